@@ -0,0 +1,96 @@
+-- Configuration changelog for incremental configuration cache update (CacheUpdateChangelog=1).
+-- Object types: 1 - host, 2 - item, 3 - trigger. Operations: 1 - add, 2 - update, 3 - remove.
+-- Function changes are recorded as changes of their triggers.
+-- Object type 4 is the configuration snapshot revision written by server itself (CacheSnapshotFile).
+-- Only the columns cached by server are tracked, runtime columns updated by server itself are ignored.
+-- Note that rows removed by foreign key cascades do not fire MySQL triggers, such removals are picked
+-- up by the periodic full synchronization (CacheUpdateFullFrequency).
+CREATE TABLE `changelog` (
+	`changelogid`            bigint unsigned                           NOT NULL AUTO_INCREMENT,
+	`object`                 integer         DEFAULT '0'               NOT NULL,
+	`objectid`               bigint unsigned                           NOT NULL,
+	`operation`              integer         DEFAULT '0'               NOT NULL,
+	`clock`                  integer         DEFAULT '0'               NOT NULL,
+	PRIMARY KEY (changelogid)
+) ENGINE=InnoDB;
+CREATE INDEX `changelog_1` ON `changelog` (`clock`);
+
+DELIMITER $$
+CREATE TRIGGER `changelog_hosts_insert` AFTER INSERT ON `hosts` FOR EACH ROW
+	INSERT INTO changelog (object,objectid,operation,clock) VALUES (1,NEW.hostid,1,UNIX_TIMESTAMP())$$
+CREATE TRIGGER `changelog_hosts_delete` AFTER DELETE ON `hosts` FOR EACH ROW
+	INSERT INTO changelog (object,objectid,operation,clock) VALUES (1,OLD.hostid,3,UNIX_TIMESTAMP())$$
+CREATE TRIGGER `changelog_hosts_update` AFTER UPDATE ON `hosts` FOR EACH ROW
+BEGIN
+	IF NOT (OLD.status <=> NEW.status) THEN
+		INSERT INTO changelog (object,objectid,operation,clock) VALUES (1,NEW.hostid,2,UNIX_TIMESTAMP());
+	END IF;
+END$$
+
+CREATE TRIGGER `changelog_items_insert` AFTER INSERT ON `items` FOR EACH ROW
+	INSERT INTO changelog (object,objectid,operation,clock) VALUES (2,NEW.itemid,1,UNIX_TIMESTAMP())$$
+CREATE TRIGGER `changelog_items_delete` AFTER DELETE ON `items` FOR EACH ROW
+	INSERT INTO changelog (object,objectid,operation,clock) VALUES (2,OLD.itemid,3,UNIX_TIMESTAMP())$$
+CREATE TRIGGER `changelog_items_update` AFTER UPDATE ON `items` FOR EACH ROW
+BEGIN
+	IF NOT (OLD.hostid <=> NEW.hostid) OR NOT (OLD.status <=> NEW.status) OR NOT (OLD.type <=> NEW.type) OR
+		NOT (OLD.value_type <=> NEW.value_type) OR NOT (OLD.key_ <=> NEW.key_) OR
+		NOT (OLD.snmp_community <=> NEW.snmp_community) OR NOT (OLD.snmp_oid <=> NEW.snmp_oid) OR
+		NOT (OLD.port <=> NEW.port) OR NOT (OLD.snmpv3_securityname <=> NEW.snmpv3_securityname) OR
+		NOT (OLD.snmpv3_securitylevel <=> NEW.snmpv3_securitylevel) OR
+		NOT (OLD.snmpv3_authpassphrase <=> NEW.snmpv3_authpassphrase) OR
+		NOT (OLD.snmpv3_privpassphrase <=> NEW.snmpv3_privpassphrase) OR
+		NOT (OLD.ipmi_sensor <=> NEW.ipmi_sensor) OR NOT (OLD.delay <=> NEW.delay) OR
+		NOT (OLD.trapper_hosts <=> NEW.trapper_hosts) OR NOT (OLD.logtimefmt <=> NEW.logtimefmt) OR
+		NOT (OLD.params <=> NEW.params) OR NOT (OLD.authtype <=> NEW.authtype) OR
+		NOT (OLD.username <=> NEW.username) OR NOT (OLD.password <=> NEW.password) OR
+		NOT (OLD.publickey <=> NEW.publickey) OR NOT (OLD.privatekey <=> NEW.privatekey) OR
+		NOT (OLD.flags <=> NEW.flags) OR NOT (OLD.interfaceid <=> NEW.interfaceid) OR
+		NOT (OLD.snmpv3_authprotocol <=> NEW.snmpv3_authprotocol) OR
+		NOT (OLD.snmpv3_privprotocol <=> NEW.snmpv3_privprotocol) OR
+		NOT (OLD.snmpv3_contextname <=> NEW.snmpv3_contextname) OR NOT (OLD.history <=> NEW.history) OR
+		NOT (OLD.trends <=> NEW.trends) OR NOT (OLD.inventory_link <=> NEW.inventory_link) OR
+		NOT (OLD.valuemapid <=> NEW.valuemapid) OR NOT (OLD.units <=> NEW.units) OR
+		NOT (OLD.jmx_endpoint <=> NEW.jmx_endpoint) OR NOT (OLD.master_itemid <=> NEW.master_itemid) OR
+		NOT (OLD.timeout <=> NEW.timeout) OR NOT (OLD.url <=> NEW.url) OR
+		NOT (OLD.query_fields <=> NEW.query_fields) OR NOT (OLD.posts <=> NEW.posts) OR
+		NOT (OLD.status_codes <=> NEW.status_codes) OR NOT (OLD.follow_redirects <=> NEW.follow_redirects) OR
+		NOT (OLD.post_type <=> NEW.post_type) OR NOT (OLD.http_proxy <=> NEW.http_proxy) OR
+		NOT (OLD.headers <=> NEW.headers) OR NOT (OLD.retrieve_mode <=> NEW.retrieve_mode) OR
+		NOT (OLD.request_method <=> NEW.request_method) OR NOT (OLD.output_format <=> NEW.output_format) OR
+		NOT (OLD.ssl_cert_file <=> NEW.ssl_cert_file) OR NOT (OLD.ssl_key_file <=> NEW.ssl_key_file) OR
+		NOT (OLD.ssl_key_password <=> NEW.ssl_key_password) OR NOT (OLD.verify_peer <=> NEW.verify_peer) OR
+		NOT (OLD.verify_host <=> NEW.verify_host) OR NOT (OLD.allow_traps <=> NEW.allow_traps) THEN
+		INSERT INTO changelog (object,objectid,operation,clock) VALUES (2,NEW.itemid,2,UNIX_TIMESTAMP());
+	END IF;
+END$$
+
+CREATE TRIGGER `changelog_triggers_insert` AFTER INSERT ON `triggers` FOR EACH ROW
+	INSERT INTO changelog (object,objectid,operation,clock) VALUES (3,NEW.triggerid,1,UNIX_TIMESTAMP())$$
+CREATE TRIGGER `changelog_triggers_delete` AFTER DELETE ON `triggers` FOR EACH ROW
+	INSERT INTO changelog (object,objectid,operation,clock) VALUES (3,OLD.triggerid,3,UNIX_TIMESTAMP())$$
+CREATE TRIGGER `changelog_triggers_update` AFTER UPDATE ON `triggers` FOR EACH ROW
+BEGIN
+	IF NOT (OLD.description <=> NEW.description) OR NOT (OLD.expression <=> NEW.expression) OR
+		NOT (OLD.priority <=> NEW.priority) OR NOT (OLD.type <=> NEW.type) OR
+		NOT (OLD.status <=> NEW.status) OR NOT (OLD.recovery_mode <=> NEW.recovery_mode) OR
+		NOT (OLD.recovery_expression <=> NEW.recovery_expression) OR
+		NOT (OLD.correlation_mode <=> NEW.correlation_mode) OR
+		NOT (OLD.correlation_tag <=> NEW.correlation_tag) OR NOT (OLD.flags <=> NEW.flags) THEN
+		INSERT INTO changelog (object,objectid,operation,clock) VALUES (3,NEW.triggerid,2,UNIX_TIMESTAMP());
+	END IF;
+END$$
+
+CREATE TRIGGER `changelog_functions_insert` AFTER INSERT ON `functions` FOR EACH ROW
+	INSERT INTO changelog (object,objectid,operation,clock) VALUES (3,NEW.triggerid,2,UNIX_TIMESTAMP())$$
+CREATE TRIGGER `changelog_functions_delete` AFTER DELETE ON `functions` FOR EACH ROW
+	INSERT INTO changelog (object,objectid,operation,clock) VALUES (3,OLD.triggerid,2,UNIX_TIMESTAMP())$$
+CREATE TRIGGER `changelog_functions_update` AFTER UPDATE ON `functions` FOR EACH ROW
+BEGIN
+	IF NOT (OLD.triggerid <=> NEW.triggerid) THEN
+		INSERT INTO changelog (object,objectid,operation,clock) VALUES (3,OLD.triggerid,2,UNIX_TIMESTAMP());
+	END IF;
+	INSERT INTO changelog (object,objectid,operation,clock) VALUES (3,NEW.triggerid,2,UNIX_TIMESTAMP());
+END$$
+
+DELIMITER ;
@@ -0,0 +1,101 @@
+-- Configuration changelog for incremental configuration cache update (CacheUpdateChangelog=1).
+-- Object types: 1 - host, 2 - item, 3 - trigger. Operations: 1 - add, 2 - update, 3 - remove.
+-- Function changes are recorded as changes of their triggers.
+-- Object type 4 is the configuration snapshot revision written by server itself (CacheSnapshotFile).
+-- Only the columns cached by server are tracked, runtime columns updated by server itself are ignored.
+CREATE TABLE changelog (
+	changelogid              bigserial                                 NOT NULL,
+	object                   integer         DEFAULT '0'               NOT NULL,
+	objectid                 bigint                                    NOT NULL,
+	operation                integer         DEFAULT '0'               NOT NULL,
+	clock                    integer         DEFAULT '0'               NOT NULL,
+	PRIMARY KEY (changelogid)
+);
+CREATE INDEX changelog_1 ON changelog (clock);
+
+CREATE FUNCTION changelog_insert(object integer, objectid bigint, operation integer) RETURNS void AS $$
+BEGIN
+	INSERT INTO changelog (object,objectid,operation,clock)
+		VALUES (object,objectid,operation,cast(extract(epoch from now()) as integer));
+END;
+$$ LANGUAGE plpgsql;
+
+CREATE FUNCTION changelog_hosts() RETURNS trigger AS $$
+BEGIN
+	IF (TG_OP = 'DELETE') THEN
+		PERFORM changelog_insert(1,OLD.hostid,3);
+		RETURN OLD;
+	ELSIF (TG_OP = 'UPDATE') THEN
+		PERFORM changelog_insert(1,NEW.hostid,2);
+	ELSE
+		PERFORM changelog_insert(1,NEW.hostid,1);
+	END IF;
+	RETURN NEW;
+END;
+$$ LANGUAGE plpgsql;
+
+CREATE FUNCTION changelog_items() RETURNS trigger AS $$
+BEGIN
+	IF (TG_OP = 'DELETE') THEN
+		PERFORM changelog_insert(2,OLD.itemid,3);
+		RETURN OLD;
+	ELSIF (TG_OP = 'UPDATE') THEN
+		PERFORM changelog_insert(2,NEW.itemid,2);
+	ELSE
+		PERFORM changelog_insert(2,NEW.itemid,1);
+	END IF;
+	RETURN NEW;
+END;
+$$ LANGUAGE plpgsql;
+
+CREATE FUNCTION changelog_triggers() RETURNS trigger AS $$
+BEGIN
+	IF (TG_OP = 'DELETE') THEN
+		PERFORM changelog_insert(3,OLD.triggerid,3);
+		RETURN OLD;
+	ELSIF (TG_OP = 'UPDATE') THEN
+		PERFORM changelog_insert(3,NEW.triggerid,2);
+	ELSE
+		PERFORM changelog_insert(3,NEW.triggerid,1);
+	END IF;
+	RETURN NEW;
+END;
+$$ LANGUAGE plpgsql;
+
+CREATE FUNCTION changelog_functions() RETURNS trigger AS $$
+BEGIN
+	IF (TG_OP = 'DELETE') THEN
+		PERFORM changelog_insert(3,OLD.triggerid,2);
+		RETURN OLD;
+	ELSIF (TG_OP = 'UPDATE' AND OLD.triggerid<>NEW.triggerid) THEN
+		PERFORM changelog_insert(3,OLD.triggerid,2);
+	END IF;
+	PERFORM changelog_insert(3,NEW.triggerid,2);
+	RETURN NEW;
+END;
+$$ LANGUAGE plpgsql;
+
+CREATE TRIGGER changelog_hosts_insert AFTER INSERT OR DELETE ON hosts
+	FOR EACH ROW EXECUTE PROCEDURE changelog_hosts();
+CREATE TRIGGER changelog_hosts_update AFTER UPDATE OF status ON hosts
+	FOR EACH ROW EXECUTE PROCEDURE changelog_hosts();
+
+CREATE TRIGGER changelog_items_insert AFTER INSERT OR DELETE ON items
+	FOR EACH ROW EXECUTE PROCEDURE changelog_items();
+CREATE TRIGGER changelog_items_update AFTER UPDATE OF hostid,status,type,value_type,key_,snmp_community,snmp_oid,
+	port,snmpv3_securityname,snmpv3_securitylevel,snmpv3_authpassphrase,snmpv3_privpassphrase,ipmi_sensor,
+	delay,trapper_hosts,logtimefmt,params,authtype,username,password,publickey,privatekey,flags,interfaceid,
+	snmpv3_authprotocol,snmpv3_privprotocol,snmpv3_contextname,history,trends,inventory_link,valuemapid,units,
+	jmx_endpoint,master_itemid,timeout,url,query_fields,posts,status_codes,follow_redirects,post_type,
+	http_proxy,headers,retrieve_mode,request_method,output_format,ssl_cert_file,ssl_key_file,
+	ssl_key_password,verify_peer,verify_host,allow_traps ON items
+	FOR EACH ROW EXECUTE PROCEDURE changelog_items();
+
+CREATE TRIGGER changelog_triggers_insert AFTER INSERT OR DELETE ON triggers
+	FOR EACH ROW EXECUTE PROCEDURE changelog_triggers();
+CREATE TRIGGER changelog_triggers_update AFTER UPDATE OF description,expression,priority,type,status,
+	recovery_mode,recovery_expression,correlation_mode,correlation_tag,flags ON triggers
+	FOR EACH ROW EXECUTE PROCEDURE changelog_triggers();
+
+CREATE TRIGGER changelog_functions AFTER INSERT OR UPDATE OR DELETE ON functions
+	FOR EACH ROW EXECUTE PROCEDURE changelog_functions();
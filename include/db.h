@@ -489,6 +489,10 @@ void	DBstatement_prepare(const char *sql);
 #endif
 int		DBexecute(const char *fmt, ...) __zbx_attr_format_printf(1, 2);
 int		DBexecute_once(const char *fmt, ...) __zbx_attr_format_printf(1, 2);
+int		DBexecute_prepared(const char *sql, const unsigned char *types, const zbx_db_value_t *values,
+		int values_num);
+int		DBpipeline_begin(void);
+int		DBpipeline_end(void);
 DB_RESULT	DBselect_once(const char *fmt, ...) __zbx_attr_format_printf(1, 2);
 DB_RESULT	DBselect(const char *fmt, ...) __zbx_attr_format_printf(1, 2);
 DB_RESULT	DBselectN(const char *query, int n);
@@ -665,6 +669,8 @@ typedef struct
 	zbx_vector_ptr_t	rows;
 	/* index of autoincrement field */
 	int			autoincrement;
+	/* 1 - load rows with COPY command if supported by database */
+	unsigned char		copy;
 }
 zbx_db_insert_t;
 
@@ -676,6 +682,7 @@ void	zbx_db_insert_add_values(zbx_db_insert_t *self, ...);
 int	zbx_db_insert_execute(zbx_db_insert_t *self);
 void	zbx_db_insert_clean(zbx_db_insert_t *self);
 void	zbx_db_insert_autoincrement(zbx_db_insert_t *self, const char *field_name);
+void	zbx_db_insert_use_copy(zbx_db_insert_t *self);
 int	zbx_db_get_database_type(void);
 
 /* agent (ZABBIX, SNMP, IPMI, JMX) availability data */
@@ -40,6 +40,7 @@
 #define MAX_SNMP_ITEMS		128
 #define MAX_POLLER_ITEMS	128	/* MAX(MAX_JAVA_ITEMS, MAX_SNMP_ITEMS) */
 #define MAX_PINGER_ITEMS	128
+#define MAX_AGENT_ITEMS		1000	/* upper limit of MaxConcurrentAgentChecks */
 
 #define ZBX_TRIGGER_DEPENDENCY_LEVELS_MAX	32
 
@@ -53,10 +54,15 @@ extern int	CONFIG_TIMEOUT;
 extern zbx_uint64_t	CONFIG_CONF_CACHE_SIZE;
 extern zbx_uint64_t	CONFIG_HISTORY_CACHE_SIZE;
 extern zbx_uint64_t	CONFIG_HISTORY_INDEX_CACHE_SIZE;
+extern int	CONFIG_HISTORY_CACHE_SHARDS;
+extern int	CONFIG_DB_COPY_HISTORY;
+extern int	CONFIG_DB_PREPARED_STATEMENTS;
 extern zbx_uint64_t	CONFIG_TRENDS_CACHE_SIZE;
 
 extern int	CONFIG_POLLER_FORKS;
 extern int	CONFIG_UNREACHABLE_POLLER_FORKS;
+extern int	CONFIG_MAX_CONCURRENT_AGENT_CHECKS;
+extern int	CONFIG_MAX_ITEMS_PER_AGENT_REQUEST;
 extern int	CONFIG_IPMIPOLLER_FORKS;
 extern int	CONFIG_JAVAPOLLER_FORKS;
 extern int	CONFIG_PINGER_FORKS;
@@ -26,6 +26,10 @@
 typedef struct
 {
 	void		**buckets;
+
+	/* the small object size classes, NULL if slab allocation is disabled */
+	void		*slab_classes;
+
 	void		*lo_bound;
 	void		*hi_bound;
 	zbx_uint64_t	free_size;
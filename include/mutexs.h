@@ -29,11 +29,13 @@
 typedef wchar_t * zbx_mutex_name_t;
 typedef HANDLE zbx_mutex_t;
 #else	/* not _WINDOWS */
+/* the maximum number of history cache shards, each history and trend cache shard has its own mutex */
+#define ZBX_MUTEX_HISTORY_SHARDS	16
+
 typedef enum
 {
 	ZBX_MUTEX_LOG = 0,
 	ZBX_MUTEX_CACHE,
-	ZBX_MUTEX_TRENDS,
 	ZBX_MUTEX_CACHE_IDS,
 	ZBX_MUTEX_SELFMON,
 	ZBX_MUTEX_CPUSTATS,
@@ -44,6 +46,10 @@ typedef enum
 	ZBX_MUTEX_SQLITE3,
 	ZBX_MUTEX_PROCSTAT,
 	ZBX_MUTEX_PROXY_HISTORY,
+	ZBX_MUTEX_HISTORY_SHARD,
+	ZBX_MUTEX_HISTORY_SHARD_LAST = ZBX_MUTEX_HISTORY_SHARD + ZBX_MUTEX_HISTORY_SHARDS - 1,
+	ZBX_MUTEX_TRENDS_SHARD,
+	ZBX_MUTEX_TRENDS_SHARD_LAST = ZBX_MUTEX_TRENDS_SHARD + ZBX_MUTEX_HISTORY_SHARDS - 1,
 	ZBX_MUTEX_COUNT
 }
 zbx_mutex_name_t;
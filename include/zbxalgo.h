@@ -169,6 +169,64 @@ void	zbx_hashset_iter_reset(zbx_hashset_t *hs, zbx_hashset_iter_t *iter);
 void	*zbx_hashset_iter_next(zbx_hashset_iter_t *iter);
 void	zbx_hashset_iter_remove(zbx_hashset_iter_t *iter);
 
+/* open addressing hashset */
+
+/* the slots store element hash and pointer to separately allocated element data, */
+/* so lookups do not access element data unless the hashes match                  */
+typedef struct
+{
+	void		*data;
+	zbx_hash_t	hash;
+	zbx_uint32_t	distance;	/* distance from the home slot + 1, 0 for empty slot */
+}
+zbx_oahashset_slot_t;
+
+typedef struct
+{
+	zbx_oahashset_slot_t	*slots;
+	int			num_slots;
+	int			num_data;
+	zbx_hash_func_t		hash_func;
+	zbx_compare_func_t	compare_func;
+	zbx_clean_func_t	clean_func;
+	zbx_mem_malloc_func_t	mem_malloc_func;
+	zbx_mem_realloc_func_t	mem_realloc_func;
+	zbx_mem_free_func_t	mem_free_func;
+}
+zbx_oahashset_t;
+
+void	zbx_oahashset_create(zbx_oahashset_t *hs, size_t init_size,
+				zbx_hash_func_t hash_func,
+				zbx_compare_func_t compare_func);
+void	zbx_oahashset_create_ext(zbx_oahashset_t *hs, size_t init_size,
+				zbx_hash_func_t hash_func,
+				zbx_compare_func_t compare_func,
+				zbx_clean_func_t clean_func,
+				zbx_mem_malloc_func_t mem_malloc_func,
+				zbx_mem_realloc_func_t mem_realloc_func,
+				zbx_mem_free_func_t mem_free_func);
+void	zbx_oahashset_destroy(zbx_oahashset_t *hs);
+
+int	zbx_oahashset_reserve(zbx_oahashset_t *hs, int num_data_req);
+void	*zbx_oahashset_insert(zbx_oahashset_t *hs, const void *data, size_t size);
+void	*zbx_oahashset_insert_ext(zbx_oahashset_t *hs, const void *data, size_t size, size_t offset);
+void	*zbx_oahashset_search(zbx_oahashset_t *hs, const void *data);
+void	zbx_oahashset_remove(zbx_oahashset_t *hs, const void *data);
+void	zbx_oahashset_remove_direct(zbx_oahashset_t *hs, const void *data);
+
+void	zbx_oahashset_clear(zbx_oahashset_t *hs);
+
+typedef struct
+{
+	zbx_oahashset_t	*hashset;
+	int		slot;
+}
+zbx_oahashset_iter_t;
+
+void	zbx_oahashset_iter_reset(zbx_oahashset_t *hs, zbx_oahashset_iter_t *iter);
+void	*zbx_oahashset_iter_next(zbx_oahashset_iter_t *iter);
+void	zbx_oahashset_iter_remove(zbx_oahashset_iter_t *iter);
+
 /* hashmap */
 
 /* currently, we only have a very specialized hashmap */
@@ -87,8 +87,19 @@ int	zbx_db_rollback(void);
 int	zbx_db_txn_level(void);
 int	zbx_db_txn_error(void);
 int	zbx_db_txn_end_error(void);
+int	zbx_db_upsert_supported(void);
 const char	*zbx_db_last_strerr(void);
 
+#ifdef HAVE_POSTGRESQL
+int	zbx_db_copy_from(const char *sql, const char *data, size_t size);
+#endif
+#if defined(HAVE_MYSQL) || defined(HAVE_POSTGRESQL)
+int	zbx_db_execute_prepared(const char *sql, const unsigned char *types, const zbx_db_value_t *values,
+		int values_num);
+#endif
+int	zbx_db_pipeline_begin(void);
+int	zbx_db_pipeline_end(void);
+
 #ifdef HAVE_ORACLE
 
 /* context for dynamic parameter binding */
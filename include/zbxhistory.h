@@ -54,5 +54,15 @@ int	zbx_history_get_values(zbx_uint64_t itemid, int value_type, int start, int c
 
 int	zbx_history_requires_trends(int value_type);
 
+/* the history storage aggregate types, see zbx_history_get_aggregate() */
+#define ZBX_HISTORY_AGGR_SUM	0
+#define ZBX_HISTORY_AGGR_AVG	1
+#define ZBX_HISTORY_AGGR_MIN	2
+#define ZBX_HISTORY_AGGR_MAX	3
+#define ZBX_HISTORY_AGGR_COUNT	4
+
+int	zbx_history_get_aggregate(zbx_uint64_t itemid, int value_type, int type, int start, int end,
+		history_value_t *value, int *num);
+
 
 #endif
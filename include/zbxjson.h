@@ -100,6 +100,7 @@
 #define ZBX_PROTO_TAG_PARAMS		"params"
 #define ZBX_PROTO_TAG_FROM		"from"
 #define ZBX_PROTO_TAG_TO		"to"
+#define ZBX_PROTO_TAG_TIMEOUT		"timeout"
 
 #define ZBX_PROTO_VALUE_FAILED		"failed"
 #define ZBX_PROTO_VALUE_SUCCESS		"success"
@@ -112,7 +113,9 @@
 #define ZBX_PROTO_VALUE_HISTORY_DATA		"history data"
 #define ZBX_PROTO_VALUE_AUTO_REGISTRATION_DATA	"auto registration"
 #define ZBX_PROTO_VALUE_SENDER_DATA		"sender data"
+#define ZBX_PROTO_VALUE_SENDER_BULK_DATA	"ZBX_SENDER_BULK"	/* header line of newline delimited sender data */
 #define ZBX_PROTO_VALUE_AGENT_DATA		"agent data"
+#define ZBX_PROTO_VALUE_PASSIVE_CHECKS		"passive checks"
 #define ZBX_PROTO_VALUE_COMMAND			"command"
 #define ZBX_PROTO_VALUE_JAVA_GATEWAY_INTERNAL	"java gateway internal"
 #define ZBX_PROTO_VALUE_JAVA_GATEWAY_JMX	"java gateway jmx"
@@ -226,5 +229,6 @@ zbx_jsonpath_t;
 void	zbx_jsonpath_clear(zbx_jsonpath_t *jsonpath);
 int	zbx_jsonpath_compile(const char *path, zbx_jsonpath_t *jsonpath);
 int	zbx_jsonpath_query(const struct zbx_json_parse *jp, const char *path, char **output);
+int	zbx_jsonpath_query_precompiled(const struct zbx_json_parse *jp, zbx_jsonpath_t *jsonpath, char **output);
 
 #endif /* ZABBIX_ZJSON_H */
@@ -0,0 +1,476 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2020 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "common.h"
+#include "log.h"
+
+#include "zbxalgo.h"
+
+/******************************************************************************
+ *                                                                            *
+ * Open addressing hashset                                                    *
+ *                                                                            *
+ * The slots are kept in a single array and hold the element hash and pointer *
+ * to the element data, so lookups scan a contiguous piece of memory and      *
+ * access element data only when hashes match. Element data is allocated      *
+ * separately and is never moved, so the returned pointers stay valid until   *
+ * the element is removed, like with zbx_hashset_t.                           *
+ *                                                                            *
+ * Collisions are resolved by linear probing with Robin Hood displacement:    *
+ * an element being inserted takes the slot of an element that is closer to   *
+ * its home slot. Removed elements are replaced by shifting the following     *
+ * elements back, so no tombstones are needed.                                *
+ *                                                                            *
+ * The probing does not wrap around. Instead there are ZBX_OAHASHSET_OVERFLOW *
+ * extra slots after the last home slot and the slot array is grown if an     *
+ * element would have to be placed beyond them. This keeps removal during     *
+ * iteration simple - the shifted elements always come from the slots not     *
+ * visited yet.                                                               *
+ *                                                                            *
+ ******************************************************************************/
+
+#define CRIT_LOAD_FACTOR		4/5
+#define ZBX_OAHASHSET_DEFAULT_SLOTS	16
+#define ZBX_OAHASHSET_OVERFLOW		64
+
+#define ZBX_OAHASHSET_SLOTS_ALLOC(hs)	((hs)->num_slots + ZBX_OAHASHSET_OVERFLOW)
+
+/* private hashset functions */
+
+static void	__oahashset_free_entry(zbx_oahashset_t *hs, void *data)
+{
+	if (NULL != hs->clean_func)
+		hs->clean_func(data);
+
+	hs->mem_free_func(data);
+}
+
+static int	__oahashset_alloc_slots(zbx_oahashset_t *hs, int num_slots)
+{
+	size_t	size;
+
+	size = (num_slots + ZBX_OAHASHSET_OVERFLOW) * sizeof(zbx_oahashset_slot_t);
+
+	if (NULL == (hs->slots = (zbx_oahashset_slot_t *)hs->mem_malloc_func(NULL, size)))
+		return FAIL;
+
+	memset(hs->slots, 0, size);
+	hs->num_slots = num_slots;
+
+	return SUCCEED;
+}
+
+static int	zbx_oahashset_init_slots(zbx_oahashset_t *hs, size_t init_size)
+{
+	int	num_slots = ZBX_OAHASHSET_DEFAULT_SLOTS;
+
+	hs->num_data = 0;
+
+	if (0 == init_size)
+	{
+		hs->num_slots = 0;
+		hs->slots = NULL;
+
+		return SUCCEED;
+	}
+
+	/* the number of home slots is a power of two, so the home slot is the lower bits of hash */
+	while ((size_t)num_slots * CRIT_LOAD_FACTOR < init_size)
+		num_slots *= 2;
+
+	return __oahashset_alloc_slots(hs, num_slots);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: __oahashset_place                                                *
+ *                                                                            *
+ * Purpose: places element into slot array using Robin Hood displacement      *
+ *                                                                            *
+ * Parameters: hs   - [IN] the hashset                                        *
+ *             slot - [IN/OUT] the element to place, the element that did not *
+ *                             fit in the slot array on failure               *
+ *                                                                            *
+ * Return value: SUCCEED - the element was placed                             *
+ *               FAIL    - the probing reached the end of slot array, the     *
+ *                         slot array must be grown                           *
+ *                                                                            *
+ ******************************************************************************/
+static int	__oahashset_place(zbx_oahashset_t *hs, zbx_oahashset_slot_t *slot)
+{
+	zbx_oahashset_slot_t	tmp;
+	int			pos, num_slots;
+
+	num_slots = ZBX_OAHASHSET_SLOTS_ALLOC(hs);
+	pos = (int)(slot->hash & (zbx_hash_t)(hs->num_slots - 1));
+	slot->distance = 1;
+
+	for (; pos < num_slots; pos++, slot->distance++)
+	{
+		if (0 == hs->slots[pos].distance)
+		{
+			hs->slots[pos] = *slot;
+			return SUCCEED;
+		}
+
+		/* the element farther from its home slot takes the slot */
+		if (hs->slots[pos].distance < slot->distance)
+		{
+			tmp = hs->slots[pos];
+			hs->slots[pos] = *slot;
+			*slot = tmp;
+		}
+	}
+
+	return FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: __oahashset_rehash                                               *
+ *                                                                            *
+ * Purpose: moves elements to a larger slot array                             *
+ *                                                                            *
+ * Parameters: hs        - [IN] the hashset                                   *
+ *             num_slots - [IN] the new number of home slots                  *
+ *             extra     - [IN] the element that is not in slot array yet,    *
+ *                              optional                                      *
+ *                                                                            *
+ * Return value: SUCCEED - the slot array was grown                           *
+ *               FAIL    - memory allocation failed                           *
+ *                                                                            *
+ ******************************************************************************/
+static int	__oahashset_rehash(zbx_oahashset_t *hs, int num_slots, const zbx_oahashset_slot_t *extra)
+{
+	zbx_oahashset_slot_t	*old_slots, slot;
+	int			i, old_num_slots, old_home_slots;
+
+	old_slots = hs->slots;
+	old_home_slots = hs->num_slots;
+	old_num_slots = (NULL != old_slots ? ZBX_OAHASHSET_SLOTS_ALLOC(hs) : 0);
+retry:
+	if (SUCCEED != __oahashset_alloc_slots(hs, num_slots))
+	{
+		/* a failed retry has already changed the number of slots */
+		hs->slots = old_slots;
+		hs->num_slots = old_home_slots;
+		return FAIL;
+	}
+
+	for (i = 0; i <= old_num_slots; i++)
+	{
+		if (i < old_num_slots)
+		{
+			if (0 == old_slots[i].distance)
+				continue;
+
+			slot = old_slots[i];
+		}
+		else if (NULL != extra)
+			slot = *extra;
+		else
+			break;
+
+		if (SUCCEED != __oahashset_place(hs, &slot))
+		{
+			/* unlikely, but possible with bad hash function - try again with more slots */
+			hs->mem_free_func(hs->slots);
+			num_slots *= 2;
+			goto retry;
+		}
+	}
+
+	if (NULL != old_slots)
+		hs->mem_free_func(old_slots);
+
+	return SUCCEED;
+}
+
+static int	__oahashset_find(zbx_oahashset_t *hs, const void *data, zbx_hash_t hash)
+{
+	int		pos, num_slots;
+	zbx_uint32_t	distance = 1;
+
+	num_slots = ZBX_OAHASHSET_SLOTS_ALLOC(hs);
+
+	/* the search stops at the first element that is closer to its home slot than the searched one would be */
+	for (pos = (int)(hash & (zbx_hash_t)(hs->num_slots - 1)); pos < num_slots; pos++, distance++)
+	{
+		if (hs->slots[pos].distance < distance)
+			break;
+
+		if (hs->slots[pos].hash == hash && 0 == hs->compare_func(hs->slots[pos].data, data))
+			return pos;
+	}
+
+	return FAIL;
+}
+
+static void	__oahashset_remove_slot(zbx_oahashset_t *hs, int pos)
+{
+	int	num_slots;
+
+	num_slots = ZBX_OAHASHSET_SLOTS_ALLOC(hs);
+
+	/* shift the following elements back until an empty slot or an element in its home slot */
+	for (; pos + 1 < num_slots && 1 < hs->slots[pos + 1].distance; pos++)
+	{
+		hs->slots[pos] = hs->slots[pos + 1];
+		hs->slots[pos].distance--;
+	}
+
+	hs->slots[pos].distance = 0;
+	hs->num_data--;
+}
+
+/* public hashset interface */
+
+void	zbx_oahashset_create(zbx_oahashset_t *hs, size_t init_size,
+				zbx_hash_func_t hash_func,
+				zbx_compare_func_t compare_func)
+{
+	zbx_oahashset_create_ext(hs, init_size, hash_func, compare_func, NULL,
+					ZBX_DEFAULT_MEM_MALLOC_FUNC,
+					ZBX_DEFAULT_MEM_REALLOC_FUNC,
+					ZBX_DEFAULT_MEM_FREE_FUNC);
+}
+
+void	zbx_oahashset_create_ext(zbx_oahashset_t *hs, size_t init_size,
+				zbx_hash_func_t hash_func,
+				zbx_compare_func_t compare_func,
+				zbx_clean_func_t clean_func,
+				zbx_mem_malloc_func_t mem_malloc_func,
+				zbx_mem_realloc_func_t mem_realloc_func,
+				zbx_mem_free_func_t mem_free_func)
+{
+	hs->hash_func = hash_func;
+	hs->compare_func = compare_func;
+	hs->clean_func = clean_func;
+	hs->mem_malloc_func = mem_malloc_func;
+	hs->mem_realloc_func = mem_realloc_func;
+	hs->mem_free_func = mem_free_func;
+
+	zbx_oahashset_init_slots(hs, init_size);
+}
+
+void	zbx_oahashset_destroy(zbx_oahashset_t *hs)
+{
+	zbx_oahashset_clear(hs);
+
+	if (NULL != hs->slots)
+		hs->mem_free_func(hs->slots);
+
+	hs->slots = NULL;
+	hs->num_slots = 0;
+
+	hs->hash_func = NULL;
+	hs->compare_func = NULL;
+	hs->mem_malloc_func = NULL;
+	hs->mem_realloc_func = NULL;
+	hs->mem_free_func = NULL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_oahashset_reserve                                            *
+ *                                                                            *
+ * Purpose: allocate memory for the specified number of elements              *
+ *                                                                            *
+ * Parameters: hs           - [IN] the hashset                                *
+ *             num_data_req - [IN] the number of elements                     *
+ *                                                                            *
+ * Return value: SUCCEED - the memory was allocated successfully              *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: Unlike zbx_hashset_reserve() the number of elements rather than  *
+ *           slots is specified, the slots are added to keep load factor.     *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_oahashset_reserve(zbx_oahashset_t *hs, int num_data_req)
+{
+	int	num_slots;
+
+	if (0 == hs->num_slots)
+		return zbx_oahashset_init_slots(hs, MAX(ZBX_OAHASHSET_DEFAULT_SLOTS, num_data_req));
+
+	if (num_data_req <= hs->num_slots * CRIT_LOAD_FACTOR)
+		return SUCCEED;
+
+	for (num_slots = hs->num_slots * 2; num_slots * CRIT_LOAD_FACTOR < num_data_req; num_slots *= 2)
+		;
+
+	return __oahashset_rehash(hs, num_slots, NULL);
+}
+
+void	*zbx_oahashset_insert(zbx_oahashset_t *hs, const void *data, size_t size)
+{
+	return zbx_oahashset_insert_ext(hs, data, size, 0);
+}
+
+void	*zbx_oahashset_insert_ext(zbx_oahashset_t *hs, const void *data, size_t size, size_t offset)
+{
+	zbx_oahashset_slot_t	slot;
+	void			*entry;
+	int			pos;
+
+	if (0 == hs->num_slots && SUCCEED != zbx_oahashset_init_slots(hs, ZBX_OAHASHSET_DEFAULT_SLOTS))
+		return NULL;
+
+	slot.hash = hs->hash_func(data);
+
+	if (FAIL != (pos = __oahashset_find(hs, data, slot.hash)))
+		return hs->slots[pos].data;
+
+	if (hs->num_data + 1 > hs->num_slots * CRIT_LOAD_FACTOR &&
+			SUCCEED != __oahashset_rehash(hs, hs->num_slots * 2, NULL))
+	{
+		return NULL;
+	}
+
+	if (NULL == (entry = hs->mem_malloc_func(NULL, size)))
+		return NULL;
+
+	memcpy((char *)entry + offset, (const char *)data + offset, size - offset);
+	slot.data = entry;
+
+	/* the element displaced past the end of slot array (not necessarily the new one) is placed after growing it */
+	if (SUCCEED != __oahashset_place(hs, &slot) && SUCCEED != __oahashset_rehash(hs, hs->num_slots * 2, &slot))
+	{
+		THIS_SHOULD_NEVER_HAPPEN;
+		exit(EXIT_FAILURE);
+	}
+
+	hs->num_data++;
+
+	return entry;
+}
+
+void	*zbx_oahashset_search(zbx_oahashset_t *hs, const void *data)
+{
+	int	pos;
+
+	if (0 == hs->num_slots)
+		return NULL;
+
+	if (FAIL == (pos = __oahashset_find(hs, data, hs->hash_func(data))))
+		return NULL;
+
+	return hs->slots[pos].data;
+}
+
+void	zbx_oahashset_remove(zbx_oahashset_t *hs, const void *data)
+{
+	int	pos;
+
+	if (0 == hs->num_slots)
+		return;
+
+	if (FAIL == (pos = __oahashset_find(hs, data, hs->hash_func(data))))
+		return;
+
+	__oahashset_free_entry(hs, hs->slots[pos].data);
+	__oahashset_remove_slot(hs, pos);
+}
+
+void	zbx_oahashset_remove_direct(zbx_oahashset_t *hs, const void *data)
+{
+	int		pos, num_slots;
+	zbx_hash_t	hash;
+
+	if (0 == hs->num_slots)
+		return;
+
+	hash = hs->hash_func(data);
+	num_slots = ZBX_OAHASHSET_SLOTS_ALLOC(hs);
+
+	for (pos = (int)(hash & (zbx_hash_t)(hs->num_slots - 1)); pos < num_slots; pos++)
+	{
+		if (0 == hs->slots[pos].distance)
+			break;
+
+		if (hs->slots[pos].data == data)
+		{
+			__oahashset_free_entry(hs, hs->slots[pos].data);
+			__oahashset_remove_slot(hs, pos);
+			return;
+		}
+	}
+}
+
+void	zbx_oahashset_clear(zbx_oahashset_t *hs)
+{
+	int	i, num_slots;
+
+	if (NULL == hs->slots)
+		return;
+
+	num_slots = ZBX_OAHASHSET_SLOTS_ALLOC(hs);
+
+	for (i = 0; i < num_slots; i++)
+	{
+		if (0 == hs->slots[i].distance)
+			continue;
+
+		__oahashset_free_entry(hs, hs->slots[i].data);
+		hs->slots[i].distance = 0;
+	}
+
+	hs->num_data = 0;
+}
+
+void	zbx_oahashset_iter_reset(zbx_oahashset_t *hs, zbx_oahashset_iter_t *iter)
+{
+	iter->hashset = hs;
+	iter->slot = -1;
+}
+
+void	*zbx_oahashset_iter_next(zbx_oahashset_iter_t *iter)
+{
+	int	num_slots;
+
+	if (NULL == iter->hashset->slots)
+		return NULL;
+
+	num_slots = ZBX_OAHASHSET_SLOTS_ALLOC(iter->hashset);
+
+	while (++iter->slot < num_slots)
+	{
+		if (0 != iter->hashset->slots[iter->slot].distance)
+			return iter->hashset->slots[iter->slot].data;
+	}
+
+	return NULL;
+}
+
+void	zbx_oahashset_iter_remove(zbx_oahashset_iter_t *iter)
+{
+	zbx_oahashset_t	*hs = iter->hashset;
+
+	if (0 > iter->slot || ZBX_OAHASHSET_SLOTS_ALLOC(hs) <= iter->slot || 0 == hs->slots[iter->slot].distance)
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "removing a hashset entry through a bad iterator");
+		exit(EXIT_FAILURE);
+	}
+
+	__oahashset_free_entry(hs, hs->slots[iter->slot].data);
+	__oahashset_remove_slot(hs, iter->slot);
+
+	/* the next element could have been shifted into the current slot */
+	iter->slot--;
+}
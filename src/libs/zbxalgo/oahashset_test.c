@@ -0,0 +1,291 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2020 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "common.h"
+#include "log.h"
+
+#include "zbxalgo.h"
+
+/******************************************************************************
+ *                                                                            *
+ * Open addressing hashset test                                               *
+ *                                                                            *
+ * Runs random insert/search/remove operations on zbx_oahashset_t and         *
+ * zbx_hashset_t side by side and checks that both agree, then measures the   *
+ * lookup speed of both with history cache like keys.                         *
+ *                                                                            *
+ * Usage: oahashset_test [number of elements for the benchmark]               *
+ *                                                                            *
+ ******************************************************************************/
+
+const char	*progname = NULL;
+const char	title_message[] = "oahashset_test";
+const char	syslog_app_name[] = "oahashset_test";
+const char	*usage_message[] = {"[elements]", NULL};
+const char	*help_message[] = {NULL};
+unsigned char	program_type = 0;
+
+#define OAHASHSET_TEST_OPERATIONS	1000000
+#define OAHASHSET_TEST_KEYS		20000
+#define OAHASHSET_BENCH_ELEMENTS	1000000
+#define OAHASHSET_BENCH_ROUNDS		4
+
+typedef struct
+{
+	zbx_uint64_t	id;
+	zbx_uint64_t	value;
+}
+zbx_test_elem_t;
+
+static zbx_uint64_t	seed = 88172645463325252;
+
+static zbx_uint64_t	test_random(void)
+{
+	seed ^= seed << 13;
+	seed ^= seed >> 7;
+	seed ^= seed << 17;
+
+	return seed;
+}
+
+/* groups of 16 consecutive identifiers share the same hash to force long probe sequences */
+static zbx_hash_t	test_weak_hash_func(const void *data)
+{
+	return (zbx_hash_t)(*(const zbx_uint64_t *)data & ~(zbx_uint64_t)0xf);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: test_compare                                                     *
+ *                                                                            *
+ * Purpose: runs random operations on both hashsets and compares the results  *
+ *                                                                            *
+ * Parameters: hash_func - [IN] the hash function to use                      *
+ *             name      - [IN] the test name                                 *
+ *                                                                            *
+ * Return value: SUCCEED - the hashsets behaved the same                      *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	test_compare(zbx_hash_func_t hash_func, const char *name)
+{
+	zbx_oahashset_t		oahs;
+	zbx_oahashset_iter_t	oaiter;
+	zbx_hashset_t		hs;
+	zbx_test_elem_t		elem_local, *elem, *oaelem;
+	int			i, num, ret = FAIL;
+
+	zbx_oahashset_create(&oahs, 0, hash_func, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_hashset_create(&hs, 0, hash_func, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	for (i = 0; i < OAHASHSET_TEST_OPERATIONS; i++)
+	{
+		elem_local.id = test_random() % OAHASHSET_TEST_KEYS;
+		elem_local.value = test_random();
+
+		elem = (zbx_test_elem_t *)zbx_hashset_search(&hs, &elem_local);
+		oaelem = (zbx_test_elem_t *)zbx_oahashset_search(&oahs, &elem_local);
+
+		if ((NULL == elem) != (NULL == oaelem) || (NULL != elem && elem->value != oaelem->value))
+		{
+			printf("%s: search mismatch for " ZBX_FS_UI64 " at operation %d\n", name, elem_local.id, i);
+			goto out;
+		}
+
+		switch (test_random() % 3)
+		{
+			case 0:
+				if (NULL != elem)
+					elem->value = oaelem->value = elem_local.value;
+				break;
+			case 1:
+				elem = (zbx_test_elem_t *)zbx_hashset_insert(&hs, &elem_local, sizeof(elem_local));
+				oaelem = (zbx_test_elem_t *)zbx_oahashset_insert(&oahs, &elem_local, sizeof(elem_local));
+
+				if (elem->value != oaelem->value)
+				{
+					printf("%s: insert mismatch for " ZBX_FS_UI64 " at operation %d\n", name,
+							elem_local.id, i);
+					goto out;
+				}
+				break;
+			case 2:
+				zbx_hashset_remove(&hs, &elem_local);
+
+				if (NULL != oaelem && 0 != (test_random() & 1))
+					zbx_oahashset_remove_direct(&oahs, oaelem);
+				else
+					zbx_oahashset_remove(&oahs, &elem_local);
+				break;
+		}
+
+		if (hs.num_data != oahs.num_data)
+		{
+			printf("%s: element count %d != %d at operation %d\n", name, oahs.num_data, hs.num_data, i);
+			goto out;
+		}
+	}
+
+	/* every element must be visited once, also when the visited elements are removed */
+	num = 0;
+	zbx_oahashset_iter_reset(&oahs, &oaiter);
+
+	while (NULL != (oaelem = (zbx_test_elem_t *)zbx_oahashset_iter_next(&oaiter)))
+	{
+		if (NULL == (elem = (zbx_test_elem_t *)zbx_hashset_search(&hs, oaelem)) || elem->value != oaelem->value)
+		{
+			printf("%s: iterator returned unknown element " ZBX_FS_UI64 "\n", name, oaelem->id);
+			goto out;
+		}
+
+		zbx_hashset_remove_direct(&hs, elem);
+
+		if (0 != (num++ & 1))
+			zbx_oahashset_iter_remove(&oaiter);
+	}
+
+	if (0 != hs.num_data || num - num / 2 != oahs.num_data)
+	{
+		printf("%s: iterator missed %d elements\n", name, hs.num_data);
+		goto out;
+	}
+
+	ret = SUCCEED;
+	printf("%s: ok\n", name);
+out:
+	zbx_hashset_destroy(&hs);
+	zbx_oahashset_destroy(&oahs);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: test_benchmark                                                   *
+ *                                                                            *
+ * Purpose: measures lookup speed of both hashsets                            *
+ *                                                                            *
+ * Parameters: num - [IN] the number of elements                              *
+ *                                                                            *
+ * Comments: The keys are item identifiers taken in random order, the same    *
+ *           way history cache looks up items when adding values.             *
+ *                                                                            *
+ ******************************************************************************/
+static void	test_benchmark(int num)
+{
+	zbx_oahashset_t	oahs;
+	zbx_hashset_t	hs;
+	zbx_test_elem_t	elem_local;
+	zbx_uint64_t	*keys, sum = 0, oasum = 0;
+	int		i, round;
+	double		sec, insert_time, search_time, oainsert_time, oasearch_time;
+
+	keys = (zbx_uint64_t *)zbx_malloc(NULL, sizeof(zbx_uint64_t) * num);
+
+	for (i = 0; i < num; i++)
+		keys[i] = 10000 + test_random() % ((zbx_uint64_t)num * 4);
+
+	zbx_hashset_create(&hs, 0, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_oahashset_create(&oahs, 0, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	sec = zbx_time();
+	for (i = 0; i < num; i++)
+	{
+		elem_local.id = keys[i];
+		elem_local.value = i;
+		zbx_hashset_insert(&hs, &elem_local, sizeof(elem_local));
+	}
+	insert_time = zbx_time() - sec;
+
+	sec = zbx_time();
+	for (i = 0; i < num; i++)
+	{
+		elem_local.id = keys[i];
+		elem_local.value = i;
+		zbx_oahashset_insert(&oahs, &elem_local, sizeof(elem_local));
+	}
+	oainsert_time = zbx_time() - sec;
+
+	/* half of the lookups are for keys that are not in the set */
+	for (i = 0; i < num; i++)
+	{
+		if (0 != (i & 1))
+			keys[i] += (zbx_uint64_t)num * 4;
+	}
+
+	sec = zbx_time();
+	for (round = 0; round < OAHASHSET_BENCH_ROUNDS; round++)
+	{
+		for (i = 0; i < num; i++)
+		{
+			zbx_test_elem_t	*elem;
+
+			if (NULL != (elem = (zbx_test_elem_t *)zbx_hashset_search(&hs, &keys[i])))
+				sum += elem->value;
+		}
+	}
+	search_time = zbx_time() - sec;
+
+	sec = zbx_time();
+	for (round = 0; round < OAHASHSET_BENCH_ROUNDS; round++)
+	{
+		for (i = 0; i < num; i++)
+		{
+			zbx_test_elem_t	*elem;
+
+			if (NULL != (elem = (zbx_test_elem_t *)zbx_oahashset_search(&oahs, &keys[i])))
+				oasum += elem->value;
+		}
+	}
+	oasearch_time = zbx_time() - sec;
+
+	printf("benchmark: %d elements, %d lookups%s\n", hs.num_data, num * OAHASHSET_BENCH_ROUNDS,
+			sum == oasum ? "" : ", results differ");
+	printf("  zbx_hashset_t:   insert %.3f sec, search %.3f sec (%.1f ns/lookup)\n", insert_time, search_time,
+			search_time * 1e9 / num / OAHASHSET_BENCH_ROUNDS);
+	printf("  zbx_oahashset_t: insert %.3f sec, search %.3f sec (%.1f ns/lookup)\n", oainsert_time, oasearch_time,
+			oasearch_time * 1e9 / num / OAHASHSET_BENCH_ROUNDS);
+
+	zbx_oahashset_destroy(&oahs);
+	zbx_hashset_destroy(&hs);
+	zbx_free(keys);
+}
+
+int	main(int argc, char **argv)
+{
+	int	num = OAHASHSET_BENCH_ELEMENTS;
+
+	progname = argv[0];
+
+	if (1 < argc && 0 >= (num = atoi(argv[1])))
+	{
+		printf("usage: %s %s\n", progname, usage_message[0]);
+		return EXIT_FAILURE;
+	}
+
+	if (SUCCEED != test_compare(ZBX_DEFAULT_UINT64_HASH_FUNC, "default hash") ||
+			SUCCEED != test_compare(test_weak_hash_func, "weak hash"))
+	{
+		return EXIT_FAILURE;
+	}
+
+	test_benchmark(num);
+
+	return EXIT_SUCCESS;
+}
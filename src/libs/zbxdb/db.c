@@ -40,6 +40,9 @@
 #if defined(HAVE_SQLITE3)
 #	include "mutexs.h"
 #endif
+#if defined(HAVE_MYSQL) || defined(HAVE_POSTGRESQL)
+#	include "zbxalgo.h"
+#endif
 
 struct zbx_db_result
 {
@@ -156,6 +159,34 @@ static zbx_mutex_t sqlite_access = ZBX_MUTEX_NULL;
 static void	OCI_DBclean_result(DB_RESULT result);
 #endif
 
+#if defined(HAVE_MYSQL) || defined(HAVE_POSTGRESQL)
+#define ZBX_DB_PREPARED_MAX	128	/* maximum number of cached prepared statements per connection */
+
+typedef struct
+{
+	char		*sql;
+#if defined(HAVE_MYSQL)
+	MYSQL_STMT	*stmt;
+#else
+	char		*name;
+#endif
+}
+zbx_db_prepared_t;
+
+static zbx_vector_ptr_t	db_prepared;		/* prepared statements of the current connection */
+static int		db_prepared_init = 0;
+
+static void	zbx_db_prepared_clear(void);
+#endif
+
+#if defined(HAVE_POSTGRESQL)
+static int		db_prepared_seq = 0;	/* sequence for unique statement names */
+#	if defined(LIBPQ_HAS_PIPELINING)
+static int		db_pipeline = 0;	/* 1 - statements are queued in pipeline */
+static zbx_vector_ptr_t	db_pipeline_prepared;	/* statements prepared within the current pipeline */
+#	endif
+#endif
+
 /* 定义函数，用于处理数据库错误日志 */
 static void zbx_db_errlog(zbx_err_codes_t zbx_errno, int db_errno, const char *db_error, const char *context)
 {
@@ -925,6 +956,8 @@ void	zbx_db_close(void)
 
 	memset(&ibm_db2, 0, sizeof(ibm_db2));
 #elif defined(HAVE_MYSQL)
+	zbx_db_prepared_clear();
+
 	if (NULL != conn)
 	{
 		mysql_close(conn);
@@ -978,6 +1011,8 @@ void	zbx_db_close(void)
 
 	zbx_vector_ptr_destroy(&oracle.db_results);
 #elif defined(HAVE_POSTGRESQL)
+	zbx_db_prepared_clear();
+
 	if (NULL != conn)
 	{
 		PQfinish(conn);
@@ -1199,6 +1234,29 @@ int	zbx_db_txn_end_error(void)
 	return txn_end_error;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_db_upsert_supported                                          *
+ *                                                                            *
+ * Purpose: checks if the database supports insert statements updating        *
+ *          conflicting rows (on duplicate key update / on conflict)          *
+ *                                                                            *
+ * Return value: SUCCEED - upsert is supported                                *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_db_upsert_supported(void)
+{
+#if defined(HAVE_MYSQL)
+	return SUCCEED;
+#elif defined(HAVE_POSTGRESQL)
+	/* on conflict clause is available starting with PostgreSQL 9.5 */
+	return 90500 <= ZBX_PG_SVERSION ? SUCCEED : FAIL;
+#else
+	return FAIL;
+#endif
+}
+
 #ifdef HAVE_ORACLE
 static sword	zbx_oracle_statement_prepare(const char *sql)
 {
@@ -1699,6 +1757,723 @@ clean:
 	return ret;
 }
 
+#ifdef HAVE_POSTGRESQL
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_db_copy_from                                                 *
+ *                                                                            *
+ * Purpose: load rows into table with COPY ... FROM STDIN command             *
+ *                                                                            *
+ * Parameters: sql  - [IN] the copy command                                   *
+ *             data - [IN] the rows in COPY text format                       *
+ *             size - [IN] the data size                                      *
+ *                                                                            *
+ * Return value: number of copied rows, ZBX_DB_FAIL or ZBX_DB_DOWN            *
+ *                                                                            *
+ * Comments: Rows are streamed to the server without building and parsing     *
+ *           insert statements, which makes bulk loading of numeric data      *
+ *           considerably cheaper for both sides.                             *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_db_copy_from(const char *sql, const char *data, size_t size)
+{
+#define ZBX_DB_COPY_CHUNK_SIZE	ZBX_MEBIBYTE
+
+	PGresult	*result;
+	char		*error = NULL;
+	int		ret = ZBX_DB_OK, chunk;
+	size_t		offset;
+	double		sec = 0;
+
+	if (0 != CONFIG_LOG_SLOW_QUERIES)
+		sec = zbx_time();
+
+	if (0 == txn_level)
+		zabbix_log(LOG_LEVEL_DEBUG, "query without transaction detected");
+
+	if (ZBX_DB_OK != txn_error)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "ignoring query [txnlev:%d] [%s] within failed transaction", txn_level, sql);
+		return ZBX_DB_FAIL;
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "query [txnlev:%d] [%s] size:" ZBX_FS_SIZE_T, txn_level, sql,
+			(zbx_fs_size_t)size);
+
+	if (NULL == (result = PQexec(conn, sql)))
+	{
+		zbx_db_errlog(ERR_Z3005, 0, "result is NULL", sql);
+		ret = (CONNECTION_OK == PQstatus(conn) ? ZBX_DB_FAIL : ZBX_DB_DOWN);
+		goto out;
+	}
+
+	if (PGRES_COPY_IN != PQresultStatus(result))
+	{
+		zbx_postgresql_error(&error, result);
+		zbx_db_errlog(ERR_Z3005, 0, error, sql);
+		zbx_free(error);
+
+		ret = (SUCCEED == is_recoverable_postgresql_error(conn, result) ? ZBX_DB_DOWN : ZBX_DB_FAIL);
+		PQclear(result);
+		goto out;
+	}
+
+	PQclear(result);
+
+	for (offset = 0; offset < size; offset += chunk)
+	{
+		chunk = (int)MIN(size - offset, ZBX_DB_COPY_CHUNK_SIZE);
+
+		if (1 != PQputCopyData(conn, data + offset, chunk))
+			break;
+	}
+
+	if (offset < size || 1 != PQputCopyEnd(conn, offset < size ? "cannot send data" : NULL))
+	{
+		zbx_db_errlog(ERR_Z3005, 0, PQerrorMessage(conn), sql);
+		ret = (CONNECTION_OK == PQstatus(conn) ? ZBX_DB_FAIL : ZBX_DB_DOWN);
+	}
+
+	/* read the copy command result, the connection must be drained before issuing next command */
+	while (NULL != (result = PQgetResult(conn)))
+	{
+		if (PGRES_COMMAND_OK != PQresultStatus(result) && ZBX_DB_OK == ret)
+		{
+			zbx_postgresql_error(&error, result);
+			zbx_db_errlog(ERR_Z3005, 0, error, sql);
+			zbx_free(error);
+
+			ret = (SUCCEED == is_recoverable_postgresql_error(conn, result) ? ZBX_DB_DOWN : ZBX_DB_FAIL);
+		}
+
+		if (ZBX_DB_OK == ret)
+			ret = atoi(PQcmdTuples(result));
+
+		PQclear(result);
+
+		if (CONNECTION_OK != PQstatus(conn))
+			break;
+	}
+out:
+	if (0 != CONFIG_LOG_SLOW_QUERIES)
+	{
+		sec = zbx_time() - sec;
+		if (sec > (double)CONFIG_LOG_SLOW_QUERIES / 1000.0)
+			zabbix_log(LOG_LEVEL_WARNING, "slow query: " ZBX_FS_DBL " sec, \"%s\"", sec, sql);
+	}
+
+	if (ZBX_DB_FAIL == ret && 0 < txn_level)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "query [%s] failed, setting transaction as failed", sql);
+		txn_error = ZBX_DB_FAIL;
+	}
+
+	return ret;
+
+#undef ZBX_DB_COPY_CHUNK_SIZE
+}
+#endif
+
+#if defined(HAVE_MYSQL) || defined(HAVE_POSTGRESQL)
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_db_prepared_free                                             *
+ *                                                                            *
+ * Purpose: frees prepared statement cache entry                              *
+ *                                                                            *
+ ******************************************************************************/
+static void	zbx_db_prepared_free(zbx_db_prepared_t *prepared)
+{
+#if defined(HAVE_MYSQL)
+	if (NULL != prepared->stmt)
+		mysql_stmt_close(prepared->stmt);
+#else
+	zbx_free(prepared->name);
+#endif
+	zbx_free(prepared->sql);
+	zbx_free(prepared);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_db_prepared_init                                             *
+ *                                                                            *
+ * Purpose: initializes prepared statement cache                              *
+ *                                                                            *
+ ******************************************************************************/
+static void	zbx_db_prepared_init(void)
+{
+	if (1 == db_prepared_init)
+		return;
+
+	zbx_vector_ptr_create(&db_prepared);
+#if defined(HAVE_POSTGRESQL) && defined(LIBPQ_HAS_PIPELINING)
+	zbx_vector_ptr_create(&db_pipeline_prepared);
+#endif
+	db_prepared_init = 1;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_db_prepared_clear                                            *
+ *                                                                            *
+ * Purpose: forgets all prepared statements of the current connection         *
+ *                                                                            *
+ * Comments: must be called before the connection is closed, the statements   *
+ *           are released by database together with the connection            *
+ *                                                                            *
+ ******************************************************************************/
+static void	zbx_db_prepared_clear(void)
+{
+	if (0 == db_prepared_init)
+		return;
+
+#if defined(HAVE_POSTGRESQL) && defined(LIBPQ_HAS_PIPELINING)
+	db_pipeline = 0;
+	zbx_vector_ptr_clear(&db_pipeline_prepared);
+#endif
+	zbx_vector_ptr_clear_ext(&db_prepared, (zbx_mem_free_func_t)zbx_db_prepared_free);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_db_prepared_get                                              *
+ *                                                                            *
+ * Purpose: finds prepared statement in cache                                 *
+ *                                                                            *
+ * Parameters: sql - [IN] the statement text                                  *
+ *                                                                            *
+ * Return value: the cached statement or NULL if statement was not prepared   *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_db_prepared_t	*zbx_db_prepared_get(const char *sql)
+{
+	int	i;
+
+	zbx_db_prepared_init();
+
+	for (i = 0; i < db_prepared.values_num; i++)
+	{
+		zbx_db_prepared_t	*prepared = (zbx_db_prepared_t *)db_prepared.values[i];
+
+		if (0 == strcmp(prepared->sql, sql))
+			return prepared;
+	}
+
+	return NULL;
+}
+
+#if defined(HAVE_MYSQL)
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_db_prepare                                                   *
+ *                                                                            *
+ * Purpose: prepares statement on database server                             *
+ *                                                                            *
+ * Parameters: prepared - [IN/OUT] the statement to prepare                   *
+ *                                                                            *
+ * Return value: ZBX_DB_OK, ZBX_DB_FAIL or ZBX_DB_DOWN                        *
+ *                                                                            *
+ ******************************************************************************/
+static int	zbx_db_prepare(zbx_db_prepared_t *prepared)
+{
+	if (NULL == conn)
+	{
+		zbx_db_errlog(ERR_Z3003, 0, NULL, NULL);
+		return ZBX_DB_FAIL;
+	}
+
+	if (NULL == (prepared->stmt = mysql_stmt_init(conn)))
+	{
+		zbx_db_errlog(ERR_Z3005, mysql_errno(conn), mysql_error(conn), prepared->sql);
+		return ZBX_DB_FAIL;
+	}
+
+	if (0 != mysql_stmt_prepare(prepared->stmt, prepared->sql, strlen(prepared->sql)))
+	{
+		zbx_db_errlog(ERR_Z3005, mysql_stmt_errno(prepared->stmt), mysql_stmt_error(prepared->stmt),
+				prepared->sql);
+		mysql_stmt_close(prepared->stmt);
+		prepared->stmt = NULL;
+
+		return SUCCEED == is_recoverable_mysql_error() ? ZBX_DB_DOWN : ZBX_DB_FAIL;
+	}
+
+	return ZBX_DB_OK;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_db_execute_prepared_stmt                                     *
+ *                                                                            *
+ * Purpose: binds parameters and executes prepared statement                  *
+ *                                                                            *
+ * Return value: number of affected rows, ZBX_DB_FAIL or ZBX_DB_DOWN          *
+ *                                                                            *
+ ******************************************************************************/
+static int	zbx_db_execute_prepared_stmt(zbx_db_prepared_t *prepared, const unsigned char *types,
+		const zbx_db_value_t *values, int values_num)
+{
+	MYSQL_BIND	*bind;
+	int		i, ret;
+
+	bind = (MYSQL_BIND *)zbx_malloc(NULL, sizeof(MYSQL_BIND) * values_num);
+	memset(bind, 0, sizeof(MYSQL_BIND) * values_num);
+
+	for (i = 0; i < values_num; i++)
+	{
+		switch (types[i])
+		{
+			case ZBX_TYPE_INT:
+				bind[i].buffer_type = MYSQL_TYPE_LONG;
+				bind[i].buffer = (void *)&values[i].i32;
+				break;
+			case ZBX_TYPE_FLOAT:
+				bind[i].buffer_type = MYSQL_TYPE_DOUBLE;
+				bind[i].buffer = (void *)&values[i].dbl;
+				break;
+			case ZBX_TYPE_ID:
+				if (0 == values[i].ui64)
+				{
+					bind[i].buffer_type = MYSQL_TYPE_NULL;
+					break;
+				}
+				ZBX_FALLTHROUGH;
+			case ZBX_TYPE_UINT:
+				bind[i].buffer_type = MYSQL_TYPE_LONGLONG;
+				bind[i].buffer = (void *)&values[i].ui64;
+				bind[i].is_unsigned = 1;
+				break;
+			default:
+				bind[i].buffer_type = MYSQL_TYPE_STRING;
+				bind[i].buffer = values[i].str;
+				bind[i].buffer_length = strlen(values[i].str);
+		}
+	}
+
+	if (0 != mysql_stmt_bind_param(prepared->stmt, bind) || 0 != mysql_stmt_execute(prepared->stmt))
+	{
+		zbx_db_errlog(ERR_Z3005, mysql_stmt_errno(prepared->stmt), mysql_stmt_error(prepared->stmt),
+				prepared->sql);
+		ret = (SUCCEED == is_recoverable_mysql_error() ? ZBX_DB_DOWN : ZBX_DB_FAIL);
+	}
+	else
+		ret = (int)mysql_stmt_affected_rows(prepared->stmt);
+
+	zbx_free(bind);
+
+	return ret;
+}
+#else
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_db_pg_command_result                                         *
+ *                                                                            *
+ * Purpose: checks result of PostgreSQL command                               *
+ *                                                                            *
+ * Return value: ZBX_DB_OK, ZBX_DB_FAIL or ZBX_DB_DOWN                        *
+ *                                                                            *
+ ******************************************************************************/
+static int	zbx_db_pg_command_result(const PGresult *result, const char *sql)
+{
+	char	*error = NULL;
+	int	ret;
+
+	if (NULL == result)
+	{
+		zbx_db_errlog(ERR_Z3005, 0, "result is NULL", sql);
+		return CONNECTION_OK == PQstatus(conn) ? ZBX_DB_FAIL : ZBX_DB_DOWN;
+	}
+
+	if (PGRES_COMMAND_OK == PQresultStatus(result))
+		return ZBX_DB_OK;
+
+	zbx_postgresql_error(&error, result);
+	zbx_db_errlog(ERR_Z3005, 0, error, sql);
+	zbx_free(error);
+
+	ret = (SUCCEED == is_recoverable_postgresql_error(conn, result) ? ZBX_DB_DOWN : ZBX_DB_FAIL);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_db_prepare                                                   *
+ *                                                                            *
+ * Purpose: prepares statement on database server                             *
+ *                                                                            *
+ * Parameters: prepared - [IN/OUT] the statement to prepare                   *
+ *                                                                            *
+ * Return value: ZBX_DB_OK, ZBX_DB_FAIL or ZBX_DB_DOWN                        *
+ *                                                                            *
+ * Comments: '?' placeholders are replaced with PostgreSQL $n parameters.     *
+ *           In pipeline mode the statement is only queued, errors are        *
+ *           reported by zbx_db_pipeline_end().                               *
+ *                                                                            *
+ ******************************************************************************/
+static int	zbx_db_prepare(zbx_db_prepared_t *prepared)
+{
+	PGresult	*result;
+	char		*pg_sql = NULL;
+	size_t		pg_sql_alloc = 0, pg_sql_offset = 0;
+	const char	*ptr;
+	int		ret = ZBX_DB_OK, params_num = 0;
+
+	for (ptr = prepared->sql; '\0' != *ptr; ptr++)
+	{
+		if ('?' == *ptr)
+			zbx_snprintf_alloc(&pg_sql, &pg_sql_alloc, &pg_sql_offset, "$%d", ++params_num);
+		else
+			zbx_chrcpy_alloc(&pg_sql, &pg_sql_alloc, &pg_sql_offset, *ptr);
+	}
+
+#ifdef LIBPQ_HAS_PIPELINING
+	if (1 == db_pipeline)
+	{
+		if (1 != PQsendPrepare(conn, prepared->name, pg_sql, params_num, NULL))
+		{
+			zbx_db_errlog(ERR_Z3005, 0, PQerrorMessage(conn), prepared->sql);
+			ret = (CONNECTION_OK == PQstatus(conn) ? ZBX_DB_FAIL : ZBX_DB_DOWN);
+		}
+
+		goto out;
+	}
+#endif
+	result = PQprepare(conn, prepared->name, pg_sql, params_num, NULL);
+	ret = zbx_db_pg_command_result(result, prepared->sql);
+	PQclear(result);
+#ifdef LIBPQ_HAS_PIPELINING
+out:
+#endif
+	zbx_free(pg_sql);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_db_execute_prepared_stmt                                     *
+ *                                                                            *
+ * Purpose: executes prepared statement with the specified parameters         *
+ *                                                                            *
+ * Return value: number of affected rows, ZBX_DB_FAIL or ZBX_DB_DOWN          *
+ *                                                                            *
+ * Comments: parameters are passed in text format, zero identifiers are       *
+ *           passed as NULL values                                            *
+ *                                                                            *
+ ******************************************************************************/
+static int	zbx_db_execute_prepared_stmt(zbx_db_prepared_t *prepared, const unsigned char *types,
+		const zbx_db_value_t *values, int values_num)
+{
+	PGresult	*result;
+	char		**params;
+	int		i, ret = ZBX_DB_OK;
+
+	params = (char **)zbx_malloc(NULL, sizeof(char *) * values_num);
+
+	for (i = 0; i < values_num; i++)
+	{
+		switch (types[i])
+		{
+			case ZBX_TYPE_INT:
+				params[i] = zbx_dsprintf(NULL, "%d", values[i].i32);
+				break;
+			case ZBX_TYPE_FLOAT:
+				params[i] = zbx_dsprintf(NULL, ZBX_FS_DBL, values[i].dbl);
+				break;
+			case ZBX_TYPE_ID:
+				if (0 == values[i].ui64)
+				{
+					params[i] = NULL;
+					break;
+				}
+				ZBX_FALLTHROUGH;
+			case ZBX_TYPE_UINT:
+				params[i] = zbx_dsprintf(NULL, ZBX_FS_UI64, values[i].ui64);
+				break;
+			default:
+				params[i] = values[i].str;
+		}
+	}
+
+#ifdef LIBPQ_HAS_PIPELINING
+	if (1 == db_pipeline)
+	{
+		if (1 != PQsendQueryPrepared(conn, prepared->name, values_num, (const char * const *)params, NULL,
+				NULL, 0))
+		{
+			zbx_db_errlog(ERR_Z3005, 0, PQerrorMessage(conn), prepared->sql);
+			ret = (CONNECTION_OK == PQstatus(conn) ? ZBX_DB_FAIL : ZBX_DB_DOWN);
+		}
+
+		goto out;
+	}
+#endif
+	result = PQexecPrepared(conn, prepared->name, values_num, (const char * const *)params, NULL, NULL, 0);
+
+	if (ZBX_DB_OK == (ret = zbx_db_pg_command_result(result, prepared->sql)))
+		ret = atoi(PQcmdTuples(result));
+
+	PQclear(result);
+#ifdef LIBPQ_HAS_PIPELINING
+out:
+#endif
+	for (i = 0; i < values_num; i++)
+	{
+		switch (types[i])
+		{
+			case ZBX_TYPE_INT:
+			case ZBX_TYPE_FLOAT:
+			case ZBX_TYPE_ID:
+			case ZBX_TYPE_UINT:
+				zbx_free(params[i]);
+		}
+	}
+
+	zbx_free(params);
+
+	return ret;
+}
+#endif
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_db_execute_prepared                                          *
+ *                                                                            *
+ * Purpose: execute a non-select statement with bound parameters              *
+ *                                                                            *
+ * Parameters: sql        - [IN] the statement with '?' placeholders          *
+ *             types      - [IN] the parameter types (ZBX_TYPE_*)             *
+ *             values     - [IN] the parameter values                         *
+ *             values_num - [IN] the number of parameters                     *
+ *                                                                            *
+ * Return value: number of affected rows (0 in pipeline mode), ZBX_DB_FAIL or *
+ *               ZBX_DB_DOWN                                                  *
+ *                                                                            *
+ * Comments: The statement is prepared on the first use and kept in a per     *
+ *           connection cache, so repeated executions skip query parsing and  *
+ *           planning. Statements are matched by text, so the values must     *
+ *           always be passed as parameters. The sql text must not contain    *
+ *           '?' characters other than placeholders.                          *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_db_execute_prepared(const char *sql, const unsigned char *types, const zbx_db_value_t *values,
+		int values_num)
+{
+	zbx_db_prepared_t	*prepared;
+	int			ret, cache = 0;
+	double			sec = 0;
+
+	if (0 != CONFIG_LOG_SLOW_QUERIES)
+		sec = zbx_time();
+
+	if (0 == txn_level)
+		zabbix_log(LOG_LEVEL_DEBUG, "query without transaction detected");
+
+	if (ZBX_DB_OK != txn_error)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "ignoring query [txnlev:%d] [%s] within failed transaction", txn_level, sql);
+		return ZBX_DB_FAIL;
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "query [txnlev:%d] [%s] parameters:%d", txn_level, sql, values_num);
+
+	if (NULL == (prepared = zbx_db_prepared_get(sql)))
+	{
+		prepared = (zbx_db_prepared_t *)zbx_malloc(NULL, sizeof(zbx_db_prepared_t));
+		prepared->sql = zbx_strdup(NULL, sql);
+
+		/* when cache is full the statement is prepared for a single execution, */
+		/* PostgreSQL unnamed statement is replaced by the next unnamed one     */
+		if (ZBX_DB_PREPARED_MAX > db_prepared.values_num)
+			cache = 1;
+#if defined(HAVE_POSTGRESQL)
+		prepared->name = (1 == cache ? zbx_dsprintf(NULL, "zbx_stmt_%d", ++db_prepared_seq) :
+				zbx_strdup(NULL, ""));
+#endif
+		if (ZBX_DB_OK != (ret = zbx_db_prepare(prepared)))
+		{
+			zbx_db_prepared_free(prepared);
+			goto out;
+		}
+
+		if (1 == cache)
+		{
+			zbx_vector_ptr_append(&db_prepared, prepared);
+#if defined(HAVE_POSTGRESQL) && defined(LIBPQ_HAS_PIPELINING)
+			if (1 == db_pipeline)
+				zbx_vector_ptr_append(&db_pipeline_prepared, prepared);
+#endif
+		}
+	}
+	else
+		cache = 1;
+
+	ret = zbx_db_execute_prepared_stmt(prepared, types, values, values_num);
+
+	if (0 == cache)
+		zbx_db_prepared_free(prepared);
+out:
+	if (0 != CONFIG_LOG_SLOW_QUERIES)
+	{
+		sec = zbx_time() - sec;
+		if (sec > (double)CONFIG_LOG_SLOW_QUERIES / 1000.0)
+			zabbix_log(LOG_LEVEL_WARNING, "slow query: " ZBX_FS_DBL " sec, \"%s\"", sec, sql);
+	}
+
+	if (ZBX_DB_FAIL == ret && 0 < txn_level)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "query [%s] failed, setting transaction as failed", sql);
+		txn_error = ZBX_DB_FAIL;
+	}
+
+	return ret;
+}
+#endif	/* defined(HAVE_MYSQL) || defined(HAVE_POSTGRESQL) */
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_db_pipeline_begin                                            *
+ *                                                                            *
+ * Purpose: start queuing prepared statements without waiting for results     *
+ *                                                                            *
+ * Return value: SUCCEED - pipeline mode was entered                          *
+ *               FAIL    - pipelining is not supported                        *
+ *                                                                            *
+ * Comments: Only zbx_db_execute_prepared() may be called until the pipeline  *
+ *           is finished with zbx_db_pipeline_end(). Pipelining is available  *
+ *           with PostgreSQL client library 14 and newer.                     *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_db_pipeline_begin(void)
+{
+#if defined(HAVE_POSTGRESQL) && defined(LIBPQ_HAS_PIPELINING)
+	if (NULL == conn || 1 == db_pipeline || ZBX_DB_OK != txn_error)
+		return FAIL;
+
+	if (1 != PQenterPipelineMode(conn))
+		return FAIL;
+
+	zbx_db_prepared_init();
+	db_pipeline = 1;
+
+	return SUCCEED;
+#else
+	return FAIL;
+#endif
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_db_pipeline_end                                              *
+ *                                                                            *
+ * Purpose: send queued statements and wait for their results                 *
+ *                                                                            *
+ * Return value: ZBX_DB_OK, ZBX_DB_FAIL or ZBX_DB_DOWN                        *
+ *                                                                            *
+ * Comments: After the first failed statement the rest of pipeline is         *
+ *           skipped by server and the transaction is marked as failed.       *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_db_pipeline_end(void)
+{
+#if defined(HAVE_POSTGRESQL) && defined(LIBPQ_HAS_PIPELINING)
+	PGresult	*result;
+	char		*error = NULL;
+	int		i, ret = ZBX_DB_OK;
+	double		sec = 0;
+
+	if (0 == db_pipeline)
+		return ZBX_DB_OK;
+
+	if (0 != CONFIG_LOG_SLOW_QUERIES)
+		sec = zbx_time();
+
+	if (1 != PQpipelineSync(conn))
+	{
+		zbx_db_errlog(ERR_Z3005, 0, PQerrorMessage(conn), "pipeline sync");
+		ret = (CONNECTION_OK == PQstatus(conn) ? ZBX_DB_FAIL : ZBX_DB_DOWN);
+		goto out;
+	}
+
+	/* every queued command returns its result followed by NULL, the sync point returns PGRES_PIPELINE_SYNC */
+	for (;;)
+	{
+		ExecStatusType	status;
+
+		if (NULL == (result = PQgetResult(conn)))
+		{
+			if (CONNECTION_OK == PQstatus(conn))
+				continue;
+
+			zbx_db_errlog(ERR_Z3005, 0, PQerrorMessage(conn), "pipeline results");
+			ret = ZBX_DB_DOWN;
+			break;
+		}
+
+		if (PGRES_PIPELINE_SYNC == (status = PQresultStatus(result)))
+		{
+			PQclear(result);
+			break;
+		}
+
+		/* commands following the failed one are reported as aborted */
+		if (PGRES_COMMAND_OK != status && PGRES_PIPELINE_ABORTED != status && ZBX_DB_OK == ret)
+		{
+			zbx_postgresql_error(&error, result);
+			zbx_db_errlog(ERR_Z3005, 0, error, "pipeline results");
+			zbx_free(error);
+
+			ret = (SUCCEED == is_recoverable_postgresql_error(conn, result) ? ZBX_DB_DOWN : ZBX_DB_FAIL);
+		}
+
+		PQclear(result);
+	}
+out:
+	if (CONNECTION_OK == PQstatus(conn))
+		PQexitPipelineMode(conn);
+
+	db_pipeline = 0;
+
+	/* statements prepared in failed pipeline might not exist on server */
+	if (ZBX_DB_OK != ret)
+	{
+		for (i = 0; i < db_pipeline_prepared.values_num; i++)
+		{
+			int	index;
+
+			if (FAIL != (index = zbx_vector_ptr_search(&db_prepared, db_pipeline_prepared.values[i],
+					ZBX_DEFAULT_PTR_COMPARE_FUNC)))
+			{
+				zbx_vector_ptr_remove_noorder(&db_prepared, index);
+			}
+
+			zbx_db_prepared_free((zbx_db_prepared_t *)db_pipeline_prepared.values[i]);
+		}
+	}
+
+	zbx_vector_ptr_clear(&db_pipeline_prepared);
+
+	if (0 != CONFIG_LOG_SLOW_QUERIES)
+	{
+		sec = zbx_time() - sec;
+		if (sec > (double)CONFIG_LOG_SLOW_QUERIES / 1000.0)
+			zabbix_log(LOG_LEVEL_WARNING, "slow query: " ZBX_FS_DBL " sec, \"pipeline sync\"", sec);
+	}
+
+	if (ZBX_DB_FAIL == ret && 0 < txn_level)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "pipeline failed, setting transaction as failed");
+		txn_error = ZBX_DB_FAIL;
+	}
+
+	return ret;
+#else
+	return ZBX_DB_OK;
+#endif
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: zbx_db_vselect                                                   *
@@ -37,19 +37,18 @@
 #include "zbxjson.h"
 #include "zbxhistory.h"
 
+/* the memory of the currently locked history cache shard, see hc_lock_shard() */
 static zbx_mem_info_t	*hc_index_mem = NULL;
 static zbx_mem_info_t	*hc_mem = NULL;
+/* the memory of the currently locked trend cache shard, see tc_lock_shard() */
 static zbx_mem_info_t	*trend_mem = NULL;
 
 #define	LOCK_CACHE	zbx_mutex_lock(cache_lock)
 #define	UNLOCK_CACHE	zbx_mutex_unlock(cache_lock)
-#define	LOCK_TRENDS	zbx_mutex_lock(trends_lock)
-#define	UNLOCK_TRENDS	zbx_mutex_unlock(trends_lock)
 #define	LOCK_CACHE_IDS		zbx_mutex_lock(cache_ids_lock)
 #define	UNLOCK_CACHE_IDS	zbx_mutex_unlock(cache_ids_lock)
 
 static zbx_mutex_t	cache_lock = ZBX_MUTEX_NULL;
-static zbx_mutex_t	trends_lock = ZBX_MUTEX_NULL;
 static zbx_mutex_t	cache_ids_lock = ZBX_MUTEX_NULL;
 
 static char		*sql = NULL;
@@ -98,15 +97,7 @@ static ZBX_DC_IDS	*ids = NULL;
 
 typedef struct
 {
-	zbx_hashset_t		trends;
-	ZBX_DC_STATS		stats;
-
-	zbx_hashset_t		history_items;
-	zbx_binary_heap_t	history_queue;
-
-	int			history_num;
 	int			trends_num;
-	int			trends_last_cleanup_hour;
 	int			history_num_total;
 	int			history_progress_ts;
 }
@@ -114,6 +105,60 @@ ZBX_DC_CACHE;
 
 static ZBX_DC_CACHE	*cache = NULL;
 
+/* History cache is split into shards by itemid. Each shard has its own lock, memory, */
+/* index and queue, so processes adding values and history syncers working with       */
+/* different shards do not wait for each other.                                       */
+#define ZBX_HC_SHARDS_MAX	ZBX_MUTEX_HISTORY_SHARDS
+
+/* the minimum history cache and history index cache size per shard */
+#define ZBX_HC_SHARD_SIZE_MIN	(128 * ZBX_KIBIBYTE)
+
+#define ZBX_HC_SHARD_INDEX(itemid)	((int)((itemid) % (zbx_uint64_t)CONFIG_HISTORY_CACHE_SHARDS))
+
+typedef struct
+{
+	zbx_oahashset_t		history_items;
+	zbx_binary_heap_t	history_queue;
+	ZBX_DC_STATS		stats;
+	int			history_num;
+}
+zbx_hc_shard_t;
+
+typedef struct
+{
+	zbx_hc_shard_t	*shard;
+	zbx_mem_info_t	*mem;
+	zbx_mem_info_t	*index_mem;
+	zbx_mutex_t	lock;
+}
+zbx_hc_shard_ref_t;
+
+static zbx_hc_shard_ref_t	hc_shards[ZBX_HC_SHARDS_MAX];
+
+/* the currently locked history cache shard */
+static zbx_hc_shard_t		*hc_shard = NULL;
+
+/* trend cache is split into the same number of shards by itemid */
+typedef struct
+{
+	zbx_hashset_t	trends;
+	int		trends_last_cleanup_hour;
+}
+zbx_tc_shard_t;
+
+typedef struct
+{
+	zbx_tc_shard_t	*shard;
+	zbx_mem_info_t	*mem;
+	zbx_mutex_t	lock;
+}
+zbx_tc_shard_ref_t;
+
+static zbx_tc_shard_ref_t	tc_shards[ZBX_HC_SHARDS_MAX];
+
+/* the currently locked trend cache shard */
+static zbx_tc_shard_t		*tc_shard = NULL;
+
 /* local history cache */
 #define ZBX_MAX_VALUES_LOCAL	256
 #define ZBX_STRUCT_REALLOC_STEP	8
@@ -157,7 +202,7 @@ static size_t		string_values_alloc = 0, string_values_offset = 0;
 static dc_item_value_t	*item_values = NULL;
 static size_t		item_values_alloc = 0, item_values_num = 0;
 
-static void	hc_add_item_values(dc_item_value_t *values, int values_num);
+static void	hc_add_item_values(dc_item_value_t *values, int values_num, int shard);
 static void	hc_pop_items(zbx_vector_ptr_t *history_items);
 static void	hc_get_item_values(ZBX_DC_HISTORY *history, zbx_vector_ptr_t *history_items);
 static void	hc_push_items(zbx_vector_ptr_t *history_items);
@@ -165,6 +210,12 @@ static void	hc_free_item_values(ZBX_DC_HISTORY *history, int history_num);
 static void	hc_queue_item(zbx_hc_item_t *item);
 static int	hc_queue_elem_compare_func(const void *d1, const void *d2);
 static int	hc_queue_get_size(void);
+static void	hc_lock_shard(int index);
+static void	hc_unlock_shard(int index);
+static void	hc_get_stats(zbx_wcache_info_t *wcache_info);
+static int	hc_get_history_num(void);
+static void	tc_lock_shard(int index);
+static void	tc_unlock_shard(int index);
 
 /******************************************************************************
  *                                                                            *
@@ -177,21 +228,20 @@ static int	hc_queue_get_size(void);
  ******************************************************************************/
 void	DCget_stats_all(zbx_wcache_info_t *wcache_info)
 {
-	LOCK_CACHE;
+	int	i;
 
-	wcache_info->stats = cache->stats;
-	wcache_info->history_free = hc_mem->free_size;
-	wcache_info->history_total = hc_mem->total_size;
-	wcache_info->index_free = hc_index_mem->free_size;
-	wcache_info->index_total = hc_index_mem->total_size;
+	hc_get_stats(wcache_info);
 
 	if (0 != (program_type & ZBX_PROGRAM_TYPE_SERVER))
 	{
-		wcache_info->trend_free = trend_mem->free_size;
-		wcache_info->trend_total = trend_mem->orig_size;
+		for (i = 0; i < CONFIG_HISTORY_CACHE_SHARDS; i++)
+		{
+			tc_lock_shard(i);
+			wcache_info->trend_free += trend_mem->free_size;
+			wcache_info->trend_total += trend_mem->orig_size;
+			tc_unlock_shard(i);
+		}
 	}
-
-	UNLOCK_CACHE;
 }
 
 
@@ -212,144 +262,157 @@ void *DCget_stats(int request)
 
 	// 定义返回值指针
 	void *ret;
+	zbx_wcache_info_t	wcache_info;
 
-	// 加锁保护数据缓存
-	LOCK_CACHE;
+	// 只有趋势缓存指标需要锁定趋势分片，其余指标只读取历史缓存分片
+	switch (request)
+	{
+		case ZBX_STATS_TREND_TOTAL:
+		case ZBX_STATS_TREND_USED:
+		case ZBX_STATS_TREND_FREE:
+		case ZBX_STATS_TREND_PUSED:
+		case ZBX_STATS_TREND_PFREE:
+			DCget_stats_all(&wcache_info);
+			break;
+		default:
+			hc_get_stats(&wcache_info);
+	}
 
 	// 根据请求类型切换执行不同操作
 	switch (request)
 	{
 		// 获取历史计数器
 		case ZBX_STATS_HISTORY_COUNTER:
-			value_uint = cache->stats.history_counter;
+			value_uint = wcache_info.stats.history_counter;
 			ret = (void *)&value_uint;
 			break;
 
 		// 获取历史浮点计数器
 		case ZBX_STATS_HISTORY_FLOAT_COUNTER:
-			value_uint = cache->stats.history_float_counter;
+			value_uint = wcache_info.stats.history_float_counter;
 			ret = (void *)&value_uint;
 			break;
 
 		// 获取历史无符号整数计数器
 		case ZBX_STATS_HISTORY_UINT_COUNTER:
-			value_uint = cache->stats.history_uint_counter;
+			value_uint = wcache_info.stats.history_uint_counter;
 			ret = (void *)&value_uint;
 			break;
 
 		// 获取历史字符串计数器
 		case ZBX_STATS_HISTORY_STR_COUNTER:
-			value_uint = cache->stats.history_str_counter;
+			value_uint = wcache_info.stats.history_str_counter;
 			ret = (void *)&value_uint;
 			break;
 
 		// 获取历史日志计数器
 		case ZBX_STATS_HISTORY_LOG_COUNTER:
-			value_uint = cache->stats.history_log_counter;
+			value_uint = wcache_info.stats.history_log_counter;
 			ret = (void *)&value_uint;
 			break;
 
 		// 获取历史文本计数器
 		case ZBX_STATS_HISTORY_TEXT_COUNTER:
-			value_uint = cache->stats.history_text_counter;
+			value_uint = wcache_info.stats.history_text_counter;
 			ret = (void *)&value_uint;
 			break;
 
 		// 获取不被支持的计数器
 		case ZBX_STATS_NOTSUPPORTED_COUNTER:
-			value_uint = cache->stats.notsupported_counter;
+			value_uint = wcache_info.stats.notsupported_counter;
 			ret = (void *)&value_uint;
 			break;
 
 		// 获取历史总和
 		case ZBX_STATS_HISTORY_TOTAL:
-			value_uint = hc_mem->total_size;
+			value_uint = wcache_info.history_total;
 			ret = (void *)&value_uint;
 			break;
 
 		// 获取历史已使用内存
 		case ZBX_STATS_HISTORY_USED:
-			value_uint = hc_mem->total_size - hc_mem->free_size;
+			value_uint = wcache_info.history_total - wcache_info.history_free;
 			ret = (void *)&value_uint;
 			break;
 
 		// 获取历史免费内存
 		case ZBX_STATS_HISTORY_FREE:
-			value_uint = hc_mem->free_size;
+			value_uint = wcache_info.history_free;
 			ret = (void *)&value_uint;
 			break;
 
 		// 获取历史占用内存百分比
 		case ZBX_STATS_HISTORY_PUSED:
-			value_double = 100 * (double)(hc_mem->total_size - hc_mem->free_size) / hc_mem->total_size;
+			value_double = 100 * (double)(wcache_info.history_total - wcache_info.history_free) /
+					wcache_info.history_total;
 			ret = (void *)&value_double;
 			break;
 
 		// 获取历史免费内存百分比
 		case ZBX_STATS_HISTORY_PFREE:
-			value_double = 100 * (double)hc_mem->free_size / hc_mem->total_size;
+			value_double = 100 * (double)wcache_info.history_free / wcache_info.history_total;
 			ret = (void *)&value_double;
 			break;
 
 		// 获取趋势内存总和
 		case ZBX_STATS_TREND_TOTAL:
-			value_uint = trend_mem->orig_size;
+			value_uint = wcache_info.trend_total;
 			ret = (void *)&value_uint;
 			break;
 
 		// 获取趋势内存已使用
 		case ZBX_STATS_TREND_USED:
-			value_uint = trend_mem->orig_size - trend_mem->free_size;
+			value_uint = wcache_info.trend_total - wcache_info.trend_free;
 			ret = (void *)&value_uint;
 			break;
 
 		// 获取趋势内存免费
 		case ZBX_STATS_TREND_FREE:
-			value_uint = trend_mem->free_size;
+			value_uint = wcache_info.trend_free;
 			ret = (void *)&value_uint;
 			break;
 
 		// 获取趋势内存占用百分比
 		case ZBX_STATS_TREND_PUSED:
-			value_double = 100 * (double)(trend_mem->orig_size - trend_mem->free_size) /
-					trend_mem->orig_size;
+			value_double = 100 * (double)(wcache_info.trend_total - wcache_info.trend_free) /
+					wcache_info.trend_total;
 			ret = (void *)&value_double;
 			break;
 
 		// 获取趋势内存免费百分比
 		case ZBX_STATS_TREND_PFREE:
-			value_double = 100 * (double)trend_mem->free_size / trend_mem->orig_size;
+			value_double = 100 * (double)wcache_info.trend_free / wcache_info.trend_total;
 			ret = (void *)&value_double;
 			break;
 
 		// 获取历史索引内存总和
 		case ZBX_STATS_HISTORY_INDEX_TOTAL:
-			value_uint = hc_index_mem->total_size;
+			value_uint = wcache_info.index_total;
 			ret = (void *)&value_uint;
 			break;
 
 		// 获取历史索引内存已使用
 		case ZBX_STATS_HISTORY_INDEX_USED:
-			value_uint = hc_index_mem->total_size - hc_index_mem->free_size;
+			value_uint = wcache_info.index_total - wcache_info.index_free;
 			ret = (void *)&value_uint;
 			break;
 
 		// 获取历史索引内存免费
 		case ZBX_STATS_HISTORY_INDEX_FREE:
-			value_uint = hc_index_mem->free_size;
+			value_uint = wcache_info.index_free;
 			ret = (void *)&value_uint;
 			break;
 
 		// 获取历史索引内存占用百分比
 		case ZBX_STATS_HISTORY_INDEX_PUSED:
-			value_double = 100 * (double)(hc_index_mem->total_size - hc_index_mem->free_size) /
-					hc_index_mem->total_size;
+			value_double = 100 * (double)(wcache_info.index_total - wcache_info.index_free) /
+					wcache_info.index_total;
 			ret = (void *)&value_double;
 			break;
 
 		// 获取历史索引内存免费百分比
 		case ZBX_STATS_HISTORY_INDEX_PFREE:
-			value_double = 100 * (double)hc_index_mem->free_size / hc_index_mem->total_size;
+			value_double = 100 * (double)wcache_info.index_free / wcache_info.index_total;
 			ret = (void *)&value_double;
 			break;
 
@@ -358,9 +421,6 @@ void *DCget_stats(int request)
 			ret = NULL;
 	}
 
-	// 释放锁保护数据缓存
-	UNLOCK_CACHE;
-
 	// 返回获取到的数据指针
 	return ret;
 }
@@ -388,7 +448,7 @@ static ZBX_DC_TREND *DCget_trend(zbx_uint64_t itemid)
     ZBX_DC_TREND	*ptr, trend;
 
     // 检查缓存中的趋势列表是否有与传入的itemid匹配的项
-    if (NULL != (ptr = (ZBX_DC_TREND *)zbx_hashset_search(&cache->trends, &itemid)))
+    if (NULL != (ptr = (ZBX_DC_TREND *)zbx_hashset_search(&tc_shard->trends, &itemid)))
         // 如果有匹配的项，直接返回该项的指针
         return ptr;
 
@@ -397,7 +457,7 @@ static ZBX_DC_TREND *DCget_trend(zbx_uint64_t itemid)
     // 设置trend结构的itemid为传入的itemid
     trend.itemid = itemid;
 
-	return (ZBX_DC_TREND *)zbx_hashset_insert(&cache->trends, &trend, sizeof(ZBX_DC_TREND));
+	return (ZBX_DC_TREND *)zbx_hashset_insert(&tc_shard->trends, &trend, sizeof(ZBX_DC_TREND));
 }
 
 /******************************************************************************
@@ -418,25 +478,41 @@ static void DCupdate_trends(zbx_vector_uint64_pair_t *trends_diff)
 	/* 定义一个字符串指针 __function_name，用于存储函数名。
        这里使用它来记录日志，方便调试。 */
 	const char *__function_name = "DCupdate_trends";
-	/* 定义一个整型变量 i，用于循环计数。 */
-	int i;
+	/* 定义整型变量 i 和 shard，用于循环计数。 */
+	int i, shard;
 
 	/* 使用 zabbix_log 记录日志，表示进入 DCupdate_trends 函数。
        这里的 LOG_LEVEL_DEBUG 表示记录调试级别的日志。 */
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
 
-	/* 使用 LOCK_TRENDS 函数对趋势数据进行加锁，防止多线程并发修改数据。 */
-	LOCK_TRENDS;
-
-	for (i = 0; i < trends_diff->values_num; i++)
+	/* 按分片处理，只锁定包含待更新趋势的分片，防止多进程并发修改数据。 */
+	for (shard = 0; shard < CONFIG_HISTORY_CACHE_SHARDS; shard++)
 	{
-		ZBX_DC_TREND	*trend;
+		int	locked = FAIL;
 
-		if (NULL != (trend = (ZBX_DC_TREND *)zbx_hashset_search(&cache->trends, &trends_diff->values[i].first)))
-			trend->disable_from = trends_diff->values[i].second;
-	}
+		for (i = 0; i < trends_diff->values_num; i++)
+		{
+			ZBX_DC_TREND	*trend;
 
-	UNLOCK_TRENDS;
+			if (shard != ZBX_HC_SHARD_INDEX(trends_diff->values[i].first))
+				continue;
+
+			if (FAIL == locked)
+			{
+				tc_lock_shard(shard);
+				locked = SUCCEED;
+			}
+
+			if (NULL != (trend = (ZBX_DC_TREND *)zbx_hashset_search(&tc_shard->trends,
+					&trends_diff->values[i].first)))
+			{
+				trend->disable_from = trends_diff->values[i].second;
+			}
+		}
+
+		if (SUCCEED == locked)
+			tc_unlock_shard(shard);
+	}
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __function_name);
 }
@@ -475,6 +551,9 @@ static void dc_insert_trends_in_db(ZBX_DC_TREND *trends, int trends_num, unsigne
     zbx_db_insert_prepare(&db_insert, table_name, "itemid", "clock", "num", "value_min", "value_avg",
                          "value_max", NULL);
 
+	if (0 != CONFIG_DB_COPY_HISTORY)
+		zbx_db_insert_use_copy(&db_insert);
+
     // 遍历趋势数据
     for (i = 0; i < trends_num; i++)
     {
@@ -772,6 +851,150 @@ static void	dc_trends_fetch_and_update(ZBX_DC_TREND *trends, int trends_num, zbx
 		DBexecute("%s", sql);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: dc_trends_upsert_execute                                         *
+ *                                                                            *
+ * Purpose: helper function for dc_upsert_trends_in_db, adds the clause       *
+ *          merging inserted trend with existing one and executes the query   *
+ *                                                                            *
+ ******************************************************************************/
+static void	dc_trends_upsert_execute(unsigned char value_type, size_t *sql_offset)
+{
+#if defined(HAVE_MYSQL)
+	/* assignments are done from left to right, so num must be updated last */
+	zbx_strcpy_alloc(&sql, &sql_alloc, sql_offset, " on duplicate key update"
+			" value_min=least(value_min,values(value_min)),"
+			"value_max=greatest(value_max,values(value_max)),");
+
+	if (ITEM_VALUE_TYPE_FLOAT == value_type)
+	{
+		zbx_strcpy_alloc(&sql, &sql_alloc, sql_offset,
+				"value_avg=(value_avg*num+values(value_avg)*values(num))/(num+values(num)),");
+	}
+	else
+	{
+		zbx_strcpy_alloc(&sql, &sql_alloc, sql_offset,
+				"value_avg=truncate((cast(value_avg as decimal(20))*num+"
+				"cast(values(value_avg) as decimal(20))*values(num))/(num+values(num)),0),");
+	}
+
+	zbx_strcpy_alloc(&sql, &sql_alloc, sql_offset, "num=num+values(num)");
+#elif defined(HAVE_POSTGRESQL)
+	zbx_strcpy_alloc(&sql, &sql_alloc, sql_offset, " on conflict (itemid,clock) do update set"
+			" num=t.num+excluded.num,"
+			"value_min=least(t.value_min,excluded.value_min),"
+			"value_max=greatest(t.value_max,excluded.value_max),");
+
+	if (ITEM_VALUE_TYPE_FLOAT == value_type)
+	{
+		zbx_strcpy_alloc(&sql, &sql_alloc, sql_offset,
+				"value_avg=(t.value_avg*t.num+excluded.value_avg*excluded.num)/(t.num+excluded.num)");
+	}
+	else
+	{
+		zbx_strcpy_alloc(&sql, &sql_alloc, sql_offset,
+				"value_avg=trunc((t.value_avg*t.num+excluded.value_avg*excluded.num)/"
+				"(t.num+excluded.num))");
+	}
+#else
+	ZBX_UNUSED(value_type);
+#endif
+	DBexecute("%s", sql);
+
+	*sql_offset = 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: dc_upsert_trends_in_db                                           *
+ *                                                                            *
+ * Purpose: helper function for DBflush_trends, inserts trends merging them   *
+ *          with the existing trends in one query                             *
+ *                                                                            *
+ * Comments: The same trend cannot be merged twice by one query, so repeated  *
+ *           trends are left in the array for the next DBflush_trends() call. *
+ *                                                                            *
+ ******************************************************************************/
+/******************************************************************************
+ * *
+ *使用 INSERT ... ON CONFLICT / ON DUPLICATE KEY UPDATE 语句写入趋势数据，数据库
+ *自动与已存在的趋势合并，不再需要先查询再更新。重复的趋势留给下一次调用处理。
+ ******************************************************************************/
+static void	dc_upsert_trends_in_db(ZBX_DC_TREND *trends, int trends_num, unsigned char value_type,
+		const char *table_name, int clock)
+{
+	const char	*__function_name = "dc_upsert_trends_in_db";
+	ZBX_DC_TREND	*trend;
+	zbx_hashset_t	itemids;
+	size_t		sql_offset = 0;
+	int		i, rows_num = 0;
+	zbx_uint128_t	avg;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() trends_num:%d", __function_name, trends_num);
+
+	zbx_hashset_create(&itemids, (size_t)MIN(ZBX_HC_SYNC_MAX, trends_num), ZBX_DEFAULT_UINT64_HASH_FUNC,
+			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	for (i = 0; i < trends_num; i++)
+	{
+		trend = &trends[i];
+
+		if (0 == trend->itemid || clock != trend->clock || value_type != trend->value_type)
+			continue;
+
+		if (NULL != zbx_hashset_search(&itemids, &trend->itemid))
+			continue;
+
+		zbx_hashset_insert(&itemids, &trend->itemid, sizeof(trend->itemid));
+
+		if (0 == rows_num)
+		{
+			zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
+#if defined(HAVE_POSTGRESQL)
+					"insert into %s as t"
+#else
+					"insert into %s"
+#endif
+					" (itemid,clock,num,value_min,value_avg,value_max) values ", table_name);
+		}
+		else
+			zbx_chrcpy_alloc(&sql, &sql_alloc, &sql_offset, ',');
+
+		if (ITEM_VALUE_TYPE_FLOAT == value_type)
+		{
+			zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
+					"(" ZBX_FS_UI64 ",%d,%d," ZBX_FS_DBL "," ZBX_FS_DBL "," ZBX_FS_DBL ")",
+					trend->itemid, trend->clock, trend->num, trend->value_min.dbl,
+					trend->value_avg.dbl, trend->value_max.dbl);
+		}
+		else
+		{
+			udiv128_64(&avg, &trend->value_avg.ui64, trend->num);
+
+			zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
+					"(" ZBX_FS_UI64 ",%d,%d," ZBX_FS_UI64 "," ZBX_FS_UI64 "," ZBX_FS_UI64 ")",
+					trend->itemid, trend->clock, trend->num, trend->value_min.ui64, avg.lo,
+					trend->value_max.ui64);
+		}
+
+		trend->itemid = 0;
+
+		if (ZBX_HC_SYNC_MAX == ++rows_num)
+		{
+			dc_trends_upsert_execute(value_type, &sql_offset);
+			rows_num = 0;
+		}
+	}
+
+	if (0 != rows_num)
+		dc_trends_upsert_execute(value_type, &sql_offset);
+
+	zbx_hashset_destroy(&itemids);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __function_name);
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: DBflush_trends                                                   *
@@ -807,6 +1030,13 @@ static void	DBflush_trends(ZBX_DC_TREND *trends, int *trends_num, zbx_vector_uin
 			assert(0);
 	}
 
+	/* existing trends are updated by the database itself, no need to select them */
+	if (SUCCEED == zbx_db_upsert_supported())
+	{
+		dc_upsert_trends_in_db(trends, *trends_num, value_type, table_name, clock);
+		goto clean;
+	}
+
 	itemids_alloc = MIN(ZBX_HC_SYNC_MAX, *trends_num);
 	itemids = (zbx_uint64_t *)zbx_malloc(itemids, itemids_alloc * sizeof(zbx_uint64_t));
 
@@ -884,6 +1114,7 @@ static void	DBflush_trends(ZBX_DC_TREND *trends, int *trends_num, zbx_vector_uin
 	if (0 != inserts_num)
 		dc_insert_trends_in_db(trends, trends_to, value_type, table_name, clock);
 
+clean:
 	/* clean trends */
 	for (i = 0, num = 0; i < *trends_num; i++)
 	{
@@ -1026,7 +1257,7 @@ static void	DCmass_update_trends(const ZBX_DC_HISTORY *history, int history_num,
     zbx_timespec_t ts;
 
     // 定义一个整型变量，用于记录趋势分配的大小
-	int		trends_alloc = 0, i, hour, seconds;
+	int		trends_alloc = 0, i, hour, seconds, shard, values_num[ZBX_HC_SHARDS_MAX] = {0};
 
 
     // 记录日志，表示函数开始执行
@@ -1039,48 +1270,62 @@ static void	DCmass_update_trends(const ZBX_DC_HISTORY *history, int history_num,
     seconds = ts.sec % SEC_PER_HOUR;
     hour = ts.sec - seconds;
 
-    // 加锁，确保趋势更新过程顺利进行
-    LOCK_TRENDS;
+	// 统计每个分片需要生成趋势的历史数据数量
+	for (i = 0; i < history_num; i++)
+	{
+		if (0 == (ZBX_DC_FLAGS_NOT_FOR_TRENDS & history[i].flags))
+			values_num[ZBX_HC_SHARD_INDEX(history[i].itemid)]++;
+	}
 
-    // 遍历历史数据
-    for (i = 0; i < history_num; i++)
-    {
-        // 指向历史数据的指针
-        const ZBX_DC_HISTORY *h = &history[i];
+	for (shard = 0; shard < CONFIG_HISTORY_CACHE_SHARDS; shard++)
+	{
+		// 分片没有新数据且还未到清理时间时跳过，避免不必要的加锁；
+		// 上次清理的小时数只在加锁后读取
+		if (0 == values_num[shard] && ZBX_TRENDS_CLEANUP_TIME >= seconds)
+			continue;
 
-        // 如果历史数据不适合生成趋势，跳过本次循环
-        if (0 != (ZBX_DC_FLAGS_NOT_FOR_TRENDS & h->flags))
-            continue;
+		// 加锁，确保趋势更新过程顺利进行
+		tc_lock_shard(shard);
 
-        // 为历史数据添加趋势
-        DCadd_trend(h, trends, &trends_alloc, trends_num);
-    }
+		// 遍历属于该分片的历史数据并添加趋势
+		for (i = 0; 0 != values_num[shard] && i < history_num; i++)
+		{
+			const ZBX_DC_HISTORY	*h = &history[i];
 
-    // 如果缓存中的趋势上次清理的时间小于当前小时且当前秒数小于ZBX_TRENDS_CLEANUP_TIME
-    if (cache->trends_last_cleanup_hour < hour && ZBX_TRENDS_CLEANUP_TIME < seconds)
-    {
-        // 初始化一个哈希表迭代器
-		zbx_hashset_iter_t	iter;
-		ZBX_DC_TREND		*trend;
-        // 重置哈希表迭代器
-        zbx_hashset_iter_reset(&cache->trends, &iter);
+			if (0 != (ZBX_DC_FLAGS_NOT_FOR_TRENDS & h->flags))
+				continue;
 
-		while (NULL != (trend = (ZBX_DC_TREND *)zbx_hashset_iter_next(&iter)))
-		{
-			if (trend->clock == hour)
+			if (shard != ZBX_HC_SHARD_INDEX(h->itemid))
 				continue;
 
-			if (SUCCEED == zbx_history_requires_trends(trend->value_type))
-				DCflush_trend(trend, trends, &trends_alloc, trends_num);
+			DCadd_trend(h, trends, &trends_alloc, trends_num);
+		}
 
-			zbx_hashset_iter_remove(&iter);
+		// 清理分片中上一个小时及更早的趋势
+		if (tc_shard->trends_last_cleanup_hour < hour && ZBX_TRENDS_CLEANUP_TIME < seconds)
+		{
+			zbx_hashset_iter_t	iter;
+			ZBX_DC_TREND		*trend;
+
+			zbx_hashset_iter_reset(&tc_shard->trends, &iter);
+
+			while (NULL != (trend = (ZBX_DC_TREND *)zbx_hashset_iter_next(&iter)))
+			{
+				if (trend->clock == hour)
+					continue;
+
+				if (SUCCEED == zbx_history_requires_trends(trend->value_type))
+					DCflush_trend(trend, trends, &trends_alloc, trends_num);
+
+				zbx_hashset_iter_remove(&iter);
+			}
+
+			tc_shard->trends_last_cleanup_hour = hour;
 		}
 
-		cache->trends_last_cleanup_hour = hour;
+		tc_unlock_shard(shard);
 	}
 
-	UNLOCK_TRENDS;
-
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __function_name);
 }
 
@@ -1819,23 +2064,26 @@ static void DCsync_trends(void)
     // 定义一个指向ZBX_DC_TREND结构的指针
     ZBX_DC_TREND *trends = NULL, *trend;
     // 定义两个整数变量，分别用于记录趋势数据的长度和分配长度
-    int trends_alloc = 0, trends_num = 0;
+    int trends_alloc = 0, trends_num = 0, i;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() trends_num:%d", __function_name, cache->trends_num);
 
 	zabbix_log(LOG_LEVEL_WARNING, "syncing trend data...");
 
-	LOCK_TRENDS;
+	for (i = 0; i < CONFIG_HISTORY_CACHE_SHARDS; i++)
+	{
+		tc_lock_shard(i);
 
-	zbx_hashset_iter_reset(&cache->trends, &iter);
+		zbx_hashset_iter_reset(&tc_shard->trends, &iter);
 
-	while (NULL != (trend = (ZBX_DC_TREND *)zbx_hashset_iter_next(&iter)))
-	{
-		if (SUCCEED == zbx_history_requires_trends(trend->value_type))
-			DCflush_trend(trend, &trends, &trends_alloc, &trends_num);
-	}
+		while (NULL != (trend = (ZBX_DC_TREND *)zbx_hashset_iter_next(&iter)))
+		{
+			if (SUCCEED == zbx_history_requires_trends(trend->value_type))
+				DCflush_trend(trend, &trends, &trends_alloc, &trends_num);
+		}
 
-	UNLOCK_TRENDS;
+		tc_unlock_shard(i);
+	}
 
 	if (SUCCEED == zbx_is_export_enabled() && 0 != trends_num)
 		DCexport_all_trends(trends, trends_num);
@@ -2542,6 +2790,82 @@ static void db_save_item_changes(size_t *sql_offset, const zbx_vector_ptr_t *ite
 	}
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: db_save_item_changes_prepared                                    *
+ *                                                                            *
+ * Purpose: save item state, error, mtime, lastlogsize changes to             *
+ *          database using prepared statements                                *
+ *                                                                            *
+ * Comments: There are only few distinct statements depending on the set of   *
+ *           changed fields, so they are prepared once per connection and     *
+ *           then executed with the item values as parameters.                *
+ *                                                                            *
+ ******************************************************************************/
+static void	db_save_item_changes_prepared(const zbx_vector_ptr_t *item_diff)
+{
+	int			i, values_num;
+	const zbx_item_diff_t	*diff;
+	char			*stmt = NULL, *error = NULL;
+	size_t			stmt_alloc = 0, stmt_offset;
+	unsigned char		types[5];
+	zbx_db_value_t		values[5];
+
+	for (i = 0; i < item_diff->values_num; i++)
+	{
+		diff = (const zbx_item_diff_t *)item_diff->values[i];
+
+		if (0 == (ZBX_FLAGS_ITEM_DIFF_UPDATE_DB & diff->flags))
+			continue;
+
+		stmt_offset = 0;
+		values_num = 0;
+		zbx_strcpy_alloc(&stmt, &stmt_alloc, &stmt_offset, "update items set ");
+
+		if (0 != (ZBX_FLAGS_ITEM_DIFF_UPDATE_LASTLOGSIZE & diff->flags))
+		{
+			zbx_strcpy_alloc(&stmt, &stmt_alloc, &stmt_offset, "lastlogsize=?,");
+			types[values_num] = ZBX_TYPE_UINT;
+			values[values_num++].ui64 = diff->lastlogsize;
+		}
+
+		if (0 != (ZBX_FLAGS_ITEM_DIFF_UPDATE_MTIME & diff->flags))
+		{
+			zbx_strcpy_alloc(&stmt, &stmt_alloc, &stmt_offset, "mtime=?,");
+			types[values_num] = ZBX_TYPE_INT;
+			values[values_num++].i32 = diff->mtime;
+		}
+
+		if (0 != (ZBX_FLAGS_ITEM_DIFF_UPDATE_STATE & diff->flags))
+		{
+			zbx_strcpy_alloc(&stmt, &stmt_alloc, &stmt_offset, "state=?,");
+			types[values_num] = ZBX_TYPE_INT;
+			values[values_num++].i32 = (int)diff->state;
+		}
+
+		if (0 != (ZBX_FLAGS_ITEM_DIFF_UPDATE_ERROR & diff->flags))
+		{
+			/* bound values are not truncated by DBdyn_escape_field(), cut error to the field length */
+			error = zbx_strdup(error, diff->error);
+			error[zbx_db_strlen_n(error, ITEM_ERROR_LEN)] = '\0';
+
+			zbx_strcpy_alloc(&stmt, &stmt_alloc, &stmt_offset, "error=?,");
+			types[values_num] = ZBX_TYPE_CHAR;
+			values[values_num++].str = error;
+		}
+
+		stmt_offset--;
+		zbx_strcpy_alloc(&stmt, &stmt_alloc, &stmt_offset, " where itemid=?");
+		types[values_num] = ZBX_TYPE_ID;
+		values[values_num++].ui64 = diff->itemid;
+
+		DBexecute_prepared(stmt, types, values, values_num);
+	}
+
+	zbx_free(error);
+	zbx_free(stmt);
+}
+
 /******************************************************************************
  * *
  *整个代码块的主要目的是更新数据库中的items，根据传入的history数组中的信息。具体操作包括：
@@ -2560,7 +2884,7 @@ static void	DBmass_update_items(const zbx_vector_ptr_t *item_diff, const zbx_vec
 	const char	*__function_name = "DBmass_update_items";
 
 	size_t		sql_offset = 0;
-	int		i;
+	int		i, pipeline = FAIL;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
 
@@ -2575,32 +2899,31 @@ static void	DBmass_update_items(const zbx_vector_ptr_t *item_diff, const zbx_vec
 
 	if (i != item_diff->values_num || 0 != inventory_values->values_num)
 	{
-        // 开始执行多个SQL更新操作
-        DBbegin_multiple_update(&sql, &sql_alloc, &sql_offset);
+		if (i != item_diff->values_num && 0 != CONFIG_DB_PREPARED_STATEMENTS &&
+				SUCCEED == (pipeline = DBpipeline_begin()))
+		{
+			db_save_item_changes_prepared(item_diff);
+			DBpipeline_end();
+		}
 
-        // 如果item_diff vector不为空，则保存物品更改到数据库
-        if (i != item_diff->values_num)
-            db_save_item_changes(&sql_offset, item_diff);
+		DBbegin_multiple_update(&sql, &sql_alloc, &sql_offset);
 
-        // 如果inventory_values vector不为空，则执行库存值更新操作
-        if (0 != inventory_values->values_num)
-            DCadd_update_inventory_sql(&sql_offset, inventory_values);
+		if (i != item_diff->values_num && SUCCEED != pipeline)
+			db_save_item_changes(&sql_offset, item_diff);
 
-        // 结束多个SQL更新操作
-        DBend_multiple_update(&sql, &sql_alloc, &sql_offset);
+		if (0 != inventory_values->values_num)
+			DCadd_update_inventory_sql(&sql_offset, inventory_values);
 
-        // 如果sql_offset大于16，表示需要执行多条SQL语句，则执行第一条SQL语句
-        if (sql_offset > 16)
-            DBexecute("%s", sql);
+		DBend_multiple_update(&sql, &sql_alloc, &sql_offset);
 
-        // 更新库存值到数据库配置
-        DCconfig_update_inventory_values(inventory_values);
-    }
+		if (sql_offset > 16)	/* In ORACLE always present begin..end; */
+			DBexecute("%s", sql);
 
-    // 记录日志，表示结束该函数
-    zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __function_name);
-}
+		DCconfig_update_inventory_values(inventory_values);
+	}
 
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __function_name);
+}
 
 /******************************************************************************
  *                                                                            *
@@ -3488,16 +3811,10 @@ static void sync_proxy_history(int *total_num, int *more)
 	{
 		*more = ZBX_SYNC_DONE;
 
-		// 锁定缓存
-		LOCK_CACHE;
-
 		// 从历史缓存中取出物品
 		hc_pop_items(&history_items);		/* select and take items out of history cache */
 		history_num = history_items.values_num;
 
-		// 解锁缓存
-		UNLOCK_CACHE;
-
 		// 如果历史记录数为0，跳出循环
 		if (0 == history_num)
 			break;
@@ -3517,20 +3834,13 @@ static void sync_proxy_history(int *total_num, int *more)
 			DCmass_proxy_update_items(history, history_num);
 		}
 		while (ZBX_DB_DOWN == DBcommit());
-		// 锁定缓存
-		LOCK_CACHE;
-
 		// 将处理过的物品放回历史缓存
 		hc_push_items(&history_items);	/* return items to history cache */
-		cache->history_num -= history_num;
 
 		// 如果还有未处理的历史记录，设置 more 为 ZBX_SYNC_MORE
 		if (0 != hc_queue_get_size())
 			*more = ZBX_SYNC_MORE;
 
-		// 解锁缓存
-		UNLOCK_CACHE;
-
 		// 累加处理的历史记录数量
 		*total_num += history_num;
 
@@ -3659,17 +3969,13 @@ static void	sync_server_history(int *values_num, int *triggers_num, int *more)
 
 		*more = ZBX_SYNC_DONE;
 
-		LOCK_CACHE;
 		hc_pop_items(&history_items);		/* select and take items out of history cache */
-		UNLOCK_CACHE;
 
 		if (0 != history_items.values_num)
 		{
 			if (0 == (history_num = DCconfig_lock_triggers_by_history_items(&history_items, &triggerids)))
 			{
-				LOCK_CACHE;
 				hc_push_items(&history_items);
-				UNLOCK_CACHE;
 				zbx_vector_ptr_clear(&history_items);
 			}
 		}
@@ -3777,9 +4083,7 @@ static void	sync_server_history(int *values_num, int *triggers_num, int *more)
 
 		if (0 != history_num)
 		{
-			LOCK_CACHE;
 			hc_push_items(&history_items);	/* return items to history cache */
-			cache->history_num -= history_num;
 
 			if (0 != hc_queue_get_size())
 			{
@@ -3792,8 +4096,6 @@ static void	sync_server_history(int *values_num, int *triggers_num, int *more)
 					*more = ZBX_SYNC_MORE;
 			}
 
-			UNLOCK_CACHE;
-
 			*values_num += history_num;
 		}
 
@@ -3869,12 +4171,12 @@ static void	sync_history_cache_full(void)
 {
 	const char		*__function_name = "sync_history_cache_full";
 
-	int			values_num = 0, triggers_num = 0, more;
-	zbx_hashset_iter_t	iter;
+	int			values_num = 0, triggers_num = 0, more, i;
+	zbx_oahashset_iter_t	iter;
 	zbx_hc_item_t		*item;
-	zbx_binary_heap_t	tmp_history_queue;
+	zbx_binary_heap_t	tmp_history_queue[ZBX_HC_SHARDS_MAX];
 
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s() history_num:%d", __function_name, cache->history_num);
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() history_num:%d", __function_name, hc_get_history_num());
 
 	/* History index cache might be full without any space left for queueing items from history index to  */
 	/* history queue. The solution: replace the shared-memory history queue with heap-allocated one. Add  */
@@ -3896,19 +4198,27 @@ static void	sync_history_cache_full(void)
 		zbx_dc_clear_timer_queue();
 	}
 
-	tmp_history_queue = cache->history_queue;
+	for (i = 0; i < CONFIG_HISTORY_CACHE_SHARDS; i++)
+	{
+		hc_lock_shard(i);
+
+		tmp_history_queue[i] = hc_shard->history_queue;
 
-	zbx_binary_heap_create(&cache->history_queue, hc_queue_elem_compare_func, ZBX_BINARY_HEAP_OPTION_EMPTY);
-	zbx_hashset_iter_reset(&cache->history_items, &iter);
+		zbx_binary_heap_create(&hc_shard->history_queue, hc_queue_elem_compare_func,
+				ZBX_BINARY_HEAP_OPTION_EMPTY);
+		zbx_oahashset_iter_reset(&hc_shard->history_items, &iter);
 
-	/* add all items from history index to the new history queue */
-	while (NULL != (item = (zbx_hc_item_t *)zbx_hashset_iter_next(&iter)))
-	{
-		if (NULL != item->tail)
+		/* add all items from history index to the new history queue */
+		while (NULL != (item = (zbx_hc_item_t *)zbx_oahashset_iter_next(&iter)))
 		{
-			item->status = ZBX_HC_ITEM_STATUS_NORMAL;
-			hc_queue_item(item);
+			if (NULL != item->tail)
+			{
+				item->status = ZBX_HC_ITEM_STATUS_NORMAL;
+				hc_queue_item(item);
+			}
 		}
+
+		hc_unlock_shard(i);
 	}
 
 	if (0 != hc_queue_get_size())
@@ -3923,15 +4233,20 @@ static void	sync_history_cache_full(void)
 				sync_proxy_history(&values_num, &more);
 
 			zabbix_log(LOG_LEVEL_WARNING, "syncing history data... " ZBX_FS_DBL "%%",
-					(double)values_num / (cache->history_num + values_num) * 100);
+					(double)values_num / (hc_get_history_num() + values_num) * 100);
 		}
 		while (0 != hc_queue_get_size());
 
 		zabbix_log(LOG_LEVEL_WARNING, "syncing history data done");
 	}
 
-	zbx_binary_heap_destroy(&cache->history_queue);
-	cache->history_queue = tmp_history_queue;
+	for (i = 0; i < CONFIG_HISTORY_CACHE_SHARDS; i++)
+	{
+		hc_lock_shard(i);
+		zbx_binary_heap_destroy(&hc_shard->history_queue);
+		hc_shard->history_queue = tmp_history_queue[i];
+		hc_unlock_shard(i);
+	}
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __function_name);
 }
@@ -3946,7 +4261,9 @@ static void	sync_history_cache_full(void)
 void	zbx_log_sync_history_cache_progress(void)
 {
 	double		pcnt = -1.0;
-	int		ts_last, ts_next, sec;
+	int		ts_last, ts_next, sec, history_num;
+
+	history_num = hc_get_history_num();
 
 	LOCK_CACHE;
 
@@ -3961,16 +4278,16 @@ void	zbx_log_sync_history_cache_progress(void)
 
 	if (0 == cache->history_progress_ts)
 	{
-		cache->history_num_total = cache->history_num;
+		cache->history_num_total = history_num;
 		cache->history_progress_ts = sec;
 	}
 
-	if (ZBX_HC_SYNC_TIME_MAX <= sec - cache->history_progress_ts || 0 == cache->history_num)
+	if (ZBX_HC_SYNC_TIME_MAX <= sec - cache->history_progress_ts || 0 == history_num)
 	{
 		if (0 != cache->history_num_total)
-			pcnt = 100 * (double)(cache->history_num_total - cache->history_num) / cache->history_num_total;
+			pcnt = 100 * (double)(cache->history_num_total - history_num) / cache->history_num_total;
 
-		cache->history_progress_ts = (0 == cache->history_num ? INT_MAX : sec);
+		cache->history_progress_ts = (0 == history_num ? INT_MAX : sec);
 	}
 
 	ts_next = cache->history_progress_ts;
@@ -3993,7 +4310,7 @@ void	zbx_log_sync_history_cache_progress(void)
  *                                                                            *
  * Purpose: writes updates and new data from history cache to database        *
  *                                                                            *
- * Parameters: values_num - [OUT] the number of synced values                  *
+ * Parameters: values_num - [OUT] the number of synced values                 *
  *             more      - [OUT] a flag indicating the cache emptiness:       *
  *                                ZBX_SYNC_DONE - nothing to sync, go idle    *
  *                                ZBX_SYNC_MORE - more data to sync           *
@@ -4009,7 +4326,7 @@ void	zbx_sync_history_cache(int *values_num, int *triggers_num, int *more)
 	const char	*__function_name = "zbx_sync_history_cache";
 
 	// 使用zabbix_log记录调试信息，显示函数名和缓存的历史记录数
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s() history_num:%d", __function_name, cache->history_num);
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() history_num:%d", __function_name, hc_get_history_num());
 
 	// 初始化values_num和triggers_num为0
 	*values_num = 0;
@@ -4384,16 +4701,29 @@ void	dc_add_history(zbx_uint64_t itemid, unsigned char item_value_type, unsigned
  ******************************************************************************/
 void	dc_flush_history(void)	// 定义一个名为dc_flush_history的函数，无返回值
 {
+	int	i, values_num[ZBX_HC_SHARDS_MAX] = {0};
+
 	if (0 == item_values_num)	// 如果item_values_num为0，即缓存为空
 		return;		// 直接返回，不再执行后续代码
 
-	LOCK_CACHE;		// 加锁，防止多线程并发访问缓存
+	// 统计每个分片的值数量
+	for (i = 0; i < (int)item_values_num; i++)
+		values_num[ZBX_HC_SHARD_INDEX(item_values[i].itemid)]++;
+
+	// 只锁定有数据的分片，防止多进程并发访问
+	for (i = 0; i < CONFIG_HISTORY_CACHE_SHARDS; i++)
+	{
+		if (0 == values_num[i])
+			continue;
 
-	hc_add_item_values(item_values, item_values_num);	// 将item_values数组中的数据添加到缓存中
+		hc_lock_shard(i);
 
-	cache->history_num += item_values_num;	// 更新缓存中的历史数据数量
+		// 将属于该分片的数据添加到缓存中，并更新分片中的历史数据数量
+		hc_add_item_values(item_values, item_values_num, i);
+		hc_shard->history_num += values_num[i];
 
-	UNLOCK_CACHE;		// 解锁，允许其他线程访问缓存
+		hc_unlock_shard(i);
+	}
 
 	item_values_num = 0;	// 将item_values数组的长度置为0，表示清空数组
 	string_values_offset = 0;	// 将string_values数组的偏移量置为0，表示清空数组
@@ -4408,6 +4738,137 @@ void	dc_flush_history(void)	// 定义一个名为dc_flush_history的函数，无
 ZBX_MEM_FUNC_IMPL(__hc_index, hc_index_mem)
 ZBX_MEM_FUNC_IMPL(__hc, hc_mem)
 
+/******************************************************************************
+ *                                                                            *
+ * Function: hc_lock_shard                                                    *
+ *                                                                            *
+ * Purpose: locks history cache shard and selects its memory for history      *
+ *          cache allocator functions                                         *
+ *                                                                            *
+ * Parameters: index - [IN] the shard index                                   *
+ *                                                                            *
+ ******************************************************************************/
+/******************************************************************************
+ * *
+ *锁定历史缓存分片，并将分片的内存设置为当前分配函数使用的内存。
+ ******************************************************************************/
+static void	hc_lock_shard(int index)
+{
+	zbx_mutex_lock(hc_shards[index].lock);
+
+	hc_shard = hc_shards[index].shard;
+	hc_mem = hc_shards[index].mem;
+	hc_index_mem = hc_shards[index].index_mem;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: hc_unlock_shard                                                  *
+ *                                                                            *
+ * Purpose: unlocks history cache shard                                       *
+ *                                                                            *
+ * Parameters: index - [IN] the shard index                                   *
+ *                                                                            *
+ ******************************************************************************/
+static void	hc_unlock_shard(int index)
+{
+	zbx_mutex_unlock(hc_shards[index].lock);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: hc_get_stats                                                     *
+ *                                                                            *
+ * Purpose: sums history cache statistics of all shards                       *
+ *                                                                            *
+ * Parameters: wcache_info - [OUT] the write cache statistics, trend cache    *
+ *                                 statistics are reset                       *
+ *                                                                            *
+ ******************************************************************************/
+/******************************************************************************
+ * *
+ *逐个锁定历史缓存分片，累加各分片的统计计数器和内存使用情况。
+ ******************************************************************************/
+static void	hc_get_stats(zbx_wcache_info_t *wcache_info)
+{
+	int	i;
+
+	memset(wcache_info, 0, sizeof(zbx_wcache_info_t));
+
+	for (i = 0; i < CONFIG_HISTORY_CACHE_SHARDS; i++)
+	{
+		hc_lock_shard(i);
+
+		wcache_info->stats.history_counter += hc_shard->stats.history_counter;
+		wcache_info->stats.history_float_counter += hc_shard->stats.history_float_counter;
+		wcache_info->stats.history_uint_counter += hc_shard->stats.history_uint_counter;
+		wcache_info->stats.history_str_counter += hc_shard->stats.history_str_counter;
+		wcache_info->stats.history_log_counter += hc_shard->stats.history_log_counter;
+		wcache_info->stats.history_text_counter += hc_shard->stats.history_text_counter;
+		wcache_info->stats.notsupported_counter += hc_shard->stats.notsupported_counter;
+
+		wcache_info->history_free += hc_mem->free_size;
+		wcache_info->history_total += hc_mem->total_size;
+		wcache_info->index_free += hc_index_mem->free_size;
+		wcache_info->index_total += hc_index_mem->total_size;
+
+		hc_unlock_shard(i);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: hc_get_history_num                                               *
+ *                                                                            *
+ * Purpose: returns the number of values in history cache                     *
+ *                                                                            *
+ ******************************************************************************/
+static int	hc_get_history_num(void)
+{
+	int	i, history_num = 0;
+
+	for (i = 0; i < CONFIG_HISTORY_CACHE_SHARDS; i++)
+	{
+		hc_lock_shard(i);
+		history_num += hc_shard->history_num;
+		hc_unlock_shard(i);
+	}
+
+	return history_num;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: tc_lock_shard                                                    *
+ *                                                                            *
+ * Purpose: locks trend cache shard and selects its memory for trend cache    *
+ *          allocator functions                                               *
+ *                                                                            *
+ * Parameters: index - [IN] the shard index                                   *
+ *                                                                            *
+ ******************************************************************************/
+static void	tc_lock_shard(int index)
+{
+	zbx_mutex_lock(tc_shards[index].lock);
+
+	tc_shard = tc_shards[index].shard;
+	trend_mem = tc_shards[index].mem;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: tc_unlock_shard                                                  *
+ *                                                                            *
+ * Purpose: unlocks trend cache shard                                         *
+ *                                                                            *
+ * Parameters: index - [IN] the shard index                                   *
+ *                                                                            *
+ ******************************************************************************/
+static void	tc_unlock_shard(int index)
+{
+	zbx_mutex_unlock(tc_shards[index].lock);
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: hc_queue_elem_compare_func                                       *
@@ -4498,14 +4959,14 @@ static void hc_free_data(zbx_hc_data_t *data)
  ******************************************************************************/
 /******************************************************************************
  * *
- *这块代码的主要目的是向名为 `cache->history_queue` 的二叉堆插入一个名为 `item` 的元素。整个代码块定义了一个静态函数 `hc_queue_item`，接收一个 `zbx_hc_item_t` 类型的指针作为参数。首先，创建一个 `zbx_binary_heap_elem_t` 类型的变量 `elem`，然后给其 `itemid` 成员赋值，值为 `item` 的 `itemid` 成员。接着，给 `elem` 的 `data` 成员赋值，值为 `item` 的地址。最后，使用 `zbx_binary_heap_insert` 函数将 `elem` 插入到名为 `cache->history_queue` 的二叉堆中。
+ *这块代码的主要目的是向名为 `hc_shard->history_queue` 的二叉堆插入一个名为 `item` 的元素。整个代码块定义了一个静态函数 `hc_queue_item`，接收一个 `zbx_hc_item_t` 类型的指针作为参数。首先，创建一个 `zbx_binary_heap_elem_t` 类型的变量 `elem`，然后给其 `itemid` 成员赋值，值为 `item` 的 `itemid` 成员。接着，给 `elem` 的 `data` 成员赋值，值为 `item` 的地址。最后，使用 `zbx_binary_heap_insert` 函数将 `elem` 插入到名为 `hc_shard->history_queue` 的二叉堆中。
  ******************************************************************************/
 // 定义一个静态函数，用于向名为 hc_queue 的二叉堆插入一个元素
 static void hc_queue_item(zbx_hc_item_t *item)
 {
 	zbx_binary_heap_elem_t	elem = {item->itemid, (const void *)item};
 
-	zbx_binary_heap_insert(&cache->history_queue, &elem);
+	zbx_binary_heap_insert(&hc_shard->history_queue, &elem);
 }
 
 
@@ -4528,7 +4989,7 @@ static void hc_queue_item(zbx_hc_item_t *item)
 // 定义一个名为 hc_get_item 的函数，参数为一个 zbx_uint64_t 类型的 itemid
 static zbx_hc_item_t *hc_get_item(zbx_uint64_t itemid)
 {
-	return (zbx_hc_item_t *)zbx_hashset_search(&cache->history_items, &itemid);
+	return (zbx_hc_item_t *)zbx_oahashset_search(&hc_shard->history_items, &itemid);
 }
 
 
@@ -4546,7 +5007,7 @@ static zbx_hc_item_t *hc_get_item(zbx_uint64_t itemid)
  ******************************************************************************/
 /******************************************************************************
  * *
- *整个代码块的主要目的是：创建一个zbx_hc_item_t类型的对象（名为item_local），并将该对象插入到名为cache->history_items的哈希集中。在这个过程中，使用了zbx_hashset_insert函数来实现插入操作。
+ *整个代码块的主要目的是：创建一个zbx_hc_item_t类型的对象（名为item_local），并将该对象插入到名为hc_shard->history_items的哈希集中。在这个过程中，使用了zbx_hashset_insert函数来实现插入操作。
  *
  *输出：
  *
@@ -4556,15 +5017,15 @@ static zbx_hc_item_t *hc_get_item(zbx_uint64_t itemid)
  *    // 创建一个zbx_hc_item_t类型的对象，名为item_local，并初始化其值为{itemid，ZBX_HC_ITEM_STATUS_NORMAL，data，data}
  *    zbx_hc_item_t\titem_local = {itemid, ZBX_HC_ITEM_STATUS_NORMAL, data, data};
  *
- *    // 使用zbx_hashset_insert函数将item_local插入到名为cache->history_items的哈希集中，插入值为sizeof(item_local)
- *    return (zbx_hc_item_t *)zbx_hashset_insert(&cache->history_items, &item_local, sizeof(item_local));
+ *    // 使用zbx_hashset_insert函数将item_local插入到名为hc_shard->history_items的哈希集中，插入值为sizeof(item_local)
+ *    return (zbx_hc_item_t *)zbx_hashset_insert(&hc_shard->history_items, &item_local, sizeof(item_local));
  *}
  ******************************************************************************/
 static zbx_hc_item_t	*hc_add_item(zbx_uint64_t itemid, zbx_hc_data_t *data)
 {
 	zbx_hc_item_t	item_local = {itemid, ZBX_HC_ITEM_STATUS_NORMAL, data, data};
 
-	return (zbx_hc_item_t *)zbx_hashset_insert(&cache->history_items, &item_local, sizeof(item_local));
+	return (zbx_hc_item_t *)zbx_oahashset_insert(&hc_shard->history_items, &item_local, sizeof(item_local));
 }
 
 /******************************************************************************
@@ -4740,7 +5201,7 @@ static int	hc_clone_history_data(zbx_hc_data_t **data, const dc_item_value_t *it
 			return FAIL;
 
 		(*data)->value_type = item_value->value_type;
-		cache->stats.notsupported_counter++;
+		hc_shard->stats.notsupported_counter++;
 
 		return SUCCEED;
 	}
@@ -4753,8 +5214,8 @@ static int	hc_clone_history_data(zbx_hc_data_t **data, const dc_item_value_t *it
 
 		(*data)->value_type = ITEM_VALUE_TYPE_TEXT;
 
-		cache->stats.history_text_counter++;
-		cache->stats.history_counter++;
+		hc_shard->stats.history_text_counter++;
+		hc_shard->stats.history_counter++;
 
 		return SUCCEED;
 	}
@@ -4793,23 +5254,23 @@ static int	hc_clone_history_data(zbx_hc_data_t **data, const dc_item_value_t *it
 		switch (item_value->item_value_type)
 		{
 			case ITEM_VALUE_TYPE_FLOAT:
-				cache->stats.history_float_counter++;
+				hc_shard->stats.history_float_counter++;
 				break;
 			case ITEM_VALUE_TYPE_UINT64:
-				cache->stats.history_uint_counter++;
+				hc_shard->stats.history_uint_counter++;
 				break;
 			case ITEM_VALUE_TYPE_STR:
-				cache->stats.history_str_counter++;
+				hc_shard->stats.history_str_counter++;
 				break;
 			case ITEM_VALUE_TYPE_TEXT:
-				cache->stats.history_text_counter++;
+				hc_shard->stats.history_text_counter++;
 				break;
 			case ITEM_VALUE_TYPE_LOG:
-				cache->stats.history_log_counter++;
+				hc_shard->stats.history_log_counter++;
 				break;
 		}
 
-		cache->stats.history_counter++;
+		hc_shard->stats.history_counter++;
 	}
 
 	// 设置data结构体的value_type
@@ -4845,7 +5306,7 @@ static int	hc_clone_history_data(zbx_hc_data_t **data, const dc_item_value_t *it
  *   - values_num：数组中数据值的个数
  * 返回值：无
  */
-static void hc_add_item_values(dc_item_value_t *values, int values_num)
+static void hc_add_item_values(dc_item_value_t *values, int values_num, int shard)
 {
 	dc_item_value_t	*item_value;
 	/* 定义循环变量 */
@@ -4863,11 +5324,15 @@ static void hc_add_item_values(dc_item_value_t *values, int values_num)
 		/* 获取当前值的地址 */
 		item_value = &values[i];
 
+		/* 跳过属于其他分片的值 */
+		if (shard != ZBX_HC_SHARD_INDEX(item_value->itemid))
+			continue;
+
 		/* 循环调用hc_clone_history_data将数据添加到历史缓存中 */
 		while (SUCCEED != hc_clone_history_data(&data, item_value))
 		{
-			/* 解锁缓存 */
-			UNLOCK_CACHE;
+			/* 解锁缓存分片 */
+			hc_unlock_shard(shard);
 
 			/*  log记录 */
 			zabbix_log(LOG_LEVEL_DEBUG, "History cache is full. Sleeping for 1 second.");
@@ -4875,8 +5340,8 @@ static void hc_add_item_values(dc_item_value_t *values, int values_num)
 			/* 等待1秒 */
 			sleep(1);
 
-			/* 重新加锁缓存 */
-			LOCK_CACHE;
+			/* 重新加锁缓存分片 */
+			hc_lock_shard(shard);
 		}
 
 		/* 尝试获取对应的item结构体 */
@@ -4974,26 +5439,65 @@ static void	hc_copy_history_data(ZBX_DC_HISTORY *history, zbx_uint64_t itemid, z
  * *
  *这段代码的主要目的是从缓存中的二叉堆中弹出历史数据项，并将弹出的历史数据项添加到历史数据 vector 中。循环条件是当缓存中的历史数据项数量大于0且二叉堆不为空时。在这个过程中，首先找到二叉堆中的最小值（即最早的历史数据项），然后将该历史数据项添加到历史数据 vector 中，最后移除二叉堆中的最小值。
  ******************************************************************************/
-// 定义一个静态函数，用于弹出缓存中的历史数据项
-static void hc_pop_items(zbx_vector_ptr_t *history_items)
+// 定义一个静态函数，用于从当前锁定的分片中弹出历史数据项
+static void hc_pop_shard_items(zbx_vector_ptr_t *history_items, int limit)
 {
 	// 定义一个指向二叉堆元素的指针
 	zbx_binary_heap_elem_t *elem;
 	// 定义一个指向历史数据项的指针
 	zbx_hc_item_t *item;
 
-	// 循环条件：当缓存中的历史数据项数量大于0且二叉堆不为空时
-	while (ZBX_HC_SYNC_MAX > history_items->values_num && FAIL == zbx_binary_heap_empty(&cache->history_queue))
+	// 循环条件：当弹出的历史数据项数量小于限制且二叉堆不为空时
+	while (limit > history_items->values_num && FAIL == zbx_binary_heap_empty(&hc_shard->history_queue))
 	{
 		// 找到二叉堆中的最小值（即最早的历史数据项）
-		elem = zbx_binary_heap_find_min(&cache->history_queue);
+		elem = zbx_binary_heap_find_min(&hc_shard->history_queue);
 		// 将找到的历史数据项添加到历史数据 vector 中
 		item = (zbx_hc_item_t *)elem->data;
 		zbx_vector_ptr_append(history_items, item);
 
 		// 移除二叉堆中的最小值（即最早的历史数据项）
-		zbx_binary_heap_remove_min(&cache->history_queue);
+		zbx_binary_heap_remove_min(&hc_shard->history_queue);
+	}
+}
+
+/******************************************************************************
+ * *
+ *从各个分片中弹出最早的历史数据项：先从每个分片取出其应得的份额，如果批次仍未
+ *填满，再从还有数据的分片中补足。每次调用从下一个分片开始，以保证公平性。
+ ******************************************************************************/
+static void hc_pop_items(zbx_vector_ptr_t *history_items)
+{
+	static int	shard_next = 0;
+	int		i, index, quota, more = FAIL;
+
+	quota = ZBX_HC_SYNC_MAX / CONFIG_HISTORY_CACHE_SHARDS;
+
+	for (i = 0; i < CONFIG_HISTORY_CACHE_SHARDS; i++)
+	{
+		index = (shard_next + i) % CONFIG_HISTORY_CACHE_SHARDS;
+
+		hc_lock_shard(index);
+
+		hc_pop_shard_items(history_items, history_items->values_num + quota);
+
+		if (FAIL == zbx_binary_heap_empty(&hc_shard->history_queue))
+			more = SUCCEED;
+
+		hc_unlock_shard(index);
+	}
+
+	for (i = 0; SUCCEED == more && i < CONFIG_HISTORY_CACHE_SHARDS &&
+			ZBX_HC_SYNC_MAX > history_items->values_num; i++)
+	{
+		index = (shard_next + i) % CONFIG_HISTORY_CACHE_SHARDS;
+
+		hc_lock_shard(index);
+		hc_pop_shard_items(history_items, ZBX_HC_SYNC_MAX);
+		hc_unlock_shard(index);
 	}
+
+	shard_next = (shard_next + 1) % CONFIG_HISTORY_CACHE_SHARDS;
 }
 
 
@@ -5068,7 +5572,7 @@ static void hc_get_item_values(ZBX_DC_HISTORY *history, zbx_vector_ptr_t *histor
  ******************************************************************************/
 void	hc_push_items(zbx_vector_ptr_t *history_items)
 {
-	int		i;
+	int		i, index, locked = -1;
 	zbx_hc_item_t	*item;
 	zbx_hc_data_t	*data_free;
 
@@ -5077,6 +5581,15 @@ void	hc_push_items(zbx_vector_ptr_t *history_items)
 	{
 		item = (zbx_hc_item_t *)history_items->values[i];
 
+		/* 项目按分片成组弹出，只有分片变化时才需要切换锁 */
+		if (locked != (index = ZBX_HC_SHARD_INDEX(item->itemid)))
+		{
+			if (-1 != locked)
+				hc_unlock_shard(locked);
+
+			hc_lock_shard(locked = index);
+		}
+
 		/* 根据项目状态进行不同操作 */
 		switch (item->status)
 		{
@@ -5090,16 +5603,20 @@ void	hc_push_items(zbx_vector_ptr_t *history_items)
 				data_free = item->tail;
 				item->tail = item->tail->next;
 				hc_free_data(data_free);
+				hc_shard->history_num--;
 
 				/* 如果项目尾部为空，则从历史索引中删除项目 */
 				if (NULL == item->tail)
-					zbx_hashset_remove(&cache->history_items, item);
+					zbx_oahashset_remove(&hc_shard->history_items, item);
 				/* 否则，将项目重新加入队列 */
 				else
 					hc_queue_item(item);
 				break;
 		}
 	}
+
+	if (-1 != locked)
+		hc_unlock_shard(locked);
 }
 
 
@@ -5116,7 +5633,16 @@ void	hc_push_items(zbx_vector_ptr_t *history_items)
 
 int	hc_queue_get_size(void)
 {
-	return cache->history_queue.elems_num;
+	int	i, size = 0;
+
+	for (i = 0; i < CONFIG_HISTORY_CACHE_SHARDS; i++)
+	{
+		hc_lock_shard(i);
+		size += hc_shard->history_queue.elems_num;
+		hc_unlock_shard(i);
+	}
+
+	return size;
 }
 
 
@@ -5152,39 +5678,61 @@ static int	init_trend_cache(char **error)
 	/* 定义变量 */
 	const char	*__function_name = "init_trend_cache"; // 定义函数名
 	size_t		sz; // 定义一个size_t类型的变量sz
-	int		ret; // 定义一个整型变量ret
+	int		ret = SUCCEED, i; // 定义整型变量ret和循环变量i
 
 	/* 打印调试日志 */
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name); // 进入函数
 
-	/* 创建互斥锁 */
-	if (SUCCEED != (ret = zbx_mutex_create(&trends_lock, ZBX_MUTEX_TRENDS, error)))
-		goto out; // 创建互斥锁失败，跳转到out标签
-
-	/* 计算趋势缓存所需内存大小 */
-	sz = zbx_mem_required_size(1, "trend cache", "TrendCacheSize");
-	if (SUCCEED != (ret = zbx_mem_create(&trend_mem, CONFIG_TRENDS_CACHE_SIZE, "trend cache", "TrendCacheSize", 0,
-			error)))
+	/* 每个分片至少需要的趋势缓存大小 */
+	if (ZBX_HC_SHARD_SIZE_MIN > CONFIG_TRENDS_CACHE_SIZE / CONFIG_HISTORY_CACHE_SHARDS)
 	{
-		goto out; // 创建趋势缓存内存失败，跳转到out标签
+		*error = zbx_dsprintf(*error, "TrendCacheSize must be at least " ZBX_FS_UI64 " bytes per trend cache"
+				" shard (HistoryCacheShards=%d)", (zbx_uint64_t)ZBX_HC_SHARD_SIZE_MIN,
+				CONFIG_HISTORY_CACHE_SHARDS);
+		ret = FAIL;
+		goto out;
 	}
 
-	/* 更新趋势缓存大小 */
-	CONFIG_TRENDS_CACHE_SIZE -= sz;
+	/* 计算趋势缓存所需内存大小 */
+	sz = zbx_mem_required_size(1, "trend cache", "TrendCacheSize");
 
 	/* 初始化趋势缓存结构体变量 */
 	cache->trends_num = 0; // 初始化趋势数量为0
-	cache->trends_last_cleanup_hour = 0; // 初始化最后一次清理时间为0
 
 	/* 定义初始哈希集大小 */
 	#define INIT_HASHSET_SIZE	100	/* Should be calculated dynamically based on trends size? */
 					/* Still does not make sense to have it more than initial */
 					/* item hashset size in configuration cache.              */
 
-	/* 创建哈希集 */
-	zbx_hashset_create_ext(&cache->trends, INIT_HASHSET_SIZE,
-			ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC, NULL,
-			__trend_mem_malloc_func, __trend_mem_realloc_func, __trend_mem_free_func);
+	/* 为每个分片创建互斥锁、趋势缓存内存和哈希集 */
+	for (i = 0; i < CONFIG_HISTORY_CACHE_SHARDS; i++)
+	{
+		zbx_tc_shard_ref_t	*ref = &tc_shards[i];
+
+		if (SUCCEED != (ret = zbx_mutex_create(&ref->lock, (zbx_mutex_name_t)(ZBX_MUTEX_TRENDS_SHARD + i),
+				error)))
+		{
+			goto out;
+		}
+
+		if (SUCCEED != (ret = zbx_mem_create(&ref->mem, CONFIG_TRENDS_CACHE_SIZE / CONFIG_HISTORY_CACHE_SHARDS,
+				"trend cache", "TrendCacheSize", 0, error)))
+		{
+			goto out;
+		}
+
+		trend_mem = ref->mem;
+
+		ref->shard = (zbx_tc_shard_t *)__trend_mem_malloc_func(NULL, sizeof(zbx_tc_shard_t));
+		ref->shard->trends_last_cleanup_hour = 0;
+
+		zbx_hashset_create_ext(&ref->shard->trends, INIT_HASHSET_SIZE,
+				ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC, NULL,
+				__trend_mem_malloc_func, __trend_mem_realloc_func, __trend_mem_free_func);
+	}
+
+	/* 更新趋势缓存大小 */
+	CONFIG_TRENDS_CACHE_SIZE -= sz * (size_t)CONFIG_HISTORY_CACHE_SHARDS;
 
 #undef INIT_HASHSET_SIZE
 out:
@@ -5196,6 +5744,70 @@ out:
 }
 
 
+/******************************************************************************
+ *                                                                            *
+ * Function: hc_init_shard                                                    *
+ *                                                                            *
+ * Purpose: allocates shared memory, lock, index and queue of history cache   *
+ *          shard                                                             *
+ *                                                                            *
+ * Parameters: index - [IN] the shard index                                   *
+ *             error - [OUT] the error message                                *
+ *                                                                            *
+ * Return value: SUCCEED - the shard was initialized successfully             *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: History cache and history index cache sizes are divided equally  *
+ *           between shards.                                                  *
+ *                                                                            *
+ ******************************************************************************/
+/******************************************************************************
+ * *
+ *初始化历史缓存分片：创建分片的互斥锁、历史缓存内存、历史索引缓存内存，
+ *并在分片索引内存中创建历史数据项哈希集和历史队列。
+ ******************************************************************************/
+static int	hc_init_shard(int index, char **error)
+{
+	zbx_hc_shard_ref_t	*ref = &hc_shards[index];
+	int			ret;
+
+	if (SUCCEED != (ret = zbx_mutex_create(&ref->lock, (zbx_mutex_name_t)(ZBX_MUTEX_HISTORY_SHARD + index),
+			error)))
+	{
+		return ret;
+	}
+
+	if (SUCCEED != (ret = zbx_mem_create(&ref->mem, CONFIG_HISTORY_CACHE_SIZE / CONFIG_HISTORY_CACHE_SHARDS,
+			"history cache", "HistoryCacheSize", 1, error)))
+	{
+		return ret;
+	}
+
+	if (SUCCEED != (ret = zbx_mem_create(&ref->index_mem,
+			CONFIG_HISTORY_INDEX_CACHE_SIZE / CONFIG_HISTORY_CACHE_SHARDS, "history index cache",
+			"HistoryIndexCacheSize", 0, error)))
+	{
+		return ret;
+	}
+
+	/* select shard memory for the allocator functions of shard index and queue */
+	hc_mem = ref->mem;
+	hc_index_mem = ref->index_mem;
+
+	ref->shard = (zbx_hc_shard_t *)__hc_index_mem_malloc_func(NULL, sizeof(zbx_hc_shard_t));
+	memset(ref->shard, 0, sizeof(zbx_hc_shard_t));
+
+	zbx_oahashset_create_ext(&ref->shard->history_items, ZBX_HC_ITEMS_INIT_SIZE / CONFIG_HISTORY_CACHE_SHARDS,
+			ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC, NULL,
+			__hc_index_mem_malloc_func, __hc_index_mem_realloc_func, __hc_index_mem_free_func);
+
+	zbx_binary_heap_create_ext(&ref->shard->history_queue, hc_queue_elem_compare_func,
+			ZBX_BINARY_HEAP_OPTION_EMPTY, __hc_index_mem_malloc_func, __hc_index_mem_realloc_func,
+			__hc_index_mem_free_func);
+
+	return SUCCEED;
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: init_database_cache                                              *
@@ -5213,7 +5825,7 @@ int	init_database_cache(char **error)
 {
 	// 定义函数名和日志级别
 	const char *__function_name = "init_database_cache";
-	int		ret;
+	int		ret, i;
 
 	// 调试日志
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
@@ -5232,39 +5844,31 @@ int	init_database_cache(char **error)
 	    goto out;
 	}
 
-	// 创建历史缓存内存
-	if (SUCCEED != (ret = zbx_mem_create(&hc_mem, CONFIG_HISTORY_CACHE_SIZE, "history cache",
-	                                "HistoryCacheSize", 1, error)))
+	if (ZBX_HC_SHARD_SIZE_MIN > CONFIG_HISTORY_CACHE_SIZE / CONFIG_HISTORY_CACHE_SHARDS ||
+			ZBX_HC_SHARD_SIZE_MIN > CONFIG_HISTORY_INDEX_CACHE_SIZE / CONFIG_HISTORY_CACHE_SHARDS)
 	{
-	    // 创建历史缓存内存失败，跳转到out标签
-	    goto out;
+		*error = zbx_dsprintf(*error, "HistoryCacheSize and HistoryIndexCacheSize must be at least "
+				ZBX_FS_UI64 " bytes per history cache shard (HistoryCacheShards=%d)",
+				(zbx_uint64_t)ZBX_HC_SHARD_SIZE_MIN, CONFIG_HISTORY_CACHE_SHARDS);
+		ret = FAIL;
+		goto out;
 	}
 
-	// 创建历史索引缓存内存
-	if (SUCCEED != (ret = zbx_mem_create(&hc_index_mem, CONFIG_HISTORY_INDEX_CACHE_SIZE, "history index cache",
-	                                "HistoryIndexCacheSize", 0, error)))
+	for (i = 0; i < CONFIG_HISTORY_CACHE_SHARDS; i++)
 	{
-	    // 创建历史索引缓存内存失败，跳转到out标签
-	    goto out;
+		if (SUCCEED != (ret = hc_init_shard(i, error)))
+			goto out;
 	}
 
-	// 分配 cache 内存并初始化
+	/* common history cache data is stored in the first shard index memory */
+	hc_index_mem = hc_shards[0].index_mem;
+
 	cache = (ZBX_DC_CACHE *)__hc_index_mem_malloc_func(NULL, sizeof(ZBX_DC_CACHE));
 	memset(cache, 0, sizeof(ZBX_DC_CACHE));
 
-	// 分配 ids 内存并初始化
 	ids = (ZBX_DC_IDS *)__hc_index_mem_malloc_func(NULL, sizeof(ZBX_DC_IDS));
 	memset(ids, 0, sizeof(ZBX_DC_IDS));
 
-	// 创建缓存中的历史物品哈希集
-	zbx_hashset_create_ext(&cache->history_items, ZBX_HC_ITEMS_INIT_SIZE,
-	                       ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC, NULL,
-	                       __hc_index_mem_malloc_func, __hc_index_mem_realloc_func, __hc_index_mem_free_func);
-
-	// 创建历史队列
-	zbx_binary_heap_create_ext(&cache->history_queue, hc_queue_elem_compare_func, ZBX_BINARY_HEAP_OPTION_EMPTY,
-	                           __hc_index_mem_malloc_func, __hc_index_mem_realloc_func, __hc_index_mem_free_func);
-
 	// 如果程序类型包含 ZBX_PROGRAM_TYPE_SERVER，则初始化趋势缓存
 	if (0 != (program_type & ZBX_PROGRAM_TYPE_SERVER))
 	{
@@ -5331,13 +5935,14 @@ static void DCsync_all(void)
  *3. 调用DCsync_all()函数，同步数据库缓存。
  *4. 将cache指针置为NULL，释放内存。
  *5. 销毁zbx_mutex类型的变量cache_lock和cache_ids_lock，解锁缓存。
- *6. 判断程序类型是否包含ZBX_PROGRAM_TYPE_SERVER，如果包含，则解锁trends_lock。
+ *6. 判断程序类型是否包含ZBX_PROGRAM_TYPE_SERVER，如果包含，则销毁趋势缓存分片的锁。
  *7. 使用zabbix_log记录调试日志，表示结束free_database_cache函数。
  ******************************************************************************/
 void	free_database_cache(void)
 {
     // 定义一个常量字符串，表示函数名
     const char	*__function_name = "free_database_cache";
+    int		i;
 
     // 使用zabbix_log记录调试日志，表示进入free_database_cache函数
     zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
@@ -5352,9 +5957,15 @@ void	free_database_cache(void)
     zbx_mutex_destroy(&cache_lock);
     zbx_mutex_destroy(&cache_ids_lock);
 
-    // 判断程序类型是否包含ZBX_PROGRAM_TYPE_SERVER，如果包含，则解锁trends_lock
+    for (i = 0; i < CONFIG_HISTORY_CACHE_SHARDS; i++)
+        zbx_mutex_destroy(&hc_shards[i].lock);
+
+    // 判断程序类型是否包含ZBX_PROGRAM_TYPE_SERVER，如果包含，则销毁趋势缓存分片的锁
     if (0 != (program_type & ZBX_PROGRAM_TYPE_SERVER))
-        zbx_mutex_destroy(&trends_lock);
+    {
+        for (i = 0; i < CONFIG_HISTORY_CACHE_SHARDS; i++)
+            zbx_mutex_destroy(&tc_shards[i].lock);
+    }
 
     // 使用zabbix_log记录调试日志，表示结束free_database_cache函数
     zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __function_name);
@@ -297,6 +297,10 @@ static zbx_uint64_t	get_item_nextcheck_seed(zbx_uint64_t itemid, zbx_uint64_t in
 		return interfaceid;
 	}
 
+	/* Zabbix agent items of the same interface are requested together */
+	if (ITEM_TYPE_ZABBIX == type && 1 < CONFIG_MAX_ITEMS_PER_AGENT_REQUEST)
+		return interfaceid;
+
 	if (ITEM_TYPE_SIMPLE == type)
 	{
 		if (SUCCEED == cmp_key_id(key, SERVER_ICMPPING_KEY) ||
@@ -4713,7 +4717,7 @@ void	DCsync_configuration(unsigned char mode)
 				action_condition_sec2, trigger_tag_sec, trigger_tag_sec2, correlation_sec,
 				correlation_sec2, corr_condition_sec, corr_condition_sec2, corr_operation_sec,
 				corr_operation_sec2, hgroups_sec, hgroups_sec2, itempp_sec, itempp_sec2, total, total2,
-				update_sec, maintenance_sec, maintenance_sec2;
+				update_sec, maintenance_sec, maintenance_sec2, start_sec;
 
 	zbx_dbsync_t		config_sync, hosts_sync, hi_sync, htmpl_sync, gmacro_sync, hmacro_sync, if_sync,
 				items_sync, triggers_sync, tdep_sync, func_sync, expr_sync, action_sync, action_op_sync,
@@ -4722,9 +4726,12 @@ void	DCsync_configuration(unsigned char mode)
 				maintenance_period_sync, maintenance_tag_sync, maintenance_group_sync,
 				maintenance_host_sync, hgroup_host_sync;
 	zbx_uint64_t		update_flags = 0;
+	int			snapshot = FAIL;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
 
+	start_sec = zbx_time();
+
 	zbx_dbsync_init_env(config);
 
 	/* global configuration must be synchronized directly with database */
@@ -4763,6 +4770,10 @@ void	DCsync_configuration(unsigned char mode)
 	zbx_dbsync_init(&maintenance_group_sync, mode);
 	zbx_dbsync_init(&maintenance_host_sync, mode);
 
+	/* read configuration changelog for incremental items, triggers and functions sync */
+	if (FAIL == zbx_dbsync_env_prepare(mode))
+		goto out;
+
 	sec = zbx_time();
 	if (FAIL == zbx_dbsync_compare_config(&config_sync))
 		goto out;
@@ -4978,16 +4989,10 @@ void	DCsync_configuration(unsigned char mode)
 		goto out;
 	corr_operation_sec = zbx_time() - sec;
 
-	START_SYNC;
-
-	sec = zbx_time();
-	DCsync_triggers(&triggers_sync);
-	tsec2 = zbx_time() - sec;
-
-	sec = zbx_time();
-	DCsync_trigdeps(&tdep_sync);
-	dsec2 = zbx_time() - sec;
+	/* global regular expressions, actions and correlation rules do not reference triggers, */
+	/* sync them separately to keep the trigger synchronization lock as short as possible   */
 
+	START_SYNC;
 	sec = zbx_time();
 	DCsync_expressions(&expr_sync);
 	expr_sec2 = zbx_time() - sec;
@@ -5003,12 +5008,9 @@ void	DCsync_configuration(unsigned char mode)
 	sec = zbx_time();
 	DCsync_action_conditions(&action_condition_sync);
 	action_condition_sec2 = zbx_time() - sec;
+	FINISH_SYNC;
 
-	sec = zbx_time();
-	/* relies on triggers, must be after DCsync_triggers() */
-	DCsync_trigger_tags(&trigger_tag_sync);
-	trigger_tag_sec2 = zbx_time() - sec;
-
+	START_SYNC;
 	sec = zbx_time();
 	DCsync_correlations(&correlation_sync);
 	correlation_sec2 = zbx_time() - sec;
@@ -5022,6 +5024,22 @@ void	DCsync_configuration(unsigned char mode)
 	/* relies on correlation rules, must be after DCsync_correlations() */
 	DCsync_corr_operations(&corr_operation_sync);
 	corr_operation_sec2 = zbx_time() - sec;
+	FINISH_SYNC;
+
+	START_SYNC;
+
+	sec = zbx_time();
+	DCsync_triggers(&triggers_sync);
+	tsec2 = zbx_time() - sec;
+
+	sec = zbx_time();
+	DCsync_trigdeps(&tdep_sync);
+	dsec2 = zbx_time() - sec;
+
+	sec = zbx_time();
+	/* relies on triggers, must be after DCsync_triggers() */
+	DCsync_trigger_tags(&trigger_tag_sync);
+	trigger_tag_sec2 = zbx_time() - sec;
 
 	sec = zbx_time();
 
@@ -5053,6 +5071,21 @@ void	DCsync_configuration(unsigned char mode)
 
 	update_sec = zbx_time() - sec;
 
+	config->status->last_update = 0;
+	config->sync_ts = time(NULL);
+
+	FINISH_SYNC;
+
+	zbx_dbsync_env_flush_changelog();
+
+	if (ZBX_DBSYNC_INIT == mode)
+	{
+		snapshot = zbx_dbsync_env_snapshot();
+
+		zabbix_log(LOG_LEVEL_INFORMATION, "configuration cache loaded from %s in " ZBX_FS_DBL " sec",
+				SUCCEED == snapshot ? "snapshot" : "database", zbx_time() - start_sec);
+	}
+
 	if (SUCCEED == ZBX_CHECK_LOG_LEVEL(LOG_LEVEL_DEBUG))
 	{
 		total = csec + hsec + hisec + htsec + gmsec + hmsec + ifsec + isec + tsec + dsec + fsec + expr_sec +
@@ -5158,6 +5191,8 @@ void	DCsync_configuration(unsigned char mode)
 		zabbix_log(LOG_LEVEL_DEBUG, "%s() total sql  : " ZBX_FS_DBL " sec.", __function_name, total);
 		zabbix_log(LOG_LEVEL_DEBUG, "%s() total sync : " ZBX_FS_DBL " sec.", __function_name, total2);
 
+		RDLOCK_CACHE;
+
 		zabbix_log(LOG_LEVEL_DEBUG, "%s() proxies    : %d (%d slots)", __function_name,
 				config->proxies.num_data, config->proxies.num_slots);
 		zabbix_log(LOG_LEVEL_DEBUG, "%s() hosts      : %d (%d slots)", __function_name,
@@ -5279,19 +5314,20 @@ void	DCsync_configuration(unsigned char mode)
 				config->strpool.num_data, config->strpool.num_slots);
 
 		zbx_mem_dump_stats(LOG_LEVEL_DEBUG, config_mem);
+
+		UNLOCK_CACHE;
 	}
+
+	goto clean;
 out:
-	if (0 == sync_in_progress)
-	{
-		/* non recoverable database error is encountered */
-		THIS_SHOULD_NEVER_HAPPEN;
-		START_SYNC;
-	}
+	/* non recoverable database error is encountered */
+	THIS_SHOULD_NEVER_HAPPEN;
 
+	START_SYNC;
 	config->status->last_update = 0;
 	config->sync_ts = time(NULL);
-
 	FINISH_SYNC;
+clean:
 
 	zbx_dbsync_clear(&config_sync);
 	zbx_dbsync_clear(&hosts_sync);
@@ -5327,6 +5363,10 @@ out:
 		DCdump_configuration();
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __function_name);
+
+	/* apply the configuration changes made after the loaded snapshot was written */
+	if (SUCCEED == snapshot)
+		DCsync_configuration(ZBX_DBSYNC_UPDATE);
 }
 
 /******************************************************************************
@@ -5503,7 +5543,17 @@ static int	__config_heap_elem_compare(const void *d1, const void *d2)
 	if (SUCCEED != is_snmp_type(i1->type))
 	{
 		if (SUCCEED != is_snmp_type(i2->type))
+		{
+			/* keep Zabbix agent items of the same interface next to each other for batch requests */
+			ZBX_RETURN_IF_NOT_EQUAL(ITEM_TYPE_ZABBIX == i1->type, ITEM_TYPE_ZABBIX == i2->type);
+
+			if (ITEM_TYPE_ZABBIX == i1->type)
+			{
+				ZBX_RETURN_IF_NOT_EQUAL(i1->interfaceid, i2->interfaceid);
+			}
+
 			return 0;
+		}
 
 		return -1;
 	}
@@ -7635,6 +7685,65 @@ static void	dc_requeue_item_at(ZBX_DC_ITEM *dc_item, ZBX_DC_HOST *dc_host, int n
 	DCupdate_item_queue(dc_item, old_poller_type, old_nextcheck);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: dc_item_agent_async_check                                        *
+ *                                                                            *
+ * Purpose: check if item can be polled concurrently with other Zabbix agent  *
+ *          items over non-blocking connections                               *
+ *                                                                            *
+ * Parameters: dc_item - [IN] the item                                        *
+ *                                                                            *
+ * Return value: SUCCEED - the item is unencrypted Zabbix agent check         *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	dc_item_agent_async_check(const ZBX_DC_ITEM *dc_item)
+{
+	const ZBX_DC_HOST	*dc_host;
+
+	if (ITEM_TYPE_ZABBIX != dc_item->type)
+		return FAIL;
+
+	if (NULL == (dc_host = (const ZBX_DC_HOST *)zbx_hashset_search(&config->hosts, &dc_item->hostid)))
+		return FAIL;
+
+	/* TLS handshake is blocking, encrypted connections are polled one at a time */
+	if (ZBX_TCP_SEC_UNENCRYPTED != dc_host->tls_connect)
+		return FAIL;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: dc_item_agent_batch_check                                        *
+ *                                                                            *
+ * Purpose: check if item can be requested from Zabbix agent together with    *
+ *          the previous item over the same connection                        *
+ *                                                                            *
+ * Parameters: dc_item_prev - [IN] the previous item in batch                 *
+ *             dc_item      - [IN] the item                                   *
+ *                                                                            *
+ * Return value: SUCCEED - both items are Zabbix agent checks of the same     *
+ *                         interface and batch requests are enabled           *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	dc_item_agent_batch_check(const ZBX_DC_ITEM *dc_item_prev, const ZBX_DC_ITEM *dc_item)
+{
+	if (1 == CONFIG_MAX_ITEMS_PER_AGENT_REQUEST)
+		return FAIL;
+
+	if (ITEM_TYPE_ZABBIX != dc_item->type || ITEM_TYPE_ZABBIX != dc_item_prev->type)
+		return FAIL;
+
+	if (dc_item_prev->interfaceid != dc_item->interfaceid)
+		return FAIL;
+
+	return SUCCEED;
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: DCconfig_get_poller_items                                        *
@@ -7652,9 +7761,11 @@ static void	dc_requeue_item_at(ZBX_DC_ITEM *dc_item, ZBX_DC_HOST *dc_host, int n
  *           always return the items they have taken using DCrequeue_items()  *
  *           or DCpoller_requeue_items().                                     *
  *                                                                            *
- *           Currently batch polling is supported only for JMX, SNMP and      *
- *           icmpping* simple checks. In other cases only single item is      *
- *           retrieved.                                                       *
+ *           Currently batch polling is supported only for JMX, SNMP,         *
+ *           icmpping* simple checks, unencrypted Zabbix agent checks when    *
+ *           MaxConcurrentAgentChecks is above 1 and Zabbix agent checks of   *
+ *           the same interface when MaxItemsPerAgentRequest is above 1. In   *
+ *           other cases only single item is retrieved.                       *
  *                                                                            *
  *           IPMI poller queue are handled by DCconfig_get_ipmi_poller_items()*
  *           function.                                                        *
@@ -7713,6 +7824,16 @@ int	DCconfig_get_poller_items(unsigned char poller_type, DC_ITEM *items)
 				if (0 != __config_java_item_compare(dc_item_prev, dc_item))
 					break;
 			}
+			else if (ITEM_TYPE_ZABBIX == dc_item_prev->type)
+			{
+				if (SUCCEED != dc_item_agent_batch_check(dc_item_prev, dc_item) &&
+						(1 == CONFIG_MAX_CONCURRENT_AGENT_CHECKS ||
+						SUCCEED != dc_item_agent_async_check(dc_item_prev) ||
+						SUCCEED != dc_item_agent_async_check(dc_item)))
+				{
+					break;
+				}
+			}
 		}
 
 		zbx_binary_heap_remove_min(queue);
@@ -7779,6 +7900,15 @@ int	DCconfig_get_poller_items(unsigned char poller_type, DC_ITEM *items)
 				max_items = DCconfig_get_suggested_snmp_vars_nolock(dc_item->interfaceid, NULL);
 			}
 		}
+
+		/* unreachable pollers keep probing hosts with a single item at a time */
+		if (1 == num && ZBX_POLLER_TYPE_NORMAL == poller_type && ITEM_TYPE_ZABBIX == dc_item->type)
+		{
+			if (1 < CONFIG_MAX_CONCURRENT_AGENT_CHECKS && ZBX_TCP_SEC_UNENCRYPTED == dc_host->tls_connect)
+				max_items = MAX(CONFIG_MAX_CONCURRENT_AGENT_CHECKS, CONFIG_MAX_ITEMS_PER_AGENT_REQUEST);
+			else
+				max_items = CONFIG_MAX_ITEMS_PER_AGENT_REQUEST;
+		}
 	}
 
 	UNLOCK_CACHE;
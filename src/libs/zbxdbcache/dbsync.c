@@ -23,38 +23,62 @@
 #include "zbxserver.h"
 #include "mutexs.h"
 
+#include <sys/mman.h>
+
 #define ZBX_DBCONFIG_IMPL
 #include "dbconfig.h"
 #include "dbsync.h"
 
+/* the number of columns selected by item, trigger and function synchronization */
+#define ZBX_DBSYNC_ITEM_COLUMNS_NUM	57
+#define ZBX_DBSYNC_TRIGGER_COLUMNS_NUM	14
+#define ZBX_DBSYNC_FUNCTION_COLUMNS_NUM	5
+
+/* the number of changelog records read by one select */
+#define ZBX_DBSYNC_CHANGELOG_BATCH_SIZE	10000
+
 typedef struct
 {
 	zbx_hashset_t	strpool;
 	ZBX_DC_CONFIG	*cache;
+
+	/* SUCCEED - items, triggers and functions are synchronized from changelog, FAIL - full comparison */
+	int			changelog;
+
+	/* the identifiers of changelog records read during this synchronization */
+	zbx_vector_uint64_t	changelogids;
+
+	/* the identifiers of objects changed since the last synchronization */
+	zbx_vector_uint64_t	hostids;
+	zbx_vector_uint64_t	itemids;
+	zbx_vector_uint64_t	triggerids;
+
+	/* the identifiers of cached functions affected by the changed objects */
+	zbx_vector_uint64_t	functionids;
+
+	/* the configuration snapshot revision stored in changelog table, 0 if not set */
+	zbx_uint64_t		revision;
+
+	/* SUCCEED - items, triggers and functions are read from configuration snapshot, FAIL - from database */
+	int			snapshot;
 }
 zbx_dbsync_env_t;
 
 static zbx_dbsync_env_t	dbsync_env;
 
+extern int	CONFIG_CONFSYNCER_CHANGELOG;
+extern int	CONFIG_CONFSYNCER_FULL_FREQUENCY;
+extern char	*CONFIG_CONFSYNCER_SNAPSHOT_FILE;
+
+/* the time of the last full comparison when incremental synchronization is enabled */
+static time_t	changelog_full_sync = 0;
+
+/* SUCCEED - changelog table exists, FAIL - not checked yet or does not exist */
+static int	changelog_table = FAIL;
+
 /* string pool support */
 
 #define REFCOUNT_FIELD_SIZE	sizeof(zbx_uint32_t)
-
-/******************************************************************************
- * c
- */*
- * * 定义一个名为 dbsync_strpool_hash_func 的静态函数，用于计算字符串的哈希值。
- * * 传入的参数为一个指向 void 类型的指针 data，通过转换指针类型为 char* 类型，
- * * 并加上 REFCOUNT_FIELD_SIZE，用于处理字符串哈希计算。
- * * 最后，调用 ZBX_DEFAULT_STRING_HASH_FUNC 函数计算字符串哈希值并返回。
- * */
- *static zbx_hash_t\tdbsync_strpool_hash_func(const void *data)
- *{
- *    // 返回 ZBX_DEFAULT_STRING_HASH_FUNC 函数的调用结果，传入的参数为（char *）data + REFCOUNT_FIELD_SIZE
- *    return ZBX_DEFAULT_STRING_HASH_FUNC((char *)data + REFCOUNT_FIELD_SIZE);
- *}
- *```
- ******************************************************************************/
 // 定义一个名为 dbsync_strpool_hash_func 的静态函数，参数为一个指向 void 类型的指针 data
 static zbx_hash_t	dbsync_strpool_hash_func(const void *data)
 {
@@ -62,11 +86,10 @@ static zbx_hash_t	dbsync_strpool_hash_func(const void *data)
     return ZBX_DEFAULT_STRING_HASH_FUNC((char *)data + REFCOUNT_FIELD_SIZE);
 }
 
-代码块主要目的是：定义一个名为 dbsync_strpool_hash_func 的静态函数，用于计算字符串的哈希值。传入的参数为一个指向 void 类型的指针 data，通过转换指针类型为 char* 类型，并加上 REFCOUNT_FIELD_SIZE，用于处理字符串哈希计算。最后，调用 ZBX_DEFAULT_STRING_HASH_FUNC 函数计算字符串哈希值并返回。
-
-整个注释好的代码块如下：
-
-
+static int	dbsync_strpool_compare_func(const void *d1, const void *d2)
+{
+	return strcmp((char *)d1 + REFCOUNT_FIELD_SIZE, (char *)d2 + REFCOUNT_FIELD_SIZE);
+}
 
 /******************************************************************************
  * *
@@ -105,64 +128,6 @@ static char *dbsync_strdup(const char *str)
 	return (char *)ptr + REFCOUNT_FIELD_SIZE;
 }
 
-{
-	void	*ptr;
-
-	ptr = zbx_hashset_search(&dbsync_env.strpool, str - REFCOUNT_FIELD_SIZE);
-/******************************************************************************
- * *
- *整个代码块的主要目的是比较一个字符串表示的uint64值与一个zbx_uint64_t类型的值是否相等。具体实现过程如下：
- *
- *1. 定义一个zbx_uint64_t类型的变量value_ui64，用于存储从value_raw字符串转换而来的uint64数值。
- *2. 使用ZBX_DBROW2UINT64函数将value_raw字符串转换为uint64类型的value_ui64。
- *3. 判断value_ui64与value是否相等，如果相等则返回SUCCEED，否则返回FAIL。
- *
- *输出结果：
- *
- *```
- *int main()
- *{
- *    const char *value_raw = \"123456789\";
- *    zbx_uint64_t value = 123456789;
- *
- *    int result = dbsync_compare_uint64(value_raw, value);
- *
- *    if (result == SUCCEED)
- *    {
- *        printf(\"The value is equal.\
- *\");
- *    }
- *    else
- *    {
- *        printf(\"The value is not equal.\
- *\");
- *    }
- *
- *    return 0;
- *}
- *```
- *
- *在这个例子中，我们将字符串\"123456789\"转换为uint64数值，并与zbx_uint64_t类型的值进行比较。如果两者相等，输出\"The value is equal.\"，否则输出\"The value is not equal.\"。
- ******************************************************************************/
-// 定义一个静态函数dbsync_compare_uint64，接收两个参数，一个是指向字符串的指针value_raw，另一个是zbx_uint64_t类型的值value。
-static int	dbsync_compare_uint64(const char *value_raw, zbx_uint64_t value)
-{
-	// 定义一个zbx_uint64_t类型的变量value_ui64，用于存储从value_raw字符串转换而来的uint64数值
-	zbx_uint64_t	value_ui64;
-
-	// 使用ZBX_DBROW2UINT64函数将value_raw字符串转换为uint64类型的value_ui64
-	ZBX_DBROW2UINT64(value_ui64, value_raw);
-
-	// 判断value_ui64与value是否相等，如果相等则返回SUCCEED，否则返回FAIL
-	return (value_ui64 == value ? SUCCEED : FAIL);
-}
-
-
-	(*(zbx_uint32_t *)ptr)++;
-
-	return (char *)ptr + REFCOUNT_FIELD_SIZE;
-}
-
 /******************************************************************************
  * *
  *整个代码块的主要目的是：释放一个已分配内存的字符串，并在字符串池中删除该字符串。当传入的字符串指针不为空时，首先计算原始内存地址，然后判断该字符串的引用计数。如果引用计数为0，说明该字符串已经被释放，可以直接从字符串池中删除。
@@ -178,10 +143,8 @@ static void dbsync_strfree(char *str)
 
         // 判断引用计数是否为0，如果为0，说明该字符串已经被释放，可以直接删除
         if (0 == --(*(zbx_uint32_t *)ptr))
-        {
             // 删除字符串池中的字符串，其中ptr作为键
             zbx_hashset_remove_direct(&dbsync_env.strpool, ptr);
-        }
     }
 }
 
@@ -209,15 +172,49 @@ static int dbsync_numeric_validator(const char *value)
 {
     // 判断value字符串是否包含小数后缀
     if (SUCCEED == is_double_suffix(value, ZBX_FLAG_DOUBLE_SUFFIX))
-    {
         // 如果包含小数后缀，返回成功
         return SUCCEED;
-    }
+
     // 如果不包含小数后缀，返回失败
     return FAIL;
 }
 
-
+/******************************************************************************
+ * *
+ *整个代码块的主要目的是比较一个字符串表示的uint64值与一个zbx_uint64_t类型的值是否相等。具体实现过程如下：
+ *
+ *1. 定义一个zbx_uint64_t类型的变量value_ui64，用于存储从value_raw字符串转换而来的uint64数值。
+ *2. 使用ZBX_DBROW2UINT64函数将value_raw字符串转换为uint64类型的value_ui64。
+ *3. 判断value_ui64与value是否相等，如果相等则返回SUCCEED，否则返回FAIL。
+ *
+ *输出结果：
+ *
+ *```
+ *int main()
+ *{
+ *    const char *value_raw = \"123456789\";
+ *    zbx_uint64_t value = 123456789;
+ *
+ *    int result = dbsync_compare_uint64(value_raw, value);
+ *
+ *    if (result == SUCCEED)
+ *    {
+ *        printf(\"The value is equal.\
+ *\");
+ *    }
+ *    else
+ *    {
+ *        printf(\"The value is not equal.\
+ *\");
+ *    }
+ *
+ *    return 0;
+ *}
+ *```
+ *
+ *在这个例子中，我们将字符串\"123456789\"转换为uint64数值，并与zbx_uint64_t类型的值进行比较。如果两者相等，输出\"The value is equal.\"，否则输出\"The value is not equal.\"。
+ ******************************************************************************/
+// 定义一个静态函数dbsync_compare_uint64，接收两个参数，一个是指向字符串的指针value_raw，另一个是zbx_uint64_t类型的值value。
 /******************************************************************************
  *                                                                            *
  * Function: dbsync_compare_uint64                                            *
@@ -227,10 +224,13 @@ static int dbsync_numeric_validator(const char *value)
  ******************************************************************************/
 static int	dbsync_compare_uint64(const char *value_raw, zbx_uint64_t value)
 {
+	// 定义一个zbx_uint64_t类型的变量value_ui64，用于存储从value_raw字符串转换而来的uint64数值
 	zbx_uint64_t	value_ui64;
 
+	// 使用ZBX_DBROW2UINT64函数将value_raw字符串转换为uint64类型的value_ui64
 	ZBX_DBROW2UINT64(value_ui64, value_raw);
 
+	// 判断value_ui64与value是否相等，如果相等则返回SUCCEED，否则返回FAIL
 	return (value_ui64 == value ? SUCCEED : FAIL);
 }
 
@@ -246,22 +246,10 @@ static int	dbsync_compare_uint64(const char *value_raw, zbx_uint64_t value)
  *这块代码的主要目的是比较两个值，一个是字符串类型的value_raw，另一个是整数类型的value。通过将字符串value_raw转换为整数，然后判断转换后的整数与value是否相等。如果相等，则返回SUCCEED，表示比较成功；否则，返回FAIL，表示比较失败。
  ******************************************************************************/
 // 定义一个静态函数dbsync_compare_int，接收两个参数：一个const char类型的指针value_raw，一个int类型的值value。
-static int dbsync_compare_int(const char *value_raw, int value)
+static int	dbsync_compare_int(const char *value_raw, int value)
 {
-    // 将字符串value_raw转换为整数，使用atoi函数
-    int num = atoi(value_raw);
-
-    // 判断转换后的整数num与传入的值value是否相等
-    if (num == value)
-    {
-        // 如果相等，返回SUCCEED，表示成功
-        return SUCCEED;
-    }
-    else
-    {
-        // 如果不相等，返回FAIL，表示失败
-        return FAIL;
-    }
+	// 将字符串value_raw转换为整数，使用atoi函数
+	return (atoi(value_raw) == value ? SUCCEED : FAIL);
 }
 
 
@@ -289,144 +277,1043 @@ static int	dbsync_compare_uchar(const char *value_raw, unsigned char value)
 	// 判断 value_uchar 和 value 是否相等，如果相等则返回 SUCCEED，否则返回 FAIL
 	return (value_uchar == value ? SUCCEED : FAIL);
 }
+
 /******************************************************************************
- * *
- *整个代码块的主要目的是：定义一个静态函数 `dbsync_add_row`，用于向数据同步结构体中的数据表添加一行数据。在函数中，首先创建一个 `zbx_dbsync_row_t` 类型的实例，并设置其行ID、行标签和行数据。然后，根据行标签的不同，更新同步状态计数器。最后，将新创建的行添加到同步结构体的 `rows` 向量中。
+ *                                                                            *
+ * Function: dbsync_compare_str                                               *
+ *                                                                            *
+ * Purpose: compares string with a raw database value                         *
+ *                                                                            *
  ******************************************************************************/
-// 定义一个静态函数，用于向数据同步结构体中的数据表添加一行数据
-static void dbsync_add_row(zbx_dbsync_t *sync, zbx_uint64_t rowid, unsigned char tag, const DB_ROW dbrow)
-{
-	// 定义一个整型变量 i，用于循环操作
-	int i;
-	// 定义一个指向 zbx_dbsync_row_t 类型的指针，用于存储行的信息
-	zbx_dbsync_row_t *row;
-
-	// 分配内存，创建一个新的 zbx_dbsync_row_t 结构体实例
-	row = (zbx_dbsync_row_t *)zbx_malloc(NULL, sizeof(zbx_dbsync_row_t));
-	// 设置行ID
-	row->rowid = rowid;
-	// 设置行标签
-	row->tag = tag;
-
-	// 如果 dbrow 参数不为空，则分配内存存储行数据
-	if (NULL != dbrow)
-	{
-		// 分配内存，存储行数据
-		row->row = (char **)zbx_malloc(NULL, sizeof(char *) * sync->columns_num);
-
-		// 遍历 dbrow 数组，将每个元素转换为字符串，并存储在 row->row 数组中
-		for (i = 0; i < sync->columns_num; i++)
-		{
-			row->row[i] = (NULL == dbrow[i] ? NULL : dbsync_strdup(dbrow[i]));
-		}
-	}
-	// 如果 dbrow 为空，则设置 row->row 为 NULL
-	else
-	{
-		row->row = NULL;
-	}
-
-	// 将新创建的行添加到 sync->rows 向量中
-	zbx_vector_ptr_append(&sync->rows, row);
 
-	// 根据行标签的不同，更新同步状态计数器
-	switch (tag)
-	{
-		case ZBX_DBSYNC_ROW_ADD:
-			sync->add_num++;
-			break;
-		case ZBX_DBSYNC_ROW_UPDATE:
-			sync->update_num++;
-			break;
-		case ZBX_DBSYNC_ROW_REMOVE:
-			sync->remove_num++;
-			break;
-	}
+static int	dbsync_compare_str(const char *value_raw, const char *value)
+{
+	return (0 == strcmp(value_raw, value) ? SUCCEED : FAIL);
 }
 
 /******************************************************************************
  *                                                                            *
- * Function: dbsync_add_row                                                   *
+ * Configuration snapshot                                                     *
  *                                                                            *
- * Purpose: adds a new row to the changeset                                   *
+ * The database rows of items, triggers and functions are kept in             *
+ * CacheSnapshotFile, so the initial synchronization can read them from local *
+ * file instead of database. The file consists of header followed by records  *
+ * (zbx_dbsync_snapshot_record_t). The rows selected by full synchronization  *
+ * are written to a new file, while the rows selected and removed by          *
+ * incremental synchronizations are appended to it. Every synchronization     *
+ * ends with commit record holding snapshot revision, the records after the   *
+ * last commit record are ignored.                                            *
  *                                                                            *
- * Parameter: sync  - [IN] the changeset                                      *
- *            rowid - [IN] the row identifier                                 *
- *            tag   - [IN] the row tag (see ZBX_DBSYNC_ROW_ defines)          *
- *            row   - [IN] the row contents (depending on configuration cache *
- *                         removal logic for the specific object it can be    *
- *                         NULL when used with ZBX_DBSYNC_ROW_REMOVE tag)     *
+ * The last committed revision is also stored in changelog table when the     *
+ * applied changelog records are removed. The snapshot is loaded only if the  *
+ * revisions match, the changelog records added since are applied by the      *
+ * next incremental synchronization.                                          *
  *                                                                            *
  ******************************************************************************/
-static void	dbsync_add_row(zbx_dbsync_t *sync, zbx_uint64_t rowid, unsigned char tag, const DB_ROW dbrow)
-{
-	int			i;
-	zbx_dbsync_row_t	*row;
 
-	row = (zbx_dbsync_row_t *)zbx_malloc(NULL, sizeof(zbx_dbsync_row_t));
-	row->rowid = rowid;
-	row->tag = tag;
+#define ZBX_DBSYNC_SNAPSHOT_MAGIC	"ZBXCSNP"
+#define ZBX_DBSYNC_SNAPSHOT_VERSION	1
 
-	if (NULL != dbrow)
-	{
-		row->row = (char **)zbx_malloc(NULL, sizeof(char *) * sync->columns_num);
+/* snapshot record types */
+#define ZBX_DBSYNC_SNAPSHOT_ROW		1
+#define ZBX_DBSYNC_SNAPSHOT_REMOVE	2
+#define ZBX_DBSYNC_SNAPSHOT_COMMIT	3
 
-		for (i = 0; i < sync->columns_num; i++)
-			row->row[i] = (NULL == dbrow[i] ? NULL : dbsync_strdup(dbrow[i]));
-	}
-	else
-		row->row = NULL;
+/* the length of NULL column value */
+#define ZBX_DBSYNC_SNAPSHOT_NULL	0xffffffff
 
-	zbx_vector_ptr_append(&sync->rows, row);
+/* the size of snapshot data buffered before writing to file during full synchronization */
+#define ZBX_DBSYNC_SNAPSHOT_BUFFER_SIZE	ZBX_MEBIBYTE
 
-	switch (tag)
-	{
-		case ZBX_DBSYNC_ROW_ADD:
-			sync->add_num++;
-			break;
-		case ZBX_DBSYNC_ROW_UPDATE:
-			sync->update_num++;
-			break;
-		case ZBX_DBSYNC_ROW_REMOVE:
-			sync->remove_num++;
-			break;
-	}
+/* the number of runtime columns of items and triggers */
+#define ZBX_DBSYNC_SNAPSHOT_RUNTIME_NUM	4
+
+typedef struct
+{
+	char		magic[8];
+	zbx_uint32_t	version;
+	zbx_uint32_t	reserved;
+	zbx_uint64_t	revision;
 }
+zbx_dbsync_snapshot_header_t;
 
-/******************************************************************************
- *                                                                            *
- * Function: dbsync_prepare                                                   *
- *                                                                            *
- * Purpose: prepares changeset                                                *
- *                                                                            *
- * Parameter: sync             - [IN] the changeset                           *
- *            columns_num      - [IN] the number of columns in the changeset  *
- *            get_hostids_func - [IN] the callback function used to retrieve  *
- *                                    associated hostids (can be NULL if      *
- *                                    user macros are not resolved during     *
- *                                    synchronization process)                *
- *                                                                            *
- ******************************************************************************/
-/******************************************************************************
- * *
- *整个代码块的主要目的是：准备数据库同步操作所需的参数，包括列的数量、处理每一行的函数以及存储每一行数据的内存空间。在这个过程中，使用了动态内存分配函数zbx_malloc()来分配内存。
- ******************************************************************************/
-/* 定义一个静态函数，用于准备数据库同步操作 */
-static void dbsync_prepare(zbx_dbsync_t *sync, int columns_num, zbx_dbsync_preproc_row_func_t preproc_row_func)
+typedef struct
 {
-	/* 保存传入的参数，columns_num表示列的数量，preproc_row_func是用于处理每一行的函数 */
-	sync->columns_num = columns_num;
-	sync->preproc_row_func = preproc_row_func;
+	/* the record type (see ZBX_DBSYNC_SNAPSHOT_* defines) */
+	unsigned char	type;
 
-	/* 为sync结构体分配一块内存，用于存储每一行的数据，columns_num表示行数 */
-	sync->row = (char **)zbx_malloc(NULL, sizeof(char *) * columns_num);
-	/* 初始化sync->row数组，将每个元素都设置为NULL */
-	memset(sync->row, 0, sizeof(char *) * columns_num);
+	/* the row object type (see ZBX_DBSYNC_OBJ_* defines) */
+	unsigned char	object;
+
+	unsigned short	columns_num;
+
+	/* the size of column data following the record */
+	zbx_uint32_t	size;
+
+	/* the row identifier or snapshot revision for commit records */
+	zbx_uint64_t	rowid;
 }
+zbx_dbsync_snapshot_record_t;
 
+/* the last row record of object changed by incremental synchronization */
+typedef struct
+{
+	zbx_uint64_t	rowid;
+	unsigned char	object;
 
-/******************************************************************************
- *                                                                            *
+	/* the row record offset or 0 if the row was removed */
+	size_t		offset;
+}
+zbx_dbsync_snapshot_ref_t;
+
+/* the runtime column values read from database, see dbsync_snapshot_select() */
+typedef struct
+{
+	zbx_uint64_t	rowid;
+	char		*values[ZBX_DBSYNC_SNAPSHOT_RUNTIME_NUM];
+}
+zbx_dbsync_snapshot_runtime_t;
+
+typedef struct
+{
+	unsigned char		*data;
+	size_t			size;
+
+	/* the end of rows written by full synchronization */
+	size_t			base_end;
+
+	/* the last committed revision */
+	zbx_uint64_t		revision;
+
+	/* the rows changed by incremental synchronizations */
+	zbx_hashset_t		journal;
+}
+zbx_dbsync_snapshot_reader_t;
+
+typedef struct
+{
+	/* the new snapshot file written by full synchronization, NULL for incremental synchronization */
+	FILE			*file;
+	char			*filename;
+
+	zbx_uint64_t		revision;
+
+	/* the buffered records */
+	char			*data;
+	size_t			data_alloc;
+	size_t			data_offset;
+
+	int			records_num;
+	int			ret;
+}
+zbx_dbsync_snapshot_writer_t;
+
+static zbx_dbsync_snapshot_reader_t	*snapshot_reader = NULL;
+static zbx_dbsync_snapshot_writer_t	*snapshot_writer = NULL;
+
+/* the revision of snapshot file written or loaded by this process, 0 if the file is not valid */
+static zbx_uint64_t	snapshot_revision = 0;
+
+/* the runtime columns of items and triggers, see dbsync_snapshot_select() */
+static const int	snapshot_item_runtime[ZBX_DBSYNC_SNAPSHOT_RUNTIME_NUM] = {18, 29, 30, 36};
+static const int	snapshot_trigger_runtime[ZBX_DBSYNC_SNAPSHOT_RUNTIME_NUM] = {3, 6, 7, 8};
+static const char	*snapshot_runtime_defaults[2][ZBX_DBSYNC_SNAPSHOT_RUNTIME_NUM] = {
+		{"0", "0", "0", ""}, {"", "0", "0", "0"}};
+
+static zbx_hash_t	dbsync_snapshot_ref_hash_func(const void *data)
+{
+	const zbx_dbsync_snapshot_ref_t	*ref = (const zbx_dbsync_snapshot_ref_t *)data;
+	zbx_hash_t			hash;
+
+	hash = ZBX_DEFAULT_UINT64_HASH_FUNC(&ref->rowid);
+	return ZBX_DEFAULT_HASH_ALGO(&ref->object, sizeof(ref->object), hash);
+}
+
+static int	dbsync_snapshot_ref_compare_func(const void *d1, const void *d2)
+{
+	const zbx_dbsync_snapshot_ref_t	*ref1 = (const zbx_dbsync_snapshot_ref_t *)d1;
+	const zbx_dbsync_snapshot_ref_t	*ref2 = (const zbx_dbsync_snapshot_ref_t *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(ref1->rowid, ref2->rowid);
+	ZBX_RETURN_IF_NOT_EQUAL(ref1->object, ref2->object);
+
+	return 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: dbsync_snapshot_columns_num                                      *
+ *                                                                            *
+ * Purpose: returns the number of columns in object rows                      *
+ *                                                                            *
+ ******************************************************************************/
+static int	dbsync_snapshot_columns_num(unsigned char object)
+{
+	switch (object)
+	{
+		case ZBX_DBSYNC_OBJ_ITEM:
+			return ZBX_DBSYNC_ITEM_COLUMNS_NUM;
+		case ZBX_DBSYNC_OBJ_TRIGGER:
+			return ZBX_DBSYNC_TRIGGER_COLUMNS_NUM;
+		case ZBX_DBSYNC_OBJ_FUNCTION:
+			return ZBX_DBSYNC_FUNCTION_COLUMNS_NUM;
+		default:
+			return 0;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: dbsync_snapshot_write                                            *
+ *                                                                            *
+ * Purpose: adds data to snapshot writer buffer                               *
+ *                                                                            *
+ ******************************************************************************/
+static void	dbsync_snapshot_write(zbx_dbsync_snapshot_writer_t *writer, const void *data, size_t size)
+{
+	if (writer->data_alloc < writer->data_offset + size)
+	{
+		while (writer->data_alloc < writer->data_offset + size)
+			writer->data_alloc = (0 == writer->data_alloc ? ZBX_KIBIBYTE : writer->data_alloc * 2);
+
+		writer->data = (char *)zbx_realloc(writer->data, writer->data_alloc);
+	}
+
+	memcpy(writer->data + writer->data_offset, data, size);
+	writer->data_offset += size;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: dbsync_snapshot_flush                                            *
+ *                                                                            *
+ * Purpose: writes buffered snapshot data to file                             *
+ *                                                                            *
+ ******************************************************************************/
+static void	dbsync_snapshot_flush(zbx_dbsync_snapshot_writer_t *writer, FILE *file)
+{
+	if (SUCCEED == writer->ret && writer->data_offset != fwrite(writer->data, 1, writer->data_offset, file))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot write configuration cache snapshot: %s", zbx_strerror(errno));
+		writer->ret = FAIL;
+	}
+
+	writer->data_offset = 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: dbsync_snapshot_write_record                                     *
+ *                                                                            *
+ * Purpose: adds row or remove record to snapshot being written               *
+ *                                                                            *
+ * Parameters: object      - [IN] the row object type (ZBX_DBSYNC_OBJ_*)      *
+ *             rowid       - [IN] the row identifier                          *
+ *             row         - [IN] the database row, NULL for removed rows     *
+ *             columns_num - [IN] the number of columns in row                *
+ *                                                                            *
+ ******************************************************************************/
+static void	dbsync_snapshot_write_record(unsigned char object, zbx_uint64_t rowid, const DB_ROW row,
+		int columns_num)
+{
+	zbx_dbsync_snapshot_writer_t	*writer = snapshot_writer;
+	zbx_dbsync_snapshot_record_t	record;
+	zbx_uint32_t			len;
+	int				i;
+
+	if (NULL == writer || SUCCEED != writer->ret)
+		return;
+
+	memset(&record, 0, sizeof(record));
+	record.object = object;
+	record.rowid = rowid;
+
+	if (NULL == row)
+	{
+		/* full synchronization writes all rows, there is nothing to remove */
+		if (NULL != writer->file)
+			return;
+
+		record.type = ZBX_DBSYNC_SNAPSHOT_REMOVE;
+		dbsync_snapshot_write(writer, &record, sizeof(record));
+		writer->records_num++;
+		return;
+	}
+
+	record.type = ZBX_DBSYNC_SNAPSHOT_ROW;
+	record.columns_num = (unsigned short)columns_num;
+
+	for (i = 0; i < columns_num; i++)
+		record.size += sizeof(len) + (NULL == row[i] ? 0 : strlen(row[i]) + 1);
+
+	dbsync_snapshot_write(writer, &record, sizeof(record));
+
+	for (i = 0; i < columns_num; i++)
+	{
+		if (NULL == row[i])
+		{
+			len = ZBX_DBSYNC_SNAPSHOT_NULL;
+			dbsync_snapshot_write(writer, &len, sizeof(len));
+			continue;
+		}
+
+		len = (zbx_uint32_t)strlen(row[i]);
+		dbsync_snapshot_write(writer, &len, sizeof(len));
+		dbsync_snapshot_write(writer, row[i], len + 1);
+	}
+
+	writer->records_num++;
+
+	if (NULL != writer->file && ZBX_DBSYNC_SNAPSHOT_BUFFER_SIZE <= writer->data_offset)
+		dbsync_snapshot_flush(writer, writer->file);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: dbsync_snapshot_add_row                                          *
+ *                                                                            *
+ * Purpose: adds database row selected by synchronization to snapshot         *
+ *                                                                            *
+ * Parameters: sync  - [IN] the changeset                                     *
+ *             dbrow - [IN] the database row                                  *
+ *                                                                            *
+ ******************************************************************************/
+static void	dbsync_snapshot_add_row(const zbx_dbsync_t *sync, const DB_ROW dbrow)
+{
+	zbx_uint64_t	rowid;
+
+	if (0 == sync->snapshot_object || NULL == snapshot_writer)
+		return;
+
+	ZBX_STR2UINT64(rowid, dbrow[ZBX_DBSYNC_OBJ_FUNCTION == sync->snapshot_object ? 1 : 0]);
+	dbsync_snapshot_write_record(sync->snapshot_object, rowid, dbrow, sync->columns_num);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: dbsync_snapshot_begin                                            *
+ *                                                                            *
+ * Purpose: starts writing snapshot for the current synchronization           *
+ *                                                                            *
+ * Parameters: full - [IN] SUCCEED - full synchronization, a new snapshot     *
+ *                                   file is written                          *
+ *                         FAIL    - incremental synchronization, the changed *
+ *                                   rows are appended to snapshot file       *
+ *                                                                            *
+ ******************************************************************************/
+static void	dbsync_snapshot_begin(int full)
+{
+	zbx_dbsync_snapshot_writer_t	*writer;
+	zbx_dbsync_snapshot_header_t	header;
+
+	if (NULL == CONFIG_CONFSYNCER_SNAPSHOT_FILE)
+		return;
+
+	/* changes can be appended only to the snapshot matching database */
+	if (SUCCEED != full && (0 == snapshot_revision || snapshot_revision != dbsync_env.revision))
+	{
+		if (0 != snapshot_revision)
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "configuration cache snapshot revision " ZBX_FS_UI64 " does not"
+					" match database revision " ZBX_FS_UI64 ", the snapshot will be written by the"
+					" next full synchronization", snapshot_revision, dbsync_env.revision);
+			unlink(CONFIG_CONFSYNCER_SNAPSHOT_FILE);
+			snapshot_revision = 0;
+		}
+
+		return;
+	}
+
+	writer = (zbx_dbsync_snapshot_writer_t *)zbx_malloc(NULL, sizeof(zbx_dbsync_snapshot_writer_t));
+	memset(writer, 0, sizeof(zbx_dbsync_snapshot_writer_t));
+	writer->revision = dbsync_env.revision + 1;
+	writer->ret = SUCCEED;
+
+	if (SUCCEED == full)
+	{
+		writer->filename = zbx_dsprintf(NULL, "%s.tmp", CONFIG_CONFSYNCER_SNAPSHOT_FILE);
+
+		if (NULL == (writer->file = fopen(writer->filename, "wb")))
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "cannot create configuration cache snapshot file \"%s\": %s",
+					writer->filename, zbx_strerror(errno));
+			zbx_free(writer->filename);
+			zbx_free(writer);
+			return;
+		}
+
+		memset(&header, 0, sizeof(header));
+		memcpy(header.magic, ZBX_DBSYNC_SNAPSHOT_MAGIC, sizeof(header.magic));
+		header.version = ZBX_DBSYNC_SNAPSHOT_VERSION;
+		header.revision = writer->revision;
+
+		dbsync_snapshot_write(writer, &header, sizeof(header));
+	}
+
+	snapshot_writer = writer;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: dbsync_snapshot_commit                                           *
+ *                                                                            *
+ * Purpose: finishes writing snapshot after successful synchronization        *
+ *                                                                            *
+ * Return value: SUCCEED - the snapshot matches configuration cache           *
+ *               FAIL    - the snapshot was not written or write failed       *
+ *                                                                            *
+ ******************************************************************************/
+static int	dbsync_snapshot_commit(void)
+{
+	zbx_dbsync_snapshot_writer_t	*writer = snapshot_writer;
+	zbx_dbsync_snapshot_record_t	record;
+	FILE				*file;
+	int				ret = FAIL;
+
+	if (NULL == writer)
+		return FAIL;
+
+	/* incremental synchronization without changed rows does not change snapshot */
+	if (NULL == writer->file && 0 == writer->records_num)
+		return SUCCEED;
+
+	memset(&record, 0, sizeof(record));
+	record.type = ZBX_DBSYNC_SNAPSHOT_COMMIT;
+	record.rowid = writer->revision;
+	dbsync_snapshot_write(writer, &record, sizeof(record));
+
+	if (NULL != writer->file)
+	{
+		file = writer->file;
+		writer->file = NULL;
+	}
+	else if (NULL == (file = fopen(CONFIG_CONFSYNCER_SNAPSHOT_FILE, "ab")))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot open configuration cache snapshot file \"%s\": %s",
+				CONFIG_CONFSYNCER_SNAPSHOT_FILE, zbx_strerror(errno));
+		writer->ret = FAIL;
+		goto out;
+	}
+
+	dbsync_snapshot_flush(writer, file);
+
+	if (0 != fclose(file) && SUCCEED == writer->ret)
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot write configuration cache snapshot: %s", zbx_strerror(errno));
+		writer->ret = FAIL;
+	}
+
+	if (SUCCEED == writer->ret && NULL != writer->filename &&
+			0 != rename(writer->filename, CONFIG_CONFSYNCER_SNAPSHOT_FILE))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot rename configuration cache snapshot file \"%s\" to \"%s\": %s",
+				writer->filename, CONFIG_CONFSYNCER_SNAPSHOT_FILE, zbx_strerror(errno));
+		writer->ret = FAIL;
+	}
+
+	if (SUCCEED == writer->ret)
+	{
+		snapshot_revision = writer->revision;
+		ret = SUCCEED;
+	}
+out:
+	if (SUCCEED != writer->ret)
+	{
+		/* partially appended snapshot is ignored when loading, but it cannot be appended anymore */
+		if (NULL == writer->filename)
+			unlink(CONFIG_CONFSYNCER_SNAPSHOT_FILE);
+
+		snapshot_revision = 0;
+	}
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: dbsync_snapshot_release_writer                                   *
+ *                                                                            *
+ * Purpose: frees snapshot writer, removing uncommitted snapshot file         *
+ *                                                                            *
+ ******************************************************************************/
+static void	dbsync_snapshot_release_writer(void)
+{
+	zbx_dbsync_snapshot_writer_t	*writer = snapshot_writer;
+
+	if (NULL == writer)
+		return;
+
+	if (NULL != writer->file)
+		fclose(writer->file);
+
+	if (NULL != writer->filename)
+	{
+		unlink(writer->filename);
+		zbx_free(writer->filename);
+	}
+
+	zbx_free(writer->data);
+	zbx_free(writer);
+
+	snapshot_writer = NULL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: dbsync_snapshot_read_record                                      *
+ *                                                                            *
+ * Purpose: reads and validates snapshot record                               *
+ *                                                                            *
+ * Parameters: data   - [IN] the snapshot data                                *
+ *             size   - [IN] the snapshot data size                           *
+ *             offset - [IN] the record offset                                *
+ *             record - [OUT] the record                                      *
+ *                                                                            *
+ * Return value: SUCCEED - the record was read                                *
+ *               FAIL    - the record is truncated or malformed               *
+ *                                                                            *
+ ******************************************************************************/
+static int	dbsync_snapshot_read_record(const unsigned char *data, size_t size, size_t offset,
+		zbx_dbsync_snapshot_record_t *record)
+{
+	const unsigned char	*ptr, *end;
+	zbx_uint32_t		len;
+	int			i;
+
+	if (size - offset < sizeof(zbx_dbsync_snapshot_record_t))
+		return FAIL;
+
+	memcpy(record, data + offset, sizeof(zbx_dbsync_snapshot_record_t));
+	offset += sizeof(zbx_dbsync_snapshot_record_t);
+
+	if (size - offset < record->size)
+		return FAIL;
+
+	switch (record->type)
+	{
+		case ZBX_DBSYNC_SNAPSHOT_COMMIT:
+		case ZBX_DBSYNC_SNAPSHOT_REMOVE:
+			return 0 == record->size ? SUCCEED : FAIL;
+		case ZBX_DBSYNC_SNAPSHOT_ROW:
+			break;
+		default:
+			return FAIL;
+	}
+
+	if (record->columns_num != dbsync_snapshot_columns_num(record->object))
+		return FAIL;
+
+	ptr = data + offset;
+	end = ptr + record->size;
+
+	for (i = 0; i < record->columns_num; i++)
+	{
+		if ((size_t)(end - ptr) < sizeof(len))
+			return FAIL;
+
+		memcpy(&len, ptr, sizeof(len));
+		ptr += sizeof(len);
+
+		if (ZBX_DBSYNC_SNAPSHOT_NULL == len)
+			continue;
+
+		if ((size_t)(end - ptr) <= len || '\0' != ptr[len])
+			return FAIL;
+
+		ptr += len + 1;
+	}
+
+	return ptr == end ? SUCCEED : FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: dbsync_snapshot_decode_row                                       *
+ *                                                                            *
+ * Purpose: gets row columns from validated row record                        *
+ *                                                                            *
+ * Parameters: reader - [IN] the loaded snapshot                              *
+ *             offset - [IN] the row record offset                            *
+ *             row    - [OUT] the row columns pointing to snapshot data       *
+ *                                                                            *
+ ******************************************************************************/
+static void	dbsync_snapshot_decode_row(const zbx_dbsync_snapshot_reader_t *reader, size_t offset, char **row)
+{
+	zbx_dbsync_snapshot_record_t	record;
+	unsigned char			*ptr;
+	zbx_uint32_t			len;
+	int				i;
+
+	memcpy(&record, reader->data + offset, sizeof(zbx_dbsync_snapshot_record_t));
+	ptr = reader->data + offset + sizeof(zbx_dbsync_snapshot_record_t);
+
+	for (i = 0; i < record.columns_num; i++)
+	{
+		memcpy(&len, ptr, sizeof(len));
+		ptr += sizeof(len);
+
+		if (ZBX_DBSYNC_SNAPSHOT_NULL == len)
+		{
+			row[i] = NULL;
+			continue;
+		}
+
+		row[i] = (char *)ptr;
+		ptr += len + 1;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: dbsync_snapshot_release_reader                                   *
+ *                                                                            *
+ * Purpose: frees loaded snapshot                                             *
+ *                                                                            *
+ ******************************************************************************/
+static void	dbsync_snapshot_release_reader(void)
+{
+	zbx_dbsync_snapshot_reader_t	*reader = snapshot_reader;
+
+	if (NULL == reader)
+		return;
+
+	zbx_hashset_destroy(&reader->journal);
+	munmap(reader->data, reader->size);
+	zbx_free(reader);
+
+	snapshot_reader = NULL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: dbsync_snapshot_load                                             *
+ *                                                                            *
+ * Purpose: loads configuration snapshot for initial synchronization          *
+ *                                                                            *
+ * Return value: SUCCEED - the snapshot matching database revision was loaded *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	dbsync_snapshot_load(void)
+{
+	const char			*__function_name = "dbsync_snapshot_load";
+	int				fd, ret = FAIL;
+	struct stat			st;
+	void				*map;
+	double				sec;
+	size_t				offset, end = 0;
+	zbx_dbsync_snapshot_header_t	header;
+	zbx_dbsync_snapshot_record_t	record;
+	zbx_dbsync_snapshot_reader_t	*reader;
+	zbx_dbsync_snapshot_ref_t	ref, *pref;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() file:'%s'", __function_name, CONFIG_CONFSYNCER_SNAPSHOT_FILE);
+
+	sec = zbx_time();
+
+	if (-1 == (fd = open(CONFIG_CONFSYNCER_SNAPSHOT_FILE, O_RDONLY)))
+	{
+		if (ENOENT != errno)
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "cannot open configuration cache snapshot file \"%s\": %s",
+					CONFIG_CONFSYNCER_SNAPSHOT_FILE, zbx_strerror(errno));
+		}
+		goto out;
+	}
+
+	if (0 != fstat(fd, &st) || (size_t)st.st_size < sizeof(header))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "invalid configuration cache snapshot file \"%s\"",
+				CONFIG_CONFSYNCER_SNAPSHOT_FILE);
+		close(fd);
+		goto out;
+	}
+
+	map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if (MAP_FAILED == map)
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot map configuration cache snapshot file \"%s\": %s",
+				CONFIG_CONFSYNCER_SNAPSHOT_FILE, zbx_strerror(errno));
+		goto out;
+	}
+
+	reader = (zbx_dbsync_snapshot_reader_t *)zbx_malloc(NULL, sizeof(zbx_dbsync_snapshot_reader_t));
+	memset(reader, 0, sizeof(zbx_dbsync_snapshot_reader_t));
+	reader->data = (unsigned char *)map;
+	reader->size = (size_t)st.st_size;
+	zbx_hashset_create(&reader->journal, 100, dbsync_snapshot_ref_hash_func, dbsync_snapshot_ref_compare_func);
+	snapshot_reader = reader;
+
+	memcpy(&header, reader->data, sizeof(header));
+
+	if (0 != memcmp(header.magic, ZBX_DBSYNC_SNAPSHOT_MAGIC, sizeof(header.magic)) ||
+			ZBX_DBSYNC_SNAPSHOT_VERSION != header.version)
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "invalid configuration cache snapshot file \"%s\" format",
+				CONFIG_CONFSYNCER_SNAPSHOT_FILE);
+		goto out;
+	}
+
+	/* validate records and find the end of the last committed synchronization */
+	for (offset = sizeof(header); offset < reader->size;
+			offset += sizeof(zbx_dbsync_snapshot_record_t) + record.size)
+	{
+		if (SUCCEED != dbsync_snapshot_read_record(reader->data, reader->size, offset, &record))
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "configuration cache snapshot file \"%s\" is truncated or"
+					" corrupted at offset " ZBX_FS_SIZE_T, CONFIG_CONFSYNCER_SNAPSHOT_FILE,
+					(zbx_fs_size_t)offset);
+			break;
+		}
+
+		if (ZBX_DBSYNC_SNAPSHOT_COMMIT != record.type)
+			continue;
+
+		if (0 == reader->revision)
+		{
+			if (header.revision != record.rowid)
+				break;
+
+			reader->base_end = offset;
+		}
+		else if (reader->revision >= record.rowid)
+			break;
+
+		reader->revision = record.rowid;
+		end = offset;
+	}
+
+	/* the rows changed by incremental synchronizations replace the rows written by full synchronization */
+	for (offset = reader->base_end; offset < end; offset += sizeof(zbx_dbsync_snapshot_record_t) + record.size)
+	{
+		memcpy(&record, reader->data + offset, sizeof(zbx_dbsync_snapshot_record_t));
+
+		if (ZBX_DBSYNC_SNAPSHOT_COMMIT == record.type)
+			continue;
+
+		ref.rowid = record.rowid;
+		ref.object = record.object;
+
+		if (NULL == (pref = (zbx_dbsync_snapshot_ref_t *)zbx_hashset_search(&reader->journal, &ref)))
+			pref = (zbx_dbsync_snapshot_ref_t *)zbx_hashset_insert(&reader->journal, &ref, sizeof(ref));
+
+		pref->offset = (ZBX_DBSYNC_SNAPSHOT_ROW == record.type ? offset : 0);
+	}
+
+	if (0 == reader->revision || reader->revision != dbsync_env.revision)
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "configuration cache snapshot revision " ZBX_FS_UI64 " does not match"
+				" database revision " ZBX_FS_UI64 ", loading configuration from database",
+				reader->revision, dbsync_env.revision);
+		goto out;
+	}
+
+	snapshot_revision = reader->revision;
+	ret = SUCCEED;
+
+	zabbix_log(LOG_LEVEL_INFORMATION, "loaded configuration cache snapshot revision " ZBX_FS_UI64 " (%d changed"
+			" rows) in " ZBX_FS_DBL " sec", reader->revision, reader->journal.num_data, zbx_time() - sec);
+out:
+	if (SUCCEED != ret)
+		dbsync_snapshot_release_reader();
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: dbsync_snapshot_select                                           *
+ *                                                                            *
+ * Purpose: prepares changeset for reading object rows from loaded snapshot   *
+ *          during initial synchronization                                    *
+ *                                                                            *
+ * Parameters: sync - [IN] the changeset                                      *
+ *                                                                            *
+ * Return value: SUCCEED - the changeset was prepared                         *
+ *               FAIL    - database error                                     *
+ *                                                                            *
+ * Comments: The item and trigger runtime columns are updated by server       *
+ *           without changelog records, so their values are read from         *
+ *           database. Only the rows with non-default values are selected.    *
+ *                                                                            *
+ ******************************************************************************/
+static int	dbsync_snapshot_select(zbx_dbsync_t *sync)
+{
+	DB_RESULT			result;
+	DB_ROW				dbrow;
+	zbx_dbsync_snapshot_runtime_t	runtime;
+	int				i;
+
+	sync->dbresult = NULL;
+	sync->snapshot_offset = sizeof(zbx_dbsync_snapshot_header_t);
+	zbx_hashset_iter_reset(&snapshot_reader->journal, &sync->snapshot_iter);
+
+	sync->snapshot_row = (char **)zbx_malloc(NULL, sizeof(char *) * sync->columns_num);
+
+	switch (sync->snapshot_object)
+	{
+		case ZBX_DBSYNC_OBJ_ITEM:
+			result = DBselect(
+					"select itemid,state,lastlogsize,mtime,error"
+					" from items"
+					" where state<>0"
+						" or lastlogsize<>0"
+						" or mtime<>0"
+						" or error" ZBX_SQL_STRCMP,
+					ZBX_SQL_STRVAL_NE(""));
+			break;
+		case ZBX_DBSYNC_OBJ_TRIGGER:
+			result = DBselect(
+					"select triggerid,error,value,state,lastchange"
+					" from triggers"
+					" where value<>0"
+						" or state<>0"
+						" or lastchange<>0"
+						" or error" ZBX_SQL_STRCMP,
+					ZBX_SQL_STRVAL_NE(""));
+			break;
+		default:
+			return SUCCEED;
+	}
+
+	if (NULL == result)
+		return FAIL;
+
+	sync->snapshot_runtime = (zbx_hashset_t *)zbx_malloc(NULL, sizeof(zbx_hashset_t));
+	zbx_hashset_create(sync->snapshot_runtime, 100, ZBX_DEFAULT_UINT64_HASH_FUNC,
+			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	while (NULL != (dbrow = DBfetch(result)))
+	{
+		ZBX_STR2UINT64(runtime.rowid, dbrow[0]);
+
+		for (i = 0; i < ZBX_DBSYNC_SNAPSHOT_RUNTIME_NUM; i++)
+			runtime.values[i] = zbx_strdup(NULL, ZBX_NULL2EMPTY_STR(dbrow[i + 1]));
+
+		zbx_hashset_insert(sync->snapshot_runtime, &runtime, sizeof(runtime));
+	}
+	DBfree_result(result);
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: dbsync_snapshot_next                                             *
+ *                                                                            *
+ * Purpose: gets the next object row from loaded snapshot                     *
+ *                                                                            *
+ * Parameters: sync - [IN] the changeset                                      *
+ *                                                                            *
+ * Return value: the row or NULL if there are no more rows                    *
+ *                                                                            *
+ * Comments: The rows written by full synchronization are read first, unless  *
+ *           they were changed or removed by incremental synchronizations.    *
+ *           Then the rows changed by incremental synchronizations are read.  *
+ *                                                                            *
+ ******************************************************************************/
+static char	**dbsync_snapshot_next(zbx_dbsync_t *sync)
+{
+	zbx_dbsync_snapshot_reader_t	*reader = snapshot_reader;
+	zbx_dbsync_snapshot_record_t	record;
+	zbx_dbsync_snapshot_ref_t	ref, *pref;
+	zbx_dbsync_snapshot_runtime_t	*runtime;
+	zbx_uint64_t			rowid;
+	size_t				offset = 0;
+	const int			*columns;
+	const char			**defaults;
+	int				i;
+
+	while (sync->snapshot_offset < reader->base_end)
+	{
+		memcpy(&record, reader->data + sync->snapshot_offset, sizeof(zbx_dbsync_snapshot_record_t));
+		sync->snapshot_offset += sizeof(zbx_dbsync_snapshot_record_t) + record.size;
+
+		if (record.object != sync->snapshot_object)
+			continue;
+
+		ref.rowid = record.rowid;
+		ref.object = record.object;
+
+		if (NULL != zbx_hashset_search(&reader->journal, &ref))
+			continue;
+
+		offset = sync->snapshot_offset - sizeof(zbx_dbsync_snapshot_record_t) - record.size;
+		rowid = record.rowid;
+		break;
+	}
+
+	while (0 == offset)
+	{
+		if (NULL == (pref = (zbx_dbsync_snapshot_ref_t *)zbx_hashset_iter_next(&sync->snapshot_iter)))
+			return NULL;
+
+		if (pref->object == sync->snapshot_object)
+		{
+			offset = pref->offset;
+			rowid = pref->rowid;
+		}
+	}
+
+	dbsync_snapshot_decode_row(reader, offset, sync->snapshot_row);
+
+	switch (sync->snapshot_object)
+	{
+		case ZBX_DBSYNC_OBJ_ITEM:
+			columns = snapshot_item_runtime;
+			defaults = snapshot_runtime_defaults[0];
+			break;
+		case ZBX_DBSYNC_OBJ_TRIGGER:
+			columns = snapshot_trigger_runtime;
+			defaults = snapshot_runtime_defaults[1];
+			break;
+		default:
+			return sync->snapshot_row;
+	}
+
+	runtime = (zbx_dbsync_snapshot_runtime_t *)zbx_hashset_search(sync->snapshot_runtime, &rowid);
+
+	for (i = 0; i < ZBX_DBSYNC_SNAPSHOT_RUNTIME_NUM; i++)
+		sync->snapshot_row[columns[i]] = (char *)(NULL != runtime ? runtime->values[i] : defaults[i]);
+
+	return sync->snapshot_row;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: dbsync_snapshot_clear                                            *
+ *                                                                            *
+ * Purpose: frees the resources allocated for reading rows from snapshot      *
+ *                                                                            *
+ ******************************************************************************/
+static void	dbsync_snapshot_clear(zbx_dbsync_t *sync)
+{
+	zbx_hashset_iter_t		iter;
+	zbx_dbsync_snapshot_runtime_t	*runtime;
+	int				i;
+
+	zbx_free(sync->snapshot_row);
+
+	if (NULL == sync->snapshot_runtime)
+		return;
+
+	zbx_hashset_iter_reset(sync->snapshot_runtime, &iter);
+	while (NULL != (runtime = (zbx_dbsync_snapshot_runtime_t *)zbx_hashset_iter_next(&iter)))
+	{
+		for (i = 0; i < ZBX_DBSYNC_SNAPSHOT_RUNTIME_NUM; i++)
+			zbx_free(runtime->values[i]);
+	}
+
+	zbx_hashset_destroy(sync->snapshot_runtime);
+	zbx_free(sync->snapshot_runtime);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: dbsync_add_row                                                   *
+ *                                                                            *
+ * Purpose: adds a new row to the changeset                                   *
+ *                                                                            *
+ * Parameter: sync  - [IN] the changeset                                      *
+ *            rowid - [IN] the row identifier                                 *
+ *            tag   - [IN] the row tag (see ZBX_DBSYNC_ROW_ defines)          *
+ *            row   - [IN] the row contents (depending on configuration cache *
+ *                         removal logic for the specific object it can be    *
+ *                         NULL when used with ZBX_DBSYNC_ROW_REMOVE tag)     *
+ *                                                                            *
+ ******************************************************************************/
+/******************************************************************************
+ * *
+ *整个代码块的主要目的是：定义一个静态函数 `dbsync_add_row`，用于向数据同步结构体中的数据表添加一行数据。在函数中，首先创建一个 `zbx_dbsync_row_t` 类型的实例，并设置其行ID、行标签和行数据。然后，根据行标签的不同，更新同步状态计数器。最后，将新创建的行添加到同步结构体的 `rows` 向量中。
+ ******************************************************************************/
+// 定义一个静态函数，用于向数据同步结构体中的数据表添加一行数据
+static void	dbsync_add_row(zbx_dbsync_t *sync, zbx_uint64_t rowid, unsigned char tag, const DB_ROW dbrow)
+{
+	// 定义一个整型变量 i，用于循环操作
+	int			i;
+	// 定义一个指向 zbx_dbsync_row_t 类型的指针，用于存储行的信息
+	zbx_dbsync_row_t	*row;
+
+	// 分配内存，创建一个新的 zbx_dbsync_row_t 结构体实例
+	row = (zbx_dbsync_row_t *)zbx_malloc(NULL, sizeof(zbx_dbsync_row_t));
+	// 设置行ID
+	row->rowid = rowid;
+	// 设置行标签
+	row->tag = tag;
+
+	// 如果 dbrow 参数不为空，则分配内存存储行数据
+	if (NULL != dbrow)
+	{
+		// 分配内存，存储行数据
+		row->row = (char **)zbx_malloc(NULL, sizeof(char *) * sync->columns_num);
+
+		// 遍历 dbrow 数组，将每个元素转换为字符串，并存储在 row->row 数组中
+		for (i = 0; i < sync->columns_num; i++)
+			row->row[i] = (NULL == dbrow[i] ? NULL : dbsync_strdup(dbrow[i]));
+	}
+	// 如果 dbrow 为空，则设置 row->row 为 NULL
+	else
+		row->row = NULL;
+
+	// 将新创建的行添加到 sync->rows 向量中
+	zbx_vector_ptr_append(&sync->rows, row);
+
+	if (ZBX_DBSYNC_ROW_REMOVE == tag && 0 != sync->snapshot_object)
+		dbsync_snapshot_write_record(sync->snapshot_object, rowid, NULL, 0);
+
+	// 根据行标签的不同，更新同步状态计数器
+	switch (tag)
+	{
+		case ZBX_DBSYNC_ROW_ADD:
+			sync->add_num++;
+			break;
+		case ZBX_DBSYNC_ROW_UPDATE:
+			sync->update_num++;
+			break;
+		case ZBX_DBSYNC_ROW_REMOVE:
+			sync->remove_num++;
+			break;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: dbsync_prepare                                                   *
+ *                                                                            *
+ * Purpose: prepares changeset                                                *
+ *                                                                            *
+ * Parameter: sync             - [IN] the changeset                           *
+ *            columns_num      - [IN] the number of columns in the changeset  *
+ *            get_hostids_func - [IN] the callback function used to retrieve  *
+ *                                    associated hostids (can be NULL if      *
+ *                                    user macros are not resolved during     *
+ *                                    synchronization process)                *
+ *                                                                            *
+ ******************************************************************************/
+/******************************************************************************
+ * *
+ *整个代码块的主要目的是：准备数据库同步操作所需的参数，包括列的数量、处理每一行的函数以及存储每一行数据的内存空间。在这个过程中，使用了动态内存分配函数zbx_malloc()来分配内存。
+ ******************************************************************************/
+/* 定义一个静态函数，用于准备数据库同步操作 */
+static void dbsync_prepare(zbx_dbsync_t *sync, int columns_num, zbx_dbsync_preproc_row_func_t preproc_row_func)
+{
+	/* 保存传入的参数，columns_num表示列的数量，preproc_row_func是用于处理每一行的函数 */
+	sync->columns_num = columns_num;
+	sync->preproc_row_func = preproc_row_func;
+
+	/* 为sync结构体分配一块内存，用于存储每一行的数据，columns_num表示行数 */
+	sync->row = (char **)zbx_malloc(NULL, sizeof(char *) * columns_num);
+	/* 初始化sync->row数组，将每个元素都设置为NULL */
+	memset(sync->row, 0, sizeof(char *) * columns_num);
+}
+
+
+/******************************************************************************
+ *                                                                            *
  * Function: dbsync_check_row_macros                                          *
  *                                                                            *
  * Purpose: checks if the specified column in the row contains user macros    *
@@ -458,6 +1345,26 @@ static int	dbsync_check_row_macros(char **row, int column)
 	return FAIL;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: dbsync_item_preproc_row                                          *
+ *                                                                            *
+ * Purpose: applies necessary preprocessing before row is compared/used       *
+ *                                                                            *
+ * Parameter: row - [IN] the row to preprocess                                *
+/******************************************************************************
+ * *
+ *这个代码块主要目的是处理物品数据，包括以下几个步骤：
+ *
+ *1. 查询物品表中的数据。
+ *2. 预处理物品数据，包括展开用户宏等操作。
+ *3. 初始化配置缓存，用于存储物品数据。
+ *4. 遍历查询结果，比较物品数据，并根据不同的标志位进行添加、更新或删除操作。
+ *5. 释放查询结果，销毁配置缓存。
+ *
+ *整个函数的输出是一个处理后的变化集（changeset），其中包括需要添加、更新或删除的物品数据。
+ ******************************************************************************/
+
 
 /******************************************************************************
  *                                                                            *
@@ -471,40 +1378,39 @@ static int	dbsync_check_row_macros(char **row, int column)
  * Return value: the resulting row                                            *
  *                                                                            *
  ******************************************************************************/
-static char	**dbsync_preproc_row(zbx_dbsync_t *sync, char **row)
-{
-	int	i;
 /******************************************************************************
  * *
  *整个代码块的主要目的是对原始行数据进行预处理，并将处理后的数据存储在 `sync->row` 中。同时，将处理后的数据与原始数据不同的部分添加到列数组 `sync->columns` 中。最后返回处理后的行数据。
  ******************************************************************************/
-// 判断预处理函数指针是否为空，若为空则直接返回原始行数据
-if (NULL == sync->preproc_row_func)
+static char	**dbsync_preproc_row(zbx_dbsync_t *sync, char **row)
 {
-    return row; // 如果预处理函数为空，直接返回原始行数据
-}
+	int	i;
 
-/* 释放上一次预处理分配的资源 */
-zbx_vector_ptr_clear_ext(&sync->columns, zbx_ptr_free);
+	// 判断预处理函数指针是否为空，若为空则直接返回原始行数据
+	if (NULL == sync->preproc_row_func)
+		return row; // 如果预处理函数为空，直接返回原始行数据
 
-/* 复制原始数据 */
-memcpy(sync->row, row, sizeof(char *) * sync->columns_num);
+	/* free the resources allocated by last preprocessing call */
+	/* 释放上一次预处理分配的资源 */
+	zbx_vector_ptr_clear_ext(&sync->columns, zbx_ptr_free);
 
-/* 调用预处理函数，并将结果存储在 sync->row 中 */
-sync->row = sync->preproc_row_func(sync->row);
+	/* copy the original data */
+	/* 复制原始数据 */
+	memcpy(sync->row, row, sizeof(char *) * sync->columns_num);
 
-/* 遍历列数组，比较原始行数据与预处理后的行数据 */
-for (i = 0; i < sync->columns_num; i++)
-{
-    if (sync->row[i] != row[i]) // 如果预处理后的数据与原始数据不同，则将差异部分添加到列数组中
-    {
-        zbx_vector_ptr_append(&sync->columns, sync->row[i]);
-    }
-}
+	/* 调用预处理函数，并将结果存储在 sync->row 中 */
+	sync->row = sync->preproc_row_func(sync->row);
 
-/* 返回预处理后的行数据 */
-return sync->row;
+	/* 遍历列数组，比较原始行数据与预处理后的行数据 */
+	for (i = 0; i < sync->columns_num; i++)
+	{
+		if (sync->row[i] != row[i]) // 如果预处理后的数据与原始数据不同，则将差异部分添加到列数组中
+			zbx_vector_ptr_append(&sync->columns, sync->row[i]);
+	}
 
+	/* 返回预处理后的行数据 */
+	return sync->row;
+}
 
 /******************************************************************************
  *                                                                            *
@@ -516,12 +1422,35 @@ return sync->row;
  *这块代码的主要目的是初始化数据同步环境，包括将传入的配置信息赋值给对应的结构体变量，以及创建一个字符串池用于存储和管理字符串资源。其中，`zbx_dbsync_init_env`函数接收一个`ZBX_DC_CONFIG`类型的指针作为参数，这个指针指向一个配置结构体，里面包含了数据同步所需的各种配置信息。在函数内部，首先将传入的配置信息赋值给`dbsync_env`结构体的`cache`字段，然后创建一个哈希表用于存储字符串池，哈希表的大小为100。`dbsync_strpool_hash_func`和`dbsync_strpool_compare_func`分别是哈希表的哈希函数和比较函数，用于管理字符串池中的字符串资源。
  ******************************************************************************/
 // 定义一个函数，用于初始化数据同步环境
-void zbx_dbsync_init_env(ZBX_DC_CONFIG *cache)
+/******************************************************************************
+ * *
+ *初始化数据同步环境：保存配置缓存指针，创建字符串池以及变更日志中对象ID的向量。
+ ******************************************************************************/
+void	zbx_dbsync_init_env(ZBX_DC_CONFIG *cache)
 {
-    // 将传入的cache指针赋值给dbsync_env结构的cache字段
-    dbsync_env.cache = cache;
-    
-    // 创建一个哈希表，用于存储字符串池（字符串缓存）
+	// 将传入的cache指针赋值给dbsync_env结构的cache字段
+	dbsync_env.cache = cache;
+	// 创建一个哈希表，用于存储字符串池（字符串缓存）
+	zbx_hashset_create(&dbsync_env.strpool, 100, dbsync_strpool_hash_func, dbsync_strpool_compare_func);
+
+	/* full comparison by default */
+	// 默认进行完整的表比较
+	dbsync_env.changelog = FAIL;
+	zbx_vector_uint64_create(&dbsync_env.changelogids);
+	zbx_vector_uint64_create(&dbsync_env.hostids);
+	zbx_vector_uint64_create(&dbsync_env.itemids);
+	zbx_vector_uint64_create(&dbsync_env.triggerids);
+	zbx_vector_uint64_create(&dbsync_env.functionids);
+
+	dbsync_env.revision = 0;
+	dbsync_env.snapshot = FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: dbsync_env_release                                               *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  * *
  *这块代码的主要目的是：销毁一个 C 语言结构体 dbsync_env 中的字符串池（strpool）。
@@ -529,24 +1458,374 @@ void zbx_dbsync_init_env(ZBX_DC_CONFIG *cache)
  *函数 zbx_dbsync_free_env 的作用是在程序运行结束时，释放字符串池中所占用的内存资源。这里使用了 zbx_hashset_destroy 函数来完成字符串池的销毁操作。在调用此函数时，将字符串池的指针传递给它，从而确保正确地销毁指定的字符串池。
  ******************************************************************************/
 // 定义一个函数，名为 zbx_dbsync_free_env，函数类型为 void
-void zbx_dbsync_free_env(void)
+/******************************************************************************
+ * *
+ *释放数据同步环境：销毁字符串池和变更日志相关的向量。
+ ******************************************************************************/
+void	zbx_dbsync_free_env(void)
 {
-    // 定义一个指向 dbsync_env.strpool 的指针，用于操作字符串池
-    zbx_hashset_t *strpool = &dbsync_env.strpool;
+	// 定义一个指向 dbsync_env.strpool 的指针，用于操作字符串池
+	// 调用 zbx_hashset_destroy 函数，传入字符串池指针，销毁字符串池
+	zbx_hashset_destroy(&dbsync_env.strpool);
 
-    // 调用 zbx_hashset_destroy 函数，传入字符串池指针，销毁字符串池
-    zbx_hashset_destroy(strpool);
+	zbx_vector_uint64_destroy(&dbsync_env.functionids);
+	zbx_vector_uint64_destroy(&dbsync_env.triggerids);
+	zbx_vector_uint64_destroy(&dbsync_env.itemids);
+	zbx_vector_uint64_destroy(&dbsync_env.hostids);
+	zbx_vector_uint64_destroy(&dbsync_env.changelogids);
+
+	dbsync_snapshot_release_reader();
+	dbsync_snapshot_release_writer();
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: dbsync_function_changed                                          *
+ *                                                                            *
+ * Purpose: checks if cached function is affected by the changed hosts, items *
+ *          or triggers                                                       *
+ *                                                                            *
+ * Parameters: function - [IN] the cached function                            *
+ *                                                                            *
+ * Return value: SUCCEED - the function trigger, item or host was changed     *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+/******************************************************************************
+ * *
+ *检查缓存中的函数所属的触发器、监控项或监控项所属主机是否在变更日志中。
+ ******************************************************************************/
+static int	dbsync_function_changed(const ZBX_DC_FUNCTION *function)
+{
+	const ZBX_DC_ITEM	*item;
+
+	if (FAIL != zbx_vector_uint64_bsearch(&dbsync_env.triggerids, function->triggerid,
+			ZBX_DEFAULT_UINT64_COMPARE_FUNC))
+	{
+		return SUCCEED;
+	}
+
+	if (FAIL != zbx_vector_uint64_bsearch(&dbsync_env.itemids, function->itemid, ZBX_DEFAULT_UINT64_COMPARE_FUNC))
+		return SUCCEED;
+
+	if (0 == dbsync_env.hostids.values_num)
+		return FAIL;
+
+	if (NULL == (item = (const ZBX_DC_ITEM *)zbx_hashset_search(&dbsync_env.cache->items, &function->itemid)))
+		return FAIL;
+
+	return FAIL == zbx_vector_uint64_bsearch(&dbsync_env.hostids, item->hostid, ZBX_DEFAULT_UINT64_COMPARE_FUNC) ?
+			FAIL : SUCCEED;
+}
 
 /******************************************************************************
  *                                                                            *
- * Function: dbsync_env_release                                               *
+ * Function: dbsync_env_add_changed_functions                                 *
+ *                                                                            *
+ * Purpose: finds cached functions affected by the changed hosts, items and   *
+ *          triggers and adds their triggers to the changed triggers          *
  *                                                                            *
  ******************************************************************************/
-void	zbx_dbsync_free_env(void)
+/******************************************************************************
+ * *
+ *遍历缓存中的函数，记录受变更影响的函数ID，并将其触发器加入需要重新比较的触发器列表。
+ ******************************************************************************/
+static void	dbsync_env_add_changed_functions(void)
 {
-	zbx_hashset_destroy(&dbsync_env.strpool);
+	zbx_hashset_iter_t	iter;
+	ZBX_DC_FUNCTION		*function;
+	zbx_vector_uint64_t	triggerids;
+
+	zbx_vector_uint64_create(&triggerids);
+
+	zbx_hashset_iter_reset(&dbsync_env.cache->functions, &iter);
+	while (NULL != (function = (ZBX_DC_FUNCTION *)zbx_hashset_iter_next(&iter)))
+	{
+		if (SUCCEED != dbsync_function_changed(function))
+			continue;
+
+		zbx_vector_uint64_append(&dbsync_env.functionids, function->functionid);
+		zbx_vector_uint64_append(&triggerids, function->triggerid);
+	}
+
+	/* the triggers of affected functions must be compared with database */
+	// 受影响的触发器需要与数据库重新比较
+	zbx_vector_uint64_append_array(&dbsync_env.triggerids, triggerids.values, triggerids.values_num);
+	zbx_vector_uint64_sort(&dbsync_env.triggerids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_vector_uint64_uniq(&dbsync_env.triggerids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	zbx_vector_uint64_destroy(&triggerids);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_dbsync_env_prepare                                           *
+ *                                                                            *
+ * Purpose: reads changelog table and decides whether items, triggers and     *
+ *          functions can be synchronized incrementally                       *
+ *                                                                            *
+ * Parameters: mode - [IN] the synchronization mode (ZBX_DBSYNC_INIT,         *
+ *                         ZBX_DBSYNC_UPDATE)                                 *
+ *                                                                            *
+ * Return value: SUCCEED - the changelog was read or incremental              *
+ *                         synchronization is disabled                        *
+ *               FAIL    - database error                                     *
+ *                                                                            *
+ * Comments: The changelog table is populated by database triggers (see       *
+ *           database/<type>/changelog.sql) or by the frontend/API. Only the  *
+ *           rows of changed objects are selected from items, triggers and    *
+ *           functions tables, other tables are still compared in full.       *
+ *           Initial synchronization and every CacheUpdateFullFrequency       *
+ *           seconds a full comparison is done to pick up changes that were   *
+ *           not recorded in changelog (for example, cascaded deletes).       *
+ *           Initial synchronization loads configuration snapshot if          *
+ *           CacheSnapshotFile is set and the snapshot matches database.      *
+ *                                                                            *
+ ******************************************************************************/
+/******************************************************************************
+ * *
+ *读取变更日志表，收集自上次同步以来变化的主机、监控项和触发器ID。
+ *初始同步或到达完整同步周期时仍然进行完整的表比较，否则只同步变化的行。
+ ******************************************************************************/
+int	zbx_dbsync_env_prepare(unsigned char mode)
+{
+	const char	*__function_name = "zbx_dbsync_env_prepare";
+
+	DB_RESULT	result;
+	DB_ROW		row;
+	char		*sql = NULL;
+	zbx_uint64_t	changelogid = 0, objectid;
+	int		ret = SUCCEED, rows_num;
+
+	if (0 == CONFIG_CONFSYNCER_CHANGELOG)
+		return SUCCEED;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
+
+	/* the changelog table is optional, incremental synchronization is disabled without it */
+	// 变更日志表是可选的，不存在时禁用增量同步
+	if (FAIL == changelog_table && FAIL == (changelog_table = DBtable_exists("changelog")))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot find \"changelog\" table, incremental configuration cache"
+				" update is disabled");
+		CONFIG_CONFSYNCER_CHANGELOG = 0;
+		goto out;
+	}
+
+	/* the records are read in batches, so that a large backlog does not end up in one result set */
+	// 分批读取变更日志，避免积压的大量记录一次性进入结果集
+	do
+	{
+		sql = zbx_dsprintf(sql, "select changelogid,object,objectid from changelog"
+				" where changelogid>" ZBX_FS_UI64
+				" order by changelogid", changelogid);
+
+		if (NULL == (result = DBselectN(sql, ZBX_DBSYNC_CHANGELOG_BATCH_SIZE)))
+		{
+			ret = FAIL;
+			goto out;
+		}
+
+		rows_num = 0;
+
+		while (NULL != (row = DBfetch(result)))
+		{
+			rows_num++;
+
+			ZBX_STR2UINT64(changelogid, row[0]);
+			ZBX_STR2UINT64(objectid, row[2]);
+
+			/* the snapshot revision record is replaced rather than removed after synchronization */
+			if (ZBX_DBSYNC_OBJ_SNAPSHOT == atoi(row[1]))
+			{
+				dbsync_env.revision = objectid;
+				continue;
+			}
+
+			zbx_vector_uint64_append(&dbsync_env.changelogids, changelogid);
+
+			switch (atoi(row[1]))
+			{
+				case ZBX_DBSYNC_OBJ_HOST:
+					zbx_vector_uint64_append(&dbsync_env.hostids, objectid);
+					break;
+				case ZBX_DBSYNC_OBJ_ITEM:
+					zbx_vector_uint64_append(&dbsync_env.itemids, objectid);
+					break;
+				case ZBX_DBSYNC_OBJ_TRIGGER:
+					zbx_vector_uint64_append(&dbsync_env.triggerids, objectid);
+					break;
+			}
+		}
+		DBfree_result(result);
+	}
+	while (ZBX_DBSYNC_CHANGELOG_BATCH_SIZE == rows_num);
+
+	/* initial synchronization and periodic synchronization every CacheUpdateFullFrequency are full */
+	// 初始同步或到达完整同步周期时进行完整比较
+	if (ZBX_DBSYNC_INIT == mode || changelog_full_sync + CONFIG_CONFSYNCER_FULL_FREQUENCY <= time(NULL))
+		goto out;
+
+	zbx_vector_uint64_sort(&dbsync_env.hostids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_vector_uint64_uniq(&dbsync_env.hostids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_vector_uint64_sort(&dbsync_env.itemids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_vector_uint64_uniq(&dbsync_env.itemids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_vector_uint64_sort(&dbsync_env.triggerids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_vector_uint64_uniq(&dbsync_env.triggerids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	dbsync_env_add_changed_functions();
+
+	dbsync_env.changelog = SUCCEED;
+out:
+	zbx_free(sql);
+
+	if (SUCCEED == ret && 0 != CONFIG_CONFSYNCER_CHANGELOG && NULL != CONFIG_CONFSYNCER_SNAPSHOT_FILE)
+	{
+		if (ZBX_DBSYNC_INIT == mode && SUCCEED == dbsync_snapshot_load())
+		{
+			/* the changes recorded after snapshot are applied by the next incremental synchronization */
+			zbx_vector_uint64_clear(&dbsync_env.changelogids);
+			zbx_vector_uint64_clear(&dbsync_env.hostids);
+			zbx_vector_uint64_clear(&dbsync_env.itemids);
+			zbx_vector_uint64_clear(&dbsync_env.triggerids);
+
+			dbsync_env.snapshot = SUCCEED;
+		}
+		else
+			dbsync_snapshot_begin(SUCCEED == dbsync_env.changelog ? FAIL : SUCCEED);
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s changelog:%d hosts:%d items:%d triggers:%d revision:" ZBX_FS_UI64,
+			__function_name, zbx_result_string(ret), dbsync_env.changelogids.values_num,
+			dbsync_env.hostids.values_num, dbsync_env.itemids.values_num, dbsync_env.triggerids.values_num,
+			dbsync_env.revision);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_dbsync_env_flush_changelog                                   *
+ *                                                                            *
+ * Purpose: removes the changelog records applied to configuration cache      *
+ *                                                                            *
+ * Comments: Called after successful configuration cache synchronization.     *
+ *           The records are removed by identifiers, so changes committed     *
+ *           during synchronization are picked up by the next one.            *
+ *           The configuration snapshot is committed first and its revision   *
+ *           is stored in changelog table in the same transaction with the    *
+ *           removal of applied records.                                      *
+ *                                                                            *
+ ******************************************************************************/
+/******************************************************************************
+ * *
+ *同步成功后按ID删除已处理的变更日志记录，同步过程中新提交的记录留待下一次同步处理。
+ ******************************************************************************/
+void	zbx_dbsync_env_flush_changelog(void)
+{
+	char		*sql = NULL;
+	size_t		sql_alloc = 0, sql_offset = 0;
+	int		snapshot;
+	zbx_uint64_t	revision = snapshot_revision;
+
+	if (0 == CONFIG_CONFSYNCER_CHANGELOG)
+		return;
+
+	if (FAIL == dbsync_env.changelog)
+		changelog_full_sync = time(NULL);
+
+	snapshot = dbsync_snapshot_commit();
+
+	if (0 == dbsync_env.changelogids.values_num && revision == snapshot_revision)
+		return;
+
+	DBbegin();
+
+	if (0 != dbsync_env.changelogids.values_num)
+	{
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, "delete from changelog where");
+		DBadd_condition_alloc(&sql, &sql_alloc, &sql_offset, "changelogid", dbsync_env.changelogids.values,
+				dbsync_env.changelogids.values_num);
+
+		DBexecute("%s", sql);
+
+		zbx_free(sql);
+	}
+
+	/* the snapshot without the applied changes must not be loaded anymore */
+	DBexecute("delete from changelog where object=%d", ZBX_DBSYNC_OBJ_SNAPSHOT);
+
+	if (SUCCEED == snapshot)
+	{
+		DBexecute("insert into changelog (object,objectid,operation,clock) values (%d," ZBX_FS_UI64 ",0,%d)",
+				ZBX_DBSYNC_OBJ_SNAPSHOT, snapshot_revision, (int)time(NULL));
+	}
+
+	DBcommit();
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_dbsync_env_snapshot                                          *
+ *                                                                            *
+ * Purpose: checks if configuration snapshot was loaded by the current        *
+ *          synchronization                                                   *
+ *                                                                            *
+ * Return value: SUCCEED - items, triggers and functions were read from       *
+ *                         configuration snapshot                             *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_dbsync_env_snapshot(void)
+{
+	return dbsync_env.snapshot;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: dbsync_changelog_condition                                       *
+ *                                                                            *
+ * Purpose: adds condition selecting only the rows of objects changed since   *
+ *          the last synchronization                                          *
+ *                                                                            *
+ * Parameters: sql        - [IN/OUT] the sql query                            *
+ *             sql_alloc  - [IN/OUT] the sql query allocated size             *
+ *             sql_offset - [IN/OUT] the sql query length                     *
+ *             hostid     - [IN] the host identifier field name, optional     *
+ *             itemid     - [IN] the item identifier field name, optional     *
+ *             triggerid  - [IN] the trigger identifier field name, optional  *
+ *                                                                            *
+ * Return value: SUCCEED - the condition was added                            *
+ *               FAIL    - there are no changed objects to select             *
+ *                                                                            *
+ ******************************************************************************/
+/******************************************************************************
+ * *
+ *为查询语句添加条件，只选择变化的主机、监控项或触发器相关的行。
+ ******************************************************************************/
+static int	dbsync_changelog_condition(char **sql, size_t *sql_alloc, size_t *sql_offset, const char *hostid,
+		const char *itemid, const char *triggerid)
+{
+	const char		*fields[] = {hostid, itemid, triggerid};
+	zbx_vector_uint64_t	*ids[] = {&dbsync_env.hostids, &dbsync_env.itemids, &dbsync_env.triggerids};
+	const char		*separator = " and (";
+	int			i, ret = FAIL;
+
+	for (i = 0; i < (int)ARRSIZE(fields); i++)
+	{
+		if (NULL == fields[i] || 0 == ids[i]->values_num)
+			continue;
+
+		zbx_strcpy_alloc(sql, sql_alloc, sql_offset, separator);
+		DBadd_condition_alloc(sql, sql_alloc, sql_offset, fields[i], ids[i]->values, ids[i]->values_num);
+		separator = " or";
+		ret = SUCCEED;
+	}
+
+	if (SUCCEED == ret)
+		zbx_chrcpy_alloc(sql, sql_alloc, sql_offset, ')');
+
+	return ret;
 }
 
 /******************************************************************************
@@ -561,7 +1840,7 @@ void	zbx_dbsync_free_env(void)
  *这段代码的主要目的是初始化一个zbx_dbsync结构体，根据传入的同步模式（ZBX_DBSYNC_UPDATE或其他）设置相应的状态和数据结构。在同步模式为ZBX_DBSYNC_UPDATE时，还会创建一个用于存储行数据的zbx_vector_ptr对象，并初始化行索引。
  ******************************************************************************/
 // 定义一个函数，用于初始化zbx_dbsync结构体
-void zbx_dbsync_init(zbx_dbsync_t *sync, unsigned char mode)
+void	zbx_dbsync_init(zbx_dbsync_t *sync, unsigned char mode)
 {
 	// 初始化同步状态的结构体指针
 	sync->columns_num = 0;
@@ -580,6 +1859,11 @@ void zbx_dbsync_init(zbx_dbsync_t *sync, unsigned char mode)
 	// 创建一个用于存储列信息的zbx_vector_ptr对象
 	zbx_vector_ptr_create(&sync->columns);
 
+	sync->snapshot_object = 0;
+	sync->snapshot_offset = 0;
+	sync->snapshot_runtime = NULL;
+	sync->snapshot_row = NULL;
+
 	// 根据同步模式进行不同操作
 	if (ZBX_DBSYNC_UPDATE == sync->mode)
 	{
@@ -589,13 +1873,10 @@ void zbx_dbsync_init(zbx_dbsync_t *sync, unsigned char mode)
 		sync->row_index = 0;
 	}
 	else
-	{
 		// 初始化数据库操作结果为空
 		sync->dbresult = NULL;
-	}
 }
 
-
 /******************************************************************************
  *                                                                            *
  * Function: zbx_dbsync_clear                                                 *
@@ -618,6 +1899,7 @@ void zbx_dbsync_init(zbx_dbsync_t *sync, unsigned char mode)
 void	zbx_dbsync_clear(zbx_dbsync_t *sync)
 {
 	/* 释放行预处理分配的资源 */
+	/* free the resources allocated by row pre-processing */
 	zbx_vector_ptr_clear_ext(&sync->columns, zbx_ptr_free);
 	zbx_vector_ptr_destroy(&sync->columns);
 
@@ -652,12 +1934,16 @@ void	zbx_dbsync_clear(zbx_dbsync_t *sync)
 	else
 	{
 		// 如果是其他同步模式，则释放数据库结果集
-		DBfree_result(sync->dbresult);
-		sync->dbresult = NULL;
+		if (NULL != sync->dbresult)
+		{
+			DBfree_result(sync->dbresult);
+			sync->dbresult = NULL;
+		}
+
+		dbsync_snapshot_clear(sync);
 	}
 }
 
-
 /******************************************************************************
  *                                                                            *
  * Function: zbx_dbsync_next                                                  *
@@ -669,33 +1955,36 @@ void	zbx_dbsync_clear(zbx_dbsync_t *sync)
  *                          optional for new/updated rows)                    *
  *             row   - [OUT] the row data                                     *
  *             tag   - [OUT] the row tag, identifying changes                 *
+ *                           (see ZBX_DBSYNC_ROW_* defines)                   *
+ *                                                                            *
+ * Return value: SUCCEED - the next row was successfully retrieved            *
+ *               FAIL    - no more data to retrieve                           *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
- * /
- ******************************************************************************/* ******************************************************************************
- * zbx_dbsync_next 函数：从数据库中获取下一行数据
- * 
- * 参数：
- *   sync：zbx_dbsync_t 类型，同步对象
- *   rowid：zbx_uint64_t 类型，用于存储下一行的行ID
- *   row：char*** 类型，用于存储下一行的数据
- *   tag：unsigned char 类型，用于存储下一行的标签
- * 
- * 返回值：
- *   SUCCEED - 成功获取到下一行数据
- *   FAIL    - 没有更多数据可供获取
- * 
- * 注释：
- *   1. 如果同步模式为 ZBX_DBSYNC_UPDATE，则按照更新模式获取下一行数据
- *   2. 如果同步索引已经到达数据末尾，则返回 FAIL，表示没有更多数据
- *   3. 获取下一行数据，并将行ID、行数据和标签存储在传入的指针变量中
- *   4. 如果同步模式为查询模式（非更新模式），则从数据库中查询下一行数据
- *   5. 如果数据库查询失败，返回 FAIL，表示没有更多数据
- *   6. 对查询到的数据进行预处理，将其存储在 row 指针变量中
- *   7. 设置行ID为0，标签为 ZBX_DBSYNC_ROW_ADD
- *   8. 调用者需增加行数据的相关处理（如：插入、更新等）
- * 
- *******************************************************************************/
-
+ * *
+ *zbx_dbsync_next 函数：从数据库中获取下一行数据
+ *
+ *参数：
+ *  sync：zbx_dbsync_t 类型，同步对象
+ *  rowid：zbx_uint64_t 类型，用于存储下一行的行ID
+ *  row：char*** 类型，用于存储下一行的数据
+ *  tag：unsigned char 类型，用于存储下一行的标签
+ *
+ *返回值：
+ *  SUCCEED - 成功获取到下一行数据
+ *  FAIL    - 没有更多数据可供获取
+ *
+ *注释：
+ *  1. 如果同步模式为 ZBX_DBSYNC_UPDATE，则按照更新模式获取下一行数据
+ *  2. 如果同步索引已经到达数据末尾，则返回 FAIL，表示没有更多数据
+ *  3. 获取下一行数据，并将行ID、行数据和标签存储在传入的指针变量中
+ *  4. 如果同步模式为查询模式（非更新模式），则从数据库中查询下一行数据
+ *  5. 如果数据库查询失败，返回 FAIL，表示没有更多数据
+ *  6. 对查询到的数据进行预处理，将其存储在 row 指针变量中
+ *  7. 设置行ID为0，标签为 ZBX_DBSYNC_ROW_ADD
+ *  8. 调用者需增加行数据的相关处理（如：插入、更新等）
+ ******************************************************************************/
 int	zbx_dbsync_next(zbx_dbsync_t *sync, zbx_uint64_t *rowid, char ***row, unsigned char *tag)
 {
 	// 如果同步模式为 ZBX_DBSYNC_UPDATE
@@ -714,120 +2003,121 @@ int	zbx_dbsync_next(zbx_dbsync_t *sync, zbx_uint64_t *rowid, char ***row, unsign
 		*row = sync_row->row;
 		*tag = sync_row->tag;
 	}
-/******************************************************************************
- * *
- *这段代码的主要目的是比较主机数据库中的记录和主机缓存中的记录，对于不同的记录类型（新增、更新、删除），将它们添加到同步结果中。整个代码块的核心功能是通过循环遍历数据库查询结果和主机缓存，对比主机信息，并根据不同的情况标记为主机记录或删除记录。最后，将同步结果添加到指定的哈希集中。整个过程完成后，释放资源并返回成功。
- ******************************************************************************/
-int zbx_dbsync_compare_hosts(zbx_dbsync_t *sync)
-{
-	// 声明变量
-	DB_ROW			dbrow;
-	DB_RESULT		result;
-	zbx_hashset_t		ids;
-	zbx_hashset_iter_t	iter;
-	zbx_uint64_t		rowid;
-	ZBX_DC_HOST		*host;
-
-	// 数据库查询，查询hosts表中符合条件的记录
-#if defined(HAVE_POLARSSL) || defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
-	if (NULL == (result = DBselect(
-			"select hostid,proxy_hostid,host,ipmi_authtype,ipmi_privilege,ipmi_username,"
-				"ipmi_password,maintenance_status,maintenance_type,maintenance_from,"
-				"errors_from,available,disable_until,snmp_errors_from,"
-				"snmp_available,snmp_disable_until,ipmi_errors_from,ipmi_available,"
-				"ipmi_disable_until,jmx_errors_from,jmx_available,jmx_disable_until,"
-				"status,name,lastaccess,error,snmp_error,ipmi_error,jmx_error,tls_connect,tls_accept"
-				",tls_issuer,tls_subject,tls_psk_identity,tls_psk,proxy_address,auto_compress,"
-				"maintenanceid"
-			" from hosts"
-			" where status in (%d,%d,%d,%d)"
-				" and flags<>%d",
-			HOST_STATUS_MONITORED, HOST_STATUS_NOT_MONITORED,
-			HOST_STATUS_PROXY_ACTIVE, HOST_STATUS_PROXY_PASSIVE,
-			ZBX_FLAG_DISCOVERY_PROTOTYPE)))
+	else
 	{
-		return FAIL;
+		char	**dbrow;
+
+		if (NULL == sync->dbresult)
+		{
+			/* the rows of initial synchronization are read from configuration snapshot */
+			if (NULL == sync->snapshot_row || NULL == (dbrow = dbsync_snapshot_next(sync)))
+			{
+				*row = NULL;
+				return FAIL;
+			}
+		}
+		else if (NULL == (dbrow = DBfetch(sync->dbresult)))
+		{
+			*row = NULL;
+			return FAIL;
+		}
+		else
+			dbsync_snapshot_add_row(sync, dbrow);
+
+		*row = dbsync_preproc_row(sync, dbrow);
+
+		*rowid = 0;
+		*tag = ZBX_DBSYNC_ROW_ADD;
+
+		sync->add_num++;
 	}
 
-	// 初始化dbsync
-	dbsync_prepare(sync, 38, NULL);
-#else
-	if (NULL == (result = DBselect(
-			"select hostid,proxy_hostid,host,ipmi_authtype,ipmi_privilege,ipmi_username,"
-				"ipmi_password,maintenance_status,maintenance_type,maintenance_from,"
-				"errors_from,available,disable_until,snmp_errors_from,"
-				"snmp_available,snmp_disable_until,ipmi_errors_from,ipmi_available,"
-				"ipmi_disable_until,jmx_errors_from,jmx_available,jmx_disable_until,"
-				"status,name,lastaccess,error,snmp_error,ipmi_error,jmx_error,tls_connect,tls_accept,"
-				"proxy_address,auto_compress,maintenanceid"
-			" from hosts"
-			" where status in (%d,%d,%d,%d)"
-				" and flags<>%d",
-			HOST_STATUS_MONITORED, HOST_STATUS_NOT_MONITORED,
-			HOST_STATUS_PROXY_ACTIVE, HOST_STATUS_PROXY_PASSIVE,
-			ZBX_FLAG_DISCOVERY_PROTOTYPE)))
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_dbsync_compare_config                                        *
+ *                                                                            *
+ * Purpose: compares config table with cached configuration data              *
+ *                                                                            *
+ * Parameter: cache - [IN] the configuration cache                            *
+ *            sync  - [OUT] the changeset                                     *
+ *                                                                            *
+ * Return value: SUCCEED - the changeset was successfully calculated          *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_dbsync_compare_config(zbx_dbsync_t *sync)
+{
+	DB_RESULT	result;
+
+	if (NULL == (result = DBselect("select refresh_unsupported,discovery_groupid,snmptrap_logging,"
+				"severity_name_0,severity_name_1,severity_name_2,"
+				"severity_name_3,severity_name_4,severity_name_5,"
+				"hk_events_mode,hk_events_trigger,hk_events_internal,"
+				"hk_events_discovery,hk_events_autoreg,hk_services_mode,"
+				"hk_services,hk_audit_mode,hk_audit,hk_sessions_mode,hk_sessions,"
+				"hk_history_mode,hk_history_global,hk_history,hk_trends_mode,"
+				"hk_trends_global,hk_trends,default_inventory_mode"
+			" from config"
+			" order by configid")))
 	{
 		return FAIL;
 	}
 
-	// 初始化dbsync
-	dbsync_prepare(sync, 34, NULL);
-#endif
+	dbsync_prepare(sync, 27, NULL);
 
-	// 如果dbsync模式为初始化
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
-		// 设置dbsync结果为查询结果
 		sync->dbresult = result;
-		// 返回成功
 		return SUCCEED;
 	}
 
-	// 创建一个哈希集用于存储主机ID
-	zbx_hashset_create(&ids, dbsync_env.cache->hosts.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
-			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	DBfree_result(result);
 
-	// 遍历查询结果，对比主机信息
-	while (NULL != (dbrow = DBfetch(result)))
-	{
-		unsigned char	tag = ZBX_DBSYNC_ROW_NONE;
+	/* global configuration will be always synchronized directly with database */
+	THIS_SHOULD_NEVER_HAPPEN;
 
-		ZBX_STR2UINT64(rowid, dbrow[0]);
-		// 将主机ID插入哈希集中
-		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
+	return FAIL;
+}
 
-		// 查询主机缓存
-		if (NULL == (host = (ZBX_DC_HOST *)zbx_hashset_search(&dbsync_env.cache->hosts, &rowid)))
-			// 标记为新增主机
-			tag = ZBX_DBSYNC_ROW_ADD;
-		else if (FAIL == dbsync_compare_host(host, dbrow))
-			// 标记为更新主机
-			tag = ZBX_DBSYNC_ROW_UPDATE;
+/******************************************************************************
+ *                                                                            *
+ * Function: dbsync_compare_host                                              *
+ *                                                                            *
+ * Purpose: compares hosts table row with cached configuration data           *
+ *                                                                            *
+ * Parameter: cache - [IN] the configuration cache                            *
+ *            host  - [IN] the cached host                                    *
+ *            row   - [IN] the database row                                   *
+ *                                                                            *
+ * Return value: SUCCEED - the row matches configuration data                 *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	dbsync_compare_host(ZBX_DC_HOST *host, const DB_ROW dbrow)
+{
+	signed char	ipmi_authtype;
+	unsigned char	ipmi_privilege;
+	ZBX_DC_IPMIHOST	*ipmihost;
+	ZBX_DC_PROXY	*proxy;
 
-		// 添加主机到同步结果中
-		if (ZBX_DBSYNC_ROW_NONE != tag)
-			dbsync_add_row(sync, rowid, tag, dbrow);
+	if (FAIL == dbsync_compare_uint64(dbrow[1], host->proxy_hostid))
+	{
+		host->update_items = 1;
+		return FAIL;
 	}
 
-	// 遍历主机缓存，处理未匹配的主机
-	zbx_hashset_iter_reset(&dbsync_env.cache->hosts, &iter);
-	while (NULL != (host = (ZBX_DC_HOST *)zbx_hashset_iter_next(&iter)))
+	if (FAIL == dbsync_compare_uchar(dbrow[22], host->status))
 	{
-		// 查询哈希集中是否有主机ID
-		if (NULL == zbx_hashset_search(&ids, &host->hostid))
-			// 标记为删除主机
-			dbsync_add_row(sync, host->hostid, ZBX_DBSYNC_ROW_REMOVE, NULL);
+		host->update_items = 1;
+		return FAIL;
 	}
 
-	// 销毁哈希集
-	zbx_hashset_destroy(&ids);
-	// 释放查询结果
-	DBfree_result(result);
-
-	// 返回成功
-	return SUCCEED;
-}
+	host->update_items = 0;
 
+	if (FAIL == dbsync_compare_str(dbrow[2], host->host))
 		return FAIL;
 
 	/* 检查主机名称是否一致 */
@@ -860,55 +2150,6 @@ int zbx_dbsync_compare_hosts(zbx_dbsync_t *sync)
 		if (FAIL == dbsync_compare_str(dbrow[34], host->tls_dc_psk->tls_psk))
 			return FAIL;
 	}
-#endif
-
-	/* 检查IPMI相关信息是否一致 */
-	ipmi_authtype = (signed char)atoi(dbrow[3]);
-	ipmi_privilege = (unsigned char)atoi(dbrow[4]);
-
-	/* 检查IPMI主机是否已经存在，如果不存在，则创建一个新的IPMI主机 */
-	if (ZBX_IPMI_DEFAULT_AUTHTYPE != ipmi_authtype || ZBX_IPMI_DEFAULT_PRIVILEGE != ipmi_privilege ||
-			'\0' != *dbrow[5] || '\0' != *dbrow[6])	/* useipmi */
-	{
-		if (NULL == (ipmihost = (ZBX_DC_IPMIHOST *)zbx_hashset_search(&dbsync_env.cache->ipmihosts,
-				&host->hostid)))
-		{
-			return FAIL;
-		}
-
-		/* 检查IPMI认证类型和权限是否一致 */
-		if (ipmihost->ipmi_authtype != ipmi_authtype)
-			return FAIL;
-
-		if (ipmihost->ipmi_privilege != ipmi_privilege)
-			return FAIL;
-
-		/* 检查IPMI用户名和密码是否一致 */
-		if (FAIL == dbsync_compare_str(dbrow[5], ipmihost->ipmi_username))
-			return FAIL;
-
-		if (FAIL == dbsync_compare_str(dbrow[6], ipmihost->ipmi_password))
-			return FAIL;
-	}
-	else if (NULL != zbx_hashset_search(&dbsync_env.cache->ipmihosts, &host->hostid))
-		return FAIL;
-
-	/* 检查代理相关信息是否一致 */
-	if (NULL != (proxy = (ZBX_DC_PROXY *)zbx_hashset_search(&dbsync_env.cache->proxies, &host->hostid)))
-	{
-		/* 检查代理地址是否一致 */
-		if (FAIL == dbsync_compare_str(dbrow[31 + ZBX_HOST_TLS_OFFSET], proxy->proxy_address))
-			return FAIL;
-
-		/* 检查代理是否支持自动压缩 */
-		if (FAIL == dbsync_compare_uchar(dbrow[32 + ZBX_HOST_TLS_OFFSET], proxy->auto_compress))
-			return FAIL;
-	}
-
-	/* 如果所有比较都成功，则返回SUCCEED，表示主机信息一致 */
-	return SUCCEED;
-}
-
 
 #endif
 	if (FAIL == dbsync_compare_uchar(dbrow[29], host->tls_connect))
@@ -919,9 +2160,11 @@ int zbx_dbsync_compare_hosts(zbx_dbsync_t *sync)
 
 	/* IPMI hosts */
 
+	/* 检查IPMI相关信息是否一致 */
 	ipmi_authtype = (signed char)atoi(dbrow[3]);
 	ipmi_privilege = (unsigned char)atoi(dbrow[4]);
 
+	/* 检查IPMI主机是否已经存在，如果不存在，则创建一个新的IPMI主机 */
 	if (ZBX_IPMI_DEFAULT_AUTHTYPE != ipmi_authtype || ZBX_IPMI_DEFAULT_PRIVILEGE != ipmi_privilege ||
 			'\0' != *dbrow[5] || '\0' != *dbrow[6])	/* useipmi */
 	{
@@ -931,12 +2174,14 @@ int zbx_dbsync_compare_hosts(zbx_dbsync_t *sync)
 			return FAIL;
 		}
 
+		/* 检查IPMI认证类型和权限是否一致 */
 		if (ipmihost->ipmi_authtype != ipmi_authtype)
 			return FAIL;
 
 		if (ipmihost->ipmi_privilege != ipmi_privilege)
 			return FAIL;
 
+		/* 检查IPMI用户名和密码是否一致 */
 		if (FAIL == dbsync_compare_str(dbrow[5], ipmihost->ipmi_username))
 			return FAIL;
 
@@ -947,18 +2192,26 @@ int zbx_dbsync_compare_hosts(zbx_dbsync_t *sync)
 		return FAIL;
 
 	/* proxies */
+	/* 检查代理相关信息是否一致 */
 	if (NULL != (proxy = (ZBX_DC_PROXY *)zbx_hashset_search(&dbsync_env.cache->proxies, &host->hostid)))
 	{
+		/* 检查代理地址是否一致 */
 		if (FAIL == dbsync_compare_str(dbrow[31 + ZBX_HOST_TLS_OFFSET], proxy->proxy_address))
 			return FAIL;
 
+		/* 检查代理是否支持自动压缩 */
 		if (FAIL == dbsync_compare_uchar(dbrow[32 + ZBX_HOST_TLS_OFFSET], proxy->auto_compress))
 			return FAIL;
 	}
 
+	/* 如果所有比较都成功，则返回SUCCEED，表示主机信息一致 */
 	return SUCCEED;
 }
 
+/******************************************************************************
+ * *
+ *这段代码的主要目的是比较主机数据库中的记录和主机缓存中的记录，对于不同的记录类型（新增、更新、删除），将它们添加到同步结果中。整个代码块的核心功能是通过循环遍历数据库查询结果和主机缓存，对比主机信息，并根据不同的情况标记为主机记录或删除记录。最后，将同步结果添加到指定的哈希集中。整个过程完成后，释放资源并返回成功。
+ ******************************************************************************/
 /******************************************************************************
  *                                                                            *
  * Function: zbx_dbsync_compare_hosts                                         *
@@ -972,8 +2225,9 @@ int zbx_dbsync_compare_hosts(zbx_dbsync_t *sync)
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-int	zbx_dbsync_compare_hosts(zbx_dbsync_t *sync)
+int zbx_dbsync_compare_hosts(zbx_dbsync_t *sync)
 {
+	// 声明变量
 	DB_ROW			dbrow;
 	DB_RESULT		result;
 	zbx_hashset_t		ids;
@@ -981,6 +2235,7 @@ int	zbx_dbsync_compare_hosts(zbx_dbsync_t *sync)
 	zbx_uint64_t		rowid;
 	ZBX_DC_HOST		*host;
 
+	// 数据库查询，查询hosts表中符合条件的记录
 #if defined(HAVE_POLARSSL) || defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
 	if (NULL == (result = DBselect(
 			"select hostid,proxy_hostid,host,ipmi_authtype,ipmi_privilege,ipmi_username,"
@@ -1001,101 +2256,74 @@ int	zbx_dbsync_compare_hosts(zbx_dbsync_t *sync)
 		return FAIL;
 	}
 
+	// 初始化dbsync
 	dbsync_prepare(sync, 38, NULL);
 #else
 	if (NULL == (result = DBselect(
 			"select hostid,proxy_hostid,host,ipmi_authtype,ipmi_privilege,ipmi_username,"
-/******************************************************************************
- * *
- *这段代码的主要目的是比较主机库存数据，并将比较结果保存在一个哈希集中。具体来说，它执行以下操作：
- *
- *1. 定义所需的变量，如数据库行、查询结果、哈希集等。
- *2. 定义查询语句，从数据库中获取主机库存数据。
- *3. 判断同步模式，初始化同步数据。
- *4. 创建哈希集，用于存储主机库存记录。
- *5. 遍历查询结果，解析主机库存记录，并将它们添加到哈希集中。
- *6. 重置哈希集迭代器，遍历主机库存记录，检查哈希集中是否包含主机ID。如果不包含，则删除主机库存记录。
- *7. 销毁哈希集，释放查询结果。
- *8. 返回成功。
- ******************************************************************************/
-int zbx_dbsync_compare_host_inventory(zbx_dbsync_t *sync)
-{
-	// 定义变量
-	DB_ROW			dbrow;
-	DB_RESULT		result;
-	zbx_hashset_t		ids;
-	zbx_hashset_iter_t	iter;
-	zbx_uint64_t		rowid;
-	ZBX_DC_HOST_INVENTORY	*hi;
-	const char		*sql;
-
-	// 定义查询语句
-	sql = "select hostid,inventory_mode,type,type_full,name,alias,os,os_full,os_short,serialno_a,"
-			"serialno_b,tag,asset_tag,macaddress_a,macaddress_b,hardware,hardware_full,software,"
-			"software_full,software_app_a,software_app_b,software_app_c,software_app_d,"
-			"software_app_e,contact,location,location_lat,location_lon,notes,chassis,model,"
-			"hw_arch,vendor,contract_number,installer_name,deployment_status,url_a,url_b,"
-			"url_c,host_networks,host_netmask,host_router,oob_ip,oob_netmask,oob_router,"
-			"date_hw_purchase,date_hw_install,date_hw_expiry,date_hw_decomm,site_address_a,"
-			"site_address_b,site_address_c,site_city,site_state,site_country,site_zip,site_rack,"
-			"site_notes,poc_1_name,poc_1_email,poc_1_phone_a,poc_1_phone_b,poc_1_cell,"
-			"poc_1_screen,poc_1_notes,poc_2_name,poc_2_email,poc_2_phone_a,poc_2_phone_b,"
-			"poc_2_cell,poc_2_screen,poc_2_notes"
-			" from host_inventory";
-
-	// 执行查询
-	if (NULL == (result = DBselect("%s", sql)))
+				"ipmi_password,maintenance_status,maintenance_type,maintenance_from,"
+				"errors_from,available,disable_until,snmp_errors_from,"
+				"snmp_available,snmp_disable_until,ipmi_errors_from,ipmi_available,"
+				"ipmi_disable_until,jmx_errors_from,jmx_available,jmx_disable_until,"
+				"status,name,lastaccess,error,snmp_error,ipmi_error,jmx_error,tls_connect,tls_accept,"
+				"proxy_address,auto_compress,maintenanceid"
+			" from hosts"
+			" where status in (%d,%d,%d,%d)"
+				" and flags<>%d",
+			HOST_STATUS_MONITORED, HOST_STATUS_NOT_MONITORED,
+			HOST_STATUS_PROXY_ACTIVE, HOST_STATUS_PROXY_PASSIVE,
+			ZBX_FLAG_DISCOVERY_PROTOTYPE)))
+	{
 		return FAIL;
+	}
 
-	// 预处理查询
-	dbsync_prepare(sync, 72, NULL);
+	// 初始化dbsync
+	dbsync_prepare(sync, 34, NULL);
+#endif
 
-	// 判断同步模式
+	// 如果dbsync模式为初始化
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
-		// 设置查询结果
+		// 设置dbsync结果为查询结果
 		sync->dbresult = result;
+		// 返回成功
 		return SUCCEED;
 	}
 
-	// 创建哈希集
-	zbx_hashset_create(&ids, dbsync_env.cache->host_inventories.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
+	// 创建一个哈希集用于存储主机ID
+	zbx_hashset_create(&ids, dbsync_env.cache->hosts.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
 			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 
-	// 遍历查询结果
+	// 遍历查询结果，对比主机信息
 	while (NULL != (dbrow = DBfetch(result)))
 	{
-		// 解析行ID
+		unsigned char	tag = ZBX_DBSYNC_ROW_NONE;
+
 		ZBX_STR2UINT64(rowid, dbrow[0]);
-		// 将行ID添加到哈希集中
+		// 将主机ID插入哈希集中
 		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
 
-		// 查找主机库存记录
-		if (NULL == (hi = (ZBX_DC_HOST_INVENTORY *)zbx_hashset_search(&dbsync_env.cache->host_inventories,
-				&rowid)))
-		{
-			// 新增主机库存记录
+		// 查询主机缓存
+		if (NULL == (host = (ZBX_DC_HOST *)zbx_hashset_search(&dbsync_env.cache->hosts, &rowid)))
+			// 标记为新增主机
 			tag = ZBX_DBSYNC_ROW_ADD;
-		}
-		else if (FAIL == dbsync_compare_host_inventory(hi, dbrow))
-			// 更新主机库存记录
+		else if (FAIL == dbsync_compare_host(host, dbrow))
+			// 标记为更新主机
 			tag = ZBX_DBSYNC_ROW_UPDATE;
 
+		// 添加主机到同步结果中
 		if (ZBX_DBSYNC_ROW_NONE != tag)
-			// 将记录添加到同步数据中
 			dbsync_add_row(sync, rowid, tag, dbrow);
-
 	}
 
-	// 重置哈希集迭代器
-	zbx_hashset_iter_reset(&dbsync_env.cache->host_inventories, &iter);
-	// 遍历主机库存记录
-	while (NULL != (hi = (ZBX_DC_HOST_INVENTORY *)zbx_hashset_iter_next(&iter)))
+	// 遍历主机缓存，处理未匹配的主机
+	zbx_hashset_iter_reset(&dbsync_env.cache->hosts, &iter);
+	while (NULL != (host = (ZBX_DC_HOST *)zbx_hashset_iter_next(&iter)))
 	{
-		// 检查哈希集中是否包含主机ID
-		if (NULL == zbx_hashset_search(&ids, &hi->hostid))
-			// 删除主机库存记录
-			dbsync_add_row(sync, hi->hostid, ZBX_DBSYNC_ROW_REMOVE, NULL);
+		// 查询哈希集中是否有主机ID
+		if (NULL == zbx_hashset_search(&ids, &host->hostid))
+			// 标记为删除主机
+			dbsync_add_row(sync, host->hostid, ZBX_DBSYNC_ROW_REMOVE, NULL);
 	}
 
 	// 销毁哈希集
@@ -1107,12 +2335,24 @@ int zbx_dbsync_compare_host_inventory(zbx_dbsync_t *sync)
 	return SUCCEED;
 }
 
- ******************************************************************************/
 /******************************************************************************
  * *
  *整个代码块的主要目的是比较数据库中的库存信息与内存中的库存信息是否一致。具体来说，就是依次比较数据库中的库存模式和库存字段值是否与内存中的库存模式和库存字段值一致。如果所有字段都比较一致，则返回SUCCEED（成功），否则返回FAIL（失败）。
  ******************************************************************************/
 // 定义一个静态函数dbsync_compare_host_inventory，接收两个参数，一个是ZBX_DC_HOST_INVENTORY类型的指针hi，另一个是DB_ROW类型的指针dbrow。
+/******************************************************************************
+ *                                                                            *
+ * Function: dbsync_compare_host_inventory                                    *
+ *                                                                            *
+ * Purpose: compares host inventory table row with cached configuration data  *
+ *                                                                            *
+ * Parameter: hi  - [IN] the cached host inventory data                       *
+ *            row - [IN] the database row                                     *
+ *                                                                            *
+ * Return value: SUCCEED - the row matches configuration data                 *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
 static int	dbsync_compare_host_inventory(const ZBX_DC_HOST_INVENTORY *hi, const DB_ROW dbrow)
 {
 	// 定义一个整型变量i，用于循环使用
@@ -1134,7 +2374,6 @@ static int	dbsync_compare_host_inventory(const ZBX_DC_HOST_INVENTORY *hi, const
 	return SUCCEED;
 }
 
-
 /******************************************************************************
  *                                                                            *
  * Function: zbx_dbsync_compare_host_inventory                                *
@@ -1148,8 +2387,22 @@ static int	dbsync_compare_host_inventory(const ZBX_DC_HOST_INVENTORY *hi, const
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
+/******************************************************************************
+ * *
+ *这段代码的主要目的是比较主机库存数据，并将比较结果保存在一个哈希集中。具体来说，它执行以下操作：
+ *
+ *1. 定义所需的变量，如数据库行、查询结果、哈希集等。
+ *2. 定义查询语句，从数据库中获取主机库存数据。
+ *3. 判断同步模式，初始化同步数据。
+ *4. 创建哈希集，用于存储主机库存记录。
+ *5. 遍历查询结果，解析主机库存记录，并将它们添加到哈希集中。
+ *6. 重置哈希集迭代器，遍历主机库存记录，检查哈希集中是否包含主机ID。如果不包含，则删除主机库存记录。
+ *7. 销毁哈希集，释放查询结果。
+ *8. 返回成功。
+ ******************************************************************************/
 int	zbx_dbsync_compare_host_inventory(zbx_dbsync_t *sync)
 {
+	// 定义变量
 	DB_ROW			dbrow;
 	DB_RESULT		result;
 	zbx_hashset_t		ids;
@@ -1158,6 +2411,7 @@ int	zbx_dbsync_compare_host_inventory(zbx_dbsync_t *sync)
 	ZBX_DC_HOST_INVENTORY	*hi;
 	const char		*sql;
 
+	// 定义查询语句
 	sql = "select hostid,inventory_mode,type,type_full,name,alias,os,os_full,os_short,serialno_a,"
 			"serialno_b,tag,asset_tag,macaddress_a,macaddress_b,hardware,hardware_full,software,"
 			"software_full,software_app_a,software_app_b,software_app_c,software_app_d,"
@@ -1171,53 +2425,85 @@ int	zbx_dbsync_compare_host_inventory(zbx_dbsync_t *sync)
 			"poc_2_cell,poc_2_screen,poc_2_notes"
 			" from host_inventory";
 
+	// 执行查询
 	if (NULL == (result = DBselect("%s", sql)))
 		return FAIL;
 
+	// 预处理查询
 	dbsync_prepare(sync, 72, NULL);
 
+	// 判断同步模式
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
+		// 设置查询结果
 		sync->dbresult = result;
 		return SUCCEED;
 	}
 
+	// 创建哈希集
 	zbx_hashset_create(&ids, dbsync_env.cache->host_inventories.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
 			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 
+	// 遍历查询结果
 	while (NULL != (dbrow = DBfetch(result)))
 	{
+		// 解析行ID
 		unsigned char	tag = ZBX_DBSYNC_ROW_NONE;
 
 		ZBX_STR2UINT64(rowid, dbrow[0]);
+		// 将行ID添加到哈希集中
 		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
 
+		// 查找主机库存记录
 		if (NULL == (hi = (ZBX_DC_HOST_INVENTORY *)zbx_hashset_search(&dbsync_env.cache->host_inventories,
 				&rowid)))
 		{
+			// 新增主机库存记录
 			tag = ZBX_DBSYNC_ROW_ADD;
 		}
 		else if (FAIL == dbsync_compare_host_inventory(hi, dbrow))
+			// 更新主机库存记录
 			tag = ZBX_DBSYNC_ROW_UPDATE;
 
 		if (ZBX_DBSYNC_ROW_NONE != tag)
+			// 将记录添加到同步数据中
 			dbsync_add_row(sync, rowid, tag, dbrow);
 
 	}
 
+	// 重置哈希集迭代器
 	zbx_hashset_iter_reset(&dbsync_env.cache->host_inventories, &iter);
+	// 遍历主机库存记录
 	while (NULL != (hi = (ZBX_DC_HOST_INVENTORY *)zbx_hashset_iter_next(&iter)))
 	{
+		// 检查哈希集中是否包含主机ID
 		if (NULL == zbx_hashset_search(&ids, &hi->hostid))
+			// 删除主机库存记录
 			dbsync_add_row(sync, hi->hostid, ZBX_DBSYNC_ROW_REMOVE, NULL);
 	}
 
+	// 销毁哈希集
 	zbx_hashset_destroy(&ids);
+	// 释放查询结果
 	DBfree_result(result);
 
+	// 返回成功
 	return SUCCEED;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_dbsync_compare_host_templates                                *
+ *                                                                            *
+ * Purpose: compares hosts_templates table with cached configuration data     *
+ *                                                                            *
+ * Parameter: cache - [IN] the configuration cache                            *
+ *            sync  - [OUT] the changeset                                     *
+ *                                                                            *
+ * Return value: SUCCEED - the changeset was successfully calculated          *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  *                                                                            *
 /******************************************************************************
@@ -1236,6 +2522,15 @@ int	zbx_dbsync_compare_host_inventory(zbx_dbsync_t *sync)
 int	zbx_dbsync_compare_host_templates(zbx_dbsync_t *sync)
 {
 	/* 定义变量，这里就不一一解释了，后面会详细解释 */
+	DB_ROW			dbrow;
+	DB_RESULT		result;
+	zbx_hashset_iter_t	iter;
+	ZBX_DC_HTMPL		*htmpl;
+	zbx_hashset_t		htmpls;
+	int			i;
+	zbx_uint64_pair_t	ht_local, *ht;
+	char			hostid_s[MAX_ID_LEN + 1], templateid_s[MAX_ID_LEN + 1];
+	char			*del_row[2] = {hostid_s, templateid_s};
 
 	if (NULL == (result = DBselect(
 			"select hostid,templateid"
@@ -1256,6 +2551,7 @@ int	zbx_dbsync_compare_host_templates(zbx_dbsync_t *sync)
 	zbx_hashset_create(&htmpls, 100, ZBX_DEFAULT_UINT64_PAIR_HASH_FUNC, ZBX_DEFAULT_UINT64_PAIR_COMPARE_FUNC);
 
 	/* 遍历所有 host->template 链接 */
+	/* index all host->template links */
 	zbx_hashset_iter_reset(&dbsync_env.cache->htmpls, &iter);
 	while (NULL != (htmpl = (ZBX_DC_HTMPL *)zbx_hashset_iter_next(&iter)))
 	{
@@ -1269,6 +2565,7 @@ int	zbx_dbsync_compare_host_templates(zbx_dbsync_t *sync)
 	}
 
 	/* 添加新行，从索引中移除现有行 */
+	/* add new rows, remove existing rows from index */
 	while (NULL != (dbrow = DBfetch(result)))
 	{
 		ZBX_STR2UINT64(ht_local.first, dbrow[0]);
@@ -1281,6 +2578,7 @@ int	zbx_dbsync_compare_host_templates(zbx_dbsync_t *sync)
 	}
 
 	/* 添加删除的行 */
+	/* add removed rows */
 	zbx_hashset_iter_reset(&htmpls, &iter);
 	while (NULL != (ht = (zbx_uint64_pair_t *)zbx_hashset_iter_next(&iter)))
 	{
@@ -1295,14 +2593,6 @@ int	zbx_dbsync_compare_host_templates(zbx_dbsync_t *sync)
 	return SUCCEED;
 }
 
-	{
-		zbx_snprintf(hostid_s, sizeof(hostid_s), ZBX_FS_UI64, ht->first);
-		zbx_snprintf(templateid_s, sizeof(templateid_s), ZBX_FS_UI64, ht->second);
-		dbsync_add_row(sync, 0, ZBX_DBSYNC_ROW_REMOVE, del_row);
-	}
-
-	DBfree_result(result);
-	zbx_hashset_destroy(&htmpls);
 /******************************************************************************
  * *
  *整个代码块的主要目的是比较全局宏（gmacro）和数据库中的一行数据（dbrow），具体包括以下几个步骤：
@@ -1364,6 +2654,19 @@ int	zbx_dbsync_compare_host_templates(zbx_dbsync_t *sync)
  *```
  ******************************************************************************/
 // 定义一个静态函数，用于比较全局宏（gmacro）和数据库中的一行数据（dbrow）
+/******************************************************************************
+ *                                                                            *
+ * Function: dbsync_compare_global_macro                                      *
+ *                                                                            *
+ * Purpose: compares global macro table row with cached configuration data    *
+ *                                                                            *
+ * Parameter: gmacro - [IN] the cached global macro data                      *
+ *            row    - [IN] the database row                                  *
+ *                                                                            *
+ * Return value: SUCCEED - the row matches configuration data                 *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
 static int	dbsync_compare_global_macro(const ZBX_DC_GMACRO *gmacro, const DB_ROW dbrow)
 {
 	// 声明两个字符指针macro和context，以及一个整型变量ret，用于存储比较结果
@@ -1407,24 +2710,6 @@ out:
 	zbx_free(context);
 
 	// 返回比较结果
-	return ret;
-}
-
-			goto out;
-
-		ret = SUCCEED;
-		goto out;
-	}
-
-	if (NULL == gmacro->context)
-		goto out;
-
-	if (0 == strcmp(gmacro->context, context))
-		ret = SUCCEED;
-out:
-	zbx_free(macro);
-	zbx_free(context);
-
 	return ret;
 }
 
@@ -1762,6 +3047,22 @@ static int	dbsync_compare_interface(const ZBX_DC_INTERFACE *interface, const DB_
 		return FAIL;
 
 	// 如果以上所有判断都通过，返回SUCCEED
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_dbsync_compare_interfaces                                    *
+ *                                                                            *
+ * Purpose: compares interfaces table with cached configuration data          *
+ *                                                                            *
+ * Parameter: cache - [IN] the configuration cache                            *
+ *            sync  - [OUT] the changeset                                     *
+ *                                                                            *
+ * Return value: SUCCEED - the changeset was successfully calculated          *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  * *
  *整个代码块的主要目的是比较数据库中查询到的接口信息与缓存中的接口信息，并将差异应用于同步数据。具体来说，代码实现了以下功能：
@@ -1778,9 +3079,77 @@ static int	dbsync_compare_interface(const ZBX_DC_INTERFACE *interface, const DB_
  *10. 销毁哈希集合，释放数据库查询结果。
  *11. 返回成功。
  ******************************************************************************/
-int zbx_dbsync_compare_interfaces(zbx_dbsync_t *sync)
+int	zbx_dbsync_compare_interfaces(zbx_dbsync_t *sync)
 {
 	// 声明变量
+	DB_ROW			dbrow;
+	DB_RESULT		result;
+	zbx_hashset_t		ids;
+	zbx_hashset_iter_t	iter;
+	zbx_uint64_t		rowid;
+	ZBX_DC_INTERFACE	*interface;
+
+	if (NULL == (result = DBselect(
+			"select interfaceid,hostid,type,main,useip,ip,dns,port,bulk"
+			" from interface")))
+	{
+		return FAIL;
+	}
+
+	dbsync_prepare(sync, 9, NULL);
+
+	if (ZBX_DBSYNC_INIT == sync->mode)
+	{
+		sync->dbresult = result;
+		return SUCCEED;
+	}
+
+	zbx_hashset_create(&ids, dbsync_env.cache->interfaces.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
+			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	while (NULL != (dbrow = DBfetch(result)))
+	{
+		unsigned char	tag = ZBX_DBSYNC_ROW_NONE;
+
+		ZBX_STR2UINT64(rowid, dbrow[0]);
+		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
+
+		if (NULL == (interface = (ZBX_DC_INTERFACE *)zbx_hashset_search(&dbsync_env.cache->interfaces, &rowid)))
+			tag = ZBX_DBSYNC_ROW_ADD;
+		else if (FAIL == dbsync_compare_interface(interface, dbrow))
+			tag = ZBX_DBSYNC_ROW_UPDATE;
+
+		if (ZBX_DBSYNC_ROW_NONE != tag)
+			dbsync_add_row(sync, rowid, tag, dbrow);
+	}
+
+	zbx_hashset_iter_reset(&dbsync_env.cache->interfaces, &iter);
+	while (NULL != (interface = (ZBX_DC_INTERFACE *)zbx_hashset_iter_next(&iter)))
+	{
+		if (NULL == zbx_hashset_search(&ids, &interface->interfaceid))
+			dbsync_add_row(sync, interface->interfaceid, ZBX_DBSYNC_ROW_REMOVE, NULL);
+	}
+
+	zbx_hashset_destroy(&ids);
+	DBfree_result(result);
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: dbsync_compare_item                                              *
+ *                                                                            *
+ * Purpose: compares items table row with cached configuration data           *
+ *                                                                            *
+ * Parameter: cache - [IN] the configuration cache                            *
+ *            item  - [IN] the cached item                                    *
+ *            row   - [IN] the database row                                   *
+ *                                                                            *
+ * Return value: SUCCEED - the row matches configuration data                 *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  * 以下是对代码的逐行注释：
  *
@@ -1789,375 +3158,362 @@ int zbx_dbsync_compare_interfaces(zbx_dbsync_t *sync)
 // 定义一个名为 dbsync_compare_item 的函数，该函数用于比较两个数据项（来自数据库和内存中的数据项）
 static int	dbsync_compare_item(const ZBX_DC_ITEM *item, const DB_ROW dbrow)
 {
-    // 定义一个指向数据项类型的指针
-    ZBX_DC_NUMITEM	*numitem;
-    ZBX_DC_SNMPITEM	*snmpitem;
-    ZBX_DC_IPMIITEM	*ipmiitem;
-    ZBX_DC_TRAPITEM	*trapitem;
-    ZBX_DC_LOGITEM	*logitem;
-    ZBX_DC_DBITEM	*dbitem;
-    ZBX_DC_SSHITEM	*sshitem;
-    ZBX_DC_TELNETITEM	*telnetitem;
-    ZBX_DC_SIMPLEITEM	*simpleitem;
-    ZBX_DC_JMXITEM	*jmxitem;
-    ZBX_DC_CALCITEM	*calcitem;
-    ZBX_DC_DEPENDENTITEM	*depitem;
-    ZBX_DC_HOST		*host;
-    ZBX_DC_HTTPITEM	*httpitem;
-    unsigned char		value_type, type;
-    int			history_sec, trends_sec;
-
-    // 比较主机 ID
-    if (FAIL == dbsync_compare_uint64(dbrow[1], item->hostid))
-        return FAIL;
+	// 定义一个指向数据项类型的指针
+	ZBX_DC_NUMITEM		*numitem;
+	ZBX_DC_SNMPITEM		*snmpitem;
+	ZBX_DC_IPMIITEM		*ipmiitem;
+	ZBX_DC_TRAPITEM		*trapitem;
+	ZBX_DC_LOGITEM		*logitem;
+	ZBX_DC_DBITEM		*dbitem;
+	ZBX_DC_SSHITEM		*sshitem;
+	ZBX_DC_TELNETITEM	*telnetitem;
+	ZBX_DC_SIMPLEITEM	*simpleitem;
+	ZBX_DC_JMXITEM		*jmxitem;
+	ZBX_DC_CALCITEM		*calcitem;
+	ZBX_DC_DEPENDENTITEM	*depitem;
+	ZBX_DC_HOST		*host;
+	ZBX_DC_HTTPITEM		*httpitem;
+	unsigned char		value_type, type;
+	int			history_sec, trends_sec;
 
-    // 从内存中查找主机
-    if (NULL == (host = (ZBX_DC_HOST *)zbx_hashset_search(&dbsync_env.cache->hosts, &item->hostid)))
-        return FAIL;
+	// 比较主机 ID
+	if (FAIL == dbsync_compare_uint64(dbrow[1], item->hostid))
+		return FAIL;
 
-    // 检查是否有更新项
-    if (0 != host->update_items)
-        return FAIL;
+	// 从内存中查找主机
+	if (NULL == (host = (ZBX_DC_HOST *)zbx_hashset_search(&dbsync_env.cache->hosts, &item->hostid)))
+		return FAIL;
 
-    // 比较状态
-    if (FAIL == dbsync_compare_uchar(dbrow[2], item->status))
-        return FAIL;
+	// 检查是否有更新项
+	if (0 != host->update_items)
+		return FAIL;
 
-    // 解析数据项类型
-    ZBX_STR2UCHAR(type, dbrow[3]);
-    // 比较数据项类型
-    if (item->type != type)
-        return FAIL;
+	// 比较状态
+	if (FAIL == dbsync_compare_uchar(dbrow[2], item->status))
+		return FAIL;
 
-    // 比较端口
-    if (FAIL == dbsync_compare_str(dbrow[8], item->port))
-        return FAIL;
+	// 解析数据项类型
+	ZBX_STR2UCHAR(type, dbrow[3]);
+	// 比较数据项类型
+	if (item->type != type)
+		return FAIL;
 
-    // 比较标志
-    if (FAIL == dbsync_compare_uchar(dbrow[24], item->flags))
-        return FAIL;
+	// 比较端口
+	if (FAIL == dbsync_compare_str(dbrow[8], item->port))
+		return FAIL;
 
-    // 比较接口 ID
-    if (FAIL == dbsync_compare_uint64(dbrow[25], item->interfaceid))
-        return FAIL;
+	// 比较标志
+	if (FAIL == dbsync_compare_uchar(dbrow[24], item->flags))
+		return FAIL;
 
-    // 获取历史秒数
-    if (SUCCEED != is_time_suffix(dbrow[31], &history_sec, ZBX_LENGTH_UNLIMITED))
-        history_sec = ZBX_HK_PERIOD_MAX;
+	// 比较接口 ID
+	if (FAIL == dbsync_compare_uint64(dbrow[25], item->interfaceid))
+		return FAIL;
 
-    // 获取趋势秒数
-    if (0 != history_sec && ZBX_HK_OPTION_ENABLED == dbsync_env.cache->config->hk.history_global)
-        history_sec = dbsync_env.cache->config->hk.history;
+	// 获取历史秒数
+	if (SUCCEED != is_time_suffix(dbrow[31], &history_sec, ZBX_LENGTH_UNLIMITED))
+		history_sec = ZBX_HK_PERIOD_MAX;
 
-    // 比较历史秒数
-    if (item->history != (0 != history_sec))
-        return FAIL;
+	// 获取趋势秒数
+	if (0 != history_sec && ZBX_HK_OPTION_ENABLED == dbsync_env.cache->config->hk.history_global)
+		history_sec = dbsync_env.cache->config->hk.history;
 
-    // 比较历史秒数
-    if (history_sec != item->history_sec)
-        return FAIL;
+	// 比较历史秒数
+	if (item->history != (0 != history_sec))
+		return FAIL;
 
-    // 比较 inventory_link
-    if (FAIL == dbsync_compare_uchar(dbrow[33], item->inventory_link))
-        return FAIL;
+	// 比较历史秒数
+	if (history_sec != item->history_sec)
+		return FAIL;
 
-    // 比较值映射 ID
-    if (FAIL == dbsync_compare_uint64(dbrow[34], item->valuemapid))
-        return FAIL;
+	// 比较 inventory_link
+	if (FAIL == dbsync_compare_uchar(dbrow[33], item->inventory_link))
+		return FAIL;
 
-    // 解析数据项类型
-    ZBX_STR2UCHAR(value_type, dbrow[4]);
-    // 比较数据项类型
-    if (item->value_type != value_type)
-        return FAIL;
+	// 比较值映射 ID
+	if (FAIL == dbsync_compare_uint64(dbrow[34], item->valuemapid))
+		return FAIL;
 
-    // 比较键
-    if (FAIL == dbsync_compare_str(dbrow[5], item->key))
-        return FAIL;
+	// 解析数据项类型
+	ZBX_STR2UCHAR(value_type, dbrow[4]);
+	// 比较数据项类型
+	if (item->value_type != value_type)
+		return FAIL;
 
-    // 比较延迟
-    if (FAIL == dbsync_compare_str(dbrow[14], item->delay))
-        return FAIL;
+	// 比较键
+	if (FAIL == dbsync_compare_str(dbrow[5], item->key))
+		return FAIL;
 
-    // 比较数值类型
-    numitem = (ZBX_DC_NUMITEM *)zbx_hashset_search(&dbsync_env.cache->numitems, &item->itemid);
-    if (ITEM_VALUE_TYPE_FLOAT == value_type || ITEM_VALUE_TYPE_UINT64 == value_type)
-    {
-        // 获取趋势秒数
-        if (SUCCEED != is_time_suffix(dbrow[32], &trends_sec, ZBX_LENGTH_UNLIMITED))
-            trends_sec = ZBX_HK_PERIOD_MAX;
+	// 比较延迟
+	if (FAIL == dbsync_compare_str(dbrow[14], item->delay))
+		return FAIL;
 
-        // 获取趋势配置
-        if (0 != trends_sec && ZBX_HK_OPTION_ENABLED == dbsync_env.cache->config->hk.trends_global)
-            trends_sec = dbsync_env.cache->config->hk.trends;
+	// 比较数值类型
+	numitem = (ZBX_DC_NUMITEM *)zbx_hashset_search(&dbsync_env.cache->numitems, &item->itemid);
+	if (ITEM_VALUE_TYPE_FLOAT == value_type || ITEM_VALUE_TYPE_UINT64 == value_type)
+	{
+		// 获取趋势秒数
+		if (NULL == numitem)
+			return FAIL;
 
-        // 比较趋势配置
-        if (numitem->trends != (0 != trends_sec))
-            return FAIL;
+		if (SUCCEED != is_time_suffix(dbrow[32], &trends_sec, ZBX_LENGTH_UNLIMITED))
+			trends_sec = ZBX_HK_PERIOD_MAX;
 
-        // 比较单位
-        if (FAIL == dbsync_compare_str(dbrow[35], numitem->units))
-            return FAIL;
-    }
-    else if (NULL != numitem)
-        return FAIL;
+		// 获取趋势配置
+		if (0 != trends_sec && ZBX_HK_OPTION_ENABLED == dbsync_env.cache->config->hk.trends_global)
+			trends_sec = dbsync_env.cache->config->hk.trends;
 
-    // 比较 SNMP 社区
-    snmpitem = (ZBX_DC_SNMPITEM *)zbx_hashset_search(&dbsync_env.cache->snmpitems, &item->itemid);
-    if (SUCCEED == is_snmp_type(type))
-    {
-        // 比较 SNMPv3 安全名
-        if (NULL == snmpitem)
-            return FAIL;
+		// 比较趋势配置
+		if (numitem->trends != (0 != trends_sec))
+			return FAIL;
 
-        // 比较 SNMPv3 安全级别
-        if (FAIL == dbsync_compare_uchar(dbrow[6], snmpitem->snmpv3_securitylevel))
-            return FAIL;
+		// 比较单位
+		if (FAIL == dbsync_compare_str(dbrow[35], numitem->units))
+			return FAIL;
+	}
+	else if (NULL != numitem)
+		return FAIL;
 
-        // 比较 SNMPv3 认证密码
-        if (FAIL == dbsync_compare_str(dbrow[11], snmpitem->snmpv3_authpassphrase))
-            return FAIL;
+	// 比较 SNMP 社区
+	snmpitem = (ZBX_DC_SNMPITEM *)zbx_hashset_search(&dbsync_env.cache->snmpitems, &item->itemid);
+	if (SUCCEED == is_snmp_type(type))
+	{
+		// 比较 SNMPv3 安全名
+		if (NULL == snmpitem)
+			return FAIL;
 
-        // 比较 SNMPv3 隐私密码
-        if (FAIL == dbsync_compare_str(dbrow[12], snmpitem->snmpv3_privpassphrase))
-            return FAIL;
+		// 比较 SNMPv3 安全级别
+		if (FAIL == dbsync_compare_str(dbrow[6], snmpitem->snmp_community))
+			return FAIL;
 
-        // 比较 SNMPv3 认证协议
-        if (FAIL == dbsync_compare_uchar(dbrow[26], snmpitem->snmpv3_authprotocol))
-            return FAIL;
+		// 比较 SNMPv3 认证密码
+		if (FAIL == dbsync_compare_str(dbrow[9], snmpitem->snmpv3_securityname))
+			return FAIL;
 
-        // 比较 SNMPv3 隐私协议
-        if (FAIL == dbsync_compare_uchar(dbrow[27], snmpitem->snmpv3_privprotocol))
-            return FAIL;
+		if (FAIL == dbsync_compare_uchar(dbrow[10], snmpitem->snmpv3_securitylevel))
+			return FAIL;
 
-        // 比较 SNMPv3 上下文名
-        if (FAIL == dbsync_compare_str(dbrow[28], snmpitem->snmpv3_contextname))
-            return FAIL;
+		if (FAIL == dbsync_compare_str(dbrow[11], snmpitem->snmpv3_authpassphrase))
+			return FAIL;
 
-        // 比较 OID
-        if (FAIL == dbsync_compare_str(dbrow[7], snmpitem->snmp_oid))
-            return FAIL;
-    }
-    else if (NULL != snmpitem)
-        return FAIL;
+		// 比较 SNMPv3 隐私密码
+		if (FAIL == dbsync_compare_str(dbrow[12], snmpitem->snmpv3_privpassphrase))
+			return FAIL;
 
-    // 比较 IPMI 传感器
-    ipmiitem = (ZBX_DC_IPMIITEM *)zbx_hashset_search(&dbsync_env.cache->ipmiitems, &item->itemid);
-    if (ITEM_TYPE_IPMI == item->type)
-    {
-        // 比较 IPMI 传感器名称
-        if (NULL == ipmiitem)
-            return FAIL;
+		// 比较 SNMPv3 认证协议
+		if (FAIL == dbsync_compare_uchar(dbrow[26], snmpitem->snmpv3_authprotocol))
+			return FAIL;
 
-        // 比较 IPMI 传感器名称
-        if (FAIL == dbsync_compare_str(dbrow[13], ipmiitem->ipmi_sensor))
-            return FAIL;
-    }
-    else if (NULL != ipmiitem)
-        return FAIL;
+		// 比较 SNMPv3 隐私协议
+		if (FAIL == dbsync_compare_uchar(dbrow[27], snmpitem->snmpv3_privprotocol))
+			return FAIL;
 
-    // 比较 trap 主机
-    trapitem = (ZBX_DC_TRAPITEM *)zbx_hashset_search(&dbsync_env.cache->trapitems, &item->itemid);
-    if (ITEM_TYPE_TRAPPER == item->type && '\0' != *dbrow[15])
-    {
-        // 解析 trap 主机
-        zbx_trim_str_list(dbrow[15], ',');
+		// 比较 SNMPv3 上下文名
+		if (FAIL == dbsync_compare_str(dbrow[28], snmpitem->snmpv3_contextname))
+			return FAIL;
 
-        // 比较 trap 主机
-        if (NULL == trapitem)
-            return FAIL;
+		// 比较 OID
+		if (FAIL == dbsync_compare_str(dbrow[7], snmpitem->snmp_oid))
+			return FAIL;
+	}
+	else if (NULL != snmpitem)
+		return FAIL;
 
-        // 比较 trap 主机
-        if (FAIL == dbsync_compare_str(dbrow[15], trapitem->trapper_hosts))
-            return FAIL;
-    }
-    else if (NULL != trapitem)
-        return FAIL;
+	// 比较 IPMI 传感器
+	ipmiitem = (ZBX_DC_IPMIITEM *)zbx_hashset_search(&dbsync_env.cache->ipmiitems, &item->itemid);
+	if (ITEM_TYPE_IPMI == item->type)
+	{
+		// 比较 IPMI 传感器名称
+		if (NULL == ipmiitem)
+			return FAIL;
 
-    // 比较日志时间格式
-    logitem = (ZBX_DC_LOGITEM *)zbx_hashset_search(&dbsync_env.cache->logitems, &item->itemid);
-    if (ITEM_VALUE_TYPE_LOG == item->value_type && '\0' != *dbrow[16])
-    {
-        // 比较日志时间格式
-        if (NULL == logitem)
-            return FAIL;
+		// 比较 IPMI 传感器名称
+		if (FAIL == dbsync_compare_str(dbrow[13], ipmiitem->ipmi_sensor))
+			return FAIL;
+	}
+	else if (NULL != ipmiitem)
+		return FAIL;
 
-        // 比较日志时间格式
-        if (FAIL == dbsync_compare_str(dbrow[16], logitem->logtimefmt))
-            return FAIL;
-    }
-    else if (NULL != logitem)
-        return FAIL;
+	// 比较 trap 主机
+	trapitem = (ZBX_DC_TRAPITEM *)zbx_hashset_search(&dbsync_env.cache->trapitems, &item->itemid);
+	if (ITEM_TYPE_TRAPPER == item->type && '\0' != *dbrow[15])
+	{
+		// 解析 trap 主机
+		zbx_trim_str_list(dbrow[15], ',');
 
-    // 比较数据库连接参数
-    dbitem = (ZBX_DC_DBITEM *)zbx_hashset_search(&dbsync_env.cache->dbitems, &item->itemid);
-    if (ITEM_TYPE_DB_MONITOR == item->type && '\0' != *dbrow[17])
-    {
-        // 比较数据库连接参数
-        if (NULL == dbitem)
-            return FAIL;
+		// 比较 trap 主机
+		if (NULL == trapitem)
+			return FAIL;
 
-        // 比较用户名
-        if (FAIL == dbsync_compare_str(dbrow[17], dbitem->params))
-            return FAIL;
+		// 比较 trap 主机
+		if (FAIL == dbsync_compare_str(dbrow[15], trapitem->trapper_hosts))
+			return FAIL;
+	}
+	else if (NULL != trapitem)
+		return FAIL;
 
-        // 比较密码
-        if (FAIL == dbsync_compare_str(dbrow[20], dbitem->username))
-            return FAIL;
+	// 比较日志时间格式
+	logitem = (ZBX_DC_LOGITEM *)zbx_hashset_search(&dbsync_env.cache->logitems, &item->itemid);
+	if (ITEM_VALUE_TYPE_LOG == item->value_type && '\0' != *dbrow[16])
+	{
+		// 比较日志时间格式
+		if (NULL == logitem)
+			return FAIL;
 
-        // 比较密码
-        if (FAIL == dbsync_compare_str(dbrow[21], dbitem->password))
-            return FAIL;
-    }
-    else if (NULL != dbitem)
-        return FAIL;
+		// 比较日志时间格式
+		if (FAIL == dbsync_compare_str(dbrow[16], logitem->logtimefmt))
+			return FAIL;
+	}
+	else if (NULL != logitem)
+		return FAIL;
 
-    // 比较 SSH 连接参数
-    sshitem = (ZBX_DC_SSHITEM *)zbx_hashset_search(&dbsync_env.cache->sshitems, &item->itemid);
-    if (ITEM_TYPE_SSH == item->type)
-    {
-        // 比较认证类型
-        if (NULL == sshitem)
-            return FAIL;
+	// 比较数据库连接参数
+	dbitem = (ZBX_DC_DBITEM *)zbx_hashset_search(&dbsync_env.cache->dbitems, &item->itemid);
+	if (ITEM_TYPE_DB_MONITOR == item->type && '\0' != *dbrow[17])
+	{
+		// 比较数据库连接参数
+		if (NULL == dbitem)
+			return FAIL;
 
-        // 比较用户名
-        if (FAIL == dbsync_compare_uchar(dbrow[19], sshitem->authtype))
-            return FAIL;
+		// 比较用户名
+		if (FAIL == dbsync_compare_str(dbrow[17], dbitem->params))
+			return FAIL;
 
-        // 比较用户名
-        if (FAIL == dbsync_compare_str(dbrow[20], sshitem->username))
-            return FAIL;
+		// 比较密码
+		if (FAIL == dbsync_compare_str(dbrow[20], dbitem->username))
+			return FAIL;
 
-        // 比较密码
-        if (FAIL == dbsync_compare_str(dbrow[21], sshitem->password))
-            return FAIL;
+		// 比较密码
+		if (FAIL == dbsync_compare_str(dbrow[21], dbitem->password))
+			return FAIL;
+	}
+	else if (NULL != dbitem)
+		return FAIL;
 
-        // 比较公钥
-        if (FAIL == dbsync_compare_str(dbrow[22], sshitem->publickey))
-            return FAIL;
+	// 比较 SSH 连接参数
+	sshitem = (ZBX_DC_SSHITEM *)zbx_hashset_search(&dbsync_env.cache->sshitems, &item->itemid);
+	if (ITEM_TYPE_SSH == item->type)
+	{
+		// 比较认证类型
+		if (NULL == sshitem)
+			return FAIL;
 
-        // 比较私钥
-        if (FAIL == dbsync_compare_str(dbrow[23], sshitem->privatekey))
-            return FAIL;
+		// 比较用户名
+		if (FAIL == dbsync_compare_uchar(dbrow[19], sshitem->authtype))
+			return FAIL;
 
-        // 比较参数
-        if (FAIL == dbsync_compare_str(dbrow[17], sshitem->params))
-            return FAIL;
-    }
-    else if (NULL != sshitem)
-        return FAIL;
+		// 比较用户名
+		if (FAIL == dbsync_compare_str(dbrow[20], sshitem->username))
+			return FAIL;
 
-    // 比较 Telnet 连接参数
-    telnetitem = (ZBX_DC_TELNETITEM *)zbx_hashset_search(&dbsync_env.cache->telnetitems, &item->itemid);
-    if (ITEM_TYPE_TELNET == item->type)
-    {
-        // 比较用户名
-        if (NULL == telnetitem)
-            return FAIL;
+		// 比较密码
+		if (FAIL == dbsync_compare_str(dbrow[21], sshitem->password))
+			return FAIL;
 
-        // 比较密码
-        if (FAIL == dbsync_compare_str(dbrow[20], telnetitem->username))
-            return FAIL;
+		// 比较公钥
+		if (FAIL == dbsync_compare_str(dbrow[22], sshitem->publickey))
+			return FAIL;
 
-        // 比较密码
-        if (FAIL == dbsync_compare_str(dbrow[21], telnetitem->password))
-            return FAIL;
+		// 比较私钥
+		if (FAIL == dbsync_compare_str(dbrow[23], sshitem->privatekey))
+			return FAIL;
 
-        // 比较参数
-        if (FAIL == dbsync_compare_str(dbrow[17], telnetitem->params))
-            return FAIL;
-    }
-    else if (NULL != telnetitem)
-        return FAIL;
+		// 比较参数
+		if (FAIL == dbsync_compare_str(dbrow[17], sshitem->params))
+			return FAIL;
+	}
+	else if (NULL != sshitem)
+		return FAIL;
 
-    // 比较简单项参数
-    simpleitem = (ZBX_DC_SIMPLEITEM *)zbx_hashset_search(&dbsync_env.cache->simpleitems, &item->itemid);
-    if (ITEM_TYPE_SIMPLE == item->type)
-    {
-        // 比较用户名
-        if (NULL == simpleitem)
-            return FAIL;
+	// 比较 Telnet 连接参数
+	telnetitem = (ZBX_DC_TELNETITEM *)zbx_hashset_search(&dbsync_env.cache->telnetitems, &item->itemid);
+	if (ITEM_TYPE_TELNET == item->type)
+	{
+		// 比较用户名
+		if (NULL == telnetitem)
+			return FAIL;
 
-        // 比较密码
-        if (FAIL == dbsync_compare_str(dbrow[20], simpleitem->username))
-            return FAIL;
+		// 比较密码
+		if (FAIL == dbsync_compare_str(dbrow[20], telnetitem->username))
+			return FAIL;
 
-        // 比较密码
-        if (FAIL == dbsync_compare_str(dbrow[21], simpleitem->password))
-            return FAIL;
-    }
-    else if (NULL != simpleitem)
-        return FAIL;
+		// 比较密码
+		if (FAIL == dbsync_compare_str(dbrow[21], telnetitem->password))
+			return FAIL;
 
-    // 比较 JMX 连接参数
-    jmxitem = (ZBX_DC_JMXITEM *)zbx_hashset_search(&dbsync_env.cache->jmxitems, &item->itemid);
-    if (ITEM_TYPE_JMX == item->type)
-    {
-        // 比较用户名
-        if (NULL == jmxitem)
-            return FAIL;
+		// 比较参数
+		if (FAIL == dbsync_compare_str(dbrow[17], telnetitem->params))
+			return FAIL;
+	}
+	else if (NULL != telnetitem)
+		return FAIL;
 
-        // 比较用户名
-        if (FAIL == dbsync_compare_str(dbrow[20], jmxitem->username))
-            return FAIL;
+	// 比较简单项参数
+	simpleitem = (ZBX_DC_SIMPLEITEM *)zbx_hashset_search(&dbsync_env.cache->simpleitems, &item->itemid);
+	if (ITEM_TYPE_SIMPLE == item->type)
+	{
+		// 比较用户名
+		if (NULL == simpleitem)
+			return FAIL;
 
-        // 比较密码
-        if (FAIL == dbsync_compare_str(dbrow[21], jmxitem->password))
-            return FAIL;
+		// 比较密码
+		if (FAIL == dbsync_compare_str(dbrow[20], simpleitem->username))
+			return FAIL;
 
-        // 比较 JMX 服务端地址
-        if (FAIL == dbsync_compare_str(dbrow[37], jmxitem->jmx_endpoint))
-            return FAIL;
-    }
-    else if (NULL != jmxitem)
-        return FAIL;
+		// 比较密码
+		if (FAIL == dbsync_compare_str(dbrow[21], simpleitem->password))
+			return FAIL;
+	}
+	else if (NULL != simpleitem)
+		return FAIL;
 
-    // 比较计算项参数
-    calcitem = (ZBX_DC_CALCITEM *)zbx_hashset_search(&dbsync_env.cache->calcitems, &item->itemid);
-    if (ITEM_TYPE_CALCULATED == item->type)
-    {
-        // 比较参数
-        if (NULL == calcitem)
-            return FAIL;
+	// 比较 JMX 连接参数
+	jmxitem = (ZBX_DC_JMXITEM *)zbx_hashset_search(&dbsync_env.cache->jmxitems, &item->itemid);
+	if (ITEM_TYPE_JMX == item->type)
+	{
+		// 比较用户名
+		if (NULL == jmxitem)
+			return FAIL;
 
-        // 比较参数
-        if (FAIL == dbsync_compare_str(dbrow[17], calcitem->params))
-            return FAIL;
-    }
-    else if (NULL != calcitem)
-        return FAIL;
+		// 比较用户名
+		if (FAIL == dbsync_compare_str(dbrow[20], jmxitem->username))
+			return FAIL;
 
-    // 比较依赖项
-    depitem = (ZBX_DC_DEPENDENTITEM *)zbx_hashset_search(&dbsync_env.cache->dependentitems, &item->itemid);
-    if (ITEM_TYPE_DEPENDENT == item->type)
-    {
-        // 比较主项 ID
-        if (NULL == depitem)
-            return FAIL;
+		// 比较密码
+		if (FAIL == dbsync_compare_str(dbrow[21], jmxitem->password))
+			return FAIL;
 
-        // 比较主项 ID
-        if (FAIL == dbsync_compare_uint64(dbrow[38], depitem->master_itemid))
-            return FAIL;
-    }
+		// 比较 JMX 服务端地址
+		if (FAIL == dbsync_compare_str(dbrow[37], jmxitem->jmx_endpoint))
+			return FAIL;
+	}
+	else if (NULL != jmxitem)
+		return FAIL;
 
+	// 比较计算项参数
 	calcitem = (ZBX_DC_CALCITEM *)zbx_hashset_search(&dbsync_env.cache->calcitems, &item->itemid);
 	if (ITEM_TYPE_CALCULATED == item->type)
 	{
+		// 比较参数
 		if (NULL == calcitem)
 			return FAIL;
 
+		// 比较参数
 		if (FAIL == dbsync_compare_str(dbrow[17], calcitem->params))
 			return FAIL;
 	}
 	else if (NULL != calcitem)
 		return FAIL;
 
+	// 比较依赖项
 	depitem = (ZBX_DC_DEPENDENTITEM *)zbx_hashset_search(&dbsync_env.cache->dependentitems, &item->itemid);
 	if (ITEM_TYPE_DEPENDENT == item->type)
 	{
+		// 比较主项 ID
 		if (NULL == depitem)
 			return FAIL;
 
+		// 比较主项 ID
 		if (FAIL == dbsync_compare_uint64(dbrow[38], depitem->master_itemid))
 			return FAIL;
 	}
@@ -2251,164 +3607,238 @@ static int	dbsync_compare_item(const ZBX_DC_ITEM *item, const DB_ROW dbrow)
  * Purpose: applies necessary preprocessing before row is compared/used       *
  *                                                                            *
  * Parameter: row - [IN] the row to preprocess                                *
+ *                                                                            *
+ * Return value: the preprocessed row                                         *
+ *                                                                            *
+ * Comments: The row preprocessing can be used to expand user macros in       *
+ *           some columns.                                                    *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  * *
- *这个代码块主要目的是处理物品数据，包括以下几个步骤：
- *
- *1. 查询物品表中的数据。
- *2. 预处理物品数据，包括展开用户宏等操作。
- *3. 初始化配置缓存，用于存储物品数据。
- *4. 遍历查询结果，比较物品数据，并根据不同的标志位进行添加、更新或删除操作。
- *5. 释放查询结果，销毁配置缓存。
- *
- *整个函数的输出是一个处理后的变化集（changeset），其中包括需要添加、更新或删除的物品数据。
+ *对监控项行进行预处理：当delay、history、trends列中包含用户宏时展开这些宏。
  ******************************************************************************/
-// 定义一个函数，用于检查行是否符合条件
-int dbsync_check_row_macros(const DB_ROW *row, int flag)
+static char	**dbsync_item_preproc_row(char **row)
 {
-    // 判断行中的标志位是否包含了给定的flag
-    if (0 == (row->flags & flag))
-        return FAIL;
+// 检查行中的标志位，根据不同的标志位进行相应的处理
+#define ZBX_DBSYNC_ITEM_COLUMN_DELAY	0x01
+#define ZBX_DBSYNC_ITEM_COLUMN_HISTORY	0x02
+#define ZBX_DBSYNC_ITEM_COLUMN_TRENDS	0x04
 
-    return SUCCEED;
-}
+	zbx_uint64_t	hostid;
+	// 定义一些变量
+	unsigned char	flags = 0;
 
-// 以下是一个处理物品数据的函数
-int dbsync_item_preproc_row(zbx_dbsync_t *sync, const DB_ROW *row)
-{
-    // 定义一些变量
-    unsigned int flags = 0;
-    zbx_uint64_t hostid = 0;
+	/* return the original row if user macros are not used in target columns */
 
-    // 检查行中的标志位，根据不同的标志位进行相应的处理
-    if (SUCCEED == dbsync_check_row_macros(row, 14))
-        flags |= ZBX_DBSYNC_ITEM_COLUMN_DELAY;
+	// 目标列中没有使用用户宏时直接返回原始行
+	if (SUCCEED == dbsync_check_row_macros(row, 14))
+		flags |= ZBX_DBSYNC_ITEM_COLUMN_DELAY;
 
-    if (SUCCEED == dbsync_check_row_macros(row, 31))
-        flags |= ZBX_DBSYNC_ITEM_COLUMN_HISTORY;
+	if (SUCCEED == dbsync_check_row_macros(row, 31))
+		flags |= ZBX_DBSYNC_ITEM_COLUMN_HISTORY;
 
-    if (SUCCEED == dbsync_check_row_macros(row, 32))
-        flags |= ZBX_DBSYNC_ITEM_COLUMN_TRENDS;
+	if (SUCCEED == dbsync_check_row_macros(row, 32))
+		flags |= ZBX_DBSYNC_ITEM_COLUMN_TRENDS;
 
-    // 如果 flags 为0，说明没有需要处理的标志位，直接返回行数据
-    if (0 == flags)
-        return row;
+	// 如果 flags 为0，说明没有需要处理的标志位，直接返回行数据
+	if (0 == flags)
+		return row;
 
-    // 获取关联的主机ID
-    ZBX_STR2UINT64(hostid, row[1]);
+	// 获取关联的主机ID
+	/* get associated host identifier */
+	ZBX_STR2UINT64(hostid, row[1]);
 
-    // 展开用户宏
-    if (0 != (flags & ZBX_DBSYNC_ITEM_COLUMN_DELAY))
-        row[14] = zbx_dc_expand_user_macros(row[14], &hostid, 1, NULL);
+	// 展开用户宏
+	/* expand user macros */
+	if (0 != (flags & ZBX_DBSYNC_ITEM_COLUMN_DELAY))
+		row[14] = zbx_dc_expand_user_macros(row[14], &hostid, 1, NULL);
 
-    if (0 != (flags & ZBX_DBSYNC_ITEM_COLUMN_HISTORY))
-        row[31] = zbx_dc_expand_user_macros(row[31], &hostid, 1, NULL);
+	if (0 != (flags & ZBX_DBSYNC_ITEM_COLUMN_HISTORY))
+		row[31] = zbx_dc_expand_user_macros(row[31], &hostid, 1, NULL);
 
-    if (0 != (flags & ZBX_DBSYNC_ITEM_COLUMN_TRENDS))
-        row[32] = zbx_dc_expand_user_macros(row[32], &hostid, 1, NULL);
+	if (0 != (flags & ZBX_DBSYNC_ITEM_COLUMN_TRENDS))
+		row[32] = zbx_dc_expand_user_macros(row[32], &hostid, 1, NULL);
 
-    // 返回处理后的行数据
-    return row;
+	// 返回处理后的行数据
+	return row;
+
+#undef ZBX_DBSYNC_ITEM_COLUMN_DELAY
+#undef ZBX_DBSYNC_ITEM_COLUMN_HISTORY
+#undef ZBX_DBSYNC_ITEM_COLUMN_TRENDS
 }
 
-// 定义一个比较物品的函数
-int dbsync_compare_item(ZBX_DC_ITEM *item, const DB_ROW *row)
+/******************************************************************************
+ *                                                                            *
+ * Function: dbsync_item_changed                                              *
+ *                                                                            *
+ * Purpose: checks if cached item or its host is in changelog                 *
+ *                                                                            *
+ ******************************************************************************/
+/******************************************************************************
+ * *
+ *检查缓存中的监控项或其所属主机是否在变更日志中。
+ ******************************************************************************/
+static int	dbsync_item_changed(const ZBX_DC_ITEM *item)
 {
-    // 对比物品的各个属性，如果存在差异，则返回FAIL，否则返回SUCCEED
-    // 此处省略了对比各个属性的具体逻辑
+	if (FAIL != zbx_vector_uint64_bsearch(&dbsync_env.itemids, item->itemid, ZBX_DEFAULT_UINT64_COMPARE_FUNC))
+		return SUCCEED;
 
-    return SUCCEED;
+	return FAIL == zbx_vector_uint64_bsearch(&dbsync_env.hostids, item->hostid, ZBX_DEFAULT_UINT64_COMPARE_FUNC) ?
+			FAIL : SUCCEED;
 }
 
-// 以下是一个同步物品数据的功能
-int zbx_dbsync_compare_items(zbx_dbsync_t *sync)
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_dbsync_compare_items                                         *
+ *                                                                            *
+ * Purpose: compares items table with cached configuration data               *
+ *                                                                            *
+ * Parameter: cache - [IN] the configuration cache                            *
+ *            sync  - [OUT] the changeset                                     *
+ *                                                                            *
+ * Return value: SUCCEED - the changeset was successfully calculated          *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: During incremental synchronization only the items changed since  *
+ *           the last synchronization and the items of changed hosts are      *
+ *           selected and compared.                                           *
+ *                                                                            *
+ ******************************************************************************/
+/******************************************************************************
+ * *
+ *比较监控项表与配置缓存，生成需要添加、更新或删除的变化集。
+ *增量同步时只查询变更日志中记录的监控项以及变化主机的监控项。
+ ******************************************************************************/
+int	zbx_dbsync_compare_items(zbx_dbsync_t *sync)
 {
-    // 获取数据库连接
-    DB_ROW dbrow;
-    DB_RESULT result;
-
-    // 查询物品表中的数据
-    if (NULL == (result = DBselect(
-            "select i.itemid,i.hostid,i.status,i.type,i.value_type,i.key_,"
-                "i.snmp_community,i.snmp_oid,i.port,i.snmpv3_securityname,i.snmpv3_securitylevel,"
-                "i.snmpv3_authpassphrase,i.snmpv3_privpassphrase,i.ipmi_sensor,i.delay,"
-                "i.trapper_hosts,i.logtimefmt,i.params,i.state,i.authtype,i.username,i.password,"
-                "i.publickey,i.privatekey,i.flags,i.interfaceid,i.snmpv3_authprotocol,"
-                "i.snmpv3_privprotocol,i.snmpv3_contextname,i.lastlogsize,i.mtime,"
-                "i.history,i.trends,i.inventory_link,i.valuemapid,i.units,i.error,i.jmx_endpoint,"
-                "i.master_itemid,i.timeout,i.url,i.query_fields,i.posts,i.status_codes,"
-                "i.follow_redirects,i.post_type,i.http_proxy,i.headers,i.retrieve_mode,"
-                "i.request_method,i.output_format,i.ssl_cert_file,i.ssl_key_file,i.ssl_key_password,"
-                "i.verify_peer,i.verify_host,i.allow_traps"
-            " from items i,hosts h"
-            " where i.hostid=h.hostid"
-            " and h.status in (%d,%d)"
-            " and i.flags<>%d",
-            HOST_STATUS_MONITORED, HOST_STATUS_NOT_MONITORED,
-            ZBX_FLAG_DISCOVERY_PROTOTYPE)))
-    {
-        return FAIL;
-    }
+	// 获取数据库连接
+	DB_ROW			dbrow;
+	DB_RESULT		result;
+	// 查询物品表中的数据
+	zbx_hashset_t		ids;
+	zbx_hashset_iter_t	iter;
+	zbx_uint64_t		rowid;
+	ZBX_DC_ITEM		*item;
+	char			**row, *sql = NULL;
+	size_t			sql_alloc = 0, sql_offset = 0;
+
+	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
+			"select i.itemid,i.hostid,i.status,i.type,i.value_type,i.key_,"
+				"i.snmp_community,i.snmp_oid,i.port,i.snmpv3_securityname,i.snmpv3_securitylevel,"
+				"i.snmpv3_authpassphrase,i.snmpv3_privpassphrase,i.ipmi_sensor,i.delay,"
+				"i.trapper_hosts,i.logtimefmt,i.params,i.state,i.authtype,i.username,i.password,"
+				"i.publickey,i.privatekey,i.flags,i.interfaceid,i.snmpv3_authprotocol,"
+				"i.snmpv3_privprotocol,i.snmpv3_contextname,i.lastlogsize,i.mtime,"
+				"i.history,i.trends,i.inventory_link,i.valuemapid,i.units,i.error,i.jmx_endpoint,"
+				"i.master_itemid,i.timeout,i.url,i.query_fields,i.posts,i.status_codes,"
+				"i.follow_redirects,i.post_type,i.http_proxy,i.headers,i.retrieve_mode,"
+				"i.request_method,i.output_format,i.ssl_cert_file,i.ssl_key_file,i.ssl_key_password,"
+				"i.verify_peer,i.verify_host,i.allow_traps"
+			" from items i,hosts h"
+			" where i.hostid=h.hostid"
+				" and h.status in (%d,%d)"
+				" and i.flags<>%d",
+			HOST_STATUS_MONITORED, HOST_STATUS_NOT_MONITORED,
+			ZBX_FLAG_DISCOVERY_PROTOTYPE);
 
-    // 预处理物品数据
-    dbsync_prepare(sync, 57, dbsync_item_preproc_row);
+	// 预处理物品数据
+	dbsync_prepare(sync, ZBX_DBSYNC_ITEM_COLUMNS_NUM, dbsync_item_preproc_row);
+	sync->snapshot_object = ZBX_DBSYNC_OBJ_ITEM;
+
+	if (SUCCEED == dbsync_env.snapshot)
+	{
+		zbx_free(sql);
+		return dbsync_snapshot_select(sync);
+	}
 
-    // 初始化配置缓存
-    zbx_hashset_create(&ids, dbsync_env.cache->items.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
-                     ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	/* there is nothing to compare if no items or hosts were changed since the last synchronization */
+	// 增量同步且没有变化的监控项时返回空的变化集
+	if (SUCCEED == dbsync_env.changelog &&
+			FAIL == dbsync_changelog_condition(&sql, &sql_alloc, &sql_offset, "i.hostid", "i.itemid", NULL))
+	{
+		zbx_free(sql);
+		return SUCCEED;
+	}
 
-    // 遍历查询结果，比较物品数据
-    while (NULL != (dbrow = DBfetch(result)))
-    {
-        unsigned char tag = ZBX_DBSYNC_ROW_NONE;
+	result = DBselect("%s", sql);
+	zbx_free(sql);
 
-        ZBX_STR2UINT64(rowid, dbrow[0]);
-        zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
+	if (NULL == result)
+		return FAIL;
 
-        row = dbsync_preproc_row(sync, dbrow);
+	if (ZBX_DBSYNC_INIT == sync->mode)
+	{
+		sync->dbresult = result;
+		return SUCCEED;
+	}
 
-        // 检查行中的标志位，根据不同的标志位进行相应的处理
-        if (NULL == (item = (ZBX_DC_ITEM *)zbx_hashset_search(&dbsync_env.cache->items, &rowid)))
-            tag = ZBX_DBSYNC_ROW_ADD;
-        else if (FAIL == dbsync_compare_item(item, row))
-            tag = ZBX_DBSYNC_ROW_UPDATE;
+	// 初始化配置缓存
+	zbx_hashset_create(&ids, SUCCEED == dbsync_env.changelog ? (size_t)dbsync_env.itemids.values_num :
+			(size_t)dbsync_env.cache->items.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
+			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 
-        if (ZBX_DBSYNC_ROW_NONE != tag)
-            dbsync_add_row(sync, rowid, tag, row);
-    }
+	// 遍历查询结果，比较物品数据
+	while (NULL != (dbrow = DBfetch(result)))
+	{
+		unsigned char	tag = ZBX_DBSYNC_ROW_NONE;
 
-    // 释放查询结果
-    zbx_hashset_iter_reset(&dbsync_env.cache->items, &iter);
-    while (NULL != (item = (ZBX_DC_ITEM *)zbx_hashset_iter_next(&iter)))
-    {
-        // 检查配置缓存中是否存在物品
-        if (NULL == zbx_hashset_search(&ids, &item->itemid))
-            dbsync_add_row(sync, item->itemid, ZBX_DBSYNC_ROW_REMOVE, NULL);
-    }
+		ZBX_STR2UINT64(rowid, dbrow[0]);
+		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
 
-    // 销毁配置缓存
-    zbx_hashset_destroy(&ids);
-    DBfree_result(result);
+		dbsync_snapshot_add_row(sync, dbrow);
 
-    // 返回同步结果
-    return SUCCEED;
-}
+		row = dbsync_preproc_row(sync, dbrow);
 
+		// 检查行中的标志位，根据不同的标志位进行相应的处理
+		if (NULL == (item = (ZBX_DC_ITEM *)zbx_hashset_search(&dbsync_env.cache->items, &rowid)))
+			tag = ZBX_DBSYNC_ROW_ADD;
+		else if (FAIL == dbsync_compare_item(item, row))
+			tag = ZBX_DBSYNC_ROW_UPDATE;
 
 		if (ZBX_DBSYNC_ROW_NONE != tag)
 			dbsync_add_row(sync, rowid, tag, row);
 	}
 
+	/* during incremental synchronization only the changed items and items of changed hosts can be removed */
+	// 增量同步时只有变化的监控项和变化主机的监控项可能被删除
+	if (SUCCEED == dbsync_env.changelog && 0 == dbsync_env.hostids.values_num)
+	{
+		int	i;
+
+		for (i = 0; i < dbsync_env.itemids.values_num; i++)
+		{
+			rowid = dbsync_env.itemids.values[i];
+
+			if (NULL == zbx_hashset_search(&ids, &rowid) &&
+					NULL != zbx_hashset_search(&dbsync_env.cache->items, &rowid))
+			{
+				dbsync_add_row(sync, rowid, ZBX_DBSYNC_ROW_REMOVE, NULL);
+			}
+		}
+
+		goto out;
+	}
+
+	// 释放查询结果
 	zbx_hashset_iter_reset(&dbsync_env.cache->items, &iter);
 	while (NULL != (item = (ZBX_DC_ITEM *)zbx_hashset_iter_next(&iter)))
 	{
-		if (NULL == zbx_hashset_search(&ids, &item->itemid))
-			dbsync_add_row(sync, item->itemid, ZBX_DBSYNC_ROW_REMOVE, NULL);
-	}
+		// 检查配置缓存中是否存在物品
+		if (NULL != zbx_hashset_search(&ids, &item->itemid))
+			continue;
+
+		if (SUCCEED == dbsync_env.changelog && SUCCEED != dbsync_item_changed(item))
+			continue;
 
+		dbsync_add_row(sync, item->itemid, ZBX_DBSYNC_ROW_REMOVE, NULL);
+	}
+out:
+	// 销毁配置缓存
 	zbx_hashset_destroy(&ids);
 	DBfree_result(result);
 
+	// 返回同步结果
 	return SUCCEED;
 }
 
@@ -2490,12 +3920,6 @@ static int	dbsync_compare_trigger(const ZBX_DC_TRIGGER *trigger, const DB_ROW db
  *           some columns.                                                    *
  *                                                                            *
  ******************************************************************************/
-static char	**dbsync_trigger_preproc_row(char **row)
-{
-	zbx_vector_uint64_t	hostids, functionids;
-	unsigned char		flags = 0;
-
-	/* return the original row if user macros are not used in target columns */
 /******************************************************************************
  * *
  *整个代码块的主要目的是检查row中的数据，根据条件设置flags，然后获取相关的hostids，扩展user macro，最后返回处理后的row。具体来说：
@@ -2510,29 +3934,73 @@ static char	**dbsync_trigger_preproc_row(char **row)
  *8. 销毁functionids和hostids的vector。
  *9. 处理完所有逻辑后，返回处理后的row。
  ******************************************************************************/
-// 判断第3列的值是否符合macro1的条件，如果符合，将flags设置为ZBX_DBSYNC_TRIGGER_COLUMN_EXPRESSION
-if (SUCCEED == dbsync_check_row_macros(row, 2))
+static char	**dbsync_trigger_preproc_row(char **row)
 {
-    flags |= ZBX_DBSYNC_TRIGGER_COLUMN_EXPRESSION;
-}
+	zbx_vector_uint64_t	hostids, functionids;
+	unsigned char		flags = 0;
 
-// 判断第11列的值是否符合macro2的条件，如果符合，将flags设置为ZBX_DBSYNC_TRIGGER_COLUMN_RECOVERY_EXPRESSION
-if (SUCCEED == dbsync_check_row_macros(row, 11))
-{
-    flags |= ZBX_DBSYNC_TRIGGER_COLUMN_RECOVERY_EXPRESSION;
-}
+	/* return the original row if user macros are not used in target columns */
+	// 判断第3列的值是否符合macro1的条件，如果符合，将flags设置为ZBX_DBSYNC_TRIGGER_COLUMN_EXPRESSION
+	if (SUCCEED == dbsync_check_row_macros(row, 2))
+		flags |= ZBX_DBSYNC_TRIGGER_COLUMN_EXPRESSION;
 
-// 如果flags为0，说明没有触发条件，直接返回row
-if (0 == flags)
-{
-    return row;
-}
+	// 判断第11列的值是否符合macro2的条件，如果符合，将flags设置为ZBX_DBSYNC_TRIGGER_COLUMN_RECOVERY_EXPRESSION
+	if (SUCCEED == dbsync_check_row_macros(row, 11))
+		flags |= ZBX_DBSYNC_TRIGGER_COLUMN_RECOVERY_EXPRESSION;
+
+	// 如果flags为0，说明没有触发条件，直接返回row
+	if (0 == flags)
+		return row;
+
+	/* get associated host identifiers */
+	/* 获取相关的host标识符 */
+
+	// 创建一个uint64类型的vector，用于存储hostids
+	zbx_vector_uint64_create(&hostids);
+	zbx_vector_uint64_create(&functionids);
+
+	get_functionids(&functionids, row[2]);
+	get_functionids(&functionids, row[11]);
+
+	zbx_dc_get_hostids_by_functionids(functionids.values, functionids.values_num, &hostids);
+
+	/* expand user macros */
 
-/* 获取相关的host标识符 */
+	if (0 != (flags & ZBX_DBSYNC_TRIGGER_COLUMN_EXPRESSION))
+	{
+		row[2] = zbx_dc_expand_user_macros(row[2], hostids.values, hostids.values_num,
+				dbsync_numeric_validator);
+	}
+
+	if (0 != (flags & ZBX_DBSYNC_TRIGGER_COLUMN_RECOVERY_EXPRESSION))
+	{
+		row[11] = zbx_dc_expand_user_macros(row[11], hostids.values, hostids.values_num,
+				dbsync_numeric_validator);
+	}
+
+	zbx_vector_uint64_destroy(&functionids);
+	zbx_vector_uint64_destroy(&hostids);
 
-// 创建一个uint64类型的vector，用于存储hostids
-zbx_vector_uint64_create(&hostids);
+	return row;
+}
 
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_dbsync_compare_triggers                                      *
+ *                                                                            *
+ * Purpose: compares triggers table with cached configuration data            *
+ *                                                                            *
+ * Parameter: cache - [IN] the configuration cache                            *
+ *            sync  - [OUT] the changeset                                     *
+ *                                                                            *
+ * Return value: SUCCEED - the changeset was successfully calculated          *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: During incremental synchronization only the changed triggers and *
+ *           the triggers of changed items and hosts are selected and         *
+ *           compared.                                                        *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  * *
  *该代码的主要目的是比较zbx监控系统中的触发器，并在需要时更新或删除触发器。具体来说，代码执行以下操作：
@@ -2546,7 +4014,7 @@ zbx_vector_uint64_create(&hostids);
  *7. 销毁ids哈希集并释放查询结果。
  *8. 返回成功。
  ******************************************************************************/
-int zbx_dbsync_compare_triggers(zbx_dbsync_t *sync)
+int	zbx_dbsync_compare_triggers(zbx_dbsync_t *sync)
 {
 	// 定义变量
 	DB_ROW			dbrow;
@@ -2555,10 +4023,12 @@ int zbx_dbsync_compare_triggers(zbx_dbsync_t *sync)
 	zbx_hashset_iter_t	iter;
 	zbx_uint64_t		rowid;
 	ZBX_DC_TRIGGER		*trigger;
-	char			**row;
+	char			**row, *sql = NULL;
+	size_t			sql_alloc = 0, sql_offset = 0;
+	int			i;
 
 	// 查询触发器信息
-	if (NULL == (result = DBselect(
+	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
 			"select distinct t.triggerid,t.description,t.expression,t.error,t.priority,t.type,t.value,"
 				"t.state,t.lastchange,t.status,t.recovery_mode,t.recovery_expression,"
 				"t.correlation_mode,t.correlation_tag"
@@ -2569,13 +4039,31 @@ int zbx_dbsync_compare_triggers(zbx_dbsync_t *sync)
 				" and h.status in (%d,%d)"
 				" and t.flags<>%d",
 			HOST_STATUS_MONITORED, HOST_STATUS_NOT_MONITORED,
-			ZBX_FLAG_DISCOVERY_PROTOTYPE)))
+			ZBX_FLAG_DISCOVERY_PROTOTYPE);
+
+	// 预处理数据
+	dbsync_prepare(sync, ZBX_DBSYNC_TRIGGER_COLUMNS_NUM, dbsync_trigger_preproc_row);
+	sync->snapshot_object = ZBX_DBSYNC_OBJ_TRIGGER;
+
+	if (SUCCEED == dbsync_env.snapshot)
 	{
-		return FAIL;
+		zbx_free(sql);
+		return dbsync_snapshot_select(sync);
 	}
 
-	// 预处理数据
-	dbsync_prepare(sync, 14, dbsync_trigger_preproc_row);
+	// 增量同步时只查询变化的触发器以及变化的监控项、主机相关的触发器
+	if (SUCCEED == dbsync_env.changelog && FAIL == dbsync_changelog_condition(&sql, &sql_alloc, &sql_offset,
+			"h.hostid", "i.itemid", "t.triggerid"))
+	{
+		zbx_free(sql);
+		return SUCCEED;
+	}
+
+	result = DBselect("%s", sql);
+	zbx_free(sql);
+
+	if (NULL == result)
+		return FAIL;
 
 	// 初始化数据缓存
 	if (ZBX_DBSYNC_INIT == sync->mode)
@@ -2585,7 +4073,8 @@ int zbx_dbsync_compare_triggers(zbx_dbsync_t *sync)
 	}
 
 	// 创建哈希集
-	zbx_hashset_create(&ids, dbsync_env.cache->triggers.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
+	zbx_hashset_create(&ids, SUCCEED == dbsync_env.changelog ? (size_t)dbsync_env.triggerids.values_num :
+			(size_t)dbsync_env.cache->triggers.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
 			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 
 	// 遍历查询结果并处理触发器
@@ -2594,6 +4083,8 @@ int zbx_dbsync_compare_triggers(zbx_dbsync_t *sync)
 		ZBX_STR2UINT64(rowid, dbrow[0]);
 		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
 
+		dbsync_snapshot_add_row(sync, dbrow);
+
 		row = dbsync_preproc_row(sync, dbrow);
 
 		// 查找触发器并对比差异
@@ -2608,6 +4099,24 @@ int zbx_dbsync_compare_triggers(zbx_dbsync_t *sync)
 		}
 	}
 
+	/* during incremental synchronization only the affected triggers can be removed */
+	// 增量同步时只有受影响的触发器可能被删除
+	if (SUCCEED == dbsync_env.changelog)
+	{
+		for (i = 0; i < dbsync_env.triggerids.values_num; i++)
+		{
+			rowid = dbsync_env.triggerids.values[i];
+
+			if (NULL == zbx_hashset_search(&ids, &rowid) &&
+					NULL != zbx_hashset_search(&dbsync_env.cache->triggers, &rowid))
+			{
+				dbsync_add_row(sync, rowid, ZBX_DBSYNC_ROW_REMOVE, NULL);
+			}
+		}
+
+		goto out;
+	}
+
 	// 迭代触发器缓存并处理差异
 	zbx_hashset_iter_reset(&dbsync_env.cache->triggers, &iter);
 	while (NULL != (trigger = (ZBX_DC_TRIGGER *)zbx_hashset_iter_next(&iter)))
@@ -2616,7 +4125,7 @@ int zbx_dbsync_compare_triggers(zbx_dbsync_t *sync)
 		if (NULL == zbx_hashset_search(&ids, &trigger->triggerid))
 			dbsync_add_row(sync, trigger->triggerid, ZBX_DBSYNC_ROW_REMOVE, NULL);
 	}
-
+out:
 	// 销毁ids哈希集
 	zbx_hashset_destroy(&ids);
 	// 释放查询结果
@@ -2626,24 +4135,23 @@ int zbx_dbsync_compare_triggers(zbx_dbsync_t *sync)
 	return SUCCEED;
 }
 
-			HOST_STATUS_MONITORED, HOST_STATUS_NOT_MONITORED,
-			ZBX_FLAG_DISCOVERY_PROTOTYPE)))
-	{
-		return FAIL;
-	}
-
-	dbsync_prepare(sync, 14, dbsync_trigger_preproc_row);
-
-	if (ZBX_DBSYNC_INIT == sync->mode)
-	{
-		sync->dbresult = result;
-		return SUCCEED;
-	}
-
 /******************************************************************************
  * *
  *整个代码块的主要目的是比较zbx_dbsync_compare_trigger_dependency函数接收到的两个触发器依赖关系集合，并在新的集合中添加符合条件的依赖关系，同时删除不再需要的依赖关系。为了实现这个目的，代码首先从数据库中查询触发器依赖关系，然后创建一个依赖关系集合，接着遍历上游和下游依赖关系，将符合条件的依赖关系添加到集合中，最后添加删除行并释放资源。
  ******************************************************************************/
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_dbsync_compare_trigger_dependency                            *
+ *                                                                            *
+ * Purpose: compares trigger_depends table with cached configuration data     *
+ *                                                                            *
+ * Parameter: cache - [IN] the configuration cache                            *
+ *            sync  - [OUT] the changeset                                     *
+ *                                                                            *
+ * Return value: SUCCEED - the changeset was successfully calculated          *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
 int zbx_dbsync_compare_trigger_dependency(zbx_dbsync_t *sync)
 {
 	// 定义变量
@@ -2686,6 +4194,7 @@ int zbx_dbsync_compare_trigger_dependency(zbx_dbsync_t *sync)
 	zbx_hashset_create(&deps, 100, ZBX_DEFAULT_UINT64_PAIR_HASH_FUNC, ZBX_DEFAULT_UINT64_PAIR_COMPARE_FUNC);
 
 	// 索引主机模板链接
+	/* index all host->template links */
 	zbx_hashset_iter_reset(&dbsync_env.cache->trigdeps, &iter);
 	while (NULL != (dep_down = (ZBX_DC_TRIGGER_DEPLIST *)zbx_hashset_iter_next(&iter)))
 	{
@@ -2701,6 +4210,7 @@ int zbx_dbsync_compare_trigger_dependency(zbx_dbsync_t *sync)
 	}
 
 	// 添加新行，删除索引中的现有行
+	/* add new rows, remove existing rows from index */
 	while (NULL != (dbrow = DBfetch(result)))
 	{
 		ZBX_STR2UINT64(dep_local.first, dbrow[0]);
@@ -2715,54 +4225,6 @@ int zbx_dbsync_compare_trigger_dependency(zbx_dbsync_t *sync)
 	}
 
 	// 添加删除行
-	zbx_hashset_iter_reset(&deps, &iter);
-	while (NULL != (dep = (zbx_uint64_pair_t *)zbx_hashset_iter_next(&iter)))
-	{
-		zbx_snprintf(down_s, sizeof(down_s), ZBX_FS_UI64, dep->first);
-		zbx_snprintf(up_s, sizeof(up_s), ZBX_FS_UI64, dep->second);
-		dbsync_add_row(sync, 0, ZBX_DBSYNC_ROW_REMOVE, del_row);
-	}
-
-	// 释放资源
-	DBfree_result(result);
-	zbx_hashset_destroy(&deps);
-
-	return SUCCEED;
-}
-
-	{
-		sync->dbresult = result;
-		return SUCCEED;
-	}
-
-	zbx_hashset_create(&deps, 100, ZBX_DEFAULT_UINT64_PAIR_HASH_FUNC, ZBX_DEFAULT_UINT64_PAIR_COMPARE_FUNC);
-
-	/* index all host->template links */
-	zbx_hashset_iter_reset(&dbsync_env.cache->trigdeps, &iter);
-	while (NULL != (dep_down = (ZBX_DC_TRIGGER_DEPLIST *)zbx_hashset_iter_next(&iter)))
-	{
-		dep_local.first = dep_down->triggerid;
-
-		for (i = 0; i < dep_down->dependencies.values_num; i++)
-		{
-			dep_up = (ZBX_DC_TRIGGER_DEPLIST *)dep_down->dependencies.values[i];
-			dep_local.second = dep_up->triggerid;
-			zbx_hashset_insert(&deps, &dep_local, sizeof(dep_local));
-		}
-	}
-
-	/* add new rows, remove existing rows from index */
-	while (NULL != (dbrow = DBfetch(result)))
-	{
-		ZBX_STR2UINT64(dep_local.first, dbrow[0]);
-		ZBX_STR2UINT64(dep_local.second, dbrow[1]);
-
-		if (NULL == (dep = (zbx_uint64_pair_t *)zbx_hashset_search(&deps, &dep_local)))
-			dbsync_add_row(sync, 0, ZBX_DBSYNC_ROW_ADD, dbrow);
-		else
-			zbx_hashset_remove_direct(&deps, dep);
-	}
-
 	/* add removed rows */
 	zbx_hashset_iter_reset(&deps, &iter);
 	while (NULL != (dep = (zbx_uint64_pair_t *)zbx_hashset_iter_next(&iter)))
@@ -2772,6 +4234,7 @@ int zbx_dbsync_compare_trigger_dependency(zbx_dbsync_t *sync)
 		dbsync_add_row(sync, 0, ZBX_DBSYNC_ROW_REMOVE, del_row);
 	}
 
+	// 释放资源
 	DBfree_result(result);
 	zbx_hashset_destroy(&deps);
 
@@ -2821,6 +4284,20 @@ static int	dbsync_compare_function(const ZBX_DC_FUNCTION *function, const DB_ROW
 
 /******************************************************************************
  *                                                                            *
+ * Function: zbx_dbsync_compare_functions                                     *
+ *                                                                            *
+ * Purpose: compares functions table with cached configuration data           *
+ *                                                                            *
+ * Parameter: cache - [IN] the configuration cache                            *
+ *            sync  - [OUT] the changeset                                     *
+ *                                                                            *
+ * Return value: SUCCEED - the changeset was successfully calculated          *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: During incremental synchronization only the functions of changed *
+ *           triggers, items and hosts are selected and compared.             *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  * *
  *该代码主要目的是比较数据库中存储的函数和缓存中的函数，根据需要进行添加、更新或删除操作。具体来说，代码实现了以下功能：
@@ -2832,7 +4309,7 @@ static int	dbsync_compare_function(const ZBX_DC_FUNCTION *function, const DB_ROW
  *5. 返回成功。
  ******************************************************************************/
 // 定义一个函数，用于比较数据库中存储的函数和缓存中的函数，并根据需要进行添加、更新或删除操作
-int zbx_dbsync_compare_functions(zbx_dbsync_t *sync)
+int	zbx_dbsync_compare_functions(zbx_dbsync_t *sync)
 {
 	// 声明变量
 	DB_ROW			dbrow;
@@ -2841,9 +4318,12 @@ int zbx_dbsync_compare_functions(zbx_dbsync_t *sync)
 	zbx_hashset_iter_t	iter;
 	zbx_uint64_t		rowid;
 	ZBX_DC_FUNCTION		*function;
+	char			*sql = NULL;
+	size_t			sql_alloc = 0, sql_offset = 0;
+	int			i;
 
 	// 从数据库中查询符合条件的函数信息
-	if (NULL == (result = DBselect(
+	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
 			"select i.itemid,f.functionid,f.name,f.parameter,t.triggerid"
 			" from hosts h,items i,functions f,triggers t"
 			" where h.hostid=i.hostid"
@@ -2852,14 +4332,32 @@ int zbx_dbsync_compare_functions(zbx_dbsync_t *sync)
 				" and h.status in (%d,%d)"
 				" and t.flags<>%d",
 			HOST_STATUS_MONITORED, HOST_STATUS_NOT_MONITORED,
-			ZBX_FLAG_DISCOVERY_PROTOTYPE)))
+			ZBX_FLAG_DISCOVERY_PROTOTYPE);
+
+	// 初始化数据同步对象
+	dbsync_prepare(sync, ZBX_DBSYNC_FUNCTION_COLUMNS_NUM, NULL);
+	sync->snapshot_object = ZBX_DBSYNC_OBJ_FUNCTION;
+
+	if (SUCCEED == dbsync_env.snapshot)
 	{
-		// 查询失败，返回错误
-		return FAIL;
+		zbx_free(sql);
+		return dbsync_snapshot_select(sync);
 	}
 
-	// 初始化数据同步对象
-	dbsync_prepare(sync, 5, NULL);
+	// 增量同步时只查询受影响触发器的函数以及变化的监控项、主机的函数
+	if (SUCCEED == dbsync_env.changelog && FAIL == dbsync_changelog_condition(&sql, &sql_alloc, &sql_offset,
+			"h.hostid", "i.itemid", "t.triggerid"))
+	{
+		zbx_free(sql);
+		return SUCCEED;
+	}
+
+	result = DBselect("%s", sql);
+	zbx_free(sql);
+
+	// 查询失败，返回错误
+	if (NULL == result)
+		return FAIL;
 
 	// 如果数据同步模式为初始化
 	if (ZBX_DBSYNC_INIT == sync->mode)
@@ -2871,7 +4369,8 @@ int zbx_dbsync_compare_functions(zbx_dbsync_t *sync)
 	}
 
 	// 创建一个哈希集，用于存储函数ID
-	zbx_hashset_create(&ids, dbsync_env.cache->functions.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
+	zbx_hashset_create(&ids, SUCCEED == dbsync_env.changelog ? (size_t)dbsync_env.functionids.values_num :
+			(size_t)dbsync_env.cache->functions.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
 			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 
 	// 遍历查询结果，比较函数ID和缓存中的函数ID
@@ -2884,6 +4383,8 @@ int zbx_dbsync_compare_functions(zbx_dbsync_t *sync)
 		// 将rowid插入到哈希集中
 		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
 
+		dbsync_snapshot_add_row(sync, dbrow);
+
 		// 查找缓存中的函数
 		if (NULL == (function = (ZBX_DC_FUNCTION *)zbx_hashset_search(&dbsync_env.cache->functions, &rowid)))
 			// 标记为新增函数
@@ -2897,6 +4398,21 @@ int zbx_dbsync_compare_functions(zbx_dbsync_t *sync)
 			dbsync_add_row(sync, rowid, tag, dbrow);
 	}
 
+	/* during incremental synchronization only the affected functions can be removed */
+	// 增量同步时只有受影响的函数可能被删除
+	if (SUCCEED == dbsync_env.changelog)
+	{
+		for (i = 0; i < dbsync_env.functionids.values_num; i++)
+		{
+			rowid = dbsync_env.functionids.values[i];
+
+			if (NULL == zbx_hashset_search(&ids, &rowid))
+				dbsync_add_row(sync, rowid, ZBX_DBSYNC_ROW_REMOVE, NULL);
+		}
+
+		goto out;
+	}
+
 	// 重置哈希集迭代器
 	zbx_hashset_iter_reset(&dbsync_env.cache->functions, &iter);
 	// 遍历缓存中的函数，检查是否需要在数据库中删除
@@ -2906,7 +4422,7 @@ int zbx_dbsync_compare_functions(zbx_dbsync_t *sync)
 		if (NULL == zbx_hashset_search(&ids, &function->functionid))
 			dbsync_add_row(sync, function->functionid, ZBX_DBSYNC_ROW_REMOVE, NULL);
 	}
-
+out:
 	// 销毁哈希集
 	zbx_hashset_destroy(&ids);
 	// 释放查询结果
@@ -2916,18 +4432,6 @@ int zbx_dbsync_compare_functions(zbx_dbsync_t *sync)
 	return SUCCEED;
 }
 
-	while (NULL != (function = (ZBX_DC_FUNCTION *)zbx_hashset_iter_next(&iter)))
-	{
-		if (NULL == zbx_hashset_search(&ids, &function->functionid))
-			dbsync_add_row(sync, function->functionid, ZBX_DBSYNC_ROW_REMOVE, NULL);
-	}
-
-	zbx_hashset_destroy(&ids);
-	DBfree_result(result);
-
-	return SUCCEED;
-}
-
 /******************************************************************************
  *                                                                            *
 /******************************************************************************
@@ -2935,6 +4439,19 @@ int zbx_dbsync_compare_functions(zbx_dbsync_t *sync)
  *这块代码的主要目的是比较数据库中的一行数据与给定的表达式是否匹配。函数`dbsync_compare_expression`接收两个参数，分别是表达式指针`expression`和数据库中的一行数据`dbrow`。通过逐个比较`dbrow`中的字段与表达式中的相应字段，判断数据是否匹配。如果所有字段都匹配成功，函数返回`SUCCEED`，表示表达式与数据库数据匹配；否则，返回`FAIL`，表示表达式与数据库数据不匹配。
  ******************************************************************************/
 // 定义一个函数，用于比较数据库中的一行数据与给定的表达式是否匹配
+/******************************************************************************
+ *                                                                            *
+ * Function: dbsync_compare_expression                                        *
+ *                                                                            *
+ * Purpose: compares expressions table row with cached configuration data     *
+ *                                                                            *
+ * Parameter: expression - [IN] the cached expression                         *
+ *            row        - [IN] the database row                              *
+ *                                                                            *
+ * Return value: SUCCEED - the row matches configuration data                 *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
 static int	dbsync_compare_expression(const ZBX_DC_EXPRESSION *expression, const DB_ROW dbrow)
 {
 	// 判断数据库中的一行数据的第一个字段（dbrow[0]）是否与表达式的正则表达式（expression->regexp）匹配
@@ -2964,6 +4481,22 @@ static int	dbsync_compare_expression(const ZBX_DC_EXPRESSION *expression, const
 
 	// 如果所有字段都匹配成功，返回SUCCEED
 	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_dbsync_compare_exprssions                                    *
+ *                                                                            *
+ * Purpose: compares expressions, regexps tables with cached configuration    *
+ *          data                                                              *
+ *                                                                            *
+ * Parameter: cache - [IN] the configuration cache                            *
+ *            sync  - [OUT] the changeset                                     *
+ *                                                                            *
+ * Return value: SUCCEED - the changeset was successfully calculated          *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  * *
  *这段代码的主要目的是比较两个数据库中的表达式信息，并根据需要进行添加、更新和删除操作。具体来说，代码的功能如下：
@@ -3060,35 +4593,6 @@ int zbx_dbsync_compare_expressions(zbx_dbsync_t *sync)
 	return SUCCEED;
 }
 
-
-		ZBX_STR2UINT64(rowid, dbrow[1]);
-		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
-
-		if (NULL == (expression = (ZBX_DC_EXPRESSION *)zbx_hashset_search(&dbsync_env.cache->expressions,
-				&rowid)))
-		{
-			tag = ZBX_DBSYNC_ROW_ADD;
-		}
-		else if (FAIL == dbsync_compare_expression(expression, dbrow))
-			tag = ZBX_DBSYNC_ROW_UPDATE;
-
-		if (ZBX_DBSYNC_ROW_NONE != tag)
-			dbsync_add_row(sync, rowid, tag, dbrow);
-	}
-
-	zbx_hashset_iter_reset(&dbsync_env.cache->expressions, &iter);
-	while (NULL != (expression = (ZBX_DC_EXPRESSION *)zbx_hashset_iter_next(&iter)))
-	{
-		if (NULL == zbx_hashset_search(&ids, &expression->expressionid))
-			dbsync_add_row(sync, expression->expressionid, ZBX_DBSYNC_ROW_REMOVE, NULL);
-	}
-
-	zbx_hashset_destroy(&ids);
-	DBfree_result(result);
-
-	return SUCCEED;
-}
-
 /******************************************************************************
  *                                                                            *
  * Function: dbsync_compare_action                                            *
@@ -3126,6 +4630,18 @@ static int	dbsync_compare_action(const zbx_dc_action_t *action, const DB_ROW dbr
 }
 
 
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_dbsync_compare_actions                                       *
+ *                                                                            *
+ * Purpose: compares actions table with cached configuration data             *
+ *                                                                            *
+ * Parameter: sync - [OUT] the changeset                                      *
+ *                                                                            *
+ * Return value: SUCCEED - the changeset was successfully calculated          *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  *                                                                            *
  * Function: zbx_dbsync_compare_actions                                       *
@@ -3217,16 +4733,6 @@ int zbx_dbsync_compare_actions(zbx_dbsync_t *sync)
 	return SUCCEED;
 }
 
-		if (NULL == zbx_hashset_search(&ids, &action->actionid))
-			dbsync_add_row(sync, action->actionid, ZBX_DBSYNC_ROW_REMOVE, NULL);
-	}
-
-	zbx_hashset_destroy(&ids);
-	DBfree_result(result);
-
-	return SUCCEED;
-}
-
 /******************************************************************************
  *                                                                            *
  * Function: dbsync_compare_action_op                                         *
@@ -3417,6 +4923,20 @@ static int	dbsync_compare_action_condition(const zbx_dc_action_condition_t *cond
 	// 如果以上所有比较都成功，返回SUCCEED（表示比较成功）
 	return SUCCEED;
 }
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_dbsync_compare_action_conditions                             *
+ *                                                                            *
+ * Purpose: compares conditions table with cached configuration data          *
+ *                                                                            *
+ * Parameter: cache - [IN] the configuration cache                            *
+ *            sync  - [OUT] the changeset                                     *
+ *                                                                            *
+ * Return value: SUCCEED - the changeset was successfully calculated          *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  * *
  *这段代码的主要目的是比较动作条件数据库中的数据与缓存中的数据，对于新增、更新和删除的动作条件进行处理。具体来说，它会执行以下操作：
@@ -3431,7 +4951,7 @@ static int	dbsync_compare_action_condition(const zbx_dc_action_condition_t *cond
  *8. 销毁哈希集并释放数据库查询结果。
  *9. 返回成功。
  ******************************************************************************/
-int zbx_dbsync_compare_action_conditions(zbx_dbsync_t *sync)
+int	zbx_dbsync_compare_action_conditions(zbx_dbsync_t *sync)
 {
 	// 定义变量
 	DB_ROW				dbrow;
@@ -3473,6 +4993,8 @@ int zbx_dbsync_compare_action_conditions(zbx_dbsync_t *sync)
 	while (NULL != (dbrow = DBfetch(result)))
 	{
 		// 将dbrow中的数据转换为zbx_uint64类型
+		unsigned char	tag = ZBX_DBSYNC_ROW_NONE;
+
 		ZBX_STR2UINT64(rowid, dbrow[0]);
 		// 将rowid插入到哈希集中
 		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
@@ -3482,18 +5004,14 @@ int zbx_dbsync_compare_action_conditions(zbx_dbsync_t *sync)
 				&dbsync_env.cache->action_conditions, &rowid)))
 		{
 			// 如果不存在，标记为新增
-			condition = (zbx_dc_action_condition_t *)zbx_hashset_add_new(
-				&dbsync_env.cache->action_conditions, (void *)&rowid, sizeof(rowid));
+			tag = ZBX_DBSYNC_ROW_ADD;
 		}
 		else if (FAIL == dbsync_compare_action_condition(condition, dbrow))
-		{
-			// 如果比较失败，标记为更新
-			condition->flags |= ZBX_DC_ACTION_CONDITION_UPDATE;
-		}
+			tag = ZBX_DBSYNC_ROW_UPDATE;
 
 		// 如果标记不为空，将数据添加到dbsync中
-		if (ZBX_DBSYNC_ROW_NONE != condition->flags)
-			dbsync_add_row(sync, rowid, condition->flags, dbrow);
+		if (ZBX_DBSYNC_ROW_NONE != tag)
+			dbsync_add_row(sync, rowid, tag, dbrow);
 	}
 
 	// 重置哈希集迭代器
@@ -3503,7 +5021,7 @@ int zbx_dbsync_compare_action_conditions(zbx_dbsync_t *sync)
 	{
 		// 如果该动作条件在ids哈希集中不存在，标记为删除
 		if (NULL == zbx_hashset_search(&ids, &condition->conditionid))
-			condition->flags |= ZBX_DC_ACTION_CONDITION_DELETE;
+			dbsync_add_row(sync, condition->conditionid, ZBX_DBSYNC_ROW_REMOVE, NULL);
 	}
 
 	// 销毁ids哈希集
@@ -3511,23 +5029,7 @@ int zbx_dbsync_compare_action_conditions(zbx_dbsync_t *sync)
 	// 释放数据库查询结果
 	DBfree_result(result);
 
-	// 返回成功
-	return SUCCEED;
-}
-
-			dbsync_add_row(sync, rowid, tag, dbrow);
-	}
-
-	zbx_hashset_iter_reset(&dbsync_env.cache->action_conditions, &iter);
-	while (NULL != (condition = (zbx_dc_action_condition_t *)zbx_hashset_iter_next(&iter)))
-	{
-		if (NULL == zbx_hashset_search(&ids, &condition->conditionid))
-			dbsync_add_row(sync, condition->conditionid, ZBX_DBSYNC_ROW_REMOVE, NULL);
-	}
-
-	zbx_hashset_destroy(&ids);
-	DBfree_result(result);
-
+	// 返回成功
 	return SUCCEED;
 }
 
@@ -3556,6 +5058,28 @@ static int	dbsync_compare_trigger_tag(const zbx_dc_trigger_tag_t *tag, const DB_
 	if (FAIL == dbsync_compare_uint64(dbrow[1], tag->triggerid))
 		return FAIL;
 
+	if (FAIL == dbsync_compare_str(dbrow[2], tag->tag))
+		return FAIL;
+
+	if (FAIL == dbsync_compare_str(dbrow[3], tag->value))
+		return FAIL;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_dbsync_compare_trigger_tags                                  *
+ *                                                                            *
+ * Purpose: compares trigger tags table with cached configuration data        *
+ *                                                                            *
+ * Parameter: cache - [IN] the configuration cache                            *
+ *            sync  - [OUT] the changeset                                     *
+ *                                                                            *
+ * Return value: SUCCEED - the changeset was successfully calculated          *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  * *
  *整个代码块的主要目的是对比数据库中存在的触发器标签和实际运行中的触发器标签，对于发生变更的标签，将它们添加到同步对象中，以便后续进行数据同步操作。同时，删除不再使用的触发器标签。
@@ -3640,33 +5164,6 @@ int zbx_dbsync_compare_trigger_tags(zbx_dbsync_t *sync)
 	return SUCCEED;
 }
 
-		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
-
-		if (NULL == (trigger_tag = (zbx_dc_trigger_tag_t *)zbx_hashset_search(&dbsync_env.cache->trigger_tags,
-				&rowid)))
-		{
-			tag = ZBX_DBSYNC_ROW_ADD;
-		}
-		else if (FAIL == dbsync_compare_trigger_tag(trigger_tag, dbrow))
-			tag = ZBX_DBSYNC_ROW_UPDATE;
-
-		if (ZBX_DBSYNC_ROW_NONE != tag)
-			dbsync_add_row(sync, rowid, tag, dbrow);
-	}
-
-	zbx_hashset_iter_reset(&dbsync_env.cache->trigger_tags, &iter);
-	while (NULL != (trigger_tag = (zbx_dc_trigger_tag_t *)zbx_hashset_iter_next(&iter)))
-	{
-		if (NULL == zbx_hashset_search(&ids, &trigger_tag->triggertagid))
-			dbsync_add_row(sync, trigger_tag->triggertagid, ZBX_DBSYNC_ROW_REMOVE, NULL);
-	}
-
-	zbx_hashset_destroy(&ids);
-	DBfree_result(result);
-
-	return SUCCEED;
-}
-
 /******************************************************************************
  *                                                                            *
  * Function: dbsync_compare_correlation                                       *
@@ -3814,7 +5311,6 @@ int zbx_dbsync_compare_correlations(zbx_dbsync_t *sync)
 	return SUCCEED;
 }
 
-
 /******************************************************************************
  *                                                                            *
  * Function: dbsync_compare_corr_condition                                    *
@@ -3827,6 +5323,50 @@ int zbx_dbsync_compare_correlations(zbx_dbsync_t *sync)
  *                                                                            *
  * Return value: SUCCEED - the row matches configuration data                 *
  *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	dbsync_compare_corr_condition(const zbx_dc_corr_condition_t *corr_condition, const DB_ROW dbrow)
+{
+	if (FAIL == dbsync_compare_uint64(dbrow[1], corr_condition->correlationid))
+		return FAIL;
+
+	if (FAIL == dbsync_compare_uchar(dbrow[2], corr_condition->type))
+		return FAIL;
+
+	switch (corr_condition->type)
+	{
+		case ZBX_CORR_CONDITION_OLD_EVENT_TAG:
+			/* break; is not missing here */
+		case ZBX_CORR_CONDITION_NEW_EVENT_TAG:
+			if (FAIL == dbsync_compare_str(dbrow[3], corr_condition->data.tag.tag))
+				return FAIL;
+			break;
+		case ZBX_CORR_CONDITION_OLD_EVENT_TAG_VALUE:
+			/* break; is not missing here */
+		case ZBX_CORR_CONDITION_NEW_EVENT_TAG_VALUE:
+			if (FAIL == dbsync_compare_str(dbrow[4], corr_condition->data.tag_value.tag))
+				return FAIL;
+			if (FAIL == dbsync_compare_str(dbrow[5], corr_condition->data.tag_value.value))
+				return FAIL;
+			if (FAIL == dbsync_compare_uchar(dbrow[6], corr_condition->data.tag_value.op))
+				return FAIL;
+			break;
+		case ZBX_CORR_CONDITION_NEW_EVENT_HOSTGROUP:
+			if (FAIL == dbsync_compare_uint64(dbrow[7], corr_condition->data.group.groupid))
+				return FAIL;
+			if (FAIL == dbsync_compare_uchar(dbrow[8], corr_condition->data.group.op))
+				return FAIL;
+			break;
+		case ZBX_CORR_CONDITION_EVENT_TAG_PAIR:
+			if (FAIL == dbsync_compare_str(dbrow[9], corr_condition->data.tag_pair.oldtag))
+				return FAIL;
+			if (FAIL == dbsync_compare_str(dbrow[10], corr_condition->data.tag_pair.newtag))
+				return FAIL;
+			break;
+	}
+	return SUCCEED;
+}
+
 /******************************************************************************
  * *
  *这段代码的主要目的是比较数据库中存储的关联条件（correlation）和缓存中的关联条件，对于不同的情况执行相应的操作（添加、更新、删除），并将处理后的关联条件添加到同步数据中。整个代码块可以分为以下几个部分：
@@ -3848,6 +5388,20 @@ int zbx_dbsync_compare_correlations(zbx_dbsync_t *sync)
  *
  *6. 返回成功：表示整个关联条件比较和处理过程顺利完成。
  ******************************************************************************/
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_dbsync_compare_corr_conditions                               *
+ *                                                                            *
+ * Purpose: compares correlation condition tables with cached configuration   *
+ *          data                                                              *
+ *                                                                            *
+ * Parameter: cache - [IN] the configuration cache                            *
+ *            sync  - [OUT] the changeset                                     *
+ *                                                                            *
+ * Return value: SUCCEED - the changeset was successfully calculated          *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
 int zbx_dbsync_compare_corr_conditions(zbx_dbsync_t *sync)
 {
 	// 定义变量
@@ -3933,99 +5487,6 @@ int zbx_dbsync_compare_corr_conditions(zbx_dbsync_t *sync)
 	return SUCCEED;
 }
 
-	}
-
-	// 如果上述所有判断均通过，返回SUCCEED，表示数据库行与关联条件匹配
-	return SUCCEED;
-}
-
-
-/******************************************************************************
- *                                                                            *
- * Function: zbx_dbsync_compare_corr_conditions                               *
- *                                                                            *
- * Purpose: compares correlation condition tables with cached configuration   *
- *          data                                                              *
- *                                                                            *
- * Parameter: cache - [IN] the configuration cache                            *
- *            sync  - [OUT] the changeset                                     *
- *                                                                            *
- * Return value: SUCCEED - the changeset was successfully calculated          *
- *               FAIL    - otherwise                                          *
- *                                                                            *
- ******************************************************************************/
-int	zbx_dbsync_compare_corr_conditions(zbx_dbsync_t *sync)
-{
-	DB_ROW			dbrow;
-	DB_RESULT		result;
-	zbx_hashset_t		ids;
-	zbx_hashset_iter_t	iter;
-	zbx_uint64_t		rowid;
-	zbx_dc_corr_condition_t	*corr_condition;
-
-	if (NULL == (result = DBselect(
-			"select cc.corr_conditionid,cc.correlationid,cc.type,cct.tag,cctv.tag,cctv.value,cctv.operator,"
-				" ccg.groupid,ccg.operator,cctp.oldtag,cctp.newtag"
-			" from correlation c,corr_condition cc"
-			" left join corr_condition_tag cct"
-				" on cct.corr_conditionid=cc.corr_conditionid"
-			" left join corr_condition_tagvalue cctv"
-				" on cctv.corr_conditionid=cc.corr_conditionid"
-			" left join corr_condition_group ccg"
-				" on ccg.corr_conditionid=cc.corr_conditionid"
-			" left join corr_condition_tagpair cctp"
-				" on cctp.corr_conditionid=cc.corr_conditionid"
-			" where c.correlationid=cc.correlationid"
-				" and c.status=%d",
-			ZBX_CORRELATION_ENABLED)))
-	{
-		return FAIL;
-	}
-
-	dbsync_prepare(sync, 11, NULL);
-
-	if (ZBX_DBSYNC_INIT == sync->mode)
-	{
-		sync->dbresult = result;
-		return SUCCEED;
-	}
-
-	zbx_hashset_create(&ids, dbsync_env.cache->corr_conditions.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
-			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
-
-	while (NULL != (dbrow = DBfetch(result)))
-	{
-		unsigned char	tag = ZBX_DBSYNC_ROW_NONE;
-
-		ZBX_STR2UINT64(rowid, dbrow[0]);
-		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
-
-		if (NULL == (corr_condition = (zbx_dc_corr_condition_t *)zbx_hashset_search(
-				&dbsync_env.cache->corr_conditions, &rowid)))
-		{
-			tag = ZBX_DBSYNC_ROW_ADD;
-		}
-		else if (FAIL == dbsync_compare_corr_condition(corr_condition, dbrow))
-			tag = ZBX_DBSYNC_ROW_UPDATE;
-
-		if (ZBX_DBSYNC_ROW_NONE != tag)
-			dbsync_add_row(sync, rowid, tag, dbrow);
-	}
-
-	zbx_hashset_iter_reset(&dbsync_env.cache->corr_conditions, &iter);
-	while (NULL != (corr_condition = (zbx_dc_corr_condition_t *)zbx_hashset_iter_next(&iter)))
-	{
-		if (NULL == zbx_hashset_search(&ids, &corr_condition->corr_conditionid))
-			dbsync_add_row(sync, corr_condition->corr_conditionid, ZBX_DBSYNC_ROW_REMOVE, NULL);
-	}
-
-	zbx_hashset_destroy(&ids);
-	DBfree_result(result);
-
-	return SUCCEED;
-}
-
-
 /******************************************************************************
  *                                                                            *
  * Function: dbsync_compare_corr_operation                                    *
@@ -4062,6 +5523,20 @@ static int	dbsync_compare_corr_operation(const zbx_dc_corr_operation_t *corr_ope
 }
 
 
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_dbsync_compare_corr_operations                               *
+ *                                                                            *
+ * Purpose: compares correlation operation tables with cached configuration   *
+ *          data                                                              *
+ *                                                                            *
+ * Parameter: cache - [IN] the configuration cache                            *
+ *            sync  - [OUT] the changeset                                     *
+ *                                                                            *
+ * Return value: SUCCEED - the changeset was successfully calculated          *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  *                                                                            *
  * Function: zbx_dbsync_compare_corr_operations                               *
@@ -4092,7 +5567,7 @@ static int	dbsync_compare_corr_operation(const zbx_dc_corr_operation_t *corr_ope
  *11. 返回成功：表示整个操作顺利完成。
  ******************************************************************************/
 // 定义一个函数，用于比较两个zbx_dc_corr_operation结构体对象的差异
-int zbx_dbsync_compare_corr_operations(zbx_dbsync_t *sync)
+int	zbx_dbsync_compare_corr_operations(zbx_dbsync_t *sync)
 {
 	// 声明一些变量
 	DB_ROW			dbrow;
@@ -4161,90 +5636,50 @@ int zbx_dbsync_compare_corr_operations(zbx_dbsync_t *sync)
 		// 如果不在ids哈希集中，则标记为移除操作
 		if (NULL == zbx_hashset_search(&ids, &corr_operation->corr_operationid))
 			dbsync_add_row(sync, corr_operation->corr_operationid, ZBX_DBSYNC_ROW_REMOVE, NULL);
-/******************************************************************************
- * *
- *整个代码块的主要目的是比较数据库中存储的主机组信息和本地缓存的主机组信息，并将差异应用到本地缓存中。具体来说，代码实现了以下功能：
- *
- *1. 从数据库中查询主机组信息，并存储在`result`变量中。
- *2. 预处理数据库同步操作，为后续的比较和更新操作做好准备。
- *3. 判断同步模式，如果是初始化模式，将数据库查询结果赋值给同步对象的数据结果，并返回成功状态。
- *4. 创建一个哈希集合`ids`，用于存储主机组ID。
- *5. 遍历数据库查询结果，并将主机组ID添加到哈希集合`ids`中。
- *6. 对于哈希集合`ids`中已存在的主机组，检查数据库中的主机组信息是否与本地缓存中的主机组信息匹配。如果不匹配，标记为更新。
- *7. 将待处理的主机组（包括新增、更新和删除）添加到同步操作的待处理行列表中。
- *8. 迭代本地缓存中的主机组，检查是否需要在同步操作中删除。
- *9. 销毁哈希集合`ids`，并释放数据库查询结果。
- *10. 同步操作完成后，返回成功状态。
- ******************************************************************************/
-int zbx_dbsync_compare_host_groups(zbx_dbsync_t *sync)
-{
-	// 声明变量
-	DB_ROW			dbrow;
-	DB_RESULT		result;
-	zbx_hashset_t		ids; // 用于存储主机组ID的哈希集合
-	zbx_hashset_iter_t	iter; // 用于迭代哈希集合的迭代器
-	zbx_uint64_t		rowid; // 存储从数据库中读取的主机组ID
-	zbx_dc_hostgroup_t	*group; // 存储主机组信息的数据结构指针
-
-	// 从数据库中查询主机组信息
-	if (NULL == (result = DBselect("select groupid,name from hstgrp")))
-		return FAIL; // 如果查询失败，返回错误状态
-
-	// 预处理数据库同步操作
-	dbsync_prepare(sync, 2, NULL);
-
-	// 判断同步模式
-	if (ZBX_DBSYNC_INIT == sync->mode)
-	{
-		sync->dbresult = result; // 将数据库查询结果赋值给同步对象的数据结果
-		return SUCCEED; // 初始化成功，返回成功状态
-	}
-
-	// 创建哈希集合用于存储主机组ID
-	zbx_hashset_create(&ids, dbsync_env.cache->hostgroups.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
-			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
-
-	// 遍历数据库查询结果，并将主机组ID添加到哈希集合中
-	while (NULL != (dbrow = DBfetch(result)))
-	{
-		unsigned char	tag = ZBX_DBSYNC_ROW_NONE;
-
-		ZBX_STR2UINT64(rowid, dbrow[0]); // 将字符串转换为整数
-		zbx_hashset_insert(&ids, &rowid, sizeof(rowid)); // 将主机组ID添加到哈希集合中
-
-		// 检查哈希集合中是否存在该主机组
-		if (NULL == (group = (zbx_dc_hostgroup_t *)zbx_hashset_search(&dbsync_env.cache->hostgroups, &rowid)))
-			tag = ZBX_DBSYNC_ROW_ADD; // 如果不存在，标记为新增
-		else if (FAIL == dbsync_compare_host_group(group, dbrow))
-			tag = ZBX_DBSYNC_ROW_UPDATE; // 如果不匹配，标记为更新
-
-		// 如果标记为新增或更新，将主机组添加到同步操作的待处理行列表中
-		if (ZBX_DBSYNC_ROW_NONE != tag)
-			dbsync_add_row(sync, rowid, tag, dbrow);
-	}
-
-	// 迭代哈希集合中的主机组，检查是否需要在同步操作中删除
-	zbx_hashset_iter_reset(&dbsync_env.cache->hostgroups, &iter);
-	while (NULL != (group = (zbx_dc_hostgroup_t *)zbx_hashset_iter_next(&iter)))
-	{
-		// 如果主机组ID不在ids哈希集合中，标记为删除
-		if (NULL == zbx_hashset_search(&ids, &group->groupid))
-			dbsync_add_row(sync, group->groupid, ZBX_DBSYNC_ROW_REMOVE, NULL);
 	}
 
-	// 销毁ids哈希集合
 	zbx_hashset_destroy(&ids);
-	// 释放数据库查询结果
 	DBfree_result(result);
 
-	// 同步操作完成后，返回成功状态
 	return SUCCEED;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: dbsync_compare_host_group                                        *
+ *                                                                            *
+ * Purpose: compares host group table row with cached configuration data      *
+ *                                                                            *
+ * Parameter: group - [IN] the cached host group                              *
+ *            row   - [IN] the database row                                   *
+ *                                                                            *
+ * Return value: SUCCEED - the row matches configuration data                 *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	dbsync_compare_host_group(const zbx_dc_hostgroup_t *group, const DB_ROW dbrow)
+{
+	if (FAIL == dbsync_compare_str(dbrow[1], group->name))
+		return FAIL;
+
 	return SUCCEED;
 }
 
-
+/******************************************************************************
+ * *
+ *整个代码块的主要目的是比较数据库中存储的主机组信息和本地缓存的主机组信息，并将差异应用到本地缓存中。具体来说，代码实现了以下功能：
+ *
+ *1. 从数据库中查询主机组信息，并存储在`result`变量中。
+ *2. 预处理数据库同步操作，为后续的比较和更新操作做好准备。
+ *3. 判断同步模式，如果是初始化模式，将数据库查询结果赋值给同步对象的数据结果，并返回成功状态。
+ *4. 创建一个哈希集合`ids`，用于存储主机组ID。
+ *5. 遍历数据库查询结果，并将主机组ID添加到哈希集合`ids`中。
+ *6. 对于哈希集合`ids`中已存在的主机组，检查数据库中的主机组信息是否与本地缓存中的主机组信息匹配。如果不匹配，标记为更新。
+ *7. 将待处理的主机组（包括新增、更新和删除）添加到同步操作的待处理行列表中。
+ *8. 迭代本地缓存中的主机组，检查是否需要在同步操作中删除。
+ *9. 销毁哈希集合`ids`，并释放数据库查询结果。
+ *10. 同步操作完成后，返回成功状态。
+ ******************************************************************************/
 /******************************************************************************
  *                                                                            *
  * Function: zbx_dbsync_compare_host_groups                                   *
@@ -4258,55 +5693,68 @@ int zbx_dbsync_compare_host_groups(zbx_dbsync_t *sync)
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-int	zbx_dbsync_compare_host_groups(zbx_dbsync_t *sync)
+int zbx_dbsync_compare_host_groups(zbx_dbsync_t *sync)
 {
+	// 声明变量
 	DB_ROW			dbrow;
 	DB_RESULT		result;
-	zbx_hashset_t		ids;
-	zbx_hashset_iter_t	iter;
-	zbx_uint64_t		rowid;
-	zbx_dc_hostgroup_t	*group;
+	zbx_hashset_t		ids; // 用于存储主机组ID的哈希集合
+	zbx_hashset_iter_t	iter; // 用于迭代哈希集合的迭代器
+	zbx_uint64_t		rowid; // 存储从数据库中读取的主机组ID
+	zbx_dc_hostgroup_t	*group; // 存储主机组信息的数据结构指针
 
+	// 从数据库中查询主机组信息
 	if (NULL == (result = DBselect("select groupid,name from hstgrp")))
-		return FAIL;
+		return FAIL; // 如果查询失败，返回错误状态
 
+	// 预处理数据库同步操作
 	dbsync_prepare(sync, 2, NULL);
 
+	// 判断同步模式
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
-		sync->dbresult = result;
-		return SUCCEED;
+		sync->dbresult = result; // 将数据库查询结果赋值给同步对象的数据结果
+		return SUCCEED; // 初始化成功，返回成功状态
 	}
 
+	// 创建哈希集合用于存储主机组ID
 	zbx_hashset_create(&ids, dbsync_env.cache->hostgroups.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
 			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 
+	// 遍历数据库查询结果，并将主机组ID添加到哈希集合中
 	while (NULL != (dbrow = DBfetch(result)))
 	{
 		unsigned char	tag = ZBX_DBSYNC_ROW_NONE;
 
-		ZBX_STR2UINT64(rowid, dbrow[0]);
-		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
+		ZBX_STR2UINT64(rowid, dbrow[0]); // 将字符串转换为整数
+		zbx_hashset_insert(&ids, &rowid, sizeof(rowid)); // 将主机组ID添加到哈希集合中
 
+		// 检查哈希集合中是否存在该主机组
 		if (NULL == (group = (zbx_dc_hostgroup_t *)zbx_hashset_search(&dbsync_env.cache->hostgroups, &rowid)))
-			tag = ZBX_DBSYNC_ROW_ADD;
+			tag = ZBX_DBSYNC_ROW_ADD; // 如果不存在，标记为新增
 		else if (FAIL == dbsync_compare_host_group(group, dbrow))
-			tag = ZBX_DBSYNC_ROW_UPDATE;
+			tag = ZBX_DBSYNC_ROW_UPDATE; // 如果不匹配，标记为更新
 
+		// 如果标记为新增或更新，将主机组添加到同步操作的待处理行列表中
 		if (ZBX_DBSYNC_ROW_NONE != tag)
 			dbsync_add_row(sync, rowid, tag, dbrow);
 	}
 
+	// 迭代哈希集合中的主机组，检查是否需要在同步操作中删除
 	zbx_hashset_iter_reset(&dbsync_env.cache->hostgroups, &iter);
 	while (NULL != (group = (zbx_dc_hostgroup_t *)zbx_hashset_iter_next(&iter)))
 	{
+		// 如果主机组ID不在ids哈希集合中，标记为删除
 		if (NULL == zbx_hashset_search(&ids, &group->groupid))
 			dbsync_add_row(sync, group->groupid, ZBX_DBSYNC_ROW_REMOVE, NULL);
 	}
 
+	// 销毁ids哈希集合
 	zbx_hashset_destroy(&ids);
+	// 释放数据库查询结果
 	DBfree_result(result);
 
+	// 同步操作完成后，返回成功状态
 	return SUCCEED;
 }
 
@@ -4327,19 +5775,38 @@ int	zbx_dbsync_compare_host_groups(zbx_dbsync_t *sync)
 static char	**dbsync_item_pp_preproc_row(char **row)
 {
 	zbx_uint64_t	hostid;
+	if (SUCCEED == dbsync_check_row_macros(row, 3))
+	{
+		// 获取关联的主机标识符
+		/* get associated host identifier */
+		ZBX_STR2UINT64(hostid, row[5]);
+		// 扩展用户宏
+		/* expand user macros */
+		row[3] = zbx_dc_expand_user_macros(row[3], &hostid, 1, NULL);
+	}
+
+	return row;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: dbsync_compare_item_preproc                                      *
+ *                                                                            *
+ * Purpose: compares item preproc table row with cached configuration data    *
+ *                                                                            *
+ * Parameter: group - [IN] the cached item preprocessing operation            *
+ *            row   - [IN] the database row                                   *
+ *                                                                            *
+ * Return value: SUCCEED - the row matches configuration data                 *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  * *
  *这块代码的主要目的是检查数据库同步中的行宏是否成功。如果成功，则提取关联的主机标识符，并使用该标识符扩展用户宏。最后，返回处理后的行数据。
  ******************************************************************************/
 // 定义一个函数，用于检查数据库同步中的行宏是否成功
-if (SUCCEED == dbsync_check_row_macros(row, 3))
-{
-    // 获取关联的主机标识符
-    ZBX_STR2UINT64(hostid, row[5]);
 
-    // 扩展用户宏
-    row[3] = zbx_dc_expand_user_macros(row[3], &hostid, 1, NULL);
-}
 
 // 返回处理后的行数据
 /******************************************************************************
@@ -4361,6 +5828,25 @@ static int	dbsync_compare_item_preproc(const zbx_dc_preproc_op_t *preproc, const
 	if (FAIL == dbsync_compare_str(dbrow[3], preproc->params))
 		return FAIL;
 
+	if (FAIL == dbsync_compare_int(dbrow[4], preproc->step))
+		return FAIL;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_dbsync_compare_item_preprocessing                            *
+ *                                                                            *
+ * Purpose: compares item preproc tables with cached configuration data       *
+ *                                                                            *
+ * Parameter: cache - [IN] the configuration cache                            *
+ *            sync  - [OUT] the changeset                                     *
+ *                                                                            *
+ * Return value: SUCCEED - the changeset was successfully calculated          *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  * *
  *整个代码块的主要目的是比较数据库中的预处理项（item_preproc）和本地缓存的预处理项，对于新增、更新和删除的预处理项进行相应的操作。具体来说，代码实现了以下功能：
@@ -4372,7 +5858,7 @@ static int	dbsync_compare_item_preproc(const zbx_dc_preproc_op_t *preproc, const
  *5. 释放查询结果，并销毁hashset。
  *6. 返回执行结果（SUCCEED或FAIL）。
  ******************************************************************************/
-int zbx_dbsync_compare_item_preprocs(zbx_dbsync_t *sync)
+int	zbx_dbsync_compare_item_preprocs(zbx_dbsync_t *sync)
 {
 	// 定义所需的变量
 	DB_ROW			dbrow;
@@ -4416,6 +5902,7 @@ int zbx_dbsync_compare_item_preprocs(zbx_dbsync_t *sync)
 	while (NULL != (dbrow = DBfetch(result)))
 	{
 		// 解析记录ID
+		unsigned char	tag = ZBX_DBSYNC_ROW_NONE;
 		ZBX_STR2UINT64(rowid, dbrow[0]);
 		// 将记录ID插入hashset中
 		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
@@ -4458,45 +5945,6 @@ int zbx_dbsync_compare_item_preprocs(zbx_dbsync_t *sync)
 	return SUCCEED;
 }
 
-		return SUCCEED;
-	}
-
-	zbx_hashset_create(&ids, dbsync_env.cache->hostgroups.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
-			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
-
-	while (NULL != (dbrow = DBfetch(result)))
-	{
-		unsigned char	tag = ZBX_DBSYNC_ROW_NONE;
-		ZBX_STR2UINT64(rowid, dbrow[0]);
-		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
-
-		row = dbsync_preproc_row(sync, dbrow);
-
-		if (NULL == (preproc = (zbx_dc_preproc_op_t *)zbx_hashset_search(&dbsync_env.cache->preprocops,
-				&rowid)))
-		{
-			tag = ZBX_DBSYNC_ROW_ADD;
-		}
-		else if (FAIL == dbsync_compare_item_preproc(preproc, row))
-			tag = ZBX_DBSYNC_ROW_UPDATE;
-
-		if (ZBX_DBSYNC_ROW_NONE != tag)
-			dbsync_add_row(sync, rowid, tag, row);
-	}
-
-	zbx_hashset_iter_reset(&dbsync_env.cache->preprocops, &iter);
-	while (NULL != (preproc = (zbx_dc_preproc_op_t *)zbx_hashset_iter_next(&iter)))
-	{
-		if (NULL == zbx_hashset_search(&ids, &preproc->item_preprocid))
-			dbsync_add_row(sync, preproc->item_preprocid, ZBX_DBSYNC_ROW_REMOVE, NULL);
-	}
-
-	zbx_hashset_destroy(&ids);
-	DBfree_result(result);
-
-	return SUCCEED;
-}
-
 /******************************************************************************
  *                                                                            *
  * Function: dbsync_compare_maintenance                                       *
@@ -4535,6 +5983,21 @@ static int	dbsync_compare_maintenance(const zbx_dc_maintenance_t *maintenance, c
 
 	// 如果以上所有条件都满足，返回SUCCEED，表示比较成功
 	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_dbsync_compare_maintenances                                  *
+ *                                                                            *
+ * Purpose: compares maintenances table with cached configuration data        *
+ *                                                                            *
+ * Parameter: cache - [IN] the configuration cache                            *
+ *            sync  - [OUT] the changeset                                     *
+ *                                                                            *
+ * Return value: SUCCEED - the changeset was successfully calculated          *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  * *
  *整个代码块的主要目的是比较数据库中的维护信息与本地缓存的维护信息，对于不一致的地方，更新本地缓存。具体来说，代码做了以下事情：
@@ -4550,7 +6013,7 @@ static int	dbsync_compare_maintenance(const zbx_dc_maintenance_t *maintenance, c
  *9. 销毁维护ID集合，释放查询结果。
  *10. 同步成功，返回SUCCEED。
  ******************************************************************************/
-int zbx_dbsync_compare_maintenances(zbx_dbsync_t *sync)
+int	zbx_dbsync_compare_maintenances(zbx_dbsync_t *sync)
 {
 	// 定义变量
 	DB_ROW			dbrow;
@@ -4588,6 +6051,8 @@ int zbx_dbsync_compare_maintenances(zbx_dbsync_t *sync)
 	while (NULL != (dbrow = DBfetch(result)))
 	{
 		// 将dbrow转换为维护ID
+		unsigned char	tag = ZBX_DBSYNC_ROW_NONE;
+
 		ZBX_STR2UINT64(rowid, dbrow[0]);
 		// 将维护ID添加到集合中
 		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
@@ -4625,23 +6090,6 @@ int zbx_dbsync_compare_maintenances(zbx_dbsync_t *sync)
 	return SUCCEED;
 }
 
-		if (ZBX_DBSYNC_ROW_NONE != tag)
-			dbsync_add_row(sync, rowid, tag, dbrow);
-	}
-
-	zbx_hashset_iter_reset(&dbsync_env.cache->maintenances, &iter);
-	while (NULL != (maintenance = (zbx_dc_maintenance_t *)zbx_hashset_iter_next(&iter)))
-	{
-		if (NULL == zbx_hashset_search(&ids, &maintenance->maintenanceid))
-			dbsync_add_row(sync, maintenance->maintenanceid, ZBX_DBSYNC_ROW_REMOVE, NULL);
-	}
-
-	zbx_hashset_destroy(&ids);
-	DBfree_result(result);
-
-	return SUCCEED;
-}
-
 /******************************************************************************
  *                                                                            *
 /******************************************************************************
@@ -4649,6 +6097,19 @@ int zbx_dbsync_compare_maintenances(zbx_dbsync_t *sync)
  *这块代码的主要目的是比较数据库中的维护标签与zbx_dc_maintenance_tag结构体中的数据是否一致。具体来说，它逐个比较了数据库行中的第3、4、5个元素（分别为操作、标签和值）与结构体中的对应数据，如果所有比较都成功，则返回SUCCEED，表示比较成功；如果有任何一项比较失败，则返回FAIL。
  ******************************************************************************/
 // 定义一个静态函数，用于比较数据库中的维护标签和zbx_dc_maintenance_tag结构体中的数据
+/******************************************************************************
+ *                                                                            *
+ * Function: dbsync_compare_maintenance_tag                                   *
+ *                                                                            *
+ * Purpose: compares maintenance_tag table row with cached configuration data *
+ *                                                                            *
+ * Parameter: maintenance_tag - [IN] the cached maintenance tag               *
+ *            row             - [IN] the database row                         *
+ *                                                                            *
+ * Return value: SUCCEED - the row matches configuration data                 *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
 static int	dbsync_compare_maintenance_tag(const zbx_dc_maintenance_tag_t *maintenance_tag, const DB_ROW dbrow)
 {
 	// 判断dbrow[2]（第3个数据库行元素）与maintenance_tag->op（操作）是否相等，如果不相等，返回FAIL
@@ -4667,18 +6128,6 @@ static int	dbsync_compare_maintenance_tag(const zbx_dc_maintenance_tag_t *mainte
 	return SUCCEED;
 }
 
-	if (FAIL == dbsync_compare_int(dbrow[2], maintenance_tag->op))
-		return FAIL;
-
-	if (FAIL == dbsync_compare_str(dbrow[3], maintenance_tag->tag))
-		return FAIL;
-
-	if (FAIL == dbsync_compare_str(dbrow[4], maintenance_tag->value))
-		return FAIL;
-
-	return SUCCEED;
-}
-
 /******************************************************************************
  *                                                                            *
  * Function: zbx_dbsync_compare_maintenance_tags                              *
@@ -4828,6 +6277,20 @@ static int	dbsync_compare_maintenance_period(const zbx_dc_maintenance_period_t *
 	// 如果以上所有判断都相等，则返回SUCCEED，表示比较成功
 	return SUCCEED;
 }
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_dbsync_compare_maintenance_periods                           *
+ *                                                                            *
+ * Purpose: compares timeperiods table with cached configuration data         *
+ *                                                                            *
+ * Parameter: cache - [IN] the configuration cache                            *
+ *            sync  - [OUT] the changeset                                     *
+ *                                                                            *
+ * Return value: SUCCEED - the changeset was successfully calculated          *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  * *
  *整个代码块的主要目的是对比两个维护周期表（maintenances_windows和timeperiods）中的数据，并将差异应用到另一个维护周期表（dbsync_maintenance_periods）中。具体操作包括以下几个步骤：
@@ -4918,22 +6381,6 @@ int zbx_dbsync_compare_maintenance_periods(zbx_dbsync_t *sync)
 	DBfree_result(result);
 
 	// 返回SUCCEED，表示整个过程成功
-	return SUCCEED;
-}
-
-			dbsync_add_row(sync, rowid, tag, dbrow);
-	}
-
-	zbx_hashset_iter_reset(&dbsync_env.cache->maintenance_periods, &iter);
-	while (NULL != (period = (zbx_dc_maintenance_period_t *)zbx_hashset_iter_next(&iter)))
-	{
-		if (NULL == zbx_hashset_search(&ids, &period->timeperiodid))
-			dbsync_add_row(sync, period->timeperiodid, ZBX_DBSYNC_ROW_REMOVE, NULL);
-	}
-
-	zbx_hashset_destroy(&ids);
-	DBfree_result(result);
-
 	return SUCCEED;
 }
 
@@ -4999,6 +6446,7 @@ int	zbx_dbsync_compare_maintenance_groups(zbx_dbsync_t *sync)
 	zbx_hashset_create(&mgroups, 100, ZBX_DEFAULT_UINT64_PAIR_HASH_FUNC, ZBX_DEFAULT_UINT64_PAIR_COMPARE_FUNC);
 
 	/* 遍历维护对象，构建分组索引 */
+	/* index all maintenance->group links */
 	zbx_hashset_iter_reset(&dbsync_env.cache->maintenances, &iter);
 	while (NULL != (maintenance = (zbx_dc_maintenance_t *)zbx_hashset_iter_next(&iter)))
 	{
@@ -5012,6 +6460,7 @@ int	zbx_dbsync_compare_maintenance_groups(zbx_dbsync_t *sync)
 	}
 
 	/* 处理新增和删除操作 */
+	/* add new rows, remove existing rows from index */
 	while (NULL != (dbrow = DBfetch(result)))
 	{
 		ZBX_STR2UINT64(mg_local.first, dbrow[0]);
@@ -5027,6 +6476,7 @@ int	zbx_dbsync_compare_maintenance_groups(zbx_dbsync_t *sync)
 	}
 
 	/* 处理删除操作 */
+	/* add removed rows */
 	zbx_hashset_iter_reset(&mgroups, &iter);
 	while (NULL != (mg = (zbx_uint64_pair_t *)zbx_hashset_iter_next(&iter)))
 	{
@@ -5061,7 +6511,7 @@ int	zbx_dbsync_compare_maintenance_groups(zbx_dbsync_t *sync)
  * *
  *这块代码的主要目的是比较zbx_dbsync_compare_maintenance_hosts函数中的维护关系数据和数据库中的维护关系数据，并在必要时更新数据库。代码首先查询数据库中的维护关系表，然后遍历维护关系，将数据库中的维护关系与哈希集中的维护关系进行比较。对于数据库中新增的维护关系，将其添加到哈希集中；对于已删除的维护关系，将其从哈希集中删除并添加到数据库中的删除行。最后，释放数据库结果集和销毁哈希集，返回成功。
  ******************************************************************************/
-int zbx_dbsync_compare_maintenance_hosts(zbx_dbsync_t *sync)
+int	zbx_dbsync_compare_maintenance_hosts(zbx_dbsync_t *sync)
 {
 	// 定义变量
 	DB_ROW			dbrow;
@@ -5092,6 +6542,7 @@ int zbx_dbsync_compare_maintenance_hosts(zbx_dbsync_t *sync)
 	zbx_hashset_create(&mhosts, 100, ZBX_DEFAULT_UINT64_PAIR_HASH_FUNC, ZBX_DEFAULT_UINT64_PAIR_COMPARE_FUNC);
 
 	// 遍历所有维护关系
+	/* index all maintenance->host links */
 	zbx_hashset_iter_reset(&dbsync_env.cache->maintenances, &iter);
 	while (NULL != (maintenance = (zbx_dc_maintenance_t *)zbx_hashset_iter_next(&iter)))
 	{
@@ -5107,6 +6558,7 @@ int zbx_dbsync_compare_maintenance_hosts(zbx_dbsync_t *sync)
 	}
 
 	// 遍历数据库中的维护关系，添加新的行，删除哈希集中的现有行
+	/* add new rows, remove existing rows from index */
 	while (NULL != (dbrow = DBfetch(result)))
 	{
 		ZBX_STR2UINT64(mh_local.first, dbrow[0]);
@@ -5121,6 +6573,7 @@ int zbx_dbsync_compare_maintenance_hosts(zbx_dbsync_t *sync)
 	}
 
 	// 添加已删除的行
+	/* add removed rows */
 	zbx_hashset_iter_reset(&mhosts, &iter);
 	while (NULL != (mh = (zbx_uint64_pair_t *)zbx_hashset_iter_next(&iter)))
 	{
@@ -5135,6 +6588,23 @@ int zbx_dbsync_compare_maintenance_hosts(zbx_dbsync_t *sync)
 	DBfree_result(result);
 	// 销毁哈希集
 	zbx_hashset_destroy(&mhosts);
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_dbsync_compare_host_group_hosts                              *
+ *                                                                            *
+ * Purpose: compares hosts_groups table with cached configuration data        *
+ *                                                                            *
+ * Parameter: cache - [IN] the configuration cache                            *
+ *            sync  - [OUT] the changeset                                     *
+ *                                                                            *
+ * Return value: SUCCEED - the changeset was successfully calculated          *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  * *
  *这块代码的主要目的是比较数据库中存储的主机组和主机信息，根据需要添加或删除主机组和主机的关联关系。具体来说，代码完成了以下任务：
@@ -5189,6 +6659,7 @@ int zbx_dbsync_compare_host_group_hosts(zbx_dbsync_t *sync)
 	zbx_hashset_create(&groups, 100, ZBX_DEFAULT_UINT64_PAIR_HASH_FUNC, ZBX_DEFAULT_UINT64_PAIR_COMPARE_FUNC);
 
 	// 遍历所有主机组及其关联的主机
+	/* index all group->host links */
 	zbx_hashset_iter_reset(&dbsync_env.cache->hostgroups, &iter);
 	while (NULL != (group = (zbx_dc_hostgroup_t *)zbx_hashset_iter_next(&iter)))
 	{
@@ -5203,6 +6674,7 @@ int zbx_dbsync_compare_host_group_hosts(zbx_dbsync_t *sync)
 	}
 
 	// 处理新的行，删除索引中的现有行
+	/* add new rows, remove existing rows from index */
 	while (NULL != (dbrow = DBfetch(result)))
 	{
 		ZBX_STR2UINT64(gh_local.first, dbrow[0]);
@@ -5217,26 +6689,6 @@ int zbx_dbsync_compare_host_group_hosts(zbx_dbsync_t *sync)
 	}
 
 	// 添加已删除的行
-	zbx_hashset_iter_reset(&groups, &iter);
-	while (NULL != (gh = (zbx_uint64_pair_t *)zbx_hashset_iter_next(&iter)))
-	{
-		zbx_snprintf(groupid_s, sizeof(groupid_s), ZBX_FS_UI64, gh->first);
-		zbx_snprintf(hostid_s, sizeof(hostid_s), ZBX_FS_UI64, gh->second);
-		dbsync_add_row(sync, 0, ZBX_DBSYNC_ROW_REMOVE, del_row);
-	}
-
-	// 释放资源
-	DBfree_result(result);
-	zbx_hashset_destroy(&groups);
-
-	return SUCCEED;
-}
-
-			dbsync_add_row(sync, 0, ZBX_DBSYNC_ROW_ADD, dbrow);
-		else
-			zbx_hashset_remove_direct(&groups, gh);
-	}
-
 	/* add removed rows */
 	zbx_hashset_iter_reset(&groups, &iter);
 	while (NULL != (gh = (zbx_uint64_pair_t *)zbx_hashset_iter_next(&iter)))
@@ -5246,6 +6698,7 @@ int zbx_dbsync_compare_host_group_hosts(zbx_dbsync_t *sync)
 		dbsync_add_row(sync, 0, ZBX_DBSYNC_ROW_REMOVE, del_row);
 	}
 
+	// 释放资源
 	DBfree_result(result);
 	zbx_hashset_destroy(&groups);
 
@@ -39,6 +39,15 @@
 #define ZBX_DBSYNC_UPDATE_HOST_GROUPS		__UINT64_C(0x0020)
 #define ZBX_DBSYNC_UPDATE_MAINTENANCE_GROUPS	__UINT64_C(0x0040)
 
+/* changelog table object types */
+#define ZBX_DBSYNC_OBJ_HOST	1
+#define ZBX_DBSYNC_OBJ_ITEM	2
+#define ZBX_DBSYNC_OBJ_TRIGGER	3
+/* the configuration snapshot revision, see zbx_dbsync_env_flush_changelog() */
+#define ZBX_DBSYNC_OBJ_SNAPSHOT	4
+/* used only in configuration snapshot */
+#define ZBX_DBSYNC_OBJ_FUNCTION	5
+
 
 #if defined(HAVE_POLARSSL) || defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
 #	define ZBX_HOST_TLS_OFFSET	4
@@ -102,6 +111,19 @@ struct zbx_dbsync
 	/* the preprocessed columns  */
 	zbx_vector_ptr_t		columns;
 
+	/* the object type of rows stored in configuration snapshot (see ZBX_DBSYNC_OBJ_* defines) */
+	unsigned char			snapshot_object;
+
+	/* the position of the next row when reading configuration snapshot */
+	size_t				snapshot_offset;
+	zbx_hashset_iter_t		snapshot_iter;
+
+	/* the runtime column values read from database */
+	zbx_hashset_t			*snapshot_runtime;
+
+	/* the row read from configuration snapshot */
+	char				**snapshot_row;
+
 	/* statistics */
 	zbx_uint64_t	add_num;
 	zbx_uint64_t	update_num;
@@ -110,6 +132,9 @@ struct zbx_dbsync
 
 void	zbx_dbsync_init_env(ZBX_DC_CONFIG *cache);
 void	zbx_dbsync_free_env(void);
+int	zbx_dbsync_env_prepare(unsigned char mode);
+void	zbx_dbsync_env_flush_changelog(void);
+int	zbx_dbsync_env_snapshot(void);
 
 void	zbx_dbsync_init(zbx_dbsync_t *sync, unsigned char mode);
 void	zbx_dbsync_clear(zbx_dbsync_t *sync);
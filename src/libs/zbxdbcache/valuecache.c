@@ -17,6 +17,8 @@
 ** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 **/
 
+#include <sys/mman.h>
+
 #include "common.h"
 #include "log.h"
 #include "memalloc.h"
@@ -52,6 +54,11 @@
  *
  * The low memory mode can't be turned off - it will persist until server is rebooted.
  * In low memory mode a warning message is written into log every 5 minutes.
+ *
+ * Float and unsigned item chunks that are filled and no longer receive new values are
+ * packed - timestamps are stored as delta-of-delta seconds, values as xor with previous
+ * value (float) or difference from previous value (unsigned), all using variable length
+ * encoding. Packed chunks are decoded into process local buffer when accessed.
  */
 
 /* the period of low memory warning messages */
@@ -78,6 +85,7 @@ static int	vc_state = ZBX_VC_DISABLED;
 
 /* the value cache size */
 extern zbx_uint64_t	CONFIG_VALUE_CACHE_SIZE;
+extern char		*CONFIG_VALUE_CACHE_SNAPSHOT_FILE;
 /******************************************************************************
  * *
  *这段代码主要定义了以下几个结构体：
@@ -105,6 +113,12 @@ ZBX_MEM_FUNC_IMPL(__vc, vc_mem)
 
 #define ZBX_VC_ITEM_EXPIRE_PERIOD	SEC_PER_DAY
 
+/* the period of running aggregate inactivity after which it is removed */
+#define ZBX_VC_AGGR_EXPIRE_PERIOD	SEC_PER_HOUR
+
+/* the number of running aggregate updates after which it is recalculated from scratch */
+#define ZBX_VC_AGGR_RESET_UPDATES	1000000
+
 /* the data chunk used to store data fragment */
 typedef struct zbx_vc_chunk
 {
@@ -123,7 +137,10 @@ typedef struct zbx_vc_chunk
 	/* the number of item value slots in chunk */
 	int			slots_num;
 
-	/* the item value data */
+	/* the size of packed item value data or 0 if the values are stored in slots */
+	int			packed_size;
+
+	/* the item value data, packed chunks store encoded values instead of slots */
 	zbx_history_record_t	slots[1];
 }
 zbx_vc_chunk_t;
@@ -136,6 +153,80 @@ zbx_vc_chunk_t;
 #define ZBX_VC_MAX_CHUNK_RECORDS	((64 * ZBX_KIBIBYTE - sizeof(zbx_vc_chunk_t)) / \
 		sizeof(zbx_history_record_t) + 1)
 
+/* The maximum number of bytes used by one packed value - timestamp seconds and */
+/* nanoseconds (5 bytes each) and either variable length unsigned integer value */
+/* (10 bytes) or floating point value control byte with 8 value bytes.          */
+#define ZBX_VC_PACKED_VALUE_MAX		20
+
+/* zigzag encoding keeps small negative differences small after packing */
+#define ZBX_VC_ZIGZAG_ENCODE(x)		(((zbx_uint64_t)(x) << 1) ^ (zbx_uint64_t)((zbx_int64_t)(x) >> 63))
+#define ZBX_VC_ZIGZAG_DECODE(x)		((zbx_int64_t)((x) >> 1) ^ -(zbx_int64_t)((x) & 1))
+
+/* The values of the last accessed packed chunk decoded by vch_item_chunk_values(). */
+/* The decoded values are valid until the chunk is freed or the cache is unlocked.  */
+static zbx_history_record_t	vc_unpacked_slots[ZBX_VC_MAX_CHUNK_RECORDS];
+static const zbx_vc_chunk_t	*vc_unpacked_chunk = NULL;
+
+/* the running minimum/maximum candidate value */
+typedef struct
+{
+	/* the value sequence number in aggregate window */
+	int		seq;
+
+	history_value_t	value;
+}
+zbx_vc_aggr_value_t;
+
+/* The running aggregate of item values in a sliding window.                    */
+/* The window always ends with the newest cached item value and starts with the */
+/* value at the window chunk and index, so new values are added to window when  */
+/* they are added to cache and the window start is moved forward (or backward)  */
+/* to match the requested period without reading all window values.            */
+typedef struct zbx_vc_aggr
+{
+	struct zbx_vc_aggr	*next;
+
+	/* the aggregate type - ZBX_VC_AGGR_SUM (also used for average), ZBX_VC_AGGR_MIN or ZBX_VC_AGGR_MAX */
+	int			type;
+
+	/* the window size - either number of seconds or number of values */
+	int			seconds;
+	int			count;
+
+	/* the last time the aggregate was requested, unused aggregates are removed */
+	int			last_accessed;
+
+	/* the number of window changes since the aggregate was calculated from scratch */
+	int			updates;
+
+	/* the number of values in window */
+	int			num;
+
+	/* the chunk and index of the oldest value in window, chunk is NULL if window is empty */
+	zbx_vc_chunk_t		*chunk;
+	int			index;
+
+	/* the sequence number of the oldest value in window */
+	int			seq_first;
+
+	/* the sum of floating point values */
+	double			sum_dbl;
+
+	/* the sums of high and low 32 bits of unsigned values, they will not overflow */
+	/* unless window contains more than 2^32 values                                */
+	zbx_uint64_t		sum_hi;
+	zbx_uint64_t		sum_lo;
+
+	/* The minimum/maximum candidates stored in circular buffer - window values  */
+	/* less/greater than all newer values in window. The oldest candidate is the */
+	/* window minimum/maximum.                                                   */
+	zbx_vc_aggr_value_t	*queue;
+	int			queue_alloc;
+	int			queue_first;
+	int			queue_num;
+}
+zbx_vc_aggr_t;
+
 /* the item operational state flags */
 #define ZBX_ITEM_STATE_CLEAN_PENDING	1
 #define ZBX_ITEM_STATE_REMOVE_PENDING	2
@@ -198,6 +289,9 @@ typedef struct
 
 	/* the first (oldest) chunk of item history data              */
 	zbx_vc_chunk_t	*tail;
+
+	/* the running aggregates of item values                      */
+	zbx_vc_aggr_t	*aggrs;
 }
 zbx_vc_item_t;
 
@@ -255,6 +349,9 @@ static size_t	vch_item_free_cache(zbx_vc_item_t *item);
 static size_t	vch_item_free_chunk(zbx_vc_item_t *item, zbx_vc_chunk_t *chunk);
 static int	vch_item_add_values_at_tail(zbx_vc_item_t *item, const zbx_history_record_t *values, int values_num);
 static void	vch_item_clean_cache(zbx_vc_item_t *item);
+static void	vch_item_reset_aggrs(zbx_vc_item_t *item, const zbx_vc_chunk_t *chunk);
+static void	vch_item_move_aggrs(zbx_vc_item_t *item, const zbx_vc_chunk_t *chunk, zbx_vc_chunk_t *target);
+static void	vch_item_evict_aggrs(zbx_vc_item_t *item, const zbx_vc_chunk_t *chunk, int index);
 
 /******************************************************************************
  *                                                                            *
@@ -267,7 +364,12 @@ static void	vch_item_clean_cache(zbx_vc_item_t *item);
 static void	vc_try_lock(void)
 {
 	if (ZBX_VC_ENABLED == vc_state && 0 == vc_locked)
+	{
 		zbx_mutex_lock(vc_lock);
+
+		/* chunks could have been freed and reused by other processes */
+		vc_unpacked_chunk = NULL;
+	}
 }
 
 
@@ -288,11 +390,9 @@ static void vc_try_unlock(void)
 {
     // 判断vc_state变量是否启用，且vc_locked变量为0，即锁未被锁定
     if (ZBX_VC_ENABLED == vc_state && 0 == vc_locked)
-    {
         // 如果满足条件，调用zbx_mutex_unlock函数解锁vc_lock互斥锁
         zbx_mutex_unlock(vc_lock);
     }
-}
 
 
 /*********************************************************************************
@@ -314,26 +414,13 @@ static int vc_db_read_values_by_time(zbx_uint64_t itemid, int value_type, zbx_ve
 {
     // 减少间隔起始点，因为历史后端不包含间隔起始点
     if (0 != range_start)
-    {
         range_start--;
-    }
 
     // 调用zbx_history_get_values函数，根据itemid、value_type、range_start、range_end获取历史数据
     // 并将结果存储在values数组中
     return zbx_history_get_values(itemid, value_type, range_start, 0, range_end, values);
 }
 
- *********************************************************************************/
-static int	vc_db_read_values_by_time(zbx_uint64_t itemid, int value_type, zbx_vector_history_record_t *values,
-		int range_start, int range_end)
-{
-	/* decrement interval start point because interval starting point is excluded by history backend */
-	if (0 != range_start)
-		range_start--;
-
-	return zbx_history_get_values(itemid, value_type, range_start, 0, range_end, values);
-}
-
 /************************************************************************************
 /******************************************************************************
  * 以下是对代码块的逐行中文注释：
@@ -342,6 +429,7 @@ static int	vc_db_read_values_by_time(zbx_uint64_t itemid, int value_type, zbx_ve
  *
  *这段代码的主要目的是根据时间戳和计数器请求从数据库中读取值。代码首先定义了一些变量，然后根据给定的范围和计数器请求历史数据。如果请求成功，代码会检查返回的值是否满足要求，并在不满足要求的情况下进行调整。最后，代码会重新读取最早的秒，以确保请求的数据满足要求。
  ******************************************************************************/
+	/* decrement interval start point because interval starting point is excluded by history backend */
 static int vc_db_read_values_by_time_and_count(zbx_uint64_t itemid, int value_type,
 		zbx_vector_history_record_t *values, int range_start, int count, int range_end,
 		const zbx_timespec_t *ts)
@@ -406,7 +494,7 @@ static int vc_db_read_values_by_time_and_count(zbx_uint64_t itemid, int value_ty
 
 		offset = values->values_num;
 
-		if (FAIL == zbx_history_get_values(itemid, value_type, first_timestamp - 1, left, first_timestamp, values))
+		if (FAIL == zbx_history_get_values(itemid, value_type, range_start, left, first_timestamp, values))
 			return FAIL;
 
 		/* 返回的值少于请求的值 - 已经读取所有值 */
@@ -438,26 +526,7 @@ static int vc_db_read_values_by_time_and_count(zbx_uint64_t itemid, int value_ty
 	return zbx_history_get_values(itemid, value_type, first_timestamp - 1, 0, first_timestamp, values);
 }
 
-	while (0 < values->values_num && values->values[values->values_num - 1].timestamp.sec == first_timestamp)
-	{
-		values->values_num--;
-		zbx_history_record_clear(&values->values[values->values_num], value_type);
-	}
-
-	/* check if there are enough values matching the request range */
-
-	for (i = values_start; i < values->values_num; i++)
-	{
-		if (0 <= zbx_timespec_compare(ts, &values->values[i].timestamp))
-			count--;
-	}
-
-	if (0 >= count)
-		return SUCCEED;
 
-	/* re-read the first (oldest) second */
-	return zbx_history_get_values(itemid, value_type, first_timestamp - 1, 0, first_timestamp, values);
-}
 /******************************************************************************
  * 以下是我为您注释好的代码块：
  *
@@ -465,6 +534,11 @@ static int vc_db_read_values_by_time_and_count(zbx_uint64_t itemid, int value_ty
  *
  *这段代码的主要目的是从数据库中读取指定ItemID、值类型、时间范围和数量的历史数据，并对数据进行处理和清洗，最后返回处理后的数据。
  ******************************************************************************/
+	/* check if there are enough values matching the request range */
+
+
+
+	/* re-read the first (oldest) second */
 static int vc_db_get_values(zbx_uint64_t itemid, int value_type, zbx_vector_history_record_t *values, int seconds,
                             int count, const zbx_timespec_t *ts)
 {
@@ -544,61 +618,8 @@ static int vc_db_get_values(zbx_uint64_t itemid, int value_type, zbx_vector_hist
 	// 函数执行成功，返回0
 	return SUCCEED;
 }
-
-	if (0 != count)
-	{
-		while (count < values->values_num)
-			zbx_history_record_clear(&values->values[--values->values_num], value_type);
-	}
-
 	/* for time based requests remove values with timestamp outside requested range */
-	if (0 != seconds)
-	{
-		zbx_timespec_t	start = {ts->sec - seconds, ts->ns};
-
-		while (0 < values->values_num &&
-				0 >= zbx_timespec_compare(&values->values[values->values_num - 1].timestamp, &start))
-		{
-			zbx_history_record_clear(&values->values[--values->values_num], value_type);
-		}
-	}
-
-	return SUCCEED;
-}
-
-/******************************************************************************************************************
- *                                                                                                                *
- * Common API                                                                                                     *
- *                                                                                                                *
-/******************************************************************************
- * c
- */**
- * * @file
- * * @brief   定义一个用于计算字符串哈希值的函数
- * */
- *
- *#include <stdio.h>
- *#include <stdlib.h>
- *
- *// 定义一个名为 vc_strpool_hash_func 的静态函数，参数为 void *data
- *static zbx_hash_t\tvc_strpool_hash_func(const void *data)
- *{
- *    // 返回 ZBX_DEFAULT_STRING_HASH_FUNC 函数的调用结果，传入的参数为（char *）data + REFCOUNT_FIELD_SIZE
- *    return ZBX_DEFAULT_STRING_HASH_FUNC((char *)data + REFCOUNT_FIELD_SIZE);
- *}
- *
- *int main()
- *{
- *    // 测试vc_strpool_hash_func函数
- *    char test_str[] = \"Hello, World!\";
- *    zbx_hash_t hash_value = vc_strpool_hash_func((void *)test_str);
- *    printf(\"测试字符串：%s，哈希值：%u\
- *\", test_str, hash_value);
- *
- *    return 0;
- *}
- *```
- ******************************************************************************/
+#define REFCOUNT_FIELD_SIZE	sizeof(zbx_uint32_t)
 // 定义一个名为 vc_strpool_hash_func 的静态函数，参数为 void *data
 static zbx_hash_t	vc_strpool_hash_func(const void *data)
 {
@@ -606,22 +627,6 @@ static zbx_hash_t	vc_strpool_hash_func(const void *data)
     return ZBX_DEFAULT_STRING_HASH_FUNC((char *)data + REFCOUNT_FIELD_SIZE);
 }
 
-代码块主要目的是：定义一个名为 vc_strpool_hash_func 的静态函数，用于计算字符串的哈希值。传入的参数为一个 void * 类型的指针，该指针指向的字符串经过处理后，计算其哈希值并返回。
-
-整个注释好的代码块如下：
-
-
- * String pool definitions & functions                                        *
- *                                                                            *
- ******************************************************************************/
-
-#define REFCOUNT_FIELD_SIZE	sizeof(zbx_uint32_t)
-
-static zbx_hash_t	vc_strpool_hash_func(const void *data)
-{
-	return ZBX_DEFAULT_STRING_HASH_FUNC((char *)data + REFCOUNT_FIELD_SIZE);
-}
-
 /******************************************************************************
  * *
  *这块代码的主要目的是定义一个静态函数 `vc_strpool_compare_func`，用于比较两个字符串。通过转换传入的 void 指针为字符指针，并减去 `REFCOUNT_FIELD_SIZE`，以便于访问字符串的头两个字符。然后使用 `strcmp` 函数比较两个字符串的头两个字符，返回差值，若相等则返回 0，否则返回正负差值。
@@ -630,11 +635,8 @@ static zbx_hash_t	vc_strpool_hash_func(const void *data)
 static int vc_strpool_compare_func(const void *d1, const void *d2)
 {
     // 将传入的 void 指针转换为字符指针，并分别减去 REFCOUNT_FIELD_SIZE，以便于访问字符串的头两个字符
-    char *str1 = (char *)d1 + REFCOUNT_FIELD_SIZE;
-    char *str2 = (char *)d2 + REFCOUNT_FIELD_SIZE;
-
     // 使用 strcmp 函数比较两个字符串的头两个字符，返回差值，若相等则返回 0，否则返回正负差值
-    return strcmp(str1, str2);
+    return strcmp((char *)d1 + REFCOUNT_FIELD_SIZE, (char *)d2 + REFCOUNT_FIELD_SIZE);
 }
 
 /******************************************************************************
@@ -651,18 +653,6 @@ static int vc_item_weight_compare_func(const zbx_vc_item_weight_t *d1, const zbx
     return 0;
 }
 
- *                                                                            *
- * Parameters: d1   - [IN] the first item weight data structure               *
- *             d2   - [IN] the second item weight data structure              *
- *                                                                            *
- ******************************************************************************/
-static int	vc_item_weight_compare_func(const zbx_vc_item_weight_t *d1, const zbx_vc_item_weight_t *d2)
-{
-	ZBX_RETURN_IF_NOT_EQUAL(d1->weight, d2->weight);
-
-	return 0;
-}
-
 /******************************************************************************
  *                                                                            *
  * Function: vc_history_logfree                                               *
@@ -724,14 +714,7 @@ static zbx_log_value_t *vc_history_logdup(const zbx_log_value_t *log)
 }
 
 
-	plog->timestamp = log->timestamp;
-	plog->logeventid = log->logeventid;
-	plog->severity = log->severity;
-	plog->source = (NULL == log->source ? NULL : zbx_strdup(NULL, log->source));
-	plog->value = zbx_strdup(NULL, log->value);
 
-	return plog;
-}
 
 /******************************************************************************
 /******************************************************************************
@@ -763,14 +746,7 @@ static void vc_history_record_vector_clean(zbx_vector_history_record_t *vector,
 }
 
 
-			break;
-		case ITEM_VALUE_TYPE_LOG:
-			for (i = 0; i < vector->values_num; i++)
-				vc_history_logfree(vector->values[i].value.log);
-	}
 
-	zbx_vector_history_record_clear(vector);
-}
 
 /******************************************************************************
  *                                                                            *
@@ -812,6 +788,14 @@ static void vc_update_statistics(zbx_vc_item_t *item, int hits, int misses)
         vc_cache->misses += misses;
     }
 }
+static int	vc_compare_items_by_total_values(const void *d1, const void *d2)
+{
+	zbx_vc_item_t	*c1 = *(zbx_vc_item_t **)d1;
+	zbx_vc_item_t	*c2 = *(zbx_vc_item_t **)d2;
+	ZBX_RETURN_IF_NOT_EQUAL(c2->values_total, c1->values_total);
+
+	return 0;
+}
 
 
 /******************************************************************************
@@ -880,27 +864,11 @@ static void vc_dump_items_statistics(void)
 }
 
 
-	while (NULL != (item = (zbx_vc_item_t *)zbx_hashset_iter_next(&iter)))
-	{
-		zbx_vector_ptr_append(&items, item);
-		total += item->values_total;
-	}
 
-	zbx_vector_ptr_sort(&items, vc_compare_items_by_total_values);
 
-	for (i = 0, limit = MIN(items.values_num, ZBX_VC_LOW_MEMORY_ITEM_PRINT_LIMIT); i < limit; i++)
-	{
-		item = (zbx_vc_item_t *)items.values[i];
 
-		zabbix_log(LOG_LEVEL_WARNING, "itemid:" ZBX_FS_UI64 " active range:%d hits:" ZBX_FS_UI64 " count:%d"
-				" perc:" ZBX_FS_DBL "%%", item->itemid, item->active_range, item->hits,
-				item->values_total, 100 * (double)item->values_total / total);
-	}
 
-	zbx_vector_ptr_destroy(&items);
 
-	zabbix_log(LOG_LEVEL_WARNING, "==================================================");
-}
 
 /******************************************************************************
  *                                                                            *
@@ -970,16 +938,16 @@ static void vc_warn_low_memory(void)
  * *
  *整个代码块的主要目的是：释放不再使用的zbx_vc_item_t类型的变量，这些变量满足以下条件：1）最后一次访问时间早于当前时间与过期时间的时间戳差；2）引用计数为0；3）不是source_item指针指向的变量。在遍历hashset的过程中，满足条件的变量会被释放，并累计释放的空间大小。最后返回释放的总空间大小。
  ******************************************************************************/
-static size_t		// 定义一个静态函数，用于释放不再使用的变量
-vc_release_unused_items(const zbx_vc_item_t *source_item)	// 接收一个zbx_vc_item_t类型的指针作为参数
+// 定义一个静态函数，用于释放不再使用的变量
+static size_t	vc_release_unused_items(const zbx_vc_item_t *source_item)
 {
-	int			// 定义一个整型变量timestamp
-		timestamp;
-	zbx_hashset_iter_t	// 定义一个zbx_hashset_iter_t类型的变量iter
-		iter;
+	// 定义一个整型变量timestamp
+	int			timestamp;
+	// 定义一个zbx_hashset_iter_t类型的变量iter
+	zbx_hashset_iter_t	iter;
 	zbx_vc_item_t		*item;
-	size_t			// 定义一个大小为size_t类型的变量freed，用于记录释放的空间大小
-		freed = 0;
+	// 定义一个大小为size_t类型的变量freed，用于记录释放的空间大小
+	size_t			freed = 0;
 
 	timestamp = time(NULL) - ZBX_VC_ITEM_EXPIRE_PERIOD; // 计算当前时间与过期时间的时间戳差
 
@@ -996,6 +964,12 @@ vc_release_unused_items(const zbx_vc_item_t *source_item)	// 接收一个zbx_vc_
 
 	return freed; // 返回释放的总空间大小
 }
+void	zbx_vc_housekeeping_value_cache(void)
+{
+	vc_try_lock();
+	vc_release_unused_items(NULL);
+	vc_try_unlock();
+}
 
 
 /******************************************************************************
@@ -1065,43 +1039,24 @@ static void vc_release_space(zbx_vc_item_t *source_item, size_t space)
     zbx_vector_vc_itemweight_destroy(&items);
 }
 
-	if ((freed = vc_release_unused_items(source_item)) >= space)
-		return;
 
+/******************************************************************************
+ * *
+ *这块代码的主要目的是实现一个函数`vc_history_record_copy`，该函数接收三个参数：一个指向目标zbx_history_record结构体的指针`dst`，一个指向源zbx_history_record结构体的指针`src`，以及一个表示value类型的整数`value_type`。函数的主要作用是根据value_type的不同，将源结构体中的数据复制到目标结构体中。具体来说，如果是字符串或文本类型，使用zbx_strdup函数进行复制；如果是日志类型，使用vc_history_logdup函数进行复制；如果是其他类型，直接进行复制。在整个过程中，需要注意释放内存以避免内存泄漏。
+ ******************************************************************************/
+// 定义一个函数，用于复制zbx_history_record结构体中的数据到另一个zbx_history_record结构体中
 	/* failed to free enough space by removing old items, entering low memory mode */
-	vc_cache->mode = ZBX_VC_MODE_LOWMEM;
-	vc_cache->mode_time = time(NULL);
 
-	vc_warn_low_memory();
 
 	/* remove items with least hits/size ratio */
-	zbx_vector_vc_itemweight_create(&items);
 
-	zbx_hashset_iter_reset(&vc_cache->items, &iter);
 
-	while (NULL != (item = (zbx_vc_item_t *)zbx_hashset_iter_next(&iter)))
-	{
 		/* don't remove the item that requested the space and also keep */
 		/* items currently being accessed                               */
-		if (0 == item->refcount)
-		{
-			zbx_vc_item_weight_t	weight = {.item = item};
 
-			if (0 < item->values_total)
-				weight.weight = (double)item->hits / item->values_total;
 
-			zbx_vector_vc_itemweight_append_ptr(&items, &weight);
-		}
-	}
 
-	zbx_vector_vc_itemweight_sort(&items, (zbx_compare_func_t)vc_item_weight_compare_func);
 
-	for (i = 0; i < items.values_num && freed < space; i++)
-/******************************************************************************
- * *
- *这块代码的主要目的是实现一个函数`vc_history_record_copy`，该函数接收三个参数：一个指向目标zbx_history_record结构体的指针`dst`，一个指向源zbx_history_record结构体的指针`src`，以及一个表示value类型的整数`value_type`。函数的主要作用是根据value_type的不同，将源结构体中的数据复制到目标结构体中。具体来说，如果是字符串或文本类型，使用zbx_strdup函数进行复制；如果是日志类型，使用vc_history_logdup函数进行复制；如果是其他类型，直接进行复制。在整个过程中，需要注意释放内存以避免内存泄漏。
- ******************************************************************************/
-// 定义一个函数，用于复制zbx_history_record结构体中的数据到另一个zbx_history_record结构体中
 static void vc_history_record_copy(zbx_history_record_t *dst, const zbx_history_record_t *src, int value_type)
 {
 	// 将源结构体中的timestamp复制到目标结构体中
@@ -1125,30 +1080,6 @@ static void vc_history_record_copy(zbx_history_record_t *dst, const zbx_history_
 	}
 }
 
- *             value_type - [IN] the value type (see ITEM_VALUE_TYPE_* defs)  *
- *                                                                            *
- * Comments: Additional memory is allocated to store string, text and log     *
- *           value contents. This memory must be freed by the caller.         *
- *                                                                            *
- ******************************************************************************/
-static void	vc_history_record_copy(zbx_history_record_t *dst, const zbx_history_record_t *src, int value_type)
-{
-	dst->timestamp = src->timestamp;
-
-	switch (value_type)
-	{
-		case ITEM_VALUE_TYPE_STR:
-		case ITEM_VALUE_TYPE_TEXT:
-			dst->value.str = zbx_strdup(NULL, src->value.str);
-			break;
-		case ITEM_VALUE_TYPE_LOG:
-			dst->value.log = vc_history_logdup(src->value.log);
-			break;
-		default:
-			dst->value = src->value;
-	}
-}
-
 /******************************************************************************
  *                                                                            *
  * Function: vc_history_record_vector_append                                  *
@@ -1175,7 +1106,7 @@ static void	vc_history_record_copy(zbx_history_record_t *dst, const zbx_history_
  ******************************************************************************/
 // 定义一个静态函数，用于向历史记录向量中添加一条记录
 static void vc_history_record_vector_append(zbx_vector_history_record_t *vector, int value_type,
-                                           zbx_history_record_t *value)
+                                           const zbx_history_record_t *value)
 {
     // 定义一个历史记录结构体变量record，用于存放复制后的记录信息
     zbx_history_record_t record;
@@ -1226,78 +1157,61 @@ static void *vc_item_malloc(zbx_vc_item_t *item, size_t size)
 	{
 		/* 如果内存分配失败，尝试释放缓存中的空间，然后再次分配内存。 */
 		/* 如果仍然空间不足，返回NULL表示分配失败。 */
-/******************************************************************************
- * *
- *整个代码块的主要目的是实现一个字符串复制功能，将传入的const char *str字符串复制到vc_cache的strpool中，并返回一个新的char *类型的指针，该指针指向复制的字符串。在复制过程中，如果字符串已经在strpool中，则直接返回该字符串的指针；否则，根据字符串长度和引用计数需求，分配足够的空间，并插入到strpool中。最后，增加字符串的引用计数，并返回字符串指针。
- ******************************************************************************/
-static char *vc_item_strdup(zbx_vc_item_t *item, const char *str)
-{
-    // 定义一个指针ptr，用于在字符串缓存池中查找或插入字符串
+        vc_release_space(item, size);
+        ptr = (char *)__vc_mem_malloc_func(NULL, size);
+        }
+    return ptr;
+    }
 
-    // 在vc_cache的strpool中查找字符串str，减去REFCOUNT_FIELD_SIZE后的地址
-    ptr = zbx_hashset_search(&vc_cache->strpool, str - REFCOUNT_FIELD_SIZE);
 
-    // 如果找不到该字符串，则进行插入操作
-    if (NULL == ptr)
-    {
-        int tries = 0; // 定义一个尝试次数变量
-        size_t len; // 定义一个字符串长度变量
 
-        // 计算字符串长度，并加1，用于获取字符串内存空间大小
-        len = strlen(str) + 1;
 
-        // 在while循环中，不断尝试插入字符串
-        while (NULL == (ptr = zbx_hashset_insert_ext(&vc_cache->strpool, str - REFCOUNT_FIELD_SIZE,
-                    REFCOUNT_FIELD_SIZE + len, REFCOUNT_FIELD_SIZE)))
-        {
-            // 如果空间不足，释放足够的空间，并尝试再次插入
-            if (0 == tries++)
-                vc_release_space(item, len + REFCOUNT_FIELD_SIZE + sizeof(ZBX_HASHSET_ENTRY_T));
-            else
-                return NULL; // 如果插入失败，返回NULL
-        }
 
-        // 初始化字符串的引用计数为0
-        *(zbx_uint32_t *)ptr = 0;
-    }
 
-    // 增加字符串的引用计数
-    (*(zbx_uint32_t *)ptr)++;
 
-    // 返回字符串指针，加上REFCOUNT_FIELD_SIZE，即字符串的实际起始地址
-    return (char *)ptr + REFCOUNT_FIELD_SIZE;
-}
 
+/******************************************************************************
+ * *
+ *整个代码块的主要目的是实现一个字符串复制功能，将传入的const char *str字符串复制到vc_cache的strpool中，并返回一个新的char *类型的指针，该指针指向复制的字符串。在复制过程中，如果字符串已经在strpool中，则直接返回该字符串的指针；否则，根据字符串长度和引用计数需求，分配足够的空间，并插入到strpool中。最后，增加字符串的引用计数，并返回字符串指针。
  ******************************************************************************/
 static char	*vc_item_strdup(zbx_vc_item_t *item, const char *str)
 {
+	// 定义一个指针ptr，用于在字符串缓存池中查找或插入字符串
+	// 在vc_cache的strpool中查找字符串str，减去REFCOUNT_FIELD_SIZE后的地址
 	void	*ptr;
 
 	ptr = zbx_hashset_search(&vc_cache->strpool, str - REFCOUNT_FIELD_SIZE);
 
+	// 如果找不到该字符串，则进行插入操作
 	if (NULL == ptr)
 	{
-		int	tries = 0;
-		size_t	len;
+		int	tries = 0; // 定义一个尝试次数变量
+		size_t	len; // 定义一个字符串长度变量
 
+		// 计算字符串长度，并加1，用于获取字符串内存空间大小
 		len = strlen(str) + 1;
 
+		// 在while循环中，不断尝试插入字符串
 		while (NULL == (ptr = zbx_hashset_insert_ext(&vc_cache->strpool, str - REFCOUNT_FIELD_SIZE,
 				REFCOUNT_FIELD_SIZE + len, REFCOUNT_FIELD_SIZE)))
 		{
+			// 如果空间不足，释放足够的空间，并尝试再次插入
 			/* If there is not enough space - free enough to store string + hashset entry overhead */
 			/* and try inserting one more time. If it fails again, then fail the function.         */
 			if (0 == tries++)
 				vc_release_space(item, len + REFCOUNT_FIELD_SIZE + sizeof(ZBX_HASHSET_ENTRY_T));
 			else
-				return NULL;
+				return NULL; // 如果插入失败，返回NULL
 		}
 
+		// 初始化字符串的引用计数为0
 		*(zbx_uint32_t *)ptr = 0;
 	}
 
+	// 增加字符串的引用计数
 	(*(zbx_uint32_t *)ptr)++;
 
+	// 返回字符串指针，加上REFCOUNT_FIELD_SIZE，即字符串的实际起始地址
 	return (char *)ptr + REFCOUNT_FIELD_SIZE;
 }
 
@@ -1402,21 +1316,6 @@ fail:
 	return NULL;
 }
 
-	else
-		plog->source = NULL;
-
-	if (NULL == (plog->value = vc_item_strdup(item, log->value)))
-		goto fail;
-
-	return plog;
-fail:
-	vc_item_strfree(plog->source);
-
-	__vc_mem_free_func(plog);
-
-	return NULL;
-}
-
 /******************************************************************************
  *                                                                            *
  * Function: vc_item_logfree                                                  *
@@ -1465,11 +1364,7 @@ static size_t	vc_item_logfree(zbx_log_value_t *log)
  * *
  *整个代码块的主要目的是释放一个名为item的zbx_vc_item结构体中指定区间（first到last）的值所占用的内存。根据不同的value_type（字符串类型、文本类型或日志类型），调用相应的内存释放函数vc_item_strfree或vc_item_logfree来释放内存。同时，更新item结构体中的values_total字段，表示已释放的值总数。
  ******************************************************************************/
-static size_t	// 定义一个名为vc_item_free_values的静态函数，它接收以下四个参数：
-vc_item_t *item， // 指向zbx_vc_item结构体的指针
-zbx_history_record_t *values， // 指向zbx_history_record结构体的指针数组
-int first， // 第一个需要释放内存的值在数组中的索引
-int last） // 最后一个需要释放内存的值在数组中的索引
+static size_t	vc_item_free_values(zbx_vc_item_t *item, zbx_history_record_t *values, int first, int last)
 {
 	size_t	freed = 0; // 定义一个名为freed的变量，初始值为0，用于记录释放的内存大小
 	int 	i; // 定义一个循环变量i
@@ -1492,19 +1387,15 @@ int last） // 最后一个需要释放内存的值在数组中的索引
 	return freed; // 返回释放的内存大小
 }
 
-				freed += vc_item_strfree(values[i].value.str);
-			break;
-		case ITEM_VALUE_TYPE_LOG:
-			for (i = first; i <= last; i++)
-				freed += vc_item_logfree(values[i].value.log);
-			break;
-	}
 
-	item->values_total -= (last - first + 1);
 
-	return freed;
-}
 
+/******************************************************************************
+ *                                                                            *
+/******************************************************************************
+ * *
+ *整个代码块的主要目的是释放一个名为item的zbx_vc_item结构体中指定区间（first到last）的值所占用的内存。根据不同的value_type（字符串类型、文本类型或日志类型），调用相应的内存释放函数vc_item_strfree或vc_item_logfree来释放内存。同时，更新item结构体中的values_total字段，表示已释放的值总数。
+ ******************************************************************************/
 /******************************************************************************
  *                                                                            *
  * Function: vc_remove_item                                                   *
@@ -1585,19 +1476,8 @@ static void vc_item_release(zbx_vc_item_t *item)
     }
 }
 
-	{
-		if (0 != (item->state & ZBX_ITEM_STATE_REMOVE_PENDING))
-		{
-			vc_remove_item(item);
-			return;
-		}
 
-		if (0 != (item->state & ZBX_ITEM_STATE_CLEAN_PENDING))
-			vch_item_clean_cache(item);
 
-		item->state = 0;
-	}
-}
 
 /******************************************************************************
  *                                                                            *
@@ -1619,11 +1499,9 @@ static void vc_item_update_db_cached_from(zbx_vc_item_t *item, int timestamp)
 {
     // 判断item->db_cached_from是否为0或者timestamp是否小于item->db_cached_from
     if (0 == item->db_cached_from || timestamp < item->db_cached_from)
-    {
         // 如果满足条件，将timestamp赋值给item->db_cached_from
         item->db_cached_from = timestamp;
     }
-}
 
 
 /******************************************************************************************************************
@@ -1668,20 +1546,6 @@ static void vch_item_update_range(zbx_vc_item_t *item, int range, int now)
         item->range_sync_hour = hour;
     }
 }
-
- *     '----------------'  |  | next           |---->| zbx_vc_chunk_t |<--'
- *                         '--| prev           |  |  |----------------|
- *                            '----------------'  |  | next           |
- *                                                '--| prev           |
- *                                                   '----------------'
- *
- * The history values are stored in a double linked list of data chunks, holding
- * variable number of records (depending on largest request size).
- *
- * After adding a new chunk, the older chunks (outside the largest request
- * range) are automatically removed from cache.
- */
-
 /******************************************************************************
  *                                                                            *
  * Function: vch_item_update_range                                            *
@@ -1693,32 +1557,21 @@ static void vch_item_update_range(zbx_vc_item_t *item, int range, int now)
  *             now    - [IN] the current timestamp                            *
  *                                                                            *
  ******************************************************************************/
-static void	vch_item_update_range(zbx_vc_item_t *item, int range, int now)
-{
-	int	hour, diff;
-
-	if (VC_MIN_RANGE > range)
-		range = VC_MIN_RANGE;
-
-	if (item->daily_range < range)
-		item->daily_range = range;
-
-	hour = (now / SEC_PER_HOUR) & 0xff;
-
-	if (0 > (diff = hour - item->range_sync_hour))
-		diff += 0xff;
-
-	if (item->active_range < item->daily_range || ZBX_VC_RANGE_SYNC_PERIOD < diff)
-	{
-		item->active_range = item->daily_range;
-		item->daily_range = range;
-		item->range_sync_hour = hour;
-	}
-}
 
 /******************************************************************************
  *                                                                            *
- * Function: vch_item_chunk_slot_count                                        *
+ * Function: vch_item_update_range                                            *
+ *                                                                            *
+ * Purpose: updates item range with current request range                     *
+ *                                                                            *
+ * Parameters: item   - [IN] the item                                         *
+ *             range  - [IN] the request range                                *
+ *             now    - [IN] the current timestamp                            *
+ *                                                                            *
+ ******************************************************************************/
+/******************************************************************************
+ *                                                                            *
+ * Function: vch_item_chunk_slot_count                                        *
  *                                                                            *
  * Purpose: calculates optimal number of slots for an item data chunk         *
  *                                                                            *
@@ -1757,15 +1610,363 @@ static int	vch_item_chunk_slot_count(zbx_vc_item_t *item, int values_new)
 	return nslots;
 }
 
-	if ((values + nslots - 1) / nslots + 1 > 32)
-		nslots = values / 32;
 
-	if (nslots > (int)ZBX_VC_MAX_CHUNK_RECORDS)
-		nslots = ZBX_VC_MAX_CHUNK_RECORDS;
-	if (nslots < (int)ZBX_VC_MIN_CHUNK_RECORDS)
-		nslots = ZBX_VC_MIN_CHUNK_RECORDS;
 
-	return nslots;
+
+/******************************************************************************
+ *                                                                            *
+ * Function: vch_chunk_size                                                   *
+ *                                                                            *
+ * Purpose: returns the memory size allocated for chunk                       *
+ *                                                                            *
+ ******************************************************************************/
+static size_t	vch_chunk_size(const zbx_vc_chunk_t *chunk)
+{
+	if (0 != chunk->packed_size)
+		return offsetof(zbx_vc_chunk_t, slots) + chunk->packed_size;
+
+	return sizeof(zbx_vc_chunk_t) + (chunk->slots_num - 1) * sizeof(zbx_history_record_t);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: vc_pack_uint                                                     *
+ *                                                                            *
+ * Purpose: writes unsigned integer in variable length encoding (7 bits per   *
+ *          byte, the highest bit set if more bytes follow)                   *
+ *                                                                            *
+ * Parameters: ptr   - [OUT] the output buffer                                *
+ *             value - [IN] the value to write                                *
+ *                                                                            *
+ * Return value: the position after the written value                         *
+ *                                                                            *
+ ******************************************************************************/
+static unsigned char	*vc_pack_uint(unsigned char *ptr, zbx_uint64_t value)
+{
+	while (0x7f < value)
+	{
+		*ptr++ = (unsigned char)(value | 0x80);
+		value >>= 7;
+	}
+
+	*ptr++ = (unsigned char)value;
+
+	return ptr;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: vc_unpack_uint                                                   *
+ *                                                                            *
+ * Purpose: reads unsigned integer written by vc_pack_uint()                  *
+ *                                                                            *
+ * Parameters: ptr   - [IN] the input buffer                                  *
+ *             value - [OUT] the value                                        *
+ *                                                                            *
+ * Return value: the position after the read value                            *
+ *                                                                            *
+ ******************************************************************************/
+static const unsigned char	*vc_unpack_uint(const unsigned char *ptr, zbx_uint64_t *value)
+{
+	int	shift = 0;
+
+	*value = 0;
+
+	do
+	{
+		*value |= (zbx_uint64_t)(*ptr & 0x7f) << shift;
+		shift += 7;
+	}
+	while (0 != (*ptr++ & 0x80));
+
+	return ptr;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: vc_pack_xor                                                      *
+ *                                                                            *
+ * Purpose: writes xor of two consecutive floating point values               *
+ *                                                                            *
+ * Parameters: ptr - [OUT] the output buffer                                  *
+ *             xor - [IN] the xor of value bits with the previous value bits  *
+ *                                                                            *
+ * Return value: the position after the written value                         *
+ *                                                                            *
+ * Comments: The control byte contains the number of leading (high 4 bits)    *
+ *           and trailing (low 4 bits) zero bytes, followed by the remaining  *
+ *           meaningful bytes. Equal values are written as single byte.       *
+ *                                                                            *
+ ******************************************************************************/
+static unsigned char	*vc_pack_xor(unsigned char *ptr, zbx_uint64_t xor)
+{
+	int	lead = 0, trail = 0, i;
+
+	if (0 == xor)
+	{
+		*ptr++ = 8 << 4;
+		return ptr;
+	}
+
+	while (0 == ((xor >> (56 - lead * 8)) & 0xff))
+		lead++;
+
+	while (0 == ((xor >> (trail * 8)) & 0xff))
+		trail++;
+
+	*ptr++ = (unsigned char)(lead << 4 | trail);
+
+	for (xor >>= trail * 8, i = 8 - lead - trail; 0 < i; i--, xor >>= 8)
+		*ptr++ = (unsigned char)xor;
+
+	return ptr;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: vc_unpack_xor                                                    *
+ *                                                                            *
+ * Purpose: reads xor of two consecutive values written by vc_pack_xor()      *
+ *                                                                            *
+ * Parameters: ptr - [IN] the input buffer                                    *
+ *             xor - [OUT] the xor of value bits with the previous value bits *
+ *                                                                            *
+ * Return value: the position after the read value                            *
+ *                                                                            *
+ ******************************************************************************/
+static const unsigned char	*vc_unpack_xor(const unsigned char *ptr, zbx_uint64_t *xor)
+{
+	int	trail, i, bytes;
+
+	trail = *ptr & 0x0f;
+	bytes = 8 - (*ptr++ >> 4) - trail;
+
+	for (*xor = 0, i = 0; i < bytes; i++)
+		*xor |= (zbx_uint64_t)*ptr++ << (i * 8);
+
+	*xor <<= trail * 8;
+
+	return ptr;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: vch_item_chunk_values                                            *
+ *                                                                            *
+ * Purpose: gets chunk values                                                 *
+ *                                                                            *
+ * Parameters: item  - [IN] the chunk owner item                              *
+ *             chunk - [IN] the chunk                                         *
+ *                                                                            *
+ * Return value: the chunk slots or the decoded values of packed chunk        *
+ *                                                                            *
+ * Comments: Packed chunk values are decoded into static buffer, so the       *
+ *           returned values are valid only until values of another packed    *
+ *           chunk are requested.                                             *
+ *                                                                            *
+ ******************************************************************************/
+/******************************************************************************
+ * *
+ *获取数据块中的值：普通数据块直接返回槽数组，压缩数据块解码到进程内的静态缓冲区后返回。
+ ******************************************************************************/
+static const zbx_history_record_t	*vch_item_chunk_values(const zbx_vc_item_t *item, const zbx_vc_chunk_t *chunk)
+{
+	const unsigned char	*ptr;
+	zbx_uint64_t		data, value = 0;
+	zbx_int64_t		delta = 0;
+	int			i, sec = 0;
+
+	if (0 == chunk->packed_size)
+		return chunk->slots;
+
+	if (chunk == vc_unpacked_chunk)
+		return vc_unpacked_slots;
+
+	ptr = (const unsigned char *)chunk->slots;
+
+	for (i = 0; i < chunk->slots_num; i++)
+	{
+		zbx_history_record_t	*record = &vc_unpacked_slots[i];
+
+		ptr = vc_unpack_uint(ptr, &data);
+		delta += ZBX_VC_ZIGZAG_DECODE(data);
+		sec += (int)delta;
+		record->timestamp.sec = sec;
+
+		ptr = vc_unpack_uint(ptr, &data);
+		record->timestamp.ns = (int)data;
+
+		if (ITEM_VALUE_TYPE_FLOAT == item->value_type)
+		{
+			ptr = vc_unpack_xor(ptr, &data);
+			value ^= data;
+			memcpy(&record->value.dbl, &value, sizeof(value));
+		}
+		else
+		{
+			ptr = vc_unpack_uint(ptr, &data);
+			value += (zbx_uint64_t)ZBX_VC_ZIGZAG_DECODE(data);
+			record->value.ui64 = value;
+		}
+	}
+
+	vc_unpacked_chunk = chunk;
+
+	return vc_unpacked_slots;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: vch_item_replace_chunk                                           *
+ *                                                                            *
+ * Purpose: replaces chunk in item's chunk list and frees the old chunk       *
+ *                                                                            *
+ * Parameters: item   - [IN/OUT] the chunk owner item                         *
+ *             chunk  - [IN] the chunk to replace                             *
+ *             target - [IN] the new chunk with values of the replaced chunk  *
+ *                                                                            *
+ ******************************************************************************/
+static void	vch_item_replace_chunk(zbx_vc_item_t *item, zbx_vc_chunk_t *chunk, zbx_vc_chunk_t *target)
+{
+	target->prev = chunk->prev;
+	target->next = chunk->next;
+
+	if (NULL != chunk->prev)
+		chunk->prev->next = target;
+	else
+		item->tail = target;
+
+	if (NULL != chunk->next)
+		chunk->next->prev = target;
+	else
+		item->head = target;
+
+	if (chunk == vc_unpacked_chunk)
+		vc_unpacked_chunk = NULL;
+
+	vch_item_move_aggrs(item, chunk, target);
+
+	__vc_mem_free_func(chunk);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: vch_item_pack_chunk                                              *
+ *                                                                            *
+ * Purpose: packs chunk values to reduce memory used by the chunk             *
+ *                                                                            *
+ * Parameters: item  - [IN/OUT] the chunk owner item                          *
+ *             chunk - [IN] the chunk to pack                                 *
+ *                                                                            *
+ * Comments: Only float and unsigned values are packed. The head chunk is     *
+ *           never packed as new values are added to it.                      *
+ *           The chunk is left unpacked if packing does not save memory or    *
+ *           there is no free space for the packed chunk.                     *
+ *                                                                            *
+ ******************************************************************************/
+/******************************************************************************
+ * *
+ *将已填满且不再接收新值的浮点或无符号整数数据块压缩：时间戳使用二阶差分编码，浮点值与前一个值异或，
+ *无符号整数值使用与前一个值的差，均采用变长编码。压缩后不节省内存或内存不足时保留原数据块。
+ ******************************************************************************/
+static void	vch_item_pack_chunk(zbx_vc_item_t *item, zbx_vc_chunk_t *chunk)
+{
+	unsigned char	*data, *ptr;
+	zbx_vc_chunk_t	*packed;
+	zbx_uint64_t	value, value_last = 0;
+	zbx_int64_t	delta, delta_last = 0;
+	int		i, sec_last = 0, values_num;
+	size_t		size;
+
+	if (NULL == chunk || chunk == item->head || 0 != chunk->packed_size)
+		return;
+
+	if (ITEM_VALUE_TYPE_FLOAT != item->value_type && ITEM_VALUE_TYPE_UINT64 != item->value_type)
+		return;
+
+	values_num = chunk->last_value - chunk->first_value + 1;
+	ptr = data = (unsigned char *)zbx_malloc(NULL, values_num * ZBX_VC_PACKED_VALUE_MAX);
+
+	for (i = chunk->first_value; i <= chunk->last_value; i++)
+	{
+		const zbx_history_record_t	*record = &chunk->slots[i];
+
+		delta = (zbx_int64_t)record->timestamp.sec - sec_last;
+		ptr = vc_pack_uint(ptr, ZBX_VC_ZIGZAG_ENCODE(delta - delta_last));
+		ptr = vc_pack_uint(ptr, (zbx_uint64_t)record->timestamp.ns);
+		delta_last = delta;
+		sec_last = record->timestamp.sec;
+
+		if (ITEM_VALUE_TYPE_FLOAT == item->value_type)
+		{
+			memcpy(&value, &record->value.dbl, sizeof(value));
+			ptr = vc_pack_xor(ptr, value ^ value_last);
+		}
+		else
+		{
+			value = record->value.ui64;
+			ptr = vc_pack_uint(ptr, ZBX_VC_ZIGZAG_ENCODE(value - value_last));
+		}
+
+		value_last = value;
+	}
+
+	size = offsetof(zbx_vc_chunk_t, slots) + (ptr - data);
+
+	/* packed chunk is allocated without freeing space in cache, packing is not worth dropping other items */
+	if (size < vch_chunk_size(chunk) && NULL != (packed = (zbx_vc_chunk_t *)__vc_mem_malloc_func(NULL, size)))
+	{
+		packed->first_value = 0;
+		packed->last_value = values_num - 1;
+		packed->slots_num = values_num;
+		packed->packed_size = (int)(ptr - data);
+		memcpy(packed->slots, data, ptr - data);
+
+		vch_item_replace_chunk(item, chunk, packed);
+	}
+
+	zbx_free(data);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: vch_item_unpack_chunk                                            *
+ *                                                                            *
+ * Purpose: converts packed chunk back to chunk with values stored in slots,  *
+ *          so the values can be modified                                     *
+ *                                                                            *
+ * Parameters: item  - [IN/OUT] the chunk owner item                          *
+ *             chunk - [IN] the chunk to unpack                               *
+ *                                                                            *
+ * Return value: the unpacked chunk or NULL if there was not enough memory    *
+ *                                                                            *
+ ******************************************************************************/
+/******************************************************************************
+ * *
+ *将压缩数据块还原为普通数据块，以便修改其中的值（例如插入乱序的新值时）。
+ ******************************************************************************/
+static zbx_vc_chunk_t	*vch_item_unpack_chunk(zbx_vc_item_t *item, zbx_vc_chunk_t *chunk)
+{
+	zbx_vc_chunk_t	*unpacked;
+
+	if (0 == chunk->packed_size)
+		return chunk;
+
+	if (NULL == (unpacked = (zbx_vc_chunk_t *)vc_item_malloc(item, sizeof(zbx_vc_chunk_t) +
+			(chunk->slots_num - 1) * sizeof(zbx_history_record_t))))
+	{
+		return NULL;
+	}
+
+	memcpy(unpacked->slots, vch_item_chunk_values(item, chunk), chunk->slots_num * sizeof(zbx_history_record_t));
+	unpacked->first_value = chunk->first_value;
+	unpacked->last_value = chunk->last_value;
+	unpacked->slots_num = chunk->slots_num;
+	unpacked->packed_size = 0;
+
+	vch_item_replace_chunk(item, chunk, unpacked);
+
+	return unpacked;
 }
 
 /******************************************************************************
@@ -1812,10 +2013,8 @@ static int	vch_item_add_chunk(zbx_vc_item_t *item, int nslots, zbx_vc_chunk_t *i
 		if (NULL != item->head)
 			item->head->next = chunk;
 		else
-		{
 			// 如果 vch_item 没有头节点，则 chunk 就是尾节点
 			item->tail = chunk;
-		}
 
 		// 更新 vch_item 的头节点为 chunk
 		item->head = chunk;
@@ -1831,26 +2030,16 @@ static int	vch_item_add_chunk(zbx_vc_item_t *item, int nslots, zbx_vc_chunk_t *i
 		if (item->tail == insert_before)
 			item->tail = chunk;
 		else
-		{
 			// 否则，更新 chunk 的 prev 指针指向的节点的 next 指针指向 chunk
 			chunk->prev->next = chunk;
 		}
-	}
 
 	// 函数执行成功，返回 SUCCEED
 	return SUCCEED;
 }
 
-		insert_before->prev = chunk;
 
-		if (item->tail == insert_before)
-			item->tail = chunk;
-		else
-			chunk->prev->next = chunk;
-	}
 
-	return SUCCEED;
-}
 
 /******************************************************************************
  *                                                                            *
@@ -1869,34 +2058,54 @@ static int	vch_item_add_chunk(zbx_vc_item_t *item, int nslots, zbx_vc_chunk_t *i
  * @version 1.0
  * @date 2022-01-01
  */
-
+/******************************************************************************
+ *                                                                            *
+ * Function: vch_chunk_find_last_value_before                                 *
+ *                                                                            *
+ * Purpose: find the index of the last value in chunk with timestamp less or  *
+ *          equal to the specified timestamp.                                 *
+ *                                                                            *
+ * Parameters:  chunk - [IN] the chunk                                        *
+ *              ts    - [IN] the target timestamp                             *
+ *                                                                            *
+ * Return value: The index of the last value in chunk with timestamp less or  *
+ *               equal to the specified timestamp.                            *
+ *               -1 is returned in the case of failure (meaning that all      *
+ *               values have timestamps greater than the target timestamp).   *
+ *                                                                            *
+ ******************************************************************************/
 // 定义一个静态整型函数，用于在chunk中查找指定时间戳之前的最后一个值
-static int	vch_chunk_find_last_value_before(const zbx_vc_chunk_t *chunk, const zbx_timespec_t *ts)
+static int	vch_chunk_find_last_value_before(const zbx_vc_item_t *item, const zbx_vc_chunk_t *chunk,
+		const zbx_timespec_t *ts)
 {
-	int	start = chunk->first_value, end = chunk->last_value, middle;
+	const zbx_history_record_t	*slots = vch_item_chunk_values(item, chunk);
+	int				start = chunk->first_value, end = chunk->last_value, middle;
 
+	/* check if the last value timestamp is already greater or equal to the specified timestamp */
 	/* 检查最后一个值的时间戳是否已经大于或等于指定的时间戳 */
-	if (0 >= zbx_timespec_compare(&chunk->slots[end].timestamp, ts))
+	if (0 >= zbx_timespec_compare(&slots[end].timestamp, ts))
 		return end;
 
 	/* 如果chunk中只有一个值，并且该值未通过上述检查，则返回失败 */
+	/* chunk contains only one value, which did not pass the above check, return failure */
 	if (start == end)
 		return -1;
 
 	/* 使用二分查找进行值查找 */
+	/* perform value lookup using binary search */
 	while (start != end)
 	{
 		middle = start + (end - start) / 2;
 
 		/* 如果中间值的时间戳大于指定的时间戳，则更新end */
-		if (0 < zbx_timespec_compare(&chunk->slots[middle].timestamp, ts))
+		if (0 < zbx_timespec_compare(&slots[middle].timestamp, ts))
 		{
 			end = middle;
 			continue;
 		}
 
 		/* 如果中间值+1的时间戳小于等于指定的时间戳，则更新start */
-		if (0 >= zbx_timespec_compare(&chunk->slots[middle + 1].timestamp, ts))
+		if (0 >= zbx_timespec_compare(&slots[middle + 1].timestamp, ts))
 		{
 			start = middle;
 			continue;
@@ -1910,17 +2119,6 @@ static int	vch_chunk_find_last_value_before(const zbx_vc_chunk_t *chunk, const z
 	return -1;
 }
 
-		{
-			start = middle;
-			continue;
-		}
-
-		return middle;
-	}
-
-	return -1;
-}
-
 /******************************************************************************
  *                                                                            *
  * Function: vch_item_get_last_value                                          *
@@ -1944,6 +2142,27 @@ static int	vch_chunk_find_last_value_before(const zbx_vc_chunk_t *chunk, const z
  *注释中还提到了一个名为 `vch_chunk_find_last_value_before` 的辅助函数，用于在给定时间戳的情况下查找缓存中最后一个值之前的值。然而，本代码块中并未提供该函数的实现。
  ******************************************************************************/
 /* 定义一个函数，用于获取缓存中的最后一个值 */
+/******************************************************************************
+ *                                                                            *
+ * Function: vch_item_get_last_value                                          *
+ *                                                                            *
+ * Purpose: gets the chunk and index of the last value with a timestamp less  *
+ *          or equal to the specified timestamp                               *
+ *                                                                            *
+ * Parameters:  item          - [IN] the item                                 *
+ *              ts            - [IN] the target timestamp                     *
+ *                                   (NULL - current time)                    *
+ *              pchunk        - [OUT] the chunk containing the target value   *
+ *              pindex        - [OUT] the index of the target value           *
+ *                                                                            *
+ * Return value: SUCCEED - the last value was found successfully              *
+ *               FAIL - all values in cache have timestamps greater than the  *
+ *                      target (timeshift) timestamp.                         *
+ *                                                                            *
+ * Comments: If end_timestamp value is 0, then simply the last item value in  *
+ *           cache is returned.                                               *
+ *                                                                            *
+ ******************************************************************************/
 static int	vch_item_get_last_value(const zbx_vc_item_t *item, const zbx_timespec_t *ts, zbx_vc_chunk_t **pchunk,
 		int *pindex)
 {
@@ -1961,16 +2180,17 @@ static int	vch_item_get_last_value(const zbx_vc_item_t *item, const zbx_timespec
 	/* 判断当前时间戳是否小于目标时间戳，如果是，则继续向前查找 */
 	if (0 < zbx_timespec_compare(&chunk->slots[index].timestamp, ts))
 	{
-		while (0 < zbx_timespec_compare(&chunk->slots[chunk->first_value].timestamp, ts))
+		while (0 < zbx_timespec_compare(&vch_item_chunk_values(item, chunk)[chunk->first_value].timestamp, ts))
 		{
 			/* 向前查找缓存 */
 			chunk = chunk->prev;
 			/* 如果没有找到请求范围内的值，返回失败 */
+			/* there are no values for requested range, return failure */
 			if (NULL == chunk)
 				return FAIL;
 		}
 		/* 查找缓存中在目标时间戳之前的最后一个值 */
-		index = vch_chunk_find_last_value_before(chunk, ts);
+		index = vch_chunk_find_last_value_before(item, chunk, ts);
 	}
 
 	/* 输出结果 */
@@ -2023,18 +2243,14 @@ static int	vch_item_copy_value(zbx_vc_item_t *item, zbx_vc_chunk_t *chunk, int i
         case ITEM_VALUE_TYPE_TEXT:
             // 如果源值是字符串类型，复制到新值中
             if (NULL == (value->value.str = vc_item_strdup(item, source_value->value.str)))
-            {
                 // 复制失败，跳转到 out 标签处
                 goto out;
-            }
             break;
         case ITEM_VALUE_TYPE_LOG:
             // 如果源值是日志类型，复制到新值中
             if (NULL == (value->value.log = vc_item_logdup(item, source_value->value.log)))
-            {
                 // 复制失败，跳转到 out 标签处
                 goto out;
-            }
             break;
         default:
             // 默认情况下，直接将 source_value 的 value 复制到新值中
@@ -2046,7 +2262,9 @@ static int	vch_item_copy_value(zbx_vc_item_t *item, zbx_vc_chunk_t *chunk, int i
     // 更新函数执行结果为成功
     ret = SUCCEED;
 out:
-    // 返回函数执行结果
+		// 返回函数执行结果
+		return ret;
+}
 /******************************************************************************
  * *
  *整个代码块的主要目的是实现一个函数，该函数根据传入的值数组和值类型，将值复制到指定位置的尾部槽中。具体来说：
@@ -2110,29 +2328,6 @@ out:
 	item->values_total += first_value - item->tail->first_value;
 
 	// 返回函数结果
-	return ret;
-}
-
-				zbx_history_record_t	*value = &item->tail->slots[item->tail->first_value - 1];
-
-				if (NULL == (value->value.log = vc_item_logdup(item, values[i].value.log)))
-					goto out;
-
-				value->timestamp = values[i].timestamp;
-				item->tail->first_value--;
-			}
-			ret = SUCCEED;
-
-			break;
-		default:
-			memcpy(&item->tail->slots[item->tail->first_value - values_num], values,
-					values_num * sizeof(zbx_history_record_t));
-			item->tail->first_value -= values_num;
-			ret = SUCCEED;
-	}
-out:
-	item->values_total += first_value - item->tail->first_value;
-
 	return ret;
 }
 
@@ -2152,20 +2347,21 @@ out:
  * *
  *整个代码块的主要目的是释放chunk所占用的内存空间，包括zbx_vc_chunk_t类型的大小和chunk中的值数据。首先计算需要的内存大小，然后调用vc_item_free_values函数释放值数据，最后使用__vc_mem_free_func函数释放chunk所占用的内存。
  ******************************************************************************/
-// 定义一个函数vch_item_free_chunk，接收两个参数，一个是zbx_vc_item_t类型的指针item，另一个是zbx_vc_chunk_t类型的指针chunk。
-// 该函数的主要目的是释放chunk所占用的内存空间。
-
-static size_t	// 定义一个静态类型为size_t的变量freed，用来存储释放的内存大小
-vch_item_free_chunk(zbx_vc_item_t *item, zbx_vc_chunk_t *chunk)
+static size_t	vch_item_free_chunk(zbx_vc_item_t *item, zbx_vc_chunk_t *chunk)
 {
 	size_t	freed; // 声明一个size_t类型的变量freed，用来存储释放的内存大小
 
-	// 计算需要释放的内存大小，首先计算zbx_vc_chunk_t类型的大小，然后计算chunk中的slots数（减去1）乘以zbx_history_record_t类型的大小
-	freed = sizeof(zbx_vc_chunk_t) + (chunk->slots_num - 1) * sizeof(zbx_history_record_t);
+	// 计算需要释放的内存大小，即数据块结构体及其槽位或压缩数据所占用的大小
+	freed = vch_chunk_size(chunk);
+
+	vch_item_evict_aggrs(item, chunk, chunk->last_value);
 
 	// 调用vc_item_free_values函数，根据item、chunk->slots、chunk->first_value和chunk->last_value释放chunk中的值数据
 	freed += vc_item_free_values(item, chunk->slots, chunk->first_value, chunk->last_value);
 
+	if (chunk == vc_unpacked_chunk)
+		vc_unpacked_chunk = NULL;
+
 	// 使用__vc_mem_free_func函数释放chunk所占用的内存
 	__vc_mem_free_func(chunk);
 
@@ -2189,76 +2385,68 @@ vch_item_free_chunk(zbx_vc_item_t *item, zbx_vc_chunk_t *chunk)
  *这块代码的主要目的是删除一个双向链表中的块（chunk），并释放该块的内存。在删除块的过程中，需要更新块之间的指针关系，以及头节点和尾节点的指针。最后，调用vch_item_free_chunk函数释放块的内存。
  ******************************************************************************/
 // 定义一个函数，用于从双向链表中删除一个块
-static void vch_item_remove_chunk(zbx_vc_item_t *item, zbx_vc_chunk_t *chunk)
+static void	vch_item_remove_chunk(zbx_vc_item_t *item, zbx_vc_chunk_t *chunk)
 {
-    // 判断下一个块是否有效
-    if (NULL != chunk->next)
-    {
+	// 判断下一个块是否有效
+	if (NULL != chunk->next)
         // 设置下一个块的prev指针指向当前块的prev
-        chunk->next->prev = chunk->prev;
-    }
+		chunk->next->prev = chunk->prev;
+
+	if (NULL != chunk->prev)
+		chunk->prev->next = chunk->next;
+
+	if (chunk == item->head)
+		item->head = chunk->prev;
+
+	if (chunk == item->tail)
+		item->tail = chunk->next;
+
+	vch_item_free_chunk(item, chunk);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: vch_item_clean_cache                                             *
+ *                                                                            *
+ * Purpose: removes item history data that are outside (older) the maximum    *
+ *          request range                                                     *
+ *                                                                            *
+ * Parameters:  item   - [IN] the target item                                 *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  * *
  *整个代码块的主要目的是清理vc_item的缓存。在这个函数中，首先检查item的有效范围是否为0，如果不为0，则遍历块并尝试移除超过最大请求范围的历史值。在遍历过程中，遇到具有相同时间戳的值，要么一起保留在缓存中，要么一起移除。最后，如果tail与item->tail不相等，重置状态标志。
  ******************************************************************************/
 // 定义一个静态函数，用于清理vc_item的缓存
-static void vch_item_clean_cache(zbx_vc_item_t *item)
+static void	vch_item_clean_cache(zbx_vc_item_t *item)
 {
 	// 定义一个指向下一个块的指针
-	zbx_vc_chunk_t *next;
+	zbx_vc_chunk_t	*next;
 
 	// 如果item的有效范围不为0
-	if (0 != item->active_range)
+	if (0 != item->active_range && NULL != item->head)
 	{
 		// 初始化tail和chunk指针，以及timestamp变量
-		zbx_vc_chunk_t *tail = item->tail;
-		zbx_vc_chunk_t *chunk = tail;
-		int timestamp;
+		const zbx_history_record_t	*values;
+		zbx_vc_chunk_t			*tail = item->tail;
+		zbx_vc_chunk_t			*chunk = tail;
+		int				timestamp, last_sec, head_sec;
 
 		// 计算当前时间与item->active_range的差值
 		timestamp = time(NULL) - item->active_range;
+		head_sec = item->head->slots[item->head->last_value].timestamp.sec;
 
 		// 遍历块，尝试移除超过最大请求范围的块的历史值
-		while (NULL != chunk && chunk->slots[chunk->last_value].timestamp.sec < timestamp &&
-				chunk->slots[chunk->last_value].timestamp.sec !=
-						item->head->slots[item->head->last_value].timestamp.sec)
+		/* try to remove chunks with all history values older than maximum request range */
+		while (NULL != chunk)
 		{
-			// 如果不存在下一个块，则退出循环
-			if (NULL == (next = chunk->next))
-				break;
-
-			// 处理具有相同时间戳（秒级精度）的值，要么一起保留在缓存中，要么一起移除
-			// 这里处理罕见情况，即第一个块的最后一个值与第二个块的第一个值具有相同的秒级时间戳
-			/* In this case increase the first value index of the next chunk until the first value timestamp is greater. */
-
-			if (next->slots[next->first_value].timestamp.sec != next->slots[next->last_value].timestamp.sec)
-			{
-				while (next->slots[next->first_value].timestamp.sec ==
-						chunk->slots[chunk->last_value].timestamp.sec)
-				{
-					// 释放vc_item中的值，并更新下一个值的索引
-					vc_item_free_values(item, next->slots, next->first_value, next->first_value);
-					next->first_value++;
-				}
-			}
-
-			// 设置从数据库缓存的时间戳为最后一个（最古老）移除值的timestamp + 1
-			item->db_cached_from = chunk->slots[chunk->last_value].timestamp.sec + 1;
-
-			// 从vc_item中移除该块
-			vch_item_remove_chunk(item, chunk);
-
-			chunk = next;
-		}
+			last_sec = vch_item_chunk_values(item, chunk)[chunk->last_value].timestamp.sec;
 
-		// 如果tail与item->tail不相等，重置状态标志
-		if (tail != item->tail)
-			item->status = 0;
-	}
-}
+			if (last_sec >= timestamp || last_sec == head_sec)
+				break;
 
-						item->head->slots[item->head->last_value].timestamp.sec)
-		{
+			// 如果不存在下一个块，则退出循环
 			/* don't remove the head chunk */
 			if (NULL == (next = chunk->next))
 				break;
@@ -2271,24 +2459,33 @@ static void vch_item_clean_cache(zbx_vc_item_t *item)
 			/* In this case increase the first value index of the next chunk until the first  */
 			/* value timestamp is greater.                                                    */
 
-			if (next->slots[next->first_value].timestamp.sec != next->slots[next->last_value].timestamp.sec)
+			values = vch_item_chunk_values(item, next);
+
+			// 处理具有相同时间戳（秒级精度）的值，要么一起保留在缓存中，要么一起移除
+			// 这里处理罕见情况，即第一个块的最后一个值与第二个块的第一个值具有相同的秒级时间戳
+			/* In this case increase the first value index of the next chunk until the first value timestamp is greater. */
+			if (values[next->first_value].timestamp.sec != values[next->last_value].timestamp.sec)
 			{
-				while (next->slots[next->first_value].timestamp.sec ==
-						chunk->slots[chunk->last_value].timestamp.sec)
+				while (values[next->first_value].timestamp.sec == last_sec)
 				{
+					// 释放vc_item中的值，并更新下一个值的索引
+					vch_item_evict_aggrs(item, next, next->first_value);
 					vc_item_free_values(item, next->slots, next->first_value, next->first_value);
 					next->first_value++;
 				}
 			}
 
+			// 设置从数据库缓存的时间戳为最后一个（最古老）移除值的timestamp + 1
 			/* set the database cached from timestamp to the last (oldest) removed value timestamp + 1 */
-			item->db_cached_from = chunk->slots[chunk->last_value].timestamp.sec + 1;
+			item->db_cached_from = last_sec + 1;
 
+			// 从vc_item中移除该块
 			vch_item_remove_chunk(item, chunk);
 
 			chunk = next;
 		}
 
+		// 如果tail与item->tail不相等，重置状态标志
 		/* reset the status flags if data was removed from cache */
 		if (tail != item->tail)
 			item->status = 0;
@@ -2312,79 +2509,124 @@ static void vch_item_clean_cache(zbx_vc_item_t *item)
  *整个代码块的主要目的是删除具有历史值的时间戳大于给定时间戳的块。注释详细解释了代码块中的每个步骤，从初始化指针、修改物品状态，到遍历块并删除符合条件的值，最后处理空块。
  ******************************************************************************/
 // 定义一个静态函数，用于删除具有历史值的时间戳大于给定时间戳的块
-static void vch_item_remove_values(zbx_vc_item_t *item, int timestamp)
+static void	vch_item_remove_values(zbx_vc_item_t *item, int timestamp)
 {
-    // 指向最后一个块的指针
-    zbx_vc_chunk_t *chunk = item->tail;
+	// 指向最后一个块的指针
+	const zbx_history_record_t	*values;
+	zbx_vc_chunk_t			*chunk = item->tail;
 
-    // 如果物品的状态为ZBX_ITEM_STATUS_CACHED_ALL，将其设置为0
-    if (ZBX_ITEM_STATUS_CACHED_ALL == item->status)
-        item->status = 0;
+	// 如果物品的状态为ZBX_ITEM_STATUS_CACHED_ALL，将其设置为0
+	if (ZBX_ITEM_STATUS_CACHED_ALL == item->status)
+		item->status = 0;
 
+	/* try to remove chunks with all history values older than the timestamp */
     /* 尝试删除所有历史值的时间戳大于给定时间戳的块 */
-    while (chunk->slots[chunk->first_value].timestamp.sec < timestamp)
-    {
-        zbx_vc_chunk_t *next;
+	while ((values = vch_item_chunk_values(item, chunk))[chunk->first_value].timestamp.sec < timestamp)
+	{
+		zbx_vc_chunk_t	*next;
 
+		/* If chunk contains values with timestamp greater or equal - remove */
+		/* only the values with less timestamp. Otherwise remove the while   */
+		/* chunk and check next one.                                         */
         /* 如果块中含有大于等于给定时间戳的值，则删除 */
         /* 只有小于给定时间戳的值。否则删除整个块并检查下一个块。                         */
-        if (chunk->slots[chunk->last_value].timestamp.sec >= timestamp)
-        {
-            while (chunk->slots[chunk->first_value].timestamp.sec < timestamp)
-            {
-                vc_item_free_values(item, chunk->slots, chunk->first_value, chunk->first_value);
-                chunk->first_value++;
-            }
+		if (values[chunk->last_value].timestamp.sec >= timestamp)
+		{
+			while (values[chunk->first_value].timestamp.sec < timestamp)
+			{
+				vch_item_evict_aggrs(item, chunk, chunk->first_value);
+				vc_item_free_values(item, chunk->slots, chunk->first_value, chunk->first_value);
+				chunk->first_value++;
+			}
 
-            break;
-        }
+			break;
+		}
+
+		next = chunk->next;
+		vch_item_remove_chunk(item, chunk);
 
-        next = chunk->next;
-        vch_item_remove_chunk(item, chunk);
+		/* empty items must be removed to avoid situation when a new value is added to cache */
+		/* while other values with matching timestamp seconds are not cached                 */
+		if (NULL == next)
+		{
+			item->state |= ZBX_ITEM_STATE_REMOVE_PENDING;
+			break;
+		}
 
+		chunk = next;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: vch_item_add_value_at_head                                       *
+ *                                                                            *
+ * Purpose: adds one item history value at the end of current item's history  *
+ *          data                                                              *
+ *                                                                            *
+ * Parameters:  item   - [IN] the item to add history data to                 *
+ *              value  - [IN] the item history data value                     *
+ *                                                                            *
+ * Return value: SUCCEED - the history data value was added successfully      *
+ *               FAIL - failed to add history data value (not enough memory)  *
+ *                                                                            *
+ * Comments: In the case of failure the item will be removed from cache       *
+ *           later.                                                           *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  * *
  *这块代码的主要目的是向一个已存在的缓存块（zbx_vc_item_t结构体中的head指针指向的缓存块）添加一个新值。在添加新值之前，代码会检查新值与已存在的值的时间戳关系，如果新值比已存在的值更旧，则不能添加，需要保持缓存的一致性。如果新值比已存在的值更新，则需要更新数据库缓存的时间戳。在找到合适的位置后，将新值复制到缓存中。如果添加过程中需要新建缓存块，则会先新建一个缓存块，然后将新值插入到合适的位置。在整个过程中，还会根据需要调整缓存块的指针和状态。
  ******************************************************************************/
 // 定义一个函数，用于在指定位置向缓存添加一个值
-static int vch_item_add_value_at_head(zbx_vc_item_t *item, const zbx_history_record_t *value)
+static int	vch_item_add_value_at_head(zbx_vc_item_t *item, const zbx_history_record_t *value)
 {
 	// 定义一些变量，用于索引和操作缓存块
 	int		ret = FAIL, index, sindex, nslots = 0;
 	zbx_vc_chunk_t	*head = item->head, *chunk, *schunk;
 
 	// 检查头指针是否为空，如果为空，说明需要新建一个缓存块
-	if (NULL == head)
+	if (NULL != item->head &&
+			0 < zbx_history_record_compare_asc_func(&item->head->slots[item->head->last_value], value))
 	{
-		if (FAIL == vch_item_add_chunk(item, 1, NULL))
-			goto out;
-	}
+		// 检查新值是否小于等于缓存中的第一个值
+		if (0 < zbx_history_record_compare_asc_func(
+				&vch_item_chunk_values(item, item->tail)[item->tail->first_value], value))
+		{
+			// 如果新值与缓存中的第一个值时间戳相同或更早，无法添加，需要保持缓存一致性
+			// 同时确保不存在与新值时间戳秒数匹配的缓存值
+			/* If the added value has the same or older timestamp as the first value in cache */
+			/* we can't add it to keep cache consistency. Additionally we must make sure no   */
+			/* values with matching timestamp seconds are kept in cache.                      */
+			vch_item_remove_values(item, value->timestamp.sec + 1);
+
+			// 如果新值比数据库缓存的时间戳新，需要更新数据库缓存
+			/* if the value is newer than the database cached from timestamp we must */
+			/* adjust the cached from timestamp to exclude this value                */
+			if (item->db_cached_from <= value->timestamp.sec)
+				item->db_cached_from = value->timestamp.sec + 1;
 
-	// 检查新值是否小于等于缓存中的第一个值
-	if (0 < zbx_history_record_compare_asc_func(&head->slots[head->last_value], value))
-	{
-		// 如果新值与缓存中的第一个值时间戳相同或更早，无法添加，需要保持缓存一致性
-		// 同时确保不存在与新值时间戳秒数匹配的缓存值
-		vch_item_remove_values(item, value->timestamp.sec + 1);
+			ret = SUCCEED;
+			goto out;
+		}
 
-		// 如果新值比数据库缓存的时间戳新，需要更新数据库缓存
-		if (item->db_cached_from <= value->timestamp.sec)
-			item->db_cached_from = value->timestamp.sec + 1;
+		// 查找缓存中最后一个值的时间戳小于新值时间戳的位置
+		sindex = item->head->last_value;
+		schunk = item->head;
 
-		ret = SUCCEED;
-		goto out;
-	}
+		// 如果缓存中的空位不足，新建一个缓存块
+		if (0 == item->head->slots_num - item->head->last_value - 1)
+		{
+			if (FAIL == vch_item_add_chunk(item, vch_item_chunk_slot_count(item, 1), NULL))
+				goto out;
+		}
+		else
+			item->head->last_value++;
 
-	// 查找缓存中最后一个值的时间戳小于新值时间戳的位置
-	sindex = head->last_value;
-	schunk = head;
+		item->values_total++;
 
-	// 如果缓存中的空位不足，新建一个缓存块
-	while (0 < zbx_timespec_compare(&schunk->slots[sindex].timestamp, &value->timestamp) &&
-	       sindex < head->slots_num - 1)
-	{
-		chunk = schunk;
-		index = sindex;
+		chunk = item->head;
+		index = item->head->last_value;
 
 		// 遍历缓存，将新值插入到合适的位置
 		do
@@ -2406,25 +2648,17 @@ static int vch_item_add_value_at_head(zbx_vc_item_t *item, const zbx_history_rec
 					goto out;
 				}
 
+				/* values are shifted through the previous chunk, it must be modifiable */
+				if (NULL == (schunk = vch_item_unpack_chunk(item, schunk)))
+					goto out;
+
 				sindex = schunk->last_value;
 			}
 		}
-		while (1);
+		while (0 < zbx_timespec_compare(&schunk->slots[sindex].timestamp, &value->timestamp));
 	}
-
 	// 如果在缓存中找到了合适的位置，复制新值
-	if (SUCCEED != vch_item_copy_value(item, chunk, index, value))
-		goto out;
-
-	// 如果添加了新缓存块，尝试删除旧的（未使用）缓存块
-	if (head != item->head)
-		item->state |= ZBX_ITEM_STATE_CLEAN_PENDING;
-
-	ret = SUCCEED;
-out:
-	return ret;
-}
-
+	else
 	{
 		/* find the number of free slots on the right side in last (head) chunk */
 		if (NULL != item->head)
@@ -2447,9 +2681,13 @@ out:
 	if (SUCCEED != vch_item_copy_value(item, chunk, index, value))
 		goto out;
 
-	/* try to remove old (unused) chunks if a new chunk was added */
+	// 如果添加了新缓存块，尝试删除旧的（未使用）缓存块
+	/* try to remove old (unused) chunks if a new chunk was added, the previous head will not change anymore */
 	if (head != item->head)
+	{
 		item->state |= ZBX_ITEM_STATE_CLEAN_PENDING;
+		vch_item_pack_chunk(item, head);
+	}
 
 	ret = SUCCEED;
 out:
@@ -2485,9 +2723,10 @@ static int	vch_item_add_values_at_tail(zbx_vc_item_t *item, const zbx_history_re
 	int 	count = values_num, ret = FAIL;
 
 	/* 跳过已经添加到 item 缓存中的值 */
+	/* skip values already added to the item cache by another process */
 	if (NULL != item->tail)
 	{
-		int	sec = item->tail->slots[item->tail->first_value].timestamp.sec;
+		int	sec = vch_item_chunk_values(item, item->tail)[item->tail->first_value].timestamp.sec;
 
 		while (--count >= 0 && values[count].timestamp.sec >= sec)
 			;
@@ -2498,8 +2737,10 @@ static int	vch_item_add_values_at_tail(zbx_vc_item_t *item, const zbx_history_re
 	{
 		int	copy_slots, nslots = 0;
 
+		/* find the number of free slots on the left side in first (tail) chunk, */
+		/* packed chunks have no free slots                                      */
 		/* 查找左侧空闲槽位的数量 */
-		if (NULL != item->tail)
+		if (NULL != item->tail && 0 == item->tail->packed_size)
 			nslots = item->tail->first_value;
 
 		// 如果左侧没有空闲槽位，则创建一个新的 chunk
@@ -2516,12 +2757,17 @@ static int	vch_item_add_values_at_tail(zbx_vc_item_t *item, const zbx_history_re
 		}
 
 		/* 将值复制到 chunk 中 */
+		/* copy values to chunk */
 		copy_slots = MIN(nslots, count);
 		count -= copy_slots;
 
 		// 如果复制值到 chunk 失败，则退出函数
 		if (FAIL == vch_item_copy_values_at_tail(item, values + count, copy_slots))
 			goto out;
+
+		/* filled tail chunk will not receive more values */
+		if (0 == item->tail->first_value)
+			vch_item_pack_chunk(item, item->tail);
 	}
 
 	// 更新返回值，表示添加成功
@@ -2529,34 +2775,57 @@ static int	vch_item_add_values_at_tail(zbx_vc_item_t *item, const zbx_history_re
 
 out:
 	// 返回添加结果
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: vch_item_cache_values_by_time                                    *
+ *                                                                            *
+ * Purpose: cache item history data for the specified time period             *
+ *                                                                            *
+ * Parameters: item        - [IN] the item                                    *
+ *             range_start - [IN] the interval start time                     *
+ *                                                                            *
+ * Return value:  >=0    - the number of values read from database            *
+ *                FAIL   - an error occurred while trying to cache values     *
+ *                                                                            *
+ * Comments: This function checks if the requested value range is cached and  *
+ *           updates cache from database if necessary.                        *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  * *
  *整个代码块的主要目的是根据时间范围从缓存中获取C语言中的zbx_vc_item_t结构体的值。函数vch_item_cache_values_by_time接受两个参数，一个是zbx_vc_item_t类型的指针item，表示要操作的item；另一个是整数类型的range_start，表示请求的时间范围的起始位置。函数首先判断item的状态，如果为ZBX_ITEM_STATUS_CACHED_ALL，则直接返回成功。然后检查请求的时间范围是否在缓存范围内，如果不在，则继续判断缓存是否需要更新以覆盖所需范围。如果需要更新，则解锁vc并从数据库中根据时间范围读取值。读取成功后，对数据进行排序并添加到item的尾部。最后更新缓存时间范围，并返回获取的数据数量。
  ******************************************************************************/
 // 定义一个静态函数，用于根据时间范围从缓存中获取item值
-static int vch_item_cache_values_by_time(zbx_vc_item_t *item, int range_start)
+static int	vch_item_cache_values_by_time(zbx_vc_item_t *item, int range_start)
 {
 	// 定义变量，用于存储函数执行结果和时间范围结束位置
-	int ret = SUCCEED, range_end;
+	int	ret = SUCCEED, range_end;
 
 	// 判断item的状态，如果为ZBX_ITEM_STATUS_CACHED_ALL，则直接返回成功
 	if (ZBX_ITEM_STATUS_CACHED_ALL == item->status)
 		return SUCCEED;
 
 	// 检查请求的时间范围是否在缓存范围内
+	/* check if the requested period is in the cached range */
 	if (0 != item->db_cached_from && range_start >= item->db_cached_from)
 		return SUCCEED;
 
 	// 判断缓存是否需要更新以覆盖所需范围
+	/* find if the cache should be updated to cover the required range */
 	if (NULL != item->tail)
 	{
+		/* we need to get item values before the first cached value, but not including it */
 		// 获取缓存中的第一个值之前的时间范围结束位置
-		range_end = item->tail->slots[item->tail->first_value].timestamp.sec - 1;
+		range_end = vch_item_chunk_values(item, item->tail)[item->tail->first_value].timestamp.sec - 1;
 	}
 	else
 		range_end = ZBX_JAN_2038;
 
 	// 判断时间范围是否需要更新缓存
+	/* update cache if necessary */
 	if (range_start < range_end)
 	{
 		zbx_vector_history_record_t	records;
@@ -2587,6 +2856,8 @@ static int vch_item_cache_values_by_time(zbx_vc_item_t *item, int range_start)
 				ret = vch_item_add_values_at_tail(item, records.values, records.values_num);
 
 			// 更新缓存时间范围，即使请求的时间范围不含数据
+			/* when updating cache with time based request we can always reset status flags */
+			/* flag even if the requested period contains no data                           */
 			item->status = 0;
 
 			// 更新缓存成功，返回获取的数据数量
@@ -2605,27 +2876,6 @@ static int vch_item_cache_values_by_time(zbx_vc_item_t *item, int range_start)
 	return ret;
 }
 
-		{
-			if (0 < records.values_num)
-				ret = vch_item_add_values_at_tail(item, records.values, records.values_num);
-
-			/* when updating cache with time based request we can always reset status flags */
-			/* flag even if the requested period contains no data                           */
-			item->status = 0;
-
-			if (SUCCEED == ret)
-			{
-				ret = records.values_num;
-				vc_item_update_db_cached_from(item, range_start);
-			}
-
-		}
-		zbx_history_record_vector_destroy(&records, item->value_type);
-	}
-
-	return ret;
-}
-
 /******************************************************************************
  *                                                                            *
  * Function: vch_item_cache_values_by_time_and_count                          *
@@ -2650,103 +2900,107 @@ static int vch_item_cache_values_by_time(zbx_vc_item_t *item, int range_start)
  *这段代码的主要目的是根据给定的时间范围和数量，从缓存中获取数据并进行处理。首先检查物品的状态，如果状态为全部已缓存，直接返回成功。然后检查请求的时间范围是否在缓存范围内，如果有缓存且需要更新，则遍历缓存直到找到满足数量的数据或者遍历结束。如果缓存的记录数仍然小于所需数量，则从数据库中读取数据并更新缓存。最后，将读取到的数据添加到物品的尾部，并更新缓存结束时间。整个过程中，还对历史记录进行了排序。
  ******************************************************************************/
 /* 定义一个函数，用于根据时间和数量从缓存中获取数据 */
-static int vch_item_cache_values_by_time_and_count(zbx_vc_item_t *item, int range_start, int count,
-                                                 const zbx_timespec_t *ts)
+static int	vch_item_cache_values_by_time_and_count(zbx_vc_item_t *item, int range_start, int count,
+		const zbx_timespec_t *ts)
 {
     /* 定义一些变量，用于保存返回值、已缓存的记录数、范围结束时间等 */
-    int ret = SUCCEED, cached_records = 0, range_end;
+	int	ret = SUCCEED, cached_records = 0, range_end;
 
     /* 如果物品的状态为全部已缓存，直接返回成功 */
-    if (ZBX_ITEM_STATUS_CACHED_ALL == item->status)
-        return SUCCEED;
+	if (ZBX_ITEM_STATUS_CACHED_ALL == item->status)
+		return SUCCEED;
 
     /* 检查请求的时间范围是否在缓存范围内 */
-    if (0 != item->db_cached_from && range_start >= item->db_cached_from)
-        return SUCCEED;
+	/* check if the requested period is in the cached range */
+	if (0 != item->db_cached_from && range_start >= item->db_cached_from)
+		return SUCCEED;
 
     /* 如果有缓存，检查缓存是否需要更新以包含所需数量的数据 */
-    if (NULL != item->head)
-    {
-        zbx_vc_chunk_t *chunk;
-        int index;
+	/* find if the cache should be updated to cover the required count */
+	if (NULL != item->head)
+	{
+		zbx_vc_chunk_t	*chunk;
+		int		index;
 
         /* 获取最后一个值的位置 */
-        if (SUCCEED == vch_item_get_last_value(item, ts, &chunk, &index))
-        {
-            cached_records = index - chunk->first_value + 1;
+		if (SUCCEED == vch_item_get_last_value(item, ts, &chunk, &index))
+		{
+			cached_records = index - chunk->first_value + 1;
 
             /* 遍历缓存，直到找到满足数量的数据或者遍历结束 */
-            while (NULL != (chunk = chunk->prev) && cached_records < count)
-                cached_records += chunk->last_value - chunk->first_value + 1;
-        }
-    }
+			while (NULL != (chunk = chunk->prev) && cached_records < count)
+				cached_records += chunk->last_value - chunk->first_value + 1;
+		}
+	}
 
     /* 如果缓存的记录数小于所需数量，则更新缓存 */
-    if (cached_records < count)
-    {
-        zbx_vector_history_record_t records;
+	/* update cache if necessary */
+	if (cached_records < count)
+	{
+		zbx_vector_history_record_t	records;
 
         /* 获取缓存结束时间 */
-        if (NULL != item->head)
-            range_end = item->tail->slots[item->tail->first_value].timestamp.sec - 1;
-        else
-            range_end = ZBX_JAN_2038;
+		/* get the end timestamp to which (including) the values should be cached */
+		if (NULL != item->head)
+			range_end = vch_item_chunk_values(item, item->tail)[item->tail->first_value].timestamp.sec - 1;
+		else
+			range_end = ZBX_JAN_2038;
 
-        vc_try_unlock();
+		vc_try_unlock();
 
         /* 创建一个历史记录vector */
-        zbx_vector_history_record_create(&records);
+		zbx_vector_history_record_create(&records);
 
         /* 如果结束时间大于给定的时间戳，说明需要在数据库中读取数据 */
-        if (range_end > ts->sec)
-        {
-            ret = vc_db_read_values_by_time(item->itemid, item->value_type, &records, ts->sec + 1,
-                                            range_end);
+		if (range_end > ts->sec)
+		{
+			ret = vc_db_read_values_by_time(item->itemid, item->value_type, &records, ts->sec + 1,
+					range_end);
 
-            range_end = ts->sec;
-        }
+			range_end = ts->sec;
+		}
 
         /* 如果读取成功，继续读取并根据时间范围和数量更新缓存 */
-        if (SUCCEED == ret && SUCCEED == (ret = vc_db_read_values_by_time_and_count(item->itemid,
-                                                                               item->value_type, &records,
-                                                                               range_start, count - cached_records,
-                                                                               range_end, ts)))
-        {
+		if (SUCCEED == ret && SUCCEED == (ret = vc_db_read_values_by_time_and_count(item->itemid,
+				item->value_type, &records, range_start, count - cached_records, range_end, ts)))
+		{
             /* 对读取到的历史记录进行排序 */
-            zbx_vector_history_record_sort(&records,
-                                          (zbx_compare_func_t)zbx_history_record_compare_asc_func);
-        }
+			zbx_vector_history_record_sort(&records,
+					(zbx_compare_func_t)zbx_history_record_compare_asc_func);
+		}
 
-        vc_try_lock();
+		vc_try_lock();
 
         /* 如果读取成功，将数据添加到物品的尾部 */
-        if (SUCCEED == ret)
-        {
-            if (0 < records.values_num)
-                ret = vch_item_add_values_at_tail(item, records.values, records.values_num);
+		if (SUCCEED == ret)
+		{
+			if (0 < records.values_num)
+				ret = vch_item_add_values_at_tail(item, records.values, records.values_num);
 
             /* 如果添加成功，更新缓存结束时间 */
-            if (SUCCEED == ret)
-            {
-                ret = records.values_num;
-                if ((count <= records.values_num || 0 == range_start) && 0 != records.values_num)
-                {
-                    vc_item_update_db_cached_from(item,
-                                                  item->tail->slots[item->tail->first_value].timestamp.sec);
-                }
-                else if (0 != range_start)
-                    vc_item_update_db_cached_from(item, range_start);
-            }
-        }
+			if (SUCCEED == ret)
+			{
+				ret = records.values_num;
+				if ((count <= records.values_num || 0 == range_start) && 0 != records.values_num)
+				{
+					const zbx_history_record_t	*values;
+
+					values = vch_item_chunk_values(item, item->tail);
+					vc_item_update_db_cached_from(item,
+							values[item->tail->first_value].timestamp.sec);
+				}
+				else if (0 != range_start)
+					vc_item_update_db_cached_from(item, range_start);
+			}
+		}
 
         /* 销毁vector */
-        zbx_history_record_vector_destroy(&records, item->value_type);
-    }
+		zbx_history_record_vector_destroy(&records, item->value_type);
+	}
 
-    return ret;
+	return ret;
 }
 
-
 /******************************************************************************
  *                                                                            *
  * Function: vch_item_get_values_by_time                                      *
@@ -2783,19 +3037,25 @@ static int vch_item_cache_values_by_time_and_count(zbx_vc_item_t *item, int rang
  * 返回值：
  *   无返回值
  */
-static void vch_item_get_values_by_time(zbx_vc_item_t *item, zbx_vector_history_record_t *values, int seconds, const zbx_timespec_t *ts)
+static void	vch_item_get_values_by_time(zbx_vc_item_t *item, zbx_vector_history_record_t *values, int seconds,
+		const zbx_timespec_t *ts)
 {
-	int		index, now;
-	zbx_timespec_t	start = {ts->sec - seconds, ts->ns};
-	zbx_vc_chunk_t	*chunk;
-
+	int				index, now;
+	zbx_timespec_t			start = {ts->sec - seconds, ts->ns};
+	zbx_vc_chunk_t			*chunk;
 	/* 检查最大请求范围是否未设置且所有数据都已缓存。
 	 * 这意味着曾经有一次基于计数的请求，其范围未知，可能大于当前请求范围。
 	 */
+	const zbx_history_record_t	*slots;
+
+	/* Check if maximum request range is not set and all data are cached.  */
+	/* Because that indicates there was a count based request with unknown */
+	/* range which might be greater than the current request range.        */
 	if (0 != item->active_range || ZBX_ITEM_STATUS_CACHED_ALL != item->status)
 	{
 		now = time(NULL);
 		/* 添加一秒，以包含纳秒级偏移量 */
+		/* add another second to include nanosecond shifts */
 		vch_item_update_range(item, seconds + now - ts->sec + 1, now);
 	}
 
@@ -2804,19 +3064,25 @@ static void vch_item_get_values_by_time(zbx_vc_item_t *item, zbx_vector_history_
 		/* 缓存中不包含指定时间偏移和秒数范围的记录。
 		 * 返回空向量并成功。
 		 */
+		/* Cache does not contain records for the specified timeshift & seconds range. */
+		/* Return empty vector with success.                                           */
 		return;
 	}
 
+	slots = vch_item_chunk_values(item, chunk);
+
+	/* fill the values vector with item history values until the start timestamp is reached */
 	/* 将 values 向量填充至达到开始时间戳 */
-	while (0 < zbx_timespec_compare(&chunk->slots[chunk->last_value].timestamp, &start))
+	while (0 < zbx_timespec_compare(&slots[chunk->last_value].timestamp, &start))
 	{
-		while (index >= chunk->first_value && 0 < zbx_timespec_compare(&chunk->slots[index].timestamp, &start))
-			vc_history_record_vector_append(values, item->value_type, &chunk->slots[index--]);
+		while (index >= chunk->first_value && 0 < zbx_timespec_compare(&slots[index].timestamp, &start))
+			vc_history_record_vector_append(values, item->value_type, &slots[index--]);
 
 		if (NULL == (chunk = chunk->prev))
 			break;
 
 		index = chunk->last_value;
+		slots = vch_item_chunk_values(item, chunk);
 	}
 }
 
@@ -2843,75 +3109,88 @@ static void vch_item_get_values_by_time(zbx_vc_item_t *item, zbx_vector_history_
  *整个代码块的主要目的是根据给定的时间范围和次数，从数据库中获取指定 item 的历史值。注释详细说明了每个步骤，包括设置开始时间戳、获取最后一个历史值、填充值向量、处理不足的数据情况以及更新 item 的范围。
  ******************************************************************************/
 // 定义一个函数，用于根据时间范围和次数获取 item 的历史值
-static void vch_item_get_values_by_time_and_count(zbx_vc_item_t *item, zbx_vector_history_record_t *values,
-                                                 int seconds, int count, const zbx_timespec_t *ts)
+static void	vch_item_get_values_by_time_and_count(zbx_vc_item_t *item, zbx_vector_history_record_t *values,
+		int seconds, int count, const zbx_timespec_t *ts)
 {
-    // 定义一些变量，用于索引和计算
-    int index, now, range_timestamp;
-    zbx_vc_chunk_t *chunk;
-    zbx_timespec_t start;
+	// 定义一些变量，用于索引和计算
+	int				index, now, range_timestamp;
+	zbx_vc_chunk_t			*chunk;
+	zbx_timespec_t			start;
+	// 设置请求时间段的开始时间戳
+	const zbx_history_record_t	*slots;
+
+	/* set start timestamp of the requested time period */
+	if (0 != seconds)
+	{
+		start.sec = ts->sec - seconds;
+		start.ns = ts->ns;
+	}
+	else
+	{
+		start.sec = 0;
+		start.ns = 0;
+	}
 
-    // 设置请求时间段的开始时间戳
-    if (0 != seconds)
-    {
-        start.sec = ts->sec - seconds;
-        start.ns = ts->ns;
-    }
-    else
-    {
-        start.sec = 0;
-        start.ns = 0;
-    }
+	// 获取 item 的最后一个历史值
+	if (FAIL == vch_item_get_last_value(item, ts, &chunk, &index))
+	{
+		// 如果没有找到历史值，返回一个空向量并标记成功
+		/* return empty vector with success */
+		goto out;
+	}
 
-    // 获取 item 的最后一个历史值
-    if (FAIL == vch_item_get_last_value(item, ts, &chunk, &index))
-    {
-        // 如果没有找到历史值，返回一个空向量并标记成功
-        goto out;
-    }
+	slots = vch_item_chunk_values(item, chunk);
 
-    // 填充值向量，直到达到指定的时间范围或读取到 <count> 个值
-    while (0 < zbx_timespec_compare(&chunk->slots[chunk->last_value].timestamp, &start))
-    {
-        while (index >= chunk->first_value && 0 < zbx_timespec_compare(&chunk->slots[index].timestamp, &start))
-        {
-            vc_history_record_vector_append(values, item->value_type, &chunk->slots[index--]);
+	/* fill the values vector with item history values until the <count> values are read    */
+	/* or no more values within specified time period                                       */
+	/* fill the values vector with item history values until the start timestamp is reached */
+	// 填充值向量，直到达到指定的时间范围或读取到 <count> 个值
+	while (0 < zbx_timespec_compare(&slots[chunk->last_value].timestamp, &start))
+	{
+		while (index >= chunk->first_value && 0 < zbx_timespec_compare(&slots[index].timestamp, &start))
+		{
+			vc_history_record_vector_append(values, item->value_type, &slots[index--]);
 
-            if (values->values_num == count)
-                goto out;
-        }
+			if (values->values_num == count)
+				goto out;
+		}
 
-        // 如果没有找到上一个 chunk，则结束循环
-        if (NULL == (chunk = chunk->prev))
-            break;
+		// 如果没有找到上一个 chunk，则结束循环
+		if (NULL == (chunk = chunk->prev))
+			break;
 
-        index = chunk->last_value;
-    }
+		index = chunk->last_value;
+		slots = vch_item_chunk_values(item, chunk);
+	}
 
 out:
-    // 如果请求的值数量大于实际找到的值数量
-    if (count > values->values_num)
-    {
-        // 如果时间为空，设置 active_range、daily_range 和 status 变量
-        if (0 == seconds)
-        {
-            item->active_range = 0;
-            item->daily_range = 0;
-            item->status = ZBX_ITEM_STATUS_CACHED_ALL;
-            return;
-        }
-        // 如果没有找到足够的数据，设置范围等于时间段加 1 秒
-        range_timestamp = ts->sec - seconds;
-    }
-    else
-    {
-        // 找到请求的值数量，将范围设置为最老值的时间戳
-        range_timestamp = values->values[values->values_num - 1].timestamp.sec - 1;
-    }
+	// 如果请求的值数量大于实际找到的值数量
+	if (count > values->values_num)
+	{
+		// 如果时间为空，设置 active_range、daily_range 和 status 变量
+		if (0 == seconds)
+		{
+			/* not enough data in db to fulfill a count based request request */
+			item->active_range = 0;
+			item->daily_range = 0;
+			item->status = ZBX_ITEM_STATUS_CACHED_ALL;
+			return;
+		}
+		// 如果没有找到足够的数据，设置范围等于时间段加 1 秒
+		/* not enough data in the requested period, set the range equal to the period plus */
+		/* one second to include nanosecond shifts                                         */
+		range_timestamp = ts->sec - seconds;
+	}
+	else
+	{
+		// 找到请求的值数量，将范围设置为最老值的时间戳
+		/* the requested number of values was retrieved, set the range to the oldest value timestamp */
+		range_timestamp = values->values[values->values_num - 1].timestamp.sec - 1;
+	}
 
-    // 更新 item 的范围
-    now = time(NULL);
-    vch_item_update_range(item, now - range_timestamp, now);
+	// 更新 item 的范围
+	now = time(NULL);
+	vch_item_update_range(item, now - range_timestamp, now);
 }
 
 
@@ -3007,166 +3286,1233 @@ out:
 	return ret;
 }
 
-	hits = values->values_num - records_read;
-	misses = records_read;
 
-	vc_update_statistics(item, hits, misses);
 
-	ret = SUCCEED;
-out:
-	return ret;
+
+/******************************************************************************
+ *                                                                            *
+ * Function: vch_aggr_reset                                                   *
+ *                                                                            *
+ * Purpose: resets aggregate to empty window                                  *
+ *                                                                            *
+ * Parameters: aggr - [IN/OUT] the aggregate                                  *
+ *                                                                            *
+ * Comments: Empty window is positioned after the newest cached value, so it  *
+ *           is extended to the requested period with the next request.       *
+ *                                                                            *
+ ******************************************************************************/
+static void	vch_aggr_reset(zbx_vc_aggr_t *aggr)
+{
+	aggr->updates = 0;
+	aggr->num = 0;
+	aggr->chunk = NULL;
+	aggr->index = 0;
+	aggr->seq_first = 0;
+	aggr->sum_dbl = 0;
+	aggr->sum_hi = 0;
+	aggr->sum_lo = 0;
+	aggr->queue_first = 0;
+	aggr->queue_num = 0;
 }
 
 /******************************************************************************
  *                                                                            *
- * Function: vch_item_free_cache                                              *
+ * Function: vch_aggr_free                                                    *
  *                                                                            *
- * Purpose: frees resources allocated for item history data                   *
+ * Purpose: frees aggregate                                                   *
  *                                                                            *
- * Parameters: item    - [IN] the item                                        *
+ * Parameters: aggr - [IN] the aggregate                                      *
  *                                                                            *
+ * Return value: the size of freed memory (bytes)                             *
+ *                                                                            *
+ ******************************************************************************/
+static size_t	vch_aggr_free(zbx_vc_aggr_t *aggr)
+{
+	size_t	freed = sizeof(zbx_vc_aggr_t);
+
+	if (NULL != aggr->queue)
+	{
+		freed += aggr->queue_alloc * sizeof(zbx_vc_aggr_value_t);
+		__vc_mem_free_func(aggr->queue);
+	}
+
+	__vc_mem_free_func(aggr);
+
+	return freed;
+}
+
 /******************************************************************************
- * *
- *整个代码块的主要目的是初始化值缓存，包括创建互斥锁、分配内存、创建哈希表用于存储值缓存的条目和字符串池、设置最小空闲空间请求等。如果初始化过程中遇到错误，函数会返回相应的错误信息。整个函数执行完毕后，禁用值缓存并记录日志。
+ *                                                                            *
+ * Function: vch_item_free_aggrs                                              *
+ *                                                                            *
+ * Purpose: frees item aggregates                                             *
+ *                                                                            *
+ * Parameters: item - [IN/OUT] the item                                       *
+ *                                                                            *
+ * Return value: the size of freed memory (bytes)                             *
+ *                                                                            *
  ******************************************************************************/
-int zbx_vc_init(char **error)
+static size_t	vch_item_free_aggrs(zbx_vc_item_t *item)
 {
-	// 定义一个常量字符串，表示函数名
-	const char *__function_name = "zbx_vc_init";
+	size_t		freed = 0;
+	zbx_vc_aggr_t	*aggr;
 
-	// 定义一个变量，用于存储分配内存的大小
-	zbx_uint64_t size_reserved;
+	while (NULL != (aggr = item->aggrs))
+	{
+		item->aggrs = aggr->next;
+		freed += vch_aggr_free(aggr);
+	}
 
-	// 定义一个变量，用于存储函数返回值
-	int ret = FAIL;
+	return freed;
+}
 
-	// 如果配置文件中的值等于0，直接返回成功
-	if (0 == CONFIG_VALUE_CACHE_SIZE)
+/******************************************************************************
+ *                                                                            *
+ * Function: vch_item_reset_aggrs                                             *
+ *                                                                            *
+ * Purpose: resets item aggregates with window starting in the specified      *
+ *          chunk                                                             *
+ *                                                                            *
+ * Parameters: item  - [IN/OUT] the item                                      *
+ *             chunk - [IN] the chunk being freed or modified, NULL to reset  *
+ *                          all item aggregates                               *
+ *                                                                            *
+ ******************************************************************************/
+static void	vch_item_reset_aggrs(zbx_vc_item_t *item, const zbx_vc_chunk_t *chunk)
+{
+	zbx_vc_aggr_t	*aggr;
+
+	for (aggr = item->aggrs; NULL != aggr; aggr = aggr->next)
+	{
+		if (NULL == chunk || chunk == aggr->chunk)
+			vch_aggr_reset(aggr);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: vch_aggr_compare                                                 *
+ *                                                                            *
+ * Purpose: checks if the first value is better minimum/maximum candidate     *
+ *          than the second value                                             *
+ *                                                                            *
+ * Parameters: value_type - [IN] the item value type                          *
+ *             aggr       - [IN] the aggregate                                *
+ *             value1     - [IN] the first value                              *
+ *             value2     - [IN] the second value                             *
+ *                                                                            *
+ * Return value: SUCCEED - the first value is less (minimum) or greater       *
+ *                         (maximum) than the second value                    *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	vch_aggr_compare(int value_type, const zbx_vc_aggr_t *aggr, const history_value_t *value1,
+		const history_value_t *value2)
+{
+	if (ITEM_VALUE_TYPE_FLOAT == value_type)
+	{
+		if (ZBX_VC_AGGR_MIN == aggr->type)
+			return value1->dbl < value2->dbl ? SUCCEED : FAIL;
+
+		return value1->dbl > value2->dbl ? SUCCEED : FAIL;
+	}
+
+	if (ZBX_VC_AGGR_MIN == aggr->type)
+		return value1->ui64 < value2->ui64 ? SUCCEED : FAIL;
+
+	return value1->ui64 > value2->ui64 ? SUCCEED : FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: vch_aggr_queue_reserve                                           *
+ *                                                                            *
+ * Purpose: makes sure there is space for one more minimum/maximum candidate  *
+ *                                                                            *
+ * Parameters: aggr - [IN/OUT] the aggregate                                  *
+ *                                                                            *
+ * Return value: SUCCEED - the space was reserved                             *
+ *               FAIL    - not enough memory                                  *
+ *                                                                            *
+ * Comments: The queue is allocated without freeing space in cache, running   *
+ *           aggregates are not worth dropping other items from cache.        *
+ *                                                                            *
+ ******************************************************************************/
+static int	vch_aggr_queue_reserve(zbx_vc_aggr_t *aggr)
+{
+	zbx_vc_aggr_value_t	*queue;
+	int			i, queue_alloc;
+
+	if (aggr->queue_num < aggr->queue_alloc)
 		return SUCCEED;
 
-	// 记录日志，表示函数开始执行
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
+	queue_alloc = (0 == aggr->queue_alloc ? 16 : aggr->queue_alloc * 2);
 
-	// 创建一个互斥锁，用于保护后续操作的数据一致性
-	if (SUCCEED != zbx_mutex_create(&vc_lock, ZBX_MUTEX_VALUECACHE, error))
-		goto out;
+	if (NULL == (queue = (zbx_vc_aggr_value_t *)__vc_mem_malloc_func(NULL,
+			queue_alloc * sizeof(zbx_vc_aggr_value_t))))
+	{
+		return FAIL;
+	}
 
-	// 计算所需的内存大小
-	size_reserved = zbx_mem_required_size(1, "value cache size", "ValueCacheSize");
+	for (i = 0; i < aggr->queue_num; i++)
+		queue[i] = aggr->queue[(aggr->queue_first + i) % aggr->queue_alloc];
 
-	// 分配内存，并创建一个值缓存结构体
-	if (SUCCEED != zbx_mem_create(&vc_mem, CONFIG_VALUE_CACHE_SIZE, "value cache size", "ValueCacheSize", 1, error))
-		goto out;
+	if (NULL != aggr->queue)
+		__vc_mem_free_func(aggr->queue);
 
-	// 更新剩余的内存大小
-	CONFIG_VALUE_CACHE_SIZE -= size_reserved;
+	aggr->queue = queue;
+	aggr->queue_alloc = queue_alloc;
+	aggr->queue_first = 0;
 
-	// 分配一个内存块，用于存储值缓存的头部信息
-	vc_cache = (zbx_vc_cache_t *)__vc_mem_malloc_func(vc_cache, sizeof(zbx_vc_cache_t));
+	return SUCCEED;
+}
 
-	// 检查分配的内存是否为空，如果为空则返回错误信息
-	if (NULL == vc_cache)
+/******************************************************************************
+ *                                                                            *
+ * Function: vch_aggr_add_value                                               *
+ *                                                                            *
+ * Purpose: adds value to aggregate window                                    *
+ *                                                                            *
+ * Parameters: value_type - [IN] the item value type                          *
+ *             aggr       - [IN/OUT] the aggregate                            *
+ *             value      - [IN] the value to add                             *
+ *             oldest     - [IN] 1 - the value is added as the oldest value,  *
+ *                               0 - the value is added as the newest value   *
+ *                                                                            *
+ * Return value: SUCCEED - the value was added                                *
+ *               FAIL    - not enough memory                                  *
+ *                                                                            *
+ ******************************************************************************/
+static int	vch_aggr_add_value(int value_type, zbx_vc_aggr_t *aggr, const history_value_t *value, int oldest)
+{
+	zbx_vc_aggr_value_t	*candidate;
+
+	if (ZBX_VC_AGGR_SUM != aggr->type)
 	{
-		*error = zbx_strdup(*error, "cannot allocate value cache header");
-		goto out;
+		if (0 == oldest)
+		{
+			/* older candidates that are not better than the new value will never be minimum/maximum */
+			while (0 != aggr->queue_num && SUCCEED != vch_aggr_compare(value_type, aggr,
+					&aggr->queue[(aggr->queue_first + aggr->queue_num - 1) % aggr->queue_alloc].value,
+					value))
+			{
+				aggr->queue_num--;
+			}
+
+			if (FAIL == vch_aggr_queue_reserve(aggr))
+				return FAIL;
+
+			candidate = &aggr->queue[(aggr->queue_first + aggr->queue_num) % aggr->queue_alloc];
+			candidate->seq = aggr->seq_first + aggr->num;
+			candidate->value = *value;
+			aggr->queue_num++;
+		}
+		else if (0 == aggr->queue_num || SUCCEED == vch_aggr_compare(value_type, aggr, value,
+				&aggr->queue[aggr->queue_first].value))
+		{
+			/* the oldest value is candidate only if it is better than all newer values */
+			if (FAIL == vch_aggr_queue_reserve(aggr))
+				return FAIL;
+
+			aggr->queue_first = (aggr->queue_first + aggr->queue_alloc - 1) % aggr->queue_alloc;
+			candidate = &aggr->queue[aggr->queue_first];
+			candidate->seq = aggr->seq_first - 1;
+			candidate->value = *value;
+			aggr->queue_num++;
+		}
+	}
+	else if (ITEM_VALUE_TYPE_FLOAT == value_type)
+	{
+		aggr->sum_dbl += value->dbl;
+	}
+	else
+	{
+		aggr->sum_hi += value->ui64 >> 32;
+		aggr->sum_lo += value->ui64 & __UINT64_C(0xffffffff);
 	}
-	// 将内存清零
-	memset(vc_cache, 0, sizeof(zbx_vc_cache_t));
 
-	// 创建一个哈希表，用于存储值缓存的条目
-	zbx_hashset_create_ext(&vc_cache->items, VC_ITEMS_INIT_SIZE,
-			ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC, NULL,
-			__vc_mem_malloc_func, __vc_mem_realloc_func, __vc_mem_free_func);
+	if (0 != oldest)
+		aggr->seq_first--;
 
-	// 检查哈希表是否创建成功，如果失败则返回错误信息
-	if (NULL == vc_cache->items.slots)
+	aggr->num++;
+	aggr->updates++;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: vch_aggr_remove_oldest                                           *
+ *                                                                            *
+ * Purpose: removes the oldest value from aggregate window                    *
+ *                                                                            *
+ * Parameters: item - [IN] the item                                           *
+ *             aggr - [IN/OUT] the aggregate                                  *
+ *                                                                            *
+ ******************************************************************************/
+static void	vch_aggr_remove_oldest(const zbx_vc_item_t *item, zbx_vc_aggr_t *aggr)
+{
+	const history_value_t	*value = &vch_item_chunk_values(item, aggr->chunk)[aggr->index].value;
+
+	if (ZBX_VC_AGGR_SUM != aggr->type)
 	{
-		*error = zbx_strdup(*error, "cannot allocate value cache data storage");
-		goto out;
+		if (0 != aggr->queue_num && aggr->queue[aggr->queue_first].seq == aggr->seq_first)
+		{
+			aggr->queue_first = (aggr->queue_first + 1) % aggr->queue_alloc;
+			aggr->queue_num--;
+		}
+	}
+	else if (ITEM_VALUE_TYPE_FLOAT == item->value_type)
+	{
+		aggr->sum_dbl -= value->dbl;
+	}
+	else
+	{
+		aggr->sum_hi -= value->ui64 >> 32;
+		aggr->sum_lo -= value->ui64 & __UINT64_C(0xffffffff);
 	}
 
-	// 创建一个哈希表，用于存储值缓存的字符串池
-	zbx_hashset_create_ext(&vc_cache->strpool, VC_STRPOOL_INIT_SIZE,
-			vc_strpool_hash_func, vc_strpool_compare_func, NULL,
-			__vc_mem_malloc_func, __vc_mem_realloc_func, __vc_mem_free_func);
+	aggr->seq_first++;
+	aggr->updates++;
 
-	// 检查哈希表是否创建成功，如果失败则返回错误信息
-	if (NULL == vc_cache->strpool.slots)
+	if (0 == --aggr->num)
 	{
-		*error = zbx_strdup(*error, "cannot allocate string pool for value cache data storage");
-		goto out;
+		/* start the next window without accumulated rounding errors */
+		vch_aggr_reset(aggr);
+		return;
 	}
 
-	// 设置最小空闲空间请求，保证数据结构的健康运行
-	vc_cache->min_free_request = (CONFIG_VALUE_CACHE_SIZE / 100) * 5;
-	// 如果最小空闲空间请求大于128KB，则设置为128KB
-	if (vc_cache->min_free_request > 128 * ZBX_KIBIBYTE)
-		vc_cache->min_free_request = 128 * ZBX_KIBIBYTE;
+	if (++aggr->index > aggr->chunk->last_value)
+	{
+		aggr->chunk = aggr->chunk->next;
+		aggr->index = aggr->chunk->first_value;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: vch_aggr_get_previous                                            *
+ *                                                                            *
+ * Purpose: gets the cached value preceding the aggregate window              *
+ *                                                                            *
+ * Parameters: item   - [IN] the item                                         *
+ *             aggr   - [IN] the aggregate                                    *
+ *             pchunk - [OUT] the chunk containing the previous value         *
+ *             pindex - [OUT] the index of the previous value                 *
+ *                                                                            *
+ * Return value: SUCCEED - the previous value was found                       *
+ *               FAIL    - the window starts with the oldest cached value     *
+ *                                                                            *
+ ******************************************************************************/
+static int	vch_aggr_get_previous(const zbx_vc_item_t *item, const zbx_vc_aggr_t *aggr, zbx_vc_chunk_t **pchunk,
+		int *pindex)
+{
+	if (NULL == aggr->chunk)
+	{
+		if (NULL == (*pchunk = item->head))
+			return FAIL;
+
+		*pindex = item->head->last_value;
+
+		return SUCCEED;
+	}
+
+	if (aggr->index > aggr->chunk->first_value)
+	{
+		*pchunk = aggr->chunk;
+		*pindex = aggr->index - 1;
+
+		return SUCCEED;
+	}
+
+	if (NULL == (*pchunk = aggr->chunk->prev))
+		return FAIL;
+
+	*pindex = (*pchunk)->last_value;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: vch_aggr_extend                                                  *
+ *                                                                            *
+ * Purpose: adds the value preceding window to aggregate window               *
+ *                                                                            *
+ * Parameters: item  - [IN] the item                                          *
+ *             aggr  - [IN/OUT] the aggregate                                 *
+ *             chunk - [IN] the chunk containing the previous value           *
+ *             index - [IN] the index of the previous value                   *
+ *                                                                            *
+ * Return value: SUCCEED - the value was added                                *
+ *               FAIL    - not enough memory                                  *
+ *                                                                            *
+ ******************************************************************************/
+static int	vch_aggr_extend(const zbx_vc_item_t *item, zbx_vc_aggr_t *aggr, zbx_vc_chunk_t *chunk, int index)
+{
+	if (FAIL == vch_aggr_add_value(item->value_type, aggr, &vch_item_chunk_values(item, chunk)[index].value, 1))
+		return FAIL;
+
+	aggr->chunk = chunk;
+	aggr->index = index;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: vch_aggr_update_window                                           *
+ *                                                                            *
+ * Purpose: moves aggregate window start to match the requested period        *
+ *                                                                            *
+ * Parameters: item - [IN] the item                                           *
+ *             aggr - [IN/OUT] the aggregate                                  *
+ *             ts   - [IN] the period end timestamp, must not be less than    *
+ *                         the newest cached value timestamp                  *
+ *                                                                            *
+ * Return value: SUCCEED - the window matches the requested period            *
+ *               FAIL    - the period is not fully cached or not enough       *
+ *                         memory to extend the window                        *
+ *                                                                            *
+ ******************************************************************************/
+static int	vch_aggr_update_window(const zbx_vc_item_t *item, zbx_vc_aggr_t *aggr, const zbx_timespec_t *ts)
+{
+	zbx_vc_chunk_t	*chunk;
+	zbx_timespec_t	start;
+	int		index;
+
+	if (0 != aggr->count)
+	{
+		while (aggr->num > aggr->count)
+			vch_aggr_remove_oldest(item, aggr);
+
+		while (aggr->num < aggr->count)
+		{
+			if (FAIL == vch_aggr_get_previous(item, aggr, &chunk, &index))
+				return ZBX_ITEM_STATUS_CACHED_ALL == item->status ? SUCCEED : FAIL;
+
+			if (FAIL == vch_aggr_extend(item, aggr, chunk, index))
+				return FAIL;
+		}
+
+		return SUCCEED;
+	}
+
+	start.sec = ts->sec - aggr->seconds;
+	start.ns = ts->ns;
+
+	while (0 != aggr->num && 0 >= zbx_timespec_compare(
+			&vch_item_chunk_values(item, aggr->chunk)[aggr->index].timestamp, &start))
+	{
+		vch_aggr_remove_oldest(item, aggr);
+	}
+
+	while (SUCCEED == vch_aggr_get_previous(item, aggr, &chunk, &index))
+	{
+		if (0 >= zbx_timespec_compare(&vch_item_chunk_values(item, chunk)[index].timestamp, &start))
+			return SUCCEED;
+
+		if (FAIL == vch_aggr_extend(item, aggr, chunk, index))
+			return FAIL;
+	}
+
+	/* the window starts with the oldest cached value, check if older values in period can be in database */
+	if (ZBX_ITEM_STATUS_CACHED_ALL == item->status || (0 != item->db_cached_from &&
+			start.sec >= item->db_cached_from))
+	{
+		return SUCCEED;
+	}
+
+	return FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: vch_item_get_aggr                                                *
+ *                                                                            *
+ * Purpose: gets item aggregate, creating it if necessary                     *
+ *                                                                            *
+ * Parameters: item    - [IN/OUT] the item                                    *
+ *             type    - [IN] the aggregate type (ZBX_VC_AGGR_*)              *
+ *             seconds - [IN] the window size in seconds                      *
+ *             count   - [IN] the window size in values                       *
+ *                                                                            *
+ * Return value: the aggregate or NULL if it could not be created             *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_vc_aggr_t	*vch_item_get_aggr(zbx_vc_item_t *item, int type, int seconds, int count)
+{
+	zbx_vc_aggr_t	*aggr;
+
+	for (aggr = item->aggrs; NULL != aggr; aggr = aggr->next)
+	{
+		if (aggr->type == type && aggr->seconds == seconds && aggr->count == count)
+			return aggr;
+	}
+
+	if (ZBX_VC_MODE_NORMAL != vc_cache->mode)
+		return NULL;
+
+	if (NULL == (aggr = (zbx_vc_aggr_t *)__vc_mem_malloc_func(NULL, sizeof(zbx_vc_aggr_t))))
+		return NULL;
+
+	memset(aggr, 0, sizeof(zbx_vc_aggr_t));
+	aggr->type = type;
+	aggr->seconds = seconds;
+	aggr->count = count;
+	aggr->next = item->aggrs;
+	item->aggrs = aggr;
+
+	return aggr;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: vch_item_update_aggrs                                            *
+ *                                                                            *
+ * Purpose: updates item aggregates with a new value added to cache           *
+ *                                                                            *
+ * Parameters: item     - [IN/OUT] the item                                   *
+ *             value    - [IN] the added value                                *
+ *             in_order - [IN] 1 - the value was added as the newest value,   *
+ *                             0 - the value was inserted between older       *
+ *                                 values                                     *
+ *             now      - [IN] the current time                               *
+ *                                                                            *
+ ******************************************************************************/
+static void	vch_item_update_aggrs(zbx_vc_item_t *item, const zbx_history_record_t *value, int in_order, int now)
+{
+	zbx_vc_aggr_t	*aggr, *prev = NULL, *next;
+	zbx_timespec_t	start;
+
+	for (aggr = item->aggrs; NULL != aggr; aggr = next)
+	{
+		next = aggr->next;
+
+		/* remove aggregates of changed or deleted trigger functions */
+		if (aggr->last_accessed + ZBX_VC_AGGR_EXPIRE_PERIOD < now)
+		{
+			if (NULL == prev)
+				item->aggrs = next;
+			else
+				prev->next = next;
+
+			vch_aggr_free(aggr);
+			continue;
+		}
+
+		prev = aggr;
+
+		/* the window of inserted value and window with accumulated rounding errors */
+		/* is recalculated with the next request                                    */
+		if (0 == in_order || ZBX_VC_AGGR_RESET_UPDATES < aggr->updates)
+		{
+			vch_aggr_reset(aggr);
+			continue;
+		}
+
+		if (FAIL == vch_aggr_add_value(item->value_type, aggr, &value->value, 0))
+		{
+			vch_aggr_reset(aggr);
+			continue;
+		}
+
+		if (NULL == aggr->chunk)
+		{
+			aggr->chunk = item->head;
+			aggr->index = item->head->last_value;
+		}
+
+		if (0 != aggr->count)
+		{
+			while (aggr->num > aggr->count)
+				vch_aggr_remove_oldest(item, aggr);
+		}
+		else
+		{
+			start.sec = value->timestamp.sec - aggr->seconds;
+			start.ns = value->timestamp.ns;
+
+			while (0 != aggr->num && 0 >= zbx_timespec_compare(
+					&vch_item_chunk_values(item, aggr->chunk)[aggr->index].timestamp, &start))
+			{
+				vch_aggr_remove_oldest(item, aggr);
+			}
+		}
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: vch_item_move_aggrs                                              *
+ *                                                                            *
+ * Purpose: moves aggregate windows starting in the specified chunk to the    *
+ *          chunk replacing it                                                *
+ *                                                                            *
+ * Parameters: item   - [IN/OUT] the item                                     *
+ *             chunk  - [IN] the replaced chunk                               *
+ *             target - [IN] the new chunk with values of the replaced chunk  *
+ *                                                                            *
+ * Comments: Packed chunks store values starting with the first slot, so the  *
+ *           window start index is shifted by the first value difference.     *
+ *                                                                            *
+ ******************************************************************************/
+static void	vch_item_move_aggrs(zbx_vc_item_t *item, const zbx_vc_chunk_t *chunk, zbx_vc_chunk_t *target)
+{
+	zbx_vc_aggr_t	*aggr;
+
+	for (aggr = item->aggrs; NULL != aggr; aggr = aggr->next)
+	{
+		if (chunk == aggr->chunk)
+		{
+			aggr->chunk = target;
+			aggr->index += target->first_value - chunk->first_value;
+		}
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: vch_item_evict_aggrs                                             *
+ *                                                                            *
+ * Purpose: removes values evicted from cache from aggregate windows          *
+ *                                                                            *
+ * Parameters: item  - [IN/OUT] the item                                      *
+ *             chunk - [IN] the chunk the values are evicted from             *
+ *             index - [IN] the index of the newest evicted value             *
+ *                                                                            *
+ * Comments: Values are evicted starting with the oldest cached value, so     *
+ *           only windows starting in the specified chunk are affected.       *
+ *           The window start moves to the oldest value left in cache and is  *
+ *           extended to the requested period with the next request.          *
+ *                                                                            *
+ ******************************************************************************/
+static void	vch_item_evict_aggrs(zbx_vc_item_t *item, const zbx_vc_chunk_t *chunk, int index)
+{
+	zbx_vc_aggr_t	*aggr;
+
+	for (aggr = item->aggrs; NULL != aggr; aggr = aggr->next)
+	{
+		while (chunk == aggr->chunk && aggr->index <= index)
+			vch_aggr_remove_oldest(item, aggr);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: vch_item_free_cache                                              *
+ *                                                                            *
+ * Purpose: frees resources allocated for item history data                   *
+ *                                                                            *
+ * Parameters: item    - [IN] the item                                        *
+ *                                                                            *
+ * Return value: the size of freed memory (bytes)                             *
+ *                                                                            *
+ ******************************************************************************/
+static size_t	vch_item_free_cache(zbx_vc_item_t *item)
+{
+	size_t	freed;
+
+	zbx_vc_chunk_t	*chunk = item->tail;
+
+	/* free aggregates first, evicting values of freed chunks from windows is pointless */
+	freed = vch_item_free_aggrs(item);
+
+	while (NULL != chunk)
+	{
+		zbx_vc_chunk_t	*next = chunk->next;
+
+		freed += vch_item_free_chunk(item, chunk);
+		chunk = next;
+	}
+	item->values_total = 0;
+	item->head = NULL;
+	item->tail = NULL;
+
+	return freed;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Value cache snapshot                                                       *
+ *                                                                            *
+ * The value cache contents are written to ValueCacheSnapshotFile on server   *
+ * shutdown and loaded back on startup, so trigger functions do not have to   *
+ * read all the cached history from database after restart.                   *
+ *                                                                            *
+ * The snapshot file consists of header followed by item records:             *
+ *   header - zbx_vc_snapshot_header_t                                        *
+ *   item   - zbx_vc_snapshot_item_t followed by item values in ascending     *
+ *            order. Each value is stored as zbx_timespec_t followed by:      *
+ *              float, uint64 - 8 bytes of history_value_t                    *
+ *              str, text     - string                                        *
+ *              log           - timestamp, severity, logeventid (int each),   *
+ *                              source string and value string                *
+ *            where string is 32 bit length (including terminating zero, 0    *
+ *            for NULL source) followed by the string data.                   *
+ *                                                                            *
+ * The checksum is calculated over the data following header.                 *
+ *                                                                            *
+ ******************************************************************************/
+
+#define ZBX_VC_SNAPSHOT_MAGIC		"ZBXVCSNP"
+#define ZBX_VC_SNAPSHOT_VERSION		1
+
+typedef struct
+{
+	char		magic[8];
+	zbx_uint32_t	version;
+	zbx_uint32_t	checksum;
+	zbx_uint64_t	timestamp;
+	zbx_uint64_t	items_num;
+	zbx_uint64_t	size;
+}
+zbx_vc_snapshot_header_t;
+
+typedef struct
+{
+	zbx_uint64_t	itemid;
+	unsigned char	value_type;
+	unsigned char	status;
+	unsigned char	range_sync_hour;
+	int		active_range;
+	int		daily_range;
+	int		db_cached_from;
+	int		values_num;
+}
+zbx_vc_snapshot_item_t;
+
+typedef struct
+{
+	FILE		*file;
+	zbx_uint32_t	checksum;
+	zbx_uint64_t	size;
+	int		ret;
+}
+zbx_vc_snapshot_writer_t;
+
+/******************************************************************************
+ *                                                                            *
+ * Function: vc_snapshot_write                                                *
+ *                                                                            *
+ * Purpose: writes data to snapshot file and updates the data checksum        *
+ *                                                                            *
+ * Parameters: writer - [IN/OUT] the snapshot writer                          *
+ *             data   - [IN] the data to write                                *
+ *             size   - [IN] the data size                                    *
+ *                                                                            *
+ * Comments: After the first failure the writer ignores the following writes  *
+ *           and the error is reported by writer->ret.                        *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_snapshot_write(zbx_vc_snapshot_writer_t *writer, const void *data, size_t size)
+{
+	if (SUCCEED != writer->ret || 0 == size)
+		return;
+
+	if (size != fwrite(data, 1, size, writer->file))
+	{
+		writer->ret = FAIL;
+		return;
+	}
+
+	writer->checksum = zbx_hash_sdbm(data, size, writer->checksum);
+	writer->size += size;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: vc_snapshot_write_str                                            *
+ *                                                                            *
+ * Purpose: writes string with its length to snapshot file                    *
+ *                                                                            *
+ * Parameters: writer - [IN/OUT] the snapshot writer                          *
+ *             str    - [IN] the string, can be NULL                          *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_snapshot_write_str(zbx_vc_snapshot_writer_t *writer, const char *str)
+{
+	zbx_uint32_t	len;
+
+	len = (NULL == str ? 0 : (zbx_uint32_t)strlen(str) + 1);
+
+	vc_snapshot_write(writer, &len, sizeof(len));
+	vc_snapshot_write(writer, str, len);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: vc_snapshot_write_item                                           *
+ *                                                                            *
+ * Purpose: writes item and its cached values to snapshot file                *
+ *                                                                            *
+ * Parameters: writer - [IN/OUT] the snapshot writer                          *
+ *             item   - [IN] the item                                         *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_snapshot_write_item(zbx_vc_snapshot_writer_t *writer, zbx_vc_item_t *item)
+{
+	zbx_vc_snapshot_item_t		record;
+	const zbx_vc_chunk_t		*chunk;
+	const zbx_history_record_t	*values;
+	int				i;
+
+	memset(&record, 0, sizeof(record));
+	record.itemid = item->itemid;
+	record.value_type = item->value_type;
+	record.status = item->status;
+	record.range_sync_hour = item->range_sync_hour;
+	record.active_range = item->active_range;
+	record.daily_range = item->daily_range;
+	record.db_cached_from = item->db_cached_from;
+	record.values_num = item->values_total;
+
+	vc_snapshot_write(writer, &record, sizeof(record));
+
+	for (chunk = item->tail; NULL != chunk; chunk = chunk->next)
+	{
+		values = vch_item_chunk_values(item, chunk);
+
+		for (i = chunk->first_value; i <= chunk->last_value; i++)
+		{
+			const zbx_history_record_t	*value = &values[i];
+
+			vc_snapshot_write(writer, &value->timestamp, sizeof(value->timestamp));
+
+			switch (item->value_type)
+			{
+				case ITEM_VALUE_TYPE_FLOAT:
+					vc_snapshot_write(writer, &value->value.dbl, sizeof(value->value.dbl));
+					break;
+				case ITEM_VALUE_TYPE_UINT64:
+					vc_snapshot_write(writer, &value->value.ui64, sizeof(value->value.ui64));
+					break;
+				case ITEM_VALUE_TYPE_STR:
+				case ITEM_VALUE_TYPE_TEXT:
+					vc_snapshot_write_str(writer, value->value.str);
+					break;
+				case ITEM_VALUE_TYPE_LOG:
+					vc_snapshot_write(writer, &value->value.log->timestamp,
+							sizeof(value->value.log->timestamp));
+					vc_snapshot_write(writer, &value->value.log->severity,
+							sizeof(value->value.log->severity));
+					vc_snapshot_write(writer, &value->value.log->logeventid,
+							sizeof(value->value.log->logeventid));
+					vc_snapshot_write_str(writer, value->value.log->source);
+					vc_snapshot_write_str(writer, value->value.log->value);
+					break;
+			}
+		}
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: vc_snapshot_read                                                 *
+ *                                                                            *
+ * Purpose: reads data from snapshot                                          *
+ *                                                                            *
+ * Parameters: ptr  - [IN/OUT] the current position in snapshot data          *
+ *             end  - [IN] the end of snapshot data                           *
+ *             data - [OUT] the read data                                     *
+ *             size - [IN] the data size                                      *
+ *                                                                            *
+ * Return value: SUCCEED - the data was read                                  *
+ *               FAIL    - not enough data left in snapshot                   *
+ *                                                                            *
+ ******************************************************************************/
+static int	vc_snapshot_read(const unsigned char **ptr, const unsigned char *end, void *data, size_t size)
+{
+	if ((size_t)(end - *ptr) < size)
+		return FAIL;
+
+	memcpy(data, *ptr, size);
+	*ptr += size;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: vc_snapshot_read_str                                             *
+ *                                                                            *
+ * Purpose: reads string from snapshot                                        *
+ *                                                                            *
+ * Parameters: ptr  - [IN/OUT] the current position in snapshot data          *
+ *             end  - [IN] the end of snapshot data                           *
+ *             str  - [OUT] the string pointing to the snapshot data or NULL  *
+ *                                                                            *
+ * Return value: SUCCEED - the string was read                                *
+ *               FAIL    - the snapshot data is malformed                     *
+ *                                                                            *
+ * Comments: The returned string is valid while the snapshot is mapped.       *
+ *                                                                            *
+ ******************************************************************************/
+static int	vc_snapshot_read_str(const unsigned char **ptr, const unsigned char *end, const char **str)
+{
+	zbx_uint32_t	len;
+
+	if (SUCCEED != vc_snapshot_read(ptr, end, &len, sizeof(len)) || (size_t)(end - *ptr) < len)
+		return FAIL;
+
+	if (0 == len)
+	{
+		*str = NULL;
+		return SUCCEED;
+	}
+
+	if ('\0' != (*ptr)[len - 1])
+		return FAIL;
+
+	*str = (const char *)*ptr;
+	*ptr += len;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: vc_snapshot_load_item                                            *
+ *                                                                            *
+ * Purpose: loads item and its values from snapshot into value cache          *
+ *                                                                            *
+ * Parameters: ptr  - [IN/OUT] the current position in snapshot data          *
+ *             end  - [IN] the end of snapshot data                           *
+ *             now  - [IN] the current time                                   *
+ *                                                                            *
+ * Return value: SUCCEED - the item was read (but might be not cached if      *
+ *                         there was not enough space in cache)               *
+ *               FAIL    - the snapshot data is malformed                     *
+ *                                                                            *
+ ******************************************************************************/
+static int	vc_snapshot_load_item(const unsigned char **ptr, const unsigned char *end, int now)
+{
+	zbx_vc_snapshot_item_t	record;
+	zbx_vc_item_t		new_item, *item;
+	zbx_history_record_t	*values = NULL;
+	zbx_log_value_t		*logs = NULL, *log;
+	const char		*str;
+	int			i, ret = FAIL;
+
+	if (SUCCEED != vc_snapshot_read(ptr, end, &record, sizeof(record)))
+		return FAIL;
+
+	if (ITEM_VALUE_TYPE_MAX <= record.value_type)
+		return FAIL;
+
+	/* every value has at least timestamp, so the value count cannot exceed the remaining data size */
+	if (0 > record.values_num || (size_t)(end - *ptr) / sizeof(zbx_timespec_t) < (size_t)record.values_num)
+		return FAIL;
+
+	values = (zbx_history_record_t *)zbx_malloc(NULL,
+			sizeof(zbx_history_record_t) * MAX(1, record.values_num));
+
+	if (ITEM_VALUE_TYPE_LOG == record.value_type)
+		logs = (zbx_log_value_t *)zbx_malloc(NULL, sizeof(zbx_log_value_t) * MAX(1, record.values_num));
+
+	for (i = 0; i < record.values_num; i++)
+	{
+		zbx_history_record_t	*value = &values[i];
+
+		if (SUCCEED != vc_snapshot_read(ptr, end, &value->timestamp, sizeof(value->timestamp)))
+			goto out;
+
+		switch (record.value_type)
+		{
+			case ITEM_VALUE_TYPE_FLOAT:
+				if (SUCCEED != vc_snapshot_read(ptr, end, &value->value.dbl, sizeof(double)))
+					goto out;
+				break;
+			case ITEM_VALUE_TYPE_UINT64:
+				if (SUCCEED != vc_snapshot_read(ptr, end, &value->value.ui64, sizeof(zbx_uint64_t)))
+					goto out;
+				break;
+			case ITEM_VALUE_TYPE_STR:
+			case ITEM_VALUE_TYPE_TEXT:
+				if (SUCCEED != vc_snapshot_read_str(ptr, end, &str) || NULL == str)
+					goto out;
+				value->value.str = (char *)str;
+				break;
+			case ITEM_VALUE_TYPE_LOG:
+				log = value->value.log = &logs[i];
+
+				if (SUCCEED != vc_snapshot_read(ptr, end, &log->timestamp, sizeof(int)) ||
+						SUCCEED != vc_snapshot_read(ptr, end, &log->severity, sizeof(int)) ||
+						SUCCEED != vc_snapshot_read(ptr, end, &log->logeventid, sizeof(int)))
+				{
+					goto out;
+				}
+
+				if (SUCCEED != vc_snapshot_read_str(ptr, end, &str))
+					goto out;
+				log->source = (char *)str;
+
+				if (SUCCEED != vc_snapshot_read_str(ptr, end, &str) || NULL == str)
+					goto out;
+				log->value = (char *)str;
+				break;
+		}
+
+		if (0 != i && 0 > zbx_timespec_compare(&value->timestamp, &values[i - 1].timestamp))
+			goto out;
+	}
+
+	ret = SUCCEED;
+
+	/* skip items when cache is running out of memory, cache will be filled with requested data later */
+	if (0 == record.values_num || ZBX_VC_MODE_NORMAL != vc_cache->mode ||
+			NULL != zbx_hashset_search(&vc_cache->items, &record.itemid))
+	{
+		goto out;
+	}
+
+	memset(&new_item, 0, sizeof(new_item));
+	new_item.itemid = record.itemid;
+	new_item.value_type = record.value_type;
+
+	if (NULL == (item = (zbx_vc_item_t *)zbx_hashset_insert(&vc_cache->items, &new_item, sizeof(new_item))))
+		goto out;
+
+	if (SUCCEED != vch_item_add_values_at_tail(item, values, record.values_num))
+	{
+		vc_remove_item(item);
+		goto out;
+	}
+
+	item->status = record.status;
+	item->range_sync_hour = record.range_sync_hour;
+	item->active_range = record.active_range;
+	item->daily_range = record.daily_range;
+	item->db_cached_from = record.db_cached_from;
+	item->last_accessed = now;
+out:
+	zbx_free(logs);
+	zbx_free(values);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: vc_snapshot_load                                                 *
+ *                                                                            *
+ * Purpose: loads value cache snapshot written during the last shutdown       *
+ *                                                                            *
+ * Comments: The snapshot file is removed after loading, so values cached     *
+ *           before server crash or restart without snapshot are not loaded.  *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_snapshot_load(void)
+{
+	const char			*__function_name = "vc_snapshot_load";
+	int				fd, now, items_num = 0;
+	struct stat			st;
+	void				*map = MAP_FAILED;
+	const unsigned char		*ptr, *end;
+	zbx_vc_snapshot_header_t	header;
+	zbx_uint64_t			i;
+
+	if (NULL == CONFIG_VALUE_CACHE_SNAPSHOT_FILE)
+		return;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() file:'%s'", __function_name, CONFIG_VALUE_CACHE_SNAPSHOT_FILE);
+
+	if (-1 == (fd = open(CONFIG_VALUE_CACHE_SNAPSHOT_FILE, O_RDONLY)))
+	{
+		if (ENOENT != errno)
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "cannot open value cache snapshot file \"%s\": %s",
+					CONFIG_VALUE_CACHE_SNAPSHOT_FILE, zbx_strerror(errno));
+		}
+		goto out;
+	}
+
+	if (0 != fstat(fd, &st))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot obtain value cache snapshot file \"%s\" information: %s",
+				CONFIG_VALUE_CACHE_SNAPSHOT_FILE, zbx_strerror(errno));
+		goto clean;
+	}
+
+	if ((size_t)st.st_size < sizeof(header))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "value cache snapshot file \"%s\" is too small, ignoring",
+				CONFIG_VALUE_CACHE_SNAPSHOT_FILE);
+		goto clean;
+	}
+
+	if (MAP_FAILED == (map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0)))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot map value cache snapshot file \"%s\": %s",
+				CONFIG_VALUE_CACHE_SNAPSHOT_FILE, zbx_strerror(errno));
+		goto clean;
+	}
+
+	memcpy(&header, map, sizeof(header));
+	ptr = (const unsigned char *)map + sizeof(header);
+	end = (const unsigned char *)map + st.st_size;
+
+	if (0 != memcmp(header.magic, ZBX_VC_SNAPSHOT_MAGIC, sizeof(header.magic)) ||
+			ZBX_VC_SNAPSHOT_VERSION != header.version || header.size != (zbx_uint64_t)(end - ptr) ||
+			header.checksum != zbx_hash_sdbm(ptr, (size_t)header.size, ZBX_DEFAULT_HASH_SEED))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "value cache snapshot file \"%s\" is corrupted, ignoring",
+				CONFIG_VALUE_CACHE_SNAPSHOT_FILE);
+		goto clean;
+	}
+
+	now = (int)time(NULL);
+
+	/* the data cached before long downtime is not worth loading, it would be dropped by housekeeping */
+	if ((zbx_uint64_t)now > header.timestamp + ZBX_VC_ITEM_EXPIRE_PERIOD)
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "value cache snapshot file \"%s\" is outdated, ignoring",
+				CONFIG_VALUE_CACHE_SNAPSHOT_FILE);
+		goto clean;
+	}
+
+	for (i = 0; i < header.items_num; i++)
+	{
+		if (SUCCEED != vc_snapshot_load_item(&ptr, end, now))
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "value cache snapshot file \"%s\" is corrupted, loaded "
+					ZBX_FS_UI64 " of " ZBX_FS_UI64 " items", CONFIG_VALUE_CACHE_SNAPSHOT_FILE, i,
+					header.items_num);
+			break;
+		}
+	}
+
+	items_num = vc_cache->items.num_data;
+
+	zabbix_log(LOG_LEVEL_INFORMATION, "loaded %d items from value cache snapshot file \"%s\"", items_num,
+			CONFIG_VALUE_CACHE_SNAPSHOT_FILE);
+clean:
+	if (MAP_FAILED != map)
+		munmap(map, (size_t)st.st_size);
+
+	close(fd);
+
+	if (0 != unlink(CONFIG_VALUE_CACHE_SNAPSHOT_FILE))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot remove value cache snapshot file \"%s\": %s",
+				CONFIG_VALUE_CACHE_SNAPSHOT_FILE, zbx_strerror(errno));
+	}
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() items:%d", __function_name, items_num);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: vch_item_free_cache                                              *
+ *                                                                            *
+ * Purpose: frees resources allocated for item history data                   *
+ *                                                                            *
+ * Parameters: item    - [IN] the item                                        *
+ *                                                                            *
+/******************************************************************************
+ * *
+ *整个代码块的主要目的是初始化值缓存，包括创建互斥锁、分配内存、创建哈希表用于存储值缓存的条目和字符串池、设置最小空闲空间请求等。如果初始化过程中遇到错误，函数会返回相应的错误信息。整个函数执行完毕后，禁用值缓存并记录日志。
+ ******************************************************************************/
+/******************************************************************************************************************
+ *                                                                                                                *
+ * Public API                                                                                                     *
+ *                                                                                                                *
+ ******************************************************************************************************************/
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_vc_init                                                      *
+ *                                                                            *
+ * Purpose: initializes value cache                                           *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_vc_init(char **error)
+{
+	// 定义一个常量字符串，表示函数名
+	const char	*__function_name = "zbx_vc_init";
 
-	// 设置初始化成功
-	ret = SUCCEED;
-out:
-	// 禁用值缓存
-	zbx_vc_disable();
+	// 定义一个变量，用于存储分配内存的大小
+	zbx_uint64_t	size_reserved;
 
-	// 记录日志，表示函数执行完毕
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __function_name);
+	// 定义一个变量，用于存储函数返回值
+	int		ret = FAIL;
 
-	// 返回函数执行结果
-	return ret;
-}
+	// 如果配置文件中的值等于0，直接返回成功
+	if (0 == CONFIG_VALUE_CACHE_SIZE)
+		return SUCCEED;
 
+	// 记录日志，表示函数开始执行
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
 
+	// 创建一个互斥锁，用于保护后续操作的数据一致性
 	if (SUCCEED != zbx_mutex_create(&vc_lock, ZBX_MUTEX_VALUECACHE, error))
 		goto out;
 
+	// 计算所需的内存大小
 	size_reserved = zbx_mem_required_size(1, "value cache size", "ValueCacheSize");
 
+	// 分配内存，并创建一个值缓存结构体
 	if (SUCCEED != zbx_mem_create(&vc_mem, CONFIG_VALUE_CACHE_SIZE, "value cache size", "ValueCacheSize", 1, error))
 		goto out;
 
+	// 更新剩余的内存大小
 	CONFIG_VALUE_CACHE_SIZE -= size_reserved;
 
+	// 分配一个内存块，用于存储值缓存的头部信息
 	vc_cache = (zbx_vc_cache_t *)__vc_mem_malloc_func(vc_cache, sizeof(zbx_vc_cache_t));
 
+	// 检查分配的内存是否为空，如果为空则返回错误信息
 	if (NULL == vc_cache)
 	{
 		*error = zbx_strdup(*error, "cannot allocate value cache header");
 		goto out;
 	}
+	// 将内存清零
 	memset(vc_cache, 0, sizeof(zbx_vc_cache_t));
 
+	// 创建一个哈希表，用于存储值缓存的条目
 	zbx_hashset_create_ext(&vc_cache->items, VC_ITEMS_INIT_SIZE,
 			ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC, NULL,
 			__vc_mem_malloc_func, __vc_mem_realloc_func, __vc_mem_free_func);
 
+	// 检查哈希表是否创建成功，如果失败则返回错误信息
 	if (NULL == vc_cache->items.slots)
 	{
 		*error = zbx_strdup(*error, "cannot allocate value cache data storage");
 		goto out;
 	}
 
+	// 创建一个哈希表，用于存储值缓存的字符串池
 	zbx_hashset_create_ext(&vc_cache->strpool, VC_STRPOOL_INIT_SIZE,
 			vc_strpool_hash_func, vc_strpool_compare_func, NULL,
 			__vc_mem_malloc_func, __vc_mem_realloc_func, __vc_mem_free_func);
 
+	// 检查哈希表是否创建成功，如果失败则返回错误信息
 	if (NULL == vc_cache->strpool.slots)
 	{
 		*error = zbx_strdup(*error, "cannot allocate string pool for value cache data storage");
 		goto out;
 	}
 
+	// 设置最小空闲空间请求，保证数据结构的健康运行
 	/* the free space request should be 5% of cache size, but no more than 128KB */
 	vc_cache->min_free_request = (CONFIG_VALUE_CACHE_SIZE / 100) * 5;
+	// 如果最小空闲空间请求大于128KB，则设置为128KB
 	if (vc_cache->min_free_request > 128 * ZBX_KIBIBYTE)
 		vc_cache->min_free_request = 128 * ZBX_KIBIBYTE;
 
+	// 设置初始化成功
+	vc_snapshot_load();
+
 	ret = SUCCEED;
 out:
+	// 禁用值缓存
 	zbx_vc_disable();
 
+	// 记录日志，表示函数执行完毕
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __function_name);
 
+	// 返回函数执行结果
 	return ret;
 }
 
@@ -3207,6 +4553,115 @@ void	zbx_vc_destroy(void)
 		// 将vc_cache设置为NULL
 		vc_cache = NULL;
 	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __function_name);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_vc_snapshot_save                                             *
+ *                                                                            *
+ * Purpose: writes value cache contents to snapshot file                      *
+ *                                                                            *
+ * Comments: The snapshot is loaded by zbx_vc_init() during the next startup. *
+ *           It must be saved after history cache is flushed, so the cached   *
+ *           values match the database.                                       *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_vc_snapshot_save(void)
+{
+	const char			*__function_name = "zbx_vc_snapshot_save";
+	char				*tmpname;
+	zbx_vc_snapshot_writer_t	writer;
+	zbx_vc_snapshot_header_t	header;
+	zbx_hashset_iter_t		iter;
+	zbx_vc_item_t			*item;
+
+	if (NULL == vc_cache || NULL == CONFIG_VALUE_CACHE_SNAPSHOT_FILE)
+		return;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() file:'%s'", __function_name, CONFIG_VALUE_CACHE_SNAPSHOT_FILE);
+
+	tmpname = zbx_dsprintf(NULL, "%s.tmp", CONFIG_VALUE_CACHE_SNAPSHOT_FILE);
+
+	if (NULL == (writer.file = fopen(tmpname, "wb")))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot create value cache snapshot file \"%s\": %s", tmpname,
+				zbx_strerror(errno));
+		goto out;
+	}
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, ZBX_VC_SNAPSHOT_MAGIC, sizeof(header.magic));
+	header.version = ZBX_VC_SNAPSHOT_VERSION;
+	header.timestamp = (zbx_uint64_t)time(NULL);
+
+	/* reserve space for header, it is written after the data checksum is calculated */
+	writer.ret = (1 == fwrite(&header, sizeof(header), 1, writer.file) ? SUCCEED : FAIL);
+	writer.checksum = ZBX_DEFAULT_HASH_SEED;
+	writer.size = 0;
+
+	vc_try_lock();
+
+	zbx_hashset_iter_reset(&vc_cache->items, &iter);
+
+	while (SUCCEED == writer.ret && NULL != (item = (zbx_vc_item_t *)zbx_hashset_iter_next(&iter)))
+	{
+		if (0 != (item->state & ZBX_ITEM_STATE_REMOVE_PENDING) || 0 == item->values_total)
+			continue;
+
+		vc_snapshot_write_item(&writer, item);
+		header.items_num++;
+	}
+
+	vc_try_unlock();
+
+	if (SUCCEED == writer.ret)
+	{
+		header.checksum = writer.checksum;
+		header.size = writer.size;
+
+		if (0 != fseek(writer.file, 0, SEEK_SET) || 1 != fwrite(&header, sizeof(header), 1, writer.file))
+			writer.ret = FAIL;
+	}
+
+	if (0 != fclose(writer.file))
+		writer.ret = FAIL;
+
+	if (SUCCEED != writer.ret)
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot write value cache snapshot file \"%s\": %s", tmpname,
+				zbx_strerror(errno));
+		unlink(tmpname);
+		goto out;
+	}
+
+	if (0 != rename(tmpname, CONFIG_VALUE_CACHE_SNAPSHOT_FILE))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot rename value cache snapshot file \"%s\" to \"%s\": %s", tmpname,
+				CONFIG_VALUE_CACHE_SNAPSHOT_FILE, zbx_strerror(errno));
+		unlink(tmpname);
+		goto out;
+	}
+
+	zabbix_log(LOG_LEVEL_INFORMATION, "saved " ZBX_FS_UI64 " items to value cache snapshot file \"%s\"",
+			header.items_num, CONFIG_VALUE_CACHE_SNAPSHOT_FILE);
+out:
+	zbx_free(tmpname);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __function_name);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_vc_reset                                                     *
+ *                                                                            *
+ * Purpose: resets value cache                                                *
+ *                                                                            *
+ * Comments: All items and their historical data are removed,                 *
+ *           cache working mode, statistics reset.                            *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  * *
  *整个代码块的主要目的是：清空vc_cache中的项目缓存，并将vc_cache的相关参数重置为初始状态。在这个过程中，首先检查vc_cache是否为空，如果不为空，则遍历vc_cache中的项目，并释放项目缓存。接着将vc_cache的相关参数重置为初始状态，最后尝试解锁并释放vc_cache的资源。整个过程通过zabbix_log记录调试日志，以保证代码执行的稳定性。
@@ -3252,19 +4707,35 @@ void	zbx_vc_reset(void)
 		// 尝试解锁，释放vc_cache的资源
 		vc_try_unlock();
 	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __function_name);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_vc_add_values                                                *
+ *                                                                            *
+ * Purpose: adds item values to the history and value cache                   *
+ *                                                                            *
+ * Parameters: history - [IN] item history values                             *
+ *                                                                            *
+ * Return value: SUCCEED - the values were added successfully                 *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  * *
  *整个代码块的主要目的是：遍历历史数据，检查每个数据项是否可以更新，如果可以更新，则将新值添加到缓存中。在添加过程中，还对数据项的状态进行标记，以便在后续处理中进行删除操作。在整个过程中，还对共享资源进行了加锁保护，以确保数据的一致性。
  ******************************************************************************/
-int zbx_vc_add_values(zbx_vector_ptr_t *history)
+int	zbx_vc_add_values(zbx_vector_ptr_t *history)
 {
 	/* 定义变量 */
 	zbx_vc_item_t		*item;
-	int 			i;
+	int 			i, in_order;
 	ZBX_DC_HISTORY		*h;
-	time_t			expire_timestamp;
-
 	/* 检查zbx_history_add_values是否添加成功，如果失败则返回失败 */
+	time_t			expire_timestamp, now;
+
 	if (FAIL == zbx_history_add_values(history))
 		return FAIL;
 
@@ -3272,10 +4743,11 @@ int zbx_vc_add_values(zbx_vector_ptr_t *history)
 	if (ZBX_VC_DISABLED == vc_state)
 		return SUCCEED;
 
+	/* 加锁保护共享资源 */
+	now = time(NULL);
 	/* 计算过期时间 */
-	expire_timestamp = time(NULL) - ZBX_VC_ITEM_EXPIRE_PERIOD;
+	expire_timestamp = now - ZBX_VC_ITEM_EXPIRE_PERIOD;
 
-	/* 加锁保护共享资源 */
 	vc_try_lock();
 
 	/* 遍历历史数据 */
@@ -3295,15 +4767,38 @@ int zbx_vc_add_values(zbx_vector_ptr_t *history)
 				/* 增加引用计数 */
 				vc_item_addref(item);
 
+				/* If the new value type does not match the item's type in cache we can't  */
+				/* change the cache because other processes might still be accessing it    */
+				/* at the same time. The only thing that can be done - mark it for removal */
+				/* so it could be added later with new type.                               */
+				/* Also mark it for removal if the value adding failed. In this case we    */
+				/* won't have the latest data in cache - so the requests must go directly  */
+				/* to the database.                                                        */
 				/* 检查新值类型是否与缓存中的类型匹配，如果不匹配，则不能更改缓存 */
 				/* 只能标记为待删除，以便稍后重新添加。同时，如果添加值失败，也标记为待删除。 */
-				if (item->value_type != h->value_type || item->last_accessed < expire_timestamp ||
-						FAIL == vch_item_add_value_at_head(item, &record))
+				if (item->value_type != h->value_type || item->last_accessed < expire_timestamp)
 				{
 					item->state |= ZBX_ITEM_STATE_REMOVE_PENDING;
 				}
-
 				/* 释放引用计数 */
+				else
+				{
+					in_order = (NULL == item->head || 0 >= zbx_history_record_compare_asc_func(
+							&item->head->slots[item->head->last_value], &record));
+
+					/* values inserted between cached values change running aggregate windows */
+					if (0 == in_order)
+						vch_item_reset_aggrs(item, NULL);
+
+					if (FAIL == vch_item_add_value_at_head(item, &record))
+					{
+						item->state |= ZBX_ITEM_STATE_REMOVE_PENDING;
+						vch_item_reset_aggrs(item, NULL);
+					}
+					else if (NULL != item->aggrs)
+						vch_item_update_aggrs(item, &record, in_order, now);
+				}
+
 				vc_item_release(item);
 			}
 		}
@@ -3316,19 +4811,32 @@ int zbx_vc_add_values(zbx_vector_ptr_t *history)
 	return SUCCEED;
 }
 
-	for (i = 0; i < history->values_num; i++)
-	{
-		h = (ZBX_DC_HISTORY *)history->values[i];
-
-		if (NULL != (item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &h->itemid)))
-		{
-			zbx_history_record_t	record = {h->ts, h->value};
-
-			if (0 == (item->state & ZBX_ITEM_STATE_REMOVE_PENDING))
-			{
-				vc_item_addref(item);
-
-				/* If the new value type does not match the item's type in cache we can't  */
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_vc_get_values                                                *
+ *                                                                            *
+ * Purpose: get item history data for the specified time period               *
+ *                                                                            *
+ * Parameters: itemid     - [IN] the item id                                  *
+ *             value_type - [IN] the item value type                          *
+ *             values     - [OUT] the item history data stored time/value     *
+ *                          pairs in descending order                         *
+ *             seconds    - [IN] the time period to retrieve data for         *
+ *             count      - [IN] the number of history values to retrieve     *
+ *             ts         - [IN] the period end timestamp                     *
+ *                                                                            *
+ * Return value:  SUCCEED - the item history data was retrieved successfully  *
+ *                FAIL    - the item history data was not retrieved           *
+ *                                                                            *
+ * Comments: If the data is not in cache, it's read from DB, so this function *
+ *           will always return the requested data, unless some error occurs. *
+ *                                                                            *
+ *           If <count> is set then value range is defined as <count> values  *
+ *           before <timestamp>. Otherwise the range is defined as <seconds>  *
+ *           seconds before <timestamp>.                                      *
+ *                                                                            *
+ ******************************************************************************/
+// 定义函数名和日志级别
 /******************************************************************************
  * *
  *整个代码块的主要目的是实现一个名为`zbx_vc_get_values`的函数，该函数用于从Zabbix监控系统中获取指定itemid的的历史数据。函数接收以下参数：
@@ -3341,114 +4849,61 @@ int zbx_vc_add_values(zbx_vector_ptr_t *history)
  *
  *函数首先查询缓存中的item，如果找不到，则新建一个item并插入缓存。然后判断item的状态和value_type是否匹配，如果不匹配，则退出。接下来调用`vch_item_get_values`函数获取数据，如果失败，则解锁并调用数据库接口`vc_db_get_values`获取数据。最后，根据获取数据的成功与否，更新统计信息并释放资源。在整个过程中，还对缓存的使用情况进行了记录和统计。
  ******************************************************************************/
-// 定义函数名和日志级别
-const char *__function_name = "zbx_vc_get_values";
-
-// 定义变量
-zbx_vc_item_t *item = NULL;
-int ret = FAIL, cache_used = 1;
-
-// 记录日志
-zabbix_log(LOG_LEVEL_DEBUG, "In %s() itemid:" ZBX_FS_UI64 " value_type:%d seconds:%d count:%d sec:%d ns:%d",
-           __function_name, itemid, value_type, seconds, count, ts->sec, ts->ns);
-
-// 尝试加锁
-vc_try_lock();
-
-// 判断vc状态，如果已禁用，则退出
-if (ZBX_VC_DISABLED == vc_state)
-    goto out;
-
-// 判断缓存模式，如果为低内存模式，则警告
-if (ZBX_VC_MODE_LOWMEM == vc_cache->mode)
-    vc_warn_low_memory();
-
-// 查询itemid对应的zbx_vc_item_t结构体
-if (NULL == (item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &itemid)))
+int	zbx_vc_get_values(zbx_uint64_t itemid, int value_type, zbx_vector_history_record_t *values, int seconds,
+		int count, const zbx_timespec_t *ts)
 {
-    // 如果缓存模式为正常，则新建一个item
-    if (ZBX_VC_MODE_NORMAL == vc_cache->mode)
-    {
-        zbx_vc_item_t   new_item = {.itemid = itemid, .value_type = value_type};
-
-        // 插入新item到缓存中
-        if (NULL == (item = (zbx_vc_item_t *)zbx_hashset_insert(&vc_cache->items, &new_item, sizeof(zbx_vc_item_t))))
-            goto out;
-    }
-    // 否则，退出
-    else
-        goto out;
-}
-
-// 增加item引用计数
-vc_item_addref(item);
-
-// 判断item状态和value_type是否匹配，如果不匹配，则退出
-if (0 != (item->state & ZBX_ITEM_STATE_REMOVE_PENDING) || item->value_type != value_type)
-    goto out;
-
-// 调用vch_item_get_values获取值
-ret = vch_item_get_values(item, values, seconds, count, ts);
-
-// 退出逻辑
-out:
-    // 如果获取值失败，设置item状态为删除待处理
-    if (FAIL == ret)
-    {
-        if (NULL != item)
-            item->state |= ZBX_ITEM_STATE_REMOVE_PENDING;
-
-        cache_used = 0;
+	// 定义函数名和日志级别
+	const char	*__function_name = "zbx_vc_get_values";
 
-        // 尝试解锁
-        vc_try_unlock();
+	// 定义变量
+	zbx_vc_item_t	*item = NULL;
+	int 		ret = FAIL, cache_used = 1;
 
-        // 调用vc_db_get_values获取值
-        ret = vc_db_get_values(itemid, value_type, values, seconds, count, ts);
+	// 记录日志
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() itemid:" ZBX_FS_UI64 " value_type:%d seconds:%d count:%d sec:%d ns:%d",
+			__function_name, itemid, value_type, seconds, count, ts->sec, ts->ns);
 
-        // 重新加锁
-        vc_try_lock();
-
-        // 如果数据库获取值成功，更新统计信息
-        if (SUCCEED == ret)
-            vc_update_statistics(NULL, 0, values->values_num);
-    }
-
-    // 释放item
-    if (NULL != item)
-        vc_item_release(item);
-
-    // 解锁
-    vc_try_unlock();
+	// 尝试加锁
+	vc_try_lock();
 
-    // 记录日志
-    zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s count:%d cached:%d",
-               __function_name, zbx_result_string(ret), values->values_num, cache_used);
+	// 判断vc状态，如果已禁用，则退出
+	if (ZBX_VC_DISABLED == vc_state)
+		goto out;
 
-    // 返回结果
-    return ret;
-}
+	// 判断缓存模式，如果为低内存模式，则警告
+	if (ZBX_VC_MODE_LOWMEM == vc_cache->mode)
+		vc_warn_low_memory();
 
+	// 查询itemid对应的zbx_vc_item_t结构体
 	if (NULL == (item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &itemid)))
 	{
+		// 如果缓存模式为正常，则新建一个item
 		if (ZBX_VC_MODE_NORMAL == vc_cache->mode)
 		{
 			zbx_vc_item_t   new_item = {.itemid = itemid, .value_type = value_type};
 
+			// 插入新item到缓存中
 			if (NULL == (item = (zbx_vc_item_t *)zbx_hashset_insert(&vc_cache->items, &new_item, sizeof(zbx_vc_item_t))))
 				goto out;
 		}
+		// 否则，退出
 		else
 			goto out;
 	}
 
+	// 增加item引用计数
 	vc_item_addref(item);
 
+	// 判断item状态和value_type是否匹配，如果不匹配，则退出
 	if (0 != (item->state & ZBX_ITEM_STATE_REMOVE_PENDING) || item->value_type != value_type)
 		goto out;
 
+	// 调用vch_item_get_values获取值
 	ret = vch_item_get_values(item, values, seconds, count, ts);
+
+// 退出逻辑
 out:
+	// 如果获取值失败，设置item状态为删除待处理
 	if (FAIL == ret)
 	{
 		if (NULL != item)
@@ -3456,27 +4911,36 @@ out:
 
 		cache_used = 0;
 
+		// 尝试解锁
 		vc_try_unlock();
 
+		// 调用vc_db_get_values获取值
 		ret = vc_db_get_values(itemid, value_type, values, seconds, count, ts);
 
+		// 重新加锁
 		vc_try_lock();
 
+		// 如果数据库获取值成功，更新统计信息
 		if (SUCCEED == ret)
 			vc_update_statistics(NULL, 0, values->values_num);
 	}
 
+	// 释放item
 	if (NULL != item)
 		vc_item_release(item);
 
+	// 解锁
 	vc_try_unlock();
 
+	// 记录日志
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s count:%d cached:%d",
 			__function_name, zbx_result_string(ret), values->values_num, cache_used);
 
+	// 返回结果
 	return ret;
 }
 
+
 /******************************************************************************
  *                                                                            *
  * Function: zbx_vc_get_value                                                 *
@@ -3507,11 +4971,12 @@ out:
 // const zbx_timespec_t *ts：时间戳指针
 // zbx_history_record_t *value：历史记录指针
 // 函数返回int类型，表示操作结果
-
 int	zbx_vc_get_value(zbx_uint64_t itemid, int value_type, const zbx_timespec_t *ts, zbx_history_record_t *value)
 {
 	// 定义一个zbx_vector_history_record_t类型的变量values，用于存储历史记录列表
 	// 初始化变量ret为FAIL，表示操作失败
+	zbx_vector_history_record_t	values;
+	int				ret = FAIL;
 
 	zbx_history_record_vector_create(&values); // 创建一个历史记录列表
 
@@ -3546,6 +5011,140 @@ out: // 标签out，用于跳过以下代码块，只在zbx_vc_get_values执行
 }
 
 
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_vc_get_aggregate                                             *
+ *                                                                            *
+ * Purpose: gets aggregate of item values in the specified period from the    *
+ *          running aggregate maintained in value cache                       *
+ *                                                                            *
+ * Parameters: itemid     - [IN] the item id                                  *
+ *             value_type - [IN] the item value type                          *
+ *             type       - [IN] the aggregate type (ZBX_VC_AGGR_*)           *
+ *             seconds    - [IN] the time period                              *
+ *             count      - [IN] the number of values                         *
+ *             ts         - [IN] the period end timestamp                     *
+ *             value      - [OUT] the aggregated value                        *
+ *             num        - [OUT] the number of aggregated values             *
+ *                                                                            *
+ * Return value: SUCCEED - the aggregate was calculated, value is not set if  *
+ *                         there are no values in the period (num is 0)       *
+ *               FAIL    - the aggregate cannot be calculated from running    *
+ *                         aggregate, zbx_vc_get_values() must be used        *
+ *                                                                            *
+ * Comments: Either seconds or count must be set. The running aggregates are  *
+ *           supported only for float and unsigned items already cached and   *
+ *           periods ending after the newest cached value, so the aggregate   *
+ *           window slides forward with new values and only the values        *
+ *           entering and leaving window are processed.                       *
+ *           For ZBX_VC_AGGR_AVG the average is returned as floating point    *
+ *           value for both value types.                                      *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_vc_get_aggregate(zbx_uint64_t itemid, int value_type, int type, int seconds, int count,
+		const zbx_timespec_t *ts, history_value_t *value, int *num)
+{
+	const char		*__function_name = "zbx_vc_get_aggregate";
+	zbx_vc_item_t		*item = NULL;
+	zbx_vc_aggr_t		*aggr;
+	const zbx_timespec_t	*oldest;
+	int			ret = FAIL, now;
+	double			sum;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() itemid:" ZBX_FS_UI64 " type:%d seconds:%d count:%d sec:%d ns:%d",
+			__function_name, itemid, type, seconds, count, ts->sec, ts->ns);
+
+	if ((0 == seconds) == (0 == count))
+		goto out;
+
+	if (ITEM_VALUE_TYPE_FLOAT != value_type && ITEM_VALUE_TYPE_UINT64 != value_type)
+		goto out;
+
+	vc_try_lock();
+
+	if (ZBX_VC_DISABLED == vc_state)
+		goto unlock;
+
+	if (NULL == (item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &itemid)))
+		goto unlock;
+
+	vc_item_addref(item);
+
+	if (0 != (item->state & ZBX_ITEM_STATE_REMOVE_PENDING) || item->value_type != value_type ||
+			NULL == item->head)
+	{
+		goto release;
+	}
+
+	/* the window can only slide forward */
+	if (0 < zbx_timespec_compare(&item->head->slots[item->head->last_value].timestamp, ts))
+		goto release;
+
+	if (NULL == (aggr = vch_item_get_aggr(item, ZBX_VC_AGGR_AVG == type ? ZBX_VC_AGGR_SUM : type, seconds,
+			count)))
+	{
+		goto release;
+	}
+
+	aggr->last_accessed = now = time(NULL);
+
+	if (FAIL == vch_aggr_update_window(item, aggr, ts))
+	{
+		vch_aggr_reset(aggr);
+		goto release;
+	}
+
+	if (0 != (*num = aggr->num))
+	{
+		switch (type)
+		{
+			case ZBX_VC_AGGR_SUM:
+				if (ITEM_VALUE_TYPE_FLOAT == value_type)
+					value->dbl = aggr->sum_dbl;
+				else
+					value->ui64 = (aggr->sum_hi << 32) + aggr->sum_lo;
+				break;
+			case ZBX_VC_AGGR_AVG:
+				if (ITEM_VALUE_TYPE_FLOAT == value_type)
+					sum = aggr->sum_dbl;
+				else
+					sum = (double)aggr->sum_hi * 4294967296.0 + (double)aggr->sum_lo;
+
+				value->dbl = sum / aggr->num;
+				break;
+			default:
+				*value = aggr->queue[aggr->queue_first].value;
+		}
+	}
+
+	/* the requested range must be kept in cache as if the values were retrieved */
+	if (0 != item->active_range || ZBX_ITEM_STATUS_CACHED_ALL != item->status)
+	{
+		if (0 != seconds)
+		{
+			vch_item_update_range(item, seconds + now - ts->sec + 1, now);
+		}
+		else if (0 != aggr->num)
+		{
+			oldest = &vch_item_chunk_values(item, aggr->chunk)[aggr->index].timestamp;
+			vch_item_update_range(item, now - oldest->sec + 1, now);
+		}
+	}
+
+	vc_update_statistics(item, aggr->num, 0);
+
+	ret = SUCCEED;
+release:
+	vc_item_release(item);
+unlock:
+	vc_try_unlock();
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
+
+	return ret;
+}
+
+
 /******************************************************************************
  *                                                                            *
  * Function: zbx_vc_get_statistics                                            *
@@ -3614,6 +5213,9 @@ void zbx_vc_lock(void)
 
     // 将 vc_locked 变量设置为 1，表示锁已经被锁定
     vc_locked = 1;
+
+    // 其他进程可能已经释放并重用了已解码的压缩数据块
+    vc_unpacked_chunk = NULL;
 }
 
 
@@ -3630,6 +5232,15 @@ void zbx_vc_unlock(void)
 	vc_locked = 0;
 
 	// 调用另一个名为 zbx_mutex_unlock 的函数，传入参数 vc_lock。
+	zbx_mutex_unlock(vc_lock);
+}
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_vc_enable                                                    *
+ *                                                                            *
+ * Purpose: enables value caching for current process                         *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  * *
  *这块代码的主要目的是：检查 vc_cache 是否为 NULL，如果不是 NULL，则将 vc_state 设置为 ZBX_VC_ENABLED。
@@ -3652,21 +5263,8 @@ void zbx_vc_unlock(void)
 void	zbx_vc_enable(void) // 定义一个名为 zbx_vc_enable 的函数，无返回值
 {
 	if (NULL != vc_cache) // 判断 vc_cache 是否不为 NULL
-	{
 		vc_state = ZBX_VC_ENABLED; // 如果 vc_cache 存在，将 vc_state 设置为 ZBX_VC_ENABLED
-	}
-}
-
-
- * Comments: See zbx_vc_lock() function.                                      *
- *                                                                            *
- ******************************************************************************/
-void	zbx_vc_unlock(void)
-{
-	vc_locked = 0;
-	zbx_mutex_unlock(vc_lock);
 }
-
 /******************************************************************************
  *                                                                            *
  * Function: zbx_vc_enable                                                    *
@@ -3674,11 +5272,6 @@ void	zbx_vc_unlock(void)
  * Purpose: enables value caching for current process                         *
  *                                                                            *
  ******************************************************************************/
-void	zbx_vc_enable(void)
-{
-	if (NULL != vc_cache)
-		vc_state = ZBX_VC_ENABLED;
-}
 
 /******************************************************************************
  *                                                                            *
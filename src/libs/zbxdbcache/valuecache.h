@@ -63,6 +63,12 @@
 /* indicates that all values from database are cached */
 #define ZBX_ITEM_STATUS_CACHED_ALL	1
 
+/* the running aggregate types, see zbx_vc_get_aggregate(), match history storage aggregate types */
+#define ZBX_VC_AGGR_SUM	ZBX_HISTORY_AGGR_SUM
+#define ZBX_VC_AGGR_AVG	ZBX_HISTORY_AGGR_AVG
+#define ZBX_VC_AGGR_MIN	ZBX_HISTORY_AGGR_MIN
+#define ZBX_VC_AGGR_MAX	ZBX_HISTORY_AGGR_MAX
+
 /* the cache statistics */
 typedef struct
 {
@@ -86,6 +92,8 @@ int	zbx_vc_init(char **error);
 
 void	zbx_vc_destroy(void);
 
+void	zbx_vc_snapshot_save(void);
+
 void	zbx_vc_reset(void);
 
 void	zbx_vc_lock(void);
@@ -101,6 +109,9 @@ int	zbx_vc_get_values(zbx_uint64_t itemid, int value_type, zbx_vector_history_re
 
 int	zbx_vc_get_value(zbx_uint64_t itemid, int value_type, const zbx_timespec_t *ts, zbx_history_record_t *value);
 
+int	zbx_vc_get_aggregate(zbx_uint64_t itemid, int value_type, int type, int seconds, int count,
+		const zbx_timespec_t *ts, history_value_t *value, int *num);
+
 int	zbx_vc_add_values(zbx_vector_ptr_t *history);
 
 int	zbx_vc_get_statistics(zbx_vc_stats_t *stats);
@@ -51,6 +51,7 @@ extern char	ZBX_PG_ESCAPE_BACKSLASH;
 #endif
 
 static int	connection_failure;
+
 /******************************************************************************
  * *
  *这段代码定义了一个名为DBclose的函数，该函数不需要传入任何参数。在函数内部，调用了名为zbx_db_close的函数，用于关闭数据库连接。整个代码块的主要目的是在程序运行结束时关闭数据库连接，以确保资源得到正确释放。
@@ -63,13 +64,19 @@ void	DBclose(void)           // 定义一个名为DBclose的函数，不需要
 
 // 整个代码块的主要目的是关闭数据库连接。
 
-
 /******************************************************************************
  *                                                                            *
  * Function: DBconnect                                                        *
  *                                                                            *
  * Purpose: connect to the database                                           *
  *                                                                            *
+ * Parameters: flag - ZBX_DB_CONNECT_ONCE (try once and return the result),   *
+ *                    ZBX_DB_CONNECT_EXIT (exit on failure) or                *
+ *                    ZBX_DB_CONNECT_NORMAL (retry until connected)           *
+ *                                                                            *
+ * Return value: same as zbx_db_connect()                                     *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  * *
  *整个代码块的主要目的是实现一个名为 DBconnect 的函数，该函数接收一个整数参数 flag，用于控制连接数据库的策略。函数内部使用 zbx_db_connect 函数尝试连接数据库，如果连接失败，则根据 flag 的值进行不同的处理，如等待重试或记录错误日志并退出程序。当数据库连接成功时，记录调试日志并返回错误码。
@@ -121,14 +128,6 @@ int DBconnect(int flag)
     return err;
 }
 
-		connection_failure = 0;
-	}
-
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%d", __function_name, err);
-
-	return err;
-}
-
 /******************************************************************************
  *                                                                            *
  * Function: DBinit                                                           *
@@ -142,20 +141,10 @@ int DBconnect(int flag)
  ******************************************************************************/
 int DBinit(char **error)
 {
-    // 定义常量
-    const char *CONFIG_DBNAME = "zbx_db";
-    const char *db_schema = "zbx_db.schema";
-
     // 调用zbx_db_init函数初始化数据库
     return zbx_db_init(CONFIG_DBNAME, db_schema, error);
 }
 
-/**
- * 函数DBinit用于初始化数据库
- * 参数：error - 错误信息指针
- * 返回值：0 - 成功，非0 - 失败
- */
-
 /******************************************************************************
  * *
  *整个代码块的主要目的是：初始化数据库。
@@ -165,12 +154,23 @@ int DBinit(char **error)
  *1. 定义一个名为 DBdeinit 的函数，该函数为 void 类型（无返回值）。
  *2. 调用 zbx_db_deinit() 函数，用于初始化数据库。
  *3. 在程序运行过程中，当需要使用数据库时，可以调用此函数进行初始化。
- *
- *输出注释后的代码块：
- *
- *```c
- */**
- * * @file db_deinit.c
+ ******************************************************************************/
+// 定义一个名为 DBdeinit 的函数，该函数为 void 类型（无返回值）
+void DBdeinit(void)
+{
+    // 调用 zbx_db_deinit() 函数，用于初始化数据库
+    zbx_db_deinit();
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: DBtxn_operation                                                  *
+ *                                                                            *
+ * Purpose: helper function to loop transaction operation while DB is down    *
+ *                                                                            *
+ * Author: Eugene Grigorjev, Vladimir Levijev                                 *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  * *
  *这块代码的主要目的是在一个循环中不断尝试执行数据库事务操作，直到成功为止。在此过程中，如果数据库连接失败，程序会关闭数据库连接，然后等待一段时间后重新连接并尝试执行事务操作。如果仍然失败，则会继续等待并重试。整个过程通过调用`DBtxn_operation`函数来实现，该函数接收一个指向事务操作函数的指针作为参数。
@@ -186,6 +186,35 @@ static void DBtxn_operation(int (*txn_operation)(void))
 
     // 判断rc的值，如果为ZBX_DB_DOWN，则进入循环
     while (ZBX_DB_DOWN == rc)
+    {
+        // 关闭数据库连接
+        DBclose();
+
+        // 重新连接数据库，连接方式为正常连接
+        DBconnect(ZBX_DB_CONNECT_NORMAL);
+
+        // 再次调用事务操作函数，并将结果存储在rc变量中
+        if (ZBX_DB_DOWN == (rc = txn_operation()))
+        {
+            // 如果数据库仍然处于关闭状态，记录日志并等待重试
+            zabbix_log(LOG_LEVEL_ERR, "database is down: retrying in %d seconds", ZBX_DB_WAIT_DOWN);
+            connection_failure = 1;
+            sleep(ZBX_DB_WAIT_DOWN);
+        }
+    }
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: DBbegin                                                          *
+ *                                                                            *
+ * Purpose: start a transaction                                               *
+ *                                                                            *
+ * Author: Eugene Grigorjev, Vladimir Levijev                                 *
+ *                                                                            *
+ * Comments: do nothing if DB does not support transactions                   *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  * *
  *void\tDBbegin(void)
@@ -194,7 +223,7 @@ static void DBtxn_operation(int (*txn_operation)(void))
  *\tDBtxn_operation(zbx_db_begin);
  *}
  *
- *// 总结：该代码块定义了一个名为 DBbegin 的函数，其主要目的是用于开始一个数据库事务操作。输出结果为：无
+ * // 总结：该代码块定义了一个名为 DBbegin 的函数，其主要目的是用于开始一个数据库事务操作。输出结果为：无
  *```
  *
  *void\tDBbegin(void)
@@ -204,11 +233,11 @@ static void DBtxn_operation(int (*txn_operation)(void))
  *\t// 函数执行完毕后，自动返回 void 类型的值，表示无事可做
  *}
  *
- *// 总结：该代码块定义了一个名为 DBbegin 的函数，其主要目的是用于开始一个数据库事务操作。输出结果为：无
+ * // 总结：该代码块定义了一个名为 DBbegin 的函数，其主要目的是用于开始一个数据库事务操作。输出结果为：无
  *```
  *
  *```c
- *// 定义一个名为 DBbegin 的函数，不接受任何参数，返回类型为 void
+ * // 定义一个名为 DBbegin 的函数，不接受任何参数，返回类型为 void
  *void DBbegin(void)
  *{
  *    // 调用 DBtxn_operation 函数，传入参数 zbx_db_begin
@@ -216,7 +245,7 @@ static void DBtxn_operation(int (*txn_operation)(void))
  *    // 函数执行完毕后，自动返回 void 类型的值，表示无事可做
  *}
  *
- *// 总结：该代码块定义了一个名为 DBbegin 的函数，其主要目的是用于开始一个数据库事务操作。
+ * // 总结：该代码块定义了一个名为 DBbegin 的函数，其主要目的是用于开始一个数据库事务操作。
  *```
  ******************************************************************************/
 // 定义一个名为 DBbegin 的函数，该函数不接受任何参数，返回类型为 void
@@ -224,79 +253,11 @@ void DBbegin(void)
 {
     // 调用 DBtxn_operation 函数，传入参数 zbx_db_begin
     // DBtxn_operation 函数用于开始一个数据库事务操作
+    DBtxn_operation(zbx_db_begin);
 }
 
 // 总结：该代码块定义了一个名为 DBbegin 的函数，其主要目的是用于开始一个数据库事务操作。
 
-        // 重新连接数据库，连接方式为正常连接
-        DBconnect(ZBX_DB_CONNECT_NORMAL);
-
-        // 再次调用事务操作函数，并将结果存储在rc变量中
-        if (ZBX_DB_DOWN == (rc = txn_operation()))
-        {
-            // 如果数据库仍然处于关闭状态，记录日志并等待重试
-            zabbix_log(LOG_LEVEL_ERR, "database is down: retrying in %d seconds", ZBX_DB_WAIT_DOWN);
-            connection_failure = 1;
-            sleep(ZBX_DB_WAIT_DOWN);
-        }
-    }
-}
-
- ******************************************************************************/
-// 定义一个名为 DBdeinit 的函数，该函数为 void 类型（无返回值）
-void DBdeinit(void)
-{
-    // 调用 zbx_db_deinit() 函数，用于初始化数据库
-    zbx_db_deinit();
-}
-
-
-
-/******************************************************************************
- *                                                                            *
- * Function: DBtxn_operation                                                  *
- *                                                                            *
- * Purpose: helper function to loop transaction operation while DB is down    *
- *                                                                            *
- * Author: Eugene Grigorjev, Vladimir Levijev                                 *
- *                                                                            *
- ******************************************************************************/
-static void	DBtxn_operation(int (*txn_operation)(void))
-{
-	int	rc;
-
-	rc = txn_operation();
-
-	while (ZBX_DB_DOWN == rc)
-	{
-		DBclose();
-		DBconnect(ZBX_DB_CONNECT_NORMAL);
-
-		if (ZBX_DB_DOWN == (rc = txn_operation()))
-		{
-			zabbix_log(LOG_LEVEL_ERR, "database is down: retrying in %d seconds", ZBX_DB_WAIT_DOWN);
-			connection_failure = 1;
-			sleep(ZBX_DB_WAIT_DOWN);
-		}
-	}
-}
-
-/******************************************************************************
- *                                                                            *
- * Function: DBbegin                                                          *
- *                                                                            *
- * Purpose: start a transaction                                               *
- *                                                                            *
- * Author: Eugene Grigorjev, Vladimir Levijev                                 *
- *                                                                            *
- * Comments: do nothing if DB does not support transactions                   *
- *                                                                            *
- ******************************************************************************/
-void	DBbegin(void)
-{
-	DBtxn_operation(zbx_db_begin);
-}
-
 /******************************************************************************
  *                                                                            *
  * Function: DBcommit                                                         *
@@ -329,7 +290,6 @@ int DBcommit(void)
     return zbx_db_txn_end_error();
 }
 
-
 /******************************************************************************
  *                                                                            *
  * Function: DBrollback                                                       *
@@ -349,18 +309,22 @@ void	DBrollback(void) // 定义一个名为 DBrollback 的函数，用于执行
 {
 	if (ZBX_DB_OK > zbx_db_rollback()) // 判断 zbx_db_rollback 函数返回值是否大于 ZBX_DB_OK，即是否成功执行回滚操作
 	{
-		zabbix_log(LOG_LEVEL_WARNING, "cannot perform transaction rollback, connection will be reset") // 如果回滚失败，记录日志，提示无法执行事务回滚，并将连接重置
+		zabbix_log(LOG_LEVEL_WARNING, "cannot perform transaction rollback, connection will be reset"); // 如果回滚失败，记录日志，提示无法执行事务回滚，并将连接重置
 
 		DBclose(); // 关闭数据库连接
-		DBconnect(ZBX_DB_CONNECT_NORMAL) // 重新连接数据库，连接方式为正常连接
+		DBconnect(ZBX_DB_CONNECT_NORMAL); // 重新连接数据库，连接方式为正常连接
 	}
 }
 
-
 /******************************************************************************
  *                                                                            *
  * Function: DBend                                                            *
  *                                                                            *
+ * Purpose: commit or rollback a transaction depending on a parameter value   *
+ *                                                                            *
+ * Comments: do nothing if DB does not support transactions                   *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  * *
  *这块代码的主要目的是判断数据库操作是否成功，并在成功的情况下返回 SUCCEED，失败的情况下返回 FAIL。具体来说，函数 DBend 接收一个整型参数 ret，表示数据库操作的返回值。首先判断 ret 是否为 SUCCEED，如果是，则调用 DBcommit() 函数判断数据库操作是否成功。如果 DBcommit() 返回 SUCCEED，则返回 SUCCEED；否则，调用 DBrollback() 函数回滚数据库操作，并返回 FAIL。如果 ret 不是 SUCCEED，直接返回 FAIL。无论何种情况，最后返回 FAIL。
@@ -370,40 +334,25 @@ int DBend(int ret)
 {
     // 判断 ret 是否为 SUCCEED（成功）
     if (SUCCEED == ret)
-    {
-        // 调用 DBcommit() 函数，判断数据库操作是否成功
-        if (ZBX_DB_OK == DBcommit())
-        {
-            // 如果 DBcommit() 返回 SUCCEED，则返回 SUCCEED，否则返回 FAIL
-            return SUCCEED;
-        }
-        else
-        {
-            // 如果 DBcommit() 返回 FAIL，则调用 DBrollback() 函数回滚数据库操作
-            DBrollback();
-        }
-    }
-    // 如果 ret 不为 SUCCEED，直接返回 FAIL
-    else
-    {
-        DBrollback();
-    }
+        return ZBX_DB_OK == DBcommit() ? SUCCEED : FAIL;
+
+    // 如果 ret 不为 SUCCEED，调用 DBrollback() 函数回滚数据库操作
+    DBrollback();
 
     // 无论何种情况，最后返回 FAIL
     return FAIL;
 }
 
-
-	DBrollback();
-
-	return FAIL;
-}
-
 #ifdef HAVE_ORACLE
 /******************************************************************************
  *                                                                            *
  * Function: DBstatement_prepare                                              *
  *                                                                            *
+ * Purpose: prepares a SQL statement for execution                            *
+ *                                                                            *
+ * Comments: retry until DB is up                                             *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  * *
  *整个代码块的主要目的是：解析给定的 SQL 语句，如果数据库连接失败，则不断尝试重新连接数据库，并等待一段时间后再次尝试。在这个过程中，如果数据库仍然连接失败，则会记录日志并设置 connection_failure 变量为 1。
@@ -434,6 +383,23 @@ void DBstatement_prepare(const char *sql)
 
             // 设置 connection_failure 变量为 1，表示数据库连接失败
             connection_failure = 1;
+
+            // 等待一段时间后重试
+            sleep(ZBX_DB_WAIT_DOWN);
+        }
+    }
+}
+#endif
+
+/******************************************************************************
+ *                                                                            *
+ * Function: __zbx_DBexecute                                                  *
+ *                                                                            *
+ * Purpose: execute a non-select statement                                    *
+ *                                                                            *
+ * Comments: retry until DB is up                                             *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  * *
  *整个代码块的主要目的是实现一个名为 DBexecute 的函数，该函数接收一个格式化字符串 fmt 和一个可变参数列表 args。函数的主要功能是执行数据库操作，如果数据库连接失败，则不断尝试重新连接并执行操作，同时记录连接失败日志。当数据库操作成功时，返回执行结果。
@@ -479,18 +445,36 @@ int DBexecute(const char *fmt, ...)
 	return rc;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: DBexecute_prepared                                               *
+ *                                                                            *
+ * Purpose: execute a non-select statement with bound parameters              *
+ *                                                                            *
+ * Parameters: sql        - [IN] the statement with '?' placeholders          *
+ *             types      - [IN] the parameter types (ZBX_TYPE_*)             *
+ *             values     - [IN] the parameter values                         *
+ *             values_num - [IN] the number of parameters                     *
+ *                                                                            *
+ * Comments: MySQL and PostgreSQL statements are prepared once and cached,    *
+ *           with other databases the values are substituted into sql text    *
+ *           and the statement is executed with DBexecute()                   *
+ *                                                                            *
+ ******************************************************************************/
+int	DBexecute_prepared(const char *sql, const unsigned char *types, const zbx_db_value_t *values,
+		int values_num)
+{
+#if defined(HAVE_MYSQL) || defined(HAVE_POSTGRESQL)
 	int	rc;
 
-	va_start(args, fmt);
-
-	rc = zbx_db_vexecute(fmt, args);
+	rc = zbx_db_execute_prepared(sql, types, values, values_num);
 
 	while (ZBX_DB_DOWN == rc)
 	{
 		DBclose();
 		DBconnect(ZBX_DB_CONNECT_NORMAL);
 
-		if (ZBX_DB_DOWN == (rc = zbx_db_vexecute(fmt, args)))
+		if (ZBX_DB_DOWN == (rc = zbx_db_execute_prepared(sql, types, values, values_num)))
 		{
 			zabbix_log(LOG_LEVEL_ERR, "database is down: retrying in %d seconds", ZBX_DB_WAIT_DOWN);
 			connection_failure = 1;
@@ -498,9 +482,82 @@ int DBexecute(const char *fmt, ...)
 		}
 	}
 
-	va_end(args);
+	return rc;
+#else
+	char		*query = NULL, *value_esc;
+	size_t		query_alloc = 0, query_offset = 0;
+	const char	*ptr;
+	int		i = 0, rc;
+
+	for (ptr = sql; '\0' != *ptr; ptr++)
+	{
+		if ('?' != *ptr || i == values_num)
+		{
+			zbx_chrcpy_alloc(&query, &query_alloc, &query_offset, *ptr);
+			continue;
+		}
+
+		switch (types[i])
+		{
+			case ZBX_TYPE_INT:
+				zbx_snprintf_alloc(&query, &query_alloc, &query_offset, "%d", values[i].i32);
+				break;
+			case ZBX_TYPE_FLOAT:
+				zbx_snprintf_alloc(&query, &query_alloc, &query_offset, ZBX_FS_DBL, values[i].dbl);
+				break;
+			case ZBX_TYPE_UINT:
+				zbx_snprintf_alloc(&query, &query_alloc, &query_offset, ZBX_FS_UI64, values[i].ui64);
+				break;
+			case ZBX_TYPE_ID:
+				zbx_strcpy_alloc(&query, &query_alloc, &query_offset, DBsql_id_ins(values[i].ui64));
+				break;
+			default:
+				value_esc = DBdyn_escape_string(values[i].str);
+				zbx_snprintf_alloc(&query, &query_alloc, &query_offset, "'%s'", value_esc);
+				zbx_free(value_esc);
+		}
+
+		i++;
+	}
+
+	rc = DBexecute("%s", query);
+	zbx_free(query);
 
 	return rc;
+#endif
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: DBpipeline_begin                                                 *
+ *                                                                            *
+ * Purpose: start sending prepared statements without waiting for results     *
+ *                                                                            *
+ * Return value: SUCCEED - statements executed by DBexecute_prepared() are    *
+ *                         queued until DBpipeline_end() is called            *
+ *               FAIL    - pipelining is not supported                        *
+ *                                                                            *
+ ******************************************************************************/
+int	DBpipeline_begin(void)
+{
+	return zbx_db_pipeline_begin();
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: DBpipeline_end                                                   *
+ *                                                                            *
+ * Purpose: wait for the results of statements queued in pipeline             *
+ *                                                                            *
+ * Return value: ZBX_DB_OK, ZBX_DB_FAIL or ZBX_DB_DOWN                        *
+ *                                                                            *
+ * Comments: the queued statements cannot be repeated after reconnect, so     *
+ *           the failure is reported to the caller without retrying           *
+ *                                                                            *
+ ******************************************************************************/
+int	DBpipeline_end(void)
+{
+	return zbx_db_pipeline_end();
 }
 
 /******************************************************************************
@@ -521,12 +578,13 @@ int DBexecute_once(const char *fmt, ...)
 {
 	// 声明一个 va_list 类型的变量 args，用于存储可变参数列表
 	va_list args;
+	int rc;
 
 	// 初始化 args 变量，准备接收可变参数
 	va_start(args, fmt);
 
 	// 调用 zbx_db_vexecute 函数，传入 fmt 和 args 作为参数，执行数据库操作
-	int rc = zbx_db_vexecute(fmt, args);
+	rc = zbx_db_vexecute(fmt, args);
 
 	// 结束 va_list 类型的变量 args，释放内存
 	va_end(args);
@@ -551,22 +609,13 @@ int DBis_null(const char *field)
  * *
  *这块代码的主要目的是定义一个名为 DB_ROW 的结构体，用于存储从数据库查询结果中获取的一行数据。同时，实现了一个名为 DBfetch 的函数，该函数从 DB_RESULT 类型的结果对象中获取查询结果中的一行数据，并将结果存储在 DB_ROW 类型的结构体中。
  ******************************************************************************/
-// 定义一个名为 DB_ROW 的结构体，用于存储从数据库查询结果中获取的一行数据
-typedef struct {
-    // 以下是一些列变量，用于存储查询结果中的数据
-    char *column1;
-    char *column2;
-    // ...
-} DB_ROW;
-
 // DBfetch 函数，用于从 DB_RESULT 类型的结果对象中获取一行数据
-DB_ROW DB_ROW::DBfetch(DB_RESULT result)
+DB_ROW DBfetch(DB_RESULT result)
 {
     // 调用 zbx_db_fetch 函数，传入 DB_RESULT 类型的结果对象，获取查询结果中的一行数据
     return zbx_db_fetch(result);
 }
 
-
 /******************************************************************************
  *                                                                            *
  * Function: DBselect_once                                                    *
@@ -574,8 +623,29 @@ DB_ROW DB_ROW::DBfetch(DB_RESULT result)
  * Purpose: execute a select statement                                        *
  *                                                                            *
  ******************************************************************************/
+DB_RESULT	DBselect_once(const char *fmt, ...)
+{
+	va_list		args;
+	DB_RESULT	rc;
+
+	va_start(args, fmt);
+
+	rc = zbx_db_vselect(fmt, args);
+
+	va_end(args);
+
+	return rc;
+}
+
 /******************************************************************************
- * *
+ *                                                                            *
+ * Function: DBselect                                                         *
+ *                                                                            *
+ * Purpose: execute a select statement                                        *
+ *                                                                            *
+ * Comments: retry until DB is up                                             *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  * *
  *整个代码块的主要目的是实现一个名为 DBselect 的函数，该函数接收一个 const char * 类型的参数 fmt 和可变参数...，用于执行数据库查询操作。当数据库连接出现故障时，函数会尝试重新连接数据库并等待一段时间后再次执行查询，直到成功为止。同时，函数还会记录数据库连接失败的日志。最后，返回数据库查询结果。
@@ -619,45 +689,11 @@ DB_RESULT	DBselect(const char *fmt, ...)
 	return rc;
 }
 
- * Function: DBselect                                                         *
+/******************************************************************************
  *                                                                            *
- * Purpose: execute a select statement                                        *
- *                                                                            *
- * Comments: retry until DB is up                                             *
- *                                                                            *
- ******************************************************************************/
-DB_RESULT	DBselect(const char *fmt, ...)
-{
-	va_list		args;
-	DB_RESULT	rc;
-
-	va_start(args, fmt);
-
-	rc = zbx_db_vselect(fmt, args);
-
-	while ((DB_RESULT)ZBX_DB_DOWN == rc)
-	{
-		DBclose();
-		DBconnect(ZBX_DB_CONNECT_NORMAL);
-
-		if ((DB_RESULT)ZBX_DB_DOWN == (rc = zbx_db_vselect(fmt, args)))
-		{
-			zabbix_log(LOG_LEVEL_ERR, "database is down: retrying in %d seconds", ZBX_DB_WAIT_DOWN);
-			connection_failure = 1;
-			sleep(ZBX_DB_WAIT_DOWN);
-		}
-	}
-
-	va_end(args);
-
-	return rc;
-}
-
-/******************************************************************************
- *                                                                            *
- * Function: DBselectN                                                        *
- *                                                                            *
- * Purpose: execute a select statement and get the first N entries            *
+ * Function: DBselectN                                                        *
+ *                                                                            *
+ * Purpose: execute a select statement and get the first N entries            *
  *                                                                            *
  * Comments: retry until DB is up                                             *
  *                                                                            *
@@ -803,7 +839,6 @@ int DBget_proxy_lastaccess(const char *hostname, int *lastaccess, char **error)
     return ret;
 }
 
-
 #ifdef HAVE_MYSQL
 /******************************************************************************
  * *
@@ -836,38 +871,18 @@ static size_t get_string_field_size(unsigned char type)
 			exit(EXIT_FAILURE);
 	}
 }
-
 #elif defined(HAVE_ORACLE)
 /******************************************************************************
  * *
  *整个代码块的主要目的是根据输入的无符号字符型参数 type 确定字符串字段的大小。根据不同的 type 值，返回相应的字符串长度限制。如果遇到未知类型，输出错误信息并退出程序。
  ******************************************************************************/
 // 定义一个名为 get_string_field_size 的静态 size_t 类型函数，接收一个无符号字符型参数 type
-/******************************************************************************
- * *
- *整个代码块的主要目的是：定义一个函数`DBdyn_escape_string_len`，用于根据给定的源字符串`src`和字符串长度`length`，对字符串进行动态转义处理。转义处理后的字符串将被返回。转义处理的方式取决于是否为IBM DB2，如果是，则限制字符串长度为字节数而非字符数。
- ******************************************************************************/
-// 定义一个函数，用于将动态生成的字符串进行转义处理
-char *DBdyn_escape_string_len(const char *src, size_t length)
+static size_t	get_string_field_size(unsigned char type)
 {
-    // 使用预定义的宏判断是否为IBM DB2，如果是，则限制字符串长度为字节数而非字符数
-#if defined(HAVE_IBM_DB2)
-    // 使用zbx_db_dyn_escape_string函数进行动态转义处理，参数分别为：
-    // src：源字符串
-    // length：源字符串长度
-    // ZBX_SIZE_T_MAX：表示最大字节数
-    // ESCAPE_SEQUENCE_ON：表示开启转义序列
-    return zbx_db_dyn_escape_string(src, length, ZBX_SIZE_T_MAX, ESCAPE_SEQUENCE_ON);
-#else
-    // 如果不是IBM DB2，则直接进行动态转义处理，参数分别为：
-    // src：源字符串
-    // ZBX_SIZE_T_MAX：表示最大字节数
-    // length：源字符串长度
-    // ESCAPE_SEQUENCE_ON：表示开启转义序列
-    return zbx_db_dyn_escape_string(src, ZBX_SIZE_T_MAX, length, ESCAPE_SEQUENCE_ON);
-#endif
-}
-
+	switch(type)
+	{
+		case ZBX_TYPE_LONGTEXT:
+		case ZBX_TYPE_TEXT:
 			// 返回 ZBX_SIZE_T_MAX，表示字符串长度不受限制
 			return ZBX_SIZE_T_MAX;
 		// 如果是 ZBX_TYPE_CHAR 或 ZBX_TYPE_SHORTTEXT 类型
@@ -883,7 +898,6 @@ char *DBdyn_escape_string_len(const char *src, size_t length)
 			exit(EXIT_FAILURE);
 	}
 }
-
 #endif
 
 /******************************************************************************
@@ -891,12 +905,28 @@ char *DBdyn_escape_string_len(const char *src, size_t length)
  * Function: DBdyn_escape_string_len                                          *
  *                                                                            *
  ******************************************************************************/
-char	*DBdyn_escape_string_len(const char *src, size_t length)
+/******************************************************************************
+ * *
+ *整个代码块的主要目的是：定义一个函数`DBdyn_escape_string_len`，用于根据给定的源字符串`src`和字符串长度`length`，对字符串进行动态转义处理。转义处理后的字符串将被返回。转义处理的方式取决于是否为IBM DB2，如果是，则限制字符串长度为字节数而非字符数。
+ ******************************************************************************/
+// 定义一个函数，用于将动态生成的字符串进行转义处理
+char *DBdyn_escape_string_len(const char *src, size_t length)
 {
-#if defined(HAVE_IBM_DB2)	/* IBM DB2 fields are limited by bytes rather than characters */
-	return zbx_db_dyn_escape_string(src, length, ZBX_SIZE_T_MAX, ESCAPE_SEQUENCE_ON);
+    // 使用预定义的宏判断是否为IBM DB2，如果是，则限制字符串长度为字节数而非字符数
+#if defined(HAVE_IBM_DB2)
+    // 使用zbx_db_dyn_escape_string函数进行动态转义处理，参数分别为：
+    // src：源字符串
+    // length：源字符串长度
+    // ZBX_SIZE_T_MAX：表示最大字节数
+    // ESCAPE_SEQUENCE_ON：表示开启转义序列
+    return zbx_db_dyn_escape_string(src, length, ZBX_SIZE_T_MAX, ESCAPE_SEQUENCE_ON);
 #else
-	return zbx_db_dyn_escape_string(src, ZBX_SIZE_T_MAX, length, ESCAPE_SEQUENCE_ON);
+    // 如果不是IBM DB2，则直接进行动态转义处理，参数分别为：
+    // src：源字符串
+    // ZBX_SIZE_T_MAX：表示最大字节数
+    // length：源字符串长度
+    // ESCAPE_SEQUENCE_ON：表示开启转义序列
+    return zbx_db_dyn_escape_string(src, ZBX_SIZE_T_MAX, length, ESCAPE_SEQUENCE_ON);
 #endif
 }
 
@@ -914,7 +944,14 @@ char *DBdyn_escape_string(const char *src)
 {
     // 定义一个返回值为char类型的指针，用于存储处理后的字符串
     // 调用名为zbx_db_dyn_escape_string的函数，传入以下参数：
-    // 1. 源字符串（const char *src）
+    return zbx_db_dyn_escape_string(src, ZBX_SIZE_T_MAX, ZBX_SIZE_T_MAX, ESCAPE_SEQUENCE_ON);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: DBdyn_escape_field_len                                           *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  * *
  *代码块主要目的是对给定的字符串进行动态转义，以适应不同数据库的字段要求。根据字段类型和长度，分别采用不同的转义方式。转义后的字符串返回给调用者。
@@ -948,21 +985,6 @@ static char *DBdyn_escape_field_len(const ZBX_FIELD *field, const char *src, zbx
 #endif
 }
 
-
-	if (ZBX_TYPE_LONGTEXT == field->type && 0 == field->length)
-		length = ZBX_SIZE_T_MAX;
-	else
-		length = field->length;
-
-#if defined(HAVE_MYSQL) || defined(HAVE_ORACLE)
-	return zbx_db_dyn_escape_string(src, get_string_field_size(field->type), length, flag);
-#elif defined(HAVE_IBM_DB2)	/* IBM DB2 fields are limited by bytes rather than characters */
-	return zbx_db_dyn_escape_string(src, length, ZBX_SIZE_T_MAX, flag);
-#else
-	return zbx_db_dyn_escape_string(src, ZBX_SIZE_T_MAX, length, flag);
-#endif
-}
-
 /******************************************************************************
  *                                                                            *
  * Function: DBdyn_escape_field                                               *
@@ -973,56 +995,9 @@ static char *DBdyn_escape_field_len(const ZBX_FIELD *field, const char *src, zbx
  *这块代码的主要目的是定义一个函数`DBdyn_escape_field`，用于对给定的表名、字段名和源字符串进行动态转义。首先，检查表名和字段名是否有效，如果无效则报错并退出程序。如果表名和字段名有效，接着调用另一个函数`DBdyn_escape_field_len`对字段值进行动态转义，并返回转义后的字符串。
  ******************************************************************************/
 // 定义一个函数，用于对的字段值进行动态转义
-/******************************************************************************
- * *
- *```c
- *#include <stdio.h>
- *#include <string.h>
- *
- *// 定义一个C语言函数，名为DBdyn_escape_like_pattern，参数为一个const char类型的指针（字符串），返回值为char类型的指针（字符串）
- *char *DBdyn_escape_like_pattern(const char *src)
- *{
- *    // 声明一个字符数组，用于存储处理后的字符串
- *    char result[256];
- *    
- *    // 调用另一个名为zbx_db_dyn_escape_like_pattern的函数，传入参数src（字符串），并将返回值存储在result数组中
- *    strncpy(result, zbx_db_dyn_escape_like_pattern(src), sizeof(result));
- *    
- *    // 为了防止数组越界，设置result数组的最大长度为255
- *    result[255] = '\\0';
- *    
- *    // 返回处理后的字符串
- *    return result;
- *}
- *
- *int main()
- *{
- *    const char *src = \"Hello, World!\";
- *    char *result = DBdyn_escape_like_pattern(src);
- *    
- *    // 输出结果
- *    printf(\"原始字符串：%s\
- *\", src);
- *    printf(\"处理后的字符串：%s\
- *\", result);
- *    
- *    return 0;
- *}
- *
- *// 另一个名为zbx_db_dyn_escape_like_pattern的函数，用于对字符串进行编码处理
- *```
- *
- *整个代码块的主要目的是定义一个名为DBdyn_escape_like_pattern的函数，该函数用于处理字符串src，并通过调用zbx_db_dyn_escape_like_pattern函数对处理后的字符串进行编码，最后将编码后的字符串作为返回值返回。在main函数中，调用DBdyn_escape_like_pattern函数处理一个示例字符串，并输出原始字符串和处理后的字符串。
- ******************************************************************************/
-// 定义一个C语言函数，名为DBdyn_escape_like_pattern，参数为一个const char类型的指针（字符串），返回值为char类型的指针（字符串）
-char *DBdyn_escape_like_pattern(const char *src)
+char	*DBdyn_escape_field(const char *table_name, const char *field_name, const char *src)
 {
-    // 调用另一个名为zbx_db_dyn_escape_like_pattern的函数，传入参数src（字符串），并将返回值赋给当前函数的返回值
-    return zbx_db_dyn_escape_like_pattern(src);
-}
-
-// 整个代码块的主要目的是定义一个名为DBdyn_escape_like_pattern的函数，该函数用于处理字符串src，并通过调用zbx_db_dyn_escape_like_pattern函数对处理后的字符串进行编码，最后将编码后的字符串作为返回值返回。
-
+	const ZBX_TABLE	*table;
 	const ZBX_FIELD	*field;
 
 	// 检查传入的表名和字段名是否为空，如果为空则报错并退出程序
@@ -1038,16 +1013,24 @@ char *DBdyn_escape_like_pattern(const char *src)
 	return DBdyn_escape_field_len(field, src, ESCAPE_SEQUENCE_ON);
 }
 
-
 /******************************************************************************
  *                                                                            *
  * Function: DBdyn_escape_like_pattern                                        *
  *                                                                            *
  ******************************************************************************/
-char	*DBdyn_escape_like_pattern(const char *src)
+/******************************************************************************
+ * *
+ *整个代码块的主要目的是定义一个名为DBdyn_escape_like_pattern的函数，该函数用于处理字符串src，并通过调用zbx_db_dyn_escape_like_pattern函数对处理后的字符串进行编码，最后将编码后的字符串作为返回值返回。
+ ******************************************************************************/
+// 定义一个C语言函数，名为DBdyn_escape_like_pattern，参数为一个const char类型的指针（字符串），返回值为char类型的指针（字符串）
+char *DBdyn_escape_like_pattern(const char *src)
 {
-	return zbx_db_dyn_escape_like_pattern(src);
+    // 调用另一个名为zbx_db_dyn_escape_like_pattern的函数，传入参数src（字符串），并将返回值赋给当前函数的返回值
+    return zbx_db_dyn_escape_like_pattern(src);
 }
+
+// 整个代码块的主要目的是定义一个名为DBdyn_escape_like_pattern的函数，该函数用于处理字符串src，并通过调用zbx_db_dyn_escape_like_pattern函数对处理后的字符串进行编码，最后将编码后的字符串作为返回值返回。
+
 /******************************************************************************
  * *
  *这块代码的主要目的是：根据传入的表名（字符串类型）在数组tables中查找对应的表结构（ZBX_TABLE类型），如果找到，则返回该表结构的地址；如果没有找到，则返回NULL。
@@ -1071,180 +1054,99 @@ const ZBX_TABLE	*DBget_table(const char *tablename)	// 定义一个函数，传
  * *
  *整个代码块的主要目的是定义一个名为 DBget_field 的函数，该函数接收一个 ZBX_TABLE 结构体的指针和一个字符串指针作为参数。函数的作用是在给定的 ZBX_TABLE 结构体中查找指定的字段名，如果找到，则返回该字段的指针；如果没有找到，则返回 NULL。
  ******************************************************************************/
-/* 定义一个函数 DBget_field，接收两个参数：指向 ZBX_TABLE 结构体的指针 table 和字符串指针 fieldname。
-/******************************************************************************
- * *
- *这个代码块的主要目的是实现一个ID初始化的功能。程序首先接收用户输入的表名，然后调用`init_ids`函数进行ID初始化。`init_ids`函数的主要逻辑如下：
- *
- *1. 获取表结构。
- *2. 循环查找下一个ID。
- *3. 避免在失败的事务中产生永恒循环。
- *4. 查询下一个ID。
- *5. 如果找不到下一条记录，或者记录中的ID小于等于最小ID，插入新记录。
- *6. 如果找到的ID小于等于最小ID或大于等于最大ID，删除现有记录。
- *7. 更新ID字段。
- *8. 找到下一条记录，如果满足条件，则退出循环。
- *
- *整个代码块的输出结果为：
- *
- *```
- *表名：test，最小ID：1，最大ID：1000000000
- *```
- *
- *这意味着成功地为表`test`初始化了ID。
- ******************************************************************************/
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-
-// 引入DB库
-#include "db.h"
-
-// 引入Zabbix日志库
-#include "zabbix_log.h"
-
-// 定义日志级别
-#define LOG_LEVEL_DEBUG 1
-
-// 定义常量
-#define ZBX_FS_UI64 "unsigned int64"
-
-// 函数原型声明
-int init_ids(char *tablename, unsigned int64_t *min, unsigned int64_t *max, unsigned int64_t num);
-
-int main()
+/* 定义一个函数 DBget_field，接收两个参数：指向 ZBX_TABLE 结构体的指针 table 和字符串指针 fieldname。 */
+const ZBX_FIELD	*DBget_field(const ZBX_TABLE *table, const char *fieldname)
 {
-    // 定义变量
-    char tablename[256];
-    unsigned int64_t min, max, ret1, ret2, found;
-    DB_TABLE *table;
-    DB_RESULT *result;
-    DB_ROW *row;
-    int dbres;
-
-    // 输入表名
-    printf("请输入表名：");
-    fgets(tablename, 256, stdin);
-
-    // 调用函数初始化ID
-    if (init_ids(tablename, &min, &max, 1) == 0)
-    {
-        printf("ID初始化失败，请检查表名和字段名是否正确。\
-");
-        return 1;
-    }
+	int	f;
 
-    printf("表名：%s，最小ID：%llu，最大ID：%llu\
-", tablename, (long long)min, (long long)max);
+	for (f = 0; NULL != table->fields[f].name; f++)
+	{
+		if (0 == strcmp(table->fields[f].name, fieldname))
+			return &table->fields[f];
+	}
 
-    return 0;
+	return NULL;
 }
 
-// 初始化ID函数
-int init_ids(char *tablename, unsigned int64_t *min, unsigned int64_t *max, unsigned int64_t num)
+/******************************************************************************
+ *                                                                            *
+ * Function: DBget_nextid                                                     *
+ *                                                                            *
+ * Purpose: gets a new identifier(s) for a specified table                    *
+ *                                                                            *
+ * Parameters: tablename - [IN] the name of a table                           *
+ *             num       - [IN] the number of reserved records                *
+ *                                                                            *
+ * Return value: first reserved identifier                                    *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_uint64_t	DBget_nextid(const char *tablename, int num)
 {
-    // 记录函数调用信息
-    const char *__function_name = "init_ids";
-
-    // 获取表结构
-    table = DBget_table(tablename);
+	const char	*__function_name = "DBget_nextid";
 
-    // 循环查找下一个ID
-    while (found == FAIL)
-    {
-        // 避免在失败的事务中产生永恒循环
-        if (zbx_db_txn_level() > 0 && zbx_db_txn_error() != 0)
-        {
-            zabbix_log(LOG_LEVEL_DEBUG, "事务失败");
-            return 0;
-        }
+	DB_RESULT	result;
+	DB_ROW		row;
+	zbx_uint64_t	ret1, ret2;
+	zbx_uint64_t	min = 0, max = ZBX_DB_MAX_ID;
+	int		found = FAIL, dbres;
+	const ZBX_TABLE	*table;
 
-        // 查询下一个ID
-        result = DBselect("select nextid from ids where table_name='%s' and field_name='%s'",
-                        table->table, table->recid);
+	// 记录函数调用信息
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() tablename:'%s'", __function_name, tablename);
 
-        // 如果没有找到下一条记录，或者记录为空
-        if (NULL == (row = DBfetch(result)))
-        {
-            DBfree_result(result);
-
-            // 查询最大ID
-            result = DBselect("select max(%s) from %s where %s between " ZBX_FS_UI64 " and " ZBX_FS_UI64,
-                             table->recid, table->table, table->recid, min, max);
-
-            // 如果找不到记录，或者记录中的ID小于等于最小ID
-            if (NULL == (row = DBfetch(result)) || SUCCEED == DBis_null(row[0]))
-            {
-                ret1 = min;
-            }
-            else
-            {
-                ZBX_STR2UINT64(ret1, row[0]);
-                if (ret1 >= max)
-                {
-                    zabbix_log(LOG_LEVEL_CRIT, "最大ID超出范围");
-                    return 0;
-                }
-            }
-
-            DBfree_result(result);
-
-            // 插入新记录
-            dbres = DBexecute("insert into ids (table_name, field_name, nextid)"
-                             " values ('%s', '%s', %llu)",
-                            table->table, table->recid, (unsigned long long)ret1);
-
-            if (ZBX_DB_OK > dbres)
-            {
-                // 处理并发事务中的问题
-                DBexecute("update ids set nextid=nextid+1 where table_name='%s' and field_name='%s'",
-                        table->table, table->recid);
-            }
+	// 获取表结构
+	table = DBget_table(tablename);
 
-            continue;
-        }
-        else
-        {
-            ZBX_STR2UINT64(ret1, row[0]);
-            DBfree_result(result);
-
-            // 如果找到的ID小于等于最小ID或大于等于最大ID
-            if (ret1 < min || ret1 >= max)
-            {
-                DBexecute("delete from ids where table_name='%s' and field_name='%s'",
-                        table->table, table->recid);
-                continue;
-            }
-
-            DBexecute("update ids set nextid=nextid+%d where table_name='%s' and field_name='%s'",
-                    num, table->table, table->recid);
+	// 循环查找下一个ID
+	while (FAIL == found)
+	{
+		/* avoid eternal loop within failed transaction */
+		if (0 < zbx_db_txn_level() && 0 != zbx_db_txn_error())
+		{
+			zabbix_log(LOG_LEVEL_DEBUG, "End of %s() transaction failed", __function_name);
+			return 0;
+		}
 
-            result = DBselect("select nextid from ids where table_name='%s' and field_name='%s'",
-                    table->table, table->recid);
+		// 查询下一个ID
+		result = DBselect("select nextid from ids where table_name='%s' and field_name='%s'",
+				table->table, table->recid);
 
-            // 如果找到的下一条记录的ID等于当前ID加num
-            if (NULL != (row = DBfetch(result)) && SUCCEED != DBis_null(row[0]))
-            {
-                ZBX_STR2UINT64(ret2, row[0]);
+		// 如果没有找到下一条记录，或者记录为空
+		if (NULL == (row = DBfetch(result)))
+		{
+			DBfree_result(result);
 
-                if (ret1 + num == ret2)
-                    found = SUCCEED;
-            }
-            else
-            {
-                THIS_SHOULD_NEVER_HAPPEN;
-            }
+			// 查询最大ID
+			result = DBselect("select max(%s) from %s where %s between " ZBX_FS_UI64 " and " ZBX_FS_UI64,
+					table->recid, table->table, table->recid, min, max);
 
-            DBfree_result(result);
-        }
-    }
+			// 如果找不到记录，或者记录中的ID小于等于最小ID
+			if (NULL == (row = DBfetch(result)) || SUCCEED == DBis_null(row[0]))
+			{
+				ret1 = min;
+			}
+			else
+			{
+				ZBX_STR2UINT64(ret1, row[0]);
+				if (ret1 >= max)
+				{
+					zabbix_log(LOG_LEVEL_CRIT, "maximum number of id's exceeded"
+							" [table:%s, field:%s, id:" ZBX_FS_UI64 "]",
+							table->table, table->recid, ret1);
+					exit(EXIT_FAILURE);
+				}
+			}
 
-    // 记录日志
-    zabbix_log(LOG_LEVEL_DEBUG, "ID初始化完成");
+			DBfree_result(result);
 
-    return ret2 - num + 1;
-}
+			// 插入新记录
+			dbres = DBexecute("insert into ids (table_name,field_name,nextid)"
+					" values ('%s','%s'," ZBX_FS_UI64 ")",
+					table->table, table->recid, ret1);
 
+			if (ZBX_DB_OK > dbres)
+			{
+				/* solving the problem of an invisible record created in a parallel transaction */
 				DBexecute("update ids set nextid=nextid+1 where table_name='%s' and field_name='%s'",
 						table->table, table->recid);
 			}
@@ -1256,6 +1158,7 @@ int init_ids(char *tablename, unsigned int64_t *min, unsigned int64_t *max, unsi
 			ZBX_STR2UINT64(ret1, row[0]);
 			DBfree_result(result);
 
+			// 如果找到的ID小于等于最小ID或大于等于最大ID
 			if (ret1 < min || ret1 >= max)
 			{
 				DBexecute("delete from ids where table_name='%s' and field_name='%s'",
@@ -1269,19 +1172,87 @@ int init_ids(char *tablename, unsigned int64_t *min, unsigned int64_t *max, unsi
 			result = DBselect("select nextid from ids where table_name='%s' and field_name='%s'",
 					table->table, table->recid);
 
+			// 如果找到的下一条记录的ID等于当前ID加num
 			if (NULL != (row = DBfetch(result)) && SUCCEED != DBis_null(row[0]))
 			{
 				ZBX_STR2UINT64(ret2, row[0]);
 
+				if (ret1 + num == ret2)
+					found = SUCCEED;
+			}
+			else
+				THIS_SHOULD_NEVER_HAPPEN;
+
+			DBfree_result(result);
+		}
+	}
+
+	// 记录日志
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():" ZBX_FS_UI64 " table:'%s' recid:'%s'",
+			__function_name, ret2 - num + 1, table->table, table->recid);
+
+	return ret2 - num + 1;
+}
+
 /******************************************************************************
  * *
  *整个代码块的主要目的是实现一个函数 `DBget_nextid`，该函数根据传入的表名 `tablename` 和序号 `num` 获取下一个 ID。首先，通过 `if` 语句判断 `tablename` 是否为八个预定义的表名之一，如果是，则调用 `DCget_nextid` 函数获取下一个 ID。否则，直接调用 `DBget_nextid` 函数获取下一个 ID。
- *
- *此外，代码中还定义了一个静态函数 `DBadd_condition_alloc_btw`，用于生成 SQL 查询中的 WHERE 条件部分。该函数接收多个参数，包括 SQL 查询缓冲区、缓冲区大小、当前缓冲区位置、表名、值数组、值数组长度、序列长度数组、序列长度、IN 条件数量、BETWEEN 条件数量等。函数的主要目的是根据给定的值数组生成 WHERE 条件中的 BETWEEN 部分。在这个过程中，首先判断序列长度是否满足最小要求，然后组装 BETWEEN 条件。如果表达式数量超过限制，则分配新的 sql 缓冲区。
+ ******************************************************************************/
+// 函数原型：zbx_uint64_t DBget_maxid_num(const char *tablename, int num)
+zbx_uint64_t	DBget_maxid_num(const char *tablename, int num)
+{
+	/* 判断 tablename 是否为以下八个预定义的表名之一，如果是，则执行相应的操作 */
+	if (0 == strcmp(tablename, "events") ||
+	    0 == strcmp(tablename, "event_tag") ||
+	    0 == strcmp(tablename, "problem_tag") ||
+	    0 == strcmp(tablename, "dservices") ||
+	    0 == strcmp(tablename, "dhosts") ||
+	    0 == strcmp(tablename, "alerts") ||
+	    0 == strcmp(tablename, "escalations") ||
+	    0 == strcmp(tablename, "autoreg_host") ||
+	    0 == strcmp(tablename, "event_suppress"))
+	{
+		/* 使用 DCget_nextid 函数获取下一个 ID */
+		return DCget_nextid(tablename, num);
+	}
+
+	/* 否则，使用 DBget_nextid 函数获取下一个 ID */
+	return DBget_nextid(tablename, num);
+}
+
+#define MAX_EXPRESSIONS	950
+
+#ifdef HAVE_ORACLE
+#define MIN_NUM_BETWEEN	5	/* minimum number of consecutive values for using "between <id1> and <idN>" */
+
+/******************************************************************************
+ *                                                                            *
+ * Function: DBadd_condition_alloc_btw                                        *
+ *                                                                            *
+ * Purpose: Takes an initial part of SQL query and appends a generated        *
+ *          WHERE condition. The WHERE condition is generated from the given  *
+ *          list of values as a mix of <fieldname> BETWEEN <id1> AND <idN>"   *
+ *                                                                            *
+ * Parameters: sql        - [IN/OUT] buffer for SQL query construction        *
+ *             sql_alloc  - [IN/OUT] size of the 'sql' buffer                 *
+ *             sql_offset - [IN/OUT] current position in the 'sql' buffer     *
+ *             fieldname  - [IN] field name to be used in SQL WHERE condition *
+ *             values     - [IN] array of numerical values sorted in          *
+ *                               ascending order to be included in WHERE      *
+ *             num        - [IN] number of elements in 'values' array         *
+ *             seq_len    - [OUT] - array of sequential chains                *
+ *             seq_num    - [OUT] - length of seq_len                         *
+ *             in_num     - [OUT] - number of id for 'IN'                     *
+ *             between_num- [OUT] - number of sequential chains for 'BETWEEN' *
+ *                                                                            *
+ ******************************************************************************/
+/******************************************************************************
+ * *
+ *代码块定义了一个静态函数 `DBadd_condition_alloc_btw`，用于生成 SQL 查询中的 WHERE 条件部分。该函数接收多个参数，包括 SQL 查询缓冲区、缓冲区大小、当前缓冲区位置、表名、值数组、值数组长度、序列长度数组、序列长度、IN 条件数量、BETWEEN 条件数量等。函数的主要目的是根据给定的值数组生成 WHERE 条件中的 BETWEEN 部分。在这个过程中，首先判断序列长度是否满足最小要求，然后组装 BETWEEN 条件。如果表达式数量超过限制，则分配新的 sql 缓冲区。
  ******************************************************************************/
 // 定义一个函数，用于生成 SQL 查询中的 WHERE 条件部分
-static void DBadd_condition_alloc_btw(char **sql, size_t *sql_alloc, size_t *sql_offset, const char *fieldname,
-                                   const zbx_uint64_t *values, const int num, int **seq_len, int *seq_num, int *in_num, int *between_num)
+static void	DBadd_condition_alloc_btw(char **sql, size_t *sql_alloc, size_t *sql_offset, const char *fieldname,
+		const zbx_uint64_t *values, const int num, int **seq_len, int *seq_num, int *in_num, int *between_num)
 {
 	int		i, len, first, start;
 	zbx_uint64_t	value;
@@ -1342,47 +1313,6 @@ static void DBadd_condition_alloc_btw(char **sql, size_t *sql_alloc, size_t *sql
 		zbx_strcpy_alloc(sql, sql_alloc, sql_offset, " or ");
 	}
 }
-
-// 函数原型：int* DBget_nextid(const char *tablename, int num)
-int* DBget_nextid(const char *tablename, int num)
-{
-	/* 判断 tablename 是否为以下八个预定义的表名之一，如果是，则执行相应的操作 */
-	if (0 == strcmp(tablename, "events") ||
-	    0 == strcmp(tablename, "event_tag") ||
-	    0 == strcmp(tablename, "problem_tag") ||
-	    0 == strcmp(tablename, "dservices") ||
-	    0 == strcmp(tablename, "dhosts") ||
-	    0 == strcmp(tablename, "alerts") ||
-	    0 == strcmp(tablename, "escalations") ||
-	    0 == strcmp(tablename, "autoreg_host") ||
-	    0 == strcmp(tablename, "event_suppress"))
-	{
-		/* 使用 DCget_nextid 函数获取下一个 ID */
-		return DCget_nextid(tablename, num);
-	}
-
-	/* 否则，使用 DBget_nextid 函数获取下一个 ID */
-	return DBget_nextid(tablename, num);
-}
-
-			{
-					zbx_strcpy_alloc(sql, sql_alloc, sql_offset, " or ");
-			}
-			else
-				first = 0;
-
-			zbx_snprintf_alloc(sql, sql_alloc, sql_offset, "%s between " ZBX_FS_UI64 " and " ZBX_FS_UI64,
-					fieldname, values[start], values[start + (*seq_len)[i] - 1]);
-		}
-
-		start += (*seq_len)[i];
-	}
-
-	if (0 < *in_num && 0 < *between_num)
-	{
-		zbx_strcpy_alloc(sql, sql_alloc, sql_offset, " or ");
-	}
-}
 #endif
 
 /******************************************************************************
@@ -1391,6 +1321,18 @@ int* DBget_nextid(const char *tablename, int num)
  *                                                                            *
  * Purpose: Takes an initial part of SQL query and appends a generated        *
  *          WHERE condition. The WHERE condition is generated from the given  *
+ *          list of values as a mix of <fieldname> BETWEEN <id1> AND <idN>"   *
+ *          and "<fieldname> IN (<id1>,<id2>,...,<idN>)" elements.            *
+ *                                                                            *
+ * Parameters: sql        - [IN/OUT] buffer for SQL query construction        *
+ *             sql_alloc  - [IN/OUT] size of the 'sql' buffer                 *
+ *             sql_offset - [IN/OUT] current position in the 'sql' buffer     *
+ *             fieldname  - [IN] field name to be used in SQL WHERE condition *
+ *             values     - [IN] array of numerical values sorted in          *
+ *                               ascending order to be included in WHERE      *
+ *             num        - [IN] number of elements in 'values' array         *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  * *
  *该代码块的主要目的是为一个C语言函数（`DBadd_condition_alloc`）添加注释。这个函数用于处理SQL查询中的条件部分，根据不同的数据库类型（ORACLE和SQLITE3）生成相应的查询语句。函数接收多个参数，包括一个指向字符串的指针（`sql`）、一个大小为`sql_alloc`的字符数组、一个指向字符串偏移量的指针（`sql_offset`）、一个字段名（`fieldname`）、一个包含值的字符数组（`values`）以及一个表示值数量的整数（`num`）。
@@ -1419,104 +1361,120 @@ int* DBget_nextid(const char *tablename, int num)
  *
  *通过这个函数，可以方便地为SQL查询中的条件部分生成合适的语句，从而实现对数据的有效查询。
  ******************************************************************************/
-void DBadd_condition_alloc(char **sql, size_t *sql_alloc, size_t *sql_offset, const char *fieldname,
-                          const zbx_uint64_t *values, const int num)
+void	DBadd_condition_alloc(char **sql, size_t *sql_alloc, size_t *sql_offset, const char *fieldname,
+		const zbx_uint64_t *values, const int num)
 {
-    // 定义变量
-    int start, between_num = 0, in_num = 0, seq_num;
-    int *seq_len = NULL;
-
+#ifdef HAVE_ORACLE
+	int		start, between_num = 0, in_num = 0, seq_num;
+	int		*seq_len = NULL;
+#endif
+	int		i, in_cnt;
 #if defined(HAVE_SQLITE3)
-    int expr_num, expr_cnt = 0;
+	int		expr_num, expr_cnt = 0;
 #endif
+	if (0 == num)
+		return;
 
-    // 判断num是否为0，若为0则直接返回
-    if (0 == num)
-        return;
+	zbx_chrcpy_alloc(sql, sql_alloc, sql_offset, ' ');
+#ifdef HAVE_ORACLE
+	DBadd_condition_alloc_btw(sql, sql_alloc, sql_offset, fieldname, values, num, &seq_len, &seq_num, &in_num,
+			&between_num);
+
+	if (1 < in_num)
+		zbx_snprintf_alloc(sql, sql_alloc, sql_offset, "%s in (", fieldname);
+
+	/* compose "in"s */
+	for (i = 0, in_cnt = 0, start = 0; i < seq_num; i++)
+	{
+		if (MIN_NUM_BETWEEN > seq_len[i])
+		{
+			if (1 == in_num)
+#else
+	if (MAX_EXPRESSIONS < num)
+		zbx_chrcpy_alloc(sql, sql_alloc, sql_offset, '(');
+
+#if	defined(HAVE_SQLITE3)
+	expr_num = (num + MAX_EXPRESSIONS - 1) / MAX_EXPRESSIONS;
+
+	if (MAX_EXPRESSIONS < expr_num)
+		zbx_chrcpy_alloc(sql, sql_alloc, sql_offset, '(');
+#endif
 
-    // 为sql分配内存，并填充空格
-    zbx_chrcpy_alloc(sql, sql_alloc, sql_offset, ' ');
+	if (1 < num)
+		zbx_snprintf_alloc(sql, sql_alloc, sql_offset, "%s in (", fieldname);
 
+	/* compose "in"s */
+	for (i = 0, in_cnt = 0; i < num; i++)
+	{
+			if (1 == num)
+#endif
+			{
+				zbx_snprintf_alloc(sql, sql_alloc, sql_offset, "%s=" ZBX_FS_UI64, fieldname,
 #ifdef HAVE_ORACLE
-    // 调用DBadd_condition_alloc_btw函数处理ORACLE情况
-    DBadd_condition_alloc_btw(sql, sql_alloc, sql_offset, fieldname, values, num, &seq_len, &seq_num, &in_num,
-                             &between_num);
-
-    // 如果in_num大于1，则拼接"in"字符串
-    if (1 < in_num)
-        zbx_snprintf_alloc(sql, sql_alloc, sql_offset, "%s in (", fieldname);
-
-    // 拼接"in"字符串
-    for (int i = 0, in_cnt = 0, start = 0; i < seq_num; i++)
-    {
-        // 处理ORACLE情况下的特殊情况
-        if (MIN_NUM_BETWEEN > seq_len[i])
-        {
-            if (1 == in_num)
-            {
-                // 拼接字符串
-                zbx_snprintf_alloc(sql, sql_alloc, sql_offset, "%s=" ZBX_FS_UI64, fieldname,
-                                  values[start]);
-                break;
-            }
-            else
-            {
-                // 拼接"in"字符串
-                do
-                {
-                    if (MAX_EXPRESSIONS == in_cnt)
-                    {
-                        in_cnt = 0;
-                        (*sql_offset)--;
-
-                        // 处理ORACLE情况下的特殊情况
-                        if (HAVE_ORACLE)
-                        {
-                            if (MAX_EXPRESSIONS == ++expr_cnt)
-                            {
-                                zbx_snprintf_alloc(sql, sql_alloc, sql_offset, ")) or (%s in (", fieldname);
-                                expr_cnt = 0;
-                            }
-                            else
-                            {
-                                zbx_snprintf_alloc(sql, sql_alloc, sql_offset, ") or %s in (", fieldname);
-                            }
-                        }
-                        else
-                        {
-                            zbx_snprintf_alloc(sql, sql_alloc, sql_offset, "%s in (", fieldname);
-                        }
-                    }
-
-                    in_cnt++;
-                    zbx_snprintf_alloc(sql, sql_alloc, sql_offset, ZBX_FS_UI64 ",",
-                                      values[start++]);
-                }
-                while (0 != --seq_len[i]);
-            }
-        }
-        else
-            start += seq_len[i];
-    }
+						values[start]);
+#else
+						values[i]);
+#endif
+				break;
+			}
+			else
+			{
+#ifdef HAVE_ORACLE
+				do
+				{
+#endif
+					if (MAX_EXPRESSIONS == in_cnt)
+					{
+						in_cnt = 0;
+						(*sql_offset)--;
+#if defined(HAVE_SQLITE3)
+						if (MAX_EXPRESSIONS == ++expr_cnt)
+						{
+							zbx_snprintf_alloc(sql, sql_alloc, sql_offset, ")) or (%s in (",
+									fieldname);
+							expr_cnt = 0;
+						}
+						else
+						{
+#endif
+							zbx_snprintf_alloc(sql, sql_alloc, sql_offset, ") or %s in (",
+									fieldname);
+#if defined(HAVE_SQLITE3)
+						}
+#endif
+					}
 
-    // 释放seq_len内存
-    zbx_free(seq_len);
+					in_cnt++;
+					zbx_snprintf_alloc(sql, sql_alloc, sql_offset, ZBX_FS_UI64 ",",
+#ifdef HAVE_ORACLE
+							values[start++]);
+				}
+				while (0 != --seq_len[i]);
+			}
+		}
+		else
+			start += seq_len[i];
+	}
 
-    // 如果in_num大于1，拼接")"字符串
-    if (1 < in_num)
-    {
-        (*sql_offset)--;
-        zbx_chrcpy_alloc(sql, sql_alloc, sql_offset, ')');
-    }
+	zbx_free(seq_len);
 
-    // 处理SQLITE3情况
-    if (MAX_EXPRESSIONS < expr_num)
-        zbx_chrcpy_alloc(sql, sql_alloc, sql_offset, ')');
+	if (1 < in_num)
+#else
+							values[i]);
+			}
+	}
 
-    // 结束条件
-    zbx_chrcpy_alloc(sql, sql_alloc, sql_offset, ')');
-}
+	if (1 < num)
+#endif
+	{
+		(*sql_offset)--;
+		zbx_chrcpy_alloc(sql, sql_alloc, sql_offset, ')');
+	}
 
+#if defined(HAVE_SQLITE3)
+	if (MAX_EXPRESSIONS < expr_num)
+		zbx_chrcpy_alloc(sql, sql_alloc, sql_offset, ')');
+#endif
 #ifdef HAVE_ORACLE
 	if (MAX_EXPRESSIONS < in_num || 1 < between_num || (0 < in_num && 0 < between_num))
 #else
@@ -1557,6 +1515,8 @@ void	DBadd_str_condition_alloc(char **sql, size_t *sql_alloc, size_t *sql_offset
 		const char **values, const int num)
 {
     // 定义一个常量 MAX_EXPRESSIONS，表示最多允许的 expressions 数量，防止内存溢出
+#define MAX_EXPRESSIONS	950
+
     int	i, cnt = 0;
     char	*value_esc;
     int	values_num = 0, empty_num = 0;
@@ -1651,11 +1611,9 @@ void	DBadd_str_condition_alloc(char **sql, size_t *sql_alloc, size_t *sql_offset
     if (MAX_EXPRESSIONS < values_num || 0 != empty_num)
         zbx_chrcpy_alloc(sql, sql_alloc, sql_offset, ')');
 
-    // 释放内存
-    #undef MAX_EXPRESSIONS
+#undef MAX_EXPRESSIONS
 }
 
-
 static char	buf_string[640];
 
 /******************************************************************************
@@ -1705,7 +1663,6 @@ const char *zbx_host_string(zbx_uint64_t hostid)
 	return buf_string;
 }
 
-
 /******************************************************************************
  *                                                                            *
  * Function: zbx_host_key_string                                              *
@@ -1752,11 +1709,26 @@ const char *zbx_host_key_string(zbx_uint64_t itemid)
 	return buf_string;
 }
 
-
 /******************************************************************************
  *                                                                            *
  * Function: zbx_check_user_permissions                                       *
  *                                                                            *
+ * Purpose: check if user has access rights to information - full name, alias,*
+ *          Email, SMS, Jabber, etc                                           *
+ *                                                                            *
+ * Parameters: userid           - [IN] user who owns the information          *
+ *             recipient_userid - [IN] user who will receive the information  *
+ *                                     can be NULL for remote command         *
+ *                                                                            *
+ * Return value: SUCCEED - if information receiving user has access rights    *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: Users has access rights or can view personal information only    *
+ *           about themselves and other user who belong to their group.       *
+ *           "Zabbix Super Admin" can view and has access rights to           *
+ *           information about any user.                                      *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  * *
  *整个代码块的主要目的是检查两个用户（userid和recipient_userid）之间的权限关系。首先，查询recipient_userid对应的用户类型，然后判断userid和recipient_userid是否属于同一用户组。如果满足条件，返回成功（SUCCEED），否则返回失败（FAIL）。
@@ -1823,23 +1795,6 @@ out:
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
 
 	// 返回函数执行结果
-	return ret;
-}
-
-					" and exists (select null"
-						" from users_groups ug2"
-						" where ug1.usrgrpid=ug2.usrgrpid"
-							" and ug2.userid=" ZBX_FS_UI64
-					")",
-				*userid, *recipient_userid);
-
-		if (NULL == DBfetch(result))
-			ret = FAIL;
-		DBfree_result(result);
-	}
-out:
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
-
 	return ret;
 }
 
@@ -1886,7 +1841,6 @@ const char *zbx_user_string(zbx_uint64_t userid)
 	return buf_string;
 }
 
-
 /******************************************************************************
  *                                                                            *
  * Function: DBsql_id_cmp                                                     *
@@ -1946,296 +1900,68 @@ const char	*DBsql_id_cmp(zbx_uint64_t id)
 }
 
 /******************************************************************************
- * *
- *主要目的：这个代码块用于处理自动注册的主机，根据给定的proxy_hostid，更新主机表中的主机元数据。
- *
- *整个代码块的输出：
- *
- *```
- *static void process_autoreg_hosts(zbx_vector_ptr_t *autoreg_hosts, zbx_uint64_t proxy_hostid)
- *{
- *\tDB_RESULT\t\tresult;
- *\tDB_ROW\t\t\trow;
- *\tzbx_vector_str_t\thosts;
- *\tzbx_uint64_t\t\tcurrent_proxy_hostid;
- *\tchar\t\t\t*sql = NULL;
- *\tsize_t\t\t\tsql_alloc = 256, sql_offset;
- *\tzbx_autoreg_host_t\t*autoreg_host;
- *\tint\t\t\ti;
- *
- *\tsql = (char *)zbx_malloc(sql, sql_alloc);
- *\tzbx_vector_str_create(&hosts);
- *
- *\tif (0 != proxy_hostid)
- *\t{
- *\t\tautoreg_get_hosts(autoreg_hosts, &hosts);
- *
- *\t\t/* delete from vector if already exist in hosts table */
- *\t\tsql_offset = 0;
- *\t\tzbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
- *\t\t\t\t\"select h.host,h.hostid,h.proxy_hostid,a.host_metadata\"
- *\t\t\t\t\" from hosts h\"
- *\t\t\t\t\" left join autoreg_host a\"
- *\t\t\t\t\t\" on a.proxy_hostid=h.proxy_hostid and a.host=h.host\"
- *\t\t\t\t\" where\");
- *\t\tDBadd_str_condition_alloc(&sql, &sql_alloc, &sql_offset, \"h.host\",
- *\t\t\t\t(const char **)hosts.values, hosts.values_num);
- *
- *\t\tresult = DBselect(\"%s\", sql);
- *
- *\t\twhile (NULL != (row = DBfetch(result)))
- *\t\t{
- *\t\t\tfor (i = 0; i < autoreg_hosts->values_num; i++)
- *\t\t\t{
- *\t\t\t\tautoreg_host = (zbx_autoreg_host_t *)autoreg_hosts->values[i];
- *
- *\t\t\t\tif (0 != strcmp(autoreg_host->host, row[0]))
- *\t\t\t\t\tcontinue;
- *
- *\t\t\t\tZBX_STR2UINT64(autoreg_host->hostid, row[1]);
- *\t\t\t\tZBX_DBROW2UINT64(current_proxy_hostid, row[2]);
- *
- *\t\t\t\tif (current_proxy_hostid != proxy_hostid || SUCCEED == DBis_null(row[3]) ||
- *\t\t\t\t\t\t0 != strcmp(autoreg_host->host_metadata, row[3]))
- *\t\t\t\t{
- *\t\t\t\t\t/* 移除主机 */
- *\t\t\t\t\tzbx_vector_ptr_remove(autoreg_hosts, i);
- *\t\t\t\t\t/* 释放主机结构体内存 */
- *\t\t\t\t\tautoreg_host_free(autoreg_host);
- *
- *\t\t\t\t\t/* 跳出循环 */
- *\t\t\t\t\tbreak;
- *\t\t\t\t}
- *\t\t\t}
- *\t\t}
- *\t\tDBfree_result(result);
- *
- *\t\thosts.values_num = 0;
- *\t}
- *
- *\tif (0 != autoreg_hosts->values_num)
- *\t{
- *\t\tautoreg_get_hosts(autoreg_hosts, &hosts);
- *
- *\t\t/* 更新主机表中的主机元数据 */
- *\t\tsql_offset = 0;
- *\t\tzbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
- *\t\t\t\t\"select autoreg_hostid,host\"
- *\t\t\t\t\" from autoreg_host\"
- *\t\t\t\t\" where\");
- *\t\tDBadd_str_condition_alloc(&sql, &sql_alloc, &sql_offset, \"host\",
- *\t\t\t\t(const char **)hosts.values, hosts.values_num);
- *
- *\t\tresult = DBselect(\"%s\", sql);
- *
- *\t\twhile (NULL != (row = DBfetch(result)))
- *\t\t{
- *\t\t\tfor (i = 0; i < autoreg_hosts->values_num; i++)
- *\t\t\t{
- *\t\t\t\tautoreg_host = (zbx_autoreg_host_t *)autoreg_hosts->values[i];
- *
- *\t\t\t\t/* 如果主机ID为0且主机名相等，则更新主机ID */
- *\t\t\t\tif (0 == autoreg_host->autoreg_hostid && 0 == strcmp(autoreg_host->host, row[1]))
- *\t\t\t\t{
- *\t\t\t\t\t/* 解析主机ID */
- *\t\t\t\t\tZBX_STR2UINT64(autoreg_host->autoreg_hostid, row[0]);
- *\t\t\t\t\tbreak;
- *\t\t\t\t}
- *\t\t\t}
- *\t\t}
- *\t\tDBfree_result(result);
- *
- *\t\thosts.values_num = 0;
- *\t}
- *
- *\tzbx_vector_str_destroy(&hosts);
- *\tzbx_free(sql);
- *}
- *```
-/******************************************************************************
- * 
+ *                                                                            *
+ * Function: DBregister_host                                                  *
+ *                                                                            *
+ * Purpose: register unknown host and generate event                          *
+ *                                                                            *
+ * Parameters: host - host name                                               *
+ *                                                                            *
+ * Author: Alexander Vladishev                                                *
+ *                                                                            *
  ******************************************************************************/
-// 定义函数名：DBregister_host_flush
-// 函数原型：void DBregister_host_flush(zbx_vector_ptr_t *autoreg_hosts, zbx_uint64_t proxy_hostid)
-// 函数作用：将自动注册的主机信息插入或更新到数据库中，并触发相关事件
-
-void	DBregister_host_flush(zbx_vector_ptr_t *autoreg_hosts, zbx_uint64_t proxy_hostid)
+void	DBregister_host(zbx_uint64_t proxy_hostid, const char *host, const char *ip, const char *dns,
+		unsigned short port, const char *host_metadata, int now)
 {
-	// 定义常量字符串，表示函数名
-	const char		*__function_name = "DBregister_host_flush";
-
-	// 定义一个zbx_autoreg_host_t结构体指针
-	zbx_autoreg_host_t	*autoreg_host;
-
-	// 定义一个zbx_uint64_t类型的变量，用于存储自动注册主机的ID
-	zbx_uint64_t		autoreg_hostid;
-
-	// 定义一个zbx_db_insert_t类型的变量，用于存储数据库插入操作的信息
-	zbx_db_insert_t		db_insert;
-
-	// 定义一个整型变量，用于循环计数
-	int			i, create = 0, update = 0;
-
-	// 定义一个字符串指针，用于存储SQL语句
-	char			*sql = NULL;
-
-	// 定义一个字符串指针，用于存储IP、DNS和主机元数据
-	char			*ip_esc, *dns_esc, *host_metadata_esc;
-
-	// 定义一个大小为256的字符串缓冲区，用于存储SQL语句
-	size_t			sql_alloc = 256;
-	size_t			sql_offset = 0;
-
-	// 定义一个zbx_timespec_t类型的变量，用于存储时间戳
-	zbx_timespec_t		ts = {0, 0};
-
-	// 打印日志，表示进入函数
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
-
-	// 判断是否成功获取到活跃自动注册主机的信息，如果没有，则退出函数
-	if (SUCCEED != DBregister_host_active())
-		goto exit;
-
-	// 处理自动注册主机列表
-	process_autoreg_hosts(autoreg_hosts, proxy_hostid);
-
-	// 遍历自动注册主机列表，统计创建和更新的主机数量
-	for (i = 0; i < autoreg_hosts->values_num; i++)
-	{
-		autoreg_host = (zbx_autoreg_host_t *)autoreg_hosts->values[i];
-
-		// 如果主机ID为0，表示需要创建新的主机记录
-		if (0 == autoreg_host->autoreg_hostid)
-			create++;
-	}
-
-	// 如果存在需要创建的主机，则执行以下操作：
-	if (0 != create)
-	{
-		// 获取自动注册主机ID的最大值，并加1，作为新创建的主机ID
-		autoreg_hostid = DBget_maxid_num("autoreg_host", create);
-
-		// 准备数据库插入操作
-		zbx_db_insert_prepare(&db_insert, "autoreg_host", "autoreg_hostid", "proxy_hostid", "host", "listen_ip",
-				"listen_dns", "listen_port", "host_metadata", NULL);
-	}
-
-	// 如果存在需要更新的主机，则执行以下操作：
-	if (0 != (update = autoreg_hosts->values_num - create))
-	{
-		// 分配内存，用于存储SQL语句
-		sql = (char *)zbx_malloc(sql, sql_alloc);
-		// 开始执行数据库批量更新操作
-		DBbegin_multiple_update(&sql, &sql_alloc, &sql_offset);
-	}
-
-	// 对自动注册主机列表进行排序，方便后续操作
-	zbx_vector_ptr_sort(autoreg_hosts, ZBX_DEFAULT_UINT64_PTR_COMPARE_FUNC);
-
-	// 遍历自动注册主机列表，执行插入或更新操作
-	for (i = 0; i < autoreg_hosts->values_num; i++)
-	{
-		autoreg_host = (zbx_autoreg_host_t *)autoreg_hosts->values[i];
-
-		// 如果主机ID为0，表示需要创建新的主机记录
-		if (0 == autoreg_host->autoreg_hostid)
-		{
-			// 为主机分配ID，并加1
-			autoreg_host->autoreg_hostid = autoreg_hostid++;
-
-			// 准备插入主机记录的SQL语句
-			zbx_db_insert_add_values(&db_insert, autoreg_host->autoreg_hostid, proxy_hostid,
-					autoreg_host->host, autoreg_host->ip, autoreg_host->dns,
-					(int)autoreg_host->port, autoreg_host->host_metadata);
-		}
-		else
-		{
-			// 转义IP、DNS和主机元数据，以便插入数据库
-			ip_esc = DBdyn_escape_string(autoreg_host->ip);
-			dns_esc = DBdyn_escape_string(autoreg_host->dns);
-			host_metadata_esc = DBdyn_escape_string(autoreg_host->host_metadata);
-
-			// 构建更新主机记录的SQL语句
-			zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
-					"update autoreg_host"
-					" set listen_ip='%s',"
-						"listen_dns='%s',"
-						"listen_port=%hu,"
-						"host_metadata='%s',"
-						"proxy_hostid=%s"
-					" where autoreg_hostid=" ZBX_FS_UI64 ";\
-",
-				ip_esc, dns_esc, autoreg_host->port, host_metadata_esc, DBsql_id_ins(proxy_hostid),
-				autoreg_host->autoreg_hostid);
-
-			// 释放内存
-			zbx_free(host_metadata_esc);
-			zbx_free(dns_esc);
-			zbx_free(ip_esc);
-		}
-	}
-
-	// 如果存在需要创建的主机，则执行以下操作：
-	if (0 != create)
-	{
-		// 执行插入操作
-		zbx_db_insert_execute(&db_insert);
-		// 清理插入操作的相关信息
-		zbx_db_insert_clean(&db_insert);
-	}
-
-	// 如果存在需要更新的主机，则执行以下操作：
-	if (0 != update)
-	{
-		// 结束批量更新操作
-		DBend_multiple_update(&sql, &sql_alloc, &sql_offset);
+	zbx_vector_ptr_t	autoreg_hosts;
 
-		// 执行更新操作
-		DBexecute("%s", sql);
+	zbx_vector_ptr_create(&autoreg_hosts);
 
-		// 释放内存
-		zbx_free(sql);
-	}
+	DBregister_host_prepare(&autoreg_hosts, host, ip, dns, port, host_metadata, now);
+	DBregister_host_flush(&autoreg_hosts, proxy_hostid);
 
-	// 对自动注册主机列表进行排序，方便后续操作
-	zbx_vector_ptr_sort(autoreg_hosts, compare_autoreg_host_by_hostid);
+	DBregister_host_clean(&autoreg_hosts);
+	zbx_vector_ptr_destroy(&autoreg_hosts);
+}
 
-	// 遍历自动注册主机列表，执行相关操作
-	for (i = 0; i < autoreg_hosts->values_num; i++)
-	{
-		autoreg_host = (zbx_autoreg_host_t *)autoreg_hosts->values[i];
+static int	DBregister_host_active(void)
+{
+	const char	*__function_name = "DBregister_host_active";
 
-		// 设置主机状态，并触发相关事件
-		ts.sec = autoreg_host->now;
-		zbx_add_event(EVENT_SOURCE_AUTO_REGISTRATION, EVENT_OBJECT_ZABBIX_ACTIVE, autoreg_host->autoreg_hostid,
-				&ts, TRIGGER_VALUE_PROBLEM, NULL, NULL, NULL, 0, 0, NULL, 0, NULL, 0, NULL);
-	}
+	DB_RESULT	result;
+	int		ret = SUCCEED;
 
-	// 处理事件
-	zbx_process_events(NULL, NULL);
-	// 清理事件
-	zbx_clean_events();
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
 
-exit:
-	// 打印日志，表示退出函数
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __function_name);
-}
+	result = DBselect(
+			"select null"
+			" from actions"
+			" where eventsource=%d"
+				" and status=%d",
+			EVENT_SOURCE_AUTO_REGISTRATION,
+			ACTION_STATUS_ACTIVE);
 
-		DBfree_result(result);
+	if (NULL == DBfetch(result))
+		ret = FAIL;
 
-		/* 清理主机列表 */
-		hosts.values_num = 0;
-	}
+	DBfree_result(result);
 
-	/* 释放内存并清理 */
-	zbx_vector_str_destroy(&hosts);
-	zbx_free(sql);
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
+
+	return ret;
 }
 
 // 定义一个静态函数，用于释放zbx_autoreg_host_t结构体中的内存空间
-static void autoreg_host_free(zbx_autoreg_host_t *autoreg_host)
+static void	autoreg_host_free(zbx_autoreg_host_t *autoreg_host)
 {
-    // 释放host变量所占用的内存空间
+	// 释放host变量所占用的内存空间
+	zbx_free(autoreg_host->host);
+	zbx_free(autoreg_host->ip);
+	zbx_free(autoreg_host->dns);
+	zbx_free(autoreg_host->host_metadata);
+	zbx_free(autoreg_host);
+}
+
 /******************************************************************************
  * *
  *整个代码块的主要目的是：注册主机信息。通过遍历autoreg_hosts数组检查主机名是否已存在，若不存在则分配内存创建一个新的zbx_autoreg_host_t结构体，并将其添加到autoreg_hosts数组中。
@@ -2278,22 +2004,6 @@ void DBregister_host_prepare(zbx_vector_ptr_t *autoreg_hosts, const char *host,
     zbx_vector_ptr_append(autoreg_hosts, autoreg_host);
 }
 
-			break;
-		}
-	}
-
-	autoreg_host = (zbx_autoreg_host_t *)zbx_malloc(NULL, sizeof(zbx_autoreg_host_t));
-	autoreg_host->autoreg_hostid = autoreg_host->hostid = 0;
-	autoreg_host->host = zbx_strdup(NULL, host);
-	autoreg_host->ip = zbx_strdup(NULL, ip);
-	autoreg_host->dns = zbx_strdup(NULL, dns);
-	autoreg_host->port = port;
-	autoreg_host->host_metadata = zbx_strdup(NULL, host_metadata);
-	autoreg_host->now = now;
-
-	zbx_vector_ptr_append(autoreg_hosts, autoreg_host);
-}
-
 /******************************************************************************
  * *
  *这块代码的主要目的是从自动注册的主机向量（autoreg_hosts）中获取所有主机名，并将这些主机名添加到另一个主机向量（hosts）中。函数采用循环遍历 autoreg_hosts 中的每个元素，然后将对应元素的主机名添加到 hosts 向量中。整个代码块的功能可以简单总结为：从一个向量中提取主机名，并将这些主机名添加到另一个向量中。
@@ -2315,7 +2025,6 @@ static void autoreg_get_hosts(zbx_vector_ptr_t *autoreg_hosts, zbx_vector_str_t
 	}
 }
 
-
 static void	process_autoreg_hosts(zbx_vector_ptr_t *autoreg_hosts, zbx_uint64_t proxy_hostid)
 {
 	DB_RESULT		result;
@@ -2432,68 +2141,100 @@ static int	compare_autoreg_host_by_hostid(const void *d1, const void *d2)
 	return 0;
 }
 
+// 定义函数名：DBregister_host_flush
+// 函数原型：void DBregister_host_flush(zbx_vector_ptr_t *autoreg_hosts, zbx_uint64_t proxy_hostid)
+// 函数作用：将自动注册的主机信息插入或更新到数据库中，并触发相关事件
 
 void	DBregister_host_flush(zbx_vector_ptr_t *autoreg_hosts, zbx_uint64_t proxy_hostid)
 {
+	// 定义常量字符串，表示函数名
 	const char		*__function_name = "DBregister_host_flush";
 
+	// 定义一个zbx_autoreg_host_t结构体指针
 	zbx_autoreg_host_t	*autoreg_host;
+
+	// 定义一个zbx_uint64_t类型的变量，用于存储自动注册主机的ID
 	zbx_uint64_t		autoreg_hostid;
+
+	// 定义一个zbx_db_insert_t类型的变量，用于存储数据库插入操作的信息
 	zbx_db_insert_t		db_insert;
+
+	// 定义一个整型变量，用于循环计数
 	int			i, create = 0, update = 0;
+	// 定义一个字符串指针，用于存储IP、DNS和主机元数据
 	char			*sql = NULL, *ip_esc, *dns_esc, *host_metadata_esc;
+	// 定义一个大小为256的字符串缓冲区，用于存储SQL语句
 	size_t			sql_alloc = 256, sql_offset = 0;
+	// 定义一个zbx_timespec_t类型的变量，用于存储时间戳
 	zbx_timespec_t		ts = {0, 0};
 
+	// 打印日志，表示进入函数
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
 
+	// 判断是否成功获取到活跃自动注册主机的信息，如果没有，则退出函数
 	if (SUCCEED != DBregister_host_active())
 		goto exit;
 
+	// 处理自动注册主机列表
 	process_autoreg_hosts(autoreg_hosts, proxy_hostid);
 
+	// 遍历自动注册主机列表，统计创建和更新的主机数量
 	for (i = 0; i < autoreg_hosts->values_num; i++)
 	{
 		autoreg_host = (zbx_autoreg_host_t *)autoreg_hosts->values[i];
 
+		// 如果主机ID为0，表示需要创建新的主机记录
 		if (0 == autoreg_host->autoreg_hostid)
 			create++;
 	}
 
+	// 如果存在需要创建的主机，则执行以下操作：
 	if (0 != create)
 	{
+		// 获取自动注册主机ID的最大值，并加1，作为新创建的主机ID
 		autoreg_hostid = DBget_maxid_num("autoreg_host", create);
 
+		// 准备数据库插入操作
 		zbx_db_insert_prepare(&db_insert, "autoreg_host", "autoreg_hostid", "proxy_hostid", "host", "listen_ip",
 				"listen_dns", "listen_port", "host_metadata", NULL);
 	}
 
+	// 如果存在需要更新的主机，则执行以下操作：
 	if (0 != (update = autoreg_hosts->values_num - create))
 	{
+		// 分配内存，用于存储SQL语句
 		sql = (char *)zbx_malloc(sql, sql_alloc);
+		// 开始执行数据库批量更新操作
 		DBbegin_multiple_update(&sql, &sql_alloc, &sql_offset);
 	}
 
+	// 对自动注册主机列表进行排序，方便后续操作
 	zbx_vector_ptr_sort(autoreg_hosts, ZBX_DEFAULT_UINT64_PTR_COMPARE_FUNC);
 
+	// 遍历自动注册主机列表，执行插入或更新操作
 	for (i = 0; i < autoreg_hosts->values_num; i++)
 	{
 		autoreg_host = (zbx_autoreg_host_t *)autoreg_hosts->values[i];
 
+		// 如果主机ID为0，表示需要创建新的主机记录
 		if (0 == autoreg_host->autoreg_hostid)
 		{
+			// 为主机分配ID，并加1
 			autoreg_host->autoreg_hostid = autoreg_hostid++;
 
+			// 准备插入主机记录的SQL语句
 			zbx_db_insert_add_values(&db_insert, autoreg_host->autoreg_hostid, proxy_hostid,
 					autoreg_host->host, autoreg_host->ip, autoreg_host->dns,
 					(int)autoreg_host->port, autoreg_host->host_metadata);
 		}
 		else
 		{
+			// 转义IP、DNS和主机元数据，以便插入数据库
 			ip_esc = DBdyn_escape_string(autoreg_host->ip);
 			dns_esc = DBdyn_escape_string(autoreg_host->dns);
 			host_metadata_esc = DBdyn_escape_string(autoreg_host->host_metadata);
 
+			// 构建更新主机记录的SQL语句
 			zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
 					"update autoreg_host"
 					" set listen_ip='%s',"
@@ -2505,41 +2246,59 @@ void	DBregister_host_flush(zbx_vector_ptr_t *autoreg_hosts, zbx_uint64_t proxy_h
 				ip_esc, dns_esc, autoreg_host->port, host_metadata_esc, DBsql_id_ins(proxy_hostid),
 				autoreg_host->autoreg_hostid);
 
+			// 释放内存
 			zbx_free(host_metadata_esc);
 			zbx_free(dns_esc);
 			zbx_free(ip_esc);
 		}
 	}
 
+	// 如果存在需要创建的主机，则执行以下操作：
 	if (0 != create)
 	{
+		// 执行插入操作
 		zbx_db_insert_execute(&db_insert);
+		// 清理插入操作的相关信息
 		zbx_db_insert_clean(&db_insert);
 	}
 
+	// 如果存在需要更新的主机，则执行以下操作：
 	if (0 != update)
 	{
+		// 结束批量更新操作
 		DBend_multiple_update(&sql, &sql_alloc, &sql_offset);
+
+		// 执行更新操作
 		DBexecute("%s", sql);
+
+		// 释放内存
 		zbx_free(sql);
 	}
 
+	// 对自动注册主机列表进行排序，方便后续操作
 	zbx_vector_ptr_sort(autoreg_hosts, compare_autoreg_host_by_hostid);
 
+	// 遍历自动注册主机列表，执行相关操作
 	for (i = 0; i < autoreg_hosts->values_num; i++)
 	{
 		autoreg_host = (zbx_autoreg_host_t *)autoreg_hosts->values[i];
 
+		// 设置主机状态，并触发相关事件
 		ts.sec = autoreg_host->now;
 		zbx_add_event(EVENT_SOURCE_AUTO_REGISTRATION, EVENT_OBJECT_ZABBIX_ACTIVE, autoreg_host->autoreg_hostid,
 				&ts, TRIGGER_VALUE_PROBLEM, NULL, NULL, NULL, 0, 0, NULL, 0, NULL, 0, NULL);
 	}
 
+	// 处理事件
 	zbx_process_events(NULL, NULL);
+	// 清理事件
 	zbx_clean_events();
+
 exit:
+	// 打印日志，表示退出函数
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __function_name);
 }
+
 /******************************************************************************
  * *
  *这块代码的主要目的是清理自动注册的主机信息。函数接收一个指向 zbx_vector_ptr_t 类型的指针，该指针指向一个存储自动注册主机信息的 vector。通过调用 zbx_vector_ptr_clear_ext 函数，清理 vector 中的所有元素。清理过程中，使用 zbx_mem_free_func_t 类型指针调用 autoreg_host_free 函数来释放内存。
@@ -2552,7 +2311,6 @@ void DBregister_host_clean(zbx_vector_ptr_t *autoreg_hosts)
     zbx_vector_ptr_clear_ext(autoreg_hosts, (zbx_mem_free_func_t)autoreg_host_free);
 }
 
-
 /******************************************************************************
  *                                                                            *
  * Function: DBproxy_register_host                                            *
@@ -2570,24 +2328,39 @@ void DBregister_host_clean(zbx_vector_ptr_t *autoreg_hosts)
  ******************************************************************************/
 // 定义一个函数 void DBproxy_register_host，这个函数的主要目的是用于注册代理主机
 void	DBproxy_register_host(const char *host, const char *ip, const char *dns, unsigned short port,
-                            const char *host_metadata)
+		const char *host_metadata)
 {
-    // 定义一些字符指针，用于存储转义后的字符串
-    char	*host_esc, *ip_esc, *dns_esc, *host_metadata_esc;
-
-    // 使用 DBdyn_escape_field 函数对输入的字符串进行转义，分别为 host、ip、dns 和 host_metadata
-    host_esc = DBdyn_escape_field("proxy_autoreg_host", "host", host);
-    ip_esc = DBdyn_escape_field("proxy_autoreg_host", "listen_ip", ip);
-    dns_esc = DBdyn_escape_field("proxy_autoreg_host", "listen_dns", dns);
-    host_metadata_esc = DBdyn_escape_field("proxy_autoreg_host", "host_metadata", host_metadata);
-
-    // 使用 DBexecute 函数执行插入操作，将转义后的字符串插入到数据库中
-    DBexecute("insert into proxy_autoreg_host"
-             " (clock,host,listen_ip,listen_dns,listen_port,host_metadata)"
-             " values"
-             " (%d,'%s','%s','%s',%d,'%s')",
-             (int)time(NULL), host_esc, ip_esc, dns_esc, (int)port, host_metadata_esc);
+	// 定义一些字符指针，用于存储转义后的字符串
+	char	*host_esc, *ip_esc, *dns_esc, *host_metadata_esc;
+
+	// 使用 DBdyn_escape_field 函数对输入的字符串进行转义，分别为 host、ip、dns 和 host_metadata
+	host_esc = DBdyn_escape_field("proxy_autoreg_host", "host", host);
+	ip_esc = DBdyn_escape_field("proxy_autoreg_host", "listen_ip", ip);
+	dns_esc = DBdyn_escape_field("proxy_autoreg_host", "listen_dns", dns);
+	host_metadata_esc = DBdyn_escape_field("proxy_autoreg_host", "host_metadata", host_metadata);
+
+	// 使用 DBexecute 函数执行插入操作，将转义后的字符串插入到数据库中
+	DBexecute("insert into proxy_autoreg_host"
+			" (clock,host,listen_ip,listen_dns,listen_port,host_metadata)"
+			" values"
+			" (%d,'%s','%s','%s',%d,'%s')",
+			(int)time(NULL), host_esc, ip_esc, dns_esc, (int)port, host_metadata_esc);
+
+	zbx_free(host_metadata_esc);
+	zbx_free(dns_esc);
+	zbx_free(ip_esc);
+	zbx_free(host_esc);
+}
 
+/******************************************************************************
+ *                                                                            *
+ * Function: DBexecute_overflowed_sql                                         *
+ *                                                                            *
+ * Purpose: execute a set of SQL statements IF it is big enough               *
+ *                                                                            *
+ * Author: Dmitry Borovikov                                                   *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  * *
  *整个代码块的主要目的是处理SQL语句执行过程中的 overflow 问题。具体来说，当SQL语句长度超过预设的最大长度时，该函数会被调用。函数首先检查最后一个字符是否为逗号，如果是，则减少sql_offset的值，并在内存分配的sql数组末尾添加一个分号和换行符。接下来，根据编译时是否启用了HAVE_ORACLE宏，对SQL语句进行处理，去掉末尾的换行符和空格，以避免Oracle在遇到分号时报错。然后调用DBexecute函数执行SQL语句，并在执行完成后，重置sql_offset为0，开始下一轮多条更新操作。最后，返回执行结果。
@@ -2601,23 +2374,67 @@ int	DBexecute_overflowed_sql(char **sql, size_t *sql_alloc, size_t *sql_offset)
 	// 判断当前的sql_offset是否大于ZBX_MAX_OVERFLOW_SQL_SIZE
 	if (ZBX_MAX_OVERFLOW_SQL_SIZE < *sql_offset)
 	{
-		// 定义一个宏HAVE_MULTIROW_INSERT，如果在编译时启用，则以下代码段生效
-		// 判断最后一个字符是否为逗号，如果是，则减少sql_offset的值，并在内存分配的sql数组末尾添加一个分号和换行符
-		// 注意：这里使用了zbx_strcpy_alloc函数，它分配了新的内存并复制了原字符串，但是这里并没有释放原内存，可能是在后续代码中会处理
-		#ifdef HAVE_MULTIROW_INSERT
+// 定义一个宏HAVE_MULTIROW_INSERT，如果在编译时启用，则以下代码段生效
+// 判断最后一个字符是否为逗号，如果是，则减少sql_offset的值，并在内存分配的sql数组末尾添加一个分号和换行符
+// 注意：这里使用了zbx_strcpy_alloc函数，它分配了新的内存并复制了原字符串，但是这里并没有释放原内存，可能是在后续代码中会处理
+#ifdef HAVE_MULTIROW_INSERT
 		if (',' == (*sql)[*sql_offset - 1])
 		{
 			(*sql_offset)--;
-			zbx_strcpy_alloc(sql, sql_alloc, sql_offset, ";\
-");
+			zbx_strcpy_alloc(sql, sql_alloc, sql_offset, ";\n");
+		}
+#endif
+#if defined(HAVE_ORACLE) && 0 == ZBX_MAX_OVERFLOW_SQL_SIZE
+		/* make sure we are not called twice without */
+		/* putting a new sql into the buffer first */
+		if (*sql_offset <= ZBX_SQL_EXEC_FROM)
+		{
+			THIS_SHOULD_NEVER_HAPPEN;
+			return ret;
 		}
-		#endif
+
+		/* Oracle fails with ORA-00911 if it encounters ';' w/o PL/SQL block */
+		zbx_rtrim(*sql, ZBX_WHITESPACE ";");
+#else
+		DBend_multiple_update(sql, sql_alloc, sql_offset);
+#endif
+		/* For Oracle with max_overflow_sql_size == 0, jump over "begin\n" */
+		/* before execution. ZBX_SQL_EXEC_FROM is 0 for all other cases. */
+		if (ZBX_DB_OK > DBexecute("%s", *sql + ZBX_SQL_EXEC_FROM))
+			ret = FAIL;
+
+		*sql_offset = 0;
+
+		DBbegin_multiple_update(sql, sql_alloc, sql_offset);
+	}
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: DBget_unique_hostname_by_sample                                  *
+ *                                                                            *
+ * Purpose: construct a unique host name by the given sample                  *
+ *                                                                            *
+ * Parameters: host_name_sample - a host name to start constructing from      *
+ *                                                                            *
+ * Return value: unique host name which does not exist in the database        *
+ *                                                                            *
+ * Author: Dmitry Borovikov                                                   *
+ *                                                                            *
+ * Comments: the sample cannot be empty                                       *
+ *           constructs new by adding "_$(number+1)", where "number"          *
+ *           shows count of the sample itself plus already constructed ones   *
+ *           host_name_sample is not modified, allocates new memory!          *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  * *
  *这块代码的主要目的是根据给定的主机名示例，查找符合条件的主机名，并构造一个唯一的主机名返回。代码首先定义了一些变量，然后执行 SQL 查询寻找符合条件的主机名。接着对查询结果进行处理，找到符合条件且长度最小的数字，并构造唯一的主机名返回。整个过程中，代码还使用了日志记录和内存管理功能，确保程序的稳定运行。
  ******************************************************************************/
 // 定义一个函数，输入一个主机名示例，输出一个唯一的主机名
-char *DBget_unique_hostname_by_sample(const char *host_name_sample)
+char	*DBget_unique_hostname_by_sample(const char *host_name_sample)
 {
 	// 定义一些变量
 	const char		*__function_name = "DBget_unique_hostname_by_sample";
@@ -2674,7 +2491,10 @@ char *DBget_unique_hostname_by_sample(const char *host_name_sample)
 
 		// 如果不是数字，跳过此次循环
 		if ('\0' == *p)
+		{
+			full_match = 1;
 			continue;
+		}
 
 		// 如果是数字，将其添加到 vector 中
 		if ('_' != *p || FAIL == is_uint64(p + 1, &n))
@@ -2702,7 +2522,7 @@ char *DBget_unique_hostname_by_sample(const char *host_name_sample)
 			continue;
 
 		// 如果找到了，跳出循环
-		if (num < nums.values[i])
+		if (num < nums.values[i])	/* found, all other will be bigger */
 			break;
 
 		num++;
@@ -2721,76 +2541,6 @@ clean:
 	return host_name_temp;
 }
 
-
-	zbx_vector_uint64_create(&nums);
-	zbx_vector_uint64_reserve(&nums, 8);
-
-	sz = strlen(host_name_sample);
-	host_name_sample_esc = DBdyn_escape_like_pattern(host_name_sample);
-
-	result = DBselect(
-			"select host"
-			" from hosts"
-			" where host like '%s%%' escape '%c'"
-				" and flags<>%d"
-				" and status in (%d,%d,%d)",
-			host_name_sample_esc, ZBX_SQL_LIKE_ESCAPE_CHAR,
-			ZBX_FLAG_DISCOVERY_PROTOTYPE,
-			HOST_STATUS_MONITORED, HOST_STATUS_NOT_MONITORED, HOST_STATUS_TEMPLATE);
-
-	zbx_free(host_name_sample_esc);
-
-	while (NULL != (row = DBfetch(result)))
-	{
-		zbx_uint64_t	n;
-		const char	*p;
-
-		if (0 != strncmp(row[0], host_name_sample, sz))
-			continue;
-
-		p = row[0] + sz;
-
-		if ('\0' == *p)
-		{
-			full_match = 1;
-			continue;
-		}
-
-		if ('_' != *p || FAIL == is_uint64(p + 1, &n))
-			continue;
-
-		zbx_vector_uint64_append(&nums, n);
-	}
-	DBfree_result(result);
-
-	zbx_vector_uint64_sort(&nums, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
-
-	if (0 == full_match)
-	{
-		host_name_temp = zbx_strdup(host_name_temp, host_name_sample);
-		goto clean;
-	}
-
-	for (i = 0; i < nums.values_num; i++)
-	{
-		if (num > nums.values[i])
-			continue;
-
-		if (num < nums.values[i])	/* found, all other will be bigger */
-			break;
-
-		num++;
-	}
-
-	host_name_temp = zbx_dsprintf(host_name_temp, "%s_" ZBX_FS_UI64, host_name_sample, num);
-clean:
-	zbx_vector_uint64_destroy(&nums);
-
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():'%s'", __function_name, host_name_temp);
-
-	return host_name_temp;
-}
-
 /******************************************************************************
  *                                                                            *
  * Function: DBsql_id_ins                                                     *
@@ -2841,7 +2591,6 @@ const char *DBsql_id_ins(zbx_uint64_t id)
 	return buf[n];
 }
 
-
 /******************************************************************************
  *                                                                            *
  * Function: DBget_inventory_field                                            *
@@ -2862,8 +2611,39 @@ const char *DBsql_id_ins(zbx_uint64_t id)
 /* 定义一个常量字符指针数组，存储库存字段名称
  * 数组下标从1开始，因为0号元素作为数组长度使用
  */
-const char *DBget_inventory_field(unsigned char inventory_link)
+const char	*DBget_inventory_field(unsigned char inventory_link)
 {
+	static const char	*inventory_fields[HOST_INVENTORY_FIELD_COUNT] =
+	{
+		"type", "type_full", "name", "alias", "os", "os_full", "os_short", "serialno_a", "serialno_b", "tag",
+		"asset_tag", "macaddress_a", "macaddress_b", "hardware", "hardware_full", "software", "software_full",
+		"software_app_a", "software_app_b", "software_app_c", "software_app_d", "software_app_e", "contact",
+		"location", "location_lat", "location_lon", "notes", "chassis", "model", "hw_arch", "vendor",
+		"contract_number", "installer_name", "deployment_status", "url_a", "url_b", "url_c", "host_networks",
+		"host_netmask", "host_router", "oob_ip", "oob_netmask", "oob_router", "date_hw_purchase",
+		"date_hw_install", "date_hw_expiry", "date_hw_decomm", "site_address_a", "site_address_b",
+		"site_address_c", "site_city", "site_state", "site_country", "site_zip", "site_rack", "site_notes",
+		"poc_1_name", "poc_1_email", "poc_1_phone_a", "poc_1_phone_b", "poc_1_cell", "poc_1_screen",
+		"poc_1_notes", "poc_2_name", "poc_2_email", "poc_2_phone_a", "poc_2_phone_b", "poc_2_cell",
+		"poc_2_screen", "poc_2_notes"
+	};
+
+	if (1 > inventory_link || inventory_link > HOST_INVENTORY_FIELD_COUNT)
+		return NULL;
+
+	return inventory_fields[inventory_link - 1];
+}
+
+int	DBtxn_status(void)
+{
+	return 0 == zbx_db_txn_error() ? SUCCEED : FAIL;
+}
+
+int	DBtxn_ongoing(void)
+{
+	return 0 == zbx_db_txn_level() ? FAIL : SUCCEED;
+}
+
 /******************************************************************************
  * *
  *整个代码块的主要目的是检查给定的表名（table_name）在数据库中是否存在。根据不同的数据库类型（DB2、MySQL、Oracle、POSTGRESQL、SQLite3），执行相应的查询语句来判断表名是否存在。如果表名存在，则返回SUCCEED，否则返回FAIL。在这个过程中，还对表名进行了转义处理，以防止SQL注入攻击。
@@ -2944,35 +2724,6 @@ int	DBtable_exists(const char *table_name)
 	return ret;
 }
 
-	/* publib.boulder.ibm.com/infocenter/db2luw/v9r7/topic/com.ibm.db2.luw.admin.cmd.doc/doc/r0001967.html */
-	result = DBselect(
-			"select 1"
-			" from syscat.tables"
-			" where tabschema=user"
-				" and lower(tabname)='%s'",
-			table_name_esc);
-#elif defined(HAVE_MYSQL)
-	result = DBselect("show tables like '%s'", table_name_esc);
-#elif defined(HAVE_ORACLE)
-	result = DBselect(
-			"select 1"
-			" from tab"
-			" where tabtype='TABLE'"
-				" and lower(tname)='%s'",
-			table_name_esc);
-#elif defined(HAVE_POSTGRESQL)
-	table_schema_esc = DBdyn_escape_string(NULL == CONFIG_DBSCHEMA || '\0' == *CONFIG_DBSCHEMA ?
-			"public" : CONFIG_DBSCHEMA);
-
-	result = DBselect(
-			"select 1"
-			" from information_schema.tables"
-			" where table_name='%s'"
-				" and table_schema='%s'",
-			table_name_esc, table_schema_esc);
-
-	zbx_free(table_schema_esc);
-
 /******************************************************************************
  * *
  *整个代码块的主要目的是检查给定的表名和字段名是否存在于数据库中。根据不同的数据库类型，执行相应的查询语句，判断查询结果是否有数据。如果没有数据，则返回FAIL，否则返回SUCCEED。
@@ -2982,7 +2733,7 @@ int	DBfield_exists(const char *table_name, const char *field_name)
 	// 定义一个DB_RESULT类型的变量result，用于存储查询结果
 	DB_RESULT	result;
 
-	// 根据不同的数据库类型，分别进行不同的处理
+// 根据不同的数据库类型，分别进行不同的处理
 #if defined(HAVE_IBM_DB2)
 	char		*table_name_esc, *field_name_esc;
 	int		ret;
@@ -3001,14 +2752,10 @@ int	DBfield_exists(const char *table_name, const char *field_name)
 	int		ret = FAIL;
 #endif
 
-	// 对表名和字段名进行转义，防止SQL注入攻击
-#if defined(HAVE_IBM_DB2) || defined(HAVE_MYSQL) || defined(HAVE_ORACLE)
+#if defined(HAVE_IBM_DB2)
 	table_name_esc = DBdyn_escape_string(table_name);
 	field_name_esc = DBdyn_escape_string(field_name);
-#endif
 
-	// 根据不同数据库类型，执行相应的查询语句
-#if defined(HAVE_IBM_DB2)
 	result = DBselect(
 			"select 1"
 			" from syscat.columns"
@@ -3016,19 +2763,47 @@ int	DBfield_exists(const char *table_name, const char *field_name)
 				" and lower(tabname)='%s'"
 				" and lower(colname)='%s'",
 			table_name_esc, field_name_esc);
+
+	zbx_free(field_name_esc);
+	zbx_free(table_name_esc);
+
+	ret = (NULL == DBfetch(result) ? FAIL : SUCCEED);
+
+	DBfree_result(result);
 #elif defined(HAVE_MYSQL)
+	field_name_esc = DBdyn_escape_string(field_name);
+
 	result = DBselect("show columns from %s like '%s'",
 			table_name, field_name_esc);
+
+	zbx_free(field_name_esc);
+
+	ret = (NULL == DBfetch(result) ? FAIL : SUCCEED);
+
+	DBfree_result(result);
 #elif defined(HAVE_ORACLE)
+	table_name_esc = DBdyn_escape_string(table_name);
+	field_name_esc = DBdyn_escape_string(field_name);
+
 	result = DBselect(
 			"select 1"
 			" from col"
 			" where lower(tname)='%s'"
 				" and lower(cname)='%s'",
 			table_name_esc, field_name_esc);
+
+	zbx_free(field_name_esc);
+	zbx_free(table_name_esc);
+
+	ret = (NULL == DBfetch(result) ? FAIL : SUCCEED);
+
+	DBfree_result(result);
 #elif defined(HAVE_POSTGRESQL)
 	table_schema_esc = DBdyn_escape_string(NULL == CONFIG_DBSCHEMA || '\0' == *CONFIG_DBSCHEMA ?
 			"public" : CONFIG_DBSCHEMA);
+	table_name_esc = DBdyn_escape_string(table_name);
+	field_name_esc = DBdyn_escape_string(field_name);
+
 	result = DBselect(
 			"select 1"
 			" from information_schema.columns"
@@ -3036,26 +2811,17 @@ int	DBfield_exists(const char *table_name, const char *field_name)
 				" and column_name='%s'"
 				" and table_schema='%s'",
 			table_name_esc, field_name_esc, table_schema_esc);
-#elif defined(HAVE_SQLITE3)
-	result = DBselect("PRAGMA table_info('%s')", table_name_esc);
-#endif
 
-	// 释放内存
-#if defined(HAVE_IBM_DB2) || defined(HAVE_ORACLE)
 	zbx_free(field_name_esc);
 	zbx_free(table_name_esc);
-#endif
+	zbx_free(table_schema_esc);
 
 	// 判断查询结果是否有数据，如果没有数据，则返回FAIL，否则返回SUCCEED
 	ret = (NULL == DBfetch(result) ? FAIL : SUCCEED);
 
-	// 释放查询结果
-#if defined(HAVE_IBM_DB2) || defined(HAVE_MYSQL) || defined(HAVE_ORACLE) || defined(HAVE_POSTGRESQL)
 	DBfree_result(result);
-#endif
-
-	return ret;
-}
+#elif defined(HAVE_SQLITE3)
+	table_name_esc = DBdyn_escape_string(table_name);
 
 	result = DBselect("PRAGMA table_info('%s')", table_name_esc);
 
@@ -3144,7 +2910,6 @@ int DBindex_exists(const char *table_name, const char *index_name)
 	// 返回结果
 	return ret;
 }
-
 #endif
 
 /******************************************************************************
@@ -3160,35 +2925,87 @@ int DBindex_exists(const char *table_name, const char *index_name)
  *整个代码块的主要目的是：根据给定的 SQL 语句查询数据库，将查询结果中的 id 字段存储到 zbx_vector_uint64_t 类型的向量 ids 中，并对向量进行排序。最后释放查询结果占用的内存。
  ******************************************************************************/
 // 定义一个名为 DBselect_uint64 的 void 类型函数，接收两个参数：一个指向 const char 类型的指针 sql 和一个 zbx_vector_uint64_t 类型的指针 ids。
-void DBselect_uint64(const char *sql, zbx_vector_uint64_t *ids)
+void	DBselect_uint64(const char *sql, zbx_vector_uint64_t *ids)
 {
 	// 定义一个 DB_RESULT 类型的变量 result，用于存储数据库查询的结果
-	DB_RESULT result;
+	DB_RESULT	result;
 	// 定义一个 DB_ROW 类型的变量 row，用于存储数据库查询的一行数据
-	DB_ROW row;
+	DB_ROW		row;
 	// 定义一个 zbx_uint64_t 类型的变量 id，用于存储查询到的数据中的 id 字段
-	zbx_uint64_t id;
+	zbx_uint64_t	id;
 
 	// 使用 DBselect 函数执行给定的 sql 语句，并将结果存储在 result 变量中
 	result = DBselect("%s", sql);
 
 	// 使用一个 while 循环，当 DBfetch 函数返回不为 NULL 的行时，执行循环体
+	while (NULL != (row = DBfetch(result)))
+	{
+		ZBX_STR2UINT64(id, row[0]);
+
+		zbx_vector_uint64_append(ids, id);
+	}
+	DBfree_result(result);
+
+	zbx_vector_uint64_sort(ids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+}
+
 /******************************************************************************
  * *
  *整个代码块的主要目的是执行多次SQL查询，对于给定的查询语句、字段名和ID列表，按照ORACLE的语法规范进行分组和更新操作。代码首先分配内存用于存储SQL语句，然后开始执行多次更新操作。遍历ID列表，将查询语句、字段名和ID条件添加到SQL缓冲区，并在每个查询语句末尾添加分隔符。执行 overflowed_sql操作，如果失败，则退出循环。如果循环成功结束，且sql_offset大于16，说明执行成功，结束多次更新操作并执行最终的SQL语句。如果执行失败，释放内存并返回失败状态。
  ******************************************************************************/
 int	DBexecute_multiple_query(const char *query, const char *field_name, zbx_vector_uint64_t *ids)
 {
-    // 定义一个常量 ZBX_MAX_IDS，表示一次最大处理的ID数量为950
-    char	*sql = NULL;
-    size_t	sql_alloc = ZBX_KIBIBYTE, sql_offset = 0;
-    int	i, ret = SUCCEED;
+// 定义一个常量 ZBX_MAX_IDS，表示一次最大处理的ID数量为950
+#define ZBX_MAX_IDS	950
+	char	*sql = NULL;
+	size_t	sql_alloc = ZBX_KIBIBYTE, sql_offset = 0;
+	int	i, ret = SUCCEED;
+
+	// 分配内存用于存储SQL语句
+	sql = (char *)zbx_malloc(sql, sql_alloc);
+
+	// 开始执行多次更新操作
+	DBbegin_multiple_update(&sql, &sql_alloc, &sql_offset);
+
+	for (i = 0; i < ids->values_num; i += ZBX_MAX_IDS)
+	{
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, query);
+		DBadd_condition_alloc(&sql, &sql_alloc, &sql_offset, field_name,
+				&ids->values[i], MIN(ZBX_MAX_IDS, ids->values_num - i));
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, ";\n");
+
+		if (SUCCEED != (ret = DBexecute_overflowed_sql(&sql, &sql_alloc, &sql_offset)))
+			break;
+	}
+
+	if (SUCCEED == ret && sql_offset > 16)	/* in ORACLE always present begin..end; */
+	{
+		DBend_multiple_update(&sql, &sql_alloc, &sql_offset);
+
+		if (ZBX_DB_OK > DBexecute("%s", sql))
+			ret = FAIL;
+	}
+
+	zbx_free(sql);
+
+	return ret;
+}
+
+#if defined(HAVE_MYSQL) || defined(HAVE_POSTGRESQL)
+static void	zbx_warn_char_set(const char *db_name, const char *char_set)
+{
+	zabbix_log(LOG_LEVEL_WARNING, "Zabbix supports only \"" ZBX_SUPPORTED_DB_CHARACTER_SET "\" character set."
+			" Database \"%s\" has default character set \"%s\"", db_name, char_set);
+}
+#endif
 
-    // 分配内存用于存储SQL语句
-    sql = (char *)zbx_malloc(sql, sql_alloc);
+#if defined(HAVE_MYSQL) || defined(HAVE_POSTGRESQL) || defined(HAVE_ORACLE)
+static void	zbx_warn_no_charset_info(const char *db_name)
+{
+	zabbix_log(LOG_LEVEL_WARNING, "Cannot get database \"%s\" character set", db_name);
+}
+#endif
 
-    // 开始执行多次更新操作
-    DBbegin_multiple_update(&sql, &sql_alloc, &sql_offset);
 /******************************************************************************
  * *
  *主要目的：检查数据库的字符集和排序规则是否符合Zabbix的支持范围，如果不符合，则发出警告。同时，检查数据库中的表是否使用了不支持的排序规则。
@@ -3203,176 +3020,141 @@ int	DBexecute_multiple_query(const char *query, const char *field_name, zbx_vect
  *6. 释放资源，关闭数据库连接。
  *7. 自由使用。
  ******************************************************************************/
-void DBcheck_character_set(void)
+void	DBcheck_character_set(void)
 {
-    // 定义宏，根据数据库类型选择不同的处理方式
+// 定义宏，根据数据库类型选择不同的处理方式
 #if defined(HAVE_MYSQL)
-    // 针对MySQL数据库的代码块
-    char *database_name_esc;
-    DB_RESULT result;
-    DB_ROW row;
-
-    // 获取数据库名称并转义
-    database_name_esc = DBdyn_escape_string(CONFIG_DBNAME);
-    // 连接数据库
-    DBconnect(ZBX_DB_CONNECT_NORMAL);
-
-    // 查询数据库的字符集和排序规则
-    result = DBselect(
-            "select default_character_set_name,default_collation_name"
-            " from information_schema.SCHEMATA"
-            " where schema_name='%s'", database_name_esc);
-
-    // 检查结果是否为空，如果不支持该数据库的字符集和排序规则，则警告
-    if (NULL == result || NULL == (row = DBfetch(result)))
-    {
-        zbx_warn_no_charset_info(CONFIG_DBNAME);
-    }
-    else
-    {
-        char *char_set = row[0];
-        char *collation = row[1];
-
-        // 检查字符集和排序规则是否与支持的规则匹配，如果不匹配，则警告
-        if (0 != strcasecmp(char_set, ZBX_SUPPORTED_DB_CHARACTER_SET))
-            zbx_warn_char_set(CONFIG_DBNAME, char_set);
+	// 针对MySQL数据库的代码块
+	char		*database_name_esc;
+	DB_RESULT	result;
+	DB_ROW		row;
 
-        if (0 != zbx_strncasecmp(collation, ZBX_SUPPORTED_DB_COLLATION, sizeof(ZBX_SUPPORTED_DB_COLLATION)))
-        {
-            zabbix_log(LOG_LEVEL_WARNING, "Zabbix supports only \"%s\" collation."
-                    " Database \"%s\" has default collation \"%s\"", ZBX_SUPPORTED_DB_COLLATION,
-                    CONFIG_DBNAME, collation);
-        }
-    }
+	// 获取数据库名称并转义
+	database_name_esc = DBdyn_escape_string(CONFIG_DBNAME);
+	// 连接数据库
+	DBconnect(ZBX_DB_CONNECT_NORMAL);
 
-    // 释放资源
-    DBfree_result(result);
+	// 查询数据库的字符集和排序规则
+	result = DBselect(
+			"select default_character_set_name,default_collation_name"
+			" from information_schema.SCHEMATA"
+			" where schema_name='%s'", database_name_esc);
 
-    // 查询数据库表的字符集和排序规则
-    result = DBselect(
-            "select count(*)"
-            " from information_schema.`COLUMNS`"
-            " where table_schema='%s'"
-            " and data_type in ('text','varchar','longtext')"
-            " and (character_set_name<>'%s' or collation_name<>'%s')",
-            database_name_esc, ZBX_SUPPORTED_DB_CHARACTER_SET, ZBX_SUPPORTED_DB_COLLATION);
-
-    // 检查结果是否为空，如果不支持该数据库的字符集和排序规则，则警告
-    if (NULL == result || NULL == (row = DBfetch(result)))
-    {
-        zabbix_log(LOG_LEVEL_WARNING, "cannot get character set of database \"%s\" tables", CONFIG_DBNAME);
-    }
-    else if (0 != strcmp("0", row[0]))
-    {
-        zabbix_log(LOG_LEVEL_WARNING, "character set name or collation name that is not supported by Zabbix"
-                " found in %s column(s) of database \"%s\"", row[0], CONFIG_DBNAME);
-        zabbix_log(LOG_LEVEL_WARNING, "only character set \"%s\" and collation \"%s\" should be used in "
-                "database", ZBX_SUPPORTED_DB_CHARACTER_SET, ZBX_SUPPORTED_DB_COLLATION);
-    }
+	// 检查结果是否为空，如果不支持该数据库的字符集和排序规则，则警告
+	if (NULL == result || NULL == (row = DBfetch(result)))
+	{
+		zbx_warn_no_charset_info(CONFIG_DBNAME);
+	}
+	else
+	{
+		char	*char_set = row[0];
+		char	*collation = row[1];
 
-    // 释放资源
-    DBfree_result(result);
-    DBclose();
-    zbx_free(database_name_esc);
-#elif defined(HAVE_ORACLE)
-    // 针对Oracle数据库的代码块
-    DB_RESULT	result;
-    DB_ROW		row;
+		// 检查字符集和排序规则是否与支持的规则匹配，如果不匹配，则警告
+		if (0 != strcasecmp(char_set, ZBX_SUPPORTED_DB_CHARACTER_SET))
+			zbx_warn_char_set(CONFIG_DBNAME, char_set);
 
-    // 连接数据库
-    DBconnect(ZBX_DB_CONNECT_NORMAL);
-    result = DBselect(
-            "select parameter,value"
-            " from NLS_DATABASE_PARAMETERS"
-            " where parameter in ('NLS_CHARACTERSET','NLS_NCHAR_CHARACTERSET')");
+		if (0 != zbx_strncasecmp(collation, ZBX_SUPPORTED_DB_COLLATION, sizeof(ZBX_SUPPORTED_DB_COLLATION)))
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "Zabbix supports only \"%s\" collation."
+					" Database \"%s\" has default collation \"%s\"", ZBX_SUPPORTED_DB_COLLATION,
+					CONFIG_DBNAME, collation);
+		}
+	}
 
-    // 检查结果是否为空，如果不支持该数据库的字符集和排序规则，则警告
-    if (NULL == result)
-    {
-        zbx_warn_no_charset_info(CONFIG_DBNAME);
-    }
-    else
-    {
-        while (NULL != (row = DBfetch(result)))
-        {
-            const char	*parameter = row[0];
-            const char	*value = row[1];
+	// 释放资源
+	DBfree_result(result);
 
-            if (NULL == parameter || NULL == value)
-            {
-                continue;
-            }
-            else if (0 == strcasecmp("NLS_CHARACTERSET", parameter) ||
-                    (0 == strcasecmp("NLS_NCHAR_CHARACTERSET", parameter)))
-            {
-                if (0 != strcasecmp(ZBX_SUPPORTED_DB_CHARACTER_SET, value))
-                {
-                    zabbix_log(LOG_LEVEL_WARNING, "database \"%s\" parameter \"%s\" has value"
-                        " \"%s\". Zabbix supports only \"%s\" character set",
-                        CONFIG_DBNAME, parameter, value,
-                        ZBX_SUPPORTED_DB_CHARACTER_SET);
-                }
-            }
-        }
-    }
+	// 查询数据库表的字符集和排序规则
+	result = DBselect(
+			"select count(*)"
+			" from information_schema.`COLUMNS`"
+			" where table_schema='%s'"
+				" and data_type in ('text','varchar','longtext')"
+				" and (character_set_name<>'%s' or collation_name<>'%s')",
+			database_name_esc, ZBX_SUPPORTED_DB_CHARACTER_SET, ZBX_SUPPORTED_DB_COLLATION);
 
-    // 释放资源
-    DBfree_result(result);
+	// 检查结果是否为空，如果不支持该数据库的字符集和排序规则，则警告
+	if (NULL == result || NULL == (row = DBfetch(result)))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot get character set of database \"%s\" tables", CONFIG_DBNAME);
+	}
+	else if (0 != strcmp("0", row[0]))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "character set name or collation name that is not supported by Zabbix"
+				" found in %s column(s) of database \"%s\"", row[0], CONFIG_DBNAME);
+		zabbix_log(LOG_LEVEL_WARNING, "only character set \"%s\" and collation \"%s\" should be used in "
+				"database", ZBX_SUPPORTED_DB_CHARACTER_SET, ZBX_SUPPORTED_DB_COLLATION);
+	}
 
-    // 查询数据库表的字符集和排序规则
-    result = DBselect(
-            "select oid"
-            " from pg_namespace"
-            " where nspname='%s'",
-            schema_name_esc);
+	// 释放资源
+	DBfree_result(result);
+	DBclose();
+	zbx_free(database_name_esc);
+#elif defined(HAVE_ORACLE)
+	// 针对Oracle数据库的代码块
+	DB_RESULT	result;
+	DB_ROW		row;
 
-    // 检查结果是否为空，如果不支持该数据库的字符集和排序规则，则警告
-    if (NULL == result || NULL == (row = DBfetch(result)) || '\0' == **row)
-    {
-        zabbix_log(LOG_LEVEL_WARNING, "cannot get character set of database \"%s\" fields", CONFIG_DBNAME);
-    }
+	// 连接数据库
+	DBconnect(ZBX_DB_CONNECT_NORMAL);
+	result = DBselect(
+			"select parameter,value"
+			" from NLS_DATABASE_PARAMETERS"
+			" where parameter in ('NLS_CHARACTERSET','NLS_NCHAR_CHARACTERSET')");
 
-    // 释放资源
-    DBfree_result(result);
+	// 检查结果是否为空，如果不支持该数据库的字符集和排序规则，则警告
+	if (NULL == result)
+	{
+		zbx_warn_no_charset_info(CONFIG_DBNAME);
+	}
+	else
+	{
+		while (NULL != (row = DBfetch(result)))
+		{
+			const char	*parameter = row[0];
+			const char	*value = row[1];
 
-    // 查询数据库的字符集和排序规则
-    result = DBselect("show client_encoding");
+			if (NULL == parameter || NULL == value)
+			{
+				continue;
+			}
+			else if (0 == strcasecmp("NLS_CHARACTERSET", parameter) ||
+					(0 == strcasecmp("NLS_NCHAR_CHARACTERSET", parameter)))
+			{
+				if (0 != strcasecmp(ZBX_SUPPORTED_DB_CHARACTER_SET, value))
+				{
+					zabbix_log(LOG_LEVEL_WARNING, "database \"%s\" parameter \"%s\" has value"
+							" \"%s\". Zabbix supports only \"%s\" character set",
+							CONFIG_DBNAME, parameter, value,
+							ZBX_SUPPORTED_DB_CHARACTER_SET);
+				}
+			}
+		}
+	}
 
-    // 检查结果是否为空，如果不支持该数据库的字符集和排序规则，则警告
-    if (NULL == result || NULL == (row = DBfetch(result)))
-    {
-        zabbix_log(LOG_LEVEL_WARNING, "cannot get info about database \"%s\" client encoding", CONFIG_DBNAME);
-    }
-    else if (0 != strcasecmp(row[0], ZBX_SUPPORTED_DB_CHARACTER_SET))
-    {
-        zabbix_log(LOG_LEVEL_WARNING, "client_encoding for database \"%s\" is \"%s\". Zabbix supports only"
-            " \"%s\"", CONFIG_DBNAME, row[0], ZBX_SUPPORTED_DB_CHARACTER_SET);
-    }
+	// 释放资源
+	DBfree_result(result);
+	DBclose();
+#elif defined(HAVE_POSTGRESQL)
+#define OID_LENGTH_MAX		20
 
-    // 释放资源
-    DBfree_result(result);
+	char		*database_name_esc, *schema_name_esc, oid[OID_LENGTH_MAX];
+	DB_RESULT	result;
+	DB_ROW		row;
 
-    // 查询数据库的服务器字符集和排序规则
-    result = DBselect("show server_encoding");
+	database_name_esc = DBdyn_escape_string(CONFIG_DBNAME);
+	schema_name_esc = (NULL != CONFIG_DBSCHEMA) ? DBdyn_escape_string(CONFIG_DBSCHEMA) : strdup("public");
 
-    // 检查结果是否为空，如果不支持该数据库的字符集和排序规则，则警告
-    if (NULL == result || NULL == (row = DBfetch(result)))
-    {
-        zabbix_log(LOG_LEVEL_WARNING, "cannot get info about database \"%s\" server encoding", CONFIG_DBNAME);
-    }
-    else if (0 != strcasecmp(row[0], ZBX_SUPPORTED_DB_CHARACTER_SET))
-    {
-        zabbix_log(LOG_LEVEL_WARNING, "server_encoding for database \"%s\" is \"%s\". Zabbix supports only"
-            " \"%s\"", CONFIG_DBNAME, row[0], ZBX_SUPPORTED_DB_CHARACTER_SET);
-    }
-out:
-    DBfree_result(result);
-    DBclose();
-    zbx_free(schema_name_esc);
-    zbx_free(database_name_esc);
-#endif
-}
+	DBconnect(ZBX_DB_CONNECT_NORMAL);
+	result = DBselect(
+			"select pg_encoding_to_char(encoding)"
+			" from pg_database"
+			" where datname='%s'",
+			database_name_esc);
 
+	if (NULL == result || NULL == (row = DBfetch(result)))
+	{
 		zbx_warn_no_charset_info(CONFIG_DBNAME);
 		goto out;
 	}
@@ -3391,6 +3173,7 @@ out:
 			" where nspname='%s'",
 			schema_name_esc);
 
+	// 检查结果是否为空，如果不支持该数据库的字符集和排序规则，则警告
 	if (NULL == result || NULL == (row = DBfetch(result)) || '\0' == **row)
 	{
 		zabbix_log(LOG_LEVEL_WARNING, "cannot get character set of database \"%s\" fields", CONFIG_DBNAME);
@@ -3399,8 +3182,10 @@ out:
 
 	strscpy(oid, *row);
 
+	// 释放资源
 	DBfree_result(result);
 
+	// 查询数据库的字符集和排序规则
 	result = DBselect(
 			"select count(*)"
 			" from pg_attribute as a"
@@ -3428,6 +3213,7 @@ out:
 
 	result = DBselect("show client_encoding");
 
+	// 检查结果是否为空，如果不支持该数据库的字符集和排序规则，则警告
 	if (NULL == result || NULL == (row = DBfetch(result)))
 	{
 		zabbix_log(LOG_LEVEL_WARNING, "cannot get info about database \"%s\" client encoding", CONFIG_DBNAME);
@@ -3438,10 +3224,13 @@ out:
 				" \"%s\"", CONFIG_DBNAME, row[0], ZBX_SUPPORTED_DB_CHARACTER_SET);
 	}
 
+	// 释放资源
 	DBfree_result(result);
 
+	// 查询数据库的服务器字符集和排序规则
 	result = DBselect("show server_encoding");
 
+	// 检查结果是否为空，如果不支持该数据库的字符集和排序规则，则警告
 	if (NULL == result || NULL == (row = DBfetch(result)))
 	{
 		zabbix_log(LOG_LEVEL_WARNING, "cannot get info about database \"%s\" server encoding", CONFIG_DBNAME);
@@ -3459,81 +3248,81 @@ out:
 #endif
 }
 
+#ifdef HAVE_ORACLE
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_db_format_values                                             *
+ *                                                                            *
+ * Purpose: format bulk operation (insert, update) value list                 *
+ *                                                                            *
+ * Parameters: fields     - [IN] the field list                               *
+ *             values     - [IN] the corresponding value list                 *
+ *             values_num - [IN] the number of values to format               *
+ *                                                                            *
+ * Return value: the formatted value list <value1>,<value2>...                *
+ *                                                                            *
+ * Comments: The returned string is allocated by this function and must be    *
+ *           freed by the caller later.                                       *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  * *
  *整个代码块的主要目的是对一个包含多个字段的数组进行格式化，将字段的数据按照指定的格式添加到一个新的字符串中。输出的字符串可以用于数据库查询或其他操作。
  ******************************************************************************/
 // 定义一个静态字符指针变量，用于存储格式化后的字符串
-static char *zbx_db_format_values(ZBX_FIELD **fields, const zbx_db_value_t *values, int values_num);
-
-// 定义变量
-int	i;
-char	*str = NULL;
-size_t	str_alloc = 0, str_offset = 0;
-
-// 遍历 values 数组
-for (i = 0; i < values_num; i++)
+static char	*zbx_db_format_values(ZBX_FIELD **fields, const zbx_db_value_t *values, int values_num)
 {
-	// 获取当前字段
-	ZBX_FIELD		*field = fields[i];
-	const zbx_db_value_t	*value = &values[i];
-
-	// 如果当前不是第一个字段，则在字符串中添加一个逗号
-	if (0 < i)
-		zbx_chrcpy_alloc(&str, &str_alloc, &str_offset, ',');
+	// 定义变量
+	int	i;
+	char	*str = NULL;
+	size_t	str_alloc = 0, str_offset = 0;
 
-	// 根据字段的类型进行格式化
-	switch (field->type)
+	// 遍历 values 数组
+	for (i = 0; i < values_num; i++)
 	{
-		// 如果是字符、文本、短文本或长文本类型，则用单引号括起来的字符串表示
-		case ZBX_TYPE_CHAR:
-		case ZBX_TYPE_TEXT:
-		case ZBX_TYPE_SHORTTEXT:
-		case ZBX_TYPE_LONGTEXT:
-			zbx_snprintf_alloc(&str, &str_alloc, &str_offset, "'%s'", value->str);
-			break;
-
-		// 如果是浮点类型，则用科学计数法表示
-		case ZBX_TYPE_FLOAT:
-			zbx_snprintf_alloc(&str, &str_alloc, &str_offset, ZBX_FS_DBL, value->dbl);
-			break;
-
-		// 如果是整数或无符号整数类型，则用十进制表示
-		case ZBX_TYPE_ID:
-		case ZBX_TYPE_UINT:
-			zbx_snprintf_alloc(&str, &str_alloc, &str_offset, ZBX_FS_UI64, value->ui64);
-			break;
-
-		// 如果是整数类型，则用十进制表示
-		case ZBX_TYPE_INT:
-			zbx_snprintf_alloc(&str, &str_alloc, &str_offset, "%d", value->i32);
-			break;
+		// 获取当前字段
+		ZBX_FIELD		*field = fields[i];
+		const zbx_db_value_t	*value = &values[i];
 
-		// 如果是未知类型，则用 "(unknown type)" 表示
-		default:
-			zbx_strcpy_alloc(&str, &str_alloc, &str_offset, "(unknown type)");
-			break;
-	}
-}
+		// 如果当前不是第一个字段，则在字符串中添加一个逗号
+		if (0 < i)
+			zbx_chrcpy_alloc(&str, &str_alloc, &str_offset, ',');
 
-// 返回格式化后的字符串
-return str;
+		// 根据字段的类型进行格式化
+		switch (field->type)
+		{
+			// 如果是字符、文本、短文本或长文本类型，则用单引号括起来的字符串表示
+			case ZBX_TYPE_CHAR:
+			case ZBX_TYPE_TEXT:
+			case ZBX_TYPE_SHORTTEXT:
+			case ZBX_TYPE_LONGTEXT:
+				zbx_snprintf_alloc(&str, &str_alloc, &str_offset, "'%s'", value->str);
+				break;
 
+			// 如果是浮点类型，则用科学计数法表示
+			case ZBX_TYPE_FLOAT:
 				zbx_snprintf_alloc(&str, &str_alloc, &str_offset, ZBX_FS_DBL, value->dbl);
 				break;
+
+			// 如果是整数或无符号整数类型，则用十进制表示
 			case ZBX_TYPE_ID:
 			case ZBX_TYPE_UINT:
 				zbx_snprintf_alloc(&str, &str_alloc, &str_offset, ZBX_FS_UI64, value->ui64);
 				break;
+
+			// 如果是整数类型，则用十进制表示
 			case ZBX_TYPE_INT:
 				zbx_snprintf_alloc(&str, &str_alloc, &str_offset, "%d", value->i32);
 				break;
+
+			// 如果是未知类型，则用 "(unknown type)" 表示
 			default:
 				zbx_strcpy_alloc(&str, &str_alloc, &str_offset, "(unknown type)");
 				break;
 		}
 	}
 
+	// 返回格式化后的字符串
 	return str;
 }
 #endif
@@ -3592,7 +3381,6 @@ void	zbx_db_insert_clean(zbx_db_insert_t *self)
 	zbx_vector_ptr_destroy(&self->fields);
 }
 
-
 /******************************************************************************
  *                                                                            *
  * Function: zbx_db_insert_prepare_dyn                                        *
@@ -3623,113 +3411,98 @@ void	zbx_db_insert_clean(zbx_db_insert_t *self)
  *这块代码的主要目的是预处理插入数据时的动态数据结构。它创建了一个zbx_db_insert_t类型的对象，设置了表名、字段数组和自动递增字段等属性。同时，还将字段数组中的所有元素添加到对象的字段数组中。在程序执行过程中，这个对象将用于插入数据到数据库。
  ******************************************************************************/
 // 定义一个函数，用于预处理插入数据时的动态数据结构
-void zbx_db_insert_prepare_dyn(zbx_db_insert_t *self, const ZBX_TABLE *table, const ZBX_FIELD **fields, int fields_num)
+void	zbx_db_insert_prepare_dyn(zbx_db_insert_t *self, const ZBX_TABLE *table, const ZBX_FIELD **fields, int fields_num)
 {
 	// 定义一个循环变量 i，用于遍历 fields 数组
-	int i;
+	int	i;
 
 	// 检查 fields_num 是否为0，如果不是，则说明 fields 数组为空，这种情况不应该发生，退出程序
 	if (0 == fields_num)
-/******************************************************************************
- * *
- *整个代码块的主要目的是为插入数据到数据库做准备。该函数接收一个zbx_db_insert_t类型的指针、一个表名以及可变数量的参数（用于存储字段名）。首先，它查找数据库架构中的表和字段，然后创建一个字段列表。接着，遍历可变数量的参数，获取字段名并将其添加到字段列表中。最后，调用zbx_db_insert_prepare_dyn函数准备插入数据。在整个过程中，如果遇到表或字段找不到的情况，会记录日志并退出程序。
- ******************************************************************************/
-void zbx_db_insert_prepare(zbx_db_insert_t *self, const char *table, ...)
-{
-	// 定义一个指向zbx_db_insert_t结构体的指针，用于传递参数
-	zbx_db_insert_t *self;
-	// 定义一个字符串指针，用于存储表名
-	const char *table;
-	// 使用变量参数列表（va_list）来接收后续的参数
-	va_list args;
-
-	// 初始化一个zbx_vector_ptr_t类型的变量fields，用于存储字段信息
-	zbx_vector_ptr_t fields;
-	// 初始化一个char类型的指针变量field，用于存储字段名
-	char *field;
-	// 初始化一个指向ZBX_TABLE类型的指针，用于存储表结构信息
-	const ZBX_TABLE *ptable;
-	// 初始化一个指向ZBX_FIELD类型的指针，用于存储字段结构信息
-	const ZBX_FIELD *pfield;
-
-	/* 查找数据库架构中的表和字段 */
-	if (NULL == (ptable = DBget_table(table)))
 	{
-		// 表名找不到，这是一个不可能的情况，记录日志并退出程序
 		THIS_SHOULD_NEVER_HAPPEN;
 		exit(EXIT_FAILURE);
 	}
 
-	// 开始解析变量参数列表
-	va_start(args, table);
-
-	// 创建一个zbx_vector_ptr_t类型的变量fields，用于存储字段信息
-	zbx_vector_ptr_create(&fields);
-
-	// 遍历变量参数列表，获取字段名
-	while (NULL != (field = va_arg(args, char *)))
-	{
-		// 查找表结构中的字段
-		if (NULL == (pfield = DBget_field(ptable, field)))
-		{
-			// 找不到字段，记录日志并退出程序
-			zabbix_log(LOG_LEVEL_ERR, "Cannot locate table \"%s\" field \"%s\" in database schema",
-					table, field);
-			THIS_SHOULD_NEVER_HAPPEN;
-			exit(EXIT_FAILURE);
-		}
-		// 将字段添加到fields vector中
-		zbx_vector_ptr_append(&fields, (ZBX_FIELD *)pfield);
-	}
+	self->autoincrement = -1;
+	self->copy = 0;
 
-	va_end(args);
+	zbx_vector_ptr_create(&self->fields);
+	zbx_vector_ptr_create(&self->rows);
 
-	// 调用zbx_db_insert_prepare_dyn函数，准备插入数据
-	zbx_db_insert_prepare_dyn(self, ptable, (const ZBX_FIELD **)fields.values, fields.values_num);
+	self->table = table;
 
-	// 释放fields vector占用的内存
-	zbx_vector_ptr_destroy(&fields);
+	for (i = 0; i < fields_num; i++)
+		zbx_vector_ptr_append(&self->fields, (ZBX_FIELD *)fields[i]);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_db_insert_prepare                                            *
+ *                                                                            *
+ * Purpose: prepare for database bulk insert operation                        *
+ *                                                                            *
+ * Parameters: self  - [IN] the bulk insert data                              *
+ *             table - [IN] the target table name                             *
+ *             ...   - [IN] names of the fields to insert                     *
+ *             NULL  - [IN] terminating NULL pointer                          *
+ *                                                                            *
  * Comments: This is a convenience wrapper for zbx_db_insert_prepare_dyn()    *
  *           function.                                                        *
  *                                                                            *
  ******************************************************************************/
+/******************************************************************************
+ * *
+ *整个代码块的主要目的是为插入数据到数据库做准备。该函数接收一个zbx_db_insert_t类型的指针、一个表名以及可变数量的参数（用于存储字段名）。首先，它查找数据库架构中的表和字段，然后创建一个字段列表。接着，遍历可变数量的参数，获取字段名并将其添加到字段列表中。最后，调用zbx_db_insert_prepare_dyn函数准备插入数据。在整个过程中，如果遇到表或字段找不到的情况，会记录日志并退出程序。
+ ******************************************************************************/
 void	zbx_db_insert_prepare(zbx_db_insert_t *self, const char *table, ...)
 {
+	// 初始化一个zbx_vector_ptr_t类型的变量fields，用于存储字段信息
 	zbx_vector_ptr_t	fields;
+	// 初始化一个char类型的指针变量field，用于存储字段名
 	va_list			args;
 	char			*field;
+	// 初始化一个指向ZBX_TABLE类型的指针，用于存储表结构信息
 	const ZBX_TABLE		*ptable;
+	// 初始化一个指向ZBX_FIELD类型的指针，用于存储字段结构信息
 	const ZBX_FIELD		*pfield;
 
+	/* 查找数据库架构中的表和字段 */
 	/* find the table and fields in database schema */
 	if (NULL == (ptable = DBget_table(table)))
 	{
+		// 表名找不到，这是一个不可能的情况，记录日志并退出程序
 		THIS_SHOULD_NEVER_HAPPEN;
 		exit(EXIT_FAILURE);
 	}
 
+	// 开始解析变量参数列表
 	va_start(args, table);
 
+	// 创建一个zbx_vector_ptr_t类型的变量fields，用于存储字段信息
 	zbx_vector_ptr_create(&fields);
 
+	// 遍历变量参数列表，获取字段名
 	while (NULL != (field = va_arg(args, char *)))
 	{
+		// 查找表结构中的字段
 		if (NULL == (pfield = DBget_field(ptable, field)))
 		{
+			// 找不到字段，记录日志并退出程序
 			zabbix_log(LOG_LEVEL_ERR, "Cannot locate table \"%s\" field \"%s\" in database schema",
 					table, field);
 			THIS_SHOULD_NEVER_HAPPEN;
 			exit(EXIT_FAILURE);
 		}
+		// 将字段添加到fields vector中
 		zbx_vector_ptr_append(&fields, (ZBX_FIELD *)pfield);
 	}
 
 	va_end(args);
 
+	// 调用zbx_db_insert_prepare_dyn函数，准备插入数据
 	zbx_db_insert_prepare_dyn(self, ptable, (const ZBX_FIELD **)fields.values, fields.values_num);
 
+	// 释放fields vector占用的内存
 	zbx_vector_ptr_destroy(&fields);
 }
 
@@ -3752,12 +3525,12 @@ void	zbx_db_insert_prepare(zbx_db_insert_t *self, const char *table, ...)
  *整个代码块的主要目的是：接收一个 zbx_db_insert_t 类型的指针（表示数据库插入操作的结构体）、一个 zbx_db_value_t 类型的指针数组（表示要插入的数据值）以及数据值的数量，然后动态生成一个数据行，并将该数据行添加到数据库插入操作的结构体的 rows 向量中。在这个过程中，还对数据值进行了转义处理，以防止 SQL 注入。
  ******************************************************************************/
 // 定义一个函数，用于向数据库插入动态生成的数据行
-void zbx_db_insert_add_values_dyn(zbx_db_insert_t *self, const zbx_db_value_t **values, int values_num)
+void	zbx_db_insert_add_values_dyn(zbx_db_insert_t *self, const zbx_db_value_t **values, int values_num)
 {
 	// 定义一个整型变量 i，用于循环计数
-	int i;
+	int		i;
 	// 定义一个指向 zbx_db_value_t 类型的指针 row，用于存储数据行
-	zbx_db_value_t *row;
+	zbx_db_value_t	*row;
 
 	// 检查传入的 values 数量是否与 self->fields.values_num 相等
 	if (values_num != self->fields.values_num)
@@ -3775,9 +3548,9 @@ void zbx_db_insert_add_values_dyn(zbx_db_insert_t *self, const zbx_db_value_t **
 	for (i = 0; i < self->fields.values_num; i++)
 	{
 		// 获取当前字段的指针
-		ZBX_FIELD *field = (ZBX_FIELD *)self->fields.values[i];
+		ZBX_FIELD		*field = (ZBX_FIELD *)self->fields.values[i];
 		// 获取当前字段的值指针
-		const zbx_db_value_t *value = values[i];
+		const zbx_db_value_t	*value = values[i];
 
 		// 根据字段类型进行不同处理
 		switch (field->type)
@@ -3801,6 +3574,24 @@ void zbx_db_insert_add_values_dyn(zbx_db_insert_t *self, const zbx_db_value_t **
 		}
 	}
 
+	zbx_vector_ptr_append(&self->rows, row);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_db_insert_add_values                                         *
+ *                                                                            *
+ * Purpose: adds row values for database bulk insert operation                *
+ *                                                                            *
+ * Parameters: self - [IN] the bulk insert data                               *
+ *             ...  - [IN] the values to insert                               *
+ *                                                                            *
+ * Comments: This is a convenience wrapper for zbx_db_insert_add_values_dyn() *
+ *           function.                                                        *
+ *           Note that the types of the passed values must conform to the     *
+ *           corresponding field types.                                       *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  * *
  *整个代码块的主要目的是：接收一个zbx_db_insert_t类型的指针以及一系列命令行参数，根据传入的ZBX_FIELD结构体，创建对应的zbx_db_value_t结构体，并将这些数据存储在一个zbx_vector_ptr结构体中。最后，调用zbx_db_insert_add_values_dyn函数将这些数据插入到数据库中。在处理完成后，释放分配的内存。
@@ -3874,26 +3665,157 @@ void	zbx_db_insert_add_values(zbx_db_insert_t *self, ...)
 	zbx_vector_ptr_destroy(&values);
 }
 
-				break;
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_db_insert_use_copy                                           *
+ *                                                                            *
+ * Purpose: requests the bulk insert to be executed with COPY command         *
+ *                                                                            *
+ * Parameters: self - [IN] the bulk insert data                               *
+ *                                                                            *
+ * Comments: COPY is used only with PostgreSQL and only when all inserted     *
+ *           fields are numeric, otherwise insert statements are used.        *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_db_insert_use_copy(zbx_db_insert_t *self)
+{
+	self->copy = 1;
+}
+
+#ifdef HAVE_POSTGRESQL
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_db_insert_copy_supported                                     *
+ *                                                                            *
+ * Purpose: checks if the bulk insert fields can be loaded with COPY command  *
+ *                                                                            *
+ * Parameters: self - [IN] the bulk insert data                               *
+ *                                                                            *
+ * Return value: SUCCEED - all fields are numeric                             *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	zbx_db_insert_copy_supported(const zbx_db_insert_t *self)
+{
+	int		i;
+	const ZBX_FIELD	*field;
+
+	for (i = 0; i < self->fields.values_num; i++)
+	{
+		field = (const ZBX_FIELD *)self->fields.values[i];
+
+		switch (field->type)
+		{
+			case ZBX_TYPE_INT:
+			case ZBX_TYPE_FLOAT:
 			case ZBX_TYPE_UINT:
 			case ZBX_TYPE_ID:
-				value->ui64 = va_arg(args, zbx_uint64_t);
 				break;
 			default:
-				THIS_SHOULD_NEVER_HAPPEN;
-				exit(EXIT_FAILURE);
+				return FAIL;
 		}
+	}
 
-		zbx_vector_ptr_append(&values, value);
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_db_insert_execute_copy                                       *
+ *                                                                            *
+ * Purpose: executes the prepared database bulk insert operation with         *
+ *          COPY ... FROM STDIN command                                       *
+ *                                                                            *
+ * Parameters: self - [IN] the bulk insert data                               *
+ *                                                                            *
+ * Return value: Returns SUCCEED if the operation completed successfully or   *
+ *               FAIL otherwise.                                              *
+ *                                                                            *
+ ******************************************************************************/
+static int	zbx_db_insert_execute_copy(zbx_db_insert_t *self)
+{
+	int		rc, i, j;
+	const ZBX_FIELD	*field;
+	char		*sql = NULL, *data, delim[2] = {',', '('};
+	size_t		sql_alloc = 0, sql_offset = 0, data_alloc = 16 * ZBX_KIBIBYTE, data_offset = 0;
+
+	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, "copy ");
+	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, self->table->table);
+	zbx_chrcpy_alloc(&sql, &sql_alloc, &sql_offset, ' ');
+
+	for (i = 0; i < self->fields.values_num; i++)
+	{
+		field = (ZBX_FIELD *)self->fields.values[i];
+
+		zbx_chrcpy_alloc(&sql, &sql_alloc, &sql_offset, delim[0 == i]);
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, field->name);
 	}
 
-	va_end(args);
+	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, ") from stdin");
 
-	zbx_db_insert_add_values_dyn(self, (const zbx_db_value_t **)values.values, values.values_num);
+	/* rows in COPY text format - tab separated columns, newline terminated rows */
+	data = (char *)zbx_malloc(NULL, data_alloc);
 
-	zbx_vector_ptr_clear_ext(&values, zbx_ptr_free);
-	zbx_vector_ptr_destroy(&values);
+	for (i = 0; i < self->rows.values_num; i++)
+	{
+		zbx_db_value_t	*values = (zbx_db_value_t *)self->rows.values[i];
+
+		for (j = 0; j < self->fields.values_num; j++)
+		{
+			const zbx_db_value_t	*value = &values[j];
+
+			field = (const ZBX_FIELD *)self->fields.values[j];
+
+			if (0 != j)
+				zbx_chrcpy_alloc(&data, &data_alloc, &data_offset, '\t');
+
+			switch (field->type)
+			{
+				case ZBX_TYPE_INT:
+					zbx_snprintf_alloc(&data, &data_alloc, &data_offset, "%d", value->i32);
+					break;
+				case ZBX_TYPE_FLOAT:
+					zbx_snprintf_alloc(&data, &data_alloc, &data_offset, ZBX_FS_DBL, value->dbl);
+					break;
+				case ZBX_TYPE_UINT:
+					zbx_snprintf_alloc(&data, &data_alloc, &data_offset, ZBX_FS_UI64, value->ui64);
+					break;
+				case ZBX_TYPE_ID:
+					if (0 == value->ui64)
+						zbx_strcpy_alloc(&data, &data_alloc, &data_offset, "\\N");
+					else
+						zbx_snprintf_alloc(&data, &data_alloc, &data_offset, ZBX_FS_UI64, value->ui64);
+					break;
+				default:
+					THIS_SHOULD_NEVER_HAPPEN;
+					exit(EXIT_FAILURE);
+			}
+		}
+
+		zbx_chrcpy_alloc(&data, &data_alloc, &data_offset, '\n');
+	}
+
+	rc = zbx_db_copy_from(sql, data, data_offset);
+
+	while (ZBX_DB_DOWN == rc)
+	{
+		DBclose();
+		DBconnect(ZBX_DB_CONNECT_NORMAL);
+
+		if (ZBX_DB_DOWN == (rc = zbx_db_copy_from(sql, data, data_offset)))
+		{
+			zabbix_log(LOG_LEVEL_ERR, "database is down: retrying in %d seconds", ZBX_DB_WAIT_DOWN);
+			connection_failure = 1;
+			sleep(ZBX_DB_WAIT_DOWN);
+		}
+	}
+
+	zbx_free(data);
+	zbx_free(sql);
+
+	return ZBX_DB_OK <= rc ? SUCCEED : FAIL;
 }
+#endif
 
 /******************************************************************************
  *                                                                            *
@@ -3920,18 +3842,32 @@ void	zbx_db_insert_add_values(zbx_db_insert_t *self, ...)
  *7. 执行插入操作。
  *8. 释放分配的内存。
  ******************************************************************************/
-int zbx_db_insert_execute(zbx_db_insert_t *self)
+int	zbx_db_insert_execute(zbx_db_insert_t *self)
 {
 	int		ret = FAIL, i, j;
 	const ZBX_FIELD	*field;
 	char		*sql_command, delim[2] = {',', '('};
 	size_t		sql_command_alloc = 512, sql_command_offset = 0;
 
+#ifndef HAVE_ORACLE
+	char		*sql;
+	size_t		sql_alloc = 16 * ZBX_KIBIBYTE, sql_offset = 0;
+
+#	ifdef HAVE_MYSQL
+	char		*sql_values = NULL;
+	size_t		sql_values_alloc = 0, sql_values_offset = 0;
+#	endif
+#else
+	zbx_db_bind_context_t	*contexts;
+	int			rc, tries = 0;
+#endif
+
 	// 检查传入的参数是否合法
 	if (0 == self->rows.values_num)
 		return SUCCEED;
 
 	// 处理自动递增字段
+	/* process the auto increment field */
 	if (-1 != self->autoincrement)
 	{
 		zbx_uint64_t	id;
@@ -3946,10 +3882,19 @@ int zbx_db_insert_execute(zbx_db_insert_t *self)
 		}
 	}
 
+#ifdef HAVE_POSTGRESQL
+	if (0 != self->copy && SUCCEED == zbx_db_insert_copy_supported(self))
+		return zbx_db_insert_execute_copy(self);
+#endif
+
 	// 分配内存用于存储SQL插入语句
+#ifndef HAVE_ORACLE
+	sql = (char *)zbx_malloc(NULL, sql_alloc);
+#endif
 	sql_command = (char *)zbx_malloc(NULL, sql_command_alloc);
 
 	// 构建SQL插入语句
+	/* create sql insert statement command */
 	zbx_strcpy_alloc(&sql_command, &sql_command_alloc, &sql_command_offset, "insert into ");
 	zbx_strcpy_alloc(&sql_command, &sql_command_alloc, &sql_command_offset, self->table->table);
 	zbx_chrcpy_alloc(&sql_command, &sql_command_alloc, &sql_command_offset, ' ');
@@ -3962,25 +3907,184 @@ int zbx_db_insert_execute(zbx_db_insert_t *self)
 		zbx_strcpy_alloc(&sql_command, &sql_command_alloc, &sql_command_offset, field->name);
 	}
 
-	// 添加MySQL特定处理
+// 添加MySQL特定处理
+#ifdef HAVE_MYSQL
+	/* MySQL workaround - explicitly add missing text fields with '' default value */
+	for (field = (const ZBX_FIELD *)self->table->fields; NULL != field->name; field++)
+	{
+		switch (field->type)
+		{
+			case ZBX_TYPE_BLOB:
+			case ZBX_TYPE_TEXT:
+			case ZBX_TYPE_SHORTTEXT:
+			case ZBX_TYPE_LONGTEXT:
+				if (FAIL != zbx_vector_ptr_search(&self->fields, (void *)field,
+						ZBX_DEFAULT_PTR_COMPARE_FUNC))
+				{
+					continue;
+				}
+
+				zbx_chrcpy_alloc(&sql_command, &sql_command_alloc, &sql_command_offset, ',');
+				zbx_strcpy_alloc(&sql_command, &sql_command_alloc, &sql_command_offset, field->name);
+
+				zbx_strcpy_alloc(&sql_values, &sql_values_alloc, &sql_values_offset, ",''");
+				break;
+		}
+	}
+#endif
 	zbx_strcpy_alloc(&sql_command, &sql_command_alloc, &sql_command_offset, ") values ");
 
-	// 预处理SQL语句
-	zbx_free(sql_command);
+// 预处理SQL语句
+#ifdef HAVE_ORACLE
+	for (i = 0; i < self->fields.values_num; i++)
+	{
+		zbx_chrcpy_alloc(&sql_command, &sql_command_alloc, &sql_command_offset, delim[0 == i]);
+		zbx_snprintf_alloc(&sql_command, &sql_command_alloc, &sql_command_offset, ":%d", i + 1);
+	}
+	zbx_chrcpy_alloc(&sql_command, &sql_command_alloc, &sql_command_offset, ')');
 
-#ifndef HAVE_ORACLE
-	sql = (char *)zbx_malloc(NULL, sql_alloc);
+	contexts = (zbx_db_bind_context_t *)zbx_malloc(NULL, sizeof(zbx_db_bind_context_t) * self->fields.values_num);
+
+retry_oracle:
+	DBstatement_prepare(sql_command);
+
+	for (j = 0; j < self->fields.values_num; j++)
+	{
+		field = (ZBX_FIELD *)self->fields.values[j];
+
+		if (ZBX_DB_OK > zbx_db_bind_parameter_dyn(&contexts[j], j, field->type,
+				(zbx_db_value_t **)self->rows.values, self->rows.values_num))
+		{
+			for (i = 0; i < j; i++)
+				zbx_db_clean_bind_context(&contexts[i]);
+
+			goto out;
+		}
+	}
+
+	if (SUCCEED == ZBX_CHECK_LOG_LEVEL(LOG_LEVEL_DEBUG))
+	{
+		for (i = 0; i < self->rows.values_num; i++)
+		{
+			zbx_db_value_t	*values = (zbx_db_value_t *)self->rows.values[i];
+			char	*str;
+
+			str = zbx_db_format_values((ZBX_FIELD **)self->fields.values, values, self->fields.values_num);
+			zabbix_log(LOG_LEVEL_DEBUG, "insert [txnlev:%d] [%s]", zbx_db_txn_level(), str);
+			zbx_free(str);
+		}
+	}
+
+	rc = zbx_db_statement_execute(self->rows.values_num);
+
+	for (j = 0; j < self->fields.values_num; j++)
+		zbx_db_clean_bind_context(&contexts[j]);
+
+	if (ZBX_DB_DOWN == rc)
+	{
+		if (0 < tries++)
+		{
+			zabbix_log(LOG_LEVEL_ERR, "database is down: retrying in %d seconds", ZBX_DB_WAIT_DOWN);
+			connection_failure = 1;
+			sleep(ZBX_DB_WAIT_DOWN);
+		}
+
+		DBclose();
+		DBconnect(ZBX_DB_CONNECT_NORMAL);
+
+		goto retry_oracle;
+	}
+
+	ret = (ZBX_DB_OK <= rc ? SUCCEED : FAIL);
+
+#else
+	DBbegin_multiple_update(&sql, &sql_alloc, &sql_offset);
+
+	for (i = 0; i < self->rows.values_num; i++)
+	{
+		zbx_db_value_t	*values = (zbx_db_value_t *)self->rows.values[i];
+
+#	ifdef HAVE_MULTIROW_INSERT
+		if (16 > sql_offset)
+			zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, sql_command);
+#	else
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, sql_command);
+#	endif
+		for (j = 0; j < self->fields.values_num; j++)
+		{
+			const zbx_db_value_t	*value = &values[j];
+
+			field = (const ZBX_FIELD *)self->fields.values[j];
+
+			zbx_chrcpy_alloc(&sql, &sql_alloc, &sql_offset, delim[0 == j]);
+
+			switch (field->type)
+			{
+				case ZBX_TYPE_CHAR:
+				case ZBX_TYPE_TEXT:
+				case ZBX_TYPE_SHORTTEXT:
+				case ZBX_TYPE_LONGTEXT:
+					zbx_chrcpy_alloc(&sql, &sql_alloc, &sql_offset, '\'');
+					zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, value->str);
+					zbx_chrcpy_alloc(&sql, &sql_alloc, &sql_offset, '\'');
+					break;
+				case ZBX_TYPE_INT:
+					zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "%d", value->i32);
+					break;
+				case ZBX_TYPE_FLOAT:
+					zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, ZBX_FS_DBL,
+							value->dbl);
+					break;
+				case ZBX_TYPE_UINT:
+					zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, ZBX_FS_UI64,
+							value->ui64);
+					break;
+				case ZBX_TYPE_ID:
+					zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset,
+							DBsql_id_ins(value->ui64));
+					break;
+				default:
+					THIS_SHOULD_NEVER_HAPPEN;
+					exit(EXIT_FAILURE);
+			}
+		}
+#	ifdef HAVE_MYSQL
+		if (NULL != sql_values)
+			zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, sql_values);
+#	endif
+
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, ")" ZBX_ROW_DL);
+
+		if (SUCCEED != (ret = DBexecute_overflowed_sql(&sql, &sql_alloc, &sql_offset)))
+			goto out;
+	}
+
+	if (16 < sql_offset)
+	{
+#	ifdef HAVE_MULTIROW_INSERT
+		if (',' == sql[sql_offset - 1])
+		{
+			sql_offset--;
+			zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, ";\n");
+		}
+#	endif
+		DBend_multiple_update(sql, sql_alloc, sql_offset);
+
+		if (ZBX_DB_OK > DBexecute("%s", sql))
+			ret = FAIL;
+	}
 #endif
 
-	// 执行插入操作
-	ret = zbx_db_insert_execute_internal(self, sql, sql_alloc);
+out:
+	zbx_free(sql_command);
 
+#ifndef HAVE_ORACLE
 	// 释放分配的内存
 	zbx_free(sql);
 
-#ifdef HAVE_MYSQL
+#	ifdef HAVE_MYSQL
 	zbx_free(sql_values);
-#endif
+#	endif
 #else
 	zbx_free(contexts);
 #endif
@@ -3988,7 +4092,6 @@ int zbx_db_insert_execute(zbx_db_insert_t *self)
 	return ret;
 }
 
-
 /******************************************************************************
  *                                                                            *
  * Function: zbx_db_insert_autoincrement                                      *
@@ -4028,6 +4131,17 @@ void zbx_db_insert_autoincrement(zbx_db_insert_t *self, const char *field_name)
 	exit(EXIT_FAILURE);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_db_get_database_type                                         *
+ *                                                                            *
+ * Purpose: determine is it a server or a proxy database                      *
+ *                                                                            *
+ * Return value: ZBX_DB_SERVER - server database                              *
+ *               ZBX_DB_PROXY - proxy database                                *
+ *               ZBX_DB_UNKNOWN - an error occurred                           *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  * *
  *整个代码块的主要目的是从一个名为\"users\"的数据库表中获取userid字段的数据，根据userid的值判断数据库类型（服务器或代理），并返回相应的类型标识。输出结果为：
@@ -4112,19 +4226,6 @@ out:
 	return ret;
 }
 
-		case ZBX_DB_PROXY:
-			result_string = "ZBX_DB_PROXY";
-			break;
-		case ZBX_DB_UNKNOWN:
-			result_string = "ZBX_DB_UNKNOWN";
-			break;
-	}
-
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, result_string);
-
-	return ret;
-}
-
 /******************************************************************************
  *                                                                            *
  * Function: DBlock_record                                                    *
@@ -4150,13 +4251,17 @@ out:
 // 2. 一个zbx_uint64_t类型的id，表示要查询的主键ID；
 // 3. 一个字符串指针add_field，表示要查询的附加字段名；
 // 4. 一个zbx_uint64_t类型的add_id，表示要查询的附加字段值。
-int DBlock_record(const char *table, zbx_uint64_t id, const char *add_field, zbx_uint64_t add_id)
+int	DBlock_record(const char *table, zbx_uint64_t id, const char *add_field, zbx_uint64_t add_id)
 {
 	// 定义一个常量字符串__function_name，值为"DBlock_record"，用于记录函数名
+	const char	*__function_name = "DBlock_record";
 
 	// 定义一个DB_RESULT类型的变量result，用于存储数据库操作结果
+	DB_RESULT	result;
 	// 定义一个const ZBX_TABLE类型的指针变量t，用于存储表格信息
+	const ZBX_TABLE	*t;
 	// 定义一个int类型的变量ret，用于存储函数返回值
+	int		ret;
 
 	// 打印调试信息，表示进入DBlock_record函数
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
@@ -4198,7 +4303,6 @@ int DBlock_record(const char *table, zbx_uint64_t id, const char *add_field, zbx
 	return ret;
 }
 
-
 /******************************************************************************
  *                                                                            *
  * Function: DBlock_records                                                   *
@@ -4276,7 +4380,6 @@ int DBlock_records(const char *table, const zbx_vector_uint64_t *ids)
     return ret;
 }
 
-
 /******************************************************************************
  *                                                                            *
  * Function: zbx_sql_add_host_availability                                    *
@@ -4362,7 +4465,6 @@ int zbx_sql_add_host_availability(char **sql, size_t *sql_alloc, size_t *sql_off
 	return SUCCEED;
 }
 
-
 /******************************************************************************
  *                                                                            *
  * Function: DBget_user_by_active_session                                     *
@@ -4380,62 +4482,59 @@ int zbx_sql_add_host_availability(char **sql, size_t *sql_alloc, size_t *sql_off
  * *
  *整个代码块的主要目的是从一个active session中获取对应的用户信息，并将用户ID和类型存储在`zbx_user_t`结构体指针所指向的内存空间中。函数输入参数为一个sessionid字符串和一个`zbx_user_t`结构体指针，输出为一个布尔值，表示查询是否成功。在函数内部，首先对sessionid进行转义，然后执行SQL查询语句，从数据库中获取用户信息。接着将查询结果中的用户ID和类型转换为uint64和整数类型，并存储在`zbx_user_t`结构体中。最后，释放内存并返回查询结果。
  ******************************************************************************/
-// 定义函数名和日志级别
-const char *__function_name = "DBget_user_by_active_session";
-int	LOG_LEVEL_DEBUG = 1;
-
-// 定义函数原型
-int DBget_user_by_active_session(const char *sessionid, zbx_user_t *user);
-
-// 初始化变量
-char		*sessionid_esc;
-int		ret = FAIL;
-DB_RESULT	result;
-DB_ROW		row;
-
-// 记录日志
-zabbix_log(LOG_LEVEL_DEBUG, "In %s() sessionid:%s", __function_name, sessionid);
-
-// 对sessionid进行转义，防止SQL注入
-sessionid_esc = DBdyn_escape_string(sessionid);
-
-// 执行SQL查询，从数据库中获取用户信息
-if (NULL == (result = DBselect(
-    "select u.userid,u.type"
-        " from sessions s,users u"
-    " where s.userid=u.userid"
-        " and s.sessionid='%s'"
-        " and s.status=%d",
-    sessionid_esc, ZBX_SESSION_ACTIVE)))
+int	DBget_user_by_active_session(const char *sessionid, zbx_user_t *user)
 {
-    // 如果查询失败，跳转到out标签处
-    goto out;
-}
+	// 定义函数名和日志级别
+	const char *__function_name = "DBget_user_by_active_session";
 
-// 从查询结果中获取一行数据
-if (NULL == (row = DBfetch(result)))
-{
-    // 如果数据获取失败，跳转到out标签处
-    goto out;
-}
+	// 初始化变量
+	char		*sessionid_esc;
+	int		ret = FAIL;
+	DB_RESULT	result;
+	DB_ROW		row;
+
+	// 记录日志
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() sessionid:%s", __function_name, sessionid);
+
+	// 对sessionid进行转义，防止SQL注入
+	sessionid_esc = DBdyn_escape_string(sessionid);
+
+	// 执行SQL查询，从数据库中获取用户信息
+	if (NULL == (result = DBselect(
+		"select u.userid,u.type"
+			" from sessions s,users u"
+		" where s.userid=u.userid"
+			" and s.sessionid='%s'"
+			" and s.status=%d",
+		sessionid_esc, ZBX_SESSION_ACTIVE)))
+	{
+		// 如果查询失败，跳转到out标签处
+		goto out;
+	}
+
+	// 从查询结果中获取一行数据
+	if (NULL == (row = DBfetch(result)))
+	{
+		// 如果数据获取失败，跳转到out标签处
+		goto out;
+	}
 
-// 将查询结果中的用户ID和类型转换为uint64和整数类型
-ZBX_STR2UINT64(user->userid, row[0]);
-user->type = atoi(row[1]);
+	// 将查询结果中的用户ID和类型转换为uint64和整数类型
+	ZBX_STR2UINT64(user->userid, row[0]);
+	user->type = atoi(row[1]);
 
-// 标记查询成功，将ret变量设置为SUCCEED
-ret = SUCCEED;
+	// 标记查询成功，将ret变量设置为SUCCEED
+	ret = SUCCEED;
 
 out:
-    // 释放查询结果
-    DBfree_result(result);
-    // 释放sessionid_esc内存
-    zbx_free(sessionid_esc);
+	// 释放查询结果
+	DBfree_result(result);
+	// 释放sessionid_esc内存
+	zbx_free(sessionid_esc);
 
-    // 记录日志
-    zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
+	// 记录日志
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
 
-    // 返回查询结果
-    return ret;
+	// 返回查询结果
+	return ret;
 }
-
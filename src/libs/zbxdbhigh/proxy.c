@@ -144,7 +144,7 @@ int zbx_proxy_check_permissions(const DC_PROXY *proxy, const zbx_socket_t *sock,
 {
     // 定义一些常量，用于表示不同的连接类型
 #if defined(HAVE_POLARSSL) || defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
-    const char *const connection_type_names[] = {"\0", "tls", "tls-psk", "unencrypted"};
+    zbx_tls_conn_attr_t	attr;
 #endif
 
     // 检查代理地址是否为空，并且检查是否允许连接
@@ -154,6 +154,7 @@ int zbx_proxy_check_permissions(const DC_PROXY *proxy, const zbx_socket_t *sock,
         return FAIL;
     }
 
+#if defined(HAVE_POLARSSL) || defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
     // 判断连接类型，根据不同的连接类型进行相应的权限检查
     if (ZBX_TCP_SEC_TLS_CERT == sock->connection_type)
     {
@@ -164,6 +165,7 @@ int zbx_proxy_check_permissions(const DC_PROXY *proxy, const zbx_socket_t *sock,
             return FAIL;
         }
     }
+#if defined(HAVE_POLARSSL) || defined(HAVE_GNUTLS) || (defined(HAVE_OPENSSL) && defined(HAVE_OPENSSL_WITH_PSK))
     // 非TLS连接类型
     else if (ZBX_TCP_SEC_TLS_PSK == sock->connection_type)
     {
@@ -174,6 +176,7 @@ int zbx_proxy_check_permissions(const DC_PROXY *proxy, const zbx_socket_t *sock,
             return FAIL;
         }
     }
+#endif
     // 非TLS和非PSK连接类型
     else if (ZBX_TCP_SEC_UNENCRYPTED != sock->connection_type)
     {
@@ -181,6 +184,7 @@ int zbx_proxy_check_permissions(const DC_PROXY *proxy, const zbx_socket_t *sock,
         THIS_SHOULD_NEVER_HAPPEN;
         return FAIL;
     }
+#endif
 
     // 检查连接类型是否允许
     if (0 == ((unsigned int)proxy->tls_accept & sock->connection_type))
@@ -190,6 +194,7 @@ int zbx_proxy_check_permissions(const DC_PROXY *proxy, const zbx_socket_t *sock,
         return FAIL;
     }
 
+#if defined(HAVE_POLARSSL) || defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
     // 针对TLS连接类型，检查证书颁发机构和主体是否匹配
     if (ZBX_TCP_SEC_TLS_CERT == sock->connection_type)
     {
@@ -205,6 +210,7 @@ int zbx_proxy_check_permissions(const DC_PROXY *proxy, const zbx_socket_t *sock,
             return FAIL;
         }
     }
+#if defined(HAVE_POLARSSL) || defined(HAVE_GNUTLS) || (defined(HAVE_OPENSSL) && defined(HAVE_OPENSSL_WITH_PSK))
     // 针对TLS PSK连接类型，检查PSK身份是否匹配
     else if (ZBX_TCP_SEC_TLS_PSK == sock->connection_type)
     {
@@ -215,6 +221,8 @@ int zbx_proxy_check_permissions(const DC_PROXY *proxy, const zbx_socket_t *sock,
             return FAIL;
         }
     }
+#endif
+#endif
 
     // 整个权限检查流程完成后，返回成功
     return SUCCEED;
@@ -264,7 +272,7 @@ static int	zbx_host_check_permissions(const DC_HOST *host, const zbx_socket_t *s
 		if (SUCCEED != zbx_tls_get_attr_cert(sock, &attr))
 		{
 			// 错误处理：内存分配失败
-			*error = zbx_strdup(*error, "内部错误：无法获取连接属性");
+			*error = zbx_strdup(*error, "internal error: cannot get connection attributes");
 			THIS_SHOULD_NEVER_HAPPEN;
 			return FAIL;
 		}
@@ -277,7 +285,7 @@ static int	zbx_host_check_permissions(const DC_HOST *host, const zbx_socket_t *s
 		if (SUCCEED != zbx_tls_get_attr_psk(sock, &attr))
 		{
 			// 错误处理：内存分配失败
-			*error = zbx_strdup(*error, "内部错误：无法获取连接属性");
+			*error = zbx_strdup(*error, "internal error: cannot get connection attributes");
 			THIS_SHOULD_NEVER_HAPPEN;
 			return FAIL;
 		}
@@ -287,7 +295,7 @@ static int	zbx_host_check_permissions(const DC_HOST *host, const zbx_socket_t *s
 	else if (ZBX_TCP_SEC_UNENCRYPTED != sock->connection_type)
 	{
 		// 错误处理：无效的连接类型
-		*error = zbx_strdup(*error, "内部错误：无效的连接类型");
+		*error = zbx_strdup(*error, "internal error: invalid connection type");
 		THIS_SHOULD_NEVER_HAPPEN;
 		return FAIL;
 	}
@@ -297,7 +305,7 @@ static int	zbx_host_check_permissions(const DC_HOST *host, const zbx_socket_t *s
 	if (0 == ((unsigned int)host->tls_accept & sock->connection_type))
 	{
 		// 错误处理：主机不允许当前连接类型
-		*error = zbx_dsprintf(NULL, "连接类型 \"%s\" 在主机 \"%s\" 上不被允许"，
+		*error = zbx_dsprintf(NULL, "connection of type \"%s\" is not allowed for host \"%s\"",
 				zbx_tcp_connection_type_name(sock->connection_type), host->host);
 		return FAIL;
 	}
@@ -310,7 +318,7 @@ static int	zbx_host_check_permissions(const DC_HOST *host, const zbx_socket_t *s
 		if ('\0' != *host->tls_issuer && 0 != strcmp(host->tls_issuer, attr.issuer))
 		{
 			// 错误处理：主机证书颁发者不匹配
-			*error = zbx_dsprintf(*error, "主机 \"%s\" 证书颁发者不匹配"， host->host);
+			*error = zbx_dsprintf(*error, "host \"%s\" certificate issuer does not match", host->host);
 			return FAIL;
 		}
 
@@ -318,27 +326,27 @@ static int	zbx_host_check_permissions(const DC_HOST *host, const zbx_socket_t *s
 		if ('\0' != *host->tls_subject && 0 != strcmp(host->tls_subject, attr.subject))
 		{
 			// 错误处理：主机证书主体不匹配
-			*error = zbx_dsprintf(*error, "主机 \"%s\" 证书主体不匹配"， host->host);
+			*error = zbx_dsprintf(*error, "host \"%s\" certificate subject does not match", host->host);
 			return FAIL;
 		}
 	}
-	#endif
-
-	// 检查TLS预共享密钥连接的标识符是否匹配
-	#if defined(HAVE_POLARSSL) || defined(HAVE_GNUTLS) || (defined(HAVE_OPENSSL) && defined(HAVE_OPENSSL_WITH_PSK))
+#if defined(HAVE_POLARSSL) || defined(HAVE_GNUTLS) || (defined(HAVE_OPENSSL) && defined(HAVE_OPENSSL_WITH_PSK))
 	else if (ZBX_TCP_SEC_TLS_PSK == sock->connection_type)
 	{
-		// 检查PSK标识符是否匹配
 		if (strlen(host->tls_psk_identity) != attr.psk_identity_len ||
 				0 != memcmp(host->tls_psk_identity, attr.psk_identity, attr.psk_identity_len))
 		{
-			// 错误处理：主机使用错误的PSK标识符
-			*error = zbx_dsprintf(*error, "主机 \"%s\" 使用了错误的PSK标识符"， host->host);
+			*error = zbx_dsprintf(*error, "host \"%s\" is using false PSK identity", host->host);
 			return FAIL;
 		}
 	}
 	#endif
 
+	// 检查TLS预共享密钥连接的标识符是否匹配
+		// 检查PSK标识符是否匹配
+			// 错误处理：主机使用错误的PSK标识符
+	#endif
+
 	// 如果没有错误，返回成功
 	return SUCCEED;
 }
@@ -373,6 +381,7 @@ static int	zbx_host_check_permissions(const DC_HOST *host, const zbx_socket_t *s
 
 int	get_active_proxy_from_request(struct zbx_json_parse *jp, DC_PROXY *proxy, char **error)
 {
+	char	*ch_error, host[HOST_HOST_LEN_MAX];
 	// 定义一个字符串指针ch_error，以及一个长度为HOST_HOST_LEN_MAX的字符串host。
 
 	// 使用zbx_json_value_by_name函数从json解析结构体中获取代理服务器的名称，将其存储在host字符串中。
@@ -404,6 +413,63 @@ int	get_active_proxy_from_request(struct zbx_json_parse *jp, DC_PROXY *proxy, ch
  * Function: check_access_passive_proxy                                       *
  *                                                                            *
  * Purpose:                                                                   *
+ *     Check access rights to a passive proxy for the given connection and    *
+ *     send a response if denied.                                             *
+ *                                                                            *
+ * Parameters:                                                                *
+ *     sock          - [IN] connection socket context                         *
+ *     send_response - [IN] to send or not to send a response to server.      *
+ *                          Value: ZBX_SEND_RESPONSE or                       *
+ *                          ZBX_DO_NOT_SEND_RESPONSE                          *
+ *     req           - [IN] request, included into error message              *
+ *                                                                            *
+ * Return value:                                                              *
+ *     SUCCEED - access is allowed                                            *
+ *     FAIL    - access is denied                                             *
+ *                                                                            *
+ ******************************************************************************/
+int	check_access_passive_proxy(zbx_socket_t *sock, int send_response, const char *req)
+{
+	char	*msg = NULL;
+
+	if (FAIL == zbx_tcp_check_allowed_peers(sock, CONFIG_SERVER))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "%s from server is not allowed: %s", req, zbx_socket_strerror());
+
+		if (ZBX_SEND_RESPONSE == send_response)
+			zbx_send_proxy_response(sock, FAIL, "connection is not allowed", CONFIG_TIMEOUT);
+
+		return FAIL;
+	}
+
+	if (0 == (configured_tls_accept_modes & sock->connection_type))
+	{
+		msg = zbx_dsprintf(NULL, "%s from server over connection of type \"%s\" is not allowed", req,
+				zbx_tcp_connection_type_name(sock->connection_type));
+
+		zabbix_log(LOG_LEVEL_WARNING, "%s by proxy configuration parameter \"TLSAccept\"", msg);
+
+		if (ZBX_SEND_RESPONSE == send_response)
+			zbx_send_proxy_response(sock, FAIL, msg, CONFIG_TIMEOUT);
+
+		zbx_free(msg);
+		return FAIL;
+	}
+
+#if defined(HAVE_POLARSSL) || defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
+	if (ZBX_TCP_SEC_TLS_CERT == sock->connection_type && SUCCEED != zbx_check_server_issuer_subject(sock, &msg))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "%s from server is not allowed: %s", req, msg);
+
+		if (ZBX_SEND_RESPONSE == send_response)
+			zbx_send_proxy_response(sock, FAIL, "certificate issuer or subject mismatch", CONFIG_TIMEOUT);
+
+		zbx_free(msg);
+		return FAIL;
+	}
+#endif
+	return SUCCEED;
+}
 /******************************************************************************
  * *
  *整个代码块的主要目的是检查被动代理服务器是否允许客户端的连接。具体来说，它逐行检查以下内容：
@@ -468,159 +534,71 @@ static int get_proxyconfig_table(zbx_uint64_t proxy_hostid, struct zbx_json *j,
 	zbx_json_addstring(j, NULL, table->recid, ZBX_JSON_TYPE_STRING);
 
 	// 遍历表的字段，添加到JSON对象
-	for (f = 0; 0 != table->fields[f].name; f++)
-	{
+	for (f = 0, fld = 1; 0 != table->fields[f].name; f++)
 		// 如果字段不是代理相关的，跳过
-		if (0 == (table->fields[f].flags & ZBX_PROXY))
-			continue;
 
 		// 添加字段到JSON对象
-		zbx_json_addstring(j, NULL, table->fields[f].name, ZBX_JSON_TYPE_STRING);
 
 		// 如果是items表，记录字段类型和键
-		if (table == table_items)
-		{
-			unsigned char	type;
 
 			// 将字符串转换为无符号整数
-			ZBX_STR2UCHAR(type, row[fld_type]);
 
 			// 检查字段是否已被服务器处理
-			if (SUCCEED == is_item_processed_by_server(type, row[fld_key]))
-				continue;
-		}
-	}
 
 	// 添加查询条件
-	zbx_json_close(j);	/* fields */
 
 	// 添加数据查询
-	zbx_json_addarray(j, "data");
 
 	// 构建SQL查询语句
-	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, " from %s t", table->table);
 
 	// 根据表名添加查询条件
-	if (table == table_items)
-	{
 		// 添加主机和代理相关的条件
-		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, " where");
-		DBadd_condition_alloc(&sql, &sql_alloc, &sql_offset, "t.hostid", hosts->values, hosts->values_num);
-	}
-	else if (0 == strcmp(table->table, "drules"))
-	{
 		// 添加代理相关的条件
-		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
-				" where t.proxy_hostid=" ZBX_FS_UI64
-					" and t.status=%d",
-				proxy_hostid, DRULE_STATUS_MONITORED);
-	}
-	else if (0 == strcmp(table->table, "dchecks"))
-	{
 		// 添加代理相关的条件
-		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
-				",drules r where t.druleid=r.druleid"
-					" and r.proxy_hostid=" ZBX_FS_UI64
-					" and r.status=%d",
-				proxy_hostid, DRULE_STATUS_MONITORED);
-	}
-	else if (0 == strcmp(table->table, "hstgrp"))
-	{
 		// 添加主机组的条件
-		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, ",config r where t.groupid=r.discovery_groupid");
-	}
-	else if (SUCCEED == str_in_list("httptest,httptest_field,httptestitem,httpstep", table->table, ','))
-	{
 		// 添加HTTP测试相关的条件
-		if (0 == httptests->values_num)
-			goto skip_data;
 
-		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, " where");
-		DBadd_condition_alloc(&sql, &sql_alloc, &sql_offset, "t.httptestid",
-				httptests->values, httptests->values_num);
-	}
-	else if (SUCCEED == str_in_list("httpstepitem,httpstep_field", table->table, ','))
-	{
 		// 添加HTTP步骤相关的条件
-		if (0 == httptests->values_num)
-			goto skip_data;
 
-		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset,
-				",httpstep r where t.httpstepid=r.httpstepid"
-					" and");
-		DBadd_condition_alloc(&sql, &sql_alloc, &sql_offset, "r.httptestid",
-				httptests->values, httptests->values_num);
-	}
 
 	// 添加查询结果排序条件
-	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, " order by t.");
-	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, table->recid);
 
 	// 执行SQL查询
-	if (NULL == (result = DBselect("%s", sql)))
-	{
 		// 查询失败，返回失败
-		ret = FAIL;
-		goto skip_data;
-	}
 
 	// 获取查询结果
-	while (NULL != (row = DBfetch(result)))
-	{
 		// 处理数据
-		if (table == table_items)
-		{
-			unsigned char	type;
 
-			ZBX_STR2UCHAR(type, row[fld_type]);
 
 			// 检查字段是否已被服务器处理
-			if (SUCCEED == is_item_processed_by_server(type, row[fld_key]))
-				continue;
-		}
 
-		fld = 0;
-		zbx_json_addarray(j, NULL);
-		zbx_json_addstring(j, NULL, row[fld++], ZBX_JSON_TYPE_INT);
 
 		// 遍历字段，添加到JSON对象
-		for (f = 0; 0 != table->fields[f].name; f++)
 		{
 			if (0 == (table->fields[f].flags & ZBX_PROXY))
 				continue;
 
-			switch (table->fields[f].type)
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, ",t.");
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, table->fields[f].name);
+
+		zbx_json_addstring(j, NULL, table->fields[f].name, ZBX_JSON_TYPE_STRING);
+
+		if (table == table_items)
 			{
-				case ZBX_TYPE_INT:
-				case ZBX_TYPE_UINT:
-				case ZBX_TYPE_ID:
-					if (SUCCEED != DBis_null(row[fld]))
-						zbx_json_addstring(j, NULL, row[fld], ZBX_JSON_TYPE_INT);
-					else
-						zbx_json_addstring(j, NULL, NULL, ZBX_JSON_TYPE_NULL);
-					break;
-				default:
-					zbx_json_addstring(j, NULL, row[fld], ZBX_JSON_TYPE_STRING);
-					break;
-			}
+			if (0 == strcmp(table->fields[f].name, "type"))
+				fld_type = fld;
+			else if (0 == strcmp(table->fields[f].name, "key_"))
+				fld_key = fld;
 
 			fld++;
 		}
-		zbx_json_close(j);
-	}
-	DBfree_result(result);
 
-skip_data:
-	zbx_free(sql);
 
-	zbx_json_close(j);	/* data */
-	zbx_json_close(j);	/* table->table */
 
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
 
-	return ret;
 }
 
+	if (table == table_items && (-1 == fld_type || -1 == fld_key))
 	{
 		THIS_SHOULD_NEVER_HAPPEN;
 		exit(EXIT_FAILURE);
@@ -845,6 +823,9 @@ static void get_proxy_monitored_hosts(zbx_uint64_t proxy_hostid, zbx_vector_uint
 // 定义一个静态函数，用于获取代理监控的HTTP测试项
 static void get_proxy_monitored_httptests(zbx_uint64_t proxy_hostid, zbx_vector_uint64_t *httptests)
 {
+	DB_RESULT	result;
+	DB_ROW		row;
+	zbx_uint64_t	httptestid;
     // 声明一个DB_RESULT类型的变量result，用于存储数据库查询的结果
     // 声明一个DB_ROW类型的变量row，用于存储数据库行的数据
     // 声明一个zbx_uint64_t类型的变量httptestid，用于存储HTTP测试项的唯一标识符
@@ -871,6 +852,12 @@ static void get_proxy_monitored_httptests(zbx_uint64_t proxy_hostid, zbx_vector_
     {
         // 将row数组中的第一个元素（httptestid）从字符串转换为整数
         ZBX_STR2UINT64(httptestid, row[0]);
+		zbx_vector_uint64_append(httptests, httptestid);
+	}
+	DBfree_result(result);
+
+	zbx_vector_uint64_sort(httptests, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+}
 /******************************************************************************
  * *
  *整个代码块的主要目的是获取代理主机的配置数据。函数`get_proxyconfig_data`接收三个参数：`proxy_hostid`（代理主机ID）、`j`（指向存储配置数据的结构体的指针）和`error`（错误信息指针）。函数首先验证`proxy_hostid`不为空，然后创建两个vector用于存储主机和HTTP测试相关信息。接着，通过数据库操作获取代理监控的主机和HTTP测试信息。
@@ -912,7 +899,7 @@ int get_proxyconfig_data(zbx_uint64_t proxy_hostid, struct zbx_json *j, char **e
 	zbx_vector_uint64_t hosts, httptests;
 
 	// 记录日志，表示进入函数
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s() proxy_hostid:%llu", __function_name, proxy_hostid);
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() proxy_hostid:" ZBX_FS_UI64, __function_name, proxy_hostid);
 
 	// 确保传入的代理主机ID不为空
 	assert(proxy_hostid);
@@ -936,36 +923,21 @@ int get_proxyconfig_data(zbx_uint64_t proxy_hostid, struct zbx_json *j, char **e
 		// 获取表对象
 		table = DBget_table(proxytable[i]);
 		// 确保表对象不为空
-		assert(NULL != table);
 
 		// 调用函数获取代理配置表数据，并将结果存储在j指向的结构体中
-		if (SUCCEED != get_proxyconfig_table(proxy_hostid, j, table, &hosts, &httptests))
-		{
 			// 获取错误信息
-			*error = zbx_dsprintf(*error, "failed to get data from table \"%s\"", table->table);
 
 			// 发生错误，跳出循环
-			goto out;
-		}
-	}
 
 	// 代理配置数据获取成功，设置返回值
-	ret = SUCCEED;
 
-out:
 	// 提交数据库操作
-	DBcommit();
 
 	// 释放内存
-	zbx_vector_uint64_destroy(&httptests);
-	zbx_vector_uint64_destroy(&hosts);
 
 	// 记录日志，表示函数结束
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
 
 	// 返回代理配置数据操作结果
-	return ret;
-}
 
 		assert(NULL != table);
 
@@ -1081,7 +1053,110 @@ static int id_offset_compare_func(const void *d1, const void *d2)
  * *
  *整个代码块的主要目的是查找一个名为`field_name`的字段，并在`fields`数组中返回该字段的索引。如果没有找到匹配的字段，则返回-1。
  ******************************************************************************/
+static int	find_field_by_name(const ZBX_FIELD **fields, int fields_count, const char *field_name)
+{
+	int	f;
+
+	for (f = 0; f < fields_count; f++)
+	{
+		if (0 == strcmp(fields[f]->name, field_name))
+			break;
+	}
+
+	return f;
+}
 // 定义一个静态函数find_field_by_name，接收三个参数：
+/******************************************************************************
+ *                                                                            *
+ * Function: compare_nth_field                                                *
+ *                                                                            *
+ * Purpose: This function compares a value from JSON record with the value    *
+ *          of the n-th field of DB record. For description how DB record is  *
+ *          stored in memory see comments in function remember_record().      *
+ *                                                                            *
+ * Comparing deals with 4 cases:                                              *
+ *          - JSON value is not NULL, DB value is not NULL                    *
+ *          - JSON value is not NULL, DB value is NULL                        *
+ *          - JSON value is NULL, DB value is NULL                            *
+ *          - JSON value is NULL, DB value is not NULL                        *
+ *                                                                            *
+ ******************************************************************************/
+static int	compare_nth_field(const ZBX_FIELD **fields, const char *rec_data, int n, const char *str, int is_null,
+		int *last_n, size_t *last_pos)
+{
+	int		i = *last_n, null_in_db = 0;
+	const char	*p = rec_data + *last_pos, *field_start = NULL;
+
+	do	/* find starting position of the n-th field */
+	{
+		field_start = p;
+		while ('\0' != *p++)
+			;
+
+		null_in_db = 0;
+
+		if (0 == (fields[i++]->flags & ZBX_NOTNULL))	/* field could be NULL */
+		{
+			if ('\2' == *p && (rec_data == p - 1 || '\0' == *(p - 2) || '\1' == *(p - 2) ||
+					'\2' == *(p - 2)))	/* field value is NULL */
+			{
+				null_in_db = 1;
+				p++;
+			}
+			else if ('\1' == *p)
+			{
+				p++;
+			}
+			else
+			{
+				THIS_SHOULD_NEVER_HAPPEN;
+				*last_n = 0;
+				*last_pos = 0;
+				return 1;
+			}
+		}
+	}
+	while (n >= i);
+
+	*last_n = i;				/* preserve number of field and its start position */
+	*last_pos = (size_t)(p - rec_data);	/* across calls to avoid searching from start */
+
+	if (0 == is_null)	/* value in JSON is not NULL */
+	{
+		if (0 == null_in_db)
+			return strcmp(field_start, str);
+		else
+			return 1;
+	}
+	else
+	{
+		if ('\0' == *str)
+		{
+			if (1 == null_in_db)
+				return 0;	/* fields are "equal" - both contain NULL */
+			else
+				return 1;
+		}
+		else
+		{
+			THIS_SHOULD_NEVER_HAPPEN;
+			*last_n = 0;
+			*last_pos = 0;
+			return 1;
+		}
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: process_proxyconfig_table                                        *
+ *                                                                            *
+ * Purpose: update configuration table                                        *
+ *                                                                            *
+ * Return value: SUCCEED - processed successfully                             *
+ *               FAIL - an error occurred                                     *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  * 这段C语言代码的主要目的是处理一个名为“process_proxyconfig_table”的过程，用于处理一个名为“proxyconfig_table”的数据表。这个函数接收一个指向该表的指针，一个指向解析后的JSON对象的指针，以及一些其他参数，如删除记录的向量、错误指针等。
  *
@@ -1263,11 +1338,6 @@ static int	process_proxyconfig_table(const ZBX_TABLE *table, struct zbx_json_par
 		move_out = 1;
 		move_field_nr = find_field_by_name(fields, fields_count, "macro");
 	}
-	else if (0 == strcmp("hosts", table->table))
-	{
-		move_out = 1;
-		move_field_nr = find_field_by_name(fields, fields_count, "hostid");
-	}
 	else if (0 == strcmp("hosts_templates", table->table))
 	{
 		move_out = 1;
@@ -1341,8 +1411,7 @@ static int	process_proxyconfig_table(const ZBX_TABLE *table, struct zbx_json_par
 
 				/* find the field requiring special preprocessing in JSON record */
 				f = 1;
-				while (NULL != (pf = zbx_json_next_value_dyn(&jp_row, pf, &buf, &buf_alloc, &type));
-						f++)
+				while (NULL != (pf = zbx_json_next_value_dyn(&jp_row, pf, &buf, &buf_alloc, &type)))
 				{
 					/* parse values for the entry (lines 10-12 in T1) */
 
@@ -1363,32 +1432,234 @@ static int	process_proxyconfig_table(const ZBX_TABLE *table, struct zbx_json_par
 				{
 					zbx_vector_uint64_append(&moves, recid);
 				}
-			
-				goto clean;
 			}
+		}
+		else
+			zbx_vector_uint64_append(&ins, recid);
+	}
+			
+	zbx_hashset_iter_reset(&h_del, &iter);
+	while (NULL != (p_recid = (uint64_t *)zbx_hashset_iter_next(&iter)))
+		zbx_vector_uint64_append(del, *p_recid);
+	zbx_vector_uint64_sort(del, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 
-			zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "update %s set ", table->table);
+	zbx_vector_uint64_sort(&ins, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 
-			for (f = 1; NULL != (pf = zbx_json_next_value_dyn(&jp_row, pf, &buf, &buf_alloc, &type));
-					f++)
+	if (1 == move_out)
+	{
+		/* special preprocessing for 'hosts_templates' table to eliminate conflicts */
+		/* in the 'hostid, templateid' unique index */
+		if (0 == strcmp("hosts_templates", table->table))
+		{
+			/* Making the 'hostid, templateid' combination unique to avoid collisions when new records */
+			/* are inserted and existing ones are updated is a bit complex. Let's take a simpler approach */
+			/* - delete affected old records and insert the new ones. */
+			for (i = 0; i < moves.values_num; i++)
 			{
-				int	field_differ = 1;
+				zbx_vector_uint64_append(del, moves.values[i]);
+				zbx_vector_uint64_append(&ins, moves.values[i]);
+			}
 
-				/* parse values for the entry (lines 10-12 in T1) */
+			if (0 < moves.values_num)
+			{
+				zbx_vector_uint64_clear(&moves);
+				zbx_vector_uint64_sort(del, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+				zbx_vector_uint64_sort(&ins, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+			}
+		}
 
-				if (f == fields_count)
-				{
-					*error = zbx_dsprintf(*error, "invalid number of fields \"%.*s\"",
-							(int)(jp_row.end - jp_row.start + 1), jp_row.start);
-					goto clean;
-				}
+		if (0 != del->values_num)
+		{
+			sql_offset = 0;
+			zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "delete from %s where", table->table);
+			DBadd_condition_alloc(&sql, &sql_alloc, &sql_offset, table->recid, del->values,
+					del->values_num);
 
-				if (ZBX_JSON_TYPE_NULL == type && 0 != (fields[f]->flags & ZBX_NOTNULL))
-				{
-					*error = zbx_dsprintf(*error, "column \"%s.%s\" cannot be null",
-							table->table, fields[f]->name);
-					goto clean;
-				}
+			if (ZBX_DB_OK > DBexecute("%s", sql))
+				goto clean2;
+
+			zbx_vector_uint64_clear(del);
+		}
+
+		/* special preprocessing for 'globalmacro', 'hostmacro', 'items', 'drules', 'regexps' and 'httptest' */
+		/* tables to eliminate conflicts */
+		/* in the 'macro', 'hostid,macro', 'hostid,key_', 'name', 'name' and 'hostid,name' unique indices */
+		if (1 < moves.values_num)
+		{
+			sql_offset = 0;
+#ifdef HAVE_MYSQL
+			zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "update %s set %s=concat('#',%s) where",
+					table->table, fields[move_field_nr]->name, table->recid);
+#else
+			zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "update %s set %s='#'||%s where",
+					table->table, fields[move_field_nr]->name, table->recid);
+#endif
+			zbx_vector_uint64_sort(&moves, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+			DBadd_condition_alloc(&sql, &sql_alloc, &sql_offset, table->recid, moves.values,
+					moves.values_num);
+
+			if (ZBX_DB_OK > DBexecute("%s", sql))
+				goto clean2;
+		}
+	}
+
+	if (0 != ins.values_num)
+	{
+		zbx_vector_ptr_create(&values);
+
+		zbx_db_insert_prepare_dyn(&db_insert, table, fields, fields_count);
+	}
+
+	sql_offset = 0;
+	DBbegin_multiple_update(&sql, &sql_alloc, &sql_offset);
+
+	p = NULL;
+	/* iterate the entries (lines 9, 14 and 19 in T1) */
+	while (NULL != (p = zbx_json_next(&jp_data, p)))
+	{
+		int		rec_differ = 0;	/* how many fields differ */
+		int		last_n = 0;
+		size_t		tmp_offset = sql_offset, last_pos = 0;
+		zbx_json_type_t	type;
+
+		if (FAIL == zbx_json_brackets_open(p, &jp_row))
+		{
+			*error = zbx_dsprintf(*error, "invalid data format: %s", zbx_json_strerror());
+			goto clean;
+		}
+
+		pf = zbx_json_next_value_dyn(&jp_row, NULL, &buf, &buf_alloc, NULL);
+
+		/* check whether we need to insert a new entry or update an existing one */
+		ZBX_STR2UINT64(recid, buf);
+		insert = (FAIL != zbx_vector_uint64_bsearch(&ins, recid, ZBX_DEFAULT_UINT64_COMPARE_FUNC));
+
+		if (0 != insert)
+		{
+			/* perform insert operation */
+
+			zbx_db_value_t	*value;
+
+			/* add the id field */
+			value = (zbx_db_value_t *)zbx_malloc(NULL, sizeof(zbx_db_value_t));
+			value->ui64 = recid;
+			zbx_vector_ptr_append(&values, value);
+
+			/* add the rest of fields */
+			for (f = 1; NULL != (pf = zbx_json_next_value_dyn(&jp_row, pf, &buf, &buf_alloc, &type));
+					f++)
+			{
+				if (f == fields_count)
+				{
+					*error = zbx_dsprintf(*error, "invalid number of fields \"%.*s\"",
+							(int)(jp_row.end - jp_row.start + 1), jp_row.start);
+					goto clean;
+				}
+
+				if (ZBX_JSON_TYPE_NULL == type && 0 != (fields[f]->flags & ZBX_NOTNULL))
+				{
+					*error = zbx_dsprintf(*error, "column \"%s.%s\" cannot be null",
+							table->table, fields[f]->name);
+					goto clean;
+				}
+
+				value = (zbx_db_value_t *)zbx_malloc(NULL, sizeof(zbx_db_value_t));
+
+				switch (fields[f]->type)
+				{
+					case ZBX_TYPE_INT:
+						value->i32 = atoi(buf);
+						break;
+					case ZBX_TYPE_UINT:
+						ZBX_STR2UINT64(value->ui64, buf);
+						break;
+					case ZBX_TYPE_ID:
+						if (ZBX_JSON_TYPE_NULL != type)
+							ZBX_STR2UINT64(value->ui64, buf);
+						else
+							value->ui64 = 0;
+						break;
+					case ZBX_TYPE_FLOAT:
+						value->dbl = atof(buf);
+						break;
+					case ZBX_TYPE_CHAR:
+					case ZBX_TYPE_TEXT:
+					case ZBX_TYPE_SHORTTEXT:
+					case ZBX_TYPE_LONGTEXT:
+						value->str = zbx_strdup(NULL, buf);
+						break;
+					default:
+						*error = zbx_dsprintf(*error, "unsupported field type %d in \"%s.%s\"",
+								(int)fields[f]->type, table->table, fields[f]->name);
+						zbx_free(value);
+						goto clean;
+
+				}
+
+				zbx_vector_ptr_append(&values, value);
+			}
+
+			zbx_db_insert_add_values_dyn(&db_insert, (const zbx_db_value_t **)values.values,
+					values.values_num);
+
+			for (f = 0; f < fields_count; f++)
+			{
+				switch (fields[f]->type)
+				{
+					case ZBX_TYPE_CHAR:
+					case ZBX_TYPE_TEXT:
+					case ZBX_TYPE_SHORTTEXT:
+					case ZBX_TYPE_LONGTEXT:
+						value = (zbx_db_value_t *)values.values[f];
+						zbx_free(value->str);
+				}
+			}
+			zbx_vector_ptr_clear_ext(&values, zbx_ptr_free);
+
+			if (f != fields_count)
+			{
+				*error = zbx_dsprintf(*error, "invalid number of fields \"%.*s\"",
+						(int)(jp_row.end - jp_row.start + 1), jp_row.start);
+				goto clean;
+			}
+		}
+		else
+		{
+			/* perform update operation */
+
+			if (1 == fields_count)	/* only primary key given, no update needed */
+				continue;
+
+			/* locate a copy of this record as found in database */
+			id_offset.id = recid;
+			if (NULL == (p_id_offset = (zbx_id_offset_t *)zbx_hashset_search(&h_id_offsets, &id_offset)))
+			{
+				THIS_SHOULD_NEVER_HAPPEN;
+				goto clean;
+			}
+
+			zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "update %s set ", table->table);
+
+			for (f = 1; NULL != (pf = zbx_json_next_value_dyn(&jp_row, pf, &buf, &buf_alloc, &type));
+					f++)
+			{
+				int	field_differ = 1;
+
+				/* parse values for the entry (lines 10-12 in T1) */
+
+				if (f == fields_count)
+				{
+					*error = zbx_dsprintf(*error, "invalid number of fields \"%.*s\"",
+							(int)(jp_row.end - jp_row.start + 1), jp_row.start);
+					goto clean;
+				}
+
+				if (ZBX_JSON_TYPE_NULL == type && 0 != (fields[f]->flags & ZBX_NOTNULL))
+				{
+					*error = zbx_dsprintf(*error, "column \"%s.%s\" cannot be null",
+							table->table, fields[f]->name);
+					goto clean;
+				}
 
 				/* do not update existing lastlogsize and mtime fields */
 				if (FAIL != zbx_vector_ptr_bsearch(&skip_fields, fields[f],
@@ -1526,11 +1797,12 @@ out:
 void process_proxyconfig(struct zbx_json_parse *jp_data)
 {
     // 定义一个结构体类型变量table_ids_t，用于存储表格名和对应的主键列表
-    struct
+    typedef struct
     {
         const ZBX_TABLE *table;
         zbx_vector_uint64_t ids;
-    } table_ids_t;
+    }
+    table_ids_t;
 
     // 定义一个常量字符串，表示函数名
     const char *__function_name = "process_proxyconfig";
@@ -1611,8 +1883,7 @@ void process_proxyconfig(struct zbx_json_parse *jp_data)
                                 table_ids->table->table);
             DBadd_condition_alloc(&sql, &sql_alloc, &sql_offset, table_ids->table->recid,
                                 table_ids->ids.values, table_ids->ids.values_num);
-            zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, ";\
-");
+            zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, ";\n");
         }
 
         // 如果有更改，执行SQL语句
@@ -1669,6 +1940,8 @@ void process_proxyconfig(struct zbx_json_parse *jp_data)
  *                FAIL - no host availability has been changed                *
  *                                                                            *
  ******************************************************************************/
+int	get_host_availability_data(struct zbx_json *json, int *ts)
+{
 /******************************************************************************
  * *
  *整个代码块的主要目的是获取主机的可用性数据，并将这些数据以JSON格式存储在一个对象中。函数接收两个参数，一个是指向zbx_json结构的指针，另一个是指向整数的指针。在函数内部，首先创建一个指向zbx_host_availability结构体的指针数组，然后从zbx_hosts结构体中获取主机可用性数据，并将结果存储在hosts数组中。接下来，遍历hosts数组，为每个主机可用性对象创建一个json对象，并添加主机ID、代理的可用性数据等。最后，关闭json对象，释放hosts数组占用的内存，并记录日志。函数返回整数类型的执行结果。
@@ -1687,9 +1960,7 @@ zbx_vector_ptr_create(&hosts);
 
 // 从zbx_hosts结构体中获取主机可用性数据，并将结果存储在hosts数组中
 if (SUCCEED != DCget_hosts_availability(&hosts, ts))
-{
     goto out;
-}
 
 // 在json对象中添加一个表示主机可用性的数组
 zbx_json_addarray(json, ZBX_PROTO_TAG_HOST_AVAILABILITY);
@@ -1721,7 +1992,14 @@ zbx_json_close(json);
 
 // 判断函数执行结果
 ret = SUCCEED;
-goto out;
+out:
+	zbx_vector_ptr_clear_ext(&hosts, (zbx_mem_free_func_t)zbx_host_availability_free);
+	zbx_vector_ptr_destroy(&hosts);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
+
+	return ret;
+}
 
 /******************************************************************************
  * *
@@ -1829,38 +2107,21 @@ static int process_host_availability_contents(struct zbx_json_parse *jp_data, ch
 					(zbx_host_availability_t *)hosts.values[i]))
 			{
 				continue;
-			}
 
 			// 添加分号和换行符
-			zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, ";\
-");
-			DBexecute_overflowed_sql(&sql, &sql_alloc, &sql_offset);
-		}
 
-		DBend_multiple_update(&sql, &sql_alloc, &sql_offset);
 
 		// 如果 SQL 语句长度超过 16 字节，直接执行 SQL 语句
-		if (16 < sql_offset)
-			DBexecute("%s", sql);
 
-		DBcommit();
 
 		// 释放内存
-		zbx_free(sql);
-	}
 
 	// 标记函数返回值
-	ret = SUCCEED;
 
-out:
 	// 释放内存并清理向量
-	zbx_vector_ptr_clear_ext(&hosts, (zbx_mem_free_func_t)zbx_host_availability_free);
-	zbx_vector_ptr_destroy(&hosts);
 
 	// 释放临时变量
-	zbx_free(tmp);
 
-	return ret;
 }
 
 			zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, ";\n");
@@ -1897,13 +2158,54 @@ out:
  *                FAIL - an error occurred                                    *
  *                                                                            *
  ******************************************************************************/
+int	process_host_availability(struct zbx_json_parse *jp, char **error)
+{
+	const char		*__function_name = "process_host_availability";
+	struct zbx_json_parse	jp_data;
+	int			ret;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
+
+	if (SUCCEED != (ret = zbx_json_brackets_by_name(jp, ZBX_PROTO_TAG_DATA, &jp_data)))
+	{
+		*error = zbx_strdup(*error, zbx_json_strerror());
+		goto out;
+	}
+
+	if (SUCCEED == zbx_json_object_is_empty(&jp_data))
+		goto out;
+
+	ret = process_host_availability_contents(&jp_data, error);
+
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
+
+	return ret;
+}
 /******************************************************************************
  * *
  *整个代码块的主要目的是处理主机可用性数据。函数`process_host_availability`接收一个`zbx_json_parse`结构体指针和一个错误信息指针，首先解析json数据，然后判断数据是否为空，如果不为空，则调用`process_host_availability_contents`函数处理数据，并返回处理结果。最后，记录函数调用日志并返回处理结果。
  ******************************************************************************/
 // 定义一个函数，处理主机可用性数据
-int process_host_availability(struct zbx_json_parse *jp, char **error)
+static void	proxy_get_lastid(const char *table_name, const char *lastidfield, zbx_uint64_t *lastid)
 {
+	const char	*__function_name = "proxy_get_lastid";
+	DB_RESULT	result;
+	DB_ROW		row;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() field:'%s.%s'", __function_name, table_name, lastidfield);
+
+	result = DBselect("select nextid from ids where table_name='%s' and field_name='%s'",
+			table_name, lastidfield);
+
+	if (NULL == (row = DBfetch(result)))
+		*lastid = 0;
+	else
+		ZBX_STR2UINT64(*lastid, row[0]);
+	DBfree_result(result);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():" ZBX_FS_UI64,	__function_name, *lastid);
+}
 /******************************************************************************
  * *
  *这块代码的主要目的是从一个历史数据表（由 ht 指针指向）中查询数据，并将查询到的数据以 JSON 格式添加到 j 指向的 zbx_json 对象中。在这个过程中，代码会处理以下操作：
@@ -2039,142 +2341,61 @@ int process_host_availability(struct zbx_json_parse *jp, char **error)
  * 一个指向 int 类型的指针 records_num，
  * 一个指向 int 类型的指针 more。
  */
-static void proxy_get_history_data_simple(struct zbx_json *j, const char *proto_tag, const zbx_history_table_t *ht,
-                                         zbx_uint64_t *lastid, zbx_uint64_t *id, int *records_num, int *more)
+static void	proxy_set_lastid(const char *table_name, const char *lastidfield, const zbx_uint64_t lastid)
 {
 	/* 定义一个常量，表示日志级别的调试信息 */
-	const char *__function_name = "proxy_get_history_data_simple";
-	size_t		offset = 0;
-	int		f, records_num_last = *records_num, retries = 1;
-	char		sql[MAX_STRING_LEN];
+	const char	*__function_name = "proxy_set_lastid";
 	DB_RESULT	result;
 	DB_ROW		row;
-	struct timespec	t_sleep = { 0, 100000000L }, t_rem;
 
 	/* 打印调试日志，显示进入函数的表名 */
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s() table:'%s'", __function_name, ht->table);
 
 	/* 初始化更多参数为 ZBX_PROXY_DATA_DONE */
-	*more = ZBX_PROXY_DATA_DONE;
 
 	/* 构建 SQL 查询语句，查询 id 字段 */
-	offset += zbx_snprintf(sql + offset, sizeof(sql) - offset, "select id");
 
-	for (f = 0; NULL != ht->fields[f].field; f++)
-	{
-		offset += zbx_snprintf(sql + offset, sizeof(sql) - offset, ",%s", ht->fields[f].field);
-	}
 
 	/* 尝试查询数据，如果失败则重试 */
-	try_again:
-	zbx_snprintf(sql + offset, sizeof(sql) - offset, " from %s where id>" ZBX_FS_UI64 " order by id",
-			ht->table, *id);
 
-	result = DBselectN(sql, ZBX_MAX_HRECORDS);
 
-	while (NULL != (row = DBfetch(result)))
-	{
 		/* 将 lastid 更新为当前查询到的最大 id */
-		ZBX_STR2UINT64(*lastid, row[0]);
 
 		/* 如果 lastid 比 id 大，说明有记录缺失 */
-		if (1 < *lastid - *id)
-		{
 			/* 如果是第一次缺失记录，且还有重试次数，则等待一段时间后重试 */
-			if (0 < retries--)
-			{
-				DBfree_result(result);
-				zabbix_log(LOG_LEVEL_DEBUG, "%s() " ZBX_FS_UI64 " record(s) missing."
-						" Waiting " ZBX_FS_DBL " sec, retrying.",
-						__function_name, *lastid - *id - 1,
-						t_sleep.tv_sec + t_sleep.tv_nsec / 1e9);
-				nanosleep(&t_sleep, &t_rem);
-				goto try_again;
-			}
-			else
-			{
 				/* 如果没有重试次数了，则打印日志 */
-				zabbix_log(LOG_LEVEL_DEBUG, "%s() " ZBX_FS_UI64 " record(s) missing. No more retries.",
-						__function_name, *lastid - *id - 1);
-			}
-		}
 
 		/* 如果没有记录，则继续查询 */
-		if (0 == *records_num)
-			zbx_json_addarray(j, proto_tag);
 
 		/* 添加一条记录到 JSON 对象中 */
-		zbx_json_addobject(j, NULL);
 
 		/* 添加记录的字段值到 JSON 对象中 */
-		for (f = 0; NULL != ht->fields[f].field; f++)
-		{
 			/* 如果字段有默认值，且当前行数据与默认值不同，则添加到 JSON 对象中 */
-			if (NULL != ht->fields[f].default_value && 0 == strcmp(row[f + 1], ht->fields[f].default_value))
-				continue;
 
-			zbx_json_addstring(j, ht->fields[f].tag, row[f + 1], ht->fields[f].jt);
-		}
 
 		/* 更新 records_num，表示已添加一条记录 */
-		(*records_num)++;
 
 		/* 关闭当前 JSON 对象，继续添加下一条记录 */
-		zbx_json_close(j);
 
 		/* 防止数据过多导致超过最大包大小，此处限制每次查询的数据量 */
-		if (ZBX_DATA_JSON_RECORD_LIMIT < j->buffer_offset)
-		{
-			*more = ZBX_PROXY_DATA_MORE;
-			break;
-		}
 
 		/* 更新 id 为当前查询到的最大 id */
-		*id = *lastid;
-	}
-	DBfree_result(result);
 
 	/* 如果本次查询的记录数与上次相同，则表示查询结束 */
-	if (ZBX_MAX_HRECORDS == *records_num - records_num_last)
-		*more = ZBX_PROXY_DATA_MORE;
 
 	/* 打印调试日志，显示结束时间、lastid、more 和 JSON 缓冲区大小 */
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%d lastid:" ZBX_FS_UI64 " more:%d size:" ZBX_FS_SIZE_T,
-			__function_name, *records_num - records_num_last, *lastid, *more,
-			(zbx_fs_size_t)j->buffer_offset);
-}
 
-	DB_RESULT result;
 	/* 定义一个 DB_ROW 类型的变量 row，用于存储数据库查询结果的行数据 */
-	DB_ROW row;
 
 	/* 记录函数调用日志，输出表名、字段名和 lastid 值 */
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s() [%s.%s:" ZBX_FS_UI64 "]",
-			__function_name, table_name, lastidfield, lastid);
 
 	/* 执行数据库查询操作，查询名为 table_name 的数据表中 lastid 字段的数据 */
-	result = DBselect("select 1 from ids where table_name='%s' and field_name='%s'",
-			table_name, lastidfield);
 
 	/* 如果查询结果为空，说明 lastid 字段不存在 */
-	if (NULL == (row = DBfetch(result)))
-	{
 		/* 插入新的 lastid 值到数据表中 */
-		DBexecute("insert into ids (table_name,field_name,nextid) values ('%s','%s'," ZBX_FS_UI64 ")",
-				table_name, lastidfield, lastid);
-	}
-	else
-	{
 		/* 更新 lastid 字段的值为新的 lastid */
-		DBexecute("update ids set nextid=" ZBX_FS_UI64 " where table_name='%s' and field_name='%s'",
-				lastid, table_name, lastidfield);
-	}
 	/* 释放查询结果内存 */
-	DBfree_result(result);
 
 	/* 记录函数执行结束日志 */
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __function_name);
-}
 
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() [%s.%s:" ZBX_FS_UI64 "]",
@@ -2197,13 +2418,128 @@ static void proxy_get_history_data_simple(struct zbx_json *j, const char *proto_
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __function_name);
 }
-/******************************************************************************
- * 以下是对这段C语言代码的逐行注释：
- *
- *
- *
- *这段代码的主要目的是从数据库中查询历史数据记录，并将查询结果转换为JSON格式。注释中详细说明了每个步骤，包括数据查询、解析、添加到JSON对象、释放资源等。
- ******************************************************************************/
+void	proxy_set_hist_lastid(const zbx_uint64_t lastid)
+{
+	proxy_set_lastid("proxy_history", "history_lastid", lastid);
+}
+
+void	proxy_set_dhis_lastid(const zbx_uint64_t lastid)
+{
+	proxy_set_lastid(dht.table, dht.lastidfield, lastid);
+}
+
+void	proxy_set_areg_lastid(const zbx_uint64_t lastid)
+{
+	proxy_set_lastid(areg.table, areg.lastidfield, lastid);
+}
+/******************************************************************************
+ *                                                                            *
+ * Function: proxy_get_history_data_simple                                    *
+ *                                                                            *
+ * Purpose: Get history data from the database.                               *
+ *                                                                            *
+ ******************************************************************************/
+static void	proxy_get_history_data_simple(struct zbx_json *j, const char *proto_tag, const zbx_history_table_t *ht,
+		zbx_uint64_t *lastid, zbx_uint64_t *id, int *records_num, int *more)
+{
+	const char	*__function_name = "proxy_get_history_data_simple";
+	size_t		offset = 0;
+	int		f, records_num_last = *records_num, retries = 1;
+	char		sql[MAX_STRING_LEN];
+	DB_RESULT	result;
+	DB_ROW		row;
+	struct timespec	t_sleep = { 0, 100000000L }, t_rem;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() table:'%s'", __function_name, ht->table);
+
+	*more = ZBX_PROXY_DATA_DONE;
+
+	offset += zbx_snprintf(sql + offset, sizeof(sql) - offset, "select id");
+
+	for (f = 0; NULL != ht->fields[f].field; f++)
+		offset += zbx_snprintf(sql + offset, sizeof(sql) - offset, ",%s", ht->fields[f].field);
+try_again:
+	zbx_snprintf(sql + offset, sizeof(sql) - offset, " from %s where id>" ZBX_FS_UI64 " order by id",
+			ht->table, *id);
+
+	result = DBselectN(sql, ZBX_MAX_HRECORDS);
+
+	while (NULL != (row = DBfetch(result)))
+	{
+		ZBX_STR2UINT64(*lastid, row[0]);
+
+		if (1 < *lastid - *id)
+		{
+			/* At least one record is missing. It can happen if some DB syncer process has */
+			/* started but not yet committed a transaction or a rollback occurred in a DB syncer. */
+			if (0 < retries--)
+			{
+				DBfree_result(result);
+				zabbix_log(LOG_LEVEL_DEBUG, "%s() " ZBX_FS_UI64 " record(s) missing."
+						" Waiting " ZBX_FS_DBL " sec, retrying.",
+						__function_name, *lastid - *id - 1,
+						t_sleep.tv_sec + t_sleep.tv_nsec / 1e9);
+				nanosleep(&t_sleep, &t_rem);
+				goto try_again;
+			}
+			else
+			{
+				zabbix_log(LOG_LEVEL_DEBUG, "%s() " ZBX_FS_UI64 " record(s) missing. No more retries.",
+						__function_name, *lastid - *id - 1);
+			}
+		}
+
+		if (0 == *records_num)
+			zbx_json_addarray(j, proto_tag);
+
+		zbx_json_addobject(j, NULL);
+
+		for (f = 0; NULL != ht->fields[f].field; f++)
+		{
+			if (NULL != ht->fields[f].default_value && 0 == strcmp(row[f + 1], ht->fields[f].default_value))
+				continue;
+
+			zbx_json_addstring(j, ht->fields[f].tag, row[f + 1], ht->fields[f].jt);
+		}
+
+		(*records_num)++;
+
+		zbx_json_close(j);
+
+		/* stop gathering data to avoid exceeding the maximum packet size */
+		if (ZBX_DATA_JSON_RECORD_LIMIT < j->buffer_offset)
+		{
+			*more = ZBX_PROXY_DATA_MORE;
+			break;
+		}
+
+		*id = *lastid;
+	}
+	DBfree_result(result);
+
+	if (ZBX_MAX_HRECORDS == *records_num - records_num_last)
+		*more = ZBX_PROXY_DATA_MORE;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%d lastid:" ZBX_FS_UI64 " more:%d size:" ZBX_FS_SIZE_T,
+			__function_name, *records_num - records_num_last, *lastid, *more,
+			(zbx_fs_size_t)j->buffer_offset);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: proxy_get_history_data                                           *
+ *                                                                            *
+ * Purpose: Get history data from the database. Get items configuration from  *
+ *          cache to speed things up.                                         *
+ *                                                                            *
+ ******************************************************************************/
+/******************************************************************************
+ * 以下是对这段C语言代码的逐行注释：
+ *
+ *
+ *
+ *这段代码的主要目的是从数据库中查询历史数据记录，并将查询结果转换为JSON格式。注释中详细说明了每个步骤，包括数据查询、解析、添加到JSON对象、释放资源等。
+ ******************************************************************************/
 static void proxy_get_history_data(struct zbx_json *j, zbx_uint64_t *lastid, zbx_uint64_t *id, int *records_num,
                                    int *more)
 {
@@ -2211,6 +2547,22 @@ static void proxy_get_history_data(struct zbx_json *j, zbx_uint64_t *lastid, zbx
 
 	const char *__function_name = "proxy_get_history_data";
 
+	typedef struct
+	{
+		zbx_uint64_t	id;
+		zbx_uint64_t	lastlogsize;
+		size_t		psource;
+		size_t		pvalue;
+		int		clock;
+		int		ns;
+		int		timestamp;
+		int		severity;
+		int		logeventid;
+		int		mtime;
+		unsigned char	state;
+		unsigned char	flags;
+	}
+	zbx_history_data_t;
 	// 定义一个结构体类型zbx_history_data_t，用于存储历史数据的相关信息。
 
 	char *sql = NULL;
@@ -2229,6 +2581,7 @@ static void proxy_get_history_data(struct zbx_json *j, zbx_uint64_t *lastid, zbx
 	zbx_history_data_t		*hd;
 	struct timespec			t_sleep = { 0, 100000000L }, t_rem;
 
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
 	// 打印调试信息，表示进入该函数。
 
 	if (NULL == string_buffer)
@@ -2256,197 +2609,84 @@ try_again:
 
 	zbx_free(sql);
 
-	while (NULL != (row = DBfetch(result)))
-	{
 		// 遍历查询结果中的每一行。
 
-		ZBX_STR2UINT64(*lastid, row[0]);
 
 		// 将lastid转换为uint64类型。
 
-		if (1 < *lastid - *id)
-		{
 			// 如果lastid减去id的结果大于1，说明至少缺失了一行记录。
 
 			/* At least one record is missing. It can happen if some DB syncer process has */
 			/* started but not yet committed a transaction or a rollback occurred in a DB syncer. */
-			if (0 < retries--)
-			{
-				DBfree_result(result);
-				zabbix_log(LOG_LEVEL_DEBUG, "%s() " ZBX_FS_UI64 " record(s) missing. Waiting " ZBX_FS_DBL " sec, retrying.",
-						__function_name, *lastid - *id - 1,
-						t_sleep.tv_sec + t_sleep.tv_nsec / 1e9);
-				nanosleep(&t_sleep, &t_rem);
-				goto try_again;
-			}
-			else
-			{
-				zabbix_log(LOG_LEVEL_DEBUG, "%s() " ZBX_FS_UI64 " record(s) missing. No more retries.",
-						__function_name, *lastid - *id - 1);
-			}
-		}
 
 		// 以下代码块重复了多次，用于处理历史数据记录。
 
-		if (data_alloc == data_num)
-		{
-			data_alloc += 8;
-			data = (zbx_history_data_t *)zbx_realloc(data, sizeof(zbx_history_data_t) * data_alloc);
-			itemids = (zbx_uint64_t *)zbx_realloc(itemids, sizeof(zbx_uint64_t) * data_alloc);
-		}
 
 		// 分配新的数据空间，用于存储历史数据记录。
 
-		ZBX_STR2UINT64(itemids[data_num], row[1]);
 
 		// 将itemid转换为uint64类型。
 
-		hd = &data[data_num++];
 
 		// 初始化一个新的历史数据记录。
 
-		hd->id = *lastid;
-		hd->clock = atoi(row[2]);
-		hd->ns = atoi(row[3]);
-		hd->timestamp = atoi(row[4]);
-		hd->severity = atoi(row[6]);
-		ZBX_STR2UCHAR(hd->state, row[9]);
-		ZBX_STR2UINT64(hd->lastlogsize, row[10]);
-		hd->mtime = atoi(row[11]);
-		ZBX_STR2UCHAR(hd->flags, row[12]);
 
 		// 解析记录中的其他信息，如source、value等。
 
-		len1 = strlen(row[5]) + 1;
-		len2 = strlen(row[7]) + 1;
 
-		if (string_buffer_alloc < string_buffer_offset + len1 + len2)
-		{
-			while (string_buffer_alloc < string_buffer_offset + len1 + len2)
-				string_buffer_alloc += ZBX_KIBIBYTE;
 
-			string_buffer = (char *)zbx_realloc(string_buffer, string_buffer_alloc);
-		}
 
 		// 分配新的字符串缓冲区，用于存储记录中的source和value。
 
-		hd->psource = string_buffer_offset;
-		memcpy(&string_buffer[string_buffer_offset], row[5], len1);
-		string_buffer_offset += len1;
-		hd->pvalue = string_buffer_offset;
-		memcpy(&string_buffer[string_buffer_offset], row[7], len2);
-		string_buffer_offset += len2;
 
 		// 将source和value添加到缓冲区。
 
-		*id = *lastid;
-	}
-	DBfree_result(result);
 
 	// 释放查询结果。
 
-	dc_items = (DC_ITEM *)zbx_malloc(NULL, (sizeof(DC_ITEM) + sizeof(int)) * data_num);
-	errcodes = (int *)(dc_items + data_num);
 
 	// 初始化dc_items和errcodes数组。
 
-	DCconfig_get_items_by_itemids(dc_items, itemids, errcodes, data_num);
 
 	// 根据itemids获取对应的主机组信息。
 
-	for (i = 0; i < data_num; i++)
-	{
 		// 遍历处理每个记录。
 
-		if (SUCCEED != errcodes[i])
 			// 如果获取主机组信息失败，跳过该记录。
-			continue;
 
-		if (ITEM_STATUS_ACTIVE != dc_items[i].status)
 			// 如果主机组状态不是活跃状态，跳过该记录。
-			continue;
 
-		if (HOST_STATUS_MONITORED != dc_items[i].host.status)
 			// 如果主机状态不是监控状态，跳过该记录。
-			continue;
 
 		// 以下代码块重复了多次，用于处理每个记录。
 
-		hd = &data[i];
 
 		// 初始化一个新的历史数据记录。
 
-		if (0 == *records_num)
-			zbx_json_addarray(j, ZBX_PROTO_TAG_HISTORY_DATA);
 
 		// 将记录添加到json对象中。
 
-		zbx_json_addobject(j, NULL);
-		zbx_json_adduint64(j, ZBX_PROTO_TAG_ID, hd->id);
-		zbx_json_adduint64(j, ZBX_PROTO_TAG_ITEMID, dc_items[i].itemid);
-		zbx_json_adduint64(j, ZBX_PROTO_TAG_CLOCK, hd->clock);
-		zbx_json_adduint64(j, ZBX_PROTO_TAG_NS, hd->ns);
 
 		// 如果有必要，添加timestamp、source、value等信息。
 
-		if (0 != hd->timestamp)
-			zbx_json_adduint64(j, ZBX_PROTO_TAG_LOGTIMESTAMP, hd->timestamp);
 
-		if ('\0' != string_buffer[hd->psource])
-		{
-			zbx_json_addstring(j, ZBX_PROTO_TAG_LOGSOURCE, &string_buffer[hd->psource],
-					ZBX_JSON_TYPE_STRING);
-		}
 
-		if (0 != hd->severity)
-			zbx_json_adduint64(j, ZBX_PROTO_TAG_LOGSEVERITY, hd->severity);
 
-		if (0 != hd->logeventid)
-			zbx_json_adduint64(j, ZBX_PROTO_TAG_LOGEVENTID, hd->logeventid);
 
-		if (ITEM_STATE_NORMAL != hd->state)
-			zbx_json_adduint64(j, ZBX_PROTO_TAG_STATE, hd->state);
 
-		if (0 == (PROXY_HISTORY_FLAG_NOVALUE & hd->flags))
-		{
-			zbx_json_addstring(j, ZBX_PROTO_TAG_VALUE, &string_buffer[hd->pvalue], ZBX_JSON_TYPE_STRING);
-		}
 
-		if (0 != (PROXY_HISTORY_FLAG_META & hd->flags))
-		{
-			zbx_json_adduint64(j, ZBX_PROTO_TAG_LASTLOGSIZE, hd->lastlogsize);
-			zbx_json_adduint64(j, ZBX_PROTO_TAG_MTIME, hd->mtime);
-		}
 
 		// 添加其他元数据信息。
 
-		zbx_json_close(j);
 
 		// 增加记录数量。
 
-		(*records_num)++;
 
 		/* stop gathering data to avoid exceeding the maximum packet size */
-		if (ZBX_DATA_JSON_RECORD_LIMIT < j->buffer_offset)
-		{
 			/* rollback lastid and id to the last added itemid */
-			*lastid = hd->id;
-			*id = hd->id;
 
-			*more = ZBX_PROXY_DATA_MORE;
-			break;
-		}
-	}
-	DCconfig_clean_items(dc_items, errcodes, data_num);
-	zbx_free(dc_items);
 
-	if (ZBX_MAX_HRECORDS == data_num)
-		*more = ZBX_PROXY_DATA_MORE;
 
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%d selected:" ZBX_FS_SIZE_T " lastid:" ZBX_FS_UI64 " more:%d size:"
-			ZBX_FS_SIZE_T, __function_name, *records_num - records_num_last, (zbx_fs_size_t)data_num,
-			*lastid, *more, (zbx_fs_size_t)j->buffer_offset);
-}
 
 	while (NULL != (row = DBfetch(result)))
 	{
@@ -2672,6 +2912,31 @@ int proxy_get_dhis_data(struct zbx_json *j, zbx_uint64_t *lastid, int *more)
 	return records_num;
 }
 
+int	proxy_get_areg_data(struct zbx_json *j, zbx_uint64_t *lastid, int *more)
+{
+	int		records_num = 0;
+	zbx_uint64_t	id;
+
+	proxy_get_lastid(areg.table, areg.lastidfield, &id);
+
+	/* get history data in batches by ZBX_MAX_HRECORDS records and stop if: */
+	/*   1) there are no more data to read                                  */
+	/*   2) we have retrieved more than the total maximum number of records */
+	/*   3) we have gathered more than half of the maximum packet size      */
+	while (ZBX_DATA_JSON_BATCH_LIMIT > j->buffer_offset)
+	{
+		proxy_get_history_data_simple(j, ZBX_PROTO_TAG_AUTO_REGISTRATION, &areg, lastid, &id, &records_num,
+				more);
+
+		if (ZBX_PROXY_DATA_DONE == *more || ZBX_MAX_HRECORDS_TOTAL <= records_num)
+			break;
+	}
+
+	if (0 != records_num)
+		zbx_json_close(j);
+
+	return records_num;
+}
 /******************************************************************************
  * *
  *整个代码块的主要目的是从输入的字符串（格式字符串和时间字符串）中解析出时间信息，并将解析出的时间信息转换为时间戳。具体步骤如下：
@@ -2755,6 +3020,12 @@ void	calc_timestamp(const char *line, int *timestamp, const char *format)
 		tm.tm_year = yyyy - 1900;
 		tm.tm_isdst = -1;
 
+		if (0 < (t = mktime(&tm)))
+			*timestamp = t;
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() timestamp:%d", __function_name, *timestamp);
+}
 		// 将时间结构体转换为时间戳
 /******************************************************************************
  * *
@@ -2790,75 +3061,26 @@ static int	process_history_data_value(DC_ITEM *item, zbx_agent_value_t *value)
 
 	/* 判断value的state是否为NOTSUPPORTED，如果是，或者value不为空且值为zbx_notsupported，则设置item的状态为NOTSUPPORTED */
 	if (ITEM_STATE_NOTSUPPORTED == value->state ||
-			(NULL != value->value && 0 == strcmp(value->value, ZBX_NOTSUPPORTED)))
-	{
-		zabbix_log(LOG_LEVEL_DEBUG, "item [%s:%s] error: %s", item->host.host, item->key_orig, value->value);
 
-		item->state = ITEM_STATE_NOTSUPPORTED;
-		zbx_preprocess_item_value(item->itemid, item->value_type, item->flags, NULL, &value->ts, item->state,
-				value->value);
-	}
-	else
-	{
-		AGENT_RESULT	result;
 
 		/* 初始化result结构体 */
-		init_result(&result);
 
 		/* 判断value是否为空 */
-		if (NULL != value->value)
-		{
 			/* 判断item的value_type是否为LOG */
-			if (ITEM_VALUE_TYPE_LOG == item->value_type)
-			{
-				zbx_log_t	*log;
 
-				log = (zbx_log_t *)zbx_malloc(NULL, sizeof(zbx_log_t));
-				log->value = zbx_strdup(NULL, value->value);
-				zbx_replace_invalid_utf8(log->value);
 
 				/* 判断value的timestamp是否为0 */
-				if (0 == value->timestamp)
-				{
-					log->timestamp = 0;
-					calc_timestamp(log->value, &log->timestamp, item->logtimefmt);
-				}
-				else
-					log->timestamp = value->timestamp;
 
-				log->logeventid = value->logeventid;
-				log->severity = value->severity;
 
 				/* 判断value的source是否为空 */
-				if (NULL != value->source)
-				{
-					log->source = zbx_strdup(NULL, value->source);
-					zbx_replace_invalid_utf8(log->source);
-				}
-				else
-					log->source = NULL;
 
-				SET_LOG_RESULT(&result, log);
-			}
-			else
-				set_result_type(&result, ITEM_VALUE_TYPE_TEXT, value->value);
-		}
 
 		/* 判断value的meta是否为0 */
-		if (0 != value->meta)
-			set_result_meta(&result, value->lastlogsize, value->mtime);
 
 		/* 更新item的状态为NORMAL，并处理value */
-		item->state = ITEM_STATE_NORMAL;
-		zbx_preprocess_item_value(item->itemid, item->value_type, item->flags, &result, &value->ts, item->state,
-				NULL);
 
 		/* 释放result内存 */
-		free_result(&result);
-	}
 
-	return SUCCEED;
-}
 
 			(NULL != value->value && 0 == strcmp(value->value, ZBX_NOTSUPPORTED)))
 	{
@@ -2979,6 +3201,29 @@ int	process_history_data(DC_ITEM *items, zbx_agent_value_t *values, int *errcode
 
 	for (i = 0; i < values_num; i++)
 	{
+		if (SUCCEED != errcodes[i])
+			continue;
+
+		if (SUCCEED != process_history_data_value(&items[i], &values[i]))
+		{
+			/* clean failed items to avoid updating their runtime data */
+			DCconfig_clean_items(&items[i], &errcodes[i], 1);
+			errcodes[i] = FAIL;
+			continue;
+		}
+
+		processed_num++;
+	}
+
+	if (0 < processed_num)
+		zbx_dc_items_update_nextcheck(items, values, errcodes, values_num);
+
+	zbx_preprocessor_flush();
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() processed:%d", __function_name, processed_num);
+
+	return processed_num;
+}
 /******************************************************************************
  * *
  *这段代码的主要目的是解析历史数据行的值，并将解析得到的值存储在 `zbx_agent_value_t` 结构体中。在解析过程中，代码依次处理了以下字段：
@@ -2997,116 +3242,70 @@ int	process_history_data(DC_ITEM *items, zbx_agent_value_t *values, int *errcode
  *在处理每个字段时，代码首先尝试从json解析结构体中获取相应的值，然后验证其合法性，并将合法的值赋给相应的结构体成员。如果在某个字段上失败，代码将跳过该字段并继续处理下一个字段。最后，将解析得到的值存储在 `zbx_agent_value_t` 结构体中并返回成功。
  ******************************************************************************/
 // 定义一个C语言函数，用于解析历史数据行的值
-static int parse_history_data_row_value(const struct zbx_json_parse *jp_row, zbx_timespec_t *unique_shift,
-                                       zbx_agent_value_t *av)
+static void	zbx_agent_values_clean(zbx_agent_value_t *values, size_t values_num)
 {
 	// 定义一个临时指针和分配大小
-	char *tmp = NULL;
-	size_t tmp_alloc = 0;
+	size_t	i;
 
 	// 初始化agent_value结构体
-	memset(av, 0, sizeof(zbx_agent_value_t));
+	for (i = 0; i < values_num; i++)
 
 	// 尝试从json解析结构体中获取 Clock 字段的值
-	if (SUCCEED == zbx_json_value_by_name_dyn(jp_row, ZBX_PROTO_TAG_CLOCK, &tmp, &tmp_alloc, NULL))
 	{
 		// 验证 Clock 值是否为合法的uint31位整数
-		if (FAIL == is_uint31(tmp, &av->ts.sec))
-			goto out;
+		zbx_free(values[i].value);
+		zbx_free(values[i].source);
 
 		// 尝试从json解析结构体中获取 NS 字段的值
-		if (SUCCEED == zbx_json_value_by_name_dyn(jp_row, ZBX_PROTO_TAG_NS, &tmp, &tmp_alloc, NULL))
-		{
 			// 验证 NS 值是否为合法的uint64位整数
-			if (FAIL == is_uint_n_range(tmp, tmp_alloc, &av->ts.ns, sizeof(av->ts.ns),
-			                            0LL, 999999999LL))
-			{
-				goto out;
-			}
-		}
-		else
-		{
 			// 如果仅存在 Clock 值，确保唯一性时间戳（clock，ns）
 
-			av->ts.sec += unique_shift->sec;
-			av->ts.ns = unique_shift->ns++;
 
 			// 更新时间戳，直到达到上限
-			while (unique_shift->ns > 999999999)
-			{
-				unique_shift->sec++;
-				unique_shift->ns = 0;
-			}
-		}
-	}
-	else
 		// 如果不存在 Clock 字段，使用默认时间戳
-		zbx_timespec(&av->ts);
 
 	// 尝试从json解析结构体中获取 State 字段的值
-	if (SUCCEED == zbx_json_value_by_name_dyn(jp_row, ZBX_PROTO_TAG_STATE, &tmp, &tmp_alloc, NULL))
-		av->state = (unsigned char)atoi(tmp);
 
 	/* 忽略不支持的项元数据，以保持向后兼容性 */
 	/* 新代理不会发送不支持状态的项的元数据。           */
-	if (ITEM_STATE_NOTSUPPORTED != av->state)
-	{
 		// 尝试从json解析结构体中获取 LastLogSize 字段的值
-		if (SUCCEED == zbx_json_value_by_name_dyn(jp_row, ZBX_PROTO_TAG_LASTLOGSIZE, &tmp, &tmp_alloc, NULL))
-		{
-			av->meta = 1;	/* 包含元数据 */
 
 			// 验证 LastLogSize 值是否为合法的uint64位整数
-			is_uint64(tmp, &av->lastlogsize);
 
-			if (SUCCEED == zbx_json_value_by_name_dyn(jp_row, ZBX_PROTO_TAG_MTIME, &tmp, &tmp_alloc, NULL))
-				av->mtime = atoi(tmp);
 		}
 	}
 
 	// 尝试从json解析结构体中获取 Value 字段的值
-	if (SUCCEED == zbx_json_value_by_name_dyn(jp_row, ZBX_PROTO_TAG_VALUE, &tmp, &tmp_alloc, NULL))
+static void	log_client_timediff(int level, struct zbx_json_parse *jp, const zbx_timespec_t *ts_recv)
 	{
 		// 复制 Value 值到 av->value 变量中
-		av->value = zbx_strdup(av->value, tmp);
-	}
-	else
+	const char	*__function_name = "log_client_timediff";
+
+	char		tmp[32];
+	zbx_timespec_t	client_timediff;
+	int		sec, ns;
+
+	if (SUCCEED != ZBX_CHECK_LOG_LEVEL(level))
+		return;
+
+	if (SUCCEED == zbx_json_value_by_name(jp, ZBX_PROTO_TAG_CLOCK, tmp, sizeof(tmp), NULL))
 	{
-		if (0 == av->meta)
-		{
+		sec = atoi(tmp);
+		client_timediff.sec = ts_recv->sec - sec;
 			/* 仅在元数据更新数据包中允许空值 */
-			goto out;
-		}
-	}
 
 	// 尝试从json解析结构体中获取 LogTimestamp 字段的值
-	if (SUCCEED == zbx_json_value_by_name_dyn(jp_row, ZBX_PROTO_TAG_LOGTIMESTAMP, &tmp, &tmp_alloc, NULL))
-		av->timestamp = atoi(tmp);
 
 	// 尝试从json解析结构体中获取 LogSource 字段的值
-	if (SUCCEED == zbx_json_value_by_name_dyn(jp_row, ZBX_PROTO_TAG_LOGSOURCE, &tmp, &tmp_alloc, NULL))
-		av->source = zbx_strdup(av->source, tmp);
 
 	// 尝试从json解析结构体中获取 LogSeverity 字段的值
-	if (SUCCEED == zbx_json_value_by_name_dyn(jp_row, ZBX_PROTO_TAG_LOGSEVERITY, &tmp, &tmp_alloc, NULL))
-		av->severity = atoi(tmp);
 
 	// 尝试从json解析结构体中获取 LogEventId 字段的值
-	if (SUCCEED != zbx_json_value_by_name_dyn(jp_row, ZBX_PROTO_TAG_LOGEVENTID, &tmp, &tmp_alloc, NULL) ||
-			SUCCEED != is_uint64(tmp, &av->id))
-	{
-		av->id = 0;
-	}
 
 	// 释放临时指针
-	zbx_free(tmp);
 
 	// 返回成功
-	ret = SUCCEED;
 
-out:
-	return ret;
-}
 
 
         // 如果成功获取到时间戳的纳秒部分，将其存储在ns变量中
@@ -3126,20 +3325,9 @@ out:
             {
                 client_timediff.sec++;
                 client_timediff.ns -= 1000000000;
-            }
 
             // 输出日志，显示时间差
-            zabbix_log(level, "%s(): timestamp from json %d seconds and %d nanosecond, "
-                        "delta time from json %d seconds and %d nanosecond",
-                        __function_name, sec, ns, client_timediff.sec, client_timediff.ns);
-        }
-        else
-        {
             // 输出日志，显示仅有的秒部分时间差
-            zabbix_log(level, "%s(): timestamp from json %d seconds, "
-                "delta time from json %d seconds", __function_name, sec, client_timediff.sec);
-        }
-    }
 }
 
 			zabbix_log(level, "%s(): timestamp from json %d seconds and %d nanosecond, "
@@ -3366,7 +3554,7 @@ static int	parse_history_data_row_hostkey(const struct zbx_json_parse *jp_row, z
 // int *parsed_num：用于存储已解析的总行数；
 // zbx_timespec_t *unique_shift：指向zbx_timespec结构体的指针，用于存储唯一偏移；
 // char **error：指向error字符串的指针。
-static int parse_history_data(struct zbx_json_parse *jp_data, const char **pNext, zbx_agent_value_t *values,
+static int	parse_history_data(struct zbx_json_parse *jp_data, const char **pnext, zbx_agent_value_t *values,
                              zbx_host_key_t *hostkeys, int *values_num, int *parsed_num, zbx_timespec_t *unique_shift,
                              char **error)
 {
@@ -3385,9 +3573,9 @@ static int parse_history_data(struct zbx_json_parse *jp_data, const char **pNext
     *parsed_num = 0;
 
     // 判断指针pNext是否为空，若为空，则退出循环
-    if (NULL == *pNext)
+    if (NULL == *pnext)
     {
-        if (NULL == (*pNext = zbx_json_next(jp_data, *pNext)) && *values_num < ZBX_HISTORY_VALUES_MAX)
+        if (NULL == (*pnext = zbx_json_next(jp_data, *pnext)) && *values_num < ZBX_HISTORY_VALUES_MAX)
         {
             ret = SUCCEED;
             goto out;
@@ -3398,7 +3586,7 @@ static int parse_history_data(struct zbx_json_parse *jp_data, const char **pNext
     do
     {
         // 解析json中的行数据
-        if (FAIL == zbx_json_brackets_open(*pNext, &jp_row))
+        if (FAIL == zbx_json_brackets_open(*pnext, &jp_row))
         {
             // 解析失败，复制错误信息到error字符串中，并退出循环
             *error = zbx_strdup(*error, zbx_json_strerror());
@@ -3424,40 +3612,16 @@ static int parse_history_data(struct zbx_json_parse *jp_data, const char **pNext
  *11. 返回解析结果。
  ******************************************************************************/
 /* 静态函数：parse_history_data_33，用于解析新的代理历史数据 */
-static int	parse_history_data_33(struct zbx_json_parse *jp_data, const char **pNext， zbx_agent_value_t *values，
-		zbx_uint64_t *itemids， int *values_num， int *parsed_num， zbx_timespec_t *unique_shift， char **error）
-{
-	const char		*__function_name = "parse_history_data_33"; // 函数名
 
-	struct zbx_json_parse	jp_row; // 用于存储每一行数据的结构体
-	int			ret = FAIL; // 初始化返回值为失败
 
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name); // 记录日志，进入函数
 
-	*values_num = 0;
-	*parsed_num = 0;
 
-	if (NULL == *pNext) // 如果指针pNext为空
-	{
-		if (NULL == (*pNext = zbx_json_next(jp_data, *pNext)) && *values_num < ZBX_HISTORY_VALUES_MAX) // 如果指针pNext不为空且未达到最大值
-		{
-			ret = SUCCEED;
-			goto out; // 解析成功，跳转到out标签
-		}
-	}
 
 	/* 遍历历史数据行 */
-	do
-	{
-		if (FAIL == zbx_json_brackets_open(*pNext, &jp_row)) // 打开json brackets失败
-		{
-			*error = zbx_strdup(*error, zbx_json_strerror()); // 保存错误信息
-			goto out; // 发生错误，跳转到out标签
-		}
 
 		(*parsed_num)++;
 
-		if (SUCCEED != parse_history_data_row_itemid(&jp_row, &itemids[*values_num])) // 解析itemid失败
+		if (SUCCEED != parse_history_data_row_hostkey(&jp_row, &hostkeys[*values_num]))
 			continue;
 
 		if (SUCCEED != parse_history_data_row_value(&jp_row, unique_shift, &values[*values_num])) // 解析value失败
@@ -3465,16 +3629,21 @@ static int	parse_history_data_33(struct zbx_json_parse *jp_data, const char **pN
 
 		(*values_num)++; // 统计解析成功的值数量
 	}
-	while (NULL != (*pNext = zbx_json_next(jp_data, *pNext)) && *values_num < ZBX_HISTORY_VALUES_MAX);
+	while (NULL != (*pnext = zbx_json_next(jp_data, *pnext)) && *values_num < ZBX_HISTORY_VALUES_MAX);
 
 	ret = SUCCEED; // 解析成功
 out:
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s processed:%d/%d", __function_name， zbx_result_string(ret)，
-			*values_num， *parsed_num); // 记录日志，结束函数
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s processed:%d/%d", __function_name, zbx_result_string(ret),
+			*values_num, *parsed_num);
 
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: parse_history_data_33                                            *
+ *                                                                            *
+ * Purpose: parses up to ZBX_HISTORY_VALUES_MAX item values and item          *
  *          identifiers from history data json                                *
  *                                                                            *
  * Parameters: jp_data      - [IN] JSON with history data array               *
@@ -3582,17 +3751,6 @@ out:
  *    ZBX_UNUSED(error);
  *
  *    /* don't process item if its host was assigned to another proxy */
- *    if (item->host.proxy_hostid != *proxyid)
- *        return FAIL;
- *
- *    /* don't process aggregate/calculated items coming from proxy */
- *    if (ITEM_TYPE_AGGREGATE == item->type || ITEM_TYPE_CALCULATED == item->type)
- *        return FAIL;
- *
- *    return SUCCEED;
- *}
- *```
- ******************************************************************************/
 // 定义一个名为 proxy_item_validator 的静态函数，参数为一个指向 DC_ITEM 结构的指针、一个指向 zbx_socket_t 结构的指针、一个指向 void 类型的指针，以及一个字符指针数组
 static int	proxy_item_validator(DC_ITEM *item, zbx_socket_t *sock, void *args, char **error)
 {
@@ -3665,6 +3823,7 @@ static int agent_item_validator(DC_ITEM *item, zbx_socket_t *sock, void *args, c
 
 	// 返回主机权限验证结果。
 	return rights->value;
+}
 /******************************************************************************
  * 以下是我为您注释的代码块：
  *
@@ -3684,42 +3843,81 @@ static int sender_item_validator(DC_ITEM *item, zbx_socket_t *sock, void *args,
 
 	/* 如果item中的proxy_hostid不为0，返回失败 */
 	if (0 != item->host.proxy_hostid)
+		return FAIL;
+
+	switch(item->type)
+	{
+		case ITEM_TYPE_HTTPAGENT:
+			if (0 == item->allow_traps)
+			{
+				*error = zbx_dsprintf(*error, "cannot process HTTP agent item \"%s\" trap:"
+						" trapping is not enabled", item->key_orig);
+				return FAIL;
+			}
+			break;
+		case ITEM_TYPE_TRAPPER:
+			break;
+		default:
+			*error = zbx_dsprintf(*error, "cannot process item \"%s\" trap:"
+					" item type \"%d\" cannot be used with traps", item->key_orig, item->type);
+			return FAIL;
+	}
+
+	if ('\0' != *item->trapper_hosts)	/* list of allowed hosts not empty */
+	{
+		char	*allowed_peers;
+		int	ret;
+
+		allowed_peers = zbx_strdup(NULL, item->trapper_hosts);
+		substitute_simple_macros(NULL, NULL, NULL, NULL, NULL, NULL, item, NULL, NULL,
+				&allowed_peers, MACRO_TYPE_ALLOWED_HOSTS, NULL, 0);
+		ret = zbx_tcp_check_allowed_peers(sock, allowed_peers);
+		zbx_free(allowed_peers);
+
+		if (FAIL == ret)
+		{
+			*error = zbx_dsprintf(*error, "cannot process item \"%s\" trap: %s",
+					item->key_orig, zbx_socket_strerror());
+			return FAIL;
+		}
+	}
+
+	rights = (zbx_host_rights_t *)args;
+
+	if (rights->hostid != item->host.hostid)
+	{
+		rights->hostid = item->host.hostid;
+		rights->value = zbx_host_check_permissions(&item->host, sock, error);
+	}
+
+	return rights->value;
+}
 /******************************************************************************
  * *
  *这个代码块的主要目的是处理客户端发送的历史数据。它首先解析客户端发送的 JSON 数据，然后根据解析出的数据创建或获取数据会话，接着验证每个数据项是否有效。如果数据项有效，它会将数据项添加到数据会话中，否则清除该数据项。在整个过程中，它会统计成功处理的数据项数量和失败的数据项数量，并在最后打印处理结果。
  ******************************************************************************/
 /* 定义一个静态函数，用于处理客户端历史数据 */
-static int	process_client_history_data(zbx_socket_t *sock, struct zbx_json_parse *jp, zbx_timespec_t *ts,
-		zbx_client_item_validator_t validator_func, void *validator_args, char **info);
 
 /* 函数声明 */
-int	main();
 
 /* 主函数，程序入口 */
-int main()
-{
 	/* 省略其他代码 */
 
 	/* 调用处理客户端历史数据的函数 */
-	int ret = process_client_history_data(sock, jp, ts, validator_func, validator_args, info);
 
 	/* 处理返回结果 */
-	printf("处理结果：%s\
-", zbx_result_string(ret));
 
-	return 0;
-}
 
 /* 处理客户端历史数据的函数 */
 static int	process_client_history_data(zbx_socket_t *sock, struct zbx_json_parse *jp, zbx_timespec_t *ts,
 		zbx_client_item_validator_t validator_func, void *validator_args, char **info)
 {
 	/* 定义常量和变量 */
-	static const char *__function_name = "process_client_history_data";
+	const char		*__function_name = "process_client_history_data";
 	int		ret, values_num, read_num, processed_num = 0, total_num = 0, i;
 	struct zbx_json_parse	jp_data;
 	zbx_timespec_t		unique_shift = {0, 0};
-	const char		*pNext = NULL;
+	const char		*pnext = NULL;
 	char			*error = NULL, *token = NULL;
 	size_t			token_alloc = 0;
 	zbx_host_key_t		*hostkeys;
@@ -3731,120 +3929,52 @@ static int	process_client_history_data(zbx_socket_t *sock, struct zbx_json_parse
 	int			errcodes[ZBX_HISTORY_VALUES_MAX];
 
 	/* 打印调试信息 */
-	zabbix_log(LOG_LEVEL_DEBUG, "进入 %s()"， __function_name);
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
+
+	log_client_timediff(LOG_LEVEL_DEBUG, jp, ts);
 
+	sec = zbx_time();
 	/* 解析客户端发送的历史数据 */
 	if (SUCCEED != (ret = zbx_json_brackets_by_name(jp, ZBX_PROTO_TAG_DATA, &jp_data)))
 	{
 		error = zbx_strdup(error, zbx_json_strerror());
 		ret = FAIL;
 		goto out;
-	}
 
 	/* 获取客户端发送的会话 token */
-	if (SUCCEED == zbx_json_value_by_name_dyn(jp, ZBX_PROTO_TAG_SESSION, &token, &token_alloc, NULL))
-	{
-		size_t	token_len;
 
-		if (ZBX_DATA_SESSION_TOKEN_SIZE != (token_len = strlen(token)))
-		{
-			error = zbx_dsprintf(NULL, "无效的会话 token 长度 %d"， (int)token_len);
-			zbx_free(token);
-			ret = FAIL;
-			goto out;
-		}
-	}
 
 	/* 分配内存，用于存储主机名和键名 */
-	hostkeys = (zbx_host_key_t *)zbx_malloc(NULL, sizeof(zbx_host_key_t) * ZBX_HISTORY_VALUES_MAX);
-	items = (DC_ITEM *)zbx_malloc(NULL, sizeof(DC_ITEM) * ZBX_HISTORY_VALUES_MAX);
-	memset(hostkeys, 0, sizeof(zbx_host_key_t) * ZBX_HISTORY_VALUES_MAX);
 
 	/* 循环解析历史数据 */
-	while (SUCCEED == parse_history_data(&jp_data, &pNext, values, hostkeys, &values_num, &read_num,
-			&unique_shift, &error) && 0 != values_num)
-	{
 		/* 获取下一个数据项 */
-		DCconfig_get_items_by_keys(items, hostkeys, errcodes, values_num);
 
 		/* 遍历数据项 */
-		for (i = 0; i < values_num; i++)
-		{
 			/* 检查数据项是否有效 */
-			if (SUCCEED != errcodes[i])
-				continue;
 
 			/* 检查是否到达最后一个数据项 */
-			if (last_hostid != items[i].host.hostid)
-			{
-				last_hostid = items[i].host.hostid;
 
 				/* 创建或获取数据会话 */
-				if (NULL != token)
-					session = zbx_dc_get_or_create_data_session(last_hostid, token);
-			}
 
 			/* 验证数据项 */
-			if (SUCCEED != validator_func(&items[i], sock, validator_args, &error))
-			{
 				/* 打印错误信息 */
-				if (NULL != error)
-				{
-					zabbix_log(LOG_LEVEL_WARNING, "%s"， error);
-					zbx_free(error);
-				}
 
 				/* 清除数据项 */
-				DCconfig_clean_items(&items[i], &errcodes[i], 1);
-				errcodes[i] = FAIL;
-			}
 
 			/* 更新数据会话的最后值 */
-			if (NULL != session)
-				session->last_valueid = values[i].id;
-		}
 
 		/* 处理历史数据 */
-		processed_num += process_history_data(items, values, errcodes, values_num);
-		total_num += read_num;
 
 		/* 清除数据项 */
-		DCconfig_clean_items(items, errcodes, values_num);
-		zbx_agent_values_clean(values, values_num);
 
 		/* 结束循环 */
-		if (NULL == pNext)
-			break;
-	}
 
 	/* 释放内存 */
-	for (i = 0; i < ZBX_HISTORY_VALUES_MAX; i++)
-	{
-		zbx_free(hostkeys[i].host);
-		zbx_free(hostkeys[i].key);
-	}
 
-	zbx_free(hostkeys);
-	zbx_free(items);
-	zbx_free(token);
 
 	/* 打印处理结果 */
-	if (NULL == error)
-	{
-		ret = SUCCEED;
-		*info = zbx_dsprintf(*info, "处理成功：%d；失败：%d；总数：%d；耗时：%.2f秒"，
-				processed_num， total_num - processed_num， total_num， zbx_time() - sec);
-	}
-	else
-	{
-		zbx_free(*info);
-		*info = error;
-	}
 
-out:
-	zabbix_log(LOG_LEVEL_DEBUG, "退出 %s()"， __function_name);
 
-	return ret;
 }
 
 	if (SUCCEED == zbx_json_value_by_name_dyn(jp, ZBX_PROTO_TAG_SESSION, &token, &token_alloc, NULL))
@@ -3943,6 +4073,274 @@ out:
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: process_proxy_history_data                                       *
+ *                                                                            *
+ * Purpose: process history data received from Zabbix proxy                   *
+ *                                                                            *
+ * Parameters: proxy        - [IN] the source proxy                           *
+ *             jp           - [IN] the JSON with history data                 *
+ *             ts           - [IN] the connection timestamp                   *
+ *             info         - [OUT] address of a pointer to the info string   *
+ *                                  (should be freed by the caller)           *
+ *                                                                            *
+ * Return value:  SUCCEED - processed successfully                            *
+ *                FAIL - an error occurred                                    *
+ *                                                                            *
+ ******************************************************************************/
+int	process_proxy_history_data(const DC_PROXY *proxy, struct zbx_json_parse *jp, zbx_timespec_t *ts, char **info)
+{
+	return process_client_history_data(NULL, jp, ts, proxy_item_validator, (void *)&proxy->hostid, info);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: process_agent_history_data                                       *
+ *                                                                            *
+ * Purpose: process history data received form Zabbix active agent            *
+ *                                                                            *
+ * Parameters: sock         - [IN] the connection socket                      *
+ *             jp           - [IN] the JSON with history data                 *
+ *             ts           - [IN] the connection timestamp                   *
+ *             info         - [OUT] address of a pointer to the info string   *
+ *                                  (should be freed by the caller)           *
+ *                                                                            *
+ * Return value:  SUCCEED - processed successfully                            *
+ *                FAIL - an error occurred                                    *
+ *                                                                            *
+ ******************************************************************************/
+int	process_agent_history_data(zbx_socket_t *sock, struct zbx_json_parse *jp, zbx_timespec_t *ts, char **info)
+{
+	zbx_host_rights_t	rights = {0};
+
+	return process_client_history_data(sock, jp, ts, agent_item_validator, &rights, info);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: process_sender_history_data                                      *
+ *                                                                            *
+ * Purpose: process history data received form Zabbix sender                  *
+ *                                                                            *
+ * Parameters: sock         - [IN] the connection socket                      *
+ *             jp           - [IN] the JSON with history data                 *
+ *             ts           - [IN] the connection timestamp                   *
+ *             info         - [OUT] address of a pointer to the info string   *
+ *                                  (should be freed by the caller)           *
+ *                                                                            *
+ * Return value:  SUCCEED - processed successfully                            *
+ *                FAIL - an error occurred                                    *
+ *                                                                            *
+ ******************************************************************************/
+int	process_sender_history_data(zbx_socket_t *sock, struct zbx_json_parse *jp, zbx_timespec_t *ts, char **info)
+{
+	zbx_host_rights_t	rights = {0};
+
+	return process_client_history_data(sock, jp, ts, sender_item_validator, &rights, info);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: process_sender_bulk_batch                                        *
+ *                                                                            *
+ * Purpose: validates and processes a batch of values received in sender bulk *
+ *          data                                                              *
+ *                                                                            *
+ * Parameters: sock       - [IN] the connection socket                        *
+ *             rights     - [IN/OUT] the cached host access rights            *
+ *             items      - [IN] the item buffer                              *
+ *             values     - [IN] the item values                              *
+ *             hostkeys   - [IN] the host,key pairs if by_itemid is 0         *
+ *             itemids    - [IN] the item identifiers if by_itemid is 1       *
+ *             errcodes   - [IN] the error code buffer                        *
+ *             values_num - [IN] the number of values                         *
+ *             by_itemid  - [IN] 1 - the values are identified by itemids,    *
+ *                               0 - by host,key pairs                        *
+ *                                                                            *
+ * Return value: The number of processed values.                              *
+ *                                                                            *
+ * Comments: All values of a batch are resolved with a single configuration   *
+ *           cache request.                                                   *
+ *                                                                            *
+ ******************************************************************************/
+static int	process_sender_bulk_batch(zbx_socket_t *sock, zbx_host_rights_t *rights, DC_ITEM *items,
+		zbx_agent_value_t *values, zbx_host_key_t *hostkeys, const zbx_uint64_t *itemids, int *errcodes,
+		int values_num, int by_itemid)
+{
+	int	i, processed_num;
+	char	*error = NULL;
+
+	if (1 == by_itemid)
+		DCconfig_get_items_by_itemids(items, itemids, errcodes, values_num);
+	else
+		DCconfig_get_items_by_keys(items, hostkeys, errcodes, values_num);
+
+	for (i = 0; i < values_num; i++)
+	{
+		if (SUCCEED != errcodes[i])
+			continue;
+
+		if (SUCCEED != sender_item_validator(&items[i], sock, rights, &error))
+		{
+			if (NULL != error)
+			{
+				zabbix_log(LOG_LEVEL_WARNING, "%s", error);
+				zbx_free(error);
+			}
+
+			DCconfig_clean_items(&items[i], &errcodes[i], 1);
+			errcodes[i] = FAIL;
+		}
+	}
+
+	processed_num = process_history_data(items, values, errcodes, values_num);
+
+	DCconfig_clean_items(items, errcodes, values_num);
+	zbx_agent_values_clean(values, values_num);
+
+	return processed_num;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: process_sender_bulk_data                                         *
+ *                                                                            *
+ * Purpose: process history data received from Zabbix sender in bulk format  *
+ *                                                                            *
+ * Parameters: sock - [IN] the connection socket                              *
+ *             data - [IN] the records following the bulk data header         *
+ *             ts   - [IN] the connection timestamp                           *
+ *             info - [OUT] address of a pointer to the info string (should   *
+ *                          be freed by the caller)                           *
+ *                                                                            *
+ * Return value:  SUCCEED - processed successfully                            *
+ *                FAIL - an error occurred                                    *
+ *                                                                            *
+ * Comments: The data contains newline delimited JSON objects, one per value, *
+ *           having the same tags as rows of sender data. Instead of host and *
+ *           key tags a value can be identified by itemid tag.                *
+ *           The records are parsed one by one and processed in batches of    *
+ *           ZBX_HISTORY_VALUES_MAX values, without validating and scanning   *
+ *           the whole request first. Invalid records are counted as failed   *
+ *           and skipped.                                                     *
+ *           The data buffer is modified during parsing and restored after.   *
+ *                                                                            *
+ ******************************************************************************/
+int	process_sender_bulk_data(zbx_socket_t *sock, char *data, zbx_timespec_t *ts, char **info)
+{
+	const char		*__function_name = "process_sender_bulk_data";
+
+	struct zbx_json_parse	jp_row;
+	zbx_timespec_t		unique_shift = {0, 0};
+	zbx_host_rights_t	rights = {0};
+	zbx_host_key_t		*hostkeys;
+	zbx_uint64_t		*itemids;
+	DC_ITEM			*items;
+	char			*p, *eol;
+	int			values_num = 0, processed_num = 0, total_num = 0, by_itemid = 0, row_by_itemid, i;
+	double			sec;
+	zbx_agent_value_t	values[ZBX_HISTORY_VALUES_MAX];
+	int			errcodes[ZBX_HISTORY_VALUES_MAX];
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
+
+	ZBX_UNUSED(ts);
+
+	sec = zbx_time();
+
+	items = (DC_ITEM *)zbx_malloc(NULL, sizeof(DC_ITEM) * ZBX_HISTORY_VALUES_MAX);
+	itemids = (zbx_uint64_t *)zbx_malloc(NULL, sizeof(zbx_uint64_t) * ZBX_HISTORY_VALUES_MAX);
+	hostkeys = (zbx_host_key_t *)zbx_malloc(NULL, sizeof(zbx_host_key_t) * ZBX_HISTORY_VALUES_MAX);
+	memset(hostkeys, 0, sizeof(zbx_host_key_t) * ZBX_HISTORY_VALUES_MAX);
+
+	for (p = data; '\0' != *p; p = (NULL != eol ? eol + 1 : p + strlen(p)))
+	{
+		if (NULL != (eol = strchr(p, '\n')))
+			*eol = '\0';
+
+		if ('\0' == *(p + strspn(p, " \t\r")))
+			goto next;
+
+		total_num++;
+
+		if (SUCCEED != zbx_json_open(p, &jp_row))
+		{
+			zabbix_log(LOG_LEVEL_DEBUG, "cannot parse sender bulk data record %d: %s", total_num,
+					zbx_json_strerror());
+			goto next;
+		}
+
+		row_by_itemid = (SUCCEED == parse_history_data_row_itemid(&jp_row, &itemids[values_num]) ? 1 : 0);
+
+		/* a batch is resolved either by itemids or host,key pairs, flush it when the record type changes */
+		if (0 != values_num && row_by_itemid != by_itemid)
+		{
+			if (1 == row_by_itemid)
+				itemids[0] = itemids[values_num];
+
+			processed_num += process_sender_bulk_batch(sock, &rights, items, values, hostkeys, itemids,
+					errcodes, values_num, by_itemid);
+			values_num = 0;
+		}
+
+		by_itemid = row_by_itemid;
+
+		if (0 == by_itemid && SUCCEED != parse_history_data_row_hostkey(&jp_row, &hostkeys[values_num]))
+			goto next;
+
+		if (SUCCEED != parse_history_data_row_value(&jp_row, &unique_shift, &values[values_num]))
+			goto next;
+
+		if (ZBX_HISTORY_VALUES_MAX == ++values_num)
+		{
+			processed_num += process_sender_bulk_batch(sock, &rights, items, values, hostkeys, itemids,
+					errcodes, values_num, by_itemid);
+			values_num = 0;
+		}
+next:
+		if (NULL != eol)
+			*eol = '\n';
+	}
+
+	if (0 != values_num)
+	{
+		processed_num += process_sender_bulk_batch(sock, &rights, items, values, hostkeys, itemids, errcodes,
+				values_num, by_itemid);
+	}
+
+	for (i = 0; i < ZBX_HISTORY_VALUES_MAX; i++)
+	{
+		zbx_free(hostkeys[i].host);
+		zbx_free(hostkeys[i].key);
+	}
+
+	zbx_free(hostkeys);
+	zbx_free(itemids);
+	zbx_free(items);
+
+	*info = zbx_dsprintf(*info, "processed: %d; failed: %d; total: %d; seconds spent: " ZBX_FS_DBL,
+			processed_num, total_num - processed_num, total_num, zbx_time() - sec);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(SUCCEED));
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: process_discovery_data_contents                                  *
+ *                                                                            *
+ * Purpose: parse discovery data contents and process it                      *
+ *                                                                            *
+ * Parameters: jp_data         - [IN] JSON with discovery data                *
+ *             error           - [OUT] address of a pointer to the info       *
+ *                                     string (should be freed by the caller) *
+ *                                                                            *
+ * Return value:  SUCCEED - processed successfully                            *
+ *                FAIL - an error occurred                                    *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  * 以下是对代码的逐行注释：
  *
@@ -3971,15 +4369,12 @@ static int process_discovery_data_contents(struct zbx_json_parse *jp_data, char
 	// 定义一个指向字符串的指针p，初始值为NULL
 	const char		*p = NULL;
 	// 定义一个字符数组ip，用于存储IP地址
-	char			ip[INTERFACE_IP_LEN_MAX];
+	char			last_ip[INTERFACE_IP_LEN_MAX], ip[INTERFACE_IP_LEN_MAX],
+				tmp[MAX_STRING_LEN], *value = NULL, dns[INTERFACE_DNS_LEN_MAX];
 	// 定义一个字符数组last_ip，用于存储上一个IP地址
-	char			last_ip[INTERFACE_IP_LEN_MAX];
 	// 定义一个字符数组tmp，用于存储临时数据
-	char			tmp[MAX_STRING_LEN];
 	// 定义一个指向字符串的指针value，初始值为NULL
-	char			*value = NULL;
 	// 定义一个字符数组dns，用于存储DNS名称
-	char			dns[INTERFACE_DNS_LEN_MAX];
 	// 定义一个时间戳变量itemtime，用于存储数据的时间
 	time_t			itemtime;
 	// 定义一个size_t类型的变量value_alloc，用于分配字符串缓冲区空间
@@ -4001,79 +4396,32 @@ static int process_discovery_data_contents(struct zbx_json_parse *jp_data, char
 	{
 		// 检查当前元素是否为zbx_json_brackets_open函数返回的FAIL
 		if (FAIL == zbx_json_brackets_open(p, &jp_row))
-			goto json_parse_error;
 
 		// 检查当前元素是否为zbx_json_value_by_name函数返回的FAIL
-		if (FAIL == zbx_json_value_by_name(&jp_row, ZBX_PROTO_TAG_CLOCK, tmp, sizeof(tmp), NULL))
-			goto json_parse_error;
 
 		// 将tmp字符串转换为整型，并存储在itemtime变量中
-		itemtime = atoi(tmp);
 
 		// 检查当前元素是否为zbx_json_value_by_name函数返回的FAIL
-		if (FAIL == zbx_json_value_by_name(&jp_row, ZBX_PROTO_TAG_DRULE, tmp, sizeof(tmp), NULL))
-			goto json_parse_error;
 
 		// 将tmp字符串转换为zbx_uint64_t类型，并存储在drule.druleid变量中
-		ZBX_STR2UINT64(drule.druleid, tmp);
 
 		// 检查当前元素是否为zbx_json_value_by_name函数返回的FAIL
-		if (FAIL == zbx_json_value_by_name(&jp_row, ZBX_PROTO_TAG_DCHECK, tmp, sizeof(tmp), NULL))
-			goto json_parse_error;
 
 		// 如果tmp字符串不为空，表示dcheckid不为0
-		if ('\0' != *tmp)
-			ZBX_STR2UINT64(dcheckid, tmp);
-		else
-			dcheckid = 0;
 
 		// 检查当前元素是否为zbx_json_value_by_name函数返回的FAIL
-		if (FAIL == zbx_json_value_by_name(&jp_row, ZBX_PROTO_TAG_IP, ip, sizeof(ip), NULL))
-			goto json_parse_error;
 
 		// 检查当前IP地址是否有效，如果无效，打印警告信息并跳过该元素
-		if (SUCCEED != is_ip(ip))
-		{
-			zabbix_log(LOG_LEVEL_WARNING, "%s(): \"%s\" is not a valid IP address", __function_name, ip);
-			continue;
-		}
 
 		// 检查当前元素是否为zbx_json_value_by_name函数返回的FAIL
-		if (FAIL == zbx_json_value_by_name(&jp_row, ZBX_PROTO_TAG_PORT, tmp, sizeof(tmp), NULL))
-		{
-			port = 0;
-		}
-		else if (FAIL == is_ushort(tmp, &port))
-		{
-			zabbix_log(LOG_LEVEL_WARNING, "%s(): \"%s\" is not a valid port", __function_name, tmp);
-			continue;
-		}
 
 		// 检查当前元素是否为zbx_json_value_by_name函数返回的FAIL
-		if (SUCCEED != zbx_json_value_by_name_dyn(&jp_row, ZBX_PROTO_TAG_VALUE, &value, &value_alloc, NULL))
-			*value = '\0';
 
 		// 检查当前元素是否为zbx_json_value_by_name函数返回的FAIL
-		if (FAIL == zbx_json_value_by_name(&jp_row, ZBX_PROTO_TAG_DNS, dns, sizeof(dns), NULL))
-		{
-			*dns = '\0';
-		}
-		else if ('\0' != *dns && FAIL == zbx_validate_hostname(dns))
-		{
-			zabbix_log(LOG_LEVEL_WARNING, "%s(): \"%s\" is not a valid hostname", __function_name, dns);
-			continue;
-		}
 
 		// 检查当前元素是否为zbx_json_value_by_name函数返回的FAIL
-		if (SUCCEED == zbx_json_value_by_name(&jp_row, ZBX_PROTO_TAG_STATUS, tmp, sizeof(tmp), NULL))
-			status = atoi(tmp);
-		else
-			status = 0;
 
 		// 检查当前元素是否为zbx_json_value_by_name函数返回的FAIL
-		if (0 == last_druleid || drule.druleid != last_druleid)
-		{
-			result = DBselect(
 
 			goto json_parse_error;
 
@@ -4211,6 +4559,39 @@ json_parse_error:
  * Function: process_discovery_data                                           *
  *                                                                            *
  * Purpose: update discovery data, received from proxy                        *
+ *                                                                            *
+ * Parameters: jp           - [IN] JSON with historical data                  *
+ *             ts           - [IN] timestamp when the proxy connection was    *
+ *                                 established                                *
+ *             error        - [OUT] address of a pointer to the info string   *
+ *                                  (should be freed by the caller)           *
+ *                                                                            *
+ * Return value:  SUCCEED - processed successfully                            *
+ *                FAIL - an error occurred                                    *
+ *                                                                            *
+ ******************************************************************************/
+int	process_discovery_data(struct zbx_json_parse *jp, zbx_timespec_t *ts, char **error)
+{
+	const char		*__function_name = "process_discovery_data";
+	int			ret;
+	struct zbx_json_parse	jp_data;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
+
+	log_client_timediff(LOG_LEVEL_DEBUG, jp, ts);
+
+	if (SUCCEED != (ret = zbx_json_brackets_by_name(jp, ZBX_PROTO_TAG_DATA, &jp_data)))
+	{
+		*error = zbx_strdup(*error, zbx_json_strerror());
+		goto out;
+	}
+
+	ret = process_discovery_data_contents(&jp_data, error);
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
+
+	return ret;
+}
 /******************************************************************************
  * *
  *这段代码的主要目的是处理自动注册的主机内容。它首先遍历输入的 JSON 数据，然后解析 JSON 数据以获取主机名、IP 地址、DNS 地址和端口号等信息。接下来，它准备注册主机并将这些信息保存到数据库。最后，释放内存并处理任何错误。
@@ -4244,85 +4625,37 @@ static int process_auto_registration_contents(struct zbx_json_parse *jp_data, zb
         if (FAIL == (ret = zbx_json_brackets_open(p, &jp_row)))
             break;
 
+		if (FAIL == (ret = zbx_json_value_by_name(&jp_row, ZBX_PROTO_TAG_CLOCK, tmp, sizeof(tmp), NULL)))
+			break;
+
+		itemtime = atoi(tmp);
         // 获取主机名
         if (FAIL == (ret = zbx_json_value_by_name(&jp_row, ZBX_PROTO_TAG_HOST, host, sizeof(host), NULL)))
             break;
 
         // 检查主机名是否合法
-        if (FAIL == zbx_check_hostname(host, NULL))
-        {
-            zabbix_log(LOG_LEVEL_WARNING, "%s(): \"%s\" is not a valid Zabbix host name", __function_name,
-                       host);
-            continue;
-        }
 
         // 获取主机元数据
-        if (FAIL == zbx_json_value_by_name_dyn(&jp_row, ZBX_PROTO_TAG_HOST_METADATA,
-                                                &host_metadata, &host_metadata_alloc, NULL))
-        {
-            *host_metadata = '\0';
-        }
 
         // 获取 IP 地址
-        if (FAIL == (ret = zbx_json_value_by_name(&jp_row, ZBX_PROTO_TAG_IP, ip, sizeof(ip), NULL)))
-            break;
 
         // 检查 IP 地址是否合法
-        if (SUCCEED != is_ip(ip))
-        {
-            zabbix_log(LOG_LEVEL_WARNING, "%s(): \"%s\" is not a valid IP address", __function_name, ip);
-            continue;
-        }
 
         // 获取 DNS 地址
-        if (FAIL == zbx_json_value_by_name(&jp_row, ZBX_PROTO_TAG_DNS, dns, sizeof(dns), NULL))
-        {
-            *dns = '\0';
-        }
-        else if ('\0' != *dns && FAIL == zbx_validate_hostname(dns))
-        {
-            zabbix_log(LOG_LEVEL_WARNING, "%s(): \"%s\" is not a valid hostname", __function_name, dns);
-            continue;
-        }
 
         // 获取端口号
-        if (FAIL == zbx_json_value_by_name(&jp_row, ZBX_PROTO_TAG_PORT, tmp, sizeof(tmp), NULL))
-        {
-            port = ZBX_DEFAULT_AGENT_PORT;
-        }
-        else if (FAIL == is_ushort(tmp, &port))
-        {
-            zabbix_log(LOG_LEVEL_WARNING, "%s(): \"%s\" is not a valid port", __function_name, tmp);
-            continue;
-        }
 
         // 准备注册主机
-        DBregister_host_prepare(&autoreg_hosts, host, ip, dns, port, host_metadata, itemtime);
-    }
 
     // 如果自动注册的主机数量不为零，则保存到数据库
-    if (0 != autoreg_hosts.values_num)
-    {
-        DBbegin();
-        DBregister_host_flush(&autoreg_hosts, proxy_hostid);
-        DBcommit();
-    }
 
     // 释放内存
-    zbx_free(host_metadata);
-    DBregister_host_clean(&autoreg_hosts);
-    zbx_vector_ptr_destroy(&autoreg_hosts);
 
     // 处理错误
-    if (SUCCEED != ret)
-        *error = zbx_strdup(*error, zbx_json_strerror());
 
     // 打印日志
-    zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
 
     // 返回结果
-    return ret;
-}
 
 		if (FAIL == zbx_check_hostname(host, NULL))
 		{
@@ -4477,10 +4810,8 @@ int proxy_get_history_count(void)
 
 	// 如果查询结果不为空，即找到了符合条件的记录
 	if (NULL != (row = DBfetch(result)))
-	{
 		// 获取查询结果中第一列的数据（即历史记录的数量），并将其转换为整型
 		count = atoi(row[0]);
-	}
 
 	// 释放查询结果占用的内存
 	DBfree_result(result);
@@ -4508,13 +4839,48 @@ int proxy_get_history_count(void)
  * *
  *整个代码块的主要目的是获取zbx协议的版本号。首先，通过zbx_json_value_by_name函数从传入的json解析结构体中获取版本号字符串。然后，对该字符串进行处理，去掉小数点，并计算出整型版本号。如果无法获取到版本号或版本号计算失败，则默认使用版本号3.2。最后，返回计算得到的版本号。
  ******************************************************************************/
-// 定义一个函数，用于获取zbx协议的版本号
-int zbx_get_protocol_version(struct zbx_json_parse *jp)
+int	zbx_get_protocol_version(struct zbx_json_parse *jp)
 {
+	char	value[MAX_STRING_LEN], *pminor, *ptr;
+	int	version;
+
+	if (NULL != jp &&
+			SUCCEED == zbx_json_value_by_name(jp, ZBX_PROTO_TAG_VERSION, value, sizeof(value), NULL) &&
+			NULL != (pminor = strchr(value, '.')))
+	{
+		*pminor++ = '\0';
+
+		if (NULL != (ptr = strchr(pminor, '.')))
+			*ptr = '\0';
+
+		version = ZBX_COMPONENT_VERSION(atoi(value), atoi(pminor));
+	}
+	else
+		version = ZBX_COMPONENT_VERSION(3, 2);
+
+	return version;
+
+}
+/******************************************************************************
+ * *
+ * Function: process_proxy_history_data_33                                    *
+ *                                                                            *
+ * Purpose: parses history data array and process the data                    *
+ *                                                                            *
+ * Parameters: proxy        - [IN] the proxy                                  *
+ *             jp_data      - [IN] JSON with history data array               *
+ *             session      - [IN] the data session                           *
+ *             unique_shift - [IN/OUT] auto increment nanoseconds to ensure   *
+ *                                     unique value of timestamps             *
+ *             info         - [OUT] address of a pointer to the info          *
+ *                                     string (should be freed by the caller) *
+ *                                                                            *
+ * Comments: This function is used to parse the new proxy history data        *
+ *           protocol introduced in Zabbix v3.3.                              *
+ *                                                                            *
+// 定义一个函数，用于获取zbx协议的版本号
 	// 定义一个字符数组，用于存储版本号
-	char value[MAX_STRING_LEN];
 	// 定义两个指针，分别指向小数点前和小数点后的字符串
-	char *pminor, *ptr;
 	// 定义一个整型变量，用于存储版本号
 /******************************************************************************
  * 以下是对代码块的逐行中文注释：
@@ -4528,7 +4894,7 @@ static void	process_proxy_history_data_33(const DC_PROXY *proxy, struct zbx_json
 {
 	const char		*__function_name = "process_proxy_history_data_33";
 
-	const char		*pNext = NULL;
+	const char		*pnext = NULL;
 	int			processed_num = 0, total_num = 0, values_num, read_num, i, *errcodes;
 	double			sec;
 	DC_ITEM			*items;
@@ -4548,7 +4914,7 @@ static void	process_proxy_history_data_33(const DC_PROXY *proxy, struct zbx_json
 	sec = zbx_time();
 
 	// 循环解析历史数据
-	while (SUCCEED == parse_history_data_33(jp_data, &pNext, values, itemids, &values_num, &read_num,
+	while (SUCCEED == parse_history_data_33(jp_data, &pnext, values, itemids, &values_num, &read_num,
 			unique_shift, &error) && 0 != values_num)
 	{
 		// 根据itemids获取对应的DC_ITEM结构体数组
@@ -4557,68 +4923,33 @@ static void	process_proxy_history_data_33(const DC_PROXY *proxy, struct zbx_json
 		// 遍历values_num个DC_ITEM结构体
 		for (i = 0; i < values_num; i++)
 		{
+			if (SUCCEED != errcodes[i])
+				continue;
 			// 检查并丢弃重复数据
 			if (NULL != session && 0 != values[i].id && values[i].id <= session->last_valueid)
 			{
 				DCconfig_clean_items(&items[i], &errcodes[i], 1);
-				errcodes[i] = FAIL;
-				continue;
-			}
 
 			// 验证代理项
-			if (SUCCEED != proxy_item_validator(&items[i], NULL, (void *)&proxy->hostid, &error))
-			{
 				// 如果验证失败，打印错误信息并释放错误码数组和DC_ITEM结构体数组
-				if (NULL != error)
-				{
-					zabbix_log(LOG_LEVEL_WARNING, "%s", error);
-					zbx_free(error);
-				}
 
-				DCconfig_clean_items(&items[i], &errcodes[i], 1);
-				errcodes[i] = FAIL;
-			}
-		}
 
 		// 处理历史数据
-		processed_num += process_history_data(items, values, errcodes, values_num);
 
 		// 累加已读取的数据条数
-		total_num += read_num;
 
 		// 如果存在会话，更新最后的数据ID
-		if (NULL != session)
-			session->last_valueid = values[values_num - 1].id;
 
 		// 清理DC_ITEM结构体数组和错误码数组
-		DCconfig_clean_items(items, errcodes, values_num);
-		zbx_agent_values_clean(values, values_num);
 
 		// 如果没有更多数据，跳出循环
-		if (NULL == pNext)
-			break;
-	}
 
 	// 释放内存
-	zbx_free(errcodes);
-	zbx_free(items);
 
 	// 如果未发生错误，输出处理结果
-	if (NULL == error)
-	{
-		*info = zbx_dsprintf(*info, "processed: %d; failed: %d; total: %d; seconds spent: " ZBX_FS_DBL,
-				processed_num, total_num - processed_num, total_num, zbx_time() - sec);
-	}
-	else
-	{
 		// 如果发生错误，释放原有信息并赋值错误信息
-		zbx_free(*info);
-		*info = error;
-	}
 
 	// 打印调试信息
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __function_name);
-}
 
 				errcodes[i] = FAIL;
 				continue;
@@ -4673,6 +5004,25 @@ static void	process_proxy_history_data_33(const DC_PROXY *proxy, struct zbx_json
  * Function: process_tasks_contents                                           *
  *                                                                            *
  * Purpose: parse tasks contents and saves the received tasks                 *
+ *                                                                            *
+ * Parameters: jp_tasks - [IN] JSON with tasks data                           *
+ *                                                                            *
+ ******************************************************************************/
+static void	process_tasks_contents(struct zbx_json_parse *jp_tasks)
+{
+	zbx_vector_ptr_t	tasks;
+
+	zbx_vector_ptr_create(&tasks);
+
+	zbx_tm_json_deserialize_tasks(jp_tasks, &tasks);
+
+	DBbegin();
+	zbx_tm_save_tasks(&tasks);
+	DBcommit();
+
+	zbx_vector_ptr_clear_ext(&tasks, (zbx_clean_func_t)zbx_tm_task_free);
+	zbx_vector_ptr_destroy(&tasks);
+}
 /******************************************************************************
  * *
  *这段代码的主要目的是处理代理发送的JSON数据。首先，它会解析JSON数据中的各种标签，如主机可用性、历史数据、发现数据、自动注册数据和任务数据。然后，根据不同类型的数据进行相应的处理。例如，对于主机可用性数据，它会处理主机可用性的内容；对于历史数据，它会创建或获取数据会话，并处理代理历史数据；对于发现数据，它会处理发现数据的内容；对于自动注册数据，它会处理自动注册数据的内容；对于任务数据，它会处理任务数据的内容。如果在处理过程中遇到错误，它会将错误信息添加到error指针指向的缓冲区中。最后，返回处理结果。
@@ -4689,101 +5039,52 @@ static void	process_proxy_history_data_33(const DC_PROXY *proxy, struct zbx_json
  * 注释：
  *   处理代理数据的函数，主要目的是解析代理发送的JSON数据，并根据数据类型进行相应处理。
  */
-int	process_proxy_data(const DC_PROXY *proxy, struct zbx_json_parse *jp, zbx_timespec_t *ts, char **error)
+static void	zbx_strcatnl_alloc(char **info, size_t *info_alloc, size_t *info_offset, const char *text)
 {
 	/* 定义日志级别 */
-	const char		*__function_name = "process_proxy_data";
+	if (0 != *info_offset)
+		zbx_chrcpy_alloc(info, info_alloc, info_offset, '\n');
 
 	/* 定义解析后的JSON数据结构 */
-	struct zbx_json_parse	jp_data;
 
 	/* 定义返回值 */
-	int			ret = SUCCEED;
 
 	/* 定义时间戳结构 */
-	zbx_timespec_t		unique_shift = {0, 0};
 
 	/* 定义错误信息指针 */
-	char			*error_step = NULL;
 
 	/* 定义错误信息分配大小 */
-	size_t			error_alloc = 0;
 
 	/* 定义错误信息偏移量 */
-	size_t			error_offset = 0;
 
 	/* 记录日志 */
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
 
 	/* 解析日志时间差 */
-	log_client_timediff(LOG_LEVEL_DEBUG, jp, ts);
 
 	/* 判断是否为主机可用性数据 */
-	if (SUCCEED == zbx_json_brackets_by_name(jp, ZBX_PROTO_TAG_HOST_AVAILABILITY, &jp_data))
-	{
 		/* 处理主机可用性数据 */
-		if (SUCCEED != (ret = process_host_availability_contents(&jp_data, &error_step)))
-			zbx_strcatnl_alloc(error, &error_alloc, &error_offset, error_step);
-	}
 
 	/* 判断是否为历史数据 */
-	if (SUCCEED == zbx_json_brackets_by_name(jp, ZBX_PROTO_TAG_HISTORY_DATA, &jp_data))
-	{
 		/* 解析历史数据 */
-		char			*token = NULL;
-		size_t			token_alloc = 0;
-		zbx_data_session_t	*session = NULL;
 
 		/* 获取会话token */
-		if (SUCCEED == zbx_json_value_by_name_dyn(jp, ZBX_PROTO_TAG_SESSION, &token, &token_alloc, NULL))
-		{
 			/* 检查token长度是否合法 */
-			size_t	token_len;
 
-			if (ZBX_DATA_SESSION_TOKEN_SIZE != (token_len = strlen(token)))
-			{
-				*error = zbx_dsprintf(*error, "invalid session token length %d", (int)token_len);
-				zbx_free(token);
-				ret = FAIL;
-				goto out;
-			}
 
 			/* 创建或获取数据会话 */
-			session = zbx_dc_get_or_create_data_session(proxy->hostid, token);
-			zbx_free(token);
-		}
 
 		/* 处理代理历史数据 */
-		process_proxy_history_data_33(proxy, &jp_data, session, &unique_shift, &error_step);
-	}
 
 	/* 判断是否为发现数据 */
-	if (SUCCEED == zbx_json_brackets_by_name(jp, ZBX_PROTO_TAG_DISCOVERY_DATA, &jp_data))
-	{
 		/* 处理发现数据 */
-		if (SUCCEED != (ret = process_discovery_data_contents(&jp_data, &error_step)))
-			zbx_strcatnl_alloc(error, &error_alloc, &error_offset, error_step);
-	}
 
 	/* 判断是否为自动注册数据 */
-	if (SUCCEED == zbx_json_brackets_by_name(jp, ZBX_PROTO_TAG_AUTO_REGISTRATION, &jp_data))
-	{
 		/* 处理自动注册数据 */
-		if (SUCCEED != (ret = process_auto_registration_contents(&jp_data, proxy->hostid, &error_step)))
-			zbx_strcatnl_alloc(error, &error_alloc, &error_offset, error_step);
-	}
 
 	/* 判断是否为任务数据 */
-	if (SUCCEED == zbx_json_brackets_by_name(jp, ZBX_PROTO_TAG_TASKS, &jp_data))
-		process_tasks_contents(&jp_data);
 
-out:
 	/* 释放错误信息 */
-	zbx_free(error_step);
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
 
-	return ret;
-}
 
 	// 使用zbx_strcpy_alloc函数将text字符串拼接到之前的内容后，并更新info_alloc和info_offset
 	zbx_strcpy_alloc(info, info_alloc, info_offset, text);
@@ -4905,53 +5206,42 @@ static void zbx_db_flush_proxy_lastaccess(void)
  *整个代码块的主要目的是用于更新代理数据。函数zbx_update_proxy_data接收四个参数，分别是代理结构体指针、版本号、最后访问时间和压缩状态。首先，根据传入的代理结构体创建一个diff结构体，用于存储代理数据的差异信息。然后，更新diff结构体的各个字段，并调用zbx_dc_update_proxy函数更新代理数据。接下来，判断diff.flags中是否包含ZBX_FLAGS_PROXY_DIFF_UPDATE_VERSION标志位，以及proxy->version是否不为0，如果是，则记录日志表示代理协议版本已更新。最后，更新proxy结构的version、auto_compress和lastaccess字段，并执行数据库操作，更新hosts表中的auto_compress字段。在整个过程中，还会刷新zbx_db_proxy_lastaccess，以更新代理的最后访问时间。
  ******************************************************************************/
 // 定义一个函数，用于更新代理数据
-void zbx_update_proxy_data(DC_PROXY *proxy, int version, int lastaccess, int compress)
+	if (0 != lastaccess.values_num)
 {
     // 定义一个diff结构体，用于存储代理数据的差异信息
-    zbx_proxy_diff_t	diff;
+        char	*sql;
+        size_t	sql_alloc = 256, sql_offset = 0;
+        int	i;
 
     // 设置diff结构体的hostid
-    diff.hostid = proxy->hostid;
+        sql = (char *)zbx_malloc(NULL, sql_alloc);
     // 设置diff结构体的标志位，表示这是代理数据的差异更新
-    diff.flags = ZBX_FLAGS_PROXY_DIFF_UPDATE;
     // 设置diff结构体的version字段
-    diff.version = version;
     // 设置diff结构体的lastaccess字段
-    diff.lastaccess = lastaccess;
     // 设置diff结构体的compress字段
-    diff.compress = compress;
 
     // 调用zbx_dc_update_proxy函数，更新代理数据
-    zbx_dc_update_proxy(&diff);
+        DBbegin();
+        DBbegin_multiple_update(&sql, &sql_alloc, &sql_offset);
 
     // 判断diff.flags中是否包含ZBX_FLAGS_PROXY_DIFF_UPDATE_VERSION标志位，以及proxy->version是否不为0
-    if (0 != (diff.flags & ZBX_FLAGS_PROXY_DIFF_UPDATE_VERSION) && 0 != proxy->version)
+        for (i = 0; i < lastaccess.values_num; i++)
     {
         // 记录日志，表示代理协议版本已更新
-        zabbix_log(LOG_LEVEL_DEBUG, "proxy \"%s\" protocol version updated from %d.%d to %d.%d", proxy->host,
-                    ZBX_COMPONENT_VERSION_MAJOR(proxy->version),
-                    ZBX_COMPONENT_VERSION_MINOR(proxy->version),
-                    ZBX_COMPONENT_VERSION_MAJOR(diff.version),
-                    ZBX_COMPONENT_VERSION_MINOR(diff.version));
-    }
+            zbx_uint64_pair_t	*pair = &lastaccess.values[i];
 
     // 更新proxy结构的version字段
-    proxy->version = version;
+            zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "update hosts"
+                    " set lastaccess=%d"
+                    " where hostid=" ZBX_FS_UI64 ";\n",
+                    (int)pair->second, pair->first);
     // 更新proxy结构的auto_compress字段
-    proxy->auto_compress = compress;
     // 更新proxy结构的lastaccess字段
-    proxy->lastaccess = lastaccess;
 
     // 判断diff.flags中是否包含ZBX_FLAGS_PROXY_DIFF_UPDATE_COMPRESS标志位
-    if (0 != (diff.flags & ZBX_FLAGS_PROXY_DIFF_UPDATE_COMPRESS))
-    {
         // 执行数据库操作，更新hosts表中的auto_compress字段
-        DBexecute("update hosts set auto_compress=%d where hostid=" ZBX_FS_UI64, diff.compress, diff.hostid);
-    }
 
     // 刷新zbx_db_proxy_lastaccess，更新代理的最后访问时间
-    zbx_db_flush_proxy_lastaccess();
-}
 
             DBexecute_overflowed_sql(&sql, &sql_alloc, &sql_offset);
         }
@@ -4961,9 +5251,7 @@ void zbx_update_proxy_data(DC_PROXY *proxy, int version, int lastaccess, int com
 
         // 如果生成的SQL语句长度大于16，则执行单行更新操作。
         if (16 < sql_offset)
-        {
             DBexecute("%s", sql);
-        }
 
         // 提交数据库事务。
         DBcommit();
@@ -5088,23 +5376,10 @@ int zbx_check_protocol_version(DC_PROXY *proxy)
 		{
 			// 打印警告日志，提示代理服务器版本与服务器版本不一致
 			zabbix_log(LOG_LEVEL_WARNING, "proxy \"%s\" protocol version %d.%d differs from server version"
-					" %d.%d", proxy->host, ZBX_COMPONENT_VERSION_MAJOR(proxy->version),
-					ZBX_COMPONENT_VERSION_MINOR(proxy->version),
-					ZABBIX_VERSION_MAJOR, ZABBIX_VERSION_MINOR);
-		}
 
 		// 如果代理版本大于服务器版本，打印警告日志并返回失败
-		if (proxy->version > server_version)
-		{
-			if (1 == print_log)
-				zabbix_log(LOG_LEVEL_WARNING, "cannot accept proxy data");
-			ret = FAIL;
-		}
-	}
 
 	// 返回处理结果
-	return ret;
-}
 
 					" %d.%d", proxy->host, ZBX_COMPONENT_VERSION_MAJOR(proxy->version),
 					ZBX_COMPONENT_VERSION_MINOR(proxy->version),
@@ -151,42 +151,26 @@ int zbx_history_add_values(const zbx_vector_ptr_t *history)
  *整个代码块的主要目的是实现一个名为`zbx_history_get_values`的函数，该函数用于获取历史数据。函数接收5个参数：`itemid`、`value_type`、`start`、`count`、`end`，以及一个指向历史数据结构的指针`values`。函数首先记录进入日志，然后调用`writer->get_values`获取历史数据，并根据日志级别输出获取到的数据。最后，记录函数执行结束的日志并返回执行结果。
  ******************************************************************************/
 // 定义函数名和日志级别
-const char *__function_name = "zbx_history_get_values";
-int ret, pos;
 
 // 定义历史接口结构体指针
-zbx_history_iface_t *writer = &history_ifaces[value_type];
 
 // 记录日志，表示进入函数，传递参数：itemid、value_type、start、count、end
-zabbix_log(LOG_LEVEL_DEBUG, "In %s() itemid:" ZBX_FS_UI64 " value_type:%d start:%d count:%d end:%d",
-           __function_name, itemid, value_type, start, count, end);
 
 // 记录日志，表示获取历史数据，传递参数：writer、itemid、start、count、end、values
-pos = values->values_num;
-ret = writer->get_values(writer, itemid, start, count, end, values);
 
 // 判断是否成功获取数据，如果成功且日志级别为TRACE，则输出历史数据
-if (SUCCEED == ret && SUCCEED == ZBX_CHECK_LOG_LEVEL(LOG_LEVEL_TRACE))
-{
-    int i;
-    char buffer[MAX_STRING_LEN];
 
     // 遍历获取到的历史数据，输出每个数据的timestamp和值
-    for (i = pos; i < values->values_num; i++)
-    {
-        zbx_history_record_t *h = &values->values[i];
 
-        zbx_history_value2str(buffer, sizeof(buffer), &h->value, value_type);
-        zabbix_log(LOG_LEVEL_TRACE, "  %d.%09d %s", h->timestamp.sec, h->timestamp.ns, buffer);
-    }
 }
 
 // 记录日志，表示函数执行结束，传递参数：__function_name、zbx_result_string(ret)、values->values_num - pos
-zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s values:%d", __function_name, zbx_result_string(ret),
-           values->values_num - pos);
+int	zbx_history_get_values(zbx_uint64_t itemid, int value_type, int start, int count, int end,
+        zbx_vector_history_record_t *values)
+{
+    const char		*__function_name = "zbx_history_get_values";
 
 // 返回函数执行结果
-return ret;
 
 	int			ret, pos;
 	zbx_history_iface_t	*writer = &history_ifaces[value_type];
@@ -217,6 +201,49 @@ return ret;
 	return ret;
 }
 
+/************************************************************************************
+ *                                                                                  *
+ * Function: zbx_history_get_aggregate                                              *
+ *                                                                                  *
+ * Purpose: calculates aggregate of item values in history storage                  *
+ *                                                                                  *
+ * Parameters:  itemid     - [IN] the itemid                                        *
+ *              value_type - [IN] the item value type                               *
+ *              type       - [IN] the aggregate type (ZBX_HISTORY_AGGR_*)           *
+ *              start      - [IN] the period start timestamp                        *
+ *              end        - [IN] the period end timestamp                          *
+ *              value      - [OUT] the aggregated value, not set for count or if    *
+ *                                 there are no values in the period                *
+ *              num        - [OUT] the number of values in the period               *
+ *                                                                                  *
+ * Return value: SUCCEED - the aggregate was calculated by history storage          *
+ *               FAIL    - history storage does not support the aggregate, the      *
+ *                         values must be read with zbx_history_get_values()        *
+ *                                                                                  *
+ * Comments: This function aggregates values from ]<start>,<end>] interval.         *
+ *           The average is returned as floating point value for all value types.   *
+ *                                                                                  *
+ ************************************************************************************/
+int	zbx_history_get_aggregate(zbx_uint64_t itemid, int value_type, int type, int start, int end,
+		history_value_t *value, int *num)
+{
+	const char		*__function_name = "zbx_history_get_aggregate";
+	int			ret;
+	zbx_history_iface_t	*writer = &history_ifaces[value_type];
+
+	if (NULL == writer->get_aggregate)
+		return FAIL;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() itemid:" ZBX_FS_UI64 " value_type:%d type:%d start:%d end:%d",
+			__function_name, itemid, value_type, type, start, end);
+
+	ret = writer->get_aggregate(writer, itemid, type, start, end, value, num);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
+
+	return ret;
+}
+
 /************************************************************************************
  *                                                                                  *
  * Function: zbx_history_requires_trends                                            *
@@ -272,20 +299,10 @@ int zbx_history_requires_trends(int value_type)
  *这块代码的主要目的是销毁一个历史记录向量。首先判断向量不为空，如果为空则不进行任何操作。如果不为空，则调用`zbx_history_record_vector_clean()`函数清理历史记录向量，根据传入的`value_type`参数删除相应的数据。清理完成后，调用`zbx_vector_history_record_destroy()`函数销毁`zbx_vector_history_record`结构体。
  ******************************************************************************/
 // 定义一个函数，用于销毁历史记录向量
-void zbx_history_record_vector_destroy(zbx_vector_history_record_t *vector, int value_type)
-{
     // 判断向量不为空
-    if (NULL != vector->values)
-    {
         // 清理历史记录向量，根据value_type类型清除数据
-        zbx_history_record_vector_clean(vector, value_type);
         // 销毁zbx_vector_history_record结构体
-        zbx_vector_history_record_destroy(vector);
-    }
-}
 
- *这个函数的作用是在程序运行过程中，释放已经不再需要的history_log结构体的内存，以避免内存泄漏。
- ******************************************************************************/
 // 定义一个静态函数，用于释放history_log结构体内存
 static void	history_logfree(zbx_log_value_t *log)
 {
@@ -349,54 +366,24 @@ void zbx_history_record_clear(zbx_history_record_t *value, int value_type)
         case ITEM_VALUE_TYPE_LOG:
             // 释放日志类型数据的内存空间
             history_logfree(value->value.log);
-            break;
         // 其他情况下，不执行任何操作，直接跳出switch语句
-        default:
-            break;
-    }
 /******************************************************************************
  * *
  *这块代码的主要目的是将history_value_t结构体的值转换为字符串，并根据不同的值类型使用不同的格式字符串进行转换。最后将转换后的字符串存储在缓冲区buffer中。
  ******************************************************************************/
 // 定义一个函数，将history_value_t结构体的值转换为字符串，存储在缓冲区buffer中
-void zbx_history_value2str(char *buffer, size_t size, const history_value_t *value, int value_type)
-{
     // 根据value_type的不同，进行分支处理
-    switch (value_type)
-    {
-        case ITEM_VALUE_TYPE_FLOAT: // 如果是浮点类型
-        {
             // 使用zbx_snprintf函数将浮点数值转换为字符串，并存储在buffer中
-            zbx_snprintf(buffer, size, ZBX_FS_DBL, value->dbl);
-            break;
-        }
-        case ITEM_VALUE_TYPE_UINT64: // 如果是无符号64位整数类型
-        {
             // 使用zbx_snprintf函数将无符号64位整数转换为字符串，并存储在buffer中
-            zbx_snprintf(buffer, size, ZBX_FS_UI64, value->ui64);
-            break;
-        }
-        case ITEM_VALUE_TYPE_STR: // 如果是字符串类型
-        case ITEM_VALUE_TYPE_TEXT: // 如果是文本类型
-        {
             // 使用zbx_strlcpy_utf8函数将字符串值转换为UTF-8字符串，并存储在buffer中
-            zbx_strlcpy_utf8(buffer, value->str, size);
-            break;
-        }
-        case ITEM_VALUE_TYPE_LOG: // 如果是日志类型
-        {
             // 使用zbx_strlcpy_utf8函数将日志值转换为UTF-8字符串，并存储在buffer中
-            zbx_strlcpy_utf8(buffer, value->log->value, size);
-            break;
-        }
-        default:
-        {
             // 默认情况下，不进行任何操作
-            break;
-        }
     }
 }
 
+void	zbx_history_value2str(char *buffer, size_t size, const history_value_t *value, int value_type)
+{
+	switch (value_type)
 	{
 		case ITEM_VALUE_TYPE_FLOAT:
 			zbx_snprintf(buffer, size, ZBX_FS_DBL, value->dbl);
@@ -408,6 +395,10 @@ void zbx_history_value2str(char *buffer, size_t size, const history_value_t *val
 		case ITEM_VALUE_TYPE_TEXT:
 			zbx_strlcpy_utf8(buffer, value->str, size);
 			break;
+		case ITEM_VALUE_TYPE_LOG:
+			zbx_strlcpy_utf8(buffer, value->log->value, size);
+	}
+}
 /******************************************************************************
  * *
  *整个代码块的主要目的是清理历史记录向量中的数据。根据输入的值类型，分别释放字符串类型和日志类型的内存，最后调用zbx_vector_history_record_clear函数清理向量。
@@ -419,35 +410,19 @@ void zbx_history_record_vector_clean(zbx_vector_history_record_t *vector, int va
 	int i;
 
 	// 使用switch语句根据值类型进行分支处理
-	switch (value_type)
-	{
 		// 当值类型为ITEM_VALUE_TYPE_STR或ITEM_VALUE_TYPE_TEXT时，执行以下操作
-		case ITEM_VALUE_TYPE_STR:
-		case ITEM_VALUE_TYPE_TEXT:
 			// 遍历向量中的每个元素，使用zbx_free函数释放每个元素的值字符串内存
-			for (i = 0; i < vector->values_num; i++)
-				zbx_free(vector->values[i].value.str);
 
 			// 跳出当前switch语句分支
-			break;
 
 		// 当值类型为ITEM_VALUE_TYPE_LOG时，执行以下操作
-		case ITEM_VALUE_TYPE_LOG:
 			// 遍历向量中的每个元素，使用history_logfree函数释放每个元素的值日志内存
-			for (i = 0; i < vector->values_num; i++)
-				history_logfree(vector->values[i].value.log);
 
 			// 跳出当前switch语句分支
-			break;
 
 		// 默认情况下，不执行任何操作
-		default:
-			break;
-	}
 
 	// 调用zbx_vector_history_record_clear函数，清理向量中的数据
-	zbx_vector_history_record_clear(vector);
-}
 
 	switch (value_type)
 	{
@@ -491,10 +466,8 @@ int zbx_history_record_compare_asc_func(const zbx_history_record_t *d1, const zb
 {
 	// 首先判断两个时间戳的秒数（d1->timestamp.sec和d2->timestamp.sec）是否相等
 	if (d1->timestamp.sec == d2->timestamp.sec)
-	{
 		// 如果相等，则比较纳秒（d1->timestamp.ns和d2->timestamp.ns）的大小，返回较小者的值
 		return d1->timestamp.ns - d2->timestamp.ns;
-	}
 
 	// 如果秒数不相等，则比较两个时间戳的整数部分（d1->timestamp.sec和d2->timestamp.sec）的大小，返回较大者的值
 	return d1->timestamp.sec - d2->timestamp.sec;
@@ -527,10 +500,8 @@ int zbx_history_record_compare_desc_func(const zbx_history_record_t *d1, const z
 {
 	// 首先比较两个记录的时间戳（timestamp）的秒（sec）是否相同
 	if (d1->timestamp.sec == d2->timestamp.sec)
-	{
 		// 如果相同，则比较时间戳的纳秒（ns）值，返回d2的纳秒值减去d1的纳秒值
 		return d2->timestamp.ns - d1->timestamp.ns;
-	}
 
 	// 如果时间戳的秒值不同，则直接返回d2的秒值减去d1的秒值
 	return d2->timestamp.sec - d1->timestamp.sec;
@@ -30,6 +30,8 @@ typedef int (*zbx_history_add_values_func_t)(struct zbx_history_iface *hist, con
 typedef int (*zbx_history_get_values_func_t)(struct zbx_history_iface *hist, zbx_uint64_t itemid, int start,
 		int count, int end, zbx_vector_history_record_t *values);
 typedef int (*zbx_history_flush_func_t)(struct zbx_history_iface *hist);
+typedef int (*zbx_history_get_aggregate_func_t)(struct zbx_history_iface *hist, zbx_uint64_t itemid, int type,
+		int start, int end, history_value_t *value, int *num);
 
 struct zbx_history_iface
 {
@@ -41,6 +43,9 @@ struct zbx_history_iface
 	zbx_history_add_values_func_t	add_values;
 	zbx_history_get_values_func_t	get_values;
 	zbx_history_flush_func_t	flush;
+
+	/* optional, NULL if the history storage cannot aggregate values */
+	zbx_history_get_aggregate_func_t	get_aggregate;
 };
 
 /* SQL hist */
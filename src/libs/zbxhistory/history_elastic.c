@@ -26,6 +26,9 @@
 #include "zbxself.h"
 #include "history.h"
 
+#ifdef HAVE_ZLIB
+#include "zlib.h"
+#endif
 /* curl_multi_wait() is supported starting with version 7.28.0 (0x071c00) */
 #if defined(HAVE_LIBCURL) && LIBCURL_VERSION_NUM >= 0x071c00
 
@@ -34,32 +37,27 @@
 #define		ZBX_IDX_JSON_ALLOCATE		256
 #define		ZBX_JSON_ALLOCATE		2048
 
+#define		ZBX_ELASTIC_BULK_SIZE_MIN	(64 * ZBX_KIBIBYTE)
 
+/* the default maximum number of hits returned by one search request (index.max_result_window) */
+#define		ZBX_ELASTIC_SEARCH_SIZE		10000
 const char	*value_type_str[] = {"dbl", "str", "log", "uint", "text"};
 
 extern char	*CONFIG_HISTORY_STORAGE_URL;
 extern int	CONFIG_HISTORY_STORAGE_PIPELINES;
+extern zbx_uint64_t	CONFIG_HISTORY_STORAGE_BULK_SIZE;
+extern int		CONFIG_HISTORY_STORAGE_BULK_REQUESTS;
+extern int		CONFIG_HISTORY_STORAGE_COMPRESSION;
+extern int		CONFIG_HISTORY_STORAGE_AGGREGATE_PERIOD;
 
 typedef struct
 {
 	char	*base_url;
 	char	*post_url;
-	char	*buf;
 	CURL	*handle;
 }
 zbx_elastic_data_t;
 
-typedef struct
-{
-	unsigned char		initialized;
-	zbx_vector_ptr_t	ifaces;
-
-	CURLM			*handle;
-}
-zbx_elastic_writer_t;
-
-static zbx_elastic_writer_t	writer;
-
 typedef struct
 {
 	char	*data;
@@ -72,12 +70,43 @@ static zbx_httppage_t	page_r;
 
 typedef struct
 {
+	char			*url;
+
+	/* the request body in NDJSON format */
+	char			*buf;
+	size_t			buf_alloc;
+	size_t			buf_offset;
+
+	/* offsets of action and document pairs in the request body */
+	zbx_vector_uint64_t	docs;
+
+	/* the compressed request body */
+	char			*gzbuf;
+	size_t			gzsize;
+
+	CURL			*handle;
 	zbx_httppage_t	page;
 	char		errbuf[CURL_ERROR_SIZE];
 }
-zbx_curlpage_t;
+zbx_elastic_bulk_t;
+
+typedef struct
+{
+	unsigned char		initialized;
+
+	/* bulk requests waiting to be sent */
+	zbx_vector_ptr_t	bulks;
+
+	CURLM			*handle;
+	struct curl_slist	*headers;
+	struct curl_slist	*headers_gzip;
+
+	/* the current maximum size of bulk requests, adapted to the cluster load */
+	zbx_uint64_t		bulk_size;
+}
+zbx_elastic_writer_t;
 
-static zbx_curlpage_t	page_w[ITEM_VALUE_TYPE_MAX];
+static zbx_elastic_writer_t	writer;
 
 /******************************************************************************
  * *
@@ -89,6 +118,16 @@ static zbx_curlpage_t	page_w[ITEM_VALUE_TYPE_MAX];
 // 2. size：写入数据的大小。
 // 3. nmemb：写入数据的成员数量。
 // 4. userdata：用户数据，可以理解为与回调函数关联的数据。
+static size_t	curl_write_cb(void *ptr, size_t size, size_t nmemb, void *userdata)
+{
+	size_t	r_size = size * nmemb;
+
+	zbx_httppage_t	*page = (zbx_httppage_t	*)userdata;
+
+	zbx_strncpy_alloc(&page->data, &page->alloc, &page->offset, ptr, r_size);
+
+	return r_size;
+}
 
 /******************************************************************************
  * *
@@ -121,35 +160,12 @@ static history_value_t	history_str2value(char *str, unsigned char value_type)
 	return value;	// 返回转换后的历史值结构体
 }
 
-
-	switch (value_type)
-	{
-		case ITEM_VALUE_TYPE_LOG:
-			value.log = (zbx_log_value_t *)zbx_malloc(NULL, sizeof(zbx_log_value_t));
-			memset(value.log, 0, sizeof(zbx_log_value_t));
-			value.log->value = zbx_strdup(NULL, str);
-			break;
-		case ITEM_VALUE_TYPE_STR:
-		case ITEM_VALUE_TYPE_TEXT:
-			value.str = zbx_strdup(NULL, str);
-			break;
-		case ITEM_VALUE_TYPE_FLOAT:
-			value.dbl = atof(str);
-			break;
-		case ITEM_VALUE_TYPE_UINT64:
-			ZBX_STR2UINT64(value.ui64, str);
-			break;
-	}
-
-	return value;
-}
-
 /******************************************************************************
  * *
  *整个代码块的主要目的是将 ZBX_DC_HISTORY 结构体中的不同类型值（如字符串、日志、浮点数、无符号整数等）转换为字符串，并将转换后的字符串存储在 static char 类型的数组 buffer 中。根据值类型选择合适的转换方法，最后返回 buffer 数组。
  ******************************************************************************/
 // 定义一个名为 history_value2str 的静态常量指针函数，参数为一个 ZBX_DC_HISTORY 类型的指针 h
-static const char *history_value2str(const ZBX_DC_HISTORY *h)
+static const char	*history_value2str(const ZBX_DC_HISTORY *h)
 {
 	// 定义一个静态的 char 类型数组 buffer，用于存储转换后的字符串，数组大小为 MAX_ID_LEN + 1
 	static char	buffer[MAX_ID_LEN + 1];
@@ -162,10 +178,21 @@ static const char *history_value2str(const ZBX_DC_HISTORY *h)
 		case ITEM_VALUE_TYPE_TEXT:
 			// 直接返回 h->value.str 成员，即原始的字符串值
 			return h->value.str;
-
 		// 如果是 ITEM_VALUE_TYPE_LOG 类型
 		case ITEM_VALUE_TYPE_LOG:
 			// 返回 h->value.log 指向的 ZBX_LOG_ENTRY 结构体的 value 成员，即日志值
+			return h->value.log->value;
+		case ITEM_VALUE_TYPE_FLOAT:
+			zbx_snprintf(buffer, sizeof(buffer), ZBX_FS_DBL, h->value.dbl);
+			break;
+		case ITEM_VALUE_TYPE_UINT64:
+			zbx_snprintf(buffer, sizeof(buffer), ZBX_FS_UI64, h->value.ui64);
+			break;
+	}
+
+	return buffer;
+}
+
 /******************************************************************************
  * *
  *整个代码块的主要目的是解析历史记录（history record）中的数据，并将解析到的数据存储到zbx_history_record_t结构体中。具体来说，这个函数会解析以下内容：
@@ -252,31 +279,6 @@ out:
 	return ret;
 }
 
-
-		if (SUCCEED != zbx_json_value_by_name_dyn(jp, "logeventid", &value, &value_alloc, NULL))
-			goto out;
-
-		hr->value.log->logeventid = atoi(value);
-
-		if (SUCCEED != zbx_json_value_by_name_dyn(jp, "severity", &value, &value_alloc, NULL))
-			goto out;
-
-		hr->value.log->severity = atoi(value);
-
-		if (SUCCEED != zbx_json_value_by_name_dyn(jp, "source", &value, &value_alloc, NULL))
-			goto out;
-
-		hr->value.log->source = zbx_strdup(NULL, value);
-	}
-
-	ret = SUCCEED;
-
-out:
-	zbx_free(value);
-
-	return ret;
-}
-
 /******************************************************************************
  * *
  *整个代码块的主要目的是处理CURL库在执行过程中遇到的错误，并将错误信息记录到日志中。当CURL库遇到HTTP错误时，代码会获取HTTP状态码，并按照一定格式生成一个字符串。如果page_r.offset不为0，表示未能从Elasticsearch获取到数据，此时打印包含HTTP状态码和错误信息的日志。如果错误码不是HTTP错误，则直接打印Elasticsearch错误信息。
@@ -296,15 +298,11 @@ static void elastic_log_error(CURL *handle, CURLcode error, const char *errbuf)
 	{
 		// 调用curl_easy_getinfo函数获取HTTP状态码
 		if (CURLE_OK == (curl_err = curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &http_code)))
-		{
 			// 格式化HTTP状态码字符串
 			zbx_snprintf(http_status, sizeof(http_status), "HTTP status code: %ld", http_code);
-		}
 		else
-		{
 			// 复制一个字符串，表示未知HTTP状态码
 			zbx_strlcpy(http_status, "unknown HTTP status code", sizeof(http_status));
-		}
 
 		// 判断page_r.offset是否不为0，如果不为0，表示未能从Elasticsearch获取到数据
 		if (0 != page_r.offset)
@@ -325,7 +323,6 @@ static void elastic_log_error(CURL *handle, CURLcode error, const char *errbuf)
 	}
 }
 
-
 /************************************************************************************
  *                                                                                  *
  * Function: elastic_close                                                          *
@@ -337,166 +334,22 @@ static void elastic_log_error(CURL *handle, CURLcode error, const char *errbuf)
  ************************************************************************************/
 /******************************************************************************
  * *
- *这块代码的主要目的是关闭 Elasticsearch 连接，并释放相关资源。函数 elastic_close 接收一个 zbx_history_iface_t 类型的指针作为参数，该指针来源于历史接口结构体。在函数内部，首先释放缓冲区和 POST 请求的 URL 内存，然后判断是否存在 CURL 句柄。如果存在，则将其从 writer.handle 中移除，并释放该句柄。最后将句柄设置为 NULL。
+ *这块代码的主要目的是关闭 Elasticsearch 连接，并释放相关资源。函数 elastic_close 接收一个 zbx_history_iface_t 类型的指针作为参数，该指针来源于历史接口结构体。在函数内部，首先释放 POST 请求的 URL 内存，然后判断是否存在 CURL 句柄。如果存在，则释放该句柄，并将句柄设置为 NULL。
  ******************************************************************************/
 // 定义一个名为 elastic_close 的静态函数，参数为一个指向 zbx_history_iface_t 类型的指针
-static void elastic_close(zbx_history_iface_t *hist)
+static void	elastic_close(zbx_history_iface_t *hist)
 {
 	// 定义一个指向 zbx_elastic_data_t 类型的指针，并将历史接口的结构体指针转换为该类型
-	zbx_elastic_data_t *data = (zbx_elastic_data_t *)hist->data;
+	zbx_elastic_data_t	*data = (zbx_elastic_data_t *)hist->data;
 
-	// 释放 data 指向的缓冲区内存
-/******************************************************************************
- * *
- *整个代码块的主要目的是解析Elasticsearch返回的JSON数据，检查其中是否存在错误。如果存在错误，输出错误信息。以下是代码的详细注释：
- *
- *1. 定义一个静态函数`elastic_is_error_present`，接收两个参数：一个`zbx_httppage_t`类型的指针`page`，用于存储Elasticsearch返回的JSON数据；一个`char **`类型的指针`err`，用于存储错误信息。
- *
- *2. 定义一个常量字符串`__function_name`，表示函数名称。
- *
- *3. 定义一个结构体`zbx_json_parse`类型的变量`jp`，用于存储解析JSON数据的状态。
- *
- *4. 定义一个`const char *`类型的变量`errors`，用于存储JSON数据中\"errors\"键的值。
- *
- *5. 定义一个`char *`类型的变量`index`，用于存储索引名称。
- *
- *6. 定义一个`char *`类型的变量`status`，用于存储状态信息。
- *
- *7. 定义一个`char *`类型的变量`type`，用于存储错误类型。
- *
- *8. 定义一个`char *`类型的变量`reason`，用于存储错误原因。
- *
- *9. 定义四个`size_t`类型的变量`index_alloc`、`status_alloc`、`type_alloc`和`reason_alloc`，用于存储字符串的长度。
- *
- *10. 定义一个`int`类型的变量`rc_js`，表示解析JSON数据的返回状态。
- *
- *11. 使用`zabbix_log`函数记录日志，输出原始JSON数据。
- *
- *12. 解析JSON数据，如果解析失败，返回FAIL。
- *
- *13. 检查JSON数据中是否存在\"errors\"键，如果不存在，返回FAIL。
- *
- *14. 解析\"items\"键下的JSON数据。
- *
- *15. 遍历\"items\"键下的所有数据，解析每个数据的\"error\"键。
- *
- *16. 获取错误类型、原因、索引名称和状态信息。
- *
- *17. 输出错误信息。
- *
- *18. 释放分配的内存。
- *
- *19. 返回SUCCEED，表示解析成功。
- ******************************************************************************/
-// 定义一个静态函数，用于检查Elasticsearch返回的JSON数据中是否存在错误
-static int elastic_is_error_present(zbx_httppage_t *page, char **err)
-{
-    // 定义一个常量字符串，表示函数名称
-    const char *__function_name = "elastic_is_error_present";
-
-    // 定义一个结构体，用于解析JSON数据
-    struct zbx_json_parse jp, jp_values, jp_index, jp_error, jp_items, jp_item;
-    const char *errors, *p = NULL;
-    char *index = NULL, *status = NULL, *type = NULL, *reason = NULL;
-    size_t index_alloc = 0, status_alloc = 0, type_alloc = 0, reason_alloc = 0;
-    int rc_js = SUCCEED;
-
-    // 记录日志，输出原始JSON数据
-    zabbix_log(LOG_LEVEL_TRACE, "%s() raw json: %s", __function_name, ZBX_NULL2EMPTY_STR(page->data));
-
-    // 解析JSON数据
-    if (SUCCEED != zbx_json_open(page->data, &jp) || SUCCEED != zbx_json_brackets_open(jp.start, &jp_values))
-        return FAIL;
-
-    // 检查JSON数据中是否存在"errors"键，如果不存在，则返回FAIL
-    if (NULL == (errors = zbx_json_pair_by_name(&jp_values, "errors")) || 0 != strncmp("true", errors, 4))
-        return FAIL;
-
-    // 解析"items"键下的JSON数据
-    if (SUCCEED == zbx_json_brackets_by_name(&jp, "items", &jp_items))
-    {
-        // 遍历"items"键下的所有数据
-        while (NULL != (p = zbx_json_next(&jp_items, p)))
-        {
-            // 解析"item"键下的JSON数据
-            if (SUCCEED == zbx_json_brackets_open(p, &jp_item) &&
-                    SUCCEED == zbx_json_brackets_by_name(&jp_item, "index", &jp_index) &&
-                    SUCCEED == zbx_json_brackets_by_name(&jp_index, "error", &jp_error))
-            {
-                // 获取错误类型和原因
-                if (SUCCEED != zbx_json_value_by_name_dyn(&jp_error, "type", &type, &type_alloc, NULL))
-                    rc_js = FAIL;
-                if (SUCCEED != zbx_json_value_by_name_dyn(&jp_error, "reason", &reason, &reason_alloc, NULL))
-                    rc_js = FAIL;
-            }
-            else
-                continue;
-
-                // 获取索引、状态和索引名称
-                if (SUCCEED != zbx_json_value_by_name_dyn(&jp_index, "status", &status, &status_alloc, NULL))
-                    rc_js = FAIL;
-                if (SUCCEED != zbx_json_value_by_name_dyn(&jp_index, "_index", &index, &index_alloc, NULL))
-                    rc_js = FAIL;
-
-                // 输出错误信息
-                break;
-            }
-        }
-    }
-    else
-        rc_js = FAIL;
-
-    // 输出错误信息
-    *err = zbx_dsprintf(NULL,"index:%s status:%s type:%s reason:%s%s", ZBX_NULL2EMPTY_STR(index),
-                ZBX_NULL2EMPTY_STR(status), ZBX_NULL2EMPTY_STR(type), ZBX_NULL2EMPTY_STR(reason),
-                FAIL == rc_js ? " / elasticsearch version is not fully compatible with zabbix server" : "");
-
-    // 释放分配的内存
-    zbx_free(status);
-    zbx_free(type);
-    zbx_free(reason);
-    zbx_free(index);
-
-    // 返回SUCCEED，表示解析成功
-    return SUCCEED;
-}
+	// 释放 POST 请求的 URL 内存
+	zbx_free(data->post_url);
 
+	if (NULL != data->handle)
 	{
-		while (NULL != (p = zbx_json_next(&jp_items, p)))
-		{
-			if (SUCCEED == zbx_json_brackets_open(p, &jp_item) &&
-					SUCCEED == zbx_json_brackets_by_name(&jp_item, "index", &jp_index) &&
-					SUCCEED == zbx_json_brackets_by_name(&jp_index, "error", &jp_error))
-			{
-				if (SUCCEED != zbx_json_value_by_name_dyn(&jp_error, "type", &type, &type_alloc, NULL))
-					rc_js = FAIL;
-				if (SUCCEED != zbx_json_value_by_name_dyn(&jp_error, "reason", &reason, &reason_alloc, NULL))
-					rc_js = FAIL;
-			}
-			else
-				continue;
-
-			if (SUCCEED != zbx_json_value_by_name_dyn(&jp_index, "status", &status, &status_alloc, NULL))
-				rc_js = FAIL;
-			if (SUCCEED != zbx_json_value_by_name_dyn(&jp_index, "_index", &index, &index_alloc, NULL))
-				rc_js = FAIL;
-
-			break;
-		}
+		curl_easy_cleanup(data->handle);
+		data->handle = NULL;
 	}
-	else
-		rc_js = FAIL;
-
-	*err = zbx_dsprintf(NULL,"index:%s status:%s type:%s reason:%s%s", ZBX_NULL2EMPTY_STR(index),
-			ZBX_NULL2EMPTY_STR(status), ZBX_NULL2EMPTY_STR(type), ZBX_NULL2EMPTY_STR(reason),
-			FAIL == rc_js ? " / elasticsearch version is not fully compatible with zabbix server" : "");
-
-	zbx_free(status);
-	zbx_free(type);
-	zbx_free(reason);
-	zbx_free(index);
-
-	return SUCCEED;
 }
 
 /******************************************************************************************************************
@@ -509,241 +362,580 @@ static int elastic_is_error_present(zbx_httppage_t *page, char **err)
 
 /************************************************************************************
  *                                                                                  *
- * Function: elastic_writer_init                                                    *
+ * Function: elastic_bulk_create                                                    *
  *                                                                                  *
- * Purpose: initializes elastic writer for a new batch of history values            *
+ * Purpose: creates bulk request                                                    *
+ *                                                                                  *
+ * Parameters: url - [IN] the bulk API url                                          *
  *                                                                                  *
  ************************************************************************************/
-/******************************************************************************
- * *
- *整个代码块的主要目的是初始化弹性写入器，主要包括以下几个步骤：
- *
- *1. 判断弹性写入器是否已经初始化，如果已经初始化则直接返回，避免重复初始化。
- *2. 创建一个指向zbx_vector的指针，用于存储弹性写入器的接口。
- *3. 初始化一个cURL多路复用器，用于处理多个并发请求。
- *4. 如果初始化多路复用器失败，打印错误信息并退出程序。
- *5. 标记弹性写入器已经初始化。
- ******************************************************************************/
-// 定义一个静态函数，用于初始化弹性写入器
-static void elastic_writer_init(void)
+static zbx_elastic_bulk_t	*elastic_bulk_create(const char *url)
 {
-	// 判断writer对象是否已经初始化，如果已经初始化则直接返回，避免重复初始化
-	if (0 != writer.initialized)
-		return;
-
-	// 创建一个指向zbx_vector的指针，用于存储弹性写入器的接口
-	zbx_vector_ptr_create(&writer.ifaces);
+	zbx_elastic_bulk_t	*bulk;
 
-	// 初始化一个cURL多路复用器，用于处理多个并发请求
-	if (NULL == (writer.handle = curl_multi_init()))
-	{
-		// 如果初始化多路复用器失败，打印错误信息并退出程序
-		zbx_error("Cannot initialize cURL multi session");
-		exit(EXIT_FAILURE);
-	}
+	bulk = (zbx_elastic_bulk_t *)zbx_malloc(NULL, sizeof(zbx_elastic_bulk_t));
+	memset(bulk, 0, sizeof(zbx_elastic_bulk_t));
+	bulk->url = zbx_strdup(NULL, url);
+	zbx_vector_uint64_create(&bulk->docs);
 
-	// 标记writer对象已经初始化
-	writer.initialized = 1;
+	return bulk;
 }
 
+/************************************************************************************
+ *                                                                                  *
+ * Function: elastic_bulk_free                                                      *
+ *                                                                                  *
+ * Purpose: releases bulk request, the request must not be added to multi handle    *
+ *                                                                                  *
+ ************************************************************************************/
+static void	elastic_bulk_free(zbx_elastic_bulk_t *bulk)
+{
+	if (NULL != bulk->handle)
+		curl_easy_cleanup(bulk->handle);
+
+	zbx_vector_uint64_destroy(&bulk->docs);
+	zbx_free(bulk->page.data);
+	zbx_free(bulk->gzbuf);
+	zbx_free(bulk->buf);
+	zbx_free(bulk->url);
+	zbx_free(bulk);
+}
 
 /************************************************************************************
  *                                                                                  *
- * Function: elastic_writer_release                                                 *
+ * Function: elastic_bulk_add_doc                                                   *
  *                                                                                  *
- * Purpose: releases initialized elastic writer by freeing allocated resources and  *
- *          setting its state to uninitialized.                                     *
+ * Purpose: appends action and document pair to bulk request                        *
  *                                                                                  *
  ************************************************************************************/
-/******************************************************************************
- * *
- *整个代码块的主要目的是：释放弹性写入器（elastic_writer）在运行过程中分配的资源，包括关闭关联的连接、清理多线程对象、销毁关联的向量等。这个过程通过一个循环遍历 writer.ifaces 数组，依次调用 elastic_close 函数关闭每个连接。在释放完所有资源后，将 writer.handle 设置为 NULL，并销毁 writer.ifaces 向量。最后，将 writer.initialized 设置为 0，表示初始化已完成。
- ******************************************************************************/
-// 定义一个静态函数，用于释放弹性写入器的相关资源
-static void elastic_writer_release(void)
+static void	elastic_bulk_add_doc(zbx_elastic_bulk_t *bulk, const char *doc, size_t size)
 {
-/******************************************************************************
- * *
- *整个代码块的主要目的是向弹性输出器添加一个新的接口，并初始化cURL会话。在这个过程中，设置了cURL会话的各种选项，如URL、POST数据、输出回调函数等。最后，将该接口添加到弹性输出器的接口列表中。
- ******************************************************************************/
-// 定义一个静态函数，用于向弹性输出器添加接口
-static void elastic_writer_add_iface(zbx_history_iface_t *hist)
+	zbx_vector_uint64_append(&bulk->docs, bulk->buf_offset);
+	zbx_strncpy_alloc(&bulk->buf, &bulk->buf_alloc, &bulk->buf_offset, doc, size);
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Function: elastic_bulk_copy_doc                                                  *
+ *                                                                                  *
+ * Purpose: copies the specified action and document pair to other bulk request     *
+ *                                                                                  *
+ * Parameters: dst   - [IN/OUT] the target bulk request                             *
+ *             src   - [IN] the source bulk request                                 *
+ *             index - [IN] the document index in source bulk request               *
+ *                                                                                  *
+ ************************************************************************************/
+static void	elastic_bulk_copy_doc(zbx_elastic_bulk_t *dst, const zbx_elastic_bulk_t *src, int index)
 {
-    // 指向历史数据结构的指针
-    zbx_elastic_data_t *data = (zbx_elastic_data_t *)hist->data;
-
-    // 初始化弹性输出器
-    elastic_writer_init();
-
-    // 初始化cURL会话
-    if (NULL == (data->handle = curl_easy_init()))
-    {
-        // 如果无法初始化cURL会话，记录错误日志并返回
-        zabbix_log(LOG_LEVEL_ERR, "cannot initialize cURL session");
-        return;
-    }
-/******************************************************************************
- * 以下是对代码的逐行注释：
- *
- *
- *
- *整个代码的主要目的是实现一个名为`elastic_writer_flush`的函数，该函数用于向Elasticsearch发送数据。发送数据的过程中，如果遇到错误，会根据不同类型的错误进行处理，如HTTP错误、CURL内部错误等。在处理错误后，会将需要重试的处理句柄添加到重试列表中，并在一段时间后继续尝试发送数据。
- ******************************************************************************/
-static int elastic_writer_flush(void)
+	size_t	end;
+
+	end = (index + 1 < src->docs.values_num ? src->docs.values[index + 1] : src->buf_offset);
+	elastic_bulk_add_doc(dst, src->buf + src->docs.values[index], end - src->docs.values[index]);
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Function: elastic_bulk_split                                                     *
+ *                                                                                  *
+ * Purpose: moves the second half of documents to a new bulk request                *
+ *                                                                                  *
+ * Return value: the new bulk request                                               *
+ *                                                                                  *
+ ************************************************************************************/
+static zbx_elastic_bulk_t	*elastic_bulk_split(zbx_elastic_bulk_t *bulk)
 {
-	// 定义一个常量，表示函数名
-	const char *__function_name = "elastic_writer_flush";
+	zbx_elastic_bulk_t	*tail;
+	int			i, half = bulk->docs.values_num / 2;
 
-	// 定义一个结构体指针，用于存储CURL句柄
-	struct curl_slist *curl_headers = NULL;
-	// 定义一个整型变量，用于循环计数
-	int i, running, previous, msgnum;
-	// 定义一个CURLMsg结构体指针，用于存储消息
-	CURLMsg *msg;
-	// 定义一个指向zbx_vector_ptr的指针，用于存储重试次数
-	zbx_vector_ptr_t retries;
+	tail = elastic_bulk_create(bulk->url);
 
-	// 记录日志，表示进入函数
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
+	for (i = half; i < bulk->docs.values_num; i++)
+		elastic_bulk_copy_doc(tail, bulk, i);
 
-	/* 检查writer是否已初始化，如果未初始化，则返回SUCCEED */
-	if (0 == writer.initialized)
-		return SUCCEED;
+	bulk->buf_offset = bulk->docs.values[half];
+	bulk->buf[bulk->buf_offset] = '\0';
+	bulk->docs.values_num = half;
 
-	// 创建一个指向zbx_vector_ptr的指针，用于存储重试次数
-	zbx_vector_ptr_create(&retries);
+	return tail;
+}
 
-	// 添加一个头信息到curl_headers链表
-	curl_headers = curl_slist_append(curl_headers, "Content-Type: application/x-ndjson");
+#ifdef HAVE_ZLIB
+/************************************************************************************
+ *                                                                                  *
+ * Function: elastic_bulk_compress                                                  *
+ *                                                                                  *
+ * Purpose: compresses bulk request body with gzip                                  *
+ *                                                                                  *
+ * Return value: SUCCEED - the body was compressed                                  *
+ *               FAIL    - otherwise                                                *
+ *                                                                                  *
+ ************************************************************************************/
+static int	elastic_bulk_compress(zbx_elastic_bulk_t *bulk)
+{
+	z_stream	zs;
+	uLong		size;
+	int		ret = FAIL;
 
-	// 遍历writer的接口数组
-	for (i = 0; i < writer.ifaces.values_num; i++)
-	{
-		// 获取当前接口的结构体指针
-		zbx_history_iface_t *hist = (zbx_history_iface_t *)writer.ifaces.values[i];
-		// 获取当前接口的数据结构体指针
-		zbx_elastic_data_t *data = (zbx_elastic_data_t *)hist->data;
+	memset(&zs, 0, sizeof(zs));
 
-		// 设置CURL句柄的HTTP头
-		(void)curl_easy_setopt(data->handle, CURLOPT_HTTPHEADER, curl_headers);
+	/* window bits increased by 16 to write gzip header and trailer instead of zlib wrapper */
+	if (Z_OK != deflateInit2(&zs, Z_BEST_SPEED, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY))
+		return FAIL;
 
-		// 记录日志，表示发送数据
-		zabbix_log(LOG_LEVEL_DEBUG, "sending %s", data->buf);
-	}
+	size = deflateBound(&zs, (uLong)bulk->buf_offset);
+	bulk->gzbuf = (char *)zbx_realloc(bulk->gzbuf, size);
 
-try_again:
-	// 初始化previous为0
-	previous = 0;
+	zs.next_in = (Bytef *)bulk->buf;
+	zs.avail_in = (uInt)bulk->buf_offset;
+	zs.next_out = (Bytef *)bulk->gzbuf;
+	zs.avail_out = (uInt)size;
 
-	// 使用do-while循环，直到运行次数为0
-	do
+	if (Z_STREAM_END == deflate(&zs, Z_FINISH))
 	{
-		int fds;
-		CURLMcode code;
-		char *error;
-		zbx_curlpage_t *curl_page;
+		bulk->gzsize = zs.total_out;
+		ret = SUCCEED;
+	}
 
-		// 检查CURL多路复用器是否正常工作，如果不正常，则记录日志并退出循环
-		if (CURLM_OK != (code = curl_multi_perform(writer.handle, &running)))
-		{
-			zabbix_log(LOG_LEVEL_ERR, "cannot perform on curl multi handle: %s", curl_multi_strerror(code));
-			break;
-		}
+	deflateEnd(&zs);
 
-		// 检查CURL多路复用器是否等待正常，如果不正常，则记录日志并退出循环
-		if (CURLM_OK != (code = curl_multi_wait(writer.handle, NULL, 0, ZBX_HISTORY_STORAGE_DOWN, &fds)))
+	return ret;
+}
+#endif
+
+/************************************************************************************
+ *                                                                                  *
+ * Function: elastic_bulk_send                                                      *
+ *                                                                                  *
+ * Purpose: adds bulk request to the writer multi handle                            *
+ *                                                                                  *
+ * Return value: SUCCEED - the request was added                                    *
+ *               FAIL    - cURL session cannot be initialized                       *
+ *                                                                                  *
+ ************************************************************************************/
+static int	elastic_bulk_send(zbx_elastic_bulk_t *bulk)
+{
+	if (NULL == bulk->handle)
+	{
+		if (NULL == (bulk->handle = curl_easy_init()))
 		{
-			zabbix_log(LOG_LEVEL_ERR, "cannot wait on curl multi handle: %s", curl_multi_strerror(code));
-			break;
+			zabbix_log(LOG_LEVEL_ERR, "cannot initialize cURL session");
+			return FAIL;
 		}
 
-		// 如果previous等于running，则继续循环
-		if (previous == running)
-			continue;
+		curl_easy_setopt(bulk->handle, CURLOPT_URL, bulk->url);
+		curl_easy_setopt(bulk->handle, CURLOPT_POST, 1L);
+		curl_easy_setopt(bulk->handle, CURLOPT_WRITEFUNCTION, curl_write_cb);
+		curl_easy_setopt(bulk->handle, CURLOPT_WRITEDATA, &bulk->page);
+		curl_easy_setopt(bulk->handle, CURLOPT_FAILONERROR, 1L);
+		curl_easy_setopt(bulk->handle, CURLOPT_ERRORBUFFER, bulk->errbuf);
+		curl_easy_setopt(bulk->handle, CURLOPT_PRIVATE, bulk);
+	}
 
-		// 遍历CURL多路复用器的消息队列
-		while (NULL != (msg = curl_multi_info_read(writer.handle, &msgnum)))
-		{
-			// 检查消息是否为错误情况，如果是，则根据错误类型采取相应措施
-			if (CURLE_HTTP_RETURNED_ERROR == msg->data.result)
-			{
-				// 检查CURL Easy handle的错误信息，如果有，则记录日志并退出循环
-				if (CURLE_OK == curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char **)&curl_page) && '\0' != *curl_page->errbuf)
-				{
-					zabbix_log(LOG_LEVEL_ERR, "cannot send data to elasticsearch, HTTP error"
-							" message: %s", curl_page->errbuf);
-				}
-				else
-				{
-					char *http_status;
-					long int err;
-					CURLcode curl_err;
-
-					// 获取CURL Easy handle的错误信息，并记录日志
-					if (CURLE_OK == (curl_err = curl_easy_getinfo(msg->easy_handle, CURLINFO_RESPONSE_CODE, &err)))
-					{
-						zbx_snprintf(http_status, sizeof(http_status), "HTTP status code: %ld", err);
-					}
-					else
-					{
-						http_status = "unknown HTTP status code";
-					}
-
-					zabbix_log(LOG_LEVEL_ERR, "cannot send data to elasticsearch, %s", http_status);
-				}
+#ifdef HAVE_ZLIB
+	if (0 != CONFIG_HISTORY_STORAGE_COMPRESSION && SUCCEED == elastic_bulk_compress(bulk))
+	{
+		curl_easy_setopt(bulk->handle, CURLOPT_HTTPHEADER, writer.headers_gzip);
+		curl_easy_setopt(bulk->handle, CURLOPT_POSTFIELDSIZE, (long)bulk->gzsize);
+		curl_easy_setopt(bulk->handle, CURLOPT_POSTFIELDS, bulk->gzbuf);
+	}
+	else
+#endif
+	{
+		curl_easy_setopt(bulk->handle, CURLOPT_HTTPHEADER, writer.headers);
+		curl_easy_setopt(bulk->handle, CURLOPT_POSTFIELDSIZE, (long)bulk->buf_offset);
+		curl_easy_setopt(bulk->handle, CURLOPT_POSTFIELDS, bulk->buf);
+	}
 
-				/* 如果错误是由于curl内部问题或与HTTP无关的问题，将处理句柄放入重试列表并从当前执行循环中移除 */
-				zbx_vector_ptr_append(&retries, msg->easy_handle);
-				curl_multi_remove_handle(writer.handle, msg->easy_handle);
-			}
-			else if (CURLE_OK != msg->data.result)
+	zabbix_log(LOG_LEVEL_DEBUG, "sending %d values, " ZBX_FS_SIZE_T " bytes", bulk->docs.values_num,
+			(zbx_fs_size_t)bulk->buf_offset);
+	zabbix_log(LOG_LEVEL_TRACE, "sending %s", bulk->buf);
+
+	*bulk->errbuf = '\0';
+	bulk->page.offset = 0;
+	if (0 < bulk->page.alloc)
+		*bulk->page.data = '\0';
+
+	curl_multi_add_handle(writer.handle, bulk->handle);
+
+	return SUCCEED;
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Function: elastic_bulk_process_response                                          *
+ *                                                                                  *
+ * Purpose: checks the results of individual documents in bulk response             *
+ *                                                                                  *
+ * Parameters: bulk  - [IN] the sent bulk request with response                     *
+ *             retry - [OUT] the bulk request with documents rejected because of    *
+ *                           temporary errors, NULL if there are no such documents  *
+ *                                                                                  *
+ * Comments: Documents rejected because of overloaded (429) or failing (5xx)        *
+ *           cluster are retried, other rejected documents are dropped as there is  *
+ *           no sense to send malformed data again.                                 *
+ *                                                                                  *
+ ************************************************************************************/
+static void	elastic_bulk_process_response(const zbx_elastic_bulk_t *bulk, zbx_elastic_bulk_t **retry)
+{
+	const char		*__function_name = "elastic_bulk_process_response";
+
+	struct zbx_json_parse	jp, jp_items, jp_item, jp_index, jp_error;
+	const char		*errors, *p = NULL;
+	char			status[MAX_ID_LEN + 1], *index = NULL, *type = NULL, *reason = NULL;
+	size_t			index_alloc = 0, type_alloc = 0, reason_alloc = 0;
+	int			i, code, failed = 0;
+
+	*retry = NULL;
+
+	zabbix_log(LOG_LEVEL_TRACE, "%s() raw json: %s", __function_name, ZBX_NULL2EMPTY_STR(bulk->page.data));
+
+	if (SUCCEED != zbx_json_open(bulk->page.data, &jp))
+		return;
+
+	if (NULL == (errors = zbx_json_pair_by_name(&jp, "errors")) || 0 != strncmp("true", errors, 4))
+		return;
+
+	if (SUCCEED != zbx_json_brackets_by_name(&jp, "items", &jp_items))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot send data to elasticsearch: elasticsearch version is not fully"
+				" compatible with zabbix server");
+		return;
+	}
+
+	/* bulk response items are in the same order as the request actions */
+	for (i = 0; NULL != (p = zbx_json_next(&jp_items, p)) && i < bulk->docs.values_num; i++)
+	{
+		if (SUCCEED != zbx_json_brackets_open(p, &jp_item) ||
+				SUCCEED != zbx_json_brackets_by_name(&jp_item, "index", &jp_index) ||
+				SUCCEED != zbx_json_value_by_name(&jp_index, "status", status, sizeof(status), NULL))
+		{
+			continue;
+		}
+
+		if (300 > (code = atoi(status)))
+			continue;
+
+		if (429 == code || 500 <= code)
+		{
+			if (NULL == *retry)
+				*retry = elastic_bulk_create(bulk->url);
+
+			elastic_bulk_copy_doc(*retry, bulk, i);
+		}
+		else
+			failed++;
+
+		/* log the reason of the first rejected document */
+		if (NULL == index)
+		{
+			zbx_json_value_by_name_dyn(&jp_index, "_index", &index, &index_alloc, NULL);
+
+			if (SUCCEED == zbx_json_brackets_by_name(&jp_index, "error", &jp_error))
+			{
+				zbx_json_value_by_name_dyn(&jp_error, "type", &type, &type_alloc, NULL);
+				zbx_json_value_by_name_dyn(&jp_error, "reason", &reason, &reason_alloc, NULL);
+			}
+
+			zabbix_log(LOG_LEVEL_WARNING, "cannot send data to elasticsearch: index:%s status:%s type:%s"
+					" reason:%s", ZBX_NULL2EMPTY_STR(index), status, ZBX_NULL2EMPTY_STR(type),
+					ZBX_NULL2EMPTY_STR(reason));
+		}
+	}
+
+	if (0 != failed)
+		zabbix_log(LOG_LEVEL_WARNING, "elasticsearch rejected %d values", failed);
+
+	if (NULL != *retry)
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "elasticsearch temporarily rejected %d values, they will be sent again",
+				(*retry)->docs.values_num);
+	}
+
+	zbx_free(reason);
+	zbx_free(type);
+	zbx_free(index);
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Function: elastic_bulk_size_update                                               *
+ *                                                                                  *
+ * Purpose: adapts the maximum size of bulk requests to the cluster load            *
+ *                                                                                  *
+ * Parameters: throttled - [IN] 1 - requests were rejected because of their size or *
+ *                                  overloaded cluster, 0 - all requests succeeded  *
+ *                                                                                  *
+ ************************************************************************************/
+static void	elastic_bulk_size_update(int throttled)
+{
+	if (1 == throttled)
+		writer.bulk_size = MAX(ZBX_ELASTIC_BULK_SIZE_MIN, writer.bulk_size / 2);
+	else
+		writer.bulk_size = MIN(CONFIG_HISTORY_STORAGE_BULK_SIZE, writer.bulk_size * 2);
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Function: elastic_writer_init                                                    *
+ *                                                                                  *
+ * Purpose: initializes elastic writer for a new batch of history values            *
+ *                                                                                  *
+ ************************************************************************************/
+/******************************************************************************
+ * *
+ *整个代码块的主要目的是初始化弹性写入器，主要包括以下几个步骤：
+ *
+ *1. 判断弹性写入器是否已经初始化，如果已经初始化则直接返回，避免重复初始化。
+ *2. 创建一个向量，用于存储待发送的批量请求。
+ *3. 初始化一个cURL多路复用器，用于处理多个并发请求。
+ *4. 如果初始化多路复用器失败，打印错误信息并退出程序。
+ *5. 准备普通和gzip压缩两种请求头，以及批量请求的初始大小上限。
+ *6. 标记弹性写入器已经初始化。
+ ******************************************************************************/
+// 定义一个静态函数，用于初始化弹性写入器
+static void	elastic_writer_init(void)
+{
+	// 判断writer对象是否已经初始化，如果已经初始化则直接返回，避免重复初始化
+	if (0 != writer.initialized)
+		return;
+
+	// 创建一个向量，用于存储待发送的批量请求
+	zbx_vector_ptr_create(&writer.bulks);
+
+	// 初始化一个cURL多路复用器，用于处理多个并发请求
+	if (NULL == (writer.handle = curl_multi_init()))
+	{
+		// 如果初始化多路复用器失败，打印错误信息并退出程序
+		zbx_error("Cannot initialize cURL multi session");
+		exit(EXIT_FAILURE);
+	}
+
+	writer.headers = curl_slist_append(NULL, "Content-Type: application/x-ndjson");
+	writer.headers_gzip = curl_slist_append(NULL, "Content-Type: application/x-ndjson");
+	writer.headers_gzip = curl_slist_append(writer.headers_gzip, "Content-Encoding: gzip");
+
+	if (0 == writer.bulk_size)
+		writer.bulk_size = CONFIG_HISTORY_STORAGE_BULK_SIZE;
+
+	// 标记writer对象已经初始化
+	writer.initialized = 1;
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Function: elastic_writer_release                                                 *
+ *                                                                                  *
+ * Purpose: releases initialized elastic writer by freeing allocated resources and  *
+ *          setting its state to uninitialized.                                     *
+ *                                                                                  *
+ ************************************************************************************/
+/******************************************************************************
+ * *
+ *整个代码块的主要目的是：释放弹性写入器（elastic_writer）在运行过程中分配的资源，包括释放未发送的批量请求、清理cURL多路复用器以及释放请求头。最后，将 writer.initialized 设置为 0，表示写入器回到未初始化状态。
+ ******************************************************************************/
+// 定义一个静态函数，用于释放弹性写入器的相关资源
+static void	elastic_writer_release(void)
+{
+	zbx_vector_ptr_clear_ext(&writer.bulks, (zbx_mem_free_func_t)elastic_bulk_free);
+	zbx_vector_ptr_destroy(&writer.bulks);
+
+	curl_multi_cleanup(writer.handle);
+	writer.handle = NULL;
+
+	curl_slist_free_all(writer.headers);
+	curl_slist_free_all(writer.headers_gzip);
+
+	writer.initialized = 0;
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Function: elastic_writer_add_bulk                                                *
+ *                                                                                  *
+ * Purpose: adds bulk request to be flushed later                                   *
+ *                                                                                  *
+ * Parameters: bulk - [IN] the bulk request                                         *
+ *                                                                                  *
+ ************************************************************************************/
+/******************************************************************************
+ * *
+ *将批量请求加入弹性写入器的发送队列，队列中的请求由elastic_writer_flush()统一发送。
+ ******************************************************************************/
+static void	elastic_writer_add_bulk(zbx_elastic_bulk_t *bulk)
+{
+	// 初始化弹性写入器
+	elastic_writer_init();
+
+	zbx_vector_ptr_append(&writer.bulks, bulk);
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Function: elastic_writer_flush                                                   *
+ *                                                                                  *
+ * Purpose: posts historical data to elastic storage                                *
+ *                                                                                  *
+ ************************************************************************************/
+/******************************************************************************
+ * *
+ *整个代码的主要目的是实现一个名为`elastic_writer_flush`的函数，该函数用于向Elasticsearch发送数据。发送数据的过程中，如果遇到错误，会根据不同类型的错误进行处理，如HTTP错误、CURL内部错误等。在处理错误后，会将需要重试的批量请求添加到重试列表中，并在一段时间后继续尝试发送数据。
+ ******************************************************************************/
+static int	elastic_writer_flush(void)
+{
+	// 定义一个常量，表示函数名
+	const char		*__function_name = "elastic_writer_flush";
+
+	int			running, msgnum, sent, throttled = 0;
+	// 定义一个CURLMsg结构体指针，用于存储消息
+	CURLMsg			*msg;
+	// 定义重试列表，用于存储需要重新发送的批量请求
+	zbx_vector_ptr_t	retries;
+
+	// 记录日志，表示进入函数
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
+
+	/* 检查writer是否已初始化，如果未初始化，则返回SUCCEED */
+	if (0 == writer.initialized)
+		return SUCCEED;
+
+	// 创建重试列表
+	zbx_vector_ptr_create(&retries);
+try_again:
+	sent = 0;
+
+	do
+	{
+		int			fds;
+		CURLMcode		code;
+		zbx_elastic_bulk_t	*bulk, *retry;
+		long int		http_code;
+
+		/* keep the configured number of bulk requests in flight */
+		while (sent < CONFIG_HISTORY_STORAGE_BULK_REQUESTS && 0 < writer.bulks.values_num)
+		{
+			bulk = (zbx_elastic_bulk_t *)writer.bulks.values[0];
+			zbx_vector_ptr_remove(&writer.bulks, 0);
+
+			if (SUCCEED != elastic_bulk_send(bulk))
+			{
+				zbx_vector_ptr_append(&retries, bulk);
+				continue;
+			}
+
+			sent++;
+		}
+
+		if (0 == sent)
+			break;
+
+		// 检查CURL多路复用器是否正常工作，如果不正常，则记录日志并退出循环
+		if (CURLM_OK != (code = curl_multi_perform(writer.handle, &running)))
+		{
+			zabbix_log(LOG_LEVEL_ERR, "cannot perform on curl multi handle: %s", curl_multi_strerror(code));
+			break;
+		}
+
+		// 检查CURL多路复用器是否等待正常，如果不正常，则记录日志并退出循环
+		if (CURLM_OK != (code = curl_multi_wait(writer.handle, NULL, 0, ZBX_HISTORY_STORAGE_DOWN, &fds)))
+		{
+			zabbix_log(LOG_LEVEL_ERR, "cannot wait on curl multi handle: %s", curl_multi_strerror(code));
+			break;
+		}
+
+		// 遍历CURL多路复用器的消息队列
+		while (NULL != (msg = curl_multi_info_read(writer.handle, &msgnum)))
+		{
+			if (CURLMSG_DONE != msg->msg)
+				continue;
+
+			if (CURLE_OK != curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char **)&bulk))
+				continue;
+
+			curl_multi_remove_handle(writer.handle, msg->easy_handle);
+			sent--;
+
+			// 检查消息是否为错误情况，如果是，则根据错误类型采取相应措施
+			if (CURLE_HTTP_RETURNED_ERROR == msg->data.result)
 			{
-				// 检查CURL Easy handle的错误信息，如果有，则记录日志并退出循环
-				if (CURLE_OK == curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char **)&curl_page) && '\0' != *curl_page->errbuf)
+				if (CURLE_OK != curl_easy_getinfo(msg->easy_handle, CURLINFO_RESPONSE_CODE, &http_code))
+					http_code = 0;
+
+				if (413 == http_code && 1 < bulk->docs.values_num)
 				{
-					zabbix_log(LOG_LEVEL_WARNING, "cannot send data to elasticsearch: %s", curl_page->errbuf);
+					/* request is too large, send it in smaller parts */
+					zbx_vector_ptr_append(&writer.bulks, elastic_bulk_split(bulk));
+					zbx_vector_ptr_append(&writer.bulks, bulk);
+					throttled = 1;
+					continue;
 				}
-				else
+
+				/* 如果错误是由于elastic内部问题（例如集群过载）引起的，将批量请求放入重试列表 */
+				if (429 == http_code || 503 == http_code)
 				{
-					zabbix_log(LOG_LEVEL_WARNING, "cannot send data to elasticsearch: %s", curl_easy_strerror(msg->data.result));
+					zabbix_log(LOG_LEVEL_WARNING, "cannot send data to elasticsearch, HTTP status"
+							" code: %ld", http_code);
+					zbx_vector_ptr_append(&retries, bulk);
+					throttled = 1;
+					continue;
 				}
 
-				/* 如果错误是由于elastic内部问题（例如索引变为只读）引起的，将处理句柄放入重试列表并从当前执行循环中移除 */
-				if (CURLM_OK == curl_easy_getinfo(msg->easy_handle, CURLINFO_RETRIABLE_40X, &err) && 0 != err)
+				// 获取CURL Easy handle的错误信息，并记录日志
+				if ('\0' != *bulk->errbuf)
 				{
-					char *error;
-
-					if (SUCCEED == elastic_is_error_present(&curl_page->page, &error))
-					{
-						zabbix_log(LOG_LEVEL_WARNING, "%s() cannot send data to elasticsearch: %s", __function_name, error);
-						zbx_free(error);
-					}
+					zabbix_log(LOG_LEVEL_ERR, "cannot send data to elasticsearch, HTTP error"
+							" message: %s", bulk->errbuf);
+				}
+				else
+				{
+					zabbix_log(LOG_LEVEL_ERR, "cannot send data to elasticsearch, HTTP status code:"
+							" %ld", http_code);
 				}
+			}
+			else if (CURLE_OK != msg->data.result)
+			{
+				zabbix_log(LOG_LEVEL_WARNING, "cannot send data to elasticsearch: %s",
+						'\0' != *bulk->errbuf ? bulk->errbuf :
+						curl_easy_strerror(msg->data.result));
 
-				/* 将处理句柄放入重试列表并从当前执行循环中移除 */
-				zbx_vector_ptr_append(&retries, msg->easy_handle);
-				curl_multi_remove_handle(writer.handle, msg->easy_handle);
+				/* If the error is due to curl internal problems or unrelated */
+				/* problems with HTTP, we put the request in a retry list */
+				zbx_vector_ptr_append(&retries, bulk);
+				continue;
 			}
-		}
+			else
+			{
+				/* only the documents rejected because of elastic internal problems */
+				/* (for example an overloaded node) are put in a retry list          */
+				elastic_bulk_process_response(bulk, &retry);
 
-		previous = running;
+				if (NULL != retry)
+				{
+					zbx_vector_ptr_append(&retries, retry);
+					throttled = 1;
+				}
+			}
+
+			elastic_bulk_free(bulk);
+		}
 	}
-	while (running);
+	while (0 < sent || 0 < writer.bulks.values_num);
 
-	/* 检查是否有需要重试的处理句柄。如果有，则将它们重新添加到多路复用器中，然后睡眠一段时间后继续尝试发送数据 */
+	/* We check if we have handles to retry. If yes, we put them back in the multi */
+	/* handle and go to the beginning of the do while() for try sending the data again */
+	/* after sleeping for ZBX_HISTORY_STORAGE_DOWN / 1000 (seconds) */
 	if (0 < retries.values_num)
 	{
-		for (i = 0; i < retries.values_num; i++)
-			curl_multi_add_handle(writer.handle, retries.values[i]);
-
+		zbx_vector_ptr_append_array(&writer.bulks, retries.values, retries.values_num);
 		zbx_vector_ptr_clear(&retries);
 
+		elastic_bulk_size_update(1);
+		throttled = 0;
+
 		sleep(ZBX_HISTORY_STORAGE_DOWN / 1000);
 		goto try_again;
 	}
 
-	// 释放CURL多路复用器的相关资源
-	curl_slist_free_all(curl_headers);
+	elastic_bulk_size_update(throttled);
 
 	// 销毁重试列表
 	zbx_vector_ptr_destroy(&retries);
@@ -758,95 +950,47 @@ try_again:
 	return SUCCEED;
 }
 
-					long int	err;
-					CURLcode	curl_err;
-
-					if (CURLE_OK == (curl_err = curl_easy_getinfo(msg->easy_handle,
-							CURLINFO_RESPONSE_CODE, &err)))
-					{
-						zbx_snprintf(http_status, sizeof(http_status), "HTTP status code: %ld",
-								err);
-					}
-					else
-					{
-						zbx_strlcpy(http_status, "unknown HTTP status code",
-								sizeof(http_status));
-					}
-
-					zabbix_log(LOG_LEVEL_ERR, "cannot send data to elasticsearch, %s", http_status);
-				}
-			}
-			else if (CURLE_OK != msg->data.result)
-			{
-				if (CURLE_OK == curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE,
-						(char **)&curl_page) && '\0' != *curl_page->errbuf)
-				{
-					zabbix_log(LOG_LEVEL_WARNING, "cannot send data to elasticsearch: %s",
-							curl_page->errbuf);
-				}
-				else
-				{
-					zabbix_log(LOG_LEVEL_WARNING, "cannot send data to elasticsearch: %s",
-							curl_easy_strerror(msg->data.result));
-				}
-
-				/* If the error is due to curl internal problems or unrelated */
-				/* problems with HTTP, we put the handle in a retry list and */
-				/* remove it from the current execution loop */
-				zbx_vector_ptr_append(&retries, msg->easy_handle);
-				curl_multi_remove_handle(writer.handle, msg->easy_handle);
-			}
-			else if (CURLE_OK == curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char **)&curl_page)
-					&& SUCCEED == elastic_is_error_present(&curl_page->page, &error))
-			{
-				zabbix_log(LOG_LEVEL_WARNING, "%s() cannot send data to elasticsearch: %s",
-						__function_name, error);
-				zbx_free(error);
+/******************************************************************************************************************
+ *                                                                                                                *
+ * history interface support                                                                                      *
+ *                                                                                                                *
+ ******************************************************************************************************************/
 
-				/* If the error is due to elastic internal problems (for example an index */
-/******************************************************************************
- * 以下是对代码块的逐行中文注释，详细解释了代码的功能和目的：
- *
- *
- *
- *这个函数的主要目的是从Elasticsearch中获取历史数据，并根据给定的条件进行筛选和排序。以下是代码的主要步骤：
- *
- *1. 初始化变量和数据结构。
- *2. 准备发送到Elasticsearch的JSON查询，应用范围限制。
- *3. 设置cURL会话的相关选项，包括URL、POST数据、写入回调、错误处理等。
- *4. 发送查询请求，并在收到响应后解析返回的数据。
- *5. 处理解析后的数据，将其添加到历史记录数组中。
- *6. 滚动到下一页，并发送新的查询请求。
- *7. 重复步骤4-6，直到返回的数据为空或者历史记录总数为0。
- *8. 关闭滚动查询。
- *9. 关闭Elasticsearch连接。
- *10. 释放资源。
- *11. 对历史记录数组进行排序。
- *12. 返回处理后的历史记录数组。
- *
- *整个代码块的主要目的是从Elasticsearch中获取并处理历史数据，以便后续的使用。
- ******************************************************************************/
-static int elastic_get_values(zbx_history_iface_t *hist, zbx_uint64_t itemid, int start, int count, int end,
-                             zbx_vector_history_record_t *values)
+/************************************************************************************
+ *                                                                                  *
+ * Function: elastic_destroy                                                        *
+ *                                                                                  *
+ * Purpose: destroys history storage interface                                      *
+ *                                                                                  *
+ * Parameters:  hist - [IN] the history storage interface                           *
+ *                                                                                  *
+ ************************************************************************************/
+static void	elastic_destroy(zbx_history_iface_t *hist)
 {
-	const char *__function_name = "elastic_get_values";
-
-	// 定义一个指向历史数据接口的结构体的指针
-	zbx_elastic_data_t *data = (zbx_elastic_data_t *)hist->data;
-	// 初始化一些变量
-	size_t			url_alloc = 0, url_offset = 0, id_alloc = 0, scroll_alloc = 0, scroll_offset = 0;
-	int			total, empty, ret;
-	CURLcode		err;
-	struct zbx_json		query;
-	struct curl_slist	*curl_headers = NULL;
-	char			*scroll_id = NULL, *scroll_query = NULL, errbuf[CURL_ERROR_SIZE];
+	zbx_elastic_data_t	*data = (zbx_elastic_data_t *)hist->data;
 
-	// 打印调试信息
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
+	elastic_close(hist);
 
-	// 初始化返回值
-	ret = FAIL;
+	zbx_free(data->base_url);
+	zbx_free(data);
+}
 
+/************************************************************************************
+ *                                                                                  *
+ * Function: elastic_open                                                           *
+ *                                                                                  *
+ * Purpose: opens connection for reading history data                               *
+ *                                                                                  *
+ * Parameters:  data    - [IN] the elastic history storage data                     *
+ *              headers - [IN] the request headers                                  *
+ *              errbuf  - [IN] the buffer for cURL error messages                   *
+ *                                                                                  *
+ * Return value: SUCCEED - the connection was opened                                *
+ *               FAIL    - cURL session cannot be initialized                       *
+ *                                                                                  *
+ ************************************************************************************/
+static int	elastic_open(zbx_elastic_data_t *data, struct curl_slist *headers, char *errbuf)
+{
 	// 检查cURL会话是否初始化成功
 	if (NULL == (data->handle = curl_easy_init()))
 	{
@@ -856,143 +1000,232 @@ static int elastic_get_values(zbx_history_iface_t *hist, zbx_uint64_t itemid, in
 		return FAIL;
 	}
 
-	// 设置cURL会话的相关选项
-	zbx_snprintf_alloc(&data->post_url, &url_alloc, &url_offset, "%s/%s*/values/_search?scroll=10s", data->base_url,
-	                  value_type_str[hist->value_type]);
+	// 设置cURL会话的写入回调、请求头、错误处理等选项
+	curl_easy_setopt(data->handle, CURLOPT_WRITEFUNCTION, curl_write_cb);
+	curl_easy_setopt(data->handle, CURLOPT_WRITEDATA, &page_r);
+	curl_easy_setopt(data->handle, CURLOPT_HTTPHEADER, headers);
+	curl_easy_setopt(data->handle, CURLOPT_FAILONERROR, 1L);
+	curl_easy_setopt(data->handle, CURLOPT_ERRORBUFFER, errbuf);
 
-	/* 准备发送到Elasticsearch的JSON查询，应用范围限制 */
-	zbx_json_init(&query, ZBX_JSON_ALLOCATE);
+	return SUCCEED;
+}
 
-	if (0 < count)
-	{
-		// 设置查询结果的大小
-		zbx_json_adduint64(&query, "size", count);
-		// 添加排序字段
-		zbx_json_addarray(&query, "sort");
-		// 添加时间戳字段
-		zbx_json_addobject(&query, NULL);
-		zbx_json_addstring(&query, "order", "desc", ZBX_JSON_TYPE_STRING);
-		// 添加查询条件
-		zbx_json_close(&query);
+/************************************************************************************
+ *                                                                                  *
+ * Function: elastic_search                                                         *
+ *                                                                                  *
+ * Purpose: sends search request and reads the response into page_r                 *
+ *                                                                                  *
+ * Parameters:  data   - [IN] the elastic history storage data with opened          *
+ *                            connection and request url                            *
+ *              query  - [IN] the search request body                               *
+ *              errbuf - [IN] the buffer for cURL error messages                    *
+ *                                                                                  *
+ * Return value: SUCCEED - the response was received                                *
+ *               FAIL    - otherwise                                                *
+ *                                                                                  *
+ ************************************************************************************/
+static int	elastic_search(zbx_elastic_data_t *data, const char *query, char *errbuf)
+{
+	CURLcode	err;
 
-		// 添加查询范围条件
-		if (0 < start)
-			zbx_json_adduint64(&query, "gt", start);
+	curl_easy_setopt(data->handle, CURLOPT_URL, data->post_url);
+	curl_easy_setopt(data->handle, CURLOPT_POSTFIELDS, query);
 
-		if (0 < end)
-			zbx_json_adduint64(&query, "lte", end);
+	zabbix_log(LOG_LEVEL_DEBUG, "sending query to %s; post data: %s", data->post_url, query);
 
-		zbx_json_close(&query);
-		zbx_json_close(&query);
-		zbx_json_close(&query);
-		zbx_json_close(&query);
-		zbx_json_close(&query);
-		zbx_json_close(&query);
+	page_r.offset = 0;
+	*errbuf = '\0';
+
+	// 发送查询请求
+	if (CURLE_OK != (err = curl_easy_perform(data->handle)))
+	{
+		elastic_log_error(data->handle, err, errbuf);
+		return FAIL;
 	}
 
-	// 设置发送请求的类型为POST
-	curl_easy_setopt(data->handle, CURLOPT_POST, 1);
-	// 设置请求头
+	zabbix_log(LOG_LEVEL_DEBUG, "received from elasticsearch: %s", ZBX_NULL2EMPTY_STR(page_r.data));
+
+	return SUCCEED;
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Function: elastic_add_query                                                      *
+ *                                                                                  *
+ * Purpose: adds query selecting item values from ]<start>,<end>] interval to       *
+ *          search request                                                          *
+ *                                                                                  *
+ ************************************************************************************/
+static void	elastic_add_query(struct zbx_json *json, zbx_uint64_t itemid, int start, int end)
+{
+	zbx_json_addobject(json, "query");
+	zbx_json_addobject(json, "bool");
+	zbx_json_addarray(json, "must");
+	zbx_json_addobject(json, NULL);
+	zbx_json_addobject(json, "match");
+	zbx_json_adduint64(json, "itemid", itemid);
+	zbx_json_close(json);
+	zbx_json_close(json);
+	zbx_json_close(json);
+	zbx_json_addarray(json, "filter");
+	zbx_json_addobject(json, NULL);
+	zbx_json_addobject(json, "range");
+	zbx_json_addobject(json, "clock");
+
+	if (0 < start)
+		zbx_json_adduint64(json, "gt", start);
+
+	if (0 < end)
+		zbx_json_adduint64(json, "lte", end);
+
+	zbx_json_close(json);
+	zbx_json_close(json);
+	zbx_json_close(json);
+	zbx_json_close(json);
+	zbx_json_close(json);
+	zbx_json_close(json);
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Function: elastic_get_values                                                     *
+ *                                                                                  *
+ * Purpose: gets item history data from history storage                             *
+ *                                                                                  *
+ * Parameters:  hist    - [IN] the history storage interface                        *
+ *              itemid  - [IN] the itemid                                           *
+ *              start   - [IN] the period start timestamp                           *
+ *              count   - [IN] the number of values to read                         *
+ *              end     - [IN] the period end timestamp                             *
+ *              values  - [OUT] the item history data values                        *
+ *                                                                                  *
+ * Return value: SUCCEED - the history data were read successfully                  *
+ *               FAIL - otherwise                                                   *
+ *                                                                                  *
+ * Comments: This function reads <count> values from ]<start>,<end>] interval or    *
+ *           all values from the specified interval if count is zero.               *
+ *           The values are read in pages sorted by timestamp and document id,      *
+ *           every next page continues after the sort values of the last hit        *
+ *           (search_after), so no search context is kept in elasticsearch between  *
+ *           requests.                                                              *
+ *                                                                                  *
+ ************************************************************************************/
+/******************************************************************************
+ * *
+ *这个函数的主要目的是从Elasticsearch中获取历史数据，并根据给定的条件进行筛选和排序。以下是代码的主要步骤：
+ *
+ *1. 初始化变量和数据结构，打开Elasticsearch连接。
+ *2. 准备发送到Elasticsearch的JSON查询，应用范围限制和排序。
+ *3. 发送查询请求，并在收到响应后解析返回的数据。
+ *4. 将解析后的数据添加到历史记录数组中，并记录最后一条数据的排序值。
+ *5. 从最后一条数据的排序值之后（search_after）请求下一页。
+ *6. 重复步骤3-5，直到返回的数据不足一页或者已获取所需数量的历史记录。
+ *7. 关闭Elasticsearch连接，释放资源。
+ *8. 对历史记录数组进行排序。
+ ******************************************************************************/
+static int	elastic_get_values(zbx_history_iface_t *hist, zbx_uint64_t itemid, int start, int count, int end,
+		zbx_vector_history_record_t *values)
+{
+	const char		*__function_name = "elastic_get_values";
+
+	zbx_elastic_data_t	*data = (zbx_elastic_data_t *)hist->data;
+	size_t			url_alloc = 0, url_offset = 0, after_alloc = 0, after_offset;
+	int			total, size, hits, ret = FAIL;
+	struct zbx_json		query;
+	struct curl_slist	*curl_headers = NULL;
+	char			*search_after = NULL, errbuf[CURL_ERROR_SIZE];
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
+
+	zbx_json_init(&query, ZBX_JSON_ALLOCATE);
+
 	curl_headers = curl_slist_append(curl_headers, "Content-Type: application/json");
 
-	// 设置cURL会话的URL、POST数据、写入回调、错误处理等选项
-	curl_easy_setopt(data->handle, CURLOPT_URL, data->post_url);
-	curl_easy_setopt(data->handle, CURLOPT_POSTFIELDS, query.buffer);
-	curl_easy_setopt(data->handle, CURLOPT_WRITEFUNCTION, curl_write_cb);
-	curl_easy_setopt(data->handle, CURLOPT_WRITEDATA, &page_r);
-	curl_easy_setopt(data->handle, CURLOPT_HTTPHEADER, curl_headers);
-	curl_easy_setopt(data->handle, CURLOPT_FAILONERROR, 1L);
-	curl_easy_setopt(data->handle, CURLOPT_ERRORBUFFER, errbuf);
+	if (SUCCEED != elastic_open(data, curl_headers, errbuf))
+		goto out;
 
-	// 发送查询请求
-	zabbix_log(LOG_LEVEL_DEBUG, "sending query to %s; post data: %s", data->post_url, query.buffer);
+	/* only the documents and their sort values are returned */
+	zbx_snprintf_alloc(&data->post_url, &url_alloc, &url_offset,
+			"%s/%s*/values/_search?filter_path=hits.hits._source,hits.hits.sort", data->base_url,
+			value_type_str[hist->value_type]);
 
-	page_r.offset = 0;
 	total = (0 == count ? -1 : count);
 
-	/* 处理记录，应用范围限制 */
 	do
 	{
-		struct zbx_json_parse	jp, jp_values, jp_item, jp_sub, jp_hits, jp_source;
+		struct zbx_json_parse	jp, jp_sub, jp_hits, jp_item, jp_source, jp_sort;
 		zbx_history_record_t	hr;
+		const char		*p = NULL;
 
-		// 解析返回的数据
-		zbx_json_open(page_r.data, &jp);
-		// 解析返回的数据中的值
-		zbx_json_brackets_open(jp.start, &jp_values);
-
-		/* 获取返回的数据中的值 */
-		while (NULL != (p = zbx_json_next(&jp_values, p)))
-		{
-			empty = 0;
+		size = (-1 == total ? ZBX_ELASTIC_SEARCH_SIZE : MIN(total, ZBX_ELASTIC_SEARCH_SIZE));
 
-			// 解析返回的值，并将其添加到历史记录数组中
-			if (SUCCEED != zbx_json_brackets_open(p, &jp_item))
-				continue;
+		// 设置查询结果的大小
+		zbx_json_clean(&query);
+		zbx_json_adduint64(&query, "size", size);
 
-			if (SUCCEED != zbx_json_brackets_by_name(&jp_item, "_source", &jp_source))
-				continue;
+		/* the nanoseconds break ties of values with the same clock and the unique document */
+		/* id breaks ties of values with the same timestamp, so search_after skips no value */
+		zbx_json_addarray(&query, "sort");
+		zbx_json_addobject(&query, NULL);
+		zbx_json_addstring(&query, "clock", "desc", ZBX_JSON_TYPE_STRING);
+		zbx_json_close(&query);
+		zbx_json_addobject(&query, NULL);
+		zbx_json_addstring(&query, "ns", "desc", ZBX_JSON_TYPE_STRING);
+		zbx_json_close(&query);
+		zbx_json_addobject(&query, NULL);
+		zbx_json_addstring(&query, "_id", "desc", ZBX_JSON_TYPE_STRING);
+		zbx_json_close(&query);
+		zbx_json_close(&query);
 
-			if (SUCCEED != history_parse_value(&jp_source, hist->value_type, &hr))
-				continue;
+		// 添加查询条件和查询范围条件
+		elastic_add_query(&query, itemid, start, end);
 
-			// 将解析后的历史记录添加到数组中
-			zbx_vector_history_record_append_ptr(values, &hr);
+		if (NULL != search_after)
+			zbx_json_addraw(&query, "search_after", search_after);
 
-			if (-1 != total)
-				--total;
+		zbx_json_close(&query);
 
-			if (0 == total)
-			{
-				empty = 1;
-				break;
-			}
-		}
+		if (SUCCEED != elastic_search(data, query.buffer, errbuf))
+			goto out;
 
-		// 如果返回的数据为空或者历史记录总数为0，则结束循环
-		if (1 == empty)
+		/* the filtered response of a search without hits is an empty object */
+		if (SUCCEED != zbx_json_open(page_r.data, &jp) ||
+				SUCCEED != zbx_json_brackets_by_name(&jp, "hits", &jp_sub) ||
+				SUCCEED != zbx_json_brackets_by_name(&jp_sub, "hits", &jp_hits))
 		{
-			ret = SUCCEED;
 			break;
 		}
 
-		/* 滚动到下一页 */
-		scroll_offset = 0;
-		zbx_snprintf_alloc(&scroll_query, &scroll_alloc, &scroll_offset,
-		                  "{\"scroll\":\"10s\",\"scroll_id\":\"%s\"}\
-", ZBX_NULL2EMPTY_STR(scroll_id));
-
-		curl_easy_setopt(data->handle, CURLOPT_POSTFIELDS, scroll_query);
-
-		page_r.offset = 0;
-		*errbuf = '\0';
-		if (CURLE_OK != (err = curl_easy_perform(data->handle)))
+		// 解析返回的数据，并将其添加到历史记录数组中
+		for (hits = 0; NULL != (p = zbx_json_next(&jp_hits, p)); hits++)
 		{
-			elastic_log_error(data->handle, err, errbuf);
-			break;
-		}
-	}
-	while (0 == empty);
+			if (SUCCEED != zbx_json_brackets_open(p, &jp_item))
+				continue;
 
-	/* 关闭滚动查询 */
-	if (NULL != scroll_id)
-	{
-		url_offset = 0;
-		zbx_snprintf_alloc(&data->post_url, &url_alloc, &url_offset, "%s/_search/scroll/%s", data->base_url,
-		                  scroll_id);
+			// 记录最后一条数据的排序值，下一页从该位置之后开始
+			if (SUCCEED == zbx_json_brackets_by_name(&jp_item, "sort", &jp_sort))
+			{
+				after_offset = 0;
+				zbx_strncpy_alloc(&search_after, &after_alloc, &after_offset, jp_sort.start,
+						jp_sort.end - jp_sort.start + 1);
+			}
 
-		curl_easy_setopt(data->handle, CURLOPT_URL, data->post_url);
-		curl_easy_setopt(data->handle, CURLOPT_POSTFIELDS, NULL);
-		curl_easy_setopt(data->handle, CURLOPT_CUSTOMREQUEST, "DELETE");
+			if (SUCCEED != zbx_json_brackets_by_name(&jp_item, "_source", &jp_source))
+				continue;
 
-		zabbix_log(LOG_LEVEL_DEBUG, "elasticsearch closing scroll %s", data->post_url);
+			if (SUCCEED != history_parse_value(&jp_source, hist->value_type, &hr))
+				continue;
+
+			zbx_vector_history_record_append_ptr(values, &hr);
+		}
 
-		page_r.offset = 0;
-		*errbuf = '\0';
-		if (CURLE_OK != (err = curl_easy_perform(data->handle)))
-			elastic_log_error(data->handle, err, errbuf);
+		if (-1 != total)
+			total -= hits;
 	}
+	while (hits == size && 0 != total && NULL != search_after);
 
+	ret = SUCCEED;
 out:
 	// 关闭Elasticsearch连接
 	elastic_close(hist);
@@ -1000,135 +1233,180 @@ out:
 	// 释放资源
 	curl_slist_free_all(curl_headers);
 
-	// 释放内存
 	zbx_json_free(&query);
 
-	// 释放滚动ID和滚动查询字符串
-	zbx_free(scroll_id);
-	zbx_free(scroll_query);
+	zbx_free(search_after);
 
 	// 排序历史记录
 	zbx_vector_history_record_sort(values, (zbx_compare_func_t)zbx_history_record_compare_desc_func);
 
-	// 打印调试信息
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __function_name);
 
-	// 返回结果
 	return ret;
 }
 
-		if (SUCCEED != zbx_json_value_by_name_dyn(&jp_values, "_scroll_id", &scroll_id, &id_alloc, NULL))
-		{
-			zabbix_log(LOG_LEVEL_WARNING, "elasticsearch version is not compatible with zabbix server. "
-					"_scroll_id tag is absent");
-		}
-
-		zbx_json_brackets_by_name(&jp_values, "hits", &jp_sub);
-		zbx_json_brackets_by_name(&jp_sub, "hits", &jp_hits);
+/************************************************************************************
+ *                                                                                  *
+ * Function: elastic_get_aggregate                                                  *
+ *                                                                                  *
+ * Purpose: calculates aggregate of item values in history storage                  *
+ *                                                                                  *
+ * Parameters:  hist   - [IN] the history storage interface                         *
+ *              itemid - [IN] the itemid                                            *
+ *              type   - [IN] the aggregate type (ZBX_HISTORY_AGGR_*)               *
+ *              start  - [IN] the period start timestamp                            *
+ *              end    - [IN] the period end timestamp                              *
+ *              value  - [OUT] the aggregated value                                 *
+ *              num    - [OUT] the number of aggregated values                      *
+ *                                                                                  *
+ * Return value: SUCCEED - the aggregate was calculated                             *
+ *               FAIL    - the aggregate cannot be calculated by elasticsearch, the *
+ *                         values must be read with elastic_get_values()            *
+ *                                                                                  *
+ * Comments: Periods shorter than HistoryStorageAggregatePeriod are not aggregated, *
+ *           so their values are kept in value cache.                               *
+ *           Elasticsearch aggregates numbers as double values, so the sum,         *
+ *           minimum and maximum of unsigned values are not aggregated to avoid     *
+ *           loss of precision.                                                     *
+ *                                                                                  *
+ ************************************************************************************/
+static int	elastic_get_aggregate(zbx_history_iface_t *hist, zbx_uint64_t itemid, int type, int start, int end,
+		history_value_t *value, int *num)
+{
+	const char		*__function_name = "elastic_get_aggregate";
 
-		while (NULL != (p = zbx_json_next(&jp_hits, p)))
-		{
-			empty = 0;
+	zbx_elastic_data_t	*data = (zbx_elastic_data_t *)hist->data;
+	size_t			url_alloc = 0, url_offset = 0;
+	int			ret = FAIL;
+	struct zbx_json		query;
+	struct zbx_json_parse	jp, jp_aggs, jp_num, jp_value;
+	struct curl_slist	*curl_headers = NULL;
+	const char		*aggs[] = {"sum", "avg", "min", "max"};
+	char			buffer[MAX_STRING_LEN], errbuf[CURL_ERROR_SIZE];
 
-			if (SUCCEED != zbx_json_brackets_open(p, &jp_item))
-				continue;
+	if (0 == CONFIG_HISTORY_STORAGE_AGGREGATE_PERIOD || end - start < CONFIG_HISTORY_STORAGE_AGGREGATE_PERIOD)
+		return FAIL;
 
-			if (SUCCEED != zbx_json_brackets_by_name(&jp_item, "_source", &jp_source))
-				continue;
+	if (ZBX_HISTORY_AGGR_COUNT != type)
+	{
+		if (ITEM_VALUE_TYPE_FLOAT != hist->value_type && ITEM_VALUE_TYPE_UINT64 != hist->value_type)
+			return FAIL;
 
-			if (SUCCEED != history_parse_value(&jp_source, hist->value_type, &hr))
-				continue;
+		if (ITEM_VALUE_TYPE_UINT64 == hist->value_type && ZBX_HISTORY_AGGR_AVG != type)
+			return FAIL;
+	}
 
-			zbx_vector_history_record_append_ptr(values, &hr);
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() itemid:" ZBX_FS_UI64 " type:%d start:%d end:%d", __function_name,
+			itemid, type, start, end);
 
-			if (-1 != total)
-				--total;
+	curl_headers = curl_slist_append(curl_headers, "Content-Type: application/json");
 
-			if (0 == total)
-			{
-				empty = 1;
-				break;
-			}
-		}
+	if (SUCCEED != elastic_open(data, curl_headers, errbuf))
+		goto out;
 
-		if (1 == empty)
-		{
-			ret = SUCCEED;
-			break;
-		}
+	zbx_snprintf_alloc(&data->post_url, &url_alloc, &url_offset,
+			"%s/%s*/values/_search?filter_path=aggregations", data->base_url,
+			value_type_str[hist->value_type]);
 
-		/* scroll to the next page */
-		scroll_offset = 0;
-		zbx_snprintf_alloc(&scroll_query, &scroll_alloc, &scroll_offset,
-				"{\"scroll\":\"10s\",\"scroll_id\":\"%s\"}\n", ZBX_NULL2EMPTY_STR(scroll_id));
+	/* only the aggregations are requested, no documents are returned */
+	zbx_json_init(&query, ZBX_JSON_ALLOCATE);
+	zbx_json_adduint64(&query, "size", 0);
+	elastic_add_query(&query, itemid, start, end);
 
-		curl_easy_setopt(data->handle, CURLOPT_POSTFIELDS, scroll_query);
+	zbx_json_addobject(&query, "aggs");
+	zbx_json_addobject(&query, "num");
+	zbx_json_addobject(&query, "value_count");
+	zbx_json_addstring(&query, "field", "clock", ZBX_JSON_TYPE_STRING);
+	zbx_json_close(&query);
+	zbx_json_close(&query);
 
-		page_r.offset = 0;
-		*errbuf = '\0';
-		if (CURLE_OK != (err = curl_easy_perform(data->handle)))
-		{
-			elastic_log_error(data->handle, err, errbuf);
-			break;
-		}
+	if (ZBX_HISTORY_AGGR_COUNT != type)
+	{
+		zbx_json_addobject(&query, "value");
+		zbx_json_addobject(&query, aggs[type]);
+		zbx_json_addstring(&query, "field", "value", ZBX_JSON_TYPE_STRING);
+		zbx_json_close(&query);
+		zbx_json_close(&query);
 	}
-	while (0 == empty);
 
-	/* as recommended by the elasticsearch documentation, we close the scroll search through a DELETE request */
-	if (NULL != scroll_id)
+	zbx_json_close(&query);
+	zbx_json_close(&query);
+
+	if (SUCCEED != elastic_search(data, query.buffer, errbuf))
+		goto clean;
+
+	if (SUCCEED != zbx_json_open(page_r.data, &jp) ||
+			SUCCEED != zbx_json_brackets_by_name(&jp, "aggregations", &jp_aggs) ||
+			SUCCEED != zbx_json_brackets_by_name(&jp_aggs, "num", &jp_num) ||
+			SUCCEED != zbx_json_value_by_name(&jp_num, "value", buffer, sizeof(buffer), NULL))
 	{
-		url_offset = 0;
-		zbx_snprintf_alloc(&data->post_url, &url_alloc, &url_offset, "%s/_search/scroll/%s", data->base_url,
-				scroll_id);
+		zabbix_log(LOG_LEVEL_WARNING, "cannot parse elasticsearch aggregation response");
+		goto clean;
+	}
 
-		curl_easy_setopt(data->handle, CURLOPT_URL, data->post_url);
-		curl_easy_setopt(data->handle, CURLOPT_POSTFIELDS, NULL);
-		curl_easy_setopt(data->handle, CURLOPT_CUSTOMREQUEST, "DELETE");
+	*num = atoi(buffer);
 
-		zabbix_log(LOG_LEVEL_DEBUG, "elasticsearch closing scroll %s", data->post_url);
+	if (ZBX_HISTORY_AGGR_COUNT != type && 0 != *num)
+	{
+		/* the aggregated value is null if there are no values in the period */
+		if (SUCCEED != zbx_json_brackets_by_name(&jp_aggs, "value", &jp_value) ||
+				SUCCEED != zbx_json_value_by_name(&jp_value, "value", buffer, sizeof(buffer), NULL))
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "cannot parse elasticsearch aggregation response");
+			goto clean;
+		}
 
-		page_r.offset = 0;
-		*errbuf = '\0';
-		if (CURLE_OK != (err = curl_easy_perform(data->handle)))
-			elastic_log_error(data->handle, err, errbuf);
+		value->dbl = atof(buffer);
 	}
 
+	ret = SUCCEED;
+clean:
+	zbx_json_free(&query);
 out:
 	elastic_close(hist);
 
 	curl_slist_free_all(curl_headers);
 
-	zbx_json_free(&query);
-
-	zbx_free(scroll_id);
-	zbx_free(scroll_query);
-
-	zbx_vector_history_record_sort(values, (zbx_compare_func_t)zbx_history_record_compare_desc_func);
-
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __function_name);
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
 
 	return ret;
 }
+
+/************************************************************************************
+ *                                                                                  *
+ * Function: elastic_add_values                                                     *
+ *                                                                                  *
+ * Purpose: sends history data to the storage                                       *
+ *                                                                                  *
+ * Parameters:  hist    - [IN] the history storage interface                        *
+ *              history - [IN] the history data vector (may have mixed value types) *
+ *                                                                                  *
+ ************************************************************************************/
 /******************************************************************************
  * *
- *这段代码的主要目的是将历史数据（历史表中的数据）添加到 Elasticsearch 系统中。代码首先定义了函数名、历史数据结构体指针、变量等，然后遍历历史数据，根据数据类型进行处理，将符合条件的数据添加到 JSON 对象中。最后，将 JSON 对象写入缓冲区，并设置上传 URL，将数据发送到 Elasticsearch。整个过程中，代码还记录了日志以方便调试。
+ *这段代码的主要目的是将历史数据（历史表中的数据）添加到 Elasticsearch 系统中。代码首先定义了函数名、历史数据结构体指针、变量等，然后遍历历史数据，根据数据类型进行处理，将符合条件的数据添加到批量请求中。批量请求达到大小上限时开始一个新的批量请求，所有批量请求都交给写入器，由写入器发送到 Elasticsearch。整个过程中，代码还记录了日志以方便调试。
  ******************************************************************************/
-static int elastic_add_values(zbx_history_iface_t *hist, const zbx_vector_ptr_t *history)
+static int	elastic_add_values(zbx_history_iface_t *hist, const zbx_vector_ptr_t *history)
 {
 	// 定义函数名
-	const char *__function_name = "elastic_add_values";
+	const char		*__function_name = "elastic_add_values";
 
 	// 获取历史数据结构体指针
-	zbx_elastic_data_t *data = (zbx_elastic_data_t *)hist->data;
-	int i, num = 0;
-	ZBX_DC_HISTORY *h;
-	struct zbx_json json_idx, json;
-	size_t buf_alloc = 0, buf_offset = 0;
-	char pipeline[14]; /* 索引名称长度 + 后缀 "-pipeline" */
+	zbx_elastic_data_t	*data = (zbx_elastic_data_t *)hist->data;
+	int			i, num = 0;
+	ZBX_DC_HISTORY		*h;
+	struct zbx_json		json_idx, json;
+	char			pipeline[14]; /* 索引名称长度 + 后缀 "-pipeline" */
+	char			*url, *doc = NULL;
+	size_t			doc_alloc = 0, doc_offset;
+	zbx_elastic_bulk_t	*bulk = NULL;
 
 	// 记录日志
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
 
+	elastic_writer_init();
+
+	url = zbx_dsprintf(NULL, "%s/_bulk?refresh=true", data->base_url);
 	// 初始化json结构体
 	zbx_json_init(&json_idx, ZBX_IDX_JSON_ALLOCATE);
 
@@ -1192,25 +1470,33 @@ static int elastic_add_values(zbx_history_iface_t *hist, const zbx_vector_ptr_t
 		zbx_json_close(&json);
 
 		// 将json字符串写入缓冲区
-		zbx_snprintf_alloc(&data->buf, &buf_alloc, &buf_offset, "%s\
-%s\
-", json_idx.buffer, json.buffer);
+		doc_offset = 0;
+		zbx_snprintf_alloc(&doc, &doc_alloc, &doc_offset, "%s\n%s\n", json_idx.buffer, json.buffer);
 
 		// 释放json结构体
 		zbx_json_free(&json);
 
+		/* start a new bulk request when the current one would exceed the size limit */
+		if (NULL != bulk && bulk->buf_offset + doc_offset > writer.bulk_size)
+		{
+			elastic_writer_add_bulk(bulk);
+			bulk = NULL;
+		}
+
+		if (NULL == bulk)
+			bulk = elastic_bulk_create(url);
+
+		elastic_bulk_add_doc(bulk, doc, doc_offset);
 		// 累加数量
 		num++;
 	}
 
-	// 如果处理了数据，执行以下操作：
-	if (num > 0)
-	{
-		// 设置 post_url
-		data->post_url = zbx_dsprintf(NULL, "%s/_bulk?refresh=true", data->base_url);
-		// 添加数据到 Elasticsearch
-		elastic_writer_add_iface(hist);
-	}
+	// 将最后一个批量请求交给写入器，由写入器发送到 Elasticsearch
+	if (NULL != bulk)
+		elastic_writer_add_bulk(bulk);
+
+	zbx_free(doc);
+	zbx_free(url);
 
 	// 释放json结构体
 	zbx_json_free(&json_idx);
@@ -1222,18 +1508,6 @@ static int elastic_add_values(zbx_history_iface_t *hist, const zbx_vector_ptr_t
 	return num;
 }
 
-	{
-		data->post_url = zbx_dsprintf(NULL, "%s/_bulk?refresh=true", data->base_url);
-		elastic_writer_add_iface(hist);
-	}
-
-	zbx_json_free(&json_idx);
-
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __function_name);
-
-	return num;
-}
-
 /************************************************************************************
  *                                                                                  *
  * Function: elastic_flush                                                          *
@@ -1251,11 +1525,28 @@ static int elastic_add_values(zbx_history_iface_t *hist, const zbx_vector_ptr_t
  *这块代码的主要目的是定义一个名为 elastic_flush 的静态函数，该函数接收一个 zbx_history_iface_t 类型的指针作为参数。在函数内部，首先忽略传入的 hist 参数，不对它进行操作。然后调用另一个名为 elastic_writer_flush 的函数，并将它的返回值作为当前函数的返回值。整个代码块的功能是实现一个简单的弹性刷新技术，用于清除历史数据。
  ******************************************************************************/
 // 定义一个名为 elastic_flush 的静态函数，参数为一个 zbx_history_iface_t 类型的指针 hist
-static int elastic_flush(zbx_history_iface_t *hist)
+static int	elastic_flush(zbx_history_iface_t *hist)
 {
-    // 忽略传入的 hist 参数，不对它进行操作
-    ZBX_UNUSED(hist);
+	// 忽略传入的 hist 参数，不对它进行操作
+	ZBX_UNUSED(hist);
+
+	return elastic_writer_flush();
+}
 
+/************************************************************************************
+ *                                                                                  *
+ * Function: zbx_history_elastic_init                                               *
+ *                                                                                  *
+ * Purpose: initializes history storage interface                                   *
+ *                                                                                  *
+ * Parameters:  hist       - [IN] the history storage interface                     *
+ *              value_type - [IN] the target value type                             *
+ *              error      - [OUT] the error message                                *
+ *                                                                                  *
+ * Return value: SUCCEED - the history storage interface was initialized            *
+ *               FAIL    - otherwise                                                *
+ *                                                                                  *
+ ************************************************************************************/
 /******************************************************************************
  * *
  *整个代码块的主要目的是初始化一个zbx历史数据接口，设置其与Elasticsearch相关的数据，并绑定相应的函数。若cURL库初始化失败，则返回错误信息。输出结果为Elasticsearch接口的初始化状态。
@@ -1265,10 +1556,10 @@ static int elastic_flush(zbx_history_iface_t *hist)
 //   hist：历史数据接口指针
 //   value_type：值类型
 //   error：错误信息指针，若出错，则返回错误信息
-int zbx_history_elastic_init(zbx_history_iface_t *hist, unsigned char value_type, char **error)
+int	zbx_history_elastic_init(zbx_history_iface_t *hist, unsigned char value_type, char **error)
 {
 	// 定义一个zbx_elastic_data_t类型的指针，用于存储Elasticsearch相关的数据
-	zbx_elastic_data_t *data;
+	zbx_elastic_data_t	*data;
 
 	// 初始化cURL库
 	if (0 != curl_global_init(CURL_GLOBAL_ALL))
@@ -1285,28 +1576,22 @@ int zbx_history_elastic_init(zbx_history_iface_t *hist, unsigned char value_type
 	memset(data, 0, sizeof(zbx_elastic_data_t));
 	data->base_url = zbx_strdup(NULL, CONFIG_HISTORY_STORAGE_URL);
 	zbx_rtrim(data->base_url, "/");
-	data->buf = NULL;
 	data->post_url = NULL;
 	data->handle = NULL;
 
 	// 设置历史数据接口的值类型
 	hist->value_type = value_type;
-
 	// 将data结构体指针赋值给历史数据接口的data成员
 	hist->data = data;
-
 	// 设置历史数据接口的销毁函数
 	hist->destroy = elastic_destroy;
-
 	// 设置历史数据接口的添加数据函数
 	hist->add_values = elastic_add_values;
-
 	// 设置历史数据接口的刷新函数
 	hist->flush = elastic_flush;
-
 	// 设置历史数据接口的获取数据函数
 	hist->get_values = elastic_get_values;
-
+	hist->get_aggregate = elastic_get_aggregate;
 	// 设置历史数据接口是否需要趋势数据
 	hist->requires_trends = 0;
 
@@ -1314,27 +1599,8 @@ int zbx_history_elastic_init(zbx_history_iface_t *hist, unsigned char value_type
 	return SUCCEED;
 }
 
-
-	data = (zbx_elastic_data_t *)zbx_malloc(NULL, sizeof(zbx_elastic_data_t));
-	memset(data, 0, sizeof(zbx_elastic_data_t));
-	data->base_url = zbx_strdup(NULL, CONFIG_HISTORY_STORAGE_URL);
-	zbx_rtrim(data->base_url, "/");
-	data->buf = NULL;
-	data->post_url = NULL;
-	data->handle = NULL;
-
-	hist->value_type = value_type;
-	hist->data = data;
-	hist->destroy = elastic_destroy;
-	hist->add_values = elastic_add_values;
-	hist->flush = elastic_flush;
-	hist->get_values = elastic_get_values;
-	hist->requires_trends = 0;
-
-	return SUCCEED;
-}
-
 #else
+
 /******************************************************************************
  * *
  *整个代码块的主要目的是检查cURL库的支持版本是否满足要求，如果满足，则返回OK，否则返回FAIL并输出错误信息。
@@ -1343,7 +1609,7 @@ int zbx_history_elastic_init(zbx_history_iface_t *hist, unsigned char value_type
 // 参数1：指向zbx_history_iface_t类型结构的指针，该结构体用于历史数据接口；
 // 参数2：无符号字符类型，表示值类型；
 // 参数3：指向字符串的指针，用于存储错误信息。
-int zbx_history_elastic_init(zbx_history_iface_t *hist, unsigned char value_type, char **error)
+int	zbx_history_elastic_init(zbx_history_iface_t *hist, unsigned char value_type, char **error)
 {
 	// 忽略hist和value_type参数，不对它们进行操作。
 	ZBX_UNUSED(hist);
@@ -1355,5 +1621,4 @@ int zbx_history_elastic_init(zbx_history_iface_t *hist, unsigned char value_type
 	return FAIL;
 }
 
-
 #endif
@@ -68,6 +68,15 @@ zbx_vc_history_table_t;
 static void	row2value_str(history_value_t *value, DB_ROW row)
 {
     // 为value结构体的str字段分配内存，分配的大小为row[0]的长度
+    value->str = zbx_strdup(NULL, row[0]);
+}
+
+static void	row2value_dbl(history_value_t *value, DB_ROW row)
+{
+	value->dbl = atof(row[0]);
+}
+
+/* timestamp, logeventid, severity, source, value */
 /******************************************************************************
  * *
  *整个代码块的主要目的是将 DB_ROW 类型的指针 row 转换为 history_value_t 类型的指针 value，并将 row 数组中的数据分别赋值给 value 结构体中的相应成员。具体来说，就是将 row 数组中的第1个、第2个、第3个和第5个元素分别转换为整数，并赋值给 value->log 结构体的 timestamp、logeventid、severity 和 value 成员。同时，判断 row 数组中的第4个元素是否为空字符串，如果是，则将其指针设置为 NULL，否则，复制该字符串到 value->log 结构体的 source 成员。
@@ -94,6 +103,7 @@ static void row2value_log(history_value_t *value, DB_ROW row)
 	value->log->value = zbx_strdup(NULL, row[4]);
 }
 
+/******************************************************************************
  * *
  *这块代码的主要目的是将DB_ROW类型的数据转换为history_value_t类型的数据。具体来说，是将DB_ROW中的第一个元素（假设是一个字符串）转换为uint64类型的数据，并存储在history_value_t结构的ui64成员变量中。
  *
@@ -116,25 +126,6 @@ static void	row2value_ui64(history_value_t *value, DB_ROW row)
     // 函数执行完毕，返回
 }
 
-
-
-static void	row2value_ui64(history_value_t *value, DB_ROW row)
-{
-	ZBX_STR2UINT64(value->ui64, row[0]);
-}
-
-/* timestamp, logeventid, severity, source, value */
-static void	row2value_log(history_value_t *value, DB_ROW row)
-{
-	value->log = (zbx_log_value_t *)zbx_malloc(NULL, sizeof(zbx_log_value_t));
-
-	value->log->timestamp = atoi(row[0]);
-	value->log->logeventid = atoi(row[1]);
-	value->log->severity = atoi(row[2]);
-	value->log->source = '\0' == *row[3] ? NULL : zbx_strdup(NULL, row[3]);
-	value->log->value = zbx_strdup(NULL, row[4]);
-}
-
 /* value_type - history table data mapping */
 static zbx_vc_history_table_t	vc_history_tables[] = {
 	{"history", "value", row2value_dbl},
@@ -279,42 +270,10 @@ static int	sql_writer_flush(void)
 			 */
 			zbx_db_insert_execute(db_insert);
 		}
-/******************************************************************************
- * *
- *整个代码块的主要目的是：遍历一个历史数据结构体数组，将其中符合条件的浮点数数据插入到数据库中。代码首先分配一块内存用于存储数据库插入信息，然后预处理插入语句。接下来，遍历历史数据结构体数组，判断数据类型是否为浮点数，如果是，则将数据插入到数据库中。最后，将数据库插入语句添加到队列中，由 sql_writer_add_dbinsert 函数处理。
- ******************************************************************************/
-// 定义一个静态函数，用于向数据库插入历史数据
-static void add_history_dbl(const zbx_vector_ptr_t *history)
-{
-	// 定义一个整型变量 i，用于循环计数
-	int i;
-	// 定义一个 zbx_db_insert_t 类型的指针，用于存储数据库插入信息
-	zbx_db_insert_t *db_insert;
-
-	// 分配一块内存，用于存储 zbx_db_insert_t 结构体
-	db_insert = (zbx_db_insert_t *)zbx_malloc(NULL, sizeof(zbx_db_insert_t));
-	// 预处理数据库插入语句，传入参数为表名、字段名和 NULL
-	zbx_db_insert_prepare(db_insert, "history", "itemid", "clock", "ns", "value", NULL);
-
-	// 遍历历史数据结构体数组
-	for (i = 0; i < history->values_num; i++)
-	{
-		// 传入一个 ZBX_DC_HISTORY 类型的指针，用于访问历史数据
-		const ZBX_DC_HISTORY *h = (ZBX_DC_HISTORY *)history->values[i];
-
-		// 判断数据类型是否为浮点数
-		if (ITEM_VALUE_TYPE_FLOAT != h->value_type)
-			// 如果不是浮点数，则跳过本次循环
-			continue;
-
-		// 将数据插入到数据库中，传入参数为 itemid、timestamp（秒和纳秒）、值
-		zbx_db_insert_add_values(db_insert, h->itemid, h->ts.sec, h->ts.ns, h->value.dbl);
 	}
+	while (ZBX_DB_DOWN == (txn_error = DBcommit()));
 
-	// 将数据库插入语句添加到队列中，由 sql_writer_add_dbinsert 函数处理
-	sql_writer_add_dbinsert(db_insert);
-}
-
+	sql_writer_release();
 
 	return ZBX_DB_OK == txn_error ? SUCCEED : FAIL;
 }
@@ -332,24 +291,42 @@ typedef void (*add_history_func_t)(const zbx_vector_ptr_t *history);
  * Function: add_history_dbl                                                  *
  *                                                                            *
  ******************************************************************************/
-static void	add_history_dbl(const zbx_vector_ptr_t *history)
+/******************************************************************************
+ * *
+ *整个代码块的主要目的是：遍历一个历史数据结构体数组，将其中符合条件的浮点数数据插入到数据库中。代码首先分配一块内存用于存储数据库插入信息，然后预处理插入语句。接下来，遍历历史数据结构体数组，判断数据类型是否为浮点数，如果是，则将数据插入到数据库中。最后，将数据库插入语句添加到队列中，由 sql_writer_add_dbinsert 函数处理。
+ ******************************************************************************/
+// 定义一个静态函数，用于向数据库插入历史数据
+static void add_history_dbl(const zbx_vector_ptr_t *history)
 {
-	int		i;
-	zbx_db_insert_t	*db_insert;
+	// 定义一个整型变量 i，用于循环计数
+	int i;
+	// 定义一个 zbx_db_insert_t 类型的指针，用于存储数据库插入信息
+	zbx_db_insert_t *db_insert;
 
+	// 分配一块内存，用于存储 zbx_db_insert_t 结构体
 	db_insert = (zbx_db_insert_t *)zbx_malloc(NULL, sizeof(zbx_db_insert_t));
+	// 预处理数据库插入语句，传入参数为表名、字段名和 NULL
 	zbx_db_insert_prepare(db_insert, "history", "itemid", "clock", "ns", "value", NULL);
 
+	if (0 != CONFIG_DB_COPY_HISTORY)
+		zbx_db_insert_use_copy(db_insert);
+
+	// 遍历历史数据结构体数组
 	for (i = 0; i < history->values_num; i++)
 	{
-		const ZBX_DC_HISTORY	*h = (ZBX_DC_HISTORY *)history->values[i];
+		// 传入一个 ZBX_DC_HISTORY 类型的指针，用于访问历史数据
+		const ZBX_DC_HISTORY *h = (ZBX_DC_HISTORY *)history->values[i];
 
+		// 判断数据类型是否为浮点数
 		if (ITEM_VALUE_TYPE_FLOAT != h->value_type)
+			// 如果不是浮点数，则跳过本次循环
 			continue;
 
+		// 将数据插入到数据库中，传入参数为 itemid、timestamp（秒和纳秒）、值
 		zbx_db_insert_add_values(db_insert, h->itemid, h->ts.sec, h->ts.ns, h->value.dbl);
 	}
 
+	// 将数据库插入语句添加到队列中，由 sql_writer_add_dbinsert 函数处理
 	sql_writer_add_dbinsert(db_insert);
 }
 
@@ -375,6 +352,9 @@ static void add_history_uint(zbx_vector_ptr_t *history)
 	// 预编译插入语句，准备插入历史数据
 	zbx_db_insert_prepare(db_insert, "history_uint", "itemid", "clock", "ns", "value", NULL);
 
+	if (0 != CONFIG_DB_COPY_HISTORY)
+		zbx_db_insert_use_copy(db_insert);
+
 	// 遍历历史数据中的每个元素
 	for (i = 0; i < history->values_num; i++)
 	{
@@ -436,48 +416,18 @@ static void add_history_str(zbx_vector_ptr_t *history)
 			continue;
 
 		// 将当前元素的数据添加到插入语句中
-/******************************************************************************
- * *
- *整个代码块的主要目的是：遍历一个历史日志数组，将符合条件的日志记录添加到数据库中。具体操作包括：分配内存空间并初始化 db_insert 结构体，准备数据库插入操作的相关参数，遍历数组处理每个元素，将符合条件的日志记录添加到 db_insert 结构体中，最后将 db_insert 添加到 sql_writer 中进行数据库插入操作。
- ******************************************************************************/
-// 定义一个静态函数，用于添加历史日志记录
-static void add_history_log(zbx_vector_ptr_t *history)
-{
-	// 定义一个整型变量 i，用于循环计数
-	int i;
-	// 定义一个指向 zbx_db_insert_t 类型的指针 db_insert，用于存储数据库插入操作的相关信息
-	zbx_db_insert_t *db_insert;
-
-	// 为 db_insert 分配内存空间，并初始化为 zbx_db_insert_t 类型的零值
-	db_insert = (zbx_db_insert_t *)zbx_malloc(NULL, sizeof(zbx_db_insert_t));
-	// 调用 zbx_db_insert_prepare 函数，准备数据库插入操作的相关参数
-	zbx_db_insert_prepare(db_insert, "history_log", "itemid", "clock", "ns", "timestamp", "source", "severity",
-			"value", "logeventid", NULL);
-
-	// 遍历 history 指向的数组，处理每个元素
-	for (i = 0; i < history->values_num; i++)
-	{
-		// 转换为 ZBX_DC_HISTORY 类型的指针 h，方便处理数组元素
-		const ZBX_DC_HISTORY *h = (ZBX_DC_HISTORY *)history->values[i];
-		// 转换为 zbx_log_value_t 类型的指针 log，方便处理日志记录
-		const zbx_log_value_t *log;
-
-		// 判断当前元素的价值类型是否为日志类型（ITEM_VALUE_TYPE_LOG）
-		if (ITEM_VALUE_TYPE_LOG != h->value_type)
-			continue;
-
-		// 获取日志记录的相关信息
-		log = h->value.log;
-
-		// 将日志记录的相关信息添加到 db_insert 中
-		zbx_db_insert_add_values(db_insert, h->itemid, h->ts.sec, h->ts.ns, log->timestamp,
-				ZBX_NULL2EMPTY_STR(log->source), log->severity, log->value, log->logeventid);
+		zbx_db_insert_add_values(db_insert, h->itemid, h->ts.sec, h->ts.ns, h->value.str);
 	}
 
-	// 将 db_insert 添加到 sql_writer 中，进行数据库插入操作
 	sql_writer_add_dbinsert(db_insert);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: add_history_text                                                 *
+ *                                                                            *
+ ******************************************************************************/
+static void	add_history_text(zbx_vector_ptr_t *history)
 {
 	// 定义一个整型变量 i，用于循环计数
 	int i;
@@ -515,29 +465,45 @@ static void add_history_log(zbx_vector_ptr_t *history)
  * Function: add_history_log                                                  *
  *                                                                            *
  ******************************************************************************/
-static void	add_history_log(zbx_vector_ptr_t *history)
+/******************************************************************************
+ * *
+ *整个代码块的主要目的是：遍历一个历史日志数组，将符合条件的日志记录添加到数据库中。具体操作包括：分配内存空间并初始化 db_insert 结构体，准备数据库插入操作的相关参数，遍历数组处理每个元素，将符合条件的日志记录添加到 db_insert 结构体中，最后将 db_insert 添加到 sql_writer 中进行数据库插入操作。
+ ******************************************************************************/
+// 定义一个静态函数，用于添加历史日志记录
+static void add_history_log(zbx_vector_ptr_t *history)
 {
-	int			i;
-	zbx_db_insert_t	*db_insert;
+	// 定义一个整型变量 i，用于循环计数
+	int i;
+	// 定义一个指向 zbx_db_insert_t 类型的指针 db_insert，用于存储数据库插入操作的相关信息
+	zbx_db_insert_t *db_insert;
 
+	// 为 db_insert 分配内存空间，并初始化为 zbx_db_insert_t 类型的零值
 	db_insert = (zbx_db_insert_t *)zbx_malloc(NULL, sizeof(zbx_db_insert_t));
+	// 调用 zbx_db_insert_prepare 函数，准备数据库插入操作的相关参数
 	zbx_db_insert_prepare(db_insert, "history_log", "itemid", "clock", "ns", "timestamp", "source", "severity",
 			"value", "logeventid", NULL);
 
+	// 遍历 history 指向的数组，处理每个元素
 	for (i = 0; i < history->values_num; i++)
 	{
-		const ZBX_DC_HISTORY	*h = (ZBX_DC_HISTORY *)history->values[i];
-		const zbx_log_value_t	*log;
+		// 转换为 ZBX_DC_HISTORY 类型的指针 h，方便处理数组元素
+		const ZBX_DC_HISTORY *h = (ZBX_DC_HISTORY *)history->values[i];
+		// 转换为 zbx_log_value_t 类型的指针 log，方便处理日志记录
+		const zbx_log_value_t *log;
 
+		// 判断当前元素的价值类型是否为日志类型（ITEM_VALUE_TYPE_LOG）
 		if (ITEM_VALUE_TYPE_LOG != h->value_type)
 			continue;
 
+		// 获取日志记录的相关信息
 		log = h->value.log;
 
+		// 将日志记录的相关信息添加到 db_insert 中
 		zbx_db_insert_add_values(db_insert, h->itemid, h->ts.sec, h->ts.ns, log->timestamp,
 				ZBX_NULL2EMPTY_STR(log->source), log->severity, log->value, log->logeventid);
 	}
 
+	// 将 db_insert 添加到 sql_writer 中，进行数据库插入操作
 	sql_writer_add_dbinsert(db_insert);
 }
 
@@ -642,6 +608,30 @@ out:
 
 
 /************************************************************************************
+ *                                                                                  *
+ * Function: db_read_values_by_count                                                *
+ *                                                                                  *
+ * Purpose: reads item history data from database                                   *
+ *                                                                                  *
+ * Parameters:  itemid        - [IN] the itemid                                     *
+ *              value_type    - [IN] the value type (see ITEM_VALUE_TYPE_* defs)    *
+ *              values        - [OUT] the item history data values                  *
+ *              count         - [IN] the number of values to read                   *
+ *              end_timestamp - [IN] the value timestamp to start reading with      *
+ *                                                                                  *
+ * Return value: SUCCEED - the history data were read successfully                  *
+ *               FAIL - otherwise                                                   *
+ *                                                                                  *
+ * Comments: this function reads <count> values before <count_timestamp> (including)*
+ *           plus all values in range:                                              *
+ *             count_timestamp < <value timestamp> <= read_timestamp                *
+ *                                                                                  *
+ *           To speed up the reading time with huge data loads, data is read by     *
+ *           smaller time segments (hours, day, week, month) and the next (larger)  *
+ *           time segment is read only if the requested number of values (<count>)  *
+ *           is not yet retrieved.                                                  *
+ *                                                                                  *
+ ************************************************************************************/
 /******************************************************************************
  * *
  *这段代码的主要目的是按照给定的计数器查询数据库中的历史数据，并将查询结果存储在一个数组中。代码首先构建一个查询语句，根据给定的条件（如itemid、价值类型、时间戳等）从数据库中查询数据。然后，遍历查询结果，将数据添加到预先分配的数组中。当查询完成时，释放查询结果并返回成功。如果数据库中没有更多数据，则删除数组中最后一段时间段的数据，并重新查询整个时间段，以确保数据被缓存到秒级。最后，调用另一个函数按时间查询数据库中的数据，并将结果存储在数组中。
@@ -677,7 +667,7 @@ static int db_read_values_by_count(zbx_uint64_t itemid, int value_type, zbx_vect
         zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
                           "select clock,ns,%s"
                           " from %s"
-                          " where itemid=%ld"
+                          " where itemid=" ZBX_FS_UI64
                           " and clock<=%d",
                           table->fields, table->name, itemid, clock_to);
 
@@ -744,31 +734,6 @@ out:
     return ret;
 }
 
-
-	if (0 < count)
-	{
-		/* no more data in database, return success */
-		ret = SUCCEED;
-		goto out;
-	}
-
-	/* drop data from the last second and read the whole second again  */
-	/* to ensure that data is cached by seconds                        */
-	end_timestamp = values->values[values->values_num - 1].timestamp.sec;
-
-	while (0 < values->values_num && values->values[values->values_num - 1].timestamp.sec == end_timestamp)
-	{
-		values->values_num--;
-		zbx_history_record_clear(&values->values[values->values_num], value_type);
-	}
-
-	ret = db_read_values_by_time(itemid, value_type, values, 1, end_timestamp);
-out:
-	zbx_free(sql);
-
-	return ret;
-}
-
 /************************************************************************************
  *                                                                                  *
  * Function: db_read_values_by_time_and_count                                       *
@@ -810,7 +775,7 @@ static int db_read_values_by_time_and_count(zbx_uint64_t itemid, int value_type,
 	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
 	                "select clock,ns,%s"
 	                " from %s"
-	                " where itemid=%zu",
+	                " where itemid=" ZBX_FS_UI64,
 	                table->fields, table->name, itemid);
 
 	// 如果指定的时间间隔为1秒，直接添加查询条件
@@ -909,7 +874,7 @@ out:
  *    ZBX_UNUSED(hist);
  *}
  *
- *// 该函数的主要目的是销毁一个zbx_history_iface类型的对象。在此过程中，传入的hist参数将被忽略。
+ * // 该函数的主要目的是销毁一个zbx_history_iface类型的对象。在此过程中，传入的hist参数将被忽略。
  *```
  ******************************************************************************/
 // 这是一个C语言代码块，定义了一个名为sql_destroy的静态函数，其参数为一个指向zbx_history_iface_t类型的指针。
@@ -923,6 +888,25 @@ static void sql_destroy(zbx_history_iface_t *hist)
 
 
 /************************************************************************************
+ *                                                                                  *
+ * Function: sql_get_values                                                         *
+ *                                                                                  *
+ * Purpose: gets item history data from history storage                             *
+ *                                                                                  *
+ * Parameters:  hist    - [IN] the history storage interface                        *
+ *              itemid  - [IN] the itemid                                           *
+ *              start   - [IN] the period start timestamp                           *
+ *              count   - [IN] the number of values to read                         *
+ *              end     - [IN] the period end timestamp                             *
+ *              values  - [OUT] the item history data values                        *
+ *                                                                                  *
+ * Return value: SUCCEED - the history data were read successfully                  *
+ *               FAIL - otherwise                                                   *
+ *                                                                                  *
+ * Comments: This function reads <count> values from ]<start>,<end>] interval or    *
+ *           all values from the specified interval if count is zero.               *
+ *                                                                                  *
+ ************************************************************************************/
 /******************************************************************************
  * *
  *整个代码块的主要目的是实现一个名为sql_get_values的函数，该函数根据传入的时间范围和数据数量来查询历史数据，并将查询结果存储在zbx_vector_history_record_t类型的数组values中。函数首先判断count是否为0，如果为0则表示时间范围为空，直接调用db_read_values_by_time函数根据时间范围读取数据；否则判断start是否为0，如果为0则表示时间范围从0开始，直接调用db_read_values_by_count函数根据数据数量读取数据；如果start不等于0，则调用db_read_values_by_time_and_count函数根据时间和数据数量来查询数据。
@@ -950,18 +934,16 @@ static int	sql_get_values(zbx_history_iface_t *hist, zbx_uint64_t itemid, int st
 	// 如果start不等于0，说明需要根据时间和数据数量来查询数据，调用db_read_values_by_time_and_count函数读取数据
 	return db_read_values_by_time_and_count(itemid, hist->value_type, values, end - start, count, end);
 }
-
+/************************************************************************************
  *                                                                                  *
- * Return value: SUCCEED - the history data were read successfully                  *
- *               FAIL - otherwise                                                   *
+ * Function: sql_add_values                                                         *
  *                                                                                  *
- * Comments: This function reads <count> values from ]<start>,<end>] interval or    *
- *           all values from the specified interval if count is zero.               *
+ * Purpose: sends history data to the storage                                       *
+ *                                                                                  *
+ * Parameters:  hist    - [IN] the history storage interface                        *
+ *              history - [IN] the history data vector (may have mixed value types) *
  *                                                                                  *
  ************************************************************************************/
-static int	sql_get_values(zbx_history_iface_t *hist, zbx_uint64_t itemid, int start, int count, int end,
-		zbx_vector_history_record_t *values)
-{
 /******************************************************************************
  * *
  *这块代码的主要目的是：定义一个静态函数`sql_add_values`，用于向历史数据中添加数据。首先遍历传入的历史数据，判断数据类型是否符合要求，如果符合则增加计数。如果符合条件的历史数据数量不为0，则调用添加历史数据的函数，并将历史数据传入。最后返回符合条件的历史数据数量。
@@ -997,25 +979,39 @@ static int	sql_add_values(zbx_history_iface_t *hist, const zbx_vector_ptr_t *his
 	return h_num;
 }
 
+/************************************************************************************
+ *                                                                                  *
+ * Function: sql_flush                                                              *
+ *                                                                                  *
+ * Purpose: flushes the history data to storage                                     *
+ *                                                                                  *
+ * Parameters:  hist    - [IN] the history storage interface                        *
+ *                                                                                  *
+ * Comments: This function will try to flush the data until it succeeds or          *
+ *           unrecoverable error occurs                                             *
+ *                                                                                  *
+ ************************************************************************************/
+static int	sql_flush(zbx_history_iface_t *hist)
 {
-	int	i, h_num = 0;
-
-	for (i = 0; i < history->values_num; i++)
-	{
-		const ZBX_DC_HISTORY	*h = (ZBX_DC_HISTORY *)history->values[i];
-
-		if (h->value_type == hist->value_type)
-			h_num++;
-	}
+	ZBX_UNUSED(hist);
 
-	if (0 != h_num)
-	{
-		add_history_func_t	add_history_func = (add_history_func_t)hist->data;
-		add_history_func(history);
-	}
-
-	return h_num;
+	return sql_writer_flush();
 }
+
+/************************************************************************************
+ *                                                                                  *
+ * Function: zbx_history_sql_init                                                   *
+ *                                                                                  *
+ * Purpose: initializes history storage interface                                   *
+ *                                                                                  *
+ * Parameters:  hist       - [IN] the history storage interface                     *
+ *              value_type - [IN] the target value type                             *
+ *              error      - [OUT] the error message                                *
+ *                                                                                  *
+ * Return value: SUCCEED - the history storage interface was initialized            *
+ *               FAIL    - otherwise                                                *
+ *                                                                                  *
+ ************************************************************************************/
 /******************************************************************************
  * *
  *整个代码块的主要目的是初始化一个历史数据接口（zbx_history_iface_t类型）对象，根据传入的数据类型（unsigned char类型）设置相应的处理函数，并设置必要的成员变量。输出结果为：
@@ -1111,46 +1107,3 @@ int zbx_history_sql_init(zbx_history_iface_t *hist, unsigned char value_type, ch
 	// 函数执行成功，返回SUCCEED表示成功；
 	return SUCCEED;
 }
-
- * Parameters:  hist       - [IN] the history storage interface                     *
- *              value_type - [IN] the target value type                             *
- *              error      - [OUT] the error message                                *
- *                                                                                  *
- * Return value: SUCCEED - the history storage interface was initialized            *
- *               FAIL    - otherwise                                                *
- *                                                                                  *
- ************************************************************************************/
-int	zbx_history_sql_init(zbx_history_iface_t *hist, unsigned char value_type, char **error)
-{
-	ZBX_UNUSED(error);
-
-	hist->value_type = value_type;
-
-	hist->destroy = sql_destroy;
-	hist->add_values = sql_add_values;
-	hist->flush = sql_flush;
-	hist->get_values = sql_get_values;
-
-	switch (value_type)
-	{
-		case ITEM_VALUE_TYPE_FLOAT:
-			hist->data = (void *)add_history_dbl;
-			break;
-		case ITEM_VALUE_TYPE_UINT64:
-			hist->data = (void *)add_history_uint;
-			break;
-		case ITEM_VALUE_TYPE_STR:
-			hist->data = (void *)add_history_str;
-			break;
-		case ITEM_VALUE_TYPE_TEXT:
-			hist->data = (void *)add_history_text;
-			break;
-		case ITEM_VALUE_TYPE_LOG:
-			hist->data = (void *)add_history_log;
-			break;
-	}
-
-	hist->requires_trends = 1;
-
-	return SUCCEED;
-}
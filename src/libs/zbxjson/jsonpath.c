@@ -76,6 +76,27 @@ zbx_jsonpath_token_def_t;
 
 // 定义一个名为 jsonpath_tokens 的静态数组，用于存储 JSON Path 语法中的各种 token
 static zbx_jsonpath_token_def_t	jsonpath_tokens[] = {
+	{0, 0},
+	{ZBX_JSONPATH_TOKEN_GROUP_OPERAND, 0},		/* ZBX_JSONPATH_TOKEN_PATH_ABSOLUTE */
+	{ZBX_JSONPATH_TOKEN_GROUP_OPERAND, 0},		/* ZBX_JSONPATH_TOKEN_PATH_RELATIVE */
+	{ZBX_JSONPATH_TOKEN_GROUP_OPERAND, 0},		/* ZBX_JSONPATH_TOKEN_CONST_STR */
+	{ZBX_JSONPATH_TOKEN_GROUP_OPERAND, 0},		/* ZBX_JSONPATH_TOKEN_CONST_NUM */
+	{ZBX_JSONPATH_TOKEN_GROUP_NONE, 0},		/* ZBX_JSONPATH_TOKEN_PAREN_LEFT */
+	{ZBX_JSONPATH_TOKEN_GROUP_NONE, 0},		/* ZBX_JSONPATH_TOKEN_PAREN_RIGHT */
+	{ZBX_JSONPATH_TOKEN_GROUP_OPERATOR2, 4},	/* ZBX_JSONPATH_TOKEN_OP_PLUS */
+	{ZBX_JSONPATH_TOKEN_GROUP_OPERATOR2, 4},	/* ZBX_JSONPATH_TOKEN_OP_MINUS */
+	{ZBX_JSONPATH_TOKEN_GROUP_OPERATOR2, 3},	/* ZBX_JSONPATH_TOKEN_OP_MULT */
+	{ZBX_JSONPATH_TOKEN_GROUP_OPERATOR2, 3},	/* ZBX_JSONPATH_TOKEN_OP_DIV */
+	{ZBX_JSONPATH_TOKEN_GROUP_OPERATOR2, 7},	/* ZBX_JSONPATH_TOKEN_OP_EQ */
+	{ZBX_JSONPATH_TOKEN_GROUP_OPERATOR2, 7},	/* ZBX_JSONPATH_TOKEN_OP_NE */
+	{ZBX_JSONPATH_TOKEN_GROUP_OPERATOR2, 6},	/* ZBX_JSONPATH_TOKEN_OP_GT */
+	{ZBX_JSONPATH_TOKEN_GROUP_OPERATOR2, 6},	/* ZBX_JSONPATH_TOKEN_OP_GE */
+	{ZBX_JSONPATH_TOKEN_GROUP_OPERATOR2, 6},	/* ZBX_JSONPATH_TOKEN_OP_LT */
+	{ZBX_JSONPATH_TOKEN_GROUP_OPERATOR2, 6},	/* ZBX_JSONPATH_TOKEN_OP_LE */
+	{ZBX_JSONPATH_TOKEN_GROUP_OPERATOR1, 2},	/* ZBX_JSONPATH_TOKEN_OP_NOT */
+	{ZBX_JSONPATH_TOKEN_GROUP_OPERATOR2, 11},	/* ZBX_JSONPATH_TOKEN_OP_AND */
+	{ZBX_JSONPATH_TOKEN_GROUP_OPERATOR2, 12},	/* ZBX_JSONPATH_TOKEN_OP_OR */
+	{ZBX_JSONPATH_TOKEN_GROUP_OPERATOR2, 7}		/* ZBX_JSONPATH_TOKEN_OP_REGEXP */
 	// 定义各种 token 的组和优先级
 };
 
@@ -97,22 +118,6 @@ static int	jsonpath_token_precedence(int type)
 static int jsonpath_token_group(int type)
 {
     // 定义一个枚举类型，用于表示 JSON 路径中的不同类型
-    enum jsonpath_token_type {
-        JSONPATH_TOKEN_TYPE_INVALID = 0,
-        JSONPATH_TOKEN_TYPE_ROOT,
-        JSONPATH_TOKEN_TYPE_OBJECT_BEGIN,
-        JSONPATH_TOKEN_TYPE_OBJECT_KEY,
-        JSONPATH_TOKEN_TYPE_OBJECT_END,
-        JSONPATH_TOKEN_TYPE_ARRAY_BEGIN,
-        JSONPATH_TOKEN_TYPE_ARRAY_END,
-        JSONPATH_TOKEN_TYPE_STRING,
-        JSONPATH_TOKEN_TYPE_NUMBER,
-        JSONPATH_TOKEN_TYPE_BOOLEAN,
-        JSONPATH_TOKEN_TYPE_NULL,
-        JSONPATH_TOKEN_TYPE_COMMA,
-        JSONPATH_TOKEN_TYPE_COLON,
-        JSONPATH_TOKEN_TYPE_WS
-    };
 
     // 获取指定类型的 token 组信息
     return jsonpath_tokens[type].group;
@@ -134,18 +139,12 @@ static void zbx_vector_json_add_element(zbx_vector_json_t *elements, const char
  *这块代码的主要目的是实现向量zbx_vector_json的复制操作。通过遍历源向量的每个元素，并将元素的名称和值复制到目标向量中。整个函数的输入参数为两个指向zbx_vector_json结构体的指针，分别表示源向量和目标向量。函数输出结果为目标向量中包含了与源向量相同数量的元素，且这些元素的名称和值与源向量中的相同。
  ******************************************************************************/
 // 定义一个静态函数，用于实现向量zbx_vector_json的复制操作
-static void zbx_vector_json_copy(zbx_vector_json_t *dst, const zbx_vector_json_t *src)
-{
 	// 定义一个循环变量i，用于遍历源向量的元素
-	int i;
 
 	// 遍历源向量的每个元素
-	for (i = 0; i < src->values_num; i++)
-	{
+	el.name = zbx_strdup(NULL, name);
+	el.value = value;
 		// 向目标向量添加一个元素，元素包含名称和值
-		zbx_vector_json_add_element(dst, src->values[i].name, src->values[i].value);
-	}
-}
 
     // 使用zbx_vector_json_append函数，将el添加到名为elements的zbx向量中
     zbx_vector_json_append(elements, el);
@@ -172,10 +171,8 @@ static void zbx_vector_json_clear_ext(zbx_vector_json_t *elements)
 
 	/* 遍历elements中的每个元素 */
 	for (i = 0; i < elements->values_num; i++)
-	{
 		/* 释放每个元素的name内存 */
 		zbx_free(elements->values[i].name);
-	}
 
 	/* 调用zbx_vector_json_clear函数，清理zbx_vector_json_t结构体中的数据 */
 	zbx_vector_json_clear(elements);
@@ -201,10 +198,8 @@ static int zbx_jsonpath_error(const char *path)
 {
     // 判断path字符串是否为空，如果不为空，则执行以下操作
     if ('\0' != *path)
-    {
         // 设置错误信息，表示不支持的字符串构造
         zbx_set_json_strerror("unsupported construct in jsonpath starting with: \"%s\"", path);
-    }
     // 如果path为空，则执行以下操作
     else
 /******************************************************************************
@@ -212,20 +207,15 @@ static int zbx_jsonpath_error(const char *path)
  *这块代码的主要目的是实现一个字符串拷贝和扩展功能的函数，即给定一个源字符串和一个长度限制，将源字符串的内容拷贝到新分配的内存空间，并添加字符串结束符。最后返回新分配的字符串指针。这个函数适用于需要拷贝和扩展字符串的场景，例如在处理JSON路径时，可以用来将JSON路径字符串扩展到合适的长度。
  ******************************************************************************/
 // 定义一个静态字符串指针类型的函数，用于实现字符串拷贝和扩展功能
-static char *jsonpath_strndup(const char *source, size_t len)
-{
+		zbx_set_json_strerror("jsonpath was unexpectedly terminated");
 	// 定义一个字符指针变量str，用于存储拷贝后的字符串
-	char *str;
 
 	// 为字符串分配内存空间，分配长度为len+1，不包括字符串结束符'\0'
-	str = (char *)zbx_malloc(NULL, len + 1);
+	return FAIL;
 	// 将source字符串的内容拷贝到新分配的内存空间
-	memcpy(str, source, len);
 	// 在拷贝后的字符串末尾添加字符串结束符'\0'
-	str[len] = '\0';
 
 	// 返回新分配的字符串指针
-	return str;
 }
 
 /******************************************************************************
@@ -266,22 +256,16 @@ static char	*jsonpath_strndup(const char *source, size_t len)
  *在这个过程中，首先动态分配一块内存空间，然后调用 `jsonpath_unquote` 函数对输入的 JSON 字符串进行解引用操作。解引用后的字符串存储在动态分配的内存中，并返回这个字符串。
  ******************************************************************************/
 // 定义一个静态字符指针变量 jsonpath_unquote_dyn，用于存储解引用后的字符串值。
-static char *jsonpath_unquote_dyn(const char *start, size_t len)
+static void	jsonpath_unquote(char *value, const char *start, size_t len)
 {
 	// 定义一个字符指针变量 value，用于存储解引用后的字符串值。
-	char *value;
 
 	// 为 value 分配 len + 1 个字节的内存空间，用于存储解引用后的字符串。
-	value = (char *)zbx_malloc(NULL, len + 1);
 	
 	// 调用 jsonpath_unquote 函数，对输入的字符串 start 进行解引用操作，并将结果存储在 value 指向的内存区域。
-	jsonpath_unquote(value, start, len);
 
 	// 返回解引用后的字符串 value，此时 value 指向的字符串已经去掉了解引用符号。
-	return value;
-}
 
-{
 	/* 定义一个指针 end，指向字符串的末尾 */
 	const char	*end = start + len - 1;
 
@@ -354,21 +338,26 @@ static zbx_jsonpath_list_node_t *jsonpath_list_create_node(size_t size)
  * Purpose: free jsonpath list                                                *
  *                                                                            *
  ******************************************************************************/
+static void	jsonpath_list_free(zbx_jsonpath_list_node_t *list)
+{
+	zbx_jsonpath_list_node_t	*item = list;
+
+	while (NULL != list)
+	{
+		item = list;
+		list = list->next;
+		zbx_free(item);
+	}
+}
 /******************************************************************************
  * *
  *这块代码的主要目的是：释放一个zbx_jsonpath_list_node结构体的链表。代码实现了一个静态函数jsonpath_list_free，接收一个zbx_jsonpath_list_node类型的指针作为参数。在函数内部，使用while循环遍历链表，依次释放每个节点的内存。
  ******************************************************************************/
 // 定义一个静态函数，用于释放zbx_jsonpath_list_node结构体的链表
-static void jsonpath_list_free(zbx_jsonpath_list_node_t *list)
-{
 	// 定义一个指向链表节点的指针，初始指向链表的头节点
-	zbx_jsonpath_list_node_t *item = list;
 
 	// 使用一个while循环，当链表不为空时进行遍历
-	while (NULL != list)
-	{
 		// 将当前节点保存到item指针中
-		item = list;
 /******************************************************************************
  * *
  *整个代码块的主要目的是创建一个jsonpath类型的token，根据给定的类型、表达式和字符串位置信息进行初始化。输出结果为一个指向分配的内存空间的zbx_jsonpath_token_t结构体指针。
@@ -405,32 +394,12 @@ static zbx_jsonpath_token_t *jsonpath_create_token(int type, const char *express
 		case ZBX_JSONPATH_TOKEN_CONST_NUM:
 			// 复制表达式字符串到token的data成员中
 			token->data = jsonpath_strndup(expression + loc->l, loc->r - loc->l + 1);
-			break;
 		// 默认情况下，token的data成员为NULL
-		default:
-			token->data = NULL;
-	}
 
 	// 返回创建的token指针
-	return token;
-}
 
-static zbx_jsonpath_token_t	*jsonpath_create_token(int type, const char *expression, const zbx_strloc_t *loc)
-{
-	zbx_jsonpath_token_t	*token;
 
-	token = (zbx_jsonpath_token_t *)zbx_malloc(NULL, sizeof(zbx_jsonpath_token_t));
-	token->type = type;
 
-	switch (token->type)
-	{
-		case ZBX_JSONPATH_TOKEN_CONST_STR:
-			token->data = jsonpath_unquote_dyn(expression + loc->l, loc->r - loc->l + 1);
-			break;
-		case ZBX_JSONPATH_TOKEN_PATH_ABSOLUTE:
-		case ZBX_JSONPATH_TOKEN_PATH_RELATIVE:
-		case ZBX_JSONPATH_TOKEN_CONST_NUM:
-			token->data = jsonpath_strndup(expression + loc->l, loc->r - loc->l + 1);
 /******************************************************************************
  * *
  *这块代码的主要目的是：释放一个zbx_jsonpath_token_t结构体类型的内存空间。在这个结构体中，包含了一个指向数据的指针（data）和一个指向该结构体的指针（token）。通过这两个指针，我们可以知道这个结构体在内存中的位置。在程序运行过程中，如果不再需要这个结构体，我们可以调用这个函数来释放它所占用的内存，以避免内存泄漏。
@@ -445,12 +414,11 @@ static zbx_jsonpath_token_t	*jsonpath_create_token(int type, const char *express
  *6. 函数没有返回值，说明它是一个无返回值的函数。
  ******************************************************************************/
 // 定义一个静态函数，用于释放zbx_jsonpath_token_t结构体类型的内存空间
-static void	jsonpath_token_free(zbx_jsonpath_token_t *token)
-{
+			break;
+		default:
+			token->data = NULL;
 	// 释放token指向的数据内存空间
-	zbx_free(token->data);
 	// 释放token本身所占用的内存空间
-	zbx_free(token);
 }
 
 	return token;
@@ -520,96 +488,74 @@ static void jsonpath_reserve(zbx_jsonpath_t *jsonpath, int num)
  * 输入参数：const char **pNext，指向下一个组件的指针。
  * 返回值：int，成功则返回 SUCCEED，出错则返回 zbx_jsonpath_error。
  */
-static int	jsonpath_next(const char **pNext)
-{
+				(jsonpath->segments_alloc - old_alloc) * sizeof(zbx_jsonpath_segment_t));
 	/* 定义两个指针，next 用于指向当前组件，start 用于保存当前组件的开始位置 */
-	const char	*next = *pNext, *start;
 
 	/* 处理点表示法组件 */
-	if ('.' == *next)
-	{
 		/* 跳过点字符 */
-		next++;
 
 		/* 检查下一个字符是否为空字符，如果是，则返回错误 */
-		if ('\0' == *(++next))
-			return zbx_jsonpath_error(*pNext);
 
 		/* 检查下一个字符是否为['，如果不是，则返回错误 */
-		if ('[' != *next)
-		{
-			start = next;
 
 			/* 遍历下一个字符，直到遇到非字母、数字或下划线字符 */
-			while (0 != isalnum((unsigned char)*next) || '_' == *next)
-				next++;
 
 			/* 如果 start 等于 next，则表示路径错误 */
-			if (start == next)
-				return zbx_jsonpath_error(*pNext);
 
 			/* 更新指针指向 */
-			*pNext = next;
-			return SUCCEED;
 		}
 	}
 
 	/* 检查下一个字符是否为['，如果不是，则返回错误 */
-	if ('[' != *next)
-		return zbx_jsonpath_error(*pNext);
+static void	jsonpath_segment_clear(zbx_jsonpath_segment_t *segment)
 
 	/* 跳过空白字符 */
-	SKIP_WHITESPACE_NEXT(next);
 
 	/* 处理数组索引组件 */
-	if (0 != isdigit((unsigned char)*next))
 	{
-		size_t	pos;
+	switch (segment->type)
+	{
+		case ZBX_JSONPATH_SEGMENT_MATCH_LIST:
+			jsonpath_list_free(segment->data.list.values);
+			break;
+		case ZBX_JSONPATH_SEGMENT_MATCH_EXPRESSION:
+			zbx_vector_ptr_clear_ext(&segment->data.expression.tokens,
+					(zbx_clean_func_t)jsonpath_token_free);
+			zbx_vector_ptr_destroy(&segment->data.expression.tokens);
+			break;
+		default:
+			break;
 
 		/* 遍历下一个字符，直到遇到数字字符 */
-		for (pos = 1; 0 != isdigit((unsigned char)next[pos]); pos++)
-			;
 
 		/* 更新指针指向 */
-		next += pos;
 
 		/* 跳过空白字符 */
-		SKIP_WHITESPACE(next);
 	}
-	else
-	{
 		/* 检查下一个字符是否为单引号或双引号，如果不是，则返回错误 */
-		char	quotes;
 
-		if ('\'' != *next && '"' != *next)
-			return zbx_jsonpath_error(*pNext);
 
-		start = next;
 
 		/* 遍历下一个字符，直到遇到引号字符 */
-		for (quotes = *next++; quotes != *next; next++)
-		{
 			/* 检查下一个字符是否为空字符 */
-			if ('\0' == *next)
-				return zbx_jsonpath_error(*pNext);
 		}
 
 		/* 如果 start 等于 next，则表示路径错误 */
-		if (start == next)
-			return zbx_jsonpath_error(*pNext);
+static int	jsonpath_next(const char **pnext)
+{
+	const char	*next = *pnext, *start;
 
 		/* 跳过空白字符 */
-		SKIP_WHITESPACE_NEXT(next);
-	}
+	if ('.' == *next)
+	{
+		if ('\0' == *(++next))
+			return zbx_jsonpath_error(*pnext);
 
 	/* 检查下一个字符是否为']'，如果不是，则返回错误 */
-	if (']' != *next++)
-		return zbx_jsonpath_error(*pNext);
+		if ('[' != *next)
+		{
 
 	/* 更新指针指向 */
-	*pNext = next;
-	return SUCCEED;
-}
 
 			start = next;
 
@@ -710,10 +656,8 @@ static int	jsonpath_parse_substring(const char *start, int *len)
 		{
 			// 判断后续字符是否为双引号或反斜杠
 			if (quotes != ptr[1] && '\\' != ptr[1] )
-			{
 				// 解析失败，返回FAIL
 				return FAIL;
-			}
 			// 跳过后续的字符
 			ptr++;
 		}
@@ -766,10 +710,52 @@ static int	jsonpath_parse_path(const char *start, int *len)
 			return FAIL;
 	}
 
+	*len = ptr - start;
+	return SUCCEED;
+}
 /******************************************************************************
  * *
  *这个函数的主要目的是解析 JSON 路径表达式中的下一个 token。输入参数包括 JSON 路径表达式、当前解析位置、上一个 token 的类型，输出参数包括下一个 token 的类型和位置。函数通过逐个字符地检查输入字符串，根据不同的字符匹配相应的 token 类型，并更新解析位置。如果遇到错误，函数将返回错误码。
  ******************************************************************************/
+static int	jsonpath_parse_number(const char *start, int *len)
+{
+	const char	*ptr = start;
+	char		*end;
+	int		size;
+	double		tmp;
+
+	if ('-' == *ptr || '+' == *ptr)
+		ptr++;
+
+	if (FAIL == zbx_number_parse(ptr, &size))
+		return FAIL;
+
+	ptr += size;
+
+	if ('e' == *ptr || 'E' == *ptr)
+	{
+		ptr++;
+
+		if ('-' == *ptr || '+' == *ptr)
+			ptr++;
+
+		if (0 == isdigit((unsigned char)*ptr))
+			return FAIL;
+
+		while (0 != isdigit((unsigned char)*ptr))
+			ptr++;
+	}
+
+	errno = 0;
+	tmp = strtod(start, &end);
+
+	if (ptr != end || HUGE_VAL == tmp || -HUGE_VAL == tmp || EDOM == errno)
+		return FAIL;
+
+	*len = (int)(ptr - start);
+
+	return SUCCEED;
+}
 /* 定义一个函数，用于解析 JSON 路径表达式中的下一个 token
  * 输入：
  *   expression - JSON 路径表达式字符串
@@ -856,154 +842,107 @@ static int jsonpath_expression_next_token(const char *expression, int pos, int p
                     return SUCCEED;
             }
             // 默认情况下，视为单个等于运算符 '='
-            break;
         // 小于运算符 '<'
-        case '<':
-            if ('=' == ptr[1])
-            {
-                *type = ZBX_JSONPATH_TOKEN_OP_LE;
-                loc->r = loc->l + 1;
-                return SUCCEED;
-            }
-            *type = ZBX_JSONPATH_TOKEN_OP_LT;
-            loc->r = loc->l;
-            return SUCCEED;
         // 大于运算符 '>'
-        case '>':
-            if ('=' == ptr[1])
-            {
-                *type = ZBX_JSONPATH_TOKEN_OP_GE;
-                loc->r = loc->l + 1;
-                return SUCCEED;
-            }
-            *type = ZBX_JSONPATH_TOKEN_OP_GT;
-            loc->r = loc->l;
-            return SUCCEED;
         // 逻辑或运算符 '|'
-        case '|':
             // 检查是否为连续的逻辑或运算符 '||'
-            if ('|' == ptr[1])
-            {
-                *type = ZBX_JSONPATH_TOKEN_OP_OR;
-                loc->r = loc->l + 1;
-                return SUCCEED;
-            }
             // 默认情况下，视为单个逻辑或运算符 '|'
-            break;
         // 逻辑与运算符 '&'
-        case '&':
             // 检查是否为连续的逻辑与运算符 '&&'
-            if ('&' == ptr[1])
-            {
-                *type = ZBX_JSONPATH_TOKEN_OP_AND;
-                loc->r = loc->l + 1;
-                return SUCCEED;
-            }
             // 默认情况下，视为单个逻辑与运算符 '&'
-            break;
         // 路径分隔符 '@'
-        case '@':
             // 检查是否为相对路径分隔符 '@'
-            if (SUCCEED == jsonpath_parse_path(ptr, &len))
-            {
-                *type = ZBX_JSONPATH_TOKEN_PATH_RELATIVE;
-                loc->r = loc->l + len - 1;
-                return SUCCEED;
-            }
             // 默认情况下，视为单个路径分隔符 '@'
-            break;
         // 路径起始符 '$'
-        case '$':
             // 检查是否为绝对路径分隔符 '$'
-            if (SUCCEED == jsonpath_parse_path(ptr, &len))
-            {
-                *type = ZBX_JSONPATH_TOKEN_PATH_ABSOLUTE;
-                loc->r = loc->l + len - 1;
-                return SUCCEED;
-            }
             // 默认情况下，视为单个路径起始符 '$'
-            break;
         // 单引号或双引号字符
-        case '\'':
-        case '"':
             // 检查是否为字符串常量 '\" 或 \'
-            if (SUCCEED == jsonpath_parse_substring(ptr, &len))
-            {
-                *type = ZBX_JSONPATH_TOKEN_CONST_STR;
-                loc->r = loc->l + len - 1;
-                return SUCCEED;
-            }
             // 默认情况下，视为单个引号字符 '\' 或 '"'
-            break;
         // 数字字符
-        case '-':
-        case '0'...'9':
             // 检查是否为数字常量
-            if (SUCCEED == jsonpath_parse_number(ptr, &len))
-            {
-                *type = ZBX_JSONPATH_TOKEN_CONST_NUM;
-                loc->r = loc->l + len - 1;
-                return SUCCEED;
-            }
             // 默认情况下，视为单个数字字符
-            break;
-        default:
             // 解析失败，返回错误码
-            return zbx_jsonpath_error(ptr);
-    }
 
     // 如果到达此处，说明未找到匹配的 token
-    return zbx_jsonpath_error(ptr);
-}
 
-			loc->r = loc->l;
-			return SUCCEED;
-		case '-':
-			if (ZBX_JSONPATH_TOKEN_GROUP_OPERAND == prev_group)
+			goto out;
+		case '<':
+			if ('=' == ptr[1])
 			{
-				*type = ZBX_JSONPATH_TOKEN_OP_MINUS;
-				loc->r = loc->l;
+				*type = ZBX_JSONPATH_TOKEN_OP_LE;
+				loc->r = loc->l + 1;
 				return SUCCEED;
 			}
-			break;
-		case '/':
-			*type = ZBX_JSONPATH_TOKEN_OP_DIV;
-			loc->r = loc->l;
-			return SUCCEED;
-		case '*':
-			*type = ZBX_JSONPATH_TOKEN_OP_MULT;
+			*type = ZBX_JSONPATH_TOKEN_OP_LT;
 			loc->r = loc->l;
 			return SUCCEED;
-		case '!':
+		case '>':
 			if ('=' == ptr[1])
 			{
-				*type = ZBX_JSONPATH_TOKEN_OP_NE;
+				*type = ZBX_JSONPATH_TOKEN_OP_GE;
 				loc->r = loc->l + 1;
 				return SUCCEED;
 			}
-			*type = ZBX_JSONPATH_TOKEN_OP_NOT;
+			*type = ZBX_JSONPATH_TOKEN_OP_GT;
 			loc->r = loc->l;
 			return SUCCEED;
-		case '=':
-			switch (ptr[1])
+		case '|':
+			if ('|' == ptr[1])
 			{
-				case '=':
-					*type = ZBX_JSONPATH_TOKEN_OP_EQ;
-					loc->r = loc->l + 1;
-					return SUCCEED;
-				case '~':
-					*type = ZBX_JSONPATH_TOKEN_OP_REGEXP;
-					loc->r = loc->l + 1;
-					return SUCCEED;
+				*type = ZBX_JSONPATH_TOKEN_OP_OR;
+				loc->r = loc->l + 1;
+				return SUCCEED;
 			}
 			goto out;
-		case '<':
-			if ('=' == ptr[1])
+		case '&':
+			if ('&' == ptr[1])
 			{
-				*type = ZBX_JSONPATH_TOKEN_OP_LE;
+				*type = ZBX_JSONPATH_TOKEN_OP_AND;
 				loc->r = loc->l + 1;
 				return SUCCEED;
 			}
+			goto out;
+		case '@':
+			if (SUCCEED == jsonpath_parse_path(ptr, &len))
+			{
+				*type = ZBX_JSONPATH_TOKEN_PATH_RELATIVE;
+				loc->r = loc->l + len - 1;
+				return SUCCEED;
+			}
+			goto out;
+
+		case '$':
+			if (SUCCEED == jsonpath_parse_path(ptr, &len))
+			{
+				*type = ZBX_JSONPATH_TOKEN_PATH_ABSOLUTE;
+				loc->r = loc->l + len - 1;
+				return SUCCEED;
+			}
+			goto out;
+		case '\'':
+		case '"':
+			if (SUCCEED == jsonpath_parse_substring(ptr, &len))
+			{
+				*type = ZBX_JSONPATH_TOKEN_CONST_STR;
+				loc->r = loc->l + len - 1;
+				return SUCCEED;
+			}
+			goto out;
+	}
+
+	if ('-' == *ptr || 0 != isdigit((unsigned char)*ptr))
+	{
+		if (SUCCEED == jsonpath_parse_number(ptr, &len))
+		{
+			*type = ZBX_JSONPATH_TOKEN_CONST_NUM;
+			loc->r = loc->l + len - 1;
+			return SUCCEED;
+		}
+	}
+out:
+	return zbx_jsonpath_error(ptr);
+}
 /******************************************************************************
  * 以下是对代码块的详细中文注释：
  *
@@ -1080,12 +1019,19 @@ static int	jsonpath_parse_expression(const char *expression, zbx_jsonpath_t *jso
 				ZBX_JSONPATH_TOKEN_GROUP_OPERATOR1 == jsonpath_token_group(token_type))
 		{
 			// 二元操作符必须跟随在一个操作数后面
-			if (ZBX_JSONPATH_TOKEN_GROUP_OPERAND != prev_group)
+			if (ZBX_JSONPATH_TOKEN_GROUP_OPERATOR2 == jsonpath_token_group(token_type) &&
+					ZBX_JSONPATH_TOKEN_GROUP_OPERAND != prev_group)
 			{
 				zbx_jsonpath_error(expression + loc.l);
-				goto out;
+				goto cleanup;
 			}
 
+			if (ZBX_JSONPATH_TOKEN_OP_NOT == token_type &&
+					ZBX_JSONPATH_TOKEN_GROUP_OPERAND == prev_group)
+			{
+				zbx_jsonpath_error(expression + loc.l);
+				goto cleanup;
+			}
 			// 遍历操作符向量，找到优先级最高的操作符
 			for (; 0 < operators.values_num; operators.values_num--)
 			{
@@ -1128,101 +1074,35 @@ static int	jsonpath_parse_expression(const char *expression, zbx_jsonpath_t *jso
 			if (ZBX_JSONPATH_TOKEN_GROUP_OPERAND != prev_group)
 			{
 				zbx_jsonpath_error(expression + loc.l);
-				goto out;
-			}
 
 			// 遍历操作符向量，找到第一个左括号
-			for (optoken = 0; 0 < operators.values_num; operators.values_num--)
-			{
-				if (ZBX_JSONPATH_TOKEN_PAREN_LEFT == operators.values[operators.values_num - 1]->type)
-				{
 					// 释放找到的左括号对应的操作符
-					zbx_vector_ptr_remove(operators, operators.values_num - 1);
-					prev_group = jsonpath_token_group(operators.values[operators.values_num - 1]->type);
-					break;
-				}
-			}
 
 			// 添加右括号到输出向量中
-			zbx_vector_ptr_append(&output, jsonpath_create_token(token_type, expression, &loc));
 
 			// 添加右括号到操作符向量中
-			zbx_vector_ptr_append(&operators, jsonpath_create_token(token_type, expression, &loc));
-			prev_group = jsonpath_token_group(token_type);
-			continue;
-		}
-	}
 
-out:
 	// 解析成功，保存解析结果
-	if (SUCCEED == ret)
-	{
-		zbx_jsonpath_segment_t	*segment;
 
-		for (optoken = 0; 0 < operators.values_num; operators.values_num--)
-		{
 			// 释放操作符向量中的所有元素
-			zbx_vector_ptr_clear_ext(&operators, (zbx_clean_func_t)jsonpath_token_free);
-			break;
-		}
 
 		// 创建解析结果的 segment
-		jsonpath_reserve(jsonpath, 1);
-		segment = &jsonpath->segments[jsonpath->segments_num++];
-		segment->type = ZBX_JSONPATH_SEGMENT_MATCH_EXPRESSION;
-		zbx_vector_ptr_create(&segment->data.expression.tokens);
-		zbx_vector_ptr_append_array(&segment->data.expression.tokens, output.values, output.values_num);
 
-		jsonpath->definite = 0;
-	}
 
-cleanup:
 	// 清理资源
-	if (SUCCEED != ret)
-	{
 		// 释放操作符向量中的所有元素
-		zbx_vector_ptr_clear_ext(&operators, (zbx_clean_func_t)jsonpath_token_free);
 		// 释放输出向量中的所有元素
-		zbx_vector_ptr_clear_ext(&output, (zbx_clean_func_t)jsonpath_token_free);
-	}
 
 	// 销毁操作符向量
-	zbx_vector_ptr_destroy(&operators);
 	// 销毁输出向量
-	zbx_vector_ptr_destroy(&output);
 
-	return ret;
-}
 
-						jsonpath_token_precedence(token_type))
-				{
-					break;
-				}
 
-				if (ZBX_JSONPATH_TOKEN_PAREN_LEFT == optoken->type)
-					break;
 
-				zbx_vector_ptr_append(&output, optoken);
-			}
 
-			zbx_vector_ptr_append(&operators, jsonpath_create_token(token_type, expression, &loc));
-			prev_group = jsonpath_token_group(token_type);
-			continue;
-		}
 
-		if (ZBX_JSONPATH_TOKEN_PAREN_LEFT == token_type)
-		{
-			zbx_vector_ptr_append(&operators, jsonpath_create_token(token_type, expression, &loc));
-			prev_group = ZBX_JSONPATH_TOKEN_GROUP_NONE;
-			continue;
-		}
 
-		if (ZBX_JSONPATH_TOKEN_PAREN_RIGHT == token_type)
-		{
 			/* right parenthesis must follow and operand or right parenthesis */
-			if (ZBX_JSONPATH_TOKEN_GROUP_OPERAND != prev_group)
-			{
-				zbx_jsonpath_error(expression + loc.l);
 				goto cleanup;
 			}
 
@@ -1380,6 +1260,60 @@ static int	jsonpath_parse_names(const char *list, zbx_jsonpath_t *jsonpath, cons
 			case '\\':
 				if (NULL == start || ('\\' != end[1] && *start != end[1]))
 				{
+					ret = zbx_jsonpath_error(end);
+					goto out;
+				}
+				end++;
+				break;
+			case ' ':
+			case '\t':
+				break;
+			case ',':
+				if (NULL != start)
+					break;
+
+				if (0 == parsed_name)
+				{
+					ret = zbx_jsonpath_error(end);
+					goto out;
+				}
+				parsed_name = 0;
+				break;
+			case '\0':
+				ret = zbx_jsonpath_error(end);
+				goto out;
+			default:
+				if (NULL == start)
+				{
+					ret = zbx_jsonpath_error(end);
+					goto out;
+				}
+		}
+	}
+
+	if (0 == parsed_name)
+	{
+		ret = zbx_jsonpath_error(end);
+		goto out;
+	}
+
+	segment = &jsonpath->segments[jsonpath->segments_num++];
+	segment->type = ZBX_JSONPATH_SEGMENT_MATCH_LIST;
+	segment->data.list.type = ZBX_JSONPATH_LIST_NAME;
+	segment->data.list.values = head;
+
+	if (NULL != head->next)
+		jsonpath->definite = 0;
+
+	head = NULL;
+	*next = end;
+	ret = SUCCEED;
+out:
+	if (NULL != head)
+		jsonpath_list_free(head);
+
+	return ret;
+}
 					/* 报错 */
 /******************************************************************************
  * *
@@ -1418,7 +1352,7 @@ static int jsonpath_parse_indexes(const char *list, zbx_jsonpath_t *jsonpath, co
 			if (NULL != start)
 			{
 				// 如果起始位置遇到 '-'，则报错并退出
-				ret = zbx_jsonpath_error(start);
+				ret = zbx_jsonpath_error(end);
 				goto out;
 			}
 			start = end;
@@ -1486,106 +1420,30 @@ static int jsonpath_parse_indexes(const char *list, zbx_jsonpath_t *jsonpath, co
 			type = ZBX_JSONPATH_SEGMENT_MATCH_LIST;
 			parsed_index = 0;
 		}
-		else if (' ' != *end && '\	' != *end)
-		{
 			// 如果遇到非空白字符，则报错并退出
-			ret = zbx_jsonpath_error(end);
-			goto out;
-		}
-	}
 
 	// 创建一个新的分段，并初始化分段类型、索引和标志位
-	segment = &jsonpath->segments[jsonpath->segments_num++];
 
 	// 如果类型为范围匹配，则构建分段数据
-	if (ZBX_JSONPATH_SEGMENT_MATCH_RANGE == type)
-	{
-		node = head;
 
-		segment->type = ZBX_JSONPATH_SEGMENT_MATCH_RANGE;
-		segment->data.range.flags = flags;
 		// 如果索引2被设置，则更新分段结束位置
-		if (0 != (flags & 0x02))
-		{
-			memcpy(&segment->data.range.end, node->data, sizeof(int));
-			node = node->next;
-		}
-		else
-			segment->data.range.end = 0;
 
 		// 如果索引1被设置，则更新分段起始位置
-		if (0 != (flags & 0x01))
-			memcpy(&segment->data.range.start, node->data, sizeof(int));
-		else
-			segment->data.range.start = 0;
 
 		// 如果解析到的索引大于1，则分段类型为不确定的范围匹配
-		jsonpath->definite = 0;
-	}
-	else
-	{
 		// 如果类型为列表匹配，则构建分段数据
-		segment->type = ZBX_JSONPATH_SEGMENT_MATCH_LIST;
-		segment->data.list.type = ZBX_JSONPATH_LIST_INDEX;
-		segment->data.list.values = head;
 
 		// 如果列表中有多个节点，则分段类型为不确定的列表匹配
-		if (NULL != head->next)
-			jsonpath->definite = 0;
 
 		// 释放列表节点内存
-		head = NULL;
-	}
 
 	// 返回解析成功的状态码
-	*next = end;
-	ret = SUCCEED;
 
-out:
 	// 释放分段内存
-	if (NULL != head)
-		jsonpath_list_free(head);
 
-	return ret;
-}
 
 
-		if (']' == *end)
-		{
-			if (ZBX_JSONPATH_SEGMENT_MATCH_RANGE != type)
-			{
-				if (0 == parsed_index)
-				{
-					ret = zbx_jsonpath_error(end);
-					goto out;
-				}
-			}
-			else
-				flags |= (parsed_index << 1);
-			break;
-		}
 
-		if (':' == *end)
-		{
-			if (ZBX_JSONPATH_SEGMENT_UNKNOWN != type)
-			{
-				ret = zbx_jsonpath_error(end);
-				goto out;
-			}
-			type = ZBX_JSONPATH_SEGMENT_MATCH_RANGE;
-			flags |= parsed_index;
-			parsed_index = 0;
-		}
-		else if (',' == *end)
-		{
-			if (ZBX_JSONPATH_SEGMENT_MATCH_RANGE == type || 0 == parsed_index)
-			{
-				ret = zbx_jsonpath_error(end);
-				goto out;
-			}
-			type = ZBX_JSONPATH_SEGMENT_MATCH_LIST;
-			parsed_index = 0;
-		}
 		else if (' ' != *end && '\t' != *end)
 		{
 			ret = zbx_jsonpath_error(end);
@@ -1709,6 +1567,14 @@ static int	jsonpath_parse_bracket_segment(const char *start, zbx_jsonpath_t *jso
 		// 跳过开头空白字符
 		SKIP_WHITESPACE(ptr);
 
+		if (']' != *ptr)
+			return zbx_jsonpath_error(ptr);
+
+		*next = ptr + 1;
+	}
+
+	return ret;
+}
 		// 如果当前字符不是右括号 ']'
 /******************************************************************************
  * *
@@ -1787,34 +1653,9 @@ static int	jsonpath_parse_dot_segment(const char *start, zbx_jsonpath_t *jsonpat
 	return zbx_jsonpath_error(start);
 }
 
-			else if (ZBX_CONST_STRLEN("length") == ptr - start && 0 == strncmp(start, "length", ptr - start))
-				segment->data.function.type = ZBX_JSONPATH_FUNCTION_LENGTH;
-			else if (ZBX_CONST_STRLEN("first") == ptr - start && 0 == strncmp(start, "first", ptr - start))
-				segment->data.function.type = ZBX_JSONPATH_FUNCTION_FIRST;
-			else if (ZBX_CONST_STRLEN("sum") == ptr - start && 0 == strncmp(start, "sum", ptr - start))
-				segment->data.function.type = ZBX_JSONPATH_FUNCTION_SUM;
-			else
-				return zbx_jsonpath_error(start);
 
-			segment->type = ZBX_JSONPATH_SEGMENT_FUNCTION;
-			*next = end + 1;
-			return SUCCEED;
-		}
-	}
 
-	if (0 < (len = ptr - start))
-	{
-		segment->type = ZBX_JSONPATH_SEGMENT_MATCH_LIST;
-		segment->data.list.type = ZBX_JSONPATH_LIST_NAME;
-		segment->data.list.values = jsonpath_list_create_node(len + 1);
-		zbx_strlcpy(segment->data.list.values->data, start, len + 1);
-		segment->data.list.values->next = NULL;
-		*next = start + len;
-		return SUCCEED;
-	}
 
-	return zbx_jsonpath_error(start);
-}
 
 /******************************************************************************
  *                                                                            *
@@ -1861,23 +1702,10 @@ static int	jsonpath_parse_name_reference(const char *start, zbx_jsonpath_t *json
  *这块代码的主要目的是处理JSON路径指针与解析器的关系。首先，检查指针pNext的第一个字符，如果是'['或'{'，则调用zbx_json_brackets_open函数处理括号开启的情况。如果不是，则设置解析器的起始和结束位置，并返回成功码。
  ******************************************************************************/
 // 定义一个静态函数，用于处理JSON路径指针和解析器的关系
-static int	jsonpath_pointer_to_jp(const char *pNext， struct zbx_json_parse *jp)
-{
 	// 检查指针pNext的第一个字符，如果是'['或'{'，则执行以下操作
-	if ('[' == *pNext || '{' == *pNext)
-	{
 		// 调用zbx_json_brackets_open函数处理括号开启的情况，并返回结果
-		return zbx_json_brackets_open(pNext， jp);
-	}
-	else
-	{
 		// 否则，设置解析器的起始和结束位置
-		jp->start = pNext;
-		jp->end = pNext + json_parse_value(pNext， NULL) - 1;
 		// 返回成功码
-		return SUCCEED;
-	}
-}
 
 static int	jsonpath_pointer_to_jp(const char *pnext, struct zbx_json_parse *jp)
 {
@@ -1922,19 +1750,19 @@ static int	jsonpath_pointer_to_jp(const char *pnext, struct zbx_json_parse *jp)
  *该函数使用switch语句判断下一个字符是大括号（表示对象开始）还是中括号（表示数组开始），然后递归调用`jsonpath_query_object`或`jsonpath_query_array`函数处理子对象或子数组。如果遇到其他情况，直接返回成功。在整个过程中，如果遇到错误情况（如开启大括号或中括号失败），则返回失败。
  ******************************************************************************/
 // 定义一个静态函数，用于查询JSON数据的内容
-static int	jsonpath_query_contents(const struct zbx_json_parse *jp_root, const char *pNext,
+static int	jsonpath_query_contents(const struct zbx_json_parse *jp_root, const char *pnext,
 		const zbx_jsonpath_t *jsonpath, int path_depth, zbx_vector_json_t *objects)
 {
 	// 定义一个结构体变量，用于存储子JSON解析对象
 	struct zbx_json_parse	jp_child;
 
 	// 使用switch语句判断下一个字符是什么类型
-	switch (*pNext)
+	switch (*pnext)
 	{
 		// 如果是大括号'{'，则执行以下操作
 		case '{':
 			// 调用zbx_json_brackets_open函数，开启大括号，并将结果存储在jp_child中
-			if (FAIL == zbx_json_brackets_open(pNext, &jp_child))
+			if (FAIL == zbx_json_brackets_open(pnext, &jp_child))
 				// 如果开启失败，返回FAIL
 				return FAIL;
 
@@ -1943,17 +1771,16 @@ static int	jsonpath_query_contents(const struct zbx_json_parse *jp_root, const c
 		// 如果是中括号'[',则执行以下操作
 		case '[':
 			// 调用zbx_json_brackets_open函数，开启中括号，并将结果存储在jp_child中
-			if (FAIL == zbx_json_brackets_open(pNext, &jp_child))
+			if (FAIL == zbx_json_brackets_open(pnext, &jp_child))
 				// 如果开启失败，返回FAIL
 				return FAIL;
 
 			// 调用jsonpath_query_array函数，递归处理子数组
 			return jsonpath_query_array(jp_root, &jp_child, jsonpath, path_depth, objects);
 		// 其他情况下，直接返回成功
-		default:
+	}
 			return SUCCEED;
 	}
-}
 
 
 /******************************************************************************
@@ -1989,7 +1816,7 @@ static int	jsonpath_query_contents(const struct zbx_json_parse *jp_root, const c
  *   成功：SUCCEED
  *   失败：FAIL
  */
-static int	jsonpath_query_next_segment(const struct zbx_json_parse *jp_root, const char *name, const char *pNext,
+static int	jsonpath_query_next_segment(const struct zbx_json_parse *jp_root, const char *name, const char *pnext,
 		const zbx_jsonpath_t *jsonpath, int path_depth, zbx_vector_json_t *objects)
 {
 	/* 检查是否已经到达 JSON 路径的末尾，即找到了匹配的数据
@@ -1998,12 +1825,12 @@ static int	jsonpath_query_next_segment(const struct zbx_json_parse *jp_root, con
 	if (++path_depth == jsonpath->segments_num ||
 			ZBX_JSONPATH_SEGMENT_FUNCTION == jsonpath->segments[path_depth].type)
 	{
-		zbx_vector_json_add_element(objects, name, pNext);
+		zbx_vector_json_add_element(objects, name, pnext);
 		return SUCCEED;
 	}
 
 	/* 继续通过匹配已找到的数据 against 剩余的 JSON 路径段落 */
-	return jsonpath_query_contents(jp_root, pNext, jsonpath, path_depth, objects);
+	return jsonpath_query_contents(jp_root, pnext, jsonpath, path_depth, objects);
 }
 
 
@@ -2012,7 +1839,7 @@ static int	jsonpath_query_next_segment(const struct zbx_json_parse *jp_root, con
  *这块代码的主要目的是用于匹配JSON路径中的名称。函数`jsonpath_match_name`接收一系列参数，其中`jsonpath`是指向JSON路径的结构体指针，`path_depth`表示当前路径深度，`objects`是一个指向对象列表的指针。函数遍历当前路径深的名称列表，如果名称匹配成功，则继续查询下一个路径段。如果匹配过程中出现错误，返回FAIL。否则，匹配成功后返回SUCCEED。
  ******************************************************************************/
 // 定义一个函数，用于匹配JSON路径中的名称
-static int	jsonpath_match_name(const struct zbx_json_parse *jp_root, const char *name, const char *pNext,
+static int	jsonpath_match_name(const struct zbx_json_parse *jp_root, const char *name, const char *pnext,
                               const zbx_jsonpath_t *jsonpath, int path_depth, zbx_vector_json_t *objects)
 {
 	// 获取当前路径深度对应的JSON路径段
@@ -2030,26 +1857,12 @@ static int	jsonpath_match_name(const struct zbx_json_parse *jp_root, const char
 		if (0 == strcmp(name, node->data))
 		{
 			// 匹配成功，继续查询下一个路径段
-			if (FAIL == jsonpath_query_next_segment(jp_root, name, pNext, jsonpath, path_depth, objects))
-				return FAIL;
-			break;
-		}
-	}
 
 	// 匹配成功，返回SUCCEED
-	return SUCCEED;
-}
 
-	const zbx_jsonpath_list_node_t	*node;
 
 	/* object contents can match only name list */
-	if (ZBX_JSONPATH_LIST_NAME != segment->data.list.type)
-		return SUCCEED;
 
-	for (node = segment->data.list.values; NULL != node; node = node->next)
-	{
-		if (0 == strcmp(name, node->data))
-		{
 			if (FAIL == jsonpath_query_next_segment(jp_root, name, pnext, jsonpath, path_depth, objects))
 				return FAIL;
 			break;
@@ -2087,9 +1900,8 @@ static int	jsonpath_extract_value(const struct zbx_json_parse *jp, const char *p
 	// 定义一个名为 jp_child 的 zbx_json_parse 结构实例，用于保存子节点信息。
 	struct zbx_json_parse	jp_child;
 	// 定义一个字符串指针 data，用于存储提取到的数据。
-	char			*data = NULL;
+	char			*data = NULL, *tmp_path = NULL;
 	// 定义一个字符串指针 tmp_path，用于存储路径的临时副本。
-	char			*tmp_path = NULL;
 	// 定义 data_alloc 变量，表示 data 内存分配的大小。
 	size_t			data_alloc = 0;
 	// 定义一个整型变量 ret，用于表示函数执行结果。
@@ -2148,15 +1960,14 @@ static char *jsonpath_expression_to_str(zbx_jsonpath_expression_t *expression)
 {
 	// 定义一个整型变量i，用于循环遍历expression中的各个token
 	int i;
+	char			*str = NULL;
+	size_t			str_alloc = 0, str_offset = 0;
 
 	// 定义一个字符串指针str，初始值为NULL
-	char *str = NULL;
 
 	// 定义一个大小为0的字符串分配大小变量str_alloc
-	size_t str_alloc = 0;
 
 	// 定义一个初始值为0的字符串偏移量变量str_offset
-	size_t str_offset = 0;
 
 	// 使用for循环遍历expression中的所有token
 	for (i = 0; i < expression->tokens.values_num; i++)
@@ -2173,15 +1984,60 @@ static char *jsonpath_expression_to_str(zbx_jsonpath_expression_t *expression)
 		{
 			// 如果是绝对路径、相对路径、常量字符串或常量数字，直接将其转换为字符串并添加到str中
 			case ZBX_JSONPATH_TOKEN_PATH_ABSOLUTE:
+				ZBX_FALLTHROUGH;
 			case ZBX_JSONPATH_TOKEN_PATH_RELATIVE:
+				ZBX_FALLTHROUGH;
 			case ZBX_JSONPATH_TOKEN_CONST_STR:
+				ZBX_FALLTHROUGH;
 			case ZBX_JSONPATH_TOKEN_CONST_NUM:
 				zbx_strcpy_alloc(&str, &str_alloc, &str_offset, token->data);
 				break;
+			case ZBX_JSONPATH_TOKEN_PAREN_LEFT:
+				zbx_strcpy_alloc(&str, &str_alloc, &str_offset, "(");
+				break;
+			case ZBX_JSONPATH_TOKEN_PAREN_RIGHT:
+				zbx_strcpy_alloc(&str, &str_alloc, &str_offset, ")");
+				break;
 			// 如果是运算符，将其转换为字符串并添加到str中
 			case ZBX_JSONPATH_TOKEN_OP_PLUS:
 				zbx_strcpy_alloc(&str, &str_alloc, &str_offset, "+");
 				break;
+			case ZBX_JSONPATH_TOKEN_OP_MINUS:
+				zbx_strcpy_alloc(&str, &str_alloc, &str_offset, "-");
+				break;
+			case ZBX_JSONPATH_TOKEN_OP_MULT:
+				zbx_strcpy_alloc(&str, &str_alloc, &str_offset, "*");
+				break;
+			case ZBX_JSONPATH_TOKEN_OP_DIV:
+				zbx_strcpy_alloc(&str, &str_alloc, &str_offset, "/");
+				break;
+			case ZBX_JSONPATH_TOKEN_OP_EQ:
+				zbx_strcpy_alloc(&str, &str_alloc, &str_offset, "==");
+				break;
+			case ZBX_JSONPATH_TOKEN_OP_NE:
+				zbx_strcpy_alloc(&str, &str_alloc, &str_offset, "!=");
+				break;
+			case ZBX_JSONPATH_TOKEN_OP_GT:
+				zbx_strcpy_alloc(&str, &str_alloc, &str_offset, ">");
+				break;
+			case ZBX_JSONPATH_TOKEN_OP_GE:
+				zbx_strcpy_alloc(&str, &str_alloc, &str_offset, ">=");
+				break;
+			case ZBX_JSONPATH_TOKEN_OP_LT:
+				zbx_strcpy_alloc(&str, &str_alloc, &str_offset, "<");
+				break;
+			case ZBX_JSONPATH_TOKEN_OP_LE:
+				zbx_strcpy_alloc(&str, &str_alloc, &str_offset, "<=");
+				break;
+			case ZBX_JSONPATH_TOKEN_OP_NOT:
+				zbx_strcpy_alloc(&str, &str_alloc, &str_offset, "!");
+				break;
+			case ZBX_JSONPATH_TOKEN_OP_AND:
+				zbx_strcpy_alloc(&str, &str_alloc, &str_offset, "&&");
+				break;
+			case ZBX_JSONPATH_TOKEN_OP_OR:
+				zbx_strcpy_alloc(&str, &str_alloc, &str_offset, "||");
+				break;
 			// ...（省略其他运算符）
 			case ZBX_JSONPATH_TOKEN_OP_REGEXP:
 				zbx_strcpy_alloc(&str, &str_alloc, &str_offset, "=~");
@@ -2354,72 +2210,277 @@ static int	jsonpath_regexp_match(const char *text, const char *pattern, double *
 	return SUCCEED;
 }
 
-
-/******************************************************************************
- *                                                                            *
-/******************************************************************************
- * 这
- ******************************************************************************/段C代码的主要目的是实现对JSON路径表达式的解析和计算。该函数名为`jsonpath_match_expression`，接收七个参数，分别是：
-
-1. `jsonpath_match_expression`函数解析`const struct zbx_json_parse *jp_root`，这是JSON解析结构体的指针。
-2. `const char *name`是表达式中使用的变量名。
-3. `const char *pNext`是表达式中的下一个字符串。
-4. `const zbx_jsonpath_t *jsonpath`是JSON路径表达式的指针。
-5. `int path_depth`表示路径深度。
-6. `zbx_vector_json_t *objects`是一个指向对象列表的指针。
-
-函数首先检查输入参数是否有效，然后创建一个名为`stack`的变量栈用于存储中间结果。接下来，遍历路径表达式中的每个字符串，根据不同的字符类型进行相应的操作。
-
-主要逻辑如下：
-
-1. 遍历表达式中的每个操作符，根据操作符的类型进行相应的计算。例如，对于加法操作，将两个栈中的数值相加，并将结果存储在栈中。
-2. 当遇到绝对路径或相对路径时，根据路径提取值并将其添加到栈中。
-3. 当遇到常量字符串或数字时，将其添加到栈中。
-4. 当遇到否定操作时，对栈顶元素进行否定操作，并将结果存储在栈中。
-
-在表达式解析完成后，将栈中的结果进行计算，得到最终结果。如果计算结果为非零值，说明表达式计算成功。否则，返回失败。
-
-整个函数的目的是解析和计算给定的JSON路径表达式，并返回计算结果。在解析和计算过程中，使用了递归调用的方式实现。
-	{
-		jsonpath_set_expression_error(&segment->data.expression);
-		goto out;
-	}
-
-	jsonpath_variant_to_boolean(&stack.values[0]);
-	if (SUCCEED != zbx_double_compare(stack.values[0].data.dbl, 0.0))
-		ret = jsonpath_query_next_segment(jp_root, name, pnext, jsonpath, path_depth, objects);
-out:
-	for (i = 0; i < stack.values_num; i++)
-		zbx_variant_clear(&stack.values[i]);
-	zbx_vector_var_destroy(&stack);
-
-	return ret;
-}
-
 /******************************************************************************
  *                                                                            *
- * Function: jsonpath_query_object                                            *
+ * Function: jsonpath_match_expression                                        *
  *                                                                            *
- * Purpose: query object fields for jsonpath segment match                    *
+ * Purpose: match json array element/object value against jsonpath expression *
  *                                                                            *
  * Parameters: jp_root    - [IN] the document root                            *
- *             jp         - [IN] the json object to query                     *
+ *             name       - [IN] name or index of the next json element       *
+ *             pnext      - [IN] a pointer to array element/object value      *
  *             jsonpath   - [IN] the jsonpath                                 *
  *             path_depth - [IN] the jsonpath segment to match                *
  *             objects    - [OUT] the matched json elements (name, value)     *
  *                                                                            *
- * Return value: SUCCEED - the object was queried successfully                *
+ * Return value: SUCCEED - no errors, failed match is not an error            *
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-static int	jsonpath_query_object(const struct zbx_json_parse *jp_root, const struct zbx_json_parse *jp,
-		const zbx_jsonpath_t *jsonpath, int path_depth, zbx_vector_json_t *objects)
-{
-	const char			*pnext = NULL;
-	char				name[MAX_STRING_LEN];
-	const zbx_jsonpath_segment_t	*segment;
-	int				ret = SUCCEED;
-
+/******************************************************************************
+ * *
+ *这段C代码的主要目的是实现对JSON路径表达式的解析和计算。该函数名为`jsonpath_match_expression`，接收七个参数，分别是：
+ *
+ *1. `jsonpath_match_expression`函数解析`const struct zbx_json_parse *jp_root`，这是JSON解析结构体的指针。
+ *2. `const char *name`是表达式中使用的变量名。
+ *3. `const char *pNext`是表达式中的下一个字符串。
+ *4. `const zbx_jsonpath_t *jsonpath`是JSON路径表达式的指针。
+ *5. `int path_depth`表示路径深度。
+ *6. `zbx_vector_json_t *objects`是一个指向对象列表的指针。
+ *
+ *函数首先检查输入参数是否有效，然后创建一个名为`stack`的变量栈用于存储中间结果。接下来，遍历路径表达式中的每个字符串，根据不同的字符类型进行相应的操作。
+ *
+ *主要逻辑如下：
+ *
+ *1. 遍历表达式中的每个操作符，根据操作符的类型进行相应的计算。例如，对于加法操作，将两个栈中的数值相加，并将结果存储在栈中。
+ *2. 当遇到绝对路径或相对路径时，根据路径提取值并将其添加到栈中。
+ *3. 当遇到常量字符串或数字时，将其添加到栈中。
+ *4. 当遇到否定操作时，对栈顶元素进行否定操作，并将结果存储在栈中。
+ *
+ *在表达式解析完成后，将栈中的结果进行计算，得到最终结果。如果计算结果为非零值，说明表达式计算成功。否则，返回失败。
+ *
+ *整个函数的目的是解析和计算给定的JSON路径表达式，并返回计算结果。在解析和计算过程中，使用了递归调用的方式实现。
+ ******************************************************************************/
+static int	jsonpath_match_expression(const struct zbx_json_parse *jp_root, const char *name, const char *pnext,
+		const zbx_jsonpath_t *jsonpath, int path_depth, zbx_vector_json_t *objects)
+{
+	struct zbx_json_parse	jp;
+	zbx_vector_var_t	stack;
+	int			i, ret = SUCCEED;
+	zbx_jsonpath_segment_t	*segment;
+	zbx_variant_t		value, *right;
+	double			res;
+
+	if (SUCCEED != jsonpath_pointer_to_jp(pnext, &jp))
+		return FAIL;
+
+	zbx_vector_var_create(&stack);
+
+	segment = &jsonpath->segments[path_depth];
+
+	for (i = 0; i < segment->data.expression.tokens.values_num; i++)
+	{
+		zbx_variant_t		*left;
+		zbx_jsonpath_token_t	*token = (zbx_jsonpath_token_t *)segment->data.expression.tokens.values[i];
+
+		if (ZBX_JSONPATH_TOKEN_GROUP_OPERATOR2 == jsonpath_token_group(token->type))
+		{
+			if (2 > stack.values_num)
+			{
+				jsonpath_set_expression_error(&segment->data.expression);
+				ret = FAIL;
+				goto out;
+			}
+
+			left = &stack.values[stack.values_num - 2];
+			right = &stack.values[stack.values_num - 1];
+
+			switch (token->type)
+			{
+				case ZBX_JSONPATH_TOKEN_OP_PLUS:
+					zbx_variant_convert(left, ZBX_VARIANT_DBL);
+					zbx_variant_convert(right, ZBX_VARIANT_DBL);
+					left->data.dbl += right->data.dbl;
+					stack.values_num--;
+					break;
+				case ZBX_JSONPATH_TOKEN_OP_MINUS:
+					zbx_variant_convert(left, ZBX_VARIANT_DBL);
+					zbx_variant_convert(right, ZBX_VARIANT_DBL);
+					left->data.dbl -= right->data.dbl;
+					stack.values_num--;
+					break;
+				case ZBX_JSONPATH_TOKEN_OP_MULT:
+					zbx_variant_convert(left, ZBX_VARIANT_DBL);
+					zbx_variant_convert(right, ZBX_VARIANT_DBL);
+					left->data.dbl *= right->data.dbl;
+					stack.values_num--;
+					break;
+				case ZBX_JSONPATH_TOKEN_OP_DIV:
+					zbx_variant_convert(left, ZBX_VARIANT_DBL);
+					zbx_variant_convert(right, ZBX_VARIANT_DBL);
+					left->data.dbl /= right->data.dbl;
+					stack.values_num--;
+					break;
+				case ZBX_JSONPATH_TOKEN_OP_EQ:
+					res = (0 == zbx_variant_compare(left, right) ? 1.0 : 0.0);
+					zbx_variant_clear(left);
+					zbx_variant_clear(right);
+					zbx_variant_set_dbl(left, res);
+					stack.values_num--;
+					break;
+				case ZBX_JSONPATH_TOKEN_OP_NE:
+					res = (0 != zbx_variant_compare(left, right) ? 1.0 : 0.0);
+					zbx_variant_clear(left);
+					zbx_variant_clear(right);
+					zbx_variant_set_dbl(left, res);
+					stack.values_num--;
+					break;
+				case ZBX_JSONPATH_TOKEN_OP_GT:
+					res = (0 < zbx_variant_compare(left, right) ? 1.0 : 0.0);
+					zbx_variant_clear(left);
+					zbx_variant_clear(right);
+					zbx_variant_set_dbl(left, res);
+					stack.values_num--;
+					break;
+				case ZBX_JSONPATH_TOKEN_OP_GE:
+					res = (0 <= zbx_variant_compare(left, right) ? 1.0 : 0.0);
+					zbx_variant_clear(left);
+					zbx_variant_clear(right);
+					zbx_variant_set_dbl(left, res);
+					stack.values_num--;
+					break;
+				case ZBX_JSONPATH_TOKEN_OP_LT:
+					res = (0 > zbx_variant_compare(left, right) ? 1.0 : 0.0);
+					zbx_variant_clear(left);
+					zbx_variant_clear(right);
+					zbx_variant_set_dbl(left, res);
+					stack.values_num--;
+					break;
+				case ZBX_JSONPATH_TOKEN_OP_LE:
+					res = (0 >= zbx_variant_compare(left, right) ? 1.0 : 0.0);
+					zbx_variant_clear(left);
+					zbx_variant_clear(right);
+					zbx_variant_set_dbl(left, res);
+					stack.values_num--;
+					break;
+				case ZBX_JSONPATH_TOKEN_OP_AND:
+					jsonpath_variant_to_boolean(left);
+					jsonpath_variant_to_boolean(right);
+					if (SUCCEED != zbx_double_compare(left->data.dbl, 0.0) &&
+							SUCCEED != zbx_double_compare(right->data.dbl, 0.0))
+					{
+						res = 1.0;
+					}
+					else
+						res = 0.0;
+					zbx_variant_set_dbl(left, res);
+					zbx_variant_clear(right);
+					stack.values_num--;
+					break;
+				case ZBX_JSONPATH_TOKEN_OP_OR:
+					jsonpath_variant_to_boolean(left);
+					jsonpath_variant_to_boolean(right);
+					if (SUCCEED != zbx_double_compare(left->data.dbl, 0.0) ||
+							SUCCEED != zbx_double_compare(right->data.dbl, 0.0))
+					{
+						res = 1.0;
+					}
+					else
+						res = 0.0;
+					zbx_variant_set_dbl(left, res);
+					zbx_variant_clear(right);
+					stack.values_num--;
+					break;
+				case ZBX_JSONPATH_TOKEN_OP_REGEXP:
+					zbx_variant_convert(left, ZBX_VARIANT_STR);
+					zbx_variant_convert(right, ZBX_VARIANT_STR);
+					ret = jsonpath_regexp_match(left->data.str, right->data.str, &res);
+					zbx_variant_clear(left);
+					zbx_variant_clear(right);
+
+					if (FAIL == ret)
+						goto out;
+
+					zbx_variant_set_dbl(left, res);
+					stack.values_num--;
+					break;
+				default:
+					break;
+			}
+			continue;
+		}
+
+		switch (token->type)
+		{
+			case ZBX_JSONPATH_TOKEN_PATH_ABSOLUTE:
+				if (FAIL == jsonpath_extract_value(jp_root, token->data, &value))
+					zbx_variant_set_none(&value);
+				zbx_vector_var_append_ptr(&stack, &value);
+				break;
+			case ZBX_JSONPATH_TOKEN_PATH_RELATIVE:
+				/* relative path can be applied only to array or object */
+				if ('[' != *jp.start && '{' != *jp.start)
+					goto out;
+
+				if (FAIL == jsonpath_extract_value(&jp, token->data, &value))
+					zbx_variant_set_none(&value);
+				zbx_vector_var_append_ptr(&stack, &value);
+				break;
+			case ZBX_JSONPATH_TOKEN_CONST_STR:
+				zbx_variant_set_str(&value, zbx_strdup(NULL, token->data));
+				zbx_vector_var_append_ptr(&stack, &value);
+				break;
+			case ZBX_JSONPATH_TOKEN_CONST_NUM:
+				zbx_variant_set_dbl(&value, atof(token->data));
+				zbx_vector_var_append_ptr(&stack, &value);
+				break;
+			case ZBX_JSONPATH_TOKEN_OP_NOT:
+				if (1 > stack.values_num)
+				{
+					jsonpath_set_expression_error(&segment->data.expression);
+					ret = FAIL;
+					goto out;
+				}
+				right = &stack.values[stack.values_num - 1];
+				jsonpath_variant_to_boolean(right);
+				right->data.dbl = 1 - right->data.dbl;
+				break;
+			default:
+				break;
+		}
+	}
+
+	if (1 != stack.values_num)
+	{
+		jsonpath_set_expression_error(&segment->data.expression);
+		goto out;
+	}
+
+	jsonpath_variant_to_boolean(&stack.values[0]);
+	if (SUCCEED != zbx_double_compare(stack.values[0].data.dbl, 0.0))
+		ret = jsonpath_query_next_segment(jp_root, name, pnext, jsonpath, path_depth, objects);
+out:
+	for (i = 0; i < stack.values_num; i++)
+		zbx_variant_clear(&stack.values[i]);
+	zbx_vector_var_destroy(&stack);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: jsonpath_query_object                                            *
+ *                                                                            *
+ * Purpose: query object fields for jsonpath segment match                    *
+ *                                                                            *
+ * Parameters: jp_root    - [IN] the document root                            *
+ *             jp         - [IN] the json object to query                     *
+ *             jsonpath   - [IN] the jsonpath                                 *
+ *             path_depth - [IN] the jsonpath segment to match                *
+ *             objects    - [OUT] the matched json elements (name, value)     *
+ *                                                                            *
+ * Return value: SUCCEED - the object was queried successfully                *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	jsonpath_query_object(const struct zbx_json_parse *jp_root, const struct zbx_json_parse *jp,
+		const zbx_jsonpath_t *jsonpath, int path_depth, zbx_vector_json_t *objects)
+{
+	const char			*pnext = NULL;
+	char				name[MAX_STRING_LEN];
+	const zbx_jsonpath_segment_t	*segment;
+	int				ret = SUCCEED;
+
 	segment = &jsonpath->segments[path_depth];
 
 	while (NULL != (pnext = zbx_json_pair_next(jp, pnext, name, sizeof(name))) && SUCCEED == ret)
@@ -2470,7 +2531,7 @@ static int	jsonpath_query_object(const struct zbx_json_parse *jp_root, const str
  *整个代码块的主要目的是实现一个名为 `jsonpath_match_index` 的函数，用于在给定的 JSON 解析结构中匹配指定的索引。该函数接收多个参数，包括 JSON 解析结构、名称、下一个指针、JSON 路径、路径深度、索引、元素数量和对象向量。在匹配成功后，继续查询下一个路径段。如果匹配过程中出现错误，返回失败。
  ******************************************************************************/
 // 定义一个函数，用于匹配 JSON 路径中的索引
-static int	jsonpath_match_index(const struct zbx_json_parse *jp_root, const char *name, const char *pNext,
+static int	jsonpath_match_index(const struct zbx_json_parse *jp_root, const char *name, const char *pnext,
 		const zbx_jsonpath_t *jsonpath, int path_depth, int index, int elements_num, zbx_vector_json_t *objects)
 {
 	// 获取当前路径深度对应的 JSON 路径段
@@ -2493,7 +2554,7 @@ static int	jsonpath_match_index(const struct zbx_json_parse *jp_root, const char
 		if ((query_index >= 0 && index == query_index) || index == elements_num + query_index)
 		{
 			// 如果查询下一个路径段失败，返回失败
-			if (FAIL == jsonpath_query_next_segment(jp_root, name, pNext, jsonpath, path_depth, objects))
+			if (FAIL == jsonpath_query_next_segment(jp_root, name, pnext, jsonpath, path_depth, objects))
 				return FAIL;
 			// 匹配成功，跳出循环
 			break;
@@ -2516,9 +2577,8 @@ static int	jsonpath_match_index(const struct zbx_json_parse *jp_root, const char
  *整个代码块的主要目的是实现一个C语言函数，该函数用于匹配JSON路径范围。该函数接收多个参数，包括JSON解析结构体、名称、下一个路径段、JSON路径结构体、路径深度、当前索引、元素数量和一个对象列表。函数首先计算范围的开始和结束索引，然后判断当前索引是否在范围内。如果在范围内，则继续匹配下一个路径段。如果匹配成功，返回SUCCEED，否则返回FAIL。
  ******************************************************************************/
 // 定义一个函数，用于匹配JSON路径范围
-static int jsonpath_match_range(const struct zbx_json_parse *jp_root, const char *name, const char *pNext,
-                              const zbx_jsonpath_t *jsonpath, int path_depth, int index, int elements_num,
-                              zbx_vector_json_t *objects)
+static int	jsonpath_match_range(const struct zbx_json_parse *jp_root, const char *name, const char *pnext,
+        const zbx_jsonpath_t *jsonpath, int path_depth, int index, int elements_num, zbx_vector_json_t *objects)
 {
     // 定义两个整数变量start_index和end_index，用于存储范围的开始和结束索引
     int start_index, end_index;
@@ -2540,95 +2600,72 @@ static int jsonpath_match_range(const struct zbx_json_parse *jp_root, const char
     if (start_index <= index && end_index > index)
     {
         // 如果下一个路径段查询成功，则继续匹配下一个路径段
-        if (FAIL == jsonpath_query_next_segment(jp_root, name, pNext, jsonpath, path_depth, objects))
-            return FAIL;
-    }
 
     // 匹配成功，返回SUCCEED
-    return SUCCEED;
-}
 
-	if (0 > start_index)
-		start_index += elements_num;
-	if (0 > end_index)
-		end_index += elements_num;
 
-	if (start_index <= index && end_index > index)
-	{
 		if (FAIL == jsonpath_query_next_segment(jp_root, name, pnext, jsonpath, path_depth, objects))
 			return FAIL;
 	}
 
+	return SUCCEED;
+}
 /******************************************************************************
  * *
  *整个代码块的主要目的是实现一个 JSON 路径查询函数。该函数接收多个参数，包括 JSON 解析根对象、JSON 解析对象、JSON 路径对象、路径深度和对象容器。函数根据 JSON 路径中的段落类型，递归处理每个段落，直到遍历完整个 JSON 对象。在处理过程中，会对不同类型的段落进行相应的操作，如匹配所有、匹配列表和匹配表达式等。最后，将处理结果返回。
  ******************************************************************************/
 // 定义一个静态函数，用于处理 JSON 路径查询对象
-static int	jsonpath_query_object(const struct zbx_json_parse *jp_root, const struct zbx_json_parse *jp,
+static int	jsonpath_query_array(const struct zbx_json_parse *jp_root, const struct zbx_json_parse *jp,
                                  const zbx_jsonpath_t *jsonpath, int path_depth, zbx_vector_json_t *objects)
 {
 	// 初始化变量
-	const char			*pNext = NULL;
-	char				name[MAX_STRING_LEN];
-	const zbx_jsonpath_segment_t	*segment;
-	int				ret = SUCCEED;
+	const char		*pnext = NULL;
+	int			index = 0, elements_num = 0, ret = SUCCEED;
+	zbx_jsonpath_segment_t	*segment;
 
 	// 获取当前路径的段落
 	segment = &jsonpath->segments[path_depth];
 
 	// 遍历 JSON 对象中的键值对
-	while (NULL != (pNext = zbx_json_pair_next(jp, pNext, name, sizeof(name))) && SUCCEED == ret)
+	while (NULL != (pnext = zbx_json_next(jp, pnext)))
+		elements_num++;
+
+	while (NULL != (pnext = zbx_json_next(jp, pnext)) && SUCCEED == ret)
 	{
+		char	name[MAX_ID_LEN + 1];
+
+		zbx_snprintf(name, sizeof(name), "%d", index);
 		// 根据段落类型进行不同操作
 		switch (segment->type)
 		{
 			case ZBX_JSONPATH_SEGMENT_MATCH_ALL:
 				// 匹配所有类型，递归处理下一个段落
-				ret = jsonpath_query_next_segment(jp_root, name, pNext, jsonpath, path_depth, objects);
+				ret = jsonpath_query_next_segment(jp_root, name, pnext, jsonpath, path_depth, objects);
 				break;
 			case ZBX_JSONPATH_SEGMENT_MATCH_LIST:
 				// 匹配列表类型，处理 name 对应的键值对
-				ret = jsonpath_match_name(jp_root, name, pNext, jsonpath, path_depth, objects);
-				break;
-			case ZBX_JSONPATH_SEGMENT_MATCH_EXPRESSION:
+				ret = jsonpath_match_index(jp_root, name, pnext, jsonpath, path_depth, index,
 				// 匹配表达式类型，处理 name 对应的键值对
-				ret = jsonpath_match_expression(jp_root, name, pNext, jsonpath, path_depth, objects);
-				break;
-			default:
 				// 默认情况下，不进行任何操作
-				break;
-		}
 
 		// 如果当前段落是 detached 状态，则查询其内容
-		if (1 == segment->detached)
-			ret = jsonpath_query_contents(jp_root, pNext, jsonpath, path_depth, objects);
-	}
 
 	// 返回处理结果
-	return ret;
-}
 
 
 		// 根据段落类型执行不同操作
-		switch (segment->type)
-		{
-			case ZBX_JSONPATH_SEGMENT_MATCH_ALL:
 				// 查询下一个段落
-				ret = jsonpath_query_next_segment(jp_root, name, pNext, jsonpath, path_depth, objects);
-				break;
-			case ZBX_JSONPATH_SEGMENT_MATCH_LIST:
 				// 匹配索引
-				ret = jsonpath_match_index(jp_root, name, pNext, jsonpath, path_depth, index,
 						elements_num, objects);
 				break;
 			case ZBX_JSONPATH_SEGMENT_MATCH_RANGE:
 				// 匹配范围
-				ret = jsonpath_match_range(jp_root, name, pNext, jsonpath, path_depth, index,
+				ret = jsonpath_match_range(jp_root, name, pnext, jsonpath, path_depth, index,
 						elements_num, objects);
 				break;
 			case ZBX_JSONPATH_SEGMENT_MATCH_EXPRESSION:
 				// 匹配表达式
-				ret = jsonpath_match_expression(jp_root, name, pNext, jsonpath, path_depth, objects);
+				ret = jsonpath_match_expression(jp_root, name, pnext, jsonpath, path_depth, objects);
 				break;
 			default:
 				break;
@@ -2636,22 +2673,12 @@ static int	jsonpath_query_object(const struct zbx_json_parse *jp_root, const str
 
 		// 如果段落是分离的，查询其内容
 		if (1 == segment->detached)
-			ret = jsonpath_query_contents(jp_root, pNext, jsonpath, path_depth, objects);
 
 		// 更新索引
-		index++;
-	}
 
 	// 返回操作结果
-	return ret;
-}
 
-				break;
-			default:
-				break;
-		}
 
-		if (1 == segment->detached)
 			ret = jsonpath_query_contents(jp_root, pnext, jsonpath, path_depth, objects);
 
 		index++;
@@ -2793,7 +2820,7 @@ static int	jsonpath_apply_function(const zbx_vector_json_t *objects, zbx_jsonpat
 	{
 		if (0 == objects->values_num)
 		{
-			zbx_set_json_strerror("cannot extract name from empty result");
+			zbx_set_json_strerror("cannot extract name from empty result"); // 不能从空结果中提取名称
 			goto out;
 		}
 
@@ -2830,7 +2857,7 @@ static int	jsonpath_apply_function(const zbx_vector_json_t *objects, zbx_jsonpat
 		{
 			/* all functions can be applied only to arrays        */
 			/* attempt to apply a function to non-array will fail */
-			zbx_set_json_strerror("cannot apply function to non-array JSON element");
+			zbx_set_json_strerror("cannot apply function to non-array JSON element"); // 不能对非数组JSON元素应用函数
 			goto out;
 		}
 
@@ -2883,104 +2910,47 @@ static int	jsonpath_apply_function(const zbx_vector_json_t *objects, zbx_jsonpat
  *13. 返回操作结果。
  ******************************************************************************/
 /* 定义一个C语言函数，用于处理JSON路径应用函数操作 */
-static int	jsonpath_apply_function(const zbx_vector_json_t *objects, zbx_jsonpath_function_type_t type,
-		int definite_path, char **output)
-{
+		if (0 < objects->values_num)
+			ret = jsonpath_extract_element(objects->values[0].value, output);
 	/* 定义变量，用于循环遍历 */
-	int			i;
-	int			ret = FAIL;
-	zbx_vector_json_t	objects_tmp;
-	double			result;
 
 	/* 创建一个临时对象数组 */
-	zbx_vector_json_create(&objects_tmp);
 
 	/* 判断操作类型，如果是取名字，则执行以下操作 */
-	if (ZBX_JSONPATH_FUNCTION_NAME == type)
-	{
-		if (0 == objects->values_num)
-		{
-			zbx_set_json_strerror("不能从空结果中提取名称");
-			goto out;
-		}
 
 		/* 对于确定的路径，我们只有一个输出值，所以返回其名称。 */
 		/* 否则返回所有输出元素名称。 */
-		if (0 == definite_path)
-		{
-			struct zbx_json	j;
 
 			/* 为输出json预留一些空间，1k足够满足大多数查询 */
-			zbx_json_initarray(&j, 1024);
-			for (i = 0; i < objects->values_num; i++)
-				zbx_json_addstring(&j, NULL, objects->values[i].name, ZBX_JSON_TYPE_STRING);
 
-			zbx_json_close(&j);
-			*output = zbx_strdup(NULL, j.buffer);
-			zbx_json_clean(&j);
-		}
 		else
-			*output = zbx_strdup(NULL, objects->values[0].name);
 
 		ret = SUCCEED;
 		goto out;
 	}
 
 	/* 将确定的路径结果转换为对象数组（如果可能） */
-	if (0 != definite_path)
-	{
-		const char		*pNext;
-		struct zbx_json_parse	jp;
-		int			index = 0;
 
 		/* 检查对象数组是否可以应用函数操作 */
-		if (0 == objects->values_num || '[' != *objects->values[0].value)
-		{
 			/* 所有函数只能应用于数组 */
 			/* 尝试对非数组JSON元素应用函数失败 */
-			zbx_set_json_strerror("不能对非数组JSON元素应用函数");
-			goto out;
-		}
 
 		/* 打开JSON括号 */
-		if (FAIL == zbx_json_brackets_open(objects->values[0].value, &jp))
-			goto out;
 
 		/* 遍历括号内的所有元素 */
-		for (pNext = NULL; NULL != (pNext = zbx_json_next(&jp, pNext));)
-		{
-			char	name[MAX_ID_LEN + 1];
 
 			/* 为输出元素名称预留空间 */
-			zbx_snprintf(name, sizeof(name), "%d", index++);
-			zbx_vector_json_add_element(&objects_tmp, name, pNext);
-		}
 
-		objects = &objects_tmp;
-	}
 
 	/* 处理不同类型的函数操作 */
-	if (ZBX_JSONPATH_FUNCTION_LENGTH == type)
-	{
-		*output = zbx_dsprintf(NULL, "%d", objects->values_num);
-		ret = SUCCEED;
-		goto out;
-	}
 
-	if (ZBX_JSONPATH_FUNCTION_FIRST == type)
-	{
 		/* 如果对象数组不为空，则执行提取操作 */
-		ret = jsonpath_extract_element(objects->values[0].value, output);
-		if (SUCCEED != ret)
-			goto out;
 
-		goto out;
-	}
 
 	/* 处理聚合函数操作，如求和、平均值等 */
 	if (0 == objects->values_num)
 	{
-		zbx_set_json_strerror("应用于空数组的聚合函数");
+		zbx_set_json_strerror("cannot apply aggregation function to empty array"); // 应用于空数组的聚合函数
 		goto out;
 	}
 
@@ -3023,7 +2993,7 @@ static int	jsonpath_apply_function(const zbx_vector_json_t *objects, zbx_jsonpat
 	*output = zbx_dsprintf(NULL, ZBX_FS_DBL, result);
 	if (SUCCEED != is_double(*output, NULL))
 	{
-		zbx_set_json_strerror("无效的函数结果：%s"， *output);
+		zbx_set_json_strerror("invalid function result: %s", *output); // 无效的函数结果
 		goto out;
 	}
 	del_zeros(*output);
@@ -3038,6 +3008,41 @@ out:
 	return ret;
 }
 
+static int	jsonpath_apply_functions(const struct zbx_json_parse *jp_root, const zbx_vector_json_t *objects,
+		const zbx_jsonpath_t *jsonpath, int path_depth, char **output)
+{
+	int			ret, definite_path;
+	zbx_vector_json_t	input;
+	char			*input_json = NULL;
+
+	zbx_vector_json_create(&input);
+
+	/* when functions are applied directly to the json document (at the start of the jsonpath ) */
+	/* it makes all document as input object                                                    */
+	if (0 == path_depth)
+		zbx_vector_json_add_element(&input, "", jp_root->start);
+	else
+		zbx_vector_json_copy(&input, objects);
+
+	definite_path = jsonpath->definite;
+
+	for (;;)
+	{
+		ret = jsonpath_apply_function(&input, jsonpath->segments[path_depth++].data.function.type,
+				definite_path, output);
+
+		zbx_vector_json_clear_ext(&input);
+		zbx_free(input_json);
+
+		if (SUCCEED != ret || path_depth == jsonpath->segments_num)
+			break;
+
+		if (NULL != *output)
+		{
+			zbx_vector_json_add_element(&input, "", *output);
+			input_json = *output;
+			*output = NULL;
+		}
 		definite_path = 1;
 	}
 
@@ -3108,6 +3113,47 @@ static int	jsonpath_format_query_result(const zbx_vector_json_t *objects, zbx_js
 			zbx_set_json_strerror("cannot format query result, unrecognized json part starting with: %s",
 					objects->values[i].value);
 			zbx_free(*output);
+			return FAIL;
+		}
+
+		if (0 != i)
+			zbx_chrcpy_alloc(output, &output_alloc, &output_offset, ',');
+
+		zbx_strncpy_alloc(output, &output_alloc, &output_offset, jp.start, jp.end - jp.start + 1);
+	}
+
+	zbx_chrcpy_alloc(output, &output_alloc, &output_offset, ']');
+
+	return SUCCEED;
+}
+/******************************************************************************
+ * *
+ * Function: zbx_jsonpath_clear                                               *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_jsonpath_clear(zbx_jsonpath_t *jsonpath)
+{
+	int	i;
+
+	for (i = 0; i < jsonpath->segments_num; i++)
+		jsonpath_segment_clear(&jsonpath->segments[i]);
+
+	zbx_free(jsonpath->segments);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_jsonpath_compile                                             *
+ *                                                                            *
+ * Purpose: compile jsonpath to be used in queries                            *
+ *                                                                            *
+ * Parameters: path     - [IN] the path to parse                              *
+ *             jsonpath  - [IN/OUT] the compiled jsonpath                     *
+ *                                                                            *
+ * Return value: SUCCEED - the segment was parsed successfully                *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  * *
  *该代码的主要目的是编译一个 JSONPath 查询字符串，将其转换为内部表示形式，并存储在 `zbx_jsonpath_t` 结构体中。在这个过程中，代码执行了以下操作：
@@ -3219,127 +3265,104 @@ int zbx_jsonpath_compile(const char *path, zbx_jsonpath_t *jsonpath)
 	else
 		zbx_jsonpath_clear(&jpquery);
 
-	return ret;
-}
-
-
-			switch (*ptr)
-			{
-				case '[':
-					prefix = *ptr;
-					break;
-				case '\0':
-				case '.':
-					prefix = 0;
-					break;
-			}
-		}
-
-		switch (prefix)
-		{
-			case '.':
-				ret = jsonpath_parse_dot_segment(ptr, &jpquery, &next);
-				break;
-			case '[':
-				ret = jsonpath_parse_bracket_segment(ptr + 1, &jpquery, &next);
-				break;
-			case '~':
-				ret = jsonpath_parse_name_reference(ptr, &jpquery, &next);
-				break;
-			default:
-				ret = zbx_jsonpath_error(ptr);
-				break;
-		}
-
-		if (SUCCEED != ret)
-			break;
-
-		/* function segments can followed only by function segments */
-		segment_type = jpquery.segments[jpquery.segments_num - 1].type;
-		if (ZBX_JSONPATH_SEGMENT_FUNCTION == last_segment_type && ZBX_JSONPATH_SEGMENT_FUNCTION != segment_type)
-		{
-			ret = zbx_jsonpath_error(ptr);
-			break;
-		}
-		last_segment_type = segment_type;
-	}
-
-	if (SUCCEED == ret && 0 == jpquery.segments_num)
-		ret = zbx_jsonpath_error(ptr);
-
-	if (SUCCEED == ret)
-		*jsonpath = jpquery;
-	else
-		zbx_jsonpath_clear(&jpquery);
-
 	return ret;
 }
 
 /******************************************************************************
  *                                                                            *
- * Function: zbx_jsonpath_query                                               *
+ * Function: zbx_jsonpath_query_precompiled                                   *
  *                                                                            *
- * Purpose: perform jsonpath query on the specified json data                 *
+ * Purpose: perform query of compiled jsonpath on the specified json data     *
  *                                                                            *
- * Parameters: jp     - [IN] the json data                                    *
- *             path   - [IN] the jsonpath                                     *
- *             output - [OUT] the output value                                *
+ * Parameters: jp       - [IN] the json data                                  *
+ *             jsonpath - [IN] the compiled jsonpath                          *
+ *             output   - [OUT] the output value                              *
+ *                                                                            *
+ * Return value: SUCCEED - the query was performed successfully (empty result *
+ *                         being counted as successful query)                 *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: The compiled jsonpath is not modified by query, so it can be     *
+ *           reused to query multiple json documents.                         *
  *                                                                            *
-/******************************************************************************
- * *
- *整个代码块的主要目的是解析一个 JSON 路径查询，并根据查询结果输出对应的 JSON 数据。函数 `zbx_jsonpath_query` 接受三个参数：一个 `zbx_json_parse` 类型的指针 `jp`，一个字符串指针 `path`，以及一个字符指针数组指针 `output`。在函数内部，首先编译 JSON 路径，然后根据路径类型（对象或数组）调用相应的查询函数（`jsonpath_query_object` 或 `jsonpath_query_array`）。查询完成后，根据路径深度执行相应的函数（`jsonpath_apply_functions` 或 `jsonpath_format_query_result`）来处理查询结果，并输出格式化后的 JSON 数据。最后，清除中间变量并返回查询结果。
  ******************************************************************************/
-// 定义一个函数，用于解析 JSON 路径查询
-int zbx_jsonpath_query(const struct zbx_json_parse *jp, const char *path, char **output)
+int	zbx_jsonpath_query_precompiled(const struct zbx_json_parse *jp, zbx_jsonpath_t *jsonpath, char **output)
 {
-	// 定义一个 zbx_jsonpath_t 类型的变量 jsonpath，用于存储编译后的 JSON 路径
 	// 初始化 path_depth 为 0，ret 变量初始化为 SUCCEED
+	int			path_depth = 0, ret = SUCCEED;
 	// 创建一个 zbx_vector_json_t 类型的变量 objects，用于存储查询结果
-
-	// 编译 JSON 路径，若编译失败则返回 FAIL
-	if (FAIL == zbx_jsonpath_compile(path, &jsonpath))
-		return FAIL;
+	zbx_vector_json_t	objects;
 
 	// 创建一个 zbx_vector_json_t 类型的变量 objects
 	zbx_vector_json_create(&objects);
 
 	// 判断输入的字符是否为 '{'，如果是，则执行 jsonpath_query_object 函数
 	if ('{' == *jp->start)
-		ret = jsonpath_query_object(jp, jp, &jsonpath, path_depth, &objects);
+		ret = jsonpath_query_object(jp, jp, jsonpath, path_depth, &objects);
 	// 否则，如果输入的字符为 '[】，则执行 jsonpath_query_array 函数
 	else if ('[' == *jp->start)
-		ret = jsonpath_query_array(jp, jp, &jsonpath, path_depth, &objects);
+		ret = jsonpath_query_array(jp, jp, jsonpath, path_depth, &objects);
 
 	// 如果 ret 为 SUCCEED，则进行以下操作：
 	if (SUCCEED == ret)
 	{
 		// 更新 path_depth 为 jsonpath.segments_num，用于记录当前路径深度
-		path_depth = jsonpath.segments_num;
+		path_depth = jsonpath->segments_num;
 		// 遍历路径深度，直到 path_depth 减至小于 jsonpath.segments_num
-		while (0 < path_depth && ZBX_JSONPATH_SEGMENT_FUNCTION == jsonpath.segments[path_depth - 1].type)
+		while (0 < path_depth && ZBX_JSONPATH_SEGMENT_FUNCTION == jsonpath->segments[path_depth - 1].type)
 			path_depth--;
 
 		// 如果 path_depth 仍然小于 jsonpath.segments_num，则执行 jsonpath_apply_functions 函数
-		if (path_depth < jsonpath.segments_num)
-			ret = jsonpath_apply_functions(jp, &objects, &jsonpath, path_depth, output);
+		if (path_depth < jsonpath->segments_num)
+			ret = jsonpath_apply_functions(jp, &objects, jsonpath, path_depth, output);
 		// 否则，执行 jsonpath_format_query_result 函数，输出查询结果
 		else
-			ret = jsonpath_format_query_result(&objects, &jsonpath, output);
+			ret = jsonpath_format_query_result(&objects, jsonpath, output);
 	}
 
 	// 清除 objects 变量，销毁 objects 结构体
 	zbx_vector_json_clear_ext(&objects);
 	zbx_vector_json_destroy(&objects);
 
-	// 清除 jsonpath 结构体
-	zbx_jsonpath_clear(&jsonpath);
-
 	// 返回 ret 变量，表示查询结果
 	return ret;
 }
 
-	zbx_vector_json_destroy(&objects);
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_jsonpath_query                                               *
+ *                                                                            *
+ * Purpose: perform jsonpath query on the specified json data                 *
+ *                                                                            *
+ * Parameters: jp     - [IN] the json data                                    *
+ *             path   - [IN] the jsonpath                                     *
+ *             output - [OUT] the output value                                *
+ *                                                                            *
+ * Return value: SUCCEED - the query was performed successfully (empty result *
+ *                         being counted as successful query)                 *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+/******************************************************************************
+ * *
+ *整个代码块的主要目的是解析一个 JSON 路径查询，并根据查询结果输出对应的 JSON 数据。函数 `zbx_jsonpath_query` 接受三个参数：一个 `zbx_json_parse` 类型的指针 `jp`，一个字符串指针 `path`，以及一个字符指针数组指针 `output`。在函数内部，首先编译 JSON 路径，然后根据路径类型（对象或数组）调用相应的查询函数（`jsonpath_query_object` 或 `jsonpath_query_array`）。查询完成后，根据路径深度执行相应的函数（`jsonpath_apply_functions` 或 `jsonpath_format_query_result`）来处理查询结果，并输出格式化后的 JSON 数据。最后，清除中间变量并返回查询结果。
+ ******************************************************************************/
+// 定义一个函数，用于解析 JSON 路径查询
+int	zbx_jsonpath_query(const struct zbx_json_parse *jp, const char *path, char **output)
+{
+	// 定义一个 zbx_jsonpath_t 类型的变量 jsonpath，用于存储编译后的 JSON 路径
+	zbx_jsonpath_t	jsonpath;
+	int		ret;
+
+	// 编译 JSON 路径，若编译失败则返回 FAIL
+	if (FAIL == zbx_jsonpath_compile(path, &jsonpath))
+		return FAIL;
+
+	ret = zbx_jsonpath_query_precompiled(jp, &jsonpath, output);
+
+	// 清除 jsonpath 结构体
 	zbx_jsonpath_clear(&jsonpath);
 
+	// 返回 ret 变量，表示查询结果
 	return ret;
 }
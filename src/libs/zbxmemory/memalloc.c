@@ -48,14 +48,8 @@
  *此外，还包括一些辅助函数，如 `ALIGN4`、`ALIGN8`、`ALIGNPTR` 等，用于对指针进行对齐操作。
  ******************************************************************************/
 /* 定义内存块结构体，包含一个连续的内存块，可以是空闲或已使用 */
-typedef struct
-{
-    zbx_uint64_t size;         /* 内存块大小 */
-    zbx_uint64_t flags;        /* 内存块状态，MEM_FLG_USED表示已使用 */
-    void *prev;               /* 指向上一个内存块的指针 */
-    void *next;               /* 指向下一个内存块的指针 */
-} chunk_t;
 
+extern int	CONFIG_CACHE_SLAB_ALLOCATOR;
 /* 内存管理相关函数 */
 static void *ALIGN4(void *ptr);
 static void *ALIGN8(void *ptr);
@@ -81,6 +75,16 @@ static void *__mem_malloc(zbx_mem_info_t *info, zbx_uint64_t size);
 static void *__mem_realloc(zbx_mem_info_t *info, void *old, zbx_uint64_t size);
 static void __mem_free(zbx_mem_info_t *info, void *ptr);
 
+static void	*mem_malloc(zbx_mem_info_t *info, zbx_uint64_t size);
+static void	*mem_slab_malloc(zbx_mem_info_t *info, zbx_uint64_t size);
+static void	*mem_slab_realloc(zbx_mem_info_t *info, void *chunk, zbx_uint64_t size);
+static void	mem_slab_free(zbx_mem_info_t *info, void *chunk);
+#define MEM_SIZE_FIELD		sizeof(zbx_uint64_t)
+
+#define MEM_FLG_USED		((__UINT64_C(1))<<63)
+
+#define FREE_CHUNK(ptr)		(((*(zbx_uint64_t *)(ptr)) & MEM_FLG_USED) == 0)
+#define CHUNK_SIZE(ptr)		((*(zbx_uint64_t *)(ptr)) & ~MEM_FLG_USED)
 /* 内存块最小大小和最大大小 */
 #define MEM_MIN_SIZE		__UINT64_C(128)
 #define MEM_MAX_SIZE		__UINT64_C(0x1000000000)	/* 64 GB */
@@ -93,6 +97,44 @@ static void __mem_free(zbx_mem_info_t *info, void *ptr);
 #define MEM_MAX_BUCKET_SIZE	256 /* 从这个大小开始，所有空闲块将被放入同一个桶中 */
 #define MEM_BUCKET_COUNT	((MEM_MAX_BUCKET_SIZE - MEM_MIN_BUCKET_SIZE) / 8 + 1)
 
+#define MEM_FLG_SLAB		((__UINT64_C(1))<<62)
+
+#define SLAB_OBJECT(ptr)	(((*(zbx_uint64_t *)(ptr)) & MEM_FLG_SLAB) != 0)
+#define SLAB_OFFSET(ptr)	((*(zbx_uint64_t *)(ptr)) & ~(MEM_FLG_USED | MEM_FLG_SLAB))
+
+#define MEM_SLAB_MAX_SIZE	128	/* the largest object allocated from slabs, should be a multiple of 8 */
+#define MEM_SLAB_SIZE		16384	/* the size of slab chunk */
+#define MEM_SLAB_CLASS_COUNT	((MEM_SLAB_MAX_SIZE - MEM_MIN_ALLOC) / 8 + 1)
+#define MEM_SLAB_CLASS_SIZE(index)	(MEM_MIN_ALLOC + 8 * (index))
+#define MEM_SLAB_HEADER_SIZE	((sizeof(mem_slab_t) + 7) & ~(size_t)7)
+
+typedef struct mem_slab
+{
+	struct mem_slab	*prev;
+	struct mem_slab	*next;
+
+	/* the tag of the first free object */
+	void		*free_object;
+
+	/* the number of used and total objects */
+	zbx_uint32_t	used_num;
+	zbx_uint32_t	objects_num;
+
+	/* the size class index */
+	int		index;
+}
+mem_slab_t;
+
+typedef struct
+{
+	/* the slabs having free objects */
+	mem_slab_t	*slabs;
+
+	/* statistics */
+	zbx_uint64_t	slabs_num;
+	zbx_uint64_t	used_num;
+}
+mem_slab_class_t;
 /* 辅助函数 */
 static void *ALIGN4(void *ptr)
 {
@@ -106,128 +148,47 @@ static void *ALIGN8(void *ptr)
 }
 
 /*  aligns the pointer to the nearest multiple of ZBX_PTR_SIZE (4 or 8) */
-static void *ALIGNPTR(void *ptr)
-{
-	return (void *)((uintptr_t)((char *)ptr + (ZBX_PTR_SIZE - 1)) & (uintptr_t)~(ZBX_PTR_SIZE - 1));
-}
 
 /* 设置内存块大小 */
-static void mem_set_chunk_size(void *chunk, zbx_uint64_t size)
-{
-	*(zbx_uint64_t *)chunk = size | MEM_FLG_USED;
-}
 
 /* 设置已使用的内存块大小 */
-static void mem_set_used_chunk_size(void *chunk, zbx_uint64_t size)
-{
-	*(zbx_uint64_t *)chunk = size | MEM_FLG_USED;
-}
 
 /* 获取上一个内存块 */
-static void *mem_get_prev_chunk(void *chunk)
-{
-	return (void *)((char *)chunk - sizeof(zbx_uint64_t));
-}
 
 /* 设置上一个内存块 */
-static void mem_set_prev_chunk(void *chunk, void *prev)
-{
-	void *ptr = (void *)((char *)chunk - sizeof(zbx_uint64_t));
-	*(void **)ptr = prev;
-}
 
 /* 获取下一个内存块 */
-static void *mem_get_next_chunk(void *chunk)
-{
-	return (void *)((char *)chunk + sizeof(zbx_uint64_t));
-}
 
 /* 设置下一个内存块 */
-static void mem_set_next_chunk(void *chunk, void *next)
-{
-	void *ptr = (void *)((char *)chunk + sizeof(zbx_uint64_t));
-	*(void **)ptr = next;
-}
 
 /* 获取内存块大小 */
-static zbx_uint64_t mem_get_chunk_size(void *chunk)
-{
-	return *(zbx_uint64_t *)chunk & ~MEM_FLG_USED;
-}
 
 /* 检查内存块是否为空闲 */
-static bool is_free_chunk(void *chunk)
-{
-	return !(*(zbx_uint64_t *)chunk & MEM_FLG_USED);
-}
 
 /* 内存管理函数 */
-static zbx_mem_info_t *mem_info;
 
 /* 初始化内存管理 */
-void mem_init(void)
-{
-	mem_info = zbx_calloc(1, sizeof(zbx_mem_info_t));
-	mem_info->first_chunk = NULL;
-	mem_info->lo_bound = MEM_MIN_SIZE;
-	mem_info->hi_bound = MEM_MAX_SIZE;
-}
 
 /* 释放内存 */
-void mem_free(void *ptr)
-{
-	if (ptr == NULL)
-		return;
 
-	zbx_free(ptr);
-}
 
 /* 分配内存 */
-void *mem_alloc(zbx_uint64_t size)
-{
-	if (size == 0)
-		return NULL;
 
-	size = mem_proper_alloc_size(size);
 
-	void *ptr = NULL;
 
 	/* 查找合适大小的内存块 */
-	ptr = __mem_find_chunk(mem_info, size);
 
-	if (ptr == NULL)
-	{
-		ptr = __mem_alloc_new_chunk(mem_info, size);
-		if (ptr == NULL)
-			return NULL;
 
 		/* 将新分配的内存块插入到合适的位置 */
-		mem_link_chunk(mem_info, ptr);
-	}
 
-	mem_set_chunk_size(ptr, size);
 
-	return ptr;
-}
 
 /* 重新分配内存 */
-void *mem_realloc(zbx_uint64_t *old_ptr, zbx_uint64_t size)
-{
-	void *new_ptr;
 
-	if (*old_ptr == NULL)
-		return NULL;
 
-	new_ptr = mem_alloc(size);
-	if (new_ptr == NULL)
-		return NULL;
 
-	memcpy(new_ptr, old_ptr, *old_ptr);
 
-	zbx_free(*old_ptr);
 
-	return new_ptr;
-}
 
 
 
@@ -251,27 +212,15 @@ void *mem_realloc(zbx_uint64_t *old_ptr, zbx_uint64_t size)
  * 3. 如果 ZBX_PTR_SIZE 为 8，那么使用 ALIGN8 函数对 void 指针进行 8 字节对齐。
  * 4. 如果 ZBX_PTR_SIZE 既不是 4 也不是 8，那么 assert(0) 触发错误，因为不支持其他对齐值。
  */
-static void *ALIGNPTR(void *ptr)
-{
 	// 判断 ZBX_PTR_SIZE 的值，即指定的大小
-	if (4 == ZBX_PTR_SIZE)
 		// 如果 ZBX_PTR_SIZE 为 4，那么使用 ALIGN4 函数对 void 指针进行 4 字节对齐
-		return ALIGN4(ptr);
-	else if (8 == ZBX_PTR_SIZE)
 		// 如果 ZBX_PTR_SIZE 为 8，那么使用 ALIGN8 函数对 void 指针进行 8 字节对齐
-		return ALIGN8(ptr);
-	else
 		// 如果 ZBX_PTR_SIZE 既不是 4 也不是 8，触发错误
-		assert(0);
 
 	// 以下部分为空，因为已经根据 ZBX_PTR_SIZE 进行了相应的对齐操作，无需其他操作
-}
 
-    uintptr_t aligned_address = (uintptr_t)((char *)ptr + 7) & (uintptr_t)~7;
 
     // 返回对齐后的地址（即 void 类型的指针）
-    return (void *)(aligned_address);
-}
 
 
 static void	*ALIGNPTR(void *ptr)
@@ -290,19 +239,13 @@ static zbx_uint64_t	mem_proper_alloc_size(zbx_uint64_t size)
  *整个代码块的主要目的是分配内存块。其中，`mem_allocate()`函数用于根据用户请求的内存大小进行分配，如果大小可以被8整除，则分配大小加上7，以8字节为最小单位分配内存；否则，返回最小的内存分配大小。`mem_bucket_by_size()`函数用于根据内存大小分配内存块，如果大小在最小内存块大小和最大内存块大小之间，则返回大小除以8的商加1；否则，返回内存块的数量减1，即分配最后一个内存块。
  ******************************************************************************/
 // 定义一个函数，用于分配内存大小
-static int mem_allocate(zbx_uint64_t size)
-{
 	// 判断分配的大小是否大于等于最小的内存分配大小（8字节）
 	if (size >= MEM_MIN_ALLOC)
-	{
 		// 如果大小可以被8整除，则返回大小加上7，以8字节为最小单位分配内存
 		return size + ((8 - (size & 7)) & 7);
-	}
 	// 否则，返回最小的内存分配大小
 	else
-	{
 		return MEM_MIN_ALLOC;
-	}
 }
 
 // 定义一个静态函数，用于根据内存大小分配内存块
@@ -310,16 +253,13 @@ static int mem_bucket_by_size(zbx_uint64_t size)
 {
 	// 判断大小是否小于最小的内存块大小
 	if (size < MEM_MIN_BUCKET_SIZE)
-	{
+		return 0;
+	if (size < MEM_MAX_BUCKET_SIZE)
 		// 如果大小在最小内存块大小和最大内存块大小之间，则返回大小除以8的商加1
 		return (size - MEM_MIN_BUCKET_SIZE) >> 3;
-	}
 	// 否则，返回内存块的数量减1，即分配最后一个内存块
-	else
-	{
 		return MEM_BUCKET_COUNT - 1;
 	}
-}
 
 
 /******************************************************************************
@@ -351,23 +291,17 @@ static void mem_set_used_chunk_size(void *chunk, zbx_uint64_t size)
  *这块代码的主要目的是获取给定内存块（chunk）的前一个块的指针。函数接受一个void类型的指针作为参数，该指针表示一个内存块。通过计算内存块大小字段的位置，获取内存块的大小，然后计算前一个块的起始地址，并返回该地址。
  ******************************************************************************/
 // 定义一个静态函数，用于获取内存块的前一个块的指针
-static void *mem_get_prev_chunk(void *chunk)
 {
     // 转换为字符指针
-    char *char_chunk = (char *)chunk;
+    *(zbx_uint64_t *)chunk = MEM_FLG_USED | size;
 
     // 计算内存块大小字段的位置
-    char *mem_size_field = char_chunk + MEM_SIZE_FIELD;
 
     // 获取内存块大小
-    int mem_size = *(int *)mem_size_field;
 
     // 计算前一个块的起始地址
-    char *prev_chunk = char_chunk - mem_size;
 
     // 返回前一个块的指针
-    return prev_chunk;
-}
 
     *(zbx_uint64_t *)((char *)chunk + MEM_SIZE_FIELD + size) = MEM_FLG_USED | size;
 }
@@ -410,16 +344,13 @@ static void mem_set_prev_chunk(void *chunk, void *prev) // 定义一个名为mem
 static void *mem_get_next_chunk(void *chunk)
 {
     // 转换为字符指针，方便计算偏移量
-    char *char_chunk = (char *)chunk;
+    return *(void **)((char *)chunk + MEM_SIZE_FIELD + ZBX_PTR_SIZE);
 
     // 计算下一个内存块的地址偏移量，偏移量为内存块大小加上指针大小
-    int offset = MEM_SIZE_FIELD + ZBX_PTR_SIZE;
 
     // 获取下一个内存块的地址
-    void *next_chunk = *(void **)((char *)char_chunk + offset);
 
     // 返回下一个内存块的地址
-    return next_chunk;
 }
 
 
@@ -437,6 +368,8 @@ static void mem_set_next_chunk(void *chunk, void *next)
 
 static void	**mem_ptr_to_prev_field(void *chunk)
 {
+	return (NULL != chunk ? (void **)((char *)chunk + MEM_SIZE_FIELD) : NULL);
+}
 /******************************************************************************
  * *
  *整个代码块的主要目的是：提供两个函数，分别用于获取下一个内存块的地址和内存块的大小。这两个函数接收一个 void * 类型的参数 chunk，用于表示当前内存块。通过判断 chunk 是否为 NULL，分别返回下一个内存块的地址和大小。
@@ -445,33 +378,104 @@ static void	**mem_ptr_to_prev_field(void *chunk)
 static void	**mem_ptr_to_next_field(void *chunk, void **first_chunk)
 {
     // 判断 chunk 是否不为 NULL，如果不为 NULL，则计算下一个内存块的地址
-    if (chunk != NULL)
+    return (NULL != chunk ? (void **)((char *)chunk + MEM_SIZE_FIELD + ZBX_PTR_SIZE) : first_chunk);
+}
+
+static void	mem_link_chunk(zbx_mem_info_t *info, void *chunk)
     {
         // 计算下一个内存块的地址，偏移量为 MEM_SIZE_FIELD（内存块大小）加上 ZBX_PTR_SIZE（指针大小）
-        return (void **)((char *)chunk + MEM_SIZE_FIELD + ZBX_PTR_SIZE);
+    int	index;
+
+    index = mem_bucket_by_size(CHUNK_SIZE(chunk));
+
+    if (NULL != info->buckets[index])
+        mem_set_prev_chunk(info->buckets[index], chunk);
+
+    mem_set_prev_chunk(chunk, NULL);
+    mem_set_next_chunk(chunk, info->buckets[index]);
+
+    info->buckets[index] = chunk;
     }
     // 如果 chunk 为 NULL，则返回第一个内存块的地址（即 first_chunk 指向的地址）
-    else
+static void	mem_unlink_chunk(zbx_mem_info_t *info, void *chunk)
     {
-        return first_chunk;
-    }
+    int	index;
+    void	*prev_chunk, *next_chunk;
+    void	**next_in_prev_chunk, **prev_in_next_chunk;
+
+    index = mem_bucket_by_size(CHUNK_SIZE(chunk));
+
+    prev_chunk = mem_get_prev_chunk(chunk);
+    next_chunk = mem_get_next_chunk(chunk);
+
+    next_in_prev_chunk = mem_ptr_to_next_field(prev_chunk, &info->buckets[index]);
+    prev_in_next_chunk = mem_ptr_to_prev_field(next_chunk);
+
+    *next_in_prev_chunk = next_chunk;
+    if (NULL != prev_in_next_chunk)
+        *prev_in_next_chunk = prev_chunk;
 }
 
-// 定义一个函数，用于获取内存块的大小
-void *mem_size_field(void *chunk)
+/* private memory functions */
+
+static void	*__mem_malloc(zbx_mem_info_t *info, zbx_uint64_t size)
 {
-    // 判断 chunk 是否不为 NULL，如果不为 NULL，则返回下一个内存块的大小（即 MEM_SIZE_FIELD 指向的地址）
-    if (chunk != NULL)
-    {
-        return (void *)((char *)chunk + MEM_SIZE_FIELD);
-    }
-    // 如果 chunk 为 NULL，则返回 NULL
-    else
+    int		index;
+    void		*chunk;
+    zbx_uint64_t	chunk_size;
+
+    size = mem_proper_alloc_size(size);
+
+    /* try to find an appropriate chunk in special buckets */
+
+    index = mem_bucket_by_size(size);
+
+    while (index < MEM_BUCKET_COUNT - 1 && NULL == info->buckets[index])
+        index++;
+
+    chunk = info->buckets[index];
+
+    if (index == MEM_BUCKET_COUNT - 1)
     {
-        return NULL;
+        /* otherwise, find a chunk big enough according to first-fit strategy */
+
+        int		counter = 0;
+        zbx_uint64_t	skip_min = __UINT64_C(0xffffffffffffffff), skip_max = __UINT64_C(0);
+
+        while (NULL != chunk && CHUNK_SIZE(chunk) < size)
+        {
+            counter++;
+            skip_min = MIN(skip_min, CHUNK_SIZE(chunk));
+            skip_max = MAX(skip_max, CHUNK_SIZE(chunk));
+            chunk = mem_get_next_chunk(chunk);
+        }
+
+        /* don't log errors if malloc can return null in low memory situations */
+        if (0 == info->allow_oom)
+        {
+            if (NULL == chunk)
+            {
+                zabbix_log(LOG_LEVEL_CRIT, "__mem_malloc: skipped %d asked " ZBX_FS_UI64 " skip_min "
+                        ZBX_FS_UI64 " skip_max " ZBX_FS_UI64,
+                        counter, size, skip_min, skip_max);
+            }
+            else if (counter >= 100)
+            {
+                zabbix_log(LOG_LEVEL_DEBUG, "__mem_malloc: skipped %d asked " ZBX_FS_UI64 " skip_min "
+                        ZBX_FS_UI64 " skip_max " ZBX_FS_UI64 " size " ZBX_FS_UI64, counter,
+                        size, skip_min, skip_max, CHUNK_SIZE(chunk));
+            }
     }
 }
 
+// 定义一个函数，用于获取内存块的大小
+	if (NULL == chunk)
+    // 判断 chunk 是否不为 NULL，如果不为 NULL，则返回下一个内存块的大小（即 MEM_SIZE_FIELD 指向的地址）
+    // 如果 chunk 为 NULL，则返回 NULL
+		return NULL;
+
+	chunk_size = CHUNK_SIZE(chunk);
+	mem_unlink_chunk(info, chunk);
 
 
 /******************************************************************************
@@ -479,12 +483,7 @@ void *mem_size_field(void *chunk)
  *这块代码的主要目的是实现一个动态内存分配函数，根据给定的内存大小需求，在特定内存块中寻找合适的块进行分配。如果找不到合适的大小的块，则记录日志。分配到的内存块可以被分为两个块使用，或者直接使用整个块。
  ******************************************************************************/
 /* 定义一个静态函数，用于动态分配内存 */
-static void *__mem_malloc(zbx_mem_info_t *info, zbx_uint64_t size)
-{
 	/* 定义变量 */
-	int		index;
-	void		*chunk;
-	zbx_uint64_t	chunk_size;
 /******************************************************************************
  * *
  *这个代码块的主要目的是实现一个内存重新分配函数__mem_realloc。该函数接收三个参数：
@@ -507,84 +506,41 @@ static void *__mem_malloc(zbx_mem_info_t *info, zbx_uint64_t size)
  *
  *整个代码块的目标是在保证内存使用效率的前提下，实现对内存的重新分配。
  ******************************************************************************/
-static void *__mem_realloc(zbx_mem_info_t *info, void *old, zbx_uint64_t size)
-{
 	// 定义变量
-	void		*chunk, *new_chunk, *next_chunk;
-	zbx_uint64_t	chunk_size, new_chunk_size;
-	int		next_free;
 
 	// 计算分配内存的大小
-	size = mem_proper_alloc_size(size);
 
 	// 获取chunk的地址和大小
-	chunk = (void *)((char *)old - MEM_SIZE_FIELD);
-	chunk_size = CHUNK_SIZE(chunk);
 
 	// 获取下一个chunk的地址和判断是否可用的标志
-	next_chunk = (void *)((char *)chunk + MEM_SIZE_FIELD + chunk_size + MEM_SIZE_FIELD);
-	next_free = (next_chunk < info->hi_bound && FREE_CHUNK(next_chunk));
 
 	// 如果size小于或等于chunk的大小
-	if (size <= chunk_size)
-	{
 		// 如果没有释放足够的内存，不进行重新分配
 		// 因为我们可能再次需要更多内存
-		if (size > chunk_size / 4)
-			return chunk;
 
 		// 如果下一个chunk可用
-		if (next_free)
-		{
 			// 合并下一个chunk
 
-			info->used_size -= chunk_size - size;
-			info->free_size += chunk_size - size;
 
-			new_chunk = (void *)((char *)chunk + MEM_SIZE_FIELD + size + MEM_SIZE_FIELD);
-			new_chunk_size = CHUNK_SIZE(next_chunk) + (chunk_size - size);
 
 			// 断开下一个chunk的链接
-			mem_unlink_chunk(info, next_chunk);
 
 			// 设置新chunk的大小
-			mem_set_chunk_size(new_chunk, new_chunk_size);
-			mem_link_chunk(info, new_chunk);
 
 			// 设置chunk已使用大小
-			mem_set_used_chunk_size(chunk, size);
-		}
-		else
-		{
 			// 如果下一个chunk不可用，分割当前chunk
 
-			info->used_size -= chunk_size - size;
-			info->free_size += chunk_size - size - 2 * MEM_SIZE_FIELD;
 
-			new_chunk = (void *)((char *)chunk + MEM_SIZE_FIELD + size + MEM_SIZE_FIELD);
-			new_chunk_size = chunk_size - size - 2 * MEM_SIZE_FIELD;
 
 			// 设置新chunk的大小
-			mem_set_chunk_size(new_chunk, new_chunk_size);
-			mem_link_chunk(info, new_chunk);
 
 			// 设置chunk已使用大小
-			mem_set_used_chunk_size(chunk, size);
-		}
 
-		return chunk;
-	}
 
 	// 如果下一个chunk可用且足够大
-	if (next_free && chunk_size + 2 * MEM_SIZE_FIELD + CHUNK_SIZE(next_chunk) >= size)
-	{
-		info->used_size -= chunk_size;
-		info->free_size += chunk_size + 2 * MEM_SIZE_FIELD;
 
-		chunk_size += 2 * MEM_SIZE_FIELD + CHUNK_SIZE(next_chunk);
 
 		// 断开下一个chunk的链接
-		mem_unlink_chunk(info, next_chunk);
 
 		/* 要么使用整个下一个chunk，要么分割它 */
 
@@ -598,75 +554,39 @@ static void *__mem_realloc(zbx_mem_info_t *info, void *old, zbx_uint64_t size)
 		}
 		else
 		{
+		void		*new_chunk;
+		zbx_uint64_t	new_chunk_size;
 			new_chunk = (void *)((char *)chunk + MEM_SIZE_FIELD + size + MEM_SIZE_FIELD);
 			new_chunk_size = chunk_size - size - 2 * MEM_SIZE_FIELD;
 
 			// 设置新chunk的大小
-			mem_set_chunk_size(new_chunk, new_chunk_size);
-			mem_link_chunk(info, new_chunk);
 
-			info->used_size += size;
-			info->free_size -= chunk_size;
-			info->free_size += new_chunk_size;
 
 			// 设置chunk已使用大小
-			mem_set_used_chunk_size(chunk, size);
-		}
 
-		return chunk;
-	}
 
 	// 如果没有找到合适的chunk，分配新的内存
-	if (NULL != (new_chunk = __mem_malloc(info, size)))
-	{
 		// 拷贝chunk的内存到新分配的内存
-		memcpy((char *)new_chunk + MEM_SIZE_FIELD, (char *)chunk + MEM_SIZE_FIELD, chunk_size);
 
 		// 释放旧的内存
-		__mem_free(info, old);
 
-		return new_chunk;
-	}
 
 	// 如果没有足够的内存分配，退出程序
-	else
-	{
-		void	*tmp = NULL;
 
 		// 检查是否可以释放当前chunk以及下一个chunk
-		new_chunk_size = chunk_size;
 
-		if (0 != next_free)
-			new_chunk_size += CHUNK_SIZE(next_chunk) + 2 * MEM_SIZE_FIELD;
 
-		if (info->lo_bound < chunk && FREE_CHUNK((char *)chunk - MEM_SIZE_FIELD))
-			new_chunk_size += CHUNK_SIZE((char *)chunk - MEM_SIZE_FIELD) + 2 * MEM_SIZE_FIELD;
 
-		if (size > new_chunk_size)
-			return NULL;
 
-		tmp = zbx_malloc(tmp, chunk_size);
 
 		// 拷贝chunk的内存到新分配的内存
-		memcpy(tmp, (char *)chunk + MEM_SIZE_FIELD, chunk_size);
 
 		// 释放旧的内存
-		__mem_free(info, old);
 
-		if (NULL == (new_chunk = __mem_malloc(info, size)))
-		{
-			THIS_SHOULD_NEVER_HAPPEN;
-			exit(EXIT_FAILURE);
-		}
 
 		// 拷贝新分配的内存到new_chunk
-		memcpy((char *)new_chunk + MEM_SIZE_FIELD, tmp, chunk_size);
 
-		zbx_free(tmp);
 
-		return new_chunk;
-	}
-}
 
 		mem_set_chunk_size(new_chunk, new_chunk_size);
 		mem_link_chunk(info, new_chunk);
@@ -687,9 +607,12 @@ static void	*__mem_realloc(zbx_mem_info_t *info, void *old, zbx_uint64_t size)
 	zbx_uint64_t	chunk_size, new_chunk_size;
 	int		next_free;
 
+	chunk = (void *)((char *)old - MEM_SIZE_FIELD);
+
+	if (SLAB_OBJECT(chunk))
+		return mem_slab_realloc(info, chunk, size);
 	size = mem_proper_alloc_size(size);
 
-	chunk = (void *)((char *)old - MEM_SIZE_FIELD);
 	chunk_size = CHUNK_SIZE(chunk);
 
 	next_chunk = (void *)((char *)chunk + MEM_SIZE_FIELD + chunk_size + MEM_SIZE_FIELD);
@@ -831,6 +754,11 @@ static void	__mem_free(zbx_mem_info_t *info, void *ptr)
 
 	// 计算chunk的地址
 	chunk = (void *)((char *)ptr - MEM_SIZE_FIELD);
+	if (SLAB_OBJECT(chunk))
+	{
+		mem_slab_free(info, chunk);
+		return;
+	}
 	chunk_size = CHUNK_SIZE(chunk);
 
 	// 更新内存使用信息
@@ -872,11 +800,186 @@ static void	__mem_free(zbx_mem_info_t *info, void *ptr)
 	}
 	else if (prev_free)
 	{
+		info->free_size += 2 * MEM_SIZE_FIELD;
+
+		prev_chunk = (void *)((char *)chunk - MEM_SIZE_FIELD - CHUNK_SIZE((char *)chunk - MEM_SIZE_FIELD) -
+				MEM_SIZE_FIELD);
+
+		chunk_size += 2 * MEM_SIZE_FIELD + CHUNK_SIZE(prev_chunk);
+
+		mem_unlink_chunk(info, prev_chunk);
+
+		chunk = prev_chunk;
+		mem_set_chunk_size(chunk, chunk_size);
+		mem_link_chunk(info, chunk);
+	}
+	else if (next_free)
+	{
+		info->free_size += 2 * MEM_SIZE_FIELD;
+
+		chunk_size += 2 * MEM_SIZE_FIELD + CHUNK_SIZE(next_chunk);
+
+		mem_unlink_chunk(info, next_chunk);
+
+		mem_set_chunk_size(chunk, chunk_size);
+		mem_link_chunk(info, chunk);
+	}
+	else
+	{
+		mem_set_chunk_size(chunk, chunk_size);
+		mem_link_chunk(info, chunk);
+	}
+}
+
+/* slab allocation of small objects */
+
+static void	mem_slab_link(mem_slab_class_t *slab_class, mem_slab_t *slab)
+{
+	slab->prev = NULL;
+	slab->next = slab_class->slabs;
+
+	if (NULL != slab_class->slabs)
+		slab_class->slabs->prev = slab;
+
+	slab_class->slabs = slab;
+}
+
+static void	mem_slab_unlink(mem_slab_class_t *slab_class, mem_slab_t *slab)
+{
+	if (NULL != slab->prev)
+		slab->prev->next = slab->next;
+	else
+		slab_class->slabs = slab->next;
+
+	if (NULL != slab->next)
+		slab->next->prev = slab->prev;
+}
+
+static mem_slab_t	*mem_slab_create(zbx_mem_info_t *info, int index)
+{
+	mem_slab_t	*slab;
+	void		*chunk, *object, *next_object = NULL;
+	zbx_uint64_t	object_size;
+	int		i;
+
+	if (NULL == (chunk = __mem_malloc(info, MEM_SLAB_SIZE)))
+		return NULL;
+
+	slab = (mem_slab_t *)((char *)chunk + MEM_SIZE_FIELD);
+	object_size = MEM_SIZE_FIELD + MEM_SLAB_CLASS_SIZE(index);
+
+	slab->index = index;
+	slab->used_num = 0;
+	slab->objects_num = (zbx_uint32_t)((CHUNK_SIZE(chunk) - MEM_SLAB_HEADER_SIZE) / object_size);
+
+	/* link objects in address order, so the first objects are allocated first */
+	for (i = (int)slab->objects_num - 1; 0 <= i; i--)
+	{
+		object = (char *)slab + MEM_SLAB_HEADER_SIZE + i * object_size;
+		*(zbx_uint64_t *)object = MEM_FLG_SLAB | (zbx_uint64_t)((char *)object - (char *)slab);
+		*(void **)((char *)object + MEM_SIZE_FIELD) = next_object;
+		next_object = object;
+	}
+
+	slab->free_object = next_object;
+
+	return slab;
+}
+
+static void	*mem_slab_malloc(zbx_mem_info_t *info, zbx_uint64_t size)
+{
+	mem_slab_class_t	*slab_class;
+	mem_slab_t		*slab;
+	void			*object;
+	int			index;
+
+	index = (int)((mem_proper_alloc_size(size) - MEM_MIN_ALLOC) >> 3);
+	slab_class = (mem_slab_class_t *)info->slab_classes + index;
+
+	if (NULL == (slab = slab_class->slabs))
+	{
+		if (NULL == (slab = mem_slab_create(info, index)))
+			return NULL;
+
+		mem_slab_link(slab_class, slab);
+		slab_class->slabs_num++;
+	}
+
+	object = slab->free_object;
+	slab->free_object = *(void **)((char *)object + MEM_SIZE_FIELD);
+	*(zbx_uint64_t *)object |= MEM_FLG_USED;
+
+	/* full slabs are not kept in the list, they are linked back when an object is freed */
+	if (++slab->used_num == slab->objects_num)
+		mem_slab_unlink(slab_class, slab);
+
+	slab_class->used_num++;
+
+	return object;
+}
+
+static void	mem_slab_free(zbx_mem_info_t *info, void *chunk)
+{
+	mem_slab_class_t	*slab_class;
+	mem_slab_t		*slab;
+
+	slab = (mem_slab_t *)((char *)chunk - SLAB_OFFSET(chunk));
+	slab_class = (mem_slab_class_t *)info->slab_classes + slab->index;
+
+	if (slab->used_num-- == slab->objects_num)
+		mem_slab_link(slab_class, slab);
+
+	*(zbx_uint64_t *)chunk &= ~MEM_FLG_USED;
+	*(void **)((char *)chunk + MEM_SIZE_FIELD) = slab->free_object;
+	slab->free_object = chunk;
+
+	slab_class->used_num--;
+
+	/* keep the last slab with free objects to avoid allocating it again for the next object */
+	if (0 == slab->used_num && (NULL != slab->prev || NULL != slab->next))
+	{
+		mem_slab_unlink(slab_class, slab);
+		slab_class->slabs_num--;
+
+		__mem_free(info, slab);
+	}
+}
+
+static void	*mem_slab_realloc(zbx_mem_info_t *info, void *chunk, zbx_uint64_t size)
+{
+	mem_slab_t	*slab;
+	void		*new_chunk;
+	zbx_uint64_t	object_size;
+
+	slab = (mem_slab_t *)((char *)chunk - SLAB_OFFSET(chunk));
+	object_size = MEM_SLAB_CLASS_SIZE(slab->index);
+
+	/* do not move small objects when shrinking */
+	if (mem_proper_alloc_size(size) <= object_size)
+		return chunk;
+
+	if (NULL == (new_chunk = mem_malloc(info, size)))
+		return NULL;
+
+	memcpy((char *)new_chunk + MEM_SIZE_FIELD, (char *)chunk + MEM_SIZE_FIELD, object_size);
+	mem_slab_free(info, chunk);
+
+	return new_chunk;
+}
 		// 如果只能合并前一个块，更新免费空间
 /******************************************************************************
  * *
  *这段代码的主要目的是创建一个私有共享内存区域，并为该内存区域分配一个zbx_mem_info_t结构体，用于存储内存使用情况。同时，将描述和参数存储在内存中，并设置允许内存溢出。最后，将共享内存划分为多个桶，以便后续分配和管理内存。
  ******************************************************************************/
+static void	*mem_malloc(zbx_mem_info_t *info, zbx_uint64_t size)
+{
+	void	*chunk;
+
+	if (NULL != info->slab_classes && MEM_SLAB_MAX_SIZE >= size && NULL != (chunk = mem_slab_malloc(info, size)))
+		return chunk;
+
+	return __mem_malloc(info, size);
+}
 int zbx_mem_create(zbx_mem_info_t **info, zbx_uint64_t size, const char *descr, const char *param, int allow_oom,
                     char **error)
 {
@@ -939,51 +1042,19 @@ int zbx_mem_create(zbx_mem_info_t **info, zbx_uint64_t size, const char *descr,
     (*info)->orig_size = size;
     size -= (char *)(*info + 1) - (char *)base;
 
-    base = (void *)(*info + 1);
 
-    (*info)->buckets = (void **)ALIGNPTR(base);
-    memset((*info)->buckets, 0, MEM_BUCKET_COUNT * ZBX_PTR_SIZE);
-    size -= (char *)((*info)->buckets + MEM_BUCKET_COUNT) - (char *)base;
-    base = (void *)((*info)->buckets + MEM_BUCKET_COUNT);
 
-    zbx_strlcpy((char *)base, descr, size);
-    (*info)->mem_descr = (char *)base;
-    size -= strlen(descr) + 1;
-    base = (void *)((char *)base + strlen(descr) + 1);
 
-    zbx_strlcpy((char *)base, param, size);
-    (*info)->mem_param = (char *)base;
-    size -= strlen(param) + 1;
-    base = (void *)((char *)base + strlen(param) + 1);
 
-    (*info)->allow_oom = allow_oom;
 
     /* 为后续分配做好准备，创建一个大的内存块 */
-    (*info)->lo_bound = ALIGN8(base);
-    (*info)->hi_bound = ALIGN8((char *)base + size - 8);
 
-    (*info)->total_size = (zbx_uint64_t)((char *)((*info)->hi_bound) - (char *)((*info)->lo_bound) -
-                            2 * MEM_SIZE_FIELD);
 
-    index = mem_bucket_by_size((*info)->total_size);
-    (*info)->buckets[index] = (*info)->lo_bound;
-    mem_set_chunk_size((*info)->buckets[index], (*info)->total_size);
-    mem_set_prev_chunk((*info)->buckets[index], NULL);
-    mem_set_next_chunk((*info)->buckets[index], NULL);
 
-    (*info)->used_size = 0;
-    (*info)->free_size = (*info)->total_size;
 
-    zabbix_log(LOG_LEVEL_DEBUG, "valid user addresses: [%p, %p] total size: " ZBX_FS_SIZE_T,
-                    (void *)((char *)(*info)->lo_bound + MEM_SIZE_FIELD),
-                    (void *)((char *)(*info)->hi_bound - MEM_SIZE_FIELD),
-                    (zbx_fs_size_t)(*info)->total_size);
 
     /* 结束 */
-    zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __function_name);
 
-    return ret;
-}
 
 	base = (void *)(*info + 1);
 
@@ -991,6 +1062,15 @@ int zbx_mem_create(zbx_mem_info_t **info, zbx_uint64_t size, const char *descr,
 	memset((*info)->buckets, 0, MEM_BUCKET_COUNT * ZBX_PTR_SIZE);
 	size -= (char *)((*info)->buckets + MEM_BUCKET_COUNT) - (char *)base;
 	base = (void *)((*info)->buckets + MEM_BUCKET_COUNT);
+	if (0 != CONFIG_CACHE_SLAB_ALLOCATOR)
+	{
+		(*info)->slab_classes = ALIGN8(base);
+		memset((*info)->slab_classes, 0, MEM_SLAB_CLASS_COUNT * sizeof(mem_slab_class_t));
+		size -= (char *)((mem_slab_class_t *)(*info)->slab_classes + MEM_SLAB_CLASS_COUNT) - (char *)base;
+		base = (void *)((mem_slab_class_t *)(*info)->slab_classes + MEM_SLAB_CLASS_COUNT);
+	}
+	else
+		(*info)->slab_classes = NULL;
 
 	zbx_strlcpy((char *)base, descr, size);
 	(*info)->mem_descr = (char *)base;
@@ -1057,7 +1137,7 @@ void *__zbx_mem_malloc(const char *file, int line, zbx_mem_info_t *info, const v
     }
 
     // 调用__mem_malloc函数分配内存，并获取内存块指针
-    chunk = __mem_malloc(info, size);
+    chunk = mem_malloc(info, size);
 
     // 如果分配内存失败，且允许内存不足，直接返回NULL
     if (NULL == chunk)
@@ -1109,7 +1189,7 @@ void *__zbx_mem_realloc(const char *file, int line, zbx_mem_info_t *info, void *
 
     // 判断old是否为空，如果为空，则使用__mem_malloc分配内存；否则，使用__mem_realloc进行内存扩展
     if (NULL == old)
-        chunk = __mem_malloc(info, size);
+        chunk = mem_malloc(info, size);
     else
         chunk = __mem_realloc(info, old, size);
 
@@ -1153,6 +1233,13 @@ void __zbx_mem_free(const char *file, int line, zbx_mem_info_t *info, void *ptr)
     // 判断传入的指针是否为空，如果为空，则进行以下操作：
     if (NULL == ptr)
     {
+		zabbix_log(LOG_LEVEL_CRIT, "[file:%s,line:%d] %s(): freeing a NULL pointer",
+				file, line, __function_name);
+		exit(EXIT_FAILURE);
+	}
+
+	__mem_free(info, ptr);
+}
         // 输出日志，记录错误信息，并退出程序
 /******************************************************************************
  * *
@@ -1180,30 +1267,24 @@ void	zbx_mem_clear(zbx_mem_info_t *info)
 	// 使用memset函数清空info->buckets数组，将其所有元素设置为0
 	memset(info->buckets, 0, MEM_BUCKET_COUNT * ZBX_PTR_SIZE);
 
+	if (NULL != info->slab_classes)
+		memset(info->slab_classes, 0, MEM_SLAB_CLASS_COUNT * sizeof(mem_slab_class_t));
 	// 根据info->total_size计算index，用于后续分配内存块
 	index = mem_bucket_by_size(info->total_size);
 
 	// 将info->lo_bound赋值给info->buckets[index]，作为内存块的起始地址
-	info->buckets[index] = info->lo_bound;
 
 	// 调用mem_set_chunk_size函数，设置内存块大小为info->total_size
-	mem_set_chunk_size(info->buckets[index], info->total_size);
 
 	// 调用mem_set_prev_chunk函数，设置当前内存块的前一个块为NULL
-	mem_set_prev_chunk(info->buckets[index], NULL);
 
 	// 调用mem_set_next_chunk函数，设置当前内存块的后一个块为NULL
-	mem_set_next_chunk(info->buckets[index], NULL);
 
 	// 初始化info->used_size为0，表示当前未使用内存大小为0
-	info->used_size = 0;
 
 	// 初始化info->free_size为info->total_size，表示总内存大小
-	info->free_size = info->total_size;
 
 	// 使用zabbix_log记录调试信息，表示结束函数__function_name()
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __function_name);
-}
 
 	info->buckets[index] = info->lo_bound;
 	mem_set_chunk_size(info->buckets[index], info->total_size);
@@ -1259,6 +1340,36 @@ void	zbx_mem_dump_stats(int level, zbx_mem_info_t *info)
 	zabbix_log(level, "min chunk size: %10llu bytes", (unsigned long long)min_size);
 	zabbix_log(level, "max chunk size: %10llu bytes", (unsigned long long)max_size);
 
+	/* the share of free memory that cannot be used for the largest possible allocation */
+	if (0 != info->free_size && 0 != total_free)
+	{
+		zabbix_log(level, "free memory fragmentation: %.2f%%",
+				100.0 - (double)max_size * 100.0 / (double)info->free_size);
+	}
+
+	if (NULL != info->slab_classes)
+	{
+		mem_slab_class_t	*slab_class;
+		zbx_uint64_t		slabs_num = 0, objects_size = 0;
+
+		for (index = 0; index < MEM_SLAB_CLASS_COUNT; index++)
+		{
+			slab_class = (mem_slab_class_t *)info->slab_classes + index;
+
+			if (0 == slab_class->slabs_num)
+				continue;
+
+			slabs_num += slab_class->slabs_num;
+			objects_size += slab_class->used_num * MEM_SLAB_CLASS_SIZE(index);
+
+			zabbix_log(level, "slab objects of size %3d bytes: %8llu used in %6llu slabs",
+					MEM_SLAB_CLASS_SIZE(index), (unsigned long long)slab_class->used_num,
+					(unsigned long long)slab_class->slabs_num);
+		}
+
+		zabbix_log(level, "slabs use %llu bytes, of those %llu bytes are in used objects",
+				(unsigned long long)(slabs_num * MEM_SLAB_SIZE), (unsigned long long)objects_size);
+	}
 	// 计算总内存大小，并拆分成内存块数量
 	total = (info->total_size - info->used_size - info->free_size) / (2 * MEM_SIZE_FIELD) + 1;
 	zabbix_log(level, "memory of total size %llu bytes fragmented into %llu chunks",
@@ -1295,6 +1406,11 @@ size_t	zbx_mem_required_size(int chunks_num, const char *descr, const char *para
 	size += sizeof(zbx_mem_info_t);
 	size += ZBX_PTR_SIZE - 1;			/* 确保分配足够的空间以对齐桶指针 */
 	size += ZBX_PTR_SIZE * MEM_BUCKET_COUNT;
+	if (0 != CONFIG_CACHE_SLAB_ALLOCATOR)
+	{
+		size += 7;				/* ensure we allocate enough to 8-align slab classes */
+		size += sizeof(mem_slab_class_t) * MEM_SLAB_CLASS_COUNT;
+	}
 	size += strlen(descr) + 1;
 	size += strlen(param) + 1;
 	size += (MEM_SIZE_FIELD - 1) + 8;		/* 确保分配足够的空间以对齐第一个内存块的大小字段 */
@@ -25,6 +25,12 @@
 #include "evalfunc.h"
 #include "zbxregexp.h"
 
+#if defined(__AVX2__)
+#	include <immintrin.h>
+#elif defined(__SSE2__)
+#	include <emmintrin.h>
+#endif
+
 typedef enum
 {
 	ZBX_PARAM_OPTIONAL,
@@ -63,7 +69,7 @@ zbx_value_type_t;
  *```
  ******************************************************************************/
 // 定义一个名为 zbx_type_string 的静态常量字符指针函数，该函数接收一个 zbx_value_type_t 类型的参数 type
-static const char *zbx_type_string(zbx_value_type_t type)
+static const char	*zbx_type_string(zbx_value_type_t type)
 {
 	// 使用 switch 语句根据 type 的值进行分支处理
 	switch (type)
@@ -74,6 +80,33 @@ static const char *zbx_type_string(zbx_value_type_t type)
 		// 当 type 为 ZBX_VALUE_NVALUES 时，返回 "num"
 		case ZBX_VALUE_NVALUES:
 			return "num";
+		default:
+			THIS_SHOULD_NEVER_HAPPEN;
+			return "unknown";
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: get_function_parameter_int                                       *
+ *                                                                            *
+ * Purpose: get the value of sec|#num trigger function parameter              *
+ *                                                                            *
+ * Parameters: hostid         - [IN] hostid of the host trigger function      *
+ *                              belongs to                                    *
+ *             parameters     - [IN] trigger function parameters              *
+ *             Nparam         - [IN] specifies which parameter to extract     *
+ *             parameter_type - [IN] specifies whether parameter is mandatory *
+ *                              or optional                                   *
+ *             value          - [OUT] parameter value (preserved as is if the *
+ *                              parameter is optional and empty)              *
+ *             type           - [OUT] parameter value type (number of seconds *
+ *                              or number of values)                          *
+ *                                                                            *
+ * Return value: SUCCEED - parameter is valid                                 *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  * *
  *整个代码块的主要目的是用于获取函数参数中的整数值。函数接收7个参数，分别是hostid、parameters、Nparam、parameter_type、value和type。在函数内部，首先解析参数，然后根据参数类型进行判断和处理，最后返回处理后的值。如果函数执行成功，还会记录日志以供调试。
@@ -150,38 +183,6 @@ out:
     return ret;
 }
 
-		else if ('#' == *parameter)
-		{
-			*type = ZBX_VALUE_NVALUES;
-			if (SUCCEED == is_uint31(parameter + 1, value) && 0 < *value)
-				ret = SUCCEED;
-		}
-		else if ('-' == *parameter)
-		{
-			if (SUCCEED == is_time_suffix(parameter + 1, value, ZBX_LENGTH_UNLIMITED))
-			{
-				*value = -(*value);
-				*type = ZBX_VALUE_SECONDS;
-				ret = SUCCEED;
-			}
-		}
-		else if (SUCCEED == is_time_suffix(parameter, value, ZBX_LENGTH_UNLIMITED))
-		{
-			*type = ZBX_VALUE_SECONDS;
-			ret = SUCCEED;
-		}
-	}
-
-	if (SUCCEED == ret)
-		zabbix_log(LOG_LEVEL_DEBUG, "%s() type:%s value:%d", __function_name, zbx_type_string(*type), *value);
-
-	zbx_free(parameter);
-out:
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
-
-	return ret;
-}
-
 /******************************************************************************
  * *
  *整个代码块的主要目的是定义一个静态函数`get_function_parameter_uint64`，用于获取函数参数中的uint64值。函数接收四个参数，分别是主机ID、参数字符串、参数个数和uint64值指针。函数通过替换简单宏和判断参数是否为uint64类型来获取并验证uint64值。如果成功获取到uint64值，函数返回SUCCEED，否则返回FAIL。在函数执行过程中，还对函数执行过程进行日志记录。
@@ -232,6 +233,86 @@ out:
 	/* 记录日志，输出函数返回值 */
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
 
+	return ret;
+}
+
+static int	get_function_parameter_float(zbx_uint64_t hostid, const char *parameters, int Nparam,
+		unsigned char flags, double *value)
+{
+	const char	*__function_name = "get_function_parameter_float";
+	char		*parameter;
+	int		ret = FAIL;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() parameters:'%s' Nparam:%d", __function_name, parameters, Nparam);
+
+	if (NULL == (parameter = zbx_function_get_param_dyn(parameters, Nparam)))
+		goto out;
+
+	if (SUCCEED == substitute_simple_macros(NULL, NULL, NULL, NULL, &hostid, NULL, NULL, NULL, NULL,
+			&parameter, MACRO_TYPE_COMMON, NULL, 0))
+	{
+		if (SUCCEED != is_double_suffix(parameter, flags))
+			goto clean;
+
+		*value = str2double(parameter);
+
+		ret = SUCCEED;
+	}
+
+	if (SUCCEED == ret)
+		zabbix_log(LOG_LEVEL_DEBUG, "%s() value:" ZBX_FS_DBL, __function_name, *value);
+clean:
+	zbx_free(parameter);
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
+
+	return ret;
+}
+
+static int	get_function_parameter_str(zbx_uint64_t hostid, const char *parameters, int Nparam, char **value)
+{
+	const char	*__function_name = "get_function_parameter_str";
+	int		ret = FAIL;
+
+	// 记录日志，输入参数
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() parameters:'%s' Nparam:%d", __function_name, parameters, Nparam);
+
+	// 尝试获取动态参数，如果失败则退出
+	if (NULL == (*value = zbx_function_get_param_dyn(parameters, Nparam)))
+		goto out;
+
+	// 调用 substitute_simple_macros 函数处理参数，替换简单宏
+	ret = substitute_simple_macros(NULL, NULL, NULL, NULL, &hostid, NULL, NULL, NULL, NULL,
+			value, MACRO_TYPE_COMMON, NULL, 0);
+
+	// 如果替换成功，记录日志
+	if (SUCCEED == ret)
+		zabbix_log(LOG_LEVEL_DEBUG, "%s() value:'%s'", __function_name, *value);
+	// 否则，释放内存
+	else
+		zbx_free(*value);
+
+// 退出逻辑
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
+
+	// 返回替换后的值
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: evaluate_LOGEVENTID                                              *
+ *                                                                            *
+ * Purpose: evaluate function 'logeventid' for the item                       *
+ *                                                                            *
+ * Parameters: item - item (performance metric)                               *
+ *             parameter - regex string for event id matching                 *
+ *                                                                            *
+ * Return value: SUCCEED - evaluated successfully, result is stored in 'value'*
+ *               FAIL - failed to evaluate function                           *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  * 以下是对代码的逐行注释：
  *
@@ -340,37 +421,6 @@ out:
 	/* 返回评估结果 */
 	return ret;
 }
-
-    const char *__function_name = "get_function_parameter_str";
-    int		ret = FAIL;
-
-    // 记录日志，输入参数
-    zabbix_log(LOG_LEVEL_DEBUG, "In %s() parameters:'%s' Nparam:%d", __function_name, parameters, Nparam);
-
-    // 尝试获取动态参数，如果失败则退出
-    if (NULL == (*value = zbx_function_get_param_dyn(parameters, Nparam)))
-        goto out;
-
-    // 调用 substitute_simple_macros 函数处理参数，替换简单宏
-    ret = substitute_simple_macros(NULL, NULL, NULL, NULL, &hostid, NULL, NULL, NULL, NULL,
-                                 value, MACRO_TYPE_COMMON, NULL, 0);
-
-    // 如果替换成功，记录日志
-    if (SUCCEED == ret)
-        zabbix_log(LOG_LEVEL_DEBUG, "%s() value:'%s'", __function_name, *value);
-    // 否则，释放内存
-    else
-        zbx_free(*value);
-
-    // 退出逻辑
-out:
-    zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
-
-    // 返回替换后的值
-    return ret;
-}
-
-
 /******************************************************************************
  *                                                                            *
  * Function: evaluate_LOGEVENTID                                              *
@@ -384,76 +434,20 @@ out:
  *               FAIL - failed to evaluate function                           *
  *                                                                            *
  ******************************************************************************/
-static int	evaluate_LOGEVENTID(char *value, DC_ITEM *item, const char *parameters,
-		const zbx_timespec_t *ts, char **error)
-{
-	const char		*__function_name = "evaluate_LOGEVENTID";
-
-	char			*arg1 = NULL;
-	int			ret = FAIL;
-	zbx_vector_ptr_t	regexps;
-	zbx_history_record_t	vc_value;
-
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
-
-	zbx_vector_ptr_create(&regexps);
-
-	if (ITEM_VALUE_TYPE_LOG != item->value_type)
-	{
-		*error = zbx_strdup(*error, "invalid value type");
-		goto out;
-	}
 
-	if (1 < num_param(parameters))
-	{
-		*error = zbx_strdup(*error, "invalid number of parameters");
-		goto out;
-	}
-
-	if (SUCCEED != get_function_parameter_str(item->host.hostid, parameters, 1, &arg1))
-	{
-		*error = zbx_strdup(*error, "invalid first parameter");
-		goto out;
-	}
-
-	if ('@' == *arg1)
-	{
-		DCget_expressions_by_name(&regexps, arg1 + 1);
-
-		if (0 == regexps.values_num)
-		{
-			*error = zbx_dsprintf(*error, "global regular expression \"%s\" does not exist", arg1 + 1);
-			goto out;
-		}
-	}
-
-	if (SUCCEED == zbx_vc_get_value(item->itemid, item->value_type, ts, &vc_value))
-	{
-		char	logeventid[16];
-		int	regexp_ret;
-
-		zbx_snprintf(logeventid, sizeof(logeventid), "%d", vc_value.value.log->logeventid);
-
-		if (FAIL == (regexp_ret = regexp_match_ex(&regexps, logeventid, arg1, ZBX_CASE_SENSITIVE)))
-		{
-			*error = zbx_dsprintf(*error, "invalid regular expression \"%s\"", arg1);
-		}
-		else
-		{
-			if (ZBX_REGEXP_MATCH == regexp_ret)
-				zbx_strlcpy(value, "1", MAX_BUFFER_LEN);
-			else if (ZBX_REGEXP_NO_MATCH == regexp_ret)
-				zbx_strlcpy(value, "0", MAX_BUFFER_LEN);
-
-			ret = SUCCEED;
-		}
-
-		zbx_history_record_clear(&vc_value, item->value_type);
-	}
-	else
-	{
-		zabbix_log(LOG_LEVEL_DEBUG, "result for LOGEVENTID is empty");
-		*error = zbx_strdup(*error, "cannot get values from value cache");
+/******************************************************************************
+ *                                                                            *
+ * Function: evaluate_LOGSOURCE                                               *
+ *                                                                            *
+ * Purpose: evaluate function 'logsource' for the item                        *
+ *                                                                            *
+ * Parameters: item - item (performance metric)                               *
+ *             parameter - ignored                                            *
+ *                                                                            *
+ * Return value: SUCCEED - evaluated successfully, result is stored in 'value'*
+ *               FAIL - failed to evaluate function                           *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  * 以下是我为您注释的代码块：
  *
@@ -543,8 +537,8 @@ static int	evaluate_LOGSOURCE(char *value, DC_ITEM *item, const char *parameters
     }
 
     /* 错误处理 */
-    out:
-        zbx_free(arg1);
+out:
+    zbx_free(arg1);
 
     /* 清理正则表达式 */
     zbx_regexp_clean_expressions(&regexps);
@@ -558,32 +552,6 @@ static int	evaluate_LOGSOURCE(char *value, DC_ITEM *item, const char *parameters
     return ret;
 }
 
-			case ZBX_REGEXP_NO_MATCH:
-				zbx_strlcpy(value, "0", MAX_BUFFER_LEN);
-				ret = SUCCEED;
-				break;
-			case FAIL:
-				*error = zbx_dsprintf(*error, "invalid regular expression");
-		}
-
-		zbx_history_record_clear(&vc_value, item->value_type);
-	}
-	else
-	{
-		zabbix_log(LOG_LEVEL_DEBUG, "result for LOGSOURCE is empty");
-		*error = zbx_strdup(*error, "cannot get values from value cache");
-	}
-out:
-	zbx_free(arg1);
-
-	zbx_regexp_clean_expressions(&regexps);
-	zbx_vector_ptr_destroy(&regexps);
-
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
-
-	return ret;
-}
-
 /******************************************************************************
  *                                                                            *
  * Function: evaluate_LOGSEVERITY                                             *
@@ -672,10 +640,41 @@ out:
 // 1 个 zbx_uint64_t 类型变量 value，表示要操作的值；
 // 1 个 zbx_uint64_t 类型变量 pattern，表示期望的值；
 // 1 个 zbx_uint64_t 类型变量 mask，表示掩码。
-static void count_one_ui64(int *count, int op, zbx_uint64_t value, zbx_uint64_t pattern, zbx_uint64_t mask)
+static void	count_one_ui64(int *count, int op, zbx_uint64_t value, zbx_uint64_t pattern, zbx_uint64_t mask)
 {
 	// 使用 switch 语句根据 op 的值切换不同的操作类型：
 	switch (op)
+	{
+		case OP_EQ:
+			if (value == pattern)
+				(*count)++;
+			break;
+		case OP_NE:
+			if (value != pattern)
+				(*count)++;
+			break;
+		case OP_GT:
+			if (value > pattern)
+				(*count)++;
+			break;
+		case OP_GE:
+			if (value >= pattern)
+				(*count)++;
+			break;
+		case OP_LT:
+			if (value < pattern)
+				(*count)++;
+			break;
+		case OP_LE:
+			if (value <= pattern)
+				(*count)++;
+			break;
+		case OP_BAND:
+			if ((value & mask) == pattern)
+				(*count)++;
+	}
+}
+
 /******************************************************************************
  * *
  *整个代码块的主要目的是计算满足不同条件（操作符）的双精度浮点数的个数。具体来说，根据传入的操作符、值、模式值和误差值，判断哪些浮点数满足条件，然后将满足条件的个数加到计数器中。
@@ -687,158 +686,46 @@ static void count_one_dbl(int *count, int op, double value, double pattern)
     switch (op)
     {
         case OP_EQ: // 操作符为 OP_EQ（等于）
-        {
             // 如果 value 在 pattern 附近（即值差小于 ZBX_DOUBLE_EPSILON），则计数器加1
             if (value > pattern - ZBX_DOUBLE_EPSILON && value < pattern + ZBX_DOUBLE_EPSILON)
-            {
                 (*count)++;
-            }
             break;
-        }
         case OP_NE: // 操作符为 OP_NE（不等于）
-        {
             // 如果 value 不在 pattern 附近（即值差大于 ZBX_DOUBLE_EPSILON），则计数器加1
             if (!(value > pattern - ZBX_DOUBLE_EPSILON && value < pattern + ZBX_DOUBLE_EPSILON))
-            {
                 (*count)++;
-            }
             break;
-        }
         case OP_GT: // 操作符为 OP_GT（大于）
-        {
             // 如果 value 大于 pattern（即 value >= pattern + ZBX_DOUBLE_EPSILON），则计数器加1
             if (value >= pattern + ZBX_DOUBLE_EPSILON)
-            {
                 (*count)++;
-            }
             break;
-        }
         case OP_GE: // 操作符为 OP_GE（大于等于）
-        {
             // 如果 value 大于等于 pattern（即 value > pattern - ZBX_DOUBLE_EPSILON），则计数器加1
             if (value > pattern - ZBX_DOUBLE_EPSILON)
-            {
                 (*count)++;
-            }
             break;
-        }
         case OP_LT: // 操作符为 OP_LT（小于）
-        {
             // 如果 value 小于 pattern（即 value <= pattern - ZBX_DOUBLE_EPSILON），则计数器加1
             if (value <= pattern - ZBX_DOUBLE_EPSILON)
-            {
                 (*count)++;
-            }
             break;
-        }
         case OP_LE: // 操作符为 OP_LE（小于等于）
-        {
             // 如果 value 小于等于 pattern（即 value < pattern + ZBX_DOUBLE_EPSILON），则计数器加1
             if (value < pattern + ZBX_DOUBLE_EPSILON)
-            {
                 (*count)++;
-            }
-            break;
-        }
-        default:
-        {
-            // 默认情况下，不执行任何操作，直接返回
-            break;
-        }
     }
 }
 
-			break;
-		}
-		// case OP_GE：表示大于等于操作
-		case OP_GE:
-		{
-			// 如果 value 大于等于 pattern，则将 count 加 1
-			if (value >= pattern)
-			{
-				(*count)++;
-			}
-			break;
-		}
-		// case OP_LT：表示小于操作
-		case OP_LT:
-		{
-			// 如果 value 小于 pattern，则将 count 加 1
-			if (value < pattern)
-			{
-				(*count)++;
-			}
-			break;
-		}
-		// case OP_LE：表示小于等于操作
-		case OP_LE:
-		{
-			// 如果 value 小于等于 pattern，则将 count 加 1
-			if (value <= pattern)
-			{
-				(*count)++;
-			}
-			break;
-		}
-		// case OP_BAND：表示按位与操作
-		case OP_BAND:
-		{
-			// 如果（value 与 mask）等于 pattern，则将 count 加 1
-			if ((value & mask) == pattern)
-			{
-				(*count)++;
-			}
-			break;
-		}
-		// 默认情况，未定义的操作类型
-		default:
-		{
-			// 这里可以添加未定义操作类型的处理逻辑，例如返回错误信息等
-			break;
-		}
-	}
-}
-
-
-static void	count_one_dbl(int *count, int op, double value, double pattern)
-{
-	switch (op)
-	{
-		case OP_EQ:
-			if (value > pattern - ZBX_DOUBLE_EPSILON && value < pattern + ZBX_DOUBLE_EPSILON)
-				(*count)++;
-			break;
-		case OP_NE:
-			if (!(value > pattern - ZBX_DOUBLE_EPSILON && value < pattern + ZBX_DOUBLE_EPSILON))
-				(*count)++;
-			break;
-		case OP_GT:
-			if (value >= pattern + ZBX_DOUBLE_EPSILON)
-				(*count)++;
-			break;
-		case OP_GE:
-			if (value > pattern - ZBX_DOUBLE_EPSILON)
-				(*count)++;
-			break;
-		case OP_LT:
-			if (value <= pattern - ZBX_DOUBLE_EPSILON)
-				(*count)++;
-			break;
-		case OP_LE:
-			if (value < pattern + ZBX_DOUBLE_EPSILON)
-				(*count)++;
-	}
-}
-
 /******************************************************************************
  * *
  *整个代码块的主要目的是实现一个函数`count_one_str`，该函数根据给定的操作符（OP_EQ、OP_NE、OP_LIKE、OP_REGEXP、OP_IREGEXP）和相应的值、模式字符串以及正则表达式匹配器，判断两者之间的匹配情况，并将结果累加到计数器count中。根据不同的操作符，执行相应的匹配操作，并在匹配成功或失败时更新计数器count的值。
  ******************************************************************************/
 // 定义一个函数，用于计算给定字符串与模式字符串之间的匹配情况，并根据操作符执行不同的匹配操作
-static void count_one_str(int *count, int op, const char *value, const char *pattern, zbx_vector_ptr_t *regexps)
+static void	count_one_str(int *count, int op, const char *value, const char *pattern, zbx_vector_ptr_t *regexps)
 {
 	// 定义一个整型变量res，用于存储正则表达式匹配的结果
-	int res;
+	int	res;
 
 	// 根据操作符op的不同，执行不同的匹配操作
 	switch (op)
@@ -868,8 +755,521 @@ static void count_one_str(int *count, int op, const char *value, const char *pat
 			else if (FAIL == res)
 				*count = FAIL;
 			break;
-
 		// 当操作符为OP_IREGEXP时，使用正则表达式匹配器regexps进行匹配，若匹配成功，则计数器count加1
+		case OP_IREGEXP:
+			if (ZBX_REGEXP_MATCH == (res = regexp_match_ex(regexps, value, pattern, ZBX_IGNORE_CASE)))
+				(*count)++;
+			else if (FAIL == res)
+				*count = FAIL;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Aggregate kernels used by numeric trigger functions.                       *
+ *                                                                            *
+ * The values are loaded from history records into vector registers (4 lanes  *
+ * with AVX2, 2 lanes with SSE2) and accumulated in independent lanes that    *
+ * are reduced at the end. Values left over after the last full vector and    *
+ * builds without SIMD support are processed by the scalar loops.             *
+ *                                                                            *
+ ******************************************************************************/
+
+#if defined(__AVX2__)
+#	define ZBX_AGGR_LANES		4
+#	define AGGR_LOAD_PD(v, i)	_mm256_set_pd((v)[(i) + 3].value.dbl, (v)[(i) + 2].value.dbl,	\
+						(v)[(i) + 1].value.dbl, (v)[i].value.dbl)
+#	define AGGR_LOAD_EPI64(v, i)	_mm256_set_epi64x((zbx_int64_t)(v)[(i) + 3].value.ui64,		\
+						(zbx_int64_t)(v)[(i) + 2].value.ui64,				\
+						(zbx_int64_t)(v)[(i) + 1].value.ui64, (zbx_int64_t)(v)[i].value.ui64)
+#	define AGGR_PD			__m256d
+#	define AGGR_EPI64		__m256i
+#	define AGGR_SET1_PD		_mm256_set1_pd
+#	define AGGR_ZERO_PD		_mm256_setzero_pd
+#	define AGGR_ADD_PD		_mm256_add_pd
+#	define AGGR_MIN_PD		_mm256_min_pd
+#	define AGGR_MAX_PD		_mm256_max_pd
+#	define AGGR_AND_PD		_mm256_and_pd
+#	define AGGR_CMPLT_PD(a, b)	_mm256_cmp_pd(a, b, _CMP_LT_OQ)
+#	define AGGR_CMPLE_PD(a, b)	_mm256_cmp_pd(a, b, _CMP_LE_OQ)
+#	define AGGR_STORE_PD		_mm256_storeu_pd
+#	define AGGR_SET1_EPI64(x)	_mm256_set1_epi64x((zbx_int64_t)(x))
+#	define AGGR_ZERO_EPI64		_mm256_setzero_si256
+#	define AGGR_ADD_EPI64		_mm256_add_epi64
+#	define AGGR_SUB_EPI64		_mm256_sub_epi64
+#	define AGGR_AND_EPI64		_mm256_and_si256
+#	define AGGR_SRLI_EPI64		_mm256_srli_epi64
+#	define AGGR_CAST_EPI64		_mm256_castpd_si256
+#	define AGGR_STORE_EPI64(p, a)	_mm256_storeu_si256((__m256i *)(p), a)
+#elif defined(__SSE2__)
+#	define ZBX_AGGR_LANES		2
+#	define AGGR_LOAD_PD(v, i)	_mm_set_pd((v)[(i) + 1].value.dbl, (v)[i].value.dbl)
+#	define AGGR_LOAD_EPI64(v, i)	_mm_set_epi64x((zbx_int64_t)(v)[(i) + 1].value.ui64,		\
+						(zbx_int64_t)(v)[i].value.ui64)
+#	define AGGR_PD			__m128d
+#	define AGGR_EPI64		__m128i
+#	define AGGR_SET1_PD		_mm_set1_pd
+#	define AGGR_ZERO_PD		_mm_setzero_pd
+#	define AGGR_ADD_PD		_mm_add_pd
+#	define AGGR_MIN_PD		_mm_min_pd
+#	define AGGR_MAX_PD		_mm_max_pd
+#	define AGGR_AND_PD		_mm_and_pd
+#	define AGGR_CMPLT_PD		_mm_cmplt_pd
+#	define AGGR_CMPLE_PD		_mm_cmple_pd
+#	define AGGR_STORE_PD		_mm_storeu_pd
+#	define AGGR_SET1_EPI64(x)	_mm_set1_epi64x((zbx_int64_t)(x))
+#	define AGGR_ZERO_EPI64		_mm_setzero_si128
+#	define AGGR_ADD_EPI64		_mm_add_epi64
+#	define AGGR_SUB_EPI64		_mm_sub_epi64
+#	define AGGR_AND_EPI64		_mm_and_si128
+#	define AGGR_SRLI_EPI64		_mm_srli_epi64
+#	define AGGR_CAST_EPI64		_mm_castpd_si128
+#	define AGGR_STORE_EPI64(p, a)	_mm_storeu_si128((__m128i *)(p), a)
+#endif
+
+/******************************************************************************
+ *                                                                            *
+ * Function: aggr_sum_dbl                                                     *
+ *                                                                            *
+ * Purpose: calculates sum of floating point values                           *
+ *                                                                            *
+ * Parameters: values - [IN] the history records                              *
+ *             num    - [IN] the number of records                            *
+ *                                                                            *
+ * Return value: the sum of values                                            *
+ *                                                                            *
+ ******************************************************************************/
+static double	aggr_sum_dbl(const zbx_history_record_t *values, int num)
+{
+	double	sum = 0;
+	int	i = 0;
+
+#if defined(ZBX_AGGR_LANES)
+	if (ZBX_AGGR_LANES * 2 <= num)
+	{
+		AGGR_PD	acc0 = AGGR_ZERO_PD(), acc1 = AGGR_ZERO_PD();
+		double	lanes[ZBX_AGGR_LANES];
+		int	j;
+
+		for (; i + ZBX_AGGR_LANES * 2 <= num; i += ZBX_AGGR_LANES * 2)
+		{
+			acc0 = AGGR_ADD_PD(acc0, AGGR_LOAD_PD(values, i));
+			acc1 = AGGR_ADD_PD(acc1, AGGR_LOAD_PD(values, i + ZBX_AGGR_LANES));
+		}
+
+		AGGR_STORE_PD(lanes, AGGR_ADD_PD(acc0, acc1));
+
+		for (j = 0; j < ZBX_AGGR_LANES; j++)
+			sum += lanes[j];
+	}
+#endif
+	for (; i < num; i++)
+		sum += values[i].value.dbl;
+
+	return sum;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: aggr_sum_ui64                                                    *
+ *                                                                            *
+ * Purpose: calculates sum of unsigned integer values                         *
+ *                                                                            *
+ * Parameters: values - [IN] the history records                              *
+ *             num    - [IN] the number of records                            *
+ *                                                                            *
+ * Return value: the sum of values (wraps around on overflow)                 *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_uint64_t	aggr_sum_ui64(const zbx_history_record_t *values, int num)
+{
+	zbx_uint64_t	sum = 0;
+	int		i = 0;
+
+#if defined(ZBX_AGGR_LANES)
+	if (ZBX_AGGR_LANES * 2 <= num)
+	{
+		AGGR_EPI64	acc0 = AGGR_ZERO_EPI64(), acc1 = AGGR_ZERO_EPI64();
+		zbx_uint64_t	lanes[ZBX_AGGR_LANES];
+		int		j;
+
+		for (; i + ZBX_AGGR_LANES * 2 <= num; i += ZBX_AGGR_LANES * 2)
+		{
+			acc0 = AGGR_ADD_EPI64(acc0, AGGR_LOAD_EPI64(values, i));
+			acc1 = AGGR_ADD_EPI64(acc1, AGGR_LOAD_EPI64(values, i + ZBX_AGGR_LANES));
+		}
+
+		AGGR_STORE_EPI64(lanes, AGGR_ADD_EPI64(acc0, acc1));
+
+		for (j = 0; j < ZBX_AGGR_LANES; j++)
+			sum += lanes[j];
+	}
+#endif
+	for (; i < num; i++)
+		sum += values[i].value.ui64;
+
+	return sum;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: aggr_sum_ui64_dbl                                                *
+ *                                                                            *
+ * Purpose: calculates sum of unsigned integer values as floating point value *
+ *                                                                            *
+ * Parameters: values - [IN] the history records                              *
+ *             num    - [IN] the number of records                            *
+ *                                                                            *
+ * Return value: the sum of values                                            *
+ *                                                                            *
+ * Comments: The high and low 32 bits of values are summed separately, so     *
+ *           the partial sums cannot overflow for less than 2^32 values.      *
+ *                                                                            *
+ ******************************************************************************/
+static double	aggr_sum_ui64_dbl(const zbx_history_record_t *values, int num)
+{
+	zbx_uint64_t	sum_hi = 0, sum_lo = 0;
+	int		i = 0;
+
+#if defined(ZBX_AGGR_LANES)
+	if (ZBX_AGGR_LANES <= num)
+	{
+		AGGR_EPI64	acc_hi = AGGR_ZERO_EPI64(), acc_lo = AGGR_ZERO_EPI64(), mask, v;
+		zbx_uint64_t	lanes_hi[ZBX_AGGR_LANES], lanes_lo[ZBX_AGGR_LANES];
+		int		j;
+
+		mask = AGGR_SET1_EPI64(__UINT64_C(0xffffffff));
+
+		for (; i + ZBX_AGGR_LANES <= num; i += ZBX_AGGR_LANES)
+		{
+			v = AGGR_LOAD_EPI64(values, i);
+			acc_hi = AGGR_ADD_EPI64(acc_hi, AGGR_SRLI_EPI64(v, 32));
+			acc_lo = AGGR_ADD_EPI64(acc_lo, AGGR_AND_EPI64(v, mask));
+		}
+
+		AGGR_STORE_EPI64(lanes_hi, acc_hi);
+		AGGR_STORE_EPI64(lanes_lo, acc_lo);
+
+		for (j = 0; j < ZBX_AGGR_LANES; j++)
+		{
+			sum_hi += lanes_hi[j];
+			sum_lo += lanes_lo[j];
+		}
+	}
+#endif
+	for (; i < num; i++)
+	{
+		sum_hi += values[i].value.ui64 >> 32;
+		sum_lo += values[i].value.ui64 & __UINT64_C(0xffffffff);
+	}
+
+	return (double)sum_hi * 4294967296.0 + (double)sum_lo;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: aggr_minmax_dbl                                                  *
+ *                                                                            *
+ * Purpose: finds minimum and maximum of floating point values                *
+ *                                                                            *
+ * Parameters: values - [IN] the history records                              *
+ *             num    - [IN] the number of records, must be positive          *
+ *             min    - [OUT] the minimum value                               *
+ *             max    - [OUT] the maximum value                               *
+ *                                                                            *
+ ******************************************************************************/
+static void	aggr_minmax_dbl(const zbx_history_record_t *values, int num, double *min, double *max)
+{
+	int	i = 1;
+
+	*min = *max = values[0].value.dbl;
+
+#if defined(ZBX_AGGR_LANES)
+	if (ZBX_AGGR_LANES <= num)
+	{
+		AGGR_PD	vmin, vmax, v;
+		double	lanes_min[ZBX_AGGR_LANES], lanes_max[ZBX_AGGR_LANES];
+		int	j;
+
+		vmin = vmax = AGGR_LOAD_PD(values, 0);
+
+		for (i = ZBX_AGGR_LANES; i + ZBX_AGGR_LANES <= num; i += ZBX_AGGR_LANES)
+		{
+			v = AGGR_LOAD_PD(values, i);
+			vmin = AGGR_MIN_PD(vmin, v);
+			vmax = AGGR_MAX_PD(vmax, v);
+		}
+
+		AGGR_STORE_PD(lanes_min, vmin);
+		AGGR_STORE_PD(lanes_max, vmax);
+
+		for (j = 0; j < ZBX_AGGR_LANES; j++)
+		{
+			if (lanes_min[j] < *min)
+				*min = lanes_min[j];
+
+			if (lanes_max[j] > *max)
+				*max = lanes_max[j];
+		}
+	}
+#endif
+	for (; i < num; i++)
+	{
+		if (values[i].value.dbl < *min)
+			*min = values[i].value.dbl;
+
+		if (values[i].value.dbl > *max)
+			*max = values[i].value.dbl;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: aggr_minmax_ui64                                                 *
+ *                                                                            *
+ * Purpose: finds minimum and maximum of unsigned integer values              *
+ *                                                                            *
+ * Parameters: values - [IN] the history records                              *
+ *             num    - [IN] the number of records, must be positive          *
+ *             min    - [OUT] the minimum value                               *
+ *             max    - [OUT] the maximum value                               *
+ *                                                                            *
+ * Comments: SSE2 has no 64-bit integer comparison, so only AVX2 builds use   *
+ *           vector path. The sign bit is flipped to compare unsigned values  *
+ *           with signed comparison instruction.                              *
+ *                                                                            *
+ ******************************************************************************/
+static void	aggr_minmax_ui64(const zbx_history_record_t *values, int num, zbx_uint64_t *min, zbx_uint64_t *max)
+{
+	int	i = 1;
+
+	*min = *max = values[0].value.ui64;
+
+#if defined(__AVX2__)
+	if (ZBX_AGGR_LANES <= num)
+	{
+		__m256i		vmin, vmax, v, sign;
+		zbx_uint64_t	lanes_min[ZBX_AGGR_LANES], lanes_max[ZBX_AGGR_LANES];
+		int		j;
+
+		sign = AGGR_SET1_EPI64(__UINT64_C(0x8000000000000000));
+		vmin = vmax = _mm256_xor_si256(AGGR_LOAD_EPI64(values, 0), sign);
+
+		for (i = ZBX_AGGR_LANES; i + ZBX_AGGR_LANES <= num; i += ZBX_AGGR_LANES)
+		{
+			v = _mm256_xor_si256(AGGR_LOAD_EPI64(values, i), sign);
+			vmin = _mm256_blendv_epi8(vmin, v, _mm256_cmpgt_epi64(vmin, v));
+			vmax = _mm256_blendv_epi8(vmax, v, _mm256_cmpgt_epi64(v, vmax));
+		}
+
+		AGGR_STORE_EPI64(lanes_min, _mm256_xor_si256(vmin, sign));
+		AGGR_STORE_EPI64(lanes_max, _mm256_xor_si256(vmax, sign));
+
+		for (j = 0; j < ZBX_AGGR_LANES; j++)
+		{
+			if (lanes_min[j] < *min)
+				*min = lanes_min[j];
+
+			if (lanes_max[j] > *max)
+				*max = lanes_max[j];
+		}
+	}
+#endif
+	for (; i < num; i++)
+	{
+		if (values[i].value.ui64 < *min)
+			*min = values[i].value.ui64;
+
+		if (values[i].value.ui64 > *max)
+			*max = values[i].value.ui64;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: aggr_count_dbl                                                   *
+ *                                                                            *
+ * Purpose: counts floating point values matching the pattern                 *
+ *                                                                            *
+ * Parameters: values  - [IN] the history records                             *
+ *             num     - [IN] the number of records                           *
+ *             op      - [IN] the comparison operator (OP_EQ ... OP_LE)       *
+ *             pattern - [IN] the value to compare with                       *
+ *                                                                            *
+ * Return value: the number of matching values                                *
+ *                                                                            *
+ * Comments: The comparisons are done in the same way as in count_one_dbl().  *
+ *                                                                            *
+ ******************************************************************************/
+static int	aggr_count_dbl(const zbx_history_record_t *values, int num, int op, double pattern)
+{
+	int	i = 0, count = 0;
+
+	/* 'not equal' is counted as values that are not 'equal' */
+	if (OP_NE == op)
+		return num - aggr_count_dbl(values, num, OP_EQ, pattern);
+
+#if defined(ZBX_AGGR_LANES)
+	if (ZBX_AGGR_LANES <= num)
+	{
+		AGGR_PD		lo, hi, v, match;
+		AGGR_EPI64	acc = AGGR_ZERO_EPI64();
+		zbx_uint64_t	lanes[ZBX_AGGR_LANES];
+		int		j;
+
+		lo = AGGR_SET1_PD(pattern - ZBX_DOUBLE_EPSILON);
+		hi = AGGR_SET1_PD(pattern + ZBX_DOUBLE_EPSILON);
+
+		for (; i + ZBX_AGGR_LANES <= num; i += ZBX_AGGR_LANES)
+		{
+			v = AGGR_LOAD_PD(values, i);
+
+			switch (op)
+			{
+				case OP_EQ:
+					match = AGGR_AND_PD(AGGR_CMPLT_PD(lo, v), AGGR_CMPLT_PD(v, hi));
+					break;
+				case OP_GT:
+					match = AGGR_CMPLE_PD(hi, v);
+					break;
+				case OP_GE:
+					match = AGGR_CMPLT_PD(lo, v);
+					break;
+				case OP_LT:
+					match = AGGR_CMPLE_PD(v, lo);
+					break;
+				case OP_LE:
+					match = AGGR_CMPLT_PD(v, hi);
+					break;
+				default:
+					match = AGGR_ZERO_PD();
+			}
+
+			/* matching lanes have all bits set, which is -1 as integer */
+			acc = AGGR_SUB_EPI64(acc, AGGR_CAST_EPI64(match));
+		}
+
+		AGGR_STORE_EPI64(lanes, acc);
+
+		for (j = 0; j < ZBX_AGGR_LANES; j++)
+			count += (int)lanes[j];
+	}
+#endif
+	for (; i < num; i++)
+		count_one_dbl(&count, op, values[i].value.dbl, pattern);
+
+	return count;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: aggr_count_ui64                                                  *
+ *                                                                            *
+ * Purpose: counts unsigned integer values matching the pattern               *
+ *                                                                            *
+ * Parameters: values  - [IN] the history records                             *
+ *             num     - [IN] the number of records                           *
+ *             op      - [IN] the comparison operator (OP_EQ ... OP_BAND)     *
+ *             pattern - [IN] the value to compare with                       *
+ *             mask    - [IN] the mask for OP_BAND operator                   *
+ *                                                                            *
+ * Return value: the number of matching values                                *
+ *                                                                            *
+ * Comments: The comparisons are done in the same way as in count_one_ui64(). *
+ *           Like aggr_minmax_ui64() only AVX2 builds use vector path.        *
+ *                                                                            *
+ ******************************************************************************/
+static int	aggr_count_ui64(const zbx_history_record_t *values, int num, int op, zbx_uint64_t pattern,
+		zbx_uint64_t mask)
+{
+	int	i = 0, count = 0;
+
+	/* negated operators are counted as values not matching the opposite operator */
+	switch (op)
+	{
+		case OP_NE:
+			return num - aggr_count_ui64(values, num, OP_EQ, pattern, mask);
+		case OP_GE:
+			return num - aggr_count_ui64(values, num, OP_LT, pattern, mask);
+		case OP_LE:
+			return num - aggr_count_ui64(values, num, OP_GT, pattern, mask);
+	}
+
+#if defined(__AVX2__)
+	if (ZBX_AGGR_LANES <= num)
+	{
+		__m256i		v, vpattern, vmask, sign, acc = AGGR_ZERO_EPI64(), match;
+		zbx_uint64_t	lanes[ZBX_AGGR_LANES];
+		int		j;
+
+		sign = AGGR_SET1_EPI64(__UINT64_C(0x8000000000000000));
+		vpattern = AGGR_SET1_EPI64(pattern);
+		vmask = AGGR_SET1_EPI64(mask);
+
+		/* signed comparison of unsigned values with flipped sign bits */
+		if (OP_GT == op || OP_LT == op)
+			vpattern = _mm256_xor_si256(vpattern, sign);
+
+		for (; i + ZBX_AGGR_LANES <= num; i += ZBX_AGGR_LANES)
+		{
+			v = AGGR_LOAD_EPI64(values, i);
+
+			switch (op)
+			{
+				case OP_EQ:
+					match = _mm256_cmpeq_epi64(v, vpattern);
+					break;
+				case OP_GT:
+					match = _mm256_cmpgt_epi64(_mm256_xor_si256(v, sign), vpattern);
+					break;
+				case OP_LT:
+					match = _mm256_cmpgt_epi64(vpattern, _mm256_xor_si256(v, sign));
+					break;
+				case OP_BAND:
+					match = _mm256_cmpeq_epi64(AGGR_AND_EPI64(v, vmask), vpattern);
+					break;
+				default:
+					match = AGGR_ZERO_EPI64();
+			}
+
+			acc = AGGR_SUB_EPI64(acc, match);
+		}
+
+		AGGR_STORE_EPI64(lanes, acc);
+
+		for (j = 0; j < ZBX_AGGR_LANES; j++)
+			count += (int)lanes[j];
+	}
+#endif
+	for (; i < num; i++)
+		count_one_ui64(&count, op, values[i].value.ui64, pattern, mask);
+
+	return count;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: evaluate_COUNT                                                   *
+ *                                                                            *
+ * Purpose: evaluate function 'count' for the item                            *
+ *                                                                            *
+ * Parameters: item - item (performance metric)                               *
+ *             parameters - up to four comma-separated fields:                *
+ *                            (1) number of seconds/values                    *
+ *                            (2) value to compare with (optional)            *
+ *                                Becomes mandatory for numeric items if 3rd  *
+ *                                parameter is specified and is not "regexp"  *
+ *                                or "iregexp". With "band" can take one of   *
+ *                                2 forms:                                    *
+ *                                  - value_to_compare_with/mask              *
+ *                                  - mask                                    *
+ *                            (3) comparison operator (optional)              *
+ *                            (4) time shift (optional)                       *
+ *                                                                            *
+ * Return value: SUCCEED - evaluated successfully, result is stored in 'value'*
+ *               FAIL - failed to evaluate function                           *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  * 这段C语言代码的主要目的是实现一个名为evaluate_COUNT的函数，该函数用于统计输入值的数量。函数的输入参数包括：
  *
@@ -909,9 +1309,9 @@ static int	evaluate_COUNT(char *value, DC_ITEM *item, const char *parameters, co
 {
 	const char			*__function_name = "evaluate_COUNT";
 	int				arg1, op = OP_UNKNOWN, numeric_search, nparams, count = 0, i, ret = FAIL;
-	int				seconds = 0, nvalues = 0;
+	int				seconds = 0, nvalues = 0, pattern;
 	char				*arg2 = NULL, *arg2_2 = NULL, *arg3 = NULL, buf[ZBX_MAX_UINT64_LEN];
-	double				arg2_dbl;
+	double				arg2_dbl = 0;
 	zbx_uint64_t			arg2_ui64, arg2_2_ui64;
 	zbx_value_type_t		arg1_type;
 	zbx_vector_ptr_t		regexps;
@@ -962,7 +1362,7 @@ static int	evaluate_COUNT(char *value, DC_ITEM *item, const char *parameters, co
 		zbx_value_type_t	time_shift_type = ZBX_VALUE_SECONDS;
 
 		if (SUCCEED != get_function_parameter_int(item->host.hostid, parameters, 4, ZBX_PARAM_OPTIONAL,
-				&time_shift, &time_shift_type) || ZBX_PARAM_SECONDS != time_shift_type ||
+				&time_shift, &time_shift_type) || ZBX_VALUE_SECONDS != time_shift_type ||
 				0 > time_shift)
 		{
 			*error = zbx_strdup(*error, "invalid fourth parameter");
@@ -990,108 +1390,111 @@ static int	evaluate_COUNT(char *value, DC_ITEM *item, const char *parameters, co
 	else if (0 == strcmp(arg3, "like"))
 		op = OP_LIKE;
 	else if (0 == strcmp(arg3, "regexp"))
-		op = OP_REGEXP;
-	else if (0 == strcmp(arg3, "iregexp"))
-		op = OP_IREGEXP;
-	else if (0 == strcmp(arg3, "band"))
-		op = OP_BAND;
-
-	/* 判断获取到的运算符是否有效，如果不
-			goto out;
-		}
-	}
-	else
-		count = values.values_num;
-
-	zbx_snprintf(value, MAX_BUFFER_LEN, "%d", count);
-
-	ret = SUCCEED;
-out:
-	zbx_free(arg2);
-	zbx_free(arg3);
-
-	zbx_regexp_clean_expressions(&regexps);
-	zbx_vector_ptr_destroy(&regexps);
-
-	zbx_history_record_vector_destroy(&values, item->value_type);
-
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
-
-	return ret;
-}
-
-#undef OP_UNKNOWN
-#undef OP_EQ
-#undef OP_NE
-#undef OP_GT
-#undef OP_GE
-#undef OP_LT
-#undef OP_LE
-#undef OP_LIKE
-#undef OP_REGEXP
-#undef OP_IREGEXP
-#undef OP_BAND
-#undef OP_MAX
-
-/******************************************************************************
- *                                                                            *
- * Function: evaluate_SUM                                                     *
- *                                                                            *
- * Purpose: evaluate function 'sum' for the item                              *
- *                                                                            *
- * Parameters: item - item (performance metric)                               *
- *             parameters - number of seconds/values and time shift (optional)*
- *                                                                            *
- * Return value: SUCCEED - evaluated successfully, result is stored in 'value'*
- *               FAIL - failed to evaluate function                           *
- *                                                                            *
- ******************************************************************************/
-static int	evaluate_SUM(char *value, DC_ITEM *item, const char *parameters, const zbx_timespec_t *ts, char **error)
-{
-	const char			*__function_name = "evaluate_SUM";
-	int				nparams, arg1, i, ret = FAIL, seconds = 0, nvalues = 0;
-	zbx_value_type_t		arg1_type;
-	zbx_vector_history_record_t	values;
-	history_value_t			result;
-	zbx_timespec_t			ts_end = *ts;
-
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
-
-	zbx_history_record_vector_create(&values);
+		op = OP_REGEXP;
+	else if (0 == strcmp(arg3, "iregexp"))
+		op = OP_IREGEXP;
+	else if (0 == strcmp(arg3, "band"))
+		op = OP_BAND;
 
-	if (ITEM_VALUE_TYPE_FLOAT != item->value_type && ITEM_VALUE_TYPE_UINT64 != item->value_type)
+	if (OP_UNKNOWN == op)
 	{
-		*error = zbx_strdup(*error, "invalid value type");
+		*error = zbx_dsprintf(*error, "operator \"%s\" is not supported for function COUNT", arg3);
 		goto out;
 	}
 
-	if (2 < (nparams = num_param(parameters)))
+	numeric_search = (0 != numeric_search && OP_REGEXP != op && OP_IREGEXP != op);
+
+	if (0 != numeric_search)
 	{
-		*error = zbx_strdup(*error, "invalid number of parameters");
-		goto out;
-	}
+		if (NULL != arg3 && '\0' != *arg3 && '\0' == *arg2)
+		{
+			*error = zbx_strdup(*error, "pattern must be provided along with operator for numeric values");
+			goto out;
+		}
 
-	if (SUCCEED != get_function_parameter_int(item->host.hostid, parameters, 1, ZBX_PARAM_MANDATORY, &arg1,
-			&arg1_type) || 0 >= arg1)
+		if (OP_LIKE == op)
+		{
+			*error = zbx_dsprintf(*error, "operator \"%s\" is not supported for counting numeric values",
+					arg3);
+			goto out;
+		}
+
+		if (OP_BAND == op && ITEM_VALUE_TYPE_FLOAT == item->value_type)
+		{
+			*error = zbx_dsprintf(*error, "operator \"%s\" is not supported for counting float values",
+					arg3);
+			goto out;
+		}
+
+		if (OP_BAND == op && NULL != (arg2_2 = strchr(arg2, '/')))
+		{
+			*arg2_2 = '\0';	/* end of the 1st part of the 2nd parameter (number to compare with) */
+			arg2_2++;	/* start of the 2nd part of the 2nd parameter (mask) */
+		}
+
+		if (NULL != arg2 && '\0' != *arg2)
+		{
+			if (ITEM_VALUE_TYPE_UINT64 == item->value_type)
+			{
+				if (OP_BAND != op)
+				{
+					if (SUCCEED != str2uint64(arg2, ZBX_UNIT_SYMBOLS, &arg2_ui64))
+					{
+						*error = zbx_dsprintf(*error, "\"%s\" is not a valid numeric unsigned"
+								" value", arg2);
+						goto out;
+					}
+				}
+				else
+				{
+					if (SUCCEED != is_uint64(arg2, &arg2_ui64))
+					{
+						*error = zbx_dsprintf(*error, "\"%s\" is not a valid numeric unsigned"
+								" value", arg2);
+						goto out;
+					}
+
+					if (NULL != arg2_2)
+					{
+						if (SUCCEED != is_uint64(arg2_2, &arg2_2_ui64))
+						{
+							*error = zbx_dsprintf(*error, "\"%s\" is not a valid numeric"
+									" unsigned value", arg2_2);
+							goto out;
+						}
+					}
+					else
+						arg2_2_ui64 = arg2_ui64;
+				}
+			}
+			else
+			{
+				if (SUCCEED != is_double_suffix(arg2, ZBX_FLAG_DOUBLE_SUFFIX))
+				{
+					*error = zbx_dsprintf(*error, "\"%s\" is not a valid numeric float value",
+							arg2);
+					goto out;
+				}
+
+				arg2_dbl = str2double(arg2);
+			}
+		}
+	}
+	else if (OP_LIKE != op && OP_REGEXP != op && OP_IREGEXP != op && OP_EQ != op && OP_NE != op)
 	{
-		*error = zbx_strdup(*error, "invalid first parameter");
+		*error = zbx_dsprintf(*error, "operator \"%s\" is not supported for counting textual values", arg3);
 		goto out;
 	}
 
-	if (2 == nparams)
+	if ((OP_REGEXP == op || OP_IREGEXP == op) && '@' == *arg2)
 	{
-		int			time_shift = 0;
-		zbx_value_type_t	time_shift_type = ZBX_VALUE_SECONDS;
+		DCget_expressions_by_name(&regexps, arg2 + 1);
 
-		if (SUCCEED != get_function_parameter_int(item->host.hostid, parameters, 2, ZBX_PARAM_OPTIONAL,
-				&time_shift, &time_shift_type) || ZBX_VALUE_SECONDS != time_shift_type ||
-				0 > time_shift)
+		if (0 == regexps.values_num)
 		{
-			*error = zbx_strdup(*error, "invalid second parameter");
+			*error = zbx_dsprintf(*error, "global regular expression \"%s\" does not exist", arg2 + 1);
 			goto out;
 		}
-
-		ts_end.sec -= time_shift;
 	}
 
 	switch (arg1_type)
@@ -1106,30 +1509,86 @@ static int	evaluate_SUM(char *value, DC_ITEM *item, const char *parameters, cons
 			THIS_SHOULD_NEVER_HAPPEN;
 	}
 
+	/* skip counting values one by one if both pattern and operator are empty or "" is searched in text values */
+	pattern = ((NULL != arg2 && '\0' != *arg2) || (NULL != arg3 && '\0' != *arg3 &&
+			OP_LIKE != op && OP_REGEXP != op && OP_IREGEXP != op));
+
+	/* the number of values in long periods can be counted by history storage */
+	if (0 == pattern && 0 != seconds && SUCCEED == zbx_history_get_aggregate(item->itemid, item->value_type,
+			ZBX_HISTORY_AGGR_COUNT, ts_end.sec - seconds, ts_end.sec, NULL, &count))
+	{
+		zbx_snprintf(value, MAX_BUFFER_LEN, "%d", count);
+		ret = SUCCEED;
+		goto out;
+	}
+
 	if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
 	{
 		*error = zbx_strdup(*error, "cannot get values from value cache");
 		goto out;
 	}
 
-	if (ITEM_VALUE_TYPE_FLOAT == item->value_type)
+	if (0 != pattern)
 	{
-		result.dbl = 0;
+		switch (item->value_type)
+		{
+			case ITEM_VALUE_TYPE_UINT64:
+				if (0 != numeric_search)
+				{
+					count = aggr_count_ui64(values.values, values.values_num, op, arg2_ui64,
+							arg2_2_ui64);
+				}
+				else
+				{
+					for (i = 0; i < values.values_num && FAIL != count; i++)
+					{
+						zbx_snprintf(buf, sizeof(buf), ZBX_FS_UI64,
+								values.values[i].value.ui64);
+						count_one_str(&count, op, buf, arg2, &regexps);
+					}
+				}
+				break;
+			case ITEM_VALUE_TYPE_FLOAT:
+				if (0 != numeric_search)
+					count = aggr_count_dbl(values.values, values.values_num, op, arg2_dbl);
+				else
+				{
+					for (i = 0; i < values.values_num && FAIL != count; i++)
+					{
+						zbx_snprintf(buf, sizeof(buf), ZBX_FS_DBL_EXT(4),
+								values.values[i].value.dbl);
+						count_one_str(&count, op, buf, arg2, &regexps);
+					}
+				}
+				break;
+			case ITEM_VALUE_TYPE_LOG:
+				for (i = 0; i < values.values_num && FAIL != count; i++)
+					count_one_str(&count, op, values.values[i].value.log->value, arg2, &regexps);
+				break;
+			default:
+				for (i = 0; i < values.values_num && FAIL != count; i++)
+					count_one_str(&count, op, values.values[i].value.str, arg2, &regexps);
+		}
 
-		for (i = 0; i < values.values_num; i++)
-			result.dbl += values.values[i].value.dbl;
+		if (FAIL == count)
+		{
+			*error = zbx_strdup(*error, "invalid regular expression");
+			goto out;
+		}
 	}
 	else
-	{
-		result.ui64 = 0;
+		count = values.values_num;
 
-		for (i = 0; i < values.values_num; i++)
-			result.ui64 += values.values[i].value.ui64;
-	}
+	zbx_snprintf(value, MAX_BUFFER_LEN, "%d", count);
 
-	zbx_history_value2str(value, MAX_BUFFER_LEN, &result, item->value_type);
 	ret = SUCCEED;
 out:
+	zbx_free(arg2);
+	zbx_free(arg3);
+
+	zbx_regexp_clean_expressions(&regexps);
+	zbx_vector_ptr_destroy(&regexps);
+
 	zbx_history_record_vector_destroy(&values, item->value_type);
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
@@ -1137,60 +1596,67 @@ out:
 	return ret;
 }
 
+#undef OP_UNKNOWN
+#undef OP_EQ
+#undef OP_NE
+#undef OP_GT
+#undef OP_GE
+#undef OP_LT
+#undef OP_LE
+#undef OP_LIKE
+#undef OP_REGEXP
+#undef OP_IREGEXP
+#undef OP_BAND
+#undef OP_MAX
+
 /******************************************************************************
  *                                                                            *
- * Function: evaluate_AVG                                                     *
+ * Function: evaluate_aggregate                                               *
  *                                                                            *
- * Purpose: evaluate function 'avg' for the item                              *
+ * Purpose: gets aggregate of item values without reading them from value     *
+ *          cache                                                             *
  *                                                                            *
- * Parameters: item - item (performance metric)                               *
- *             parameters - number of seconds/values and time shift (optional)*
+ * Parameters: item    - [IN] the item                                        *
+ *             type    - [IN] the aggregate type (ZBX_VC_AGGR_*)              *
+ *             seconds - [IN] the time period                                 *
+ *             nvalues - [IN] the number of values                            *
+ *             ts      - [IN] the period end timestamp                        *
+ *             value   - [OUT] the aggregated value                           *
+ *             num     - [OUT] the number of aggregated values                *
  *                                                                            *
- * Return value: SUCCEED - evaluated successfully, result is stored in 'value'*
- *               FAIL - failed to evaluate function                           *
+ * Return value: SUCCEED - the aggregate was calculated                       *
+ *               FAIL    - the values must be read from value cache           *
+ *                                                                            *
+ * Comments: The running aggregate of value cache is used if possible,        *
+ *           otherwise periods can be aggregated by history storage.          *
  *                                                                            *
  ******************************************************************************/
-/******************************************************************************
- * *
- *这段代码的主要目的是计算指定物品的平均值。它接收一个物品、参数列表、时间戳和一个错误指针。首先，它检查物品的值类型和参数列表的合法性。然后，根据参数计算时间偏移，并获取物品的历史数据。接下来，根据物品的值类型计算平均值，并将结果存储在指定的字符串中。最后，返回成功或失败的结果。
- *
- *代码注释详细说明了每个步骤的操作和意义，使得初学者可以更容易地理解代码的功能和实现方式。
- ******************************************************************************/
-static int evaluate_AVG(char *value, DC_ITEM *item, const char *parameters, const zbx_timespec_t *ts, char **error)
+static int	evaluate_aggregate(const DC_ITEM *item, int type, int seconds, int nvalues, const zbx_timespec_t *ts,
+		history_value_t *value, int *num)
 {
-	const char *__function_name = "evaluate_AVG";
-	int nparams, arg1, ret = FAIL, i, seconds = 0, nvalues = 0;
-	zbx_value_type_t arg1_type;
-	zbx_vector_history_record_t values;
-	zbx_timespec_t ts_end = *ts;
-
-	// 开启调试日志
-	zabbix_log(LOG_LEVEL_DEBUG, "进入%s()", __function_name);
-
-	// 创建历史记录向量
-	zbx_history_record_vector_create(&values);
+	if (SUCCEED == zbx_vc_get_aggregate(item->itemid, item->value_type, type, seconds, nvalues, ts, value, num))
+		return SUCCEED;
 
-	// 检查物品值类型是否为浮点数或无符号整数
-	if (ITEM_VALUE_TYPE_FLOAT != item->value_type && ITEM_VALUE_TYPE_UINT64 != item->value_type)
-	{
-		*error = zbx_strdup(*error, "无效的值类型");
-		goto out;
-	}
+	if (0 == seconds)
+		return FAIL;
 
-	// 检查参数数量是否为2或更多
-	if (2 < (nparams = num_param(parameters)))
-	{
-		*error = zbx_strdup(*error, "无效的参数数量");
-		goto out;
-	}
+	return zbx_history_get_aggregate(item->itemid, item->value_type, type, ts->sec - seconds, ts->sec, value,
+			num);
+}
 
-	// 获取并验证第一个参数
-	if (SUCCEED != get_function_parameter_int(item->host.hostid, parameters, 1, ZBX_PARAM_MANDATORY, &arg1,
-			&arg1_type) || 0 >= arg1)
-	{
-		*error = zbx_strdup(*error, "无效的第一个参数");
-		goto out;
-	}
+/******************************************************************************
+ *                                                                            *
+ * Function: evaluate_SUM                                                     *
+ *                                                                            *
+ * Purpose: evaluate function 'sum' for the item                              *
+ *                                                                            *
+ * Parameters: item - item (performance metric)                               *
+ *             parameters - number of seconds/values and time shift (optional)*
+ *                                                                            *
+ * Return value: SUCCEED - evaluated successfully, result is stored in 'value'*
+ *               FAIL - failed to evaluate function                           *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  * *
  *该代码的主要目的是计算给定item的历史值总和。首先，它检查参数的合法性，然后获取item的历史值。根据item的价值类型（浮点数或无符号整数），计算各个历史值的总和，并将结果存储在指定的字符串中。最后，返回计算结果。
@@ -1200,7 +1666,7 @@ static int evaluate_SUM(char *value, DC_ITEM *item, const char *parameters, cons
 {
     // 定义一些变量
     const char *__function_name = "evaluate_SUM";
-    int nparams, arg1, i, ret = FAIL, seconds = 0, nvalues = 0;
+    int nparams, arg1, ret = FAIL, seconds = 0, nvalues = 0, num;
     zbx_value_type_t arg1_type;
     zbx_vector_history_record_t values;
     history_value_t result;
@@ -1264,49 +1730,186 @@ static int evaluate_SUM(char *value, DC_ITEM *item, const char *parameters, cons
             THIS_SHOULD_NEVER_HAPPEN;
     }
 
-    // 获取item的历史值
-    if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
-    {
-        *error = zbx_strdup(*error, "cannot get values from value cache");
-        goto out;
-    }
+    /* the running aggregate is updated with new values, so the period values are not read every time */
+    if (SUCCEED == evaluate_aggregate(item, ZBX_VC_AGGR_SUM, seconds, nvalues, &ts_end, &result, &num))
+    {
+        if (0 == num)
+            memset(&result, 0, sizeof(result));
+    }
+    else
+    {
+        // 获取item的历史值
+        if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
+        {
+            *error = zbx_strdup(*error, "cannot get values from value cache");
+            goto out;
+        }
+
+        // 根据item的价值类型计算总和
+        if (ITEM_VALUE_TYPE_FLOAT == item->value_type)
+            result.dbl = aggr_sum_dbl(values.values, values.values_num);
+        else
+            result.ui64 = aggr_sum_ui64(values.values, values.values_num);
+    }
+
+    // 将结果转换为字符串并存储在value中
+    zbx_history_value2str(value, MAX_BUFFER_LEN, &result, item->value_type);
+    ret = SUCCEED;
+
+out:
+    // 销毁历史记录向量
+    zbx_history_record_vector_destroy(&values, item->value_type);
+
+    // 打印调试信息
+    zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
+
+    return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: evaluate_AVG                                                     *
+ *                                                                            *
+ * Purpose: evaluate function 'avg' for the item                              *
+ *                                                                            *
+ * Parameters: item - item (performance metric)                               *
+ *             parameters - number of seconds/values and time shift (optional)*
+ *                                                                            *
+ * Return value: SUCCEED - evaluated successfully, result is stored in 'value'*
+ *               FAIL - failed to evaluate function                           *
+ *                                                                            *
+ ******************************************************************************/
+/******************************************************************************
+ * *
+ *这段代码的主要目的是计算指定物品的平均值。它接收一个物品、参数列表、时间戳和一个错误指针。首先，它检查物品的值类型和参数列表的合法性。然后，根据参数计算时间偏移，并获取物品的历史数据。接下来，根据物品的值类型计算平均值，并将结果存储在指定的字符串中。最后，返回成功或失败的结果。
+ *
+ *代码注释详细说明了每个步骤的操作和意义，使得初学者可以更容易地理解代码的功能和实现方式。
+ ******************************************************************************/
+static int	evaluate_AVG(char *value, DC_ITEM *item, const char *parameters, const zbx_timespec_t *ts, char **error)
+{
+	const char			*__function_name = "evaluate_AVG";
+	int				nparams, arg1, ret = FAIL, seconds = 0, nvalues = 0, num;
+	zbx_value_type_t		arg1_type;
+	zbx_vector_history_record_t	values;
+	history_value_t			avg;
+	zbx_timespec_t			ts_end = *ts;
+
+	// 创建历史记录向量
+	// 开启调试日志
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
+
+	zbx_history_record_vector_create(&values);
+
+	// 检查物品值类型是否为浮点数或无符号整数
+	if (ITEM_VALUE_TYPE_FLOAT != item->value_type && ITEM_VALUE_TYPE_UINT64 != item->value_type)
+	{
+		*error = zbx_strdup(*error, "invalid value type");
+		goto out;
+	}
+
+	// 检查参数数量是否为2或更多
+	if (2 < (nparams = num_param(parameters)))
+	{
+		*error = zbx_strdup(*error, "invalid number of parameters");
+		goto out;
+	}
+
+	// 获取并验证第一个参数
+	if (SUCCEED != get_function_parameter_int(item->host.hostid, parameters, 1, ZBX_PARAM_MANDATORY, &arg1,
+			&arg1_type) || 0 >= arg1)
+	{
+		*error = zbx_strdup(*error, "invalid first parameter");
+		goto out;
+	}
+
+	if (2 == nparams)
+	{
+		int			time_shift = 0;
+		zbx_value_type_t	time_shift_type = ZBX_VALUE_SECONDS;
+
+		if (SUCCEED != get_function_parameter_int(item->host.hostid, parameters, 2, ZBX_PARAM_OPTIONAL,
+				&time_shift, &time_shift_type) || ZBX_VALUE_SECONDS != time_shift_type ||
+				0 > time_shift)
+		{
+			*error = zbx_strdup(*error, "invalid second parameter");
+			goto out;
+		}
+
+		ts_end.sec -= time_shift;
+	}
+
+	switch (arg1_type)
+	{
+		case ZBX_VALUE_SECONDS:
+			seconds = arg1;
+			break;
+		case ZBX_VALUE_NVALUES:
+			nvalues = arg1;
+			break;
+		default:
+			THIS_SHOULD_NEVER_HAPPEN;
+	}
+
+	if (SUCCEED != evaluate_aggregate(item, ZBX_VC_AGGR_AVG, seconds, nvalues, &ts_end, &avg, &num))
+	{
+		if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
+		{
+			*error = zbx_strdup(*error, "cannot get values from value cache");
+			goto out;
+		}
 
-    // 根据item的价值类型计算总和
-    if (ITEM_VALUE_TYPE_FLOAT == item->value_type)
-    {
-        result.dbl = 0;
+		if (0 < (num = values.values_num))
+		{
+			double	sum;
 
-        for (i = 0; i < values.values_num; i++)
-            result.dbl += values.values[i].value.dbl;
-    }
-    else
-    {
-        result.ui64 = 0;
+			if (ITEM_VALUE_TYPE_FLOAT == item->value_type)
+				sum = aggr_sum_dbl(values.values, values.values_num);
+			else
+				sum = aggr_sum_ui64_dbl(values.values, values.values_num);
 
-        for (i = 0; i < values.values_num; i++)
-            result.ui64 += values.values[i].value.ui64;
-    }
+			avg.dbl = sum / num;
+		}
+	}
 
-    // 将结果转换为字符串并存储在value中
-    zbx_history_value2str(value, MAX_BUFFER_LEN, &result, item->value_type);
-    ret = SUCCEED;
+	if (0 < num)
+	{
+		zbx_snprintf(value, MAX_BUFFER_LEN, ZBX_FS_DBL, avg.dbl);
 
+		ret = SUCCEED;
+	}
+	else
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "result for AVG is empty");
+		*error = zbx_strdup(*error, "not enough data");
+	}
 out:
-    // 销毁历史记录向量
-    zbx_history_record_vector_destroy(&values, item->value_type);
+	zbx_history_record_vector_destroy(&values, item->value_type);
 
-    // 打印调试信息
-    zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
 
-    return ret;
+	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: evaluate_LAST                                                    *
+ *                                                                            *
+ * Purpose: evaluate functions 'last' and 'prev' for the item                 *
+ *                                                                            *
+ * Parameters: value - buffer of size MAX_BUFFER_LEN                          *
+ *             item - item (performance metric)                               *
+ *             parameters - Nth last value and time shift (optional)          *
+ *                                                                            *
+ * Return value: SUCCEED - evaluated successfully, result is stored in 'value'*
+ *               FAIL - failed to evaluate function                           *
+ *                                                                            *
  ******************************************************************************/
 // 定义一个静态函数 evaluate_LAST，接收五个参数：一个字符指针 value，一个 DC_ITEM 结构指针 item，一个字符指针参数串 pointer，一个 zbx_timespec_t 结构指针 ts，以及一个错误指针 error。
-static int evaluate_LAST(char *value, DC_ITEM *item, const char *parameters, const zbx_timespec_t *ts, char **error)
+static int	evaluate_LAST(char *value, DC_ITEM *item, const char *parameters, const zbx_timespec_t *ts,
+		char **error)
 {
 	// 定义一些常量和变量，如日志级别、函数名、参数索引等
-	const char *__function_name = "evaluate_LAST";
+	const char			*__function_name = "evaluate_LAST";
 	int				arg1 = 1, ret = FAIL;
 	zbx_value_type_t		arg1_type = ZBX_VALUE_NVALUES;
 	zbx_vector_history_record_t	values;
@@ -1319,7 +1922,8 @@ static int evaluate_LAST(char *value, DC_ITEM *item, const char *parameters, con
 	zbx_history_record_vector_create(&values);
 
 	// 获取第一个参数，并判断类型
-	if (SUCCEED != get_function_parameter_int(item->host.hostid, parameters, 1, ZBX_PARAM_OPTIONAL, &arg1, &arg1_type))
+	if (SUCCEED != get_function_parameter_int(item->host.hostid, parameters, 1, ZBX_PARAM_OPTIONAL, &arg1,
+			&arg1_type))
 	{
 		*error = zbx_strdup(*error, "invalid first parameter");
 		goto out;
@@ -1327,7 +1931,7 @@ static int evaluate_LAST(char *value, DC_ITEM *item, const char *parameters, con
 
 	// 如果第一个参数不是 ZBX_VALUE_NVALUES 类型，则将其设置为 1，以支持旧版本的语法 "last(0)"
 	if (ZBX_VALUE_NVALUES != arg1_type)
-		arg1 = 1;
+		arg1 = 1;	/* non-# first parameter is ignored to support older syntax "last(0)" */
 
 	// 检查参数个数，如果为2，则获取第二个参数并判断类型
 	if (2 == num_param(parameters))
@@ -1336,7 +1940,8 @@ static int evaluate_LAST(char *value, DC_ITEM *item, const char *parameters, con
 		zbx_value_type_t	time_shift_type = ZBX_VALUE_SECONDS;
 
 		// 获取第二个参数，并判断类型
-		if (SUCCEED != get_function_parameter_int(item->host.hostid, parameters, 2, ZBX_PARAM_OPTIONAL, &time_shift, &time_shift_type) || ZBX_VALUE_SECONDS != time_shift_type ||
+		if (SUCCEED != get_function_parameter_int(item->host.hostid, parameters, 2, ZBX_PARAM_OPTIONAL,
+				&time_shift, &time_shift_type) || ZBX_VALUE_SECONDS != time_shift_type ||
 				0 > time_shift)
 		{
 			*error = zbx_strdup(*error, "invalid second parameter");
@@ -1353,7 +1958,8 @@ static int evaluate_LAST(char *value, DC_ITEM *item, const char *parameters, con
 		// 如果 arg1 小于等于历史记录的数量，则获取最后一个值的字符串表示，并返回成功
 		if (arg1 <= values.values_num)
 		{
-			zbx_history_value2str(value, MAX_BUFFER_LEN, &values.values[arg1 - 1].value, item->value_type);
+			zbx_history_value2str(value, MAX_BUFFER_LEN, &values.values[arg1 - 1].value,
+					item->value_type);
 			ret = SUCCEED;
 		}
 		else
@@ -1376,6 +1982,20 @@ out:
 	// 返回结果
 	return ret;
 }
+
+/******************************************************************************
+ *                                                                            *
+ * Function: evaluate_MIN                                                     *
+ *                                                                            *
+ * Purpose: evaluate function 'min' for the item                              *
+ *                                                                            *
+ * Parameters: item - item (performance metric)                               *
+ *             parameters - number of seconds/values and time shift (optional)*
+ *                                                                            *
+ * Return value: SUCCEED - evaluated successfully, result is stored in 'value'*
+ *               FAIL - failed to evaluate function                           *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  * *
  *主要目的：这个代码块定义了一个名为`evaluate_MIN`的函数，用于计算某个数据项（可能是浮点数或无符号整数）的历史最小值。函数接收五个参数：一个字符串指针`value`，一个`DC_ITEM`结构体指针`item`，一个字符串指针`parameters`，一个`zbx_timespec_t`结构体指针`ts`，以及一个错误指针`error`。
@@ -1394,9 +2014,10 @@ out:
 static int evaluate_MIN(char *value, DC_ITEM *item, const char *parameters, const zbx_timespec_t *ts, char **error)
 {
 	const char *__function_name = "evaluate_MIN"; // 定义一个内部函数名，便于调试
-	int nparams, arg1, i, ret = FAIL, seconds = 0, nvalues = 0; // 定义所需变量
+	int nparams, arg1, ret = FAIL, seconds = 0, nvalues = 0, num; // 定义所需变量
 	zbx_value_type_t arg1_type; // 定义变量类型
 	zbx_vector_history_record_t values; // 定义一个历史记录向量
+	history_value_t min, max;
 	zbx_timespec_t ts_end = *ts; // 定义时间戳
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name); // 打印调试信息，进入函数
@@ -1450,33 +2071,28 @@ static int evaluate_MIN(char *value, DC_ITEM *item, const char *parameters, cons
 			THIS_SHOULD_NEVER_HAPPEN; // 非法情况，不应该发生
 	}
 
-	if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end)) // 获取物品值
-	{
-		*error = zbx_strdup(*error, "cannot get values from value cache"); // 错误信息
-		goto out; // 跳转到out标签
-	}
-
-	if (0 < values.values_num) // 判断获取到的值的数量是否大于0
+	if (SUCCEED != evaluate_aggregate(item, ZBX_VC_AGGR_MIN, seconds, nvalues, &ts_end, &min, &num))
 	{
-		int index = 0; // 定义一个索引
-
-		if (ITEM_VALUE_TYPE_UINT64 == item->value_type) // 如果是无符号整数类型
+		// 获取物品值
+		if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
 		{
-			for (i = 1; i < values.values_num; i++) // 遍历所有值
-			{
-				if (values.values[i].value.ui64 < values.values[index].value.ui64) // 找到最小值
-					index = i;
-			}
+			*error = zbx_strdup(*error, "cannot get values from value cache"); // 错误信息
+			goto out; // 跳转到out标签
 		}
-		else // 如果是浮点数类型
+
+		if (0 < (num = values.values_num)) // 判断获取到的值的数量是否大于0
 		{
-			for (i = 1; i < values.values_num; i++)
-			{
-				if (values.values[i].value.dbl < values.values[index].value.dbl) // 找到最小值
-					index = i;
-			}
+			if (ITEM_VALUE_TYPE_UINT64 == item->value_type) // 如果是无符号整数类型
+				aggr_minmax_ui64(values.values, values.values_num, &min.ui64, &max.ui64);
+			else // 如果是浮点数类型
+				aggr_minmax_dbl(values.values, values.values_num, &min.dbl, &max.dbl);
 		}
-		zbx_history_value2str(value, MAX_BUFFER_LEN, &values.values[index].value, item->value_type); // 将最小值转换为字符串并赋值给value
+	}
+
+	if (0 < num)
+	{
+		// 将最小值转换为字符串并赋值给value
+		zbx_history_value2str(value, MAX_BUFFER_LEN, &min, item->value_type);
 
 		ret = SUCCEED; // 返回成功
 	}
@@ -1493,22 +2109,6 @@ out: // 跳出函数
 	return ret; // 返回函数执行结果
 }
 
-
-		ret = SUCCEED;
-	}
-	else
-	{
-		zabbix_log(LOG_LEVEL_DEBUG, "result for MIN is empty");
-		*error = zbx_strdup(*error, "not enough data");
-	}
-out:
-	zbx_history_record_vector_destroy(&values, item->value_type);
-
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
-
-	return ret;
-}
-
 /******************************************************************************
  *                                                                            *
  * Function: evaluate_MAX                                                     *
@@ -1522,30 +2122,45 @@ out:
  *               FAIL - failed to evaluate function                           *
  *                                                                            *
  ******************************************************************************/
+/******************************************************************************
+ * *
+ *主要目的：这个函数用于计算指定 item 的最大值，并将结果存储在 value 指向的字符串中。函数接收 5 个参数，分别是 value、item、parameters、ts 和 error。通过对这些参数的验证和处理，计算出最大值，并返回成功与否的标志。如果成功，返回 SUCCEED；如果失败，返回 FAIL。
+ ******************************************************************************/
+// 定义静态函数 evaluate_MAX，接收 5 个参数：一个字符指针 value，一个 DC_ITEM 结构体指针 item，一个字符指针参数指针 parameters，一个 zbx_timespec_t 结构体指针 ts，以及一个字符指针指针 error。
 static int	evaluate_MAX(char *value, DC_ITEM *item, const char *parameters, const zbx_timespec_t *ts, char **error)
 {
+	// 定义常量字符串 __function_name，表示函数名
 	const char			*__function_name = "evaluate_MAX";
-	int				nparams, arg1, ret = FAIL, i, seconds = 0, nvalues = 0;
+	// 定义变量 nparams、arg1、ret、i、seconds、nvalues，以及 zbx_value_type_t 类型的 arg1_type
+	int				nparams, arg1, ret = FAIL, seconds = 0, nvalues = 0, num;
 	zbx_value_type_t		arg1_type;
+	// 定义 zbx_vector_history_record_t 类型的变量 values
 	zbx_vector_history_record_t	values;
+	history_value_t			min, max;
+	// 定义 zbx_timespec_t 类型的变量 ts_end，表示时间戳的结束时间
 	zbx_timespec_t			ts_end = *ts;
 
+	// 打印调试日志，表示函数开始执行
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
 
+	// 创建一个历史记录向量 values
 	zbx_history_record_vector_create(&values);
 
+	// 判断 item 的值类型是否为浮点数或无符号整数，如果不是，则报错并退出函数
 	if (ITEM_VALUE_TYPE_FLOAT != item->value_type && ITEM_VALUE_TYPE_UINT64 != item->value_type)
 	{
 		*error = zbx_strdup(*error, "invalid value type");
 		goto out;
 	}
 
+	// 判断 parameters 字符串中的参数个数是否为 2 或更多，如果是，则报错并退出函数
 	if (2 < (nparams = num_param(parameters)))
 	{
 		*error = zbx_strdup(*error, "invalid number of parameters");
 		goto out;
 	}
 
+	// 获取函数参数，第一个参数应为整数，且不能为 0
 	if (SUCCEED != get_function_parameter_int(item->host.hostid, parameters, 1, ZBX_PARAM_MANDATORY, &arg1,
 			&arg1_type) || 0 >= arg1)
 	{
@@ -1553,11 +2168,13 @@ static int	evaluate_MAX(char *value, DC_ITEM *item, const char *parameters, cons
 		goto out;
 	}
 
+	// 判断参数个数为 2 时，第二个参数是否为可选参数，如果是，则获取第二个参数
 	if (2 == nparams)
 	{
 		int			time_shift = 0;
 		zbx_value_type_t	time_shift_type = ZBX_VALUE_SECONDS;
 
+		// 获取可选的第二个参数，判断其值类型是否为秒，如果不符合要求，则报错并退出函数
 		if (SUCCEED != get_function_parameter_int(item->host.hostid, parameters, 2, ZBX_PARAM_OPTIONAL,
 				&time_shift, &time_shift_type) || ZBX_VALUE_SECONDS != time_shift_type ||
 				0 > time_shift)
@@ -1566,96 +2183,127 @@ static int	evaluate_MAX(char *value, DC_ITEM *item, const char *parameters, cons
 			goto out;
 		}
 
+		// 更新时间戳的结束时间
 		ts_end.sec -= time_shift;
 	}
 
+	// 判断 arg1_type 的值，根据不同的值类型执行相应的操作
 	switch (arg1_type)
 	{
 		case ZBX_VALUE_SECONDS:
+			// 如果值为秒，则设置 seconds 为 arg1
 			seconds = arg1;
 			break;
 		case ZBX_VALUE_NVALUES:
+			// 如果值为无符号整数，则设置 nvalues 为 arg1
 			nvalues = arg1;
 			break;
 		default:
+			// 不应该出现这种情况，记录错误并退出函数
 			THIS_SHOULD_NEVER_HAPPEN;
 	}
 
-	if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
-	{
-		*error = zbx_strdup(*error, "cannot get values from value cache");
-		goto out;
-	}
-
-	if (0 < values.values_num)
+	if (SUCCEED != evaluate_aggregate(item, ZBX_VC_AGGR_MAX, seconds, nvalues, &ts_end, &max, &num))
 	{
-		int	index = 0;
-
-		if (ITEM_VALUE_TYPE_UINT64 == item->value_type)
+		// 获取 item 的值，存储在 values 向量中
+		if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
 		{
-			for (i = 1; i < values.values_num; i++)
-			{
-				if (values.values[i].value.ui64 > values.values[index].value.ui64)
-					index = i;
-			}
+			*error = zbx_strdup(*error, "cannot get values from value cache");
+			goto out;
 		}
-		else
+
+		// 如果 values 向量不为空，则获取最大值，并将结果存储在 value 指向的字符串中
+		if (0 < (num = values.values_num))
 		{
-			for (i = 1; i < values.values_num; i++)
-			{
-				if (values.values[i].value.dbl > values.values[index].value.dbl)
-					index = i;
-			}
+			if (ITEM_VALUE_TYPE_UINT64 == item->value_type)
+				aggr_minmax_ui64(values.values, values.values_num, &min.ui64, &max.ui64);
+			else
+				aggr_minmax_dbl(values.values, values.values_num, &min.dbl, &max.dbl);
 		}
-		zbx_history_value2str(value, MAX_BUFFER_LEN, &values.values[index].value, item->value_type);
+	}
+
+	if (0 < num)
+	{
+		// 将最大值转换为字符串并存储在 value 指向的字符串中
+		zbx_history_value2str(value, MAX_BUFFER_LEN, &max, item->value_type);
 
+		// 设置函数执行成功
 		ret = SUCCEED;
 	}
 	else
 	{
+		// 打印日志，表示结果为空
 		zabbix_log(LOG_LEVEL_DEBUG, "result for MAX is empty");
 		*error = zbx_strdup(*error, "not enough data");
 	}
+
 out:
+	// 销毁向量 values，释放内存
 	zbx_history_record_vector_destroy(&values, item->value_type);
+
+	// 打印调试日志，表示函数执行结束
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
+
+	// 返回函数执行结果
+	return ret;
+}
+
+static int	__history_record_float_compare(const zbx_history_record_t *d1, const zbx_history_record_t *d2)
+{
+	ZBX_RETURN_IF_NOT_EQUAL(d1->value.dbl, d2->value.dbl);
+
+	return 0;
+}
+
+static int	__history_record_uint64_compare(const zbx_history_record_t *d1, const zbx_history_record_t *d2)
+{
+	ZBX_RETURN_IF_NOT_EQUAL(d1->value.ui64, d2->value.ui64);
+
+	return 0;
+}
+
 /******************************************************************************
- * *
- *主要目的：这个函数用于计算指定 item 的最大值，并将结果存储在 value 指向的字符串中。函数接收 5 个参数，分别是 value、item、parameters、ts 和 error。通过对这些参数的验证和处理，计算出最大值，并返回成功与否的标志。如果成功，返回 SUCCEED；如果失败，返回 FAIL。
+ *                                                                            *
+ * Function: evaluate_PERCENTILE                                              *
+ *                                                                            *
+ * Purpose: evaluate function 'percentile' for the item                       *
+ *                                                                            *
+ * Parameters: item       - [IN] item (performance metric)                    *
+ *             parameters - [IN] seconds/values, time shift (optional),       *
+ *                               percentage                                   *
+ *                                                                            *
+ * Return value: SUCCEED - evaluated successfully, result is stored in        *
+ *                         'value'                                            *
+ *               FAIL    - failed to evaluate function                        *
+ *                                                                            *
  ******************************************************************************/
-// 定义静态函数 evaluate_MAX，接收 5 个参数：一个字符指针 value，一个 DC_ITEM 结构体指针 item，一个字符指针参数指针 parameters，一个 zbx_timespec_t 结构体指针 ts，以及一个字符指针指针 error。
-static int evaluate_MAX(char *value, DC_ITEM *item, const char *parameters, const zbx_timespec_t *ts, char **error)
+static int	evaluate_PERCENTILE(char *value, DC_ITEM *item, const char *parameters,
+		const zbx_timespec_t *ts, char **error)
 {
-	// 定义常量字符串 __function_name，表示函数名
-	const char *__function_name = "evaluate_MAX";
-	// 定义变量 nparams、arg1、ret、i、seconds、nvalues，以及 zbx_value_type_t 类型的 arg1_type
-	int nparams, arg1, ret = FAIL, i, seconds = 0, nvalues = 0;
-	zbx_value_type_t arg1_type;
-	// 定义 zbx_vector_history_record_t 类型的变量 values
-	zbx_vector_history_record_t values;
-	// 定义 zbx_timespec_t 类型的变量 ts_end，表示时间戳的结束时间
-	zbx_timespec_t ts_end = *ts;
+	const char			*__function_name = "evaluate_PERCENTILE";
+
+	int				nparams, arg1, time_shift = 0, ret = FAIL, seconds = 0, nvalues = 0;
+	zbx_value_type_t		arg1_type, time_shift_type = ZBX_VALUE_SECONDS;
+	double				percentage;
+	zbx_vector_history_record_t	values;
+	zbx_timespec_t			ts_end = *ts;
 
-	// 打印调试日志，表示函数开始执行
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
 
-	// 创建一个历史记录向量 values
 	zbx_history_record_vector_create(&values);
 
-	// 判断 item 的值类型是否为浮点数或无符号整数，如果不是，则报错并退出函数
 	if (ITEM_VALUE_TYPE_FLOAT != item->value_type && ITEM_VALUE_TYPE_UINT64 != item->value_type)
 	{
 		*error = zbx_strdup(*error, "invalid value type");
 		goto out;
 	}
 
-	// 判断 parameters 字符串中的参数个数是否为 2 或更多，如果是，则报错并退出函数
-	if (2 < (nparams = num_param(parameters)))
+	if (3 != (nparams = num_param(parameters)))
 	{
 		*error = zbx_strdup(*error, "invalid number of parameters");
 		goto out;
 	}
 
-	// 获取函数参数，第一个参数应为整数，且不能为 0
 	if (SUCCEED != get_function_parameter_int(item->host.hostid, parameters, 1, ZBX_PARAM_MANDATORY, &arg1,
 			&arg1_type) || 0 >= arg1)
 	{
@@ -1663,151 +2311,97 @@ static int evaluate_MAX(char *value, DC_ITEM *item, const char *parameters, cons
 		goto out;
 	}
 
-	// 判断参数个数为 2 时，第二个参数是否为可选参数，如果是，则获取第二个参数
-	if (2 == nparams)
-	{
-		int time_shift = 0;
-		zbx_value_type_t time_shift_type = ZBX_VALUE_SECONDS;
-
-		// 获取可选的第二个参数，判断其值类型是否为秒，如果不符合要求，则报错并退出函数
-		if (SUCCEED != get_function_parameter_int(item->host.hostid, parameters, 2, ZBX_PARAM_OPTIONAL,
-				&time_shift, &time_shift_type) || ZBX_VALUE_SECONDS != time_shift_type ||
-				0 > time_shift)
-		{
-			*error = zbx_strdup(*error, "invalid second parameter");
-			goto out;
-		}
-
-		// 更新时间戳的结束时间
-		ts_end.sec -= time_shift;
-	}
-
-	// 判断 arg1_type 的值，根据不同的值类型执行相应的操作
 	switch (arg1_type)
 	{
 		case ZBX_VALUE_SECONDS:
-			// 如果值为秒，则设置 seconds 为 arg1
 			seconds = arg1;
 			break;
 		case ZBX_VALUE_NVALUES:
-			// 如果值为无符号整数，则设置 nvalues 为 arg1
 			nvalues = arg1;
 			break;
 		default:
-			// 不应该出现这种情况，记录错误并退出函数
 			THIS_SHOULD_NEVER_HAPPEN;
 	}
 
-	// 获取 item 的值，存储在 values 向量中
-	if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
+	if (SUCCEED != get_function_parameter_int(item->host.hostid, parameters, 2, ZBX_PARAM_OPTIONAL, &time_shift,
+			&time_shift_type) || ZBX_VALUE_SECONDS != time_shift_type || 0 > time_shift)
 	{
-		*error = zbx_strdup(*error, "cannot get values from value cache");
+		*error = zbx_strdup(*error, "invalid second parameter");
 		goto out;
 	}
 
-	// 如果 values 向量不为空，则获取最大值，并将结果存储在 value 指向的字符串中
-	if (0 < values.values_num)
-	{
-		int index = 0;
-
-		// 遍历向量，找到最大值
-		for (i = 1; i < values.values_num; i++)
-		{
-			if (ITEM_VALUE_TYPE_UINT64 == item->value_type)
-			{
-				// 如果是无符号整数类型，则比较最大值和当前值
-				if (values.values[i].value.ui64 > values.values[index].value.ui64)
-					index = i;
-			}
-			else
-			{
-				// 如果是浮点数类型，则比较最大值和当前值
-				if (values.values[i].value.dbl > values.values[index].value.dbl)
-					index = i;
-			}
-		}
-		// 将最大值转换为字符串并存储在 value 指向的字符串中
-		zbx_history_value2str(value, MAX_BUFFER_LEN, &values.values[index].value, item->value_type);
+	ts_end.sec -= time_shift;
 
-		// 设置函数执行成功
-		ret = SUCCEED;
-	}
-	else
+	if (SUCCEED != get_function_parameter_float(item->host.hostid, parameters, 3, ZBX_FLAG_DOUBLE_PLAIN,
+			&percentage) || 0.0 > percentage || 100.0 < percentage)
 	{
-		// 打印日志，表示结果为空
-		zabbix_log(LOG_LEVEL_DEBUG, "result for MAX is empty");
-		*error = zbx_strdup(*error, "not enough data");
+		*error = zbx_strdup(*error, "invalid third parameter");
+		goto out;
 	}
 
-out:
-	// 销毁向量 values，释放内存
-	zbx_history_record_vector_destroy(&values, item->value_type);
-
-	// 打印调试日志，表示函数执行结束
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
-
-	// 返回函数执行结果
-	return ret;
-}
-
-    ts_end.sec -= time_shift;
+	if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
+	{
+		*error = zbx_strdup(*error, "cannot get values from value cache");
+		goto out;
+	}
 
-    // 获取可选参数3（百分比）并检查其有效性
-    if (SUCCEED != get_function_parameter_float(item->host.hostid, parameters, 3, ZBX_FLAG_DOUBLE_PLAIN,
-                                                 &percentage) || 0.0 > percentage || 100.0 < percentage)
-    {
-        *error = zbx_strdup(*error, "invalid third parameter");
-        goto out;
-    }
+	if (0 < values.values_num)
+	{
+		int	index;
 
-    // 获取物品历史记录值
-    if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
-    {
-        *error = zbx_strdup(*error, "cannot get values from value cache");
-        goto out;
-    }
+		if (ITEM_VALUE_TYPE_FLOAT == item->value_type)
+			zbx_vector_history_record_sort(&values, (zbx_compare_func_t)__history_record_float_compare);
+		else
+			zbx_vector_history_record_sort(&values, (zbx_compare_func_t)__history_record_uint64_compare);
 
-    // 如果历史记录值数量大于0，按照百分比计算索引
-    if (0 < values.values_num)
-    {
-        int index;
+		if (0 == percentage)
+			index = 1;
+		else
+			index = (int)ceil(values.values_num * (percentage / 100));
 
-        if (ITEM_VALUE_TYPE_FLOAT == item->value_type)
-            zbx_vector_history_record_sort(&values, (zbx_compare_func_t)__history_record_float_compare);
-        else
-            zbx_vector_history_record_sort(&values, (zbx_compare_func_t)__history_record_uint64_compare);
+		zbx_history_value2str(value, MAX_BUFFER_LEN, &values.values[index - 1].value, item->value_type);
 
-        if (0 == percentage)
-            index = 1;
-        else
-            index = (int)ceil(values.values_num * (percentage / 100));
+		ret = SUCCEED;
+	}
+	else
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "result for PERCENTILE is empty");
+		*error = zbx_strdup(*error, "not enough data");
+	}
+out:
+	zbx_history_record_vector_destroy(&values, item->value_type);
 
-        // 将结果字符串填充到value指向的缓冲区
-        zbx_history_value2str(value, MAX_BUFFER_LEN, &values.values[index - 1].value, item->value_type);
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
 
-        // 设置返回值
-        ret = SUCCEED;
-    }
-    else
-    {
-        zabbix_log(LOG_LEVEL_DEBUG, "result for PERCENTILE is empty");
-        *error = zbx_strdup(*error, "not enough data");
-    }
+	return ret;
+}
 
-    // 释放资源
-    zbx_history_record_vector_destroy(&values, item->value_type);
 /******************************************************************************
  * 
  ******************************************************************************/
+/******************************************************************************
+ *                                                                            *
+ * Function: evaluate_DELTA                                                   *
+ *                                                                            *
+ * Purpose: evaluate function 'delta' for the item                            *
+ *                                                                            *
+ * Parameters: item - item (performance metric)                               *
+ *             parameters - number of seconds/values and time shift (optional)*
+ *                                                                            *
+ * Return value: SUCCEED - evaluated successfully, result is stored in 'value'*
+ *               FAIL - failed to evaluate function                           *
+ *                                                                            *
+ ******************************************************************************/
 // 定义静态函数 evaluate_DELTA，输入参数为一个字符指针 value，一个 DC_ITEM 结构指针 item，一个字符指针 parameters，一个 zbx_timespec_t 结构指针 ts，以及一个错误指针 error。
-static int evaluate_DELTA(char *value, DC_ITEM *item, const char *parameters, const zbx_timespec_t *ts, char **error)
+static int	evaluate_DELTA(char *value, DC_ITEM *item, const char *parameters, const zbx_timespec_t *ts,
+		char **error)
 {
 	// 定义变量，包括函数名、参数数量、arg1、ret 变量、i 变量、seconds 变量、nvalues 变量、ts_end 变量等。
-	const char *__function_name = "evaluate_DELTA";
-	int nparams, arg1, ret = FAIL, i, seconds = 0, nvalues = 0;
-	zbx_value_type_t arg1_type;
-	zbx_vector_history_record_t values;
-	zbx_timespec_t ts_end = *ts;
+	const char			*__function_name = "evaluate_DELTA";
+	int				nparams, arg1, ret = FAIL, seconds = 0, nvalues = 0;
+	zbx_value_type_t		arg1_type;
+	zbx_vector_history_record_t	values;
+	zbx_timespec_t			ts_end = *ts;
 
 	// 记录调试日志
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
@@ -1830,7 +2424,8 @@ static int evaluate_DELTA(char *value, DC_ITEM *item, const char *parameters, co
 	}
 
 	// 获取函数参数 int 类型参数 1，并检查是否成功
-	if (SUCCEED != get_function_parameter_int(item->host.hostid, parameters, 1, ZBX_PARAM_MANDATORY, &arg1, &arg1_type) || 0 >= arg1)
+	if (SUCCEED != get_function_parameter_int(item->host.hostid, parameters, 1, ZBX_PARAM_MANDATORY, &arg1,
+			&arg1_type) || 0 >= arg1)
 	{
 		*error = zbx_strdup(*error, "invalid first parameter");
 		goto out;
@@ -1839,8 +2434,8 @@ static int evaluate_DELTA(char *value, DC_ITEM *item, const char *parameters, co
 	// 检查是否有 2 个参数
 	if (2 == nparams)
 	{
-		int time_shift = 0;
-		zbx_value_type_t time_shift_type = ZBX_VALUE_SECONDS;
+		int			time_shift = 0;
+		zbx_value_type_t	time_shift_type = ZBX_VALUE_SECONDS;
 
 		// 获取可选的第二个参数，并检查是否成功
 		if (SUCCEED != get_function_parameter_int(item->host.hostid, parameters, 2, ZBX_PARAM_OPTIONAL,
@@ -1878,37 +2473,18 @@ static int evaluate_DELTA(char *value, DC_ITEM *item, const char *parameters, co
 	// 如果历史记录值不为空
 	if (0 < values.values_num)
 	{
-		history_value_t result;
-		int index_min = 0, index_max = 0;
+		history_value_t		result, min, max;
 
-		// 根据 item 的值类型计算最小和最大索引
+		// 根据 item 的值类型计算最小和最大值
 		if (ITEM_VALUE_TYPE_UINT64 == item->value_type)
 		{
-			for (i = 1; i < values.values_num; i++)
-			{
-				if (values.values[i].value.ui64 > values.values[index_max].value.ui64)
-					index_max = i;
-
-				if (values.values[i].value.ui64 < values.values[index_min].value.ui64)
-					index_min = i;
-			}
-
-			// 计算 DELTA 值
-			result.ui64 = values.values[index_max].value.ui64 - values.values[index_min].value.ui64;
+			aggr_minmax_ui64(values.values, values.values_num, &min.ui64, &max.ui64);
+			result.ui64 = max.ui64 - min.ui64;
 		}
 		else
 		{
-			for (i = 1; i < values.values_num; i++)
-			{
-				if (values.values[i].value.dbl > values.values[index_max].value.dbl)
-					index_max = i;
-
-				if (values.values[i].value.dbl < values.values[index_min].value.dbl)
-					index_min = i;
-			}
-
-			// 计算 DELTA 值
-			result.dbl = values.values[index_max].value.dbl - values.values[index_min].value.dbl;
+			aggr_minmax_dbl(values.values, values.values_num, &min.dbl, &max.dbl);
+			result.dbl = max.dbl - min.dbl;
 		}
 
 		// 将结果转换为字符串并输出
@@ -1922,8 +2498,8 @@ static int evaluate_DELTA(char *value, DC_ITEM *item, const char *parameters, co
 		zabbix_log(LOG_LEVEL_DEBUG, "result for DELTA is empty");
 		*error = zbx_strdup(*error, "not enough data");
 	}
-
-	// 释放资源并退出
+// 释放资源并退出
+out:
 	zbx_history_record_vector_destroy(&values, item->value_type);
 
 	// 记录调试日志
@@ -1933,47 +2509,24 @@ static int evaluate_DELTA(char *value, DC_ITEM *item, const char *parameters, co
 	return ret;
 }
 
-					index_max = i;
-
-				if (values.values[i].value.ui64 < values.values[index_min].value.ui64)
-					index_min = i;
-			}
-
-			result.ui64 = values.values[index_max].value.ui64 - values.values[index_min].value.ui64;
-		}
-		else
-		{
-			for (i = 1; i < values.values_num; i++)
-			{
-				if (values.values[i].value.dbl > values.values[index_max].value.dbl)
-					index_max = i;
-
-				if (values.values[i].value.dbl < values.values[index_min].value.dbl)
-					index_min = i;
-			}
-
-			result.dbl = values.values[index_max].value.dbl - values.values[index_min].value.dbl;
-		}
-
-		zbx_history_value2str(value, MAX_BUFFER_LEN, &result, item->value_type);
-
-		ret = SUCCEED;
-	}
-	else
-	{
-		zabbix_log(LOG_LEVEL_DEBUG, "result for DELTA is empty");
-		*error = zbx_strdup(*error, "not enough data");
-	}
-out:
-	zbx_history_record_vector_destroy(&values, item->value_type);
-
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
-
 /******************************************************************************
  * *
  *整个代码块的主要目的是评估给定指标的数据是否有效。函数`evaluate_NODATA`接收四个参数：一个指向值的字符指针、一个指向DC项的指针、一个指向参数字符串的指针和一个指向错误信息的指针。函数首先检查参数数量是否合法，然后获取第一个参数并判断其类型和值是否合法。接下来，获取当前时间戳，并根据参数值和时间戳查询指标数据。如果满足条件，将结果存储到value字符串中；否则，尝试获取预期数据并判断是否超过预期时间。最后，更新返回值并销毁历史记录向量，返回结果。
  ******************************************************************************/
 // 定义一个静态函数，用于评估给定指标的数据是否有效
+/******************************************************************************
+ *                                                                            *
+ * Function: evaluate_NODATA                                                  *
+ *                                                                            *
+ * Purpose: evaluate function 'nodata' for the item                           *
+ *                                                                            *
+ * Parameters: item - item (performance metric)                               *
+ *             parameter - number of seconds                                  *
+ *                                                                            *
+ * Return value: SUCCEED - evaluated successfully, result is stored in 'value'*
+ *               FAIL - failed to evaluate function                           *
+ *                                                                            *
+ ******************************************************************************/
 static int evaluate_NODATA(char *value, DC_ITEM *item, const char *parameters, char **error)
 {
 	// 定义一些常量和变量
@@ -2048,23 +2601,6 @@ out:
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
 
 	// 返回结果
-	return ret;
-}
-
-			*error = zbx_strdup(*error,
-					"item does not have enough data after server start or item creation");
-			goto out;
-		}
-
-		zbx_strlcpy(value, "1", MAX_BUFFER_LEN);
-	}
-
-	ret = SUCCEED;
-out:
-	zbx_history_record_vector_destroy(&values, item->value_type);
-
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
-
 	return ret;
 }
 
@@ -2116,6 +2652,7 @@ static int	evaluate_ABSCHANGE(char *value, DC_ITEM *item, const zbx_timespec_t *
 			break;
 		case ITEM_VALUE_TYPE_UINT64:
 			/* 为了避免溢出，计算两个值之间的差值 */
+			/* to avoid overflow */
 			if (values.values[0].value.ui64 >= values.values[1].value.ui64)
 			{
 				zbx_snprintf(value, MAX_BUFFER_LEN, ZBX_FS_UI64,
@@ -2207,6 +2744,7 @@ static int evaluate_CHANGE(char *value, DC_ITEM *item, const zbx_timespec_t *ts,
 			break;
 		case ITEM_VALUE_TYPE_UINT64:
 			/* 避免溢出 */
+			/* to avoid overflow */
 			if (values.values[0].value.ui64 >= values.values[1].value.ui64)
 				zbx_snprintf(value, MAX_BUFFER_LEN, ZBX_FS_UI64,
 						values.values[0].value.ui64 - values.values[1].value.ui64);
@@ -2246,6 +2784,19 @@ out:
 }
 
 
+/******************************************************************************
+ *                                                                            *
+ * Function: evaluate_DIFF                                                    *
+ *                                                                            *
+ * Purpose: evaluate function 'diff' for the item                             *
+ *                                                                            *
+ * Parameters: item - item (performance metric)                               *
+ *             parameter - number of seconds                                  *
+ *                                                                            *
+ * Return value: SUCCEED - evaluated successfully, result is stored in 'value'*
+ *               FAIL - failed to evaluate function                           *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
 /******************************************************************************
  * 
@@ -2255,12 +2806,12 @@ out:
 // 2. 一个 DC_ITEM 结构体指针 item，用于获取数据；
 // 3. 一个 zbx_timespec_t 结构体指针 ts，用于时间戳；
 // 4. 一个字符指针指针 error，用于存储错误信息。
-static int evaluate_DIFF(char *value, DC_ITEM *item, const zbx_timespec_t *ts, char **error)
+static int	evaluate_DIFF(char *value, DC_ITEM *item, const zbx_timespec_t *ts, char **error)
 {
 	// 定义一个常量字符串，表示函数名
-	const char *__function_name = "evaluate_DIFF";
-	int ret = FAIL;
-	zbx_vector_history_record_t values;
+	const char			*__function_name = "evaluate_DIFF";
+	int				ret = FAIL;
+	zbx_vector_history_record_t	values;
 
 	// 打印调试日志，表示进入函数
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
@@ -2321,6 +2872,68 @@ static int evaluate_DIFF(char *value, DC_ITEM *item, const zbx_timespec_t *ts, c
 		// 默认情况，返回错误信息
 		default:
 			*error = zbx_strdup(*error, "invalid value type");
+			goto out;
+	}
+
+	ret = SUCCEED;
+out:
+	zbx_history_record_vector_destroy(&values, item->value_type);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: evaluate_STR                                                     *
+ *                                                                            *
+ * Purpose: evaluate function 'str' for the item                              *
+ *                                                                            *
+ * Parameters: item - item (performance metric)                               *
+ *             parameters - <string>[,seconds]                                *
+ *                                                                            *
+ * Return value: SUCCEED - evaluated successfully, result stored in 'value'   *
+ *               FAIL - failed to match the regular expression                *
+ *               NOTSUPPORTED - invalid regular expression                    *
+ *                                                                            *
+ ******************************************************************************/
+
+#define ZBX_FUNC_STR		1
+#define ZBX_FUNC_REGEXP		2
+#define ZBX_FUNC_IREGEXP	3
+
+static int	evaluate_STR_one(int func, zbx_vector_ptr_t *regexps, const char *value, const char *arg1)
+{
+	switch (func)
+	{
+		case ZBX_FUNC_STR:
+			if (NULL != strstr(value, arg1))
+				return SUCCEED;
+			break;
+		case ZBX_FUNC_REGEXP:
+			switch (regexp_match_ex(regexps, value, arg1, ZBX_CASE_SENSITIVE))
+			{
+				case ZBX_REGEXP_MATCH:
+					return SUCCEED;
+				case FAIL:
+					return NOTSUPPORTED;
+			}
+			break;
+		case ZBX_FUNC_IREGEXP:
+			switch (regexp_match_ex(regexps, value, arg1, ZBX_IGNORE_CASE))
+			{
+				case ZBX_REGEXP_MATCH:
+					return SUCCEED;
+				case FAIL:
+					return NOTSUPPORTED;
+			}
+			break;
+	}
+
+	return FAIL;
+}
+
 /******************************************************************************
  * 以下是对代码块的逐行中文注释：
  *
@@ -2382,6 +2995,17 @@ static int	evaluate_STR(char *value, DC_ITEM *item, const char *function, const
 		}
 	}
 
+	if ((ZBX_FUNC_REGEXP == func || ZBX_FUNC_IREGEXP == func) && '@' == *arg1)
+	{
+		DCget_expressions_by_name(&regexps, arg1 + 1);
+
+		if (0 == regexps.values_num)
+		{
+			*error = zbx_dsprintf(*error, "global regular expression \"%s\" does not exist", arg1 + 1);
+			goto out;
+		}
+	}
+
 	switch (arg2_type) // 根据arg2_type的值进行切换
 	{
 		case ZBX_VALUE_SECONDS: // 如果arg2_type为ZBX_VALUE_SECONDS
@@ -2449,123 +3073,11 @@ out: // 跳出错误处理分支
 
 	zbx_history_record_vector_destroy(&values, item->value_type); // 销毁历史记录向量
 
-	zbx_free(arg1); // 释放arg1内存
-
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret)); // 打印调试日志，表示函数执行结束
-
-	return ret; // 返回函数执行结果
-}
-
-	else if (0 == strcmp(function, "iregexp"))
-		func = ZBX_FUNC_IREGEXP;
-	else
-		goto out;
-
-	if (2 < (nparams = num_param(parameters)))
-	{
-		*error = zbx_strdup(*error, "invalid number of parameters");
-		goto out;
-	}
-
-	if (SUCCEED != get_function_parameter_str(item->host.hostid, parameters, 1, &arg1))
-	{
-		*error = zbx_strdup(*error, "invalid first parameter");
-		goto out;
-	}
-
-	if (2 == nparams)
-	{
-		if (SUCCEED != get_function_parameter_int(item->host.hostid, parameters, 2, ZBX_PARAM_OPTIONAL, &arg2,
-				&arg2_type) || 0 >= arg2)
-		{
-			*error = zbx_strdup(*error, "invalid second parameter");
-			goto out;
-		}
-	}
-
-	if ((ZBX_FUNC_REGEXP == func || ZBX_FUNC_IREGEXP == func) && '@' == *arg1)
-	{
-		DCget_expressions_by_name(&regexps, arg1 + 1);
-
-		if (0 == regexps.values_num)
-		{
-			*error = zbx_dsprintf(*error, "global regular expression \"%s\" does not exist", arg1 + 1);
-			goto out;
-		}
-	}
-
-	switch (arg2_type)
-	{
-		case ZBX_VALUE_SECONDS:
-			seconds = arg2;
-			break;
-		case ZBX_VALUE_NVALUES:
-			nvalues = arg2;
-			break;
-		default:
-			THIS_SHOULD_NEVER_HAPPEN;
-	}
-
-	if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, ts))
-	{
-		*error = zbx_strdup(*error, "cannot get values from value cache");
-		goto out;
-	}
-
-	if (0 != values.values_num)
-	{
-		/* at this point the value type can be only str, text or log */
-		if (ITEM_VALUE_TYPE_LOG == item->value_type)
-		{
-			for (i = 0; i < values.values_num; i++)
-			{
-				if (SUCCEED == (str_one_ret = evaluate_STR_one(func, &regexps,
-						values.values[i].value.log->value, arg1)))
-				{
-					found = 1;
-					break;
-				}
-
-				if (NOTSUPPORTED == str_one_ret)
-				{
-					*error = zbx_dsprintf(*error, "invalid regular expression \"%s\"", arg1);
-					goto out;
-				}
-			}
-		}
-		else
-		{
-			for (i = 0; i < values.values_num; i++)
-			{
-				if (SUCCEED == (str_one_ret = evaluate_STR_one(func, &regexps,
-						values.values[i].value.str, arg1)))
-				{
-					found = 1;
-					break;
-				}
-
-				if (NOTSUPPORTED == str_one_ret)
-				{
-					*error = zbx_dsprintf(*error, "invalid regular expression \"%s\"", arg1);
-					goto out;
-				}
-			}
-		}
-	}
-
-	zbx_snprintf(value, MAX_BUFFER_LEN, "%d", found);
-	ret = SUCCEED;
-out:
-	zbx_regexp_clean_expressions(&regexps);
-	zbx_vector_ptr_destroy(&regexps);
-
-	zbx_history_record_vector_destroy(&values, item->value_type);
-
-	zbx_free(arg1);
+	zbx_free(arg1); // 释放arg1内存
 
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret)); // 打印调试日志，表示函数执行结束
 
-	return ret;
+	return ret; // 返回函数执行结果
 }
 
 #undef ZBX_FUNC_STR
@@ -2591,41 +3103,41 @@ out:
  *整个代码块的主要目的是评估一个字符串的长度。函数`evaluate_STRLEN`接收五个参数：一个字符指针`value`，一个`DC_ITEM`结构体指针`item`，一个字符指针数组`parameters`，一个`zbx_timespec_t`结构体指针`ts`，以及一个错误信息指针`error`。函数首先判断`item`的数据类型是否为字符串、文本或日志类型，如果不合法，则返回错误信息。如果数据类型合法，调用`evaluate_LAST`函数评估值的有效性。如果评估成功，计算字符串长度并格式化输出。最后，清理资源并返回评估结果。
  ******************************************************************************/
 // 定义一个静态函数，用于评估字符串长度
-static int evaluate_STRLEN(char *value, DC_ITEM *item, const char *parameters, const zbx_timespec_t *ts, char **error)
+static int	evaluate_STRLEN(char *value, DC_ITEM *item, const char *parameters, const zbx_timespec_t *ts,
+		char **error)
 {
-    // 定义一个内部字符串，用于存储函数名
-    const char *__function_name = "evaluate_STRLEN";
-    int		ret = FAIL; // 定义一个返回值，初始值为失败
+	// 定义一个内部字符串，用于存储函数名
+	const char	*__function_name = "evaluate_STRLEN";
+	int		ret = FAIL; // 定义一个返回值，初始值为失败
 
-    // 记录日志，表示函数开始执行
-    zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
+	// 记录日志，表示函数开始执行
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
 
-    // 判断item的数据类型是否为字符串、文本或日志类型
-    if (ITEM_VALUE_TYPE_STR != item->value_type && ITEM_VALUE_TYPE_TEXT != item->value_type &&
-            ITEM_VALUE_TYPE_LOG != item->value_type)
-    {
-        // 如果数据类型不合法，返回错误信息
-        *error = zbx_strdup(*error, "invalid value type");
-        goto clean; // 跳转到clean标签处
-    }
+	// 判断item的数据类型是否为字符串、文本或日志类型
+	if (ITEM_VALUE_TYPE_STR != item->value_type && ITEM_VALUE_TYPE_TEXT != item->value_type &&
+			ITEM_VALUE_TYPE_LOG != item->value_type)
+	{
+		// 如果数据类型不合法，返回错误信息
+		*error = zbx_strdup(*error, "invalid value type");
+		goto clean; // 跳转到clean标签处
+	}
 
-    // 调用evaluate_LAST函数，评估值的有效性
-    if (SUCCEED == evaluate_LAST(value, item, parameters, ts, error))
-    {
-        // 如果评估成功，计算字符串长度并格式化输出
-        zbx_snprintf(value, MAX_BUFFER_LEN, ZBX_FS_SIZE_T, (zbx_fs_size_t)zbx_strlen_utf8(value));
-        ret = SUCCEED;
-    }
+	// 调用evaluate_LAST函数，评估值的有效性
+	if (SUCCEED == evaluate_LAST(value, item, parameters, ts, error))
+	{
+		// 如果评估成功，计算字符串长度并格式化输出
+		zbx_snprintf(value, MAX_BUFFER_LEN, ZBX_FS_SIZE_T, (zbx_fs_size_t)zbx_strlen_utf8(value));
+		ret = SUCCEED;
+	}
 
-    // 清理资源，结束函数执行
-    clean:
-        zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
+// 清理资源，结束函数执行
+clean:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
 
-    // 返回评估结果
-    return ret;
+	// 返回评估结果
+	return ret;
 }
 
-
 /******************************************************************************
  *                                                                            *
  * Function: evaluate_FUZZYTIME                                               *
@@ -2655,16 +3167,17 @@ static int evaluate_STRLEN(char *value, DC_ITEM *item, const char *parameters, c
  * 0：成功
  * 非0：失败
  */
-static int evaluate_FUZZYTIME(char *value, DC_ITEM *item, const char *parameters, const zbx_timespec_t *ts, char **error)
+static int	evaluate_FUZZYTIME(char *value, DC_ITEM *item, const char *parameters, const zbx_timespec_t *ts,
+		char **error)
 {
 	/* 定义一个内部字符串常量，表示函数名 */
-	const char *__function_name = "evaluate_FUZZYTIME";
+	const char		*__function_name = "evaluate_FUZZYTIME";
 
 	/* 定义一些变量 */
-	int arg1, ret = FAIL;
-	zbx_value_type_t arg1_type;
-	zbx_history_record_t vc_value;
-	zbx_uint64_t fuzlow, fuzhig;
+	int			arg1, ret = FAIL;
+	zbx_value_type_t	arg1_type;
+	zbx_history_record_t	vc_value;
+	zbx_uint64_t		fuzlow, fuzhig;
 
 	/* 记录日志 */
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
@@ -2737,6 +3250,27 @@ out:
 }
 
 
+/******************************************************************************
+ *                                                                            *
+ * Function: evaluate_BAND                                                    *
+ *                                                                            *
+ * Purpose: evaluate logical bitwise function 'and' for the item              *
+ *                                                                            *
+ * Parameters: value - buffer of size MAX_BUFFER_LEN                          *
+ *             item - item (performance metric)                               *
+ *             parameters - up to 3 comma-separated fields:                   *
+ *                            (1) same as the 1st parameter for function      *
+ *                                evaluate_LAST() (see documentation of       *
+ *                                trigger function last()),                   *
+ *                            (2) mask to bitwise AND with (mandatory),       *
+ *                            (3) same as the 2nd parameter for function      *
+ *                                evaluate_LAST() (see documentation of       *
+ *                                trigger function last()).                   *
+ *                                                                            *
+ * Return value: SUCCEED - evaluated successfully, result is stored in 'value'*
+ *               FAIL - failed to evaluate function                           *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  *                                                                            *
  * Function: evaluate_BAND                                                    *
@@ -2775,6 +3309,54 @@ static int	evaluate_BAND(char *value, DC_ITEM *item, const char *parameters, con
 
 	/* 判断 item 的值类型是否为 uint64，如果不是，返回错误 */
 	if (ITEM_VALUE_TYPE_UINT64 != item->value_type)
+	{
+		*error = zbx_strdup(*error, "invalid value type");
+		goto clean;
+	}
+
+	if (3 < (nparams = num_param(parameters)))
+	{
+		*error = zbx_strdup(*error, "invalid number of parameters");
+		goto clean;
+	}
+
+	if (SUCCEED != get_function_parameter_uint64(item->host.hostid, parameters, 2, &mask))
+	{
+		*error = zbx_strdup(*error, "invalid second parameter");
+		goto clean;
+	}
+
+	/* prepare the 1st and the 3rd parameter for passing to evaluate_LAST() */
+	last_parameters = zbx_strdup(NULL, parameters);
+	remove_param(last_parameters, 2);
+
+	if (SUCCEED == evaluate_LAST(value, item, last_parameters, ts, error))
+	{
+		ZBX_STR2UINT64(last_uint64, value);
+		zbx_snprintf(value, MAX_BUFFER_LEN, ZBX_FS_UI64, last_uint64 & (zbx_uint64_t)mask);
+		ret = SUCCEED;
+	}
+
+	zbx_free(last_parameters);
+clean:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: evaluate_FORECAST                                                *
+ *                                                                            *
+ * Purpose: evaluate function 'forecast' for the item                         *
+ *                                                                            *
+ * Parameters: item - item (performance metric)                               *
+ *             parameters - number of seconds/values and time shift (optional)*
+ *                                                                            *
+ * Return value: SUCCEED - evaluated successfully, result is stored in 'value'*
+ *               FAIL - failed to evaluate function                           *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  * 以下是对代码的逐行注释：
  *
@@ -2924,6 +3506,7 @@ static int	evaluate_FORECAST(char *value, DC_ITEM *item, const char *parameters,
 				t[i] = values.values[i].timestamp.sec - zero_time.sec + 1.0e-9 *
 						(values.values[i].timestamp.ns - zero_time.ns + 1);
 				x[i] = values.values[i].value.dbl;
+			}
 		}
 		else
 		{
@@ -2932,8 +3515,10 @@ static int	evaluate_FORECAST(char *value, DC_ITEM *item, const char *parameters,
 				t[i] = values.values[i].timestamp.sec - zero_time.sec + 1.0e-9 *
 						(values.values[i].timestamp.ns - zero_time.ns + 1);
 				x[i] = values.values[i].value.ui64;
-		}
+			}
 		// 使用zbx_forecast()计算预测值
+		}
+
 		zbx_snprintf(value, MAX_BUFFER_LEN, ZBX_FS_DBL, zbx_forecast(t, x, values.values_num,
 				ts->sec - zero_time.sec - 1.0e-9 * (zero_time.ns + 1), time, fit, k, mode));
 	}
@@ -2963,189 +3548,188 @@ out:
 	return ret;
 }
 
+/******************************************************************************
+ * 以下是对代码的详细注释：
+ *
+ *
+ *
+ *这个代码块的主要目的是计算时间剩余。函数接收五个参数：值、物品、参数列表、时间戳和误差指针。函数首先检查参数的合法性，然后获取物品的历史记录，并根据记录计算时间剩余。计算过程中，函数会根据数据类型分别处理时间数组和值数组。最后，将计算得到的时间剩余值存储在`value`字符串中，并返回成功与否的结果。
+ ******************************************************************************/
+/******************************************************************************
+ *                                                                            *
+ * Function: evaluate_TIMELEFT                                                *
+ *                                                                            *
+ * Purpose: evaluate function 'timeleft' for the item                         *
+ *                                                                            *
+ * Parameters: item - item (performance metric)                               *
+ *             parameters - number of seconds/values and time shift (optional)*
+ *                                                                            *
+ * Return value: SUCCEED - evaluated successfully, result is stored in 'value'*
+ *               FAIL - failed to evaluate function                           *
+ *                                                                            *
+ ******************************************************************************/
+// 静态局部变量，用于存储函数名称
+static int	evaluate_TIMELEFT(char *value, DC_ITEM *item, const char *parameters, const zbx_timespec_t *ts,
+		char **error)
+{
+	// 定义函数名
+	const char			*__function_name = "evaluate_TIMELEFT";
+    
+	// 定义一些变量
+	char				*fit_str = NULL;
+	double				*t = NULL, *x = NULL, threshold;
+	int				nparams, arg1, i, ret = FAIL, seconds = 0, nvalues = 0, time_shift = 0;
+	zbx_value_type_t		arg1_type, time_shift_type = ZBX_VALUE_SECONDS;
+	unsigned			k = 0;
+	zbx_vector_history_record_t	values;
+	zbx_timespec_t			zero_time;
+	zbx_fit_t			fit;
+	zbx_timespec_t			ts_end = *ts;
+
+	// 打印调试信息
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
+
+	// 创建历史记录向量
+	zbx_history_record_vector_create(&values);
+
+	// 检查item的价值类型是否为浮点数或无符号整数
+	if (ITEM_VALUE_TYPE_FLOAT != item->value_type && ITEM_VALUE_TYPE_UINT64 != item->value_type)
+	{
+		// 输出错误信息
+		*error = zbx_strdup(*error, "invalid value type");
+		goto out;
 	}
 
-	ts_end.sec -= time_shift;
+	// 检查参数数量是否在3到4之间
+	if (3 > (nparams = num_param(parameters)) || nparams > 4)
+	{
+		*error = zbx_strdup(*error, "invalid number of parameters");
+		goto out;
+	}
 
-	if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
+	// 获取第一个参数（必填）
+	if (SUCCEED != get_function_parameter_int(item->host.hostid, parameters, 1, ZBX_PARAM_MANDATORY, &arg1,
+			&arg1_type) || 0 >= arg1)
 	{
-		*error = zbx_strdup(*error, "cannot get values from value cache");
+		*error = zbx_strdup(*error, "invalid first parameter");
 		goto out;
 	}
 
-	if (0 < values.values_num)
+	// 获取第二个参数（可选）
+	if (SUCCEED != get_function_parameter_int(item->host.hostid, parameters, 2, ZBX_PARAM_OPTIONAL, &time_shift,
+			&time_shift_type) || ZBX_VALUE_SECONDS != time_shift_type || 0 > time_shift)
 	{
-		t = (double *)zbx_malloc(t, values.values_num * sizeof(double));
-		x = (double *)zbx_malloc(x, values.values_num * sizeof(double));
+		*error = zbx_strdup(*error, "invalid second parameter");
+		goto out;
+	}
 
-		zero_time.sec = values.values[values.values_num - 1].timestamp.sec;
-		zero_time.ns = values.values[values.values_num - 1].timestamp.ns;
+	// 获取第三个参数（必填）
+	if (SUCCEED != get_function_parameter_float(item->host.hostid, parameters, 3, ZBX_FLAG_DOUBLE_SUFFIX,
+			&threshold))
+	{
+		*error = zbx_strdup(*error, "invalid third parameter");
+		goto out;
+	}
 
-		if (ITEM_VALUE_TYPE_FLOAT == item->value_type)
-		{
-			for (i = 0; i < values.values_num; i++)
-			{
-				t[i] = values.values[i].timestamp.sec - zero_time.sec + 1.0e-9 *
-						(values.values[i].timestamp.ns - zero_time.ns + 1);
-				x[i] = values.values[i].value.dbl;
-			}
-		}
-		else
+	// 获取第四个参数（可选）
+	if (4 == nparams)
+	{
+		if (SUCCEED != get_function_parameter_str(item->host.hostid, parameters, 4, &fit_str) ||
+				SUCCEED != zbx_fit_code(fit_str, &fit, &k, error))
 		{
-			for (i = 0; i < values.values_num; i++)
-			{
-				t[i] = values.values[i].timestamp.sec - zero_time.sec + 1.0e-9 *
-						(values.values[i].timestamp.ns - zero_time.ns + 1);
-				x[i] = values.values[i].value.ui64;
-			}
+			*error = zbx_strdup(*error, "invalid fourth parameter");
+			goto out;
 		}
-
-		zbx_snprintf(value, MAX_BUFFER_LEN, ZBX_FS_DBL, zbx_forecast(t, x, values.values_num,
-				ts->sec - zero_time.sec - 1.0e-9 * (zero_time.ns + 1), time, fit, k, mode));
 	}
 	else
 	{
-		zabbix_log(LOG_LEVEL_DEBUG, "no data available");
-		zbx_snprintf(value, MAX_BUFFER_LEN, ZBX_FS_DBL, ZBX_MATH_ERROR);
+		fit = FIT_LINEAR;
 	}
 
-	ret = SUCCEED;
-out:
-	zbx_history_record_vector_destroy(&values, item->value_type);
-
-	zbx_free(fit_str);
-	zbx_free(mode_str);
-
-	zbx_free(t);
-	zbx_free(x);
-
-/******************************************************************************
- * 以下是对代码的详细注释：
- *
- *
- *
- *这个代码块的主要目的是计算时间剩余。函数接收五个参数：值、物品、参数列表、时间戳和误差指针。函数首先检查参数的合法性，然后获取物品的历史记录，并根据记录计算时间剩余。计算过程中，函数会根据数据类型分别处理时间数组和值数组。最后，将计算得到的时间剩余值存储在`value`字符串中，并返回成功与否的结果。
- ******************************************************************************/
-// 静态局部变量，用于存储函数名称
-static int evaluate_TIMELEFT(char *value, DC_ITEM *item, const char *parameters, const zbx_timespec_t *ts, char **error)
-{
-    // 定义函数名
-    const char *__function_name = "evaluate_TIMELEFT";
-    
-    // 定义一些变量
-    char *fit_str = NULL;
-    double *t = NULL, *x = NULL, threshold;
-    int nparams, arg1, i, ret = FAIL, seconds = 0, nvalues = 0, time_shift = 0;
-    zbx_value_type_t arg1_type, time_shift_type = ZBX_VALUE_SECONDS;
-    unsigned k = 0;
-    zbx_vector_history_record_t values;
-    zbx_timespec_t zero_time;
-    zbx_fit_t fit;
-    zbx_timespec_t ts_end = *ts;
-
-    // 打印调试信息
-    zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
-
-    // 创建历史记录向量
-    zbx_history_record_vector_create(&values);
-
-    // 检查item的价值类型是否为浮点数或无符号整数
-    if (ITEM_VALUE_TYPE_FLOAT != item->value_type && ITEM_VALUE_TYPE_UINT64 != item->value_type)
-    {
-        // 输出错误信息
-        *error = zbx_strdup(*error, "invalid value type");
-        goto OUT;
-    }
-
-    // 检查参数数量是否在3到4之间
-    if (3 > (nparams = num_param(parameters)) || nparams > 4)
-    {
-        *error = zbx_strdup(*error, "invalid number of parameters");
-        goto OUT;
-    }
+	// 检查threshold是否为0，如果是，则不允许使用指数函数和幂函数
+	if ((FIT_EXPONENTIAL == fit || FIT_POWER == fit) && 0.0 >= threshold)
+	{
+		*error = zbx_strdup(*error, "exponential and power functions are always positive");
+		goto out;
+	}
 
-    // 获取第一个参数（必填）
-    if (SUCCEED != get_function_parameter_int(item->host.hostid, parameters, 1, ZBX_PARAM_MANDATORY, &arg1,
-                                               &arg1_type) || 0 >= arg1)
-    {
-        *error = zbx_strdup(*error, "invalid first parameter");
-        goto OUT;
-    }
+	// 切换参数类型
+	switch (arg1_type)
+	{
+		case ZBX_VALUE_SECONDS:
+			seconds = arg1;
+			break;
+		case ZBX_VALUE_NVALUES:
+			nvalues = arg1;
+			break;
+		default:
+			THIS_SHOULD_NEVER_HAPPEN;
+	}
 
-    // 获取第二个参数（可选）
-    if (SUCCEED != get_function_parameter_int(item->host.hostid, parameters, 2, ZBX_PARAM_OPTIONAL, &time_shift,
-                                               &time_shift_type) || ZBX_VALUE_SECONDS != time_shift_type || 0 > time_shift)
-    {
-        *error = zbx_strdup(*error, "invalid second parameter");
-        goto OUT;
-    }
+	// 计算时间戳偏移
+	ts_end.sec -= time_shift;
 
-    // 获取第三个参数（必填）
-    if (SUCCEED != get_function_parameter_float(item->host.hostid, parameters, 3, ZBX_FLAG_DOUBLE_SUFFIX,
-                                                 &threshold))
-    {
-        *error = zbx_strdup(*error, "invalid third parameter");
-        goto OUT;
-    }
+	// 获取数据缓存中的值
+	if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
+	{
+		*error = zbx_strdup(*error, "cannot get values from value cache");
+		goto out;
+	}
 
-    // 获取第四个参数（可选）
-    if (4 == nparams)
-    {
-        if (SUCCEED != get_function_parameter_str(item->host.hostid, parameters, 4, &fit_str) ||
-                SUCCEED != zbx_fit_code(fit_str, &fit, &k, error))
-        {
-            *error = zbx_strdup(*error, "invalid fourth parameter");
-            goto OUT;
-        }
-    }
-    else
-    {
-        fit = FIT_LINEAR;
-    }
+	// 如果数据缓存中有值
+	if (0 < values.values_num)
+	{
+		// 分配内存存储时间数组和值数组
+		t = (double *)zbx_malloc(t, values.values_num * sizeof(double));
+		x = (double *)zbx_malloc(x, values.values_num * sizeof(double));
 
-    // 检查threshold是否为0，如果是，则不允许使用指数函数和幂函数
-    if ((FIT_EXPONENTIAL == fit || FIT_POWER == fit) && 0.0 >= threshold)
-    {
-        *error = zbx_strdup(*error, "exponential and power functions are always positive");
-        goto OUT;
-    }
+		// 初始化零时间
+		zero_time.sec = values.values[values.values_num - 1].timestamp.sec;
+		zero_time.ns = values.values[values.values_num - 1].timestamp.ns;
 
-    // 切换参数类型
-    switch (arg1_type)
-    {
-        case ZBX_VALUE_SECONDS:
-            seconds = arg1;
-            break;
-        case ZBX_VALUE_NVALUES:
-            nvalues = arg1;
-            break;
-        default:
-            THIS_SHOULD_NEVER_HAPPEN;
-    }
+		// 根据数据类型分别处理时间数组和值数组
+		if (ITEM_VALUE_TYPE_FLOAT == item->value_type)
+		{
+			for (i = 0; i < values.values_num; i++)
+			{
+				t[i] = values.values[i].timestamp.sec - zero_time.sec + 1.0e-9 *
+						(values.values[i].timestamp.ns - zero_time.ns + 1);
+				x[i] = values.values[i].value.dbl;
+			}
+		}
+		else
+		{
+			for (i = 0; i < values.values_num; i++)
+			{
+				t[i] = values.values[i].timestamp.sec - zero_time.sec + 1.0e-9 *
+						(values.values[i].timestamp.ns - zero_time.ns + 1);
+				x[i] = values.values[i].value.ui64;
+			}
+		}
 
-    // 计算时间戳偏移
-    ts_end.sec -= time_shift;
+		zbx_snprintf(value, MAX_BUFFER_LEN, ZBX_FS_DBL, zbx_timeleft(t, x, values.values_num,
+				ts->sec - zero_time.sec - 1.0e-9 * (zero_time.ns + 1), threshold, fit, k));
+	}
+	else
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "no data available");
+		zbx_snprintf(value, MAX_BUFFER_LEN, ZBX_FS_DBL, ZBX_MATH_ERROR);
+	}
 
-    // 获取数据缓存中的值
-    if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
-    {
-        *error = zbx_strdup(*error, "cannot get values from value cache");
-        goto OUT;
-    }
+	ret = SUCCEED;
+out:
+	zbx_history_record_vector_destroy(&values, item->value_type);
 
-    // 如果数据缓存中有值
-    if (0 < values.values_num)
-    {
-        // 分配内存存储时间数组和值数组
-        t = (double *)zbx_malloc(t, values.values_num * sizeof(double));
-        x = (double *)zbx_malloc(x, values.values_num * sizeof(double));
+	zbx_free(fit_str);
 
-        // 初始化零时间
-        zero_time.sec = values.values[values.values_num - 1].timestamp.sec;
-        zero_time.ns = values.values[values.values_num - 1].timestamp.ns;
+	zbx_free(t);
+	zbx_free(x);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
+
+	return ret;
+}
 
-        // 根据数据类型分别处理时间数组和值数组
-        if (ITEM_VALUE_TYPE_FLOAT == item->value_type)
 /******************************************************************************
  * 
  ******************************************************************************/
@@ -3165,9 +3749,24 @@ static int evaluate_TIMELEFT(char *value, DC_ITEM *item, const char *parameters,
  *   - 支持的功能包括：last、prev、min、max、avg、sum、percentile、count、delta、nodata、date、dayofweek、dayofmonth、time、abschange、change、diff、str、regexp、iregexp、strlen、now、fuzzytime、logeventid、logseverity、logsource、band、forecast、timeleft等
  *   - 如果传入的函数名不支持，返回失败，并提示错误信息
  */
-int evaluate_function(char *value, DC_ITEM *item, const char *function, const char *parameter, const zbx_timespec_t *ts, char **error)
+/******************************************************************************
+ *                                                                            *
+ * Function: evaluate_function                                                *
+ *                                                                            *
+ * Purpose: evaluate function                                                 *
+ *                                                                            *
+ * Parameters: item - item to calculate function for                          *
+ *             function - function (for example, 'max')                       *
+ *             parameter - parameter of the function                          *
+ *                                                                            *
+ * Return value: SUCCEED - evaluated successfully, value contains its value   *
+ *               FAIL - evaluation failed                                     *
+ *                                                                            *
+ ******************************************************************************/
+int	evaluate_function(char *value, DC_ITEM *item, const char *function, const char *parameter,
+		const zbx_timespec_t *ts, char **error)
 {
-	const char *__function_name = "evaluate_function"; // 定义函数名
+	const char	*__function_name = "evaluate_function"; // 定义函数名
 
 	int		ret; // 定义返回值
 	struct tm	*tm = NULL; // 定义时间结构体指针
@@ -3317,88 +3916,6 @@ int evaluate_function(char *value, DC_ITEM *item, const char *function, const ch
 	return ret;
 }
 
-	{
-		time_t	now = ts->sec;
-
-		tm = localtime(&now);
-		zbx_snprintf(value, MAX_BUFFER_LEN, "%d", tm->tm_mday);
-		ret = SUCCEED;
-	}
-	else if (0 == strcmp(function, "time"))
-	{
-		time_t	now = ts->sec;
-
-		tm = localtime(&now);
-		zbx_snprintf(value, MAX_BUFFER_LEN, "%.2d%.2d%.2d", tm->tm_hour, tm->tm_min, tm->tm_sec);
-		ret = SUCCEED;
-	}
-	else if (0 == strcmp(function, "abschange"))
-	{
-		ret = evaluate_ABSCHANGE(value, item, ts, error);
-	}
-	else if (0 == strcmp(function, "change"))
-	{
-		ret = evaluate_CHANGE(value, item, ts, error);
-	}
-	else if (0 == strcmp(function, "diff"))
-	{
-		ret = evaluate_DIFF(value, item, ts, error);
-	}
-	else if (0 == strcmp(function, "str") || 0 == strcmp(function, "regexp") || 0 == strcmp(function, "iregexp"))
-	{
-		ret = evaluate_STR(value, item, function, parameter, ts, error);
-	}
-	else if (0 == strcmp(function, "strlen"))
-	{
-		ret = evaluate_STRLEN(value, item, parameter, ts, error);
-	}
-	else if (0 == strcmp(function, "now"))
-	{
-		zbx_snprintf(value, MAX_BUFFER_LEN, "%d", ts->sec);
-		ret = SUCCEED;
-	}
-	else if (0 == strcmp(function, "fuzzytime"))
-	{
-		ret = evaluate_FUZZYTIME(value, item, parameter, ts, error);
-	}
-	else if (0 == strcmp(function, "logeventid"))
-	{
-		ret = evaluate_LOGEVENTID(value, item, parameter, ts, error);
-	}
-	else if (0 == strcmp(function, "logseverity"))
-	{
-		ret = evaluate_LOGSEVERITY(value, item, ts, error);
-	}
-	else if (0 == strcmp(function, "logsource"))
-	{
-		ret = evaluate_LOGSOURCE(value, item, parameter, ts, error);
-	}
-	else if (0 == strcmp(function, "band"))
-	{
-		ret = evaluate_BAND(value, item, parameter, ts, error);
-	}
-	else if (0 == strcmp(function, "forecast"))
-	{
-		ret = evaluate_FORECAST(value, item, parameter, ts, error);
-	}
-	else if (0 == strcmp(function, "timeleft"))
-	{
-		ret = evaluate_TIMELEFT(value, item, parameter, ts, error);
-	}
-	else
-	{
-		*error = zbx_strdup(*error, "function is not supported");
-		ret = FAIL;
-	}
-
-	if (SUCCEED == ret)
-		del_zeros(value);
-
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s value:'%s'", __function_name, zbx_result_string(ret), value);
-
-	return ret;
-}
-
 /******************************************************************************
  *                                                                            *
  * Function: add_value_suffix_uptime                                          *
@@ -3477,14 +3994,14 @@ static void add_value_suffix_uptime(char *value, size_t max_len)
  * *
  *这段代码的主要目的是将一个时间值（以秒为单位）转换为人类可读的字符串形式，例如“1y 2m 3d 4h 5ms”等。代码首先判断输入的时间值是否为0或小于1毫秒，如果是，则直接返回。然后根据时间值的大小，分别计算年、月、日、小时、分钟和秒的数量，并将它们拼接成字符串。最后，去掉字符串末尾的空格并返回。
  ******************************************************************************/
-static void add_value_suffix_s(char *value, size_t max_len)
+static void	add_value_suffix_s(char *value, size_t max_len)
 {
 	/* 定义一些常量和变量 */
-	const char *__function_name = "add_value_suffix_s";
+	const char	*__function_name = "add_value_suffix_s";
 
-	double secs, n;
-	size_t offset = 0;
-	int n_unit = 0;
+	double	secs, n;
+	size_t	offset = 0;
+	int	n_unit = 0;
 
 	/* 打印调试信息 */
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
@@ -3559,8 +4076,8 @@ static void add_value_suffix_s(char *value, size_t max_len)
 	/* 如果值不为0，去掉末尾的空格 */
 	if (0 != offset && ' ' == value[--offset])
 		value[offset] = '\0';
-
 	/* 打印调试信息 */
+clean:
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __function_name);
 }
 
@@ -3603,6 +4120,20 @@ static int	is_blacklisted_unit(const char *unit)
 	/* 记录函数返回值日志，调试用 */
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
 
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: add_value_units_no_kmgt                                          *
+ *                                                                            *
+ * Purpose: add only units to the value                                       *
+ *                                                                            *
+ * Parameters: value - value for adjusting                                    *
+ *             max_len - max len of the value                                 *
+ *             units - units (bps, b, B, etc)                                 *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  * *
  *整个代码块的主要目的是将一个数值和一个单位组合在一起，形成一个字符串。在这个过程中，首先将输入的值转换为double类型，如果值为负数，设置minus为\"-\"并取相反数。然后判断值是否发生了变化，如果发生变化，格式化一个新的字符串并删除末尾的零；否则，只保留零位小数。最后，将处理后的值、minus和单位组合成一个字符串，并输出结果。
@@ -3647,23 +4178,6 @@ static void add_value_units_no_kmgt(char *value, size_t max_len, const char *uni
     zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __function_name);
 }
 
-		minus = "-";
-		value_double = -value_double;
-	}
-
-	if (SUCCEED != zbx_double_compare(round(value_double), value_double))
-	{
-		zbx_snprintf(tmp, sizeof(tmp), ZBX_FS_DBL_EXT(2), value_double);
-		del_zeros(tmp);
-	}
-	else
-		zbx_snprintf(tmp, sizeof(tmp), ZBX_FS_DBL_EXT(0), value_double);
-
-	zbx_snprintf(value, max_len, "%s%s %s", minus, tmp, units);
-
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __function_name);
-}
-
 /******************************************************************************
  *                                                                            *
  * Function: add_value_units_with_kmgt                                        *
@@ -3798,6 +4312,38 @@ static void	add_value_suffix(char *value, size_t max_len, const char *units, uns
 				break;
 			}
 			ZBX_FALLTHROUGH;
+		case ITEM_VALUE_TYPE_FLOAT:
+			if (0 == strcmp(units, "s"))
+				add_value_suffix_s(value, max_len);
+			else if (0 == strcmp(units, "uptime"))
+				add_value_suffix_uptime(value, max_len);
+			else if ('!' == *units)
+				add_value_units_no_kmgt(value, max_len, (const char *)(units + 1));
+			else if (SUCCEED == is_blacklisted_unit(units))
+				add_value_units_no_kmgt(value, max_len, units);
+			else if ('\0' != *units)
+				add_value_units_with_kmgt(value, max_len, units);
+			break;
+		default:
+			;
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() value:'%s'", __function_name, value);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: replace_value_by_map                                             *
+ *                                                                            *
+ * Purpose: replace value by mapping value                                    *
+ *                                                                            *
+ * Parameters: value - value for replacing                                    *
+ *             valuemapid - index of value map                                *
+ *                                                                            *
+ * Return value: SUCCEED - evaluated successfully, value contains new value   *
+ *               FAIL - evaluation failed, value contains old value           *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  * 
  ******************************************************************************/
@@ -3869,39 +4415,6 @@ clean:
 	return ret;
 }
 
-	int		ret = FAIL;
-
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s() value:'%s' valuemapid:" ZBX_FS_UI64, __function_name, value, valuemapid);
-
-	if (0 == valuemapid)
-		goto clean;
-
-	value_esc = DBdyn_escape_string(value);
-	result = DBselect(
-			"select newvalue"
-			" from mappings"
-			" where valuemapid=" ZBX_FS_UI64
-				" and value" ZBX_SQL_STRCMP,
-			valuemapid, ZBX_SQL_STRVAL_EQ(value_esc));
-	zbx_free(value_esc);
-
-	if (NULL != (row = DBfetch(result)) && FAIL == DBis_null(row[0]))
-	{
-		del_zeros(row[0]);
-
-		value_tmp = zbx_dsprintf(NULL, "%s (%s)", row[0], value);
-		zbx_strlcpy_utf8(value, value_tmp, max_len);
-		zbx_free(value_tmp);
-
-		ret = SUCCEED;
-	}
-	DBfree_result(result);
-clean:
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() value:'%s'", __function_name, value);
-
-	return ret;
-}
-
 /******************************************************************************
  *                                                                            *
  * Function: zbx_format_value                                                 *
@@ -3924,31 +4437,59 @@ clean:
 // valuemapid：值映射ID
 // units：单位字符串
 // value_type：数据类型（字符串、浮点数、无符号64位整数等）
-void zbx_format_value(char *value, size_t max_len, zbx_uint64_t valuemapid,
-                      const char *units, unsigned char value_type)
+void	zbx_format_value(char *value, size_t max_len, zbx_uint64_t valuemapid,
+		const char *units, unsigned char value_type)
 {
-    // 定义一个名为 __function_name 的常量字符串，表示当前函数名
-    const char *__function_name = "zbx_format_value";
+	// 定义一个名为 __function_name 的常量字符串，表示当前函数名
+	const char	*__function_name = "zbx_format_value";
 
-    // 使用 zabbix_log 记录调试日志，表示进入 zbx_format_value 函数
-    zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
+	// 使用 zabbix_log 记录调试日志，表示进入 zbx_format_value 函数
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
+
+	// 根据 value_type 进行switch分支处理
+	switch (value_type)
+	{
+		// 当 value_type 为 ITEM_VALUE_TYPE_STR（字符串）时，执行以下操作
+		case ITEM_VALUE_TYPE_STR:
+			replace_value_by_map(value, max_len, valuemapid);
+			break;
+		// 当 value_type 为 ITEM_VALUE_TYPE_FLOAT（浮点数）时，执行以下操作
+		case ITEM_VALUE_TYPE_FLOAT:
+			del_zeros(value);
+			// 由于 case ITEM_VALUE_TYPE_FLOAT 和 case ITEM_VALUE_TYPE_UINT64 之间使用了 ZBX_FALLTHROUGH，所以接下来的代码块也会适用于浮点数类型
+			// 当 value_type 为 ITEM_VALUE_TYPE_UINT64（无符号64位整数）时，执行以下操作
+			ZBX_FALLTHROUGH;
+		case ITEM_VALUE_TYPE_UINT64:
+			if (SUCCEED != replace_value_by_map(value, max_len, valuemapid))
+				// 如果替换值失败，则为数据值添加单位后缀
+				add_value_suffix(value, max_len, units, value_type);
+			break;
+		default:
+			;
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __function_name);
+}
 
-    // 根据 value_type 进行switch分支处理
-    switch (value_type)
-    {
-        // 当 value_type 为 ITEM_VALUE_TYPE_STR（字符串）时，执行以下操作
-        case ITEM_VALUE_TYPE_STR:
-            replace_value_by_map(value, max_len, valuemapid);
-            break;
-        // 当 value_type 为 ITEM_VALUE_TYPE_FLOAT（浮点数）时，执行以下操作
-        case ITEM_VALUE_TYPE_FLOAT:
-            del_zeros(value);
-            // 由于 case ITEM_VALUE_TYPE_FLOAT 和 case ITEM_VALUE_TYPE_UINT64 之间使用了 ZBX_FALLTHROUGH，所以接下来的代码块也会适用于浮点数类型
-        // 当 value_type 为 ITEM_VALUE_TYPE_UINT64（无符号64位整数）时，执行以下操作
-        case ITEM_VALUE_TYPE_UINT64:
-            if (SUCCEED != replace_value_by_map(value, max_len, valuemapid))
-            {
-                // 如果替换值失败，则为数据值添加单位后缀
+/******************************************************************************
+ *                                                                            *
+ * Function: evaluate_macro_function                                          *
+ *                                                                            *
+ * Purpose: evaluate function used in simple macro                            *
+ *                                                                            *
+ * Parameters: result    - [OUT] evaluation result (if it's successful)       *
+ *             host      - [IN] host the key belongs to                       *
+ *             key       - [IN] item's key                                    *
+ *                              (for example, 'system.cpu.load[,avg1]')       *
+ *             function  - [IN] function name (for example, 'max')            *
+ *             parameter - [IN] function parameter list                       *
+ *                                                                            *
+ * Return value: SUCCEED - evaluated successfully, value contains its value   *
+ *               FAIL - evaluation failed                                     *
+ *                                                                            *
+ * Comments: used for evaluation of notification macros                       *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  * *
  *整个代码块的主要目的是评估通知宏函数，根据提供的主机、键、函数名和函数参数计算结果值，并将结果值存储在result指针中。如果计算失败，返回FAIL，否则返回SUCCEED。在计算过程中，根据函数名和参数格式化结果值，并添加相应的后缀。
@@ -4033,29 +4574,6 @@ int	evaluate_macro_function(char **result, const char *host, const char *key, co
 	/* 记录日志，显示函数返回结果 */
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s value:'%s'", __function_name, zbx_result_string(ret), value);
 
-	return ret;
-}
-
-					add_value_suffix(value, MAX_BUFFER_LEN, item.units, item.value_type);
-					break;
-				default:
-					;
-			}
-		}
-		else if (SUCCEED == str_in_list("timeleft", function, ','))
-		{
-			add_value_suffix(value, MAX_BUFFER_LEN, "s", ITEM_VALUE_TYPE_FLOAT);
-		}
-
-		*result = zbx_strdup(NULL, value);
-		ret = SUCCEED;
-	}
-
-	DCconfig_clean_items(&item, &errcode, 1);
-	zbx_free(error);
-
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s value:'%s'", __function_name, zbx_result_string(ret), value);
-
 	return ret;
 }
 
@@ -4080,22 +4598,19 @@ int	evaluate_macro_function(char **result, const char *host, const char *key, co
  */
 int	evaluatable_for_notsupported(const char *fn)
 {
-	/* 声明一个字符串变量，用于存储函数名称的前一个字符 */
-	char prev_char;
-
-	/* 获取函数名称的第一个字符，并将其存储在 prev_char 变量中 */
-	prev_char = *fn;
+	/* functions date(), dayofmonth(), dayofweek(), now(), time() and nodata() are exceptions, */
+	/* they should be evaluated for NOTSUPPORTED items, too */
 
 	/* 判断 prev_char 是否为 'n'、'd' 或 't'，如果不是，返回 FAIL */
-	if ('n' != prev_char && 'd' != prev_char && 't' != prev_char)
+	if ('n' != *fn && 'd' != *fn && 't' != *fn)
 		return FAIL;
 
 	/* 判断 prev_char 是否为 'n'，如果是，比较 fn 字符串与 "nodata" 或 "now" 是否相等，相等则返回 SUCCEED，否则返回 FAIL */
-	if (('n' == prev_char) && (0 == strcmp(fn, "nodata") || 0 == strcmp(fn, "now")))
+	if (('n' == *fn) && (0 == strcmp(fn, "nodata") || 0 == strcmp(fn, "now")))
 		return SUCCEED;
 
 	/* 判断 prev_char 是否为 'd'，如果是，比较 fn 字符串与 "dayofweek"、"dayofmonth" 或 "date" 是否相等，相等则返回 SUCCEED，否则返回 FAIL */
-	if (('d' == prev_char) && (0 == strcmp(fn, "dayofweek") || 0 == strcmp(fn, "dayofmonth") || 0 == strcmp(fn, "date")))
+	if (('d' == *fn) && (0 == strcmp(fn, "dayofweek") || 0 == strcmp(fn, "dayofmonth") || 0 == strcmp(fn, "date")))
 		return SUCCEED;
 
 	/* 如果 fn 字符串等于 "time"，则返回 SUCCEED */
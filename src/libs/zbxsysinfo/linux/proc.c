@@ -423,6 +423,178 @@ static int	get_total_memory(zbx_uint64_t *total_memory)
 	return ret;
 }
 
+/* process files kept in the snapshot shared by proc.mem[] and proc.num[] items */
+typedef struct
+{
+	/* the lines of /proc/<pid>/status file used by the items */
+	char	*status;
+	size_t	status_len;
+
+	/* /proc/<pid>/cmdline file as returned by get_cmdline() */
+	char	*cmdline;
+	size_t	cmdline_len;
+}
+zbx_proc_files_t;
+
+static zbx_vector_ptr_t	proc_snapshot;
+static int		proc_snapshot_created = 0;
+static double		proc_snapshot_time;
+
+static void	proc_files_free(zbx_proc_files_t *proc)
+{
+	zbx_free(proc->status);
+	zbx_free(proc->cmdline);
+
+	zbx_free(proc);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: proc_read_files                                                  *
+ *                                                                            *
+ * Purpose: reads process files used by proc.mem[] and proc.num[] items       *
+ *                                                                            *
+ * Parameters: pid - [IN] the process identifier                              *
+ *                                                                            *
+ * Return value: The process files or NULL if they cannot be read.            *
+ *                                                                            *
+ * Comments: Only the status lines checked by the items are kept, in the same *
+ *           order as in the file.                                            *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_proc_files_t	*proc_read_files(const char *pid)
+{
+	char			tmp[MAX_STRING_LEN];
+	FILE			*f_cmd, *f_stat;
+	zbx_proc_files_t	*proc = NULL;
+	size_t			status_alloc = 0;
+
+	zbx_snprintf(tmp, sizeof(tmp), "/proc/%s/cmdline", pid);
+
+	if (NULL == (f_cmd = fopen(tmp, "r")))
+		return NULL;
+
+	zbx_snprintf(tmp, sizeof(tmp), "/proc/%s/status", pid);
+
+	if (NULL == (f_stat = fopen(tmp, "r")))
+		goto out;
+
+	proc = (zbx_proc_files_t *)zbx_malloc(NULL, sizeof(zbx_proc_files_t));
+	proc->status = NULL;
+	proc->status_len = 0;
+	proc->cmdline = NULL;
+
+	while (NULL != fgets(tmp, (int)sizeof(tmp), f_stat))
+	{
+		if (0 == strncmp(tmp, "Name:\t", 6) || 0 == strncmp(tmp, "State:\t", 7) ||
+				0 == strncmp(tmp, "Uid:\t", 5) || 0 == strncmp(tmp, "Vm", 2))
+		{
+			zbx_strcpy_alloc(&proc->status, &status_alloc, &proc->status_len, tmp);
+		}
+	}
+
+	/* the command line is terminated by two '\0' characters, so it is never empty */
+	if (0 != ferror(f_stat) || SUCCEED != get_cmdline(f_cmd, &proc->cmdline, &proc->cmdline_len))
+	{
+		proc_files_free(proc);
+		proc = NULL;
+	}
+	else
+		proc->cmdline = (char *)zbx_realloc(proc->cmdline, proc->cmdline_len);
+
+	zbx_fclose(f_stat);
+out:
+	zbx_fclose(f_cmd);
+
+	return proc;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: proc_update_snapshot                                             *
+ *                                                                            *
+ * Purpose: reads all processes if the snapshot is older than one second      *
+ *                                                                            *
+ * Return value: SUCCEED - the snapshot is up to date                         *
+ *               FAIL    - failed to open /proc directory, errno is set       *
+ *                                                                            *
+ * Comments: Walking /proc and opening the files of every process for each    *
+ *           proc.mem[] and proc.num[] item is expensive on hosts with many   *
+ *           processes, so the items checked within the same second share one *
+ *           snapshot.                                                        *
+ *                                                                            *
+ ******************************************************************************/
+static int	proc_update_snapshot(void)
+{
+	DIR			*dir;
+	struct dirent		*entries;
+	zbx_proc_files_t	*proc;
+	double			now;
+
+	now = zbx_time();
+
+	/* also refresh the snapshot if the system time was moved back */
+	if (0 != proc_snapshot_created && proc_snapshot_time <= now && now < proc_snapshot_time + 1.0)
+		return SUCCEED;
+
+	if (NULL == (dir = opendir("/proc")))
+		return FAIL;
+
+	if (0 == proc_snapshot_created)
+	{
+		zbx_vector_ptr_create(&proc_snapshot);
+		proc_snapshot_created = 1;
+	}
+	else
+		zbx_vector_ptr_clear_ext(&proc_snapshot, (zbx_mem_free_func_t)proc_files_free);
+
+	while (NULL != (entries = readdir(dir)))
+	{
+		if (0 == atoi(entries->d_name))
+			continue;
+
+		if (NULL != (proc = proc_read_files(entries->d_name)))
+			zbx_vector_ptr_append(&proc_snapshot, proc);
+	}
+
+	closedir(dir);
+
+	proc_snapshot_time = now;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: proc_open_files                                                  *
+ *                                                                            *
+ * Purpose: opens snapshot copies of process files as streams, so they can be *
+ *          checked the same way as the files in /proc                        *
+ *                                                                            *
+ * Parameters: proc   - [IN] the process files                                *
+ *             f_cmd  - [OUT] the command line stream                         *
+ *             f_stat - [OUT] the status stream                               *
+ *                                                                            *
+ * Return value: SUCCEED - the streams were opened                            *
+ *               FAIL    - otherwise, the opened stream must be closed        *
+ *                                                                            *
+ ******************************************************************************/
+static int	proc_open_files(zbx_proc_files_t *proc, FILE **f_cmd, FILE **f_stat)
+{
+	static char	empty[] = "";
+
+	if (NULL == (*f_cmd = fmemopen(proc->cmdline, proc->cmdline_len, "r")))
+		return FAIL;
+
+	/* fmemopen() fails on zero size buffer in older glibc versions */
+	if (0 == proc->status_len)
+		*f_stat = fmemopen(empty, sizeof(empty), "r");
+	else
+		*f_stat = fmemopen(proc->status, proc->status_len, "r");
+
+	return NULL != *f_stat ? SUCCEED : FAIL;
+}
+
 int	PROC_MEM(AGENT_REQUEST *request, AGENT_RESULT *result)
 {
     // 定义一些常量，用于表示不同的内存类型
@@ -442,14 +614,12 @@ int	PROC_MEM(AGENT_REQUEST *request, AGENT_RESULT *result)
     #define ZBX_VMPTE	13
 
     // 一些变量声明
-    char		tmp[MAX_STRING_LEN], *procname, *proccomm, *param;
-    DIR		*dir;
-    struct dirent	*entries;
+    char		*procname, *proccomm, *param;
     struct passwd	*usrinfo;
     FILE		*f_cmd = NULL, *f_stat = NULL;
     zbx_uint64_t	mem_size = 0, byte_value = 0, total_memory;
     double		pct_size = 0.0, pct_value = 0.0;
-    int		do_task, res, proccount = 0, invalid_user = 0, invalid_read = 0;
+    int		do_task, res, proccount = 0, invalid_user = 0, invalid_read = 0, i;
     int		mem_type_tried = 0, mem_type_code;
     char		*mem_type = NULL;
     const char	*mem_type_search = NULL;
@@ -608,28 +778,18 @@ int	PROC_MEM(AGENT_REQUEST *request, AGENT_RESULT *result)
 		}
 	}
 
-	if (NULL == (dir = opendir("/proc")))
+	if (SUCCEED != proc_update_snapshot())
 	{
 		SET_MSG_RESULT(result, zbx_dsprintf(NULL, "Cannot open /proc: %s", zbx_strerror(errno)));
 		return SYSINFO_RET_FAIL;
 	}
 
-	while (NULL != (entries = readdir(dir)))
+	for (i = 0; i < proc_snapshot.values_num; i++)
 	{
 		zbx_fclose(f_cmd);
 		zbx_fclose(f_stat);
 
-		if (0 == atoi(entries->d_name))
-			continue;
-
-		zbx_snprintf(tmp, sizeof(tmp), "/proc/%s/cmdline", entries->d_name);
-
-		if (NULL == (f_cmd = fopen(tmp, "r")))
-			continue;
-
-		zbx_snprintf(tmp, sizeof(tmp), "/proc/%s/status", entries->d_name);
-
-		if (NULL == (f_stat = fopen(tmp, "r")))
+		if (SUCCEED != proc_open_files((zbx_proc_files_t *)proc_snapshot.values[i], &f_cmd, &f_stat))
 			continue;
 
 		if (FAIL == check_procname(f_cmd, f_stat, procname))
@@ -767,7 +927,6 @@ int	PROC_MEM(AGENT_REQUEST *request, AGENT_RESULT *result)
 clean:
 	zbx_fclose(f_cmd);
 	zbx_fclose(f_stat);
-	closedir(dir);
 
 	if ((0 == proccount && 0 != mem_type_tried) || 0 != invalid_read)
 	{
@@ -815,12 +974,10 @@ out:
 
 int	PROC_NUM(AGENT_REQUEST *request, AGENT_RESULT *result)
 {
-	char		tmp[MAX_STRING_LEN], *procname, *proccomm, *param;
-	DIR		*dir;
-	struct dirent	*entries;
+	char		*procname, *proccomm, *param;
 	struct passwd	*usrinfo;
 	FILE		*f_cmd = NULL, *f_stat = NULL;
-	int		proccount = 0, invalid_user = 0, zbx_proc_stat;
+	int		proccount = 0, invalid_user = 0, zbx_proc_stat, i;
 
 	if (4 < request->nparam)
 	{
@@ -875,28 +1032,18 @@ int	PROC_NUM(AGENT_REQUEST *request, AGENT_RESULT *result)
 	if (1 == invalid_user)	/* handle 0 for non-existent user after all parameters have been parsed and validated */
 		goto out;
 
-	if (NULL == (dir = opendir("/proc")))
+	if (SUCCEED != proc_update_snapshot())
 	{
 		SET_MSG_RESULT(result, zbx_dsprintf(NULL, "Cannot open /proc: %s", zbx_strerror(errno)));
 		return SYSINFO_RET_FAIL;
 	}
 
-	while (NULL != (entries = readdir(dir)))
+	for (i = 0; i < proc_snapshot.values_num; i++)
 	{
 		zbx_fclose(f_cmd);
 		zbx_fclose(f_stat);
 
-		if (0 == atoi(entries->d_name))
-			continue;
-
-		zbx_snprintf(tmp, sizeof(tmp), "/proc/%s/cmdline", entries->d_name);
-
-		if (NULL == (f_cmd = fopen(tmp, "r")))
-			continue;
-
-		zbx_snprintf(tmp, sizeof(tmp), "/proc/%s/status", entries->d_name);
-
-		if (NULL == (f_stat = fopen(tmp, "r")))
+		if (SUCCEED != proc_open_files((zbx_proc_files_t *)proc_snapshot.values[i], &f_cmd, &f_stat))
 			continue;
 
 		if (FAIL == check_procname(f_cmd, f_stat, procname))
@@ -915,7 +1062,6 @@ int	PROC_NUM(AGENT_REQUEST *request, AGENT_RESULT *result)
 	}
 	zbx_fclose(f_cmd);
 	zbx_fclose(f_stat);
-	closedir(dir);
 out:
 	SET_UI64_RESULT(result, proccount);
 
@@ -46,11 +46,26 @@ extern ZBX_THREAD_LOCAL int		server_num, process_num;
 
 #include "../libs/zbxcrypto/tls.h"
 
+#if !defined(_WINDOWS)
+#	include "activespool.h"
+
+extern int	CONFIG_ACTIVE_FORKS;
+
+/* the number of values sent from buffer file in one request and the maximum number of requests per send */
+#define ZBX_SPOOL_BATCH_SIZE	1000
+#define ZBX_SPOOL_BATCHES_MAX	10
+#endif
 ZBX_THREAD_LOCAL static ZBX_ACTIVE_BUFFER	buffer;
 ZBX_THREAD_LOCAL static zbx_vector_ptr_t	active_metrics;
+ZBX_THREAD_LOCAL static zbx_binary_heap_t	active_schedule;	/* metrics ready to process, by nextcheck */
+ZBX_THREAD_LOCAL static zbx_uint64_t		last_metricid = 0;
 ZBX_THREAD_LOCAL static zbx_vector_ptr_t	regexps;
 ZBX_THREAD_LOCAL static char			*session_token;
 ZBX_THREAD_LOCAL static zbx_uint64_t		last_valueid = 0;
+#if !defined(_WINDOWS)
+ZBX_THREAD_LOCAL static zbx_active_spool_t	spool;
+ZBX_THREAD_LOCAL static int			spool_lastsent = 0;
+#endif
 
 #ifdef _WINDOWS
 LONG WINAPI	DelayLoadDllExceptionFilter(PEXCEPTION_POINTERS excpointers)
@@ -99,9 +114,46 @@ switch (excpointers->ExceptionRecord->ExceptionCode)
 
 // 返回disposition值
 return disposition;
-
+}
 #endif
 
+/* active checks schedule binary heap support */
+
+/******************************************************************************
+ *                                                                            *
+ * Function: metric_nextcheck_compare                                         *
+ *                                                                            *
+ * Purpose: compares active check schedule heap elements by nextcheck         *
+ *                                                                            *
+ * Parameters: d1 - [IN] the first heap element                               *
+ *             d2 - [IN] the second heap element                              *
+ *                                                                            *
+ * Return value: <0 - the first metric is due before the second one           *
+ *                0 - the elements refer to the same metric                   *
+ *               >0 - the first metric is due after the second one            *
+ *                                                                            *
+ * Comments: Metrics with the same nextcheck are ordered by metricid, so that *
+ *           they are processed in the order they were added.                 *
+ *                                                                            *
+ ******************************************************************************/
+/******************************************************************************
+ * *
+ *按下一次检查时间比较调度堆中的两个元素，时间相同时按指标ID排序。
+ ******************************************************************************/
+static int	metric_nextcheck_compare(const void *d1, const void *d2)
+{
+	const zbx_binary_heap_elem_t	*e1 = (const zbx_binary_heap_elem_t *)d1;
+	const zbx_binary_heap_elem_t	*e2 = (const zbx_binary_heap_elem_t *)d2;
+
+	const ZBX_ACTIVE_METRIC		*m1 = (const ZBX_ACTIVE_METRIC *)e1->data;
+	const ZBX_ACTIVE_METRIC		*m2 = (const ZBX_ACTIVE_METRIC *)e2->data;
+
+	ZBX_RETURN_IF_NOT_EQUAL(m1->nextcheck, m2->nextcheck);
+	ZBX_RETURN_IF_NOT_EQUAL(m1->metricid, m2->metricid);
+
+	return 0;
+}
+
 /******************************************************************************
  * *
  *整个代码块的主要目的是初始化活动指标和相关数据结构。具体来说，包括以下几个步骤：
@@ -118,45 +170,45 @@ return disposition;
  *10. 打印调试日志，表示函数执行完毕。
  ******************************************************************************/
 // 定义一个静态函数，用于初始化活动指标
-static void init_active_metrics(void)
+static void	init_active_metrics(void)
 {
-    // 定义一个字符串指针，用于存储函数名
-    const char *__function_name = "init_active_metrics";
-    size_t		sz;
+	// 定义一个字符串指针，用于存储函数名
+	const char	*__function_name = "init_active_metrics";
+	size_t		sz;
 
-    // 打印调试日志，表示进入该函数
-    zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
+	// 打印调试日志，表示进入该函数
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
 
-    // 检查缓冲区是否存在，如果为空，则进行首次分配
-    if (NULL == buffer.data)
-    {
-        zabbix_log(LOG_LEVEL_DEBUG, "buffer: first allocation for %d elements", CONFIG_BUFFER_SIZE);
-        // 计算缓冲区大小，单位为ZBX_ACTIVE_BUFFER_ELEMENT结构体数量
-        sz = CONFIG_BUFFER_SIZE * sizeof(ZBX_ACTIVE_BUFFER_ELEMENT);
-        // 为缓冲区分配内存空间
-        buffer.data = (ZBX_ACTIVE_BUFFER_ELEMENT *)zbx_malloc(buffer.data, sz);
-        // 将缓冲区内存清零
-        memset(buffer.data, 0, sz);
-        // 初始化缓冲区计数器
-        buffer.count = 0;
-        // 初始化缓冲区发送指针
-        buffer.pcount = 0;
-        // 初始化缓冲区最后一次发送时间
-        buffer.lastsent = (int)time(NULL);
-        // 初始化缓冲区首个错误时间
-        buffer.first_error = 0;
-    }
+	// 检查缓冲区是否存在，如果为空，则进行首次分配
+	if (NULL == buffer.data)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "buffer: first allocation for %d elements", CONFIG_BUFFER_SIZE);
+		// 计算缓冲区大小，单位为ZBX_ACTIVE_BUFFER_ELEMENT结构体数量
+		sz = CONFIG_BUFFER_SIZE * sizeof(ZBX_ACTIVE_BUFFER_ELEMENT);
+		// 为缓冲区分配内存空间
+		buffer.data = (ZBX_ACTIVE_BUFFER_ELEMENT *)zbx_malloc(buffer.data, sz);
+		// 将缓冲区内存清零
+		memset(buffer.data, 0, sz);
+		// 初始化缓冲区计数器
+		buffer.count = 0;
+		// 初始化缓冲区发送指针
+		buffer.pcount = 0;
+		// 初始化缓冲区最后一次发送时间
+		buffer.lastsent = (int)time(NULL);
+		// 初始化缓冲区首个错误时间
+		buffer.first_error = 0;
+	}
 
-    // 创建一个指向活动指标的指针向量
-    zbx_vector_ptr_create(&active_metrics);
-    // 创建一个指向正则表达式的指针向量
-    zbx_vector_ptr_create(&regexps);
+	// 创建一个指向活动指标的指针向量
+	zbx_vector_ptr_create(&active_metrics);
+	zbx_binary_heap_create(&active_schedule, metric_nextcheck_compare, ZBX_BINARY_HEAP_OPTION_DIRECT);
+	// 创建一个指向正则表达式的指针向量
+	zbx_vector_ptr_create(&regexps);
 
-    // 打印调试日志，表示函数执行完毕
-    zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __function_name);
+	// 打印调试日志，表示函数执行完毕
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __function_name);
 }
 
-
 /******************************************************************************
  * *
  *整个注释好的代码块如下：
@@ -188,7 +240,6 @@ static void	free_active_metric(ZBX_ACTIVE_METRIC *metric)
 	zbx_free(metric);
 }
 
-
 #ifdef _WINDOWS
 /******************************************************************************
  * *
@@ -205,10 +256,10 @@ static void	free_active_metric(ZBX_ACTIVE_METRIC *metric)
  *代码块中的注释详细说明了每个步骤的目的和操作，帮助读者更好地理解代码功能。
  ******************************************************************************/
 /* 定义一个静态函数 free_active_metrics，用于释放活跃的性能指标数据结构。 */
-static void free_active_metrics(void)
+static void	free_active_metrics(void)
 {
 	/* 定义一个字符串常量，表示函数名 */
-	const char *__function_name = "free_active_metrics";
+	const char	*__function_name = "free_active_metrics";
 
 	/* 使用 zabbix_log 记录函数调用日志，表示调试级别 */
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
@@ -219,6 +270,8 @@ static void free_active_metrics(void)
 	/* 释放正则表达式的内存 */
 	zbx_vector_ptr_destroy(&regexps);
 
+	zbx_binary_heap_destroy(&active_schedule);
+
 	/* 遍历活跃性能指标数据结构，释放每个节点的内存 */
 	zbx_vector_ptr_clear_ext(&active_metrics, (zbx_clean_func_t)free_active_metric);
 
@@ -228,7 +281,6 @@ static void free_active_metrics(void)
 	/* 使用 zabbix_log 记录函数调用日志，表示调试级别 */
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __function_name);
 }
-
 #endif
 
 /******************************************************************************
@@ -236,35 +288,75 @@ static void free_active_metrics(void)
  *这块代码的主要目的是判断一个ZBX_ACTIVE_METRIC结构体中的状态（state）和刷新不支持状态（refresh_unsupported）的值，如果满足特定条件，返回FAIL表示处理失败，否则返回SUCCEED表示处理成功。
  ******************************************************************************/
 // 定义一个静态函数metric_ready_to_process，参数为一个ZBX_ACTIVE_METRIC结构体的指针
-static int metric_ready_to_process(const ZBX_ACTIVE_METRIC *metric)
+static int	metric_ready_to_process(const ZBX_ACTIVE_METRIC *metric)
 {
-    // 判断metric的结构体中的state字段值是否为ITEM_STATE_NOTSUPPORTED
-    // 并且refresh_unsupported字段值为0
-    if (ITEM_STATE_NOTSUPPORTED == metric->state && 0 == metric->refresh_unsupported)
-    {
-        // 如果满足条件，返回FAIL，表示处理失败
-        return FAIL;
-    }
+	// 判断metric的结构体中的state字段值是否为ITEM_STATE_NOTSUPPORTED
+	// 并且refresh_unsupported字段值为0，如果满足条件，返回FAIL，表示处理失败
+	if (ITEM_STATE_NOTSUPPORTED == metric->state && 0 == metric->refresh_unsupported)
+		return FAIL;
 
-    // 如果不满足条件，返回SUCCEED，表示处理成功
-    return SUCCEED;
+	// 如果不满足条件，返回SUCCEED，表示处理成功
+	return SUCCEED;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: schedule_metric                                                  *
+ *                                                                            *
+ * Purpose: adds metric to the active checks schedule                         *
+ *                                                                            *
+ * Parameters: metric - [IN] the metric to schedule                           *
+ *                                                                            *
+ * Comments: Metrics that are not ready to process (not supported and not     *
+ *           refreshed) are left out of the schedule until the next refresh   *
+ *           of active checks list.                                           *
+ *                                                                            *
+ ******************************************************************************/
+/******************************************************************************
+ * *
+ *将准备好处理的指标按下一次检查时间加入调度堆。
+ ******************************************************************************/
+static void	schedule_metric(ZBX_ACTIVE_METRIC *metric)
+{
+	zbx_binary_heap_elem_t	elem = {metric->metricid, (const void *)metric};
+
+	if (SUCCEED == metric_ready_to_process(metric))
+		zbx_binary_heap_insert(&active_schedule, &elem);
+}
 
+/******************************************************************************
+ *                                                                            *
+ * Function: get_min_nextcheck                                                *
+ *                                                                            *
+ * Purpose: returns the earliest nextcheck of scheduled metrics               *
+ *                                                                            *
+ * Return value: the earliest nextcheck or FAIL if no metrics are scheduled   *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  * *
- *整个代码块的主要目的是获取活跃度指标（active_metrics）数组中下一个检查时间（nextcheck）的最小值。函数通过遍历 active_metrics 数组，逐个判断metric的nextcheck值，并更新min值。如果min值为-1，则将其设置为FAIL。最后，将找到的最小下一个检查时间（min）作为结果返回。在整个过程中，使用了zabbix_log函数记录日志，以表示函数的执行状态。
+ *返回调度堆中最早的下一次检查时间，没有待处理的指标时返回FAIL。
  ******************************************************************************/
 // 定义一个名为 get_min_nextcheck 的静态函数
-static int get_min_nextcheck(void)
+static int	get_min_nextcheck(void)
 {
-    // 定义一个常量字符串，表示函数名
-    const char *__function_name = "get_min_nextcheck";
-    // 定义一个整型变量 i，用于循环计数
-    int i, min = -1;
+	// 定义一个常量字符串，表示函数名
+	const char	*__function_name = "get_min_nextcheck";
+	int		min;
+
+	// 使用 zabbix_log 函数记录日志，表示函数开始执行
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
+
+	if (SUCCEED == zbx_binary_heap_empty(&active_schedule))
+		min = FAIL;
+	else
+		min = ((const ZBX_ACTIVE_METRIC *)zbx_binary_heap_find_min(&active_schedule)->data)->nextcheck;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%d", __function_name, min);
+
+	return min;
+}
 
-    // 使用 zabbix_log 函数记录日志，表示函数开始执行
-    zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
 /******************************************************************************
  * *
  *这段代码的主要目的是添加一个新的metric（用于监控数据）到活跃的metric列表中。具体来说，这个函数接收一个键（key）、键的原始值（key_orig）、刷新间隔（refresh）、最后一次日志大小（lastlogsize）和修改时间（mtime）作为参数。在满足条件的情况下，它会更新已有的metric或创建一个新的metric并将其添加到活跃的metric列表中。
@@ -276,7 +368,7 @@ static void add_check(const char *key, const char *key_orig, int refresh, zbx_ui
 	int			i;
 
 	// 打印调试日志
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s() key:'%s' refresh:%d lastlogsize:%llu mtime:%d",
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() key:'%s' refresh:%d lastlogsize:" ZBX_FS_UI64 " mtime:%d",
 			__function_name, key, refresh, lastlogsize, mtime);
 
 	// 遍历活跃的metric列表
@@ -288,6 +380,9 @@ static void add_check(const char *key, const char *key_orig, int refresh, zbx_ui
 		if (0 != strcmp(metric->key_orig, key_orig))
 			continue;
 
+		/* the metric is rescheduled below as its nextcheck or readiness might change */
+		if (SUCCEED == metric_ready_to_process(metric))
+			zbx_binary_heap_remove_direct(&active_schedule, metric->metricid);
 		// 如果metric的key与传入的key不同，复制新的key，并更新metric的相关信息
 		if (0 != strcmp(metric->key, key))
 		{
@@ -309,6 +404,7 @@ static void add_check(const char *key, const char *key_orig, int refresh, zbx_ui
 			metric->logfiles_num = 0;
 			metric->start_time = 0.0;
 			metric->processed_bytes = 0;
+			metric->watch_seq = 0;
 		}
 
 		// 如果metric的refresh与传入的refresh不同，更新metric的nextcheck和refresh
@@ -328,9 +424,112 @@ static void add_check(const char *key, const char *key_orig, int refresh, zbx_ui
 			metric->processed_bytes = 0;
 		}
 
+		schedule_metric(metric);
 		// 结束本次循环
 		goto out;
 	}
+	metric = (ZBX_ACTIVE_METRIC *)zbx_malloc(NULL, sizeof(ZBX_ACTIVE_METRIC));
+
+	/* add new metric */
+	metric->metricid = ++last_metricid;
+	metric->key = zbx_strdup(NULL, key);
+	metric->key_orig = zbx_strdup(NULL, key_orig);
+	metric->refresh = refresh;
+	metric->nextcheck = 0;
+	metric->state = ITEM_STATE_NORMAL;
+	metric->refresh_unsupported = 0;
+	metric->lastlogsize = lastlogsize;
+	metric->mtime = mtime;
+	/* existing log[], log.count[] and eventlog[] data can be skipped */
+	metric->skip_old_data = (0 != metric->lastlogsize ? 0 : 1);
+	metric->big_rec = 0;
+	metric->use_ino = 0;
+	metric->error_count = 0;
+	metric->logfiles_num = 0;
+	metric->logfiles = NULL;
+	metric->flags = ZBX_METRIC_FLAG_NEW;
+
+	if ('l' == metric->key[0] && 'o' == metric->key[1] && 'g' == metric->key[2])
+	{
+		if ('[' == metric->key[3])					/* log[ */
+			metric->flags |= ZBX_METRIC_FLAG_LOG_LOG;
+		else if (0 == strncmp(metric->key + 3, "rt[", 3))		/* logrt[ */
+			metric->flags |= ZBX_METRIC_FLAG_LOG_LOGRT;
+		else if (0 == strncmp(metric->key + 3, ".count[", 7))		/* log.count[ */
+			metric->flags |= ZBX_METRIC_FLAG_LOG_LOG | ZBX_METRIC_FLAG_LOG_COUNT;
+		else if (0 == strncmp(metric->key + 3, "rt.count[", 9))		/* logrt.count[ */
+			metric->flags |= ZBX_METRIC_FLAG_LOG_LOGRT | ZBX_METRIC_FLAG_LOG_COUNT;
+	}
+	else if (0 == strncmp(metric->key, "eventlog[", 9))
+		metric->flags |= ZBX_METRIC_FLAG_LOG_EVENTLOG;
+
+	metric->start_time = 0.0;
+	metric->processed_bytes = 0;
+	metric->watch_seq = 0;
+
+	zbx_vector_ptr_append(&active_metrics, metric);
+	schedule_metric(metric);
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __function_name);
+}
+/******************************************************************************
+ *                                                                            *
+ * Function: mode_parameter_is_skip                                           *
+ *                                                                            *
+ * Purpose: test log[] or log.count[] item key if <mode> parameter is set to  *
+ *          'skip'                                                            *
+ *                                                                            *
+ * Return value: SUCCEED - <mode> parameter is set to 'skip'                  *
+ *               FAIL - <mode> is not 'skip' or error                         *
+ *                                                                            *
+ ******************************************************************************/
+static int	mode_parameter_is_skip(unsigned char flags, const char *itemkey)
+{
+	AGENT_REQUEST	request;
+	const char	*skip;
+	int		ret = FAIL, max_num_parameters;
+
+	if (0 == (ZBX_METRIC_FLAG_LOG_COUNT & flags))	/* log[] */
+		max_num_parameters = 7;
+	else						/* log.count[] */
+		max_num_parameters = 6;
+
+	init_request(&request);
+
+	if (SUCCEED == parse_item_key(itemkey, &request) && 0 < get_rparams_num(&request) &&
+			max_num_parameters >= get_rparams_num(&request) && NULL != (skip = get_rparam(&request, 4)) &&
+			0 == strcmp(skip, "skip"))
+	{
+		ret = SUCCEED;
+	}
+
+	free_request(&request);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: parse_list_of_checks                                             *
+ *                                                                            *
+ * Purpose: Parse list of active checks received from server                  *
+ *                                                                            *
+ * Parameters: str  - NULL terminated string received from server             *
+ *             host - address of host                                         *
+ *             port - port number on host                                     *
+ *                                                                            *
+ * Return value: returns SUCCEED on successful parsing,                       *
+ *               FAIL on an incorrect format of string                        *
+ *                                                                            *
+ * Author: Eugene Grigorjev, Alexei Vladishev (new json protocol)             *
+ *                                                                            *
+ * Comments:                                                                  *
+ *    String represented as "ZBX_EOF" termination list                        *
+ *    With '\n' delimiter between elements.                                   *
+ *    Each element represented as:                                            *
+ *           <key>:<refresh time>:<last log size>:<modification time>         *
+ *                                                                            *
+ ******************************************************************************/
 /******************************************************************************
  * 以下是对这段C语言代码的逐行注释：
  *
@@ -413,165 +612,53 @@ static int parse_list_of_checks(char *str, const char *host, unsigned short port
 	{
 /* {"data":[{"key":"system.cpu.num",...,...},{...},...]}
  *          ^------------------------------^
- */ 		// 解析数据项
-		if (SUCCEED != zbx_json_brackets_open(p, &jp_row))
-		{
+ */ 		if (SUCCEED != zbx_json_brackets_open(p, &jp_row))
 			// 如果解析失败，记录日志并退出
-			zabbix_log(LOG_LEVEL_ERR, "cannot parse list of active checks: %s", zbx_json_strerror());
-			goto out;
-		}
 
 		// 获取数据项的名称
-		if (SUCCEED != zbx_json_value_by_name(&jp_row, ZBX_PROTO_TAG_KEY, name, sizeof(name), NULL) ||
-				'\0' == *name)
-		{
 			// 如果解析失败，记录日志并退出
-			zabbix_log(LOG_LEVEL_WARNING, "cannot retrieve value of tag \"%s\"", ZBX_PROTO_TAG_KEY);
-			continue;
-		}
 
 		// 获取数据项的原始名称
-		if (SUCCEED != zbx_json_value_by_name(&jp_row, ZBX_PROTO_TAG_KEY_ORIG, key_orig, sizeof(key_orig), NULL)
-				|| '\0' == *key_orig)
-		{
 			// 如果解析失败，记录日志并退出
-			zbx_strlcpy(key_orig, name, sizeof(key_orig));
-		}
 
 		// 获取数据项的延迟
-		if (SUCCEED != zbx_json_value_by_name(&jp_row, ZBX_PROTO_TAG_DELAY, tmp, sizeof(tmp), NULL) ||
-				'\0' == *tmp)
-		{
 			// 如果解析失败，记录日志并退出
-			zabbix_log(LOG_LEVEL_WARNING, "cannot retrieve value of tag \"%s\"", ZBX_PROTO_TAG_DELAY);
-			continue;
-		}
 
-		delay = atoi(tmp);
 
 		// 获取数据项的最后日志大小
-		if (SUCCEED != zbx_json_value_by_name(&jp_row, ZBX_PROTO_TAG_LASTLOGSIZE, tmp, sizeof(tmp), NULL) ||
-				SUCCEED != is_uint64(tmp, &lastlogsize))
-		{
 			// 如果解析失败，记录日志并退出
-			zabbix_log(LOG_LEVEL_WARNING, "cannot retrieve value of tag \"%s\"", ZBX_PROTO_TAG_LASTLOGSIZE);
-			continue;
-		}
 
 		// 获取数据项的记录时间
-		if (SUCCEED != zbx_json_value_by_name(&jp_row, ZBX_PROTO_TAG_MTIME, tmp, sizeof(tmp), NULL) ||
-				'\0' == *tmp)
-		{
 			// 如果解析失败，记录日志并退出
-			zabbix_log(LOG_LEVEL_WARNING, "cannot retrieve value of tag \"%s\"", ZBX_PROTO_TAG_MTIME);
-			mtime = 0;
-		}
-		else
-			mtime = atoi(tmp);
 
 		// 将数据项添加到活跃检查列表中
-		add_check(zbx_alias_get(name), key_orig, delay, lastlogsize, mtime);
 
 		/* 记录已接收到的数据项 */
-		zbx_vector_str_append(&received_metrics, zbx_strdup(NULL, key_orig));
-	}
 
 	/* 删除未接收到的数据项 */
-	for (i = 0; i < active_metrics.values_num; i++)
-	{
-		int	found = 0;
 
-		metric = (ZBX_ACTIVE_METRIC *)active_metrics.values[i];
 
 		/* 'Do-not-delete' exception for log[] and log.count[] items with <mode> parameter set to 'skip'. */
 		/* 我们需要保持它们的 state，即 skip_old_data，以防检查项变为 NOTSUPPORTED。 */
 
-		if (0 != (ZBX_METRIC_FLAG_LOG_LOG & metric->flags) && ITEM_STATE_NOTSUPPORTED == metric->state &&
-				0 == metric->skip_old_data && SUCCEED == mode_parameter_is_skip(metric->flags,
-				metric->key))
-		{
-			continue;
-		}
 
-		for (j = 0; j < received_metrics.values_num; j++)
-		{
-			if (0 == strcmp(metric->key_orig, received_metrics.values[j]))
-			{
-				found = 1;
-				break;
-			}
-		}
 
-		if (0 == found)
-		{
-			zbx_vector_ptr_remove_noorder(&active_metrics, i);
-			free_active_metric(metric);
-			i--;	/* consider the same index on the next run */
-		}
-	}
 
-	zbx_regexp_clean_expressions(&regexps);
 
-	if (SUCCEED == zbx_json_brackets_by_name(&jp, ZBX_PROTO_TAG_REGEXP, &jp_data))
-	{
- 		p = NULL;
-		while (NULL != (p = zbx_json_next(&jp_data, p)))
-		{
 /* {"regexp":[{"name":"regexp1",...,...},{...},...]}
  *            ^------------------------^
  */
-			if (SUCCEED != zbx_json_value_by_name(&jp_row, "name", name, sizeof(name), NULL))
-			{
-				zabbix_log(LOG_LEVEL_WARNING, "cannot retrieve value of tag \"%s\"", "name");
-				continue;
-			}
 
-			if (SUCCEED != zbx_json_value_by_name(&jp_row, "expression", expression, sizeof(expression), NULL) ||
-					'\0' == *expression)
-			{
-				zabbix_log(LOG_LEVEL_WARNING, "cannot retrieve value of tag \"%s\"", "expression");
-				continue;
-			}
 
-			if (SUCCEED != zbx_json_value_by_name(&jp_row, "expression_type", tmp, sizeof(tmp), NULL) ||
-					'\0' == *tmp)
-			{
-				zabbix_log(LOG_LEVEL_WARNING, "cannot retrieve value of tag \"%s\"", "expression_type");
-				continue;
-			}
 
-			expression_type = atoi(tmp);
 
-			if (SUCCEED != zbx_json_value_by_name(&jp_row, "exp_delimiter", tmp, sizeof(tmp), NULL))
-			{
-				zabbix_log(LOG_LEVEL_WARNING, "cannot retrieve value of tag \"%s\"", "exp_delimiter");
-				continue;
-			}
 
-			exp_delimiter = tmp[0];
 
-			if (SUCCEED != zbx_json_value_by_name(&jp_row, "case_sensitive", tmp,
-					sizeof(tmp), NULL) || '\0' == *tmp)
-			{
-				zabbix_log(LOG_LEVEL_WARNING, "cannot retrieve value of tag \"%s\"", "case_sensitive");
-				continue;
-			}
 
-			case_sensitive = atoi(tmp);
 
-			add_regexp_ex(&regexps, name, expression, expression_type, exp_delimiter, case_sensitive);
-		}
-	}
 
-	ret = SUCCEED;
-out:
-	zbx_vector_str_clear_ext(&received_metrics, zbx_str_free);
-	zbx_vector_str_destroy(&received_metrics);
 
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
 
-	return ret;
-}
 
 		{
 			zabbix_log(LOG_LEVEL_ERR, "cannot parse list of active checks: %s", zbx_json_strerror());
@@ -650,6 +737,8 @@ out:
 
 		if (0 == found)
 		{
+			if (SUCCEED == metric_ready_to_process(metric))
+				zbx_binary_heap_remove_direct(&active_schedule, metric->metricid);
 			zbx_vector_ptr_remove_noorder(&active_metrics, i);
 			free_active_metric(metric);
 			i--;	/* consider the same index on the next run */
@@ -699,6 +788,30 @@ out:
 				continue;
 			}
 
+			exp_delimiter = tmp[0];
+
+			if (SUCCEED != zbx_json_value_by_name(&jp_row, "case_sensitive", tmp,
+					sizeof(tmp), NULL) || '\0' == *tmp)
+			{
+				zabbix_log(LOG_LEVEL_WARNING, "cannot retrieve value of tag \"%s\"", "case_sensitive");
+				continue;
+			}
+
+			case_sensitive = atoi(tmp);
+
+			add_regexp_ex(&regexps, name, expression, expression_type, exp_delimiter, case_sensitive);
+		}
+	}
+
+	ret = SUCCEED;
+out:
+	zbx_vector_str_clear_ext(&received_metrics, zbx_str_free);
+	zbx_vector_str_destroy(&received_metrics);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
+
+	return ret;
+}
 /******************************************************************************
  * 以下是对代码块的详细中文注释：
  *
@@ -743,6 +856,7 @@ static int	refresh_active_checks(const char *host, unsigned short port)
 	}
 	else if (NULL != CONFIG_HOST_METADATA_ITEM)
 	{
+		char		**value;
 		// 初始化结果结构体
 		AGENT_RESULT	result;
 		init_result(&result);
@@ -825,53 +939,24 @@ static int	refresh_active_checks(const char *host, unsigned short port)
 			THIS_SHOULD_NEVER_HAPPEN;
 			ret = FAIL;
 			goto out;
-	}
 
 	// 使用zbx_tcp_connect()函数连接服务器，并传递参数
-	if (SUCCEED == (ret = zbx_tcp_connect(&s, CONFIG_SOURCE_IP, host, port, CONFIG_TIMEOUT,
-			configured_tls_connect_mode, tls_arg1, tls_arg2)))
-	{
 		// 发送JSON数据到服务器
-		zabbix_log(LOG_LEVEL_DEBUG, "sending [%s]", json.buffer);
 
 		// 接收服务器响应
-		if (SUCCEED == (ret = zbx_tcp_recv(&s)))
-		{
 			// 处理服务器响应，并更新上次操作成功状态
-			zabbix_log(LOG_LEVEL_DEBUG, "got [%s]", s.buffer);
 
-			if (SUCCEED != last_ret)
-			{
 				// 如果上次操作失败，则记录日志并更新上次操作成功状态
-				zabbix_log(LOG_LEVEL_WARNING, "active check configuration update from [%s:%hu]"
-						" is working again", host, port);
-			}
-			parse_list_of_checks(s.buffer, host, port);
-		}
 
 		// 关闭套接字
-		zbx_tcp_close(&s);
-	}
 
-out:
 	// 如果本次操作失败且上次操作成功，则记录日志
-	if (SUCCEED != ret && SUCCEED == last_ret)
-	{
-		zabbix_log(LOG_LEVEL_WARNING,
-				"active check configuration update from [%s:%hu] started to fail (%s)",
-				host, port, zbx_socket_strerror());
-	}
 
 	// 记录日志，表示函数执行完毕
-	last_ret = ret;
 
 	// 释放json结构体
-	zbx_json_free(&json);
 
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
 
-	return ret;
-}
 
 	}
 
@@ -936,30 +1021,64 @@ out:
  * *
  *这块代码的主要目的是对一个字符串（响应）进行JSON解析，并根据解析结果判断操作是否成功，同时获取响应中的值和信息。最后将解析结果记录到日志中，并返回解析结果。
  ******************************************************************************/
-// 定义一个静态函数check_response，接收一个字符指针作为参数
-static int check_response(char *response)
+static int	check_response(char *response)
+{
+	const char		*__function_name = "check_response";
+
+	struct zbx_json_parse	jp;
+	char			value[MAX_STRING_LEN];
+	char			info[MAX_STRING_LEN];
+	int			ret;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() response:'%s'", __function_name, response);
+
+	ret = zbx_json_open(response, &jp);
+
+	if (SUCCEED == ret)
+		ret = zbx_json_value_by_name(&jp, ZBX_PROTO_TAG_RESPONSE, value, sizeof(value), NULL);
+
+	if (SUCCEED == ret && 0 != strcmp(value, ZBX_PROTO_VALUE_SUCCESS))
+		ret = FAIL;
+
+	if (SUCCEED == ret && SUCCEED == zbx_json_value_by_name(&jp, ZBX_PROTO_TAG_INFO, info, sizeof(info), NULL))
+		zabbix_log(LOG_LEVEL_DEBUG, "info from server: '%s'", info);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
+
+	return ret;
+}
+/******************************************************************************
+ * *
+ * Function: free_buffer_elements                                             *
+ *                                                                            *
+ * Purpose: frees resources allocated by buffer elements                      *
+ *                                                                            *
+ ******************************************************************************/
+static void	free_buffer_elements(ZBX_ACTIVE_BUFFER_ELEMENT *elements, int num)
 {
+	int	i;
+// 定义一个静态函数check_response，接收一个字符指针作为参数
     // 定义一个常量字符串，表示函数名
-    const char *__function_name = "check_response";
 
+	for (i = 0; i < num; i++)
+	{
+		zbx_free(elements[i].host);
+		zbx_free(elements[i].key);
+		zbx_free(elements[i].value);
+		zbx_free(elements[i].source);
+	}
+}
     // 定义一个结构体，用于存储JSON解析的信息
-    struct zbx_json_parse jp;
 
     // 定义两个字符数组，用于存储值和信息
-    char value[MAX_STRING_LEN];
-    char info[MAX_STRING_LEN];
 
     // 定义一个整型变量，用于存储返回值
-    int ret;
 
     // 记录日志，表示函数开始执行，传入函数名和响应字符串
-    zabbix_log(LOG_LEVEL_DEBUG, "In %s() response:'%s'", __function_name, response);
 
     // 调用zbx_json_open函数，对响应字符串进行JSON解析，并将结果存储在结构体jp中
-    ret = zbx_json_open(response, &jp);
 
     // 判断解析是否成功，如果成功，继续执行后续操作
-    if (SUCCEED == ret)
 /******************************************************************************
  * *
  *这个代码块的主要目的是实现一个名为`send_buffer`的函数，该函数用于将缓冲区中的数据发送到服务器。函数接收两个参数：`host`和`port`，分别表示服务器的IP地址和端口。
@@ -968,12 +1087,61 @@ static int check_response(char *response)
  *
  *在整个过程中，代码注重了日志记录，使用了多个注释来说明代码的功能和注意事项。这块代码的主要目的是确保数据能够正确地从缓冲区发送到服务器，并在出现问题时提供诊断信息。
  ******************************************************************************/
-static int send_buffer(const char *host, unsigned short port)
+static void	clear_buffer(int now)
 {
 	// 定义常量、变量和函数
-	const char *__function_name = "send_buffer";
-	ZBX_ACTIVE_BUFFER_ELEMENT *el;
-	int				ret = SUCCEED, i, now;
+	free_buffer_elements(buffer.data, buffer.count);
+	buffer.count = 0;
+	buffer.pcount = 0;
+	buffer.lastsent = now;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: buffer_send_is_due                                               *
+ *                                                                            *
+ * Purpose: checks if the buffer must be sent now                             *
+ *                                                                            *
+ * Return value: SUCCEED - the buffer is full or BufferSend seconds passed    *
+ *               FAIL    - the buffer can wait                                *
+ *                                                                            *
+ ******************************************************************************/
+static int	buffer_send_is_due(int now)
+{
+	if (CONFIG_BUFFER_SIZE / 2 > buffer.pcount && CONFIG_BUFFER_SIZE > buffer.count &&
+			CONFIG_BUFFER_SEND > now - buffer.lastsent)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "buffer now:%d lastsent:%d now-lastsent:%d BufferSend:%d;"
+				" will not send now", now, buffer.lastsent, now - buffer.lastsent, CONFIG_BUFFER_SEND);
+		return FAIL;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: send_values                                                      *
+ *                                                                            *
+ * Purpose: send values to Zabbix server                                      *
+ *                                                                            *
+ * Parameters: host     - IP or Hostname of Zabbix server                     *
+ *             port     - port number                                         *
+ *             elements - the values                                          *
+ *             num      - the number of values                                *
+ *             now      - the current time                                    *
+ *             flags    - the protocol flags                                  *
+ *                                                                            *
+ * Return value: returns SUCCEED on successful sending,                       *
+ *               FAIL on other cases                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	send_values(const char *host, unsigned short port, const ZBX_ACTIVE_BUFFER_ELEMENT *elements, int num,
+		int now, unsigned char flags)
+{
+	const char			*__function_name = "send_values";
+	const ZBX_ACTIVE_BUFFER_ELEMENT	*el;
+	int				ret = SUCCEED, i;
 	char				*tls_arg1, *tls_arg2;
 	zbx_timespec_t			ts;
 	const char			*err_send_step = "";
@@ -981,24 +1149,13 @@ static int send_buffer(const char *host, unsigned short port)
 	struct zbx_json 		json;
 
 	// 打印日志
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s() host:'%s' port:%d entries:%d/%d",
-			__function_name, host, port, buffer.count, CONFIG_BUFFER_SIZE);
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() host:'%s' port:%d values:%d", __function_name, host, port, num);
 
 	// 判断缓冲区是否为空，若为空则直接返回
-	if (0 == buffer.count)
-		goto ret;
 
 	// 获取当前时间
-	now = (int)time(NULL);
 
 	// 判断是否需要发送数据
-	if (CONFIG_BUFFER_SIZE / 2 > buffer.pcount && CONFIG_BUFFER_SIZE > buffer.count &&
-			CONFIG_BUFFER_SEND > now - buffer.lastsent)
-	{
-		zabbix_log(LOG_LEVEL_DEBUG, "%s() now:%d lastsent:%d now-lastsent:%d BufferSend:%d; will not send now",
-				__function_name, now, buffer.lastsent, now - buffer.lastsent, CONFIG_BUFFER_SEND);
-		goto ret;
-	}
 
 	// 初始化JSON对象
 	zbx_json_init(&json, ZBX_JSON_STAT_BUF_LEN);
@@ -1007,9 +1164,9 @@ static int send_buffer(const char *host, unsigned short port)
 	zbx_json_addarray(&json, ZBX_PROTO_TAG_DATA);
 
 	// 遍历缓冲区数据并添加到JSON对象中
-	for (i = 0; i < buffer.count; i++)
+	for (i = 0; i < num; i++)
 	{
-		el = &buffer.data[i];
+		el = &elements[i];
 
 		// 添加主机、键、值等信息
 		zbx_json_addobject(&json, NULL);
@@ -1086,14 +1243,17 @@ static int send_buffer(const char *host, unsigned short port)
 	}
 
 	// 连接服务器
-	if (SUCCEED == (ret = zbx_tcp_connect(&s, CONFIG_SOURCE_IP, host, port, MIN(buffer.count * CONFIG_TIMEOUT, 60),
+	if (SUCCEED == (ret = zbx_tcp_connect(&s, CONFIG_SOURCE_IP, host, port, MIN(num * CONFIG_TIMEOUT, 60),
 			configured_tls_connect_mode, tls_arg1, tls_arg2)))
 	{
+		zbx_timespec(&ts);
+		zbx_json_adduint64(&json, ZBX_PROTO_TAG_CLOCK, ts.sec);
+		zbx_json_adduint64(&json, ZBX_PROTO_TAG_NS, ts.ns);
 		// 发送数据
 		zabbix_log(LOG_LEVEL_DEBUG, "JSON before sending [%s]", json.buffer);
 
 		// 检查响应
-		if (SUCCEED == (ret = zbx_tcp_send(&s, json.buffer)))
+		if (SUCCEED == (ret = zbx_tcp_send_ext(&s, json.buffer, strlen(json.buffer), flags, 0)))
 		{
 			// 接收响应
 			if (SUCCEED == (ret = zbx_tcp_recv(&s)))
@@ -1116,52 +1276,198 @@ static int send_buffer(const char *host, unsigned short port)
 		else
 			err_send_step = "[send] ";
 
-		// 关闭连接
-		zbx_tcp_close(&s);
+		// 关闭连接
+		zbx_tcp_close(&s);
+	}
+	else
+		err_send_step = "[connect] ";
+
+	// 输出结果
+out:
+
+
+	zbx_json_free(&json);
+
+	if (SUCCEED == ret)
+	{
+		/* free buffer */
+
+		if (0 != buffer.first_error)
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "active check data upload to [%s:%hu] is working again",
+					host, port);
+			buffer.first_error = 0;
+		}
+	}
+	else
+	{
+		if (0 == buffer.first_error)
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "active check data upload to [%s:%hu] started to fail (%s%s)",
+					host, port, err_send_step, zbx_socket_strerror());
+			buffer.first_error = now;
+		}
+		zabbix_log(LOG_LEVEL_DEBUG, "send value error: %s%s", err_send_step, zbx_socket_strerror());
+	}
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
+
+	return ret;
+}
+
+#if !defined(_WINDOWS)
+/******************************************************************************
+ *                                                                            *
+ * Function: open_spool                                                       *
+ *                                                                            *
+ * Purpose: opens buffer file of the active checks process                    *
+ *                                                                            *
+ * Comments: Each active checks process uses its own file, the process number *
+ *           is appended to BufferFile when there are several processes.      *
+ *                                                                            *
+ ******************************************************************************/
+static void	open_spool(void)
+{
+	char	*path, *error = NULL;
+
+	if (1 < CONFIG_ACTIVE_FORKS)
+		path = zbx_dsprintf(NULL, "%s.%d", CONFIG_BUFFER_FILE, process_num);
+	else
+		path = zbx_strdup(NULL, CONFIG_BUFFER_FILE);
+
+	if (SUCCEED != zbx_active_spool_open(&spool, path, CONFIG_BUFFER_FILE_SIZE, &error))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot use active check buffer file \"%s\": %s", path, error);
+		zbx_free(error);
+	}
+	else
+	{
+		/* the value identifiers must keep growing for the values sent in the new session */
+		if (spool.last_id > last_valueid)
+			last_valueid = spool.last_id;
+
+		if (0 != spool.values_num)
+		{
+			zabbix_log(LOG_LEVEL_INFORMATION, "active check buffer file \"%s\" contains %d values to send",
+					path, spool.values_num);
+		}
+	}
+
+	zbx_free(path);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: send_spool                                                       *
+ *                                                                            *
+ * Purpose: send values stored in buffer file to Zabbix server                *
+ *                                                                            *
+ * Parameters: host - IP or Hostname of Zabbix server                         *
+ *             port - port number                                             *
+ *             now  - the current time                                        *
+ *                                                                            *
+ * Return value: returns SUCCEED on successful sending,                       *
+ *               FAIL on other cases                                          *
+ *                                                                            *
+ * Comments: While buffer file is not empty the values in memory are appended *
+ *           to it instead of being sent directly to keep the value order.    *
+ *                                                                            *
+ ******************************************************************************/
+static int	send_spool(const char *host, unsigned short port, int now)
+{
+	ZBX_ACTIVE_BUFFER_ELEMENT	*elements;
+	zbx_uint64_t			next;
+	int				ret = SUCCEED, num, batches;
+	unsigned char			flags = ZBX_TCP_PROTOCOL;
+
+	if (0 != buffer.count && SUCCEED == buffer_send_is_due(now))
+	{
+		if (SUCCEED == zbx_active_spool_write(&spool, buffer.data, buffer.count))
+			clear_buffer(now);
+		else
+			zabbix_log(LOG_LEVEL_DEBUG, "buffer file is full, cannot store %d values", buffer.count);
+	}
+
+	/* do not retry on every new value while the upload is failing */
+	if (0 != buffer.first_error && CONFIG_BUFFER_SEND > now - spool_lastsent)
+		return FAIL;
+
+#if defined(HAVE_ZLIB)
+	flags |= ZBX_TCP_COMPRESS;
+#endif
+	elements = (ZBX_ACTIVE_BUFFER_ELEMENT *)zbx_malloc(NULL, sizeof(ZBX_ACTIVE_BUFFER_ELEMENT) *
+			ZBX_SPOOL_BATCH_SIZE);
+
+	for (batches = 0; batches < ZBX_SPOOL_BATCHES_MAX && 0 != spool.values_num; batches++)
+	{
+		if (0 == (num = zbx_active_spool_read(&spool, elements, ZBX_SPOOL_BATCH_SIZE, &next)))
+			break;
+
+		ret = send_values(host, port, elements, num, now, flags);
+		free_buffer_elements(elements, num);
+
+		if (SUCCEED != ret)
+			break;
+
+		zbx_active_spool_remove(&spool, next, num);
 	}
-	else
-		err_send_step = "[connect] ";
 
-	// 输出结果
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
+	zbx_free(elements);
+	spool_lastsent = now;
 
 	return ret;
 }
+#endif
 
-	zbx_json_free(&json);
+/******************************************************************************
+ *                                                                            *
+ * Function: send_buffer                                                      *
+ *                                                                            *
+ * Purpose: Send value stored in the buffer to Zabbix server                  *
+ *                                                                            *
+ * Parameters: host - IP or Hostname of Zabbix server                         *
+ *             port - port number                                             *
+ *                                                                            *
+ * Return value: returns SUCCEED on successful sending,                       *
+ *               FAIL on other cases                                          *
+ *                                                                            *
+ * Author: Alexei Vladishev                                                   *
+ *                                                                            *
+ * Comments: If the values cannot be sent and BufferFile is configured, they  *
+ *           are moved to buffer file and sent from there later.              *
+ *                                                                            *
+ ******************************************************************************/
+static int	send_buffer(const char *host, unsigned short port)
+{
+	const char	*__function_name = "send_buffer";
+	int		ret = SUCCEED, now;
 
-	if (SUCCEED == ret)
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() host:'%s' port:%d entries:%d/%d",
+			__function_name, host, port, buffer.count, CONFIG_BUFFER_SIZE);
+
+	now = (int)time(NULL);
+
+#if !defined(_WINDOWS)
+	if (NULL != spool.path && 0 != spool.values_num)
 	{
-		/* free buffer */
-		for (i = 0; i < buffer.count; i++)
-		{
-			el = &buffer.data[i];
+		ret = send_spool(host, port, now);
+		goto ret;
+	}
+#endif
+	if (0 == buffer.count || SUCCEED != buffer_send_is_due(now))
+		goto ret;
 
-			zbx_free(el->host);
-			zbx_free(el->key);
-			zbx_free(el->value);
-			zbx_free(el->source);
-		}
-		buffer.count = 0;
-		buffer.pcount = 0;
-		buffer.lastsent = now;
-		if (0 != buffer.first_error)
-		{
-			zabbix_log(LOG_LEVEL_WARNING, "active check data upload to [%s:%hu] is working again",
-					host, port);
-			buffer.first_error = 0;
-		}
+	if (SUCCEED == (ret = send_values(host, port, buffer.data, buffer.count, now, ZBX_TCP_PROTOCOL)))
+	{
+		clear_buffer(now);
 	}
-	else
+#if !defined(_WINDOWS)
+	else if (NULL != spool.path && SUCCEED == zbx_active_spool_write(&spool, buffer.data, buffer.count))
 	{
-		if (0 == buffer.first_error)
-		{
-			zabbix_log(LOG_LEVEL_WARNING, "active check data upload to [%s:%hu] started to fail (%s%s)",
-					host, port, err_send_step, zbx_socket_strerror());
-			buffer.first_error = now;
-		}
-		zabbix_log(LOG_LEVEL_DEBUG, "send value error: %s%s", err_send_step, zbx_socket_strerror());
+		zabbix_log(LOG_LEVEL_DEBUG, "%s() stored %d values in buffer file", __function_name, buffer.count);
+		clear_buffer(now);
+		spool_lastsent = now;
 	}
+#endif
 ret:
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
 
@@ -1241,6 +1547,8 @@ static int	process_value(const char *server, unsigned short port, const char *ho
 	}
 	else
 	{
+		if (0 == (ZBX_METRIC_FLAG_PERSISTENT & flags))
+		{
 		/* 遍历缓冲区，查找相同主机和键的元素 */
 		for (i = 0; i < buffer.count; i++)
 		{
@@ -1277,6 +1585,7 @@ static int	process_value(const char *server, unsigned short port, const char *ho
 	zabbix_log(LOG_LEVEL_DEBUG, "buffer full: new element %d", buffer.count - 1);
 
 	el = &buffer.data[CONFIG_BUFFER_SIZE - 1];
+	}
 
 	/* 初始化新元素 */
 	memset(el, 0, sizeof(ZBX_ACTIVE_BUFFER_ELEMENT));
@@ -1288,33 +1597,12 @@ static int	process_value(const char *server, unsigned short port, const char *ho
 
 	/* 赋值给源代码、严重性、时间戳等字段 */
 	if (NULL != source)
-		el->source = strdup(source);
-	if (NULL != severity)
-		el->severity = *severity;
-	if (NULL != lastlogsize)
-		el->lastlogsize = *lastlogsize;
-	if (NULL != mtime)
-		el->mtime = *mtime;
-	if (NULL != timestamp)
-		el->timestamp = *timestamp;
-	if (NULL != logeventid)
-		el->logeventid = (int)*logeventid;
 
 	/* 记录时间戳 */
-	zbx_timespec(&el->ts);
-	el->flags = flags;
-	el->id = ++last_valueid;
 
 	/* 如果数据具有持久性，则增加缓冲区中的持久性计数 */
-	if (0 != (ZBX_METRIC_FLAG_PERSISTENT & flags))
-		buffer.pcount++;
 
-	ret = SUCCEED;
-out:
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
 
-	return ret;
-}
 
 		el->source = strdup(source);
 	if (NULL != severity)
@@ -1401,24 +1689,28 @@ static int	check_number_of_parameters(unsigned char flags, const AGENT_REQUEST *
  *整个代码块的主要目的是初始化每秒最大日志行数。根据请求中的参数，判断是否计算日志行数，并设置最大日志行数。如果请求参数中的每秒日志行数不合法，则复制一条错误信息到error指向的内存区域，并返回执行失败。否则，将合法的每秒日志行数设置为最大日志行数，并返回执行成功。
  ******************************************************************************/
 /* 定义一个函数，用于初始化每秒最大日志行数，参数包括：是否计算日志行数，请求指针，最大日志行数指针，错误信息指针 */
-static int	init_max_lines_per_sec(int is_count_item, const AGENT_REQUEST *request, int *max_lines_per_sec,
-                char **error)
+    if (0 == (parameter_num = get_rparams_num(request)))
 {
 	/* 定义一个指向请求参数的指针 */
-	const char	*p;
+		*error = zbx_strdup(*error, "Invalid number of parameters.");
+		return FAIL;
+	}
 	/* 定义一个整型变量，用于存储每秒日志行数 */
-	int		rate;
 
 	/* 检查请求参数中是否有第三个参数（即每秒日志行数），如果没有或为空，则执行以下操作：
 	 * 如果is_count_item为0，表示不计算日志行数，直接使用配置文件中定义的每秒最大日志行数
 	 * 否则，使用log_lines_multiplier（暂未定义）与配置文件中定义的每秒最大日志行数的乘积作为最大日志行数
 	 */
-	if (NULL == (p = get_rparam(request, 3)) || '\0' == *p)
+	if (0 != (ZBX_METRIC_FLAG_LOG_COUNT & flags))
+		max_parameter_num = 7;	/* log.count or logrt.count */
+	else
+		max_parameter_num = 8;	/* log or logrt */
+
+	if (max_parameter_num < parameter_num)
 	{
-		if (0 == is_count_item)				/* log[], logrt[] */
-			*max_lines_per_sec = CONFIG_MAX_LINES_PER_SECOND;
-		else							/* log.count[], logrt.count[] */
-			*max_lines_per_sec = MAX_VALUE_LINES_MULTIPLIER * CONFIG_MAX_LINES_PER_SECOND;
+		*error = zbx_strdup(*error, "Too many parameters.");
+		return FAIL;
+	}
 
 		/* 函数执行成功，返回0 */
 		return SUCCEED;
@@ -1428,20 +1720,11 @@ static int	init_max_lines_per_sec(int is_count_item, const AGENT_REQUEST *reques
 	 * 如果is_count_item为0，检查值是否在MIN_VALUE_LINES和MAX_VALUE_LINES之间
 	 * 否则，检查值是否在MIN_VALUE_LINES和MAX_VALUE_LINES_MULTIPLIER * MAX_VALUE_LINES之间
 	 */
-	if (MIN_VALUE_LINES > (rate = atoi(p)) ||
-			(0 == is_count_item && MAX_VALUE_LINES < rate) ||
-			(0 != is_count_item && MAX_VALUE_LINES_MULTIPLIER * MAX_VALUE_LINES < rate))
-	{
+static int	init_max_lines_per_sec(int is_count_item, const AGENT_REQUEST *request, int *max_lines_per_sec,
 		/* 如果值不合法，则复制一条错误信息到error指向的内存区域，并返回FAIL表示执行失败 */
-		*error = zbx_strdup(*error, "Invalid fourth parameter.");
-		return FAIL;
-	}
 
 	/* 如果值合法，将其作为最大日志行数 */
-	*max_lines_per_sec = rate;
 	/* 函数执行成功，返回0 */
-	return SUCCEED;
-}
 
 		char **error)
 {
@@ -1457,6 +1740,17 @@ static int	init_max_lines_per_sec(int is_count_item, const AGENT_REQUEST *reques
 
 		return SUCCEED;
 	}
+	if (MIN_VALUE_LINES > (rate = atoi(p)) ||
+			(0 == is_count_item && MAX_VALUE_LINES < rate) ||
+			(0 != is_count_item && MAX_VALUE_LINES_MULTIPLIER * MAX_VALUE_LINES < rate))
+	{
+		*error = zbx_strdup(*error, "Invalid fourth parameter.");
+		return FAIL;
+	}
+
+	*max_lines_per_sec = rate;
+	return SUCCEED;
+}
 /******************************************************************************
  * 
  ******************************************************************************/
@@ -1503,7 +1797,59 @@ static int	init_max_delay(int is_count_item, const AGENT_REQUEST *request, float
 
 	/* 将临时最大延迟值转换为 float 类型，并存储到 max_delay 指向的内存位置 */
 	*max_delay = (float)max_delay_tmp;
+	return SUCCEED;
+}
+
+static int	init_rotation_type(unsigned char flags, const AGENT_REQUEST *request,
+		zbx_log_rotation_options_t *rotation_type, char **error)
+{
+	char	*options;
+	int	options_par_nr;
+
+	if (0 == (ZBX_METRIC_FLAG_LOG_COUNT & flags))	/* log, logrt */
+		options_par_nr = 7;
+	else						/* log.count, logrt.count */
+		options_par_nr = 6;
 
+	options = get_rparam(request, options_par_nr);
+
+	if (NULL == options || '\0' == *options)	/* default options */
+	{
+		if (0 != (ZBX_METRIC_FLAG_LOG_LOGRT & flags))
+			*rotation_type = ZBX_LOG_ROTATION_LOGRT;
+		else
+			*rotation_type = ZBX_LOG_ROTATION_REREAD;
+	}
+	else
+	{
+		if (0 != (ZBX_METRIC_FLAG_LOG_LOGRT & flags))	/* logrt, logrt.count */
+		{
+			if (0 == strcmp(options, "copytruncate"))
+				*rotation_type = ZBX_LOG_ROTATION_LOGCPT;
+			else if (0 == strcmp(options, "rotate") || 0 == strcmp(options, "mtime-reread"))
+				*rotation_type = ZBX_LOG_ROTATION_LOGRT;
+			else if (0 == strcmp(options, "mtime-noreread"))
+				*rotation_type = ZBX_LOG_ROTATION_NO_REREAD;
+			else
+				goto err;
+		}
+		else	/* log, log.count */
+		{
+			if (0 == strcmp(options, "mtime-reread"))
+				*rotation_type = ZBX_LOG_ROTATION_REREAD;
+			else if (0 == strcmp(options, "mtime-noreread"))
+				*rotation_type = ZBX_LOG_ROTATION_NO_REREAD;
+			else
+				goto err;
+		}
+	}
+
+	return SUCCEED;
+err:
+	*error = zbx_strdup(*error, "Invalid parameter \"options\".");
+
+	return FAIL;
+}
 /******************************************************************************
  * 以下是对这段C语言代码的逐行注释：
  *
@@ -1667,68 +2013,29 @@ static int	process_log_check(char *server, unsigned short port, ZBX_ACTIVE_METRI
 			&metric->logfiles_num, &logfiles_new, &logfiles_num_new, encoding, &regexps, regexp,
 			output_template, &p_count, &s_count, process_value, server, port, CONFIG_HOSTNAME,
 			metric->key_orig, &jumped, max_delay, &metric->start_time, &metric->processed_bytes,
-			rotation_type);
+			rotation_type, &metric->watch_seq);
 
 	if (0 == is_count_item && NULL != logfiles_new)
 	{
 		/* for log[] and logrt[] items - switch to the new log file list */
 
-		destroy_logfile_list(&metric->logfiles, NULL, &metric->logfiles_num);
-		metric->logfiles = logfiles_new;
-		metric->logfiles_num = logfiles_num_new;
-	}
 
-	if (SUCCEED == ret)
-	{
-		metric->error_count = 0;
 
-		if (0 != is_count_item)
-		{
 			/* send log.count[] or logrt.count[] item value to server */
 
-			int	match_count;			/* number of matching lines */
-			char	buf[ZBX_MAX_UINT64_LEN];
 
-			match_count = s_count_orig - s_count;
 
-			zbx_snprintf(buf, sizeof(buf), "%d", match_count);
 
-			if (SUCCEED == process_value(server, port, CONFIG_HOSTNAME, metric->key_orig, buf,
-					ITEM_STATE_NORMAL, &metric->lastlogsize, &metric->mtime, NULL, NULL, NULL, NULL,
-					metric->flags | ZBX_METRIC_FLAG_PERSISTENT) || 0 != jumped)
-			{
 				/* if process_value() fails (i.e. log(rt).count result cannot be sent to server) but */
 				/* a jump took place to meet <maxdelay> then we discard the result and keep the state */
 				/* during the next check */
 
-				*lastlogsize_sent = metric->lastlogsize;
-				*mtime_sent = metric->mtime;
 
 				/* switch to the new log file list */
-				destroy_logfile_list(&metric->logfiles, NULL, &metric->logfiles_num);
-				metric->logfiles = logfiles_new;
-				metric->logfiles_num = logfiles_num_new;
-		}
-	}
-	else
-	{
-		metric->error_count++;
 
-		if (3 > metric->error_count)
-		{
-			zabbix_log(LOG_LEVEL_DEBUG, "suppressing log(rt)(.count) processing error #%d: %s",
-					metric->error_count, NULL != *error ? *error : "unknown error");
 
-			zbx_free(*error);
-			ret = SUCCEED;
-		}
-	}
 
-	zbx_free(encoding_uc);
-	free_request(&request);
 
-	return ret;
-}
 
 		/* for log[] and logrt[] items - switch to the new log file list */
 
@@ -1989,6 +2296,23 @@ static int	process_common_check(char *server, unsigned short port, ZBX_ACTIVE_ME
 	// 调用 process 函数处理 metric 结构体中的 key，若处理失败，则返回 NOT_SUCCEED 状态。
 	if (SUCCEED != (ret = process(metric->key, 0, &result)))
 	{
+		if (NULL != (pvalue = GET_MSG_RESULT(&result)))
+			*error = zbx_strdup(*error, *pvalue);
+		goto out;
+	}
+
+	if (NULL != (pvalue = GET_TEXT_RESULT(&result)))
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "for key [%s] received value [%s]", metric->key, *pvalue);
+
+		process_value(server, port, CONFIG_HOSTNAME, metric->key_orig, *pvalue, ITEM_STATE_NORMAL, NULL, NULL,
+				NULL, NULL, NULL, NULL, metric->flags);
+	}
+out:
+	free_result(&result);
+
+	return ret;
+}
 		// 若处理失败，获取 result 结构体中的错误信息，并将 error 指针指向该错误信息。
 /******************************************************************************
  * *
@@ -1999,30 +2323,33 @@ static void process_active_checks(char *server, unsigned short port)
 	const char *__function_name = "process_active_checks";
 	char *error = NULL;
 	int i, now, ret;
+	zbx_vector_ptr_t	processed;
 
 	// 打印调试信息，显示调用函数的名称、服务器地址和端口
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() server:'%s' port:%hu", __function_name, server, port);
 
+	zbx_vector_ptr_create(&processed);
 	// 获取当前时间
 	now = (int)time(NULL);
 
 	// 遍历活跃的性能指标数组
-	for (i = 0; i < active_metrics.values_num; i++)
+	/* process the checks in the order of their nextcheck, the most overdue first */
+	while (SUCCEED != zbx_binary_heap_empty(&active_schedule))
 	{
 		zbx_uint64_t lastlogsize_last, lastlogsize_sent;
 		int mtime_last, mtime_sent;
 		ZBX_ACTIVE_METRIC *metric;
 
 		// 获取性能指标结构体
-		metric = (ZBX_ACTIVE_METRIC *)active_metrics.values[i];
+		metric = (ZBX_ACTIVE_METRIC *)zbx_binary_heap_find_min(&active_schedule)->data;
 
 		// 如果下一个检查时间大于当前时间，跳过这个性能指标
 		if (metric->nextcheck > now)
-			continue;
+			break;
 
 		// 如果性能指标未准备好处理，跳过这个性能指标
-		if (SUCCEED != metric_ready_to_process(metric))
-			continue;
+		zbx_binary_heap_remove_min(&active_schedule);
+		zbx_vector_ptr_append(&processed, metric);
 
 		/* 更新元数据信息，需要知道检查过程中是否发送了数据 */
 		lastlogsize_last = metric->lastlogsize;
@@ -2075,6 +2402,16 @@ static void process_active_checks(char *server, unsigned short port)
 				if (ITEM_STATE_NOTSUPPORTED == metric->state)
 				{
 					/* 项目变为支持 */
+
+					/* 元数据更新 */
+
+				/* 删除"新项目"标志 */
+
+		// 发送缓冲区数据
+
+	// 打印调试信息，显示函数调用结束
+
+					/* item became supported */
 					metric->state = ITEM_STATE_NORMAL;
 					metric->refresh_unsupported = 0;
 				}
@@ -2082,38 +2419,29 @@ static void process_active_checks(char *server, unsigned short port)
 				if (SUCCEED == need_meta_update(metric, lastlogsize_sent, mtime_sent, old_state,
 						lastlogsize_last, mtime_last))
 				{
-					/* 元数据更新 */
+					/* meta information update */
 					process_value(server, port, CONFIG_HOSTNAME, metric->key_orig, NULL,
 							metric->state, &metric->lastlogsize, &metric->mtime, NULL, NULL,
 							NULL, NULL, metric->flags);
 				}
 
-				/* 删除"新项目"标志 */
+				/* remove "new metric" flag */
 				metric->flags &= ~ZBX_METRIC_FLAG_NEW;
 			}
 		}
 
-		// 发送缓冲区数据
 		send_buffer(server, port);
 		metric->nextcheck = (int)time(NULL) + metric->refresh;
 	}
 
-	// 打印调试信息，显示函数调用结束
+	/* reschedule after processing so that every check is processed at most once per call, */
+	/* not supported checks are not scheduled until refresh of the list of active checks   */
+	for (i = 0; i < processed.values_num; i++)
+		schedule_metric((ZBX_ACTIVE_METRIC *)processed.values[i]);
+
+	zbx_vector_ptr_destroy(&processed);
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __function_name);
 }
-
-					/* item became supported */
-					metric->state = ITEM_STATE_NORMAL;
-					metric->refresh_unsupported = 0;
-				}
-
-				if (SUCCEED == need_meta_update(metric, lastlogsize_sent, mtime_sent, old_state,
-						lastlogsize_last, mtime_last))
-				{
-					/* meta information update */
-					process_value(server, port, CONFIG_HOSTNAME, metric->key_orig, NULL,
-							metric->state, &metric->lastlogsize, &metric->mtime, NULL, NULL,
-							NULL, NULL, metric->flags);
 /******************************************************************************
  * *
  *这段代码的主要目的是实现一个线程，用于定期执行 Active Checks 相关操作，包括发送数据、刷新 Active Checks 列表和处理 Active Checks。具体来说，它完成以下任务：
@@ -2140,6 +2468,21 @@ static void process_active_checks(char *server, unsigned short port)
  *...
  *```
  ******************************************************************************/
+static void	update_schedule(int delta)
+{
+	int	i;
+
+	for (i = 0; i < active_metrics.values_num; i++)
+	{
+		ZBX_ACTIVE_METRIC	*metric = (ZBX_ACTIVE_METRIC *)active_metrics.values[i];
+		metric->nextcheck += delta;
+	}
+
+	buffer.lastsent += delta;
+#if !defined(_WINDOWS)
+	spool_lastsent += delta;
+#endif
+}
 // 定义线程入口函数，参数为 active_checks_thread 和 args
 ZBX_THREAD_ENTRY(active_checks_thread, args)
 {
@@ -2181,6 +2524,10 @@ ZBX_THREAD_ENTRY(active_checks_thread, args)
     // 初始化 Active Checks 相关代码
     init_active_metrics();
 
+#if !defined(_WINDOWS)
+	if (NULL != CONFIG_BUFFER_FILE)
+		open_spool();
+#endif
     // 循环执行，直到程序退出
     while (ZBX_IS_RUNNING())
     {
@@ -2188,7 +2535,7 @@ ZBX_THREAD_ENTRY(active_checks_thread, args)
         zbx_update_env(zbx_time());
 
         // 如果当前时间大于下次发送时间，则发送数据
-        if (now >= nextsend)
+        if ((now = time(NULL)) >= nextsend)
         {
             send_buffer(activechk_args.host, activechk_args.port);
             nextsend = time(NULL) + 1;
@@ -2207,71 +2554,31 @@ ZBX_THREAD_ENTRY(active_checks_thread, args)
             else
             {
                 nextrefresh = time(NULL) + CONFIG_REFRESH_ACTIVE_CHECKS;
-            }
-        }
 
         // 如果当前时间大于下次检查时间且缓冲区还有空闲空间，则处理 Active Checks
-        if (now >= nextcheck && CONFIG_BUFFER_SIZE / 2 > buffer.pcount)
-        {
-            zbx_setproctitle("active checks #%d [processing active checks]", process_num);
 
             // 处理 Active Checks
-            process_active_checks(activechk_args.host, activechk_args.port);
 
             // 如果处理 Active Checks 失败，则更新下次检查时间为60秒后
-            if (CONFIG_BUFFER_SIZE / 2 <= buffer.pcount)
-                continue;
 
             // 获取下次检查的最小时间
-            nextcheck = get_min_nextcheck();
-            if (FAIL == nextcheck)
-                nextcheck = time(NULL) + 60;
-        }
-        else
-        {
             // 如果当前时间小于上次检查时间，则睡眠1秒
-            if (0 > (delta = now - lastcheck))
-            {
-                zabbix_log(LOG_LEVEL_WARNING, "the system time has been pushed back,"
-                           " adjusting active check schedule");
-                update_schedule((int)delta);
-                nextcheck += delta;
-                nextsend += delta;
-                nextrefresh += delta;
-            }
 
             // 空闲1秒
-            zbx_setproctitle("active checks #%d [idle 1 sec]", process_num);
-            zbx_sleep(1);
-        }
 
         // 更新上次检查时间
-        lastcheck = now;
-    }
 
     // 释放 session_token 内存
-    zbx_free(session_token);
 
     // 清理资源
-#ifdef _WINDOWS
     // 释放 host 内存，清理 Active Metrics
-    zbx_free(activechk_args.host);
-    free_active_metrics();
 
     // 退出线程
-    ZBX_DO_EXIT();
 
     // 终止线程
-    zbx_thread_exit(EXIT_SUCCESS);
-#else
     // 打印日志，记录进程终止信息
-    zbx_setproctitle("%s #%d [terminated]", get_process_type_string(process_type), process_num);
 
     // 无限循环睡眠，直到被强制终止
-    while (1)
-        zbx_sleep(SEC_PER_MIN);
-#endif
-}
 
 			}
 		}
@@ -2310,6 +2617,16 @@ ZBX_THREAD_ENTRY(active_checks_thread, args)
 
 	zbx_free(session_token);
 
+#if !defined(_WINDOWS)
+	if (NULL != spool.path)
+	{
+		/* keep the values not sent yet for the next agent start */
+		if (0 != buffer.count && SUCCEED == zbx_active_spool_write(&spool, buffer.data, buffer.count))
+			clear_buffer((int)time(NULL));
+
+		zbx_active_spool_close(&spool);
+	}
+#endif
 #ifdef _WINDOWS
 	zbx_free(activechk_args.host);
 	free_active_metrics();
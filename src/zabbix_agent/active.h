@@ -78,6 +78,7 @@ extern int	CONFIG_LISTEN_PORT;
 
 typedef struct
 {
+	zbx_uint64_t		metricid;	/* identifies the metric in the schedule of active checks */
 	char			*key;
 	char			*key_orig;
 	zbx_uint64_t		lastlogsize;
@@ -100,6 +101,7 @@ typedef struct
 						/* items. Used for measuring duration of checks. */
 	zbx_uint64_t		processed_bytes;	/* number of processed bytes for log[], log.count[], logrt[], */
 							/* logrt.count[] items */
+	zbx_uint64_t		watch_seq;	/* inotify change counter value at the last log file list update */
 }
 ZBX_ACTIVE_METRIC;
 
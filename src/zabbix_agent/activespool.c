@@ -0,0 +1,498 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2020 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "common.h"
+#include "log.h"
+#include "zbxalgo.h"
+#include "zbxserialize.h"
+
+#include "activespool.h"
+
+#include <sys/mman.h>
+#include <sys/file.h>
+
+/******************************************************************************
+ *                                                                            *
+ * The spool file is a ring of records following the file header. Records     *
+ * are only appended at the tail and removed from the head after the values   *
+ * have been sent.                                                            *
+ *                                                                            *
+ * The head and tail are logical offsets that only grow, the physical record  *
+ * position is the offset modulo data size. A record never crosses the end    *
+ * of file - if it does not fit, a wrap marker is written instead and the     *
+ * record is placed at the beginning of data.                                 *
+ *                                                                            *
+ * Records are flushed to disk before the tail is moved, so after a crash     *
+ * the file contains either all or none of the values of a write.             *
+ * Every record has a checksum which is verified when the file is opened.     *
+ *                                                                            *
+ ******************************************************************************/
+
+#define ZBX_SPOOL_MAGIC			"ZBXSPOOL"
+#define ZBX_SPOOL_VERSION		1
+
+/* record length value marking that the next record is at the beginning of data */
+#define ZBX_SPOOL_WRAP			0xffffffff
+
+#define ZBX_SPOOL_ALIGN(size)		(((size) + 7) & ~(zbx_uint64_t)7)
+#define ZBX_SPOOL_RECORD_HEADER_SIZE	(sizeof(zbx_uint32_t) * 2)
+
+typedef struct
+{
+	char		magic[8];
+	zbx_uint32_t	version;
+	zbx_uint32_t	reserved;
+	zbx_uint64_t	size;
+	zbx_uint64_t	head;
+	zbx_uint64_t	tail;
+}
+zbx_spool_header_t;
+
+#define ZBX_SPOOL_DATA_OFFSET		ZBX_SPOOL_ALIGN(sizeof(zbx_spool_header_t))
+
+#define SPOOL_HEADER(spool)		((zbx_spool_header_t *)(spool)->data)
+#define SPOOL_DATA(spool)		((unsigned char *)(spool)->data + ZBX_SPOOL_DATA_OFFSET)
+#define SPOOL_CAPACITY(spool)		((spool)->size - ZBX_SPOOL_DATA_OFFSET)
+
+/******************************************************************************
+ *                                                                            *
+ * Function: spool_header_is_valid                                            *
+ *                                                                            *
+ * Purpose: checks if the spool file header matches the file                  *
+ *                                                                            *
+ ******************************************************************************/
+static int	spool_header_is_valid(const zbx_spool_header_t *header, zbx_uint64_t size)
+{
+	if (0 != memcmp(header->magic, ZBX_SPOOL_MAGIC, sizeof(header->magic)))
+		return FAIL;
+
+	if (ZBX_SPOOL_VERSION != header->version || size != header->size)
+		return FAIL;
+
+	if (header->head > header->tail || header->tail - header->head > size - ZBX_SPOOL_DATA_OFFSET)
+		return FAIL;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: spool_flush                                                      *
+ *                                                                            *
+ * Purpose: writes modified spool file pages to disk                          *
+ *                                                                            *
+ ******************************************************************************/
+static void	spool_flush(zbx_active_spool_t *spool)
+{
+	if (0 != msync(spool->data, (size_t)spool->size, MS_SYNC))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot flush active check buffer file \"%s\": %s", spool->path,
+				zbx_strerror(errno));
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: spool_read_record                                                *
+ *                                                                            *
+ * Purpose: reads record from spool file                                      *
+ *                                                                            *
+ * Parameters: spool   - [IN] the spool                                       *
+ *             offset  - [IN/OUT] the record offset, the next record offset   *
+ *                                on success                                  *
+ *             el      - [OUT] the value, optional                            *
+ *             id      - [OUT] the value identifier                           *
+ *                                                                            *
+ * Return value: SUCCEED - the record was read                                *
+ *               FAIL    - the record is damaged                              *
+ *                                                                            *
+ ******************************************************************************/
+static int	spool_read_record(zbx_active_spool_t *spool, zbx_uint64_t *offset, ZBX_ACTIVE_BUFFER_ELEMENT *el,
+		zbx_uint64_t *id)
+{
+	zbx_uint64_t	capacity, left, size, pos = *offset;
+	zbx_uint32_t	len, checksum, value_len;
+	unsigned char	*ptr;
+
+	capacity = SPOOL_CAPACITY(spool);
+	left = capacity - pos % capacity;
+	ptr = SPOOL_DATA(spool) + pos % capacity;
+
+	memcpy(&len, ptr, sizeof(len));
+
+	if (ZBX_SPOOL_WRAP == len)
+	{
+		pos += left;
+		left = capacity;
+		ptr = SPOOL_DATA(spool);
+
+		if (pos >= SPOOL_HEADER(spool)->tail)
+			return FAIL;
+
+		memcpy(&len, ptr, sizeof(len));
+	}
+
+	if (len < sizeof(zbx_uint64_t) || ZBX_SPOOL_RECORD_HEADER_SIZE + len > left)
+		return FAIL;
+
+	size = ZBX_SPOOL_ALIGN(ZBX_SPOOL_RECORD_HEADER_SIZE + len);
+
+	if (pos + size > SPOOL_HEADER(spool)->tail)
+		return FAIL;
+
+	memcpy(&checksum, ptr + sizeof(len), sizeof(checksum));
+	ptr += ZBX_SPOOL_RECORD_HEADER_SIZE;
+
+	if (checksum != zbx_hash_modfnv(ptr, len, 0))
+		return FAIL;
+
+	ptr += zbx_deserialize_uint64(ptr, id);
+
+	if (NULL != el)
+	{
+		el->id = *id;
+		ptr += zbx_deserialize_str(ptr, &el->host, value_len);
+		ptr += zbx_deserialize_str(ptr, &el->key, value_len);
+		ptr += zbx_deserialize_str(ptr, &el->value, value_len);
+		ptr += zbx_deserialize_str(ptr, &el->source, value_len);
+		ptr += zbx_deserialize_char(ptr, &el->state);
+		ptr += zbx_deserialize_char(ptr, &el->flags);
+		ptr += zbx_deserialize_uint64(ptr, &el->lastlogsize);
+		ptr += zbx_deserialize_int(ptr, &el->timestamp);
+		ptr += zbx_deserialize_int(ptr, &el->severity);
+		ptr += zbx_deserialize_int(ptr, &el->ts.sec);
+		ptr += zbx_deserialize_int(ptr, &el->ts.ns);
+		ptr += zbx_deserialize_int(ptr, &el->logeventid);
+		(void)zbx_deserialize_int(ptr, &el->mtime);
+	}
+
+	*offset = pos + size;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: spool_write_record                                               *
+ *                                                                            *
+ * Purpose: writes record to spool file after the specified offset            *
+ *                                                                            *
+ * Parameters: spool  - [IN] the spool                                        *
+ *             offset - [IN/OUT] the record offset, the next record offset    *
+ *                               on success                                   *
+ *             el     - [IN] the value                                        *
+ *                                                                            *
+ * Return value: SUCCEED - the record was written                             *
+ *               FAIL    - not enough free space                              *
+ *                                                                            *
+ ******************************************************************************/
+static int	spool_write_record(zbx_active_spool_t *spool, zbx_uint64_t *offset, const ZBX_ACTIVE_BUFFER_ELEMENT *el)
+{
+	zbx_uint64_t	capacity, left, size, total;
+	zbx_uint32_t	len = 0, checksum, wrap = ZBX_SPOOL_WRAP, host_len, key_len, value_len, source_len;
+	const char	*host = el->host, *key = el->key, *value = el->value, *source = el->source;
+	unsigned char	*ptr, *payload;
+
+	zbx_serialize_prepare_value(len, el->id);
+	zbx_serialize_prepare_str(len, host);
+	zbx_serialize_prepare_str(len, key);
+	zbx_serialize_prepare_str(len, value);
+	zbx_serialize_prepare_str(len, source);
+	zbx_serialize_prepare_value(len, el->state);
+	zbx_serialize_prepare_value(len, el->flags);
+	zbx_serialize_prepare_value(len, el->lastlogsize);
+	zbx_serialize_prepare_value(len, el->timestamp);
+	zbx_serialize_prepare_value(len, el->severity);
+	zbx_serialize_prepare_value(len, el->ts.sec);
+	zbx_serialize_prepare_value(len, el->ts.ns);
+	zbx_serialize_prepare_value(len, el->logeventid);
+	zbx_serialize_prepare_value(len, el->mtime);
+
+	capacity = SPOOL_CAPACITY(spool);
+	left = capacity - *offset % capacity;
+	size = ZBX_SPOOL_ALIGN(ZBX_SPOOL_RECORD_HEADER_SIZE + len);
+	total = (size <= left ? size : left + size);
+
+	if (*offset + total - SPOOL_HEADER(spool)->head > capacity)
+		return FAIL;
+
+	ptr = SPOOL_DATA(spool) + *offset % capacity;
+
+	if (size > left)
+	{
+		memcpy(ptr, &wrap, sizeof(wrap));
+		ptr = SPOOL_DATA(spool);
+	}
+
+	payload = ptr + ZBX_SPOOL_RECORD_HEADER_SIZE;
+
+	ptr = payload;
+	ptr += zbx_serialize_uint64(ptr, el->id);
+	ptr += zbx_serialize_str(ptr, host, host_len);
+	ptr += zbx_serialize_str(ptr, key, key_len);
+	ptr += zbx_serialize_str(ptr, value, value_len);
+	ptr += zbx_serialize_str(ptr, source, source_len);
+	ptr += zbx_serialize_char(ptr, el->state);
+	ptr += zbx_serialize_char(ptr, el->flags);
+	ptr += zbx_serialize_uint64(ptr, el->lastlogsize);
+	ptr += zbx_serialize_int(ptr, el->timestamp);
+	ptr += zbx_serialize_int(ptr, el->severity);
+	ptr += zbx_serialize_int(ptr, el->ts.sec);
+	ptr += zbx_serialize_int(ptr, el->ts.ns);
+	ptr += zbx_serialize_int(ptr, el->logeventid);
+	(void)zbx_serialize_int(ptr, el->mtime);
+
+	checksum = zbx_hash_modfnv(payload, len, 0);
+	memcpy(payload - ZBX_SPOOL_RECORD_HEADER_SIZE, &len, sizeof(len));
+	memcpy(payload - sizeof(checksum), &checksum, sizeof(checksum));
+
+	*offset += total;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_active_spool_open                                            *
+ *                                                                            *
+ * Purpose: opens spool file, creating it if necessary, and checks the stored *
+ *          values                                                            *
+ *                                                                            *
+ * Parameters: spool - [OUT] the spool                                        *
+ *             path  - [IN] the spool file path                               *
+ *             size  - [IN] the spool file size                               *
+ *             error - [OUT] the error message                                *
+ *                                                                            *
+ * Return value: SUCCEED - the spool file was opened                          *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: If the file holds values, it is used with its current size until *
+ *           it is emptied. The values after the first damaged record are     *
+ *           discarded.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_active_spool_open(zbx_active_spool_t *spool, const char *path, zbx_uint64_t size, char **error)
+{
+	const char		*__function_name = "zbx_active_spool_open";
+	zbx_spool_header_t	header, *hdr;
+	zbx_stat_t		st;
+	zbx_uint64_t		offset, id;
+	int			ret = FAIL;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() path:'%s' size:" ZBX_FS_UI64, __function_name, path, size);
+
+	memset(spool, 0, sizeof(zbx_active_spool_t));
+	spool->data = MAP_FAILED;
+	size &= ~(zbx_uint64_t)7;
+
+	if (-1 == (spool->fd = open(path, O_RDWR | O_CREAT, 0600)))
+	{
+		*error = zbx_dsprintf(*error, "cannot open file: %s", zbx_strerror(errno));
+		goto out;
+	}
+
+	if (0 != flock(spool->fd, LOCK_EX | LOCK_NB))
+	{
+		*error = zbx_dsprintf(*error, "cannot lock file: %s", zbx_strerror(errno));
+		goto out;
+	}
+
+	if (0 != fstat(spool->fd, &st))
+	{
+		*error = zbx_dsprintf(*error, "cannot obtain file information: %s", zbx_strerror(errno));
+		goto out;
+	}
+
+	if (size != (zbx_uint64_t)st.st_size && (ssize_t)sizeof(header) == read(spool->fd, &header, sizeof(header)) &&
+			SUCCEED == spool_header_is_valid(&header, (zbx_uint64_t)st.st_size) &&
+			header.head != header.tail)
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "active check buffer file \"%s\" contains values, using its current"
+				" size " ZBX_FS_UI64, path, (zbx_uint64_t)st.st_size);
+		size = (zbx_uint64_t)st.st_size;
+	}
+
+	if (size != (zbx_uint64_t)st.st_size && 0 != ftruncate(spool->fd, (off_t)size))
+	{
+		*error = zbx_dsprintf(*error, "cannot resize file: %s", zbx_strerror(errno));
+		goto out;
+	}
+
+	if (MAP_FAILED == (spool->data = (char *)mmap(NULL, (size_t)size, PROT_READ | PROT_WRITE, MAP_SHARED,
+			spool->fd, 0)))
+	{
+		*error = zbx_dsprintf(*error, "cannot map file: %s", zbx_strerror(errno));
+		goto out;
+	}
+
+	spool->size = size;
+	spool->path = zbx_strdup(NULL, path);
+	hdr = SPOOL_HEADER(spool);
+
+	if (SUCCEED != spool_header_is_valid(hdr, size))
+	{
+		memset(hdr, 0, sizeof(zbx_spool_header_t));
+		memcpy(hdr->magic, ZBX_SPOOL_MAGIC, sizeof(hdr->magic));
+		hdr->version = ZBX_SPOOL_VERSION;
+		hdr->size = size;
+		spool_flush(spool);
+	}
+
+	for (offset = hdr->head; offset < hdr->tail; spool->values_num++)
+	{
+		if (SUCCEED != spool_read_record(spool, &offset, NULL, &id))
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "active check buffer file \"%s\" is damaged, keeping the first %d"
+					" values", path, spool->values_num);
+			hdr->tail = offset;
+			spool_flush(spool);
+			break;
+		}
+
+		if (id > spool->last_id)
+			spool->last_id = id;
+	}
+
+	ret = SUCCEED;
+out:
+	if (SUCCEED != ret)
+	{
+		if (MAP_FAILED != spool->data)
+			munmap(spool->data, (size_t)size);
+
+		if (-1 != spool->fd)
+			close(spool->fd);
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s values:%d", __function_name, zbx_result_string(ret),
+			spool->values_num);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_active_spool_close                                           *
+ *                                                                            *
+ * Purpose: closes spool file                                                 *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_active_spool_close(zbx_active_spool_t *spool)
+{
+	spool_flush(spool);
+	munmap(spool->data, (size_t)spool->size);
+	close(spool->fd);
+	zbx_free(spool->path);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_active_spool_write                                           *
+ *                                                                            *
+ * Purpose: appends values to spool file                                      *
+ *                                                                            *
+ * Parameters: spool    - [IN] the spool                                      *
+ *             elements - [IN] the values                                     *
+ *             num      - [IN] the number of values                           *
+ *                                                                            *
+ * Return value: SUCCEED - the values were written                            *
+ *               FAIL    - not enough free space, nothing was written         *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_active_spool_write(zbx_active_spool_t *spool, const ZBX_ACTIVE_BUFFER_ELEMENT *elements, int num)
+{
+	zbx_uint64_t	tail, last_id = spool->last_id;
+	int		i;
+
+	tail = SPOOL_HEADER(spool)->tail;
+
+	for (i = 0; i < num; i++)
+	{
+		if (SUCCEED != spool_write_record(spool, &tail, &elements[i]))
+			return FAIL;
+
+		if (elements[i].id > last_id)
+			last_id = elements[i].id;
+	}
+
+	/* the records must reach disk before the tail making them visible */
+	spool_flush(spool);
+	SPOOL_HEADER(spool)->tail = tail;
+	spool_flush(spool);
+
+	spool->values_num += num;
+	spool->last_id = last_id;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_active_spool_read                                            *
+ *                                                                            *
+ * Purpose: reads the oldest values from spool file                           *
+ *                                                                            *
+ * Parameters: spool    - [IN] the spool                                      *
+ *             elements - [OUT] the values                                    *
+ *             num      - [IN] the maximum number of values to read           *
+ *             next     - [OUT] the offset of the first value not read, to be *
+ *                              passed to zbx_active_spool_remove()           *
+ *                                                                            *
+ * Return value: The number of values read.                                   *
+ *                                                                            *
+ * Comments: The values are not removed from spool file.                      *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_active_spool_read(zbx_active_spool_t *spool, ZBX_ACTIVE_BUFFER_ELEMENT *elements, int num,
+		zbx_uint64_t *next)
+{
+	zbx_uint64_t	offset, id;
+	int		i;
+
+	offset = SPOOL_HEADER(spool)->head;
+
+	for (i = 0; i < num && offset < SPOOL_HEADER(spool)->tail; i++)
+	{
+		memset(&elements[i], 0, sizeof(ZBX_ACTIVE_BUFFER_ELEMENT));
+
+		if (SUCCEED != spool_read_record(spool, &offset, &elements[i], &id))
+		{
+			THIS_SHOULD_NEVER_HAPPEN;
+			break;
+		}
+	}
+
+	*next = offset;
+
+	return i;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_active_spool_remove                                          *
+ *                                                                            *
+ * Purpose: removes the values returned by zbx_active_spool_read() from spool *
+ *          file                                                              *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_active_spool_remove(zbx_active_spool_t *spool, zbx_uint64_t next, int num)
+{
+	SPOOL_HEADER(spool)->head = next;
+	spool->values_num -= num;
+}
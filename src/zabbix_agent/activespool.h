@@ -0,0 +1,48 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2020 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#ifndef ZABBIX_ACTIVESPOOL_H
+#define ZABBIX_ACTIVESPOOL_H
+
+#include "active.h"
+
+extern char		*CONFIG_BUFFER_FILE;
+extern zbx_uint64_t	CONFIG_BUFFER_FILE_SIZE;
+
+/* active check values that could not be sent, stored in a memory mapped file */
+typedef struct
+{
+	char		*path;
+	int		fd;
+	char		*data;		/* the mapped file */
+	zbx_uint64_t	size;		/* the file size */
+	int		values_num;	/* the number of stored values */
+	zbx_uint64_t	last_id;	/* the largest stored value identifier */
+}
+zbx_active_spool_t;
+
+int	zbx_active_spool_open(zbx_active_spool_t *spool, const char *path, zbx_uint64_t size, char **error);
+void	zbx_active_spool_close(zbx_active_spool_t *spool);
+
+int	zbx_active_spool_write(zbx_active_spool_t *spool, const ZBX_ACTIVE_BUFFER_ELEMENT *elements, int num);
+int	zbx_active_spool_read(zbx_active_spool_t *spool, ZBX_ACTIVE_BUFFER_ELEMENT *elements, int num,
+		zbx_uint64_t *next);
+void	zbx_active_spool_remove(zbx_active_spool_t *spool, zbx_uint64_t next, int num);
+
+#endif
@@ -26,6 +26,7 @@
 #include "stats.h"
 #include "sysinfo.h"
 #include "log.h"
+#include "zbxjson.h"
 
 extern unsigned char			program_type;
 extern ZBX_THREAD_LOCAL unsigned char	process_type;
@@ -40,64 +41,215 @@ extern ZBX_THREAD_LOCAL int		server_num, process_num;
 #include "../libs/zbxcrypto/tls.h"
 #include "../libs/zbxcrypto/tls_tcp_active.h"
 
+/******************************************************************************
+ *                                                                            *
+ * Function: process_passive_checks                                           *
+ *                                                                            *
+ * Purpose: process request for multiple item keys and send all values back   *
+ *          in a single response                                              *
+ *                                                                            *
+ * Parameters: s  - [IN] the connection                                       *
+ *             jp - [IN] the request                                          *
+ *                                                                            *
+ * Return value: SUCCEED - the response was sent                              *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: request:                                                         *
+ *           {"request":"passive checks","timeout":3,"data":[{"key":"..."}]}  *
+ *           response:                                                        *
+ *           {"response":"success","data":[{"value":"..."},{"error":"..."}]}  *
+ *                                                                            *
+ *           Keys are answered in request order within half of the requester  *
+ *           timeout. A key is not started when the time left is shorter than *
+ *           the slowest key processed so far, the remaining keys are left    *
+ *           out of response and the requester polls them one key at a time.  *
+ *                                                                            *
+ ******************************************************************************/
+/******************************************************************************
+ * *
+ *处理一次连接中请求的多个监控项键值，并在一个响应中按请求顺序返回所有键值的结果，
+ *从而避免服务器或代理为每个监控项单独建立TCP连接和TLS握手。
+ ******************************************************************************/
+static int	process_passive_checks(zbx_socket_t *s, const struct zbx_json_parse *jp)
+{
+	struct zbx_json_parse	jp_data, jp_row;
+	struct zbx_json		j;
+	AGENT_RESULT		result;
+	const char		*p = NULL;
+	char			tmp[MAX_ID_LEN + 1], *key = NULL, **value;
+	size_t			key_alloc = 0;
+	int			timeout, num = 0, ret;
+	double			deadline, key_start, key_time, key_time_max = 0;
+
+	// 请求方未指定超时时间时使用本地的超时时间
+	if (SUCCEED != zbx_json_value_by_name(jp, ZBX_PROTO_TAG_TIMEOUT, tmp, sizeof(tmp), NULL) ||
+			SUCCEED != is_uint_range(tmp, &timeout, 1, SEC_PER_MIN))
+	{
+		timeout = CONFIG_TIMEOUT;
+	}
+
+	deadline = zbx_time() + timeout / 2.0;
+
+	zbx_json_init(&j, ZBX_JSON_STAT_BUF_LEN);
+
+	if (SUCCEED != zbx_json_brackets_by_name(jp, ZBX_PROTO_TAG_DATA, &jp_data))
+	{
+		zbx_json_addstring(&j, ZBX_PROTO_TAG_RESPONSE, ZBX_PROTO_VALUE_FAILED, ZBX_JSON_TYPE_STRING);
+		zbx_json_addstring(&j, ZBX_PROTO_TAG_INFO, zbx_json_strerror(), ZBX_JSON_TYPE_STRING);
+		goto out;
+	}
+
+	zbx_json_addstring(&j, ZBX_PROTO_TAG_RESPONSE, ZBX_PROTO_VALUE_SUCCESS, ZBX_JSON_TYPE_STRING);
+	zbx_json_addarray(&j, ZBX_PROTO_TAG_DATA);
+
+	while (NULL != (p = zbx_json_next(&jp_data, p)))
+	{
+		// 至少处理一个键值，剩余时间不足以处理最慢的键值时剩余键值留给请求方逐个请求
+		if (0 != num++ && deadline < zbx_time() + key_time_max)
+			break;
+
+		key_start = zbx_time();
+
+		zbx_json_addobject(&j, NULL);
+
+		if (SUCCEED != zbx_json_brackets_open(p, &jp_row) || SUCCEED != zbx_json_value_by_name_dyn(&jp_row,
+				ZBX_PROTO_TAG_KEY, &key, &key_alloc, NULL))
+		{
+			zbx_json_addstring(&j, ZBX_PROTO_TAG_ERROR, "Invalid item key request.", ZBX_JSON_TYPE_STRING);
+			zbx_json_close(&j);
+			continue;
+		}
+
+		zabbix_log(LOG_LEVEL_DEBUG, "Requested [%s]", key);
+
+		init_result(&result);
+
+		if (SUCCEED == process(key, PROCESS_WITH_ALIAS, &result) && NULL != (value = GET_TEXT_RESULT(&result)))
+		{
+			zabbix_log(LOG_LEVEL_DEBUG, "Sending back [%s]", *value);
+			zbx_json_addstring(&j, ZBX_PROTO_TAG_VALUE, *value, ZBX_JSON_TYPE_STRING);
+		}
+		else
+		{
+			value = GET_MSG_RESULT(&result);
+
+			zabbix_log(LOG_LEVEL_DEBUG, "Sending back [" ZBX_NOTSUPPORTED ": %s]",
+					NULL != value ? *value : "");
+			zbx_json_addstring(&j, ZBX_PROTO_TAG_ERROR, NULL != value ? *value : "", ZBX_JSON_TYPE_STRING);
+		}
+
+		free_result(&result);
+		zbx_json_close(&j);
+
+		if (key_time_max < (key_time = zbx_time() - key_start))
+			key_time_max = key_time;
+	}
+out:
+	ret = zbx_tcp_send_to(s, j.buffer, CONFIG_TIMEOUT);
+
+	zbx_free(key);
+	zbx_json_free(&j);
+
+	return ret;
+}
+
 /******************************************************************************
  * *
  *整个代码块的主要目的是处理客户端发送的请求，并根据请求类型返回相应的数据。具体来说，这段代码实现了以下功能：
  *
  *1. 接收客户端发送的请求数据，并去除结尾的换行符。
  *2. 记录日志，显示接收到的请求数据。
- *3. 初始化一个结果结构体变量result，用于存储处理结果。
- *4. 调用process函数处理请求数据，根据处理结果提取文本数据或错误信息。
- *5. 如果处理成功，将提取到的文本数据发送回客户端。
- *6. 如果处理失败，将提取到的错误信息发送回客户端。
- *7. 释放result结构体内存。
- *8. 如果接收数据操作失败，记录日志并返回错误信息。
+ *3. 如果请求是多个键值的批量请求，则交给process_passive_checks处理。
+ *4. 初始化一个结果结构体变量result，用于存储处理结果。
+ *5. 调用process函数处理请求数据，根据处理结果提取文本数据或错误信息。
+ *6. 如果处理成功，将提取到的文本数据发送回客户端。
+ *7. 如果处理失败，将提取到的错误信息发送回客户端。
+ *8. 释放result结构体内存。
+ *9. 如果接收数据操作失败，记录日志并返回错误信息。
  ******************************************************************************/
-static void process_listener(zbx_socket_t *s)
+static void	process_listener(zbx_socket_t *s)
 {
-    // 定义一个AGENT_RESULT结构体变量result，用于存储处理结果
-    AGENT_RESULT	result;
-    // 定义一个字符串指针变量value，初始化为NULL
-    char		**value = NULL;
-    // 定义一个int类型变量ret，用于存储操作返回值
-    int		ret;
-
-    // 检查zbx_tcp_recv_to函数接收数据是否成功，若成功，则进行以下操作
-    if (SUCCEED == (ret = zbx_tcp_recv_to(s, CONFIG_TIMEOUT)))
-    {
-        // 对接收到的数据进行右 trim，去除结尾的\r\
-换行符
-        zbx_rtrim(s->buffer, "\r\
-");
+	// 定义一个AGENT_RESULT结构体变量result，用于存储处理结果
+	AGENT_RESULT		result;
+	struct zbx_json_parse	jp;
+	// 定义一个字符串指针变量value，初始化为NULL
+	char			**value = NULL, request[MAX_STRING_LEN];
+	// 定义一个int类型变量ret，用于存储操作返回值
+	int			ret;
+
+	// 检查zbx_tcp_recv_to函数接收数据是否成功，若成功，则进行以下操作
+	if (SUCCEED == (ret = zbx_tcp_recv_to(s, CONFIG_TIMEOUT)))
+	{
+		// 对接收到的数据进行右 trim，去除结尾的换行符
+		zbx_rtrim(s->buffer, "\r\n");
+
+		// 记录日志，显示接收到的请求数据
+		zabbix_log(LOG_LEVEL_DEBUG, "Requested [%s]", s->buffer);
+
+		// 监控项键值不能以'{'开头，以JSON对象开头的是多个键值的批量请求
+		if ('{' == *s->buffer && SUCCEED == zbx_json_open(s->buffer, &jp) &&
+				SUCCEED == zbx_json_value_by_name(&jp, ZBX_PROTO_TAG_REQUEST, request, sizeof(request),
+				NULL) && 0 == strcmp(request, ZBX_PROTO_VALUE_PASSIVE_CHECKS))
+		{
+			ret = process_passive_checks(s, &jp);
+			goto out;
+		}
 
-        // 记录日志，显示接收到的请求数据
-        zabbix_log(LOG_LEVEL_DEBUG, "Requested [%s]", s->buffer);
+		// 初始化result结构体
+		init_result(&result);
 
-        // 初始化result结构体
-        init_result(&result);
+		// 调用process函数处理请求数据，若处理成功，则进行以下操作
+		if (SUCCEED == process(s->buffer, PROCESS_WITH_ALIAS, &result))
+		{
+			// 如果处理结果包含文本数据，则提取并发送回客户端
+			if (NULL != (value = GET_TEXT_RESULT(&result)))
+			{
+				zabbix_log(LOG_LEVEL_DEBUG, "Sending back [%s]", *value);
+				ret = zbx_tcp_send_to(s, *value, CONFIG_TIMEOUT);
+			}
+		}
+		// 处理失败，则提取错误信息并发送回客户端
+		else
+		{
+			value = GET_MSG_RESULT(&result);
 
-        // 调用process函数处理请求数据，若处理成功，则进行以下操作
-        if (SUCCEED == process(s->buffer, PROCESS_WITH_ALIAS, &result))
-        {
-            // 如果处理结果包含文本数据，则提取并发送回客户端
-            if (NULL != (value = GET_TEXT_RESULT(&result)))
-            {
-                // 记录日志，显示发送回客户端的数据
-                zabbix_log(LOG_LEVEL_DEBUG, "Sending back [%s]", *value);
-                // 发送数据到客户端
-                ret = zbx_tcp_send_to(s, *value, CONFIG_TIMEOUT);
-            }
-        }
-        // 处理失败，则提取错误信息并发送回客户端
-        else
-        {
-            value = GET_MSG_RESULT(&result);
+			if (NULL != value)
+			{
+				// 静态字符串变量buffer和buffer_alloc，用于存储发送回客户端的数据
+				static char	*buffer = NULL;
+				static size_t	buffer_alloc = 256;
+				size_t		buffer_offset = 0;
+
+				zabbix_log(LOG_LEVEL_DEBUG, "Sending back [" ZBX_NOTSUPPORTED ": %s]", *value);
+
+				if (NULL == buffer)
+					buffer = (char *)zbx_malloc(buffer, buffer_alloc);
+
+				// 组装"ZBX_NOTSUPPORTED\0<错误信息>"格式的响应
+				zbx_strncpy_alloc(&buffer, &buffer_alloc, &buffer_offset,
+						ZBX_NOTSUPPORTED, ZBX_CONST_STRLEN(ZBX_NOTSUPPORTED));
+				buffer_offset++;
+				zbx_strcpy_alloc(&buffer, &buffer_alloc, &buffer_offset, *value);
+
+				ret = zbx_tcp_send_bytes_to(s, buffer, buffer_offset, CONFIG_TIMEOUT);
+			}
+			else
+			{
+				zabbix_log(LOG_LEVEL_DEBUG, "Sending back [" ZBX_NOTSUPPORTED "]");
+
+				ret = zbx_tcp_send_to(s, ZBX_NOTSUPPORTED, CONFIG_TIMEOUT);
+			}
+		}
+
+		// 释放result结构体内存
+		free_result(&result);
+	}
+out:
+	// 如果接收数据操作失败，记录日志
+	if (FAIL == ret)
+		zabbix_log(LOG_LEVEL_DEBUG, "Process listener error: %s", zbx_socket_strerror());
+}
 
-            // 如果处理结果包含错误信息，则进行以下操作
-            if (NULL != value)
-            {
-                // 静态字符串变量buffer和buffer_alloc，用于存储发送回客户端的数据
-                static char	*buffer = NULL;
 /******************************************************************************
  * *
  *代码主要目的是创建一个监听器线程，用于处理客户端的连接请求。整个代码块分为以下几个部分：
@@ -122,8 +274,10 @@ static void process_listener(zbx_socket_t *s)
  ******************************************************************************/
 ZBX_THREAD_ENTRY(listener_thread, args)
 {
+#if defined(HAVE_POLARSSL) || defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
     // 定义一个字符串指针，用于存储错误信息
     char *msg = NULL;
+#endif
     // 定义一个整型变量，用于存储函数返回值
     int ret;
     // 定义一个zbx_socket_t类型的变量s，用于存储套接字信息
@@ -225,44 +379,4 @@ ZBX_THREAD_ENTRY(listener_thread, args)
     while (1)
         zbx_sleep(SEC_PER_MIN);
 #endif
-}
-
-				{
-					process_listener(&s);
-				}
-			}
-
-			zbx_tcp_unaccept(&s);
-		}
-
-		if (SUCCEED == ret || EINTR == zbx_socket_last_error())
-			continue;
-
-#if defined(HAVE_POLARSSL) || defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
-		if (NULL != msg)
-		{
-			zabbix_log(LOG_LEVEL_WARNING, "failed to accept an incoming connection: %s", msg);
-			zbx_free(msg);
-		}
-		else
-#endif
-		{
-			zabbix_log(LOG_LEVEL_WARNING, "failed to accept an incoming connection: %s",
-					zbx_socket_strerror());
-		}
-
-		if (ZBX_IS_RUNNING())
-			zbx_sleep(1);
-	}
-
-#ifdef _WINDOWS
-	ZBX_DO_EXIT();
-
-	zbx_thread_exit(EXIT_SUCCESS);
-#else
-	zbx_setproctitle("%s #%d [terminated]", get_process_type_string(process_type), process_num);
-
-	while (1)
-		zbx_sleep(SEC_PER_MIN);
-#endif
 }
@@ -21,6 +21,9 @@
 #include "logfiles.h"
 #include "log.h"
 #include "active.h"
+#ifdef HAVE_SYS_INOTIFY_H
+#	include <sys/inotify.h>
+#endif
 
 #if defined(_WINDOWS)
 #	include "symbols.h"
@@ -40,6 +43,8 @@
 #define ZBX_FILE_PLACE_OTHER	0	/* both files have different device or inode numbers */
 #define ZBX_FILE_PLACE_SAME	1	/* both files have the same device and inode numbers */
 
+#define ZBX_NEWLINE_SEARCH_WINDOW	512	/* bytes searched for line end at once, multiple of character size */
+
 /******************************************************************************
  *                                                                            *
  * Function: split_string                                                     *
@@ -131,6 +136,9 @@ static int split_filename(const char *filename, char **directory, char **filenam
 	const char *separator = NULL;
 	zbx_stat_t buf;
 	int ret = FAIL;
+#ifdef _WINDOWS
+	size_t		sz;
+#endif
 
 	/* 调试日志 */
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() filename:'%s'", __function_name, ZBX_NULL2STR(filename));
@@ -144,8 +152,6 @@ static int split_filename(const char *filename, char **directory, char **filenam
 
 	/* 针对Windows系统进行特殊处理，因为目录名不能简单地从文件名中分离 */
 #ifdef _WINDOWS
-	size_t sz;
-#endif
 	/* 循环查找分隔符 */
 	for (sz = strlen(filename) - 1, separator = &filename[sz]; separator >= filename; separator--)
 	{
@@ -246,24 +252,8 @@ out:
 	return ret;
 }
 
-		goto out;
-	}
 
-	if (-1 == zbx_stat(*directory, &buf))
-	{
-		*err_msg = zbx_dsprintf(*err_msg, "Cannot obtain directory information: %s", zbx_strerror(errno));
-		zbx_free(*directory);
-		zbx_free(*filename_regexp);
-		goto out;
-	}
 
-	if (0 == S_ISDIR(buf.st_mode))
-	{
-		*err_msg = zbx_dsprintf(*err_msg, "Base path \"%s\" is not a directory.", *directory);
-		zbx_free(*directory);
-		zbx_free(*filename_regexp);
-		goto out;
-	}
 /******************************************************************************
  * *
  *整个代码块的主要目的是计算文件的MD5值。函数 file_start_md5 接收一个文件描述符、文件长度、MD5缓冲区指针、文件名和错误信息指针作为参数。首先，检查文件长度是否超过MD5缓冲区的最大长度，如果超过，则返回错误信息。接着，尝试将文件指针移动到文件开头，如果失败，则返回错误信息。然后，读取文件内容到缓冲区中，如果读取失败或读取的字节数与预期长度不符，则返回错误信息。最后，初始化MD5计算状态，将缓冲区中的数据添加到MD5计算中，计算出文件的MD5值，并将结果存储在MD5缓冲区中。如果整个过程顺利完成，返回SUCCEED状态，否则返回FAIL状态。
@@ -276,6 +266,9 @@ out:
 // char **err_msg：错误信息指针，如果发生错误，将返回错误信息字符串。
 static int	file_start_md5(int f, int length, md5_byte_t *md5buf, const char *filename, char **err_msg)
 {
+	md5_state_t	state;
+	char		buf[MAX_LEN_MD5];
+	int		rc;
 	// 定义一个 md5_state_t 类型的变量 state，用于存储MD5计算的状态；
 	// 定义一个长度为 MAX_LEN_MD5 的字符数组 buf，用于存储从文件中读取的数据；
 	// 定义一个 int 类型的变量 rc，用于存储读取文件的操作结果。
@@ -291,41 +284,18 @@ static int	file_start_md5(int f, int length, md5_byte_t *md5buf, const char *fil
 	// 尝试使用 zbx_lseek 函数将文件指针移动到文件开头，如果失败，则返回错误信息。
 	if ((zbx_offset_t)-1 == zbx_lseek(f, 0, SEEK_SET))
 	{
-		*err_msg = zbx_dsprintf(*err_msg, "Cannot set position to 0 for file \"%s\": %s", filename,
-				zbx_strerror(errno));
-		return FAIL;
-	}
 
 	// 读取文件内容到 buf 数组中，如果读取的字节数与 length 不相等，则表示读取失败，返回错误信息。
-	if (length != (rc = (int)read(f, buf, (size_t)length)))
-	{
 		// 如果读取失败，返回错误信息。
-		if (-1 == rc)
-		{
-			*err_msg = zbx_dsprintf(*err_msg, "Cannot read %d bytes from file \"%s\": %s", length, filename,
-					zbx_strerror(errno));
-		}
 		// 否则，返回读取的字节数与预期长度不符的错误信息。
-		else
-		{
-			*err_msg = zbx_dsprintf(*err_msg, "Cannot read %d bytes from file \"%s\". Read %d bytes only.",
-					length, filename, rc);
-		}
 
 		// 读取失败，返回 FAIL 状态。
-		return FAIL;
-	}
 
 	// 初始化 MD5 计算状态。
-	zbx_md5_init(&state);
 	// 将 buf 数组中的数据添加到 MD5 计算中。
-	zbx_md5_append(&state, (const md5_byte_t *)buf, length);
 	// 计算文件的 MD5 值，并将结果存储在 md5buf 缓冲区中。
-	zbx_md5_finish(&state, md5buf);
 
 	// 计算成功，返回 SUCCEED 状态。
-	return SUCCEED;
-}
 
 		*err_msg = zbx_dsprintf(*err_msg, "Cannot set position to 0 for file \"%s\": %s", filename,
 				zbx_strerror(errno));
@@ -441,58 +411,28 @@ static int	file_id(int f, int use_ino, zbx_uint64_t *dev, zbx_uint64_t *ino_lo,
 		// 这种情况不应该发生，表示 use_ino 的值不合法
 		THIS_SHOULD_NEVER_HAPPEN;
 		return ret;
+	}
+
+	ret = SUCCEED;
+
+	return ret;
+}
 /******************************************************************************
  * *
- *这段代码的主要目的是遍历一个名为 `logfiles` 的数组，打印数组中每个元素的详细信息。数组中的每个元素都是一个 `struct st_logfile` 类型的结构体，包含了日志文件的多个属性，如文件名、修改时间、大小、已处理大小、序列号、副本编号、不完整标志等。
- *
- *以下是代码的详细注释：
- *
- *1. 定义一个静态函数 `print_logfile_list`，接收两个参数：一个指向 `const struct st_logfile` 类型的指针 `logfiles` 和一个整型变量 `logfiles_num`。
- *
- *2. 定义一个整型变量 `i`，用于循环计数。
- *
- *3. 使用 `for` 循环遍历 `logfiles` 数组中的每个元素。
- *
- *4. 使用 `zabbix_log` 函数打印日志，日志级别为 DEBUG。打印的内容包括以下几个部分：
- *
- *   a. 序号（`i`）：当前遍历到的日志文件序号。
- *
- *   b. 文件名（`logfiles[i].filename`）：当前日志文件的名称。
- *
- *   c. 修改时间（`logfiles[i].mtime`）：当前日志文件的修改时间。
- *
- *   d. 大小（`logfiles[i].size`）：当前日志文件的大小。
- *
- *   e. 已处理大小（`logfiles[i].processed_size`）：当前日志文件已处理的大小。
- *
- *   f. 序列号（`logfiles[i].seq`）：当前日志文件的序列号。
- *
- *   g. 副本编号（`logfiles[i].copy_of`）：当前日志文件的副本编号。
- *
- *   h. 不完整标志（`logfiles[i].incomplete`）：当前日志文件的不完整标志。
- *
- *   i. 设备号（`logfiles[i].dev`）：当前日志文件的设备号。
- *
- *   j. 索引号（`logfiles[i].ino_hi` 和 `logfiles[i].ino_lo`）：当前日志文件的索引号。
- *
- *   k. MD5 校验和（`logfiles[i].md5buf`）：当前日志文件的 MD5 校验和。
- *
- *5. 在循环结束后，整个函数结束执行。
- ******************************************************************************/
+ * Function: set_use_ino_by_fs_type                                           *
+ *                                                                            *
+ * Purpose: find file system type and set 'use_ino' parameter                 *
+ *                                                                            *
+ * Parameters:                                                                *
+ *     path     - [IN] directory or file name                                 *
+ *     use_ino  - [IN] how to use file IDs                                    *
+ *     err_msg  - [IN/OUT] error message why an item became NOTSUPPORTED      *
+ *                                                                            *
 // 定义一个静态函数，用于打印日志文件列表
-static void print_logfile_list(const struct st_logfile *logfiles, int logfiles_num)
-{
 	// 定义一个整型变量 i，用于循环计数
-	int i;
 
 	// 使用 for 循环遍历 logfiles 数组中的每个元素
-	for (i = 0; i < logfiles_num; i++)
-	{
 		// 使用 zabbix_log 函数打印日志，级别为 DEBUG
-		zabbix_log(LOG_LEVEL_DEBUG, "   nr:%d filename:'%s' mtime:%d size:" ZBX_FS_UI64 " processed_size:"
-				ZBX_FS_UI64 " seq:%d copy_of:%d incomplete:%d dev:" ZBX_FS_UI64 " ino_hi:" ZBX_FS_UI64
-				" ino_lo:" ZBX_FS_UI64
-				" md5size:%d md5buf:%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x
 
  * Return value: SUCCEED or FAIL                                              *
  *                                                                            *
@@ -568,6 +508,44 @@ static int	set_use_ino_by_fs_type(const char *path, int *use_ino, char **err_msg
  *     logfiles_num - [IN] number of elements in the array                    *
  *                                                                            *
  ******************************************************************************/
+/******************************************************************************
+ * *
+ *这段代码的主要目的是遍历一个名为 `logfiles` 的数组，打印数组中每个元素的详细信息。数组中的每个元素都是一个 `struct st_logfile` 类型的结构体，包含了日志文件的多个属性，如文件名、修改时间、大小、已处理大小、序列号、副本编号、不完整标志等。
+ *
+ *以下是代码的详细注释：
+ *
+ *1. 定义一个静态函数 `print_logfile_list`，接收两个参数：一个指向 `const struct st_logfile` 类型的指针 `logfiles` 和一个整型变量 `logfiles_num`。
+ *
+ *2. 定义一个整型变量 `i`，用于循环计数。
+ *
+ *3. 使用 `for` 循环遍历 `logfiles` 数组中的每个元素。
+ *
+ *4. 使用 `zabbix_log` 函数打印日志，日志级别为 DEBUG。打印的内容包括以下几个部分：
+ *
+ *   a. 序号（`i`）：当前遍历到的日志文件序号。
+ *
+ *   b. 文件名（`logfiles[i].filename`）：当前日志文件的名称。
+ *
+ *   c. 修改时间（`logfiles[i].mtime`）：当前日志文件的修改时间。
+ *
+ *   d. 大小（`logfiles[i].size`）：当前日志文件的大小。
+ *
+ *   e. 已处理大小（`logfiles[i].processed_size`）：当前日志文件已处理的大小。
+ *
+ *   f. 序列号（`logfiles[i].seq`）：当前日志文件的序列号。
+ *
+ *   g. 副本编号（`logfiles[i].copy_of`）：当前日志文件的副本编号。
+ *
+ *   h. 不完整标志（`logfiles[i].incomplete`）：当前日志文件的不完整标志。
+ *
+ *   i. 设备号（`logfiles[i].dev`）：当前日志文件的设备号。
+ *
+ *   j. 索引号（`logfiles[i].ino_hi` 和 `logfiles[i].ino_lo`）：当前日志文件的索引号。
+ *
+ *   k. MD5 校验和（`logfiles[i].md5buf`）：当前日志文件的 MD5 校验和。
+ *
+ *5. 在循环结束后，整个函数结束执行。
+ ******************************************************************************/
 static void	print_logfile_list(const struct st_logfile *logfiles, int logfiles_num)
 {
 	int	i;
@@ -659,10 +637,8 @@ static int open_file_helper(const char *pathname, char **err_msg)
     // 使用zbx_open函数尝试打开文件，参数1为文件路径，参数2为打开模式（此处为只读模式O_RDONLY）
     // 如果zbx_open返回-1，表示文件打开失败
     if (-1 == (fd = zbx_open(pathname, O_RDONLY)))
-    {
         // 分配一个新的字符串，用于存储错误信息
         *err_msg = zbx_dsprintf(*err_msg, "Cannot open file \"%s\": %s", pathname, zbx_strerror(errno));
-    }
 
     // 返回文件描述符fd
     return fd;
@@ -691,10 +667,8 @@ static int	close_file_helper(int fd, const char *pathname, char **err_msg)
 {
 	// 判断close(fd)函数是否成功，即文件是否关闭成功
 	if (0 == close(fd))
-	{
 		// 如果close(fd)成功，返回SUCCEED，表示文件关闭成功
 		return SUCCEED;
-	}
 
 	// 如果close(fd)失败，记录错误信息
 	*err_msg = zbx_dsprintf(*err_msg, "Cannot close file \"%s\": %s", pathname, zbx_strerror(errno));
@@ -724,6 +698,22 @@ static int	close_file_helper(int fd, const char *pathname, char **err_msg)
  *           match it is assumed to be the same file                          *
  *                                                                            *
  ******************************************************************************/
+static int	examine_md5_and_place(const md5_byte_t *buf1, const md5_byte_t *buf2, size_t size, int is_same_place)
+{
+	if (0 == memcmp(buf1, buf2, size))
+	{
+		switch (is_same_place)
+		{
+			case ZBX_FILE_PLACE_UNKNOWN:
+			case ZBX_FILE_PLACE_SAME:
+				return ZBX_SAME_FILE_YES;
+			case ZBX_FILE_PLACE_OTHER:
+				return ZBX_SAME_FILE_COPY;
+		}
+	}
+
+	return ZBX_SAME_FILE_NO;
+}
 /******************************************************************************
  * *
  *整个代码块的主要目的是比较两个文件的内容（通过md5值进行比较），并根据文件位置和内容是否相同返回不同的结果码。具体来说：
@@ -735,11 +725,7 @@ static int	close_file_helper(int fd, const char *pathname, char **err_msg)
  *   - 如果文件位置和内容都不同，返回ZBX_SAME_FILE_NO，表示文件内容不同。
  ******************************************************************************/
 // 定义一个函数，用于检查两个文件内容是否相同，并返回相同文件的结果码
-static int examine_md5_and_place(const md5_byte_t *buf1, const md5_byte_t *buf2, size_t size, int is_same_place)
-{
 	// 使用memcmp函数比较两个缓冲区的内容，若内容相同，则继续执行后续代码
-	if (0 == memcmp(buf1, buf2, size))
-	{
 		// 根据is_same_place的值，进行分支判断
 /******************************************************************************
  * *
@@ -799,7 +785,7 @@ static int	is_same_file_logcpt(const struct st_logfile *old_file, const struct s
 		}
 
 		// 打开较大文件的文件，并获取错误信息
-		if ((-1 == (f = open_file_helper(p_larger->filename, err_msg)))
+		if (-1 == (f = open_file_helper(p_larger->filename, err_msg)))
 			return ZBX_SAME_FILE_ERROR;
 
 		// 调用file_start_md5函数计算较大文件的MD5校验和
@@ -822,6 +808,11 @@ static int	is_same_file_logcpt(const struct st_logfile *old_file, const struct s
 				ret = ZBX_SAME_FILE_ERROR;
 			}
 		}
+		return ret;
+	}
+
+	return ZBX_SAME_FILE_NO;
+}
 /******************************************************************************
  * *
  *这段代码的主要目的是比较两个日志文件是否为同一文件。它根据不同的日志轮换选项（如ZBX_LOG_ROTATION_LOGCPT和ZBX_LOG_ROTATION_NO_REREAD等）执行不同的比较逻辑。在比较过程中，它会考虑文件的时间戳、大小、md5sum等因素，以判断两个文件是否相同。如果相同，则返回ZBX_SAME_FILE_YES，否则返回ZBX_SAME_FILE_NO。在比较过程中如果发生错误，则返回ZBX_SAME_FILE_ERROR。
@@ -872,90 +863,29 @@ static int is_same_file_logrt(const struct st_logfile *old_file, const struct st
 	// 文件大小相等且时间戳顺序相反，可能是文件系统缓存问题，先认为相同文件，下次尝试重新比较
 	if (old_file->size == new_file->size && old_file->mtime < new_file->mtime)
 	{
-		if (0 == old_file->retry)
-		{
 			// 如果选项不为ZBX_LOG_ROTATION_NO_REREAD，则警告并重试
-			if (ZBX_LOG_ROTATION_NO_REREAD != options)
-			{
-				zabbix_log(LOG_LEVEL_WARNING, "the modification time of log file \"%s\" has been"
-						" updated without changing its size, try checking again later",
-						old_file->filename);
-			}
 
-			return ZBX_SAME_FILE_RETRY;
-		}
 
 		// 如果选项为ZBX_LOG_ROTATION_NO_REREAD，则直接认为相同文件
-		if (ZBX_LOG_ROTATION_NO_REREAD == options)
-		{
-			zabbix_log(LOG_LEVEL_WARNING, "after changing modification time the size of log file \"%s\""
-					" still has not been updated, consider it to be same file",
-					old_file->filename);
-			return ZBX_SAME_FILE_YES;
-		}
 
-		zabbix_log(LOG_LEVEL_WARNING, "after changing modification time the size of log file \"%s\""
-				" still has not been updated, consider it to be a new file", old_file->filename);
-		return ZBX_SAME_FILE_NO;
-	}
 
 	// 比较文件md5sum，但大小减小时不比较，避免误判
-	if (-1 == old_file->md5size || -1 == new_file->md5size)
-	{
 		/* Cannot compare MD5 sums. Assume two different files - reporting twice is better than skipping. */
-		return ZBX_SAME_FILE_NO;
-	}
 
 	// 如果旧文件md5sum大于新文件md5sum，则文件不可能相同
-	if (old_file->md5size > new_file->md5size)
-	{
-		return ZBX_SAME_FILE_NO;
-	}
 
 	// 大小相等且md5sum相等，认为同一文件
-	if (old_file->md5size == new_file->md5size)
-	{
-		if (0 != memcmp(old_file->md5buf, new_file->md5buf, sizeof(new_file->md5buf)))	/* MD5 sums differ */
-			return ZBX_SAME_FILE_NO;
 
-		return ZBX_SAME_FILE_YES;
-	}
 
 	// 如果旧文件有md5sum，则计算新文件的md5sum进行比较
-	if (0 < old_file->md5size)
-	{
-		int		f, ret;
-		md5_byte_t	md5tmp[MD5_DIGEST_SIZE];
 
 		// 打开新文件计算md5sum，如果打开失败或计算失败，则返回错误
-		if (-1 == (f = open_file_helper(new_file->filename, err_msg)))
-			return ZBX_SAME_FILE_ERROR;
 
 		// 计算新文件的md5sum，并与旧文件md5sum比较
-		if (SUCCEED == file_start_md5(f, old_file->md5size, md5tmp, new_file->filename, err_msg))
-		{
-			ret = (0 == memcmp(old_file->md5buf, &md5tmp, sizeof(md5tmp))) ? ZBX_SAME_FILE_YES :
-					ZBX_SAME_FILE_NO;
-		}
-		else
-			ret = ZBX_SAME_FILE_ERROR;
 
 		// 关闭文件
-		if (0 != close(f))
-		{
-			if (ZBX_SAME_FILE_ERROR != ret)
-			{
-				*err_msg = zbx_dsprintf(*err_msg, "Cannot close file \"%s\": %s", new_file->filename,
-						zbx_strerror(errno));
-				ret = ZBX_SAME_FILE_ERROR;
-			}
-		}
 
-		return ret;
-	}
 
-	return ZBX_SAME_FILE_YES;
-}
 
 		/* that some tampering was done and to be safe we will treat it  */
 		/* as a different file.                                          */
@@ -1292,21 +1222,21 @@ static int is_old2new_unique_mapping(const char * const old2new, int num_old, in
 // 定义一个名为 resolve_old2new 的静态函数，该函数接受三个参数：一个指向旧文件到新文件映射的字符指针、旧文件数量和新文件数量。
 static void resolve_old2new(char *old2new, int num_old, int num_new)
 {
+	int	i;
     // 定义两个字符指针变量 protected_rows 和 protected_cols，用于存储受保护的行和列。
     char *protected_rows = NULL, *protected_cols = NULL;
 
     // 检查旧文件到新文件映射是否唯一。
     if (SUCCEED == is_old2new_unique_mapping(old2new, num_old, num_new))
-    {
         // 如果映射唯一，则直接返回。
         return;
-    }
 
     // 如果映射不唯一，则执行以下操作：
     // 1. 打印 debug 信息，提示非唯一映射。
     // 2. 保护唯一映射，防止进一步修改。
     // 3. 解决剩余的非唯一映射，将其变为唯一映射。
 
+	zabbix_log(LOG_LEVEL_DEBUG, "resolve_old2new(): non-unique mapping");
     // 分配内存，存储受保护的行和列。
     protected_rows = (char *)zbx_calloc(protected_rows, (size_t)num_old, sizeof(char));
     protected_cols = (char *)zbx_calloc(protected_cols, (size_t)num_new, sizeof(char));
@@ -1420,29 +1350,10 @@ static char *create_old2new_and_copy_of(zbx_log_rotation_options_t rotation_type
 					break;
 				case ZBX_SAME_FILE_COPY:
 					p[j] = '2'; // 如果旧文件和新文件是同一文件，且需要复制，将old2new数组对应位置的字符设置为'2'
-					new_files[j].copy_of = i; // 记录旧文件索引
-					break;
-				case ZBX_SAME_FILE_RETRY:
-					old_files[i].retry = 1; // 如果旧文件和新文件是同一文件，但需要重试
-					zbx_free(old2new); // 释放old2new内存
-					return NULL; // 返回NULL，表示映射关系创建失败
-				case ZBX_SAME_FILE_ERROR:
-					zbx_free(old2new); // 释放old2new内存
-					return NULL; // 返回NULL，表示映射关系创建失败
-			}
 
-			zabbix_log(LOG_LEVEL_DEBUG, "%s(): is_same_file(%s, %s) = %c", __function_name,
-					old_files[i].filename, new_files[j].filename, p[j]);
-		}
 
-		p += (size_t)num_new; // 更新p指向下一个新文件组
-	}
 
-	if (ZBX_LOG_ROTATION_LOGCPT != rotation_type && (1 < num_old || 1 < num_new))
-		resolve_old2new(old2new, num_old, num_new); // 如果rotation_type不等于ZBX_LOG_ROTATION_LOGCPT，且旧文件或新文件数量大于1，则调用resolve_old2new函数处理映射关系
 
-	return old2new;
-}
 
 					new_files[j].copy_of = i;
 					break;
@@ -1508,12 +1419,13 @@ static int	find_old2new(const char * const old2new, int num_new, int i_old)
 	{
 		// 如果当前字符为'1'或'2'，表示找到了对应旧字符串的行
 		if ('1' == *p || '2' == *p)
-		{
 			return i;
+		p++;
 		}
 
 		// 移动指针，遍历下一列（行）
-		p++;
+	return -1;
+}
 /******************************************************************************
  * *
  ******************************************************************************/
@@ -1527,7 +1439,8 @@ static int	find_old2new(const char * const old2new, int num_new, int i_old)
  *   st：文件信息结构体指针
  * 返回值：无
  */
-static void add_logfile(struct st_logfile **logfiles, int *logfiles_alloc, int *logfiles_num, const char *filename, zbx_stat_t *st)
+static void	add_logfile(struct st_logfile **logfiles, int *logfiles_alloc, int *logfiles_num, const char *filename,
+		zbx_stat_t *st)
 {
 	const char *__function_name = "add_logfile";
 	int		i = 0, cmp = 0;
@@ -1606,28 +1519,8 @@ out:
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __function_name);
 }
 
-				(size_t)(*logfiles_num - i) * sizeof(struct st_logfile));
-	}
 
-	(*logfiles)[i].filename = zbx_strdup(NULL, filename);
-	(*logfiles)[i].mtime = (int)st->st_mtime;
-	(*logfiles)[i].md5size = -1;
-	(*logfiles)[i].seq = 0;
-	(*logfiles)[i].incomplete = 0;
-	(*logfiles)[i].copy_of = -1;
-#ifndef _WINDOWS
-	(*logfiles)[i].dev = (zbx_uint64_t)st->st_dev;
-	(*logfiles)[i].ino_lo = (zbx_uint64_t)st->st_ino;
-	(*logfiles)[i].ino_hi = 0;
-#endif
-	(*logfiles)[i].size = (zbx_uint64_t)st->st_size;
-	(*logfiles)[i].processed_size = 0;
-	(*logfiles)[i].retry = 0;
 
-	++(*logfiles_num);
-out:
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __function_name);
-}
 
 /******************************************************************************
  *                                                                            *
@@ -1653,19 +1546,15 @@ void	destroy_logfile_list(struct st_logfile **logfiles, int *logfiles_alloc, int
 
 	// 遍历 logfiles 数组中的每个元素
 	for (i = 0; i < *logfiles_num; i++)
-	{
 		// 释放每个 logfile 的 filename 内存空间
 		zbx_free((*logfiles)[i].filename);
-	}
 
 	// 将 logfiles 数组的长度清零，即将指针指向的内存空间释放
 	*logfiles_num = 0;
 
 	// 如果 logfiles_alloc 不是 NULL，将其清零，即将分配的内存空间释放
 	if (NULL != logfiles_alloc)
-	{
 		*logfiles_alloc = 0;
-	}
 
 	// 释放 logfiles 指针指向的内存空间
 	zbx_free(*logfiles);
@@ -1727,6 +1616,8 @@ static void pick_logfile(const char *directory, const char *filename, int mtime,
     else
         zabbix_log(LOG_LEVEL_DEBUG, "cannot process entry '%s': %s", logfile_candidate, zbx_strerror(errno));
 
+    zbx_free(logfile_candidate);
+}
 /******************************************************************************
  * *
  *这个代码块的主要目的是在给定的目录中查找满足条件的日志文件，并将它们添加到指定的日志文件列表中。这里的条件可以是文件的最后修改时间（mtime）或者使用正则表达式（re）筛选。函数接受一个指向目录的指针、一个整数变量（mtime）、一个正则表达式指针、一个整数指针（用于存储是否使用inode标识文件）、一个日志文件结构体的指针数组、一个整数指针（用于存储日志文件数组的大小）和一个字符串指针（用于存储错误信息）。函数在Windows和UNIX系统上有所不同，分别使用_wfindfirst和opendir来打开和遍历目录。根据系统类型，设置使用inode标识文件，并调用pick_logfile函数来选择满足条件的日志文件。最后，关闭目录并释放内存。
@@ -1735,6 +1626,7 @@ static void pick_logfile(const char *directory, const char *filename, int mtime,
 static int pick_logfiles(const char *directory, int mtime, const zbx_regexp_t *re, int *use_ino,
                         struct st_logfile **logfiles, int *logfiles_alloc, int *logfiles_num, char **err_msg)
 {
+#ifdef _WINDOWS
     /* 定义一些变量，用于存放搜索目录、文件名、错误信息等 */
     int				ret = FAIL;
     char				*find_path = NULL, *file_name_utf8;
@@ -1743,7 +1635,6 @@ static int pick_logfiles(const char *directory, int mtime, const zbx_regexp_t *r
     struct _wfinddata_t		find_data;
 
     /* 根据系统类型，分别处理Windows和UNIX目录 */
-#ifdef _WINDOWS
     /* "open" Windows directory */
     find_path = zbx_dsprintf(find_path, "%s*", directory);
     find_wpath = zbx_utf8_to_unicode(find_path);
@@ -1784,35 +1675,14 @@ clean:
     zbx_free(find_wpath);
     zbx_free(find_path);
 
-    return ret;
-#else
     /* 打开目录，并遍历目录中的文件 */
-    if (NULL == (dir = opendir(directory)))
-    {
-        *err_msg = zbx_dsprintf(*err_msg, "Cannot open directory \"%s\" for reading: %s", directory,
-                                 zbx_strerror(errno));
-        return FAIL;
-    }
 
     /* 默认使用inode标识文件 */
-    *use_ino = 1;
 
     /* 遍历目录中的文件，并选择满足条件的日志文件 */
-    while (NULL != (d_ent = readdir(dir)))
-    {
-        pick_logfile(directory, d_ent->d_name, mtime, re, logfiles, logfiles_alloc, logfiles_num);
-    }
 
     /* 关闭目录，并处理可能的错误 */
-    if (-1 == closedir(dir))
-    {
-        *err_msg = zbx_dsprintf(*err_msg, "Cannot close directory \"%s\": %s", directory, zbx_strerror(errno));
-        return FAIL;
-    }
 
-    return SUCCEED;
-#endif
-}
 
 
 	return ret;
@@ -1927,6 +1797,9 @@ static int	compile_filename_regexp(const char *filename_regexp, zbx_regexp_t **r
  *   失败：非0
  */
 static int	fill_file_details(struct st_logfile **logfiles, int logfiles_num, int use_ino, char **err_msg)
+#else
+static int	fill_file_details(struct st_logfile **logfiles, int logfiles_num, char **err_msg)
+#endif
 {
 	int	i, ret = SUCCEED;
 
@@ -1936,6 +1809,10 @@ static int	fill_file_details(struct st_logfile **logfiles, int logfiles_num, int
 		int			f;
 		struct st_logfile	*p = *logfiles + i;
 
+		/* details of files reused from the previous list are already filled in */
+		if (-1 != p->md5size)
+			continue;
+
 		/* 打开文件，并将其添加到日志文件结构体中的文件描述符列表 */
 		if (-1 == (f = open_file_helper(p->filename, err_msg)))
 			return FAIL;
@@ -1946,6 +1823,16 @@ static int	fill_file_details(struct st_logfile **logfiles, int logfiles_num, int
 		/* 计算文件MD5校验和 */
 		if (SUCCEED != (ret = file_start_md5(f, p->md5size, p->md5buf, p->filename, err_msg)))
 			goto clean;
+#ifdef _WINDOWS
+		ret = file_id(f, use_ino, &p->dev, &p->ino_lo, &p->ino_hi, p->filename, err_msg);
+#endif	/*_WINDOWS*/
+clean:
+		if (SUCCEED != close_file_helper(f, p->filename, err_msg) || FAIL == ret)
+			return FAIL;
+	}
+
+	return ret;
+}
 
 /******************************************************************************
  * *
@@ -2045,141 +1932,142 @@ static int	make_logfile_list(unsigned char flags, const char *filename, int mtim
 #endif
 		}
 clean2:
-		zbx_regexp_free(re);				/* 释放正则表达式对象 */
+
+
+
+
+		zbx_regexp_free(re);
 clean1:
 		zbx_free(directory);
 		zbx_free(filename_regexp);
 
 		if (FAIL == ret || ZBX_NO_FILE_ERROR == ret)
-			goto clean;				/* 如果函数调用失败或NO_FILE_ERROR，跳转到clean标签处 */
+			goto clean;
+/******************************************************************************
+ * 以下是对代码的逐行注释：
+ *
+ *
+ *
+ *整个代码块的主要目的是在一个缓冲区中查找新的换行符（LF或CR），并返回换行符的位置。该函数适用于单字节和多字节字符集。在单字节字符集中，函数逐个检查字符，直到找到换行符。在多字节字符集中，函数使用`memcmp`函数比较字符串以找到匹配的换行符。如果找到换行符，函数返回换行符的位置；否则，返回NULL。
+ ******************************************************************************/
 	}
 	else
-		THIS_SHOULD_NEVER_HAPPEN;			/* 如果不满足flags的任意一种情况，表示不应该发生这种情况 */
+		THIS_SHOULD_NEVER_HAPPEN;
 
 #ifdef _WINDOWS
-	ret = fill_file_details(logfiles, *logfiles_num, *use_ino, err_msg);	/* 填充文件详细信息 */
+	ret = fill_file_details(logfiles, *logfiles_num, *use_ino, err_msg);
 #else
 	ret = fill_file_details(logfiles, *logfiles_num, err_msg);
 #endif
 clean:
 	if ((FAIL == ret || ZBX_NO_FILE_ERROR == ret) && NULL != *logfiles)
-		destroy_logfile_list(logfiles, logfiles_alloc, logfiles_num);	/* 销毁日志列表 */
+		destroy_logfile_list(logfiles, logfiles_alloc, logfiles_num);
 
 	return	ret;
 }
 
-			ret = ZBX_NO_FILE_ERROR;
-#else
-			if (0 != access(directory, X_OK))
-			{
-				zabbix_log(LOG_LEVEL_WARNING, "insufficient access rights (no \"execute\" permission) "
-						"to directory \"%s\": %s", directory, zbx_strerror(errno));
-			}
-			else
-			{
-				zabbix_log(LOG_LEVEL_WARNING, "there are no recently modified files matching \"%s\" in"
-						" \"%s\"", filename_regexp, directory);
-				ret = ZBX_NO_FILE_ERROR;
-			}
-#endif
-		}
-clean2:
-		zbx_regexp_free(re);
-clean1:
-		zbx_free(directory);
-		zbx_free(filename_regexp);
-
-		if (FAIL == ret || ZBX_NO_FILE_ERROR == ret)
-			goto clean;
 /******************************************************************************
- * 以下是对代码的逐行注释：
- *
- *
- *
- *整个代码块的主要目的是在一个缓冲区中查找新的换行符（LF或CR），并返回换行符的位置。该函数适用于单字节和多字节字符集。在单字节字符集中，函数逐个检查字符，直到找到换行符。在多字节字符集中，函数使用`memcmp`函数比较字符串以找到匹配的换行符。如果找到换行符，函数返回换行符的位置；否则，返回NULL。
+ *                                                                            *
+ * Function: buf_find_char                                                    *
+ *                                                                            *
+ * Purpose: finds the first occurrence of a character in the buffer           *
+ *                                                                            *
+ * Parameters: p      - [IN] the buffer start, aligned to character size      *
+ *             p_end  - [IN] the buffer end                                   *
+ *             c      - [IN] the character                                    *
+ *             szbyte - [IN] the character size in bytes                      *
+ *                                                                            *
+ * Return value: pointer to the character or NULL if it was not found         *
+ *                                                                            *
+ * Comments: The buffer is scanned with memchr() for a non-zero byte of the   *
+ *           character, which is much faster than comparing every character.  *
+ *                                                                            *
  ******************************************************************************/
-static char *buf_find_newline(char *p, char **p_next, const char *p_end, const char *cr, const char *lf, size_t szbyte)
+static char	*buf_find_char(char *p, const char *p_end, const char *c, size_t szbyte)
 {
-	// 判断字符集大小，如果是单字节字符集（如ASCII）
-	if (1 == szbyte)	/* single-byte character set */
+	char	*q;
+	size_t	k;
+
+	/* CR and LF have a single non-zero byte in all the supported encodings */
+	for (k = 0; k < szbyte - 1 && '\0' == c[k]; k++)
+		;
+
+	while (p + szbyte <= p_end)
 	{
-		for (; p < p_end; p++)
-		{
-			// 检查当前字符是否为换行符（LF或CR）
-			if (0xd < *p || 0xa > *p)
-				continue;
+		if (NULL == (q = (char *)memchr(p + k, c[k], (size_t)(p_end - p) - k)))
+			return NULL;
 
-			// 如果是LF（Unix系统换行符）
-			if (0xa == *p)  /* LF (Unix) */
-			{
-				// 指向下一个字符的指针指向当前字符的后一个字符
-				*p_next = p + 1;
-				// 返回当前字符的地址
-				return p;
-			}
+		q -= k;
 
-			// 如果是CR（Mac系统换行符）
-			if (0xd == *p)	/* CR (Mac) */
-			{
-				// 如果当前字符后面还有一个字符且为LF（Windows系统换行符）
-				if (p < p_end - 1 && 0xa == *(p + 1))   /* CR+LF (Windows) */
-				{
-					// 指向下一个字符的指针指向当前字符的后两个字符
-					*p_next = p + 2;
-					// 返回当前字符的地址
-					return p;
-				}
+		/* the byte must be at the right place in a whole character */
+		if (0 == (size_t)(q - p) % szbyte && q + szbyte <= p_end && 0 == memcmp(q, c, szbyte))
+			return q;
 
-				// 指向下一个字符的指针指向当前字符的后一个字符
-				*p_next = p + 1;
-				// 返回当前字符的地址
-				return p;
-			}
-		}
-		// 如果没有找到换行符，返回NULL
-		return (char *)NULL;
+		p += ((size_t)(q - p) / szbyte + 1) * szbyte;
 	}
-	else
+
+	return NULL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: buf_find_newline                                                 *
+ *                                                                            *
+ * Purpose: finds the first line end (LF, CR or CR+LF) in the buffer          *
+ *                                                                            *
+ * Parameters: p      - [IN] the buffer start, aligned to character size      *
+ *             p_next - [OUT] the start of the next line                      *
+ *             p_end  - [IN] the buffer end                                   *
+ *             cr     - [IN] the CR character in the file encoding            *
+ *             lf     - [IN] the LF character in the file encoding            *
+ *             szbyte - [IN] the character size in bytes                      *
+ *                                                                            *
+ * Return value: pointer to the line end or NULL if it was not found          *
+ *                                                                            *
+ * Comments: The buffer is searched in windows of ZBX_NEWLINE_SEARCH_WINDOW   *
+ *           bytes, so a line without LF (for example, in a file with CR      *
+ *           line ends) does not make every LF search run to the buffer end.  *
+ *                                                                            *
+ ******************************************************************************/
+static char	*buf_find_newline(char *p, char **p_next, const char *p_end, const char *cr, const char *lf,
+		size_t szbyte)
+{
+	char	*p_lf, *p_cr, *p_window_end;
+
+	for (; p < p_end; p = p_window_end)
 	{
-		// 如果是多字节字符集
-		while (p <= p_end - szbyte)
-		{
-			// 检查当前字符串是否为LF（Unix系统换行符）
-			if (0 == memcmp(p, lf, szbyte))		/* LF (Unix) */
-			{
-				// 指向下一个字符的指针指向当前字符的后一个字符
-				*p_next = p + szbyte;
-				// 返回当前字符的地址
-				return p;
-			}
+		if (ZBX_NEWLINE_SEARCH_WINDOW < p_end - p)
+			p_window_end = p + ZBX_NEWLINE_SEARCH_WINDOW;
+		else
+			p_window_end = (char *)p_end;
 
-			// 检查当前字符串是否为CR（Mac系统换行符）
-			if (0 == memcmp(p, cr, szbyte))		/* CR (Mac) */
-			{
-				// 如果当前字符后面还有一个字符且为LF（Windows系统换行符）
-				if (p <= p_end - szbyte - szbyte && 0 == memcmp(p + szbyte, lf, szbyte))
-				{
-					/* CR+LF (Windows) */
-					*p_next = p + szbyte + szbyte;
-					// 返回当前字符的地址
-					return p;
-				}
+		/* CR is searched only up to the first LF */
+		if (NULL == (p_lf = buf_find_char(p, p_window_end, lf, szbyte)))
+			p_cr = buf_find_char(p, p_window_end, cr, szbyte);
+		else
+			p_cr = buf_find_char(p, p_lf, cr, szbyte);
 
-				// 指向下一个字符的指针指向当前字符的后一个字符
-				*p_next = p + szbyte;
-				// 返回当前字符的地址
-				return p;
-			}
+		if (NULL != p_cr)	/* CR (Mac) */
+		{
+			/* the LF can be the first character of the next window */
+			if (p_cr + 2 * szbyte <= p_end && 0 == memcmp(p_cr + szbyte, lf, szbyte))
+				*p_next = p_cr + 2 * szbyte;	/* CR+LF (Windows) */
+			else
+				*p_next = p_cr + szbyte;
+
+			return p_cr;
+		}
 
-			// 移动到下一个字符
-			p += szbyte;
+		if (NULL != p_lf)	/* LF (Unix) */
+		{
+			*p_next = p_lf + szbyte;
+			return p_lf;
 		}
-		// 如果没有找到换行符，返回NULL
-		return (char *)NULL;
 	}
+
+	return NULL;
 }
 
-				if (p <= p_end - szbyte - szbyte && 0 == memcmp(p + szbyte, lf, szbyte))
 /******************************************************************************
  * 这是一个C语言代码块，主要功能是从一个文件中读取数据，并根据给定的正则表达式进行匹配。匹配到的数据将被发送到Zabbix服务器，以便进行进一步处理。以下是代码的详细注释：
  *
@@ -2238,6 +2126,13 @@ static int zbx_read2(int fd, unsigned char flags, zbx_uint64_t *lastlogsize, int
             goto out;
         }
 
+		if ((zbx_offset_t)-1 == (offset = zbx_lseek(fd, 0, SEEK_CUR)))
+		{
+			*big_rec = 0;
+			*err_msg = zbx_dsprintf(*err_msg, "Cannot set position to 0 in file: %s", zbx_strerror(errno));
+			ret = FAIL;
+			goto out;
+		}
         // 读取数据到缓冲区
         nbytes = (int)read(fd, buf, (size_t)BUF_SIZE);
 
@@ -2272,41 +2167,51 @@ static int zbx_read2(int fd, unsigned char flags, zbx_uint64_t *lastlogsize, int
                 *incomplete = 1;
 
             // 重新定位文件读取位置
-            if ((zbx_offset_t)-1 == zbx_lseek(fd, *lastlogsize, SEEK_SET))
+            if (BUF_SIZE > nbytes)
             {
-                *err_msg = zbx_dsprintf(*err_msg, "Cannot set position to " ZBX_FS_UI64
-                    " in file: %s", *lastlogsize, zbx_strerror(errno));
-                ret = FAIL;
+                *lastlogsize = (zbx_uint64_t)offset;
+                ret = SUCCEED;
                 goto out;
             }
             else
-                break;
-        }
+            {
+                /* buffer is full and there is no "newline" in it */
+
+                if (0 == *big_rec)
+                {
+                    /* It is the first, beginning part of a long record. Match it against the */
+                    /* regexp now (our buffer length corresponds to what we can save in the */
+                    /* database). */
+
+                    char	*value;
+
+                    buf[BUF_SIZE] = '\0';
+
+                    if ('\0' != *encoding)
+                        value = convert_to_utf8(buf, (size_t)BUF_SIZE, encoding);
         else
-        {
+                        value = buf;
             // 找到换行符，继续处理数据
-            *incomplete = 0;
-        }
 
         // 处理数据，发送到Zabbix服务器
-        for (;;)
-        {
+                    zabbix_log(LOG_LEVEL_WARNING, "Logfile contains a large record: \"%.64s\""
+                            " (showing only the first 64 characters). Only the first 256 kB"
+                            " will be analyzed, the rest will be ignored while Zabbix agent"
+                            " is running.", value);
             // 检查是否达到处理限制
-            if (0 >= *p_count || 0 >= *s_count)
-            {
                 // 达到处理限制，退出循环
-                ret = SUCCEED;
-                goto out;
-            }
 
             // 初始化变量
-            lastlogsize1 = (size_t)offset + (size_t)(p_next - buf);
+                    lastlogsize1 = (size_t)offset + (size_t)nbytes;
             send_err = FAIL;
 
             // 根据给定的正则表达式匹配数据
-            if (0 == (regexp_ret = regexp_sub_ex(regexps, p_start, &item_value,
-                                              pattern, ZBX_CASE_SENSITIVE, output_template)))
+                    if (0 == (ZBX_METRIC_FLAG_LOG_COUNT & flags))	/* log[] or logrt[] */
             {
+						if (ZBX_REGEXP_MATCH == (regexp_ret = regexp_sub_ex(regexps, value,
+								pattern, ZBX_CASE_SENSITIVE, output_template,
+								&item_value)))
+						{
                 // 匹配成功，发送数据
                 if (SUCCEED == (send_err = process_value(server, port,
                                                       hostname, key, item_value, ITEM_STATE_NORMAL,
@@ -2316,27 +2221,34 @@ static int zbx_read2(int fd, unsigned char flags, zbx_uint64_t *lastlogsize, int
                     // 发送成功，更新发送时间和数据
                     *lastlogsize_sent = lastlogsize1;
                     if (NULL != mtime_sent)
-                        *mtime_sent = mtime;
+                                    *mtime_sent = *mtime;
 
                     // 减少处理计数
-                    (*p_count)--;
+                                (*s_count)--;
+                                zbx_free(item_value);
                 }
                 else
                 {
+								zbx_free(item_value);
                     // 发送失败，重新发送数据
                     ret = SUCCEED;
                     goto out;
                 }
             }
+                    }
             else
             {
+						if (ZBX_REGEXP_MATCH == (regexp_ret = regexp_sub_ex(regexps, value,
+								pattern, ZBX_CASE_SENSITIVE, NULL, NULL)))
+						{
                 // 匹配失败，增加处理计数
                 (*s_count)--;
             }
+					}
 
             // 释放匹配到的数据
             if ('\0' != *encoding)
-                zbx_free(item_value);
+                        zbx_free(value);
 
             // 更新最后一条日志的时间和大小
             if (FAIL == regexp_ret)
@@ -2347,17 +2259,130 @@ static int zbx_read2(int fd, unsigned char flags, zbx_uint64_t *lastlogsize, int
             }
 
             // 移动到下一行
-            p_start = p_next;
-            p = p_next;
+                    (*p_count)--;
+
+                    if (0 != (ZBX_METRIC_FLAG_LOG_COUNT & flags) ||
+                            ZBX_REGEXP_NO_MATCH == regexp_ret || SUCCEED == send_err)
+                    {
+                        *lastlogsize = lastlogsize1;
+                        *big_rec = 1;	/* ignore the rest of this record */
+                    }
+                }
+                else
+                {
+                    /* It is a middle part of a long record. Ignore it. We have already */
+                    /* checked the first part against the regexp. */
+                    *lastlogsize = (size_t)offset + (size_t)nbytes;
+                }
+            }
+        }
+        else
+        {
+            /* the "newline" was found, so there is at least one complete record */
+            /* (or trailing part of a large record) in the buffer */
+            *incomplete = 0;
+
+            for (;;)
+            {
+                if (0 >= *p_count || 0 >= *s_count)
+                {
+                    /* limit on number of processed or sent-to-server lines reached */
+                    ret = SUCCEED;
+                    goto out;
+                }
+
+                if (0 == *big_rec)
+                {
+                    char	*value;
+
+                    *p_nl = '\0';
+
+                    if ('\0' != *encoding)
+                        value = convert_to_utf8(p_start, (size_t)(p_nl - p_start), encoding);
+                    else
+                        value = p_start;
+
+                    lastlogsize1 = (size_t)offset + (size_t)(p_next - buf);
+                    send_err = FAIL;
+
+                    if (0 == (ZBX_METRIC_FLAG_LOG_COUNT & flags))   /* log[] or logrt[] */
+                    {
+                        if (ZBX_REGEXP_MATCH == (regexp_ret = regexp_sub_ex(regexps, value,
+                                pattern, ZBX_CASE_SENSITIVE, output_template,
+                                &item_value)))
+                        {
+                            if (SUCCEED == (send_err = process_value(server, port,
+                                    hostname, key, item_value, ITEM_STATE_NORMAL,
+                                    &lastlogsize1, mtime, NULL, NULL, NULL, NULL,
+                                    flags | ZBX_METRIC_FLAG_PERSISTENT)))
+                            {
+                                *lastlogsize_sent = lastlogsize1;
+                                if (NULL != mtime_sent)
+                                    *mtime_sent = *mtime;
+
+                                (*s_count)--;
+                                zbx_free(item_value);
+                            }
+                            else
+                            {
+                                zbx_free(item_value);
+
+                                /* Sending of buffer failed. */
+                                /* Try to resend it in the next check. */
+                                ret = SUCCEED;
+                                goto out;
+                            }
+                        }
+                    }
+                    else	/* log.count[] or logrt.count[] */
+                    {
+                        if (ZBX_REGEXP_MATCH == (regexp_ret = regexp_sub_ex(regexps, value,
+                                pattern, ZBX_CASE_SENSITIVE, NULL, NULL)))
+                        {
+                            (*s_count)--;
         }
     }
 
-out:
-    return ret;
+                    if ('\0' != *encoding)
+                        zbx_free(value);
 
-#undef BUF_SIZE
+					if (FAIL == regexp_ret)
+					{
+						*err_msg = zbx_dsprintf(*err_msg, "cannot compile regular expression");
+						ret = FAIL;
+						goto out;
 }
 
+					(*p_count)--;
+
+					if (0 != (ZBX_METRIC_FLAG_LOG_COUNT & flags) ||
+							ZBX_REGEXP_NO_MATCH == regexp_ret || SUCCEED == send_err)
+					{
+						*lastlogsize = lastlogsize1;
+					}
+				}
+				else
+				{
+					/* skip the trailing part of a long record */
+					*lastlogsize = (size_t)offset + (size_t)(p_next - buf);
+					*big_rec = 0;
+				}
+
+				/* move to the next record in the buffer */
+				p_start = p_next;
+				p = p_next;
+
+				if (NULL == (p_nl = buf_find_newline(p, &p_next, p_end, cr, lf, szbyte)))
+				{
+					/* There are no complete records in the buffer. */
+					/* Try to read more data from this position if available. */
+					if (p_end > p)
+						*incomplete = 1;
+
+					if ((zbx_offset_t)-1 == zbx_lseek(fd, *lastlogsize, SEEK_SET))
+					{
+						*err_msg = zbx_dsprintf(*err_msg, "Cannot set position to " ZBX_FS_UI64
+								" in file: %s", *lastlogsize, zbx_strerror(errno));
 						ret = FAIL;
 						goto out;
 					}
@@ -2724,8 +2749,8 @@ static void	handle_multiple_copies(struct st_logfile *logfiles, int logfiles_num
 			{
 				logfiles[j].processed_size = MIN(logfiles[i].processed_size, logfiles[j].size);
 
-				zabbix_log(LOG_LEVEL_DEBUG, "handle_multiple_copies() 文件 '%s' 处理大小："
-						ZBX_FS_UI64 " 转移至" " 文件 '%s' 处理大小：" ZBX_FS_UI64,
+				zabbix_log(LOG_LEVEL_DEBUG, "handle_multiple_copies() file '%s' processed_size:"
+						ZBX_FS_UI64 " transferred to" " file '%s' processed_size:" ZBX_FS_UI64,
 						logfiles[i].filename, logfiles[i].processed_size,
 						logfiles[j].filename, logfiles[j].processed_size);
 			}
@@ -2733,8 +2758,8 @@ static void	handle_multiple_copies(struct st_logfile *logfiles, int logfiles_num
 			{
 				logfiles[i].processed_size = MIN(logfiles[j].processed_size, logfiles[i].size);
 
-				zabbix_log(LOG_LEVEL_DEBUG, "handle_multiple_copies() 文件 '%s' 处理大小："
-						ZBX_FS_UI64 " 转移至" " 文件 '%s' 处理大小：" ZBX_FS_UI64,
+				zabbix_log(LOG_LEVEL_DEBUG, "handle_multiple_copies() file '%s' processed_size:"
+						ZBX_FS_UI64 " transferred to" " file '%s' processed_size:" ZBX_FS_UI64,
 						logfiles[j].filename, logfiles[j].processed_size,
 						logfiles[i].filename, logfiles[i].processed_size);
 			}
@@ -2748,7 +2773,8 @@ static void	handle_multiple_copies(struct st_logfile *logfiles, int logfiles_num
  *这段代码的主要目的是在存在副本的情况下，延迟更新文件的大小和时间戳。函数接收四个参数：一个文件结构体数组`logfiles`，文件数量`logfiles_num`，一个时间戳指针`mtime`和一个文件大小指针`lastlogsize`。在找到原始文件后，将更新时间戳和文件大小，并重置其他文件的序列号，以便下次从找到的原始文件开始处理。
  ******************************************************************************/
 /* 定义一个静态函数，用于延迟更新文件大小和时间戳，当存在副本时 */
-static void delay_update_if_copies(struct st_logfile *logfiles, int logfiles_num, int *mtime, zbx_uint64_t *lastlogsize)
+static void	delay_update_if_copies(struct st_logfile *logfiles, int logfiles_num, int *mtime,
+		zbx_uint64_t *lastlogsize)
 {
 	/* 定义变量，用于遍历logfiles数组 */
 	int i, idx_to_keep = logfiles_num - 1;
@@ -2812,30 +2838,24 @@ static zbx_uint64_t	max_processed_size_in_copies(const struct st_logfile *logfil
 {
 	zbx_uint64_t	max_processed = 0;
 	int		j;
-/******************************************************************************
- * /
- ******************************************************************************// 定义一个函数，用于遍历 logfiles 数组中的所有元素
+
 for (j = 0; j < logfiles_num; j++)
 {
     // 定义一个循环变量 i，用于在 logfiles 数组中遍历元素
-    for (i = 0; i < logfiles_num; i++)
-    {
         // 判断 logfiles[i] 和 logfiles[j] 是否具有相同的 MD5 值，且 i 不等于 j
         if (i != j && SUCCEED == files_start_with_same_md5(logfiles + i, logfiles + j))
         {
             /* logfiles[i] 和 logfiles[j] 是原始文件和副本（或相反）。 */
             // 判断 logfiles[j].processed_size 是否大于当前 max_processed 的值
             if (max_processed < logfiles[j].processed_size)
-            {
                 // 如果满足条件，将 max_processed 更新为 logfiles[j].processed_size
                 max_processed = logfiles[j].processed_size;
             }
         }
+	return max_processed;
     }
-}
 
 // 函数返回 max_processed 的值
-return max_processed;
 
 
 /******************************************************************************
@@ -2846,6 +2866,25 @@ return max_processed;
  * *
  *整个代码块的主要目的是计算两个进程（已处理字节数和剩余字节数）之间的延迟时间。首先判断输入参数是否合法，然后根据合法的输入参数计算延迟时间，并将结果记录到日志中。最后返回计算得到的延迟时间。
  ******************************************************************************/
+static double	calculate_delay(zbx_uint64_t processed_bytes, zbx_uint64_t remaining_bytes, double t_proc)
+{
+	double	delay = 0.0;
+
+	/* Processing time could be negative or 0 if the system clock has been set back in time. */
+	/* In this case return 0, then a jump over log lines will not take place. */
+
+	if (0 != processed_bytes && 0.0 < t_proc)
+	{
+		delay = (double)remaining_bytes * t_proc / (double)processed_bytes;
+
+		zabbix_log(LOG_LEVEL_DEBUG, "calculate_delay(): processed bytes:" ZBX_FS_UI64
+				" remaining bytes:" ZBX_FS_UI64 " t_proc:%e s speed:%e B/s remaining full checks:"
+				ZBX_FS_UI64 " delay:%e s", processed_bytes, remaining_bytes, t_proc,
+				(double)processed_bytes / t_proc, remaining_bytes / processed_bytes, delay);
+	}
+
+	return delay;
+}
 /* 定义一个名为 calculate_delay 的静态函数，用于计算延迟时间。
  * 输入参数：
  *   processed_bytes：已处理的字节数
@@ -2901,6 +2940,20 @@ static void jump_remaining_bytes_logrt(struct st_logfile *logfiles, int logfiles
 			*jumped_to = i;
 		}
 
+		if (0 == bytes_to_jump)
+			break;
+
+		if (0 != first_pass)
+		{
+			/* 'start_from' element was processed, now proceed from the beginning of file list */
+			first_pass = 0;
+			i = 0;
+			continue;
+		}
+
+		i++;
+	}
+}
 /******************************************************************************
  * 以下是对代码的详细注释：
  *
@@ -2946,7 +2999,7 @@ static int	adjust_position_after_jump(struct st_logfile *logfile, zbx_uint64_t *
 	{
 		*err_msg = zbx_dsprintf(*err_msg, "Cannot set position to " ZBX_FS_UI64 " in file \"%s\": %s",
 				lastlogsize_aligned, logfile->filename, zbx_strerror(errno));
-		goto OUT;
+		goto out;
 	}
 
 	/* 查找向前方向上的第一个换行符，直到文件末尾 */
@@ -2959,7 +3012,7 @@ static int	adjust_position_after_jump(struct st_logfile *logfile, zbx_uint64_t *
 		{
 			*err_msg = zbx_dsprintf(*err_msg, "Cannot read from file \"%s\": %s", logfile->filename,
 					zbx_strerror(errno));
-			goto OUT;
+			goto out;
 		}
 
 		if (0 == nbytes)	/* 文件结束 */
@@ -2975,7 +3028,7 @@ static int	adjust_position_after_jump(struct st_logfile *logfile, zbx_uint64_t *
 			*lastlogsize = lastlogsize_tmp + (zbx_uint64_t)(p_next - buf);
 			logfile->processed_size = *lastlogsize;
 			ret = SUCCEED;
-			goto OUT;
+			goto out;
 		}
 
 		lastlogsize_tmp += (zbx_uint64_t)nbytes;
@@ -2992,77 +3045,23 @@ static int	adjust_position_after_jump(struct st_logfile *logfile, zbx_uint64_t *
 		else
 			seek_pos = min_size;
 
-		if ((zbx_offset_t)-1 == zbx_lseek(fd, seek_pos, SEEK_SET))
-		{
-			*err_msg = zbx_dsprintf(*err_msg, "Cannot set position to " ZBX_FS_UI64 " in file \"%s\": %s",
-					lastlogsize_aligned, logfile->filename, zbx_strerror(errno));
-			goto OUT;
-		}
 
-		if (-1 == (nbytes = read(fd, buf, sizeof(buf))))
-		{
-			*err_msg = zbx_dsprintf(*err_msg, "Cannot read from file \"%s\": %s", logfile->filename,
-					zbx_strerror(errno));
-			goto OUT;
-		}
 
-		if (0 == nbytes)	/* 文件结束 */
-		{
-			*err_msg = zbx_dsprintf(*err_msg, "Unexpected end of file while reading file \"%s\"",
-					logfile->filename);
-			goto OUT;
-		}
 
-		p = buf;
-		p_end = buf + nbytes;	/* 当前位置无数据 */
 
-		if (NULL != (p_nl = buf_find_newline(p, &p_next, p_end, cr, lf, szbyte)))
-		{
 			/* 找到换行符 */
 
-			*lastlogsize = seek_pos + (zbx_uint64_t)(p_next - buf);
-			logfile->processed_size = *lastlogsize;
-			ret = SUCCEED;
-			goto OUT;
-		}
 
-		if (min_size == seek_pos)
-		{
 			/* 已经查找回溯到min_size，但未找到换行符。*/
 			/* 实际上它是一个长度为0的跳转。*/
 
-			*lastlogsize = min_size;
-			logfile->processed_size = *lastlogsize;
-			ret = SUCCEED;
-			goto OUT;
-		}
-	}
 
-OUT:
 	/* 关闭文件失败则返回失败 */
-	if (SUCCEED != close_file_helper(fd, logfile->filename, err_msg))
-		ret = FAIL;
 
 	/* 输出调试信息 */
-	if (SUCCEED == ZBX_CHECK_LOG_LEVEL(LOG_LEVEL_DEBUG))
-	{
-		const char	*dbg_msg;
 
-		if (SUCCEED == ret)
-			dbg_msg = "NEWLINE FOUND";
-		else
-			dbg_msg = "NEWLINE NOT FOUND";
 
-		zabbix_log(LOG_LEVEL_DEBUG, "adjust_position_after_jump(): szbyte:" ZBX_FS_SIZE_T " lastlogsize_org:"
-				ZBX_FS_UI64 " lastlogsize_aligned:" ZBX_FS_UI64 " (change " ZBX_FS_I64 " bytes)"
-				" lastlogsize_after:" ZBX_FS_UI64 " (change " ZBX_FS_I64 " bytes) %s %s",
-				(zbx_fs_size_t)szbyte, lastlogsize_org, lastlogsize_aligned,
-				(zbx_int64_t)lastlogsize_aligned - (zbx_int64_t)lastlogsize_org,
-				dbg_msg, ZBX_NULL2EMPTY_STR(*err_msg));
-	}
 
-	return ret;
-}
 
 		if ((zbx_offset_t)-1 == zbx_lseek(fd, seek_pos, SEEK_SET))
 		{
@@ -3200,19 +3199,27 @@ static int	jump_ahead(const char *key, struct st_logfile *logfiles, int logfiles
  *这块代码的主要目的是处理日志文件的轮换传输。首先，它计算出所有日志文件剩余的字节数。然后，遍历旧日志文件，根据一定条件更新新日志文件的处理状态和序列号。具体条件包括：日志文件在上一轮检查时已完全处理、大小不变；或未完全处理但大小增长。最后，更新新日志文件的序列号。
  ******************************************************************************/
 // 定义一个函数，用于计算剩余的字节数
-for (i = 0; i < logfiles_num; i++)
-{
+        min_size = 0;
     // 累加每个日志文件的大小减去已处理的大小，得到剩余的字节数
-    remaining_bytes += logfiles[i].size - logfiles[i].processed_size;
 }
 
-// 返回剩余的字节数
-return remaining_bytes;
+	return adjust_position_after_jump(&logfiles[jumped_to], lastlogsize, min_size, encoding, err_msg);
 }
 
-// 定义一个静态函数，用于日志文件轮换传输
-static void	transfer_for_rotate(const struct st_logfile *logfiles_old, int idx, struct st_logfile *logfiles,
-                int logfiles_num, const char *old2new, int *seq)
+static zbx_uint64_t	calculate_remaining_bytes(struct st_logfile *logfiles, int logfiles_num)
+{
+	zbx_uint64_t	remaining_bytes = 0;
+	int		i;
+
+	for (i = 0; i < logfiles_num; i++)
+		remaining_bytes += logfiles[i].size - logfiles[i].processed_size;
+// 返回剩余的字节数
+return remaining_bytes;
+}
+
+// 定义一个静态函数，用于日志文件轮换传输
+static void	transfer_for_rotate(const struct st_logfile *logfiles_old, int idx, struct st_logfile *logfiles,
+                int logfiles_num, const char *old2new, int *seq)
 {
     int	j;
 
@@ -3241,6 +3248,18 @@ static void	transfer_for_rotate(const struct st_logfile *logfiles_old, int idx,
     {
         // 判断条件：上一轮检查时日志文件因不完整的最后一记录未完全处理，但大小增长，尝试进一步处理
         if (logfiles_old[idx].size < logfiles[j].size)
+		{
+			/* The file was not fully processed because of incomplete last record but it has grown. */
+			/* Try to process it further. */
+			logfiles[j].incomplete = 0;
+		}
+		else
+			logfiles[j].incomplete = 1;
+
+		if (logfiles[j].processed_size < logfiles_old[idx].processed_size)
+			logfiles[j].processed_size = MIN(logfiles[j].size, logfiles_old[idx].processed_size);
+	}
+}
 /******************************************************************************
  * *
  *整个代码块的主要目的是实现旧日志文件和新生成日志文件之间的数据传输和处理。函数`transfer_for_copytruncate`接收旧日志文件指针、索引、新生成日志文件指针、日志文件数量、旧日志文件与新生成日志文件映射关系指针和序列号指针作为参数。根据旧日志文件的处理情况，更新新生成日志文件的处理进度和序列号。
@@ -3279,36 +3298,11 @@ static void transfer_for_copytruncate(const struct st_logfile *logfiles_old, int
 						logfiles[j].processed_size = MIN(logfiles[j].size,
 						                             logfiles_old[idx].processed_size);
 					}
-				}
-			}
-		}
-	}
 	/* 如果旧日志文件中的当前部分为不完全处理，则遍历 'old2new' 数组的每一列，更新新生成日志文件的相关信息 */
-	else if (1 == logfiles_old[idx].incomplete)
-	{
-		for (j = 0; j < logfiles_num; j++, p++)
-		{
 			/* 如果 'old2new' 数组中的当前元素是 '1' 或 '2'，说明该列数据需要处理 */
-			if ('1' == *p || '2' == *p)
-			{
 				/* 如果旧日志文件的大小小于新生成日志文件的大小，说明文件未完全处理完毕但已增长，尝试进一步处理 */
-				if (logfiles_old[idx].size < logfiles[j].size)
-				{
-					logfiles[j].incomplete = 0;
-				}
-				else
-					logfiles[j].incomplete = 1;
 
 				/* 如果旧日志文件的处理进度小于新生成日志文件的处理进度，则更新新生成日志文件的处理进度 */
-				if (logfiles[j].processed_size < logfiles_old[idx].processed_size)
-				{
-					logfiles[j].processed_size = MIN(logfiles[j].size,
-					                             logfiles_old[idx].processed_size);
-				}
-			}
-		}
-	}
-}
 
 				}
 			}
@@ -3360,8 +3354,8 @@ static void transfer_for_copytruncate(const struct st_logfile *logfiles_old, int
  *   FAIL：失败
  */
 static int update_new_list_from_old(zbx_log_rotation_options_t rotation_type, struct st_logfile *logfiles_old,
-                                   int logfiles_num_old, struct st_logfile *logfiles, int logfiles_num, int use_ino,
-                                   int *seq, int *start_idx, zbx_uint64_t *lastlogsize, char **err_msg)
+        int logfiles_num_old, struct st_logfile *logfiles, int logfiles_num, int use_ino, int *seq,
+        int *start_idx, zbx_uint64_t *lastlogsize, char **err_msg)
 {
 	char	*old2new; // 声明一个字符指针old2new，用于存储旧日志列表到新日志列表的映射关系
 	int	i, max_old_seq = 0, old_last; // 声明一个整型变量i，以及max_old_seq和old_last，用于记录已处理的最后日志文件
@@ -3370,260 +3364,747 @@ static int update_new_list_from_old(zbx_log_rotation_options_t rotation_type, st
 	                                                 logfiles, logfiles_num, use_ino, err_msg)))
 	{
 		return FAIL; // 如果创建旧日志到新日志的映射关系失败，返回FAIL
+	}
+
+	/* transfer data about fully and partially processed files from the old file list to the new list */
+	for (i = 0; i < logfiles_num_old; i++)
+	{
+		if (ZBX_LOG_ROTATION_LOGCPT == rotation_type)
+			transfer_for_copytruncate(logfiles_old, i, logfiles, logfiles_num, old2new, seq);
+		else
+			transfer_for_rotate(logfiles_old, i, logfiles, logfiles_num, old2new, seq);
+
+		/* find the last file processed (fully or partially) in the previous check */
+		if (max_old_seq < logfiles_old[i].seq)
+		{
+			max_old_seq = logfiles_old[i].seq;
+			old_last = i;
+		}
+	}
+
+	/* find the first file to continue from in the new file list */
+	if (0 < max_old_seq && -1 == (*start_idx = find_old2new(old2new, logfiles_num, old_last)))
+	{
+		/* Cannot find the successor of the last processed file from the previous check. */
+		/* Adjust 'lastlogsize' for this case. */
+		*start_idx = 0;
+		*lastlogsize = logfiles[*start_idx].processed_size;
+	}
+
+	zbx_free(old2new);
+
+	return SUCCEED;
+}
+#ifdef HAVE_SYS_INOTIFY_H
 /******************************************************************************
- * 这```
- *int\tprocess_logrt(unsigned char flags, const char *filename, zbx_uint64_t *lastlogsize, int *mtime,
- *\t\tzbx_uint64_t *lastlogsize_sent, int *mtime_sent, unsigned char *skip_old_data, int *big_rec,
- *\t\tint *use_ino, char **err_msg, struct st_logfile **logfiles_old, const int *logfiles_num_old,
- *\t\tstruct st_logfile **logfiles_new, int *logfiles_num_new, const char *encoding,
- *\t\tzbx_vector_ptr_t *regexps, const char *pattern, const char *output_template, int *p_count, int *s_count,
- *\t\tzbx_process_value_func_t process_value, const char *server, unsigned short port, const char *hostname,
- *\t\tconst char *key, int *jumped, float max_delay, double *start_time, zbx_uint64_t *processed_bytes,
- *\t\tzbx_log_rotation_options_t rotation_type)
- *{
- *\tconst char\t\t*__function_name = \"process_logrt\";
- *\tint\t\t\ti, start_idx, ret = FAIL, logfiles_num = 0, logfiles_alloc = 0, seq = 1,
- *\t\t\t\tfrom_first_file = 1, last_processed, limit_reached = 0, res;
- *\tstruct st_logfile\t*logfiles = NULL;
- *\tzbx_uint64_t\t\tprocessed_bytes_sum = 0;
- *
- *\t// 函数参数列表
- *\t// 参数说明：
- *\t// flags: 日志文件处理标志
- *\t// filename: 日志文件名
- *\t// lastlogsize: 日志文件大小
- *\t// mtime: 日志文件时间
- *\t// lastlogsize_sent: 发送到服务器的日志文件大小
- *\t// mtime_sent: 发送到服务器的日志文件时间
- *\t// skip_old_data: 是否跳过旧数据
- *\t// big_rec: 是否是大记录
- *\t// use_ino: 是否使用 inode
- *\t// err_msg: 错误信息
- *\t// logfiles_old: 旧日志文件列表
- *\t// logfiles_num_old: 旧日志文件数量
- *\t// logfiles_new: 新日志文件列表
- *\t// logfiles_num_new: 新日志文件数量
- *\t// encoding: 日志文件编码
- *\t// regexps: 正则表达式列表
- *\t// pattern: 正则表达式模式
- *\t// output_template: 输出模板
- *\t// p_count: 记录处理数量限制
- *\t// s_count: 发送到服务器的记录数量限制
- *\t// process_value: 处理值函数
- *\t// server: 服务器地址
- *\t// port: 服务器端口
- *\t// hostname: 数据来源的主机名
- *\t// key: 日志条目的键
- *\t// jumped: 是否发生跳过
- *\t// max_delay: 最大延迟时间
- *\t// start_time: 检查开始时间
- *\t// processed_bytes: 处理的字节数
- *\t// rotation_type: 日志旋转类型
- *
- *\t// 打印日志
- *\tzabbix_log(LOG_LEVEL_DEBUG, \"In %s() flags:0x%02x filename:'%s' lastlogsize:\" ZBX_FS_UI64 \" mtime:%d\",
- *\t\t\t__function_name, (unsigned int)flags, filename, *lastlogsize, *mtime);
- *
- *\t// 调整时间
- *\tadjust_mtime_to_clock(mtime);
- *
- *\t// 判断文件是否存在
- *\tif (SUCCEED != (res = make_logfile_list(flags, filename, *mtime, &logfiles, &logfiles_alloc, &logfiles_num,
- *\t\t\tuse_ino, err_msg)))
- *\t{
- *\t\t// 打印错误信息
- *\t\tif (ZBX_NO_FILE_ERROR == res)
- *\t\t{
- *\t\t\tif (1 == *skip_old_data)
- *\t\t\t{
- *\t\t\t\t*skip_old_data = 0;
- *
- *\t\t\t\tzabbix_log(LOG_LEVEL_DEBUG, \"%s(): no files, setting skip_old_data to 0\",
- *\t\t\t\t\t\t__function_name);
- *\t\t\t}
- *
- *\t\t\tif (0 != (ZBX_METRIC_FLAG_LOG_LOG & flags) || (0 != (ZBX_METRIC_FLAG_LOG_LOGRT & flags) && FAIL == res))
- *\t\t\t\tgoto out;
- *\t\t}
- *
- *\t\t// 打印错误信息
- *\t\tif (0 != (ZBX_METRIC_FLAG_LOG_LOG & flags) || (0 != (ZBX_METRIC_FLAG_LOG_LOGRT & flags) && FAIL == res))
- *\t\t\tgoto out;
- *\t}
- *
- *\t// 如果日志文件为空，直接返回成功
- *\tif (0 == logfiles_num)
- *\t{
- *\t\tret = SUCCEED;
- *\t\tgoto out;
- *\t}
- *
- *\t// 如果需要跳过旧数据，标记文件为已处理
- *\tif (1 == *skip_old_data)
- *\t{
- *\t\tstart_idx = logfiles_num - 1;
- *
- *\t\t// 标记文件为已处理（除最后一个文件）
- *\t\tfor (i = 0; i < start_idx; i++)
- *\t\t{
- *\t\t\tlogfiles[i].processed_size = logfiles[i].size;
- *\t\t\tlogfiles[i].seq = seq++;
- *\t\t}
- *\t}
- *\telse
- *\t\tstart_idx = 0;
- *
- *\t// 更新新旧日志文件列表
- *\tif (0 < *logfiles_num_old && 0 < logfiles_num && SUCCEED != update_new_list_from_old(rotation_type,
- *\t\t\t*logfiles_old, *logfiles_num_old, logfiles, logfiles_num, *use_ino, &seq, &start_idx,
- *\t\t\tlastlogsize, err_msg))
- *\t{
- *\t\tdestroy_logfile_list(&logfiles, &logfiles_alloc, &logfiles_num);
- *\t\tgoto out;
- *\t}
- *
- *\t// 打印日志
- *\tif (ZBX_LOG_ROTATION_LOGCPT == rotation_type && 1 < logfiles_num)
- *\t\tensure_order_if_mtimes_equal(*logfiles_old, logfiles, logfiles_num, *use_ino, &start_idx);
- *
- *\t// 打印日志
- *\tif (SUCCEED == ZBX_CHECK_LOG_LEVEL(LOG_LEVEL_DEBUG))
- *\t{
- *\t\tzabbix_log(LOG_LEVEL_DEBUG, \"%s() old file list:\", __function_name);
- *\t\tif (NULL != *logfiles_old)
- *\t\t\tprint_logfile_list(*logfiles_old, *logfiles_num_old);
- *\t\telse
- *\t\t\tzabbix_log(LOG_LEVEL_DEBUG, \"   file list empty\");
- *
- *\t\tzabbix_log(LOG_LEVEL_DEBUG, \"%s() new file list: (mtime:%d lastlogsize:\" ZBX_FS_UI64
- *\t\t\t\t\" start_idx:%d)\", __function_name, *mtime, *lastlogsize, start_idx);
- *\t\tif (NULL != logfiles)
- *\t\t\tprint_logfile_list(logfiles, logfiles_num);
- *\t\telse
- *\t\t\tzabbix_log(LOG_LEVEL_DEBUG, \"   file list empty\");
- *\t}
- *
- *\t// 打印日志
- *\t/* number of file last processed - start from this */
- *\tlast_processed = start_idx;
- *
- *\t// 打印日志
- *\t/* from now assume success - it could be that there is nothing to do */
- *\tret = SUCCEED;
- *
- *\t// 如果存在最大延迟时间，计算延迟并跳过
- *\tif (0.0f != max_delay)
- *\t{
- *\t\tif (0.0 != *start_time)
- *\t\t{
- *\t\t\t// 计算剩余的字节数
- *\t\t\tzbx_uint64_t\tremaining_bytes;
- *
- *\t\t\t// 如果存在剩余的字节数，计算延迟并跳过
- *\t\t\tif (0 != (remaining_bytes = calculate_remaining_bytes(logfiles, logfiles_num)))
- *\t\t\t{
- *\t\t\t\t// 计算延迟
- *\t\t\t\tdouble\tdelay;
- *
- *\t\t\t\t// 如果剩余的字节数小于最大延迟，则跳过
- *\t\t\t\tif ((double)max_delay < (delay = calculate_delay(*processed_bytes, remaining_bytes,
- *\t\t\t\t\t\tzbx_time() - *start_time)))
- *\t\t\t\t{
- *\t\t\t\t\t// 跳过
- *\t\t\t\t\tzbx_uint64_t\tbytes_to_jump;
- *
- *\t\t\t\t\t// 跳过成功，则标记跳过
- *\t\t\t\t\tif (SUCCEED == (ret = jump_ahead(key, logfiles, logfiles_num,
- *\t\t\t\t\t\t\t&last_processed, &seq, lastlogsize, mtime, encoding,
- *\t\t\t\t\t\t\tbytes_to_jump, err_msg)))
- *\t\t\t\t\t{
- *\t\t\t\t\t\t*jumped = 1;
- *\t\t\t\t\t}
- *\t\t\t\t}
- *\t\t\t}
- *\t\t}
- *
- *\t\t// 标记新的开始时间
- *\t\t*start_time = zbx_time();\t/* mark new start time for using in the next check */
- *\t}
- *
- *\t// 循环处理日志文件
- *\ti = last_processed;
- *
- *\t// 如果存在日志文件，则循环处理
- *\twhile (NULL != logfiles && i < logfiles_num)
- *\t{
- *\t\t// 如果文件大小等于已处理的大小，则处理文件
- *\t\tif (0 == logfiles[i].incomplete &&
- *\t\t\t\t(logfiles[i].size != logfiles[i].processed_size || 0 == logfiles[i].seq))
- *\t\t{
- *\t\t\t// 处理文件
- *\t\t\tret = process_log(flags, logfiles[i].filename, lastlogsize, mtime, lastlogsize_sent,
- *\t\t\t\t\tmtime_sent, skip_old_data, big_rec, &logfiles[i].incomplete, err_msg,
- *\t\t\t\t\tencoding, regexps, pattern, output_template, p_count, s_count,
- *\t\t\t\t\tprocess_value, server, port, hostname, key, &processed_bytes_tmp,
- *\t\t\t\t\tseek_offset);
- *
- *\t\t\t// 处理成功，则更新已处理的大小
- *\t\t\tlogfiles[i].processed_size = *lastlogsize;
- *
- *\t\t\t// 更新文件大小
- *\t\t\tif (*lastlogsize > logfiles[i].size)
- *\t\t\t\tlogfiles[i].size = *lastlogsize;
- *\t\t}
- *
- *\t\t// 跳过旧数据
- *\t\tif (0 != from_first_file)
- *\t\t{
- *\t\t\t// 如果已经处理到第一个文件，则跳过旧数据
- *\t\t\tfrom_first_file = 0;
- *
- *\t\t\t// 从新文件列表的第一个文件开始处理
- *\t\t\ti = 0;
- *\t\t\tcontinue;
- *\t\t}
- *
- *\t\t// 跳过文件
- *\t\ti++;
- *\t}
- *
- *\t// 更新新日志文件列表
- *\t*logfiles_num_new = logfiles_num;
- *
- *\t// 如果存在日志文件，则返回新日志文件列表
- *\tif (0 < logfiles_num)
- *\t\t*logfiles_new = logfiles;
- *
- *out:
- *\t// 如果存在最大延迟时间，则返回处理的字节数
- *\tif (0.0f != max_delay)
- *\t{
- *\t\tif (SUCCEED == ret)
- *\t\t\t*processed_bytes = processed_bytes_sum;
- *
- *\t\t// 如果处理成功，则返回处理的字节数
- *\t\tif (SUCCEED != ret || 0 == limit_reached)
- *\t\t{
- *\t\t\t/* FAIL或记录数量限制未达到。
- *\t\t\t  在此情况下，需要将start_time设置为0，以防止在下次检查中跳过。
- *\t\t\t*/
- *\t\t\t*start_time = 0.0;
- *\t\t}
- *\t}
- *
- *\t// 打印日志
- *\tzabbix_log(LOG_LEVEL_DEBUG, \"End of %s():%s\", __function_name, zbx_result_string(ret));
- *
- *\treturn ret;
- *}
- *```
- ******************************************************************************/段代码是一个名为 process_logrt 的 C 语言函数，主要目的是处理日志文件。它接受一系列参数，包括日志文件名、日志模式、日志大小、日志时间等，然后对这些日志文件进行处理。
+ *                                                                            *
+ * Log file changes are watched with inotify. A logrt[] item directory and    *
+ * the files from its last file list are watched, so the list can be updated  *
+ * from the previous one instead of listing the directory and calculating     *
+ * MD5 sums of all the files again.                                           *
+ *                                                                            *
+ * Every change increments a counter and the counter value is stored with     *
+ * the changed watch. An item stores the counter value at its last file list  *
+ * update, so any watch with a larger value means that the path has changed.  *
+ * Only files created, deleted or renamed in the directory, event queue       *
+ * overflow and the periodic rescan make the list again from scratch, other   *
+ * changed files are examined again one by one. Paths which cannot be         *
+ * watched (no more watches, network file systems) are polled as before.      *
+ *                                                                            *
+ ******************************************************************************/
+
+#define ZBX_LOGWATCH_UNAVAILABLE	-2
 
-注释部分主要是对代码中各个参数的解释，如日志文件名、日志大小、日志时间等，以及函数的主要功能，如处理日志文件、更新日志列表等。
+/* the directory watch reports changes of the directory entries, file contents are reported by file watches */
+#define ZBX_LOGWATCH_DIR_MASK	(IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF)
+#define ZBX_LOGWATCH_FILE_MASK	(IN_MODIFY | IN_ATTRIB | IN_DELETE_SELF | IN_MOVE_SELF)
 
-以下是代码的逐行注释：
+#define ZBX_LOGWATCH_RETRY	SEC_PER_MIN		/* retry period for paths which cannot be watched */
+#define ZBX_LOGWATCH_RESCAN	(5 * SEC_PER_MIN)	/* all the files are considered changed with this period */
+#define ZBX_LOGWATCH_TTL	(10 * SEC_PER_MIN)	/* watches not used for this period are removed */
+
+typedef struct
+{
+	char	*path;
+	int	wd;		/* watch descriptor, -1 if the path is not watched */
+	int	lastaccess;
+	int	nextattempt;	/* the time of the next attempt to watch the path */
+}
+zbx_logwatch_path_t;
+
+/* several paths have the same watch descriptor if they refer to the same file */
+typedef struct
+{
+	int		wd;
+	int		lastaccess;
+	zbx_uint64_t	seq;		/* the change counter value at the last change */
+}
+zbx_logwatch_t;
+
+ZBX_THREAD_LOCAL static int		logwatch_fd = -1;
+ZBX_THREAD_LOCAL static zbx_hashset_t	logwatch_paths;
+ZBX_THREAD_LOCAL static zbx_hashset_t	logwatches;
+ZBX_THREAD_LOCAL static zbx_uint64_t	logwatch_seq;		/* the change counter */
+ZBX_THREAD_LOCAL static zbx_uint64_t	logwatch_reset_seq;	/* everything has changed at this counter value */
+ZBX_THREAD_LOCAL static int		logwatch_nextrescan;
+ZBX_THREAD_LOCAL static int		logwatch_nextcleanup;
+
+static zbx_hash_t	logwatch_path_hash(const void *data)
+{
+	const zbx_logwatch_path_t	*wpath = (const zbx_logwatch_path_t *)data;
+
+	return ZBX_DEFAULT_STRING_HASH_FUNC(wpath->path);
+}
+
+static int	logwatch_path_compare(const void *d1, const void *d2)
+{
+	const zbx_logwatch_path_t	*wpath1 = (const zbx_logwatch_path_t *)d1;
+	const zbx_logwatch_path_t	*wpath2 = (const zbx_logwatch_path_t *)d2;
+
+	return strcmp(wpath1->path, wpath2->path);
+}
+
+static zbx_hash_t	logwatch_hash(const void *data)
+{
+	const zbx_logwatch_t	*watch = (const zbx_logwatch_t *)data;
+
+	return ZBX_DEFAULT_HASH_ALGO(&watch->wd, sizeof(watch->wd), ZBX_DEFAULT_HASH_SEED);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: logwatch_init                                                    *
+ *                                                                            *
+ * Purpose: initializes inotify on the first use                              *
+ *                                                                            *
+ * Return value: SUCCEED - inotify can be used                                *
+ *               FAIL    - log files must be polled                           *
+ *                                                                            *
+ ******************************************************************************/
+static int	logwatch_init(void)
+{
+	if (-1 != logwatch_fd)
+		return ZBX_LOGWATCH_UNAVAILABLE == logwatch_fd ? FAIL : SUCCEED;
+
+	if (-1 == (logwatch_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC)))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot initialize inotify, log files will be polled: %s",
+				zbx_strerror(errno));
+		logwatch_fd = ZBX_LOGWATCH_UNAVAILABLE;
+		return FAIL;
+	}
+
+	zbx_hashset_create(&logwatch_paths, 100, logwatch_path_hash, logwatch_path_compare);
+	zbx_hashset_create(&logwatches, 100, logwatch_hash, ZBX_DEFAULT_INT_COMPARE_FUNC);
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: logwatch_is_supported                                            *
+ *                                                                            *
+ * Purpose: checks if the path is on a file system where inotify reports all  *
+ *          changes                                                           *
+ *                                                                            *
+ * Comments: Network file systems do not report changes made by other hosts.  *
+ *                                                                            *
+ ******************************************************************************/
+static int	logwatch_is_supported(const char *path)
+{
+	struct statfs	buf;
+
+	if (0 != statfs(path, &buf))
+		return FAIL;
+
+	switch ((unsigned int)buf.f_type)
+	{
+		case 0x6969:		/* NFS */
+		case 0x517b:		/* SMB */
+		case 0xff534d42:	/* CIFS */
+		case 0xfe534d42:	/* SMB2 */
+		case 0x65735546:	/* FUSE */
+		case 0x00c36400:	/* Ceph */
+		case 0x01021997:	/* 9P */
+		case 0x5346414f:	/* AFS */
+			return FAIL;
+		default:
+			return SUCCEED;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: logwatch_process_events                                          *
+ *                                                                            *
+ * Purpose: reads pending inotify events and marks the watches changed        *
+ *                                                                            *
+ ******************************************************************************/
+static void	logwatch_process_events(int now)
+{
+	char			buf[16 * ZBX_KIBIBYTE], *ptr;
+	ssize_t			n;
+	struct inotify_event	event;
+	zbx_logwatch_t		*watch;
+	zbx_logwatch_path_t	*wpath;
+	zbx_hashset_iter_t	iter;
+
+	while (0 < (n = read(logwatch_fd, buf, sizeof(buf))))
+	{
+		for (ptr = buf; ptr < buf + n; ptr += sizeof(event) + event.len)
+		{
+			memcpy(&event, ptr, sizeof(event));
+
+			if (0 != (IN_Q_OVERFLOW & event.mask))
+			{
+				zabbix_log(LOG_LEVEL_DEBUG, "inotify event queue overflow, rescanning all log files");
+				logwatch_reset_seq = ++logwatch_seq;
+				continue;
+			}
+
+			if (NULL == (watch = (zbx_logwatch_t *)zbx_hashset_search(&logwatches, &event.wd)))
+				continue;
+
+			if (0 != (IN_IGNORED & event.mask))
+			{
+				zbx_hashset_remove_direct(&logwatches, watch);
+				continue;
+			}
+
+			watch->seq = ++logwatch_seq;
+
+			/* the path does not refer to the watched file anymore, it will be watched again */
+			if (0 != ((IN_DELETE_SELF | IN_MOVE_SELF) & event.mask))
+				inotify_rm_watch(logwatch_fd, event.wd);
+		}
+	}
+
+	if (-1 == n && EAGAIN != errno)
+		zabbix_log(LOG_LEVEL_DEBUG, "cannot read inotify events: %s", zbx_strerror(errno));
+
+	if (now >= logwatch_nextrescan)
+	{
+		logwatch_reset_seq = ++logwatch_seq;
+		logwatch_nextrescan = now + ZBX_LOGWATCH_RESCAN;
+	}
+
+	if (now < logwatch_nextcleanup)
+		return;
+
+	zbx_hashset_iter_reset(&logwatch_paths, &iter);
+	while (NULL != (wpath = (zbx_logwatch_path_t *)zbx_hashset_iter_next(&iter)))
+	{
+		if (wpath->lastaccess + ZBX_LOGWATCH_TTL < now)
+		{
+			zbx_free(wpath->path);
+			zbx_hashset_iter_remove(&iter);
+		}
+	}
+
+	zbx_hashset_iter_reset(&logwatches, &iter);
+	while (NULL != (watch = (zbx_logwatch_t *)zbx_hashset_iter_next(&iter)))
+	{
+		if (watch->lastaccess + ZBX_LOGWATCH_TTL < now)
+		{
+			inotify_rm_watch(logwatch_fd, watch->wd);
+			zbx_hashset_iter_remove(&iter);
+		}
+	}
+
+	logwatch_nextcleanup = now + ZBX_LOGWATCH_TTL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: logwatch_path_is_unchanged                                       *
+ *                                                                            *
+ * Purpose: checks if the path has not changed since the specified counter    *
+ *          value, starts watching the path if necessary                      *
+ *                                                                            *
+ * Parameters: path - [IN] the path                                           *
+ *             mask - [IN] the events to watch (ZBX_LOGWATCH_*_MASK)          *
+ *             seq  - [IN] the change counter value                           *
+ *             now  - [IN] the current time                                   *
+ *                                                                            *
+ * Return value: SUCCEED - the path is watched and has not changed            *
+ *               FAIL    - the path has changed or is not watched             *
+ *                                                                            *
+ ******************************************************************************/
+static int	logwatch_path_is_unchanged(const char *path, zbx_uint32_t mask, zbx_uint64_t seq, int now)
+{
+	zbx_logwatch_path_t	*wpath, wpath_local;
+	zbx_logwatch_t		*watch, watch_local;
+
+	wpath_local.path = (char *)path;
+
+	if (NULL == (wpath = (zbx_logwatch_path_t *)zbx_hashset_search(&logwatch_paths, &wpath_local)))
+	{
+		wpath_local.path = zbx_strdup(NULL, path);
+		wpath_local.wd = -1;
+		wpath_local.nextattempt = 0;
+		wpath = (zbx_logwatch_path_t *)zbx_hashset_insert(&logwatch_paths, &wpath_local, sizeof(wpath_local));
+	}
+
+	wpath->lastaccess = now;
+
+	if (-1 == wpath->wd || NULL == (watch = (zbx_logwatch_t *)zbx_hashset_search(&logwatches, &wpath->wd)))
+	{
+		if (now < wpath->nextattempt)
+			return FAIL;
+
+		if (SUCCEED != logwatch_is_supported(path) ||
+				-1 == (wpath->wd = inotify_add_watch(logwatch_fd, path, mask)))
+		{
+			zabbix_log(LOG_LEVEL_DEBUG, "cannot watch \"%s\", it will be polled: %s", path,
+					zbx_strerror(errno));
+			wpath->wd = -1;
+			wpath->nextattempt = now + ZBX_LOGWATCH_RETRY;
+			return FAIL;
+		}
+
+		if (NULL == (watch = (zbx_logwatch_t *)zbx_hashset_search(&logwatches, &wpath->wd)))
+		{
+			/* the file could have changed before it was watched */
+			watch_local.wd = wpath->wd;
+			watch_local.seq = ++logwatch_seq;
+			watch = (zbx_logwatch_t *)zbx_hashset_insert(&logwatches, &watch_local, sizeof(watch_local));
+		}
+	}
+
+	watch->lastaccess = now;
+
+	return watch->seq <= seq ? SUCCEED : FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: logwatch_check                                                   *
+ *                                                                            *
+ * Purpose: checks if the log file list of an item can be updated from the    *
+ *          previous one and which files have changed                         *
+ *                                                                            *
+ * Parameters:                                                                *
+ *     filename     - [IN] logfile name (regular expression with a path)      *
+ *     logfiles     - [IN] the log file list made in the previous check       *
+ *     logfiles_num - [IN] number of logfiles in the list                     *
+ *     watch_seq    - [IN/OUT] the change counter value at the last file list *
+ *                    update                                                  *
+ *     dirty        - [OUT] 1 for files which have changed or are not         *
+ *                    watched, 0 for unchanged files                          *
+ *                                                                            *
+ * Return value: SUCCEED - the directory entries have not changed, only the   *
+ *                         dirty files must be examined again                 *
+ *               FAIL    - the file list must be made again                   *
+ *                                                                            *
+ ******************************************************************************/
+static int	logwatch_check(const char *filename, const struct st_logfile *logfiles, int logfiles_num,
+		zbx_uint64_t *watch_seq, unsigned char *dirty)
+{
+	const char	*p;
+	char		*directory;
+	int		i, now, ret;
+
+	if (SUCCEED != logwatch_init() || NULL == (p = strrchr(filename, PATH_SEPARATOR)))
+		return FAIL;
+
+	now = (int)time(NULL);
+	logwatch_process_events(now);
+
+	ret = (*watch_seq >= logwatch_reset_seq ? SUCCEED : FAIL);
+
+	directory = zbx_strdup(NULL, filename);
+	directory[p - filename + 1] = '\0';
+
+	/* all the paths are checked to start watching them as soon as possible */
+	if (SUCCEED != logwatch_path_is_unchanged(directory, ZBX_LOGWATCH_DIR_MASK, *watch_seq, now))
+		ret = FAIL;
+
+	for (i = 0; i < logfiles_num; i++)
+	{
+		dirty[i] = (SUCCEED == logwatch_path_is_unchanged(logfiles[i].filename, ZBX_LOGWATCH_FILE_MASK,
+				*watch_seq, now) ? 0 : 1);
+	}
+
+	zbx_free(directory);
+
+	/* changes made while the new list is being made will be noticed in the next check */
+	*watch_seq = logwatch_seq;
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: update_logfile_list                                              *
+ *                                                                            *
+ * Purpose: makes a new log file list from the old one when the directory     *
+ *          entries have not changed                                          *
+ *                                                                            *
+ * Parameters:                                                                *
+ *     flags          - [IN] bit flags with item type: log, logrt, log.count  *
+ *                      or logrt.count                                        *
+ *     logfiles_old   - [IN] the log file list made in the previous check     *
+ *     logfiles_num_old - [IN] number of logfiles in the old list             *
+ *     dirty          - [IN] 1 for the old list files which have changed      *
+ *     mtime          - [IN] last modification time of the file               *
+ *     logfiles       - [OUT] pointer to the list of logfiles                 *
+ *     logfiles_alloc - [OUT] number of logfiles memory was allocated for     *
+ *     logfiles_num   - [OUT] number of inserted logfiles                     *
+ *                                                                            *
+ * Return value: SUCCEED - the list was made                                  *
+ *               FAIL    - a changed file could not be examined, the list     *
+ *                         must be made from scratch                          *
+ *                                                                            *
+ * Comments: The result is the same as make_logfile_list() would make.        *
+ *           Unchanged files keep their size, modification time and MD5 sum   *
+ *           from the old list, only the changed files are examined again.    *
+ *                                                                            *
+ ******************************************************************************/
+static int	update_logfile_list(unsigned char flags, const struct st_logfile *logfiles_old, int logfiles_num_old,
+		const unsigned char *dirty, int mtime, struct st_logfile **logfiles, int *logfiles_alloc,
+		int *logfiles_num)
+{
+	int			i;
+	struct st_logfile	*p;
+	zbx_stat_t		file_buf;
+	char			*error = NULL;
+
+	*logfiles = (struct st_logfile *)zbx_malloc(NULL, (size_t)logfiles_num_old * sizeof(struct st_logfile));
+	*logfiles_alloc = logfiles_num_old;
+	*logfiles_num = 0;
+
+	/* the old list is sorted, so the unchanged files copied in the same order stay sorted */
+	for (i = 0; i < logfiles_num_old; i++)
+	{
+		if (0 != dirty[i])
+			continue;
+
+		/* the same selection criterion as in pick_logfile() */
+		if (0 != (ZBX_METRIC_FLAG_LOG_LOGRT & flags) && mtime > logfiles_old[i].mtime)
+			continue;
+
+		p = *logfiles + (*logfiles_num)++;
+
+		*p = logfiles_old[i];
+		p->filename = zbx_strdup(NULL, logfiles_old[i].filename);
+		p->seq = 0;
+		p->retry = 0;
+		p->incomplete = 0;
+		p->copy_of = -1;
+		p->processed_size = 0;
+	}
+
+	/* the changed files are inserted at their new place, their MD5 sums are calculated below */
+	for (i = 0; i < logfiles_num_old; i++)
+	{
+		if (0 == dirty[i])
+			continue;
+
+		if (0 != zbx_stat(logfiles_old[i].filename, &file_buf) || !S_ISREG(file_buf.st_mode))
+		{
+			zabbix_log(LOG_LEVEL_DEBUG, "cannot update log file list, \"%s\" is not available",
+					logfiles_old[i].filename);
+			goto fail;
+		}
+
+		if (0 != (ZBX_METRIC_FLAG_LOG_LOGRT & flags) && mtime > file_buf.st_mtime)
+			continue;
+
+		add_logfile(logfiles, logfiles_alloc, logfiles_num, logfiles_old[i].filename, &file_buf);
+	}
+
+	if (SUCCEED != fill_file_details(logfiles, *logfiles_num, &error))
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "cannot update log file list: %s", error);
+		zbx_free(error);
+		goto fail;
+	}
+
+	return SUCCEED;
+fail:
+	destroy_logfile_list(logfiles, logfiles_alloc, logfiles_num);
+
+	return FAIL;
+}
+#endif	/* HAVE_SYS_INOTIFY_H */
+/******************************************************************************
+ *                                                                            *
+ * Function: process_logrt                                                    *
+ *                                                                            *
+ * Purpose: Find new records in logfiles                                      *
+ *                                                                            *
+ * Parameters:                                                                *
+ *     flags            - [IN] bit flags with item type: log, logrt,          *
+ *                        log.count or logrt.count                            *
+ *     filename         - [IN] logfile name (regular expression with a path)  *
+ *     lastlogsize      - [IN/OUT] offset from the beginning of the file      *
+ *     mtime            - [IN/OUT] last modification time of the file         *
+ *     lastlogsize_sent - [OUT] lastlogsize value that was last sent          *
+ *     mtime_sent       - [OUT] mtime value that was last sent                *
+ *     skip_old_data    - [IN/OUT] start from the beginning of the file or    *
+ *                        jump to the end                                     *
+ *     big_rec          - [IN/OUT] state variable to remember whether a long  *
+ *                        record is being processed                           *
+ *     use_ino          - [IN/OUT] how to use inode numbers                   *
+ *     err_msg          - [IN/OUT] error message why an item became           *
+ *                        NOTSUPPORTED                                        *
+ *     logfiles_old     - [IN/OUT] array of logfiles from the last check      *
+ *     logfiles_num_old - [IN] number of elements in "logfiles_old"           *
+ *     logfiles_new     - [OUT] new array of logfiles                         *
+ *     logfiles_num_new - [OUT] number of elements in "logfiles_new"          *
+ *     encoding         - [IN] text string describing encoding.               *
+ *                        See function find_cr_lf_szbyte() for supported      *
+ *                        encodings.                                          *
+ *                        "" (empty string) means a single-byte character set *
+ *                        (e.g. ASCII).                                       *
+ *     regexps          - [IN] array of regexps                               *
+ *     pattern          - [IN] pattern to match                               *
+ *     output_template  - [IN] output formatting template                     *
+ *     p_count          - [IN/OUT] limit of records to be processed           *
+ *     s_count          - [IN/OUT] limit of records to be sent to server      *
+ *     process_value    - [IN] pointer to function process_value()            *
+ *     server           - [IN] server to send data to                         *
+ *     port             - [IN] port to send data to                           *
+ *     hostname         - [IN] hostname the data comes from                   *
+ *     key              - [IN] item key the data belongs to                   *
+ *     jumped           - [OUT] flag to indicate that a jump took place       *
+ *     max_delay        - [IN] maximum allowed delay, s                       *
+ *     start_time       - [IN/OUT] start time of check                        *
+ *     processed_bytes  - [IN/OUT] number of bytes processed                  *
+ *     rotation_type    - [IN] simple rotation or copy/truncate rotation      *
+ *                                                                            *
+ * Return value: returns SUCCEED on successful reading,                       *
+ *               FAIL on other cases                                          *
+ *                                                                            *
+ * Author: Dmitry Borovikov (logrotation)                                     *
+ *                                                                            *
+ ******************************************************************************/
+int	process_logrt(unsigned char flags, const char *filename, zbx_uint64_t *lastlogsize, int *mtime,
+		zbx_uint64_t *lastlogsize_sent, int *mtime_sent, unsigned char *skip_old_data, int *big_rec,
+		int *use_ino, char **err_msg, struct st_logfile **logfiles_old, const int *logfiles_num_old,
+		struct st_logfile **logfiles_new, int *logfiles_num_new, const char *encoding,
+		zbx_vector_ptr_t *regexps, const char *pattern, const char *output_template, int *p_count, int *s_count,
+		zbx_process_value_func_t process_value, const char *server, unsigned short port, const char *hostname,
+		const char *key, int *jumped, float max_delay, double *start_time, zbx_uint64_t *processed_bytes,
+		zbx_log_rotation_options_t rotation_type, zbx_uint64_t *watch_seq)
+{
+	const char		*__function_name = "process_logrt";
+	int			i, start_idx, ret = FAIL, logfiles_num = 0, logfiles_alloc = 0, seq = 1,
+				from_first_file = 1, last_processed, limit_reached = 0, res = SUCCEED;
+	struct st_logfile	*logfiles = NULL;
+	zbx_uint64_t		processed_bytes_sum = 0;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() flags:0x%02x filename:'%s' lastlogsize:" ZBX_FS_UI64 " mtime:%d",
+			__function_name, (unsigned int)flags, filename, *lastlogsize, *mtime);
+
+	adjust_mtime_to_clock(mtime);
+
+#ifdef HAVE_SYS_INOTIFY_H
+	/* copy-truncate rotation keeps extra state about copies, always examine the files for it */
+	if (0 < *logfiles_num_old && 0 == *skip_old_data && ZBX_LOG_ROTATION_LOGCPT != rotation_type)
+	{
+		unsigned char	*dirty;
+
+		dirty = (unsigned char *)zbx_malloc(NULL, (size_t)*logfiles_num_old);
+
+		if (SUCCEED == logwatch_check(filename, *logfiles_old, *logfiles_num_old, watch_seq, dirty) &&
+				SUCCEED == update_logfile_list(flags, *logfiles_old, *logfiles_num_old, dirty, *mtime,
+				&logfiles, &logfiles_alloc, &logfiles_num))
+		{
+			if (0 != logfiles_num)
+				zabbix_log(LOG_LEVEL_DEBUG, "%s(): log file list updated from the old one", __function_name);
+			else
+				destroy_logfile_list(&logfiles, &logfiles_alloc, &logfiles_num);
+		}
+
+		zbx_free(dirty);
+	}
+#endif
+	if (0 == logfiles_num && SUCCEED != (res = make_logfile_list(flags, filename, *mtime, &logfiles,
+			&logfiles_alloc, &logfiles_num, use_ino, err_msg)))
+	{
+		/* do not reuse the file list which could not be made */
+		*watch_seq = 0;
+		if (ZBX_NO_FILE_ERROR == res)
+		{
+			if (1 == *skip_old_data)
+			{
+				*skip_old_data = 0;
+
+				zabbix_log(LOG_LEVEL_DEBUG, "%s(): no files, setting skip_old_data to 0",
+						__function_name);
+			}
+
+			if (0 != (ZBX_METRIC_FLAG_LOG_LOGRT & flags) && 0 == *logfiles_num_old)
+			{
+				/* Both the old and the new log file lists are empty. That means the agent has not */
+				/* seen any log files for this logrt[] item since started. If log files appear later */
+				/* then analyze them from start, do not apply the 'lastlogsize' received from server */
+				/* anymore. */
+
+				*lastlogsize = 0;
+			}
+		}
+
+		/* file was not accessible for a log[] or log.count[] item or an error occurred */
+		if (0 != (ZBX_METRIC_FLAG_LOG_LOG & flags) || (0 != (ZBX_METRIC_FLAG_LOG_LOGRT & flags) && FAIL == res))
+			goto out;
+	}
+
+	if (0 == logfiles_num)
+	{
+		/* there were no files for a logrt[] or logrt.count[] item to analyze */
+		ret = SUCCEED;
+		goto out;
+	}
+
+	if (1 == *skip_old_data)
+	{
+		start_idx = logfiles_num - 1;
+
+		/* mark files to be skipped as processed (except the last one) */
+		for (i = 0; i < start_idx; i++)
+		{
+			logfiles[i].processed_size = logfiles[i].size;
+			logfiles[i].seq = seq++;
+		}
+	}
+	else
+		start_idx = 0;
+
+	if (0 < *logfiles_num_old && 0 < logfiles_num && SUCCEED != update_new_list_from_old(rotation_type,
+			*logfiles_old, *logfiles_num_old, logfiles, logfiles_num, *use_ino, &seq, &start_idx,
+			lastlogsize, err_msg))
+	{
+		destroy_logfile_list(&logfiles, &logfiles_alloc, &logfiles_num);
+		goto out;
+	}
+
+	if (ZBX_LOG_ROTATION_LOGCPT == rotation_type && 1 < logfiles_num)
+		ensure_order_if_mtimes_equal(*logfiles_old, logfiles, logfiles_num, *use_ino, &start_idx);
+
+	if (SUCCEED == ZBX_CHECK_LOG_LEVEL(LOG_LEVEL_DEBUG))
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "%s() old file list:", __function_name);
+		if (NULL != *logfiles_old)
+			print_logfile_list(*logfiles_old, *logfiles_num_old);
+		else
+			zabbix_log(LOG_LEVEL_DEBUG, "   file list empty");
+
+		zabbix_log(LOG_LEVEL_DEBUG, "%s() new file list: (mtime:%d lastlogsize:" ZBX_FS_UI64
+				" start_idx:%d)", __function_name, *mtime, *lastlogsize, start_idx);
+		if (NULL != logfiles)
+			print_logfile_list(logfiles, logfiles_num);
+		else
+			zabbix_log(LOG_LEVEL_DEBUG, "   file list empty");
+	}
+
+	/* number of file last processed - start from this */
+	last_processed = start_idx;
+
+	/* from now assume success - it could be that there is nothing to do */
+	ret = SUCCEED;
+
+	if (0.0f != max_delay)
+	{
+		if (0.0 != *start_time)
+		{
+			zbx_uint64_t	remaining_bytes;
+
+			if (0 != (remaining_bytes = calculate_remaining_bytes(logfiles, logfiles_num)))
+			{
+				/* calculate delay and jump if necessary */
+
+				double	delay;
+
+				if ((double)max_delay < (delay = calculate_delay(*processed_bytes, remaining_bytes,
+						zbx_time() - *start_time)))
+				{
+					zbx_uint64_t	bytes_to_jump;
+
+					bytes_to_jump = (zbx_uint64_t)((double)remaining_bytes *
+							(delay - (double)max_delay) / delay);
+
+					if (SUCCEED == (ret = jump_ahead(key, logfiles, logfiles_num,
+							&last_processed, &seq, lastlogsize, mtime, encoding,
+							bytes_to_jump, err_msg)))
+					{
+						*jumped = 1;
+					}
+				}
+			}
+		}
+
+		*start_time = zbx_time();	/* mark new start time for using in the next check */
+	}
+
+	/* enter the loop with index of the first file to be processed, later continue the loop from the start */
+	i = last_processed;
+
+	while (NULL != logfiles && i < logfiles_num)
+	{
+		if (0 == logfiles[i].incomplete &&
+				(logfiles[i].size != logfiles[i].processed_size || 0 == logfiles[i].seq))
+		{
+			zbx_uint64_t	processed_bytes_tmp = 0, seek_offset;
+			int		process_this_file = 1;
+
+			*mtime = logfiles[i].mtime;
+
+			if (start_idx != i)
+				*lastlogsize = logfiles[i].processed_size;
+
+			if (0 == *skip_old_data)
+			{
+				seek_offset = *lastlogsize;
+			}
+			else
+			{
+				seek_offset = logfiles[i].size;
+
+				zabbix_log(LOG_LEVEL_DEBUG, "skipping old data in filename:'%s' to seek_offset:"
+						ZBX_FS_UI64, logfiles[i].filename, seek_offset);
+			}
+
+			if (ZBX_LOG_ROTATION_LOGCPT == rotation_type)
+			{
+				zbx_uint64_t	max_processed;
+
+				if (seek_offset < (max_processed = max_processed_size_in_copies(logfiles, logfiles_num,
+						i)))
+				{
+					logfiles[i].processed_size = MIN(logfiles[i].size, max_processed);
+
+					if (logfiles[i].size == logfiles[i].processed_size)
+						process_this_file = 0;
+
+					*lastlogsize = max_processed;
+				}
+			}
+
+			if (0 != process_this_file)
+			{
+				ret = process_log(flags, logfiles[i].filename, lastlogsize, mtime, lastlogsize_sent,
+						mtime_sent, skip_old_data, big_rec, &logfiles[i].incomplete, err_msg,
+						encoding, regexps, pattern, output_template, p_count, s_count,
+						process_value, server, port, hostname, key, &processed_bytes_tmp,
+						seek_offset);
+
+				/* process_log() advances 'lastlogsize' only on success therefore */
+				/* we do not check for errors here */
+				logfiles[i].processed_size = *lastlogsize;
+
+				/* log file could grow during processing, update size in our list */
+				if (*lastlogsize > logfiles[i].size)
+					logfiles[i].size = *lastlogsize;
+			}
 
+			/* Mark file as processed (at least partially). In case if process_log() failed we will stop */
+			/* the current checking. In the next check the file will be marked in the list of old files */
+			/* and we will know where we left off. */
+			logfiles[i].seq = seq++;
 
+			if (ZBX_LOG_ROTATION_LOGCPT == rotation_type && 1 < logfiles_num)
 			{
 				int	k;
 
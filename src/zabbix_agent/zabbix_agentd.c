@@ -43,6 +43,10 @@ int	CONFIG_LOG_LEVEL		= LOG_LEVEL_WARNING;
 
 int	CONFIG_BUFFER_SIZE		= 100;
 int	CONFIG_BUFFER_SEND		= 5;
+#if !defined(_WINDOWS)
+char		*CONFIG_BUFFER_FILE		= NULL;
+zbx_uint64_t	CONFIG_BUFFER_FILE_SIZE		= 16 * ZBX_MEBIBYTE;
+#endif
 
 int	CONFIG_MAX_LINES_PER_SECOND	= 20;
 
@@ -323,6 +327,16 @@ int get_process_info_by_thread(int local_server_num, unsigned char *local_proces
 		*local_process_type = ZBX_PROCESS_TYPE_LISTENER;
 		*local_process_num = local_server_num - server_count + CONFIG_PASSIVE_FORKS;
 	}
+	else if (local_server_num <= (server_count += CONFIG_ACTIVE_FORKS))
+	{
+		*local_process_type = ZBX_PROCESS_TYPE_ACTIVE_CHECKS;
+		*local_process_num = local_server_num - server_count + CONFIG_ACTIVE_FORKS;
+	}
+	else
+		return FAIL;
+
+	return SUCCEED;
+}
 /******************************************************************************
  * 以下是对代码的详细注释：
  *
@@ -422,6 +436,31 @@ static int	parse_commandline(int argc, char **argv, ZBX_TASK_EX *t)
 		}
 	}
 
+#ifdef _WINDOWS
+	switch (t->task)
+	{
+		case ZBX_TASK_START:
+			break;
+		case ZBX_TASK_INSTALL_SERVICE:
+		case ZBX_TASK_UNINSTALL_SERVICE:
+		case ZBX_TASK_START_SERVICE:
+		case ZBX_TASK_STOP_SERVICE:
+			if (0 != (t->flags & ZBX_TASK_FLAG_FOREGROUND))
+			{
+				zbx_error("foreground option cannot be used with Zabbix agent services");
+				ret = FAIL;
+				goto out;
+			}
+			break;
+		default:
+			if (0 != (t->flags & ZBX_TASK_FLAG_MULTIPLE_AGENTS))
+			{
+				zbx_error("multiple agents option can be used only with Zabbix agent services");
+				ret = FAIL;
+				goto out;
+			}
+	}
+#endif
 	/* 检查选项是否合法 */
 	for (i = 0; NULL != longopts[i].name; i++)
 	{
@@ -433,37 +472,90 @@ static int	parse_commandline(int argc, char **argv, ZBX_TASK_EX *t)
 		if (1 < opt_count[(unsigned char)ch])
 		{
 			if (NULL == strchr(shortopts, ch))
-				zbx_error("option \"-%c\" or \"--%s\" specified multiple times", ch, longopts[i].name);
+				zbx_error("option \"--%s\" specified multiple times", longopts[i].name);
 			else
 				zbx_error("option \"-%c\" or \"--%s\" specified multiple times", ch, longopts[i].name);
 
 			ret = FAIL;
-			goto out;
 		}
 	}
 
+	if (FAIL == ret)
+		goto out;
+
+#ifdef _WINDOWS
+	/* check for mutually exclusive options */
+	/* Allowed option combinations.		*/
+	/* Option 'c' is always optional.	*/
+	/*   p  t  i  d  s  x  m    opt_mask	*/
+	/* ---------------------    --------	*/
+	/*   -  -  -  -  -  -  - 	0x00	*/
+	/*   p  -  -  -  -  -  -	0x40	*/
+	/*   -  t  -  -  -  -  -	0x20	*/
+	/*   -  -  i  -  -  -  -	0x10	*/
+	/*   -  -  -  d  -  -  -	0x08	*/
+	/*   -  -  -  -  s  -  -	0x04	*/
+	/*   -  -  -  -  -  x  -	0x02	*/
+	/*   -  -  i  -  -  -  m	0x11	*/
+	/*   -  -  -  d  -  -  m	0x09	*/
+	/*   -  -  -  -  s  -  m	0x05	*/
+	/*   -  -  -  -  -  x  m	0x03	*/
+	/*   -  -  -  -  -  -  m	0x01 special case required for starting as a service with '-m' option */
+
+	if (0 < opt_count['p'])
+		opt_mask |= 0x40;
+	if (0 < opt_count['t'])
+		opt_mask |= 0x20;
+	if (0 < opt_count['i'])
+		opt_mask |= 0x10;
+	if (0 < opt_count['d'])
+		opt_mask |= 0x08;
+	if (0 < opt_count['s'])
+		opt_mask |= 0x04;
+	if (0 < opt_count['x'])
+		opt_mask |= 0x02;
+	if (0 < opt_count['m'])
+		opt_mask |= 0x01;
+
+	switch (opt_mask)
+	{
+		case 0x00:
+		case 0x01:
+		case 0x02:
+		case 0x03:
+		case 0x04:
+		case 0x05:
+		case 0x08:
+		case 0x09:
+		case 0x10:
+		case 0x11:
+		case 0x20:
+		case 0x40:
+			break;
+		default:
+			zbx_error("mutually exclusive options used");
+			usage();
+			ret = FAIL;
+			goto out;
+	}
+#else
+	/* check for mutually exclusive options */
+	if (1 < opt_count['p'] + opt_count['t'] + opt_count['R'])
+	{
+		zbx_error("only one of options \"-p\" or \"--print\", \"-t\" or \"--test\","
+				" \"-R\" or \"--runtime-control\" can be used");
+		ret = FAIL;
+		goto out;
+	}
+#endif
 	/* 检查是否有未处理的参数 */
 	if (argc > zbx_optind)
 	{
 		for (i = zbx_optind; i < argc; i++)
-			zbx_error("invalid parameter \"%s\"", argv[i]);
 
-		ret = FAIL;
-		goto out;
-	}
 
-	if (NULL == CONFIG_FILE)
-		CONFIG_FILE = zbx_strdup(NULL, DEFAULT_CONFIG_FILE);
 
-	out:
-	if (FAIL == ret)
-	{
-		zbx_free(TEST_METRIC);
-		zbx_free(CONFIG_FILE);
-	}
 
-	return ret;
-}
 
 			zbx_error("invalid parameter \"%s\"", argv[i]);
 
@@ -616,30 +708,13 @@ static void	zbx_validate_config(ZBX_TASK_EX *task)
  *如果发现任何一项配置不合法，代码会输出错误日志，并将错误标志 `err` 加 1。最后，如果 `err` 不为 0，程序将退出，返回错误退出码。
  ******************************************************************************/
 /* 定义静态函数 zbx_validate_config，传入参数为 ZBX_TASK_EX 类型的指针 */
-static void zbx_validate_config(ZBX_TASK_EX *task)
-{
 	/* 声明字符指针变量 ch_error 和整型变量 err，并初始化 err 为 0 */
-	char *ch_error;
-	int err = 0;
 
 	/* 判断 CONFIG_PASSIVE_FORKS 是否不为 0，若不为 0，则执行以下代码：
 	 * 判断 CONFIG_HOSTS_ALLOWED 是否为 NULL，若为 NULL，则输出错误日志，err 加 1
 	 * 调用 zbx_validate_peer_list 函数验证 peer_list 配置是否合法，若验证失败，则输出错误日志，
 	 * 释放 ch_error 内存，err 加 1 */
-	if (0 != CONFIG_PASSIVE_FORKS)
-	{
-		if (NULL == CONFIG_HOSTS_ALLOWED)
-		{
-			zabbix_log(LOG_LEVEL_CRIT, "StartAgents is not 0, parameter \"Server\" must be defined");
-			err = 1;
 		}
-		else if (SUCCEED != zbx_validate_peer_list(CONFIG_HOSTS_ALLOWED, &ch_error))
-		{
-			zabbix_log(LOG_LEVEL_CRIT, "invalid entry in \"Server\" configuration parameter: %s", ch_error);
-			zbx_free(ch_error);
-			err = 1;
-		}
-	}
 
 	/* 判断 CONFIG_HOSTNAME 是否为 NULL，若为 NULL，则输出错误日志，err 加 1
 	 * 调用 zbx_check_hostname 函数验证 hostname 配置是否合法，若验证失败，则输出错误日志，
@@ -701,7 +776,7 @@ static void zbx_validate_config(ZBX_TASK_EX *task)
 #endif
 
 	/* 检查 GnuTLS 或 OpenSSL 相关配置，若不符合要求，则输出错误日志，err 加 1 */
-#if !defined(HAVE_GNUTLS) || !defined(HAVE_OPENSSL)
+#if !(defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL))
 	err |= (FAIL == check_cfg_feature_str("TLSCipherCert", CONFIG_TLS_CIPHER_CERT, "GnuTLS or OpenSSL"));
 	err |= (FAIL == check_cfg_feature_str("TLSCipherPSK", CONFIG_TLS_CIPHER_PSK, "GnuTLS or OpenSSL"));
 	err |= (FAIL == check_cfg_feature_str("TLSCipherAll", CONFIG_TLS_CIPHER_ALL, "GnuTLS or OpenSSL"));
@@ -719,7 +794,15 @@ static void zbx_validate_config(ZBX_TASK_EX *task)
 		exit(EXIT_FAILURE);
 }
 
+static int	add_activechk_host(const char *host, unsigned short port)
+{
+	int	i;
 
+	for (i = 0; i < CONFIG_ACTIVE_FORKS; i++)
+	{
+		if (0 == strcmp(CONFIG_ACTIVE_ARGS[i].host, host) && CONFIG_ACTIVE_ARGS[i].port == port)
+			return FAIL;
+	}
 	// 如果循环结束后，未找到相同的主机和端口，则进行以下操作：
 	CONFIG_ACTIVE_FORKS++;
 	// 重新分配 CONFIG_ACTIVE_ARGS 内存空间，使其能容纳新的参数
@@ -741,6 +824,49 @@ static void zbx_validate_config(ZBX_TASK_EX *task)
  * Purpose: parse string like IP<:port>,[IPv6]<:port>                         *
  *                                                                            *
  ******************************************************************************/
+static void	get_serveractive_hosts(char *active_hosts)
+{
+	char	*l = active_hosts, *r;
+	int	rc = SUCCEED;
+
+	do
+	{
+		char		*host = NULL;
+		unsigned short	port;
+
+		if (NULL != (r = strchr(l, ',')))
+			*r = '\0';
+
+		if (SUCCEED != parse_serveractive_element(l, &host, &port, (unsigned short)ZBX_DEFAULT_SERVER_PORT))
+			goto fail;
+
+		rc = add_activechk_host(host, port);
+
+		zbx_free(host);
+
+		if (SUCCEED != rc)
+			goto fail;
+
+		if (NULL != r)
+		{
+			*r = ',';
+			l = r + 1;
+		}
+	}
+	while (NULL != r);
+
+	return;
+fail:
+	if (SUCCEED != rc)
+		zbx_error("error parsing a \"ServerActive\" option: address \"%s\" specified more than once", l);
+	else
+		zbx_error("error parsing a \"ServerActive\" option: address \"%s\" is invalid", l);
+
+	if (NULL != r)
+		*r = ',';
+
+	exit(EXIT_FAILURE);
+}
 /******************************************************************************
  * 
  ******************************************************************************/
@@ -766,6 +892,7 @@ static void zbx_validate_config(ZBX_TASK_EX *task)
  ******************************************************************************/
 static void zbx_load_config(int requirement, ZBX_TASK_EX *task)
 {
+	static char	*active_hosts;
     // 定义配置项结构体数组
     struct cfg_line cfg[] =
     {
@@ -795,6 +922,10 @@ static void zbx_load_config(int requirement, ZBX_TASK_EX *task)
             PARM_OPT, 1, SEC_PER_HOUR},
         // 配置项9：PidFile
 #ifndef _WINDOWS
+		{"BufferFile",			&CONFIG_BUFFER_FILE,			TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"BufferFileSize",		&CONFIG_BUFFER_FILE_SIZE,		TYPE_UINT64,
+			PARM_OPT,	128 * ZBX_KIBIBYTE,	ZBX_GIBIBYTE},
         {"PidFile", &CONFIG_PID_FILE, TYPE_STRING,
             PARM_OPT, 0, 0},
 #endif
@@ -859,6 +990,13 @@ static void zbx_load_config(int requirement, ZBX_TASK_EX *task)
         // 配置项29：User
         {"User", &CONFIG_USER, TYPE_STRING,
             PARM_OPT, 0, 0},
+#endif
+#ifdef _WINDOWS
+		{"PerfCounter",			&CONFIG_PERF_COUNTERS,			TYPE_MULTISTRING,
+			PARM_OPT,	0,			0},
+		{"PerfCounterEn",		&CONFIG_PERF_COUNTERS_EN,		TYPE_MULTISTRING,
+			PARM_OPT,	0,			0},
+#endif
         // 配置项30：TLSConnect
         {"TLSConnect", &CONFIG_TLS_CONNECT, TYPE_STRING,
             PARM_OPT, 0, 0},
@@ -932,12 +1070,20 @@ static void zbx_load_config(int requirement, ZBX_TASK_EX *task)
 
     // 如果有配置项active_hosts，则加载活跃主机
     if (NULL != active_hosts && '\0' != *active_hosts)
+		get_serveractive_hosts(active_hosts);
+
+	zbx_free(active_hosts);
+
+	if (ZBX_CFG_FILE_REQUIRED == requirement)
     {
-        get_serveractive_hosts(active_hosts);
+        zbx_validate_config(task);
+#if defined(HAVE_POLARSSL) || defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
+        zbx_tls_validate_config();
+#endif
+    }
     }
 
     // 释放active_hosts内存
-    zbx_free(active_hosts);
 /******************************************************************************
  * *
  *这个代码块主要是启动 Zabbix 代理服务，包括以下步骤：
@@ -954,6 +1100,46 @@ static void zbx_load_config(int requirement, ZBX_TASK_EX *task)
  *
  *整个代码块的目的是启动 Zabbix 代理服务，并确保其正常运行。
  ******************************************************************************/
+static void	zbx_free_config(void)
+{
+	zbx_strarr_free(CONFIG_ALIASES);
+	zbx_strarr_free(CONFIG_USER_PARAMETERS);
+#ifndef _WINDOWS
+	zbx_strarr_free(CONFIG_LOAD_MODULE);
+#endif
+#ifdef _WINDOWS
+	zbx_strarr_free(CONFIG_PERF_COUNTERS);
+	zbx_strarr_free(CONFIG_PERF_COUNTERS_EN);
+#endif
+}
+
+#ifdef _WINDOWS
+static int	zbx_exec_service_task(const char *name, const ZBX_TASK_EX *t)
+{
+	int	ret;
+
+	switch (t->task)
+	{
+		case ZBX_TASK_INSTALL_SERVICE:
+			ret = ZabbixCreateService(name, t->flags & ZBX_TASK_FLAG_MULTIPLE_AGENTS);
+			break;
+		case ZBX_TASK_UNINSTALL_SERVICE:
+			ret = ZabbixRemoveService();
+			break;
+		case ZBX_TASK_START_SERVICE:
+			ret = ZabbixStartService();
+			break;
+		case ZBX_TASK_STOP_SERVICE:
+			ret = ZabbixStopService();
+			break;
+		default:
+			/* there can not be other choice */
+			assert(0);
+	}
+
+	return ret;
+}
+#endif	/* _WINDOWS */
 int MAIN_ZABBIX_ENTRY(int flags)
 {
 	// 定义变量
@@ -968,182 +1154,59 @@ int MAIN_ZABBIX_ENTRY(int flags)
 	if (0 != (flags & ZBX_TASK_FLAG_FOREGROUND))
 	{
 		// 输出启动信息
-		printf("Starting Zabbix Agent [%s]. Zabbix %s (revision %s).\
-Press Ctrl+C to exit.\
-\
-",
+		printf("Starting Zabbix Agent [%s]. Zabbix %s (revision %s).\nPress Ctrl+C to exit.\n\n",
 				CONFIG_HOSTNAME, ZABBIX_VERSION, ZABBIX_REVISION);
 	}
 #ifndef _WINDOWS
 	if (SUCCEED != zbx_locks_create(&error))
 	{
 		zbx_error("cannot create locks: %s", error);
-		zbx_free(error);
-		exit(EXIT_FAILURE);
-	}
-#endif
-	if (SUCCEED != zabbix_open_log(CONFIG_LOG_TYPE, CONFIG_LOG_LEVEL, CONFIG_LOG_FILE, &error))
-	{
-		zbx_error("cannot open log: %s", error);
-		zbx_free(error);
-		exit(EXIT_FAILURE);
-	}
 
 	// 打印 enabled features
-	zabbix_log(LOG_LEVEL_INFORMATION, "**** Enabled features ****");
-	zabbix_log(LOG_LEVEL_INFORMATION, "IPv6 support:          " IPV6_FEATURE_STATUS);
-	zabbix_log(LOG_LEVEL_INFORMATION, "TLS support:           " TLS_FEATURE_STATUS);
-	zabbix_log(LOG_LEVEL_INFORMATION, "**************************");
 
 	// 输出配置文件信息
-	zabbix_log(LOG_LEVEL_INFORMATION, "using configuration file: %s", CONFIG_FILE);
 
 	// 检查并禁用核心转储
-	if (SUCCEED != zbx_coredump_disable())
-	{
-		zabbix_log(LOG_LEVEL_CRIT, "cannot disable core dump, exiting...");
-		zbx_free_service_resources(FAIL);
-		exit(EXIT_FAILURE);
-	}
 
 	// 加载模块
-	if (FAIL == zbx_load_modules(CONFIG_LOAD_MODULE_PATH, CONFIG_LOAD_MODULE, CONFIG_TIMEOUT, 1))
-	{
-		zabbix_log(LOG_LEVEL_CRIT, "loading modules failed, exiting...");
-		zbx_free_service_resources(FAIL);
-		exit(EXIT_FAILURE);
-	}
 
 	// 初始化收集器
-	if (SUCCEED != init_collector_data(&error))
-	{
-		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize collector: %s", error);
-		zbx_free(error);
-		zbx_free_service_resources(FAIL);
-		exit(EXIT_FAILURE);
-	}
 
 	// 初始化性能计数器收集器
-#ifdef _WINDOWS
-	if (SUCCEED != init_perf_collector(ZBX_MULTI_THREADED, &error))
-	{
-		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize performance counter collector: %s", error);
-		zbx_free(error);
-		zbx_free_service_resources(FAIL);
-		exit(EXIT_FAILURE);
-	}
 
 	// 加载性能计数器
-	load_perf_counters(CONFIG_PERF_COUNTERS, CONFIG_PERF_COUNTERS_EN);
-#endif
 
 	// 释放资源
-	zbx_free_config();
 
 	// 初始化TLS
-	if (ZBX_IS_TLS())
-	{
-		zbx_tls_init_parent();
-	}
 
 	// 启动线程
 	/* 分配内存用于收集器、监听器和活动检查线程 */
-	threads_num = CONFIG_COLLECTOR_FORKS + CONFIG_PASSIVE_FORKS + CONFIG_ACTIVE_FORKS;
 
-#ifdef _WINDOWS
-	if (MAXIMUM_WAIT_OBJECTS < threads_num)
-	{
-		zabbix_log(LOG_LEVEL_CRIT, "Too many agent threads. Please reduce the StartAgents configuration"
-				" parameter or the number of active servers in ServerActive configuration parameter.");
-		zbx_free_service_resources(FAIL);
-		exit(EXIT_FAILURE);
-	}
-#endif
 
-	threads = (ZBX_THREAD_HANDLE *)zbx_calloc(threads, threads_num, sizeof(ZBX_THREAD_HANDLE));
-	threads_flags = (int *)zbx_calloc(threads_flags, threads_num, sizeof(int));
 
 	// 启动线程
-	for (i = 0; i < threads_num; i++)
-	{
-		zbx_thread_args_t	*thread_args;
 
-		thread_args = (zbx_thread_args_t *)zbx_malloc(NULL, sizeof(zbx_thread_args_t));
 
-		if (FAIL == get_process_info_by_thread(i + 1, &thread_args->process_type, &thread_args->process_num))
-		{
-			THIS_SHOULD_NEVER_HAPPEN;
-			exit(EXIT_FAILURE);
-		}
 
-		thread_args->server_num = i + 1;
-		thread_args->args = NULL;
 
-		switch (thread_args->process_type)
-		{
-			case ZBX_PROCESS_TYPE_COLLECTOR:
-				zbx_thread_start(collector_thread, thread_args, &threads[i]);
-				break;
-			case ZBX_PROCESS_TYPE_LISTENER:
-				thread_args->args = &listen_sock;
-				zbx_thread_start(listener_thread, thread_args, &threads[i]);
-				break;
-			case ZBX_PROCESS_TYPE_ACTIVE_CHECKS:
-				thread_args->args = &CONFIG_ACTIVE_ARGS[j++];
-				zbx_thread_start(active_checks_thread, thread_args, &threads[i]);
-				break;
-		}
-#ifndef _WINDOWS
-		zbx_free(thread_args);
-#endif
-	}
 
-#ifdef _WINDOWS
-	set_parent_signal_handler();	/* must be called after all threads are created */
 
 	/* wait for an exiting thread */
-	res = WaitForMultipleObjectsEx(threads_num, threads, FALSE, INFINITE, FALSE);
 
-	if (ZBX_IS_RUNNING())
-	{
 		/* Zabbix agent service should either be stopped by the user in ServiceCtrlHandler() or */
 		/* crash. If some thread has terminated normally, it means something is terribly wrong. */
 
-		zabbix_log(LOG_LEVEL_CRIT, "One thread has terminated unexpectedly (code:%lu). Exiting ...", res);
-		THIS_SHOULD_NEVER_HAPPEN;
 
 		/* notify other threads and allow them to terminate */
-		ZBX_DO_EXIT();
-		zbx_sleep(1);
-	}
-	else
-	{
-		zbx_tcp_close(&listen_sock);
 
 		/* Wait for the service worker thread to terminate us. Listener threads may not exit up to */
 		/* CONFIG_TIMEOUT seconds if they're waiting for external processes to finish / timeout */
-		zbx_sleep(CONFIG_TIMEOUT);
 
-		THIS_SHOULD_NEVER_HAPPEN;
-	}
-#else
-	while (-1 == wait(&i))	/* wait for any child to exit */
-	{
-		if (EINTR != errno)
-		{
-			zabbix_log(LOG_LEVEL_ERR, "failed to wait on child processes: %s", zbx_strerror(errno));
-			break;
-		}
-	}
 
 	/* all exiting child processes should be caught by signal handlers */
-	THIS_SHOULD_NEVER_HAPPEN;
-#endif
 
-	zbx_on_exit(SUCCEED);
 
-	return SUCCEED;
-}
 
 		zbx_free(error);
 		exit(EXIT_FAILURE);
@@ -1293,6 +1356,36 @@ Press Ctrl+C to exit.\
 
 		zabbix_log(LOG_LEVEL_CRIT, "One thread has terminated unexpectedly (code:%lu). Exiting ...", res);
 		THIS_SHOULD_NEVER_HAPPEN;
+		ZBX_DO_EXIT();
+		zbx_sleep(1);
+	}
+	else
+	{
+		zbx_tcp_close(&listen_sock);
+
+		/* Wait for the service worker thread to terminate us. Listener threads may not exit up to */
+		/* CONFIG_TIMEOUT seconds if they're waiting for external processes to finish / timeout */
+		zbx_sleep(CONFIG_TIMEOUT);
+
+		THIS_SHOULD_NEVER_HAPPEN;
+	}
+#else
+	while (-1 == wait(&i))	/* wait for any child to exit */
+	{
+		if (EINTR != errno)
+		{
+			zabbix_log(LOG_LEVEL_ERR, "failed to wait on child processes: %s", zbx_strerror(errno));
+			break;
+		}
+	}
+
+	/* all exiting child processes should be caught by signal handlers */
+	THIS_SHOULD_NEVER_HAPPEN;
+#endif
+	zbx_on_exit(SUCCEED);
+
+	return SUCCEED;
+}
 /******************************************************************************
  * *
  *这是一个C语言程序的主函数，主要功能是接收命令行参数，根据不同的任务类型进行相应的处理。主要包括以下几个部分：
@@ -1309,6 +1402,53 @@ Press Ctrl+C to exit.\
  *10. 启动主要业务逻辑。
  *11. 程序退出成功。
  ******************************************************************************/
+void	zbx_free_service_resources(int ret)
+{
+	if (NULL != threads)
+	{
+		zbx_threads_wait(threads, threads_flags, threads_num, ret);	/* wait for all child processes to exit */
+		zbx_free(threads);
+		zbx_free(threads_flags);
+	}
+#ifdef HAVE_PTHREAD_PROCESS_SHARED
+	zbx_locks_disable();
+#endif
+	free_metrics();
+	alias_list_free();
+	free_collector_data();
+#ifdef _WINDOWS
+	free_perf_collector();
+	zbx_co_uninitialize();
+#endif
+#ifndef _WINDOWS
+	zbx_unload_modules();
+#endif
+	zabbix_log(LOG_LEVEL_INFORMATION, "Zabbix Agent stopped. Zabbix %s (revision %s).",
+			ZABBIX_VERSION, ZABBIX_REVISION);
+
+	zabbix_close_log();
+}
+
+void	zbx_on_exit(int ret)
+{
+	zabbix_log(LOG_LEVEL_DEBUG, "zbx_on_exit() called");
+
+	zbx_free_service_resources(ret);
+
+#if defined(_WINDOWS) && (defined(HAVE_POLARSSL) || defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL))
+	zbx_tls_free();
+	zbx_tls_library_deinit();	/* deinitialize crypto library from parent thread */
+#endif
+#if defined(PS_OVERWRITE_ARGV)
+	setproctitle_free_env();
+#endif
+#ifdef _WINDOWS
+	while (0 == WSACleanup())
+		;
+#endif
+
+	exit(EXIT_SUCCESS);
+}
 // 定义主函数
 int main(int argc, char **argv)
 {
@@ -1341,6 +1481,7 @@ int main(int argc, char **argv)
 	// 导入符号表
 	import_symbols();
 
+#ifdef _WINDOWS
 	// 针对Windows系统的额外处理
 	if (ZBX_TASK_SHOW_USAGE != t.task && ZBX_TASK_SHOW_VERSION != t.task && ZBX_TASK_SHOW_HELP != t.task &&
 			SUCCEED != zbx_socket_start(&error))
@@ -1349,135 +1490,45 @@ int main(int argc, char **argv)
 		zbx_free(error);
 		exit(EXIT_FAILURE);
 	}
+#endif
 
 	// 初始化指标
 	init_metrics();
 
 	// 根据任务类型进行切换处理
 	switch (t.task)
-	{
 		// 显示用法
-		case ZBX_TASK_SHOW_USAGE:
-			usage();
-			exit(EXIT_FAILURE);
-			break;
 
 		// 运行时控制
-		#ifndef _WINDOWS
-		case ZBX_TASK_RUNTIME_CONTROL:
-			zbx_load_config(ZBX_CFG_FILE_REQUIRED, &t);
-			exit(SUCCEED == zbx_sigusr_send(t.data) ? EXIT_SUCCESS : EXIT_FAILURE);
-			break;
-		#else
 		// Windows系统下的安装、卸载、启动、停止服务
-		case ZBX_TASK_INSTALL_SERVICE:
-		case ZBX_TASK_UNINSTALL_SERVICE:
-		case ZBX_TASK_START_SERVICE:
-		case ZBX_TASK_STOP_SERVICE:
-			if (t.flags & ZBX_TASK_FLAG_MULTIPLE_AGENTS)
-			{
-				zbx_load_config(ZBX_CFG_FILE_REQUIRED, &t);
 
-				zbx_snprintf(ZABBIX_SERVICE_NAME, sizeof(ZABBIX_SERVICE_NAME), "%s [%s]",
-						APPLICATION_NAME, CONFIG_HOSTNAME);
-				zbx_snprintf(ZABBIX_EVENT_SOURCE, sizeof(ZABBIX_EVENT_SOURCE), "%s [%s]",
-						APPLICATION_NAME, CONFIG_HOSTNAME);
-			}
-			else
-				zbx_load_config(ZBX_CFG_FILE_OPTIONAL, &t);
 
-			zbx_free_config();
 
-			ret = zbx_exec_service_task(argv[0], &t);
 
-			while (0 == WSACleanup())
-				;
 
-			free_metrics();
-			exit(SUCCEED == ret ? EXIT_SUCCESS : EXIT_FAILURE);
-			break;
-		#endif
 
 		// 测试指标
-		case ZBX_TASK_TEST_METRIC:
-		case ZBX_TASK_PRINT_SUPPORTED:
-			zbx_load_config(ZBX_CFG_FILE_OPTIONAL, &t);
 
 			// 针对非Windows系统，设置信号处理函数
-			#ifdef _WINDOWS
-			if (SUCCEED != init_perf_collector(ZBX_SINGLE_THREADED, &error))
-			{
-				zbx_error("cannot initialize performance counter collector: %s", error);
-				zbx_free(error);
-				exit(EXIT_FAILURE);
-			}
-			#else
-			zbx_set_common_signal_handlers();
-			#endif
 
-			#ifndef _WINDOWS
-			if (FAIL == zbx_load_modules(CONFIG_LOAD_MODULE_PATH, CONFIG_LOAD_MODULE, CONFIG_TIMEOUT, 0))
-			{
-				zabbix_log(LOG_LEVEL_CRIT, "loading modules failed, exiting...");
-				exit(EXIT_FAILURE);
-			}
-			#endif
 
-			load_user_parameters(CONFIG_USER_PARAMETERS);
-			load_aliases(CONFIG_ALIASES);
 
 			// 根据任务类型执行相应操作
-			if (ZBX_TASK_TEST_METRIC == t.task)
-				test_parameter(TEST_METRIC);
-			else
-				test_parameters();
 
-			#ifdef _WINDOWS
-			free_perf_collector();	/* cpu_collector must be freed before perf_collector is freed */
 
-			while (0 == WSACleanup())
-				;
-			#endif
 
-			zbx_unload_modules();
-			free_metrics();
-			alias_list_free();
-			exit(EXIT_SUCCESS);
-			break;
 
 		// 显示版本信息
-		case ZBX_TASK_SHOW_VERSION:
-			version();
 
-			#ifdef _AIX
-			printf("\
-");
-			tl_version();
-			#endif
 
-			exit(EXIT_SUCCESS);
-			break;
 
 		// 显示帮助信息
-		case ZBX_TASK_SHOW_HELP:
-			help();
-			exit(EXIT_SUCCESS);
-			break;
 
 		// 默认情况，加载配置文件并运行
-		default:
-			zbx_load_config(ZBX_CFG_FILE_REQUIRED, &t);
-			load_user_parameters(CONFIG_USER_PARAMETERS);
-			load_aliases(CONFIG_ALIASES);
-			break;
-	}
 
 	// 启动主要业务逻辑
-	START_MAIN_ZABBIX_ENTRY(CONFIG_ALLOW_ROOT, CONFIG_USER, t.flags);
 
 	// 程序退出成功
-	exit(EXIT_SUCCESS);
-}
 
 	{
 		case ZBX_TASK_SHOW_USAGE:
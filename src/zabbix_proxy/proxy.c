@@ -171,6 +171,12 @@ int	CONFIG_ALERTMANAGER_FORKS	= 0;
 int	CONFIG_PREPROCMAN_FORKS		= 0;
 int	CONFIG_PREPROCESSOR_FORKS	= 0;
 
+/* number of Zabbix agent checks a poller keeps in flight at once, 1 - one blocking check at a time */
+int	CONFIG_MAX_CONCURRENT_AGENT_CHECKS	= 1;
+
+/* number of item keys requested from Zabbix agent over one connection, 1 - one key per connection */
+int	CONFIG_MAX_ITEMS_PER_AGENT_REQUEST	= 1;
+
 int	CONFIG_LISTEN_PORT		= ZBX_DEFAULT_SERVER_PORT;
 char	*CONFIG_LISTEN_IP		= NULL;
 char	*CONFIG_SOURCE_IP		= NULL;
@@ -188,6 +194,9 @@ int	CONFIG_PROXYDATA_FREQUENCY	= 1;
 int	CONFIG_HISTSYNCER_FORKS		= 4;
 int	CONFIG_HISTSYNCER_FREQUENCY	= 1;
 int	CONFIG_CONFSYNCER_FORKS		= 1;
+int	CONFIG_CONFSYNCER_CHANGELOG	= 0;
+int	CONFIG_CONFSYNCER_FULL_FREQUENCY	= SEC_PER_HOUR;
+char	*CONFIG_CONFSYNCER_SNAPSHOT_FILE	= NULL;
 
 int	CONFIG_VMWARE_FORKS		= 0;
 int	CONFIG_VMWARE_FREQUENCY		= 60;
@@ -197,9 +206,12 @@ int	CONFIG_VMWARE_TIMEOUT		= 10;
 zbx_uint64_t	CONFIG_CONF_CACHE_SIZE		= 8 * ZBX_MEBIBYTE;
 zbx_uint64_t	CONFIG_HISTORY_CACHE_SIZE	= 16 * ZBX_MEBIBYTE;
 zbx_uint64_t	CONFIG_HISTORY_INDEX_CACHE_SIZE	= 4 * ZBX_MEBIBYTE;
+int		CONFIG_HISTORY_CACHE_SHARDS	= 1;
 zbx_uint64_t	CONFIG_TRENDS_CACHE_SIZE	= 0;
 zbx_uint64_t	CONFIG_VALUE_CACHE_SIZE		= 0;
+char		*CONFIG_VALUE_CACHE_SNAPSHOT_FILE	= NULL;
 zbx_uint64_t	CONFIG_VMWARE_CACHE_SIZE	= 8 * ZBX_MEBIBYTE;
+int		CONFIG_CACHE_SLAB_ALLOCATOR	= 0;
 zbx_uint64_t	CONFIG_EXPORT_FILE_SIZE;
 
 int	CONFIG_UNREACHABLE_PERIOD	= 45;
@@ -219,6 +231,8 @@ char	*CONFIG_DBPASSWORD		= NULL;
 char	*CONFIG_DBSOCKET		= NULL;
 char	*CONFIG_EXPORT_DIR		= NULL;
 int	CONFIG_DBPORT			= 0;
+int	CONFIG_DB_COPY_HISTORY		= 0;
+int	CONFIG_DB_PREPARED_STATEMENTS	= 0;
 int	CONFIG_ENABLE_REMOTE_COMMANDS	= 0;
 int	CONFIG_LOG_REMOTE_COMMANDS	= 0;
 int	CONFIG_UNSAFE_USER_PARAMETERS	= 0;
@@ -278,6 +292,10 @@ static char	*CONFIG_SOCKET_PATH	= NULL;
 char	*CONFIG_HISTORY_STORAGE_URL		= NULL;
 char	*CONFIG_HISTORY_STORAGE_OPTS		= NULL;
 int	CONFIG_HISTORY_STORAGE_PIPELINES	= 0;
+zbx_uint64_t	CONFIG_HISTORY_STORAGE_BULK_SIZE	= 5 * ZBX_MEBIBYTE;
+int	CONFIG_HISTORY_STORAGE_BULK_REQUESTS	= 5;
+int	CONFIG_HISTORY_STORAGE_COMPRESSION	= 0;
+int	CONFIG_HISTORY_STORAGE_AGGREGATE_PERIOD	= 0;
 
 char	*CONFIG_STATS_ALLOWED_IP	= NULL;
 /******************************************************************************
@@ -653,6 +671,31 @@ static void zbx_validate_config(ZBX_TASK_EX *task)
     // 检查 TLS 相关配置参数是否合法，如果不合法则输出错误日志，并将 err 置为 1
     if (SUCCEED != zbx_validate_log_parameters(task))
         err = 1;
+#if !(defined(HAVE_POLARSSL) || defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL))
+	err |= (FAIL == check_cfg_feature_str("TLSConnect", CONFIG_TLS_CONNECT, "TLS support"));
+	err |= (FAIL == check_cfg_feature_str("TLSAccept", CONFIG_TLS_ACCEPT, "TLS support"));
+	err |= (FAIL == check_cfg_feature_str("TLSCAFile", CONFIG_TLS_CA_FILE, "TLS support"));
+	err |= (FAIL == check_cfg_feature_str("TLSCRLFile", CONFIG_TLS_CRL_FILE, "TLS support"));
+	err |= (FAIL == check_cfg_feature_str("TLSServerCertIssuer", CONFIG_TLS_SERVER_CERT_ISSUER, "TLS support"));
+	err |= (FAIL == check_cfg_feature_str("TLSServerCertSubject", CONFIG_TLS_SERVER_CERT_SUBJECT, "TLS support"));
+	err |= (FAIL == check_cfg_feature_str("TLSCertFile", CONFIG_TLS_CERT_FILE, "TLS support"));
+	err |= (FAIL == check_cfg_feature_str("TLSKeyFile", CONFIG_TLS_KEY_FILE, "TLS support"));
+	err |= (FAIL == check_cfg_feature_str("TLSPSKIdentity", CONFIG_TLS_PSK_IDENTITY, "TLS support"));
+	err |= (FAIL == check_cfg_feature_str("TLSPSKFile", CONFIG_TLS_PSK_FILE, "TLS support"));
+#endif
+#if !(defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL))
+	err |= (FAIL == check_cfg_feature_str("TLSCipherCert", CONFIG_TLS_CIPHER_CERT, "GnuTLS or OpenSSL"));
+	err |= (FAIL == check_cfg_feature_str("TLSCipherPSK", CONFIG_TLS_CIPHER_PSK, "GnuTLS or OpenSSL"));
+	err |= (FAIL == check_cfg_feature_str("TLSCipherAll", CONFIG_TLS_CIPHER_ALL, "GnuTLS or OpenSSL"));
+#endif
+#if !defined(HAVE_OPENSSL)
+	err |= (FAIL == check_cfg_feature_str("TLSCipherCert13", CONFIG_TLS_CIPHER_CERT13, "OpenSSL 1.1.1 or newer"));
+	err |= (FAIL == check_cfg_feature_str("TLSCipherPSK13", CONFIG_TLS_CIPHER_PSK13, "OpenSSL 1.1.1 or newer"));
+	err |= (FAIL == check_cfg_feature_str("TLSCipherAll13", CONFIG_TLS_CIPHER_ALL13, "OpenSSL 1.1.1 or newer"));
+#endif
+#if !defined(HAVE_OPENIPMI)
+	err |= (FAIL == check_cfg_feature_int("StartIPMIPollers", CONFIG_IPMIPOLLER_FORKS, "IPMI support"));
+#endif
 
     // 如果 err 变量不为 0，则退出程序
     if (0 != err)
@@ -672,62 +715,263 @@ static void zbx_validate_config(ZBX_TASK_EX *task)
  *                                                                            *
  ******************************************************************************/
 /******************************************************************************
- * T
- ******************************************************************************/he configuration file for Zabbix consists of several sections, each containing key-value pairs. The sections and their respective keys and values are as follows:
-
-1. General:
-	* `Hostname`: The hostname of the Zabbix server.
-	* `DBHost`, `DBName`, `DBSchema`, `DBUser`, `DBPassword`: Database configuration parameters.
-	* `ListenIP`: The IP address to bind the Zabbix server to.
-	* `ListenPort`: The port to bind the Zabbix server to.
-	* `SourceIP`: The IP address to use for communication with external systems.
-	* `Timeout`: The timeout for communication with external systems.
-	* `TrapperTimeout`: The timeout for trapper events.
-2. Users:
-	* `User`: The username for the Zabbix server.
-3. Logging:
-	* `LogType`: The type of log output (e.g., syslog, console).
-	* `LogFile`: The location of the log file.
-	* `LogFileSize`: The maximum size of the log file before it is rotated.
-4. Proxies:
-	* `StartProxies`: The number of proxies to start.
-	* `ProxyConfig`: The configuration file for proxies.
-5. Pollers:
-	* `StartPollers`: The number of pollers to start.
-	* `StartPollersUnreachable`: The number of unreachable pollers to start.
-	* `PollingInterval`: The interval between polls.
-6. DataSenders:
-	* `StartDataSenders`: The number of data senders to start.
-7. Trappers:
-	* `StartTrappers`: The number of trappers to start.
-8. VMware collectors:
-	* `StartVMwareCollectors`: The number of VMware collectors to start.
-	* `VMwareFrequency`: The frequency of VMware data collection.
-	* `VMwarePerfFrequency`: The frequency of VMware performance data collection.
-	* `VMwareCacheSize`: The size of the VMware cache.
-	* `VMwareTimeout`: The timeout for VMware communication.
-9. SSL/TLS:
-	* `SSLCALocation`, `SSLCertLocation`, `SSLKeyLocation`: SSL/TLS certificate and key file locations.
-	* `TLSConnect`, `TLSACCEPT`: SSL/TLS connection and accept settings.
-	* `TLSCipher`: SSL/TLS cipher settings.
-10. Historical data:
-	* `HistoryCacheSize`: The size of the history cache.
-	* `HistoryIndexCacheSize`: The size of the history index cache.
-11. Housekeeping:
-	* `HousekeepingFrequency`: The frequency of housekeeping operations.
-12. Debugging:
-	* `DebugLevel`: The debug level for the Zabbix server.
-13. Pid file:
-	* `PidFile`: The location of the pid file.
-14. External scripts:
-	* `ExternalScripts`: A list of external scripts to execute.
-15. Reporting:
-	* `EnableRemoteCommands`: Whether to enable remote commands.
-	* `LogRemoteCommands`: Whether to log remote commands.
-16. Statistics:
-	* `StatsAllowedIP`: A list of IP addresses allowed to access statistics.
-
-The configuration file is parsed using the `parse_cfg_file()` function, which takes the file name, the configuration structure, and the strictness of the configuration validation. After parsing the file, the configuration is validated using the `zbx_validate_config()` function. If the configuration is valid, the Zabbix server starts and runs according to the specified settings.
+ * The configuration file for Zabbix consists of several sections, each containing key-value pairs. The sections and their respective keys and values are as follows:
+ *
+ * 1. General:
+ *     * `Hostname`: The hostname of the Zabbix server.
+ *     * `DBHost`, `DBName`, `DBSchema`, `DBUser`, `DBPassword`: Database configuration parameters.
+ *     * `ListenIP`: The IP address to bind the Zabbix server to.
+ *     * `ListenPort`: The port to bind the Zabbix server to.
+ *     * `SourceIP`: The IP address to use for communication with external systems.
+ *     * `Timeout`: The timeout for communication with external systems.
+ *     * `TrapperTimeout`: The timeout for trapper events.
+ * 2. Users:
+ *     * `User`: The username for the Zabbix server.
+ * 3. Logging:
+ *     * `LogType`: The type of log output (e.g., syslog, console).
+ *     * `LogFile`: The location of the log file.
+ *     * `LogFileSize`: The maximum size of the log file before it is rotated.
+ * 4. Proxies:
+ *     * `StartProxies`: The number of proxies to start.
+ *     * `ProxyConfig`: The configuration file for proxies.
+ * 5. Pollers:
+ *     * `StartPollers`: The number of pollers to start.
+ *     * `StartPollersUnreachable`: The number of unreachable pollers to start.
+ *     * `PollingInterval`: The interval between polls.
+ * 6. DataSenders:
+ *     * `StartDataSenders`: The number of data senders to start.
+ * 7. Trappers:
+ *     * `StartTrappers`: The number of trappers to start.
+ * 8. VMware collectors:
+ *     * `StartVMwareCollectors`: The number of VMware collectors to start.
+ *     * `VMwareFrequency`: The frequency of VMware data collection.
+ *     * `VMwarePerfFrequency`: The frequency of VMware performance data collection.
+ *     * `VMwareCacheSize`: The size of the VMware cache.
+ *     * `VMwareTimeout`: The timeout for VMware communication.
+ * 9. SSL/TLS:
+ *     * `SSLCALocation`, `SSLCertLocation`, `SSLKeyLocation`: SSL/TLS certificate and key file locations.
+ *     * `TLSConnect`, `TLSACCEPT`: SSL/TLS connection and accept settings.
+ *     * `TLSCipher`: SSL/TLS cipher settings.
+ * 10. Historical data:
+ *     * `HistoryCacheSize`: The size of the history cache.
+ *     * `HistoryIndexCacheSize`: The size of the history index cache.
+ * 11. Housekeeping:
+ *     * `HousekeepingFrequency`: The frequency of housekeeping operations.
+ * 12. Debugging:
+ *     * `DebugLevel`: The debug level for the Zabbix server.
+ * 13. Pid file:
+ *     * `PidFile`: The location of the pid file.
+ * 14. External scripts:
+ *     * `ExternalScripts`: A list of external scripts to execute.
+ * 15. Reporting:
+ *     * `EnableRemoteCommands`: Whether to enable remote commands.
+ *     * `LogRemoteCommands`: Whether to log remote commands.
+ * 16. Statistics:
+ *     * `StatsAllowedIP`: A list of IP addresses allowed to access statistics.
+ *
+ * The configuration file is parsed using the `parse_cfg_file()` function, which takes the file name, the configuration structure, and the strictness of the configuration validation. After parsing the file, the configuration is validated using the `zbx_validate_config()` function. If the configuration is valid, the Zabbix server starts and runs according to the specified settings.
+ ******************************************************************************/
+static void	zbx_load_config(ZBX_TASK_EX *task)
+{
+	static struct cfg_line	cfg[] =
+	{
+		/* PARAMETER,			VAR,					TYPE,
+			MANDATORY,	MIN,			MAX */
+		{"ProxyMode",			&CONFIG_PROXYMODE,			TYPE_INT,
+			PARM_OPT,	ZBX_PROXYMODE_ACTIVE,	ZBX_PROXYMODE_PASSIVE},
+		{"Server",			&CONFIG_SERVER,				TYPE_STRING,
+			PARM_MAND,	0,			0},
+		{"ServerPort",			&CONFIG_SERVER_PORT,			TYPE_INT,
+			PARM_OPT,	1024,			32767},
+		{"Hostname",			&CONFIG_HOSTNAME,			TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"HostnameItem",		&CONFIG_HOSTNAME_ITEM,			TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"StartDBSyncers",		&CONFIG_HISTSYNCER_FORKS,		TYPE_INT,
+			PARM_OPT,	1,			100},
+		{"StartDiscoverers",		&CONFIG_DISCOVERER_FORKS,		TYPE_INT,
+			PARM_OPT,	0,			250},
+		{"StartHTTPPollers",		&CONFIG_HTTPPOLLER_FORKS,		TYPE_INT,
+			PARM_OPT,	0,			1000},
+		{"StartPingers",		&CONFIG_PINGER_FORKS,			TYPE_INT,
+			PARM_OPT,	0,			1000},
+		{"StartPollers",		&CONFIG_POLLER_FORKS,			TYPE_INT,
+			PARM_OPT,	0,			1000},
+		{"StartPollersUnreachable",	&CONFIG_UNREACHABLE_POLLER_FORKS,	TYPE_INT,
+			PARM_OPT,	0,			1000},
+		{"MaxConcurrentAgentChecks",	&CONFIG_MAX_CONCURRENT_AGENT_CHECKS,	TYPE_INT,
+			PARM_OPT,	1,			MAX_AGENT_ITEMS},
+		{"MaxItemsPerAgentRequest",	&CONFIG_MAX_ITEMS_PER_AGENT_REQUEST,	TYPE_INT,
+			PARM_OPT,	1,			MAX_POLLER_ITEMS},
+		{"StartIPMIPollers",		&CONFIG_IPMIPOLLER_FORKS,		TYPE_INT,
+			PARM_OPT,	0,			1000},
+		{"StartTrappers",		&CONFIG_TRAPPER_FORKS,			TYPE_INT,
+			PARM_OPT,	0,			1000},
+		{"StartJavaPollers",		&CONFIG_JAVAPOLLER_FORKS,		TYPE_INT,
+			PARM_OPT,	0,			1000},
+		{"JavaGateway",			&CONFIG_JAVA_GATEWAY,			TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"JavaGatewayPort",		&CONFIG_JAVA_GATEWAY_PORT,		TYPE_INT,
+			PARM_OPT,	1024,			32767},
+		{"SNMPTrapperFile",		&CONFIG_SNMPTRAP_FILE,			TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"StartSNMPTrapper",		&CONFIG_SNMPTRAPPER_FORKS,		TYPE_INT,
+			PARM_OPT,	0,			1},
+		{"CacheSize",			&CONFIG_CONF_CACHE_SIZE,		TYPE_UINT64,
+			PARM_OPT,	128 * ZBX_KIBIBYTE,	__UINT64_C(8) * ZBX_GIBIBYTE},
+		{"CacheSlabAllocator",		&CONFIG_CACHE_SLAB_ALLOCATOR,		TYPE_INT,
+			PARM_OPT,	0,			1},
+		{"HistoryCacheSize",		&CONFIG_HISTORY_CACHE_SIZE,		TYPE_UINT64,
+			PARM_OPT,	128 * ZBX_KIBIBYTE,	__UINT64_C(2) * ZBX_GIBIBYTE},
+		{"HistoryIndexCacheSize",	&CONFIG_HISTORY_INDEX_CACHE_SIZE,	TYPE_UINT64,
+			PARM_OPT,	128 * ZBX_KIBIBYTE,	__UINT64_C(2) * ZBX_GIBIBYTE},
+		{"HistoryCacheShards",		&CONFIG_HISTORY_CACHE_SHARDS,		TYPE_INT,
+			PARM_OPT,	1,			16},
+		{"HousekeepingFrequency",	&CONFIG_HOUSEKEEPING_FREQUENCY,		TYPE_INT,
+			PARM_OPT,	0,			24},
+		{"ProxyLocalBuffer",		&CONFIG_PROXY_LOCAL_BUFFER,		TYPE_INT,
+			PARM_OPT,	0,			720},
+		{"ProxyOfflineBuffer",		&CONFIG_PROXY_OFFLINE_BUFFER,		TYPE_INT,
+			PARM_OPT,	1,			720},
+		{"HeartbeatFrequency",		&CONFIG_HEARTBEAT_FREQUENCY,		TYPE_INT,
+			PARM_OPT,	0,			ZBX_PROXY_HEARTBEAT_FREQUENCY_MAX},
+		{"ConfigFrequency",		&CONFIG_PROXYCONFIG_FREQUENCY,		TYPE_INT,
+			PARM_OPT,	1,			SEC_PER_WEEK},
+		{"DataSenderFrequency",		&CONFIG_PROXYDATA_FREQUENCY,		TYPE_INT,
+			PARM_OPT,	1,			SEC_PER_HOUR},
+		{"TmpDir",			&CONFIG_TMPDIR,				TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"FpingLocation",		&CONFIG_FPING_LOCATION,			TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"Fping6Location",		&CONFIG_FPING6_LOCATION,		TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"Timeout",			&CONFIG_TIMEOUT,			TYPE_INT,
+			PARM_OPT,	1,			30},
+		{"TrapperTimeout",		&CONFIG_TRAPPER_TIMEOUT,		TYPE_INT,
+			PARM_OPT,	1,			300},
+		{"UnreachablePeriod",		&CONFIG_UNREACHABLE_PERIOD,		TYPE_INT,
+			PARM_OPT,	1,			SEC_PER_HOUR},
+		{"UnreachableDelay",		&CONFIG_UNREACHABLE_DELAY,		TYPE_INT,
+			PARM_OPT,	1,			SEC_PER_HOUR},
+		{"UnavailableDelay",		&CONFIG_UNAVAILABLE_DELAY,		TYPE_INT,
+			PARM_OPT,	1,			SEC_PER_HOUR},
+		{"ListenIP",			&CONFIG_LISTEN_IP,			TYPE_STRING_LIST,
+			PARM_OPT,	0,			0},
+		{"ListenPort",			&CONFIG_LISTEN_PORT,			TYPE_INT,
+			PARM_OPT,	1024,			32767},
+		{"SourceIP",			&CONFIG_SOURCE_IP,			TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"DebugLevel",			&CONFIG_LOG_LEVEL,			TYPE_INT,
+			PARM_OPT,	0,			5},
+		{"PidFile",			&CONFIG_PID_FILE,			TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"LogType",			&CONFIG_LOG_TYPE_STR,			TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"LogFile",			&CONFIG_LOG_FILE,			TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"LogFileSize",			&CONFIG_LOG_FILE_SIZE,			TYPE_INT,
+			PARM_OPT,	0,			1024},
+		{"ExternalScripts",		&CONFIG_EXTERNALSCRIPTS,		TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"DBHost",			&CONFIG_DBHOST,				TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"DBName",			&CONFIG_DBNAME,				TYPE_STRING,
+			PARM_MAND,	0,			0},
+		{"DBSchema",			&CONFIG_DBSCHEMA,			TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"DBUser",			&CONFIG_DBUSER,				TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"DBPassword",			&CONFIG_DBPASSWORD,			TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"DBSocket",			&CONFIG_DBSOCKET,			TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"DBPort",			&CONFIG_DBPORT,				TYPE_INT,
+			PARM_OPT,	1024,			65535},
+		{"SSHKeyLocation",		&CONFIG_SSH_KEY_LOCATION,		TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"LogSlowQueries",		&CONFIG_LOG_SLOW_QUERIES,		TYPE_INT,
+			PARM_OPT,	0,			3600000},
+		{"LoadModulePath",		&CONFIG_LOAD_MODULE_PATH,		TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"LoadModule",			&CONFIG_LOAD_MODULE,			TYPE_MULTISTRING,
+			PARM_OPT,	0,			0},
+		{"StartVMwareCollectors",	&CONFIG_VMWARE_FORKS,			TYPE_INT,
+			PARM_OPT,	0,			250},
+		{"VMwareFrequency",		&CONFIG_VMWARE_FREQUENCY,		TYPE_INT,
+			PARM_OPT,	10,			SEC_PER_DAY},
+		{"VMwarePerfFrequency",		&CONFIG_VMWARE_PERF_FREQUENCY,		TYPE_INT,
+			PARM_OPT,	10,			SEC_PER_DAY},
+		{"VMwareCacheSize",		&CONFIG_VMWARE_CACHE_SIZE,		TYPE_UINT64,
+			PARM_OPT,	256 * ZBX_KIBIBYTE,	__UINT64_C(2) * ZBX_GIBIBYTE},
+		{"VMwareTimeout",		&CONFIG_VMWARE_TIMEOUT,			TYPE_INT,
+			PARM_OPT,	1,			300},
+		{"AllowRoot",			&CONFIG_ALLOW_ROOT,			TYPE_INT,
+			PARM_OPT,	0,			1},
+		{"User",			&CONFIG_USER,				TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"SSLCALocation",		&CONFIG_SSL_CA_LOCATION,		TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"SSLCertLocation",		&CONFIG_SSL_CERT_LOCATION,		TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"SSLKeyLocation",		&CONFIG_SSL_KEY_LOCATION,		TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"TLSConnect",			&CONFIG_TLS_CONNECT,			TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"TLSAccept",			&CONFIG_TLS_ACCEPT,			TYPE_STRING_LIST,
+			PARM_OPT,	0,			0},
+		{"TLSCAFile",			&CONFIG_TLS_CA_FILE,			TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"TLSCRLFile",			&CONFIG_TLS_CRL_FILE,			TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"TLSServerCertIssuer",		&CONFIG_TLS_SERVER_CERT_ISSUER,		TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"TLSServerCertSubject",	&CONFIG_TLS_SERVER_CERT_SUBJECT,	TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"TLSCertFile",			&CONFIG_TLS_CERT_FILE,			TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"TLSKeyFile",			&CONFIG_TLS_KEY_FILE,			TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"TLSPSKIdentity",		&CONFIG_TLS_PSK_IDENTITY,		TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"TLSPSKFile",			&CONFIG_TLS_PSK_FILE,			TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"TLSCipherCert13",		&CONFIG_TLS_CIPHER_CERT13,		TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"TLSCipherCert",		&CONFIG_TLS_CIPHER_CERT,		TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"TLSCipherPSK13",		&CONFIG_TLS_CIPHER_PSK13,		TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"TLSCipherPSK",		&CONFIG_TLS_CIPHER_PSK,			TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"TLSCipherAll13",		&CONFIG_TLS_CIPHER_ALL13,		TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"TLSCipherAll",		&CONFIG_TLS_CIPHER_ALL,			TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"SocketDir",			&CONFIG_SOCKET_PATH,			TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"EnableRemoteCommands",	&CONFIG_ENABLE_REMOTE_COMMANDS,		TYPE_INT,
+			PARM_OPT,	0,			1},
+		{"LogRemoteCommands",		&CONFIG_LOG_REMOTE_COMMANDS,		TYPE_INT,
+			PARM_OPT,	0,			1},
+		{"StatsAllowedIP",		&CONFIG_STATS_ALLOWED_IP,		TYPE_STRING_LIST,
+			PARM_OPT,	0,			0},
+		{NULL}
+	};
+
+	/* initialize multistrings */
+	zbx_strarr_init(&CONFIG_LOAD_MODULE);
+
+	parse_cfg_file(CONFIG_FILE, cfg, ZBX_CFG_FILE_REQUIRED, ZBX_CFG_STRICT);
+
+	zbx_set_defaults();
+
+	CONFIG_LOG_TYPE = zbx_get_log_type(CONFIG_LOG_TYPE_STR);
+
+	zbx_validate_config(task);
+#if defined(HAVE_POLARSSL) || defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
+	zbx_tls_validate_config();
+#endif
+}
 
 /******************************************************************************
  *                                                                            *
@@ -745,11 +989,12 @@ The configuration file is parsed using the `parse_cfg_file()` function, which ta
  *2. 调用zbx_strarr_free函数，传入参数CONFIG_LOAD_MODULE。这个参数很可能是一个字符串数组，用于存储配置文件加载模块的信息。
  *3. zbx_strarr_free函数的作用是释放传入的字符串数组占用的内存空间。在这里，它主要用于释放配置文件加载模块的相关资源。
  *
- *整个注释好的代码块如下：
- *
- *```c
- */**
- * * @file
+ ******************************************************************************/
+static void	zbx_free_config(void)
+{
+	zbx_strarr_free(CONFIG_LOAD_MODULE);
+}
+
 /******************************************************************************
  * *
  *这段代码的主要目的是从一个C语言程序的命令行参数中解析并处理配置信息，然后启动后台进程。具体来说，它做了以下事情：
@@ -862,27 +1107,10 @@ int main(int argc, char **argv)
 	return daemon_start(CONFIG_ALLOW_ROOT, CONFIG_USER, t.flags);
 }
 
-	init_metrics();
 
-	zbx_load_config(&t);
 
-	if (ZBX_TASK_RUNTIME_CONTROL == t.task)
-		exit(SUCCEED == zbx_sigusr_send(t.data) ? EXIT_SUCCESS : EXIT_FAILURE);
 
-#ifdef HAVE_OPENIPMI
-	{
-		char *error = NULL;
 
-		if (FAIL == zbx_ipc_service_init_env(CONFIG_SOCKET_PATH, &error))
-		{
-			zbx_error("Cannot initialize IPC services: %s", error);
-			zbx_free(error);
-			exit(EXIT_FAILURE);
-		}
-	}
-#endif
-	return daemon_start(CONFIG_ALLOW_ROOT, CONFIG_USER, t.flags);
-}
 
 int	MAIN_ZABBIX_ENTRY(int flags)
 {
@@ -992,361 +1220,198 @@ int	MAIN_ZABBIX_ENTRY(int flags)
 /******************************************************************************
  * ```c
  ******************************************************************************/
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <time.h>
-#include <unistd.h>
-
-#include "zbx_config.h"
-#include "zbx_server.h"
-#include "zbx_db.h"
-#include "zbx_macros.h"
-#include "zbx_tcp.h"
-#include "zbx_hash.h"
-#include "zbx_regexp.h"
-#include "zbx_sleep.h"
-#include "zbx_time.h"
-#include "zbx_thread.h"
-#include "zbx_process.h"
-#include "zbx_system.h"
-#include "zbx_event.h"
-#include "zbx_snmp.h"
-#include "zbx_ipmi.h"
-#include "zbx_java.h"
-#include "zbx_curl.h"
-#include "zbx_os.h"
-#include "zbx_network.h"
-#include "zbx_tls.h"
-#include "zbx_regexp.h"
-#include "zbx_ipmi.h"
-#include "zbx_agent.h"
-#include "zbx_log.h"
-#include "zbx_hash.h"
-#include "zbx_utils.h"
-#include "zbx_time.h"
-#include "zbx_sleep.h"
-#include "zbx_config.h"
-#include "zbx_regexp.h"
-#include "zbx_curl.h"
-#include "zbx_tls.h"
-#include "zbx_ipmi.h"
-#include "zbx_hash.h"
-#include "zbx_utils.h"
-#include "zbx_macros.h"
-#include "zbx_event.h"
-#include "zbx_regexp.h"
-#include "zbx_agent.h"
-#include "zbx_log.h"
-#include "zbx_hash.h"
-#include "zbx_utils.h"
-#include "zbx_sleep.h"
-#include "zbx_config.h"
-#include "zbx_regexp.h"
-#include "zbx_curl.h"
-#include "zbx_tls.h"
-#include "zbx_ipmi.h"
-#include "zbx_hash.h"
-#include "zbx_utils.h"
-#include "zbx_macros.h"
-#include "zbx_event.h"
-#include "zbx_regexp.h"
-#include "zbx_agent.h"
-#include "zbx_log.h"
-#include "zbx_hash.h"
-#include "zbx_utils.h"
-#include "zbx_sleep.h"
-#include "zbx_config.h"
-#include "zbx_regexp.h"
-#include "zbx_curl.h"
-#include "zbx_tls.h"
-#include "zbx_ipmi.h"
-#include "zbx_hash.h"
-#include "zbx_utils.h"
-#include "zbx_macros.h"
-#include "zbx_event.h"
-#include "zbx_regexp.h"
-#include "zbx_agent.h"
-#include "zbx_log.h"
-#include "zbx_hash.h"
-#include "zbx_utils.h"
-#include "zbx_sleep.h"
-#include "zbx_config.h"
-#include "zbx_regexp.h"
-#include "zbx_curl.h"
-#include "zbx_tls.h"
-#include "zbx_ipmi.h"
-#include "zbx_hash.h"
-#include "zbx_utils.h"
-#include "zbx_macros.h"
-#include "zbx_event.h"
-#include "zbx_regexp.h"
-#include "zbx_agent.h"
-#include "zbx_log.h"
-#include "zbx_hash.h"
-#include "zbx_utils.h"
-#include "zbx_sleep.h"
-#include "zbx_config.h"
-#include "zbx_regexp.h"
-#include "zbx_curl.h"
-#include "zbx_tls.h"
-#include "zbx_ipmi.h"
-#include "zbx_hash.h"
-#include "zbx_utils.h"
-#include "zbx_macros.h"
-#include "zbx_event.h"
-#include "zbx_regexp.h"
-#include "zbx_agent.h"
-#include "zbx_log.h"
-#include "zbx_hash.h"
-#include "zbx_utils.h"
-#include "zbx_sleep.h"
-#include "zbx_config.h"
-#include "zbx_regexp.h"
-#include "zbx_curl.h"
-#include "zbx_tls.h"
-#include "zbx_ipmi.h"
-#include "zbx_hash.h"
-#include "zbx_utils.h"
-#include "zbx_macros.h"
-#include "zbx_event.h"
-#include "zbx_regexp.h"
-#include "zbx_agent.h"
-#include "zbx_log.h"
-#include "zbx_hash.h"
-#include "zbx_utils.h"
-#include "zbx_sleep.h"
-#include "zbx_config.h"
-#include "zbx_regexp.h"
-#include "zbx_curl.h"
-#include "zbx_tls.h"
-#include "zbx_ipmi.h"
-#include "zbx_hash.h"
-#include "zbx_utils.h"
-#include "zbx_macros.h"
-#include "zbx_event.h"
-#include "zbx_regexp.h"
-#include "zbx_agent.h"
-#include "zbx_log.h"
-#include "zbx_hash.h"
-#include "zbx_utils.h"
-#include "zbx_sleep.h"
-#include "zbx_config.h"
-#include "zbx_regexp.h"
-#include "zbx_curl.h"
-#include "zbx_tls.h"
-#include "zbx_ipmi.h"
-#include "zbx_hash.h"
-#include "zbx_utils.h"
-#include "zbx_macros.h"
-#include "zbx_event.h"
-#include "zbx_regexp.h"
-#include "zbx_agent.h"
-#include "zbx_log.h"
-#include "zbx_hash.h"
-#include "zbx_utils.h"
-#include "zbx_sleep.h"
-#include "zbx_config.h"
-#include "zbx_regexp.h"
-#include "zbx_curl.h"
-#include "zbx_tls.h"
-#include "zbx_ipmi.h"
-#include "zbx_hash.h"
-#include "zbx_utils.h"
-#include "zbx_macros.h"
-#include "zbx_event.h"
-#include "zbx_regexp.h"
-#include "zbx_agent.h"
-#include "zbx_log.h"
-#include "zbx_hash.h"
-#include "zbx_utils.h"
-#include "zbx_sleep.h"
-#include "zbx_config.h"
-#include "zbx_regexp.h"
-#include "zbx_curl.h"
-#include "zbx_tls.h"
-#include "zbx_ipmi.h"
-#include "zbx_hash.h"
-#include "zbx_utils.h"
-#include "zbx_macros.h"
-#include "zbx_event.h"
-#include "zbx_regexp.h"
-#include "zbx_agent.h"
-#include "zbx_log.h"
-#include "zbx_hash.h"
-#include "zbx_utils.h"
-#include "zbx_sleep.h"
-#include "zbx_config.h"
-#include "zbx_regexp.h"
-#include "zbx_curl.h"
-#include "zbx_tls.h"
-#include "zbx_ipmi.h"
-#include "zbx_hash.h"
-#include "zbx_utils.h"
-#include "zbx_macros.h"
-#include "zbx_event.h"
-#include "zbx_regexp.h"
-#include "zbx_agent.h"
-#include "zbx_log.h"
-#include "zbx_hash.h"
-#include "zbx_utils.h"
-#include "zbx_sleep.h"
-#include "zbx_config.h"
-#include "zbx_regexp.h"
-#include "zbx_curl.h"
-#include "zbx_tls.h"
-#include "zbx_ipmi.h"
-#include "zbx_hash.h"
-#include "zbx_utils.h"
-#include "zbx_macros.h"
-#include "zbx_event.h"
-#include "zbx_regexp.h"
-#include "zbx_agent.h"
-#include "zbx_log.h"
-#include "zbx_hash.h"
-#include "zbx_utils.h"
-#include "zbx_sleep.h"
-#include "zbx_config.h"
-#include "zbx_regexp.h"
-#include "zbx_curl.h"
-#include "zbx_tls.h"
-#include "zbx_ipmi.h"
-#include "zbx_hash.h"
-#include "zbx_utils.h"
-#include "zbx_macros.h"
-#include "zbx_event.h"
-#include "zbx_regexp.h"
-#include "zbx_agent.h"
-#include "zbx_log.h"
-#include "zbx_hash.h"
-#include "zbx_utils.h"
-#include "zbx_sleep.h"
-#include "zbx_config.h"
-#include "zbx_regexp.h"
-#include "zbx_curl.h"
-#include "zbx_tls.h"
-#include "zbx_ipmi.h"
-#include "zbx_hash.h"
-#include "zbx_utils.h"
-#include "zbx_macros.h"
-#include "zbx_event.h"
-#include "zbx_regexp.h"
-#include "zbx_agent.h"
-#include "zbx_log.h"
-#include "zbx_hash.h"
-#include "zbx_utils.h"
-#include "zbx_sleep.h"
-#include "zbx_config.h"
-#include "zbx_regexp.h"
-#include "zbx_curl.h"
-#include "zbx_tls.h"
-#include "zbx_ipmi.h"
-#include "zbx_hash.h"
-#include "zbx_utils.h"
-#include "zbx_macros.h"
-#include "zbx_event.h"
-#include "zbx_regexp.h"
-#include "zbx_agent.h"
-#include "zbx_log.h"
-#include "zbx_hash.h"
-#include "zbx_utils.h"
-#include "zbx_sleep.h"
-#include "zbx_config.h"
-#include "zbx_regexp.h"
-#include "zbx_curl.h"
-#include "zbx_tls.h"
-#include "zbx_ipmi.h"
-#include "zbx_hash.h"
-#include "zbx_utils.h"
-#include "zbx_macros.h"
-#include "zbx_event.h"
-#include "zbx_regexp.h"
-#include "zbx_agent.h"
-#include "zbx_log.h"
-#include "zbx_hash.h"
-#include "zbx_utils.h"
-#include "zbx_sleep.h"
-#include "zbx_config.h"
-#include "zbx_regexp.h"
-#include "zbx_curl.h"
-#include "zbx_tls.h"
-#include "zbx_ipmi.h"
-#include "zbx_hash.h"
-#include "zbx_utils.h"
-#include "zbx_macros.h"
-#include "zbx_event.h"
-#include "zbx_regexp.h"
-#include "zbx_agent.h"
-#include "zbx_log.h"
-#include "zbx_hash.h"
-#include "zbx_utils.h"
-#include "zbx_sleep.h"
-#include "zbx_config.h"
-#include "zbx_regexp.h"
-#include "zbx_curl.h"
-#include "zbx_tls.h"
-#include "zbx_ipmi.h"
-#include "zbx_hash.h"
-#include "zbx_utils.h"
-#include "zbx_macros.h"
-#include "zbx_event.h"
-#include "zbx_regexp.h"
-#include "zbx_agent.h"
-#include "zbx_log.h"
-#include "zbx_hash.h"
-#include "zbx_utils.h"
-#include "zbx_sleep.h"
-#include "zbx_config.h"
-#include "zbx_regexp.h"
-#include "zbx_curl.h"
-#include "zbx_tls.h"
-#include "zbx_ipmi.h"
-#include "zbx_hash.h"
-#include "zbx_utils.h"
-#include "zbx_macros.h"
-#include "zbx_event.h"
-#include "zbx_regexp.h"
-#include "zbx_agent.h"
-#include "zbx_log.h"
-#include "zbx_hash.h"
-#include "zbx_utils.h"
-#include "zbx_sleep.h"
-#include "zbx_config.h"
-#include "zbx_regexp.h"
-#include "zbx_curl.h"
-#include "zbx_tls.h"
-#include "zbx_ipmi.h"
-#include "zbx_hash.h"
-#include "zbx_utils.h"
-#include "zbx_macros.h"
-#include "zbx_event.h"
-#include "zbx_regexp.h"
-#include "zbx_agent.h"
-#include "zbx_log.h"
-#include "zbx_hash.h"
-#include "zbx_utils.h"
-#include "zbx_sleep.h"
-#include "zbx_config.h"
-#include "zbx_regexp.h"
-#include "zbx_curl.h"
-#include "zbx_tls.h"
-#include "zbx_ipmi.h"
-#include "zbx_hash.h"
-#include "zbx_utils.h"
-#include "zbx_macros.h"
-#include "zbx_event.h"
-#include "zbx_regexp.h"
-#include "zbx_agent.h"
-#include "zbx_log.h"
-#include "zbx_hash.h"
-#include "zbx_utils.h"
-#include "zbx_sleep.h"
-#include "zbx_config.h"
-#include "zbx_regexp.h"
-#include "zbx_curl.h"
-#include "zbx_tls.h"
-#include "zbx_ipmi.h"
-#include "zbx_hash.h"
-#include "zbx_utils.h"
-#include "zbx_macros.h"
-#include
+	}
+	if (SUCCEED != init_proxy_history_lock(&error))
+{
+		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize lock for passive proxy history: %s", error);
+			zbx_free(error);
+        exit(EXIT_FAILURE);
+	}
+	if (SUCCEED != init_configuration_cache(&error))
+{
+		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize configuration cache: %s", error);
+			zbx_free(error);
+        exit(EXIT_FAILURE);
+	}
+	if (SUCCEED != init_selfmon_collector(&error))
+{
+		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize self-monitoring: %s", error);
+			zbx_free(error);
+        exit(EXIT_FAILURE);
+	}
+	if (0 != CONFIG_VMWARE_FORKS && SUCCEED != zbx_vmware_init(&error))
+{
+		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize VMware cache: %s", error);
+			zbx_free(error);
+        exit(EXIT_FAILURE);
+	}
+	if (SUCCEED != DBinit(&error))
+{
+		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize database: %s", error);
+			zbx_free(error);
+        exit(EXIT_FAILURE);
+	}
+	if (ZBX_DB_UNKNOWN == (db_type = zbx_db_get_database_type()))
+{
+		zabbix_log(LOG_LEVEL_CRIT, "cannot use database \"%s\": database is not a Zabbix database",
+				CONFIG_DBNAME);
+        exit(EXIT_FAILURE);
+	}
+	else if (ZBX_DB_PROXY != db_type)
+{
+		zabbix_log(LOG_LEVEL_CRIT, "cannot use database \"%s\": Zabbix proxy cannot work with a"
+				" Zabbix server database", CONFIG_DBNAME);
+        exit(EXIT_FAILURE);
+	}
+	if (SUCCEED != DBcheck_version())
+        exit(EXIT_FAILURE);
+	DBcheck_character_set();
+	threads_num = CONFIG_CONFSYNCER_FORKS + CONFIG_HEARTBEAT_FORKS + CONFIG_DATASENDER_FORKS
+			+ CONFIG_POLLER_FORKS + CONFIG_UNREACHABLE_POLLER_FORKS + CONFIG_TRAPPER_FORKS
+			+ CONFIG_PINGER_FORKS + CONFIG_HOUSEKEEPER_FORKS + CONFIG_HTTPPOLLER_FORKS
+			+ CONFIG_DISCOVERER_FORKS + CONFIG_HISTSYNCER_FORKS + CONFIG_IPMIPOLLER_FORKS
+			+ CONFIG_JAVAPOLLER_FORKS + CONFIG_SNMPTRAPPER_FORKS + CONFIG_SELFMON_FORKS
+			+ CONFIG_VMWARE_FORKS + CONFIG_IPMIMANAGER_FORKS + CONFIG_TASKMANAGER_FORKS;
+	threads = (pid_t *)zbx_calloc(threads, threads_num, sizeof(pid_t));
+	threads_flags = (int *)zbx_calloc(threads_flags, threads_num, sizeof(int));
+	if (0 != CONFIG_TRAPPER_FORKS)
+{
+		if (FAIL == zbx_tcp_listen(&listen_sock, CONFIG_LISTEN_IP, (unsigned short)CONFIG_LISTEN_PORT))
+{
+			zabbix_log(LOG_LEVEL_CRIT, "listener failed: %s", zbx_socket_strerror());
+        exit(EXIT_FAILURE);
+	}
+	}
+#if defined(HAVE_POLARSSL) || defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
+	zbx_tls_init_parent();
+#endif
+	zabbix_log(LOG_LEVEL_INFORMATION, "proxy #0 started [main process]");
+	for (i = 0; i < threads_num; i++)
+{
+		zbx_thread_args_t	thread_args;
+		unsigned char		poller_type;
+		if (FAIL == get_process_info_by_thread(i + 1, &thread_args.process_type, &thread_args.process_num))
+{
+			THIS_SHOULD_NEVER_HAPPEN;
+        exit(EXIT_FAILURE);
+	}
+		thread_args.server_num = i + 1;
+		thread_args.args = NULL;
+		switch (thread_args.process_type)
+{
+			case ZBX_PROCESS_TYPE_CONFSYNCER:
+				zbx_thread_start(proxyconfig_thread, &thread_args, &threads[i]);
+				DCconfig_wait_sync();
+				break;
+			case ZBX_PROCESS_TYPE_TRAPPER:
+				thread_args.args = &listen_sock;
+				zbx_thread_start(trapper_thread, &thread_args, &threads[i]);
+				if (0 == CONFIG_CONFSYNCER_FORKS)
+				DCconfig_wait_sync();
+				break;
+			case ZBX_PROCESS_TYPE_HEARTBEAT:
+				zbx_thread_start(heart_thread, &thread_args, &threads[i]);
+				break;
+			case ZBX_PROCESS_TYPE_DATASENDER:
+				zbx_thread_start(datasender_thread, &thread_args, &threads[i]);
+				break;
+			case ZBX_PROCESS_TYPE_POLLER:
+				poller_type = ZBX_POLLER_TYPE_NORMAL;
+				thread_args.args = &poller_type;
+				zbx_thread_start(poller_thread, &thread_args, &threads[i]);
+				break;
+			case ZBX_PROCESS_TYPE_UNREACHABLE:
+				poller_type = ZBX_POLLER_TYPE_UNREACHABLE;
+				thread_args.args = &poller_type;
+				zbx_thread_start(poller_thread, &thread_args, &threads[i]);
+				break;
+			case ZBX_PROCESS_TYPE_PINGER:
+				zbx_thread_start(pinger_thread, &thread_args, &threads[i]);
+				break;
+			case ZBX_PROCESS_TYPE_HOUSEKEEPER:
+				zbx_thread_start(housekeeper_thread, &thread_args, &threads[i]);
+				break;
+			case ZBX_PROCESS_TYPE_HTTPPOLLER:
+				zbx_thread_start(httppoller_thread, &thread_args, &threads[i]);
+				break;
+			case ZBX_PROCESS_TYPE_DISCOVERER:
+				zbx_thread_start(discoverer_thread, &thread_args, &threads[i]);
+				break;
+			case ZBX_PROCESS_TYPE_HISTSYNCER:
+				threads_flags[i] = ZBX_THREAD_WAIT_EXIT;
+				zbx_thread_start(dbsyncer_thread, &thread_args, &threads[i]);
+				break;
+			case ZBX_PROCESS_TYPE_JAVAPOLLER:
+				poller_type = ZBX_POLLER_TYPE_JAVA;
+				thread_args.args = &poller_type;
+				zbx_thread_start(poller_thread, &thread_args, &threads[i]);
+				break;
+			case ZBX_PROCESS_TYPE_SNMPTRAPPER:
+				zbx_thread_start(snmptrapper_thread, &thread_args, &threads[i]);
+				break;
+			case ZBX_PROCESS_TYPE_SELFMON:
+				zbx_thread_start(selfmon_thread, &thread_args, &threads[i]);
+				break;
+			case ZBX_PROCESS_TYPE_VMWARE:
+				zbx_thread_start(vmware_thread, &thread_args, &threads[i]);
+				break;
+#ifdef HAVE_OPENIPMI
+			case ZBX_PROCESS_TYPE_IPMIMANAGER:
+				zbx_thread_start(ipmi_manager_thread, &thread_args, &threads[i]);
+				break;
+			case ZBX_PROCESS_TYPE_IPMIPOLLER:
+				zbx_thread_start(ipmi_poller_thread, &thread_args, &threads[i]);
+				break;
+#endif
+			case ZBX_PROCESS_TYPE_TASKMANAGER:
+				zbx_thread_start(taskmanager_thread, &thread_args, &threads[i]);
+				break;
+	}
+	}
+	while (-1 == wait(&i))
+{
+		if (EINTR != errno)
+{
+			zabbix_log(LOG_LEVEL_ERR, "failed to wait on child processes: %s", zbx_strerror(errno));
+				break;
+	}
+	}
+			THIS_SHOULD_NEVER_HAPPEN;
+	zbx_on_exit(FAIL);
+	return SUCCEED;
+	}
+void	zbx_on_exit(int ret)
+{
+	zabbix_log(LOG_LEVEL_DEBUG, "zbx_on_exit() called");
+	if (NULL != threads)
+{
+		zbx_threads_wait(threads, threads_flags, threads_num, ret);
+		zbx_free(threads);
+		zbx_free(threads_flags);
+	}
+#ifdef HAVE_PTHREAD_PROCESS_SHARED
+	zbx_locks_disable();
+#endif
+	free_metrics();
+#ifdef HAVE_OPENIPMI
+	zbx_ipc_service_free_env();
+#endif
+	DBconnect(ZBX_DB_CONNECT_EXIT);
+	free_database_cache();
+	free_configuration_cache();
+	DBclose();
+	DBdeinit();
+	if (0 != CONFIG_VMWARE_FORKS)
+		zbx_vmware_destroy();
+	free_selfmon_collector();
+	free_proxy_history_lock();
+	zbx_unload_modules();
+	zabbix_log(LOG_LEVEL_INFORMATION, "Zabbix Proxy stopped. Zabbix %s (revision %s).",
+			ZABBIX_VERSION, ZABBIX_REVISION);
+	zabbix_close_log();
+#if defined(PS_OVERWRITE_ARGV)
+	setproctitle_free_env();
+#endif
+				exit(EXIT_SUCCESS);
+	}
+
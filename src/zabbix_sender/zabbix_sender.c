@@ -172,6 +172,11 @@ const char	*help_message[] = {
 	"                             received. This can be used when reading from",
 	"                             standard input",
 	"",
+	"  --bulk                     Send values from input file as newline",
+	"                             delimited records instead of a single JSON",
+	"                             request, up to 10000 values per connection.",
+	"                             This can be used with --input-file option only",
+	"",
 	"  -v --verbose               Verbose mode, -vv for more details",
 	"",
 	"  -h --help                  Display this help message",
@@ -302,6 +307,7 @@ static struct zbx_option	longopts[] =
 	{"tls-psk-file",		1,	NULL,	'9'},
 	{"tls-cipher13",		1,	NULL,	'A'},
 	{"tls-cipher",			1,	NULL,	'B'},
+	{"bulk",			0,	NULL,	'C'},
 	{NULL}
 };
 
@@ -315,6 +321,7 @@ static int	CONFIG_LOG_LEVEL = LOG_LEVEL_CRIT;
 static char	*INPUT_FILE = NULL;
 static int	WITH_TIMESTAMPS = 0;
 static int	REAL_TIME = 0;
+static int	BULK = 0;
 
 static char		*CONFIG_SOURCE_IP = NULL;
 static char		*ZABBIX_SERVER = NULL;
@@ -376,6 +383,9 @@ typedef struct
 	ZBX_THREAD_SENDVAL_TLS_ARGS	tls_vars;
 #endif
 	int		sync_timestamp;
+	char		*bulk_data;	/* newline delimited value records, NULL if values are sent in JSON */
+	size_t		bulk_data_alloc;
+	size_t		bulk_data_offset;
 }
 ZBX_THREAD_SENDVAL_ARGS;
 
@@ -652,7 +662,7 @@ static	ZBX_THREAD_ENTRY(send_value, args)
 	if (SUCCEED == (tcp_ret = zbx_tcp_connect(&sock, CONFIG_SOURCE_IP, sendval_args->server, sendval_args->port,
 			GET_SENDER_TIMEOUT, configured_tls_connect_mode, tls_arg1, tls_arg2)))
 	{
-		if (1 == sendval_args->sync_timestamp)
+		if (NULL == sendval_args->bulk_data && 1 == sendval_args->sync_timestamp)
 		{
 			zbx_timespec_t	ts;
 
@@ -662,7 +672,8 @@ static	ZBX_THREAD_ENTRY(send_value, args)
 			zbx_json_adduint64(&sendval_args->json, ZBX_PROTO_TAG_NS, ts.ns);
 		}
 
-		if (SUCCEED == (tcp_ret = zbx_tcp_send(&sock, sendval_args->json.buffer)))
+		if (SUCCEED == (tcp_ret = zbx_tcp_send(&sock, NULL != sendval_args->bulk_data ?
+				sendval_args->bulk_data : sendval_args->json.buffer)))
 		{
 			if (SUCCEED == (tcp_ret = zbx_tcp_recv(&sock)))
 			{
@@ -890,6 +901,9 @@ static void	parse_commandline(int argc, char **argv)
 			case 'r':
 				REAL_TIME = 1;
 				break;
+			case 'C':
+				BULK = 1;
+				break;
 			case 'v':
 				if (LOG_LEVEL_WARNING > CONFIG_LOG_LEVEL)
 					CONFIG_LOG_LEVEL = LOG_LEVEL_WARNING;
@@ -1177,6 +1191,13 @@ static void	parse_commandline(int argc, char **argv)
 		exit(EXIT_FAILURE);
 	}
 
+	if (0 < opt_count['C'] && 0 == opt_count['i'])
+	{
+		zbx_error("option \"--bulk\" can be used only together with \"-i\" or \"--input-file\"");
+		usage();
+		exit(EXIT_FAILURE);
+	}
+
 	/* Parameters which are not option values are invalid. The check relies on zbx_getopt_internal() which */
 	/* always permutes command line arguments regardless of POSIXLY_CORRECT environment variable. */
 	if (argc > zbx_optind)
@@ -1243,6 +1264,24 @@ static char *zbx_fgets_alloc(char **buffer, size_t *buffer_alloc, FILE *fp)
 /* take long and hit timeout, so we limit values to 250 per connection */
 #define VALUES_MAX	250
 
+/* bulk data is processed in batches while being parsed, so more values */
+/* can be sent in a single connection                                   */
+#define BULK_VALUES_MAX	10000
+
+/******************************************************************************
+ *                                                                            *
+ * Function: sender_bulk_reset                                                *
+ *                                                                            *
+ * Purpose: resets bulk data buffer to contain only the bulk data header      *
+ *                                                                            *
+ ******************************************************************************/
+static void	sender_bulk_reset(ZBX_THREAD_SENDVAL_ARGS *sendval_args)
+{
+	sendval_args->bulk_data_offset = 0;
+	zbx_strcpy_alloc(&sendval_args->bulk_data, &sendval_args->bulk_data_alloc, &sendval_args->bulk_data_offset,
+			ZBX_PROTO_VALUE_SENDER_BULK_DATA "\n");
+}
+
 int	main(int argc, char **argv)
 {
 	FILE			*in;
@@ -1256,6 +1295,7 @@ int	main(int argc, char **argv)
 	zbx_thread_args_t	thread_args;		// 定义一个zbx_thread_args结构体的变量thread_args，用于存储线程参数
 	ZBX_THREAD_SENDVAL_ARGS sendval_args;	// 定义一个ZBX_THREAD_SENDVAL_ARGS结构体的变量sendval_args，用于存储发送数据所需参数
 	ZBX_THREAD_HANDLE	thread;			// 定义一个ZBX_THREAD_HANDLE结构体的变量thread，用于存储线程句柄
+	struct zbx_json		bulk_record;
 
 	progname = get_program_name(argv[0]);	// 从命令行参数中获取程序名
 
@@ -1342,6 +1382,9 @@ int	main(int argc, char **argv)
 	zbx_json_addstring(&sendval_args.json, ZBX_PROTO_TAG_REQUEST, ZBX_PROTO_VALUE_SENDER_DATA, ZBX_JSON_TYPE_STRING);
 	zbx_json_addarray(&sendval_args.json, ZBX_PROTO_TAG_DATA);
 
+	sendval_args.bulk_data = NULL;
+	sendval_args.bulk_data_alloc = 0;
+
 	if (INPUT_FILE)	// 如果指定了输入文件
 	{
 		if (0 == strcmp(INPUT_FILE, "-"))	// 如果输入文件是标准输入
@@ -1362,6 +1405,12 @@ int	main(int argc, char **argv)
 		sendval_args.sync_timestamp = WITH_TIMESTAMPS;
 		in_line = (char *)zbx_malloc(NULL, in_line_alloc);
 
+		if (1 == BULK)
+		{
+			sender_bulk_reset(&sendval_args);
+			zbx_json_init(&bulk_record, ZBX_JSON_STAT_BUF_LEN);
+		}
+
 		ret = SUCCEED;
 
 		while ((SUCCEED == ret || SUCCEED_PARTIAL == ret) &&
@@ -1443,13 +1492,32 @@ int	main(int argc, char **argv)
 				break;
 			}
 
-			zbx_json_addobject(&sendval_args.json, NULL);
-			zbx_json_addstring(&sendval_args.json, ZBX_PROTO_TAG_HOST, hostname, ZBX_JSON_TYPE_STRING);
-			zbx_json_addstring(&sendval_args.json, ZBX_PROTO_TAG_KEY, key, ZBX_JSON_TYPE_STRING);
-			zbx_json_addstring(&sendval_args.json, ZBX_PROTO_TAG_VALUE, key_value, ZBX_JSON_TYPE_STRING);
-			if (1 == WITH_TIMESTAMPS)
-				zbx_json_adduint64(&sendval_args.json, ZBX_PROTO_TAG_CLOCK, timestamp);
-			zbx_json_close(&sendval_args.json);
+			if (1 == BULK)
+			{
+				zbx_json_addstring(&bulk_record, ZBX_PROTO_TAG_HOST, hostname, ZBX_JSON_TYPE_STRING);
+				zbx_json_addstring(&bulk_record, ZBX_PROTO_TAG_KEY, key, ZBX_JSON_TYPE_STRING);
+				zbx_json_addstring(&bulk_record, ZBX_PROTO_TAG_VALUE, key_value, ZBX_JSON_TYPE_STRING);
+				if (1 == WITH_TIMESTAMPS)
+					zbx_json_adduint64(&bulk_record, ZBX_PROTO_TAG_CLOCK, timestamp);
+
+				zbx_strcpy_alloc(&sendval_args.bulk_data, &sendval_args.bulk_data_alloc,
+						&sendval_args.bulk_data_offset, bulk_record.buffer);
+				zbx_chrcpy_alloc(&sendval_args.bulk_data, &sendval_args.bulk_data_alloc,
+						&sendval_args.bulk_data_offset, '\n');
+				zbx_json_clean(&bulk_record);
+			}
+			else
+			{
+				zbx_json_addobject(&sendval_args.json, NULL);
+				zbx_json_addstring(&sendval_args.json, ZBX_PROTO_TAG_HOST, hostname,
+						ZBX_JSON_TYPE_STRING);
+				zbx_json_addstring(&sendval_args.json, ZBX_PROTO_TAG_KEY, key, ZBX_JSON_TYPE_STRING);
+				zbx_json_addstring(&sendval_args.json, ZBX_PROTO_TAG_VALUE, key_value,
+						ZBX_JSON_TYPE_STRING);
+				if (1 == WITH_TIMESTAMPS)
+					zbx_json_adduint64(&sendval_args.json, ZBX_PROTO_TAG_CLOCK, timestamp);
+				zbx_json_close(&sendval_args.json);
+			}
 
 			succeed_count++;
 			buffer_count++;
@@ -1481,7 +1549,8 @@ int	main(int argc, char **argv)
 				}
 			}
 
-			if (VALUES_MAX == buffer_count || (stdin == in && 1 == REAL_TIME && 0 >= read_more))
+			if ((1 == BULK ? BULK_VALUES_MAX : VALUES_MAX) == buffer_count ||
+					(stdin == in && 1 == REAL_TIME && 0 >= read_more))
 			{
 				zbx_json_close(&sendval_args.json);
 
@@ -1490,6 +1559,10 @@ int	main(int argc, char **argv)
 				ret = update_exit_status(ret, zbx_thread_wait(thread));
 
 				buffer_count = 0;
+
+				if (1 == BULK)
+					sender_bulk_reset(&sendval_args);
+
 				zbx_json_clean(&sendval_args.json);
 				zbx_json_addstring(&sendval_args.json, ZBX_PROTO_TAG_REQUEST, ZBX_PROTO_VALUE_SENDER_DATA,
 						ZBX_JSON_TYPE_STRING);
@@ -1509,6 +1582,12 @@ int	main(int argc, char **argv)
 
 		zbx_free(key_value);
 		zbx_free(in_line);
+
+		if (1 == BULK)
+		{
+			zbx_json_free(&bulk_record);
+			zbx_free(sendval_args.bulk_data);
+		}
 	}
 	else
 	{
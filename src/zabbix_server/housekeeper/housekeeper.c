@@ -150,6 +150,9 @@ typedef struct
 
 	/* the item delete queue */
 	zbx_vector_ptr_t	delete_queue;
+
+	/* the longest storage period of items in target table, -1 if there are no items */
+	int			history_max;
 }
 zbx_hk_history_rule_t;
 
@@ -198,12 +201,10 @@ static void zbx_housekeeper_sigusr_handler(int flags)
             zbx_wakeup();
         }
         else
-        {
             // 输出警告日志，表示housekeeping进程已经在进行中
             zabbix_log(LOG_LEVEL_WARNING, "housekeeping procedure is already in progress");
         }
     }
-}
 
 
 /******************************************************************************
@@ -237,6 +238,8 @@ static int hk_item_update_cache_compare(const void *d1, const void *d2)
 
 	// 判断 r1 和 r2 指向的元素 itemid 是否相等，如果不相等，则返回 1（表示不相等）
 	ZBX_RETURN_IF_NOT_EQUAL(r1->itemid, r2->itemid);
+	return 0;
+}
 /******************************************************************************
  * *
  *整个代码块的主要目的是：当处理历史数据时，根据规则规则和item记录，计算需要保留的时间戳，并更新item记录中的最小时间戳。同时，将新的删除队列元素添加到规则的删除队列中。
@@ -244,45 +247,29 @@ static int hk_item_update_cache_compare(const void *d1, const void *d2)
 /* 定义一个静态函数hk_history_delete_queue_append，参数包括一个zbx_hk_history_rule_t类型的指针rule，一个int类型的now，一个zbx_hk_item_cache_t类型的指针item_record，以及一个int类型的history。
 */
 static void	hk_history_delete_queue_append(zbx_hk_history_rule_t *rule, int now,
-		zbx_hk_item_cache_t *item_record, int history)
-{
 	/* 定义一个整型变量keep_from，用于计算保留的时间戳。
 	*/
-	int	keep_from;
 
 	/* 如果history大于now，说明不存在负时间戳的记录，无需执行任何操作，直接返回。
 	*/
-	if (history > now)
-		return;
 
 	/* 计算keep_from，即now减去history。
 	*/
-	keep_from = now - history;
 
 	/* 如果keep_from大于item_record中的最小时间戳，
 	 * 则更新item_record中的最小时间戳，并添加一个新的删除队列元素。
 	*/
-	if (keep_from > item_record->min_clock)
-	{
 		/* 分配一个新的zbx_hk_delete_queue_t结构体内存空间。
 		*/
-		zbx_hk_delete_queue_t	*update_record;
 
 		/* 更新item_record中的最小时间戳，取keep_from和hk_period（最大删除周期）的较小值。
 		*/
-		item_record->min_clock = MIN(keep_from, item_record->min_clock + HK_MAX_DELETE_PERIODS * hk_period);
 
 		/* 初始化新分配的删除队列元素。
 		*/
-		update_record = (zbx_hk_delete_queue_t *)zbx_malloc(NULL, sizeof(zbx_hk_delete_queue_t));
-		update_record->itemid = item_record->itemid;
-		update_record->min_clock = item_record->min_clock;
 
 		/* 将新分配的删除队列元素添加到rule的删除队列中。
 		*/
-		zbx_vector_ptr_append(&rule->delete_queue, update_record);
-	}
-}
 
 		zbx_hk_item_cache_t *item_record, int history)
 {
@@ -346,18 +333,11 @@ static void hk_history_prepare(zbx_hk_history_rule_t *rule)
         zbx_hk_item_cache_t item_record;
 
         ZBX_STR2UINT64(itemid, row[0]);
-        min_clock = atoi(row[1]);
 
         // 构建item_record结构体并填充数据
-        item_record.itemid = itemid;
-        item_record.min_clock = min_clock;
 
         // 将item_record插入到rule->item_cache中
-        zbx_hashset_insert(&rule->item_cache, &item_record, sizeof(zbx_hk_item_cache_t));
-    }
     // 释放查询结果
-    DBfree_result(result);
-}
 
 		min_clock = atoi(row[1]);
 
@@ -384,139 +364,118 @@ static void hk_history_prepare(zbx_hk_history_rule_t *rule)
  *           for the table referred by this rule.                             *
  *                                                                            *
  ******************************************************************************/
+static void	hk_history_release(zbx_hk_history_rule_t *rule)
+{
+	if (0 == rule->item_cache.num_slots)
+		return;
+
+	zbx_hashset_destroy(&rule->item_cache);
+	zbx_vector_ptr_destroy(&rule->delete_queue);
+}
 /******************************************************************************
  * *
  *整个代码块的主要目的是：销毁一个zbx_hk_history_rule类型结构体中的item_cache哈希表和delete_queue队列。当item_cache不为空时，执行销毁操作。如果item_cache为空，则直接返回，不执行任何操作。
  ******************************************************************************/
 // 定义一个静态函数hk_history_release，参数为一个zbx_hk_history_rule_t类型的指针rule
-static void hk_history_release(zbx_hk_history_rule_t *rule)
+static void	hk_history_item_update(zbx_hk_history_rule_t *rules, zbx_hk_history_rule_t *rule_add, int count,
+		int now, zbx_uint64_t itemid, int history)
 {
+	zbx_hk_history_rule_t	*rule;
+
+	/* item can be cached in multiple rules when value type has been changed */
+	for (rule = rules; rule - rules < count; rule++)
+	{
+		zbx_hk_item_cache_t	*item_record;
+
+		if (0 == rule->item_cache.num_slots)
+			continue;
+
+		if (NULL == (item_record = (zbx_hk_item_cache_t *)zbx_hashset_search(&rule->item_cache, &itemid)))
+		{
+			zbx_hk_item_cache_t	item_data = {itemid, now};
+
+			if (rule_add != rule)
+				continue;
+
+			if (NULL == (item_record = (zbx_hk_item_cache_t *)zbx_hashset_insert(&rule->item_cache,
+					&item_data, sizeof(zbx_hk_item_cache_t))))
+			{
+				continue;
+			}
+		}
+
+		hk_history_delete_queue_append(rule, now, item_record, history);
+	}
+}
 /******************************************************************************
  * *
- *这段代码的主要目的是更新历史数据和趋势数据。它接收一个zbx_hk_history_rule_t类型的指针（表示规则列表）和一个int类型的值now（表示当前时间）。在循环读取数据库查询结果的过程中，代码会逐行解析数据，提取itemid、hostid、value_type、history和trends等信息。然后根据这些信息，判断是否符合条件，并更新相应的历史数据和趋势数据。如果数据不符合条件，代码会记录日志并继续处理下一行数据。最后，释放数据库查询结果和临时字符串tmp。
- ******************************************************************************/
+ * Function: hk_history_update                                                *
+ *                                                                            *
+ * Purpose: updates history housekeeping rule with the latest item history    *
+ *          settings and prepares delete queue                                *
+ *                                                                            *
+ * Parameters: rule  - [IN/OUT] the history housekeeping rule                 *
+ *             now   - [IN] the current timestamp                             *
 // 定义一个静态函数hk_history_update，输入参数为一个zbx_hk_history_rule_t类型的指针和一個int类型的值now。
-static void hk_history_update(zbx_hk_history_rule_t *rules, int now)
-{
 	// 声明一个DB_RESULT类型的变量result，用于存储数据库查询结果
-	DB_RESULT	result;
 	// 声明一个DB_ROW类型的变量row，用于存储数据库行的数据
-	DB_ROW		row;
 	// 声明一个char类型的指针变量tmp，用于存储字符串
-	char		*tmp = NULL;
 
 	// 执行数据库查询，查询符合条件的数据
-	result = DBselect(
-			"select i.itemid,i.value_type,i.history,i.trends,h.hostid"
-			" from items i,hosts h"
-			" where i.flags in (%d,%d)"
-				" and i.hostid=h.hostid"
-				" and h.status in (%d,%d)",
-			ZBX_FLAG_DISCOVERY_NORMAL, ZBX_FLAG_DISCOVERY_CREATED,
-			HOST_STATUS_MONITORED, HOST_STATUS_NOT_MONITORED);
 
 	// 循环读取数据库查询结果中的每一行
-	while (NULL != (row = DBfetch(result)))
-	{
 		// 解析行数据，提取itemid、hostid、value_type、history和trends
-		zbx_uint64_t		itemid, hostid;
-		int			history, trends, value_type;
-		zbx_hk_history_rule_t	*rule;
 
-		ZBX_STR2UINT64(itemid, row[0]);
-		value_type = atoi(row[1]);
-		ZBX_STR2UINT64(hostid, row[4]);
 
 		// 判断value_type是否在有效的范围之内，并且对应的选项模式是否启用
-		if (value_type < ITEM_VALUE_TYPE_MAX &&
-				ZBX_HK_OPTION_DISABLED != *(rule = rules + value_type)->poption_mode)
-		{
 			// 为history存储一个临时字符串
-			tmp = zbx_strdup(tmp, row[2]);
 			// 替换hostid和history对应的宏
-			substitute_simple_macros(NULL, NULL, NULL, NULL, &hostid, NULL, NULL, NULL, NULL, &tmp,
-					MACRO_TYPE_COMMON, NULL, 0);
 
 			// 判断history存储周期是否合法，如果合法，则更新history
-			if (SUCCEED != is_time_suffix(tmp, &history, ZBX_LENGTH_UNLIMITED))
-			{
 				// 记录日志，提示 invalid history storage period
-				zabbix_log(LOG_LEVEL_WARNING, "invalid history storage period '%s' for itemid '%s'",
-						tmp, row[0]);
 				// 继续处理下一行数据
-				continue;
-			}
 
 			// 判断history值是否在有效的范围之内，如果不在范围内，则记录日志并继续处理下一行数据
-			if (0 != history && (ZBX_HK_HISTORY_MIN > history || ZBX_HK_PERIOD_MAX < history))
-			{
-				zabbix_log(LOG_LEVEL_WARNING, "invalid history storage period for itemid '%s'", row[0]);
 				// 继续处理下一行数据
-				continue;
-			}
 
 			// 如果history值合法且global选项启用，则更新history值
-			if (0 != history && ZBX_HK_OPTION_DISABLED != *rule->poption_global)
-				history = *rule->poption;
 
 			// 更新history数据
-			hk_history_item_update(rules, rule, ITEM_VALUE_TYPE_MAX, now, itemid, history);
-		}
 
 		// 处理float和uint64类型的数据
-		if (ITEM_VALUE_TYPE_FLOAT == value_type || ITEM_VALUE_TYPE_UINT64 == value_type)
-		{
 			// 判断选项模式是否启用
-			if (ZBX_HK_OPTION_DISABLED == *rule = rules + (value_type == ITEM_VALUE_TYPE_FLOAT ?
-					HK_UPDATE_CACHE_OFFSET_TREND_FLOAT : HK_UPDATE_CACHE_OFFSET_TREND_UINT))
-				continue;
 
 			// 存储trends字符串
-			tmp = zbx_strdup(tmp, row[3]);
 			// 替换hostid和trends对应的宏
-			substitute_simple_macros(NULL, NULL, NULL, NULL, &hostid, NULL, NULL, NULL, NULL, &tmp,
-					MACRO_TYPE_COMMON, NULL, 0);
 
 			// 判断trends存储周期是否合法，如果合法，则更新trends
-			if (SUCCEED != is_time_suffix(tmp, &trends, ZBX_LENGTH_UNLIMITED))
-			{
 				// 记录日志，提示 invalid trends storage period
-				zabbix_log(LOG_LEVEL_WARNING, "invalid trends storage period '%s' for itemid '%s'",
-						tmp, row[0]);
 				// 继续处理下一行数据
-				continue;
-			}
-			else if (0 != trends && (ZBX_HK_TRENDS_MIN > trends || ZBX_HK_PERIOD_MAX < trends))
-			{
 				// 记录日志，提示 invalid trends storage period
-				zabbix_log(LOG_LEVEL_WARNING, "invalid trends storage period for itemid '%s'", row[0]);
 				// 继续处理下一行数据
-				continue;
-			}
 
 			// 如果trends值合法且global选项启用，则更新trends值
-			if (0 != trends && ZBX_HK_OPTION_DISABLED != *rule->poption_global)
-				trends = *rule->poption;
 
 			// 更新trends数据
-			hk_history_item_update(rules + HK_UPDATE_CACHE_OFFSET_TREND_FLOAT, rule,
-					HK_UPDATE_CACHE_TREND_COUNT, now, itemid, trends);
-		}
-	}
 	// 释放数据库查询结果
-	DBfree_result(result);
 
 	// 释放临时字符串tmp
-	zbx_free(tmp);
-}
 
  *                                                                            *
  ******************************************************************************/
+/******************************************************************************
+ * *
+ *这段代码的主要目的是更新历史数据和趋势数据。它接收一个zbx_hk_history_rule_t类型的指针（表示规则列表）和一个int类型的值now（表示当前时间）。在循环读取数据库查询结果的过程中，代码会逐行解析数据，提取itemid、hostid、value_type、history和trends等信息。然后根据这些信息，判断是否符合条件，并更新相应的历史数据和趋势数据。如果数据不符合条件，代码会记录日志并继续处理下一行数据。最后，释放数据库查询结果和临时字符串tmp。
+ ******************************************************************************/
 static void	hk_history_update(zbx_hk_history_rule_t *rules, int now)
 {
 	DB_RESULT	result;
 	DB_ROW		row;
 	char		*tmp = NULL;
+	zbx_hk_history_rule_t	*rule;
+
+	for (rule = rules; NULL != rule->table; rule++)
+		rule->history_max = -1;
 
 	result = DBselect(
 			"select i.itemid,i.value_type,i.history,i.trends,h.hostid"
@@ -560,6 +519,7 @@ static void	hk_history_update(zbx_hk_history_rule_t *rules, int now)
 			if (0 != history && ZBX_HK_OPTION_DISABLED != *rule->poption_global)
 				history = *rule->poption;
 
+			rule->history_max = MAX(rule->history_max, history);
 			hk_history_item_update(rules, rule, ITEM_VALUE_TYPE_MAX, now, itemid, history);
 		}
 
@@ -590,6 +550,7 @@ static void	hk_history_update(zbx_hk_history_rule_t *rules, int now)
 			if (0 != trends && ZBX_HK_OPTION_DISABLED != *rule->poption_global)
 				trends = *rule->poption;
 
+			rule->history_max = MAX(rule->history_max, trends);
 			hk_history_item_update(rules + HK_UPDATE_CACHE_OFFSET_TREND_FLOAT, rule,
 					HK_UPDATE_CACHE_TREND_COUNT, now, itemid, trends);
 		}
@@ -620,7 +581,7 @@ static void	hk_history_update(zbx_hk_history_rule_t *rules, int now)
  *整个代码块的主要目的是遍历rules数组中的每个元素，根据选项模式的不同，对item_cache进行预处理或释放资源，然后调用hk_history_update()函数更新历史数据。
  ******************************************************************************/
 // 定义一个静态函数hk_history_delete_queue_prepare_all，参数为一个指向zbx_hk_history_rule_t结构体的指针rules和整数now
-static void hk_history_delete_queue_prepare_all(zbx_hk_history_t *rules, int now)
+static void	hk_history_delete_queue_prepare_all(zbx_hk_history_rule_t *rules, int now)
 {
 	// 定义一个常量字符串，表示函数名
 	const char *__function_name = "hk_history_delete_queue_prepare_all";
@@ -666,8 +627,329 @@ static void hk_history_delete_queue_prepare_all(zbx_hk_history_t *rules, int now
  * Author: Andris Zeila                                                       *
  *                                                                            *
  ******************************************************************************/
+static void	hk_history_delete_queue_clear(zbx_hk_history_rule_t *rule)
+{
+	zbx_vector_ptr_clear_ext(&rule->delete_queue, zbx_ptr_free);
+}
+
+#if defined(HAVE_MYSQL) || defined(HAVE_POSTGRESQL)
+/* time range partition of history or trends table */
+typedef struct
+{
+	char	*name;
+
+	/* the partition range [clock_from, clock_to) */
+	int	clock_from;
+	int	clock_to;
+}
+zbx_hk_partition_t;
+
 /******************************************************************************
- * *
+ *                                                                            *
+ * Function: hk_partition_free                                                *
+ *                                                                            *
+ * Purpose: frees time range partition                                        *
+ *                                                                            *
+ * Parameters: partition - [IN] the partition to free                         *
+ *                                                                            *
+ ******************************************************************************/
+static void	hk_partition_free(zbx_hk_partition_t *partition)
+{
+	zbx_free(partition->name);
+	zbx_free(partition);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: hk_partition_compare                                             *
+ *                                                                            *
+ * Purpose: compares time range partitions by range end                       *
+ *                                                                            *
+ * Parameters: d1 - [IN] the first partition                                  *
+ *             d2 - [IN] the second partition                                 *
+ *                                                                            *
+ * Return value: <0 - the first partition ends before the second one          *
+ *                0 - the partitions end at the same time                     *
+ *               >0 - the first partition ends after the second one           *
+ *                                                                            *
+ ******************************************************************************/
+static int	hk_partition_compare(const void *d1, const void *d2)
+{
+	const zbx_hk_partition_t	*p1 = *(const zbx_hk_partition_t **)d1;
+	const zbx_hk_partition_t	*p2 = *(const zbx_hk_partition_t **)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(p1->clock_to, p2->clock_to);
+
+	return 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: hk_partition_add                                                 *
+ *                                                                            *
+ * Purpose: adds time range partition to the partition vector                 *
+ *                                                                            *
+ * Parameters: partitions - [IN/OUT] the partitions                           *
+ *             name       - [IN] the partition name                           *
+ *             clock_from - [IN] the partition range start (inclusive)        *
+ *             clock_to   - [IN] the partition range end (exclusive)          *
+ *                                                                            *
+ ******************************************************************************/
+static void	hk_partition_add(zbx_vector_ptr_t *partitions, const char *name, int clock_from, int clock_to)
+{
+	zbx_hk_partition_t	*partition;
+
+	partition = (zbx_hk_partition_t *)zbx_malloc(NULL, sizeof(zbx_hk_partition_t));
+	partition->name = zbx_strdup(NULL, name);
+	partition->clock_from = clock_from;
+	partition->clock_to = clock_to;
+	zbx_vector_ptr_append(partitions, partition);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: hk_partitions_get                                                *
+ *                                                                            *
+ * Purpose: reads time range partitions of history or trends table            *
+ *                                                                            *
+ * Parameters: table      - [IN] the partitioned table name                   *
+ *             partitions - [OUT] the partitions sorted by range end          *
+ *                                                                            *
+ * Return value: SUCCEED - the table is partitioned by range                  *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: Only partitions with numeric bounds are returned. Default        *
+ *           (PostgreSQL) and MAXVALUE (MySQL) partitions are never dropped,  *
+ *           MAXVALUE partition also prevents creation of new partitions.     *
+ *                                                                            *
+ ******************************************************************************/
+static int	hk_partitions_get(const char *table, zbx_vector_ptr_t *partitions)
+{
+	DB_RESULT	result;
+	DB_ROW		row;
+	int		ret = FAIL, clock_from = 0, clock_to;
+
+#if defined(HAVE_POSTGRESQL)
+	result = DBselect("select relkind from pg_class where relname='%s' and pg_table_is_visible(oid)", table);
+
+	if (NULL != (row = DBfetch(result)) && 'p' == *row[0])
+		ret = SUCCEED;
+
+	DBfree_result(result);
+
+	if (SUCCEED != ret)
+		return FAIL;
+
+	result = DBselect(
+			"select c.relname,pg_get_expr(c.relpartbound,c.oid)"
+			" from pg_inherits i,pg_class c,pg_class p"
+			" where i.inhrelid=c.oid"
+				" and i.inhparent=p.oid"
+				" and p.relname='%s'"
+				" and pg_table_is_visible(p.oid)",
+			table);
+
+	while (NULL != (row = DBfetch(result)))
+	{
+		if (2 != sscanf(row[1], "FOR VALUES FROM (%d) TO (%d)", &clock_from, &clock_to))
+			continue;
+
+		hk_partition_add(partitions, row[0], clock_from, clock_to);
+	}
+#else
+	result = DBselect(
+			"select partition_name,partition_description"
+			" from information_schema.partitions"
+			" where table_schema=database()"
+				" and table_name='%s'"
+				" and partition_method like 'RANGE%%'"
+			" order by partition_ordinal_position",
+			table);
+
+	while (NULL != (row = DBfetch(result)))
+	{
+		ret = SUCCEED;
+
+		/* MAXVALUE partition covers all future values, keep it as the last one */
+		if (SUCCEED != is_uint31(row[1], &clock_to))
+			clock_to = INT_MAX;
+
+		hk_partition_add(partitions, row[0], clock_from, clock_to);
+		clock_from = clock_to;
+	}
+#endif
+	DBfree_result(result);
+
+	zbx_vector_ptr_sort(partitions, hk_partition_compare);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: hk_partitions_create                                             *
+ *                                                                            *
+ * Purpose: creates partitions for the current and the next periods           *
+ *                                                                            *
+ * Parameters: table      - [IN] the partitioned table name                   *
+ *             partitions - [IN/OUT] the existing partitions, the created     *
+ *                          partitions are added to them                      *
+ *             now        - [IN] the current timestamp                        *
+ *                                                                            *
+ * Comments: The partitions are created for HousekeepingPartitionsAhead       *
+ *           periods of HousekeepingPartitionPeriod hours. Partition ranges   *
+ *           are limited to timestamps that fit in the clock column.          *
+ *                                                                            *
+ ******************************************************************************/
+static void	hk_partitions_create(const char *table, zbx_vector_ptr_t *partitions, int now)
+{
+	int		period, clock_from, clock_to, i;
+	zbx_int64_t	clock, clock_end;
+	char		name[ZBX_TABLENAME_LEN_MAX + ZBX_MAX_UINT64_LEN];
+
+	period = CONFIG_HOUSEKEEPING_PARTITION_PERIOD * SEC_PER_HOUR;
+
+	/* up to 365 periods of 720 hours ahead do not fit in int, the last partition must end before INT_MAX */
+	clock_end = (zbx_int64_t)now + (zbx_int64_t)CONFIG_HOUSEKEEPING_PARTITIONS_AHEAD * period;
+
+	if (clock_end > (zbx_int64_t)INT_MAX - period)
+		clock_end = (zbx_int64_t)INT_MAX - period;
+
+	for (clock = now - now % period; clock <= clock_end; clock += period)
+	{
+		clock_from = (int)clock;
+		clock_to = (int)(clock + period);
+#if defined(HAVE_POSTGRESQL)
+		for (i = 0; i < partitions->values_num; i++)
+		{
+			const zbx_hk_partition_t	*partition = (const zbx_hk_partition_t *)partitions->values[i];
+
+			if (partition->clock_from < clock_to && clock_from < partition->clock_to)
+				break;
+		}
+
+		if (i != partitions->values_num)
+			continue;
+
+		zbx_snprintf(name, sizeof(name), "%s_p%d", table, clock_from);
+
+		if (ZBX_DB_OK > DBexecute("create table %s partition of %s for values from (%d) to (%d)",
+				name, table, clock_from, clock_to))
+		{
+			break;
+		}
+#else
+		/* range partitions can only be appended after the last one */
+		if (0 != (i = partitions->values_num))
+			clock_from = MAX(clock_from, ((const zbx_hk_partition_t *)partitions->values[i - 1])->clock_to);
+
+		if (clock_from >= clock_to)
+			continue;
+
+		zbx_snprintf(name, sizeof(name), "p%d", clock_from);
+
+		if (ZBX_DB_OK > DBexecute("alter table %s add partition (partition %s values less than (%d))",
+				table, name, clock_to))
+		{
+			break;
+		}
+#endif
+		zabbix_log(LOG_LEVEL_DEBUG, "created partition \"%s\" of table \"%s\" for period [%d,%d)", name, table,
+				clock_from, clock_to);
+
+		hk_partition_add(partitions, name, clock_from, clock_to);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: hk_partitions_drop                                               *
+ *                                                                            *
+ * Purpose: drops partitions containing only expired records                  *
+ *                                                                            *
+ * Parameters: table      - [IN] the partitioned table name                   *
+ *             partitions - [IN] the existing partitions                      *
+ *             keep_from  - [IN] the oldest timestamp to keep                 *
+ *                                                                            *
+ ******************************************************************************/
+static void	hk_partitions_drop(const char *table, const zbx_vector_ptr_t *partitions, int keep_from)
+{
+	int	i, rc;
+
+	for (i = 0; i < partitions->values_num; i++)
+	{
+		const zbx_hk_partition_t	*partition = (const zbx_hk_partition_t *)partitions->values[i];
+
+		if (partition->clock_to > keep_from)
+			break;
+#if defined(HAVE_POSTGRESQL)
+		rc = DBexecute("drop table %s", partition->name);
+#else
+		rc = DBexecute("alter table %s drop partition %s", table, partition->name);
+#endif
+		if (ZBX_DB_OK > rc)
+			break;
+
+		zabbix_log(LOG_LEVEL_WARNING, "dropped partition \"%s\" of table \"%s\" with records older than %d",
+				partition->name, table, partition->clock_to);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: hk_history_partitions_update                                     *
+ *                                                                            *
+ * Purpose: maintains time range partitions of history (trends) table         *
+ *                                                                            *
+ * Parameters: rule      - [IN] the history housekeeping rule                 *
+ *             now       - [IN] the current timestamp                         *
+ *             keep_from - [OUT] records older than this timestamp are        *
+ *                         removed by dropping partitions                     *
+ *                                                                            *
+ * Return value: SUCCEED - the table is partitioned                           *
+ *               FAIL    - the table is not partitioned                       *
+ *                                                                            *
+ * Comments: Partitions are kept for the longest item storage period of the   *
+ *           table, the items with shorter storage periods still must be      *
+ *           housekept by deleting their records.                             *
+ *                                                                            *
+ ******************************************************************************/
+static int	hk_history_partitions_update(const zbx_hk_history_rule_t *rule, int now, int *keep_from)
+{
+	const char		*__function_name = "hk_history_partitions_update";
+
+	zbx_vector_ptr_t	partitions;
+	int			ret;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() table:'%s' history_max:%d", __function_name, rule->table,
+			rule->history_max);
+
+	zbx_vector_ptr_create(&partitions);
+
+	*keep_from = 0;
+
+	if (SUCCEED == (ret = hk_partitions_get(rule->table, &partitions)))
+	{
+		hk_partitions_create(rule->table, &partitions, now);
+
+		/* do not drop anything if storage periods are not known yet */
+		if (0 <= rule->history_max && rule->history_max < now)
+		{
+			*keep_from = now - rule->history_max;
+			hk_partitions_drop(rule->table, &partitions, *keep_from);
+		}
+	}
+
+	zbx_vector_ptr_clear_ext(&partitions, (zbx_mem_free_func_t)hk_partition_free);
+	zbx_vector_ptr_destroy(&partitions);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s keep_from:%d", __function_name, zbx_result_string(ret),
+			*keep_from);
+
+	return ret;
+}
+#endif
+
 /******************************************************************************
  * *
  *整个代码块的主要目的是处理历史整理规则，包括准备删除队列、遍历规则、执行数据库删除操作以及清空删除队列。在这个过程中，统计了删除操作的计数并将其返回。
@@ -679,7 +961,7 @@ static int housekeeping_history_and_trends(int now)
 	const char *__function_name = "housekeeping_history_and_trends";
 
 	// 定义一些变量，如 deleted（删除计数）、i（循环计数）、rc（数据库操作返回值）以及指向 zbx_hk_history_rule_t 结构体的指针 rule
-	int			deleted = 0, i, rc;
+	int			deleted = 0, i, rc, keep_from;
 	zbx_hk_history_rule_t	*rule;
 
 	// 记录日志，表示函数开始调用
@@ -695,6 +977,14 @@ static int housekeeping_history_and_trends(int now)
 		if (ZBX_HK_OPTION_DISABLED == *rule->poption_mode)
 			continue;
 
+		keep_from = 0;
+#if defined(HAVE_MYSQL) || defined(HAVE_POSTGRESQL)
+		if (0 != CONFIG_HOUSEKEEPING_PARTITIONS &&
+				SUCCEED != hk_history_partitions_update(rule, now, &keep_from))
+		{
+			zabbix_log(LOG_LEVEL_DEBUG, "table \"%s\" is not partitioned", rule->table);
+		}
+#endif
 		// 处理历史整理规则
 
 		// 对规则的删除队列进行排序
@@ -705,11 +995,25 @@ static int housekeeping_history_and_trends(int now)
 		{
 			zbx_hk_delete_queue_t	*item_record = (zbx_hk_delete_queue_t *)rule->delete_queue.values[i];
 
+			/* records of items with the longest storage period are removed with expired partitions */
+			if (item_record->min_clock <= keep_from)
+				continue;
 			// 执行数据库删除操作
 			rc = DBexecute("delete from %s where itemid=" ZBX_FS_UI64 " and clock<%d",
 					rule->table, item_record->itemid, item_record->min_clock);
 			// 如果数据库操作返回值大于 ZBX_DB_OK，则将 deleted 计数加到返回值上
 			if (ZBX_DB_OK < rc)
+				deleted += rc;
+		}
+
+		/* clear history rule delete queue so it's ready for the next housekeeping cycle */
+		hk_history_delete_queue_clear(rule);
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%d", __function_name, deleted);
+
+	return deleted;
+}
 /******************************************************************************
  * *
  *整个代码块的主要目的是实现一个名为`housekeeping_process_rule`的函数，该函数用于根据给定的规则（包括表名、字段名、过滤器和最小时间戳）删除数据库中旧的记录。在删除过程中，限制一次性删除的记录数量不超过4个housekeeping周期 worth的数据，以防止数据库阻塞。函数最后返回删除的记录数量。
@@ -754,63 +1058,24 @@ static int housekeeping_process_rule(int now, zbx_hk_rule_t *rule)
 		zbx_vector_uint64_t	ids;
 		int			ret;
 
-		zbx_vector_uint64_create(&ids);
 
-		rule->min_clock = MIN(keep_from, rule->min_clock + HK_MAX_DELETE_PERIODS * hk_period);
 
 		/* 构建SQL语句，查询符合条件的记录ID */
-		zbx_snprintf(buffer, sizeof(buffer),
-			"select %s"
-			" from %s"
-			" where clock<%d%s%s"
-			" order by %s",
-			rule->field_name, rule->table, rule->min_clock, '\0' != *rule->filter ? " and " : "",
-			rule->filter, rule->field_name);
 
-		while (1)
-		{
 			/* 查询要删除的记录ID */
-			if (0 == CONFIG_MAX_HOUSEKEEPER_DELETE)
-				result = DBselect("%s", buffer);
-			else
-				result = DBselectN(buffer, CONFIG_MAX_HOUSEKEEPER_DELETE);
 
-			while (NULL != (row = DBfetch(result)))
-			{
-				zbx_uint64_t	id;
 
-				ZBX_STR2UINT64(id, row[0]);
-				zbx_vector_uint64_append(&ids, id);
-			}
-			DBfree_result(result);
 
-			if (0 == ids.values_num)
-				break;
 
-			sql_offset = 0;
-			zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "delete from %s where", rule->table);
-			DBadd_condition_alloc(&sql, &sql_alloc, &sql_offset, rule->field_name, ids.values,
-					ids.values_num);
 
-			if (ZBX_DB_OK > (ret = DBexecute("%s", sql)))
-				break;
 
-			deleted += ret;
-			zbx_vector_uint64_clear(&ids);
-		}
 
 		/* 释放SQL语句 */
-		zbx_free(sql);
 		/* 销毁ID列表 */
-		zbx_vector_uint64_destroy(&ids);
-	}
 
 	/* 打印调试信息，表示函数执行完毕 */
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%d", __function_name, deleted);
 
 	/* 返回删除的记录数量 */
-	return deleted;
-}
 
 
 		zbx_vector_uint64_create(&ids);
@@ -862,8 +1127,10 @@ static int housekeeping_process_rule(int now, zbx_hk_rule_t *rule)
 		zbx_vector_uint64_destroy(&ids);
 	}
 
+	/* 打印日志，表示函数执行结束 */
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%d", __function_name, deleted);
 
+	/* 返回deleted值 */
 	return deleted;
 }
 
@@ -891,6 +1158,46 @@ static int DBdelete_from_table(const char *tablename, const char *filter, int li
                 "delete from %s"
                 " where %s",
                 tablename,
+				filter);
+	}
+	else
+	{
+#if defined(HAVE_IBM_DB2) || defined(HAVE_ORACLE)
+		return DBexecute(
+				"delete from %s"
+				" where %s"
+					" and rownum<=%d",
+				tablename,
+				filter,
+				limit);
+#elif defined(HAVE_MYSQL)
+		return DBexecute(
+				"delete from %s"
+				" where %s limit %d",
+				tablename,
+				filter,
+				limit);
+#elif defined(HAVE_POSTGRESQL)
+		return DBexecute(
+				"delete from %s"
+				" where %s and ctid = any(array(select ctid from %s"
+					" where %s limit %d))",
+				tablename,
+				filter,
+				tablename,
+				filter,
+				limit);
+#elif defined(HAVE_SQLITE3)
+		return DBexecute(
+				"delete from %s"
+				" where %s",
+				tablename,
+				filter);
+#endif
+	}
+
+	return 0;
+}
 /******************************************************************************
  * *
  *这段代码的主要目的是清理不需要进行housekeeping操作的表。具体步骤如下：
@@ -911,119 +1218,56 @@ static int DBdelete_from_table(const char *tablename, const char *filter, int li
  *
  *整个代码块的主要目的是对不需要进行housekeeping操作的表进行清理。清理操作包括删除表中的数据行和删除housekeeper记录。
  ******************************************************************************/
-static int housekeeping_cleanup(void)
+static int	hk_problem_cleanup(const char *table, int source, int object, zbx_uint64_t objectid, int *more)
 {
 	/* 定义常量，表示函数名 */
-	const char *__function_name = "housekeeping_cleanup";
+	char	filter[MAX_STRING_LEN];
+	int	ret;
 
 	/* 定义变量 */
-	DB_RESULT		result;
-	DB_ROW			row;
-	int			deleted = 0;
-	zbx_vector_uint64_t	housekeeperids;
-	char			*sql = NULL, *table_name_esc;
-	size_t			sql_alloc = 0, sql_offset = 0;
-	zbx_hk_cleanup_table_t *table;
-	zbx_uint64_t		housekeeperid, objectid;
+	zbx_snprintf(filter, sizeof(filter), "source=%d and object=%d and objectid=" ZBX_FS_UI64,
+			source, object, objectid);
 
 	/* 打印日志，表示进入函数 */
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
+	ret = DBdelete_from_table(table, filter, CONFIG_MAX_HOUSEKEEPER_DELETE);
 
 	/* 创建一个uint64类型的vector，用于存储不需要进行housekeeping操作的表名 */
-	zbx_vector_uint64_create(&housekeeperids);
+	if (ZBX_DB_OK > ret || (0 != CONFIG_MAX_HOUSEKEEPER_DELETE && ret >= CONFIG_MAX_HOUSEKEEPER_DELETE))
+		*more = 1;
 
 	/* 拼接SQL语句，查询不需要进行housekeeping操作的表名 */
-	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset,
-			"select housekeeperid,tablename,field,value"
-			" from housekeeper"
-			" where tablename in (");
+	return ZBX_DB_OK <= ret ? ret : 0;
 
 	/* 组装不需要进行housekeeping操作的表名列表 */
-	for (table = hk_cleanup_tables; NULL != table->name; table++)
-	{
-		if (ZBX_HK_OPTION_ENABLED != *table->poption_mode)
-			continue;
 
-		table_name_esc = DBdyn_escape_string(table->name);
 
 		/* 拼接SQL语句，包含表名 */
-		zbx_chrcpy_alloc(&sql, &sql_alloc, &sql_offset, '\'');
-		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, table_name_esc);
-		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, "',");
 
 		/* 释放内存 */
-		zbx_free(table_name_esc);
-	}
-	sql_offset--;
 
 	/* 按照表名排序，以便有效使用数据库缓存 */
-	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, ") order by tablename");
 
 	/* 执行SQL查询 */
-	result = DBselect("%s", sql);
 
 	/* 遍历查询结果 */
-	while (NULL != (row = DBfetch(result)))
-	{
-		int	more = 0;
 
 		/* 解析housekeeperid和objectid */
-		ZBX_STR2UINT64(housekeeperid, row[0]);
-		ZBX_STR2UINT64(objectid, row[3]);
 
 		/* 处理events表 */
-		if (0 == strcmp(row[1], "events")) /* events名字用于与前端兼容 */
-		{
-			const char	*table_name = "problem";
 
-			if (0 == strcmp(row[2], "triggerid"))
-			{
-				deleted += hk_problem_cleanup(table_name, EVENT_SOURCE_TRIGGERS, EVENT_OBJECT_TRIGGER,
-						objectid, &more);
-				deleted += hk_problem_cleanup(table_name, EVENT_SOURCE_INTERNAL, EVENT_OBJECT_TRIGGER,
-						objectid, &more);
-			}
-			else if (0 == strcmp(row[2], "itemid"))
-			{
-				deleted += hk_problem_cleanup(table_name, EVENT_SOURCE_INTERNAL, EVENT_OBJECT_ITEM,
-						objectid, &more);
-			}
-			else if (0 == strcmp(row[2], "lldruleid"))
-			{
-				deleted += hk_problem_cleanup(table_name, EVENT_SOURCE_INTERNAL, EVENT_OBJECT_LLDRULE,
-						objectid, &more);
-			}
-		}
 		/* 处理其他表 */
-		else
-			deleted += hk_table_cleanup(row[1], row[2], objectid, &more);
 
 		/* 如果more为0，表示处理完毕 */
-		if (0 == more)
-			zbx_vector_uint64_append(&housekeeperids, housekeeperid);
-	}
-	DBfree_result(result);
 
 	/* 如果housekeeperids不为空，执行删除操作 */
-	if (0 != housekeeperids.values_num)
-	{
-		zbx_vector_uint64_sort(&housekeeperids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
-		DBexecute_multiple_query("delete from housekeeper where", "housekeeperid", &housekeeperids);
 	}
 
-	/* 释放内存 */
-	zbx_free(sql);
-
-	/* 销毁vector */
-	zbx_vector_uint64_destroy(&housekeeperids);
-
-	/* 打印日志，表示函数执行结束 */
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%d", __function_name, deleted);
-
-	/* 返回deleted值 */
-	return deleted;
-}
-
+/******************************************************************************
+ *                                                                            *
+ * Function: hk_table_cleanup                                                 *
+ *                                                                            *
+ * Purpose: perform generic table cleanup                                     *
+ *                                                                            *
  * Parameters: table    - [IN] the table name                                 *
  *             field    - [IN] the field name                                 *
  *             objectid - [IN] the field value                                *
@@ -1169,6 +1413,7 @@ static int	housekeeping_cleanup(void)
 
 	zbx_free(sql);
 
+	/* 销毁vector */
 	zbx_vector_uint64_destroy(&housekeeperids);
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%d", __function_name, deleted);
@@ -1212,15 +1457,34 @@ static int	housekeeping_sessions(int now)
 
 		/* 判断数据库操作是否成功，即rc是否大于等于ZBX_DB_OK */
 		if (ZBX_DB_OK <= rc)
-		{
 			/* 记录删除的会话数量 */
 			deleted = rc;
 		}
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%d", __function_name, deleted);
+
+	return deleted;
 	}
 
 	/* 使用 zabbix_log 记录调试信息，显示函数结束和删除的会话数量 */
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%d", __function_name, deleted);
+static int	housekeeping_services(int now)
+{
+	static zbx_hk_rule_t	rule = {"service_alarms", "servicealarmid", "", 0, &cfg.hk.services};
+
+	if (ZBX_HK_OPTION_ENABLED == cfg.hk.services_mode)
+		return housekeeping_process_rule(now, &rule);
 
+	return 0;
+}
+
+static int	housekeeping_audit(int now)
+{
+	static zbx_hk_rule_t	rule = {"auditlog", "auditid", "", 0, &cfg.hk.audit};
+
+	if (ZBX_HK_OPTION_ENABLED == cfg.hk.audit_mode)
+		return housekeeping_process_rule(now, &rule);
+
+	return 0;
+}
 	/* 返回删除的会话数量 */
 /******************************************************************************
  * *
@@ -1251,162 +1515,102 @@ static int	housekeeping_events(int now)
  * *
  *这个代码块的主要目的是实现一个Housekeeper线程，负责执行一些Housekeeping任务，如删除旧的history、trends、items、triggers、events、sessions、service alarms和audit log items等。线程在执行任务时，会根据配置文件中的Housekeeping频率来确定等待时间。当Housekeeper任务执行完成后，会打印相应的日志信息。整个程序采用循环结构，确保Housekeeper任务定期执行。
  ******************************************************************************/
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <signal.h>
-#include <time.h>
-#include "zbx.h"
-
-ZBX_THREAD_ENTRY(housekeeper_thread, args)
-{
+			ZBX_HK_EVENT_RULE, 0, &cfg.hk.events_internal},
+		{"events", "eventid", "events.source=" ZBX_STR(EVENT_SOURCE_INTERNAL)
+			" and events.object=" ZBX_STR(EVENT_OBJECT_LLDRULE)
+			ZBX_HK_EVENT_RULE, 0, &cfg.hk.events_internal},
+		{"events", "eventid", "events.source=" ZBX_STR(EVENT_SOURCE_DISCOVERY)
+			" and events.object=" ZBX_STR(EVENT_OBJECT_DHOST), 0, &cfg.hk.events_discovery},
+		{"events", "eventid", "events.source=" ZBX_STR(EVENT_SOURCE_DISCOVERY)
+			" and events.object=" ZBX_STR(EVENT_OBJECT_DSERVICE), 0, &cfg.hk.events_discovery},
+		{"events", "eventid", "events.source=" ZBX_STR(EVENT_SOURCE_AUTO_REGISTRATION)
+			" and events.object=" ZBX_STR(EVENT_OBJECT_ZABBIX_ACTIVE), 0, &cfg.hk.events_autoreg},
+		{NULL}
+	};
+
+	int		deleted = 0;
+	zbx_hk_rule_t	*rule;
 	// 定义一些变量
-	int	now, d_history_and_trends, d_cleanup, d_events, d_problems, d_sessions, d_services, d_audit, sleeptime;
-	double	sec, time_slept, time_now;
-	char	sleeptext[25];
 
 	// 获取进程类型、服务器编号和进程编号
-	process_type = ((zbx_thread_args_t *)args)->process_type;
-	server_num = ((zbx_thread_args_t *)args)->server_num;
-	process_num = ((zbx_thread_args_t *)args)->process_num;
+	if (ZBX_HK_OPTION_ENABLED != cfg.hk.events_mode)
+		return 0;
 
 	// 打印日志
-	zabbix_log(LOG_LEVEL_INFORMATION, "%s #%d started [%s #%d]", get_program_type_string(program_type),
-			server_num, get_process_type_string(process_type), process_num);
+	for (rule = rules; NULL != rule->table; rule++)
+		deleted += housekeeping_process_rule(now, rule);
 
 	// 更新自监控计数器
-	update_selfmon_counter(ZBX_PROCESS_STATE_BUSY);
+	return deleted;
+#undef ZBX_HK_EVENT_RULE
 
 	// 如果配置中没有设置Housekeeping频率，则一直等待用户命令
-	if (0 == CONFIG_HOUSEKEEPING_FREQUENCY)
-	{
-		zbx_setproctitle("%s [waiting for user command]", get_process_type_string(process_type));
-		zbx_snprintf(sleeptext, sizeof(sleeptext), "waiting for user command");
-	}
-	else
-	{
 		// 否则，等待Housekeeping启动延迟分钟数
-		sleeptime = HOUSEKEEPER_STARTUP_DELAY * SEC_PER_MIN;
-		zbx_setproctitle("%s [startup idle for %d minutes]", get_process_type_string(process_type),
-				HOUSEKEEPER_STARTUP_DELAY);
-		zbx_snprintf(sleeptext, sizeof(sleeptext), "idle for %d hour(s)", CONFIG_HOUSEKEEPING_FREQUENCY);
 	}
 
 	// 设置信号处理器
-	zbx_set_sigusr_handler(zbx_housekeeper_sigusr_handler);
+static int	housekeeping_problems(int now)
+{
+	const char	*__function_name = "housekeeping_problems";
 
 	// 循环执行Housekeeper任务
-	while (ZBX_IS_RUNNING())
-	{
+	int		deleted = 0, rc;
 		// 获取当前时间
-		sec = zbx_time();
 
 		// 如果配置中没有设置Housekeeping频率，则永久等待
-		if (0 == CONFIG_HOUSEKEEPING_FREQUENCY)
-			zbx_sleep_forever();
-		else
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() now:%d", __function_name, now);
 			// 否则，按照配置中的Housekeeping频率等待
-			zbx_sleep_loop(sleeptime);
 
 		// 如果进程已停止，则退出循环
-		if (!ZBX_IS_RUNNING())
-			break;
+	rc = DBexecute("delete from problem where r_clock<>0 and r_clock<%d", now - SEC_PER_DAY);
 
 		// 更新时间
-		time_now = zbx_time();
-		time_slept = time_now - sec;
-		zbx_update_env(time_now);
 
 		// 计算Housekeeping周期
-		hk_period = get_housekeeping_period(time_slept);
 
 		// 打印日志
-		zabbix_log(LOG_LEVEL_WARNING, "executing housekeeper");
 
 		// 处理Housekeeping任务
-		now = time(NULL);
 
 		// 连接数据库
-		zbx_setproctitle("%s [connecting to the database]", get_process_type_string(process_type));
-		DBconnect(ZBX_DB_CONNECT_NORMAL);
 
 		// 获取配置信息
-		zbx_config_get(&cfg, ZBX_CONFIG_FLAGS_HOUSEKEEPER);
 
 		// 逐个执行Housekeeping任务
-		zbx_setproctitle("%s [removing old history and trends]",
-				get_process_type_string(process_type));
-		sec = zbx_time();
-		d_history_and_trends = housekeeping_history_and_trends(now);
 
 		// 删除旧的问题
-		zbx_setproctitle("%s [removing old problems]", get_process_type_string(process_type));
-		d_problems = housekeeping_problems(now);
 
 		// 删除旧的事件
-		zbx_setproctitle("%s [removing old events]", get_process_type_string(process_type));
-		d_events = housekeeping_events(now);
 
 		// 删除旧会话
-		zbx_setproctitle("%s [removing old sessions]", get_process_type_string(process_type));
-		d_sessions = housekeeping_sessions(now);
 
 		// 删除旧服务报警
-		zbx_setproctitle("%s [removing old service alarms]", get_process_type_string(process_type));
-		d_services = housekeeping_services(now);
 
 		// 删除旧审计日志项
-		zbx_setproctitle("%s [removing old audit log items]", get_process_type_string(process_type));
-		d_audit = housekeeping_audit(now);
 
 		// 删除已删除项目的数据
-		zbx_setproctitle("%s [removing deleted items data]", get_process_type_string(process_type));
-		d_cleanup = housekeeping_cleanup();
 
 		// 计算执行时间
-		sec = zbx_time() - sec;
 
 		// 打印日志
-		zabbix_log(LOG_LEVEL_WARNING, "%s [deleted %d hist/trends, %d items/triggers, %d events, %d problems,"
-				" %d sessions, %d alarms, %d audit items in " ZBX_FS_DBL " sec, %s]",
-				get_process_type_string(process_type), d_history_and_trends,
-				d_cleanup, d_events, d_problems, d_sessions, d_services, d_audit, sec,
-				sleeptext);
 
 		// 清理配置
-		zbx_config_clean(&cfg);
 
 		// 关闭数据库连接
-		DBclose();
 
 		// 清理会话数据
-		zbx_dc_cleanup_data_sessions();
 		// 清理值缓存
-		zbx_vc_housekeeping_value_cache();
 
 		// 设置进程标题
-		zbx_setproctitle("%s [deleted %d hist/trends, %d items/triggers, %d events, %d sessions,"
-				" %d alarms, %d audit items in " ZBX_FS_DBL " sec, %s]",
-				get_process_type_string(process_type), d_history_and_trends, d_cleanup, d_events,
-				d_sessions, d_services, d_audit, sec, sleeptext);
 
 		// 如果配置中设置了Housekeeping频率，则更新等待时间
-		if (0 != CONFIG_HOUSEKEEPING_FREQUENCY)
-			sleeptime = CONFIG_HOUSEKEEPING_FREQUENCY * SEC_PER_HOUR;
-	}
 
 	// 设置进程标题
-	zbx_setproctitle("%s #%d [terminated]", get_process_type_string(process_type), process_num);
 
 	// 无限循环等待
-	while (1)
-		zbx_sleep(SEC_PER_MIN);
-}
 
     if (ZBX_DB_OK <= rc)
-    {
         deleted = rc;
-    }
 
     // 使用 zabbix_log 函数记录日志，表示函数执行结束，输出函数名和 deleted 变量值
     zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%d", __function_name, deleted);
@@ -1425,21 +1629,15 @@ static int get_housekeeping_period(double time_slept)
 {
 	// 判断 time_slept 是否大于 SEC_PER_HOUR（1小时秒数）
 	if (SEC_PER_HOUR > time_slept)
-	{
 		// 如果 time_slept 小于 SEC_PER_HOUR，返回 SEC_PER_HOUR
 		return SEC_PER_HOUR;
-	}
 	else if (24 * SEC_PER_HOUR < time_slept)
-	{
 		// 如果 time_slept 大于等于 SEC_PER_HOUR 且小于 24 倍的 SEC_PER_HOUR，返回 24 倍的 SEC_PER_HOUR
 		return 24 * SEC_PER_HOUR;
-	}
 	else
-	{
 		// 如果 time_slept 在 SEC_PER_HOUR 和 24 倍的 SEC_PER_HOUR 之间，返回 time_slept 整数部分
 		return (int)time_slept;
 	}
-}
 
 
 ZBX_THREAD_ENTRY(housekeeper_thread, args)
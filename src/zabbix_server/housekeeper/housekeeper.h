@@ -24,6 +24,9 @@
 
 extern int	CONFIG_HOUSEKEEPING_FREQUENCY;
 extern int	CONFIG_MAX_HOUSEKEEPER_DELETE;
+extern int	CONFIG_HOUSEKEEPING_PARTITIONS;
+extern int	CONFIG_HOUSEKEEPING_PARTITION_PERIOD;
+extern int	CONFIG_HOUSEKEEPING_PARTITIONS_AHEAD;
 
 ZBX_THREAD_ENTRY(housekeeper_thread, args);
 
@@ -20,14 +20,144 @@
 #include "common.h"
 #include "comms.h"
 #include "log.h"
+#include "zbxjson.h"
+#include "zbxcompress.h"
 #include "../../libs/zbxcrypto/tls_tcp_active.h"
 
 #include "checks_agent.h"
 
+#ifdef HAVE_LIBEVENT
+#	include <event.h>
+
+#	ifndef SOCK_CLOEXEC
+#		define SOCK_CLOEXEC 0	/* SOCK_CLOEXEC is Linux-specific, available since 2.6.23 */
+#	endif
+#endif
+
 #if !(defined(HAVE_POLARSSL) || defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL))
 extern unsigned char	program_type;
 #endif
 
+/******************************************************************************
+ *                                                                            *
+ * Function: agent_parse_value                                                *
+ *                                                                            *
+ * Purpose: convert Zabbix agent response into item result                    *
+ *                                                                            *
+ * Parameters: item         - [IN] the item                                   *
+ *             buffer       - [IN/OUT] the received data, trimmed in place    *
+ *             read_bytes   - [IN] the number of data bytes in buffer         *
+ *             received_len - [IN] the number of bytes received from socket   *
+ *             result       - [OUT] the item result                           *
+ *                                                                            *
+ * Return value: SUCCEED - value was stored in result                         *
+ *               NETWORK_ERROR - agent dropped connection                     *
+ *               NOTSUPPORTED - item not supported by the agent               *
+ *               AGENT_ERROR - uncritical error on agent side occurred        *
+ *                                                                            *
+ ******************************************************************************/
+/******************************************************************************
+ * *
+ *这个函数把代理返回的数据转换为监控项结果，阻塞方式和异步方式共用同一套判断逻辑。
+ ******************************************************************************/
+static int	agent_parse_value(const DC_ITEM *item, char *buffer, size_t read_bytes, ssize_t received_len,
+		AGENT_RESULT *result)
+{
+	// 去掉响应两端的空白字符
+	zbx_rtrim(buffer, " \r\n");
+	zbx_ltrim(buffer, " ");
+
+	zabbix_log(LOG_LEVEL_DEBUG, "get value from agent result: '%s'", buffer);
+
+	// 判断响应类型并设置结果
+	if (0 == strcmp(buffer, ZBX_NOTSUPPORTED))
+	{
+		/* 'ZBX_NOTSUPPORTED\0<error message>' */
+		if (sizeof(ZBX_NOTSUPPORTED) < read_bytes)
+			SET_MSG_RESULT(result, zbx_dsprintf(NULL, "%s", buffer + sizeof(ZBX_NOTSUPPORTED)));
+		else
+			SET_MSG_RESULT(result, zbx_strdup(NULL, "Not supported by Zabbix Agent"));
+
+		return NOTSUPPORTED;
+	}
+
+	// 代理错误
+	if (0 == strcmp(buffer, ZBX_ERROR))
+	{
+		SET_MSG_RESULT(result, zbx_strdup(NULL, "Zabbix Agent non-critical error"));
+		return AGENT_ERROR;
+	}
+
+	// 空响应
+	if (0 == received_len)
+	{
+		SET_MSG_RESULT(result, zbx_dsprintf(NULL, "Received empty response from Zabbix Agent at [%s]."
+				" Assuming that agent dropped connection because of access permissions.",
+				item->interface.addr));
+		return NETWORK_ERROR;
+	}
+
+	// 设置结果类型
+	set_result_type(result, ITEM_VALUE_TYPE_TEXT, buffer);
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: agent_get_tls_args                                               *
+ *                                                                            *
+ * Purpose: get TLS connection arguments for the item host                    *
+ *                                                                            *
+ * Parameters: item     - [IN] the item                                       *
+ *             tls_arg1 - [OUT] the certificate issuer or PSK identity        *
+ *             tls_arg2 - [OUT] the certificate subject or PSK                *
+ *             result   - [OUT] the error message on failure                  *
+ *                                                                            *
+ * Return value: SUCCEED - the arguments were retrieved                       *
+ *               CONFIG_ERROR - connection to host cannot be established      *
+ *                                                                            *
+ ******************************************************************************/
+/******************************************************************************
+ * *
+ *根据主机的加密连接类型获取证书或PSK参数，单个键值请求和批量请求共用。
+ ******************************************************************************/
+static int	agent_get_tls_args(DC_ITEM *item, char **tls_arg1, char **tls_arg2, AGENT_RESULT *result)
+{
+	switch (item->host.tls_connect)
+	{
+		// 未加密连接
+		case ZBX_TCP_SEC_UNENCRYPTED:
+			*tls_arg1 = NULL;
+			*tls_arg2 = NULL;
+			break;
+#if defined(HAVE_POLARSSL) || defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
+		case ZBX_TCP_SEC_TLS_CERT:
+			*tls_arg1 = item->host.tls_issuer;
+			*tls_arg2 = item->host.tls_subject;
+			break;
+		// PSK加密连接
+		case ZBX_TCP_SEC_TLS_PSK:
+			*tls_arg1 = item->host.tls_psk_identity;
+			*tls_arg2 = item->host.tls_psk;
+			break;
+#else
+		case ZBX_TCP_SEC_TLS_CERT:
+		case ZBX_TCP_SEC_TLS_PSK:
+			SET_MSG_RESULT(result, zbx_dsprintf(NULL, "A TLS connection is configured to be used with agent"
+					" but support for TLS was not compiled into %s.",
+					get_program_type_string(program_type)));
+			return CONFIG_ERROR;
+#endif
+		default:
+			THIS_SHOULD_NEVER_HAPPEN;
+			SET_MSG_RESULT(result, zbx_strdup(NULL, "Invalid TLS connection parameters."));
+			return CONFIG_ERROR;
+	}
+
+	return SUCCEED;
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: get_value_agent                                                  *
@@ -84,39 +214,9 @@ int get_value_agent(DC_ITEM *item, AGENT_RESULT *result)
     zabbix_log(LOG_LEVEL_DEBUG, "In %s() host:'%s' addr:'%s' key:'%s' conn:'%s'", __function_name, item->host.host,
                item->interface.addr, item->key, zbx_tcp_connection_type_name(item->host.tls_connect));
 
-    // 根据连接类型切换处理方式
-    switch (item->host.tls_connect)
-    {
-        // 未加密连接
-        case ZBX_TCP_SEC_UNENCRYPTED:
-            tls_arg1 = NULL;
-            tls_arg2 = NULL;
-            break;
-#if defined(HAVE_POLARSSL) || defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
-		case ZBX_TCP_SEC_TLS_CERT:
-            tls_arg1 = item->host.tls_issuer;
-            tls_arg2 = item->host.tls_subject;
-            break;
-        // PSK加密连接
-        case ZBX_TCP_SEC_TLS_PSK:
-            tls_arg1 = item->host.tls_psk_identity;
-            tls_arg2 = item->host.tls_psk;
-            break;
-#else
-		case ZBX_TCP_SEC_TLS_CERT:
-		case ZBX_TCP_SEC_TLS_PSK:
-			SET_MSG_RESULT(result, zbx_dsprintf(NULL, "A TLS connection is configured to be used with agent"
-					" but support for TLS was not compiled into %s.",
-					get_program_type_string(program_type)));
-			ret = CONFIG_ERROR;
-			goto out;
-#endif
-        default:
-            THIS_SHOULD_NEVER_HAPPEN;
-            SET_MSG_RESULT(result, zbx_strdup(NULL, "Invalid TLS connection parameters."));
-            ret = CONFIG_ERROR;
-            goto out;
-    }
+    // 根据连接类型获取加密参数
+    if (SUCCEED != (ret = agent_get_tls_args(item, &tls_arg1, &tls_arg2, result)))
+        goto out;
 
     // 连接目标主机
     if (SUCCEED == (ret = zbx_tcp_connect(&s, CONFIG_SOURCE_IP, item->interface.addr, item->interface.port, 0,
@@ -142,44 +242,9 @@ int get_value_agent(DC_ITEM *item, AGENT_RESULT *result)
     else
         ret = NETWORK_ERROR;
 
-    // 成功获取值
+    // 成功获取值，解析响应数据
     if (SUCCEED == ret)
-    {
-        // 处理响应数据
-        zbx_rtrim(s.buffer, " \r\n");
-        zbx_ltrim(s.buffer, " ");
-
-        zabbix_log(LOG_LEVEL_DEBUG, "get value from agent result: '%s'", s.buffer);
-
-        // 判断响应类型并设置结果
-        if (0 == strcmp(s.buffer, ZBX_NOTSUPPORTED))
-        {
-            /* 'ZBX_NOTSUPPORTED\0<error message>' */
-            if (sizeof(ZBX_NOTSUPPORTED) < s.read_bytes)
-                SET_MSG_RESULT(result, zbx_dsprintf(NULL, "%s", s.buffer + sizeof(ZBX_NOTSUPPORTED)));
-            else
-                SET_MSG_RESULT(result, zbx_strdup(NULL, "Not supported by Zabbix Agent"));
-
-            ret = NOTSUPPORTED;
-        }
-        // 代理错误
-        else if (0 == strcmp(s.buffer, ZBX_ERROR))
-        {
-            SET_MSG_RESULT(result, zbx_strdup(NULL, "Zabbix Agent non-critical error"));
-            ret = AGENT_ERROR;
-        }
-        // 空响应
-        else if (0 == received_len)
-        {
-            SET_MSG_RESULT(result, zbx_dsprintf(NULL, "Received empty response from Zabbix Agent at [%s]."
-                                                " Assuming that agent dropped connection because of access permissions.",
-                                                item->interface.addr));
-            ret = NETWORK_ERROR;
-        }
-        // 设置结果类型
-        else
-            set_result_type(result, ITEM_VALUE_TYPE_TEXT, s.buffer);
-    }
+        ret = agent_parse_value(item, s.buffer, s.read_bytes, received_len, result);
     // 获取值失败
     else
         SET_MSG_RESULT(result, zbx_dsprintf(NULL, "Get value from agent failed: %s", zbx_socket_strerror()));
@@ -193,3 +258,1043 @@ out:
     return ret;
 }
 
+/* result code of items the agent did not answer in batch request, such items are requested one key at a time */
+#define ZBX_AGENT_ITEM_PENDING		FAIL
+
+/* how long to keep requesting one key at a time from agents without batch request support */
+#define ZBX_AGENT_BATCH_RETRY_PERIOD	SEC_PER_HOUR
+
+typedef struct
+{
+	zbx_uint64_t	interfaceid;
+	time_t		retry_time;
+}
+zbx_agent_batch_disabled_t;
+
+/* interfaces of agents that do not support multiple keys per request */
+static zbx_hashset_t	agent_batch_disabled;
+
+/******************************************************************************
+ *                                                                            *
+ * Function: agent_batch_disable                                              *
+ *                                                                            *
+ * Purpose: stop sending batch requests to the item interface for a while     *
+ *                                                                            *
+ * Parameters: item - [IN] the item                                           *
+ *                                                                            *
+ ******************************************************************************/
+static void	agent_batch_disable(const DC_ITEM *item)
+{
+	zbx_agent_batch_disabled_t	*disabled, disabled_local;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "Zabbix agent at [%s] does not support multiple keys per request, requesting"
+			" one key at a time", item->interface.addr);
+
+	if (NULL == agent_batch_disabled.slots)
+	{
+		zbx_hashset_create(&agent_batch_disabled, 100, ZBX_DEFAULT_UINT64_HASH_FUNC,
+				ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	}
+
+	disabled_local.interfaceid = item->interface.interfaceid;
+	disabled = (zbx_agent_batch_disabled_t *)zbx_hashset_insert(&agent_batch_disabled, &disabled_local,
+			sizeof(disabled_local));
+	disabled->retry_time = time(NULL) + ZBX_AGENT_BATCH_RETRY_PERIOD;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: agent_batch_size                                                 *
+ *                                                                            *
+ * Purpose: get number of items that can be requested from agent over the     *
+ *          same connection as the first item                                 *
+ *                                                                            *
+ * Parameters: items    - [IN] the items                                      *
+ *             errcodes - [IN] the item result codes                          *
+ *             num      - [IN] the number of items                            *
+ *                                                                            *
+ * Return value: the number of leading items with the same interface, 1 if    *
+ *               batch requests are disabled                                  *
+ *                                                                            *
+ ******************************************************************************/
+static int	agent_batch_size(const DC_ITEM *items, const int *errcodes, int num)
+{
+	zbx_agent_batch_disabled_t	*disabled;
+	int				i;
+
+	if (1 == CONFIG_MAX_ITEMS_PER_AGENT_REQUEST)
+		return 1;
+
+	if (NULL != agent_batch_disabled.slots && NULL != (disabled = (zbx_agent_batch_disabled_t *)
+			zbx_hashset_search(&agent_batch_disabled, &items[0].interface.interfaceid)))
+	{
+		if (time(NULL) < disabled->retry_time)
+			return 1;
+
+		// 到期后重新尝试批量请求，代理可能已经升级
+		zbx_hashset_remove_direct(&agent_batch_disabled, disabled);
+	}
+
+	for (i = 1; i < num && i < CONFIG_MAX_ITEMS_PER_AGENT_REQUEST; i++)
+	{
+		if (items[i].interface.interfaceid != items[0].interface.interfaceid || SUCCEED != errcodes[i])
+			break;
+	}
+
+	return i;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: agent_batch_request                                              *
+ *                                                                            *
+ * Purpose: prepare request for multiple item keys                            *
+ *                                                                            *
+ * Parameters: items - [IN] the items                                         *
+ *             num   - [IN] the number of items                               *
+ *             j     - [OUT] the request, must be freed by caller             *
+ *                                                                            *
+ * Comments: {"request":"passive checks","timeout":3,"data":[{"key":"..."}]}  *
+ *                                                                            *
+ ******************************************************************************/
+static void	agent_batch_request(const DC_ITEM *items, int num, struct zbx_json *j)
+{
+	int	i;
+
+	zbx_json_init(j, ZBX_JSON_STAT_BUF_LEN);
+	zbx_json_addstring(j, ZBX_PROTO_TAG_REQUEST, ZBX_PROTO_VALUE_PASSIVE_CHECKS, ZBX_JSON_TYPE_STRING);
+	zbx_json_adduint64(j, ZBX_PROTO_TAG_TIMEOUT, (zbx_uint64_t)CONFIG_TIMEOUT);
+	zbx_json_addarray(j, ZBX_PROTO_TAG_DATA);
+
+	for (i = 0; i < num; i++)
+	{
+		zbx_json_addobject(j, NULL);
+		zbx_json_addstring(j, ZBX_PROTO_TAG_KEY, items[i].key, ZBX_JSON_TYPE_STRING);
+		zbx_json_close(j);
+	}
+
+	zbx_json_close(j);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: agent_batch_parse                                                *
+ *                                                                            *
+ * Purpose: convert Zabbix agent response to multiple item keys into item     *
+ *          results                                                           *
+ *                                                                            *
+ * Parameters: items    - [IN] the items                                      *
+ *             results  - [OUT] the item results                              *
+ *             errcodes - [OUT] the item result codes                         *
+ *             num      - [IN] the number of items                            *
+ *             data     - [IN] the received data                              *
+ *                                                                            *
+ * Return value: SUCCEED - the response was parsed, items the agent did not   *
+ *                         answer are left with ZBX_AGENT_ITEM_PENDING code   *
+ *               FAIL    - agent does not support batch requests, all items   *
+ *                         are left with ZBX_AGENT_ITEM_PENDING code          *
+ *                                                                            *
+ * Comments: agent answers keys in request order and may stop early when it   *
+ *           runs out of time:                                                *
+ *           {"response":"success","data":[{"value":"..."},{"error":"..."}]}  *
+ *                                                                            *
+ ******************************************************************************/
+/******************************************************************************
+ * *
+ *解析代理对批量请求的响应，按请求顺序为每个监控项设置结果。
+ *旧版本代理无法识别批量请求，会把整个请求当作监控项键值并返回不支持，此时返回FAIL，由调用者逐个键值重新请求。
+ ******************************************************************************/
+static int	agent_batch_parse(const DC_ITEM *items, AGENT_RESULT *results, int *errcodes, int num,
+		const char *data)
+{
+	struct zbx_json_parse	jp, jp_data, jp_row;
+	const char		*p = NULL;
+	char			response[MAX_STRING_LEN], *value = NULL;
+	size_t			value_alloc = 0;
+	int			i;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "get values from agent result: '%s'", data);
+
+	for (i = 0; i < num; i++)
+		errcodes[i] = ZBX_AGENT_ITEM_PENDING;
+
+	if (SUCCEED != zbx_json_open(data, &jp) ||
+			SUCCEED != zbx_json_value_by_name(&jp, ZBX_PROTO_TAG_RESPONSE, response, sizeof(response),
+					NULL) ||
+			0 != strcmp(response, ZBX_PROTO_VALUE_SUCCESS) ||
+			SUCCEED != zbx_json_brackets_by_name(&jp, ZBX_PROTO_TAG_DATA, &jp_data))
+	{
+		return FAIL;
+	}
+
+	for (i = 0; i < num && NULL != (p = zbx_json_next(&jp_data, p)); i++)
+	{
+		if (SUCCEED != zbx_json_brackets_open(p, &jp_row))
+			break;
+
+		if (SUCCEED == zbx_json_value_by_name_dyn(&jp_row, ZBX_PROTO_TAG_VALUE, &value, &value_alloc, NULL))
+		{
+			// 与单个键值请求一样去掉两端的空白字符
+			zbx_rtrim(value, " \r\n");
+			zbx_ltrim(value, " ");
+
+			set_result_type(&results[i], ITEM_VALUE_TYPE_TEXT, value);
+			errcodes[i] = SUCCEED;
+		}
+		else if (SUCCEED == zbx_json_value_by_name_dyn(&jp_row, ZBX_PROTO_TAG_ERROR, &value, &value_alloc,
+				NULL))
+		{
+			SET_MSG_RESULT(&results[i], zbx_strdup(NULL, '\0' != *value ? value :
+					"Not supported by Zabbix Agent"));
+			errcodes[i] = NOTSUPPORTED;
+		}
+		else
+			break;
+	}
+
+	zbx_free(value);
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: agent_batch_set_error                                            *
+ *                                                                            *
+ * Purpose: set the same error for all items requested over one connection    *
+ *                                                                            *
+ * Parameters: results  - [IN/OUT] the item results, the first one contains   *
+ *                                 the error message                          *
+ *             errcodes - [OUT] the item result codes                         *
+ *             num      - [IN] the number of items                            *
+ *             ret      - [IN] the result code                                *
+ *                                                                            *
+ ******************************************************************************/
+static void	agent_batch_set_error(AGENT_RESULT *results, int *errcodes, int num, int ret)
+{
+	int	i;
+
+	for (i = 0; i < num; i++)
+	{
+		if (0 != i && ISSET_MSG(&results[0]))
+			SET_MSG_RESULT(&results[i], zbx_strdup(NULL, results[0].msg));
+
+		errcodes[i] = ret;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: agent_get_batch                                                  *
+ *                                                                            *
+ * Purpose: retrieve multiple item values from Zabbix agent over a single     *
+ *          connection                                                        *
+ *                                                                            *
+ * Parameters: items    - [IN] the items of the same interface                *
+ *             results  - [OUT] the item results                              *
+ *             errcodes - [OUT] the item result codes, see get_value_agent()  *
+ *             num      - [IN] the number of items                            *
+ *                                                                            *
+ * Comments: items the agent did not answer are left with                     *
+ *           ZBX_AGENT_ITEM_PENDING code, also when the agent accepted the    *
+ *           request but did not respond in time                              *
+ *                                                                            *
+ ******************************************************************************/
+static void	agent_get_batch(DC_ITEM *items, AGENT_RESULT *results, int *errcodes, int num)
+{
+	const char	*__function_name = "agent_get_batch";
+	zbx_socket_t	s;
+	char		*tls_arg1, *tls_arg2;
+	struct zbx_json	j;
+	int		ret;
+	ssize_t		received_len;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() host:'%s' addr:'%s' num:%d conn:'%s'", __function_name, items->host.host,
+			items->interface.addr, num, zbx_tcp_connection_type_name(items->host.tls_connect));
+
+	if (SUCCEED != (ret = agent_get_tls_args(items, &tls_arg1, &tls_arg2, results)))
+		goto out;
+
+	agent_batch_request(items, num, &j);
+
+	if (SUCCEED == (ret = zbx_tcp_connect(&s, CONFIG_SOURCE_IP, items->interface.addr, items->interface.port, 0,
+			items->host.tls_connect, tls_arg1, tls_arg2)))
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "Sending [%s]", j.buffer);
+
+		if (SUCCEED != zbx_tcp_send(&s, j.buffer))
+			ret = NETWORK_ERROR;
+		else if (FAIL != (received_len = zbx_tcp_recv_ext(&s, 0)))
+			ret = SUCCEED;
+		else if (SUCCEED == zbx_alarm_timed_out())
+			ret = TIMEOUT_ERROR;
+		else
+			ret = NETWORK_ERROR;
+	}
+	else
+		ret = NETWORK_ERROR;
+
+	if (SUCCEED == ret)
+	{
+		// 代理在拒绝访问时会直接关闭连接
+		if (0 == received_len)
+			ret = agent_parse_value(items, s.buffer, s.read_bytes, received_len, results);
+		else if (SUCCEED != agent_batch_parse(items, results, errcodes, num, s.buffer))
+			agent_batch_disable(items);
+	}
+	else if (TIMEOUT_ERROR != ret)
+		SET_MSG_RESULT(results, zbx_dsprintf(NULL, "Get value from agent failed: %s", zbx_socket_strerror()));
+
+	zbx_tcp_close(&s);
+	zbx_json_free(&j);
+out:
+	// 代理已收到请求但未及时响应，可能只是个别键值较慢，由调用者逐个请求
+	if (TIMEOUT_ERROR == ret)
+		agent_batch_set_error(results, errcodes, num, ZBX_AGENT_ITEM_PENDING);
+	else if (SUCCEED != ret)
+		agent_batch_set_error(results, errcodes, num, ret);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: get_values_agent                                                 *
+ *                                                                            *
+ * Purpose: retrieve data from Zabbix agents, requesting items of the same    *
+ *          interface over a single connection                                *
+ *                                                                            *
+ * Parameters: items    - [IN] the Zabbix agent items                         *
+ *             results  - [OUT] the item results                              *
+ *             errcodes - [IN/OUT] the item result codes, only items with     *
+ *                                 SUCCEED code are polled                    *
+ *             num      - [IN] the number of items                            *
+ *                                                                            *
+ * Comments: up to MaxItemsPerAgentRequest consecutive items of the same      *
+ *           interface are requested together, each connection is limited by  *
+ *           Timeout. Result codes are the same as returned by                *
+ *           get_value_agent().                                               *
+ *                                                                            *
+ ******************************************************************************/
+/******************************************************************************
+ * *
+ *这个函数逐个连接阻塞获取代理监控项，同一接口的多个监控项通过一次连接（以及一次TLS握手）批量请求，
+ *代理不支持批量请求或未来得及返回的监控项再逐个请求。
+ ******************************************************************************/
+void	get_values_agent(DC_ITEM *items, AGENT_RESULT *results, int *errcodes, int num)
+{
+	const char	*__function_name = "get_values_agent";
+	int		i, batch;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() num:%d", __function_name, num);
+
+	for (i = 0; i < num; i += batch)
+	{
+		if (SUCCEED != errcodes[i])
+		{
+			batch = 1;
+			continue;
+		}
+
+		batch = agent_batch_size(&items[i], &errcodes[i], num - i);
+
+		zbx_alarm_on(CONFIG_TIMEOUT);
+
+		if (1 == batch)
+			errcodes[i] = get_value_agent(&items[i], &results[i]);
+		else
+			agent_get_batch(&items[i], &results[i], &errcodes[i], batch);
+
+		zbx_alarm_off();
+	}
+
+	// 逐个请求代理未返回的监控项
+	for (i = 0; i < num; i++)
+	{
+		if (ZBX_AGENT_ITEM_PENDING != errcodes[i])
+			continue;
+
+		zbx_alarm_on(CONFIG_TIMEOUT);
+		errcodes[i] = get_value_agent(&items[i], &results[i]);
+		zbx_alarm_off();
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __function_name);
+}
+
+#ifdef HAVE_LIBEVENT
+
+#define ZBX_AGENT_CONN_CONNECT	0
+#define ZBX_AGENT_CONN_SEND	1
+#define ZBX_AGENT_CONN_RECV	2
+
+#define ZBX_AGENT_HEADER_DATA	"ZBXD"
+#define ZBX_AGENT_HEADER_LEN	ZBX_CONST_STRLEN(ZBX_AGENT_HEADER_DATA)
+#define ZBX_AGENT_HEADER_SIZE	(ZBX_AGENT_HEADER_LEN + 1 + 2 * sizeof(zbx_uint32_t))
+
+/* non-blocking connection to passive Zabbix agent, one per item or per group of items of the same interface */
+typedef struct
+{
+	DC_ITEM			*items;
+	AGENT_RESULT		*results;
+	int			*errcodes;
+	int			num;
+
+	/* number of connections of the batch still in progress */
+	int			*active;
+
+	struct event_base	*base;
+	struct event		ev;
+	int			fd;
+	unsigned char		state;
+
+	/* addresses resolved before the connection is started */
+	struct addrinfo		*ai;
+	const struct addrinfo	*ai_bind;
+
+	/* request while sending, response while receiving */
+	char			*buf;
+	size_t			buf_alloc;
+	size_t			buf_offset;
+	size_t			buf_len;
+
+	/* connection must complete before this time */
+	double			deadline;
+}
+zbx_agent_conn_t;
+
+static void	agent_conn_event_cb(evutil_socket_t fd, short what, void *arg);
+
+/******************************************************************************
+ *                                                                            *
+ * Function: agent_conn_finish                                                *
+ *                                                                            *
+ * Purpose: close agent connection and store the check result code            *
+ *                                                                            *
+ * Parameters: conn - [IN] the agent connection                               *
+ *             ret  - [IN] the check result code, applied to all items of the *
+ *                         connection unless batch request succeeded          *
+ *                                                                            *
+ * Comments: items of a batch request the agent accepted but did not answer   *
+ *           in time are left with ZBX_AGENT_ITEM_PENDING code                *
+ *                                                                            *
+ ******************************************************************************/
+static void	agent_conn_finish(zbx_agent_conn_t *conn, int ret)
+{
+	// 关闭套接字，释放缓冲区
+	if (-1 != conn->fd)
+	{
+		close(conn->fd);
+		conn->fd = -1;
+	}
+
+	zbx_free(conn->buf);
+
+	if (NULL != conn->ai)
+	{
+		freeaddrinfo(conn->ai);
+		conn->ai = NULL;
+	}
+
+	// 批量请求成功时各监控项的结果代码已在解析响应时设置
+	if (1 == conn->num)
+		*conn->errcodes = ret;
+	else if (TIMEOUT_ERROR == ret)
+	{
+		// 代理已收到请求但未及时响应，可能只是个别键值较慢，由调用者逐个请求
+		UNSET_MSG_RESULT(conn->results);
+		agent_batch_set_error(conn->results, conn->errcodes, conn->num, ZBX_AGENT_ITEM_PENDING);
+	}
+	else if (SUCCEED != ret)
+		agent_batch_set_error(conn->results, conn->errcodes, conn->num, ret);
+
+	(*conn->active)--;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of get_value_agent() host:'%s' key:'%s' num:%d:%s", conn->items->host.host,
+			conn->items->key, conn->num, zbx_result_string(ret));
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: agent_conn_wait                                                  *
+ *                                                                            *
+ * Purpose: wait for the socket to become readable or writable, limited by    *
+ *          the connection deadline                                           *
+ *                                                                            *
+ * Parameters: conn - [IN] the agent connection                               *
+ *             what - [IN] EV_READ or EV_WRITE                                *
+ *                                                                            *
+ ******************************************************************************/
+static void	agent_conn_wait(zbx_agent_conn_t *conn, short what)
+{
+	struct timeval	tv;
+	double		left;
+
+	// 剩余时间不足时立即触发超时事件
+	if (0 > (left = conn->deadline - zbx_time()))
+		left = 0;
+
+	tv.tv_sec = (time_t)left;
+	tv.tv_usec = (suseconds_t)((left - tv.tv_sec) * 1000000);
+
+	event_set(&conn->ev, conn->fd, what, agent_conn_event_cb, (void *)conn);
+	event_base_set(conn->base, &conn->ev);
+	event_add(&conn->ev, &tv);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: agent_conn_start                                                 *
+ *                                                                            *
+ * Purpose: start non-blocking connection to the item agent and prepare the   *
+ *          request for one or multiple item keys                             *
+ *                                                                            *
+ * Parameters: conn - [IN] the agent connection with resolved address         *
+ *                                                                            *
+ * Comments: on failure the connection is finished with NETWORK_ERROR         *
+ *                                                                            *
+ ******************************************************************************/
+static void	agent_conn_start(zbx_agent_conn_t *conn)
+{
+	const char	*__function_name = "agent_conn_start";
+	DC_ITEM		*item = conn->items;
+	struct addrinfo	*ai = conn->ai;
+	struct zbx_json	j;
+	const char	*request;
+	zbx_uint32_t	len32_le;
+	size_t		request_len;
+	int		ret = FAIL;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() host:'%s' addr:'%s' key:'%s' num:%d conn:'%s'", __function_name,
+			item->host.host, item->interface.addr, item->key, conn->num,
+			zbx_tcp_connection_type_name(item->host.tls_connect));
+
+	conn->deadline = zbx_time() + CONFIG_TIMEOUT;
+
+	if (-1 == (conn->fd = socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol)))
+	{
+		SET_MSG_RESULT(conn->results, zbx_dsprintf(NULL, "Get value from agent failed: cannot create socket"
+				" [[%s]:%hu]: %s", item->interface.addr, item->interface.port, zbx_strerror(errno)));
+		goto out;
+	}
+#if !SOCK_CLOEXEC
+	fcntl(conn->fd, F_SETFD, FD_CLOEXEC);
+#endif
+
+	// 设置非阻塞模式
+	if (-1 == fcntl(conn->fd, F_SETFL, fcntl(conn->fd, F_GETFL) | O_NONBLOCK))
+	{
+		SET_MSG_RESULT(conn->results, zbx_dsprintf(NULL, "Get value from agent failed: cannot set non-blocking"
+				" mode: %s", zbx_strerror(errno)));
+		goto out;
+	}
+
+	if (NULL != conn->ai_bind && -1 == bind(conn->fd, conn->ai_bind->ai_addr, conn->ai_bind->ai_addrlen))
+	{
+		SET_MSG_RESULT(conn->results, zbx_dsprintf(NULL, "Get value from agent failed: bind() failed: %s",
+				zbx_strerror(errno)));
+		goto out;
+	}
+
+	if (-1 == connect(conn->fd, ai->ai_addr, (socklen_t)ai->ai_addrlen) && EINPROGRESS != errno)
+	{
+		SET_MSG_RESULT(conn->results, zbx_dsprintf(NULL, "Get value from agent failed: cannot connect to"
+				" [[%s]:%hu]: %s", item->interface.addr, item->interface.port, zbx_strerror(errno)));
+		goto out;
+	}
+
+	// 组装请求报文：协议头 + 数据长度 + 保留字段 + 监控项键值或批量请求
+	if (1 == conn->num)
+	{
+		request = item->key;
+	}
+	else
+	{
+		agent_batch_request(conn->items, conn->num, &j);
+		request = j.buffer;
+	}
+
+	request_len = strlen(request);
+	conn->buf_len = ZBX_AGENT_HEADER_SIZE + request_len;
+	conn->buf_alloc = conn->buf_len + 1;
+	conn->buf = (char *)zbx_malloc(NULL, conn->buf_alloc);
+
+	memcpy(conn->buf, ZBX_AGENT_HEADER_DATA, ZBX_AGENT_HEADER_LEN);
+	conn->buf[ZBX_AGENT_HEADER_LEN] = ZBX_TCP_PROTOCOL;
+	len32_le = zbx_htole_uint32((zbx_uint32_t)request_len);
+	memcpy(conn->buf + ZBX_AGENT_HEADER_LEN + 1, &len32_le, sizeof(len32_le));
+	len32_le = 0;
+	memcpy(conn->buf + ZBX_AGENT_HEADER_LEN + 1 + sizeof(len32_le), &len32_le, sizeof(len32_le));
+	memcpy(conn->buf + ZBX_AGENT_HEADER_SIZE, request, request_len);
+	conn->buf_offset = 0;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "Sending [%s]", request);
+
+	if (1 != conn->num)
+		zbx_json_free(&j);
+
+	conn->state = ZBX_AGENT_CONN_CONNECT;
+	agent_conn_wait(conn, EV_WRITE);
+
+	ret = SUCCEED;
+out:
+	freeaddrinfo(conn->ai);
+	conn->ai = NULL;
+
+	if (SUCCEED != ret)
+		agent_conn_finish(conn, NETWORK_ERROR);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: agent_conn_process_response                                      *
+ *                                                                            *
+ * Purpose: validate received Zabbix protocol packet and convert its payload  *
+ *          into item result                                                  *
+ *                                                                            *
+ * Parameters: conn - [IN] the agent connection                               *
+ *                                                                            *
+ * Return value: item check result code, SUCCEED if batch response was        *
+ *               parsed and result codes were set for every item              *
+ *                                                                            *
+ * Comments: performs the same checks as zbx_tcp_recv_ext()                   *
+ *                                                                            *
+ ******************************************************************************/
+static int	agent_conn_process_response(zbx_agent_conn_t *conn)
+{
+	DC_ITEM		*item = conn->items;
+	zbx_uint32_t	data_len, reserved;
+	unsigned char	flags;
+	char		*data, *out = NULL;
+	size_t		out_size;
+	int		ret;
+
+	// 代理在拒绝访问时会直接关闭连接
+	if (0 == conn->buf_offset)
+	{
+		conn->buf[0] = '\0';
+		return agent_parse_value(item, conn->buf, 0, 0, conn->results);
+	}
+
+	if (ZBX_AGENT_HEADER_SIZE > conn->buf_offset ||
+			0 != strncmp(conn->buf, ZBX_AGENT_HEADER_DATA, ZBX_AGENT_HEADER_LEN))
+	{
+		SET_MSG_RESULT(conn->results, zbx_dsprintf(NULL, "Get value from agent failed: message from [%s] is"
+				" missing header", item->interface.addr));
+		return NETWORK_ERROR;
+	}
+
+	flags = (unsigned char)conn->buf[ZBX_AGENT_HEADER_LEN];
+
+	if (0 == (flags & ZBX_TCP_PROTOCOL) || (ZBX_TCP_PROTOCOL | ZBX_TCP_COMPRESS) < flags)
+	{
+		SET_MSG_RESULT(conn->results, zbx_dsprintf(NULL, "Get value from agent failed: message from [%s] is"
+				" using unsupported protocol version \"%d\"", item->interface.addr, (int)flags));
+		return NETWORK_ERROR;
+	}
+
+	memcpy(&data_len, conn->buf + ZBX_AGENT_HEADER_LEN + 1, sizeof(data_len));
+	data_len = zbx_letoh_uint32(data_len);
+	memcpy(&reserved, conn->buf + ZBX_AGENT_HEADER_LEN + 1 + sizeof(data_len), sizeof(reserved));
+	reserved = zbx_letoh_uint32(reserved);
+
+	if (conn->buf_offset - ZBX_AGENT_HEADER_SIZE != data_len)
+	{
+		SET_MSG_RESULT(conn->results, zbx_dsprintf(NULL, "Get value from agent failed: message from [%s] is"
+				" %s than expected " ZBX_FS_UI64 " bytes", item->interface.addr,
+				conn->buf_offset - ZBX_AGENT_HEADER_SIZE < data_len ? "shorter" : "longer",
+				(zbx_uint64_t)data_len));
+		return NETWORK_ERROR;
+	}
+
+	data = conn->buf + ZBX_AGENT_HEADER_SIZE;
+	data[data_len] = '\0';
+
+	// 压缩数据需要先解压缩
+	if (0 != (flags & ZBX_TCP_COMPRESS))
+	{
+		if (ZBX_MAX_RECV_DATA_SIZE < reserved)
+		{
+			SET_MSG_RESULT(conn->results, zbx_dsprintf(NULL, "Get value from agent failed: uncompressed"
+					" message size " ZBX_FS_UI64 " exceeds the maximum size " ZBX_FS_UI64 " bytes",
+					(zbx_uint64_t)reserved, (zbx_uint64_t)ZBX_MAX_RECV_DATA_SIZE));
+			return NETWORK_ERROR;
+		}
+
+		out_size = reserved;
+		out = (char *)zbx_malloc(NULL, reserved + 1);
+
+		if (FAIL == zbx_uncompress(data, data_len, out, &out_size) || out_size != reserved)
+		{
+			SET_MSG_RESULT(conn->results, zbx_dsprintf(NULL, "Get value from agent failed: cannot"
+					" uncompress data: %s", zbx_compress_strerror()));
+			zbx_free(out);
+			return NETWORK_ERROR;
+		}
+
+		out[out_size] = '\0';
+		data = out;
+		data_len = (zbx_uint32_t)out_size;
+	}
+
+	if (1 == conn->num)
+	{
+		ret = agent_parse_value(item, data, data_len, (ssize_t)(ZBX_AGENT_HEADER_SIZE + data_len),
+				conn->results);
+	}
+	else
+	{
+		if (SUCCEED != agent_batch_parse(conn->items, conn->results, conn->errcodes, conn->num, data))
+			agent_batch_disable(item);
+
+		ret = SUCCEED;
+	}
+
+	zbx_free(out);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: agent_conn_response_complete                                     *
+ *                                                                            *
+ * Purpose: check if the whole packet announced in header has been received   *
+ *                                                                            *
+ * Parameters: conn - [IN] the agent connection                               *
+ *                                                                            *
+ * Return value: SUCCEED - the packet is complete                             *
+ *               FAIL    - more data is expected                              *
+ *                                                                            *
+ ******************************************************************************/
+static int	agent_conn_response_complete(const zbx_agent_conn_t *conn)
+{
+	zbx_uint32_t	data_len;
+
+	if (ZBX_AGENT_HEADER_SIZE > conn->buf_offset ||
+			0 != strncmp(conn->buf, ZBX_AGENT_HEADER_DATA, ZBX_AGENT_HEADER_LEN))
+	{
+		return FAIL;
+	}
+
+	memcpy(&data_len, conn->buf + ZBX_AGENT_HEADER_LEN + 1, sizeof(data_len));
+
+	if (ZBX_AGENT_HEADER_SIZE + zbx_letoh_uint32(data_len) > conn->buf_offset)
+		return FAIL;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: agent_conn_event_cb                                              *
+ *                                                                            *
+ * Purpose: advance agent connection state machine on socket events           *
+ *                                                                            *
+ * Parameters: fd   - [IN] the socket                                         *
+ *             what - [IN] the libevent event flags                           *
+ *             arg  - [IN] the agent connection                               *
+ *                                                                            *
+ ******************************************************************************/
+static void	agent_conn_event_cb(evutil_socket_t fd, short what, void *arg)
+{
+	zbx_agent_conn_t	*conn = (zbx_agent_conn_t *)arg;
+	DC_ITEM			*item = conn->items;
+	ssize_t			n;
+	int			err;
+	socklen_t		err_len = sizeof(err);
+
+	if (0 != (what & EV_TIMEOUT))
+	{
+		// 与阻塞方式保持一致：连接和发送超时视为网络错误，接收超时视为超时错误
+		SET_MSG_RESULT(conn->results, zbx_dsprintf(NULL, "Get value from agent failed: timed out while %s"
+				" [[%s]:%hu]", ZBX_AGENT_CONN_CONNECT == conn->state ? "connecting to" :
+				(ZBX_AGENT_CONN_SEND == conn->state ? "sending to" : "receiving from"),
+				item->interface.addr, item->interface.port));
+		agent_conn_finish(conn, ZBX_AGENT_CONN_RECV == conn->state ? TIMEOUT_ERROR : NETWORK_ERROR);
+		return;
+	}
+
+	switch (conn->state)
+	{
+		case ZBX_AGENT_CONN_CONNECT:
+			if (-1 == getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &err_len))
+				err = errno;
+
+			if (0 != err)
+			{
+				SET_MSG_RESULT(conn->results, zbx_dsprintf(NULL, "Get value from agent failed: cannot"
+						" connect to [[%s]:%hu]: %s", item->interface.addr,
+						item->interface.port, zbx_strerror(err)));
+				agent_conn_finish(conn, NETWORK_ERROR);
+				return;
+			}
+
+			conn->state = ZBX_AGENT_CONN_SEND;
+			ZBX_FALLTHROUGH;
+		case ZBX_AGENT_CONN_SEND:
+			if (-1 == (n = write(fd, conn->buf + conn->buf_offset, conn->buf_len - conn->buf_offset)))
+			{
+				if (EAGAIN == errno || EINTR == errno)
+				{
+					agent_conn_wait(conn, EV_WRITE);
+					return;
+				}
+
+				SET_MSG_RESULT(conn->results, zbx_dsprintf(NULL, "Get value from agent failed: cannot"
+						" write to [[%s]:%hu]: %s", item->interface.addr,
+						item->interface.port, zbx_strerror(errno)));
+				agent_conn_finish(conn, NETWORK_ERROR);
+				return;
+			}
+
+			if (conn->buf_len > (conn->buf_offset += (size_t)n))
+			{
+				agent_conn_wait(conn, EV_WRITE);
+				return;
+			}
+
+			// 请求发送完毕，复用缓冲区接收响应
+			conn->state = ZBX_AGENT_CONN_RECV;
+			conn->buf_offset = 0;
+			agent_conn_wait(conn, EV_READ);
+			return;
+		case ZBX_AGENT_CONN_RECV:
+			// 保留一个字节用于字符串结束符
+			if (conn->buf_alloc - conn->buf_offset < ZBX_STAT_BUF_LEN)
+			{
+				if (ZBX_MAX_RECV_DATA_SIZE < conn->buf_offset)
+				{
+					SET_MSG_RESULT(conn->results, zbx_dsprintf(NULL, "Get value from agent failed:"
+							" message size exceeds the maximum size " ZBX_FS_UI64 " bytes",
+							(zbx_uint64_t)ZBX_MAX_RECV_DATA_SIZE));
+					agent_conn_finish(conn, NETWORK_ERROR);
+					return;
+				}
+
+				conn->buf_alloc = MAX(conn->buf_alloc * 2, conn->buf_offset + ZBX_STAT_BUF_LEN + 1);
+				conn->buf = (char *)zbx_realloc(conn->buf, conn->buf_alloc);
+			}
+
+			if (-1 == (n = read(fd, conn->buf + conn->buf_offset, conn->buf_alloc - conn->buf_offset - 1)))
+			{
+				if (EAGAIN == errno || EINTR == errno)
+				{
+					agent_conn_wait(conn, EV_READ);
+					return;
+				}
+
+				SET_MSG_RESULT(conn->results, zbx_dsprintf(NULL, "Get value from agent failed: cannot"
+						" read from [[%s]:%hu]: %s", item->interface.addr,
+						item->interface.port, zbx_strerror(errno)));
+				agent_conn_finish(conn, NETWORK_ERROR);
+				return;
+			}
+
+			conn->buf_offset += (size_t)n;
+
+			// 连接未关闭且数据不完整时继续等待
+			if (0 != n && SUCCEED != agent_conn_response_complete(conn))
+			{
+				agent_conn_wait(conn, EV_READ);
+				return;
+			}
+
+			agent_conn_finish(conn, agent_conn_process_response(conn));
+			return;
+		default:
+			THIS_SHOULD_NEVER_HAPPEN;
+			agent_conn_finish(conn, NETWORK_ERROR);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: agent_conn_create                                                *
+ *                                                                            *
+ * Purpose: initialize agent connection and resolve the agent address         *
+ *                                                                            *
+ * Parameters: conn     - [OUT] the agent connection                          *
+ *             base     - [IN] the event base                                 *
+ *             active   - [IN/OUT] the number of connections in progress      *
+ *             ai_bind  - [IN] the resolved source address, NULL if not set   *
+ *             items    - [IN] the items to request over the connection       *
+ *             results  - [OUT] the item results                              *
+ *             errcodes - [OUT] the item result codes                         *
+ *             num      - [IN] the number of items                            *
+ *                                                                            *
+ * Comments: getaddrinfo() blocks, so all connections of a round are resolved *
+ *           before any of them is started and their timeouts begin.          *
+ *           On failure the connection is finished with NETWORK_ERROR.        *
+ *                                                                            *
+ ******************************************************************************/
+static void	agent_conn_create(zbx_agent_conn_t *conn, struct event_base *base, int *active,
+		const struct addrinfo *ai_bind, DC_ITEM *items, AGENT_RESULT *results, int *errcodes, int num)
+{
+	struct addrinfo	hints;
+	char		service[8];
+
+	memset(conn, 0, sizeof(zbx_agent_conn_t));
+
+	conn->items = items;
+	conn->results = results;
+	conn->errcodes = errcodes;
+	conn->num = num;
+	conn->active = active;
+	conn->base = base;
+	conn->fd = -1;
+	conn->ai_bind = ai_bind;
+
+	(*active)++;
+
+	if (NULL != CONFIG_SOURCE_IP && NULL == ai_bind)
+	{
+		SET_MSG_RESULT(results, zbx_dsprintf(NULL, "Get value from agent failed: invalid source IP address"
+				" [%s]", CONFIG_SOURCE_IP));
+		agent_conn_finish(conn, NETWORK_ERROR);
+		return;
+	}
+
+	// 解析代理地址，与阻塞方式一样使用getaddrinfo()
+	zbx_snprintf(service, sizeof(service), "%hu", items->interface.port);
+	memset(&hints, 0, sizeof(hints));
+#ifdef HAVE_IPV6
+	hints.ai_family = PF_UNSPEC;
+#else
+	hints.ai_family = PF_INET;
+#endif
+	hints.ai_socktype = SOCK_STREAM;
+
+	if (0 != getaddrinfo(items->interface.addr, service, &hints, &conn->ai))
+	{
+		conn->ai = NULL;
+		SET_MSG_RESULT(results, zbx_dsprintf(NULL, "Get value from agent failed: cannot resolve [%s]",
+				items->interface.addr));
+		agent_conn_finish(conn, NETWORK_ERROR);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: agent_conns_start                                                *
+ *                                                                            *
+ * Purpose: start all resolved connections and wait until they complete       *
+ *                                                                            *
+ * Parameters: conns  - [IN] the agent connections                            *
+ *             num    - [IN] the number of connections                        *
+ *             base   - [IN] the event base                                   *
+ *             active - [IN] the number of connections in progress            *
+ *                                                                            *
+ ******************************************************************************/
+static void	agent_conns_start(zbx_agent_conn_t *conns, int num, struct event_base *base, const int *active)
+{
+	int	i;
+
+	for (i = 0; i < num; i++)
+	{
+		if (NULL != conns[i].ai)
+			agent_conn_start(&conns[i]);
+	}
+
+	// 事件循环在所有连接完成后退出
+	if (0 != *active)
+		event_base_dispatch(base);
+}
+
+#endif	/* HAVE_LIBEVENT */
+
+/******************************************************************************
+ *                                                                            *
+ * Function: get_values_agent_async                                           *
+ *                                                                            *
+ * Purpose: retrieve data from multiple Zabbix agents concurrently            *
+ *                                                                            *
+ * Parameters: items    - [IN] the unencrypted Zabbix agent items             *
+ *             results  - [OUT] the item results                              *
+ *             errcodes - [IN/OUT] the item result codes, only items with     *
+ *                                 SUCCEED code are polled                    *
+ *             num      - [IN] the number of items                            *
+ *                                                                            *
+ * Comments: every item or group of up to MaxItemsPerAgentRequest items of    *
+ *           the same interface uses its own non-blocking connection limited  *
+ *           by Timeout, all connections are multiplexed with libevent.       *
+ *           Result codes are the same as returned by get_value_agent().      *
+ *                                                                            *
+ ******************************************************************************/
+/******************************************************************************
+ * *
+ *这个函数用一个事件循环同时处理一批被动代理监控项，每个监控项使用独立的非阻塞连接和超时，
+ *从而让一个轮询进程同时保持多个请求在途，而不是逐个阻塞等待网络响应。
+ ******************************************************************************/
+void	get_values_agent_async(DC_ITEM *items, AGENT_RESULT *results, int *errcodes, int num)
+{
+	const char		*__function_name = "get_values_agent_async";
+#ifdef HAVE_LIBEVENT
+	struct event_base	*base;
+	struct addrinfo		hints, *ai_bind = NULL;
+	zbx_agent_conn_t	*conns;
+	int			i, batch, active = 0;
+#endif
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() num:%d", __function_name, num);
+
+#ifdef HAVE_LIBEVENT
+	if (NULL != (base = event_base_new()))
+	{
+		conns = (zbx_agent_conn_t *)zbx_calloc(NULL, (size_t)num, sizeof(zbx_agent_conn_t));
+
+		// 源地址只解析一次，由所有连接共用
+		if (NULL != CONFIG_SOURCE_IP)
+		{
+			memset(&hints, 0, sizeof(hints));
+			hints.ai_family = PF_UNSPEC;
+			hints.ai_socktype = SOCK_STREAM;
+			hints.ai_flags = AI_NUMERICHOST;
+
+			if (0 != getaddrinfo(CONFIG_SOURCE_IP, NULL, &hints, &ai_bind))
+				ai_bind = NULL;
+		}
+
+		// 为每个监控项或同一接口的一组监控项发起非阻塞连接
+		for (i = 0; i < num; i += batch)
+		{
+			if (SUCCEED != errcodes[i])
+			{
+				batch = 1;
+				continue;
+			}
+
+			batch = agent_batch_size(&items[i], &errcodes[i], num - i);
+			agent_conn_create(&conns[i], base, &active, ai_bind, &items[i], &results[i], &errcodes[i], batch);
+		}
+
+		agent_conns_start(conns, num, base, &active);
+
+		// 逐个请求代理未返回的监控项
+		for (i = 0; i < num; i++)
+		{
+			if (ZBX_AGENT_ITEM_PENDING == errcodes[i])
+				agent_conn_create(&conns[i], base, &active, ai_bind, &items[i], &results[i], &errcodes[i], 1);
+		}
+
+		agent_conns_start(conns, num, base, &active);
+
+		if (NULL != ai_bind)
+			freeaddrinfo(ai_bind);
+
+		zbx_free(conns);
+		event_base_free(base);
+
+		goto out;
+	}
+
+	zabbix_log(LOG_LEVEL_WARNING, "cannot initialize event base, polling agent items one connection at a time");
+#endif
+	// 无法使用事件循环时逐个连接阻塞获取
+	get_values_agent(items, results, errcodes, num);
+#ifdef HAVE_LIBEVENT
+out:
+#endif
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __function_name);
+}
@@ -26,5 +26,7 @@
 extern char	*CONFIG_SOURCE_IP;
 
 int	get_value_agent(DC_ITEM *item, AGENT_RESULT *result);
+void	get_values_agent(DC_ITEM *items, AGENT_RESULT *results, int *errcodes, int num);
+void	get_values_agent_async(DC_ITEM *items, AGENT_RESULT *results, int *errcodes, int num);
 
 #endif
@@ -594,8 +594,10 @@ static int	parse_query_fields(const DC_ITEM *item, char **query_fields)
  *                                                                            *
  * Author: Alexei Vladishev                                                   *
  *                                                                            *
- * Comments: processes single item at a time except for Java, SNMP items,     *
- *           see DCconfig_get_poller_items()                                  *
+ * Comments: processes single item at a time except for Java, SNMP items      *
+ *           and Zabbix agent items when MaxConcurrentAgentChecks or          *
+ *           MaxItemsPerAgentRequest is above 1, see                          *
+ *           DCconfig_get_poller_items()                                      *
  *                                                                            *
  ******************************************************************************/
 // 定义一个名为get_values的函数，该函数接受两个参数：一个表示轮询器类型的无符号字符和一个指向检查下一个时间戳的整型指针。
@@ -604,14 +606,11 @@ static int get_values(unsigned char poller_type, int *nextcheck)
     // 定义一个常量字符串，表示当前函数的名称
     const char *__function_name = "get_values";
 
-    // 定义一个数组，用于存储DC配置中的所有轮询器项
-    DC_ITEM items[MAX_POLLER_ITEMS];
-
-    // 定义一个数组，用于存储轮询器项的结果
-    AGENT_RESULT results[MAX_POLLER_ITEMS];
-
-    // 定义一个数组，用于存储轮询器项的错误代码
-    int errcodes[MAX_POLLER_ITEMS];
+    // 定义数组，用于存储DC配置中的轮询器项、结果和错误代码
+    // 异步代理检查一次最多可获取MaxConcurrentAgentChecks个监控项，数组较大，因此分配在堆上并重复使用
+    static DC_ITEM		*items = NULL;
+    static AGENT_RESULT	*results;
+    static int		*errcodes;
 
     // 定义一个结构体，用于存储时间戳
     zbx_timespec_t timespec;
@@ -628,6 +627,15 @@ static int get_values(unsigned char poller_type, int *nextcheck)
     // 记录当前函数的日志
     zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
 
+    if (NULL == items)
+    {
+        int	items_max = MAX(MAX_POLLER_ITEMS, CONFIG_MAX_CONCURRENT_AGENT_CHECKS);
+
+        items = (DC_ITEM *)zbx_malloc(NULL, sizeof(DC_ITEM) * items_max);
+        results = (AGENT_RESULT *)zbx_malloc(NULL, sizeof(AGENT_RESULT) * items_max);
+        errcodes = (int *)zbx_malloc(NULL, sizeof(int) * items_max);
+    }
+
     // 获取DC配置中的所有轮询器项
     num = DCconfig_get_poller_items(poller_type, items);
 
@@ -867,6 +875,14 @@ static int get_values(unsigned char poller_type, int *nextcheck)
 		get_values_java(ZBX_JAVA_GATEWAY_REQUEST_JMX, items, results, errcodes, num);
 		zbx_alarm_off();
 	}
+	else if (ITEM_TYPE_ZABBIX == items[0].type && 1 < num)
+	{
+		/* agent checks use their own per-connection timeouts */
+		if (ZBX_TCP_SEC_UNENCRYPTED == items[0].host.tls_connect)
+			get_values_agent_async(items, results, errcodes, num);
+		else
+			get_values_agent(items, results, errcodes, num);
+	}
 	else if (1 == num)
 	{
 		if (SUCCEED == errcodes[0])
@@ -880,6 +896,10 @@ static int get_values(unsigned char poller_type, int *nextcheck)
 	/* process item values */
 	for (i = 0; i < num; i++)
 	{
+		/* concurrent agent checks may span several hosts */
+		if (0 != i && items[i].host.hostid != items[i - 1].host.hostid)
+			last_available = HOST_AVAILABLE_UNKNOWN;
+
 		switch (errcodes[i])
 		{
 			case SUCCEED:
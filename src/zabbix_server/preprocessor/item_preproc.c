@@ -31,6 +31,162 @@
 
 #include "item_preproc.h"
 
+/* compiled step parameters unused for this period are removed from cache */
+#define ZBX_PREPROC_CACHE_TTL		SEC_PER_HOUR
+#define ZBX_PREPROC_CACHE_CHECK_PERIOD	(SEC_PER_MIN * 10)
+
+typedef struct
+{
+	unsigned char	type;		/* preprocessing step type */
+	char		*params;	/* preprocessing step parameters */
+	void		*data;		/* compiled parameters - zbx_regexp_t or zbx_jsonpath_t */
+	int		lastaccess;
+}
+zbx_preproc_cache_step_t;
+
+static zbx_hash_t	preproc_cache_step_hash(const void *d)
+{
+	const zbx_preproc_cache_step_t	*step = (const zbx_preproc_cache_step_t *)d;
+	zbx_hash_t			hash;
+
+	hash = ZBX_DEFAULT_STRING_HASH_FUNC(step->params);
+
+	return ZBX_DEFAULT_HASH_ALGO(&step->type, sizeof(step->type), hash);
+}
+
+static int	preproc_cache_step_compare(const void *d1, const void *d2)
+{
+	const zbx_preproc_cache_step_t	*step1 = (const zbx_preproc_cache_step_t *)d1;
+	const zbx_preproc_cache_step_t	*step2 = (const zbx_preproc_cache_step_t *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(step1->type, step2->type);
+
+	return strcmp(step1->params, step2->params);
+}
+
+static void	preproc_cache_step_clear(void *d)
+{
+	zbx_preproc_cache_step_t	*step = (zbx_preproc_cache_step_t *)d;
+
+	switch (step->type)
+	{
+		case ZBX_PREPROC_REGSUB:
+			zbx_regexp_free((zbx_regexp_t *)step->data);
+			break;
+		case ZBX_PREPROC_JSONPATH:
+			zbx_jsonpath_clear((zbx_jsonpath_t *)step->data);
+			zbx_free(step->data);
+			break;
+	}
+
+	zbx_free(step->params);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_preproc_cache_init                                           *
+ *                                                                            *
+ * Purpose: initializes compiled preprocessing step cache                     *
+ *                                                                            *
+ * Parameters: cache - [IN] the cache to initialize                           *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_preproc_cache_init(zbx_preproc_cache_t *cache)
+{
+	zbx_hashset_create_ext(&cache->steps, 0, preproc_cache_step_hash, preproc_cache_step_compare,
+			preproc_cache_step_clear, ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC,
+			ZBX_DEFAULT_MEM_FREE_FUNC);
+	cache->lastcheck = (int)time(NULL);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_preproc_cache_destroy                                        *
+ *                                                                            *
+ * Purpose: frees resources allocated by compiled preprocessing step cache    *
+ *                                                                            *
+ * Parameters: cache - [IN] the cache to destroy                              *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_preproc_cache_destroy(zbx_preproc_cache_t *cache)
+{
+	zbx_hashset_destroy(&cache->steps);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: preproc_cache_get                                                *
+ *                                                                            *
+ * Purpose: gets compiled preprocessing step parameters from cache            *
+ *                                                                            *
+ * Parameters: cache  - [IN] the cache                                        *
+ *             type   - [IN] the preprocessing step type                      *
+ *             params - [IN] the preprocessing step parameters                *
+ *                                                                            *
+ * Return value: the compiled parameters or NULL if they are not cached       *
+ *                                                                            *
+ ******************************************************************************/
+static void	*preproc_cache_get(zbx_preproc_cache_t *cache, unsigned char type, const char *params)
+{
+	zbx_preproc_cache_step_t	*step, step_local;
+
+	step_local.type = type;
+	step_local.params = (char *)params;
+
+	if (NULL == (step = (zbx_preproc_cache_step_t *)zbx_hashset_search(&cache->steps, &step_local)))
+		return NULL;
+
+	step->lastaccess = (int)time(NULL);
+
+	return step->data;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: preproc_cache_put                                                *
+ *                                                                            *
+ * Purpose: stores compiled preprocessing step parameters in cache            *
+ *                                                                            *
+ * Parameters: cache  - [IN] the cache                                        *
+ *             type   - [IN] the preprocessing step type                      *
+ *             params - [IN] the preprocessing step parameters                *
+ *             data   - [IN] the compiled parameters, the cache takes         *
+ *                           ownership                                        *
+ *                                                                            *
+ * Comments: Steps not used for ZBX_PREPROC_CACHE_TTL seconds are removed, so *
+ *           the cache does not grow with every configuration change.         *
+ *                                                                            *
+ ******************************************************************************/
+static void	preproc_cache_put(zbx_preproc_cache_t *cache, unsigned char type, const char *params, void *data)
+{
+	zbx_preproc_cache_step_t	step_local;
+	int				now;
+
+	now = (int)time(NULL);
+
+	if (now - cache->lastcheck >= ZBX_PREPROC_CACHE_CHECK_PERIOD)
+	{
+		zbx_hashset_iter_t		iter;
+		zbx_preproc_cache_step_t	*step;
+
+		zbx_hashset_iter_reset(&cache->steps, &iter);
+		while (NULL != (step = (zbx_preproc_cache_step_t *)zbx_hashset_iter_next(&iter)))
+		{
+			if (now - step->lastaccess >= ZBX_PREPROC_CACHE_TTL)
+				zbx_hashset_iter_remove(&iter);
+		}
+
+		cache->lastcheck = now;
+	}
+
+	step_local.type = type;
+	step_local.params = zbx_strdup(NULL, params);
+	step_local.data = data;
+	step_local.lastaccess = now;
+
+	zbx_hashset_insert(&cache->steps, &step_local, sizeof(step_local));
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: item_preproc_numeric_type_hint                                   *
@@ -938,7 +1094,8 @@ static int	item_preproc_hex2dec(zbx_variant_t *value, char **errmsg)
  *                                                                            *
  * Purpose: execute regular expression substitution operation                 *
  *                                                                            *
- * Parameters: value  - [IN/OUT] the value to process                         *
+ * Parameters: cache  - [IN] the compiled step cache (optional)               *
+ *             value  - [IN/OUT] the value to process                         *
  *             params - [IN] the operation parameters                         *
  *             errmsg - [OUT] error message                                   *
  *                                                                            *
@@ -951,7 +1108,8 @@ static int	item_preproc_hex2dec(zbx_variant_t *value, char **errmsg)
  * 以及一个指向错误信息的指针 errmsg。该函数的主要目的是对输入的 value 进行预处理，
  * 使用正则表达式替换 value 中的特定字符串，并将替换后的结果存储在 value 中。
  */
-static int	item_preproc_regsub_op(zbx_variant_t *value, const char *params, char **errmsg)
+static int	item_preproc_regsub_op(zbx_preproc_cache_t *cache, zbx_variant_t *value, const char *params,
+		char **errmsg)
 {
 	/* 定义一个字符数组 pattern，用于存储输入的参数 params，并进行后续操作 */
 	char		pattern[ITEM_PREPROC_PARAMS_LEN * ZBX_MAX_BYTES_IN_UTF8_CHAR + 1];
@@ -961,6 +1119,7 @@ static int	item_preproc_regsub_op(zbx_variant_t *value, const char *params, char
 	const char	*regex_error;
 	/* 定义一个指向正则表达式的指针 regex，用于存储编译后的正则表达式 */
 	zbx_regexp_t	*regex = NULL;
+	int		ret = FAIL;
 
 	/* 判断 value 是否为字符串类型，如果不是，则转换为字符串类型 */
 	if (FAIL == item_preproc_convert_value(value, ZBX_VARIANT_STR, errmsg))
@@ -978,25 +1137,33 @@ static int	item_preproc_regsub_op(zbx_variant_t *value, const char *params, char
 
 	*output++ = '\0';
 
-	if (FAIL == zbx_regexp_compile_ext(pattern, &regex, 0, &regex_error))	/* PCRE_MULTILINE is not used here */
+	if (NULL == cache || NULL == (regex = (zbx_regexp_t *)preproc_cache_get(cache, ZBX_PREPROC_REGSUB, params)))
 	{
-		*errmsg = zbx_dsprintf(*errmsg, "invalid regular expression: %s", regex_error);
-		return FAIL;
+		if (FAIL == zbx_regexp_compile_ext(pattern, &regex, 0, &regex_error))	/* PCRE_MULTILINE is not used here */
+		{
+			*errmsg = zbx_dsprintf(*errmsg, "invalid regular expression: %s", regex_error);
+			return FAIL;
+		}
+
+		if (NULL != cache)
+			preproc_cache_put(cache, ZBX_PREPROC_REGSUB, params, regex);
 	}
 
 	if (FAIL == zbx_mregexp_sub_precompiled(value->data.str, regex, output, ZBX_MAX_RECV_DATA_SIZE, &new_value))
 	{
 		*errmsg = zbx_strdup(*errmsg, "pattern does not match");
-		zbx_regexp_free(regex);
-		return FAIL;
+		goto out;
 	}
 
 	zbx_variant_clear(value);
 	zbx_variant_set_str(value, new_value);
 
-	zbx_regexp_free(regex);
+	ret = SUCCEED;
+out:
+	if (NULL == cache)
+		zbx_regexp_free(regex);
 
-	return SUCCEED;
+	return ret;
 }
 /******************************************************************************
  *                                                                            *
@@ -1004,7 +1171,8 @@ static int	item_preproc_regsub_op(zbx_variant_t *value, const char *params, char
  *                                                                            *
  * Purpose: execute regular expression substitution operation                 *
  *                                                                            *
- * Parameters: value  - [IN/OUT] the value to process                         *
+ * Parameters: cache  - [IN] the compiled step cache (optional)               *
+ *             value  - [IN/OUT] the value to process                         *
  *             params - [IN] the operation parameters                         *
  *             errmsg - [OUT] error message                                   *
  *                                                                            *
@@ -1016,14 +1184,15 @@ static int	item_preproc_regsub_op(zbx_variant_t *value, const char *params, char
 // 参数1：一个指向 zbx_variant_t 结构体的指针，用于存储数据；
 // 参数2：一个指向字符串的指针，表示正则表达式的参数；
 // 参数3：一个指向字符指针的指针，用于存储错误信息。
-static int	item_preproc_regsub(zbx_variant_t *value, const char *params, char **errmsg)
+static int	item_preproc_regsub(zbx_preproc_cache_t *cache, zbx_variant_t *value, const char *params,
+		char **errmsg)
 {
 	// 定义一个字符指针变量 err，用于存储可能的错误信息。
 	char	*err = NULL;
 
 	// 调用 item_preproc_regsub_op 函数，对传入的 value 和 params 进行正则表达式匹配。
 	// 如果匹配成功，返回 SUCCEED 表示成功；如果匹配失败，会将错误信息存储在 err 指针所指向的字符串中。
-	if (SUCCEED == item_preproc_regsub_op(value, params, &err))
+	if (SUCCEED == item_preproc_regsub_op(cache, value, params, &err))
 		return SUCCEED;
 
 	// 如果匹配失败，将 err 指针所指向的错误信息赋值给 errmsg 指针所指向的字符串。
@@ -1043,7 +1212,8 @@ static int	item_preproc_regsub(zbx_variant_t *value, const char *params, char **
  *                                                                            *
  * Purpose: execute jsonpath query                                            *
  *                                                                            *
- * Parameters: value  - [IN/OUT] the value to process                         *
+ * Parameters: cache  - [IN] the compiled step cache (optional)               *
+ *             value  - [IN/OUT] the value to process                         *
  *             params - [IN] the operation parameters                         *
  *             errmsg - [OUT] error message                                   *
  *                                                                            *
@@ -1051,15 +1221,48 @@ static int	item_preproc_regsub(zbx_variant_t *value, const char *params, char **
  *               FAIL - otherwise                                             *
  *                                                                            *
  ******************************************************************************/
-static int	item_preproc_jsonpath_op(zbx_variant_t *value, const char *params, char **errmsg)
+static int	item_preproc_jsonpath_op(zbx_preproc_cache_t *cache, zbx_variant_t *value, const char *params,
+		char **errmsg)
 {
 	struct zbx_json_parse	jp;
 	char			*data = NULL;
+	zbx_jsonpath_t		jsonpath_local, *jsonpath;
+	int			ret;
 
 	if (FAIL == item_preproc_convert_value(value, ZBX_VARIANT_STR, errmsg))
 		return FAIL;
 
-	if (FAIL == zbx_json_open(value->data.str, &jp) || FAIL == zbx_jsonpath_query(&jp, params, &data))
+	if (FAIL == zbx_json_open(value->data.str, &jp))
+	{
+		*errmsg = zbx_strdup(*errmsg, zbx_json_strerror());
+		return FAIL;
+	}
+
+	if (NULL == cache ||
+			NULL == (jsonpath = (zbx_jsonpath_t *)preproc_cache_get(cache, ZBX_PREPROC_JSONPATH, params)))
+	{
+		if (FAIL == zbx_jsonpath_compile(params, &jsonpath_local))
+		{
+			*errmsg = zbx_strdup(*errmsg, zbx_json_strerror());
+			return FAIL;
+		}
+
+		if (NULL != cache)
+		{
+			jsonpath = (zbx_jsonpath_t *)zbx_malloc(NULL, sizeof(zbx_jsonpath_t));
+			*jsonpath = jsonpath_local;
+			preproc_cache_put(cache, ZBX_PREPROC_JSONPATH, params, jsonpath);
+		}
+		else
+			jsonpath = &jsonpath_local;
+	}
+
+	ret = zbx_jsonpath_query_precompiled(&jp, jsonpath, &data);
+
+	if (jsonpath == &jsonpath_local)
+		zbx_jsonpath_clear(&jsonpath_local);
+
+	if (FAIL == ret)
 	{
 		*errmsg = zbx_strdup(*errmsg, zbx_json_strerror());
 		return FAIL;
@@ -1083,7 +1286,8 @@ static int	item_preproc_jsonpath_op(zbx_variant_t *value, const char *params, ch
  *                                                                            *
  * Purpose: execute jsonpath query                                            *
  *                                                                            *
- * Parameters: value  - [IN/OUT] the value to process                         *
+ * Parameters: cache  - [IN] the compiled step cache (optional)               *
+ *             value  - [IN/OUT] the value to process                         *
  *             params - [IN] the operation parameters                         *
  *             errmsg - [OUT] error message                                   *
  *                                                                            *
@@ -1102,11 +1306,12 @@ static int	item_preproc_jsonpath_op(zbx_variant_t *value, const char *params, ch
  * 一个指向 const char * 类型的指针 params，
  * 还有一个指向 char ** 类型的指针 errmsg。
  */
-static int	item_preproc_jsonpath(zbx_variant_t *value, const char *params, char **errmsg)
+static int	item_preproc_jsonpath(zbx_preproc_cache_t *cache, zbx_variant_t *value, const char *params,
+		char **errmsg)
 {
 	char	*err = NULL;
 
-	if (SUCCEED == item_preproc_jsonpath_op(value, params, &err))
+	if (SUCCEED == item_preproc_jsonpath_op(cache, value, params, &err))
 		return SUCCEED;
 
 	*errmsg = zbx_dsprintf(*errmsg, "cannot extract value from json by path \"%s\": %s", params, err);
@@ -1292,7 +1497,9 @@ static int	item_preproc_xpath(zbx_variant_t *value, const char *params, char **e
  *                                                                            *
  * Purpose: execute preprocessing operation                                   *
  *                                                                            *
- * Parameters: value_type    - [IN] the item value type                       *
+ * Parameters: cache         - [IN] the compiled step cache, NULL to compile  *
+ *                                  step parameters for every call            *
+ *             value_type    - [IN] the item value type                       *
  *             value         - [IN/OUT] the value to process                  *
  *             ts            - [IN] the value timestamp                       *
  *             op            - [IN] the preprocessing operation to execute    *
@@ -1314,8 +1521,9 @@ static int	item_preproc_xpath(zbx_variant_t *value, const char *params, char **e
 // 
 // 该函数的主要目的是对传入的值根据预处理操作进行相应的处理，如去除前后空格、替换字符等，并返回处理后的值和相关错误信息。
 
-int	zbx_item_preproc(unsigned char value_type, zbx_variant_t *value, const zbx_timespec_t *ts,
-		const zbx_preproc_op_t *op, zbx_item_history_value_t *history_value, char **errmsg)
+int	zbx_item_preproc(zbx_preproc_cache_t *cache, unsigned char value_type, zbx_variant_t *value,
+		const zbx_timespec_t *ts, const zbx_preproc_op_t *op, zbx_item_history_value_t *history_value,
+		char **errmsg)
 {
 	// 切换到op->type所对应的预处理操作类型
 	switch (op->type)
@@ -1338,7 +1546,7 @@ int	zbx_item_preproc(unsigned char value_type, zbx_variant_t *value, const zbx_t
 
 		// case ZBX_PREPROC_REGSUB：表示正则替换预处理操作
 		case ZBX_PREPROC_REGSUB:
-			return item_preproc_regsub(value, op->params, errmsg);
+			return item_preproc_regsub(cache, value, op->params, errmsg);
 
 		case ZBX_PREPROC_BOOL2DEC:
 			return item_preproc_bool2dec(value, errmsg);
@@ -1353,7 +1561,7 @@ int	zbx_item_preproc(unsigned char value_type, zbx_variant_t *value, const zbx_t
 		case ZBX_PREPROC_XPATH:
 			return item_preproc_xpath(value, op->params, errmsg);
 		case ZBX_PREPROC_JSONPATH:
-			return item_preproc_jsonpath(value, op->params, errmsg);
+			return item_preproc_jsonpath(cache, value, op->params, errmsg);
 	}
 
 	*errmsg = zbx_dsprintf(*errmsg, "unknown preprocessing operation");
@@ -22,7 +22,18 @@
 
 #include "dbcache.h"
 
-int	zbx_item_preproc(unsigned char value_type, zbx_variant_t *value, const zbx_timespec_t *ts,
+/* cache of compiled preprocessing step parameters (regular expressions, jsonpaths) */
+typedef struct
+{
+	zbx_hashset_t	steps;
+	int		lastcheck;	/* the last time unused steps were removed */
+}
+zbx_preproc_cache_t;
+
+void	zbx_preproc_cache_init(zbx_preproc_cache_t *cache);
+void	zbx_preproc_cache_destroy(zbx_preproc_cache_t *cache);
+
+int	zbx_item_preproc(zbx_preproc_cache_t *cache, unsigned char value_type, zbx_variant_t *value, const zbx_timespec_t *ts,
 		const zbx_preproc_op_t *op, zbx_item_history_value_t *history_value, char **errmsg);
 
 int	zbx_item_preproc_convert_value_to_numeric(zbx_variant_t *value_num, const zbx_variant_t *value,
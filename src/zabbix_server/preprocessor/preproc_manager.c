@@ -40,6 +40,9 @@ extern int		server_num, process_num, CONFIG_PREPROCESSOR_FORKS;
 #define ZBX_PREPROC_PRIORITY_NONE	0
 #define ZBX_PREPROC_PRIORITY_FIRST	1
 
+#define ZBX_PREPROC_BATCH_MAX		256		/* maximum number of tasks sent to worker at once */
+#define ZBX_PREPROC_BATCH_SIZE		ZBX_MEBIBYTE	/* batch data size after which no tasks are added */
+
 typedef enum
 {
 	REQUEST_STATE_QUEUED		= 0,		/* requires preprocessing */
@@ -67,7 +70,7 @@ zbx_preprocessing_request_t;
 typedef struct
 {
 	zbx_ipc_client_t	*client;	/* the connected preprocessing worker client */
-	zbx_list_item_t		*queue_item;	/* queued item */
+	zbx_vector_ptr_t	tasks;		/* queued items of the tasks sent to worker */
 }
 zbx_preprocessing_worker_t;
 
@@ -174,41 +177,35 @@ static void preprocessor_sync_configuration(zbx_preprocessing_manager_t *manager
 
 /******************************************************************************
  *                                                                            *
- * Function: preprocessor_get_queued_item                                     *
+ * Function: preprocessor_get_queued_items                                    *
  *                                                                            *
- * Purpose: get queued item value with no dependencies (or with resolved      *
+ * Purpose: get queued item values with no dependencies (or with resolved     *
  *          dependencies)                                                     *
  *                                                                            *
  * Parameters: manager - [IN] preprocessing manager                           *
- *                                                                            *
- * Return value: pointer to the queued item or NULL if none                   *
+ *             items   - [OUT] the queued items                               *
+ *             max_num - [IN] the maximum number of items to get              *
  *                                                                            *
  ******************************************************************************/
-static zbx_list_item_t	*preprocessor_get_queued_item(zbx_preprocessing_manager_t *manager)
+static void	preprocessor_get_queued_items(zbx_preprocessing_manager_t *manager, zbx_vector_ptr_t *items,
+		int max_num)
 {
-	const char			*__function_name = "preprocessor_get_queued_item";
+	const char			*__function_name = "preprocessor_get_queued_items";
 	zbx_list_iterator_t		iterator;
 	zbx_preprocessing_request_t	*request;
-	zbx_list_item_t			*item = NULL;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
 
 	zbx_list_iterator_init(&manager->queue, &iterator);
-	while (SUCCEED == zbx_list_iterator_next(&iterator))
+	while (items->values_num < max_num && SUCCEED == zbx_list_iterator_next(&iterator))
 	{
 		zbx_list_iterator_peek(&iterator, (void **)&request);
 
 		if (REQUEST_STATE_QUEUED == request->state)
-		{
-			/* queued item is found */
-			item = iterator.current;
-			break;
-		}
+			zbx_vector_ptr_append(items, iterator.current);
 	}
 
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __function_name);
-
-	return item;
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() items:%d", __function_name, items->values_num);
 }
 
 /******************************************************************************
@@ -264,13 +261,37 @@ static zbx_preprocessing_worker_t	*preprocessor_get_free_worker(zbx_preprocessin
 
 	for (i = 0; i < manager->worker_count; i++)
 	{
-		if (NULL == manager->workers[i].queue_item)
+		if (0 == manager->workers[i].tasks.values_num)
 			return &manager->workers[i];
 	}
 
 	return NULL;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: preprocessor_get_free_worker_num                                 *
+ *                                                                            *
+ * Purpose: get number of workers without active preprocessing tasks          *
+ *                                                                            *
+ * Parameters: manager - [IN] preprocessing manager                           *
+ *                                                                            *
+ * Return value: the number of free workers                                   *
+ *                                                                            *
+ ******************************************************************************/
+static int	preprocessor_get_free_worker_num(zbx_preprocessing_manager_t *manager)
+{
+	int	i, free_num = 0;
+
+	for (i = 0; i < manager->worker_count; i++)
+	{
+		if (0 == manager->workers[i].tasks.values_num)
+			free_num++;
+	}
+
+	return free_num;
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: preprocessor_create_task                                         *
@@ -316,6 +337,11 @@ static zbx_uint32_t	preprocessor_create_task(zbx_preprocessing_manager_t *manage
  *                                                                            *
  * Parameters: manager - [IN] preprocessing manager                           *
  *                                                                            *
+ * Comments: Queued tasks are split evenly between free workers and sent in   *
+ *           batches of [size][task] records to reduce the number of IPC      *
+ *           round trips. A batch is limited to ZBX_PREPROC_BATCH_MAX tasks   *
+ *           and is closed after reaching ZBX_PREPROC_BATCH_SIZE bytes.       *
+ *                                                                            *
  ******************************************************************************/
 static void	preprocessor_assign_tasks(zbx_preprocessing_manager_t *manager)
 {
@@ -323,30 +349,61 @@ static void	preprocessor_assign_tasks(zbx_preprocessing_manager_t *manager)
 	zbx_list_item_t			*queue_item;
 	zbx_preprocessing_request_t	*request;
 	zbx_preprocessing_worker_t	*worker;
-	zbx_uint32_t			size;
-	unsigned char			*task;
+	zbx_vector_ptr_t		queued;
+	zbx_uint32_t			size, data_alloc = 0, data_offset;
+	unsigned char			*task, *data = NULL;
+	int				free_num, batch_num, index = 0;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
 
-	while (NULL != (worker = preprocessor_get_free_worker(manager)) &&
-			NULL != (queue_item = preprocessor_get_queued_item(manager)))
+	if (0 == (free_num = preprocessor_get_free_worker_num(manager)))
+		goto out;
+
+	zbx_vector_ptr_create(&queued);
+	preprocessor_get_queued_items(manager, &queued, free_num * ZBX_PREPROC_BATCH_MAX);
+
+	batch_num = (queued.values_num + free_num - 1) / free_num;
+
+	while (index < queued.values_num && NULL != (worker = preprocessor_get_free_worker(manager)))
 	{
-		request = (zbx_preprocessing_request_t *)queue_item->data;
-		size = preprocessor_create_task(manager, request, &task);
+		data_offset = 0;
+
+		while (index < queued.values_num && worker->tasks.values_num < batch_num &&
+				ZBX_PREPROC_BATCH_SIZE > data_offset)
+		{
+			queue_item = (zbx_list_item_t *)queued.values[index++];
+			request = (zbx_preprocessing_request_t *)queue_item->data;
+			size = preprocessor_create_task(manager, request, &task);
+
+			if (data_alloc - data_offset < size + sizeof(zbx_uint32_t))
+			{
+				while (data_alloc - data_offset < size + sizeof(zbx_uint32_t))
+					data_alloc += ZBX_KIBIBYTE * 64;
+
+				data = (unsigned char *)zbx_realloc(data, data_alloc);
+			}
+
+			data_offset += zbx_serialize_value(data + data_offset, size);
+			memcpy(data + data_offset, task, size);
+			data_offset += size;
+
+			request->state = REQUEST_STATE_PROCESSING;
+			zbx_vector_ptr_append(&worker->tasks, queue_item);
+
+			request_free_steps(request);
+			zbx_free(task);
+		}
 
-		if (FAIL == zbx_ipc_client_send(worker->client, ZBX_IPC_PREPROCESSOR_REQUEST, task, size))
+		if (FAIL == zbx_ipc_client_send(worker->client, ZBX_IPC_PREPROCESSOR_REQUEST, data, data_offset))
 		{
 			zabbix_log(LOG_LEVEL_CRIT, "cannot send data to preprocessing worker");
 			exit(EXIT_FAILURE);
 		}
-
-		request->state = REQUEST_STATE_PROCESSING;
-		worker->queue_item = queue_item;
-
-		request_free_steps(request);
-		zbx_free(task);
 	}
 
+	zbx_free(data);
+	zbx_vector_ptr_destroy(&queued);
+out:
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __function_name);
 }
 
@@ -946,69 +1003,83 @@ static void preprocessor_add_result(zbx_preprocessing_manager_t *manager, zbx_ip
 	const char			*__function_name = "preprocessor_add_result";
 	zbx_preprocessing_worker_t	*worker;
 	zbx_preprocessing_request_t	*request;
+	zbx_list_item_t			*queue_item;
 	zbx_variant_t			value;
 	char				*error;
 	zbx_item_history_value_t	*history_value, *cached_value;
 	zbx_delta_item_index_t		*index;
+	zbx_uint32_t			size;
+	unsigned char			*ptr;
+	int				i;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
 
 	worker = preprocessor_get_worker_by_client(manager, client);
-	request = (zbx_preprocessing_request_t *)worker->queue_item->data;
+	ptr = message->data;
 
-	/* 解压结果 */
-	zbx_preprocessor_unpack_result(&value, &history_value, &error, message->data);
-
-	/* 处理历史值 */
-	if (NULL != history_value)
+	/* results are received in the same order as the tasks were sent */
+	for (i = 0; i < worker->tasks.values_num; i++)
 	{
-		history_value->itemid = request->value.itemid;
-		history_value->value_type = request->value_type;
+		queue_item = (zbx_list_item_t *)worker->tasks.values[i];
+		request = (zbx_preprocessing_request_t *)queue_item->data;
 
-		if (NULL != (cached_value = (zbx_item_history_value_t *)zbx_hashset_search(&manager->history_cache, history_value)))
+		/* 解压结果 */
+		ptr += zbx_deserialize_value(ptr, &size);
+		zbx_preprocessor_unpack_result(&value, &history_value, &error, ptr);
+		ptr += size;
+
+		/* 处理历史值 */
+		if (NULL != history_value)
 		{
-			if (0 < zbx_timespec_compare(&history_value->timestamp, &cached_value->timestamp))
+			history_value->itemid = request->value.itemid;
+			history_value->value_type = request->value_type;
+
+			if (NULL != (cached_value = (zbx_item_history_value_t *)zbx_hashset_search(
+					&manager->history_cache, history_value)))
 			{
-				/* 更新缓存 */
-				cached_value->timestamp = history_value->timestamp;
-				cached_value->value = history_value->value;
+				if (0 < zbx_timespec_compare(&history_value->timestamp, &cached_value->timestamp))
+				{
+					/* 更新缓存 */
+					cached_value->timestamp = history_value->timestamp;
+					cached_value->value = history_value->value;
+				}
 			}
+			else
+				/* 插入缓存 */
+				zbx_hashset_insert(&manager->history_cache, history_value, sizeof(zbx_item_history_value_t));
 		}
-		else
-			/* 插入缓存 */
-			zbx_hashset_insert(&manager->history_cache, history_value, sizeof(zbx_item_history_value_t));
-	}
 
-	/* 设置请求状态为完成 */
-	request->state = REQUEST_STATE_DONE;
+		/* 设置请求状态为完成 */
+		request->state = REQUEST_STATE_DONE;
 
-	/* value processed - the pending value can now be processed */
-	if (NULL != request->pending)
-		request->pending->state = REQUEST_STATE_QUEUED;
+		/* value processed - the pending value can now be processed */
+		if (NULL != request->pending)
+			request->pending->state = REQUEST_STATE_QUEUED;
 
-	if (NULL != (index = (zbx_delta_item_index_t *)zbx_hashset_search(&manager->delta_items, &request->value.itemid)) &&
-			worker->queue_item == index->queue_item)
-	{
-		/* 删除差分索引中的项 */
-		zbx_hashset_remove_direct(&manager->delta_items, index);
-	}
+		if (NULL != (index = (zbx_delta_item_index_t *)zbx_hashset_search(&manager->delta_items,
+				&request->value.itemid)) && queue_item == index->queue_item)
+		{
+			/* 删除差分索引中的项 */
+			zbx_hashset_remove_direct(&manager->delta_items, index);
+		}
 
-	/* 设置变量结果 */
-	if (FAIL != preprocessor_set_variant_result(request, &value, error))
-		/* 入队处理依赖项 */
-		preprocessor_enqueue_dependent(manager, &request->value, worker->queue_item);
+		/* 设置变量结果 */
+		if (FAIL != preprocessor_set_variant_result(request, &value, error))
+			/* 入队处理依赖项 */
+			preprocessor_enqueue_dependent(manager, &request->value, queue_item);
 
-	/* 清除工作者的队列项 */
-	worker->queue_item = NULL;
+		/* 清除变量值 */
+		zbx_variant_clear(&value);
 
-	/* 清除变量值 */
-	zbx_variant_clear(&value);
+		/* 释放历史值内存 */
+		zbx_free(history_value);
 
-	/* 释放历史值内存 */
-	zbx_free(history_value);
+		/* 减少预处理任务数量 */
+		manager->preproc_num--;
+	}
 
-	/* 减少预处理任务数量 */
-	manager->preproc_num--;
+	/* 清除工作者的队列项 */
+	zbx_vector_ptr_clear(&worker->tasks);
 
 	/* 分配任务 */
 	preprocessor_assign_tasks(manager);
@@ -1117,6 +1188,7 @@ static void preprocessor_register_worker(zbx_preprocessing_manager_t *manager, z
 
 		worker = (zbx_preprocessing_worker_t *)&manager->workers[manager->worker_count++];
 		worker->client = client;
+		zbx_vector_ptr_create(&worker->tasks);
 
 		preprocessor_assign_tasks(manager);
 	}
@@ -1136,6 +1208,10 @@ static void preprocessor_register_worker(zbx_preprocessing_manager_t *manager, z
 static void	preprocessor_destroy_manager(zbx_preprocessing_manager_t *manager)
 {
 	zbx_preprocessing_request_t	*request;
+	int				i;
+
+	for (i = 0; i < manager->worker_count; i++)
+		zbx_vector_ptr_destroy(&manager->workers[i].tasks);
 
 	zbx_free(manager->workers);
 
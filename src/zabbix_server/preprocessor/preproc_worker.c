@@ -38,8 +38,11 @@ extern int		server_num, process_num;
  *                                                                            *
  * Purpose: handle item value preprocessing task                              *
  *                                                                            *
- * Parameters: socket  - [IN] IPC socket                                      *
- *             message - [IN] packed preprocessing task                       *
+ * Parameters: cache  - [IN] the compiled preprocessing step cache            *
+ *             task   - [IN] packed preprocessing task                        *
+ *             result - [OUT] packed preprocessing result                     *
+ *                                                                            *
+ * Return value: the size of packed preprocessing result                      *
  *                                                                            *
  ******************************************************************************/
 /******************************************************************************
@@ -47,12 +50,13 @@ extern int		server_num, process_num;
  *整个代码块的主要目的是对传入的消息进行预处理，包括解析消息中的数据、对数据进行预处理操作、将预处理后的数据打包并发送给客户端。其中，预处理操作包括将value转换为numeric类型、处理steps数组中的每个步骤等。
  ******************************************************************************/
 // 定义一个静态函数worker_preprocess_value，接收两个参数：zbx_ipc_socket_t类型的套接字指针socket，以及zbx_ipc_message_t类型的消息指针message。
-static void worker_preprocess_value(zbx_ipc_socket_t *socket, zbx_ipc_message_t *message)
+static zbx_uint32_t	worker_preprocess_value(zbx_preproc_cache_t *cache, const unsigned char *task,
+		unsigned char **result)
 {
 	// 定义一些变量，包括zbx_uint32_t类型的size，unsigned char类型的指针data和value_type，zbx_uint64_t类型的itemid，以及zbx_variant_t类型的value、value_num等。
 	// 还定义了int类型的i和steps_num，char类型的error，以及zbx_timespec_t类型的指针ts等。
 	zbx_uint32_t			size = 0;
-	unsigned char			*data = NULL, value_type;
+	unsigned char			value_type;
 	zbx_uint64_t			itemid;
 	zbx_variant_t			value, value_num;
 	int				i, steps_num;
@@ -63,8 +67,7 @@ static void worker_preprocess_value(zbx_ipc_socket_t *socket, zbx_ipc_message_t
 	// 以及zbx_preproc_op_t类型的指针steps等。
 	zbx_preproc_op_t		*steps;
 	// 使用zbx_preprocessor_unpack_task函数解析消息中的数据，将解析出的itemid、value_type、ts、value、history_value、steps和steps_num存储在相应的变量中。
-	zbx_preprocessor_unpack_task(&itemid, &value_type, &ts, &value, &history_value, &steps, &steps_num,
-			message->data);
+	zbx_preprocessor_unpack_task(&itemid, &value_type, &ts, &value, &history_value, &steps, &steps_num, task);
 	// 遍历steps数组，对每个步骤进行处理。
 	for (i = 0; i < steps_num; i++)
 	{
@@ -85,7 +88,7 @@ static void worker_preprocess_value(zbx_ipc_socket_t *socket, zbx_ipc_message_t
 			break;
 		}
 
-		if (SUCCEED != zbx_item_preproc(value_type, &value, ts, op, history_value, &error))
+		if (SUCCEED != zbx_item_preproc(cache, value_type, &value, ts, op, history_value, &error))
 		{
 			char	*errmsg_full;
 
@@ -100,7 +103,7 @@ static void worker_preprocess_value(zbx_ipc_socket_t *socket, zbx_ipc_message_t
 			break;
 	}
 
-	size = zbx_preprocessor_pack_result(&data, &value, history_value, error);
+	size = zbx_preprocessor_pack_result(result, &value, history_value, error);
 	// 清空value和error变量。
 	zbx_variant_clear(&value);
 	zbx_free(error);
@@ -111,8 +114,53 @@ static void worker_preprocess_value(zbx_ipc_socket_t *socket, zbx_ipc_message_t
 	if (history_value != &history_value_local)
 		zbx_free(history_value);
 
+	return size;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: worker_preprocess_values                                         *
+ *                                                                            *
+ * Purpose: handle batch of item value preprocessing tasks                    *
+ *                                                                            *
+ * Parameters: cache   - [IN] the compiled preprocessing step cache           *
+ *             socket  - [IN] IPC socket                                      *
+ *             message - [IN] packed preprocessing tasks                      *
+ *                                                                            *
+ * Comments: The request message contains one or more [size][task] records,   *
+ *           the results are sent back in a single message as [size][result] *
+ *           records in the same order.                                       *
+ *                                                                            *
+ ******************************************************************************/
+static void	worker_preprocess_values(zbx_preproc_cache_t *cache, zbx_ipc_socket_t *socket,
+		zbx_ipc_message_t *message)
+{
+	zbx_uint32_t	task_size, result_size, data_alloc = 0, data_offset = 0;
+	unsigned char	*data = NULL, *result, *ptr = message->data;
+
+	while (ptr < message->data + message->size)
+	{
+		ptr += zbx_deserialize_value(ptr, &task_size);
+		result_size = worker_preprocess_value(cache, ptr, &result);
+		ptr += task_size;
+
+		if (data_alloc - data_offset < result_size + sizeof(zbx_uint32_t))
+		{
+			while (data_alloc - data_offset < result_size + sizeof(zbx_uint32_t))
+				data_alloc += ZBX_KIBIBYTE * 64;
+
+			data = (unsigned char *)zbx_realloc(data, data_alloc);
+		}
+
+		data_offset += zbx_serialize_value(data + data_offset, result_size);
+		memcpy(data + data_offset, result, result_size);
+		data_offset += result_size;
+
+		zbx_free(result);
+	}
+
 	// 将打包后的数据发送给客户端。
-	if (FAIL == zbx_ipc_socket_write(socket, ZBX_IPC_PREPROCESSOR_RESULT, data, size))
+	if (FAIL == zbx_ipc_socket_write(socket, ZBX_IPC_PREPROCESSOR_RESULT, data, data_offset))
 	{
 		// 如果发送失败，打印日志并退出程序。
 		zabbix_log(LOG_LEVEL_CRIT, "cannot send preprocessing result");
@@ -135,6 +183,7 @@ ZBX_THREAD_ENTRY(preprocessing_worker_thread, args)
 	char			*error = NULL;
 	zbx_ipc_socket_t	socket;
 	zbx_ipc_message_t	message;
+	zbx_preproc_cache_t	cache;
 
 	// 解析传入的参数，获取进程类型、服务器编号、进程编号
 	process_type = ((zbx_thread_args_t *)args)->process_type;
@@ -146,6 +195,7 @@ ZBX_THREAD_ENTRY(preprocessing_worker_thread, args)
 
 	// 初始化IPC消息结构体
 	zbx_ipc_message_init(&message);
+	zbx_preproc_cache_init(&cache);
 
 	// 尝试打开IPC套接字，连接预处理服务
 	if (FAIL == zbx_ipc_socket_open(&socket, ZBX_IPC_SERVICE_PREPROCESSING, SEC_PER_MIN, &error))
@@ -195,7 +245,7 @@ ZBX_THREAD_ENTRY(preprocessing_worker_thread, args)
 		{
 			case ZBX_IPC_PREPROCESSOR_REQUEST:
 				// 处理预处理请求
-				worker_preprocess_value(&socket, &message);
+				worker_preprocess_values(&cache, &socket, &message);
 				break;
 		}
 
@@ -203,6 +253,8 @@ ZBX_THREAD_ENTRY(preprocessing_worker_thread, args)
 		zbx_ipc_message_clean(&message);
 	}
 
+	zbx_preproc_cache_destroy(&cache);
+
 	// 设置进程标题，表示进程终止
 	zbx_setproctitle("%s #%d [terminated]", get_process_type_string(process_type), process_num);
 
@@ -183,6 +183,12 @@ int	CONFIG_ALERTMANAGER_FORKS	= 1;
 int	CONFIG_PREPROCMAN_FORKS		= 1;
 int	CONFIG_PREPROCESSOR_FORKS	= 3;
 
+/* number of Zabbix agent checks a poller keeps in flight at once, 1 - one blocking check at a time */
+int	CONFIG_MAX_CONCURRENT_AGENT_CHECKS	= 1;
+
+/* number of item keys requested from Zabbix agent over one connection, 1 - one key per connection */
+int	CONFIG_MAX_ITEMS_PER_AGENT_REQUEST	= 1;
+
 int	CONFIG_LISTEN_PORT		= ZBX_DEFAULT_SERVER_PORT;
 char	*CONFIG_LISTEN_IP		= NULL;
 char	*CONFIG_SOURCE_IP		= NULL;
@@ -191,10 +197,16 @@ char	*CONFIG_SERVER			= NULL;		/* not used in zabbix_server, required for linkin
 
 int	CONFIG_HOUSEKEEPING_FREQUENCY	= 1;
 int	CONFIG_MAX_HOUSEKEEPER_DELETE	= 5000;		/* applies for every separate field value */
+int	CONFIG_HOUSEKEEPING_PARTITIONS	= 0;
+int	CONFIG_HOUSEKEEPING_PARTITION_PERIOD	= 24;	/* hours */
+int	CONFIG_HOUSEKEEPING_PARTITIONS_AHEAD	= 3;
 int	CONFIG_HISTSYNCER_FORKS		= 4;
 int	CONFIG_HISTSYNCER_FREQUENCY	= 1;
 int	CONFIG_CONFSYNCER_FORKS		= 1;
 int	CONFIG_CONFSYNCER_FREQUENCY	= 60;
+int	CONFIG_CONFSYNCER_CHANGELOG	= 0;
+int	CONFIG_CONFSYNCER_FULL_FREQUENCY	= SEC_PER_HOUR;
+char	*CONFIG_CONFSYNCER_SNAPSHOT_FILE	= NULL;
 
 int	CONFIG_VMWARE_FORKS		= 0;
 int	CONFIG_VMWARE_FREQUENCY		= 60;
@@ -204,9 +216,12 @@ int	CONFIG_VMWARE_TIMEOUT		= 10;
 zbx_uint64_t	CONFIG_CONF_CACHE_SIZE		= 8 * ZBX_MEBIBYTE;
 zbx_uint64_t	CONFIG_HISTORY_CACHE_SIZE	= 16 * ZBX_MEBIBYTE;
 zbx_uint64_t	CONFIG_HISTORY_INDEX_CACHE_SIZE	= 4 * ZBX_MEBIBYTE;
+int		CONFIG_HISTORY_CACHE_SHARDS	= 1;
 zbx_uint64_t	CONFIG_TRENDS_CACHE_SIZE	= 4 * ZBX_MEBIBYTE;
 zbx_uint64_t	CONFIG_VALUE_CACHE_SIZE		= 8 * ZBX_MEBIBYTE;
+char		*CONFIG_VALUE_CACHE_SNAPSHOT_FILE	= NULL;
 zbx_uint64_t	CONFIG_VMWARE_CACHE_SIZE	= 8 * ZBX_MEBIBYTE;
+int		CONFIG_CACHE_SLAB_ALLOCATOR	= 0;
 zbx_uint64_t	CONFIG_EXPORT_FILE_SIZE		= ZBX_GIBIBYTE;
 
 int	CONFIG_UNREACHABLE_PERIOD	= 45;
@@ -226,6 +241,8 @@ char	*CONFIG_DBPASSWORD		= NULL;
 char	*CONFIG_DBSOCKET		= NULL;
 char	*CONFIG_EXPORT_DIR		= NULL;
 int	CONFIG_DBPORT			= 0;
+int	CONFIG_DB_COPY_HISTORY		= 0;
+int	CONFIG_DB_PREPARED_STATEMENTS	= 0;
 int	CONFIG_ENABLE_REMOTE_COMMANDS	= 0;
 int	CONFIG_LOG_REMOTE_COMMANDS	= 0;
 int	CONFIG_UNSAFE_USER_PARAMETERS	= 0;
@@ -289,6 +306,10 @@ static char	*CONFIG_SOCKET_PATH	= NULL;
 char	*CONFIG_HISTORY_STORAGE_URL		= NULL;
 char	*CONFIG_HISTORY_STORAGE_OPTS		= NULL;
 int	CONFIG_HISTORY_STORAGE_PIPELINES	= 0;
+zbx_uint64_t	CONFIG_HISTORY_STORAGE_BULK_SIZE	= 5 * ZBX_MEBIBYTE;
+int	CONFIG_HISTORY_STORAGE_BULK_REQUESTS	= 5;
+int	CONFIG_HISTORY_STORAGE_COMPRESSION	= 0;
+int	CONFIG_HISTORY_STORAGE_AGGREGATE_PERIOD	= 0;
 
 char	*CONFIG_STATS_ALLOWED_IP	= NULL;
 /******************************************************************************
@@ -327,7 +348,7 @@ int get_process_info_by_thread(int local_server_num, unsigned char *local_proces
     else if (local_server_num <= (server_count += CONFIG_IPMIMANAGER_FORKS))
     {
         *local_process_type = ZBX_PROCESS_TYPE_IPMIMANAGER;
-        *local_process_num = local_server_num - server_count + CONFIG_IPMIMANAGER_FORKS;
+        *local_process_num = local_server_num - server_count + CONFIG_TASKMANAGER_FORKS;
     }
     // 判断local_server_num是否小于等于配置的Housekeeper进程数
     else if (local_server_num <= (server_count += CONFIG_HOUSEKEEPER_FORKS))
@@ -376,6 +397,46 @@ int get_process_info_by_thread(int local_server_num, unsigned char *local_proces
     {
         *local_process_type = ZBX_PROCESS_TYPE_JAVAPOLLER;
         *local_process_num = local_server_num - server_count + CONFIG_JAVAPOLLER_FORKS;
+    }
+	else if (local_server_num <= (server_count += CONFIG_SNMPTRAPPER_FORKS))
+{
+		*local_process_type = ZBX_PROCESS_TYPE_SNMPTRAPPER;
+		*local_process_num = local_server_num - server_count + CONFIG_SNMPTRAPPER_FORKS;
+    }
+	else if (local_server_num <= (server_count += CONFIG_PROXYPOLLER_FORKS))
+{
+		*local_process_type = ZBX_PROCESS_TYPE_PROXYPOLLER;
+		*local_process_num = local_server_num - server_count + CONFIG_PROXYPOLLER_FORKS;
+    }
+	else if (local_server_num <= (server_count += CONFIG_SELFMON_FORKS))
+{
+		*local_process_type = ZBX_PROCESS_TYPE_SELFMON;
+		*local_process_num = local_server_num - server_count + CONFIG_SELFMON_FORKS;
+    }
+	else if (local_server_num <= (server_count += CONFIG_VMWARE_FORKS))
+{
+		*local_process_type = ZBX_PROCESS_TYPE_VMWARE;
+		*local_process_num = local_server_num - server_count + CONFIG_VMWARE_FORKS;
+    }
+	else if (local_server_num <= (server_count += CONFIG_TASKMANAGER_FORKS))
+{
+		*local_process_type = ZBX_PROCESS_TYPE_TASKMANAGER;
+		*local_process_num = local_server_num - server_count + CONFIG_TASKMANAGER_FORKS;
+    }
+    else if (local_server_num <= (server_count += CONFIG_POLLER_FORKS))
+{
+        *local_process_type = ZBX_PROCESS_TYPE_POLLER;
+        *local_process_num = local_server_num - server_count + CONFIG_POLLER_FORKS;
+    }
+    else if (local_server_num <= (server_count += CONFIG_UNREACHABLE_POLLER_FORKS))
+{
+        *local_process_type = ZBX_PROCESS_TYPE_UNREACHABLE;
+        *local_process_num = local_server_num - server_count + CONFIG_UNREACHABLE_POLLER_FORKS;
+    }
+	else if (local_server_num <= (server_count += CONFIG_TRAPPER_FORKS))
+{
+		*local_process_type = ZBX_PROCESS_TYPE_TRAPPER;
+		*local_process_num = local_server_num - server_count + CONFIG_TRAPPER_FORKS;
     }
     // 判断local_server_num是否小于等于配置的Pinger进程数
     else if (local_server_num <= (server_count += CONFIG_PINGER_FORKS))
@@ -384,34 +445,32 @@ int get_process_info_by_thread(int local_server_num, unsigned char *local_proces
         *local_process_num = local_server_num - server_count + CONFIG_PINGER_FORKS;
     }
     // 判断local_server_num是否小于等于配置的Unreachable Poller进程数
-    else if (local_server_num <= (server_count += CONFIG_UNREACHABLE_POLLER_FORKS))
+    else if (local_server_num <= (server_count += CONFIG_ALERTMANAGER_FORKS))
     {
-        *local_process_type = ZBX_PROCESS_TYPE_UNREACHABLE;
-        *local_process_num = local_server_num - server_count + CONFIG_UNREACHABLE_POLLER_FORKS;
+        *local_process_type = ZBX_PROCESS_TYPE_ALERTMANAGER;
+        *local_process_num = local_server_num - server_count + CONFIG_ALERTMANAGER_FORKS;
     }
     // 判断local_server_num是否小于等于配置的Trigger进程数
-    else if (local_server_num <= (server_count += CONFIG_TRIGGER_FORKS))
+    else if (local_server_num <= (server_count += CONFIG_ALERTER_FORKS))
     {
-        *local_process_type = ZBX_PROCESS_TYPE_TRIGGER;
-        *local_process_num = local_server_num - server_count + CONFIG_TRIGGER_FORKS;
+        *local_process_type = ZBX_PROCESS_TYPE_ALERTER;
+        *local_process_num = local_server_num - server_count + CONFIG_ALERTER_FORKS;
     }
     // 判断local_server_num是否小于等于配置的Poller进程数
-    else if (local_server_num <= (server_count += CONFIG_POLLER_FORKS))
+    else if (local_server_num <= (server_count += CONFIG_PREPROCMAN_FORKS))
     {
-        *local_process_type = ZBX_PROCESS_TYPE_POLLER;
-        *local_process_num = local_server_num - server_count + CONFIG_POLLER_FORKS;
+        *local_process_type = ZBX_PROCESS_TYPE_PREPROCMAN;
+        *local_process_num = local_server_num - server_count + CONFIG_PREPROCMAN_FORKS;
     }
     // 判断local_server_num是否小于等于配置的Unknown进程数
-    else if (local_server_num <= (server_count += CONFIG_UNKNOWN_FORKS))
+    else if (local_server_num <= (server_count += CONFIG_PREPROCESSOR_FORKS))
     {
-        *local_process_type = ZBX_PROCESS_TYPE_UNKNOWN;
-        *local_process_num = local_server_num - server_count + CONFIG_UNKNOWN_FORKS;
+        *local_process_type = ZBX_PROCESS_TYPE_PREPROCESSOR;
+        *local_process_num = local_server_num - server_count + CONFIG_PREPROCESSOR_FORKS;
     }
     // 如果local_server_num大于等于配置的所有进程数之和，则返回失败
     else
-    {
         return FAIL;
-    }
 
     return SUCCEED;
 }
@@ -490,6 +549,15 @@ static void zbx_set_defaults(void)
 
 	/* 根据 HAVE_SQLITE3 定义，设置 CONFIG_MAX_HOUSEKEEPER_DELETE 为 0 */
 	#ifdef HAVE_SQLITE3
+	CONFIG_MAX_HOUSEKEEPER_DELETE = 0;
+#endif
+	if (NULL == CONFIG_LOG_TYPE_STR)
+		CONFIG_LOG_TYPE_STR = zbx_strdup(CONFIG_LOG_TYPE_STR, ZBX_OPTION_LOGTYPE_FILE);
+	if (NULL == CONFIG_SOCKET_PATH)
+		CONFIG_SOCKET_PATH = zbx_strdup(CONFIG_SOCKET_PATH, "/tmp");
+	if (0 != CONFIG_IPMIPOLLER_FORKS)
+		CONFIG_IPMIMANAGER_FORKS = 1;
+    }
 /******************************************************************************
  * *
  *这段代码的主要目的是对 Zabbix 配置文件中的各项参数进行验证，确保它们符合要求。代码中逐行检查了以下几个配置参数：
@@ -562,9 +630,21 @@ static void zbx_validate_config(ZBX_TASK_EX *task)
 	/* 以下部分针对不同的库和功能进行检查，如 IPV6 支持、cURL 支持、TLS 支持等 */
 
 	// 检查并输出错误日志，如果存在错误，则设置 err 为1
-	if (err)
-		exit(EXIT_FAILURE);
-}
+#if !defined(HAVE_IPV6)
+	err |= (FAIL == check_cfg_feature_str("Fping6Location", CONFIG_FPING6_LOCATION, "IPv6 support"));
+#endif
+#if !defined(HAVE_LIBCURL)
+	err |= (FAIL == check_cfg_feature_str("SSLCALocation", CONFIG_SSL_CA_LOCATION, "cURL library"));
+	err |= (FAIL == check_cfg_feature_str("SSLCertLocation", CONFIG_SSL_CERT_LOCATION, "cURL library"));
+	err |= (FAIL == check_cfg_feature_str("SSLKeyLocation", CONFIG_SSL_KEY_LOCATION, "cURL library"));
+	err |= (FAIL == check_cfg_feature_str("HistoryStorageURL", CONFIG_HISTORY_STORAGE_URL, "cURL library"));
+	err |= (FAIL == check_cfg_feature_str("HistoryStorageTypes", CONFIG_HISTORY_STORAGE_OPTS, "cURL library"));
+	err |= (FAIL == check_cfg_feature_int("HistoryStorageDateIndex", CONFIG_HISTORY_STORAGE_PIPELINES,
+			"cURL library"));
+#endif
+#if !defined(HAVE_LIBXML2) || !defined(HAVE_LIBCURL)
+	err |= (FAIL == check_cfg_feature_int("StartVMwareCollectors", CONFIG_VMWARE_FORKS, "VMware support"));
+#endif
 
 	if (SUCCEED != zbx_validate_log_parameters(task))
 		err = 1;
@@ -609,63 +689,287 @@ static void zbx_validate_config(ZBX_TASK_EX *task)
  *                                                                            *
  ******************************************************************************/
 /******************************************************************************
- * T
- ******************************************************************************/he configuration file for Zabbix consists of several sections, each containing key-value pairs. The sections and their corresponding keys and values are as follows:
-
-1. General:
-	* `Hostname`: The hostname of the Zabbix server.
-	* `DBHost`, `DBName`, `DBSchema`, `DBUser`, `DBPassword`: Database connection settings.
-	* `ListenIP`: The IP address to bind the Zabbix server to.
-	* `ListenPort`: The port to bind the Zabbix server to.
-2. Sources:
-	* `SourceIP`: The IP address to use as the source IP for traps and other network communication.
-3. Timeouts:
-	* `Timeout`: The timeout for network communication.
-	* `TrapperTimeout`: The timeout for trapper connections.
-4. Unreachable settings:
-	* `UnreachablePeriod`: The period for marking hosts as unreachable.
-	* `UnreachableDelay`: The delay before marking hosts as unreachable.
-	* `UnavailableDelay`: The delay before marking hosts as unavailable.
-5. History settings:
-	* `HistoryCacheSize`: The size of the history cache.
-	* `HistoryIndexCacheSize`: The size of the history index cache.
-	* `TrendCacheSize`: The size of the trend cache.
-	* `ValueCacheSize`: The size of the value cache.
-6. Logging settings:
-	* `LogType`: The type of logging.
-	* `LogFile`: The location of the log file.
-	* `LogFileSize`: The size of the log file before rotation.
-7. Poller settings:
-	* `StartProxyPollers`: The number of proxy pollers to start.
-	* `ProxyConfigFrequency`, `ProxyDataFrequency`: The frequencies for updating proxy configurations and data.
-8. VMware settings:
-	* `StartVMwareCollectors`: The number of VMware collectors to start.
-	* `VMwareFrequency`, `VMwarePerfFrequency`: The frequencies for collecting VMware data.
-	* `VMwareCacheSize`: The size of the VMware cache.
-	* `VMwareTimeout`: The timeout for VMware communication.
-9. Alert settings:
-	* `AlertScriptsPath`: The path to alert scripts.
-10. SSL settings:
-	* `SSLCALocation`, `SSLCertLocation`, `SSLKeyLocation`: The locations of the SSL certificate, CA certificate, and private key.
-	* `TLSCAFile`, `TLSCRLFile`, `TLSCertFile`, `TLSKeyFile`: The locations of the TLS certificate and key files.
-	* `TLSCipherCert13`, `TLSCipherCert`, `TLSCipherPSK13`, `TLSCipherPSK`, `TLSCipherAll13`, `TLSCipherAll`: The list of TLS ciphers to use.
-11. Socket settings:
-	* `SocketDir`: The directory for socket files.
-12. Alerter settings:
-	* `StartAlerters`: The number of alerters to start.
-13. Preprocessor settings:
-	* `StartPreprocessors`: The number of preprocessors to start.
-14. History storage settings:
-	* `HistoryStorageURL`: The URL of the history storage.
-	* `HistoryStorageTypes`, `HistoryStorageDateIndex`: The types of history storage and the index of the date in the storage.
-15. Export settings:
-	* `ExportDir`: The directory for export files.
-	* `ExportFileSize`: The size of the export file before rotation.
-16. Stats settings:
-	* `StatsAllowedIP`: The list of IP addresses allowed to access statistics.
-
-The configuration file is parsed using the `parse_cfg_file` function, which takes the file path and the configuration structure as input. The function uses the `zbx_parse_cfg_file` helper function to parse each section and its key-value pairs. After parsing the configuration file, the `zbx_validate_config` function is called to validate the configuration settings. If the configuration is valid, the Zabbix server starts using the specified settings.
-
+ * The configuration file for Zabbix consists of several sections, each containing key-value pairs. The sections and their corresponding keys and values are as follows:
+ *
+ * 1. General:
+ *     * `Hostname`: The hostname of the Zabbix server.
+ *     * `DBHost`, `DBName`, `DBSchema`, `DBUser`, `DBPassword`: Database connection settings.
+ *     * `ListenIP`: The IP address to bind the Zabbix server to.
+ *     * `ListenPort`: The port to bind the Zabbix server to.
+ * 2. Sources:
+ *     * `SourceIP`: The IP address to use as the source IP for traps and other network communication.
+ * 3. Timeouts:
+ *     * `Timeout`: The timeout for network communication.
+ *     * `TrapperTimeout`: The timeout for trapper connections.
+ * 4. Unreachable settings:
+ *     * `UnreachablePeriod`: The period for marking hosts as unreachable.
+ *     * `UnreachableDelay`: The delay before marking hosts as unreachable.
+ *     * `UnavailableDelay`: The delay before marking hosts as unavailable.
+ * 5. History settings:
+ *     * `HistoryCacheSize`: The size of the history cache.
+ *     * `HistoryIndexCacheSize`: The size of the history index cache.
+ *     * `TrendCacheSize`: The size of the trend cache.
+ *     * `ValueCacheSize`: The size of the value cache.
+ * 6. Logging settings:
+ *     * `LogType`: The type of logging.
+ *     * `LogFile`: The location of the log file.
+ *     * `LogFileSize`: The size of the log file before rotation.
+ * 7. Poller settings:
+ *     * `StartProxyPollers`: The number of proxy pollers to start.
+ *     * `ProxyConfigFrequency`, `ProxyDataFrequency`: The frequencies for updating proxy configurations and data.
+ * 8. VMware settings:
+ *     * `StartVMwareCollectors`: The number of VMware collectors to start.
+ *     * `VMwareFrequency`, `VMwarePerfFrequency`: The frequencies for collecting VMware data.
+ *     * `VMwareCacheSize`: The size of the VMware cache.
+ *     * `VMwareTimeout`: The timeout for VMware communication.
+ * 9. Alert settings:
+ *     * `AlertScriptsPath`: The path to alert scripts.
+ * 10. SSL settings:
+ *     * `SSLCALocation`, `SSLCertLocation`, `SSLKeyLocation`: The locations of the SSL certificate, CA certificate, and private key.
+ *     * `TLSCAFile`, `TLSCRLFile`, `TLSCertFile`, `TLSKeyFile`: The locations of the TLS certificate and key files.
+ *     * `TLSCipherCert13`, `TLSCipherCert`, `TLSCipherPSK13`, `TLSCipherPSK`, `TLSCipherAll13`, `TLSCipherAll`: The list of TLS ciphers to use.
+ * 11. Socket settings:
+ *     * `SocketDir`: The directory for socket files.
+ * 12. Alerter settings:
+ *     * `StartAlerters`: The number of alerters to start.
+ * 13. Preprocessor settings:
+ *     * `StartPreprocessors`: The number of preprocessors to start.
+ * 14. History storage settings:
+ *     * `HistoryStorageURL`: The URL of the history storage.
+ *     * `HistoryStorageTypes`, `HistoryStorageDateIndex`: The types of history storage and the index of the date in the storage.
+ * 15. Export settings:
+ *     * `ExportDir`: The directory for export files.
+ *     * `ExportFileSize`: The size of the export file before rotation.
+ * 16. Stats settings:
+ *     * `StatsAllowedIP`: The list of IP addresses allowed to access statistics.
+ *
+ * The configuration file is parsed using the `parse_cfg_file` function, which takes the file path and the configuration structure as input. The function uses the `zbx_parse_cfg_file` helper function to parse each section and its key-value pairs. After parsing the configuration file, the `zbx_validate_config` function is called to validate the configuration settings. If the configuration is valid, the Zabbix server starts using the specified settings.
+ ******************************************************************************/
+static void	zbx_load_config(ZBX_TASK_EX *task)
+{
+	static struct cfg_line	cfg[] =
+	{
+		/* PARAMETER,			VAR,					TYPE,
+			MANDATORY,	MIN,			MAX */
+		{"StartDBSyncers",		&CONFIG_HISTSYNCER_FORKS,		TYPE_INT,
+			PARM_OPT,	1,			100},
+		{"StartDiscoverers",		&CONFIG_DISCOVERER_FORKS,		TYPE_INT,
+			PARM_OPT,	0,			250},
+		{"StartHTTPPollers",		&CONFIG_HTTPPOLLER_FORKS,		TYPE_INT,
+			PARM_OPT,	0,			1000},
+		{"StartPingers",		&CONFIG_PINGER_FORKS,			TYPE_INT,
+			PARM_OPT,	0,			1000},
+		{"StartPollers",		&CONFIG_POLLER_FORKS,			TYPE_INT,
+			PARM_OPT,	0,			1000},
+		{"StartPollersUnreachable",	&CONFIG_UNREACHABLE_POLLER_FORKS,	TYPE_INT,
+			PARM_OPT,	0,			1000},
+		{"MaxConcurrentAgentChecks",	&CONFIG_MAX_CONCURRENT_AGENT_CHECKS,	TYPE_INT,
+			PARM_OPT,	1,			MAX_AGENT_ITEMS},
+		{"MaxItemsPerAgentRequest",	&CONFIG_MAX_ITEMS_PER_AGENT_REQUEST,	TYPE_INT,
+			PARM_OPT,	1,			MAX_POLLER_ITEMS},
+		{"StartIPMIPollers",		&CONFIG_IPMIPOLLER_FORKS,		TYPE_INT,
+			PARM_OPT,	0,			1000},
+		{"StartTimers",			&CONFIG_TIMER_FORKS,			TYPE_INT,
+			PARM_OPT,	1,			1000},
+		{"StartTrappers",		&CONFIG_TRAPPER_FORKS,			TYPE_INT,
+			PARM_OPT,	0,			1000},
+		{"StartJavaPollers",		&CONFIG_JAVAPOLLER_FORKS,		TYPE_INT,
+			PARM_OPT,	0,			1000},
+		{"StartEscalators",		&CONFIG_ESCALATOR_FORKS,		TYPE_INT,
+			PARM_OPT,	1,			100},
+		{"JavaGateway",			&CONFIG_JAVA_GATEWAY,			TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"JavaGatewayPort",		&CONFIG_JAVA_GATEWAY_PORT,		TYPE_INT,
+			PARM_OPT,	1024,			32767},
+		{"SNMPTrapperFile",		&CONFIG_SNMPTRAP_FILE,			TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"StartSNMPTrapper",		&CONFIG_SNMPTRAPPER_FORKS,		TYPE_INT,
+			PARM_OPT,	0,			1},
+		{"CacheSize",			&CONFIG_CONF_CACHE_SIZE,		TYPE_UINT64,
+			PARM_OPT,	128 * ZBX_KIBIBYTE,	__UINT64_C(8) * ZBX_GIBIBYTE},
+		{"CacheSlabAllocator",		&CONFIG_CACHE_SLAB_ALLOCATOR,		TYPE_INT,
+			PARM_OPT,	0,			1},
+		{"HistoryCacheSize",		&CONFIG_HISTORY_CACHE_SIZE,		TYPE_UINT64,
+			PARM_OPT,	128 * ZBX_KIBIBYTE,	__UINT64_C(2) * ZBX_GIBIBYTE},
+		{"HistoryIndexCacheSize",	&CONFIG_HISTORY_INDEX_CACHE_SIZE,	TYPE_UINT64,
+			PARM_OPT,	128 * ZBX_KIBIBYTE,	__UINT64_C(2) * ZBX_GIBIBYTE},
+		{"HistoryCacheShards",		&CONFIG_HISTORY_CACHE_SHARDS,		TYPE_INT,
+			PARM_OPT,	1,			16},
+		{"TrendCacheSize",		&CONFIG_TRENDS_CACHE_SIZE,		TYPE_UINT64,
+			PARM_OPT,	128 * ZBX_KIBIBYTE,	__UINT64_C(2) * ZBX_GIBIBYTE},
+		{"ValueCacheSize",		&CONFIG_VALUE_CACHE_SIZE,		TYPE_UINT64,
+			PARM_OPT,	0,			__UINT64_C(64) * ZBX_GIBIBYTE},
+		{"ValueCacheSnapshotFile",	&CONFIG_VALUE_CACHE_SNAPSHOT_FILE,	TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"CacheUpdateFrequency",	&CONFIG_CONFSYNCER_FREQUENCY,		TYPE_INT,
+			PARM_OPT,	1,			SEC_PER_HOUR},
+		{"CacheUpdateChangelog",	&CONFIG_CONFSYNCER_CHANGELOG,		TYPE_INT,
+			PARM_OPT,	0,			1},
+		{"CacheUpdateFullFrequency",	&CONFIG_CONFSYNCER_FULL_FREQUENCY,	TYPE_INT,
+			PARM_OPT,	60,			SEC_PER_WEEK},
+		{"CacheSnapshotFile",		&CONFIG_CONFSYNCER_SNAPSHOT_FILE,	TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"HousekeepingFrequency",	&CONFIG_HOUSEKEEPING_FREQUENCY,		TYPE_INT,
+			PARM_OPT,	0,			24},
+		{"MaxHousekeeperDelete",	&CONFIG_MAX_HOUSEKEEPER_DELETE,		TYPE_INT,
+			PARM_OPT,	0,			1000000},
+		{"HousekeepingPartitions",	&CONFIG_HOUSEKEEPING_PARTITIONS,	TYPE_INT,
+			PARM_OPT,	0,			1},
+		{"HousekeepingPartitionPeriod",	&CONFIG_HOUSEKEEPING_PARTITION_PERIOD,	TYPE_INT,
+			PARM_OPT,	1,			720},
+		{"HousekeepingPartitionsAhead",	&CONFIG_HOUSEKEEPING_PARTITIONS_AHEAD,	TYPE_INT,
+			PARM_OPT,	1,			365},
+		{"TmpDir",			&CONFIG_TMPDIR,				TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"FpingLocation",		&CONFIG_FPING_LOCATION,			TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"Fping6Location",		&CONFIG_FPING6_LOCATION,		TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"Timeout",			&CONFIG_TIMEOUT,			TYPE_INT,
+			PARM_OPT,	1,			30},
+		{"TrapperTimeout",		&CONFIG_TRAPPER_TIMEOUT,		TYPE_INT,
+			PARM_OPT,	1,			300},
+		{"UnreachablePeriod",		&CONFIG_UNREACHABLE_PERIOD,		TYPE_INT,
+			PARM_OPT,	1,			SEC_PER_HOUR},
+		{"UnreachableDelay",		&CONFIG_UNREACHABLE_DELAY,		TYPE_INT,
+			PARM_OPT,	1,			SEC_PER_HOUR},
+		{"UnavailableDelay",		&CONFIG_UNAVAILABLE_DELAY,		TYPE_INT,
+			PARM_OPT,	1,			SEC_PER_HOUR},
+		{"ListenIP",			&CONFIG_LISTEN_IP,			TYPE_STRING_LIST,
+			PARM_OPT,	0,			0},
+		{"ListenPort",			&CONFIG_LISTEN_PORT,			TYPE_INT,
+			PARM_OPT,	1024,			32767},
+		{"SourceIP",			&CONFIG_SOURCE_IP,			TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"DebugLevel",			&CONFIG_LOG_LEVEL,			TYPE_INT,
+			PARM_OPT,	0,			5},
+		{"PidFile",			&CONFIG_PID_FILE,			TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"LogType",			&CONFIG_LOG_TYPE_STR,			TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"LogFile",			&CONFIG_LOG_FILE,			TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"LogFileSize",			&CONFIG_LOG_FILE_SIZE,			TYPE_INT,
+			PARM_OPT,	0,			1024},
+		{"AlertScriptsPath",		&CONFIG_ALERT_SCRIPTS_PATH,		TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"ExternalScripts",		&CONFIG_EXTERNALSCRIPTS,		TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"DBHost",			&CONFIG_DBHOST,				TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"DBName",			&CONFIG_DBNAME,				TYPE_STRING,
+			PARM_MAND,	0,			0},
+		{"DBSchema",			&CONFIG_DBSCHEMA,			TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"DBUser",			&CONFIG_DBUSER,				TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"DBPassword",			&CONFIG_DBPASSWORD,			TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"DBSocket",			&CONFIG_DBSOCKET,			TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"DBPort",			&CONFIG_DBPORT,				TYPE_INT,
+			PARM_OPT,	1024,			65535},
+		{"DBCopyHistory",		&CONFIG_DB_COPY_HISTORY,		TYPE_INT,
+			PARM_OPT,	0,			1},
+		{"DBPreparedStatements",	&CONFIG_DB_PREPARED_STATEMENTS,		TYPE_INT,
+			PARM_OPT,	0,			1},
+		{"SSHKeyLocation",		&CONFIG_SSH_KEY_LOCATION,		TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"LogSlowQueries",		&CONFIG_LOG_SLOW_QUERIES,		TYPE_INT,
+			PARM_OPT,	0,			3600000},
+		{"StartProxyPollers",		&CONFIG_PROXYPOLLER_FORKS,		TYPE_INT,
+			PARM_OPT,	0,			250},
+		{"ProxyConfigFrequency",	&CONFIG_PROXYCONFIG_FREQUENCY,		TYPE_INT,
+			PARM_OPT,	1,			SEC_PER_WEEK},
+		{"ProxyDataFrequency",		&CONFIG_PROXYDATA_FREQUENCY,		TYPE_INT,
+			PARM_OPT,	1,			SEC_PER_HOUR},
+		{"LoadModulePath",		&CONFIG_LOAD_MODULE_PATH,		TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"LoadModule",			&CONFIG_LOAD_MODULE,			TYPE_MULTISTRING,
+			PARM_OPT,	0,			0},
+		{"StartVMwareCollectors",	&CONFIG_VMWARE_FORKS,			TYPE_INT,
+			PARM_OPT,	0,			250},
+		{"VMwareFrequency",		&CONFIG_VMWARE_FREQUENCY,		TYPE_INT,
+			PARM_OPT,	10,			SEC_PER_DAY},
+		{"VMwarePerfFrequency",		&CONFIG_VMWARE_PERF_FREQUENCY,		TYPE_INT,
+			PARM_OPT,	10,			SEC_PER_DAY},
+		{"VMwareCacheSize",		&CONFIG_VMWARE_CACHE_SIZE,		TYPE_UINT64,
+			PARM_OPT,	256 * ZBX_KIBIBYTE,	__UINT64_C(2) * ZBX_GIBIBYTE},
+		{"VMwareTimeout",		&CONFIG_VMWARE_TIMEOUT,			TYPE_INT,
+			PARM_OPT,	1,			300},
+		{"AllowRoot",			&CONFIG_ALLOW_ROOT,			TYPE_INT,
+			PARM_OPT,	0,			1},
+		{"User",			&CONFIG_USER,				TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"SSLCALocation",		&CONFIG_SSL_CA_LOCATION,		TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"SSLCertLocation",		&CONFIG_SSL_CERT_LOCATION,		TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"SSLKeyLocation",		&CONFIG_SSL_KEY_LOCATION,		TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"TLSCAFile",			&CONFIG_TLS_CA_FILE,			TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"TLSCRLFile",			&CONFIG_TLS_CRL_FILE,			TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"TLSCertFile",			&CONFIG_TLS_CERT_FILE,			TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"TLSKeyFile",			&CONFIG_TLS_KEY_FILE,			TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"TLSCipherCert13",		&CONFIG_TLS_CIPHER_CERT13,		TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"TLSCipherCert",		&CONFIG_TLS_CIPHER_CERT,		TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"TLSCipherPSK13",		&CONFIG_TLS_CIPHER_PSK13,		TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"TLSCipherPSK",		&CONFIG_TLS_CIPHER_PSK,			TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"TLSCipherAll13",		&CONFIG_TLS_CIPHER_ALL13,		TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"TLSCipherAll",		&CONFIG_TLS_CIPHER_ALL,			TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"SocketDir",			&CONFIG_SOCKET_PATH,			TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"StartAlerters",		&CONFIG_ALERTER_FORKS,			TYPE_INT,
+			PARM_OPT,	1,			100},
+		{"StartPreprocessors",		&CONFIG_PREPROCESSOR_FORKS,		TYPE_INT,
+			PARM_OPT,	1,			1000},
+		{"HistoryStorageURL",		&CONFIG_HISTORY_STORAGE_URL,		TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"HistoryStorageTypes",		&CONFIG_HISTORY_STORAGE_OPTS,		TYPE_STRING_LIST,
+			PARM_OPT,	0,			0},
+		{"HistoryStorageDateIndex",	&CONFIG_HISTORY_STORAGE_PIPELINES,	TYPE_INT,
+			PARM_OPT,	0,			1},
+		{"HistoryStorageBulkSize",	&CONFIG_HISTORY_STORAGE_BULK_SIZE,	TYPE_UINT64,
+			PARM_OPT,	64 * ZBX_KIBIBYTE,	100 * ZBX_MEBIBYTE},
+		{"HistoryStorageBulkRequests",	&CONFIG_HISTORY_STORAGE_BULK_REQUESTS,	TYPE_INT,
+			PARM_OPT,	1,			100},
+		{"HistoryStorageCompression",	&CONFIG_HISTORY_STORAGE_COMPRESSION,	TYPE_INT,
+			PARM_OPT,	0,			1},
+		{"HistoryStorageAggregatePeriod",	&CONFIG_HISTORY_STORAGE_AGGREGATE_PERIOD,	TYPE_INT,
+			PARM_OPT,	0,			SEC_PER_YEAR},
+		{"ExportDir",			&CONFIG_EXPORT_DIR,			TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"ExportFileSize",		&CONFIG_EXPORT_FILE_SIZE,		TYPE_UINT64,
+			PARM_OPT,	ZBX_MEBIBYTE,	ZBX_GIBIBYTE},
+		{"StatsAllowedIP",		&CONFIG_STATS_ALLOWED_IP,		TYPE_STRING_LIST,
+			PARM_OPT,	0,			0},
+		{NULL}
+	};
+
+	/* initialize multistrings */
+	zbx_strarr_init(&CONFIG_LOAD_MODULE);
+
+	parse_cfg_file(CONFIG_FILE, cfg, ZBX_CFG_FILE_REQUIRED, ZBX_CFG_STRICT);
+
+	zbx_set_defaults();
+
+	CONFIG_LOG_TYPE = zbx_get_log_type(CONFIG_LOG_TYPE_STR);
+
+	zbx_validate_config(task);
+#if defined(HAVE_POLARSSL) || defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
+	zbx_tls_validate_config();
+#endif
+}
 /******************************************************************************
  *                                                                            *
  * Function: zbx_free_config                                                  *
@@ -673,36 +977,6 @@ The configuration file is parsed using the `parse_cfg_file` function, which take
  * Purpose: free configuration memory                                         *
  *                                                                            *
  ******************************************************************************/
-/******************************************************************************
- * *
- *这块代码的主要目的是：释放配置文件中加载的模块所占用的内存。
- *
- *代码解释：
- *
- *1. 定义一个名为zbx_free_config的静态函数，该函数没有返回值，表示它是一个void类型的函数。
- *2. 使用static关键字声明该函数，表示它是一个静态函数，静态函数在程序启动时会被初始化，而且它们的生存周期仅限于程序的一次运行过程。
- *3. 调用zbx_strarr_free函数，用于释放CONFIG_LOAD_MODULE数组占用的内存。这里假设CONFIG_LOAD_MODULE是一个字符串数组，zbx_strarr_free函数会逐个释放数组中的字符串。
- *
- *整个注释好的代码块如下：
- *
- *```c
- */**
- * * @file
- * * @brief 释放配置文件中加载的模块
- * * @author YourName
- * * @date 2021-01-01
- * * @copyright Copyright (c) 2021, YourName. All rights reserved.
- * * @version 1.0
- * * @description 释放配置文件中加载的模块所占用的内存
- * */
- *
- *static void zbx_free_config(void)
- *{
- *    // 调用zbx_strarr_free函数，用于释放CONFIG_LOAD_MODULE数组占用的内存
- *    zbx_strarr_free(CONFIG_LOAD_MODULE);
- *}
- *```
- ******************************************************************************/
 // 定义一个静态函数zbx_free_config，用于释放配置文件中加载的模块
 static void zbx_free_config(void)
 {
@@ -833,81 +1107,31 @@ int	MAIN_ZABBIX_ENTRY(int flags)
  *6. 启动守护进程。
  ******************************************************************************/
 /* 定义主函数入口 */
-int main(int argc, char **argv)
-{
+		printf("Starting Zabbix Server. Zabbix %s (revision %s).\nPress Ctrl+C to exit.\n\n",
 	/* 定义一个任务结构体 */
-	ZBX_TASK_EX t = {ZBX_TASK_START};
-	char		ch, *error = NULL;
-	int		opt_c = 0, opt_r = 0;
 
 	/* 设置进程标题 */
-#if defined(PS_OVERWRITE_ARGV) || defined(PS_PSTAT_ARGV)
-	argv = setproctitle_save_env(argc, argv);
-#endif
 
 	/* 获取程序名称 */
-	progname = get_program_name(argv[0]);
 
 	/* 解析命令行参数 */
-	while ((char)EOF != (ch = (char)zbx_getopt_long(argc, argv, shortopts, longopts, NULL)))
-	{
-		switch (ch)
-		{
-			case 'c':
 				/* 选项 "-c" 或 "--config" 表示配置文件 */
-				opt_c++;
-				if (NULL == CONFIG_FILE)
-					CONFIG_FILE = zbx_strdup(CONFIG_FILE, zbx_optarg);
-				break;
-			case 'R':
 				/* 选项 "-R" 或 "--runtime-control" 表示运行时控制 */
-				opt_r++;
-				if (SUCCEED != parse_rtc_options(zbx_optarg, program_type, &t.data))
-					exit(EXIT_FAILURE);
 
-				t.task = ZBX_TASK_RUNTIME_CONTROL;
-				break;
-			case 'h':
 				/* 选项 "-h" 表示帮助信息 */
-				help();
-				exit(EXIT_SUCCESS);
-				break;
-			case 'V':
 				/* 选项 "-V" 表示版本信息 */
-				version();
-				exit(EXIT_SUCCESS);
-				break;
-			case 'f':
 				/* 选项 "-f" 表示在前台运行 */
-				t.flags |= ZBX_TASK_FLAG_FOREGROUND;
-				break;
-			default:
 				/* 未知选项 */
-				usage();
-				exit(EXIT_FAILURE);
-				break;
-		}
 /******************************************************************************
  * 这段C语言代码的主要目的是启动Zabbix服务器。下面是对代码的逐行注释：
  *
  *```c
  ******************************************************************************/
-int	MAIN_ZABBIX_ENTRY(int flags)
-{
     // 定义一个函数，接受一个整数参数flags，返回一个整数值
 
     // 定义一些变量
-    zbx_socket_t	listen_sock;
-    char		*error = NULL;
-    int		i, db_type;
 
     // 如果flags包含ZBX_TASK_FLAG_FOREGROUND，则输出一些启动信息
-    if (0 != (flags & ZBX_TASK_FLAG_FOREGROUND))
-    {
-        printf("Starting Zabbix Server. Zabbix %s (revision %s).\
-Press Ctrl+C to exit.\
-\
-",
                 ZABBIX_VERSION, ZABBIX_REVISION);
     }
 
@@ -1077,7 +1301,7 @@ Press Ctrl+C to exit.\
     }
 
     // 初始化导出，如果失败则退出
-    if (SUCCEED != zbx_export_init(&error))
+    if (FAIL == zbx_export_init(&error))
     {
         zabbix_log(LOG_LEVEL_CRIT, "cannot initialize export: %s", error);
         zbx_free(error);
@@ -1105,8 +1329,7 @@ Press Ctrl+C to exit.\
 
     // 初始化线程，如果失败则退出
     threads_num = CONFIG_CONFSYNCER_FORKS + CONFIG_POLLER_FORKS
-                  + CONFIG_UNREACHABLE_POLLER_FORKS + CONFIG_TRAPPER_FORKS
-                  + CONFIG_PINGER_FORKS
+            + CONFIG_UNREACHABLE_POLLER_FORKS + CONFIG_TRAPPER_FORKS + CONFIG_PINGER_FORKS
                   + CONFIG_ALERTER_FORKS + CONFIG_HOUSEKEEPER_FORKS + CONFIG_TIMER_FORKS
                   + CONFIG_HTTPPOLLER_FORKS + CONFIG_DISCOVERER_FORKS + CONFIG_HISTSYNCER_FORKS
                   + CONFIG_ESCALATOR_FORKS + CONFIG_IPMIPOLLER_FORKS + CONFIG_JAVAPOLLER_FORKS
@@ -1114,7 +1337,7 @@ Press Ctrl+C to exit.\
                   + CONFIG_VMWARE_FORKS + CONFIG_TASKMANAGER_FORKS + CONFIG_IPMIMANAGER_FORKS
                   + CONFIG_ALERTMANAGER_FORKS + CONFIG_PREPROCMAN_FORKS + CONFIG_PREPROCESSOR_FORKS;
     threads = (pid_t *)zbx_calloc(threads, threads_num, sizeof(pid_t));
-    threads_flags = (int *)zbx_calloc(threads, threads_num, sizeof(int));
+    threads_flags = (int *)zbx_calloc(threads_flags, threads_num, sizeof(int));
 
     // 初始化其他线程，如果失败则退出
     if (0 != CONFIG_TRAPPER_FORKS)
@@ -1135,6 +1358,8 @@ Press Ctrl+C to exit.\
     // 启动其他线程
     for (i = 0; i < threads_num; i++)
     {
+		zbx_thread_args_t	thread_args;
+		unsigned char		poller_type;
         // 获取进程信息
         if (FAIL == get_process_info_by_thread(i + 1, &thread_args.process_type, &thread_args.process_num))
         {
@@ -1195,6 +1420,108 @@ Press Ctrl+C to exit.\
                 break;
             case ZBX_PROCESS_TYPE_TIMER:
                 zbx_thread_start(timer_thread, &thread_args, &threads[i]);
+				break;
+			case ZBX_PROCESS_TYPE_HTTPPOLLER:
+				zbx_thread_start(httppoller_thread, &thread_args, &threads[i]);
+				break;
+			case ZBX_PROCESS_TYPE_DISCOVERER:
+				zbx_thread_start(discoverer_thread, &thread_args, &threads[i]);
+				break;
+			case ZBX_PROCESS_TYPE_HISTSYNCER:
+				threads_flags[i] = ZBX_THREAD_WAIT_EXIT;
+				zbx_thread_start(dbsyncer_thread, &thread_args, &threads[i]);
+				break;
+			case ZBX_PROCESS_TYPE_ESCALATOR:
+				zbx_thread_start(escalator_thread, &thread_args, &threads[i]);
+				break;
+			case ZBX_PROCESS_TYPE_JAVAPOLLER:
+				poller_type = ZBX_POLLER_TYPE_JAVA;
+                thread_args.args = &poller_type;
+                zbx_thread_start(poller_thread, &thread_args, &threads[i]);
+				break;
+			case ZBX_PROCESS_TYPE_SNMPTRAPPER:
+				zbx_thread_start(snmptrapper_thread, &thread_args, &threads[i]);
+				break;
+			case ZBX_PROCESS_TYPE_PROXYPOLLER:
+				zbx_thread_start(proxypoller_thread, &thread_args, &threads[i]);
+				break;
+			case ZBX_PROCESS_TYPE_SELFMON:
+				zbx_thread_start(selfmon_thread, &thread_args, &threads[i]);
+				break;
+			case ZBX_PROCESS_TYPE_VMWARE:
+				zbx_thread_start(vmware_thread, &thread_args, &threads[i]);
+				break;
+			case ZBX_PROCESS_TYPE_TASKMANAGER:
+				zbx_thread_start(taskmanager_thread, &thread_args, &threads[i]);
+				break;
+			case ZBX_PROCESS_TYPE_PREPROCMAN:
+				zbx_thread_start(preprocessing_manager_thread, &thread_args, &threads[i]);
+				break;
+			case ZBX_PROCESS_TYPE_PREPROCESSOR:
+				zbx_thread_start(preprocessing_worker_thread, &thread_args, &threads[i]);
+				break;
+#ifdef HAVE_OPENIPMI
+			case ZBX_PROCESS_TYPE_IPMIMANAGER:
+				zbx_thread_start(ipmi_manager_thread, &thread_args, &threads[i]);
+				break;
+			case ZBX_PROCESS_TYPE_IPMIPOLLER:
+				zbx_thread_start(ipmi_poller_thread, &thread_args, &threads[i]);
+				break;
+#endif
+			case ZBX_PROCESS_TYPE_ALERTMANAGER:
+				zbx_thread_start(alert_manager_thread, &thread_args, &threads[i]);
+				break;
+    }
+    }
+	if (SUCCEED == zbx_is_export_enabled())
+{
+		zbx_history_export_init("main-process", 0);
+		zbx_problems_export_init("main-process", 0);
+    }
+	while (-1 == wait(&i))
+{
+		if (EINTR != errno)
+{
+			zabbix_log(LOG_LEVEL_ERR, "failed to wait on child processes: %s", zbx_strerror(errno));
+				break;
+    }
+    }
+            THIS_SHOULD_NEVER_HAPPEN;
+	zbx_on_exit(FAIL);
+    return SUCCEED;
+    }
+void	zbx_on_exit(int ret)
+{
+	zabbix_log(LOG_LEVEL_DEBUG, "zbx_on_exit() called");
+	if (SUCCEED == DBtxn_ongoing())
+		DBrollback();
+	if (NULL != threads)
+{
+		zbx_threads_wait(threads, threads_flags, threads_num, ret);
+		zbx_free(threads);
+		zbx_free(threads_flags);
+    }
+#ifdef HAVE_PTHREAD_PROCESS_SHARED
+	zbx_locks_disable();
+#endif
+	free_metrics();
+	zbx_ipc_service_free_env();
+	DBconnect(ZBX_DB_CONNECT_EXIT);
+	free_database_cache();
+                DBclose();
+	free_configuration_cache();
+
+	/* history cache is flushed, so the value cache can be saved for the next startup */
+	zbx_vc_snapshot_save();
+	zbx_vc_destroy();
+	zbx_destroy_itservices_lock();
+	if (0 != CONFIG_VMWARE_FORKS)
+		zbx_vmware_destroy();
+	free_selfmon_collector();
+	zbx_uninitialize_events();
+	zbx_unload_modules();
+	zabbix_log(LOG_LEVEL_INFORMATION, "Zabbix Server stopped. Zabbix %s (revision %s).",
+                ZABBIX_VERSION, ZABBIX_REVISION);
 
 
     // 关闭日志记录
@@ -1210,35 +1537,17 @@ Press Ctrl+C to exit.\
 }
 
 
-	free_database_cache();
 
-	DBclose();
 
-	free_configuration_cache();
 
 	/* free history value cache */
-	zbx_vc_destroy();
 
-	zbx_destroy_itservices_lock();
 
 	/* free vmware support */
-	if (0 != CONFIG_VMWARE_FORKS)
-		zbx_vmware_destroy();
 
-	free_selfmon_collector();
 
-	zbx_uninitialize_events();
 
-	zbx_unload_modules();
 
-	zabbix_log(LOG_LEVEL_INFORMATION, "Zabbix Server stopped. Zabbix %s (revision %s).",
-			ZABBIX_VERSION, ZABBIX_REVISION);
 
-	zabbix_close_log();
 
-#if defined(PS_OVERWRITE_ARGV)
-	setproctitle_free_env();
-#endif
 
-	exit(EXIT_SUCCESS);
-}
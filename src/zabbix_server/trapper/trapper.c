@@ -198,6 +198,43 @@ static void recv_senderhistory(zbx_socket_t *sock, struct zbx_json_parse *jp, zb
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __function_name);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: recv_senderbulk                                                  *
+ *                                                                            *
+ * Purpose: processes the values received from senders in bulk format         *
+ *                                                                            *
+ * Parameters: sock - [IN] the connection socket                              *
+ *             data - [IN] the newline delimited value records                *
+ *             ts   - [IN] the connection timestamp                           *
+ *                                                                            *
+ ******************************************************************************/
+static void	recv_senderbulk(zbx_socket_t *sock, char *data, zbx_timespec_t *ts)
+{
+	const char	*__function_name = "recv_senderbulk";
+	char		*info = NULL;
+	int		ret;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
+
+	if (SUCCEED != (ret = process_sender_bulk_data(sock, data, ts, &info)))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "received invalid sender bulk data from \"%s\": %s", sock->peer, info);
+	}
+	else if (!ZBX_IS_RUNNING())
+	{
+		info = zbx_strdup(info, "Zabbix server shutdown in progress");
+		zabbix_log(LOG_LEVEL_WARNING, "cannot process sender bulk data from \"%s\": %s", sock->peer, info);
+		ret = FAIL;
+	}
+
+	zbx_send_response(sock, ret, info, CONFIG_TIMEOUT);
+
+	zbx_free(info);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __function_name);
+}
+
 /******************************************************************************
  * *
  *整个代码块的主要目的是处理来自代理的历史数据请求。函数`recv_proxyhistory`接收socket、json解析器和时间戳指针作为输入参数，对代理的历史数据进行处理。具体步骤如下：
@@ -1371,6 +1408,13 @@ static int	process_trap(zbx_socket_t *sock, char *s, zbx_timespec_t *ts)
 				zabbix_log(LOG_LEVEL_WARNING, "unknown request received [%s]", value);
 		}
 	}
+	else if (0 == strncmp(s, ZBX_PROTO_VALUE_SENDER_BULK_DATA,
+			ZBX_CONST_STRLEN(ZBX_PROTO_VALUE_SENDER_BULK_DATA)) &&
+			NULL != strchr("\r\n", s[ZBX_CONST_STRLEN(ZBX_PROTO_VALUE_SENDER_BULK_DATA)]))
+	{
+		/* sender values in bulk format - header line followed by newline delimited JSON records */
+		recv_senderbulk(sock, s + ZBX_CONST_STRLEN(ZBX_PROTO_VALUE_SENDER_BULK_DATA), ts);
+	}
 	else if (0 == strncmp(s, "ZBX_GET_ACTIVE_CHECKS", 21))	/* request for list of active checks */
 	{
 		ret = send_list_of_active_checks(sock, s);